@@ -1,25 +1,23 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+#include "../common/target_tracking.h"
+#include "../vision/hand_tracking_scene_shared.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <string>
+#include <thread>
 #include <vector>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "Ws2_32.lib")
-#else
-#include <arpa/inet.h>
-#include <errno.h>
-#include <fcntl.h>
-#include <sys/socket.h>
-#include <unistd.h>
-#endif
-
 namespace {
 
 constexpr int kPreferredWindowWidth = 1280;
@@ -27,9 +25,8 @@ constexpr int kPreferredWindowHeight = 800;
 constexpr float kWindowFillRatio = 0.90f;
 constexpr int kMinWindowWidth = 960;
 constexpr int kMinWindowHeight = 640;
-constexpr int kUdpPort = 50505;
-constexpr float kTurretTurnRate = 8.0f;
-constexpr float kTurretPitchRate = 8.0f;
+constexpr int kUdpPort = astro_hand::kBridgeUdpPort;
+constexpr float kTurretTurnRate = 8.0f;   // the old first-order aim lag, kept for the bench baseline
 constexpr float kMaxYaw = 120.0f * DEG2RAD;
 constexpr float kMaxPitch = 78.0f * DEG2RAD;
 constexpr float kMinPitch = -18.0f * DEG2RAD;
@@ -37,23 +34,51 @@ constexpr float kRearAimEnterY = 0.94f;  // enter rear mode when hand is very hi
 constexpr float kRearAimExitY = 0.84f;   // exit rear mode after moving hand down enough
 constexpr float kRearAimBlendRate = 7.5f;
 constexpr float kShotCooldown = 0.22f;
+constexpr uint64_t kPlaneSeed = 5150;
+constexpr uint64_t kRadarSeed = 7310;
 constexpr float kShotRange = 180.0f;
-constexpr float kShotFxTime = 0.12f;
 constexpr float kPlaneExplosionTime = 0.72f;
 constexpr float kPlaneRespawnDelay = 1.45f;
-
-struct TrackingInput {
-    bool leftValid = false;
-    float leftX = 0.5f;
-    float leftY = 0.5f;
-    bool rightValid = false;
-    bool rightPinch = false;
-    double timestamp = 0.0;
-};
+constexpr std::array<int, 3> kSwarmSizes = {10, 100, 400};
+constexpr int kBenchPlanes = 400;
+
+// Turret servo: critically damped at kServoBandwidth with feed-forward of the aim
+// rate, so a steadily moving aim point is followed without lag.
+constexpr float kServoBandwidth = 24.0f;  // rad/s
+constexpr float kMaxSlewRate = 4.0f;      // rad/s
+
+// Shells fly in straight lines at kShellSpeed; the muzzle sits kBarrelLength out.
+constexpr float kShellSpeed = 150.0f;
+constexpr float kBarrelLength = 9.0f;
+constexpr int kMaxShells = 48;
+
+// Radar: noisy position fixes of every airborne plane at a fixed rate.
+constexpr float kRadarInterval = 0.05f;
+constexpr float kRadarSigma = 0.6f;
+constexpr float kTrackTimeout = 0.4f;
+
+// Aim assist locks the enemy track whose intercept point is nearest the hand's aim
+// within this cone.
+constexpr float kAssistCone = 7.0f * DEG2RAD;
+
+// Hand input is extrapolated by its age plus the transit delay above the fastest
+// packet seen, capped here; the floor on transit drifts up this fast so a clock
+// drift or a route change is followed.
+constexpr float kMaxInputLead = 0.10f;
+constexpr double kTransitFloorDrift = 0.002;
+
+constexpr float kGridLo[3] = {-96.0f, -8.0f, -56.0f};
+constexpr float kGridHi[3] = {96.0f, 56.0f, 56.0f};
+constexpr float kGridCell = 8.0f;
 
 struct Plane {
     Vector3 pos{};
-    float speed = 0.0f;
+    float speed = 0.0f;  // along x
+    float drift = 0.0f;  // along z
+    float baseY = 0.0f;
+    float weaveAmplitude = 0.0f;
+    float weaveRate = 0.0f;
+    float weavePhase = 0.0f;
     float size = 1.5f;
     bool enemy = false;
     bool alive = true;
@@ -61,17 +86,16 @@ struct Plane {
     float respawnAt = 0.0f;
 };
 
-struct ShotFx {
+struct Shell {
     bool active = false;
-    bool hit = false;
-    float until = 0.0f;
-    Vector3 from{};
-    Vector3 to{};
+    Vector3 pos{};
+    Vector3 vel{};
+    float travelled = 0.0f;
 };
 
 float RandomRange(float minV, float maxV) {
-    const float u = static_cast<float>(GetRandomValue(0, 10000)) / 10000.0f;
-    return minV + (maxV - minV) * u;
+    static astro_random::PhiloxStream rng(kPlaneSeed);
+    return rng.Uniform(minV, maxV);
 }
 
 float NormalizeAngle(float a) {
@@ -83,143 +107,513 @@ float LerpAngle(float from, float to, float alpha) {
     return NormalizeAngle(from + delta * alpha);
 }
 
+float HitRadius(const Plane &plane) {
+    return 1.15f * plane.size + 0.85f;
+}
+
 void SpawnPlane(Plane &plane, int direction) {
     plane.size = RandomRange(1.35f, 2.15f);
     plane.speed = RandomRange(15.0f, 24.0f) * static_cast<float>(direction);
+    plane.drift = RandomRange(-3.0f, 3.0f);
     plane.pos.x = (direction > 0) ? -78.0f : 78.0f;
-    plane.pos.y = RandomRange(8.0f, 22.0f);
+    plane.baseY = RandomRange(8.0f, 22.0f);
+    plane.weaveAmplitude = RandomRange(0.0f, 3.0f);
+    plane.weaveRate = RandomRange(0.4f, 1.2f);
+    plane.weavePhase = RandomRange(0.0f, 2.0f * PI);
+    plane.pos.y = plane.baseY + plane.weaveAmplitude * std::sin(plane.weavePhase);
     plane.pos.z = RandomRange(-30.0f, 30.0f);
     plane.alive = true;
     plane.explosionUntil = 0.0f;
     plane.respawnAt = 0.0f;
 }
 
-void InitPlanes(std::vector<Plane> &planes) {
+// Planes start spread along their lanes so a large swarm does not arrive as one wave.
+void InitPlanes(std::vector<Plane> &planes, int count) {
     planes.clear();
-    planes.reserve(10);
-    for (int i = 0; i < 10; ++i) {
+    planes.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
         Plane plane{};
         plane.enemy = (i % 2 == 1);
         const int direction = (i % 2 == 0) ? 1 : -1;
         SpawnPlane(plane, direction);
-        plane.pos.z += (i - 5) * 1.6f;
+        plane.pos.x = RandomRange(-78.0f, 78.0f);
         planes.push_back(plane);
     }
 }
 
-void DrawPlane3D(const Plane &plane) {
-    const Color body = plane.enemy ? Color{230, 70, 72, 255} : Color{72, 132, 236, 255};
-    const Color wing = plane.enemy ? Color{190, 60, 62, 255} : Color{62, 112, 196, 255};
-    const Color glass = Color{220, 236, 255, 255};
-    const float nose = (plane.speed >= 0.0f) ? 1.0f : -1.0f;
-    const Vector3 p = plane.pos;
-    const float s = plane.size;
-
-    DrawCube({p.x - 1.2f * s * nose, p.y, p.z}, 1.8f * s, 0.45f * s, 0.55f * s, body);
-    DrawCube({p.x - 2.0f * s * nose, p.y + 0.1f * s, p.z}, 0.8f * s, 0.36f * s, 2.6f * s, wing);
-    DrawCube({p.x - 0.35f * s * nose, p.y + 0.05f * s, p.z}, 1.1f * s, 0.25f * s, 0.44f * s, glass);
-    DrawSphere({p.x + 0.05f * s * nose, p.y, p.z}, 0.3f * s, body);
+void MovePlanes(std::vector<Plane> &planes, float now, float dt) {
+    for (Plane &plane : planes) {
+        if (plane.alive) {
+            plane.pos.x += plane.speed * dt;
+            plane.pos.z += plane.drift * dt;
+            plane.weavePhase += plane.weaveRate * dt;
+            plane.pos.y = plane.baseY + plane.weaveAmplitude * std::sin(plane.weavePhase);
+            if ((plane.speed > 0.0f && plane.pos.x > 88.0f) || (plane.speed < 0.0f && plane.pos.x < -88.0f)) {
+                SpawnPlane(plane, (plane.speed >= 0.0f) ? 1 : -1);
+            }
+        } else if (now >= plane.respawnAt) {
+            SpawnPlane(plane, (plane.speed >= 0.0f) ? 1 : -1);
+        }
+    }
 }
 
-class UdpBridgeReceiver {
+// Critically damped second-order follower. Over one frame the target is taken to move
+// at its reported rate, which the servo state is solved for exactly, so the response
+// does not depend on the frame rate.
+struct AimServo {
+    float angle = 0.0f;
+    float rate = 0.0f;
+
+    void Update(float target, float targetRate, float dt, bool wrap) {
+        const float start = target - targetRate * dt;
+        float e = angle - start;
+        if (wrap) e = NormalizeAngle(e);
+        const float de = rate - targetRate;
+        const float decay = std::exp(-kServoBandwidth * dt);
+        const float eNext = (e + (de + kServoBandwidth * e) * dt) * decay;
+        const float deNext = (de - kServoBandwidth * (de + kServoBandwidth * e) * dt) * decay;
+        rate = std::clamp(targetRate + deNext, -kMaxSlewRate, kMaxSlewRate);
+        const float next = target + eNext;
+        const float step = std::clamp(wrap ? NormalizeAngle(next - angle) : next - angle, -kMaxSlewRate * dt, kMaxSlewRate * dt);
+        angle = wrap ? NormalizeAngle(angle + step) : angle + step;
+    }
+};
+
+// Turns timestamped bridge samples into an input estimate for the current frame. The
+// sender clock is unrelated to ours, so transit time is measured against the fastest
+// packet seen: what exceeds that floor is queueing and jitter, and it is added to the
+// sample's age when extrapolating.
+class InputPredictor {
   public:
-    bool Start(uint16_t port) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return false;
-#endif
-        socket_ = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
-        if (socket_ < 0) return false;
-
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        addr.sin_port = htons(port);
-        if (bind(socket_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
-            Close();
-            return false;
+    void Push(const astro_hand::BridgeInput &input, double receivedAt) {
+        const double transit = receivedAt - input.timestamp;
+        if (count_ == 0) {
+            transitFloor_ = transit;
+        } else {
+            transitFloor_ = std::min(transitFloor_ + kTransitFloorDrift * (receivedAt - latest_.receivedAt), transit);
         }
+        previous_ = latest_;
+        latest_.input = input;
+        latest_.receivedAt = receivedAt;
+        latest_.count = ++count_;
+        excessTransit_ = static_cast<float>(transit - transitFloor_);
+    }
 
-#ifdef _WIN32
-        u_long mode = 1;
-        if (ioctlsocket(socket_, FIONBIO, &mode) != 0) {
-            Close();
-            return false;
-        }
-#else
-        const int flags = fcntl(socket_, F_GETFL, 0);
-        if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0) {
-            Close();
-            return false;
-        }
-#endif
-        ready_ = true;
+    bool ready() const { return count_ > 0; }
+    double lastReceivedAt() const { return latest_.receivedAt; }
+    // Seconds the last estimate was extrapolated by.
+    float lead() const { return lead_; }
+    float excessTransit() const { return excessTransit_; }
+
+    astro_hand::BridgeInput Predict(double now, float extraLatency) {
+        lead_ = std::clamp(static_cast<float>(now - latest_.receivedAt) + excessTransit_ + extraLatency, 0.0f, kMaxInputLead);
+        if (previous_.count == 0) return latest_.input;
+        return astro_hand::ExtrapolateBridgeInput(previous_.input, latest_.input, lead_);
+    }
+
+  private:
+    astro_hand::BridgeSample latest_{};
+    astro_hand::BridgeSample previous_{};
+    uint64_t count_ = 0;
+    double transitFloor_ = 0.0;
+    float excessTransit_ = 0.0f;
+    float lead_ = 0.0f;
+};
+
+// Receives bridge datagrams on a thread that sleeps in poll(), so each one is stamped
+// when it arrives rather than when the next frame gets to it.
+class BridgeLink {
+  public:
+    bool Start(uint16_t port) {
+        if (!receiver_.Start(port)) return false;
+        thread_ = std::thread([this]() { NetworkLoop(); });
         return true;
     }
 
-    void Close() {
-        if (socket_ >= 0) {
-#ifdef _WIN32
-            closesocket(socket_);
-            WSACleanup();
-#else
-            close(socket_);
-#endif
-            socket_ = -1;
+    void Stop() {
+        stop_.store(true);
+        if (thread_.joinable()) thread_.join();
+        receiver_.Close();
+    }
+
+    ~BridgeLink() {
+        Stop();
+    }
+
+    bool ready() const { return receiver_.ready(); }
+
+    // Feeds a fresh sample, when there is one, into `predictor`.
+    bool Drain(InputPredictor &predictor) {
+        if (!slot_.Acquire()) return false;
+        const astro_hand::BridgeSample &sample = slot_.ReadBuffer();
+        predictor.Push(sample.input, sample.receivedAt);
+        return true;
+    }
+
+  private:
+    void NetworkLoop() {
+        astro_hand::BridgeInput input{};
+        uint64_t count = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            astro_hand::WaitForSockets(receiver_.socketHandle(), -1, 20);
+            int packetsRead = 0;
+            if (receiver_.Poll(input, packetsRead)) {
+                astro_hand::BridgeSample &sample = slot_.WriteBuffer();
+                sample.input = input;
+                sample.receivedAt = astro_hand::SteadySeconds();
+                sample.count = ++count;
+                slot_.Publish();
+            }
         }
-        ready_ = false;
     }
 
-    bool Poll(TrackingInput &outInput, int &packetsRead) {
-        packetsRead = 0;
-        if (!ready_) return false;
-        bool gotAny = false;
-        std::array<char, 256> buffer{};
-
-        while (true) {
-            sockaddr_in src{};
-            socklen_t srcLen = sizeof(src);
-            const int n = recvfrom(socket_, buffer.data(), static_cast<int>(buffer.size()) - 1, 0,
-                                   reinterpret_cast<sockaddr *>(&src), &srcLen);
-            if (n <= 0) {
-#ifdef _WIN32
-                if (WSAGetLastError() == WSAEWOULDBLOCK) break;
-#else
-                if (errno == EWOULDBLOCK || errno == EAGAIN) break;
-#endif
-                break;
+    astro_hand::UdpBridgeReceiver receiver_{};
+    std::thread thread_{};
+    std::atomic<bool> stop_{false};
+    astro_hand::TripleBuffer<astro_hand::BridgeSample> slot_{};
+};
+
+// Hand position to turret angles. The rear-aim hysteresis is stateful, so this
+// carries its own blend.
+struct HandAim {
+    bool rearMode = false;
+    float rearBlend = 0.0f;
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+
+    void Update(const astro_hand::BridgeInput &input, float dt) {
+        if (!input.leftValid) return;
+        const float yNorm = std::clamp(1.0f - input.leftY, 0.0f, 1.0f);
+        const float xNorm = std::clamp((input.leftX - 0.5f) * 2.0f, -1.0f, 1.0f);
+        if (!rearMode && yNorm >= kRearAimEnterY) {
+            rearMode = true;
+        } else if (rearMode && yNorm <= kRearAimExitY) {
+            rearMode = false;
+        }
+        rearBlend = Lerp(rearBlend, rearMode ? 1.0f : 0.0f, 1.0f - std::exp(-kRearAimBlendRate * dt));
+        yaw = NormalizeAngle(xNorm * kMaxYaw + rearBlend * PI);
+        pitch = std::clamp(kMinPitch + (kMaxPitch - kMinPitch) * yNorm, kMinPitch, kMaxPitch);
+    }
+};
+
+Vector3 AimDirection(float yaw, float pitch) {
+    return Vector3Normalize({std::sin(yaw) * std::cos(pitch), std::sin(pitch), std::cos(yaw) * std::cos(pitch)});
+}
+
+// Radar, tracks, intercepts and shells for one swarm.
+class FireControl {
+  public:
+    FireControl() : grid_(kGridLo, kGridHi, kGridCell), radarNoise_(kRadarSeed) {}
+
+    void Reset(int planes) {
+        bank_.Resize(planes);
+        nextScan_ = 0.0f;
+        lock_ = -1;
+        for (Shell &shell : shells_) shell.active = false;
+    }
+
+    const astro_track::TrackBank &bank() const { return bank_; }
+    const astro_track::InterceptSolution &intercepts() const { return intercepts_; }
+    const std::array<Shell, kMaxShells> &shells() const { return shells_; }
+    int lock() const { return lock_; }
+    float solveMs() const { return solveMs_; }
+    int gridEntries() const { return grid_.entries(); }
+
+    // Radar scans due by `now`, then prediction to `now` and the intercept solve.
+    void UpdateTracks(const std::vector<Plane> &planes, float now, float dt, const Vector3 &pivot) {
+        const auto t0 = std::chrono::steady_clock::now();
+        bank_.Predict(dt);
+        if (now >= nextScan_) {
+            nextScan_ = std::max(nextScan_ + kRadarInterval, now);
+            for (int i = 0; i < static_cast<int>(planes.size()); ++i) {
+                const Plane &plane = planes[static_cast<size_t>(i)];
+                if (!plane.alive) continue;
+                bank_.Update(i, plane.pos.x + kRadarSigma * radarNoise_.Normal(), plane.pos.y + kRadarSigma * radarNoise_.Normal(),
+                             plane.pos.z + kRadarSigma * radarNoise_.Normal());
             }
+        }
+        bank_.DropStale(kTrackTimeout);
+        const float origin[3] = {pivot.x, pivot.y, pivot.z};
+        astro_track::SolveIntercepts(bank_, origin, kShellSpeed, 0.0f, &intercepts_);
+        solveMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
 
-            buffer[static_cast<size_t>(n)] = '\0';
-            TrackingInput parsed{};
-            int lv = 0;
-            int rv = 0;
-            int rp = 0;
-            if (std::sscanf(buffer.data(), "%lf,%d,%f,%f,%d,%d",
-                            &parsed.timestamp, &lv, &parsed.leftX, &parsed.leftY, &rv, &rp) == 6) {
-                parsed.leftValid = (lv != 0);
-                parsed.rightValid = (rv != 0);
-                parsed.rightPinch = (rp != 0);
-                parsed.leftX = std::clamp(parsed.leftX, 0.0f, 1.0f);
-                parsed.leftY = std::clamp(parsed.leftY, 0.0f, 1.0f);
-                outInput = parsed;
-                gotAny = true;
-                packetsRead++;
+    // The enemy track whose intercept point is nearest `aim` within the assist cone.
+    int SelectLock(const std::vector<Plane> &planes, const Vector3 &pivot, const Vector3 &aim) {
+        lock_ = -1;
+        float best = std::cos(kAssistCone);
+        for (int i = 0; i < bank_.size(); ++i) {
+            const float t = intercepts_.time[static_cast<size_t>(i)];
+            if (t < 0.0f || t * kShellSpeed > kShotRange || !planes[static_cast<size_t>(i)].enemy || bank_.updates(i) < 3) continue;
+            const Vector3 to = Vector3Normalize(Vector3Subtract(InterceptPoint(i), pivot));
+            const float c = Vector3DotProduct(to, aim);
+            if (c > best) {
+                best = c;
+                lock_ = i;
             }
         }
-        return gotAny;
+        return lock_;
     }
 
-    bool ready() const { return ready_; }
+    Vector3 InterceptPoint(int i) const {
+        const size_t k = static_cast<size_t>(i);
+        return {intercepts_.point[0][k], intercepts_.point[1][k], intercepts_.point[2][k]};
+    }
+
+    void Fire(const Vector3 &pivot, const Vector3 &dir) {
+        for (Shell &shell : shells_) {
+            if (shell.active) continue;
+            shell.active = true;
+            shell.pos = Vector3Add(pivot, Vector3Scale(dir, kBarrelLength));
+            shell.vel = Vector3Scale(dir, kShellSpeed);
+            shell.travelled = kBarrelLength;
+            return;
+        }
+    }
+
+    // Moves the shells and tests each frame's path against the planes through the grid.
+    // `onHit(i)` is called for the nearest plane along each shell's path.
+    template <typename OnHit>
+    void UpdateShells(const std::vector<Plane> &planes, float dt, OnHit &&onHit) {
+        const size_t n = planes.size();
+        px_.resize(n);
+        py_.resize(n);
+        pz_.resize(n);
+        radius_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            px_[i] = planes[i].pos.x;
+            py_[i] = planes[i].pos.y;
+            pz_[i] = planes[i].pos.z;
+            radius_[i] = planes[i].alive ? HitRadius(planes[i]) : 0.0f;
+        }
+        grid_.Build(static_cast<int>(n), px_.data(), py_.data(), pz_.data(), radius_.data());
+
+        for (Shell &shell : shells_) {
+            if (!shell.active) continue;
+            const float a[3] = {shell.pos.x, shell.pos.y, shell.pos.z};
+            const float b[3] = {shell.pos.x + shell.vel.x * dt, shell.pos.y + shell.vel.y * dt, shell.pos.z + shell.vel.z * dt};
+            int bestIdx = -1;
+            float bestT = 2.0f;
+            grid_.QuerySegment(a, b, [&](int i) {
+                const float center[3] = {px_[static_cast<size_t>(i)], py_[static_cast<size_t>(i)], pz_[static_cast<size_t>(i)]};
+                const float t = astro_track::SegmentSphereHit(a, b, center, radius_[static_cast<size_t>(i)]);
+                if (t >= 0.0f && t < bestT && planes[static_cast<size_t>(i)].alive) {
+                    bestT = t;
+                    bestIdx = i;
+                }
+                return true;
+            });
+            if (bestIdx >= 0) {
+                shell.active = false;
+                radius_[static_cast<size_t>(bestIdx)] = 0.0f;
+                onHit(bestIdx);
+                continue;
+            }
+            shell.pos = {b[0], b[1], b[2]};
+            shell.travelled += kShellSpeed * dt;
+            if (shell.travelled > kShotRange || shell.pos.y < 0.0f) shell.active = false;
+        }
+    }
 
   private:
-    int socket_ = -1;
-    bool ready_ = false;
+    astro_track::TrackBank bank_{astro_track::FilterOptions{kRadarSigma, 6.0f, 30.0f, 6.0f}};
+    astro_track::InterceptSolution intercepts_;
+    astro_track::SphereGrid grid_;
+    astro_random::PhiloxStream radarNoise_;
+    std::array<Shell, kMaxShells> shells_{};
+    std::vector<float> px_, py_, pz_, radius_;
+    float nextScan_ = 0.0f;
+    int lock_ = -1;
+    float solveMs_ = 0.0f;
+};
+
+// Where the turret points this frame: the locked intercept point, or the hand aim.
+// The aim rate for the servo's feed-forward is differenced from the previous target
+// and dropped when the lock changes.
+struct AimTarget {
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    float yawRate = 0.0f;
+    float pitchRate = 0.0f;
+    int lock = -1;
+    bool primed = false;
+
+    void Update(float newYaw, float newPitch, int newLock, float dt) {
+        if (primed && newLock == lock && dt > 0.0f) {
+            yawRate = std::clamp(NormalizeAngle(newYaw - yaw) / dt, -kMaxSlewRate, kMaxSlewRate);
+            pitchRate = std::clamp((newPitch - pitch) / dt, -kMaxSlewRate, kMaxSlewRate);
+        } else {
+            yawRate = pitchRate = 0.0f;
+        }
+        yaw = newYaw;
+        pitch = newPitch;
+        lock = newLock;
+        primed = true;
+    }
 };
 
+void AnglesTo(const Vector3 &from, const Vector3 &to, float *yaw, float *pitch) {
+    const Vector3 d = Vector3Subtract(to, from);
+    *yaw = std::atan2(d.x, d.z);
+    *pitch = std::clamp(std::atan2(d.y, std::sqrt(d.x * d.x + d.z * d.z)), kMinPitch, kMaxPitch);
+}
+
+void DrawPlane3D(const Plane &plane) {
+    const Color body = plane.enemy ? Color{230, 70, 72, 255} : Color{72, 132, 236, 255};
+    const Color wing = plane.enemy ? Color{190, 60, 62, 255} : Color{62, 112, 196, 255};
+    const Color glass = Color{220, 236, 255, 255};
+    const float nose = (plane.speed >= 0.0f) ? 1.0f : -1.0f;
+    const Vector3 p = plane.pos;
+    const float s = plane.size;
+
+    DrawCube({p.x - 1.2f * s * nose, p.y, p.z}, 1.8f * s, 0.45f * s, 0.55f * s, body);
+    DrawCube({p.x - 2.0f * s * nose, p.y + 0.1f * s, p.z}, 0.8f * s, 0.36f * s, 2.6f * s, wing);
+    DrawCube({p.x - 0.35f * s * nose, p.y + 0.05f * s, p.z}, 1.1f * s, 0.25f * s, 0.44f * s, glass);
+    DrawSphere({p.x + 0.05f * s * nose, p.y, p.z}, 0.3f * s, body);
+}
+
+void DrawExplosion(const Plane &plane, float now) {
+    const float life = std::clamp((plane.explosionUntil - now) / kPlaneExplosionTime, 0.0f, 1.0f);
+    const float progress = 1.0f - life;
+    const int aCore = static_cast<int>(255.0f * life);
+    const int aWave = static_cast<int>(200.0f * life);
+    const float coreRadius = (0.9f + 1.2f * progress) * plane.size;
+    const float waveRadius = (1.8f + 4.6f * progress) * plane.size;
+
+    DrawSphere(plane.pos, coreRadius, Color{255, 232, 156, static_cast<unsigned char>(aCore)});
+    DrawSphereWires(plane.pos, waveRadius, 10, 12, Color{255, 120, 70, static_cast<unsigned char>(aWave)});
+
+    for (int j = 0; j < 8; ++j) {
+        const float jf = static_cast<float>(j);
+        const float ang = jf * PI / 4.0f + progress * 5.0f;
+        const float ring = (1.5f + progress * 3.8f) * plane.size;
+        const Vector3 spark{
+            plane.pos.x + std::cos(ang) * ring,
+            plane.pos.y + std::sin(ang * 1.7f) * 0.9f * plane.size,
+            plane.pos.z + std::sin(ang) * ring,
+        };
+        DrawSphere(spark, 0.22f * plane.size * life, Color{255, 170, 84, static_cast<unsigned char>(aCore)});
+        DrawLine3D(plane.pos, spark, Color{255, 136, 82, static_cast<unsigned char>(aWave)});
+    }
+}
+
+// --headless: a swarm under fire with a synthetic hand. The hand sweeps along a smooth
+// path and reaches the demo as 30 Hz samples with 35-55 ms transit. The old input path
+// (newest sample, first-order lag) and the new one (extrapolation, servo) steer two
+// turrets from the same samples, and their aim error against the hand's true
+// direction is reported. The new turret fires whenever it holds a lock.
+int RunTrackingBench(const astro_bench::BenchOptions &bench, int planeCount) {
+    constexpr double kSampleInterval = 1.0 / 30.0;
+    constexpr double kClockOffset = 5000.0;  // sender and receiver clocks disagree
+    std::vector<Plane> planes;
+    InitPlanes(planes, planeCount);
+    FireControl fire;
+    fire.Reset(planeCount);
+    const Vector3 pivot = {0.0f, 1.6f, 0.0f};
+
+    astro_random::PhiloxStream jitter(91);
+    InputPredictor predictor;
+    std::vector<std::pair<double, astro_hand::BridgeInput>> inFlight;
+    double nextSend = 0.0;
+    auto handAt = [](double t) {
+        astro_hand::BridgeInput input;
+        input.leftValid = true;
+        input.leftX = static_cast<float>(0.5 + 0.32 * std::sin(0.9 * t) + 0.08 * std::sin(2.3 * t));
+        input.leftY = static_cast<float>(0.45 + 0.18 * std::sin(0.6 * t + 1.0));
+        input.timestamp = t;
+        return input;
+    };
+
+    HandAim trueAim, oldAim, newAim;
+    AimServo yawServo, pitchServo;
+    AimTarget target;
+    float oldYaw = 0.0f, oldPitch = 0.0f;
+    double oldError2 = 0.0, newError2 = 0.0;
+    long errorSamples = 0, locks = 0;
+    int shots = 0, enemyKills = 0, friendlyHits = 0;
+    float lastShot = -10.0f;
+    double now = 0.0;
+    bool haveOld = false;
+    astro_hand::BridgeInput oldInput{};
+
+    return astro_bench::RunBench(
+        "defensive_sys_3d", bench,
+        [&](float dt) {
+            now += dt;
+            const float t = static_cast<float>(now);
+            while (nextSend <= now) {
+                const double arrive = nextSend + 0.035 + 0.02 * jitter.Uniform(0.0f, 1.0f);
+                inFlight.emplace_back(arrive + kClockOffset, handAt(nextSend));
+                nextSend += kSampleInterval;
+            }
+            for (size_t i = 0; i < inFlight.size();) {
+                if (inFlight[i].first <= now + kClockOffset) {
+                    predictor.Push(inFlight[i].second, inFlight[i].first);
+                    oldInput = inFlight[i].second;
+                    haveOld = true;
+                    inFlight.erase(inFlight.begin() + static_cast<std::ptrdiff_t>(i));
+                } else {
+                    ++i;
+                }
+            }
+            trueAim.Update(handAt(now), dt);
+            if (!haveOld) return;
+
+            oldAim.Update(oldInput, dt);
+            oldYaw = LerpAngle(oldYaw, oldAim.yaw, 1.0f - std::exp(-kTurretTurnRate * dt));
+            oldPitch = Lerp(oldPitch, oldAim.pitch, 1.0f - std::exp(-kTurretTurnRate * dt));
+            newAim.Update(predictor.Predict(now + kClockOffset, 0.0f), dt);
+            target.Update(newAim.yaw, newAim.pitch, -1, dt);
+            yawServo.Update(target.yaw, target.yawRate, dt, true);
+            pitchServo.Update(target.pitch, target.pitchRate, dt, false);
+            const Vector3 trueDir = AimDirection(trueAim.yaw, trueAim.pitch);
+            const float oldErr = std::acos(std::clamp(Vector3DotProduct(trueDir, AimDirection(oldYaw, oldPitch)), -1.0f, 1.0f));
+            const float newErr = std::acos(std::clamp(Vector3DotProduct(trueDir, AimDirection(yawServo.angle, pitchServo.angle)), -1.0f, 1.0f));
+            oldError2 += oldErr * oldErr;
+            newError2 += newErr * newErr;
+            ++errorSamples;
+
+            MovePlanes(planes, t, dt);
+            fire.UpdateTracks(planes, t, dt, pivot);
+            const int lock = fire.SelectLock(planes, pivot, AimDirection(yawServo.angle, pitchServo.angle));
+            if (lock >= 0) {
+                ++locks;
+                float yaw, pitch;
+                AnglesTo(pivot, fire.InterceptPoint(lock), &yaw, &pitch);
+                if (t - lastShot >= kShotCooldown) {
+                    lastShot = t;
+                    ++shots;
+                    fire.Fire(pivot, AimDirection(yaw, pitch));
+                }
+            }
+            fire.UpdateShells(planes, dt, [&](int i) {
+                Plane &hit = planes[static_cast<size_t>(i)];
+                hit.alive = false;
+                hit.respawnAt = t + kPlaneRespawnDelay;
+                (hit.enemy ? enemyKills : friendlyHits)++;
+            });
+        },
+        [&]() {
+            const double toDeg = 180.0 / 3.14159265358979;
+            std::fprintf(stderr,
+                         "%d planes: %d shots, %d enemy kills, %d friendly hits, locked %.0f%% of frames; "
+                         "rms aim error %.2f deg old path, %.2f deg new path; last input lead %.1f ms\n",
+                         planeCount, shots, enemyKills, friendlyHits, 100.0 * locks / std::max<long>(1, errorSamples),
+                         toDeg * std::sqrt(oldError2 / std::max<long>(1, errorSamples)),
+                         toDeg * std::sqrt(newError2 / std::max<long>(1, errorSamples)), 1000.0f * predictor.lead());
+            return static_cast<double>(enemyKills) + 1.0e-3 * friendlyHits;
+        });
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char **argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 1200, 1.0f / 120.0f);
+    if (bench.enabled) return RunTrackingBench(bench, std::max(1, astro_bench::IntArg(argc, argv, "--planes", kBenchPlanes)));
+    // Fixed latency ahead of the bridge timestamps (camera exposure, hand inference) to
+    // compensate as well, in milliseconds.
+    const float inputLatency = 1.0e-3f * std::max(0.0f, astro_bench::FloatArg(argc, argv, "--input-latency-ms", 0.0f));
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(kPreferredWindowWidth, kPreferredWindowHeight, "DefensiveSys 3D Turret + Planes (raylib)");
     SetTargetFPS(120);
@@ -239,23 +633,23 @@ int main() {
     cam.fovy = 50.0f;
     cam.projection = CAMERA_PERSPECTIVE;
 
-    UdpBridgeReceiver receiver;
-    const bool receiverOk = receiver.Start(static_cast<uint16_t>(kUdpPort));
-    TrackingInput tracking{};
-    double lastPacketWallClock = 0.0;
+    BridgeLink link;
+    link.Start(static_cast<uint16_t>(kUdpPort));
+    InputPredictor predictor;
+    astro_hand::BridgeInput tracking{};
 
+    int swarmIndex = 0;
     std::vector<Plane> planes;
-    InitPlanes(planes);
-
-    float turretYaw = 0.0f;
-    float turretPitch = 0.0f;
-    float targetYaw = 0.0f;
-    float targetPitch = 0.0f;
-    bool rearAimMode = false;
-    float rearAimBlend = 0.0f;
+    InitPlanes(planes, kSwarmSizes[0]);
+    FireControl fire;
+    fire.Reset(kSwarmSizes[0]);
+
+    HandAim handAim;
+    AimServo yawServo, pitchServo;
+    AimTarget aimTarget;
+    bool assist = true;
     bool prevRightPinch = false;
     float lastShotTime = -10.0f;
-    ShotFx shotFx{};
 
     int shots = 0;
     int enemyKills = 0;
@@ -265,89 +659,53 @@ int main() {
     while (!WindowShouldClose()) {
         const float now = static_cast<float>(GetTime());
         const float dt = GetFrameTime();
+        const double steadyNow = astro_hand::SteadySeconds();
 
-        int packetsRead = 0;
-        if (receiver.Poll(tracking, packetsRead)) {
-            lastPacketWallClock = static_cast<double>(now);
+        if (IsKeyPressed(KEY_N)) {
+            swarmIndex = (swarmIndex + 1) % static_cast<int>(kSwarmSizes.size());
+            InitPlanes(planes, kSwarmSizes[static_cast<size_t>(swarmIndex)]);
+            fire.Reset(kSwarmSizes[static_cast<size_t>(swarmIndex)]);
+            aimTarget.primed = false;
         }
-        const bool linkLive = receiver.ready() && ((now - static_cast<float>(lastPacketWallClock)) < 0.60f);
-
-        if (tracking.leftValid) {
-            const float yNorm = std::clamp(1.0f - tracking.leftY, 0.0f, 1.0f);
-            const float xNorm = std::clamp((tracking.leftX - 0.5f) * 2.0f, -1.0f, 1.0f);
-
-            if (!rearAimMode && yNorm >= kRearAimEnterY) {
-                rearAimMode = true;
-            } else if (rearAimMode && yNorm <= kRearAimExitY) {
-                rearAimMode = false;
-            }
-            const float rearTarget = rearAimMode ? 1.0f : 0.0f;
-            rearAimBlend = Lerp(rearAimBlend, rearTarget, 1.0f - std::exp(-kRearAimBlendRate * dt));
+        if (IsKeyPressed(KEY_L)) assist = !assist;
 
-            const float baseYaw = xNorm * kMaxYaw;
-            targetYaw = NormalizeAngle(baseYaw + rearAimBlend * PI);
-            targetPitch = kMinPitch + (kMaxPitch - kMinPitch) * yNorm;
-            targetPitch = std::clamp(targetPitch, kMinPitch, kMaxPitch);
-        }
-        turretYaw = LerpAngle(turretYaw, targetYaw, 1.0f - std::exp(-kTurretTurnRate * dt));
-        turretPitch = Lerp(turretPitch, targetPitch, 1.0f - std::exp(-kTurretPitchRate * dt));
+        link.Drain(predictor);
+        if (predictor.ready()) tracking = predictor.Predict(steadyNow, inputLatency);
+        const bool linkLive = link.ready() && predictor.ready() && (steadyNow - predictor.lastReceivedAt()) < astro_hand::kLinkTimeout;
+        handAim.Update(tracking, dt);
 
         const Vector3 turretPivot = {0.0f, 1.6f, 0.0f};
-        Vector3 fireDir = {
-            std::sin(turretYaw) * std::cos(turretPitch),
-            std::sin(turretPitch),
-            std::cos(turretYaw) * std::cos(turretPitch),
-        };
-        fireDir = Vector3Normalize(fireDir);
-        const Vector3 muzzle = Vector3Add(turretPivot, Vector3Scale(fireDir, 9.0f));
-
-        for (Plane &plane : planes) {
-            if (plane.alive) {
-                plane.pos.x += plane.speed * dt;
-                if ((plane.speed > 0.0f && plane.pos.x > 88.0f) || (plane.speed < 0.0f && plane.pos.x < -88.0f)) {
-                    SpawnPlane(plane, (plane.speed >= 0.0f) ? 1 : -1);
-                }
-            } else if (now >= plane.respawnAt) {
-                SpawnPlane(plane, (plane.speed >= 0.0f) ? 1 : -1);
-            }
+        MovePlanes(planes, now, dt);
+        {
+            ASTRO_PROFILE_SCOPE("tracking");
+            fire.UpdateTracks(planes, now, dt, turretPivot);
         }
+        const int lock = assist ? fire.SelectLock(planes, turretPivot, AimDirection(handAim.yaw, handAim.pitch)) : -1;
+        float aimYaw = handAim.yaw, aimPitch = handAim.pitch;
+        if (lock >= 0) AnglesTo(turretPivot, fire.InterceptPoint(lock), &aimYaw, &aimPitch);
+        aimTarget.Update(aimYaw, aimPitch, lock, dt);
+        yawServo.Update(aimTarget.yaw, aimTarget.yawRate, dt, true);
+        pitchServo.Update(aimTarget.pitch, aimTarget.pitchRate, dt, false);
+
+        const Vector3 fireDir = AimDirection(yawServo.angle, pitchServo.angle);
+        const Vector3 muzzle = Vector3Add(turretPivot, Vector3Scale(fireDir, kBarrelLength));
 
         const bool rightPinch = tracking.rightValid && tracking.rightPinch;
         if (rightPinch && !prevRightPinch && (now - lastShotTime >= kShotCooldown)) {
             shots++;
             lastShotTime = now;
-            shotFx.active = true;
-            shotFx.hit = false;
-            shotFx.until = now + kShotFxTime;
-            shotFx.from = muzzle;
-            shotFx.to = Vector3Add(muzzle, Vector3Scale(fireDir, kShotRange));
-
-            int bestIdx = -1;
-            float bestT = 1e9f;
-            for (int i = 0; i < static_cast<int>(planes.size()); ++i) {
-                const Plane &plane = planes[static_cast<size_t>(i)];
-                if (!plane.alive) continue;
-
-                const Vector3 rel = Vector3Subtract(plane.pos, muzzle);
-                const float t = Vector3DotProduct(rel, fireDir);
-                if (t < 0.0f || t > kShotRange) continue;
-
-                const Vector3 closest = Vector3Add(muzzle, Vector3Scale(fireDir, t));
-                const float dist = Vector3Distance(closest, plane.pos);
-                const float hitRadius = 1.15f * plane.size + 0.85f;
-                if (dist <= hitRadius && t < bestT) {
-                    bestT = t;
-                    bestIdx = i;
-                }
-            }
+            fire.Fire(turretPivot, fireDir);
+            lastEvent = lock >= 0 ? "fired on lock" : "fired";
+        }
+        prevRightPinch = rightPinch;
 
-            if (bestIdx >= 0) {
-                Plane &hit = planes[static_cast<size_t>(bestIdx)];
+        {
+            ASTRO_PROFILE_SCOPE("shells");
+            fire.UpdateShells(planes, dt, [&](int i) {
+                Plane &hit = planes[static_cast<size_t>(i)];
                 hit.alive = false;
                 hit.explosionUntil = now + kPlaneExplosionTime;
                 hit.respawnAt = now + kPlaneRespawnDelay;
-                shotFx.hit = true;
-                shotFx.to = hit.pos;
                 if (hit.enemy) {
                     enemyKills++;
                     lastEvent = "enemy down";
@@ -355,11 +713,8 @@ int main() {
                     friendlyHits++;
                     lastEvent = "friendly hit";
                 }
-            } else {
-                lastEvent = "miss";
-            }
+            });
         }
-        prevRightPinch = rightPinch;
 
         BeginDrawing();
         ClearBackground(Color{14, 18, 26, 255});
@@ -372,68 +727,70 @@ int main() {
             if (plane.alive) {
                 DrawPlane3D(plane);
             } else if (now < plane.explosionUntil) {
-                const float life = std::clamp((plane.explosionUntil - now) / kPlaneExplosionTime, 0.0f, 1.0f);
-                const float progress = 1.0f - life;
-                const int aCore = static_cast<int>(255.0f * life);
-                const int aWave = static_cast<int>(200.0f * life);
-                const float coreRadius = (0.9f + 1.2f * progress) * plane.size;
-                const float waveRadius = (1.8f + 4.6f * progress) * plane.size;
-
-                DrawSphere(plane.pos, coreRadius, Color{255, 232, 156, static_cast<unsigned char>(aCore)});
-                DrawSphereWires(plane.pos, waveRadius, 10, 12, Color{255, 120, 70, static_cast<unsigned char>(aWave)});
-
-                for (int j = 0; j < 8; ++j) {
-                    const float jf = static_cast<float>(j);
-                    const float ang = jf * PI / 4.0f + progress * 5.0f;
-                    const float ring = (1.5f + progress * 3.8f) * plane.size;
-                    const Vector3 spark{
-                        plane.pos.x + std::cos(ang) * ring,
-                        plane.pos.y + std::sin(ang * 1.7f) * 0.9f * plane.size,
-                        plane.pos.z + std::sin(ang) * ring,
-                    };
-                    DrawSphere(spark, 0.22f * plane.size * life, Color{255, 170, 84, static_cast<unsigned char>(aCore)});
-                    DrawLine3D(plane.pos, spark, Color{255, 136, 82, static_cast<unsigned char>(aWave)});
-                }
+                DrawExplosion(plane, now);
             }
         }
 
+        // Tracks: estimated position and half a second of estimated velocity.
+        const astro_track::TrackBank &bank = fire.bank();
+        for (int i = 0; i < bank.size(); ++i) {
+            if (!bank.valid(i)) continue;
+            const Vector3 p = {bank.pos(0, i), bank.pos(1, i), bank.pos(2, i)};
+            const Vector3 v = {bank.vel(0, i), bank.vel(1, i), bank.vel(2, i)};
+            DrawLine3D(p, Vector3Add(p, Vector3Scale(v, 0.5f)), Color{120, 230, 210, 150});
+        }
+        if (lock >= 0) {
+            const Vector3 lead = fire.InterceptPoint(lock);
+            const Vector3 p = {bank.pos(0, lock), bank.pos(1, lock), bank.pos(2, lock)};
+            DrawSphereWires(lead, 1.6f, 8, 10, Color{255, 214, 96, 220});
+            DrawLine3D(p, lead, Color{255, 214, 96, 160});
+        }
+
         DrawCylinder({0.0f, 0.7f, 0.0f}, 2.6f, 2.8f, 1.4f, 24, Color{70, 78, 90, 255});
         DrawCylinder({0.0f, 1.45f, 0.0f}, 1.75f, 1.85f, 0.95f, 24, Color{96, 106, 118, 255});
         DrawCylinderEx(turretPivot, muzzle, 0.50f, 0.42f, 12, Color{142, 154, 170, 255});
         DrawSphere(muzzle, 0.48f, Color{212, 222, 236, 255});
 
-        if (shotFx.active && now <= shotFx.until) {
-            const Color c = shotFx.hit ? Color{120, 246, 176, 255} : Color{120, 196, 255, 255};
-            DrawLine3D(shotFx.from, shotFx.to, c);
-            DrawSphere(shotFx.to, shotFx.hit ? 0.65f : 0.35f, c);
-        } else {
-            shotFx.active = false;
+        for (const Shell &shell : fire.shells()) {
+            if (!shell.active) continue;
+            DrawSphere(shell.pos, 0.35f, Color{120, 196, 255, 255});
+            DrawLine3D(shell.pos, Vector3Subtract(shell.pos, Vector3Scale(shell.vel, 0.04f)), Color{120, 196, 255, 200});
         }
         EndMode3D();
 
         const int screenW = GetScreenWidth();
         const int screenH = GetScreenHeight();
-        const int hudHeight = 94;
+        const int hudHeight = 118;
         const int hudY = std::max(0, screenH - hudHeight);
         DrawRectangle(0, hudY, screenW, hudHeight, Color{8, 10, 14, 190});
         DrawText("DefensiveSys 3D Bridge", 18, hudY + 10, 24, RAYWHITE);
 
         const char *linkText = linkLive ? "link:connected" : "link:waiting";
-        DrawText(TextFormat("%s  udp:%d  left:%s (%.2f, %.2f)  right:%s pinch:%s",
+        DrawText(TextFormat("%s  udp:%d  left:%s (%.2f, %.2f)  right:%s pinch:%s  input lead:%.0f ms (jitter %.0f ms)",
                             linkText, kUdpPort,
                             tracking.leftValid ? "ok" : "none", tracking.leftX, tracking.leftY,
                             tracking.rightValid ? "ok" : "none",
-                            rightPinch ? "down" : "up"),
+                            rightPinch ? "down" : "up", 1000.0f * predictor.lead(), 1000.0f * predictor.excessTransit()),
                  18, hudY + 38, 18, Color{186, 206, 232, 255});
 
+        int tracks = 0;
+        for (int i = 0; i < bank.size(); ++i) tracks += bank.valid(i) ? 1 : 0;
+        DrawText(TextFormat("planes:%d  tracks:%d  grid entries:%d  track+solve:%.2f ms  assist:%s%s  [N] swarm  [L] assist",
+                            static_cast<int>(planes.size()), tracks, fire.gridEntries(), fire.solveMs(), assist ? "on" : "off",
+                            lock >= 0 ? TextFormat(" (lock, %.2f s to impact)", fire.intercepts().time[static_cast<size_t>(lock)]) : ""),
+                 18, hudY + 62, 18, Color{172, 196, 224, 255});
+
         DrawText(TextFormat("enemy kills:%d  friendly hits:%d  shots:%d  event:%s",
                             enemyKills, friendlyHits, shots, lastEvent.c_str()),
-                 18, hudY + 62, 18, Color{172, 196, 224, 255});
+                 18, hudY + 86, 18, Color{172, 196, 224, 255});
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
-    receiver.Close();
+    link.Stop();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
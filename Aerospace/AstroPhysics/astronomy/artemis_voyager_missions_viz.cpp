@@ -1,10 +1,18 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/chebyshev_ephemeris.h"
+#include "../common/frame_arena.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/starfield.h"
+#include "../common/world_coords.h"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdio>
+#include <memory_resource>
 #include <random>
 #include <string>
 #include <vector>
@@ -16,6 +24,21 @@ constexpr int kScreenHeight = 920;
 constexpr float kSceneExtent = 56.0f;
 constexpr int kStarCount = 520;
 constexpr int kTrailSamples = 220;
+constexpr float kCameraFovDeg = 45.0f;
+constexpr float kMoonOrbitRadius = 3.4f;    // scene units around Earth
+// Planets run from Voyager 2's launch (1977-08-20) at this many days per second.
+constexpr double kPlanetEpochJd = 2443375.5;
+constexpr double kPlanetDaysPerSecond = 23.4;
+
+// True-scale view (T): heliocentric km in doubles behind a floating origin.
+constexpr double kKmPerAu = 1.495978707e8;
+constexpr double kEarthMoonKm = 384400.0;
+constexpr double kSunRadiusKm = 695700.0;
+constexpr double kMoonRadiusKm = 1737.4;
+constexpr float kTrueViewUnits = 40.0f;     // camera distance from its target, render units
+constexpr float kTrueFarUnits = 900.0f;     // inside raylib's 1000-unit far plane
+constexpr double kTrueMinViewKm = 1.5e4;
+constexpr double kTrueMaxViewKm = 400.0 * kKmPerAu;
 
 struct OrbitCameraState {
     float yaw = 0.74f;
@@ -33,9 +56,8 @@ enum class FocusMode {
 
 struct Planet {
     const char* name = "";
-    float orbitRadius = 0.0f;
+    astro_ephem::Body body = astro_ephem::kBodyEarth;
     float orbitOmega = 0.0f;
-    float eccentricity = 0.0f;
     float radius = 0.0f;
     float phase = 0.0f;
     float tilt = 0.0f;
@@ -46,15 +68,10 @@ struct Planet {
     bool gasGiant = false;
     Color color{};
     Color accent{};
+    double radiusKm = 0.0;
     Vector3 pos{};
 };
 
-struct BackdropStar {
-    Vector3 pos{};
-    float size = 0.0f;
-    float twinkle = 0.0f;
-};
-
 struct MissionSample {
     Vector3 pos{};
     Vector3 tangent{};
@@ -103,13 +120,17 @@ Vector3 Bezier3(Vector3 a, Vector3 b, Vector3 c, Vector3 d, float t) {
     };
 }
 
-void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit, Vector3 desiredTarget) {
+void ApplyOrbitDrag(OrbitCameraState* orbit) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         const Vector2 delta = GetMouseDelta();
         orbit->yaw -= delta.x * 0.0038f;
         orbit->pitch += delta.y * 0.0038f;
         orbit->pitch = std::clamp(orbit->pitch, -1.24f, 1.24f);
     }
+}
+
+void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit, Vector3 desiredTarget) {
+    ApplyOrbitDrag(orbit);
 
     orbit->distance -= GetMouseWheelMove() * 1.4f;
     orbit->distance = std::clamp(orbit->distance, 8.0f, 96.0f);
@@ -124,53 +145,103 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit, Vector
     });
 }
 
-std::vector<BackdropStar> MakeBackdropStars() {
+// Pulse was 0.68 + 0.32 * sin(t * rate) on both size and alpha (0.16 + 0.60 * pulse),
+// i.e. size 0.68 * (1 + 0.47 sin) and alpha 0.568 * (1 + 0.34 sin).
+std::vector<astro_render::StarfieldStar> MakeBackdropStars() {
     std::mt19937 rng(71241);
-    std::vector<BackdropStar> stars;
+    std::vector<astro_render::StarfieldStar> stars;
     stars.reserve(kStarCount);
     for (int i = 0; i < kStarCount; ++i) {
         const float theta = RandRange(rng, 0.0f, 2.0f * PI);
         const float phi = RandRange(rng, -0.47f * PI, 0.47f * PI);
         const float radius = RandRange(rng, 62.0f, 92.0f);
-        stars.push_back({
-            {
-                radius * std::cos(phi) * std::cos(theta),
-                radius * std::sin(phi),
-                radius * std::cos(phi) * std::sin(theta),
-            },
-            RandRange(rng, 0.02f, 0.09f),
-            RandRange(rng, 0.5f, 4.0f),
-        });
+        const Vector3 pos = {
+            radius * std::cos(phi) * std::cos(theta),
+            radius * std::sin(phi),
+            radius * std::cos(phi) * std::sin(theta),
+        };
+        const float size = RandRange(rng, 0.02f, 0.09f);
+        const float rate = RandRange(rng, 0.5f, 4.0f);
+        stars.push_back({pos, 0.68f * size, Fade(WHITE, 0.568f), rate, 0.0f, 0.192f / 0.568f, 0.32f / 0.68f});
     }
     return stars;
 }
 
 std::vector<Planet> MakePlanets() {
     return {
-        {"Mercury", 5.2f, 1.05f, 0.16f, 0.22f, 0.8f, 0.01f, 0.12f, 0.02f, 0.0f, 0.0f, false, Color{188, 178, 164, 255}, Color{216, 204, 188, 255}},
-        {"Venus", 7.4f, 0.82f, 0.04f, 0.42f, 1.6f, -0.02f, 0.18f, 0.05f, 0.0f, 0.0f, false, Color{224, 188, 116, 255}, Color{244, 220, 156, 255}},
-        {"Earth", 10.0f, 0.62f, 0.02f, 0.68f, 2.5f, 0.12f, 0.26f, 0.08f, 0.0f, 0.0f, false, Color{96, 176, 255, 255}, Color{136, 224, 255, 255}},
-        {"Mars", 13.2f, 0.46f, 0.09f, 0.48f, 0.6f, 0.07f, 0.18f, 0.03f, 0.0f, 0.0f, false, Color{220, 120, 92, 255}, Color{246, 168, 122, 255}},
-        {"Jupiter", 20.4f, 0.19f, 0.05f, 1.55f, 0.4f, 0.07f, 0.70f, 0.12f, 0.0f, 0.0f, true, Color{228, 186, 146, 255}, Color{246, 220, 184, 255}},
-        {"Saturn", 29.5f, 0.13f, 0.04f, 1.32f, 1.5f, 0.05f, 0.58f, 0.11f, 2.05f, 2.95f, true, Color{224, 198, 128, 255}, Color{248, 228, 172, 255}},
-        {"Uranus", 38.8f, 0.09f, 0.03f, 1.08f, 2.1f, -0.04f, 0.42f, 0.08f, 0.0f, 0.0f, true, Color{146, 226, 236, 255}, Color{198, 248, 255, 255}},
-        {"Neptune", 47.0f, 0.07f, 0.02f, 1.04f, 2.9f, 0.03f, 0.44f, 0.08f, 0.0f, 0.0f, true, Color{92, 146, 242, 255}, Color{144, 186, 255, 255}},
+        {"Mercury", astro_ephem::kBodyMercury, 1.05f, 0.22f, 0.8f, 0.01f, 0.12f, 0.02f, 0.0f, 0.0f, false, Color{188, 178, 164, 255}, Color{216, 204, 188, 255}, 2439.7},
+        {"Venus", astro_ephem::kBodyVenus, 0.82f, 0.42f, 1.6f, -0.02f, 0.18f, 0.05f, 0.0f, 0.0f, false, Color{224, 188, 116, 255}, Color{244, 220, 156, 255}, 6051.8},
+        {"Earth", astro_ephem::kBodyEarth, 0.62f, 0.68f, 2.5f, 0.12f, 0.26f, 0.08f, 0.0f, 0.0f, false, Color{96, 176, 255, 255}, Color{136, 224, 255, 255}, 6371.0},
+        {"Mars", astro_ephem::kBodyMars, 0.46f, 0.48f, 0.6f, 0.07f, 0.18f, 0.03f, 0.0f, 0.0f, false, Color{220, 120, 92, 255}, Color{246, 168, 122, 255}, 3389.5},
+        {"Jupiter", astro_ephem::kBodyJupiter, 0.19f, 1.55f, 0.4f, 0.07f, 0.70f, 0.12f, 0.0f, 0.0f, true, Color{228, 186, 146, 255}, Color{246, 220, 184, 255}, 69911.0},
+        {"Saturn", astro_ephem::kBodySaturn, 0.13f, 1.32f, 1.5f, 0.05f, 0.58f, 0.11f, 2.05f, 2.95f, true, Color{224, 198, 128, 255}, Color{248, 228, 172, 255}, 58232.0},
+        {"Uranus", astro_ephem::kBodyUranus, 0.09f, 1.08f, 2.1f, -0.04f, 0.42f, 0.08f, 0.0f, 0.0f, true, Color{146, 226, 236, 255}, Color{198, 248, 255, 255}, 25362.0},
+        {"Neptune", astro_ephem::kBodyNeptune, 0.07f, 1.04f, 2.9f, 0.03f, 0.44f, 0.08f, 0.0f, 0.0f, true, Color{92, 146, 242, 255}, Color{144, 186, 255, 255}, 24622.0},
     };
 }
 
-void UpdatePlanets(std::vector<Planet>* planets, float time) {
-    for (Planet& planet : *planets) {
-        const float a = planet.phase + time * planet.orbitOmega;
-        const float radial = planet.orbitRadius * (1.0f - planet.eccentricity * planet.eccentricity) /
-            std::max(0.25f, 1.0f + planet.eccentricity * std::cos(a));
-        planet.pos = {
-            radial * std::cos(a),
-            planet.tilt * std::sin(a * 1.8f),
-            radial * std::sin(a),
-        };
+// Scene radius of each planet's semi-major axis, then the scene radius
+// of the Voyager end points against the heliopause crossings they stand for (about
+// 120 AU for both; the two end points sit at nearly the same scene radius).
+struct RadiusNode {
+    float scene;
+    double au;
+};
+
+constexpr std::array<RadiusNode, 10> kSceneRadiusToAu = {{
+    {0.0f, 0.0}, {5.2f, 0.387}, {7.4f, 0.723}, {10.0f, 1.0}, {13.2f, 1.524},
+    {20.4f, 5.203}, {29.5f, 9.537}, {38.8f, 19.19}, {47.0f, 30.07}, {60.9f, 121.6},
+}};
+
+double SceneRadiusToAu(float radius) {
+    size_t i = 1;
+    while (i + 1 < kSceneRadiusToAu.size() && radius > kSceneRadiusToAu[i].scene) ++i;
+    const RadiusNode& a = kSceneRadiusToAu[i - 1];
+    const RadiusNode& b = kSceneRadiusToAu[i];
+    return a.au + (b.au - a.au) * (radius - a.scene) / (b.scene - a.scene);
+}
+
+float AuToSceneRadius(double au) {
+    size_t i = 1;
+    while (i + 1 < kSceneRadiusToAu.size() && au > kSceneRadiusToAu[i].au) ++i;
+    const RadiusNode& a = kSceneRadiusToAu[i - 1];
+    const RadiusNode& b = kSceneRadiusToAu[i];
+    return a.scene + static_cast<float>((au - a.au) / (b.au - a.au)) * (b.scene - a.scene);
+}
+
+// A heliocentric ecliptic point in the stylised scene: same direction in the ecliptic
+// plane (ecliptic y along scene z, the scene's original sense of rotation) with the
+// radius mapped through kSceneRadiusToAu, so HeliocentricKm() undoes it exactly.
+Vector3 EclipticToScene(const astro_ephem::Vec3d& au) {
+    const double r = std::hypot(au.x, au.y);
+    if (r < 1.0e-9) return {};
+    const float scale = AuToSceneRadius(r) / static_cast<float>(r);
+    return {static_cast<float>(au.x) * scale, 0.0f, static_cast<float>(au.y) * scale};
+}
+
+double OrbitPeriodDays(astro_ephem::Body body) {
+    return 360.0 * 36525.0 / astro_ephem::kBodyElements[body]->meanLongitudeRate;
+}
+
+// One lap of the ephemeris path centred on `julianDate`, at segments + 1 points.
+template <typename PointFn>
+void ForEachOrbitPoint(const astro_ephem::ChebyshevEphemeris& ephemeris, astro_ephem::Body body, double julianDate,
+                       int segments, PointFn point) {
+    const double period = OrbitPeriodDays(body);
+    for (int i = 0; i <= segments; ++i) {
+        point(ephemeris.Position(body, julianDate + period * (static_cast<double>(i) / segments - 0.5)));
     }
 }
 
+
+// Heliocentric positions from the ephemeris; AnchorPlanetsToSpacetime() sets the
+// heights.
+void UpdatePlanets(const astro_ephem::ChebyshevEphemeris& ephemeris, double julianDate, std::vector<Planet>* planets) {
+    std::array<astro_ephem::Vec3d, astro_ephem::kBodyCount> au;
+    ephemeris.Positions(julianDate, &au);
+    for (Planet& planet : *planets) planet.pos = EclipticToScene(au[planet.body]);
+}
+
 const Planet& FindPlanet(const std::vector<Planet>& planets, const char* name) {
     for (const Planet& planet : planets) {
         if (std::string(planet.name) == name) return planet;
@@ -201,12 +272,11 @@ void AnchorPlanetsToSpacetime(std::vector<Planet>* planets, float time) {
 }
 
 Vector3 MakeMoonPosition(const Planet& earth, float time) {
-    const float moonRadius = 3.4f;
     const float a = time * 2.4f + 1.1f;
     Vector3 moon = Vector3Add(earth.pos, {
-        moonRadius * std::cos(a),
+        kMoonOrbitRadius * std::cos(a),
         0.55f * std::sin(a * 1.7f),
-        moonRadius * std::sin(a),
+        kMoonOrbitRadius * std::sin(a),
     });
     moon.y = earth.pos.y + 0.28f + 0.55f * std::sin(a * 1.7f);
     return moon;
@@ -633,17 +703,24 @@ MissionSample EvaluateVoyager2Mission(float t, const Planet& earth, const Planet
     return sample;
 }
 
+float TrailSampleT(int i) {
+    return static_cast<float>(i) / static_cast<float>(kTrailSamples - 1);
+}
+
+Color TrailColor(float t, float currentT, Color pastColor, Color futureColor) {
+    const float fadeT = std::pow(t, 0.72f);
+    return t <= currentT
+        ? Fade(pastColor, 0.25f + 0.65f * fadeT)
+        : Fade(futureColor, 0.06f + 0.16f * (1.0f - fadeT));
+}
+
 template <typename EvalFn>
 void DrawMissionTrail(EvalFn eval, float currentT, Color pastColor, Color futureColor) {
     Vector3 prev = eval(0.0f).pos;
     for (int i = 1; i < kTrailSamples; ++i) {
-        const float t = static_cast<float>(i) / static_cast<float>(kTrailSamples - 1);
+        const float t = TrailSampleT(i);
         const Vector3 cur = eval(t).pos;
-        const float fadeT = std::pow(t, 0.72f);
-        const Color color = t <= currentT
-            ? Fade(pastColor, 0.25f + 0.65f * fadeT)
-            : Fade(futureColor, 0.06f + 0.16f * (1.0f - fadeT));
-        DrawLine3D(prev, cur, color);
+        DrawLine3D(prev, cur, TrailColor(t, currentT, pastColor, futureColor));
         prev = cur;
     }
 }
@@ -715,20 +792,18 @@ void DrawPlanetVisual(const Planet& planet, float time) {
     }
 }
 
-void DrawProjectedOrbit(const Planet& planet, const std::vector<Planet>& planets, float time) {
+void DrawProjectedOrbit(const astro_ephem::ChebyshevEphemeris& ephemeris, double julianDate, const Planet& planet,
+                        const std::vector<Planet>& planets, float time) {
     constexpr int kSegments = 180;
     Vector3 prev{};
-    for (int i = 0; i <= kSegments; ++i) {
-        const float a = (2.0f * PI * i) / kSegments;
-        const float angle = planet.phase + a;
-        const float radial = planet.orbitRadius * (1.0f - planet.eccentricity * planet.eccentricity) /
-            std::max(0.25f, 1.0f + planet.eccentricity * std::cos(angle));
-        const float x = radial * std::cos(angle);
-        const float z = radial * std::sin(angle);
-        Vector3 cur = {x, SpacetimeHeightAtPoint(x, z, planets, time) + 0.02f, z};
-        if (i > 0) DrawLine3D(prev, cur, Fade(planet.accent, 0.12f));
+    bool first = true;
+    ForEachOrbitPoint(ephemeris, planet.body, julianDate, kSegments, [&](const astro_ephem::Vec3d& au) {
+        Vector3 cur = EclipticToScene(au);
+        cur.y = SpacetimeHeightAtPoint(cur.x, cur.z, planets, time) + 0.02f;
+        if (!first) DrawLine3D(prev, cur, Fade(planet.accent, 0.12f));
         prev = cur;
-    }
+        first = false;
+    });
 }
 
 void DrawVoyagerProbe(Vector3 pos, Vector3 tangent, Color color) {
@@ -796,7 +871,65 @@ void DrawPlanetLabel(const Camera3D& camera, Vector3 pos, const char* text, Colo
     DrawText(text, static_cast<int>(screen.x) + 6, static_cast<int>(screen.y) - 6, 18, color);
 }
 
-void SetFocus(FocusMode focus, OrbitCameraState* orbit) {
+const char* FocusName(FocusMode focus) {
+    switch (focus) {
+        case FocusMode::kOverview: return "Overview";
+        case FocusMode::kArtemis: return "Artemis II";
+        case FocusMode::kVoyager1: return "Voyager 1";
+        case FocusMode::kVoyager2: return "Voyager 2";
+    }
+    return "";
+}
+
+// A heliocentric scene point at its true distance: same direction from the Sun, with
+// the radius remapped through kSceneRadiusToAu.
+astro_world::WorldPos HeliocentricKm(Vector3 p) {
+    const float radius = Vector3Length(p);
+    if (radius < 1.0e-5f) return {};
+    return astro_world::FromVector3(p) * (SceneRadiusToAu(radius) * kKmPerAu / radius);
+}
+
+// Planets drop the stylised gravity-sheet height and sit in the ecliptic.
+astro_world::WorldPos PlanetKm(const Planet& planet) {
+    return HeliocentricKm({planet.pos.x, 0.0f, planet.pos.z});
+}
+
+// The Moon and the Artemis arcs keep their shape around Earth, scaled so the Moon
+// sits at the real Earth-Moon distance.
+astro_world::WorldPos EarthOffsetKm(const Planet& earth, Vector3 p) {
+    return PlanetKm(earth) + astro_world::FromVector3(Vector3Subtract(p, earth.pos)) * (kEarthMoonKm / kMoonOrbitRadius);
+}
+
+struct TrueScaleCraft {
+    astro_world::WorldPos moon;
+    astro_world::WorldPos artemis;
+    astro_world::WorldPos voyager1;
+    astro_world::WorldPos voyager2;
+};
+
+// Camera of the true-scale view. It orbits its target at kTrueViewUnits render units,
+// and zooming changes the render scale (viewKm / kTrueViewUnits) rather than the
+// camera distance, so the target always sits in well-conditioned float range.
+struct TrueView {
+    astro_world::FloatingOrigin origin;
+    astro_world::WorldPos target;
+    double viewKm = kTrueMaxViewKm;
+    double desiredViewKm = kTrueMaxViewKm;
+    Vector3 eye{};
+};
+
+double TrueViewKmForFocus(FocusMode focus) {
+    switch (focus) {
+        case FocusMode::kOverview: return 260.0 * kKmPerAu;
+        case FocusMode::kArtemis: return 1.6e6;
+        case FocusMode::kVoyager1:
+        case FocusMode::kVoyager2: return 6.0 * kKmPerAu;
+    }
+    return kTrueMaxViewKm;
+}
+
+void SetFocus(FocusMode focus, OrbitCameraState* orbit, TrueView* trueView) {
+    trueView->desiredViewKm = TrueViewKmForFocus(focus);
     switch (focus) {
         case FocusMode::kOverview:
             orbit->distance = 64.0f;
@@ -821,19 +954,127 @@ void SetFocus(FocusMode focus, OrbitCameraState* orbit) {
     }
 }
 
-const char* FocusName(FocusMode focus) {
-    switch (focus) {
-        case FocusMode::kOverview: return "Overview";
-        case FocusMode::kArtemis: return "Artemis II";
-        case FocusMode::kVoyager1: return "Voyager 1";
-        case FocusMode::kVoyager2: return "Voyager 2";
+void SnapTrueView(TrueView* view, astro_world::WorldPos target) {
+    view->target = target;
+    view->viewKm = view->desiredViewKm;
+    view->origin.SetScale(view->viewKm / kTrueViewUnits);
+    view->origin.Rebase(target);
+}
+
+void UpdateTrueScaleCamera(Camera3D* camera, OrbitCameraState* orbit, TrueView* view, astro_world::WorldPos desiredTarget) {
+    ApplyOrbitDrag(orbit);
+    view->desiredViewKm = std::clamp(view->desiredViewKm * std::exp(-0.12 * GetMouseWheelMove()), kTrueMinViewKm, kTrueMaxViewKm);
+    view->viewKm = std::exp(std::log(view->viewKm) + 0.08 * (std::log(view->desiredViewKm) - std::log(view->viewKm)));
+    view->target = astro_world::Lerp(view->target, desiredTarget, 0.08);
+    view->origin.SetScale(view->viewKm / kTrueViewUnits);
+    view->origin.Follow(view->target);
+
+    const float cp = std::cos(orbit->pitch);
+    camera->target = view->origin.ToLocal(view->target);
+    camera->position = Vector3Add(camera->target, {
+        kTrueViewUnits * cp * std::cos(orbit->yaw),
+        kTrueViewUnits * std::sin(orbit->pitch),
+        kTrueViewUnits * cp * std::sin(orbit->yaw),
+    });
+    view->eye = camera->position;
+}
+
+// Pulls a point beyond the far plane back along its ray from the eye and returns the
+// factor its size shrinks by. The point keeps its screen position and segments to it
+// stay straight, so distant orbits and trails still project where they should.
+float PullInsideFar(const TrueView& view, Vector3* local) {
+    const Vector3 d = Vector3Subtract(*local, view.eye);
+    const float distance = Vector3Length(d);
+    if (distance <= kTrueFarUnits) return 1.0f;
+    const float pull = kTrueFarUnits / distance;
+    *local = Vector3Add(view.eye, Vector3Scale(d, pull));
+    return pull;
+}
+
+Vector3 TrueLocal(const TrueView& view, astro_world::WorldPos p) {
+    Vector3 local = view.origin.ToLocal(p);
+    PullInsideFar(view, &local);
+    return local;
+}
+
+float PixelsToUnits(const TrueView& view, Vector3 local, float pixels) {
+    const float perPixel = 2.0f * std::tan(0.5f * kCameraFovDeg * DEG2RAD) / static_cast<float>(kScreenHeight);
+    return pixels * perPixel * Vector3Distance(view.eye, local);
+}
+
+// A body at its true size, but never smaller than minPixels on screen.
+Vector3 DrawTrueBody(const TrueView& view, astro_world::WorldPos p, double radiusKm, float minPixels, Color color) {
+    Vector3 local = view.origin.ToLocal(p);
+    const float pull = PullInsideFar(view, &local);
+    const float radius = std::max(static_cast<float>(radiusKm / view.origin.scale()) * pull, PixelsToUnits(view, local, minPixels));
+    DrawSphere(local, radius, color);
+    return local;
+}
+
+// Converts a polyline through the floating origin in one batch, then draws it.
+template <typename ColorFn>
+void DrawTruePolyline(const TrueView& view, const std::pmr::vector<astro_world::WorldPos>& points, ColorFn colorAt) {
+    std::pmr::vector<Vector3> local(points.size(), &astro_frame::SharedArena());
+    view.origin.ToLocal(points.data(), points.size(), local.data());
+    for (Vector3& p : local) PullInsideFar(view, &p);
+    for (size_t i = 1; i < local.size(); ++i) DrawLine3D(local[i - 1], local[i], colorAt(i));
+}
+
+void DrawTrueOrbit(const TrueView& view, const astro_ephem::ChebyshevEphemeris& ephemeris, double julianDate, const Planet& planet) {
+    constexpr int kSegments = 360;
+    std::pmr::vector<astro_world::WorldPos> points(&astro_frame::SharedArena());
+    points.reserve(kSegments + 1);
+    ForEachOrbitPoint(ephemeris, planet.body, julianDate, kSegments, [&](const astro_ephem::Vec3d& au) {
+        points.push_back(astro_world::WorldPos{au.x, 0.0, au.y} * kKmPerAu);
+    });
+    const Color color = Fade(planet.accent, 0.22f);
+    DrawTruePolyline(view, points, [color](size_t) { return color; });
+}
+
+template <typename EvalKmFn>
+void DrawTrueMissionTrail(const TrueView& view, EvalKmFn evalKm, float currentT, Color pastColor, Color futureColor) {
+    std::pmr::vector<astro_world::WorldPos> points(&astro_frame::SharedArena());
+    points.reserve(kTrailSamples);
+    for (int i = 0; i < kTrailSamples; ++i) points.push_back(evalKm(TrailSampleT(i)));
+    DrawTruePolyline(view, points, [&](size_t i) { return TrailColor(TrailSampleT(static_cast<int>(i)), currentT, pastColor, futureColor); });
+}
+
+void DrawTrueScaleBodies(const TrueView& view, const astro_ephem::ChebyshevEphemeris& ephemeris, double julianDate,
+                         const std::vector<Planet>& planets, const Planet& earth, const TrueScaleCraft& craft) {
+    DrawTrueBody(view, {}, kSunRadiusKm, 6.0f, Color{255, 208, 112, 255});
+    for (const Planet& planet : planets) {
+        DrawTrueOrbit(view, ephemeris, julianDate, planet);
+        DrawTrueBody(view, PlanetKm(planet), planet.radiusKm, 2.5f, planet.color);
+    }
+    DrawTrueBody(view, craft.moon, kMoonRadiusKm, 1.5f, Color{208, 212, 220, 255});
+    DrawLine3D(TrueLocal(view, PlanetKm(earth)), TrueLocal(view, craft.moon), Fade(Color{124, 170, 224, 255}, 0.14f));
+}
+
+// Spacecraft are metres across, so each gets a fixed-size marker; the model is drawn
+// around it at render-unit size and only reads once the view is close.
+void DrawTrueScaleCraft(const TrueView& view, const TrueScaleCraft& craft, const MissionSample& artemis, const MissionSample& voyager1,
+                        const MissionSample& voyager2) {
+    DrawOrionCraft(DrawTrueBody(view, craft.artemis, 0.0, 2.5f, Color{212, 242, 255, 255}), artemis.tangent, Color{212, 242, 255, 255});
+    DrawVoyagerProbe(DrawTrueBody(view, craft.voyager1, 0.0, 2.5f, Color{255, 214, 126, 255}), voyager1.tangent, Color{255, 214, 126, 255});
+    DrawVoyagerProbe(DrawTrueBody(view, craft.voyager2, 0.0, 2.5f, Color{132, 255, 214, 255}), voyager2.tangent, Color{132, 255, 214, 255});
+}
+
+void FormatKm(double km, char* buffer, int size) {
+    if (km < 1.0e6) {
+        std::snprintf(buffer, size, "%.0f km", km);
+    } else if (km < 0.1 * kKmPerAu) {
+        std::snprintf(buffer, size, "%.2f Mkm", km / 1.0e6);
+    } else {
+        std::snprintf(buffer, size, "%.2f AU", km / kKmPerAu);
     }
-    return "";
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    astro_ephem::ChebyshevEphemeris ephemeris;
+    astro_ephem::OpenPlanetEphemeris(argc, argv, &ephemeris);
+
     InitWindow(kScreenWidth, kScreenHeight, "Artemis II + Voyager 1 & 2 Mission Observatory - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -841,19 +1082,23 @@ int main() {
     camera.position = {48.0f, 28.0f, 48.0f};
     camera.target = {0.0f, 0.0f, 0.0f};
     camera.up = {0.0f, 1.0f, 0.0f};
-    camera.fovy = 45.0f;
+    camera.fovy = kCameraFovDeg;
     camera.projection = CAMERA_PERSPECTIVE;
 
     OrbitCameraState orbit{};
     std::vector<Planet> planets = MakePlanets();
-    const std::vector<BackdropStar> stars = MakeBackdropStars();
+    astro_render::StarfieldLayer starfield;
+    starfield.Init(astro_render::StarfieldSpace::kWorldBillboard, MakeBackdropStars());
 
     float sceneTime = 0.0f;
     float masterProgress = 0.0f;
     float timeScale = 0.08f;
     bool paused = false;
     FocusMode focus = FocusMode::kOverview;
-    SetFocus(focus, &orbit);
+    bool trueScale = false;
+    TrueView trueView;
+    SetFocus(focus, &orbit, &trueView);
+    SnapTrueView(&trueView, {});
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_SPACE)) paused = !paused;
@@ -863,27 +1108,27 @@ int main() {
             timeScale = 0.08f;
             paused = false;
             focus = FocusMode::kOverview;
-            SetFocus(focus, &orbit);
+            SetFocus(focus, &orbit, &trueView);
         }
         if (IsKeyPressed(KEY_ZERO)) {
             focus = FocusMode::kOverview;
-            SetFocus(focus, &orbit);
+            SetFocus(focus, &orbit, &trueView);
         }
         if (IsKeyPressed(KEY_ONE)) {
             focus = FocusMode::kArtemis;
-            SetFocus(focus, &orbit);
+            SetFocus(focus, &orbit, &trueView);
         }
         if (IsKeyPressed(KEY_TWO)) {
             focus = FocusMode::kVoyager1;
-            SetFocus(focus, &orbit);
+            SetFocus(focus, &orbit, &trueView);
         }
         if (IsKeyPressed(KEY_THREE)) {
             focus = FocusMode::kVoyager2;
-            SetFocus(focus, &orbit);
+            SetFocus(focus, &orbit, &trueView);
         }
         if (IsKeyPressed(KEY_TAB)) {
             focus = static_cast<FocusMode>((static_cast<int>(focus) + 1) % 4);
-            SetFocus(focus, &orbit);
+            SetFocus(focus, &orbit, &trueView);
         }
         if (IsKeyDown(KEY_LEFT)) masterProgress = std::max(0.0f, masterProgress - 0.18f * GetFrameTime());
         if (IsKeyDown(KEY_RIGHT)) masterProgress = std::min(1.0f, masterProgress + 0.18f * GetFrameTime());
@@ -893,6 +1138,7 @@ int main() {
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) timeScale = std::min(0.40f, timeScale + 0.015f);
         if (IsKeyPressed(KEY_COMMA)) timeScale = std::max(0.005f, timeScale * 0.5f);
         if (IsKeyPressed(KEY_PERIOD)) timeScale = std::min(0.40f, timeScale * 2.0f);
+        const bool toggleTrueScale = IsKeyPressed(KEY_T);
         if (IsKeyPressed(KEY_HOME)) masterProgress = 0.0f;
         if (IsKeyPressed(KEY_END)) masterProgress = 1.0f;
 
@@ -903,7 +1149,8 @@ int main() {
             if (masterProgress > 1.0f) masterProgress -= 1.0f;
         }
 
-        UpdatePlanets(&planets, sceneTime * 0.65f);
+        const double planetJd = kPlanetEpochJd + sceneTime * kPlanetDaysPerSecond;
+        UpdatePlanets(ephemeris, planetJd, &planets);
         AnchorPlanetsToSpacetime(&planets, sceneTime);
         const Planet& earth = FindPlanet(planets, "Earth");
         const Planet& mercury = FindPlanet(planets, "Mercury");
@@ -919,11 +1166,32 @@ int main() {
         const MissionSample voyager1 = EvaluateVoyager1Mission(masterProgress, earth, jupiter, saturn);
         const MissionSample voyager2 = EvaluateVoyager2Mission(masterProgress, earth, jupiter, saturn, uranus, neptune);
 
-        Vector3 desiredTarget = {0.0f, 0.0f, 0.0f};
-        if (focus == FocusMode::kArtemis) desiredTarget = Vector3Lerp(earth.pos, moonPos, 0.22f);
-        if (focus == FocusMode::kVoyager1) desiredTarget = voyager1.pos;
-        if (focus == FocusMode::kVoyager2) desiredTarget = voyager2.pos;
-        UpdateOrbitCameraDragOnly(&camera, &orbit, desiredTarget);
+        TrueScaleCraft craft{};
+        if (trueScale || toggleTrueScale) {
+            craft.moon = EarthOffsetKm(earth, moonPos);
+            craft.artemis = EarthOffsetKm(earth, artemis.pos);
+            craft.voyager1 = HeliocentricKm(voyager1.pos);
+            craft.voyager2 = HeliocentricKm(voyager2.pos);
+        }
+
+        if (toggleTrueScale) {
+            trueScale = !trueScale;
+            SetFocus(focus, &orbit, &trueView);
+        }
+        if (trueScale) {
+            astro_world::WorldPos desiredTarget{};
+            if (focus == FocusMode::kArtemis) desiredTarget = astro_world::Lerp(PlanetKm(earth), craft.moon, 0.22);
+            if (focus == FocusMode::kVoyager1) desiredTarget = craft.voyager1;
+            if (focus == FocusMode::kVoyager2) desiredTarget = craft.voyager2;
+            if (toggleTrueScale) SnapTrueView(&trueView, desiredTarget);
+            UpdateTrueScaleCamera(&camera, &orbit, &trueView, desiredTarget);
+        } else {
+            Vector3 desiredTarget = {0.0f, 0.0f, 0.0f};
+            if (focus == FocusMode::kArtemis) desiredTarget = Vector3Lerp(earth.pos, moonPos, 0.22f);
+            if (focus == FocusMode::kVoyager1) desiredTarget = voyager1.pos;
+            if (focus == FocusMode::kVoyager2) desiredTarget = voyager2.pos;
+            UpdateOrbitCameraDragOnly(&camera, &orbit, desiredTarget);
+        }
 
         const bool artemisFlyby = masterProgress >= 0.52f && masterProgress < 0.66f;
         const bool voyager1Jupiter = masterProgress >= 0.42f && masterProgress < 0.56f;
@@ -943,59 +1211,83 @@ int main() {
 
         BeginMode3D(camera);
 
-        for (const BackdropStar& star : stars) {
-            const float pulse = 0.68f + 0.32f * std::sin(sceneTime * star.twinkle);
-            DrawSphere(star.pos, star.size * pulse, Fade(WHITE, 0.16f + 0.60f * pulse));
-        }
+        if (trueScale) {
+            starfield.Draw(astro_render::StarfieldView{sceneTime, 0.0f, trueView.eye});
+            DrawTrueScaleBodies(trueView, ephemeris, planetJd, planets, earth, craft);
+            DrawTrueMissionTrail(
+                trueView,
+                [&](float t) { return EarthOffsetKm(earth, EvaluateArtemisPosition(t, earth, moonPos)); },
+                masterProgress,
+                Color{120, 220, 255, 255},
+                Color{120, 220, 255, 255}
+            );
+            DrawTrueMissionTrail(
+                trueView,
+                [&](float t) { return HeliocentricKm(EvaluateVoyager1Position(t, earth, jupiter, saturn)); },
+                masterProgress,
+                Color{255, 216, 112, 255},
+                Color{255, 216, 112, 255}
+            );
+            DrawTrueMissionTrail(
+                trueView,
+                [&](float t) { return HeliocentricKm(EvaluateVoyager2Position(t, earth, jupiter, saturn, uranus, neptune)); },
+                masterProgress,
+                Color{112, 255, 204, 255},
+                Color{112, 255, 204, 255}
+            );
+            DrawTrueScaleCraft(trueView, craft, artemis, voyager1, voyager2);
+        } else {
+            starfield.Draw(sceneTime);
 
-        DrawSphere({0.0f, 0.0f, 0.0f}, 2.5f, Color{255, 208, 112, 255});
-        for (int i = 0; i < 5; ++i) {
-            DrawSphereWires({0.0f, 0.0f, 0.0f}, 2.9f + 0.9f * i, 16, 16, Fade(Color{255, 170, 62, 255}, 0.05f));
-        }
+            DrawSphere({0.0f, 0.0f, 0.0f}, 2.5f, Color{255, 208, 112, 255});
+            for (int i = 0; i < 5; ++i) {
+                DrawSphereWires({0.0f, 0.0f, 0.0f}, 2.9f + 0.9f * i, 16, 16, Fade(Color{255, 170, 62, 255}, 0.05f));
+            }
 
-        DrawSpacetimeGrid(planets, sceneTime, kSceneExtent - 4.0f);
-        for (const Planet& planet : planets) DrawProjectedOrbit(planet, planets, sceneTime);
+            DrawSpacetimeGrid(planets, sceneTime, kSceneExtent - 4.0f);
+            for (const Planet& planet : planets) DrawProjectedOrbit(ephemeris, planetJd, planet, planets, sceneTime);
 
-        for (const Planet& planet : planets) DrawPlanetVisual(planet, sceneTime);
+            for (const Planet& planet : planets) DrawPlanetVisual(planet, sceneTime);
 
-        DrawSphere(moonPos, 0.26f, Color{208, 212, 220, 255});
-        DrawSphereWires(earth.pos, 3.4f, 18, 18, Fade(SKYBLUE, 0.14f));
+            DrawSphere(moonPos, 0.26f, Color{208, 212, 220, 255});
+            DrawSphereWires(earth.pos, 3.4f, 18, 18, Fade(SKYBLUE, 0.14f));
 
-        DrawMissionTrail(
-            [&](float t) { return EvaluateArtemisMission(t, earth, moonPos); },
-            masterProgress,
-            Color{120, 220, 255, 255},
-            Color{120, 220, 255, 255}
-        );
-        DrawMissionTrail(
-            [&](float t) { return EvaluateVoyager1Mission(t, earth, jupiter, saturn); },
-            masterProgress,
-            Color{255, 216, 112, 255},
-            Color{255, 216, 112, 255}
-        );
-        DrawMissionTrail(
-            [&](float t) { return EvaluateVoyager2Mission(t, earth, jupiter, saturn, uranus, neptune); },
-            masterProgress,
-            Color{112, 255, 204, 255},
-            Color{112, 255, 204, 255}
-        );
+            DrawMissionTrail(
+                [&](float t) { return EvaluateArtemisMission(t, earth, moonPos); },
+                masterProgress,
+                Color{120, 220, 255, 255},
+                Color{120, 220, 255, 255}
+            );
+            DrawMissionTrail(
+                [&](float t) { return EvaluateVoyager1Mission(t, earth, jupiter, saturn); },
+                masterProgress,
+                Color{255, 216, 112, 255},
+                Color{255, 216, 112, 255}
+            );
+            DrawMissionTrail(
+                [&](float t) { return EvaluateVoyager2Mission(t, earth, jupiter, saturn, uranus, neptune); },
+                masterProgress,
+                Color{112, 255, 204, 255},
+                Color{112, 255, 204, 255}
+            );
 
-        if (artemisFlyby) DrawEncounterPulse(moonPos, 1.7f, sceneTime, Color{122, 220, 255, 255});
-        if (voyager1Jupiter || voyager2Jupiter) DrawEncounterPulse(jupiter.pos, 4.2f, sceneTime, Color{255, 196, 116, 255});
-        if (voyager1Saturn || voyager2Saturn) DrawEncounterPulse(saturn.pos, 4.5f, sceneTime, Color{255, 216, 132, 255});
-        if (voyager2Uranus) DrawEncounterPulse(uranus.pos, 4.0f, sceneTime, Color{152, 238, 240, 255});
-        if (voyager2Neptune) DrawEncounterPulse(neptune.pos, 4.0f, sceneTime, Color{112, 168, 255, 255});
+            if (artemisFlyby) DrawEncounterPulse(moonPos, 1.7f, sceneTime, Color{122, 220, 255, 255});
+            if (voyager1Jupiter || voyager2Jupiter) DrawEncounterPulse(jupiter.pos, 4.2f, sceneTime, Color{255, 196, 116, 255});
+            if (voyager1Saturn || voyager2Saturn) DrawEncounterPulse(saturn.pos, 4.5f, sceneTime, Color{255, 216, 132, 255});
+            if (voyager2Uranus) DrawEncounterPulse(uranus.pos, 4.0f, sceneTime, Color{152, 238, 240, 255});
+            if (voyager2Neptune) DrawEncounterPulse(neptune.pos, 4.0f, sceneTime, Color{112, 168, 255, 255});
 
-        DrawOrionCraft(artemis.pos, artemis.tangent, Color{212, 242, 255, 255});
-        DrawVoyagerProbe(voyager1.pos, voyager1.tangent, Color{255, 214, 126, 255});
-        DrawVoyagerProbe(voyager2.pos, voyager2.tangent, Color{132, 255, 214, 255});
+            DrawOrionCraft(artemis.pos, artemis.tangent, Color{212, 242, 255, 255});
+            DrawVoyagerProbe(voyager1.pos, voyager1.tangent, Color{255, 214, 126, 255});
+            DrawVoyagerProbe(voyager2.pos, voyager2.tangent, Color{132, 255, 214, 255});
 
-        DrawLine3D(earth.pos, moonPos, Fade(Color{124, 170, 224, 255}, 0.08f));
+            DrawLine3D(earth.pos, moonPos, Fade(Color{124, 170, 224, 255}, 0.08f));
+        }
 
         EndMode3D();
 
         DrawText("Artemis II + Voyager 1 & 2 Mission Observatory", 20, 18, 30, Color{236, 242, 248, 255});
-        DrawText("Mouse drag: orbit | wheel: zoom | 0-3 focus | Tab cycle focus | Left/Right scrub | Q/E fine scrub | [ ] / , . rate | Space pause | R reset", 20, 54, 18, Color{166, 184, 210, 255});
+        DrawText("Mouse drag: orbit | wheel: zoom | 0-3 focus | Tab cycle focus | Left/Right scrub | Q/E fine scrub | [ ] / , . rate | T true scale | Space pause | R reset", 20, 54, 18, Color{166, 184, 210, 255});
 
         DrawRectangleRounded(Rectangle{16, 112, 428, 228}, 0.08f, 12, Fade(Color{10, 16, 28, 255}, 0.92f));
         DrawRectangleRoundedLinesEx(Rectangle{16, 112, 428, 228}, 0.08f, 12, 1.0f, Fade(Color{74, 104, 144, 255}, 0.85f));
@@ -1009,7 +1301,20 @@ int main() {
         DrawText(voyager1.phase, 154, 264, 20, Color{222, 232, 244, 255});
         DrawText("Voyager 2", 32, 292, 20, Color{132, 255, 214, 255});
         DrawText(voyager2.phase, 154, 292, 20, Color{222, 232, 244, 255});
-        DrawText("Visual note: geometry is scaled for readability while preserving mission relationships.", 32, 320, 18, Color{152, 170, 194, 255});
+        if (trueScale) {
+            char scaleBuf[32];
+            char orionBuf[32];
+            FormatKm(trueView.origin.scale() * 100.0, scaleBuf, sizeof(scaleBuf));
+            FormatKm(astro_world::Length(craft.artemis - PlanetKm(earth)), orionBuf, sizeof(orionBuf));
+            DrawText(TextFormat("True scale: V1 %.1f AU, V2 %.1f AU, Orion %s from Earth", astro_world::Length(craft.voyager1) / kKmPerAu,
+                                astro_world::Length(craft.voyager2) / kKmPerAu, orionBuf),
+                     32, 320, 18, Color{152, 170, 194, 255});
+            DrawText(TextFormat("100 units = %s | origin rebased %llu times", scaleBuf,
+                                static_cast<unsigned long long>(trueView.origin.rebases())),
+                     32, 350, 18, Color{152, 170, 194, 255});
+        } else {
+            DrawText("Visual note: geometry is scaled for readability while preserving mission relationships.", 32, 320, 18, Color{152, 170, 194, 255});
+        }
 
         DrawRectangleRounded(Rectangle{1094, 112, 390, 292}, 0.08f, 12, Fade(Color{8, 14, 24, 255}, 0.92f));
         DrawRectangleRoundedLinesEx(Rectangle{1094, 112, 390, 292}, 0.08f, 12, 1.0f, Fade(Color{74, 104, 144, 255}, 0.85f));
@@ -1024,24 +1329,29 @@ int main() {
         DrawText("Spacetime grid is a stylized gravity well sheet, not a relativistic simulation.", 1114, 320, 18, Color{152, 170, 194, 255});
         DrawText("Mercury, Venus, Earth, Mars, Jupiter, Saturn, Uranus, and Neptune are all in the scene.", 1114, 348, 18, Color{152, 170, 194, 255});
 
-        DrawPlanetLabel(camera, mercury.pos, "Mercury", Color{210, 202, 188, 255});
-        DrawPlanetLabel(camera, venus.pos, "Venus", Color{238, 214, 164, 255});
-        DrawPlanetLabel(camera, earth.pos, "Earth", Color{178, 214, 255, 255});
-        DrawPlanetLabel(camera, moonPos, "Moon", Color{214, 220, 226, 255});
-        DrawPlanetLabel(camera, mars.pos, "Mars", Color{246, 168, 122, 255});
-        DrawPlanetLabel(camera, jupiter.pos, "Jupiter", Color{236, 204, 170, 255});
-        DrawPlanetLabel(camera, saturn.pos, "Saturn", Color{236, 218, 154, 255});
-        DrawPlanetLabel(camera, uranus.pos, "Uranus", Color{178, 238, 244, 255});
-        DrawPlanetLabel(camera, neptune.pos, "Neptune", Color{138, 182, 255, 255});
-        DrawPlanetLabel(camera, artemis.pos, "Artemis II", Color{132, 224, 255, 255});
-        DrawPlanetLabel(camera, voyager1.pos, "Voyager 1", Color{255, 214, 126, 255});
-        DrawPlanetLabel(camera, voyager2.pos, "Voyager 2", Color{132, 255, 214, 255});
+        const auto labelPos = [&](Vector3 scenePos, astro_world::WorldPos km) { return trueScale ? TrueLocal(trueView, km) : scenePos; };
+        DrawPlanetLabel(camera, labelPos(mercury.pos, PlanetKm(mercury)), "Mercury", Color{210, 202, 188, 255});
+        DrawPlanetLabel(camera, labelPos(venus.pos, PlanetKm(venus)), "Venus", Color{238, 214, 164, 255});
+        DrawPlanetLabel(camera, labelPos(earth.pos, PlanetKm(earth)), "Earth", Color{178, 214, 255, 255});
+        DrawPlanetLabel(camera, labelPos(moonPos, craft.moon), "Moon", Color{214, 220, 226, 255});
+        DrawPlanetLabel(camera, labelPos(mars.pos, PlanetKm(mars)), "Mars", Color{246, 168, 122, 255});
+        DrawPlanetLabel(camera, labelPos(jupiter.pos, PlanetKm(jupiter)), "Jupiter", Color{236, 204, 170, 255});
+        DrawPlanetLabel(camera, labelPos(saturn.pos, PlanetKm(saturn)), "Saturn", Color{236, 218, 154, 255});
+        DrawPlanetLabel(camera, labelPos(uranus.pos, PlanetKm(uranus)), "Uranus", Color{178, 238, 244, 255});
+        DrawPlanetLabel(camera, labelPos(neptune.pos, PlanetKm(neptune)), "Neptune", Color{138, 182, 255, 255});
+        DrawPlanetLabel(camera, labelPos(artemis.pos, craft.artemis), "Artemis II", Color{132, 224, 255, 255});
+        DrawPlanetLabel(camera, labelPos(voyager1.pos, craft.voyager1), "Voyager 1", Color{255, 214, 126, 255});
+        DrawPlanetLabel(camera, labelPos(voyager2.pos, craft.voyager2), "Voyager 2", Color{132, 255, 214, 255});
 
         DrawTimelineBar(masterProgress, artemisDay, voyager1Year, voyager2Year);
         DrawFPS(20, kScreenHeight - 34);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    starfield.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
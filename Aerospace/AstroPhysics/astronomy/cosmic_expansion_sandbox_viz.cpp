@@ -1,14 +1,84 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/cosmology.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/point_cloud.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <random>
 #include <vector>
 
 namespace {
 constexpr int kW = 1280;
 constexpr int kH = 820;
+constexpr int kDefaultGalaxies = 20000;
+constexpr int kMaxGalaxies = 100000;
+constexpr float kComovingRadiusGly = 18.0f;  // today's size of the galaxy ball
+constexpr float kSceneUnitsPerGly = 0.4f;
+constexpr float kGyrPerSecond = 1.5f;
+constexpr float kMinShownScale = 0.08f;      // playback turns around outside [min, max]
+constexpr float kMaxShownScale = 5.0f;
+constexpr float kBrightDistanceGly = 12.0f;  // luminosity distance where galaxies fade to half
+
+// Comoving positions (Gly at a = 1), uniform in a ball around the observer.
+struct GalaxyField {
+    std::vector<Vector3> comoving;
+    std::vector<float> chi;
+    std::vector<float> z;
+    std::vector<float> luminosity;
+    std::vector<astro_render::CloudPoint> points;
+
+    explicit GalaxyField(int count) {
+        std::mt19937 rng(60317);
+        std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+        comoving.reserve(static_cast<size_t>(count));
+        while (static_cast<int>(comoving.size()) < count) {
+            const Vector3 p = {u(rng), u(rng), u(rng)};
+            if (Vector3LengthSqr(p) > 1.0f) continue;
+            comoving.push_back(Vector3Scale(p, kComovingRadiusGly));
+        }
+        chi.resize(comoving.size());
+        for (size_t i = 0; i < comoving.size(); ++i) chi[i] = Vector3Length(comoving[i]);
+        z.resize(comoving.size());
+        luminosity.resize(comoving.size());
+        points.resize(comoving.size());
+    }
+
+    // Redshift and luminosity distance from the tables, then scene points: stretched by
+    // a(t), blue to red with z / (1 + z), dimmer with distance, grey past the horizon.
+    void Update(const astro_cosmo::CosmoTable& table, double t) {
+        table.Observe(t, chi.data(), chi.size(), z.data(), luminosity.data());
+        const float scale = static_cast<float>(table.ScaleFactor(t)) * kSceneUnitsPerGly;
+        for (size_t i = 0; i < comoving.size(); ++i) {
+            points[i].pos = Vector3Scale(comoving[i], scale);
+            if (!std::isfinite(z[i])) {
+                points[i].color = Color{90, 96, 110, 40};
+                continue;
+            }
+            const float d = std::fabs(luminosity[i]) / kBrightDistanceGly;
+            const unsigned char alpha = static_cast<unsigned char>(60.0f + 195.0f / (1.0f + d * d));
+            if (z[i] < 0.0f) {
+                const float s = std::min(1.0f, -z[i]);
+                points[i].color = Color{static_cast<unsigned char>(170 - 110 * s), static_cast<unsigned char>(200 - 40 * s), 255, alpha};
+                continue;
+            }
+            const float s = z[i] / (1.0f + z[i]);
+            points[i].color = Color{static_cast<unsigned char>(150 + 105 * s), static_cast<unsigned char>(200 - 130 * s),
+                                    static_cast<unsigned char>(255 - 205 * s), alpha};
+        }
+    }
+
+    double VisibleFraction() const {
+        size_t visible = 0;
+        for (float v : z) visible += std::isfinite(v) ? 1 : 0;
+        return z.empty() ? 0.0 : static_cast<double>(visible) / static_cast<double>(z.size());
+    }
+};
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dist) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -22,9 +92,50 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
     float cp = std::cos(*pitch);
     c->position = Vector3Add(c->target, {*dist * cp * std::cos(*yaw), *dist * std::sin(*pitch), *dist * cp * std::sin(*yaw)});
 }
+
+// a(t) over the whole run with the current time marked.
+void DrawScalePlot(const astro_cosmo::CosmoTable& table, double t) {
+    const Rectangle panel = {kW - 330.0f, kH - 190.0f, 310.0f, 170.0f};
+    DrawRectangleRec(panel, Color{12, 18, 30, 220});
+    DrawRectangleLinesEx(panel, 1.0f, Color{60, 86, 124, 255});
+    const float x0 = panel.x + 12.0f, w = panel.width - 24.0f;
+    const float y0 = panel.y + panel.height - 14.0f, h = panel.height - 44.0f;
+    const double top = std::min(static_cast<double>(kMaxShownScale), table.maxScale);
+    const auto toY = [&](double a) { return y0 - h * static_cast<float>(std::min(a, top) / top); };
+    if (table.reachesToday) DrawLine(static_cast<int>(x0), static_cast<int>(toY(1.0)), static_cast<int>(x0 + w), static_cast<int>(toY(1.0)), Color{50, 70, 100, 255});
+    Vector2 prev = {x0, toY(table.ScaleFactor(0.0))};
+    constexpr int kColumns = 150;
+    for (int i = 1; i <= kColumns; ++i) {
+        const double ti = table.endTime * i / kColumns;
+        const Vector2 p = {x0 + w * static_cast<float>(i) / kColumns, toY(table.ScaleFactor(ti))};
+        DrawLineV(prev, p, Color{126, 224, 255, 255});
+        prev = p;
+    }
+    const float mx = x0 + w * static_cast<float>(t / table.endTime);
+    DrawCircleV({mx, toY(table.ScaleFactor(t))}, 4.0f, Color{255, 200, 120, 255});
+    char s[96];
+    std::snprintf(s, sizeof(s), "a(t), 0 - %.0f Gyr%s", table.endTime, table.crunches ? " (crunch)" : "");
+    DrawText(s, static_cast<int>(panel.x) + 10, static_cast<int>(panel.y) + 8, 16, Color{200, 214, 236, 255});
 }
+}  // namespace
+
+int main(int argc, char** argv) {
+    const int galaxyCount = std::clamp(astro_bench::IntArg(argc, argv, "--galaxies", kDefaultGalaxies), 1, kMaxGalaxies);
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // One bench step is a frame of playback: table lookups and colours for every galaxy.
+        const astro_cosmo::CosmoTable table = astro_cosmo::CosmoTable::Build(astro_cosmo::CosmoParams{});
+        GalaxyField field(galaxyCount);
+        double t = 1.0;
+        return astro_bench::RunBench(
+            "cosmic_expansion_sandbox_viz", bench,
+            [&](float dt) {
+                t = std::fmod(t + kGyrPerSecond * dt, table.endTime);
+                field.Update(table, t);
+            },
+            [&]() { return field.VisibleFraction(); });
+    }
 
-int main() {
     InitWindow(kW, kH, "Cosmic Expansion Sandbox 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -36,63 +147,89 @@ int main() {
     cam.projection = CAMERA_PERSPECTIVE;
     float yaw = 0.8f, pitch = 0.36f, dist = 25.0f;
 
-    float omegaM = 0.30f;
-    float omegaL = 0.70f;
-    float a = 1.0f;
-    float adot = 0.40f;
+    astro_cosmo::CosmoParams params;
+    astro_cosmo::CosmologyCache cosmology;
+    cosmology.BuildNow(params);
+    double t = cosmology.table()->age;
+    float direction = 1.0f;
     bool paused = false;
 
-    std::vector<Vector3> comoving;
-    for (int x = -4; x <= 4; ++x) {
-        for (int y = -4; y <= 4; ++y) {
-            for (int z = -4; z <= 4; ++z) {
-                if ((x + y + z) % 3 == 0) comoving.push_back({x * 0.8f, y * 0.8f, z * 0.8f});
-            }
-        }
-    }
+    GalaxyField field(galaxyCount);
+    astro_render::PointCloudBuffer cloud;
+    cloud.Init(field.points.size());
 
     while (!WindowShouldClose()) {
+        const float frameDt = GetFrameTime();
         if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_R)) { omegaM = 0.30f; omegaL = 0.70f; a = 1.0f; adot = 0.40f; paused = false; }
-        if (IsKeyDown(KEY_UP)) omegaL = std::min(1.4f, omegaL + 0.6f * GetFrameTime());
-        if (IsKeyDown(KEY_DOWN)) omegaL = std::max(0.0f, omegaL - 0.6f * GetFrameTime());
-        if (IsKeyDown(KEY_RIGHT)) omegaM = std::min(1.6f, omegaM + 0.6f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT)) omegaM = std::max(0.0f, omegaM - 0.6f * GetFrameTime());
+        if (IsKeyPressed(KEY_R)) {
+            params = astro_cosmo::CosmoParams{};
+            direction = 1.0f;
+            paused = false;
+        }
+        if (IsKeyDown(KEY_UP)) params.omegaL = std::min(1.4f, params.omegaL + 0.6f * frameDt);
+        if (IsKeyDown(KEY_DOWN)) params.omegaL = std::max(0.0f, params.omegaL - 0.6f * frameDt);
+        if (IsKeyDown(KEY_RIGHT)) params.omegaM = std::min(1.6f, params.omegaM + 0.6f * frameDt);
+        if (IsKeyDown(KEY_LEFT)) params.omegaM = std::max(0.0f, params.omegaM - 0.6f * frameDt);
+        if (IsKeyPressed(KEY_RIGHT_BRACKET)) params.omegaR = std::min(0.1f, std::max(1.0e-5f, params.omegaR * 3.0f));
+        if (IsKeyPressed(KEY_LEFT_BRACKET)) params.omegaR = params.omegaR < 2.0e-5f ? 0.0f : params.omegaR / 3.0f;
+        if (IsKeyDown(KEY_EQUAL)) params.h0 = std::min(100.0f, params.h0 + 20.0f * frameDt);
+        if (IsKeyDown(KEY_MINUS)) params.h0 = std::max(40.0f, params.h0 - 20.0f * frameDt);
+        cosmology.Request(params);
+        if (cosmology.Acquire()) t = std::min(t, cosmology.table()->endTime);
+        const astro_cosmo::CosmoTable& table = *cosmology.table();
+        if (IsKeyPressed(KEY_T)) t = table.age;
         UpdateOrbitCameraDragOnly(&cam, &yaw, &pitch, &dist);
 
         if (!paused) {
-            float dt = GetFrameTime();
-            // Simple Friedmann-like toy dynamics: a'' = -0.5*Omega_m/a^2 + Omega_L*a
-            float addot = -0.5f * omegaM / std::max(0.1f, a * a) + omegaL * a;
-            adot += addot * dt * 0.35f;
-            a += adot * dt * 0.35f;
-            a = std::clamp(a, 0.25f, 5.0f);
-            if (a <= 0.26f || a >= 4.95f) adot *= -0.3f;
+            t += direction * kGyrPerSecond * frameDt;
+            const double a = table.ScaleFactor(t);
+            if (direction > 0.0f && (a > kMaxShownScale || t >= table.endTime)) direction = -1.0f;
+            if (direction < 0.0f && (a < kMinShownScale || t <= 0.0)) direction = 1.0f;
+            t = std::clamp(t, 0.0, table.endTime);
         }
+        const double a = table.ScaleFactor(t);
+        const double horizonNow = a * table.ConformalTime(t);
+
+        field.Update(table, t);
+        cloud.Clear();
+        cloud.Append(field.points.data(), field.points.size());
 
         BeginDrawing();
         ClearBackground(Color{6, 10, 18, 255});
         BeginMode3D(cam);
         DrawGrid(20, 1.0f);
-        for (const auto& c : comoving) {
-            Vector3 p = Vector3Scale(c, a);
-            float speedProxy = Vector3Length(c) * std::fabs(adot);
-            unsigned char r = (unsigned char)std::clamp(80.0f + 35.0f * speedProxy, 80.0f, 255.0f);
-            unsigned char b = (unsigned char)std::clamp(255.0f - 30.0f * speedProxy, 70.0f, 255.0f);
-            DrawSphere(p, 0.11f, Color{r, 170, b, 235});
-            DrawLine3D({0, 0, 0}, p, Fade(Color{120, 180, 255, 255}, 0.10f));
-        }
+        DrawSphereWires({0, 0, 0}, static_cast<float>(horizonNow) * kSceneUnitsPerGly, 10, 20, Fade(Color{120, 180, 255, 255}, 0.10f));
+        BeginBlendMode(BLEND_ADDITIVE);
+        cloud.Draw(2.0f);
+        EndBlendMode();
+        DrawSphere({0, 0, 0}, 0.12f, Color{255, 236, 170, 255});
         EndMode3D();
 
         DrawText("Cosmic Expansion Sandbox (matter vs dark energy)", 20, 18, 30, Color{232, 238, 248, 255});
-        DrawText("Mouse drag orbit | wheel zoom | Left/Right Omega_m | Up/Down Omega_Lambda | P pause | R reset", 20, 54, 18, Color{160, 182, 210, 255});
+        DrawText("Mouse drag orbit | wheel zoom | Left/Right Omega_m | Up/Down Omega_Lambda | [ ] Omega_r | -/= H0 | T today | P pause | R reset", 20, 54, 18, Color{160, 182, 210, 255});
         char s[260];
-        std::snprintf(s, sizeof(s), "Omega_m=%.2f  Omega_Lambda=%.2f  a=%.2f  adot=%.2f%s", omegaM, omegaL, a, adot, paused ? "  [PAUSED]" : "");
+        std::snprintf(s, sizeof(s), "Omega_m=%.2f  Omega_Lambda=%.2f  Omega_r=%.1e  Omega_k=%.2f  H0=%.1f%s", table.params.omegaM, table.params.omegaL,
+                      table.params.omegaR, table.params.omegaK(), table.params.h0, cosmology.Busy() ? "  building..." : "");
         DrawText(s, 20, 82, 20, Color{126, 224, 255, 255});
-        DrawFPS(20, 110);
+        std::snprintf(s, sizeof(s), "t=%.2f Gyr  a=%.3f  H=%.1f km/s/Mpc  horizon=%.1f Gly  visible=%.0f%%%s", t, a, table.Hubble(t), horizonNow,
+                      100.0 * field.VisibleFraction(), paused ? "  [PAUSED]" : "");
+        DrawText(s, 20, 108, 20, Color{200, 214, 236, 255});
+        if (table.reachesToday) {
+            std::snprintf(s, sizeof(s), "age today %.2f Gyr  |  %d galaxies, colour = redshift, brightness = luminosity distance", table.age, galaxyCount);
+        } else {
+            std::snprintf(s, sizeof(s), "no big bang for these parameters: the Friedmann equation bounces before a = 1");
+        }
+        DrawText(s, 20, 134, 18, table.reachesToday ? Color{150, 168, 196, 255} : Color{255, 160, 120, 255});
+        DrawScalePlot(table, t);
+        DrawFPS(20, 160);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    cosmology.Stop();
+    cloud.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
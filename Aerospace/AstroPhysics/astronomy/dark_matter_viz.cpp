@@ -1,6 +1,10 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/rotation_curve.h"
+
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
@@ -12,10 +16,10 @@ namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+constexpr int kStarCount = 420;
+constexpr float kDiskRadius = 9.5f;
 
-struct Star {
-    float r;
-    float theta;
+struct StarLook {
     float size;
     Color color;
 };
@@ -52,6 +56,28 @@ float OrbitSpeed(float r, float enclosedMass) {
     return std::sqrt(std::max(0.001f, enclosedMass / r));
 }
 
+// Angular speed with the halo, and the angle the baryonic-only ghost lags behind, as
+// radial tables; both depend only on the halo strength.
+struct HaloCurves {
+    astro_galaxy::RadialTable omega;
+    astro_galaxy::RadialTable ghostLag;
+    float builtFor = -1.0f;
+
+    bool Refresh(float haloStrength) {
+        if (haloStrength == builtFor) return false;
+        omega.Build(kDiskRadius, [&](float r) {
+            r = std::max(r, 0.05f);
+            return OrbitSpeed(r, BaryonicMass(r) + HaloMass(r, haloStrength)) / r;
+        });
+        ghostLag.Build(kDiskRadius, [&](float r) {
+            r = std::max(r, 0.05f);
+            return 0.85f * (OrbitSpeed(r, BaryonicMass(r) + HaloMass(r, haloStrength)) - OrbitSpeed(r, BaryonicMass(r))) / r;
+        });
+        builtFor = haloStrength;
+        return true;
+    }
+};
+
 void DrawCircleXZ(float radius, int segs, Color c) {
     for (int i = 0; i < segs; ++i) {
         float a0 = 2.0f * PI * static_cast<float>(i) / static_cast<float>(segs);
@@ -90,16 +116,20 @@ int main() {
     float camPitch = 0.33f;
     float camDistance = 16.0f;
 
-    std::vector<Star> stars;
-    stars.reserve(420);
-    for (int i = 0; i < 420; ++i) {
-        float t = static_cast<float>(i) / 419.0f;
+    astro_galaxy::DiskOrbits orbits;
+    std::vector<StarLook> looks;
+    orbits.reserve(kStarCount);
+    for (int i = 0; i < kStarCount; ++i) {
+        float t = static_cast<float>(i) / (kStarCount - 1);
         float r = 0.7f + 8.6f * std::pow(t, 0.62f);
         float theta = 2.0f * PI * std::fmod(i * 0.6180339f, 1.0f);
         float size = 0.018f + 0.022f * (1.0f - t);
         unsigned char c = static_cast<unsigned char>(140 + 100 * (1.0f - t));
-        stars.push_back({r, theta, size, Color{c, c, 255, 240}});
+        orbits.push_back(r, theta, 1.0f, 0.0f, 0.0f);
+        looks.push_back({size, Color{c, c, 255, 240}});
     }
+    HaloCurves curves;
+    std::vector<Vector2> ghostTurn(kStarCount);  // (cos, sin) of each ghost's lag
 
     float haloStrength = 1.0f;
     float timeScale = 1.0f;
@@ -122,15 +152,14 @@ int main() {
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
-        float dt = GetFrameTime() * timeScale;
-        if (!paused) {
-            for (Star& s : stars) {
-                float mBar = BaryonicMass(s.r);
-                float mDM = HaloMass(s.r, haloStrength);
-                float vTotal = OrbitSpeed(s.r, mBar + mDM);
-                s.theta += (vTotal / s.r) * dt;
+        if (curves.Refresh(haloStrength)) {
+            for (size_t i = 0; i < orbits.size(); ++i) {
+                const float lag = curves.ghostLag(orbits.radius[i]);
+                ghostTurn[i] = {std::cos(lag), -std::sin(lag)};
             }
         }
+        float dt = GetFrameTime() * timeScale;
+        if (!paused) astro_galaxy::AdvanceOrbits(&orbits, curves.omega, dt, 0.0f);
 
         BeginDrawing();
         ClearBackground(Color{5, 8, 16, 255});
@@ -144,15 +173,14 @@ int main() {
             DrawCircleXZ(r, 96, Color{70, 95, 140, 45});
         }
 
-        for (const Star& s : stars) {
-            Vector3 p = {s.r * std::cos(s.theta), 0.0f, s.r * std::sin(s.theta)};
-            DrawSphere(p, s.size, s.color);
+        for (size_t i = 0; i < orbits.size(); ++i) {
+            const float r = orbits.radius[i], c = orbits.cosTheta[i], sn = orbits.sinTheta[i];
+            DrawSphere({r * c, 0.0f, r * sn}, looks[i].size, looks[i].color);
 
             if (showBaryonicGhost) {
-                float vBar = OrbitSpeed(s.r, BaryonicMass(s.r));
-                float thetaBar = s.theta - 0.85f * (OrbitSpeed(s.r, BaryonicMass(s.r) + HaloMass(s.r, haloStrength)) - vBar) / s.r;
-                Vector3 pb = {s.r * std::cos(thetaBar), 0.0f, s.r * std::sin(thetaBar)};
-                DrawSphere(pb, s.size * 0.7f, Color{255, 110, 110, 85});
+                const Vector2 turn = ghostTurn[i];
+                Vector3 pb = {r * (c * turn.x - sn * turn.y), 0.0f, r * (sn * turn.x + c * turn.y)};
+                DrawSphere(pb, looks[i].size * 0.7f, Color{255, 110, 110, 85});
             }
         }
 
@@ -165,9 +193,12 @@ int main() {
         DrawText("Blue stars: with dark matter halo | Red ghosts: baryonic-only speed", 20, 110, 18, Color{200, 180, 180, 255});
         DrawFPS(20, 138);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,15 +1,35 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
+#include "../common/transit_fit.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <deque>
+#include <string>
+#include <vector>
 
 namespace {
 constexpr int kW = 1280;
 constexpr int kH = 820;
 constexpr float kG = 1.0f;
+constexpr double kLimbU1 = 0.42;
+constexpr double kLimbU2 = 0.22;
+
+// The built-in data set: a hot Jupiter observed for 60 days at 100000 samples.
+constexpr size_t kSyntheticSamples = 100000;
+constexpr double kSyntheticSpanDays = 60.0;
+constexpr double kSyntheticNoise = 1.5e-3;
+constexpr int kFoldBins = 120;
+constexpr int kModelSamples = 240;
+constexpr Rectangle kFitPanel = {850.0f, 130.0f, 410.0f, 370.0f};
+constexpr Rectangle kFitPlot = {870.0f, 186.0f, 370.0f, 180.0f};
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dist) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -27,14 +47,227 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
 float TransitFlux(Vector3 planetPos, float starR, float planetR) {
     // Observer fixed on +X axis looking toward origin.
     if (planetPos.x < 0.0f) return 1.0f;
-    float d = std::sqrt(planetPos.y * planetPos.y + planetPos.z * planetPos.z);
-    float overlap = std::max(0.0f, starR + planetR - d);
-    float frac = std::clamp(overlap / (2.0f * planetR), 0.0f, 1.0f);
-    return 1.0f - frac * frac * (planetR * planetR) / (starR * starR);
+    const float d = std::sqrt(planetPos.y * planetPos.y + planetPos.z * planetPos.z);
+    return static_cast<float>(astro_transit::OccultQuad(d / starR, planetR / starR, kLimbU1, kLimbU2));
+}
+
+astro_transit::TransitParams SyntheticTruth() {
+    astro_transit::TransitParams truth;
+    truth.t0 = 1.7;
+    truth.period = 3.5248;
+    truth.rp = 0.118;
+    truth.aRs = 8.8;
+    truth.b = 0.36;
+    truth.u1 = kLimbU1;
+    truth.u2 = kLimbU2;
+    return truth;
+}
+
+// A deliberately poor starting point, so the fit has visible work to do.
+astro_transit::TransitParams SyntheticGuess() {
+    astro_transit::TransitParams guess = SyntheticTruth();
+    guess.t0 += 0.012;
+    guess.period *= 1.0003;
+    guess.rp *= 1.25;
+    guess.aRs *= 0.8;
+    guess.b = 0.55;
+    guess.u1 = 0.3;
+    guess.u2 = 0.3;
+    guess.f0 = 1.0005;
+    return guess;
+}
+
+// Starting point for a loaded light curve at a known period: mid-transit from the
+// deepest phase bin, depth from that bin, a/R* from Kepler's law for a Sun-like star
+// with the period in days.
+astro_transit::TransitParams GuessFromFold(const astro_transit::Photometry& data, double period) {
+    constexpr int kBins = 200;
+    std::vector<double> sum(kBins, 0.0), count(kBins, 0.0);
+    const double origin = data.t.front();
+    double mean = 0.0;
+    for (size_t i = 0; i < data.size(); ++i) {
+        const double phase = std::fmod(data.t[i] - origin, period) / period;
+        const int bin = std::min(kBins - 1, static_cast<int>(phase * kBins));
+        sum[bin] += data.flux[i];
+        count[bin] += 1.0;
+        mean += data.flux[i];
+    }
+    mean /= static_cast<double>(data.size());
+    int deepest = 0;
+    double depth = 0.0;
+    for (int b = 0; b < kBins; ++b) {
+        if (count[b] > 0.0 && mean - sum[b] / count[b] > depth) {
+            depth = mean - sum[b] / count[b];
+            deepest = b;
+        }
+    }
+    astro_transit::TransitParams guess;
+    guess.period = period;
+    const double first = origin + (deepest + 0.5) / kBins * period;
+    guess.t0 = first + std::floor((data.t[data.size() / 2] - first) / period) * period;
+    guess.rp = std::clamp(std::sqrt(std::max(1.0e-6, depth / mean)), 0.01, 0.5);
+    guess.aRs = std::max(1.5, 4.2 * std::pow(period, 2.0 / 3.0));
+    guess.b = 0.3;
+    guess.u1 = 0.4;
+    guess.u2 = 0.25;
+    guess.f0 = mean;
+    return guess;
+}
+
+double ParseDoubleArg(int argc, char** argv, const char* name, double fallback) {
+    const char* value = astro_bench::FindArg(argc, argv, name);
+    return value != nullptr ? std::strtod(value, nullptr) : fallback;
+}
+
+// Phase-folded view of the data around the fitted transit: binned means over
+// [-span, span] days from mid-transit.
+struct FoldedCurve {
+    std::vector<float> binFlux;
+    std::vector<uint8_t> binUsed;
+    float span = 0.1f;
+};
+
+void FoldLightCurve(const astro_transit::Photometry& data, const astro_transit::TransitParams& params, FoldedCurve* fold) {
+    fold->span = static_cast<float>(1.6 * astro_transit::TransitHalfWindow(params));
+    std::vector<double> sum(kFoldBins, 0.0), count(kFoldBins, 0.0);
+    for (size_t i = 0; i < data.size(); ++i) {
+        double dt = std::fmod(data.t[i] - params.t0, params.period);
+        if (dt < -0.5 * params.period) dt += params.period;
+        if (dt > 0.5 * params.period) dt -= params.period;
+        if (std::fabs(dt) >= fold->span) continue;
+        const int bin = std::min(kFoldBins - 1, static_cast<int>((dt / fold->span + 1.0) * 0.5 * kFoldBins));
+        sum[bin] += data.flux[i];
+        count[bin] += 1.0;
+    }
+    fold->binFlux.assign(kFoldBins, 0.0f);
+    fold->binUsed.assign(kFoldBins, 0);
+    for (int b = 0; b < kFoldBins; ++b) {
+        if (count[b] == 0.0) continue;
+        fold->binFlux[b] = static_cast<float>(sum[b] / count[b]);
+        fold->binUsed[b] = 1;
+    }
+}
+
+const char* StageName(astro_transit::FitSnapshot::Stage stage) {
+    switch (stage) {
+        case astro_transit::FitSnapshot::Stage::kIdle: return "idle";
+        case astro_transit::FitSnapshot::Stage::kLeastSquares: return "Levenberg-Marquardt";
+        case astro_transit::FitSnapshot::Stage::kSampling: return "ensemble sampling";
+        case astro_transit::FitSnapshot::Stage::kDone: return "done";
+        case astro_transit::FitSnapshot::Stage::kFailed: return "failed";
+    }
+    return "";
+}
+
+void DrawFitPanel(const astro_transit::FitSnapshot& snap, const FoldedCurve& fold, const char* source) {
+    DrawRectangleRec(kFitPanel, Fade(Color{20, 28, 44, 255}, 0.9f));
+    DrawText("Transit Fit", static_cast<int>(kFitPanel.x) + 20, static_cast<int>(kFitPanel.y) + 14, 22, Color{220, 230, 244, 255});
+    char s[200];
+    std::snprintf(s, sizeof(s), "%s, %zu pts", source, snap.samples);
+    DrawText(s, static_cast<int>(kFitPanel.x) + 150, static_cast<int>(kFitPanel.y) + 20, 14, Color{150, 166, 190, 255});
+
+    const astro_transit::TransitParams& p = snap.best;
+    float lo = 1.0e9f, hi = -1.0e9f;
+    for (int b = 0; b < kFoldBins; ++b) {
+        if (!fold.binUsed[b]) continue;
+        lo = std::min(lo, fold.binFlux[b]);
+        hi = std::max(hi, fold.binFlux[b]);
+    }
+    if (lo > hi) lo = hi = static_cast<float>(p.f0);
+    const float pad = 0.12f * std::max(hi - lo, 1.0e-4f);
+    lo -= pad;
+    hi += pad;
+    const auto toScreen = [&](float dt, float flux) {
+        return Vector2{kFitPlot.x + (dt / fold.span + 1.0f) * 0.5f * kFitPlot.width, kFitPlot.y + (hi - flux) / (hi - lo) * kFitPlot.height};
+    };
+    DrawRectangleLinesEx(kFitPlot, 1.0f, Fade(SKYBLUE, 0.25f));
+    for (int b = 0; b < kFoldBins; ++b) {
+        if (!fold.binUsed[b]) continue;
+        const float dt = ((b + 0.5f) / kFoldBins * 2.0f - 1.0f) * fold.span;
+        DrawCircleV(toScreen(dt, fold.binFlux[b]), 2.0f, Color{200, 210, 230, 200});
+    }
+    Vector2 prev{};
+    for (int i = 0; i < kModelSamples; ++i) {
+        const float dt = (static_cast<float>(i) / (kModelSamples - 1) * 2.0f - 1.0f) * fold.span;
+        const Vector2 q = toScreen(dt, static_cast<float>(astro_transit::ModelFluxAt(p, p.t0 + dt)));
+        if (i > 0) DrawLineEx(prev, q, 2.0f, Color{255, 170, 90, 255});
+        prev = q;
+    }
+
+    int y = static_cast<int>(kFitPlot.y + kFitPlot.height) + 12;
+    const int x = static_cast<int>(kFitPanel.x) + 20;
+    std::snprintf(s, sizeof(s), "%s  %d/%d  %.2fs", StageName(snap.stage), snap.iteration, snap.iterations, snap.seconds);
+    DrawText(s, x, y, 16, Color{126, 224, 255, 255});
+    y += 22;
+    const double reducedChi2 = snap.chi2 / static_cast<double>(std::max<size_t>(1, snap.samples));
+    if (snap.stage == astro_transit::FitSnapshot::Stage::kLeastSquares) {
+        std::snprintf(s, sizeof(s), "chi2/N = %.4f", reducedChi2);
+    } else {
+        std::snprintf(s, sizeof(s), "chi2/N = %.4f   acceptance %.2f", reducedChi2, snap.acceptance);
+    }
+    DrawText(s, x, y, 16, Color{190, 202, 222, 255});
+    y += 22;
+    std::snprintf(s, sizeof(s), "Rp/R* %.4f +- %.4f   a/R* %.2f +- %.2f", p.rp, snap.sigma[2], p.aRs, snap.sigma[3]);
+    DrawText(s, x, y, 16, Color{190, 202, 222, 255});
+    y += 20;
+    std::snprintf(s, sizeof(s), "b %.3f +- %.3f   P %.5f +- %.5f", p.b, snap.sigma[4], p.period, snap.sigma[1]);
+    DrawText(s, x, y, 16, Color{190, 202, 222, 255});
+    y += 20;
+    std::snprintf(s, sizeof(s), "u1 %.3f  u2 %.3f   F to refit", p.u1, p.u2);
+    DrawText(s, x, y, 16, Color{190, 202, 222, 255});
 }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 1, 0.0f);
+
+    // Photometry to fit: --lightcurve=file.csv --period=P [--t0=T], else synthetic.
+    astro_transit::Photometry photometry;
+    astro_transit::TransitParams guess = SyntheticGuess();
+    std::string source = "synthetic";
+    if (const char* path = astro_bench::FindArg(argc, argv, "--lightcurve")) {
+        std::string error;
+        const double period = ParseDoubleArg(argc, argv, "--period", 0.0);
+        if (!astro_transit::LoadPhotometryCsv(path, &photometry, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        if (!(period > 0.0)) {
+            std::fprintf(stderr, "--lightcurve needs --period=<days>\n");
+            return 1;
+        }
+        guess = GuessFromFold(photometry, period);
+        guess.t0 = ParseDoubleArg(argc, argv, "--t0", guess.t0);
+        source = path;
+        if (const char* slash = std::strrchr(path, '/')) source = slash + 1;
+    } else {
+        photometry = astro_transit::SyntheticPhotometry(SyntheticTruth(), kSyntheticSamples, kSyntheticSpanDays, kSyntheticNoise, 20240917);
+    }
+    astro_transit::FitOptions fitOptions;
+    fitOptions.steps = std::max(1, astro_bench::IntArg(argc, argv, "--mcmc-steps", fitOptions.steps));
+    fitOptions.burnIn = std::min(fitOptions.burnIn, fitOptions.steps / 2);
+
+    if (bench.enabled) {
+        astro_transit::FitSnapshot result;
+        return astro_bench::RunBench(
+            "exoplanet_transit_lab_viz", bench,
+            [&](float) { result = astro_transit::RunTransitFit(photometry, guess, fitOptions, [](const astro_transit::FitSnapshot&) { return true; }); },
+            [&]() {
+                for (int j = 0; j < astro_transit::kFitParams; ++j) {
+                    const double value = result.hasPosterior ? result.posteriorMean[j] : astro_transit::ToFitVector(result.best)[j];
+                    std::fprintf(stderr, "%-6s %.6f +- %.6f\n", astro_transit::FitParamName(j), value, result.sigma[j]);
+                }
+                std::fprintf(stderr, "chi2/N %.4f, acceptance %.2f, %.2fs\n", result.chi2 / std::max<size_t>(1, result.samples),
+                             result.acceptance, result.seconds);
+                return result.best.rp;
+            });
+    }
+
+    astro_transit::TransitFitter fitter;
+    fitter.Start(&photometry, guess, fitOptions);
+    FoldedCurve fold;
+    uint64_t foldedVersion = ~0ull;
+
     InitWindow(kW, kH, "Exoplanet Transit Lab 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -70,8 +303,16 @@ int main() {
         if (IsKeyDown(KEY_RIGHT_BRACKET)) planetR = std::min(0.56f, planetR + 0.32f * GetFrameTime());
         if (IsKeyDown(KEY_LEFT_BRACKET)) planetR = std::max(0.08f, planetR - 0.32f * GetFrameTime());
 
+        if (IsKeyPressed(KEY_F)) fitter.Start(&photometry, guess, fitOptions);
+
         UpdateOrbitCameraDragOnly(&cam, &yaw, &pitch, &dist);
 
+        const astro_transit::FitSnapshot fit = fitter.Snapshot();
+        if (fit.version != foldedVersion) {
+            FoldLightCurve(photometry, fit.best, &fold);
+            foldedVersion = fit.version;
+        }
+
         if (!paused) {
             float dt = GetFrameTime();
             Vector3 r = Vector3Negate(p);
@@ -106,14 +347,19 @@ int main() {
         }
 
         DrawText("Exoplanet Transit Lab (3D gravity orbit)", 20, 18, 30, Color{232, 238, 248, 255});
-        DrawText("Mouse drag orbit | wheel zoom | Up/Down star mass | [ ] planet radius | P pause | R reset", 20, 54, 18, Color{160, 182, 210, 255});
+        DrawText("Mouse drag orbit | wheel zoom | Up/Down star mass | [ ] planet radius | P pause | R reset | F refit", 20, 54, 18, Color{160, 182, 210, 255});
         char s[220];
         std::snprintf(s, sizeof(s), "M*=%.1f  Rp=%.2f  flux=%.4f%s", starMass, planetR, fluxHistory.back(), paused ? "  [PAUSED]" : "");
         DrawText(s, 20, 82, 20, Color{126, 224, 255, 255});
+        DrawFitPanel(fit, fold, source.c_str());
         DrawFPS(20, 110);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
+    fitter.Stop();
     CloseWindow();
     return 0;
 }
@@ -1,10 +1,24 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/barnes_hut_octree.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/instanced_particles.h"
+#include "../common/integrators.h"
+#include "../common/particle_soa.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+#include "../common/replay_log.h"
+#include "../common/sim_thread.h"
+#include "../common/snapshot_export.h"
+
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
-#include <random>
+#include <string>
 #include <vector>
 
 namespace {
@@ -12,6 +26,11 @@ constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kG = 7.5f;
 constexpr float kPi = 3.14159265358979323846f;
+constexpr float kStarSoftening = 0.9f;
+constexpr float kDiskMassFraction = 0.35f;
+constexpr std::array<int, 6> kStarsPerGalaxyOptions = {420, 5000, 25000, 50000, 200000, 500000};
+constexpr uint32_t kStarSeed = 42;
+constexpr float kSimRate = 60.0f;  // simulation thread steps per simulated second
 
 struct CoreBody {
     Vector3 pos;
@@ -19,10 +38,22 @@ struct CoreBody {
     float mass;
 };
 
-struct StarParticle {
-    Vector3 pos;
-    Vector3 vel;
-    int galaxyId;
+// Star kinematics live in an SoA store so the per-step kernels vectorize; mass and
+// galaxy id are parallel arrays indexed the same way.
+struct StarField {
+    astro_soa::ParticleSoA kin;
+    std::vector<float> mass;
+    std::vector<int> galaxyId;
+
+    size_t size() const { return kin.size(); }
+};
+
+struct SelfGravityState {
+    astro_nbody::BarnesHutOctree tree;
+    std::vector<Vector3> positions;
+    std::vector<Vector3> accelerations;
+    float buildMs = 0.0f;
+    float walkMs = 0.0f;
 };
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
@@ -42,14 +73,14 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     });
 }
 
-float RandRange(std::mt19937* rng, float lo, float hi) {
-    std::uniform_real_distribution<float> dist(lo, hi);
-    return dist(*rng);
-}
-
-void InitSystem(std::vector<StarParticle>* stars, CoreBody* c1, CoreBody* c2, float massRatio, float encounterSpeed, float diskScale) {
-    stars->clear();
-    stars->reserve(900);
+void InitSystem(StarField* stars, CoreBody* c1, CoreBody* c2, float massRatio, float encounterSpeed, float diskScale,
+                int nPerGalaxy) {
+    stars->kin.clear();
+    stars->mass.clear();
+    stars->galaxyId.clear();
+    stars->kin.reserve(static_cast<size_t>(2 * nPerGalaxy));
+    stars->mass.reserve(static_cast<size_t>(2 * nPerGalaxy));
+    stars->galaxyId.reserve(static_cast<size_t>(2 * nPerGalaxy));
 
     c1->mass = 22.0f;
     c2->mass = c1->mass * massRatio;
@@ -58,19 +89,23 @@ void InitSystem(std::vector<StarParticle>* stars, CoreBody* c1, CoreBody* c2, fl
     c1->vel = {0.7f * encounterSpeed, 0.0f, 0.0f};
     c2->vel = {-0.7f * encounterSpeed, 0.0f, 0.0f};
 
-    std::mt19937 rng(42);
-    const int nPerGalaxy = 420;
+    // Three uniforms per star from stream (kStarSeed, galaxy), filled in one batch.
+    const astro_random::PhiloxKey key = astro_random::SeedKey(kStarSeed);
+    std::vector<float> u(static_cast<size_t>(3 * nPerGalaxy));
     const float soft = 0.6f;
 
     for (int g = 0; g < 2; ++g) {
         CoreBody core = (g == 0) ? *c1 : *c2;
+        const float starMass = kDiskMassFraction * core.mass / static_cast<float>(nPerGalaxy);
         float diskTilt = (g == 0) ? 0.28f : -0.22f;
         float cTilt = std::cos(diskTilt);
         float sTilt = std::sin(diskTilt);
+        astro_random::FillUniform(key, static_cast<uint32_t>(g), 0, 0, u.data(), u.size());
         for (int i = 0; i < nPerGalaxy; ++i) {
-            float r = diskScale * std::sqrt(RandRange(&rng, 0.02f, 1.0f));
-            float ang = RandRange(&rng, 0.0f, 2.0f * kPi);
-            float y = RandRange(&rng, -0.22f, 0.22f);
+            const float* draw = &u[static_cast<size_t>(3 * i)];
+            float r = diskScale * std::sqrt(0.02f + 0.98f * draw[0]);
+            float ang = 2.0f * kPi * draw[1];
+            float y = -0.22f + 0.44f * draw[2];
 
             float lx = r * std::cos(ang);
             float lz = r * std::sin(ang);
@@ -83,13 +118,315 @@ void InitSystem(std::vector<StarParticle>* stars, CoreBody* c1, CoreBody* c2, fl
             Vector3 tangentTilted = {tangent.x, tangent.y * cTilt - tangent.z * sTilt, tangent.y * sTilt + tangent.z * cTilt};
             Vector3 vel = Vector3Add(core.vel, Vector3Scale(tangentTilted, vCirc));
 
-            stars->push_back({pos, vel, g});
+            stars->kin.push_back(pos, vel);
+            stars->mass.push_back(starMass);
+            stars->galaxyId.push_back(g);
+        }
+    }
+}
+
+// Star-star gravity through the octree; the two cores stay exact point masses for the
+// stars, and feel the stellar disks back through the same tree.
+void ComputeSelfGravity(SelfGravityState* state, const StarField& stars, float theta) {
+    using Clock = std::chrono::steady_clock;
+    astro_soa::GatherPositions(stars.kin, &state->positions);
+
+    const Clock::time_point t0 = Clock::now();
+    state->tree.Build(state->positions, stars.mass);
+    const Clock::time_point t1 = Clock::now();
+    state->tree.ComputeAccelerations(theta, kG, kStarSoftening, &state->accelerations);
+    const Clock::time_point t2 = Clock::now();
+
+    state->buildMs = std::chrono::duration<float, std::milli>(t1 - t0).count();
+    state->walkMs = std::chrono::duration<float, std::milli>(t2 - t1).count();
+}
+
+// Drift/kick view of the cores and stars. Kick evaluates every acceleration (and
+// rebuilds the tree when self-gravity is on), so leapfrog costs one force pass per step.
+struct MergerSystem {
+    CoreBody* c1;
+    CoreBody* c2;
+    StarField* stars;
+    SelfGravityState* selfGravityState;
+    bool selfGravity;
+    float theta;
+
+    void Drift(float h) {
+        c1->pos = Vector3Add(c1->pos, Vector3Scale(c1->vel, h));
+        c2->pos = Vector3Add(c2->pos, Vector3Scale(c2->vel, h));
+        astro_soa::Drift(&stars->kin, h);
+    }
+
+    void Kick(float h) {
+        Vector3 d = Vector3Subtract(c2->pos, c1->pos);
+        float r = std::max(1.4f, Vector3Length(d));
+        Vector3 a1 = Vector3Scale(d, kG * c2->mass / (r * r * r));
+        Vector3 a2 = Vector3Scale(d, -kG * c1->mass / (r * r * r));
+        if (selfGravity) {
+            ComputeSelfGravity(selfGravityState, *stars, theta);
+            a1 = Vector3Add(a1, selfGravityState->tree.AccelerationAt(c1->pos, theta, kG, kStarSoftening));
+            a2 = Vector3Add(a2, selfGravityState->tree.AccelerationAt(c2->pos, theta, kG, kStarSoftening));
         }
+        astro_soa::TwoCenterAcceleration(&stars->kin, {c1->pos, kG * c1->mass}, {c2->pos, kG * c2->mass}, kStarSoftening);
+        if (selfGravity) astro_soa::AddAcceleration(&stars->kin, selfGravityState->accelerations);
+
+        c1->vel = Vector3Add(c1->vel, Vector3Scale(a1, h));
+        c2->vel = Vector3Add(c2->vel, Vector3Scale(a2, h));
+        astro_soa::Kick(&stars->kin, h);
+    }
+};
+
+// Leapfrog or Yoshida-4; the Runge-Kutta methods need a fixed-size state and are not
+// offered here.
+void StepMerger(CoreBody* c1, CoreBody* c2, StarField* stars, SelfGravityState* selfGravityState, bool selfGravity,
+                float theta, astro_integrate::Method method, float dt) {
+    MergerSystem system{c1, c2, stars, selfGravityState, selfGravity, theta};
+    astro_integrate::SymplecticStep(method, system, dt);
+}
+
+// Everything the interactive loop changes. UpdateMergerScene() is the whole per-frame
+// update, so a replay log can drive it without a window; the window itself splits it
+// into the controls and the step and runs both on the simulation thread.
+struct MergerScene {
+    float massRatio = 1.0f;
+    float encounterSpeed = 1.0f;
+    float diskScale = 8.0f;
+    float simSpeed = 1.0f;
+    bool paused = false;
+    bool selfGravity = false;
+    bool instancedStars = true;
+    float theta = 0.7f;
+    int starOption = 0;
+    astro_integrate::Method method = astro_integrate::Method::Leapfrog;
+    CoreBody c1{};
+    CoreBody c2{};
+    StarField stars;
+    SelfGravityState selfGravityState;
+    int generation = 0;  // bumped by every reset, so the renderer does not blend across one
+    uint64_t steps = 0;  // since the last reset; snapshot k is the state after k steps
+    double time = 0.0;
+};
+
+void ResetMergerScene(MergerScene* scene) {
+    InitSystem(&scene->stars, &scene->c1, &scene->c2, scene->massRatio, scene->encounterSpeed, scene->diskScale,
+               kStarsPerGalaxyOptions[static_cast<size_t>(scene->starOption)]);
+    ++scene->generation;
+    scene->steps = 0;
+    scene->time = 0.0;
+}
+
+// Keys and held-key rates for one frame of `input.dt` wall seconds.
+void ApplyMergerInput(MergerScene* scene, const astro_replay::InputFrame& input) {
+    const float dt = input.dt;
+    bool needsReset = false;
+    if (input.Pressed(KEY_P)) scene->paused = !scene->paused;
+    if (input.Pressed(KEY_R)) {
+        scene->massRatio = 1.0f;
+        scene->encounterSpeed = 1.0f;
+        scene->diskScale = 8.0f;
+        scene->simSpeed = 1.0f;
+        scene->paused = false;
+        scene->selfGravity = false;
+        scene->theta = 0.7f;
+        scene->starOption = 0;
+        needsReset = true;
+    }
+    if (input.Pressed(KEY_G)) scene->selfGravity = !scene->selfGravity;
+    if (input.Pressed(KEY_I)) scene->instancedStars = !scene->instancedStars;
+    if (input.Pressed(KEY_O)) {
+        scene->method = (scene->method == astro_integrate::Method::Leapfrog) ? astro_integrate::Method::Yoshida4
+                                                                             : astro_integrate::Method::Leapfrog;
+    }
+    if (input.Pressed(KEY_N)) {
+        scene->starOption = (scene->starOption + 1) % static_cast<int>(kStarsPerGalaxyOptions.size());
+        needsReset = true;
+    }
+    if (input.Down(KEY_X)) scene->theta = std::min(1.5f, scene->theta + 0.5f * dt);
+    if (input.Down(KEY_Z)) scene->theta = std::max(0.2f, scene->theta - 0.5f * dt);
+    if (input.Down(KEY_UP)) {
+        scene->massRatio = std::min(3.0f, scene->massRatio + 0.8f * dt);
+        needsReset = true;
+    }
+    if (input.Down(KEY_DOWN)) {
+        scene->massRatio = std::max(0.25f, scene->massRatio - 0.8f * dt);
+        needsReset = true;
+    }
+    if (input.Down(KEY_RIGHT)) {
+        scene->encounterSpeed = std::min(2.6f, scene->encounterSpeed + 0.8f * dt);
+        needsReset = true;
+    }
+    if (input.Down(KEY_LEFT)) {
+        scene->encounterSpeed = std::max(0.3f, scene->encounterSpeed - 0.8f * dt);
+        needsReset = true;
+    }
+    if (input.Down(KEY_RIGHT_BRACKET)) {
+        scene->diskScale = std::min(13.0f, scene->diskScale + 2.5f * dt);
+        needsReset = true;
+    }
+    if (input.Down(KEY_LEFT_BRACKET)) {
+        scene->diskScale = std::max(4.0f, scene->diskScale - 2.5f * dt);
+        needsReset = true;
+    }
+    if (input.Down(KEY_EQUAL)) scene->simSpeed = std::min(5.0f, scene->simSpeed + 1.2f * dt);
+    if (input.Down(KEY_MINUS)) scene->simSpeed = std::max(0.2f, scene->simSpeed - 1.2f * dt);
+
+    if (needsReset) ResetMergerScene(scene);
+}
+
+// The cores as ids 0 and 1, then the stars as ids 2.., the first disk before the second.
+void ExportMergerSnapshot(astro_snapshot::SnapshotWriter* snapshots, uint64_t step, double time, const CoreBody& c1,
+                          const CoreBody& c2, const StarField& stars) {
+    if (snapshots == nullptr || !snapshots->Due(step)) return;
+    const astro_soa::ParticleSoA& kin = stars.kin;
+    snapshots->Capture(step, time, kin.size() + 2, [&](astro_snapshot::SnapshotFrame& frame) {
+        frame.Set(0, 0, c1.mass, c1.pos, c1.vel);
+        frame.Set(1, 1, c2.mass, c2.pos, c2.vel);
+        for (size_t i = 0; i < kin.size(); ++i) {
+            frame.Set(i + 2, static_cast<uint32_t>(i + 2), stars.mass[i], kin.position(i), kin.velocity(i));
+        }
+    });
+}
+
+void AdvanceMergerScene(MergerScene* scene, float dt, astro_snapshot::SnapshotWriter* snapshots = nullptr) {
+    if (scene->paused) return;
+    ExportMergerSnapshot(snapshots, scene->steps, scene->time, scene->c1, scene->c2, scene->stars);
+    StepMerger(&scene->c1, &scene->c2, &scene->stars, &scene->selfGravityState, scene->selfGravity, scene->theta,
+               scene->method, dt);
+    ++scene->steps;
+    scene->time += dt;
+}
+
+void UpdateMergerScene(MergerScene* scene, const astro_replay::InputFrame& input, astro_snapshot::SnapshotWriter* snapshots = nullptr) {
+    ASTRO_PROFILE_SCOPE("physics");
+    ApplyMergerInput(scene, input);
+    AdvanceMergerScene(scene, input.dt * scene->simSpeed, snapshots);
+}
+
+bool AnyKey(const astro_replay::InputFrame& input) {
+    for (int i = 0; i < astro_replay::kKeyBytes; ++i) {
+        if (input.keysDown[i] != 0 || input.keysPressed[i] != 0) return true;
     }
+    return false;
+}
+
+// What the renderer draws, copied out of the scene after each batch of steps. Stars
+// are ordered galaxy by galaxy, so the first perGalaxy belong to the first disk.
+struct MergerView {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    size_t perGalaxy = 0;
+    CoreBody c1{};
+    CoreBody c2{};
+    float massRatio = 1.0f;
+    float encounterSpeed = 1.0f;
+    float diskScale = 8.0f;
+    float simSpeed = 1.0f;
+    float theta = 0.7f;
+    bool paused = false;
+    bool selfGravity = false;
+    bool instancedStars = true;
+    astro_integrate::Method method = astro_integrate::Method::Leapfrog;
+    size_t treeNodes = 0;
+    float buildMs = 0.0f;
+    float walkMs = 0.0f;
+    int generation = 0;
+};
+
+void PublishMergerScene(const MergerScene& scene, MergerView& view) {
+    const astro_soa::ParticleSoA& kin = scene.stars.kin;
+    view.x.assign(kin.x.begin(), kin.x.begin() + static_cast<std::ptrdiff_t>(kin.size()));
+    view.y.assign(kin.y.begin(), kin.y.begin() + static_cast<std::ptrdiff_t>(kin.size()));
+    view.z.assign(kin.z.begin(), kin.z.begin() + static_cast<std::ptrdiff_t>(kin.size()));
+    view.perGalaxy = kin.size() / 2;
+    view.c1 = scene.c1;
+    view.c2 = scene.c2;
+    view.massRatio = scene.massRatio;
+    view.encounterSpeed = scene.encounterSpeed;
+    view.diskScale = scene.diskScale;
+    view.simSpeed = scene.simSpeed;
+    view.theta = scene.theta;
+    view.paused = scene.paused;
+    view.selfGravity = scene.selfGravity;
+    view.instancedStars = scene.instancedStars;
+    view.method = scene.method;
+    view.treeNodes = scene.selfGravityState.tree.nodes().size();
+    view.buildMs = scene.selfGravityState.buildMs;
+    view.walkMs = scene.selfGravityState.walkMs;
+    view.generation = scene.generation;
+}
+
+// Keyframe for the replay log: controls, cores and star kinematics.
+void SnapshotMergerScene(const MergerScene& scene, std::vector<uint8_t>* out) {
+    astro_replay::ByteWriter writer(out);
+    writer.Put(scene.massRatio);
+    writer.Put(scene.encounterSpeed);
+    writer.Put(scene.diskScale);
+    writer.Put(scene.simSpeed);
+    writer.Put(scene.theta);
+    writer.Put(scene.starOption);
+    writer.Put(scene.method);
+    writer.Put(scene.paused);
+    writer.Put(scene.selfGravity);
+    writer.Put(scene.c1);
+    writer.Put(scene.c2);
+    const astro_soa::ParticleSoA& kin = scene.stars.kin;
+    for (const astro_soa::AlignedFloats* a : {&kin.x, &kin.y, &kin.z, &kin.vx, &kin.vy, &kin.vz}) writer.PutArray(a->data(), a->size());
 }
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    // --snapshot=path writes the particle state every --snapshot-every steps, in every mode.
+    astro_snapshot::SnapshotWriter snapshots;
+    std::string snapshotError;
+    if (!snapshots.Open(astro_snapshot::SnapshotOptions::FromArgs(argc, argv), "galaxy_merger_nbody_viz", &snapshotError)) {
+        std::fprintf(stderr, "galaxy_merger_nbody_viz: %s\n", snapshotError.c_str());
+        return 1;
+    }
+
+    const astro_replay::ReplayOptions replay = astro_replay::ParseReplayArgs(argc, argv);
+    if (!replay.replayPath.empty()) {
+        MergerScene scene;
+        ResetMergerScene(&scene);
+        const int status = astro_replay::RunReplay(
+            "galaxy_merger_nbody_viz", replay,
+            [&](const astro_replay::InputFrame& input, const auto&) { UpdateMergerScene(&scene, input, &snapshots); },
+            [&](std::vector<uint8_t>* out) { SnapshotMergerScene(scene, out); });
+        astro_snapshot::CloseSnapshots(&snapshots, "galaxy_merger_nbody_viz");
+        return status;
+    }
+
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 120, 1.0f / 60.0f);
+    if (bench.enabled) {
+        const int perGalaxy = std::max(1, astro_bench::IntArg(argc, argv, "--stars", kStarsPerGalaxyOptions[1]));
+        const bool selfGravity = !astro_bench::HasFlag(argc, argv, "--no-self-gravity");
+        const float theta = astro_bench::FloatArg(argc, argv, "--theta", 0.7f);
+        astro_integrate::Method method = astro_integrate::Method::Leapfrog;
+        if (const char* name = astro_bench::FindArg(argc, argv, "--integrator")) {
+            if (!astro_integrate::ParseMethod(name, &method) || !astro_integrate::IsSymplectic(method)) {
+                std::fprintf(stderr, "unknown --integrator=%s (leapfrog, yoshida4)\n", name);
+                return 1;
+            }
+        }
+        CoreBody c1{};
+        CoreBody c2{};
+        StarField stars;
+        SelfGravityState selfGravityState;
+        InitSystem(&stars, &c1, &c2, 1.0f, 1.0f, 8.0f, perGalaxy);
+        uint64_t step = 0;
+        double time = 0.0;
+        const int status = astro_bench::RunBench(
+            "galaxy_merger_nbody_viz", bench,
+            [&](float dt) {
+                ExportMergerSnapshot(&snapshots, step++, time, c1, c2, stars);
+                StepMerger(&c1, &c2, &stars, &selfGravityState, selfGravity, theta, method, dt);
+                time += dt;
+            },
+            [&]() { return Vector3Distance(c1.pos, c2.pos) + stars.kin.x[0] + stars.kin.z[stars.size() - 1]; });
+        astro_snapshot::CloseSnapshots(&snapshots, "galaxy_merger_nbody_viz");
+        return status;
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Galaxy Merger (Toy N-body) 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -103,111 +440,129 @@ int main() {
     float camPitch = 0.42f;
     float camDistance = 65.0f;
 
-    float massRatio = 1.0f;
-    float encounterSpeed = 1.0f;
-    float diskScale = 8.0f;
-    float simSpeed = 1.0f;
-    bool paused = false;
+    astro_render::InstancedParticleRenderer starRenderer;
+    const bool instancingAvailable = starRenderer.Init(astro_render::InstanceShape::kScreenPoint);
 
-    CoreBody c1{};
-    CoreBody c2{};
-    std::vector<StarParticle> stars;
-    InitSystem(&stars, &c1, &c2, massRatio, encounterSpeed, diskScale);
-
-    while (!WindowShouldClose()) {
-        bool needsReset = false;
-        if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_R)) {
-            massRatio = 1.0f;
-            encounterSpeed = 1.0f;
-            diskScale = 8.0f;
-            simSpeed = 1.0f;
-            paused = false;
-            needsReset = true;
-        }
-        if (IsKeyDown(KEY_UP)) {
-            massRatio = std::min(3.0f, massRatio + 0.8f * GetFrameTime());
-            needsReset = true;
-        }
-        if (IsKeyDown(KEY_DOWN)) {
-            massRatio = std::max(0.25f, massRatio - 0.8f * GetFrameTime());
-            needsReset = true;
-        }
-        if (IsKeyDown(KEY_RIGHT)) {
-            encounterSpeed = std::min(2.6f, encounterSpeed + 0.8f * GetFrameTime());
-            needsReset = true;
-        }
-        if (IsKeyDown(KEY_LEFT)) {
-            encounterSpeed = std::max(0.3f, encounterSpeed - 0.8f * GetFrameTime());
-            needsReset = true;
-        }
-        if (IsKeyDown(KEY_RIGHT_BRACKET)) {
-            diskScale = std::min(13.0f, diskScale + 2.5f * GetFrameTime());
-            needsReset = true;
-        }
-        if (IsKeyDown(KEY_LEFT_BRACKET)) {
-            diskScale = std::max(4.0f, diskScale - 2.5f * GetFrameTime());
-            needsReset = true;
-        }
-        if (IsKeyDown(KEY_EQUAL)) simSpeed = std::min(5.0f, simSpeed + 1.2f * GetFrameTime());
-        if (IsKeyDown(KEY_MINUS)) simSpeed = std::max(0.2f, simSpeed - 1.2f * GetFrameTime());
+    // Recording needs the whole update once per logged frame, as the replay runs it, so
+    // it stays on the window thread; otherwise the scene steps on its own thread at
+    // --sim-hz and the window draws between its snapshots.
+    const bool recording = !replay.recordPath.empty();
+    const float simRate = static_cast<float>(std::clamp(astro_bench::IntArg(argc, argv, "--sim-hz", static_cast<int>(kSimRate)), 15, 1000));
+    MergerScene scene;
+    ResetMergerScene(&scene);
+    MergerView syncView;
+    astro_sim::SimThread<MergerScene, MergerView> sim;
+    if (!recording) {
+        sim.Start(std::move(scene), simRate,
+                  [&snapshots](MergerScene& state, float dt) {
+                      ASTRO_PROFILE_SCOPE("physics");
+                      AdvanceMergerScene(&state, dt, &snapshots);
+                  },
+                  PublishMergerScene, 6);
+    }
 
-        if (needsReset) InitSystem(&stars, &c1, &c2, massRatio, encounterSpeed, diskScale);
-        UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
+    astro_replay::Recorder recorder;
+    if (recording && !recorder.Open(replay.recordPath, "galaxy_merger_nbody_viz", kStarSeed)) {
+        std::fprintf(stderr, "galaxy_merger_nbody_viz: cannot write %s\n", replay.recordPath.c_str());
+    }
+    std::vector<uint8_t> keyframe;
+    uint32_t frame = 0;
 
-        if (!paused) {
-            float dt = GetFrameTime() * simSpeed;
-            Vector3 d = Vector3Subtract(c2.pos, c1.pos);
-            float r = std::max(1.4f, Vector3Length(d));
-            Vector3 a1 = Vector3Scale(d, kG * c2.mass / (r * r * r));
-            Vector3 a2 = Vector3Scale(d, -kG * c1.mass / (r * r * r));
-            c1.vel = Vector3Add(c1.vel, Vector3Scale(a1, dt));
-            c2.vel = Vector3Add(c2.vel, Vector3Scale(a2, dt));
-            c1.pos = Vector3Add(c1.pos, Vector3Scale(c1.vel, dt));
-            c2.pos = Vector3Add(c2.pos, Vector3Scale(c2.vel, dt));
-
-            const float eps = 0.9f;
-            for (StarParticle& s : stars) {
-                Vector3 r1 = Vector3Subtract(c1.pos, s.pos);
-                Vector3 r2 = Vector3Subtract(c2.pos, s.pos);
-                float d1 = std::sqrt(Vector3LengthSqr(r1) + eps * eps);
-                float d2 = std::sqrt(Vector3LengthSqr(r2) + eps * eps);
-                Vector3 a = {0.0f, 0.0f, 0.0f};
-                a = Vector3Add(a, Vector3Scale(r1, kG * c1.mass / (d1 * d1 * d1)));
-                a = Vector3Add(a, Vector3Scale(r2, kG * c2.mass / (d2 * d2 * d2)));
-                s.vel = Vector3Add(s.vel, Vector3Scale(a, dt));
-                s.pos = Vector3Add(s.pos, Vector3Scale(s.vel, dt));
+    while (!WindowShouldClose()) {
+        const astro_replay::InputFrame input = astro_replay::CaptureInput();
+        const MergerView* previous = &syncView;
+        const MergerView* view = &syncView;
+        float alpha = 1.0f;
+        if (recording) {
+            UpdateMergerScene(&scene, input, &snapshots);
+            if (recorder.recording()) {
+                recorder.Frame(frame, input);
+                if (astro_replay::Recorder::KeyframeDue(frame)) {
+                    SnapshotMergerScene(scene, &keyframe);
+                    recorder.Keyframe(frame, keyframe);
+                }
             }
+            PublishMergerScene(scene, syncView);
+        } else {
+            if (AnyKey(input)) sim.Post([input](MergerScene& state) { ApplyMergerInput(&state, input); });
+            const auto sample = sim.Sample();
+            previous = sample.previous;
+            view = sample.current;
+            alpha = previous->generation == view->generation ? sample.alpha : 1.0f;
+            sim.SetTimeScale(view->paused ? 0.0f : view->simSpeed);
         }
+        ++frame;
+        UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
+        const auto starAt = [&](size_t i) {
+            return Vector3{previous->x[i] + (view->x[i] - previous->x[i]) * alpha,
+                           previous->y[i] + (view->y[i] - previous->y[i]) * alpha,
+                           previous->z[i] + (view->z[i] - previous->z[i]) * alpha};
+        };
+        const size_t starCount = view->x.size();
+        const Vector3 c1 = Vector3Lerp(previous->c1.pos, view->c1.pos, alpha);
+        const Vector3 c2 = Vector3Lerp(previous->c2.pos, view->c2.pos, alpha);
         BeginDrawing();
         ClearBackground(Color{5, 8, 14, 255});
         BeginMode3D(camera);
         DrawGrid(40, 2.0f);
 
-        for (const StarParticle& s : stars) {
-            Color c = (s.galaxyId == 0) ? Color{130, 205, 255, 210} : Color{255, 170, 130, 210};
-            DrawPoint3D(s.pos, c);
+        if (view->instancedStars && instancingAvailable) {
+            starRenderer.Clear();
+            starRenderer.Reserve(starCount);
+            for (size_t i = 0; i < starCount; ++i) {
+                Color c = (i < view->perGalaxy) ? Color{130, 205, 255, 210} : Color{255, 170, 130, 210};
+                starRenderer.Add(starAt(i), 2.0f, c);
+            }
+            starRenderer.Draw();
+        } else {
+            for (size_t i = 0; i < starCount; ++i) {
+                Color c = (i < view->perGalaxy) ? Color{130, 205, 255, 210} : Color{255, 170, 130, 210};
+                DrawPoint3D(starAt(i), c);
+            }
         }
-        DrawSphere(c1.pos, 0.65f, Color{125, 220, 255, 255});
-        DrawSphere(c2.pos, 0.65f, Color{255, 180, 130, 255});
-        DrawLine3D(c1.pos, c2.pos, Fade(Color{220, 220, 240, 255}, 0.35f));
+        DrawSphere(c1, 0.65f, Color{125, 220, 255, 255});
+        DrawSphere(c2, 0.65f, Color{255, 180, 130, 255});
+        DrawLine3D(c1, c2, Fade(Color{220, 220, 240, 255}, 0.35f));
 
         EndMode3D();
 
         DrawText("Galaxy Merger (Toy N-body)", 20, 18, 30, Color{232, 238, 248, 255});
         DrawText("Mouse orbit | wheel zoom | Up/Down mass ratio | Left/Right encounter speed | [ ] disk size | +/- sim speed | P pause | R reset",
                  20, 54, 18, Color{164, 183, 210, 255});
+        DrawText("G self-gravity (Barnes-Hut) | Z/X opening angle | N star count | I instanced stars | O integrator", 20, 140, 18, Color{164, 183, 210, 255});
 
         char status[220];
         std::snprintf(status, sizeof(status),
-                      "M2/M1=%.2f  v_enc=%.2f  disk=%.1f  stars=%zu%s",
-                      massRatio, encounterSpeed, diskScale, stars.size(), paused ? " [PAUSED]" : "");
+                      "M2/M1=%.2f  v_enc=%.2f  disk=%.1f  stars=%zu  kernels=%s  draw=%s  %s%s",
+                      view->massRatio, view->encounterSpeed, view->diskScale, starCount, astro_soa::SimdPathName(),
+                      (view->instancedStars && instancingAvailable) ? "instanced" : "immediate",
+                      astro_integrate::MethodName(view->method), view->paused ? " [PAUSED]" : "");
         DrawText(status, 20, 84, 20, Color{126, 224, 255, 255});
         DrawFPS(20, 112);
+        if (!recording) {
+            DrawText(TextFormat("sim %.0f Hz on its own thread, load %.0f%%", simRate, 100.0f * sim.load()), 120, 112, 18,
+                     Color{150, 165, 190, 255});
+        }
+        if (view->selfGravity) {
+            char treeStatus[200];
+            std::snprintf(treeStatus, sizeof(treeStatus),
+                          "self-gravity ON  theta=%.2f  nodes=%zu  build=%.1f ms  walk=%.1f ms",
+                          view->theta, view->treeNodes, view->buildMs, view->walkMs);
+            DrawText(treeStatus, 20, 166, 18, Color{255, 214, 150, 255});
+        } else {
+            DrawText("self-gravity OFF (stars feel the two cores only)", 20, 166, 18, Color{150, 165, 190, 255});
+        }
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    sim.Stop();
+    recorder.Close();
+    astro_snapshot::CloseSnapshots(&snapshots, "galaxy_merger_nbody_viz");
+    starRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,8 +1,17 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/instanced_particles.h"
+#include "../common/particle_mesh.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+#include "../common/rotation_curve.h"
+
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <random>
@@ -15,8 +24,19 @@ constexpr int kScreenWidth = 1520;
 constexpr int kScreenHeight = 920;
 constexpr float kPi = 3.14159265358979323846f;
 constexpr float kGalaxyRadius = 20.0f;
-constexpr int kStarCount = 1150;
+constexpr std::array<int, 3> kStarCounts = {1150, 100000, 1000000};
+constexpr int kGlowLimit = 20000;  // above this, stars are flat sprites without glow or twinkle
+constexpr float kCurveRadius = kGalaxyRadius + 1.0f;  // rotation tables cover every star
 constexpr int kTracerCount = 18;
+constexpr int kLiveBaryonParticles = 40000;  // disk and bulge
+constexpr int kLiveHaloParticles = 80000;
+constexpr float kHaloTruncation = 26.0f;
+constexpr float kMeshHalfWidth = 27.0f;
+constexpr std::array<int, 2> kMeshCells = {32, 64};
+constexpr float kLiveMaxStep = 0.02f;
+constexpr int kLiveMaxSubsteps = 4;
+constexpr int kCurveBins = 40;
+constexpr uint64_t kLiveSeed = 77;
 
 enum class GravityModel {
     kBaryonsOnly = 0,
@@ -35,16 +55,21 @@ struct GalaxyParams {
     float probeRadius = 11.0f;
 };
 
-struct StarParticle {
-    float radius;
-    float theta;
-    float initialTheta;
-    float zAmplitude;
+// Appearance of one star; its orbit lives in GalaxyStars::orbits at the same index.
+struct StarLook {
     float zPhase;
     float size;
     float brightness;
     float temperature;
-    int arm;
+    Color color;  // untwinkled colour for the sprite path
+};
+
+struct GalaxyStars {
+    astro_galaxy::DiskOrbits orbits;
+    std::vector<float> initialTheta;
+    std::vector<StarLook> look;
+
+    size_t size() const { return look.size(); }
 };
 
 struct BackgroundStar {
@@ -128,6 +153,40 @@ float RotationSpeed(GravityModel model, float r, const GalaxyParams& params) {
     return std::sqrt(std::max(0.001f, MondAcceleration(gNewton, params.mondA0) * r));
 }
 
+// Speed and angular-speed tables for the three models, rebuilt only when a parameter
+// that shapes the curves changes (not the probe radius or time scale).
+class RotationCurves {
+  public:
+    void Refresh(const GalaxyParams& params) {
+        if (valid_ && SameCurves(params, built_)) return;
+        for (int modelIdx = 0; modelIdx < 3; ++modelIdx) {
+            const GravityModel model = static_cast<GravityModel>(modelIdx);
+            speed_[modelIdx].Build(kCurveRadius, [&](float r) { return RotationSpeed(model, r, params); });
+            omega_[modelIdx].Build(kCurveRadius, [&](float r) { return RotationSpeed(model, r, params) / ClampRadius(r); });
+        }
+        built_ = params;
+        valid_ = true;
+        ++builds_;
+    }
+
+    float Speed(GravityModel model, float r) const { return speed_[static_cast<int>(model)](r); }
+    float Omega(GravityModel model, float r) const { return omega_[static_cast<int>(model)](r); }
+    const astro_galaxy::RadialTable& OmegaTable(GravityModel model) const { return omega_[static_cast<int>(model)]; }
+    int builds() const { return builds_; }
+
+  private:
+    static bool SameCurves(const GalaxyParams& a, const GalaxyParams& b) {
+        return a.baryonMass == b.baryonMass && a.diskScale == b.diskScale && a.bulgeScale == b.bulgeScale &&
+               a.haloStrength == b.haloStrength && a.haloCore == b.haloCore && a.mondA0 == b.mondA0;
+    }
+
+    std::array<astro_galaxy::RadialTable, 3> speed_;
+    std::array<astro_galaxy::RadialTable, 3> omega_;
+    GalaxyParams built_;
+    bool valid_ = false;
+    int builds_ = 0;
+};
+
 Color ModelColor(GravityModel model) {
     switch (model) {
         case GravityModel::kBaryonsOnly: return Color{255, 110, 104, 255};
@@ -185,17 +244,21 @@ std::vector<BackgroundStar> BuildBackgroundStars() {
     return stars;
 }
 
-std::vector<StarParticle> BuildGalaxyStars() {
-    std::vector<StarParticle> stars;
-    stars.reserve(kStarCount);
+GalaxyStars BuildGalaxyStars(int count, float timeSeconds) {
+    GalaxyStars stars;
+    stars.orbits.reserve(count);
+    stars.initialTheta.reserve(count);
+    stars.look.reserve(count);
 
     std::mt19937 rng(42);
     std::uniform_real_distribution<float> unit(0.0f, 1.0f);
     std::normal_distribution<float> armNoise(0.0f, 0.28f);
     std::normal_distribution<float> heightNoise(0.0f, 1.0f);
     constexpr int armCount = 4;
+    const Color warm = Color{255, 208, 154, 255};
+    const Color cool = Color{156, 206, 255, 255};
 
-    for (int i = 0; i < kStarCount; ++i) {
+    for (int i = 0; i < count; ++i) {
         float u = unit(rng);
         float radius = 0.55f + kGalaxyRadius * std::pow(u, 0.62f);
         int arm = i % armCount;
@@ -208,7 +271,13 @@ std::vector<StarParticle> BuildGalaxyStars() {
         float zAmplitude = 0.03f + 0.10f * std::abs(heightNoise(rng)) + 0.10f * (radius / kGalaxyRadius);
         float zPhase = 2.0f * kPi * unit(rng);
 
-        stars.push_back({radius, theta, theta, zAmplitude, zPhase, size, brightness, temperature, arm});
+        // Per-star spread around the model's angular speed, and the vertical wobble.
+        float rate = 0.90f + 0.18f * brightness + 0.05f * std::sin(zPhase + radius * 0.11f);
+        float wobblePhase = timeSeconds * 0.7f + zPhase + radius * 0.12f;
+        stars.orbits.push_back(radius, theta, rate, 0.45f * zAmplitude, wobblePhase);
+        stars.initialTheta.push_back(theta);
+        Color color = Brighten(LerpColor(warm, cool, temperature), 0.16f + 0.13f * brightness);
+        stars.look.push_back({zPhase, size, brightness, temperature, color});
     }
 
     return stars;
@@ -222,13 +291,7 @@ std::array<TracerState, kTracerCount> BuildTracerRing(float seedPhase) {
     return tracers;
 }
 
-Vector3 GalaxyPositionFromStar(const StarParticle& star, float timeSeconds) {
-    float wobble = 0.45f * std::sin(timeSeconds * 0.7f + star.zPhase + star.radius * 0.12f);
-    float y = star.zAmplitude * wobble;
-    return {star.radius * std::cos(star.theta), y, star.radius * std::sin(star.theta)};
-}
-
-Color StarColor(const StarParticle& star, float timeSeconds) {
+Color StarColor(const StarLook& star, float timeSeconds) {
     Color warm = Color{255, 208, 154, 255};
     Color cool = Color{156, 206, 255, 255};
     float twinkle = 0.5f + 0.5f * std::sin(timeSeconds * (1.2f + 0.8f * star.brightness) + star.zPhase);
@@ -236,36 +299,243 @@ Color StarColor(const StarParticle& star, float timeSeconds) {
     return Brighten(base, 0.16f + 0.26f * twinkle * star.brightness);
 }
 
-void ResetGalaxy(std::vector<StarParticle>* stars) {
-    for (StarParticle& star : *stars) {
-        star.theta = star.initialTheta;
+void ResetGalaxy(GalaxyStars* stars) {
+    for (size_t i = 0; i < stars->size(); ++i) {
+        stars->orbits.SetAngle(i, stars->initialTheta[i]);
     }
 }
 
+// Stars advance by the cached angular-speed table; the wobble follows wall-clock time.
 void UpdateGalaxy(
-    std::vector<StarParticle>* stars,
+    GalaxyStars* stars,
     std::array<std::array<TracerState, kTracerCount>, 3>* tracers,
     GravityModel activeModel,
     const GalaxyParams& params,
-    float dt
+    const RotationCurves& curves,
+    float dt,
+    float wobbleDt
 ) {
-    for (StarParticle& star : *stars) {
-        float speed = RotationSpeed(activeModel, star.radius, params);
-        float angular = speed / ClampRadius(star.radius);
-        angular *= 0.90f + 0.18f * star.brightness + 0.05f * std::sin(star.zPhase + star.radius * 0.11f);
-        star.theta += angular * dt;
-    }
+    astro_galaxy::AdvanceOrbits(&stars->orbits, curves.OmegaTable(activeModel), dt, 0.7f * wobbleDt);
 
     for (int modelIdx = 0; modelIdx < 3; ++modelIdx) {
         GravityModel model = static_cast<GravityModel>(modelIdx);
-        float speed = RotationSpeed(model, params.probeRadius, params);
-        float angular = speed / ClampRadius(params.probeRadius);
+        float angular = curves.Omega(model, params.probeRadius);
         for (TracerState& tracer : (*tracers)[modelIdx]) {
             tracer.theta += angular * dt;
         }
     }
 }
 
+// Self-consistent galaxy: disk, bulge and (unless the halo is off) halo particles that
+// move under their own particle-mesh gravity. Only the mass and scale parameters
+// matter here; gravity is Newtonian, so the live curve has no MOND counterpart.
+struct LiveGalaxy {
+    astro_soa::ParticleSoA particles;  // disk and bulge first, then halo
+    astro_soa::AlignedFloats mass;
+    size_t diskCount = 0;  // the curve is measured from disk particles only
+    size_t baryonCount = 0;
+    astro_pm::ParticleMesh mesh;
+    GalaxyParams builtFor;
+    std::vector<float> curve;  // measured mean tangential speed per radial bin
+    std::vector<int> curveCounts;
+    float time = 0.0f;
+    float lastStepMs = 0.0f;
+    bool built = false;
+};
+
+float HaloMassTruncated(float r, const GalaxyParams& params) {
+    return HaloEnclosedMass(std::min(r, kHaloTruncation), params);
+}
+
+float LiveEnclosedMass(float r, const GalaxyParams& params) {
+    return BaryonicEnclosedMass(r, params) + HaloMassTruncated(r, params);
+}
+
+bool SameLiveModel(const GalaxyParams& a, const GalaxyParams& b) {
+    return a.baryonMass == b.baryonMass && a.diskScale == b.diskScale && a.bulgeScale == b.bulgeScale &&
+           a.haloStrength == b.haloStrength && a.haloCore == b.haloCore;
+}
+
+// Isotropic velocity dispersion of a spherical component with enclosed mass `component`
+// in the total potential, from the Jeans equation
+//     sigma^2(r) = 1 / rho(r) * int_r^rMax rho(s) M(s) / s^2 ds.
+template <typename Component>
+astro_galaxy::RadialTable JeansDispersion(Component&& component, const GalaxyParams& params, float rMax) {
+    constexpr int kSteps = 1024;
+    std::vector<double> rho(kSteps + 1), pressure(kSteps + 1, 0.0);
+    const double dr = static_cast<double>(rMax) / kSteps;
+    for (int i = 0; i <= kSteps; ++i) {
+        const double r = std::max(dr * i, 0.5 * dr);
+        const double dm = component(static_cast<float>(r + 0.5 * dr)) - component(static_cast<float>(std::max(0.0, r - 0.5 * dr)));
+        rho[static_cast<size_t>(i)] = dm / (dr * r * r);
+    }
+    for (int i = kSteps - 1; i >= 0; --i) {
+        const auto integrand = [&](int k) {
+            const double r = std::max(dr * k, 0.5 * dr);
+            return rho[static_cast<size_t>(k)] * LiveEnclosedMass(static_cast<float>(r), params) / (r * r);
+        };
+        pressure[static_cast<size_t>(i)] = pressure[static_cast<size_t>(i) + 1] + 0.5 * dr * (integrand(i) + integrand(i + 1));
+    }
+    astro_galaxy::RadialTable sigma;
+    sigma.Build(rMax, [&](float r) {
+        const size_t i = std::min(static_cast<size_t>(r / dr + 0.5), static_cast<size_t>(kSteps));
+        return rho[i] > 0.0 ? static_cast<float>(std::sqrt(pressure[i] / rho[i])) : 0.0f;
+    });
+    return sigma;
+}
+
+// Radius with enclosed fraction u of a monotone mass profile on [0, rMax].
+template <typename Component>
+float InverseMass(Component&& component, float u, float rMax) {
+    const float target = u * component(rMax);
+    float lo = 0.0f, hi = rMax;
+    for (int it = 0; it < 40; ++it) {
+        const float mid = 0.5f * (lo + hi);
+        (component(mid) < target ? lo : hi) = mid;
+    }
+    return 0.5f * (lo + hi);
+}
+
+Vector3 RandomDirection(astro_random::PhiloxStream* rng) {
+    const float z = rng->Uniform(-1.0f, 1.0f);
+    const float phi = rng->Uniform(0.0f, 2.0f * kPi);
+    const float s = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    return {s * std::cos(phi), z, s * std::sin(phi)};
+}
+
+// Velocities were drawn for the spherical analytic potential, but the mesh underestimates
+// gravity within a couple of cells of the centre and a flattened disk pulls a little
+// harder than its spherical equivalent. Scale the baryon velocities by sqrt(mesh /
+// analytic radial force), binned in radius, so they start in equilibrium with the forces
+// they will actually feel.
+void MatchMeshForce(LiveGalaxy* live, const GalaxyParams& params) {
+    astro_soa::ParticleSoA& p = live->particles;
+    const float binWidth = kGalaxyRadius / kCurveBins;
+    std::vector<double> meshForce(kCurveBins, 0.0), counts(kCurveBins, 0.0);
+    for (size_t i = 0; i < live->diskCount; ++i) {
+        const float r = std::sqrt(p.x[i] * p.x[i] + p.z[i] * p.z[i]);
+        const int bin = static_cast<int>(r / binWidth);
+        if (bin >= kCurveBins || r < 1e-4f) continue;
+        meshForce[static_cast<size_t>(bin)] -= (p.x[i] * p.ax[i] + p.z[i] * p.az[i]) / r;
+        counts[static_cast<size_t>(bin)] += 1.0;
+    }
+    astro_galaxy::RadialTable ratio;
+    ratio.Build(kGalaxyRadius, [&](float r) {
+        const int bin = std::min(static_cast<int>(r / binWidth), kCurveBins - 1);
+        if (counts[static_cast<size_t>(bin)] < 20.0) return 1.0f;
+        const float radius = (bin + 0.5f) * binWidth;
+        const float want = LiveEnclosedMass(radius, params) / (radius * radius);
+        const float got = static_cast<float>(meshForce[static_cast<size_t>(bin)] / counts[static_cast<size_t>(bin)]);
+        return std::sqrt(std::clamp(got / want, 0.05f, 1.5f));
+    });
+    for (size_t i = 0; i < live->baryonCount; ++i) {
+        const float r = i < live->diskCount ? std::sqrt(p.x[i] * p.x[i] + p.z[i] * p.z[i])
+                                            : std::sqrt(p.x[i] * p.x[i] + p.y[i] * p.y[i] + p.z[i] * p.z[i]);
+        const float s = ratio(std::min(r, kGalaxyRadius));
+        p.vx[i] *= s;
+        p.vy[i] *= s;
+        p.vz[i] *= s;
+    }
+}
+
+void BuildLiveGalaxy(LiveGalaxy* live, const GalaxyParams& params, int baryons, int halo, int cells) {
+    astro_random::PhiloxStream rng(kLiveSeed);
+    live->particles.clear();
+    live->mass.clear();
+    const bool withHalo = params.haloStrength > 0.01f && halo > 0;
+    live->particles.reserve(static_cast<size_t>(baryons + (withHalo ? halo : 0)));
+    live->mass.reserve(live->particles.size());
+
+    const auto disk = [&](float r) { return DiskMassProfile(r, params); };
+    const auto bulge = [&](float r) { return BulgeMassProfile(r, params); };
+    const auto haloMass = [&](float r) { return HaloMassTruncated(r, params); };
+    const float bulgeLimit = 0.5f * kGalaxyRadius;
+    const astro_galaxy::RadialTable bulgeSigma = JeansDispersion(bulge, params, bulgeLimit);
+
+    const int bulgeCount = static_cast<int>(0.28f * baryons);
+    const int diskCount = baryons - bulgeCount;
+    const float diskParticle = disk(kGalaxyRadius) / diskCount;
+    const float bulgeParticle = bulge(bulgeLimit) / std::max(1, bulgeCount);
+    for (int i = 0; i < diskCount; ++i) {
+        const float r = InverseMass(disk, rng.Uniform(), kGalaxyRadius);
+        const float theta = rng.Uniform(0.0f, 2.0f * kPi);
+        const float vc = std::sqrt(LiveEnclosedMass(r, params) / ClampRadius(r));
+        const float c = std::cos(theta), sn = std::sin(theta);
+        const float vPhi = vc * (1.0f + 0.06f * rng.Normal());
+        const float vR = 0.08f * vc * rng.Normal();
+        live->particles.push_back({r * c, 0.12f * rng.Normal(), r * sn}, {vR * c - vPhi * sn, 0.04f * vc * rng.Normal(), vR * sn + vPhi * c});
+        live->mass.push_back(diskParticle);
+    }
+    live->diskCount = live->particles.size();
+    for (int i = 0; i < bulgeCount; ++i) {
+        const float r = InverseMass(bulge, rng.Uniform(), bulgeLimit);
+        const float sigma = bulgeSigma(r);
+        live->particles.push_back(Vector3Scale(RandomDirection(&rng), r), {sigma * rng.Normal(), sigma * rng.Normal(), sigma * rng.Normal()});
+        live->mass.push_back(bulgeParticle);
+    }
+    live->baryonCount = live->particles.size();
+
+    if (withHalo) {
+        const astro_galaxy::RadialTable haloSigma = JeansDispersion(haloMass, params, kHaloTruncation);
+        const float haloParticle = haloMass(kHaloTruncation) / halo;
+        for (int i = 0; i < halo; ++i) {
+            const float r = InverseMass(haloMass, rng.Uniform(), kHaloTruncation);
+            const float sigma = haloSigma(r);
+            live->particles.push_back(Vector3Scale(RandomDirection(&rng), r), {sigma * rng.Normal(), sigma * rng.Normal(), sigma * rng.Normal()});
+            live->mass.push_back(haloParticle);
+        }
+    }
+
+    live->mesh.Configure(cells, kMeshHalfWidth);
+    live->mesh.Accelerations(&live->particles, live->mass);
+    MatchMeshForce(live, params);
+    astro_galaxy::MeasureRotationCurve(live->particles, 0, live->diskCount, kGalaxyRadius, kCurveBins, &live->curve, &live->curveCounts);
+    live->builtFor = params;
+    live->time = 0.0f;
+    live->built = true;
+}
+
+// Kick-drift-kick leapfrog with one mesh solve per substep.
+void StepLiveGalaxy(LiveGalaxy* live, float dt) {
+    if (dt <= 0.0f) return;
+    const auto t0 = std::chrono::steady_clock::now();
+    const int substeps = std::min(kLiveMaxSubsteps, static_cast<int>(std::ceil(dt / kLiveMaxStep)));
+    const float h = dt / substeps;
+    for (int s = 0; s < substeps; ++s) {
+        astro_soa::Kick(&live->particles, 0.5f * h);
+        astro_soa::Drift(&live->particles, h);
+        live->mesh.Accelerations(&live->particles, live->mass);
+        astro_soa::Kick(&live->particles, 0.5f * h);
+    }
+    live->time += dt;
+    astro_galaxy::MeasureRotationCurve(live->particles, 0, live->diskCount, kGalaxyRadius, kCurveBins, &live->curve, &live->curveCounts);
+    live->lastStepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Measured speed at radius r, linearly interpolated between populated bins.
+float LiveSpeedAt(const LiveGalaxy& live, float r) {
+    const float x = r * kCurveBins / kGalaxyRadius - 0.5f;
+    const int i = std::clamp(static_cast<int>(std::floor(x)), 0, kCurveBins - 2);
+    const float f = std::clamp(x - i, 0.0f, 1.0f);
+    return live.curve[static_cast<size_t>(i)] + f * (live.curve[static_cast<size_t>(i) + 1] - live.curve[static_cast<size_t>(i)]);
+}
+
+void DrawLiveGalaxy(const LiveGalaxy& live, astro_render::InstancedParticleRenderer* sprites) {
+    const Color warm = Color{255, 208, 154, 255};
+    const Color cool = Color{156, 206, 255, 255};
+    sprites->Clear();
+    sprites->Reserve(live.particles.size());
+    for (size_t i = live.baryonCount; i < live.particles.size(); i += 2) {
+        sprites->Add(live.particles.position(i), 0.05f, Color{90, 196, 255, 40});
+    }
+    for (size_t i = 0; i < live.baryonCount; ++i) {
+        const Vector3 p = live.particles.position(i);
+        const float t = std::sqrt(p.x * p.x + p.z * p.z) / kGalaxyRadius;
+        sprites->Add(p, 0.06f, Brighten(LerpColor(warm, cool, t), 0.2f));
+    }
+    sprites->Draw();
+}
+
 void DrawBackground(const std::vector<BackgroundStar>& stars, float timeSeconds) {
     DrawRectangleGradientV(0, 0, kScreenWidth, kScreenHeight, Color{7, 10, 24, 255}, Color{1, 3, 10, 255});
     DrawCircleGradient(210, 140, 280.0f, Fade(Color{38, 68, 122, 255}, 0.22f), BLANK);
@@ -301,17 +571,34 @@ void DrawGalaxyPlane(const GalaxyParams& params, float timeSeconds) {
     }
 }
 
-void DrawGalaxyStars(const std::vector<StarParticle>& stars, float timeSeconds) {
-    for (const StarParticle& star : stars) {
-        Vector3 pos = GalaxyPositionFromStar(star, timeSeconds);
-        Color color = StarColor(star, timeSeconds);
-        float glow = star.size * (1.4f + 0.9f * star.brightness);
-        DrawSphere(pos, glow, Fade(color, 0.10f));
-        DrawSphere(pos, star.size, color);
+// Small galaxies keep the twinkling glow spheres; large ones draw one sprite per star.
+void DrawGalaxyStars(const GalaxyStars& stars, float timeSeconds, astro_render::InstancedParticleRenderer* spheres,
+                     astro_render::InstancedParticleRenderer* sprites) {
+    const size_t n = stars.size();
+    if (n <= static_cast<size_t>(kGlowLimit)) {
+        spheres->Clear();
+        spheres->Reserve(2 * n);
+        for (size_t i = 0; i < n; ++i) {
+            const StarLook& star = stars.look[i];
+            Vector3 pos = stars.orbits.Position(i);
+            Color color = StarColor(star, timeSeconds);
+            float glow = star.size * (1.4f + 0.9f * star.brightness);
+            spheres->Add(pos, glow, Fade(color, 0.10f));
+            spheres->Add(pos, star.size, color);
+        }
+        spheres->Draw();
+        return;
     }
+    sprites->Clear();
+    sprites->Reserve(n);
+    for (size_t i = 0; i < n; ++i) sprites->Add(stars.orbits.Position(i), 0.6f * stars.look[i].size, stars.look[i].color);
+    sprites->Draw();
 }
 
-void DrawProbeRing(const GalaxyParams& params, const std::array<std::array<TracerState, kTracerCount>, 3>& tracers, GravityModel activeModel) {
+constexpr Color kLiveColor = Color{132, 240, 150, 255};
+
+void DrawProbeRing(const GalaxyParams& params, const std::array<std::array<TracerState, kTracerCount>, 3>& tracers, GravityModel activeModel,
+                   const std::array<TracerState, kTracerCount>* liveTracers) {
     DrawCircle3D({0.0f, 0.0f, 0.0f}, params.probeRadius, {1.0f, 0.0f, 0.0f}, 90.0f, Fade(Color{235, 240, 250, 255}, 0.26f));
 
     for (int modelIdx = 0; modelIdx < 3; ++modelIdx) {
@@ -329,9 +616,19 @@ void DrawProbeRing(const GalaxyParams& params, const std::array<std::array<Trace
             DrawSphere(pos, radius, Brighten(color, model == activeModel ? 0.18f : 0.0f));
         }
     }
+
+    // Tracers driven by the speed the N-body disk actually has at the probe radius.
+    if (liveTracers != nullptr) {
+        for (const TracerState& tracer : *liveTracers) {
+            Vector3 pos = {params.probeRadius * std::cos(tracer.theta), 0.28f, params.probeRadius * std::sin(tracer.theta)};
+            DrawSphere(pos, 0.29f, Fade(kLiveColor, 0.16f));
+            DrawSphere(pos, 0.16f, kLiveColor);
+        }
+    }
 }
 
-void DrawCurvePanel(Rectangle panel, const GalaxyParams& params, GravityModel activeModel, float timeSeconds) {
+void DrawCurvePanel(Rectangle panel, const GalaxyParams& params, const RotationCurves& curves, GravityModel activeModel, float timeSeconds,
+                    const LiveGalaxy* live) {
     DrawRectangleRounded(panel, 0.06f, 16, Fade(Color{8, 15, 30, 255}, 0.88f));
     DrawRectangleRoundedLinesEx(panel, 0.06f, 16, 1.5f, Fade(Color{118, 146, 186, 255}, 0.38f));
 
@@ -344,9 +641,12 @@ void DrawCurvePanel(Rectangle panel, const GalaxyParams& params, GravityModel ac
         GravityModel model = static_cast<GravityModel>(modelIdx);
         for (int i = 1; i <= 160; ++i) {
             float r = maxRadius * static_cast<float>(i) / 160.0f;
-            maxSpeed = std::max(maxSpeed, RotationSpeed(model, r, params));
+            maxSpeed = std::max(maxSpeed, curves.Speed(model, r));
         }
     }
+    if (live != nullptr) {
+        for (float v : live->curve) maxSpeed = std::max(maxSpeed, v);
+    }
     maxSpeed *= 1.08f;
 
     for (int i = 0; i <= 5; ++i) {
@@ -369,10 +669,10 @@ void DrawCurvePanel(Rectangle panel, const GalaxyParams& params, GravityModel ac
         Color color = ModelColor(model);
         color = Brighten(color, model == activeModel ? 0.18f : 0.0f);
 
-        Vector2 prev = mapPoint(0.25f, RotationSpeed(model, 0.25f, params));
+        Vector2 prev = mapPoint(0.25f, curves.Speed(model, 0.25f));
         for (int i = 1; i <= 220; ++i) {
             float r = 0.25f + (maxRadius - 0.25f) * static_cast<float>(i) / 220.0f;
-            Vector2 next = mapPoint(r, RotationSpeed(model, r, params));
+            Vector2 next = mapPoint(r, curves.Speed(model, r));
             DrawLineEx(prev, next, model == activeModel ? 3.2f : 2.0f, color);
             prev = next;
         }
@@ -380,19 +680,36 @@ void DrawCurvePanel(Rectangle panel, const GalaxyParams& params, GravityModel ac
 
     for (int i = 0; i < 14; ++i) {
         float r = 1.2f + 1.25f * static_cast<float>(i);
-        float vDark = RotationSpeed(GravityModel::kDarkMatter, r, params);
-        float vMond = RotationSpeed(GravityModel::kMond, r, params);
+        float vDark = curves.Speed(GravityModel::kDarkMatter, r);
+        float vMond = curves.Speed(GravityModel::kMond, r);
         float observed = 0.55f * vDark + 0.45f * vMond + 0.12f * std::sin(timeSeconds * 0.8f + i * 0.8f);
         DrawCircleV(mapPoint(r, observed), 3.1f, Color{238, 243, 250, 235});
     }
 
+    if (live != nullptr) {
+        bool havePrev = false;
+        Vector2 prev{};
+        for (int b = 0; b < kCurveBins; ++b) {
+            if (live->curveCounts[static_cast<size_t>(b)] < 20) continue;
+            const float r = (b + 0.5f) * kGalaxyRadius / kCurveBins;
+            const Vector2 point = mapPoint(r, live->curve[static_cast<size_t>(b)]);
+            if (havePrev) DrawLineEx(prev, point, 2.0f, Fade(kLiveColor, 0.7f));
+            DrawCircleV(point, 3.6f, kLiveColor);
+            prev = point;
+            havePrev = true;
+        }
+        char liveText[64];
+        std::snprintf(liveText, sizeof(liveText), "green: live N-body, t=%.1f", live->time);
+        DrawText(liveText, static_cast<int>(panel.x + panel.width - 236), static_cast<int>(panel.y + 18), 17, kLiveColor);
+    }
+
     Vector2 probeLineStart = mapPoint(params.probeRadius, 0.0f);
     Vector2 probeLineEnd = mapPoint(params.probeRadius, maxSpeed);
     DrawLineEx(probeLineStart, probeLineEnd, 1.6f, Fade(Color{240, 246, 255, 255}, 0.38f));
 
     for (int modelIdx = 0; modelIdx < 3; ++modelIdx) {
         GravityModel model = static_cast<GravityModel>(modelIdx);
-        float v = RotationSpeed(model, params.probeRadius, params);
+        float v = curves.Speed(model, params.probeRadius);
         DrawCircleV(mapPoint(params.probeRadius, v), 4.8f, Brighten(ModelColor(model), 0.14f));
     }
 
@@ -425,14 +742,14 @@ void DrawCurvePanel(Rectangle panel, const GalaxyParams& params, GravityModel ac
     DrawText("toy observations", legendX + 14, legendY - 9, 18, Color{224, 232, 244, 255});
 }
 
-void DrawInfoPanel(const GalaxyParams& params, GravityModel activeModel, bool paused) {
-    Rectangle panel = {24.0f, 20.0f, 490.0f, 162.0f};
+void DrawInfoPanel(const GalaxyParams& params, GravityModel activeModel, bool paused, size_t starCount, float updateMs, const LiveGalaxy* live) {
+    Rectangle panel = {24.0f, 20.0f, 490.0f, 186.0f};
     DrawRectangleRounded(panel, 0.06f, 16, Fade(Color{8, 15, 30, 255}, 0.78f));
     DrawRectangleRoundedLinesEx(panel, 0.06f, 16, 1.5f, Fade(Color{118, 146, 186, 255}, 0.32f));
 
     DrawText("Dark Matter vs MOND: Galaxy Rotation", 42, 36, 31, Color{235, 240, 248, 255});
     DrawText("3D toy comparison of flat rotation curves", 42, 70, 18, Color{154, 186, 226, 255});
-    DrawText("Mouse orbit | wheel zoom | 1 baryons | 2 dark halo | 3 MOND | Left/Right probe | Q/A halo | W/S MOND a0 | +/- time | P pause | R reset",
+    DrawText("Mouse orbit | wheel zoom | 1 baryons | 2 dark halo | 3 MOND | Left/Right probe | Q/A halo | W/S MOND a0 | +/- time | N stars | B live N-body | G mesh | P pause | R reset",
              42, 98, 18, Color{176, 193, 216, 255});
 
     char status[256];
@@ -448,11 +765,46 @@ void DrawInfoPanel(const GalaxyParams& params, GravityModel activeModel, bool pa
         paused ? "   [PAUSED]" : ""
     );
     DrawText(status, 42, 128, 19, Brighten(ModelColor(activeModel), 0.14f));
+
+    char perf[128];
+    if (live != nullptr) {
+        const int n = live->mesh.cells();
+        std::snprintf(perf, sizeof(perf), "live N-body: %zu baryons + %zu halo, PM %d^3 (%d^3 padded)  %.1f ms", live->baryonCount,
+                      live->particles.size() - live->baryonCount, n, 2 * n, live->lastStepMs);
+    } else {
+        std::snprintf(perf, sizeof(perf), "stars=%zu   orbit update %.2f ms (%s)", starCount, updateMs, astro_soa::SimdPathName());
+    }
+    DrawText(perf, 42, 156, 18, Color{176, 193, 216, 255});
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 240, 1.0f / 60.0f);
+    if (bench.enabled) {
+        GalaxyParams params;
+        if (astro_bench::HasFlag(argc, argv, "--live")) {
+            LiveGalaxy live;
+            BuildLiveGalaxy(&live, params, kLiveBaryonParticles, kLiveHaloParticles,
+                            std::max(8, astro_bench::IntArg(argc, argv, "--mesh", kMeshCells.front())));
+            return astro_bench::RunBench(
+                "galaxy_rotation_dark_matter_viz_live", bench, [&](float dt) { StepLiveGalaxy(&live, dt * params.timeScale); },
+                [&]() { return LiveSpeedAt(live, params.probeRadius); });
+        }
+        RotationCurves curves;
+        curves.Refresh(params);
+        GalaxyStars stars = BuildGalaxyStars(std::max(1, astro_bench::IntArg(argc, argv, "--stars", kStarCounts.back())), 0.0f);
+        std::array<std::array<TracerState, kTracerCount>, 3> tracers = {BuildTracerRing(0.0f), BuildTracerRing(0.8f), BuildTracerRing(1.6f)};
+        return astro_bench::RunBench(
+            "galaxy_rotation_dark_matter_viz", bench,
+            [&](float dt) { UpdateGalaxy(&stars, &tracers, GravityModel::kDarkMatter, params, curves, dt * params.timeScale, dt); },
+            [&]() {
+                float sum = 0.0f;
+                for (size_t i = 0; i < stars.size(); i += 97) sum += stars.orbits.cosTheta[i];
+                return sum;
+            });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Dark Matter vs MOND Galaxy Rotation - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -471,19 +823,42 @@ int main() {
     GravityModel activeModel = GravityModel::kDarkMatter;
     bool paused = false;
 
-    std::vector<StarParticle> galaxyStars = BuildGalaxyStars();
+    size_t starCountIndex = 0;
+    GalaxyStars galaxyStars = BuildGalaxyStars(kStarCounts[starCountIndex], 0.0f);
+    RotationCurves curves;
+    astro_render::InstancedParticleRenderer starSpheres;
+    starSpheres.Init(astro_render::InstanceShape::kSphere);
+    astro_render::InstancedParticleRenderer starSprites;
+    starSprites.Init(astro_render::InstanceShape::kBillboard);
+    float updateMs = 0.0f;
     std::vector<BackgroundStar> backgroundStars = BuildBackgroundStars();
     std::array<std::array<TracerState, kTracerCount>, 3> tracers = {
         BuildTracerRing(0.0f),
         BuildTracerRing(0.8f),
         BuildTracerRing(1.6f)
     };
+    LiveGalaxy live;
+    bool liveMode = false;
+    size_t meshIndex = 0;
+    std::array<TracerState, kTracerCount> liveTracers = BuildTracerRing(0.4f);
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_ONE)) activeModel = GravityModel::kBaryonsOnly;
         if (IsKeyPressed(KEY_TWO)) activeModel = GravityModel::kDarkMatter;
         if (IsKeyPressed(KEY_THREE)) activeModel = GravityModel::kMond;
         if (IsKeyPressed(KEY_P)) paused = !paused;
+        if (IsKeyPressed(KEY_N)) {
+            starCountIndex = (starCountIndex + 1) % kStarCounts.size();
+            galaxyStars = BuildGalaxyStars(kStarCounts[starCountIndex], static_cast<float>(GetTime()));
+        }
+        if (IsKeyPressed(KEY_B)) {
+            liveMode = !liveMode;
+            if (liveMode && !live.built) BuildLiveGalaxy(&live, params, kLiveBaryonParticles, kLiveHaloParticles, kMeshCells[meshIndex]);
+        }
+        if (IsKeyPressed(KEY_G)) {
+            meshIndex = (meshIndex + 1) % kMeshCells.size();
+            if (live.built) BuildLiveGalaxy(&live, params, kLiveBaryonParticles, kLiveHaloParticles, kMeshCells[meshIndex]);
+        }
         if (IsKeyPressed(KEY_R)) {
             params = GalaxyParams{};
             activeModel = GravityModel::kDarkMatter;
@@ -494,6 +869,8 @@ int main() {
                 BuildTracerRing(0.8f),
                 BuildTracerRing(1.6f)
             };
+            liveTracers = BuildTracerRing(0.4f);
+            if (live.built) BuildLiveGalaxy(&live, params, kLiveBaryonParticles, kLiveHaloParticles, kMeshCells[meshIndex]);
         }
 
         if (IsKeyDown(KEY_RIGHT)) params.probeRadius = std::min(kGalaxyRadius - 1.0f, params.probeRadius + 7.0f * GetFrameTime());
@@ -507,9 +884,19 @@ int main() {
 
         UpdateOrbitCamera(&camera, &cameraYaw, &cameraPitch, &cameraDistance);
 
-        float dt = GetFrameTime() * params.timeScale;
-        if (!paused) {
-            UpdateGalaxy(&galaxyStars, &tracers, activeModel, params, dt);
+        curves.Refresh(params);
+        float dt = paused ? 0.0f : GetFrameTime() * params.timeScale;
+        const auto updateStart = std::chrono::steady_clock::now();
+        UpdateGalaxy(&galaxyStars, &tracers, activeModel, params, curves, dt, GetFrameTime());
+        updateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - updateStart).count();
+        if (liveMode) {
+            // Halo edits rebuild the live galaxy once the key is released, not every frame.
+            if (!SameLiveModel(params, live.builtFor) && !IsKeyDown(KEY_Q) && !IsKeyDown(KEY_A)) {
+                BuildLiveGalaxy(&live, params, kLiveBaryonParticles, kLiveHaloParticles, kMeshCells[meshIndex]);
+            }
+            StepLiveGalaxy(&live, dt);
+            const float liveOmega = LiveSpeedAt(live, params.probeRadius) / params.probeRadius;
+            for (TracerState& tracer : liveTracers) tracer.theta += liveOmega * dt;
         }
 
         float timeSeconds = static_cast<float>(GetTime());
@@ -519,12 +906,16 @@ int main() {
 
         BeginMode3D(camera);
         DrawGalaxyPlane(params, timeSeconds);
-        DrawGalaxyStars(galaxyStars, timeSeconds);
-        DrawProbeRing(params, tracers, activeModel);
+        if (liveMode) {
+            DrawLiveGalaxy(live, &starSprites);
+        } else {
+            DrawGalaxyStars(galaxyStars, timeSeconds, &starSpheres, &starSprites);
+        }
+        DrawProbeRing(params, tracers, activeModel, liveMode ? &liveTracers : nullptr);
         EndMode3D();
 
-        DrawInfoPanel(params, activeModel, paused);
-        DrawCurvePanel({940.0f, 28.0f, 548.0f, 360.0f}, params, activeModel, timeSeconds);
+        DrawInfoPanel(params, activeModel, paused, galaxyStars.size(), updateMs, liveMode ? &live : nullptr);
+        DrawCurvePanel({940.0f, 28.0f, 548.0f, 360.0f}, params, curves, activeModel, timeSeconds, liveMode ? &live : nullptr);
 
         DrawRectangleRounded({940.0f, 406.0f, 548.0f, 120.0f}, 0.06f, 12, Fade(Color{8, 15, 30, 255}, 0.80f));
         DrawRectangleRoundedLinesEx({940.0f, 406.0f, 548.0f, 120.0f}, 0.06f, 12, 1.5f, Fade(Color{118, 146, 186, 255}, 0.30f));
@@ -534,9 +925,14 @@ int main() {
         DrawText("Gold stays flatter by modifying the low-acceleration law instead.", 960, 508, 18, Color{255, 215, 132, 255});
 
         DrawFPS(28, kScreenHeight - 38);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    starSprites.Unload();
+    starSpheres.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
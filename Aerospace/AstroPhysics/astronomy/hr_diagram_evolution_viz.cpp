@@ -1,15 +1,47 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/point_cloud.h"
+#include "../common/profiler.h"
+#include "../common/stellar_tracks.h"
+#include "../common/thread_pool.h"
+
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
-#include <deque>
+#include <string>
+#include <vector>
 
 namespace {
 constexpr int kW = 1280;
 constexpr int kH = 820;
 
+constexpr int kDefaultStars = 100000;
+constexpr int kIsochroneMasses = 480;
+constexpr const char* kSyntheticTracksPath = "synthetic.tracks";
+constexpr float kMinLogAge = 5.0f;
+constexpr float kMaxLogAge = 10.15f;
+constexpr float kStartLogAge = 6.5f;
+constexpr float kDefaultAgeRate = 0.12f;   // dex of age per second
+constexpr float kFehStep = 0.25f;
+constexpr float kFehSpread = 0.03f;        // star-to-star scatter in [Fe/H]
+constexpr float kPointPixels = 1.5f;
+constexpr uint64_t kClusterSeed = 20240801;
+
+// Diagram box: log Teff 4.9 .. 3.3 (hot on the left) along x, log L -4.5 .. 6.5 along y,
+// log age 5 .. 10.3 along z, filling the 12 x 9 x 13 box centred on (0, 4, 0).
+constexpr float kHotLogT = 4.9f, kCoolLogT = 3.3f;
+constexpr float kDimLogL = -4.5f, kBrightLogL = 6.5f;
+constexpr float kAxisMinLogAge = 5.0f, kAxisMaxLogAge = 10.3f;
+
+// Colours by log Teff on a fixed grid, so 10^5 stars a frame need no pow().
+constexpr int kColorLutSize = 256;
+constexpr float kLutMinLogT = 3.3f, kLutMaxLogT = 5.2f;
+
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dist) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 d = GetMouseDelta();
@@ -22,9 +54,180 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
     float cp = std::cos(*pitch);
     c->position = Vector3Add(c->target, {*dist * cp * std::cos(*yaw), *dist * std::sin(*pitch), *dist * cp * std::sin(*yaw)});
 }
+
+Vector3 HrPoint(float logTeff, float logL, float logAge) {
+    const float x = -6.0f + 12.0f * (kHotLogT - std::clamp(logTeff, kCoolLogT, kHotLogT)) / (kHotLogT - kCoolLogT);
+    const float y = -0.5f + 9.0f * (std::clamp(logL, kDimLogL, kBrightLogL) - kDimLogL) / (kBrightLogL - kDimLogL);
+    const float z = -6.5f + 13.0f * (std::clamp(logAge, kAxisMinLogAge, kAxisMaxLogAge) - kAxisMinLogAge) / (kAxisMaxLogAge - kAxisMinLogAge);
+    return {x, y, z};
+}
+
+using ColorLut = std::array<Color, kColorLutSize>;
+
+ColorLut BuildColorLut() {
+    ColorLut lut{};
+    for (int i = 0; i < kColorLutSize; ++i) {
+        const float logT = kLutMinLogT + (kLutMaxLogT - kLutMinLogT) * i / (kColorLutSize - 1);
+        const std::array<uint8_t, 3> rgb = astro_catalog::BlackbodyColor(std::pow(10.0f, logT));
+        lut[static_cast<size_t>(i)] = Color{rgb[0], rgb[1], rgb[2], 255};
+    }
+    return lut;
+}
+
+Color LutColor(const ColorLut& lut, float logTeff) {
+    const float x = (logTeff - kLutMinLogT) / (kLutMaxLogT - kLutMinLogT) * (kColorLutSize - 1);
+    return lut[static_cast<size_t>(std::clamp(static_cast<int>(x + 0.5f), 0, kColorLutSize - 1))];
+}
+
+// Stars per evolutionary stage, for the HUD.
+struct PhaseCounts {
+    int preMain = 0, main = 0, giants = 0, helium = 0, agb = 0, whiteDwarfs = 0, gone = 0;
+};
+
+void CountPhase(float phase, PhaseCounts* counts) {
+    const int p = static_cast<int>(std::lround(phase));
+    if (p == astro_stellar::kPhasePreMainSequence) {
+        ++counts->preMain;
+    } else if (p == astro_stellar::kPhaseMainSequence) {
+        ++counts->main;
+    } else if (p == astro_stellar::kPhaseRedGiant) {
+        ++counts->giants;
+    } else if (p == astro_stellar::kPhaseCoreHelium || p == astro_stellar::kPhaseWolfRayet) {
+        ++counts->helium;
+    } else if (p == astro_stellar::kPhaseEarlyAgb || p == astro_stellar::kPhaseThermalPulseAgb) {
+        ++counts->agb;
+    } else if (p == astro_stellar::kPhasePostAgb) {
+        ++counts->whiteDwarfs;
+    } else {
+        ++counts->gone;
+    }
+}
+
+bool IsRemnant(float phase) { return phase >= astro_stellar::kPhaseRemnant - 0.5f; }
+
+// A single-age cluster: Kroupa masses over the table's range with a small [Fe/H] scatter,
+// plus a thin log-spaced mass sequence at the mean [Fe/H] that traces the isochrone line.
+struct Cluster {
+    std::vector<float> mass, feh;
+    astro_stellar::ClusterEvolver stars;
+    std::vector<float> isoMass, isoFeh;
+    astro_stellar::ClusterEvolver isochrone;
+    float meanFeh = 0.0f;
+};
+
+void BuildCluster(const astro_stellar::TrackTable& table, int count, float meanFeh, Cluster* cluster) {
+    astro_random::PhiloxStream rng(kClusterSeed);
+    const float lo = table.minMass(), hi = table.maxMass();
+    cluster->meanFeh = std::clamp(meanFeh, table.minFeh(), table.maxFeh());
+    cluster->mass.resize(static_cast<size_t>(count));
+    cluster->feh.resize(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        cluster->mass[static_cast<size_t>(i)] = astro_stellar::SampleKroupaMass(rng, lo, hi);
+        cluster->feh[static_cast<size_t>(i)] = cluster->meanFeh + kFehSpread * rng.Normal();
+    }
+    cluster->stars.Bind(&table, cluster->mass.data(), cluster->feh.data(), cluster->mass.size());
+
+    cluster->isoMass.resize(kIsochroneMasses);
+    cluster->isoFeh.assign(kIsochroneMasses, cluster->meanFeh);
+    for (int i = 0; i < kIsochroneMasses; ++i) {
+        cluster->isoMass[static_cast<size_t>(i)] = lo * std::pow(hi / lo, static_cast<float>(i) / (kIsochroneMasses - 1));
+    }
+    cluster->isochrone.Bind(&table, cluster->isoMass.data(), cluster->isoFeh.data(), cluster->isoMass.size());
+}
+
+void EvolveCluster(Cluster* cluster, float logAge, astro_parallel::ThreadPool& pool) {
+    cluster->stars.Evaluate(logAge, pool);
+    cluster->isochrone.Evaluate(logAge, pool);
+}
+
+// Live stars as cloud points on the isochrone plane; remnants are left out.
+void FillCloud(const Cluster& cluster, float logAge, const ColorLut& lut, std::vector<astro_render::CloudPoint>* points,
+               PhaseCounts* counts) {
+    points->clear();
+    *counts = PhaseCounts{};
+    const astro_stellar::ClusterEvolver& stars = cluster.stars;
+    for (size_t i = 0; i < stars.size(); ++i) {
+        CountPhase(stars.phase()[i], counts);
+        if (IsRemnant(stars.phase()[i])) continue;
+        Color color = LutColor(lut, stars.logTeff()[i]);
+        color.a = stars.phase()[i] > astro_stellar::kPhaseMainSequence + 0.5f ? 255 : 150;
+        points->push_back({HrPoint(stars.logTeff()[i], stars.logL()[i], logAge), color});
+    }
+}
+
+// --pack=<dir of MIST .eep files> writes --out (default mist.tracks) and uses it;
+// --tracks=<file> maps an existing table; otherwise the synthetic grid is packed to
+// synthetic.tracks on first run and mapped from then on.
+bool OpenTracks(int argc, char** argv, astro_stellar::TrackTable* table) {
+    std::string error;
+    std::string path = kSyntheticTracksPath;
+    if (const char* dir = astro_bench::FindArg(argc, argv, "--pack")) {
+        const char* out = astro_bench::FindArg(argc, argv, "--out");
+        path = out != nullptr ? out : "mist.tracks";
+        astro_stellar::TrackGrid grid;
+        if (!astro_stellar::ReadMistDirectory(dir, &grid, &error) || !astro_stellar::PackTracks(grid, path, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        std::printf("packed %zu x %zu tracks of %d EEPs into %s\n", grid.logMass.size(), grid.feh.size(), grid.eepCount, path.c_str());
+    } else if (const char* file = astro_bench::FindArg(argc, argv, "--tracks")) {
+        path = file;
+    } else if (!table->Open(path, &error)) {
+        if (!astro_stellar::PackTracks(astro_stellar::SyntheticTrackGrid(), path, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        std::printf("packed synthetic tracks into %s\n", path.c_str());
+    }
+    if (!table->open() && !table->Open(path, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+float AdvanceAge(float logAge, float rate, float dt) {
+    logAge += rate * dt;
+    return logAge > kMaxLogAge ? kMinLogAge : logAge;
 }
 
-int main() {
+int RunClusterBench(const astro_bench::BenchOptions& bench, Cluster* cluster) {
+    astro_parallel::ThreadPool& pool = astro_parallel::SharedPool();
+    const ColorLut lut = BuildColorLut();
+    std::vector<astro_render::CloudPoint> points;
+    points.reserve(cluster->mass.size());
+    PhaseCounts counts;
+    float logAge = kStartLogAge;
+    size_t bisected = 0;
+    return astro_bench::RunBench(
+        "hr_diagram_evolution_viz", bench,
+        [&](float dt) {
+            logAge = AdvanceAge(logAge, kDefaultAgeRate, dt);
+            EvolveCluster(cluster, logAge, pool);
+            bisected += cluster->stars.bisected();
+            FillCloud(*cluster, logAge, lut, &points, &counts);
+        },
+        [&]() {
+            std::fprintf(stderr, "%zu stars at log age %.2f: %d PMS, %d MS, %d RGB, %d CHeB, %d AGB, %d WD, %d gone; %zu bisections\n",
+                         cluster->mass.size(), logAge, counts.preMain, counts.main, counts.giants, counts.helium, counts.agb,
+                         counts.whiteDwarfs, counts.gone, bisected);
+            double sum = 0.0;
+            for (const astro_render::CloudPoint& p : points) sum += p.pos.y;
+            return sum;
+        });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    astro_stellar::TrackTable table;
+    if (!OpenTracks(argc, argv, &table)) return 1;
+    const int starCount = std::max(1, astro_bench::IntArg(argc, argv, "--stars", kDefaultStars));
+    Cluster cluster;
+    BuildCluster(table, starCount, astro_bench::FloatArg(argc, argv, "--feh", 0.0f), &cluster);
+    if (bench.enabled) return RunClusterBench(bench, &cluster);
+
     InitWindow(kW, kH, "H-R Diagram Evolution 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -36,46 +239,60 @@ int main() {
     cam.projection = CAMERA_PERSPECTIVE;
     float yaw = 0.82f, pitch = 0.34f, dist = 18.0f;
 
-    float mass = 2.2f;     // solar masses
-    float age = 0.0f;      // normalized
-    float radius = 1.8f;   // normalized
+    astro_parallel::ThreadPool& pool = astro_parallel::SharedPool();
+    const ColorLut lut = BuildColorLut();
+    astro_render::PointCloudBuffer cloud;
+    cloud.Init(cluster.mass.size());
+    std::vector<astro_render::CloudPoint> points;
+    points.reserve(cluster.mass.size());
+    PhaseCounts counts;
+
+    float mass = 2.2f;  // highlighted star, solar masses
+    float logAge = kStartLogAge;
+    float ageRate = kDefaultAgeRate;
     bool paused = false;
-    std::deque<Vector3> trail;
+    std::vector<astro_stellar::TrackRow> track;
+    float trackMass = -1.0f, trackFeh = 1.0e9f;
+    int trackCursor = 0;
+    double evolveMs = 0.0;
 
     while (!WindowShouldClose()) {
+        const float dt = GetFrameTime();
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
-            mass = 2.2f; age = 0.0f; radius = 1.8f; paused = false; trail.clear();
+            mass = 2.2f;
+            logAge = kStartLogAge;
+            ageRate = kDefaultAgeRate;
+            paused = false;
+        }
+        if (IsKeyDown(KEY_UP)) mass = std::min(table.maxMass(), mass * (1.0f + 1.5f * dt));
+        if (IsKeyDown(KEY_DOWN)) mass = std::max(table.minMass(), mass / (1.0f + 1.5f * dt));
+        if (IsKeyDown(KEY_RIGHT)) ageRate = std::min(1.0f, ageRate * (1.0f + 2.0f * dt));
+        if (IsKeyDown(KEY_LEFT)) ageRate = std::max(0.005f, ageRate / (1.0f + 2.0f * dt));
+        if (IsKeyPressed(KEY_RIGHT_BRACKET) || IsKeyPressed(KEY_LEFT_BRACKET)) {
+            const float step = IsKeyPressed(KEY_RIGHT_BRACKET) ? kFehStep : -kFehStep;
+            BuildCluster(table, starCount, cluster.meanFeh + step, &cluster);
         }
-        if (IsKeyDown(KEY_UP)) mass = std::min(20.0f, mass + 5.0f * GetFrameTime());
-        if (IsKeyDown(KEY_DOWN)) mass = std::max(0.4f, mass - 5.0f * GetFrameTime());
+        if (IsKeyDown(KEY_PAGE_UP)) logAge = std::min(kMaxLogAge, logAge + 0.8f * dt);
+        if (IsKeyDown(KEY_PAGE_DOWN)) logAge = std::max(kMinLogAge, logAge - 0.8f * dt);
         UpdateOrbitCameraDragOnly(&cam, &yaw, &pitch, &dist);
 
-        if (!paused) {
-            float dt = GetFrameTime();
-            age += 0.08f * dt * std::pow(mass, 0.35f);
-            if (age > 1.4f) age = 0.0f;
-
-            // Hydrostatic-like balance toy model: pressure support vs self-gravity.
-            float grav = mass * mass / std::max(0.25f, radius * radius);
-            float pressure = 2.8f * std::pow(mass, 1.2f) / std::max(0.25f, radius * radius * radius);
-            radius += (pressure - grav) * 0.22f * dt;
-            radius = std::clamp(radius, 0.3f, 7.0f);
-
-            float temp = 3200.0f + 7200.0f * std::pow(mass, 0.52f) / std::pow(radius, 0.35f);
-            float lum = std::pow(mass, 3.4f) * std::pow(std::max(0.2f, radius), 0.45f);
-            // RGB transition for giant phase.
-            if (age > 0.85f) {
-                temp *= (1.0f - 0.45f * (age - 0.85f) / 0.55f);
-                lum *= (1.0f + 18.0f * (age - 0.85f) / 0.55f);
-            }
-
-            float x = (15000.0f - std::clamp(temp, 2500.0f, 15000.0f)) / 1200.0f - 5.0f;
-            float y = std::log10(std::max(0.001f, lum)) * 2.4f + 1.5f;
-            float z = age * 12.0f - 6.0f;
-            trail.push_back({x, y, z});
-            if (trail.size() > 700) trail.pop_front();
+        if (!paused) logAge = AdvanceAge(logAge, ageRate, dt);
+        {
+            ASTRO_PROFILE_SCOPE("evolve");
+            const auto t0 = std::chrono::steady_clock::now();
+            EvolveCluster(&cluster, logAge, pool);
+            evolveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            FillCloud(cluster, logAge, lut, &points, &counts);
         }
+        cloud.Clear();
+        cloud.Append(points.data(), points.size());
+        if (mass != trackMass || cluster.meanFeh != trackFeh) {
+            table.Track(mass, cluster.meanFeh, &track);
+            trackMass = mass;
+            trackFeh = cluster.meanFeh;
+        }
+        const astro_stellar::TrackRow star = table.Sample(table.Stencil(mass, cluster.meanFeh), logAge, &trackCursor);
 
         BeginDrawing();
         ClearBackground(Color{7, 10, 18, 255});
@@ -83,22 +300,58 @@ int main() {
         DrawGrid(22, 0.8f);
         DrawCubeWires({0, 4, 0}, 12, 9, 13, Fade(SKYBLUE, 0.45f));
 
-        for (size_t i = 1; i < trail.size(); ++i) {
-            float a = (float)i / (float)trail.size();
-            DrawLine3D(trail[i - 1], trail[i], Fade(Color{255, 180, 120, 255}, a));
+        // The isochrone plane at the current age.
+        const float zPlane = HrPoint(4.0f, 0.0f, logAge).z;
+        DrawCubeWires({0, 4, zPlane}, 12, 9, 0.01f, Fade(Color{120, 160, 220, 255}, 0.35f));
+
+        // Highlighted star's whole track through (Teff, L, age), brighter where it has been.
+        for (size_t e = 1; e < track.size(); ++e) {
+            if (IsRemnant(track[e].phase)) break;
+            const Vector3 a = HrPoint(track[e - 1].logTeff, track[e - 1].logL, track[e - 1].logAge);
+            const Vector3 b = HrPoint(track[e].logTeff, track[e].logL, track[e].logAge);
+            DrawLine3D(a, b, Fade(LutColor(lut, track[e].logTeff), track[e].logAge <= logAge ? 0.95f : 0.3f));
         }
-        if (!trail.empty()) DrawSphere(trail.back(), 0.22f, Color{255, 235, 170, 255});
+
+        // Isochrone line through the log-spaced mass sequence.
+        const astro_stellar::ClusterEvolver& iso = cluster.isochrone;
+        for (size_t i = 1; i < iso.size(); ++i) {
+            if (IsRemnant(iso.phase()[i - 1]) || IsRemnant(iso.phase()[i])) continue;
+            DrawLine3D(HrPoint(iso.logTeff()[i - 1], iso.logL()[i - 1], logAge), HrPoint(iso.logTeff()[i], iso.logL()[i], logAge),
+                       Fade(Color{255, 236, 190, 255}, 0.55f));
+        }
+
+        BeginBlendMode(BLEND_ADDITIVE);
+        cloud.Draw(kPointPixels);
+        EndBlendMode();
+        if (!IsRemnant(star.phase)) DrawSphere(HrPoint(star.logTeff, star.logL, logAge), 0.16f, Color{255, 235, 170, 255});
         EndMode3D();
 
-        DrawText("H-R Diagram Evolution (3D track with gravity-pressure balance)", 20, 18, 28, Color{232, 238, 248, 255});
-        DrawText("Mouse drag orbit | wheel zoom | Up/Down stellar mass | P pause | R reset", 20, 54, 18, Color{160, 182, 210, 255});
-        char s[220];
-        std::snprintf(s, sizeof(s), "mass=%.2f Msun  radius=%.2f  age=%.2f%s", mass, radius, age, paused ? "  [PAUSED]" : "");
+        DrawText("H-R Diagram Evolution (cluster isochrone from interpolated tracks)", 20, 18, 28, Color{232, 238, 248, 255});
+        DrawText("Mouse drag orbit | wheel zoom | Up/Down track mass | Left/Right age rate | PgUp/PgDn scrub | [ ] [Fe/H] | P pause | R reset",
+                 20, 54, 18, Color{160, 182, 210, 255});
+        const float years = std::pow(10.0f, logAge);
+        char s[256];
+        std::snprintf(s, sizeof(s), "age %.3g %s   [Fe/H] %+.2f   %zu stars   evolve %.2f ms%s", years >= 1.0e9f ? years / 1.0e9f : years / 1.0e6f,
+                      years >= 1.0e9f ? "Gyr" : "Myr", cluster.meanFeh, cluster.mass.size(), evolveMs, paused ? "  [PAUSED]" : "");
         DrawText(s, 20, 82, 20, Color{126, 224, 255, 255});
-        DrawFPS(20, 110);
+        std::snprintf(s, sizeof(s), "PMS %d  MS %d  RGB %d  CHeB %d  AGB %d  WD %d  gone %d", counts.preMain, counts.main, counts.giants,
+                      counts.helium, counts.agb, counts.whiteDwarfs, counts.gone);
+        DrawText(s, 20, 108, 18, Color{200, 210, 228, 255});
+        std::snprintf(s, sizeof(s), "track %.2f Msun: Teff %.0f K  L %.3g Lsun%s", mass, std::pow(10.0f, star.logTeff), std::pow(10.0f, star.logL),
+                      IsRemnant(star.phase) ? "  (ended)" : "");
+        DrawText(s, 20, 132, 18, Color{255, 220, 170, 255});
+        std::snprintf(s, sizeof(s), "%d x %d tracks, %d EEPs, %.1f MB mapped", table.massCount(), table.fehCount(), table.eepCount(),
+                      table.bytes() / 1048576.0);
+        DrawText(s, 20, 156, 16, Color{140, 160, 190, 255});
+        DrawText("hot <- log Teff      up: log L      depth: log age", 20, kH - 30, 16, Color{140, 160, 190, 255});
+        DrawFPS(20, 180);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    cloud.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,10 +1,22 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/philox.h"
+#include "../common/point_cloud.h"
+#include "../common/profiler.h"
+#include "../common/sim_thread.h"
+#include "../common/snapshot_export.h"
+#include "../common/sph_hydro.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdio>
 #include <deque>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -12,10 +24,37 @@ constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kPi = 3.14159265358979323846f;
 
-struct EjectaParticle {
-    Vector3 dir;
-    float speed;
-    float phase;
+constexpr float kSimRate = 30.0f;     // simulation thread ticks per simulated second
+constexpr int kMaxStepsPerTick = 8;   // adaptive SPH steps per tick before the ejecta slow down
+constexpr float kEjectaRadius = 0.7f;  // outer edge of the dynamical ejecta at launch
+constexpr float kWindRadius = 0.35f;   // hot disk wind inside it
+constexpr float kDynamicalSpeed = 1.6f;
+constexpr float kWindMassFraction = 0.1f;
+constexpr float kWindHeat = 3.0f;      // specific internal energy of the wind at launch
+constexpr uint64_t kEjectaSeed = 0x4B11A0FAull;
+constexpr std::array<int, 4> kParticleOptions = {20000, 60000, 200000, 1000000};
+
+struct EjectaParams {
+    float totalMass = 2.75f;
+    float spin = 0.8f;
+    int particleOption = 1;
+};
+
+// The ejecta gas on the simulation thread; empty until the merger.
+struct EjectaScene {
+    astro_sph::SphSystem gas;
+    int generation = 0;
+};
+
+// Particle positions and colours indexed by id, so consecutive snapshots blend.
+struct EjectaView {
+    std::vector<Vector3> pos;
+    std::vector<Color> color;
+    float age = 0.0f;
+    uint64_t steps = 0;
+    float neighbours = 0.0f;
+    float stepMs = 0.0f;
+    int generation = 0;
 };
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
@@ -35,24 +74,135 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     });
 }
 
-std::vector<EjectaParticle> BuildEjectaField(int n) {
-    std::vector<EjectaParticle> particles;
-    particles.reserve(n);
-    for (int i = 0; i < n; ++i) {
-        float t = (i + 0.5f) / static_cast<float>(n);
-        float y = 1.0f - 2.0f * t;
-        float r = std::sqrt(std::max(0.0f, 1.0f - y * y));
-        float phi = kPi * (3.0f - std::sqrt(5.0f)) * static_cast<float>(i);
-        Vector3 d = {r * std::cos(phi), y, r * std::sin(phi)};
-        float lat = std::abs(d.y);
-        float speed = 1.4f + 0.8f * (1.0f - lat);  // Slightly faster near the orbital plane.
-        particles.push_back({d, speed, 0.17f * static_cast<float>(i)});
+// Equal-mass particles: neutron-rich dynamical ejecta (tag 0) in a shell flattened
+// towards the orbital plane and moving homologously, faster at the equator, around a
+// light, hot disk wind (tag 1) whose pressure inflates it from inside. Light gas pushing
+// heavy gas is Rayleigh-Taylor unstable, so the wind breaks through the shell in
+// fingers; random particle positions seed the modes. The remnant's spin adds a swirl
+// about the orbital axis.
+std::vector<astro_sph::SphParticle> BuildEjectaGas(const EjectaParams& params, astro_sph::SphConfig* config) {
+    const int n = kParticleOptions[static_cast<size_t>(params.particleOption)];
+    const int windCount = static_cast<int>(kWindMassFraction * static_cast<float>(n));
+    const float mass = 1.0f / static_cast<float>(n);
+    astro_random::PhiloxStream rng(kEjectaSeed);
+    const auto inBall = [&](float rMin, float rMax) {
+        while (true) {
+            const Vector3 p = {rng.Uniform(-rMax, rMax), rng.Uniform(-rMax, rMax), rng.Uniform(-rMax, rMax)};
+            const float r2 = Vector3LengthSqr(p);
+            if (r2 <= rMax * rMax && r2 >= rMin * rMin) return p;
+        }
+    };
+
+    std::vector<astro_sph::SphParticle> gas;
+    gas.reserve(static_cast<size_t>(n));
+    const float swirl = 0.3f * params.spin;
+    const float speed = kDynamicalSpeed * std::sqrt(params.totalMass / 2.75f);
+    while (static_cast<int>(gas.size()) < n - windCount) {
+        const Vector3 p = inBall(kWindRadius, kEjectaRadius);
+        const float lat = std::abs(p.y) / Vector3Length(p);
+        const float equator = (1.0f - lat) * (1.0f - lat);
+        if (rng.Uniform() > 0.35f + 0.65f * equator) continue;
+        Vector3 v = Vector3Scale(p, speed / kEjectaRadius * (0.75f + 0.5f * (1.0f - lat)));
+        v = Vector3Add(v, {-swirl * p.z, 0.0f, swirl * p.x});
+        gas.push_back({p, v, mass, 0.01f, 0.0f});
+    }
+    while (static_cast<int>(gas.size()) < n) {
+        const Vector3 p = inBall(0.0f, kWindRadius);
+        const float lat = std::abs(p.y) / std::max(Vector3Length(p), 1.0e-6f);
+        const Vector3 v = Vector3Scale(p, 0.5f / kWindRadius * (0.6f + 0.8f * lat));  // polar-leaning outflow
+        gas.push_back({p, v, mass, kWindHeat, 1.0f});
+    }
+
+    const float spacing = std::cbrt(4.0f / 3.0f * kPi * kEjectaRadius * kEjectaRadius * kEjectaRadius / static_cast<float>(n));
+    config->hMin = 0.05f * spacing;
+    config->hMax = 3.0f;  // the cloud stays coherent, so h may follow it far out
+    config->maxDt = 1.0f / kSimRate;
+    config->centralGm = 0.12f * params.totalMass;  // slow wind falls back onto the remnant
+    config->centralSoftening = 0.3f;
+    return gas;
+}
+
+void LaunchEjecta(EjectaScene* scene, const EjectaParams& params) {
+    astro_sph::SphConfig config;
+    const std::vector<astro_sph::SphParticle> gas = BuildEjectaGas(params, &config);
+    scene->gas.Reset(config, gas);
+    ++scene->generation;
+}
+
+void ClearEjecta(EjectaScene* scene) {
+    scene->gas.Reset(astro_sph::SphConfig{}, {});
+    ++scene->generation;
+}
+
+// Red for the lanthanide-rich dynamical ejecta, blue for the wind; heat brightens both.
+void PublishEjecta(const EjectaScene& scene, EjectaView& view) {
+    const astro_sph::SphSystem& gas = scene.gas;
+    view.pos.resize(gas.size());
+    view.color.resize(gas.size());
+    for (size_t i = 0; i < gas.size(); ++i) {
+        const float heat = std::clamp(std::log10(1.0f + 30.0f * gas.internalEnergy(i)) / 2.0f, 0.0f, 1.0f);
+        const Color base = gas.tag(i) > 0.5f ? Color{110, 170, 255, 255} : Color{255, 120, 80, 255};
+        Color c = ColorLerp(base, Color{255, 240, 220, 255}, 0.6f * heat);
+        c.a = static_cast<unsigned char>(90 + 120 * heat);
+        view.pos[gas.id(i)] = gas.position(i);
+        view.color[gas.id(i)] = c;
     }
-    return particles;
+    view.age = static_cast<float>(gas.time());
+    view.steps = gas.steps();
+    view.neighbours = gas.meanNeighbours();
+    view.stepMs = gas.sortMs() + gas.densityMs() + gas.forceMs();
+    view.generation = scene.generation;
+}
+
+// Gas particles keyed by their launch index; the cadence counts SPH steps, and a tick of
+// several steps is written at its start.
+void ExportEjectaSnapshot(const astro_sph::SphSystem& gas, astro_snapshot::SnapshotWriter* snapshots) {
+    if (snapshots == nullptr || gas.empty() || !snapshots->Due(gas.steps())) return;
+    snapshots->Capture(gas.steps(), gas.time(), gas.size(), [&](astro_snapshot::SnapshotFrame& frame) {
+        for (size_t i = 0; i < gas.size(); ++i) frame.Set(i, gas.id(i), gas.mass(i), gas.position(i), gas.velocity(i));
+    });
+}
+
+void AdvanceEjecta(EjectaScene* scene, float dt, astro_snapshot::SnapshotWriter* snapshots = nullptr) {
+    ExportEjectaSnapshot(scene->gas, snapshots);
+    scene->gas.Advance(dt, kMaxStepsPerTick);
 }
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    // --snapshot=path writes the ejecta gas every --snapshot-every SPH steps after the merger.
+    astro_snapshot::SnapshotWriter snapshots;
+    std::string snapshotError;
+    if (!snapshots.Open(astro_snapshot::SnapshotOptions::FromArgs(argc, argv), "neutron_star_merger_kilonova_viz", &snapshotError)) {
+        std::fprintf(stderr, "neutron_star_merger_kilonova_viz: %s\n", snapshotError.c_str());
+        return 1;
+    }
+
+    EjectaParams initial;
+    if (const int particles = astro_bench::IntArg(argc, argv, "--particles", 0); particles > 0) {
+        initial.particleOption = 0;
+        while (initial.particleOption + 1 < static_cast<int>(kParticleOptions.size()) &&
+               kParticleOptions[static_cast<size_t>(initial.particleOption)] < particles) {
+            ++initial.particleOption;
+        }
+    }
+
+    // Headless runs skip the inspiral and time the ejecta from the merger onwards.
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 60, 1.0f / kSimRate);
+    if (bench.enabled) {
+        EjectaScene scene;
+        LaunchEjecta(&scene, initial);
+        const int status = astro_bench::RunBench(
+            "neutron_star_merger_kilonova_viz", bench, [&](float dt) { AdvanceEjecta(&scene, dt, &snapshots); },
+            [&]() {
+                std::fprintf(stderr, "%zu particles, age %.2f, %llu SPH steps, E_kin=%.4f E_th=%.4f\n", scene.gas.size(), scene.gas.time(),
+                             static_cast<unsigned long long>(scene.gas.steps()), scene.gas.KineticEnergy(), scene.gas.ThermalEnergy());
+                return scene.gas.KineticEnergy() + scene.gas.ThermalEnergy();
+            });
+        astro_snapshot::CloseSnapshots(&snapshots, "neutron_star_merger_kilonova_viz");
+        return status;
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Neutron Star Merger + Kilonova 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -70,15 +220,35 @@ int main() {
     float m2 = 1.30f;
     float inspiralRate = 0.27f;
     float spin = 0.8f;
+    int particleOption = initial.particleOption;
     bool paused = false;
 
     float sep = 6.0f;
     float phase = 0.0f;
     bool merged = false;
-    float postMergerTime = 0.0f;
     float simTime = 0.0f;
     std::deque<float> luminosityHistory(360, 0.04f);
-    std::vector<EjectaParticle> ejecta = BuildEjectaField(950);
+
+    astro_render::PointCloudBuffer cloud;
+    cloud.Init(static_cast<size_t>(kParticleOptions.back()));
+    std::vector<astro_render::CloudPoint> points;
+
+    // The inspiral is a few numbers and stays on this thread; at the merger the ejecta
+    // gas is launched on the simulation thread with the binary's mass and spin.
+    astro_sim::SimThread<EjectaScene, EjectaView> sim;
+    sim.Start(EjectaScene{}, kSimRate,
+              [&snapshots](EjectaScene& state, float dt) {
+                  ASTRO_PROFILE_SCOPE("physics");
+                  AdvanceEjecta(&state, dt, &snapshots);
+              },
+              PublishEjecta, 2);
+    const auto launch = [&]() {
+        EjectaParams params;
+        params.totalMass = m1 + m2;
+        params.spin = spin;
+        params.particleOption = particleOption;
+        sim.Reset([params](EjectaScene& state) { LaunchEjecta(&state, params); });
+    };
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
@@ -90,10 +260,14 @@ int main() {
             sep = 6.0f;
             phase = 0.0f;
             merged = false;
-            postMergerTime = 0.0f;
             simTime = 0.0f;
             paused = false;
             luminosityHistory.assign(360, 0.04f);
+            sim.Reset([](EjectaScene& state) { ClearEjecta(&state); });
+        }
+        if (IsKeyPressed(KEY_N)) {
+            particleOption = (particleOption + 1) % static_cast<int>(kParticleOptions.size());
+            if (merged) launch();
         }
         if (IsKeyDown(KEY_UP)) m2 = std::min(2.4f, m2 + 0.5f * GetFrameTime());
         if (IsKeyDown(KEY_DOWN)) m2 = std::max(0.8f, m2 - 0.5f * GetFrameTime());
@@ -101,9 +275,15 @@ int main() {
         if (IsKeyDown(KEY_LEFT)) inspiralRate = std::max(0.05f, inspiralRate - 0.25f * GetFrameTime());
         if (IsKeyDown(KEY_RIGHT_BRACKET)) spin = std::min(2.2f, spin + 0.8f * GetFrameTime());
         if (IsKeyDown(KEY_LEFT_BRACKET)) spin = std::max(0.1f, spin - 0.8f * GetFrameTime());
+        sim.SetTimeScale(paused ? 0.0f : 1.0f);
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
+        const auto sample = sim.Sample();
+        const EjectaView* view = sample.current;
+        const EjectaView* previous = sample.previous;
+        const float alpha = previous->generation == view->generation && previous->pos.size() == view->pos.size() ? sample.alpha : 1.0f;
+
         float luminosity = 0.0f;
         if (!paused) {
             float dt = GetFrameTime();
@@ -115,11 +295,12 @@ int main() {
                 phase += dt * (2.3f + 8.0f / std::pow(sep + 0.2f, 1.5f));
                 if (sep <= 0.66f) {
                     merged = true;
-                    postMergerTime = 0.0f;
+                    launch();
                 }
                 luminosity = 0.015f + 0.2f / std::pow(sep + 0.25f, 2.8f);
             } else {
-                postMergerTime += dt;
+                // The light curve follows the gas clock, so it slows with the ejecta.
+                const float postMergerTime = view->age;
                 float flash = 2.3f * std::exp(-std::pow((postMergerTime - 0.22f) / 0.09f, 2.0f));
                 float kilonova = 1.5f * std::exp(-postMergerTime / 7.5f);
                 luminosity = 0.05f + flash + kilonova;
@@ -135,6 +316,11 @@ int main() {
         Vector3 p1 = {r1 * std::cos(phase), 0.0f, r1 * std::sin(phase)};
         Vector3 p2 = {-r2 * std::cos(phase), 0.0f, -r2 * std::sin(phase)};
 
+        points.resize(merged ? view->pos.size() : 0);
+        for (size_t i = 0; i < points.size(); ++i) points[i] = {Vector3Lerp(previous->pos[i], view->pos[i], alpha), view->color[i]};
+        cloud.Clear();
+        cloud.Append(points.data(), points.size());
+
         BeginDrawing();
         ClearBackground(Color{5, 8, 15, 255});
         BeginMode3D(camera);
@@ -155,19 +341,9 @@ int main() {
             DrawSphere({0.0f, 0.0f, 0.0f}, remnantRadius, Color{168, 208, 255, 255});
             DrawSphereWires({0.0f, 0.0f, 0.0f}, remnantRadius + 0.15f, 16, 16, Fade(SKYBLUE, 0.4f));
 
-            for (const EjectaParticle& e : ejecta) {
-                float travel = e.speed * std::pow(postMergerTime + 0.03f, 0.9f);
-                float ripple = 1.0f + 0.18f * std::sin(5.0f * postMergerTime + e.phase);
-                Vector3 pos = Vector3Scale(e.dir, travel * ripple);
-                float heat = std::exp(-postMergerTime / 9.0f);
-                Color c = Color{
-                    static_cast<unsigned char>(180 + 70 * heat),
-                    static_cast<unsigned char>(120 + 90 * heat),
-                    static_cast<unsigned char>(90 + 140 * heat),
-                    190
-                };
-                DrawPoint3D(pos, c);
-            }
+            BeginBlendMode(BLEND_ADDITIVE);
+            cloud.Draw(1.6f);
+            EndBlendMode();
         }
         EndMode3D();
 
@@ -184,7 +360,7 @@ int main() {
         }
 
         DrawText("Neutron Star Merger + Kilonova", 20, 18, 30, Color{232, 238, 248, 255});
-        DrawText("Mouse drag orbit | wheel zoom | Up/Down m2 | Left/Right inspiral | [ ] spin | P pause | R reset",
+        DrawText("Mouse drag orbit | wheel zoom | Up/Down m2 | Left/Right inspiral | [ ] spin | N particles | P pause | R reset",
                  20, 54, 18, Color{164, 183, 210, 255});
 
         char status[220];
@@ -193,10 +369,23 @@ int main() {
                       m1, m2, sep, merged ? "post-merger" : "inspiral", paused ? " [PAUSED]" : "");
         DrawText(status, 20, 84, 20, Color{126, 224, 255, 255});
         DrawFPS(20, 112);
+        DrawText(TextFormat("sim %.0f Hz on its own thread, load %.0f%%", kSimRate, 100.0f * sim.load()), 120, 112, 18,
+                 Color{150, 165, 190, 255});
+        char gasStatus[220];
+        std::snprintf(gasStatus, sizeof(gasStatus), "SPH ejecta: %d particles  age=%.2f  %llu steps  neighbours=%.0f  step=%.1f ms",
+                      kParticleOptions[static_cast<size_t>(particleOption)], merged ? view->age : 0.0f,
+                      static_cast<unsigned long long>(merged ? view->steps : 0), view->neighbours, view->stepMs);
+        DrawText(gasStatus, 20, 140, 18, Color{255, 214, 150, 255});
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    sim.Stop();
+    astro_snapshot::CloseSnapshots(&snapshots, "neutron_star_merger_kilonova_viz");
+    cloud.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
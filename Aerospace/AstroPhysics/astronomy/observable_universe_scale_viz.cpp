@@ -1,10 +1,18 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/cosmology.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/point_cloud.h"
+#include "../common/profiler.h"
+#include "../common/star_catalog.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <random>
+#include <string>
 #include <vector>
 
 namespace {
@@ -14,11 +22,16 @@ constexpr int kScreenHeight = 920;
 constexpr float kSceneMinRadius = 1.6f;
 constexpr float kSceneMaxRadius = 34.0f;
 constexpr double kMinDistanceLy = 0.001;
-constexpr double kMaxDistanceLy = 46.5e9;
-constexpr double kMaxLookbackGyr = 13.8;
 constexpr double kMaxRedshift = 1100.0;
+constexpr double kHubbleFlowLy = 1.0e7;  // beyond this, landmark redshifts follow the expansion
 constexpr int kStarCount = 520;
 constexpr int kFilamentParticleCount = 320;
+constexpr float kCameraFovDeg = 43.0f;
+constexpr float kMinOrbitDistance = 18.0f;
+constexpr float kMinCatalogOrbitDistance = 2.5f;  // lets the camera dive into the star shell
+constexpr int kDefaultBudgetMb = 96;
+constexpr float kNodeMinPixels = 90.0f;           // nodes projected smaller than this stay coarse
+constexpr float kCatalogPointPixels = 1.6f;
 
 enum class MetricMode {
     kDistanceNow = 0,
@@ -83,21 +96,35 @@ double SafeLog10(double value) {
     return std::log10(std::max(value, 1.0e-9));
 }
 
+// Planck-like background behind the distance map and the landmark redshifts. Built on
+// first use by whichever thread gets here first; the catalog remap runs on the
+// streamer's page-in thread.
+const astro_cosmo::CosmoTable& Cosmology() {
+    static const astro_cosmo::CosmoTable table = astro_cosmo::CosmoTable::Build(astro_cosmo::CosmoParams{});
+    return table;
+}
+
+// The scene's outer shell is today's particle horizon.
+double MaxDistanceLy() {
+    static const double horizonLy = Cosmology().horizon * 1.0e9;
+    return horizonLy;
+}
+
 float MapDistanceLyToSceneRadius(double distanceLy) {
     const double lo = SafeLog10(kMinDistanceLy);
-    const double hi = SafeLog10(kMaxDistanceLy);
-    const double norm = (SafeLog10(std::clamp(distanceLy, kMinDistanceLy, kMaxDistanceLy)) - lo) / (hi - lo);
+    const double hi = SafeLog10(MaxDistanceLy());
+    const double norm = (SafeLog10(std::clamp(distanceLy, kMinDistanceLy, MaxDistanceLy())) - lo) / (hi - lo);
     return kSceneMinRadius + static_cast<float>(norm) * (kSceneMaxRadius - kSceneMinRadius);
 }
 
 float NormalizeMetric(const Landmark& landmark, MetricMode mode) {
     if (mode == MetricMode::kDistanceNow) {
         const double lo = SafeLog10(kMinDistanceLy);
-        const double hi = SafeLog10(kMaxDistanceLy);
+        const double hi = SafeLog10(MaxDistanceLy());
         return static_cast<float>((SafeLog10(landmark.distanceLy) - lo) / (hi - lo));
     }
     if (mode == MetricMode::kLookbackTime) {
-        return static_cast<float>(landmark.lookbackGyr / kMaxLookbackGyr);
+        return static_cast<float>(landmark.lookbackGyr / Cosmology().age);
     }
     return static_cast<float>(SafeLog10(1.0 + landmark.redshift) / SafeLog10(1.0 + kMaxRedshift));
 }
@@ -116,7 +143,7 @@ Vector3 SpherePoint(float radius, float theta, float phi) {
     };
 }
 
-void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit) {
+void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit, float minDistance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         const Vector2 delta = GetMouseDelta();
         orbit->yaw -= delta.x * 0.0037f;
@@ -125,7 +152,7 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit) {
     }
 
     orbit->distance -= GetMouseWheelMove() * 2.0f;
-    orbit->distance = std::clamp(orbit->distance, 18.0f, 110.0f);
+    orbit->distance = std::clamp(orbit->distance, minDistance, 110.0f);
 
     const float cp = std::cos(orbit->pitch);
     camera->target = orbit->target;
@@ -136,8 +163,41 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit) {
     });
 }
 
+// Catalog stars keep their direction from the Sun and take the same log radius as the
+// landmark shells, so real neighbours fill the space between Alpha Centauri and the
+// Orion Arm. Runs on the streamer's page-in thread.
+void RemapStarsToScene(astro_catalog::CatalogStar* stars, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        float* p = stars[i].pos;
+        const float pc = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        const float scale = pc > 0.0f ? MapDistanceLyToSceneRadius(pc * astro_catalog::kLightYearsPerParsec) / pc : 0.0f;
+        for (int k = 0; k < 3; ++k) p[k] *= scale;
+    }
+}
+
+// Projected size in pixels of a node after the log remap: the larger of its radial
+// thickness and its angular width on the shell, seen from the camera. Nodes behind the
+// camera count for a quarter so turning around does not empty the view.
+float CatalogNodePriority(const astro_catalog::CatalogNode& node, Vector3 eye, Vector3 forward) {
+    const Vector3 c = {node.center[0], node.center[1], node.center[2]};
+    const float pc = Vector3Length(c);
+    const float reach = node.half * 1.7320508f;
+    const double ly = astro_catalog::kLightYearsPerParsec;
+    const float inner = MapDistanceLyToSceneRadius(std::max(0.0, static_cast<double>(pc - reach)) * ly);
+    const float outer = MapDistanceLyToSceneRadius((pc + reach) * ly);
+    const float mid = MapDistanceLyToSceneRadius(pc * ly);
+    const float extent = std::max(0.5f * (outer - inner), mid * std::min(1.0f, reach / std::max(pc, 1.0e-3f)));
+    const Vector3 sceneCenter = pc > 1.0e-3f ? Vector3Scale(c, mid / pc) : Vector3{0.0f, 0.0f, 0.0f};
+    const Vector3 toNode = Vector3Subtract(sceneCenter, eye);
+    const float distance = Vector3Length(toNode);
+    if (distance <= extent) return 1.0e6f;
+    const float focal = 0.5f * static_cast<float>(kScreenHeight) / std::tan(0.5f * kCameraFovDeg * DEG2RAD);
+    const float pixels = extent * focal / distance;
+    return Vector3DotProduct(toNode, forward) < -extent ? 0.25f * pixels : pixels;
+}
+
 std::vector<Landmark> BuildLandmarks() {
-    return {
+    std::vector<Landmark> landmarks = {
         {"Solar System Edge", "heliopause / outer planetary neighborhood", 0.0023, 0.0, 0.0, Color{120, 210, 255, 255}, 0.20f, 0.18f},
         {"Oort Cloud", "icy reservoir around the Sun", 1.6, 0.0000016, 0.0, Color{164, 224, 255, 255}, 1.05f, -0.08f},
         {"Alpha Centauri", "nearest stellar system", 4.37, 0.00000437, 0.0, Color{248, 244, 180, 255}, 1.78f, 0.20f},
@@ -149,6 +209,22 @@ std::vector<Landmark> BuildLandmarks() {
         {"Quasar Era", "peak growth of bright early galaxies", 1.05e10, 10.8, 2.1, Color{228, 126, 255, 255}, 0.86f, 0.32f},
         {"Cosmic Microwave Background", "last scattering surface", 4.65e10, 13.8, 1100.0, Color{255, 240, 144, 255}, 2.18f, 0.36f},
     };
+
+    // In the Hubble flow the background fixes two of the three numbers from the third:
+    // entries given by redshift (z >= 1) get their comoving distance, the rest their
+    // redshift, and both their lookback time.
+    const astro_cosmo::CosmoTable& cosmology = Cosmology();
+    for (Landmark& landmark : landmarks) {
+        if (landmark.redshift >= 1.0) {
+            landmark.distanceLy = cosmology.ComovingDistance(landmark.redshift) * 1.0e9;
+        } else if (landmark.distanceLy >= kHubbleFlowLy) {
+            landmark.redshift = cosmology.RedshiftToday(landmark.distanceLy * 1.0e-9);
+        } else {
+            continue;
+        }
+        landmark.lookbackGyr = cosmology.LookbackTime(landmark.redshift);
+    }
+    return landmarks;
 }
 
 std::vector<BackdropStar> BuildBackdropStars() {
@@ -265,9 +341,110 @@ void DrawMetricRuler(const std::vector<Landmark>& landmarks, MetricMode mode, in
     DrawText("log-scaled scene radius, but metric focus can switch to time or redshift", left - 2, top + height, 16, Color{148, 164, 188, 255});
 }
 
+// The orbit camera of the headless catalog bench: a slow spiral from outside every
+// shell down into the solar neighbourhood and back out.
+void ScriptedOrbit(float t, OrbitCameraState* orbit, Camera3D* camera) {
+    orbit->yaw = 0.74f + 0.35f * t;
+    orbit->pitch = 0.30f * std::cos(0.21f * t);
+    const float zoom = 0.5f - 0.5f * std::cos(0.15f * t);
+    orbit->distance = LerpFloat(76.0f, kMinCatalogOrbitDistance + 1.0f, zoom);
+    const float cp = std::cos(orbit->pitch);
+    camera->target = orbit->target;
+    camera->position = Vector3Add(orbit->target, {
+        orbit->distance * cp * std::cos(orbit->yaw),
+        orbit->distance * std::sin(orbit->pitch),
+        orbit->distance * cp * std::sin(orbit->yaw),
+    });
+}
+
+void UpdateCatalogStreaming(astro_catalog::CatalogStreamer* streamer, const Camera3D& camera) {
+    const Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    streamer->Update([&](const astro_catalog::CatalogNode& node) { return CatalogNodePriority(node, camera.position, forward); },
+                     kNodeMinPixels);
+}
+
+// --pack=stars.csv or --synthetic=N write a catalog to --out (default synthetic.stars
+// for --synthetic). Returns the path written, or an empty string on failure.
+std::string PackCatalogFromArgs(int argc, char** argv) {
+    const char* csv = astro_bench::FindArg(argc, argv, "--pack");
+    const int synthetic = astro_bench::IntArg(argc, argv, "--synthetic", 0);
+    const char* outArg = astro_bench::FindArg(argc, argv, "--out");
+    const std::string out = outArg != nullptr ? outArg : (csv != nullptr ? "catalog.stars" : "synthetic.stars");
+    std::vector<astro_catalog::PackStar> stars;
+    std::string error;
+    if (csv != nullptr) {
+        if (!astro_catalog::ReadStarCsv(csv, &stars, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return {};
+        }
+    } else {
+        stars = astro_catalog::SyntheticDiskStars(static_cast<size_t>(synthetic), 2500.0f, 20240611);
+    }
+    const size_t count = stars.size();
+    if (!astro_catalog::PackCatalog(std::move(stars), astro_catalog::PackOptions{}, out, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return {};
+    }
+    std::printf("packed %zu stars into %s\n", count, out.c_str());
+    return out;
+}
+
+int RunCatalogBench(const astro_bench::BenchOptions& bench, astro_catalog::CatalogStreamer* streamer) {
+    OrbitCameraState orbit{};
+    Camera3D camera{};
+    camera.up = {0.0f, 1.0f, 0.0f};
+    camera.fovy = kCameraFovDeg;
+    float t = 0.0f;
+    return astro_bench::RunBench(
+        "observable_universe_scale_viz", bench,
+        [&](float dt) {
+            t += dt;
+            ScriptedOrbit(t, &orbit, &camera);
+            UpdateCatalogStreaming(streamer, camera);
+        },
+        [&]() {
+            streamer->Drain();
+            UpdateCatalogStreaming(streamer, camera);
+            const astro_catalog::StreamerStats& stats = streamer->stats();
+            std::fprintf(stderr, "catalog: %zu/%zu slots, %llu page-ins, %llu evictions, %.1f MB paged, %zu stars drawn\n",
+                         stats.residentNodes, stats.slots, static_cast<unsigned long long>(stats.pageIns),
+                         static_cast<unsigned long long>(stats.evictions), stats.bytesPaged / 1048576.0, stats.drawnStars);
+            return static_cast<double>(stats.drawnStars);
+        });
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    std::string catalogPath;
+    if (const char* path = astro_bench::FindArg(argc, argv, "--catalog")) catalogPath = path;
+    if (astro_bench::FindArg(argc, argv, "--pack") != nullptr || astro_bench::IntArg(argc, argv, "--synthetic", 0) > 0) {
+        const std::string packed = PackCatalogFromArgs(argc, argv);
+        if (packed.empty()) return 1;
+        if (astro_bench::FindArg(argc, argv, "--pack") != nullptr && catalogPath.empty() && !bench.enabled) return 0;
+        if (catalogPath.empty()) catalogPath = packed;
+    }
+
+    astro_catalog::StarCatalog catalog;
+    astro_catalog::CatalogStreamer streamer;
+    if (!catalogPath.empty()) {
+        std::string error;
+        if (!catalog.Open(catalogPath, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        const size_t budget = static_cast<size_t>(std::max(1, astro_bench::IntArg(argc, argv, "--budget", kDefaultBudgetMb))) << 20;
+        streamer.Configure(&catalog, budget, RemapStarsToScene);
+    }
+    if (bench.enabled) {
+        if (!catalog.open()) {
+            std::fprintf(stderr, "--headless needs --catalog=file or --synthetic=N\n");
+            return 1;
+        }
+        return RunCatalogBench(bench, &streamer);
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Observable Universe Scale Explorer - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -275,7 +452,7 @@ int main() {
     camera.position = {56.0f, 28.0f, 56.0f};
     camera.target = {0.0f, 0.0f, 0.0f};
     camera.up = {0.0f, 1.0f, 0.0f};
-    camera.fovy = 43.0f;
+    camera.fovy = kCameraFovDeg;
     camera.projection = CAMERA_PERSPECTIVE;
 
     OrbitCameraState orbit{};
@@ -291,6 +468,12 @@ int main() {
     float titlePulse = 0.0f;
     bool autoplay = true;
 
+    // One GPU slot per arena slot; arrivals are uploaded in place and the selected
+    // resident nodes drawn as runs.
+    astro_render::PointCloudBuffer catalogPoints;
+    std::vector<astro_render::PointCloudBuffer::Range> catalogRuns;
+    if (catalog.open()) catalogPoints.Init(streamer.slotCount() * streamer.slotStars());
+
     while (!WindowShouldClose()) {
         const float dt = GetFrameTime();
         titlePulse += dt;
@@ -319,7 +502,17 @@ int main() {
             slider = std::fmod(slider + 0.045f * dt, 1.0f);
         }
 
-        UpdateOrbitCameraDragOnly(&camera, &orbit);
+        UpdateOrbitCameraDragOnly(&camera, &orbit, catalog.open() ? kMinCatalogOrbitDistance : kMinOrbitDistance);
+        if (catalog.open()) {
+            UpdateCatalogStreaming(&streamer, camera);
+            for (const astro_catalog::CatalogStreamer::Arrival& arrival : streamer.arrivals()) {
+                const astro_catalog::CatalogNode& node = catalog.node(arrival.node);
+                catalogPoints.WriteAt(reinterpret_cast<const astro_render::CloudPoint*>(streamer.slotStars(arrival.slot)),
+                                      node.starCount, static_cast<size_t>(arrival.slot) * streamer.slotStars());
+            }
+            catalogRuns.clear();
+            for (const astro_catalog::CatalogStreamer::DrawRun& run : streamer.draws()) catalogRuns.push_back({run.first, run.count});
+        }
 
         const int selectedIndex = FindNearestLandmarkIndex(landmarks, mode, slider);
         const Landmark& selected = landmarks[selectedIndex];
@@ -335,6 +528,12 @@ int main() {
             DrawSphere(star.pos, star.size * (0.7f + 0.5f * pulse), Fade(Color{220, 232, 255, 255}, 0.22f + 0.30f * pulse));
         }
 
+        if (catalog.open()) {
+            BeginBlendMode(BLEND_ADDITIVE);
+            catalogPoints.DrawRanges(catalogRuns, kCatalogPointPixels);
+            EndBlendMode();
+        }
+
         for (int i = 0; i < 6; ++i) {
             const float radius = kSceneMinRadius + (kSceneMaxRadius - kSceneMinRadius) * static_cast<float>(i + 1) / 6.0f;
             DrawSphereWires({0.0f, 0.0f, 0.0f}, radius, 36, 24, Fade(Color{54, 94, 148, 255}, 0.13f));
@@ -426,12 +625,27 @@ int main() {
             DrawText(landmark.name, static_cast<int>(screen.x) + offsetX + 6, static_cast<int>(screen.y) + offsetY - 10, selectedLabel ? 18 : 15, selectedLabel ? Color{238, 244, 252, 255} : Color{164, 178, 204, 255});
         }
 
+        if (catalog.open()) {
+            const astro_catalog::StreamerStats& stats = streamer.stats();
+            std::snprintf(line, sizeof(line), "Catalog: %.2fM stars | %zu nodes drawn, %zu loading | %zu/%zu slots (%zu MB)",
+                          catalog.starCount() / 1.0e6, stats.selectedNodes - stats.pendingNodes, stats.pendingNodes,
+                          stats.residentNodes, stats.slots, streamer.arenaBytes() >> 20);
+            DrawText(line, 28, 360, 18, Color{148, 220, 255, 255});
+            std::snprintf(line, sizeof(line), "%.2fM stars on screen | %llu page-ins, %llu evictions", stats.drawnStars / 1.0e6,
+                          static_cast<unsigned long long>(stats.pageIns), static_cast<unsigned long long>(stats.evictions));
+            DrawText(line, 28, 382, 18, Color{148, 164, 188, 255});
+        }
+
         DrawMetricRuler(landmarks, mode, selectedIndex);
         DrawFPS(24, kScreenHeight - 36);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
+    catalogPoints.Unload();
     CloseWindow();
     return 0;
 }
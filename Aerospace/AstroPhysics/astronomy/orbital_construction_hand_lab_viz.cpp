@@ -1,8 +1,15 @@
+#include "../common/frame_capture.h"
+#include "../common/instanced_particles.h"
+#include "../common/kepler_propagator.h"
+#include "../common/profiler.h"
+#include "../common/spatial_hash.h"
+#include "../vision/hand_gestures.h"
 #include "../vision/hand_tracking_scene_shared.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <sstream>
 #include <vector>
 
@@ -12,6 +19,15 @@ namespace {
 
 constexpr int kScreenWidth = 1480;
 constexpr int kScreenHeight = 920;
+// Pinch-and-place needs a steady grab point more than a fast one.
+constexpr HandFilterConfig kHandFilter = {{0.8f, 6.0f, 1.0f}, 6.0f, 0.25f, 0.01f, kMaxTrackingExtrapolation};
+constexpr float kPlanetMu = 10.5f;
+constexpr float kGrabRadius = 0.75f;
+// Satellites within this of the one in hand are flagged as close approaches.
+constexpr float kProximityRadius = 1.1f;
+constexpr size_t kMoonCount = 5;
+constexpr size_t kConstellationSize = 64;
+constexpr size_t kMaxSatellites = 1024;
 
 struct Satellite {
     Vector3 pos{};
@@ -31,12 +47,59 @@ void ResetSatellite(Satellite& sat, float seed) {
     const float a = seed * 2.0f * PI;
     const float r = 3.0f + 2.8f * std::fmod(seed * 17.3f, 1.0f);
     sat.pos = {std::cos(a) * r, 1.1f + 0.25f * std::sin(seed * 12.0f), std::sin(a) * r};
-    const float v = std::sqrt(10.5f / std::max(r, 0.8f));
+    const float v = std::sqrt(kPlanetMu / std::max(r, 0.8f));
     sat.vel = {-std::sin(a) * v, 0.0f, std::cos(a) * v};
     sat.heldBy = -1;
     sat.stableTime = 0.0f;
 }
 
+// Constellation satellite k sits on a circular orbit in ring k / kConstellationSize;
+// each ring gets its own radius, inclination and node so successive rings cross.
+void PlaceConstellationSatellite(Satellite& sat, size_t k) {
+    const size_t ring = k / kConstellationSize;
+    const float phase = 2.0f * PI * static_cast<float>(k % kConstellationSize) / static_cast<float>(kConstellationSize);
+    const float r = 3.3f + 0.45f * static_cast<float>(ring % 8);
+    const float inclination = 0.30f + 0.22f * static_cast<float>(ring % 5);
+    const float node = 0.95f * static_cast<float>(ring);
+    const float v = std::sqrt(kPlanetMu / r);
+    Vector3 pos = {std::cos(phase) * r, 0.0f, std::sin(phase) * r};
+    Vector3 vel = {-std::sin(phase) * v, 0.0f, std::cos(phase) * v};
+    pos = Vector3RotateByAxisAngle(Vector3RotateByAxisAngle(pos, {1.0f, 0.0f, 0.0f}, inclination), {0.0f, 1.0f, 0.0f}, node);
+    vel = Vector3RotateByAxisAngle(Vector3RotateByAxisAngle(vel, {1.0f, 0.0f, 0.0f}, inclination), {0.0f, 1.0f, 0.0f}, node);
+    sat.pos = pos;
+    sat.vel = vel;
+    sat.heldBy = -1;
+    sat.stableTime = 0.0f;
+}
+
+Color ConstellationColor(size_t k) {
+    constexpr std::array<Color, 4> kPalette = {
+        Color{150, 210, 255, 255}, Color{255, 226, 170, 255}, Color{190, 255, 214, 255}, Color{236, 196, 255, 255}};
+    return kPalette[(k / kConstellationSize) % kPalette.size()];
+}
+
+void ResetSatellites(std::vector<Satellite>& sats) {
+    for (size_t i = 0; i < sats.size(); ++i) {
+        if (i < kMoonCount) ResetSatellite(sats[i], static_cast<float>(i) / static_cast<float>(kMoonCount));
+        else PlaceConstellationSatellite(sats[i], i - kMoonCount);
+    }
+}
+
+// Nearest satellite nobody is holding within kGrabRadius of point, or -1.
+int NearestFreeSatellite(const astro_spatial::SpatialHash& grid, const std::vector<Satellite>& sats, Vector3 point) {
+    int best = -1;
+    float bestDist2 = kGrabRadius * kGrabRadius;
+    grid.ForEachCandidate(point, kGrabRadius, [&](uint32_t si) {
+        if (sats[si].heldBy >= 0) return;
+        const float dist2 = Vector3DistanceSqr(sats[si].pos, point);
+        if (dist2 < bestDist2) {
+            bestDist2 = dist2;
+            best = static_cast<int>(si);
+        }
+    });
+    return best;
+}
+
 void DrawPlanet(float t) {
     DrawSphere({0.0f, 0.0f, 0.0f}, 1.45f, Color{94, 140, 240, 255});
     DrawSphere({0.0f, 0.0f, 0.0f}, 1.02f, Color{136, 186, 255, 255});
@@ -61,8 +124,12 @@ int main() {
     float camPitch = 0.42f;
     float camDistance = 15.5f;
 
+    // Releases come from pinch-up events, so a throw flicked between two frames still lets go.
+    GestureEngine<PinchGesture<>> gestures;
     HandSceneBridge bridge;
+    bridge.SetPacketListener([&gestures](const TrackingSample& sample) { gestures.Process(sample); });
     bridge.Start();
+    bridge.SetFilter(kHandFilter);
 
     std::vector<Satellite> sats = {
         {{}, {}, Color{132, 224, 255, 255}},
@@ -71,9 +138,24 @@ int main() {
         {{}, {}, Color{255, 168, 198, 255}},
         {{}, {}, Color{214, 190, 255, 255}},
     };
-    for (size_t i = 0; i < sats.size(); ++i) ResetSatellite(sats[i], static_cast<float>(i) / static_cast<float>(sats.size()));
+    sats.reserve(kMaxSatellites);
+    ResetSatellites(sats);
+
+    // Picking, hover and close-approach queries go through a uniform grid rebuilt each
+    // frame (an allocation-free counting sort), so they cost the same with a thousand
+    // satellites as with five; free satellites then advance in exact Kepler batches.
+    astro_spatial::SpatialHash grid;
+    std::vector<uint32_t> freeSats;
+    freeSats.reserve(kMaxSatellites);
+    std::vector<uint32_t> closeApproaches;
+    std::array<int, 2> heldIndex = {-1, -1};
+    std::array<int, 2> hoverIndex = {-1, -1};
+    const auto rebuildGrid = [&]() {
+        grid.Build(sats.size(), kGrabRadius, [&](size_t i) { return sats[i].pos; });
+    };
 
-    std::array<bool, 2> prevPinched = {false, false};
+    astro_render::InstancedParticleRenderer satRenderer;
+    satRenderer.Init(astro_render::InstanceShape::kSphere);
 
     while (!WindowShouldClose()) {
         const float dt = std::max(GetFrameTime(), 1.0e-4f);
@@ -84,55 +166,71 @@ int main() {
 
         const std::array<const HandControlState*, 2> hands = {&bridge.Control(false), &bridge.Control(true)};
 
+        if (IsKeyPressed(KEY_C) && sats.size() + kConstellationSize <= kMaxSatellites) {
+            for (size_t k = 0; k < kConstellationSize; ++k) {
+                Satellite sat;
+                sat.color = ConstellationColor(sats.size() - kMoonCount);
+                PlaceConstellationSatellite(sat, sats.size() - kMoonCount);
+                sats.push_back(sat);
+            }
+        }
+        if (IsKeyPressed(KEY_X) && sats.size() > kMoonCount) {
+            sats.resize(kMoonCount);
+            for (int& held : heldIndex) {
+                if (held >= static_cast<int>(kMoonCount)) held = -1;
+            }
+        }
+
+        rebuildGrid();
         for (size_t hi = 0; hi < hands.size(); ++hi) {
             const HandControlState& hand = *hands[hi];
-            const bool pinched = hand.active && hand.pinched;
-            if (pinched) {
-                int held = -1;
-                for (size_t si = 0; si < sats.size(); ++si) {
-                    if (sats[si].heldBy == static_cast<int>(hi)) held = static_cast<int>(si);
-                }
-                if (held < 0) {
-                    float bestDist = 0.75f;
-                    for (size_t si = 0; si < sats.size(); ++si) {
-                        if (sats[si].heldBy >= 0) continue;
-                        const float dist = Vector3Distance(sats[si].pos, hand.pinchPoint);
-                        if (dist < bestDist) {
-                            bestDist = dist;
-                            held = static_cast<int>(si);
-                        }
-                    }
-                    if (held >= 0) sats[static_cast<size_t>(held)].heldBy = static_cast<int>(hi);
-                }
+            hoverIndex[hi] = -1;
+            if (!hand.active || heldIndex[hi] >= 0) continue;
+            const int nearest = NearestFreeSatellite(grid, sats, hand.pinchPoint);
+            if (!hand.pinched) {
+                hoverIndex[hi] = nearest;
+            } else if (nearest >= 0) {
+                heldIndex[hi] = nearest;
+                sats[static_cast<size_t>(nearest)].heldBy = static_cast<int>(hi);
             }
-            if (prevPinched[hi] && !pinched) {
-                for (Satellite& sat : sats) {
-                    if (sat.heldBy == static_cast<int>(hi)) {
-                        sat.heldBy = -1;
-                        sat.vel = Vector3Scale(hand.velocity, 0.060f);
-                    }
+        }
+
+        for (GestureEvent event; gestures.Poll(&event);) {
+            const size_t hi = event.rightHand ? 1 : 0;
+            if (event.type == GestureType::kPinchUp) {
+                if (heldIndex[hi] >= 0) {
+                    Satellite& sat = sats[static_cast<size_t>(heldIndex[hi])];
+                    sat.heldBy = -1;
+                    sat.vel = Vector3Scale(hands[hi]->velocity, 0.060f);
+                    heldIndex[hi] = -1;
                 }
+            } else if (event.type == GestureType::kPinchTaps && event.count >= 2) {
+                heldIndex = {-1, -1};
+                ResetSatellites(sats);
             }
-            prevPinched[hi] = pinched;
         }
 
-        int stableCount = 0;
+        freeSats.clear();
         for (size_t i = 0; i < sats.size(); ++i) {
             Satellite& sat = sats[i];
             if (sat.heldBy >= 0) {
                 sat.pos = hands[static_cast<size_t>(sat.heldBy)]->pinchPoint;
                 sat.vel = {0.0f, 0.0f, 0.0f};
                 sat.stableTime = 0.0f;
-                continue;
+            } else {
+                freeSats.push_back(static_cast<uint32_t>(i));
             }
+        }
+        // Exact two-body steps: satellites reset below r = 1.65, so the old 0.8 softening
+        // never applied and a long frame no longer throws orbits off.
+        astro_kepler::Propagate(freeSats.size(), kPlanetMu, dt, [&](size_t k) -> Satellite& { return sats[freeSats[k]]; });
 
-            Vector3 d = Vector3Subtract({0.0f, 0.0f, 0.0f}, sat.pos);
-            const float r = std::max(0.8f, Vector3Length(d));
-            sat.vel = Vector3Add(sat.vel, Vector3Scale(d, 10.5f * dt / (r * r * r)));
-            sat.pos = Vector3Add(sat.pos, Vector3Scale(sat.vel, dt));
-
+        int stableCount = 0;
+        for (const uint32_t i : freeSats) {
+            Satellite& sat = sats[i];
+            const float r = Vector3Length(sat.pos);
             const float speed = Vector3Length(sat.vel);
-            const float energy = 0.5f * speed * speed - 10.5f / r;
+            const float energy = 0.5f * speed * speed - kPlanetMu / r;
             if (r > 2.2f && r < 8.2f && energy < -0.05f) sat.stableTime += dt;
             else sat.stableTime = std::max(0.0f, sat.stableTime - 2.0f * dt);
             if (sat.stableTime > 2.0f) ++stableCount;
@@ -140,36 +238,62 @@ int main() {
             if (r < 1.65f || r > 11.0f) ResetSatellite(sat, std::fmod(t * 0.13f + static_cast<float>(i) * 0.19f, 1.0f));
         }
 
+        closeApproaches.clear();
+        rebuildGrid();
+        for (const int held : heldIndex) {
+            if (held < 0) continue;
+            const Vector3 center = sats[static_cast<size_t>(held)].pos;
+            grid.ForEachCandidate(center, kProximityRadius, [&](uint32_t si) {
+                if (static_cast<int>(si) != held && Vector3DistanceSqr(sats[si].pos, center) < kProximityRadius * kProximityRadius) {
+                    closeApproaches.push_back(si);
+                }
+            });
+        }
+
         BeginDrawing();
         ClearBackground(Color{4, 8, 16, 255});
         DrawStarfieldBackdrop(280, 0x44AA17u, t * 0.10f, Color{228, 236, 255, 255});
 
         BeginMode3D(camera);
         DrawPlanet(t);
-        for (const Satellite& sat : sats) {
-            DrawSphere(sat.pos, 0.16f, sat.color);
-            DrawSphere(sat.pos, 0.28f, Fade(sat.color, 0.18f));
-            if (sat.stableTime > 1.2f) {
+        satRenderer.Clear();
+        satRenderer.Reserve(2 * sats.size());
+        for (size_t i = 0; i < sats.size(); ++i) {
+            const Satellite& sat = sats[i];
+            const float core = i < kMoonCount ? 0.16f : 0.09f;
+            satRenderer.Add(sat.pos, core, sat.color);
+            satRenderer.Add(sat.pos, core * 1.75f, Fade(sat.color, sat.stableTime > 2.0f ? 0.30f : 0.18f));
+            // Orbit shells only for the moons; a thousand wire spheres would bury the scene.
+            if (i < kMoonCount && sat.stableTime > 1.2f) {
                 DrawSphereWires({0.0f, 0.0f, 0.0f}, Vector3Length(sat.pos), 32, 20, Fade(sat.color, 0.18f));
             }
         }
+        satRenderer.Draw();
+        for (const int hovered : hoverIndex) {
+            if (hovered >= 0) DrawSphereWires(sats[static_cast<size_t>(hovered)].pos, 0.36f, 8, 8, Fade(WHITE, 0.65f));
+        }
+        for (const uint32_t si : closeApproaches) DrawSphereWires(sats[si].pos, 0.26f, 6, 6, Color{255, 150, 96, 220});
         if (bridge.AnyTracked()) bridge.DrawHands(false);
         EndMode3D();
 
         DrawText("Orbital Construction Hand Lab", 20, 18, 34, Color{236, 240, 248, 255});
-        DrawText("Pinch a moon or satellite, move it, then release it with a good tangent velocity to build a stable orbit.", 20, 58, 20, Color{182, 198, 226, 255});
+        DrawText("Pinch a moon or satellite, move it, then release it with a good tangent velocity to build a stable orbit. Double pinch resets.", 20, 58, 20, Color{182, 198, 226, 255});
         std::ostringstream os;
         os.setf(std::ios::fixed);
         os.precision(2);
-        os << "stable orbits=" << stableCount << "/" << sats.size();
+        os << "stable orbits=" << stableCount << "/" << sats.size() << "  close approaches=" << closeApproaches.size();
         DrawText(os.str().c_str(), 20, 88, 19, Color{132, 228, 255, 255});
         DrawBridgeStatus(bridge, 20, 116);
-        DrawText("This is more game-like: grab, place, release, and see whether the orbit survives or crashes out.", 20, 142, 18, Color{255, 218, 142, 255});
+        DrawText("C adds a ring of 64 satellites, X clears them. Satellites close to the one in hand light up as close approaches.", 20, 142, 18, Color{255, 218, 142, 255});
         DrawFPS(20, 170);
         bridge.DrawPreviewPanel({static_cast<float>(GetScreenWidth() - 392), 20.0f, 360.0f, 220.0f}, "Python Webcam Feed");
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    satRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
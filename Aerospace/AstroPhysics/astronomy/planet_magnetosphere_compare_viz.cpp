@@ -1,9 +1,22 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/boris_pusher.h"
+#include "../common/dynamic_resolution.h"
+#include "../common/field_line_tracer.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/instanced_particles.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+#include "../common/starfield.h"
+#include "../common/task_graph.h"
+#include "../common/thread_pool.h"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <random>
 #include <string_view>
@@ -13,10 +26,26 @@ namespace {
 
 constexpr int kScreenWidth = 1600;
 constexpr int kScreenHeight = 960;
-constexpr int kParticlesPerPlanet = 520;
+constexpr int kParticleCounts[] = {520, 5200, 52000};  // solar-wind test particles per planet
+constexpr int kParticleCountPresets = static_cast<int>(sizeof(kParticleCounts) / sizeof(kParticleCounts[0]));
+constexpr int kDefaultParticleCount = 1;
 constexpr int kStarCount = 420;
 constexpr int kDustCount = 140;
 constexpr Vector3 kSunPosition = {-23.5f, 0.0f, 0.0f};
+constexpr int kFieldLatitudes = 12;
+constexpr int kFieldLongitudes = 16;
+constexpr float kFootLatitudeMin = 24.0f * DEG2RAD;
+constexpr float kFootLatitudeMax = 80.0f * DEG2RAD;
+constexpr float kImfCoupling = 0.22f;    // IMF strength relative to the compressed field at the nose
+constexpr float kTailLobeField = 0.9f;   // lobe field relative to the dipole field at the nose
+constexpr float kRetraceTolerance = 0.015f;  // relative change in the field inputs that re-traces a planet
+constexpr float kStormerScale = 0.75f;  // Stormer length over magnetopause radius; sets each planet's q/m
+constexpr float kWindMaxGyroAngle = 0.8f;
+constexpr int kWindMaxSubsteps = 10;
+constexpr float kWindLifetime = 12.0f;  // seconds before a trapped particle is recycled
+constexpr float kWindThermalSpread = 0.06f;
+constexpr int kMaxWindStreaks = 1800;
+constexpr uint32_t kWindSeed = 2571u;
 
 struct OrbitCameraState {
     float yaw = 0.82f;
@@ -24,12 +53,6 @@ struct OrbitCameraState {
     float distance = 34.0f;
 };
 
-struct BackdropStar {
-    Vector3 pos{};
-    float size = 0.0f;
-    float alpha = 0.0f;
-};
-
 struct DustMote {
     Vector3 pos{};
     float radius = 0.0f;
@@ -62,16 +85,6 @@ struct PlanetState {
     float fieldCompression = 0.0f;
 };
 
-struct WindParticle {
-    int planetIndex = 0;
-    Vector3 localPos{};
-    Vector3 prevLocalPos{};
-    float speedJitter = 0.0f;
-    float lane = 0.0f;
-    float swirl = 0.0f;
-    float size = 0.0f;
-};
-
 float RandRange(std::mt19937& rng, float lo, float hi) {
     std::uniform_real_distribution<float> dist(lo, hi);
     return dist(rng);
@@ -251,24 +264,23 @@ std::array<PlanetState, 4> MakePlanets() {
     }};
 }
 
-std::vector<BackdropStar> MakeBackdropStars() {
+std::vector<astro_render::StarfieldStar> MakeBackdropStars() {
     std::mt19937 rng(8142);
-    std::vector<BackdropStar> stars;
+    std::vector<astro_render::StarfieldStar> stars;
     stars.reserve(kStarCount);
 
     for (int i = 0; i < kStarCount; ++i) {
         const float theta = RandRange(rng, 0.0f, 2.0f * PI);
         const float phi = RandRange(rng, -0.46f * PI, 0.46f * PI);
         const float radius = RandRange(rng, 54.0f, 78.0f);
-        stars.push_back({
-            {
-                radius * std::cos(phi) * std::cos(theta),
-                radius * std::sin(phi),
-                radius * std::cos(phi) * std::sin(theta),
-            },
-            RandRange(rng, 0.025f, 0.115f),
-            RandRange(rng, 0.18f, 0.95f),
-        });
+        const Vector3 pos = {
+            radius * std::cos(phi) * std::cos(theta),
+            radius * std::sin(phi),
+            radius * std::cos(phi) * std::sin(theta),
+        };
+        const float size = RandRange(rng, 0.025f, 0.115f);
+        const float alpha = RandRange(rng, 0.18f, 0.95f);
+        stars.push_back({pos, size, Fade(WHITE, alpha), 0.0f, 0.0f, 0.0f, 0.0f});
     }
 
     return stars;
@@ -360,15 +372,6 @@ Vector3 IncomingCenterlineLocal(const PlanetState& planet, float localX) {
     return {localX, 0.0f, 0.0f};
 }
 
-void SeedParticleAlongFlow(WindParticle* particle, const PlanetState& planet, std::mt19937* rng, float x) {
-    const Vector3 centerline = IncomingCenterlineLocal(planet, x);
-    const float radialScale = x < 0.0f ? 0.42f : 0.95f;
-    const float dy = particle->lane * 0.80f + RandRange(*rng, -0.42f, 0.42f) * radialScale;
-    const float dz = std::sin(particle->swirl) * 0.65f + RandRange(*rng, -0.38f, 0.38f) * radialScale;
-    particle->localPos = {x, centerline.y + dy, centerline.z + dz};
-    particle->prevLocalPos = particle->localPos;
-}
-
 Vector3 DeflectLocalFlow(const PlanetState& planet, Vector3 local, float time, float imfTiltDeg) {
     const float imfTilt = imfTiltDeg * DEG2RAD;
     const Vector3 centerline = IncomingCenterlineLocal(planet, local.x);
@@ -404,73 +407,6 @@ Vector3 DeflectLocalFlow(const PlanetState& planet, Vector3 local, float time, f
     return {centered.x, centered.y + centerline.y, centered.z + centerline.z};
 }
 
-void RespawnParticle(WindParticle* particle, const PlanetState& planet, std::mt19937* rng) {
-    particle->speedJitter = RandRange(*rng, 0.82f, 1.24f);
-    particle->lane = RandRange(*rng, -1.0f, 1.0f);
-    particle->swirl = RandRange(*rng, 0.0f, 2.0f * PI);
-    particle->size = RandRange(*rng, 0.028f, 0.074f);
-    const float sourceX = SunLocalCenter(planet).x + RandRange(*rng, 2.4f, 5.6f);
-    SeedParticleAlongFlow(particle, planet, rng, sourceX);
-}
-
-std::vector<WindParticle> MakeWindParticles(const std::array<PlanetState, 4>& planets) {
-    std::mt19937 rng(2571);
-    std::vector<WindParticle> particles;
-    particles.reserve(static_cast<std::size_t>(planets.size()) * kParticlesPerPlanet);
-
-    for (int planetIndex = 0; planetIndex < static_cast<int>(planets.size()); ++planetIndex) {
-        for (int i = 0; i < kParticlesPerPlanet; ++i) {
-            WindParticle particle{};
-            particle.planetIndex = planetIndex;
-            RespawnParticle(&particle, planets[planetIndex], &rng);
-            const float sourceX = SunLocalCenter(planets[planetIndex]).x + 2.2f;
-            const float x = RandRange(rng, sourceX, planets[planetIndex].tailLength + 2.6f);
-            SeedParticleAlongFlow(&particle, planets[planetIndex], &rng, x);
-            particles.push_back(particle);
-        }
-    }
-
-    return particles;
-}
-
-void UpdateWindParticles(std::vector<WindParticle>* particles,
-                         const std::array<PlanetState, 4>& planets,
-                         float dt,
-                         float time,
-                         float windSpeed,
-                         float imfTiltDeg) {
-    static std::mt19937 rng(6621);
-
-    for (WindParticle& particle : *particles) {
-        const PlanetState& planet = planets[particle.planetIndex];
-        const float speed = (4.8f + 3.2f * windSpeed) * particle.speedJitter;
-
-        particle.prevLocalPos = particle.localPos;
-        particle.localPos.x += speed * dt;
-        const Vector3 centerline = IncomingCenterlineLocal(planet, particle.localPos.x);
-        particle.localPos.y += (centerline.y - particle.localPos.y) * std::min(1.0f, 1.9f * dt);
-        particle.localPos.z += (centerline.z - particle.localPos.z) * std::min(1.0f, 1.9f * dt);
-        particle.localPos.y += 0.24f * std::sin(time * 1.5f + particle.swirl + particle.localPos.x * 0.22f) * dt;
-        particle.localPos.z += 0.24f * std::cos(time * 1.24f + particle.lane * 4.2f + particle.localPos.x * 0.17f) * dt;
-        particle.localPos = DeflectLocalFlow(planet, particle.localPos, time, imfTiltDeg);
-
-        const float yz = std::sqrt(particle.localPos.y * particle.localPos.y + particle.localPos.z * particle.localPos.z);
-        const float bodyRadius = planet.preset.displayRadius;
-
-        if (yz < bodyRadius * (planet.preset.globalDipole ? 0.92f : 1.08f) &&
-            std::fabs(particle.localPos.x) < bodyRadius * 1.08f) {
-            RespawnParticle(&particle, planet, &rng);
-            continue;
-        }
-
-        if (particle.localPos.x > planet.tailLength + 6.4f ||
-            std::fabs(particle.localPos.y) > 10.0f ||
-            std::fabs(particle.localPos.z) > 10.0f) {
-            RespawnParticle(&particle, planet, &rng);
-        }
-    }
-}
-
 template <std::size_t N>
 void DrawRibbonStrip(const std::array<Vector3, N>& left, const std::array<Vector3, N>& right, Color color, float alpha) {
     for (std::size_t i = 1; i < N; ++i) {
@@ -503,10 +439,8 @@ void DrawSun(float time) {
     }
 }
 
-void DrawBackground(const std::vector<BackdropStar>& stars, const std::vector<DustMote>& dust, float time) {
-    for (const BackdropStar& star : stars) {
-        DrawSphere(star.pos, star.size, Fade(WHITE, star.alpha));
-    }
+void DrawBackground(astro_render::StarfieldLayer* starfield, const std::vector<DustMote>& dust, float time) {
+    starfield->Draw(time);
 
     for (std::size_t i = 0; i < dust.size(); ++i) {
         const DustMote& mote = dust[i];
@@ -661,71 +595,260 @@ void DrawSolarWindStreamlines(const PlanetState& planet, float time, float imfTi
     }
 }
 
-Vector3 DipoleFieldPoint(float shellRadius, float latitude, float longitude, float tailStretch, float tiltRad) {
-    const float c = std::cos(latitude);
-    const float s = std::sin(latitude);
-    const float radial = shellRadius * c * c;
-    Vector3 p = {radial * c, radial * s, 0.0f};
+using PlanetFieldCache = astro_fieldlines::FieldLineCache<astro_fieldlines::MagnetosphereField>;
 
-    if (p.x > 0.0f) {
-        p.x *= 1.0f + tailStretch * (p.x / std::max(0.001f, shellRadius));
-    } else {
-        p.x *= 0.76f;
-    }
+// Field inputs a traced set was built from; the set is re-traced once they drift by more
+// than kRetraceTolerance.
+struct FieldKey {
+    float magnetopause = 0.0f;
+    float tail = 0.0f;
+    float compression = 0.0f;
+    float imfTiltDeg = 0.0f;
+};
 
-    p = Vector3RotateByAxisAngle(p, {1.0f, 0.0f, 0.0f}, longitude);
-    p = Vector3RotateByAxisAngle(p, {0.0f, 0.0f, 1.0f}, tiltRad);
-    return p;
+struct PlanetFieldLines {
+    PlanetFieldCache cache;
+    FieldKey traced{};
+    int retraces = 0;
+};
+
+FieldKey MakeFieldKey(const PlanetState& planet, float imfTiltDeg) {
+    return {planet.magnetopauseRadius, planet.tailLength, planet.fieldCompression, imfTiltDeg};
+}
+
+bool FieldKeyChanged(const FieldKey& a, const FieldKey& b) {
+    auto drift = [](float x, float y) { return std::fabs(x - y) > kRetraceTolerance * std::max(std::fabs(x), std::fabs(y)); };
+    return drift(a.magnetopause, b.magnetopause) || drift(a.tail, b.tail) || std::fabs(a.compression - b.compression) > kRetraceTolerance ||
+           std::fabs(a.imfTiltDeg - b.imfTiltDeg) > 0.5f;
 }
 
-void DrawDipoleFieldLines(const PlanetState& planet, float time, float imfTiltDeg, bool selected) {
+// Field model in planet-local coordinates: the dipole is scaled to unit field on the
+// equator and the IMF to a fraction of the compressed nose field, so every planet traces
+// the same topology at its own size. Mars gets the IMF draped around its ionosphere.
+astro_fieldlines::MagnetosphereField PlanetFieldModel(const PlanetState& planet, float imfTiltDeg) {
+    astro_fieldlines::MagnetosphereField field;
+    const float rp = planet.preset.displayRadius;
+    const float mp = planet.magnetopauseRadius;
+    const float imfTilt = imfTiltDeg * DEG2RAD;
+    field.standoff = mp;
+    field.tailLength = planet.tailLength;
+    field.sheetThickness = 0.12f * mp;
+
     if (!planet.preset.globalDipole) {
-        const Color drapeColor = WithAlpha(planet.preset.fieldColor, selected ? 0.24f : 0.12f);
-        for (int i = 0; i < 11; ++i) {
-            const float z = -3.0f + i * 0.60f;
-            Vector3 prev{};
-            bool hasPrev = false;
-            for (int j = 0; j <= 56; ++j) {
-                const float t = static_cast<float>(j) / 56.0f;
-                const float x = Lerp(-planet.magnetopauseRadius, planet.magnetopauseRadius * 0.9f, t);
-                const float arch = planet.magnetopauseRadius * (0.86f - std::pow(2.0f * t - 1.0f, 2.0f) * 0.64f);
-                const Vector3 p = Vector3Add(planet.preset.center, {
-                    x,
-                    arch + 0.20f * std::sin(time * 1.7f + i * 0.4f + t * 6.0f),
-                    z,
-                });
-                if (hasPrev) DrawLine3D(prev, p, drapeColor);
-                prev = p;
-                hasPrev = true;
-            }
+        field.imf = {0.0f, std::sin(imfTilt), std::cos(imfTilt)};
+        field.obstacleRadius = mp * 0.72f;
+        return field;
+    }
+
+    const float noseField = rp * rp * rp / (mp * mp * mp);
+    const float imf = kImfCoupling * 2.0f * noseField;
+    field.moment = rp * rp * rp;
+    field.tilt = (planet.preset.dipoleTiltDeg + 0.34f * imfTiltDeg) * DEG2RAD;
+    field.imf = {0.0f, imf * std::sin(imfTilt), imf * std::cos(imfTilt)};
+    field.tailField = kTailLobeField * noseField * (1.0f + planet.preset.tailBias);
+    return field;
+}
+
+astro_fieldlines::TraceOptions PlanetTraceOptions(const PlanetState& planet) {
+    astro_fieldlines::TraceOptions options;
+    const float mp = planet.magnetopauseRadius;
+    options.sampleSpacing = std::clamp(0.045f * mp, 0.06f, 0.32f);
+    options.innerRadius = planet.preset.displayRadius * 1.02f;
+    options.outerRadius = mp * 1.6f;
+    options.minX = -planet.bowShockRadius * 1.1f;
+    options.maxX = planet.preset.globalDipole ? planet.tailLength * 1.05f : mp * 1.6f;
+    options.maxLength = 4.0f * (options.maxX - options.minX);
+    options.tolerance = 1e-4f * mp;
+    return options;
+}
+
+// Dipole planets: footpoints from both magnetic hemispheres traced outward.
+// Mars: a sheet of seeds across the flow, traced both ways along the draped IMF.
+std::vector<astro_fieldlines::Seed> PlanetFieldSeeds(const PlanetState& planet, const astro_fieldlines::MagnetosphereField& field) {
+    if (planet.preset.globalDipole) {
+        return astro_fieldlines::DipoleFootpointSeeds(field, planet.preset.displayRadius * 1.03f, kFieldLatitudes, kFieldLongitudes,
+                                                      kFootLatitudeMin, kFootLatitudeMax);
+    }
+
+    std::vector<astro_fieldlines::Seed> seeds;
+    const float mp = planet.magnetopauseRadius;
+    const float len = std::sqrt(field.imf[1] * field.imf[1] + field.imf[2] * field.imf[2]);
+    const Vector3 across = {0.0f, -field.imf[2] / len, field.imf[1] / len};
+    for (int ix = 0; ix < 9; ++ix) {
+        for (int ia = 0; ia < 11; ++ia) {
+            const float x = mp * (-1.3f + 2.6f * ix / 8.0f);
+            const float a = mp * (-1.25f + 2.5f * ia / 10.0f);
+            const Vector3 p = {x, across.y * a, across.z * a};
+            if (Vector3Length(p) < field.obstacleRadius * 1.05f) continue;
+            astro_fieldlines::Seed seed;
+            seed.pos = {p.x, p.y, p.z};
+            seed.bothWays = true;
+            seeds.push_back(seed);
         }
-        return;
     }
+    return seeds;
+}
 
-    const float tilt = (planet.preset.dipoleTiltDeg + 0.34f * imfTiltDeg) * DEG2RAD;
-    const Color fieldColor = WithAlpha(planet.preset.fieldColor, selected ? 0.34f : 0.16f);
+void RequestPlanetFieldLines(PlanetFieldLines* lines, const PlanetState& planet, float imfTiltDeg, bool async) {
+    const astro_fieldlines::MagnetosphereField field = PlanetFieldModel(planet, imfTiltDeg);
+    std::vector<astro_fieldlines::Seed> seeds = PlanetFieldSeeds(planet, field);
+    if (async) {
+        lines->cache.Request(field, std::move(seeds), PlanetTraceOptions(planet));
+    } else {
+        lines->cache.TraceNow(field, seeds, PlanetTraceOptions(planet));
+    }
+    lines->traced = MakeFieldKey(planet, imfTiltDeg);
+    ++lines->retraces;
+}
 
-    for (int shell = 0; shell < 8; ++shell) {
-        const float shellRadius = planet.preset.displayRadius * (1.45f + shell * 0.48f);
-        for (int az = 0; az < 10; ++az) {
-            const float longitude = (2.0f * PI * az) / 10.0f;
-            Vector3 prev{};
-            bool hasPrev = false;
+// Swaps in finished traces and queues a re-trace for planets whose inputs moved. A planet
+// still tracing keeps its request until the worker is free, so a held key cannot flood it.
+void RefreshFieldLines(std::array<PlanetFieldLines, 4>* fieldLines, const std::array<PlanetState, 4>& planets, float imfTiltDeg) {
+    for (std::size_t i = 0; i < planets.size(); ++i) {
+        PlanetFieldLines& lines = (*fieldLines)[i];
+        lines.cache.Acquire();
+        if (lines.cache.Busy() || !FieldKeyChanged(lines.traced, MakeFieldKey(planets[i], imfTiltDeg))) continue;
+        RequestPlanetFieldLines(&lines, planets[i], imfTiltDeg, true);
+    }
+}
 
-            for (int i = 0; i <= 132; ++i) {
-                const float lat = -1.20f + 2.40f * static_cast<float>(i) / 132.0f;
-                Vector3 p = DipoleFieldPoint(shellRadius, lat, longitude, 0.48f + 0.24f * planet.preset.tailBias, tilt);
-                if (Vector3Length(p) < planet.preset.displayRadius * 1.03f) {
-                    hasPrev = false;
-                    continue;
-                }
+// Solar-wind protons as test particles in the same field model the lines are traced
+// through. Outside the magnetopause they also feel the motional field E = -u x B_imf, so
+// they E x B drift with the wind; inside it only the planet's field acts, and the dipole
+// turns them away below the Stormer length sqrt(M q / m v).
+struct WindField {
+    astro_fieldlines::MagnetosphereField magnetic;
+    PlanetState planet;
+    std::array<float, 3> motional{};
+
+    void operator()(float x, float y, float z, float* e, float* b) const {
+        magnetic(x, y, z, b);
+        const float boundary = MagnetopauseBoundaryYZ(planet, x);
+        const float shield = boundary > 0.0f ? SmoothStep(0.85f * boundary, 1.15f * boundary, std::sqrt(y * y + z * z)) : 1.0f;
+        e[0] = motional[0] * shield;
+        e[1] = motional[1] * shield;
+        e[2] = motional[2] * shield;
+    }
+};
 
-                p.y += 0.05f * std::sin(time * 1.45f + shell * 0.8f + lat * 5.0f);
-                p = Vector3Add(p, planet.preset.center);
-                if (hasPrev) DrawLine3D(prev, p, fieldColor);
-                prev = p;
-                hasPrev = true;
-            }
+struct WindBatch {
+    astro_plasma::ParticleBatch batch;
+    std::vector<uint32_t> respawns;  // Philox counter per particle, so respawns need no shared generator
+    std::vector<float> age;
+};
+
+float BulkWindSpeed(float windSpeed) { return 4.8f + 3.2f * windSpeed; }
+
+float WindInjectionX(const PlanetState& planet) { return -1.5f * planet.bowShockRadius - 1.0f; }
+
+float WindInjectionRadius(const PlanetState& planet) { return std::min(9.5f, 1.4f * planet.bowShockRadius + 1.0f); }
+
+WindField MakeWindField(const PlanetState& planet, float imfTiltDeg, float speed) {
+    WindField field;
+    field.magnetic = PlanetFieldModel(planet, imfTiltDeg);
+    field.planet = planet;
+    const std::array<float, 3>& imf = field.magnetic.imf;
+    field.motional = {0.0f, speed * imf[2], -speed * imf[1]};  // -u x B for u along +x
+    return field;
+}
+
+float WindChargeOverMass(const PlanetState& planet, const astro_fieldlines::MagnetosphereField& field, float speed) {
+    if (field.moment > 0.0f) {
+        const float stormer = kStormerScale * planet.magnetopauseRadius;
+        return stormer * stormer * speed / field.moment;
+    }
+    return speed / planet.magnetopauseRadius;  // gyro-radius of order the obstacle in the unit draped field
+}
+
+// Draws a fresh particle from Philox stream (planet, index, respawn count). `anywhere`
+// fills the whole box (start-up) instead of the upstream injection slab.
+void SpawnWindParticle(WindBatch* wind, size_t i, int planetIndex, const PlanetState& planet, float speed, bool anywhere) {
+    astro_random::PhiloxStream rng({kWindSeed, static_cast<uint32_t>(planetIndex)}, static_cast<uint32_t>(i), wind->respawns[i]++);
+    const float x0 = WindInjectionX(planet);
+    const float radius = WindInjectionRadius(planet);
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        x = anywhere ? rng.Uniform(x0, planet.tailLength + 6.4f) : x0 + rng.Uniform(0.0f, 1.5f);
+        const float r = radius * std::sqrt(rng.Uniform());
+        const float a = rng.Uniform(0.0f, 2.0f * PI);
+        y = r * std::cos(a);
+        z = r * std::sin(a);
+        const float boundary = MagnetopauseBoundaryYZ(planet, x);
+        if (boundary <= 0.0f || y * y + z * z > boundary * boundary) break;
+    }
+    astro_plasma::ParticleBatch& batch = wind->batch;
+    batch.x[i] = x;
+    batch.y[i] = y;
+    batch.z[i] = z;
+    batch.vx[i] = speed * rng.Uniform(0.82f, 1.24f);
+    batch.vy[i] = speed * kWindThermalSpread * (rng.Uniform() + rng.Uniform() - 1.0f);
+    batch.vz[i] = speed * kWindThermalSpread * (rng.Uniform() + rng.Uniform() - 1.0f);
+    wind->age[i] = anywhere ? rng.Uniform(0.0f, kWindLifetime) : 0.0f;
+}
+
+void MakeWindParticles(std::array<WindBatch, 4>* winds, const std::array<PlanetState, 4>& planets, int perPlanet, float windSpeed) {
+    const float speed = BulkWindSpeed(windSpeed);
+    for (int p = 0; p < static_cast<int>(planets.size()); ++p) {
+        WindBatch& wind = (*winds)[p];
+        wind.batch.resize(static_cast<size_t>(perPlanet));
+        wind.respawns.assign(static_cast<size_t>(perPlanet), 0u);
+        wind.age.assign(static_cast<size_t>(perPlanet), 0.0f);
+        astro_parallel::SharedPool().ParallelFor(perPlanet, 1024, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) SpawnWindParticle(&wind, static_cast<size_t>(i), p, planets[p], speed, true);
+        });
+    }
+}
+
+// Each planet's wind is independent of the others, so the live loop runs one of these per
+// planet as a separate task.
+void UpdatePlanetWind(WindBatch* windBatch, const PlanetState& planet, int p, float dt, float windSpeed, float imfTiltDeg) {
+    const float speed = BulkWindSpeed(windSpeed);
+    WindBatch& wind = *windBatch;
+    const WindField field = MakeWindField(planet, imfTiltDeg, speed);
+    wind.batch.chargeOverMass = WindChargeOverMass(planet, field.magnetic, speed);
+
+    // Sub-steps resolve gyration at 1.5 planet radii; closer in Boris stays stable, just coarse.
+    float e[3], b[3];
+    field(-1.5f * planet.preset.displayRadius, 0.0f, 0.0f, e, b);
+    const float omega = wind.batch.chargeOverMass * std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+    const int steps = std::clamp(static_cast<int>(std::ceil(omega * dt / kWindMaxGyroAngle)), 1, kWindMaxSubsteps);
+    astro_plasma::BorisPush(&wind.batch, dt / steps, steps, field);
+
+    const float body2 = planet.preset.displayRadius * planet.preset.displayRadius * 1.04f;
+    const float x0 = WindInjectionX(planet) - 2.0f;
+    const float x1 = planet.tailLength + 6.4f;
+    astro_parallel::SharedPool().ParallelFor(static_cast<int>(wind.batch.size()), astro_plasma::kPushChunk, [&](int begin, int end) {
+        const astro_plasma::ParticleBatch& batch = wind.batch;
+        for (int i = begin; i < end; ++i) {
+            wind.age[i] += dt;
+            const float x = batch.x[i], y = batch.y[i], z = batch.z[i];
+            const bool hit = x * x + y * y + z * z < body2;
+            const bool gone = x < x0 || x > x1 || std::fabs(y) > 10.0f || std::fabs(z) > 10.0f;
+            if (hit || gone || wind.age[i] > kWindLifetime) SpawnWindParticle(&wind, static_cast<size_t>(i), p, planet, speed, false);
+        }
+    });
+}
+
+void UpdateWindParticles(std::array<WindBatch, 4>* winds, const std::array<PlanetState, 4>& planets, float dt, float windSpeed,
+                         float imfTiltDeg) {
+    for (int p = 0; p < static_cast<int>(planets.size()); ++p) UpdatePlanetWind(&(*winds)[p], planets[p], p, dt, windSpeed, imfTiltDeg);
+}
+
+void DrawTracedFieldLines(const PlanetState& planet, const astro_fieldlines::FieldLineSet& lines, bool selected) {
+    const float alpha = selected ? 0.34f : 0.16f;
+    const Color closedColor = WithAlpha(planet.preset.fieldColor, alpha);
+    const Color openColor = WithAlpha(LerpColor(planet.preset.fieldColor, planet.preset.auroraColor, 0.45f), alpha * 0.8f);
+    const float* xyz = lines.xyz.data();
+
+    for (int line = 0; line < lines.lineCount(); ++line) {
+        const Color color = lines.closed[line] ? closedColor : openColor;
+        const int begin = lines.lineStart[line];
+        const int end = lines.lineStart[line + 1];
+        Vector3 prev = Vector3Add(planet.preset.center, {xyz[3 * begin], xyz[3 * begin + 1], xyz[3 * begin + 2]});
+        for (int v = begin + 1; v < end; ++v) {
+            const Vector3 p = Vector3Add(planet.preset.center, {xyz[3 * v], xyz[3 * v + 1], xyz[3 * v + 2]});
+            DrawLine3D(prev, p, color);
+            prev = p;
         }
     }
 }
@@ -863,24 +986,38 @@ void DrawPlanetBody(const PlanetState& planet, float time, bool selected) {
     }
 }
 
-void DrawParticles(const std::vector<WindParticle>& particles, const std::array<PlanetState, 4>& planets, int selectedPlanet) {
-    for (const WindParticle& particle : particles) {
-        const PlanetState& planet = planets[particle.planetIndex];
-        const Vector3 p = Vector3Add(planet.preset.center, particle.localPos);
-        const Vector3 q = Vector3Add(planet.preset.center, particle.prevLocalPos);
-
-        const float yz = std::sqrt(particle.localPos.y * particle.localPos.y + particle.localPos.z * particle.localPos.z);
-        const float shell = MagnetopauseBoundaryYZ(planet, particle.localPos.x);
-        const bool insideField = shell > 0.0f && yz < shell;
-        Color color = insideField ? planet.preset.auroraColor : Color{178, 228, 255, 255};
-
-        if (particle.planetIndex != selectedPlanet) {
-            color = WithAlpha(color, insideField ? 0.58f : 0.34f);
+void DrawParticles(const std::array<WindBatch, 4>& winds,
+                   const std::array<PlanetState, 4>& planets,
+                   int selectedPlanet,
+                   astro_render::InstancedParticleRenderer* instanced) {
+    const Color windColor = Color{178, 228, 255, 255};
+    size_t total = 0;
+    for (const WindBatch& wind : winds) total += wind.batch.size();
+    instanced->Clear();
+    instanced->Reserve(total);
+
+    for (int p = 0; p < static_cast<int>(planets.size()); ++p) {
+        const PlanetState& planet = planets[p];
+        const astro_plasma::ParticleBatch& batch = winds[p].batch;
+        const bool selected = p == selectedPlanet;
+        const Color inside = selected ? planet.preset.auroraColor : WithAlpha(planet.preset.auroraColor, 0.58f);
+        const Color outside = selected ? windColor : WithAlpha(windColor, 0.34f);
+        const float size = selected ? 2.6f : 2.0f;
+        const size_t streakStride = std::max<size_t>(1, batch.size() * planets.size() / kMaxWindStreaks);
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const float yz = std::sqrt(batch.y[i] * batch.y[i] + batch.z[i] * batch.z[i]);
+            const float shell = MagnetopauseBoundaryYZ(planet, batch.x[i]);
+            const bool insideField = shell > 0.0f && yz < shell;
+            const Vector3 pos = Vector3Add(planet.preset.center, {batch.x[i], batch.y[i], batch.z[i]});
+            instanced->Add(pos, size, insideField ? inside : outside);
+            if (i % streakStride == 0) {
+                const Vector3 tail = Vector3Subtract(pos, Vector3Scale({batch.vx[i], batch.vy[i], batch.vz[i]}, 0.035f));
+                DrawLine3D(tail, pos, WithAlpha(insideField ? inside : outside, insideField ? 0.30f : 0.16f));
+            }
         }
-
-        DrawLine3D(q, p, WithAlpha(color, insideField ? 0.30f : 0.16f));
-        DrawSphere(p, particle.size, color);
     }
+    instanced->Draw();
 }
 
 void DrawPanelLabels(const std::array<PlanetState, 4>& planets, const Camera3D& camera, int selectedPlanet) {
@@ -913,10 +1050,12 @@ void DrawPanelLabels(const std::array<PlanetState, 4>& planets, const Camera3D&
 }
 
 void DrawComparisonPanel(const std::array<PlanetState, 4>& planets,
+                         const std::array<PlanetFieldLines, 4>& fieldLines,
                          int selectedPlanet,
                          float windSpeed,
                          float windDensity,
                          float imfTiltDeg,
+                         int particlesPerPlanet,
                          bool paused) {
     const Rectangle panel = {1000.0f, 22.0f, 568.0f, 310.0f};
     DrawRectangleRounded(panel, 0.04f, 10, Fade(Color{6, 10, 20, 255}, 0.84f));
@@ -924,16 +1063,17 @@ void DrawComparisonPanel(const std::array<PlanetState, 4>& planets,
 
     DrawText("Planet Magnetosphere Compare", 1024, 38, 32, Color{232, 239, 248, 255});
     DrawText("Dense 3D toy visualization of how solar wind pressure meets planetary shielding.", 1024, 72, 18, Color{164, 186, 222, 255});
-    DrawText("Mouse orbit | wheel zoom | 1..4 select | [ ] wind speed | - / + density | I/K IMF tilt | P pause | R reset",
+    DrawText("Mouse orbit | wheel zoom | 1..4 select | [ ] wind speed | - / + density | I/K IMF tilt | N particles | P pause | R reset",
              1024,
              98,
              16,
              Color{138, 214, 255, 255});
 
-    DrawText(TextFormat("wind %.2fx   density %.2fx   IMF %+0.0f deg%s",
+    DrawText(TextFormat("wind %.2fx   density %.2fx   IMF %+0.0f deg   %d ions/planet%s",
                         windSpeed,
                         windDensity,
                         imfTiltDeg,
+                        particlesPerPlanet,
                         paused ? "   [PAUSED]" : ""),
              1024,
              126,
@@ -967,6 +1107,20 @@ void DrawComparisonPanel(const std::array<PlanetState, 4>& planets,
              388,
              19,
              Color{255, 218, 148, 255});
+
+    const astro_fieldlines::FieldLineSet& lines = fieldLines[selectedPlanet].cache.lines();
+    int closed = 0;
+    for (unsigned char c : lines.closed) closed += c;
+    DrawText(TextFormat("traced field lines %d (%d closed, %d open)   re-traces %d%s",
+                        lines.lineCount(),
+                        closed,
+                        lines.lineCount() - closed,
+                        fieldLines[selectedPlanet].retraces,
+                        fieldLines[selectedPlanet].cache.Busy() ? "   [TRACING]" : ""),
+             1042,
+             414,
+             17,
+             Color{150, 214, 255, 255});
 }
 
 void DrawScreenEffects() {
@@ -981,11 +1135,51 @@ void DrawScreenEffects() {
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // Sweeps the wind so every planet re-traces regularly; traces run inline here so the
+        // cost is counted in the step.
+        std::array<PlanetState, 4> planets = MakePlanets();
+        std::array<PlanetFieldLines, 4> fieldLines;
+        UpdatePlanetDerivedState(&planets, 1.0f, 1.0f, 8.0f, 0.0f);
+        const int perPlanet = std::max(1, astro_bench::IntArg(argc, argv, "particles", kParticleCounts[kDefaultParticleCount]));
+        std::array<WindBatch, 4> winds;
+        MakeWindParticles(&winds, planets, perPlanet, 1.0f);
+        float time = 0.0f;
+        return astro_bench::RunBench(
+            "planet_magnetosphere_compare_viz", bench,
+            [&](float dt) {
+                time += dt;
+                const float windSpeed = 1.0f + 0.6f * std::sin(time * 0.7f);
+                const float imfTiltDeg = 8.0f + 20.0f * std::sin(time * 0.3f);
+                UpdatePlanetDerivedState(&planets, windSpeed, 1.0f, imfTiltDeg, time);
+                for (std::size_t i = 0; i < planets.size(); ++i) {
+                    if (fieldLines[i].retraces == 0 || FieldKeyChanged(fieldLines[i].traced, MakeFieldKey(planets[i], imfTiltDeg))) {
+                        RequestPlanetFieldLines(&fieldLines[i], planets[i], imfTiltDeg, false);
+                    }
+                }
+                UpdateWindParticles(&winds, planets, dt, windSpeed, imfTiltDeg);
+            },
+            [&]() {
+                float sum = 0.0f;
+                for (const PlanetFieldLines& lines : fieldLines) {
+                    sum += static_cast<float>(lines.cache.lines().vertexCount());
+                    for (float v : lines.cache.lines().xyz) sum += v;
+                }
+                for (const WindBatch& wind : winds) {
+                    for (size_t i = 0; i < wind.batch.size(); ++i) sum += wind.batch.x[i] + wind.batch.y[i] + wind.batch.z[i];
+                }
+                return sum;
+            });
+    }
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
     InitWindow(kScreenWidth, kScreenHeight, "Planet Magnetosphere Compare - C++ (raylib)");
     SetWindowMinSize(1180, 740);
     SetTargetFPS(120);
+    astro_render::DynamicResolution dynres;
+    dynres.Init(GetScreenWidth(), GetScreenHeight(), astro_render::DynamicResolutionOptions::FromArgs(argc, argv));
 
     Camera3D camera{};
     camera.position = {29.0f, 13.0f, 24.0f};
@@ -1003,13 +1197,38 @@ int main() {
 
     std::array<PlanetState, 4> planets = MakePlanets();
     UpdatePlanetDerivedState(&planets, windSpeed, windDensity, imfTiltDeg, 0.0f);
-    std::vector<BackdropStar> stars = MakeBackdropStars();
+    astro_render::StarfieldLayer starfield;
+    starfield.Init(astro_render::StarfieldSpace::kWorldBillboard, MakeBackdropStars());
     std::vector<DustMote> dust = MakeDustCloud();
-    std::vector<WindParticle> particles = MakeWindParticles(planets);
+    int particleCountIndex = kDefaultParticleCount;
+    std::array<WindBatch, 4> winds;
+    MakeWindParticles(&winds, planets, kParticleCounts[particleCountIndex], windSpeed);
+    astro_render::InstancedParticleRenderer windRenderer;
+    windRenderer.Init(astro_render::InstanceShape::kScreenPoint, 4 * kParticleCounts[kParticleCountPresets - 1]);
+    std::array<PlanetFieldLines, 4> fieldLines;
+    for (std::size_t i = 0; i < planets.size(); ++i) RequestPlanetFieldLines(&fieldLines[i], planets[i], imfTiltDeg, false);
+
+    // Per-frame update stages: the planets' derived state feeds the field-line refresh and
+    // the four wind batches, which are independent and run in parallel.
+    float time = 0.0f;
+    float windDt = 0.0f;
+    astro_parallel::TaskGraph updates;
+    const astro_parallel::TaskGraph::TaskId planetTask = updates.Add(
+        "planets", [&]() { UpdatePlanetDerivedState(&planets, windSpeed, windDensity, imfTiltDeg, time); });
+    updates.Add("lines", [&]() { RefreshFieldLines(&fieldLines, planets, imfTiltDeg); }, {planetTask});
+    for (int p = 0; p < static_cast<int>(planets.size()); ++p) {
+        updates.Add(
+            TextFormat("wind%d", p + 1),
+            [&, p]() {
+                if (windDt > 0.0f) UpdatePlanetWind(&winds[p], planets[p], p, windDt, windSpeed, imfTiltDeg);
+            },
+            {planetTask});
+    }
+    char timings[256] = "";
 
     while (!WindowShouldClose()) {
         const float dt = std::max(1.0e-4f, GetFrameTime());
-        const float time = static_cast<float>(GetTime());
+        time = static_cast<float>(GetTime());
 
         if (IsKeyPressed(KEY_ONE)) selectedPlanet = 0;
         if (IsKeyPressed(KEY_TWO)) selectedPlanet = 1;
@@ -1023,7 +1242,11 @@ int main() {
             imfTiltDeg = 8.0f;
             paused = false;
             UpdatePlanetDerivedState(&planets, windSpeed, windDensity, imfTiltDeg, time);
-            particles = MakeWindParticles(planets);
+            MakeWindParticles(&winds, planets, kParticleCounts[particleCountIndex], windSpeed);
+        }
+        if (IsKeyPressed(KEY_N)) {
+            particleCountIndex = (particleCountIndex + 1) % kParticleCountPresets;
+            MakeWindParticles(&winds, planets, kParticleCounts[particleCountIndex], windSpeed);
         }
 
         if (IsKeyDown(KEY_RIGHT_BRACKET)) windSpeed = std::min(2.4f, windSpeed + 0.55f * dt);
@@ -1034,17 +1257,17 @@ int main() {
         if (IsKeyDown(KEY_K)) imfTiltDeg = std::max(-45.0f, imfTiltDeg - 28.0f * dt);
 
         UpdateOrbitCameraDragOnly(&camera, &orbit);
-        UpdatePlanetDerivedState(&planets, windSpeed, windDensity, imfTiltDeg, time);
-        if (!paused) {
-            UpdateWindParticles(&particles, planets, dt, time, windSpeed, imfTiltDeg);
-        }
+        windDt = paused ? 0.0f : std::min(dt, 1.0f / 30.0f);
+        updates.Run();
+        updates.FormatTimings(timings, sizeof(timings));
 
         BeginDrawing();
+        dynres.BeginScene();
         ClearBackground(Color{3, 5, 12, 255});
         DrawScreenEffects();
 
         BeginMode3D(camera);
-        DrawBackground(stars, dust, time);
+        DrawBackground(&starfield, dust, time);
         DrawSun(time);
 
         for (int i = 0; i < static_cast<int>(planets.size()); ++i) {
@@ -1053,27 +1276,38 @@ int main() {
             DrawSolarWindStreamlines(planets[i], time, imfTiltDeg, selected);
             DrawBowShock(planets[i], time, selected);
             DrawMagnetopauseShell(planets[i], selected);
-            DrawDipoleFieldLines(planets[i], time, imfTiltDeg, selected);
+            DrawTracedFieldLines(planets[i], fieldLines[i].cache.lines(), selected);
             DrawTailRibbon(planets[i], time, 0.7f, planets[i].preset.displayRadius * 1.6f, planets[i].preset.fieldColor, selected ? 0.10f : 0.05f);
             DrawTailRibbon(planets[i], time, 2.2f, planets[i].preset.displayRadius * 1.1f, planets[i].preset.auroraColor, selected ? 0.11f : 0.06f);
             DrawPlanetBody(planets[i], time, selected);
         }
 
-        DrawParticles(particles, planets, selectedPlanet);
+        DrawParticles(winds, planets, selectedPlanet, &windRenderer);
         EndMode3D();
+        dynres.EndScene();
 
         DrawPanelLabels(planets, camera, selectedPlanet);
-        DrawComparisonPanel(planets, selectedPlanet, windSpeed, windDensity, imfTiltDeg, paused);
+        DrawComparisonPanel(planets, fieldLines, selectedPlanet, windSpeed, windDensity, imfTiltDeg, kParticleCounts[particleCountIndex], paused);
         DrawText("Planetary magnetic shielding under a shared stellar wind", 28, 28, 34, Color{236, 242, 250, 255});
         DrawText("More cinematic than literal: the scene exaggerates structure so the magnetospheres read clearly in motion.",
                  28,
                  64,
                  18,
                  Color{170, 190, 222, 255});
+        DrawText(timings, 28, GetScreenHeight() - 60, 16, Color{150, 170, 204, 255});
         DrawFPS(28, GetScreenHeight() - 36);
+        char renderStatus[96];
+        dynres.FormatStatus(renderStatus, sizeof(renderStatus));
+        DrawText(renderStatus, 120, GetScreenHeight() - 34, 16, Color{150, 170, 204, 255});
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    windRenderer.Unload();
+    starfield.Unload();
+    dynres.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,31 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/photon_timing.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <deque>
+#include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kPi = 3.14159265358979323846f;
 
+constexpr float kDefaultSpinHz = 2.8f;
+constexpr double kSpinDown = -4.0e-3;     // Hz/s, exaggerated so a few seconds of data show it
+constexpr float kDefaultTiltDeg = 72.0f;  // the beam grazes the observer's line of sight
+constexpr float kDefaultBeamWidthDeg = 8.0f;
+constexpr int kShapeSamples = 1024;
+constexpr size_t kRingCapacity = size_t{1} << 22;  // about 0.4 s of events at the default rate
+constexpr float kDefaultPhotonRate = 1.0e7f;
+constexpr float kMaxPhotonRate = 4.0e7f;
+
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 d = GetMouseDelta();
@@ -33,9 +48,98 @@ void BuildOrthoBasis(Vector3 axis, Vector3* u, Vector3* v) {
     *u = Vector3Normalize(Vector3CrossProduct(axis, ref));
     *v = Vector3Normalize(Vector3CrossProduct(axis, *u));
 }
+
+Vector3 ObserverDirection() { return Vector3Normalize({1.0f, 0.1f, 0.0f}); }
+
+Vector3 MagneticAxis(float phase, float tilt) {
+    return Vector3Normalize({std::sin(tilt) * std::cos(phase), std::cos(tilt), std::sin(tilt) * std::sin(phase)});
+}
+
+float BeamIntensity(Vector3 magnetic, float sigma) {
+    const Vector3 observerDir = ObserverDirection();
+    const float a1 = std::acos(std::clamp(Vector3DotProduct(magnetic, observerDir), -1.0f, 1.0f));
+    const float a2 = std::acos(std::clamp(Vector3DotProduct(Vector3Negate(magnetic), observerDir), -1.0f, 1.0f));
+    const float intensity = std::exp(-(a1 * a1) / (2.0f * sigma * sigma)) + std::exp(-(a2 * a2) / (2.0f * sigma * sigma));
+    return std::min(1.0f, intensity);
+}
+
+// One turn of the observed pulse, which drives the simulated photon rate.
+std::vector<float> BeamShape(float tiltDeg, float beamWidthDeg) {
+    std::vector<float> shape(kShapeSamples);
+    for (int i = 0; i < kShapeSamples; ++i) {
+        const float phase = 2.0f * kPi * static_cast<float>(i) / kShapeSamples;
+        shape[static_cast<size_t>(i)] = BeamIntensity(MagneticAxis(phase, tiltDeg * DEG2RAD), beamWidthDeg * DEG2RAD);
+    }
+    return shape;
+}
+
+void DrawFoldedProfile(const astro_photon::SearchSnapshot& s, int x, int y, int w, int h) {
+    DrawText("Folded photons", x, y - 22, 18, Color{220, 230, 244, 255});
+    DrawRectangleLines(x, y, w, h, Fade(Color{120, 150, 190, 255}, 0.5f));
+    if (!s.locked) {
+        DrawText(s.searches > 0 ? "no pulsation found" : "collecting...", x + 12, y + h / 2 - 9, 18, Color{150, 164, 186, 255});
+        return;
+    }
+    const float barW = static_cast<float>(w) / astro_photon::kProfileBins;
+    float floor = 1.0f;
+    for (float p : s.profile) floor = std::min(floor, p);
+    for (int b = 0; b < astro_photon::kProfileBins; ++b) {
+        const float level = floor < 1.0f ? (s.profile[static_cast<size_t>(b)] - floor) / (1.0f - floor) : 0.0f;
+        const float bh = std::max(1.0f, level * (h - 6));
+        DrawRectangleRec({x + b * barW + 1.0f, y + h - bh, barW - 1.0f, bh}, Color{255, 196, 120, 230});
+    }
+}
+
+void DrawPeriodogram(const astro_photon::SearchSnapshot& s, const astro_photon::SearchOptions& options, double trueHz, int x, int y,
+                     int w, int h) {
+    const double maxHz = options.maxFrequency;
+    DrawText(TextFormat("FFT power, %d harmonics", options.harmonics), x, y - 22, 18, Color{220, 230, 244, 255});
+    DrawRectangleLines(x, y, w, h, Fade(Color{120, 150, 190, 255}, 0.5f));
+    const int trueX = x + static_cast<int>(trueHz / maxHz * w);
+    DrawLine(trueX, y, trueX, y + h, Fade(Color{170, 255, 190, 255}, 0.45f));
+    for (int i = 1; i < astro_photon::kSpectrumPoints; ++i) {
+        const float x0 = x + static_cast<float>(i - 1) * w / astro_photon::kSpectrumPoints;
+        const float x1 = x + static_cast<float>(i) * w / astro_photon::kSpectrumPoints;
+        DrawLineV({x0, y + h - s.spectrum[static_cast<size_t>(i - 1)] * (h - 4)}, {x1, y + h - s.spectrum[static_cast<size_t>(i)] * (h - 4)},
+                  Color{126, 224, 255, 255});
+    }
+    DrawText(TextFormat("0 - %.0f Hz", maxHz), x + w - 78, y + h + 4, 14, Color{150, 164, 186, 255});
+}
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const double photonRate = std::clamp(astro_bench::FloatArg(argc, argv, "--rate", kDefaultPhotonRate), 1.0e3f, kMaxPhotonRate);
+    astro_photon::SourceOptions sourceOptions;
+    sourceOptions.meanRate = photonRate;
+    const astro_photon::SearchOptions searchOptions;
+    const astro_photon::SpinModel initialSpin{0.0, 0.0, kDefaultSpinHz, kSpinDown};
+
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // One bench step is a frame of photons generated, binned and folded; a search
+        // runs for every second of data once four seconds are in.
+        astro_photon::PhotonSource source(sourceOptions);
+        astro_photon::PeriodSearch search(searchOptions);
+        source.SetModel(initialSpin);
+        source.SetShape(BeamShape(kDefaultTiltDeg, kDefaultBeamWidthDeg));
+        std::vector<double> events;
+        double simTime = 0.0;
+        return astro_bench::RunBench(
+            "pulsar_beam_timing_viz", bench,
+            [&](float dt) {
+                simTime += dt;
+                events.clear();
+                source.Generate(simTime, &events);
+                search.Consume(events.data(), events.size());
+                if (search.Due()) search.Search();
+            },
+            [&]() {
+                search.Publish();
+                const astro_photon::SearchSnapshot s = search.snapshot();
+                return s.FrequencyAt(simTime) + s.fdot;
+            });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Pulsar Beam Sweep + Timing 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -49,45 +153,59 @@ int main() {
     float camPitch = 0.35f;
     float camDistance = 18.0f;
 
-    float spinHz = 2.8f;
-    float tiltDeg = 28.0f;
-    float beamWidthDeg = 8.0f;
+    float tiltDeg = kDefaultTiltDeg;
+    float beamWidthDeg = kDefaultBeamWidthDeg;
     bool paused = false;
-    float phase = 0.0f;
     std::deque<float> pulseHistory(360, 0.0f);
 
+    // The 3D beam and the photon stream share one ephemeris, clocked by simTime.
+    double simTime = 0.0;
+    astro_photon::SpinModel spin = initialSpin;
+    astro_photon::SpscRing<double> photonRing(kRingCapacity);
+    astro_photon::PhotonSource source(sourceOptions);
+    astro_photon::PeriodSearch search(searchOptions);
+    source.SetModel(spin);
+    source.SetShape(BeamShape(tiltDeg, beamWidthDeg));
+    source.Start(&photonRing);
+    search.Start(&photonRing);
+
     while (!WindowShouldClose()) {
+        const float shapeTilt = tiltDeg;
+        const float shapeWidth = beamWidthDeg;
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
-            spinHz = 2.8f;
-            tiltDeg = 28.0f;
-            beamWidthDeg = 8.0f;
+            tiltDeg = kDefaultTiltDeg;
+            beamWidthDeg = kDefaultBeamWidthDeg;
             paused = false;
-            phase = 0.0f;
+            spin = {simTime, 0.0, kDefaultSpinHz, kSpinDown};
+            source.SetModel(spin);
+            search.RequestReset();
             pulseHistory.assign(360, 0.0f);
         }
-        if (IsKeyDown(KEY_EQUAL)) spinHz = std::min(18.0f, spinHz + 4.0f * GetFrameTime());
-        if (IsKeyDown(KEY_MINUS)) spinHz = std::max(0.2f, spinHz - 4.0f * GetFrameTime());
+        const double spinHz = spin.Frequency(simTime);
+        if (IsKeyDown(KEY_EQUAL) || IsKeyDown(KEY_MINUS) || spinHz < 0.2) {
+            const double rate = (IsKeyDown(KEY_EQUAL) ? 4.0 : 0.0) - (IsKeyDown(KEY_MINUS) ? 4.0 : 0.0);
+            spin = spin.Reanchored(simTime, std::clamp(spinHz + rate * GetFrameTime(), 0.2, 18.0), kSpinDown);
+            source.SetModel(spin);
+        }
         if (IsKeyDown(KEY_RIGHT_BRACKET)) tiltDeg = std::min(80.0f, tiltDeg + 35.0f * GetFrameTime());
         if (IsKeyDown(KEY_LEFT_BRACKET)) tiltDeg = std::max(2.0f, tiltDeg - 35.0f * GetFrameTime());
         if (IsKeyDown(KEY_PERIOD)) beamWidthDeg = std::min(28.0f, beamWidthDeg + 22.0f * GetFrameTime());
         if (IsKeyDown(KEY_COMMA)) beamWidthDeg = std::max(2.0f, beamWidthDeg - 22.0f * GetFrameTime());
+        if (tiltDeg != shapeTilt || beamWidthDeg != shapeWidth) source.SetShape(BeamShape(tiltDeg, beamWidthDeg));
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
-        if (!paused) phase += GetFrameTime() * spinHz * 2.0f * kPi;
+        if (!paused) simTime += GetFrameTime();
+        source.AdvanceTo(simTime);
+        const astro_photon::SearchSnapshot timing = search.snapshot();
 
-        float tilt = tiltDeg * DEG2RAD;
-        Vector3 spinAxis = {0.0f, 1.0f, 0.0f};
-        Vector3 magnetic = Vector3Normalize({std::sin(tilt) * std::cos(phase), std::cos(tilt), std::sin(tilt) * std::sin(phase)});
+        const double turns = spin.Phase(simTime);
+        const float phase = static_cast<float>(2.0 * kPi * (turns - std::floor(turns)));
+        Vector3 magnetic = MagneticAxis(phase, tiltDeg * DEG2RAD);
         Vector3 antiMagnetic = Vector3Negate(magnetic);
-        Vector3 observerDir = Vector3Normalize({1.0f, 0.1f, 0.0f});
-
-        float sigma = beamWidthDeg * DEG2RAD;
-        float a1 = std::acos(std::clamp(Vector3DotProduct(magnetic, observerDir), -1.0f, 1.0f));
-        float a2 = std::acos(std::clamp(Vector3DotProduct(antiMagnetic, observerDir), -1.0f, 1.0f));
-        float intensity = std::exp(-(a1 * a1) / (2.0f * sigma * sigma)) + std::exp(-(a2 * a2) / (2.0f * sigma * sigma));
-        intensity = std::min(1.0f, intensity);
+        Vector3 observerDir = ObserverDirection();
+        float intensity = BeamIntensity(magnetic, beamWidthDeg * DEG2RAD);
         pulseHistory.push_back(intensity);
         if (pulseHistory.size() > 360) pulseHistory.pop_front();
 
@@ -135,18 +253,38 @@ int main() {
             DrawLine(x0, y0, x1, y1, Color{130, 240, 186, 255});
         }
 
+        DrawRectangle(20, 516, 832, 236, Fade(Color{18, 26, 42, 255}, 0.92f));
+        DrawFoldedProfile(timing, 40, 566, 380, 150);
+        DrawPeriodogram(timing, searchOptions, spin.Frequency(simTime), 452, 566, 380, 150);
+
         DrawText("Pulsar Beam Sweep + Observer Timing", 20, 18, 30, Color{232, 238, 248, 255});
         DrawText("Mouse orbit | wheel zoom | +/- spin Hz | [ ] tilt | , . beam width | P pause | R reset",
                  20, 54, 18, Color{164, 183, 210, 255});
         char status[220];
-        std::snprintf(status, sizeof(status), "spin=%.2f Hz  tilt=%.1f deg  beam=%.1f deg  pulse=%.3f%s",
-                      spinHz, tiltDeg, beamWidthDeg, intensity, paused ? " [PAUSED]" : "");
+        std::snprintf(status, sizeof(status), "spin=%.4f Hz  fdot=%.1e Hz/s  tilt=%.1f deg  beam=%.1f deg  pulse=%.3f%s",
+                      spin.Frequency(simTime), spin.fdot, tiltDeg, beamWidthDeg, intensity, paused ? " [PAUSED]" : "");
         DrawText(status, 20, 84, 20, Color{126, 224, 255, 255});
-        DrawFPS(20, 112);
+        std::snprintf(status, sizeof(status), "photons %.2f M/s  dropped %llu  skipped %.2f s",
+                      timing.eventsPerSecond * 1.0e-6, static_cast<unsigned long long>(source.dropped()), source.skipped());
+        DrawText(status, 20, 112, 18, Color{164, 183, 210, 255});
+        if (timing.locked) {
+            std::snprintf(status, sizeof(status), "search: f=%.4f Hz  fdot=%.1e Hz/s  Z2_%d=%.3g  %.1f s window, %d trials, %.1f ms",
+                          timing.FrequencyAt(simTime), timing.fdot, searchOptions.harmonics, timing.z2, timing.span, timing.trials, timing.searchMs);
+        } else {
+            std::snprintf(status, sizeof(status), "search: %.1f s of photons needed before the first period search",
+                          searchOptions.minSpan);
+        }
+        DrawText(status, 20, 136, 18, timing.locked ? Color{255, 210, 150, 255} : Color{164, 183, 210, 255});
+        DrawFPS(20, 162);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    source.Stop();
+    search.Stop();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
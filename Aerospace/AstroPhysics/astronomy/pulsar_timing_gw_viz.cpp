@@ -1,14 +1,22 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
+#include "../common/pulsar_timing.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
-#include <deque>
+#include <vector>
 
 namespace {
 constexpr int kW = 1280;
 constexpr int kH = 820;
+constexpr float kSkyRadius = 5.0f;
+constexpr int kPlotEpochs = 420;
+constexpr float kDefaultEpochRate = 12.0f;  // epochs per second of wall time
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dist) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -22,10 +30,107 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
     float cp = std::cos(*pitch);
     c->position = Vector3Add(c->target, {*dist * cp * std::cos(*yaw), *dist * std::sin(*pitch), *dist * cp * std::sin(*yaw)});
 }
+
+Vector3 SkyPosition(const astro_pta::Pulsar& p) {
+    return {p.x * kSkyRadius, p.y * kSkyRadius, p.z * kSkyRadius};
+}
+
+// Blue for early arrivals, orange for late, brighter with |residual| / scale.
+Color ResidualColor(float residual, float scale) {
+    const float t = std::clamp(residual / std::max(1.0f, scale), -1.0f, 1.0f);
+    if (t < 0.0f) return ColorLerp(Color{150, 170, 200, 255}, Color{90, 170, 255, 255}, -t);
+    return ColorLerp(Color{150, 170, 200, 255}, Color{255, 170, 90, 255}, t);
 }
 
-int main() {
-    InitWindow(kW, kH, "Pulsar Timing + Gravitational Waves 3D - C++ (raylib)");
+void DrawResidualPanel(const astro_pta::TimingArray& pta, int selected) {
+    const int x0 = 820, y0 = 540, w = 430, h = 250;
+    DrawRectangle(x0, y0, w, h, Fade(Color{20, 28, 44, 255}, 0.9f));
+    char s[160];
+    const astro_pta::Pulsar& p = pta.pulsar(selected);
+    std::snprintf(s, sizeof(s), "Timing Residuals - PSR %d (white %.0f ns)", selected, p.whiteNs);
+    DrawText(s, x0 + 16, y0 + 12, 18, Color{220, 230, 244, 255});
+
+    const int n = std::min(kPlotEpochs, pta.samples());
+    float peak = 1.0f;
+    for (int k = 0; k < n; ++k) peak = std::max(peak, std::fabs(pta.Residual(selected, k)));
+    const float mid = static_cast<float>(y0 + 140);
+    const float scale = 95.0f / peak;
+    DrawLine(x0 + 8, static_cast<int>(mid), x0 + w - 8, static_cast<int>(mid), Fade(Color{140, 160, 190, 255}, 0.35f));
+    for (int k = 1; k < n; ++k) {
+        const int xa = x0 + 8 + (kPlotEpochs - k);
+        const int xb = x0 + 8 + (kPlotEpochs - k + 1);
+        DrawLine(xa, static_cast<int>(mid - pta.Residual(selected, k) * scale), xb, static_cast<int>(mid - pta.Residual(selected, k - 1) * scale),
+                 Color{120, 240, 180, 255});
+    }
+    std::snprintf(s, sizeof(s), "+-%.0f ns   last %.1f yr", peak, n * pta.options().cadenceYears);
+    DrawText(s, x0 + 16, y0 + h - 24, 16, Color{160, 182, 210, 255});
+}
+
+// Binned cross-correlations against separation with the fitted A * HD(zeta) curve.
+void DrawCorrelationPanel(const std::vector<astro_pta::CorrelationBin>& bins, float amplitude, float significance, int pairs) {
+    const int x0 = 820, y0 = 140, w = 430, h = 380;
+    DrawRectangle(x0, y0, w, h, Fade(Color{20, 28, 44, 255}, 0.9f));
+    DrawText("Hellings-Downs Correlation", x0 + 16, y0 + 12, 20, Color{220, 230, 244, 255});
+
+    const float left = static_cast<float>(x0 + 44), right = static_cast<float>(x0 + w - 16);
+    const float top = static_cast<float>(y0 + 52), bottom = static_cast<float>(y0 + h - 56);
+    const float scale = std::max(0.05f, 0.55f * std::fabs(amplitude));
+    auto px = [&](float zeta) { return left + (right - left) * zeta / PI; };
+    auto py = [&](float rho) { return top + (bottom - top) * (0.5f - 0.5f * rho / scale); };
+    DrawRectangleLines(static_cast<int>(left), static_cast<int>(top), static_cast<int>(right - left), static_cast<int>(bottom - top),
+                       Fade(Color{140, 160, 190, 255}, 0.4f));
+    DrawLine(static_cast<int>(left), static_cast<int>(py(0.0f)), static_cast<int>(right), static_cast<int>(py(0.0f)), Fade(Color{140, 160, 190, 255}, 0.35f));
+    for (int deg = 0; deg <= 180; deg += 45) {
+        char label[8];
+        std::snprintf(label, sizeof(label), "%d", deg);
+        DrawText(label, static_cast<int>(px(deg * DEG2RAD)) - 8, static_cast<int>(bottom) + 6, 14, Color{150, 170, 198, 255});
+    }
+
+    Vector2 prev = {px(0.0f), py(amplitude * 0.5f)};
+    for (int i = 1; i <= 90; ++i) {
+        const float zeta = PI * static_cast<float>(i) / 90.0f;
+        const Vector2 cur = {px(zeta), py(amplitude * static_cast<float>(astro_pta::HellingsDowns(zeta)))};
+        DrawLineEx(prev, cur, 2.0f, Color{255, 196, 110, 255});
+        prev = cur;
+    }
+    for (const astro_pta::CorrelationBin& b : bins) {
+        if (b.pairs == 0) continue;
+        const float x = px(b.zeta);
+        DrawLineEx({x, py(b.mean - b.error)}, {x, py(b.mean + b.error)}, 2.0f, Color{120, 220, 255, 255});
+        DrawCircleV({x, py(b.mean)}, 4.0f, Color{150, 235, 255, 255});
+    }
+
+    char s[160];
+    std::snprintf(s, sizeof(s), "A = %.3f   %.1f sigma   %d pairs", amplitude, significance, pairs);
+    DrawText(s, x0 + 16, y0 + h - 30, 18, Color{126, 224, 255, 255});
+}
+}
+
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 1040, 0.0f);
+    astro_pta::ArrayOptions options;
+    options.pulsars = std::clamp(astro_bench::IntArg(argc, argv, "--pulsars", options.pulsars), 2, 2000);
+    options.sources = std::clamp(astro_bench::IntArg(argc, argv, "--sources", options.sources), 1, 1024);
+    astro_pta::TimingArray pta;
+    pta.Configure(options);
+    const int pairs = pta.pulsars() * (pta.pulsars() - 1) / 2;
+    std::vector<astro_pta::CorrelationBin> bins;
+    float amplitude = 0.0f, significance = 0.0f;
+
+    if (bench.enabled) {
+        return astro_bench::RunBench(
+            "pulsar_timing_gw_viz", bench,
+            [&](float) {
+                pta.Step(1);
+                pta.Correlate(&bins, &amplitude, &significance);
+            },
+            [&]() {
+                std::fprintf(stderr, "%d pulsars, %.1f yr: A = %.4f, %.1f sigma\n", pta.pulsars(), pta.years(), amplitude, significance);
+                return static_cast<double>(amplitude);
+            });
+    }
+
+    InitWindow(kW, kH, "Pulsar Timing Array + Gravitational Waves 3D - C++ (raylib)");
     SetTargetFPS(60);
 
     Camera3D cam{};
@@ -36,63 +141,74 @@ int main() {
     cam.projection = CAMERA_PERSPECTIVE;
     float yaw = 0.82f, pitch = 0.34f, dist = 14.0f;
 
-    float omega = 1.5f;
-    float gwAmp = 0.015f;
-    float t = 0.0f;
+    float gwScale = 1.0f;
+    float epochRate = kDefaultEpochRate;
+    float pendingEpochs = 0.0f;
+    int selected = 0;
     bool paused = false;
-    std::deque<float> residuals(420, 0.0f);
+    uint64_t correlatedEpoch = ~0ull;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_R)) { omega = 1.5f; gwAmp = 0.015f; t = 0.0f; residuals.assign(420, 0.0f); paused = false; }
-        if (IsKeyDown(KEY_UP)) gwAmp = std::min(0.08f, gwAmp + 0.03f * GetFrameTime());
-        if (IsKeyDown(KEY_DOWN)) gwAmp = std::max(0.0f, gwAmp - 0.03f * GetFrameTime());
-        if (IsKeyDown(KEY_RIGHT)) omega = std::min(5.0f, omega + 1.2f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT)) omega = std::max(0.4f, omega - 1.2f * GetFrameTime());
+        if (IsKeyPressed(KEY_R)) {
+            gwScale = 1.0f;
+            epochRate = kDefaultEpochRate;
+            pta.Reset();
+            paused = false;
+        }
+        if (IsKeyPressed(KEY_N)) selected = (selected + 1) % pta.pulsars();
+        if (IsKeyPressed(KEY_B)) selected = (selected + pta.pulsars() - 1) % pta.pulsars();
+        if (IsKeyDown(KEY_UP)) gwScale = std::min(4.0f, gwScale + 0.8f * GetFrameTime());
+        if (IsKeyDown(KEY_DOWN)) gwScale = std::max(0.0f, gwScale - 0.8f * GetFrameTime());
+        if (IsKeyDown(KEY_RIGHT)) epochRate = std::min(240.0f, epochRate * (1.0f + 1.5f * GetFrameTime()));
+        if (IsKeyDown(KEY_LEFT)) epochRate = std::max(1.0f, epochRate / (1.0f + 1.5f * GetFrameTime()));
         UpdateOrbitCameraDragOnly(&cam, &yaw, &pitch, &dist);
+        pta.SetGwScale(gwScale);
 
         if (!paused) {
-            t += GetFrameTime();
-            float res = gwAmp * std::sin(2.0f * PI * 0.6f * t) + 0.005f * std::sin(2.0f * PI * 0.11f * t);
-            residuals.push_back(res);
-            if (residuals.size() > 420) residuals.pop_front();
+            pendingEpochs += epochRate * std::min(GetFrameTime(), 0.1f);
+            const int epochs = static_cast<int>(pendingEpochs);
+            pendingEpochs -= static_cast<float>(epochs);
+            pta.Step(epochs);
+        }
+        if (pta.epoch() != correlatedEpoch) {
+            pta.Correlate(&bins, &amplitude, &significance);
+            correlatedEpoch = pta.epoch();
         }
-
-        float phase = omega * t;
-        Vector3 pulsarPos{2.0f * std::cos(phase), 0.2f * std::sin(phase * 0.7f), 2.0f * std::sin(phase)};
-        Vector3 compPos = Vector3Negate(pulsarPos);
-        Vector3 beamDir = Vector3Normalize({std::cos(phase * 7.0f), 0.2f, std::sin(phase * 7.0f)});
 
         BeginDrawing();
         ClearBackground(Color{6, 9, 17, 255});
         BeginMode3D(cam);
-        DrawGrid(16, 0.8f);
-        DrawSphere(pulsarPos, 0.34f, Color{150, 220, 255, 255});
-        DrawSphere(compPos, 0.24f, Color{255, 180, 130, 255});
-        DrawLine3D(pulsarPos, compPos, Fade(SKYBLUE, 0.35f));
-        DrawLine3D(pulsarPos, Vector3Add(pulsarPos, Vector3Scale(beamDir, 6.0f)), Fade(Color{120, 255, 180, 255}, 0.7f));
-        DrawLine3D(pulsarPos, Vector3Add(pulsarPos, Vector3Scale(beamDir, -6.0f)), Fade(Color{120, 255, 180, 255}, 0.7f));
+        DrawSphere({0, 0, 0}, 0.30f, Color{90, 150, 255, 255});
+        DrawSphereWires({0, 0, 0}, kSkyRadius, 12, 18, Fade(Color{70, 90, 130, 255}, 0.18f));
+        const float colorScale = 2.0f * options.gwRmsNs * std::max(0.25f, gwScale);
+        for (int a = 0; a < pta.pulsars(); ++a) {
+            const Vector3 pos = SkyPosition(pta.pulsar(a));
+            const float radius = a == selected ? 0.16f : 0.07f;
+            DrawSphereEx(pos, radius, 6, 8, ResidualColor(pta.Latest(a), colorScale));
+        }
+        const Vector3 chosen = SkyPosition(pta.pulsar(selected));
+        DrawLine3D({0, 0, 0}, chosen, Fade(Color{120, 255, 180, 255}, 0.7f));
+        DrawSphereWires(chosen, 0.26f, 6, 8, Fade(Color{120, 255, 180, 255}, 0.6f));
         EndMode3D();
 
-        DrawRectangle(820, 520, 430, 230, Fade(Color{20, 28, 44, 255}, 0.9f));
-        DrawText("Timing Residuals", 840, 536, 22, Color{220, 230, 244, 255});
-        for (int i = 1; i < (int)residuals.size(); ++i) {
-            int x0 = 840 + i - 1;
-            int x1 = 840 + i;
-            int y0 = 650 - (int)(residuals[i - 1] * 1700.0f);
-            int y1 = 650 - (int)(residuals[i] * 1700.0f);
-            DrawLine(x0, y0, x1, y1, Color{120, 240, 180, 255});
-        }
+        DrawCorrelationPanel(bins, amplitude, significance, pairs);
+        DrawResidualPanel(pta, selected);
 
-        DrawText("Pulsar Timing + Gravitational Wave Perturbation", 20, 18, 30, Color{232, 238, 248, 255});
-        DrawText("Mouse drag orbit | wheel zoom | Up/Down GW amplitude | Left/Right orbit rate | P pause | R reset", 20, 54, 18, Color{160, 182, 210, 255});
+        DrawText("Pulsar Timing Array + Gravitational Wave Background", 20, 18, 30, Color{232, 238, 248, 255});
+        DrawText("Mouse drag orbit | wheel zoom | Up/Down GW scale | Left/Right epoch rate | N/B pulsar | P pause | R reset", 20, 54, 18,
+                 Color{160, 182, 210, 255});
         char s[220];
-        std::snprintf(s, sizeof(s), "gw_amp=%.4f  omega=%.2f%s", gwAmp, omega, paused ? "  [PAUSED]" : "");
+        std::snprintf(s, sizeof(s), "%d pulsars  gw_scale=%.2f  %.0f epochs/s  t=%.1f yr%s", pta.pulsars(), gwScale, epochRate, pta.years(),
+                      paused ? "  [PAUSED]" : "");
         DrawText(s, 20, 82, 20, Color{126, 224, 255, 255});
         DrawFPS(20, 110);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,8 +1,18 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/chebyshev_ephemeris.h"
+#include "../common/frame_capture.h"
+#include "../common/parker_wind.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+#include "../common/task_graph.h"
+#include "../common/thread_pool.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <random>
 #include <vector>
 
@@ -13,6 +23,12 @@ constexpr int kScreenHeight = 900;
 constexpr float kSystemExtent = 34.0f;
 constexpr int kBackgroundStarCount = 180;
 constexpr int kWindParticleCount = 820;
+constexpr int kGpuTracerCount = 1 << 20;
+constexpr std::array<float, 4> kSheetTilts = {0.0f, 0.26f, 0.52f, 1.05f};
+constexpr int kWindChunk = 128;
+constexpr uint32_t kWindSeed = 9917;
+// Simulated seconds run at this many days from J2000, so Earth laps in about 6.8 s.
+constexpr double kDaysPerSimSecond = 53.5;
 
 struct OrbitCameraState {
     float yaw = 0.72f;
@@ -22,11 +38,9 @@ struct OrbitCameraState {
 
 struct Planet {
     const char* name = "";
+    astro_ephem::Body body = astro_ephem::kBodyEarth;
     float orbitRadius = 0.0f;
-    float orbitOmega = 0.0f;
     float radius = 0.0f;
-    float phase = 0.0f;
-    float incline = 0.0f;
     float magnetosphere = 0.0f;
     bool strongTail = false;
     Color color{};
@@ -34,11 +48,10 @@ struct Planet {
 };
 
 struct WindParticle {
-    Vector3 dir{};
     Vector3 pos{};
-    float speed = 0.0f;
     float size = 0.0f;
     float band = 0.0f;
+    uint32_t respawns = 0;
 };
 
 struct BackdropStar {
@@ -84,23 +97,24 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit) {
 
 std::vector<Planet> MakePlanets() {
     return {
-        {"Mercury", 4.0f, 1.65f, 0.30f, 0.1f, 0.02f, 0.18f, false, Color{208, 198, 186, 255}},
-        {"Venus", 6.1f, 1.20f, 0.42f, 1.3f, -0.03f, 0.26f, false, Color{238, 196, 118, 255}},
-        {"Earth", 8.6f, 0.92f, 0.46f, 2.4f, 0.06f, 0.78f, true, Color{92, 174, 255, 255}},
-        {"Mars", 11.2f, 0.72f, 0.36f, 0.9f, -0.02f, 0.22f, false, Color{242, 112, 78, 255}},
-        {"Jupiter", 17.0f, 0.36f, 1.02f, 2.9f, 0.04f, 1.15f, true, Color{230, 184, 138, 255}},
+        {"Mercury", astro_ephem::kBodyMercury, 4.0f, 0.30f, 0.18f, false, Color{208, 198, 186, 255}},
+        {"Venus", astro_ephem::kBodyVenus, 6.1f, 0.42f, 0.26f, false, Color{238, 196, 118, 255}},
+        {"Earth", astro_ephem::kBodyEarth, 8.6f, 0.46f, 0.78f, true, Color{92, 174, 255, 255}},
+        {"Mars", astro_ephem::kBodyMars, 11.2f, 0.36f, 0.22f, false, Color{242, 112, 78, 255}},
+        {"Jupiter", astro_ephem::kBodyJupiter, 17.0f, 1.02f, 1.15f, true, Color{230, 184, 138, 255}},
     };
 }
 
-void UpdatePlanets(std::vector<Planet>* planets, float time) {
+// Each planet sits in its true heliocentric direction at its scene radius, so the
+// rings stay circles. Ecliptic north is scene up and ecliptic y runs along scene z,
+// which keeps the scene's original sense of rotation.
+void UpdatePlanets(const astro_ephem::ChebyshevEphemeris& ephemeris, std::vector<Planet>* planets, float time) {
+    std::array<astro_ephem::Vec3d, astro_ephem::kBodyCount> au;
+    ephemeris.Positions(astro_ephem::kJ2000 + time * kDaysPerSimSecond, &au);
     for (Planet& planet : *planets) {
-        const float a = planet.phase + time * planet.orbitOmega;
-        Vector3 p = {
-            std::cos(a) * planet.orbitRadius,
-            std::sin(a * 1.6f) * planet.incline,
-            std::sin(a) * planet.orbitRadius,
-        };
-        planet.pos = p;
+        const astro_ephem::Vec3d& p = au[planet.body];
+        const float scale = planet.orbitRadius / static_cast<float>(std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z));
+        planet.pos = {static_cast<float>(p.x) * scale, static_cast<float>(p.z) * scale, static_cast<float>(p.y) * scale};
     }
 }
 
@@ -143,9 +157,7 @@ std::vector<WindParticle> MakeWindParticles() {
         });
         const float radius = RandRange(rng, 0.0f, kSystemExtent) + shell * 1.2f;
         particles.push_back({
-            dir,
             Vector3Scale(dir, std::fmod(radius, kSystemExtent)),
-            RandRange(rng, 4.6f, 9.6f),
             RandRange(rng, 0.028f, 0.072f),
             static_cast<float>(shell),
         });
@@ -154,63 +166,74 @@ std::vector<WindParticle> MakeWindParticles() {
     return particles;
 }
 
-void RespawnWindParticle(WindParticle* particle, std::mt19937* rng) {
-    const float theta = RandRange(*rng, 0.0f, 2.0f * PI);
-    const float elev = RandRange(*rng, -0.42f, 0.42f);
-    particle->dir = Vector3Normalize({
+// Draws from a stream keyed by (particle, respawn count) so chunks can respawn in parallel.
+void RespawnWindParticle(WindParticle* particle, int index) {
+    astro_random::PhiloxStream rng({kWindSeed, 0u}, static_cast<uint32_t>(index), particle->respawns++);
+    const float theta = rng.Uniform(0.0f, 2.0f * PI);
+    const float elev = rng.Uniform(-0.42f, 0.42f);
+    const Vector3 dir = Vector3Normalize({
         std::cos(theta) * std::cos(elev),
         std::sin(elev) * 0.7f,
         std::sin(theta) * std::cos(elev),
     });
-    const float radius = RandRange(*rng, 0.2f, 2.4f) + particle->band * 0.26f;
-    particle->pos = Vector3Scale(particle->dir, radius);
-    particle->speed = RandRange(*rng, 4.6f, 9.6f);
+    const float radius = rng.Uniform(0.2f, 2.4f) + particle->band * 0.26f;
+    particle->pos = Vector3Scale(dir, radius);
 }
 
-void UpdateWindParticles(std::vector<WindParticle>* wind, const std::vector<Planet>& planets, float dt) {
-    static std::mt19937 rng(9917);
+// The magnetosphere as both wind paths see it.
+astro_helio::Obstacle PlanetObstacle(const Planet& planet) {
+    astro_helio::Obstacle obstacle;
+    obstacle.pos = planet.pos;
+    obstacle.shield = 0.72f * (planet.radius + planet.magnetosphere * 1.45f);
+    obstacle.influence = planet.radius + planet.magnetosphere * 2.8f;
+    obstacle.deflection = planet.magnetosphere;
+    obstacle.tailPush = planet.strongTail ? 11.0f : 0.0f;
+    return obstacle;
+}
 
-    for (WindParticle& particle : *wind) {
-        particle.pos = Vector3Add(particle.pos, Vector3Scale(particle.dir, particle.speed * dt));
+void UpdateWindParticle(WindParticle* particleOut, int index, const astro_helio::ParkerWind& parker, const std::vector<Planet>& planets,
+                        float time, float dt) {
+    WindParticle& particle = *particleOut;
+    const Vector3 solarDir = Vector3Normalize(particle.pos);
+    particle.pos = Vector3Add(particle.pos, Vector3Scale(solarDir, astro_helio::Speed(parker, particle.pos, time) * dt));
 
-        bool respawn = Vector3Length(particle.pos) > kSystemExtent;
+    bool respawn = Vector3Length(particle.pos) > kSystemExtent;
 
-        for (const Planet& planet : planets) {
-            const Vector3 rel = Vector3Subtract(particle.pos, planet.pos);
-            const float dist = Vector3Length(rel);
-            const float influence = planet.radius + planet.magnetosphere * 2.8f;
-            const float shield = planet.radius + planet.magnetosphere * 1.45f;
-
-            if (dist < shield * 0.72f) {
-                respawn = true;
-                break;
-            }
-
-            if (dist < influence && dist > 0.0001f) {
-                const Vector3 relDir = Vector3Scale(rel, 1.0f / dist);
-                const Vector3 solarDir = Vector3Normalize(particle.pos);
-                Vector3 tangent = Vector3CrossProduct(relDir, Vector3CrossProduct(solarDir, relDir));
-                if (Vector3Length(tangent) < 1.0e-4f) tangent = {0.0f, 1.0f, 0.0f};
-                tangent = Vector3Normalize(tangent);
-
-                const float strength = (1.0f - dist / influence) * planet.magnetosphere;
-                particle.pos = Vector3Add(particle.pos, Vector3Scale(tangent, strength * dt * 14.0f));
+    for (const Planet& planet : planets) {
+        const astro_helio::Obstacle obstacle = PlanetObstacle(planet);
+        const Vector3 rel = Vector3Subtract(particle.pos, obstacle.pos);
+        const float dist = Vector3Length(rel);
 
-                if (planet.strongTail) {
-                    const Vector3 awayFromSun = Vector3Normalize(planet.pos);
-                    particle.pos = Vector3Add(particle.pos, Vector3Scale(awayFromSun, strength * dt * 11.0f));
-                }
-            }
+        if (dist < obstacle.shield) {
+            respawn = true;
+            break;
         }
 
-        if (respawn) {
-            RespawnWindParticle(&particle, &rng);
+        if (dist < obstacle.influence && dist > 0.0001f) {
+            const Vector3 relDir = Vector3Scale(rel, 1.0f / dist);
+            Vector3 tangent = Vector3CrossProduct(relDir, Vector3CrossProduct(solarDir, relDir));
+            if (Vector3Length(tangent) < 1.0e-4f) tangent = {0.0f, 1.0f, 0.0f};
+            tangent = Vector3Normalize(tangent);
+
+            const float strength = (1.0f - dist / obstacle.influence) * obstacle.deflection;
+            particle.pos = Vector3Add(particle.pos, Vector3Scale(tangent, strength * dt * 14.0f));
+            particle.pos = Vector3Add(particle.pos, Vector3Scale(Vector3Normalize(obstacle.pos), strength * obstacle.tailPush * dt));
         }
     }
+
+    if (respawn) RespawnWindParticle(&particle, index);
+}
+
+void UpdateWindParticles(std::vector<WindParticle>* wind, const astro_helio::ParkerWind& parker, const std::vector<Planet>& planets,
+                         float time, float dt) {
+    astro_parallel::SharedPool().ParallelFor(static_cast<int>(wind->size()), kWindChunk, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) UpdateWindParticle(&(*wind)[i], i, parker, planets, time, dt);
+    });
 }
 
-Color WindParticleColor(const Vector3& pos, const std::vector<Planet>& planets) {
-    Color c = Color{162, 220, 255, 255};
+// Orange above the current sheet, blue below, tinted near magnetospheres.
+Color WindParticleColor(const Vector3& pos, float polarity, const std::vector<Planet>& planets) {
+    Color c = polarity > 0.0f ? Color{255, 168, 96, 255} : Color{120, 186, 255, 255};
 
     for (const Planet& planet : planets) {
         const float dist = Vector3Distance(pos, planet.pos);
@@ -237,6 +260,23 @@ void DrawOrbitRing(float radius, Color color) {
     }
 }
 
+// The warped current sheet, as spiral arms traced out from evenly spaced source
+// longitudes.
+void DrawCurrentSheet(const astro_helio::ParkerWind& parker, float time) {
+    constexpr int kArms = 24;
+    constexpr int kSegments = 64;
+    for (int arm = 0; arm < kArms; ++arm) {
+        const float source = 2.0f * PI * static_cast<float>(arm) / kArms;
+        Vector3 prev = astro_helio::SheetPoint(parker, source, parker.sourceRadius, time);
+        for (int i = 1; i <= kSegments; ++i) {
+            const float r = parker.sourceRadius + (parker.extent - parker.sourceRadius) * static_cast<float>(i) / kSegments;
+            const Vector3 next = astro_helio::SheetPoint(parker, source, r, time);
+            DrawLine3D(prev, next, Fade(Color{236, 214, 255, 255}, 0.16f * (1.0f - 0.7f * r / parker.extent)));
+            prev = next;
+        }
+    }
+}
+
 void DrawPlanetInteraction(const Planet& planet, float time) {
     const float tailLen = planet.strongTail ? 4.8f : 2.1f;
     const Vector3 awayFromSun = Vector3Normalize(planet.pos);
@@ -273,7 +313,10 @@ void DrawBackdropStars(const std::vector<BackdropStar>& stars) {
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    astro_ephem::ChebyshevEphemeris ephemeris;
+    astro_ephem::OpenPlanetEphemeris(argc, argv, &ephemeris);
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
     InitWindow(kScreenWidth, kScreenHeight, "Solar System Solar Wind 3D - C++ (raylib)");
     SetWindowMinSize(1024, 660);
@@ -290,26 +333,68 @@ int main() {
     std::vector<Planet> planets = MakePlanets();
     const std::vector<BackdropStar> backdrop = MakeBackdropStars();
     std::vector<WindParticle> wind = MakeWindParticles();
+    astro_helio::ParkerWind parker;
+    parker.extent = kSystemExtent;
+    size_t tiltIndex = 1;
     float simSpeed = 1.0f;
     float simTime = 0.0f;
     bool paused = false;
 
+    // A million tracers advected on the GPU when float render targets are available;
+    // the CPU particles stay as the fallback and run the same wind model.
+    astro_helio::GpuParkerTracers gpuWind;
+    const bool gpuWindReady = gpuWind.Init(kGpuTracerCount, parker, kWindSeed);
+    bool useGpuWind = gpuWindReady;
+    std::vector<astro_helio::Obstacle> obstacles;
+
+    // The wind reads the planet positions for this frame, so it runs after them; its
+    // particles are split across threads inside the task.
+    float dt = 0.0f;
+    astro_parallel::TaskGraph updates;
+    const astro_parallel::TaskGraph::TaskId planetTask = updates.Add("planets", [&]() { UpdatePlanets(ephemeris, &planets, simTime); });
+    updates.Add("wind", [&]() {
+        if (!useGpuWind) UpdateWindParticles(&wind, parker, planets, simTime, dt);
+    }, {planetTask});
+    char timings[128] = "";
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) simSpeed = std::max(0.1f, simSpeed - 0.2f);
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) simSpeed = std::min(6.0f, simSpeed + 0.2f);
+        if (IsKeyPressed(KEY_LEFT_BRACKET) || IsKeyPressed(KEY_RIGHT_BRACKET)) {
+            const float scale = IsKeyPressed(KEY_LEFT_BRACKET) ? 0.8f : 1.25f;
+            parker.slowSpeed = std::clamp(parker.slowSpeed * scale, 1.5f, 18.0f);
+            parker.fastSpeed = parker.slowSpeed * (9.6f / 4.6f);
+        }
+        if (IsKeyPressed(KEY_T)) {
+            tiltIndex = (tiltIndex + 1) % kSheetTilts.size();
+            parker.sheetTilt = kSheetTilts[tiltIndex];
+        }
+        if (IsKeyPressed(KEY_G) && gpuWindReady) useGpuWind = !useGpuWind;
         if (IsKeyPressed(KEY_R)) {
             wind = MakeWindParticles();
+            parker = astro_helio::ParkerWind{};
+            parker.extent = kSystemExtent;
+            tiltIndex = 1;
             simSpeed = 1.0f;
             simTime = 0.0f;
             paused = false;
+            if (gpuWindReady) {
+                gpuWind.Unload();
+                useGpuWind = gpuWind.Init(kGpuTracerCount, parker, kWindSeed);
+            }
         }
 
-        const float dt = paused ? 0.0f : GetFrameTime() * simSpeed;
+        dt = paused ? 0.0f : GetFrameTime() * simSpeed;
         simTime += dt;
         UpdateOrbitCameraDragOnly(&camera, &orbit);
-        UpdatePlanets(&planets, simTime);
-        UpdateWindParticles(&wind, planets, dt);
+        updates.Run();
+        updates.FormatTimings(timings, sizeof(timings));
+        if (useGpuWind) {
+            obstacles.clear();
+            for (const Planet& planet : planets) obstacles.push_back(PlanetObstacle(planet));
+            gpuWind.Advect(parker, obstacles.data(), static_cast<int>(obstacles.size()), simTime, dt);
+        }
 
         BeginDrawing();
         ClearBackground(Color{4, 6, 12, 255});
@@ -326,12 +411,18 @@ int main() {
         DrawSphere({0.0f, 0.0f, 0.0f}, 1.28f, Color{255, 236, 164, 255});
         DrawSphereWires({0.0f, 0.0f, 0.0f}, 1.66f, 16, 16, Fade(Color{255, 248, 210, 255}, 0.18f));
 
-        for (const WindParticle& particle : wind) {
-            const Vector3 p = particle.pos;
-            const Color c = WindParticleColor(p, planets);
-            const Vector3 tail = Vector3Subtract(p, Vector3Scale(Vector3Normalize(p), 0.22f + particle.size * 1.8f));
-            DrawLine3D(tail, p, Fade(c, 0.22f));
-            DrawPoint3D(p, Fade(c, 0.92f));
+        DrawCurrentSheet(parker, simTime);
+        if (useGpuWind) {
+            gpuWind.Draw(parker, camera.position, simTime, 0.32f, 0.012f, 0.10f);
+        } else {
+            for (const WindParticle& particle : wind) {
+                const Vector3 p = particle.pos;
+                const Color c = WindParticleColor(p, astro_helio::Polarity(parker, p, simTime), planets);
+                const Vector3 field = astro_helio::FieldDirection(parker, p, simTime);
+                const Vector3 tail = Vector3Subtract(p, Vector3Scale(field, 0.22f + particle.size * 1.8f));
+                DrawLine3D(tail, p, Fade(c, 0.22f));
+                DrawPoint3D(p, Fade(c, 0.92f));
+            }
         }
 
         for (const Planet& planet : planets) {
@@ -342,14 +433,24 @@ int main() {
 
         EndMode3D();
 
-        DrawRectangle(14, 14, 560, 92, Fade(BLACK, 0.28f));
+        DrawRectangle(14, 14, 640, 142, Fade(BLACK, 0.28f));
         DrawText("Solar System + Solar Wind", 26, 24, 30, Color{234, 241, 252, 255});
-        DrawText("The Sun emits pulsed particle bands while planets bend, shield, or trail the flow.", 26, 58, 19, Color{170, 192, 223, 255});
+        DrawText("The rotating Sun winds its wind into a Parker spiral; planets bend, shield, or trail the flow.", 26, 58, 19, Color{170, 192, 223, 255});
         DrawText(TextFormat("Mouse orbit | wheel zoom | - / + speed | P pause | R reset | speed %.1fx%s", simSpeed, paused ? " [PAUSED]" : ""), 26, 82, 18, Color{132, 220, 255, 255});
+        DrawText(TextFormat("[ ] wind %.1f-%.1f | T sheet tilt %.0f deg | G %s: %d tracers", parker.slowSpeed, parker.fastSpeed,
+                            parker.sheetTilt * RAD2DEG, useGpuWind ? "GPU" : (gpuWindReady ? "CPU" : "CPU (no GL 3.3)"),
+                            useGpuWind ? gpuWind.count() : static_cast<int>(wind.size())),
+                 26, 106, 18, Color{132, 220, 255, 255});
+        DrawText("Orange: field outward, above the current sheet | blue: inward, below it", 26, 130, 17, Color{170, 192, 223, 255});
+        DrawText(timings, 26, GetScreenHeight() - 30, 16, Color{150, 170, 204, 255});
         DrawFPS(GetScreenWidth() - 96, 18);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    gpuWind.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
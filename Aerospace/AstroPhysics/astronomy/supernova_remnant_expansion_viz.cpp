@@ -1,20 +1,72 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/philox.h"
+#include "../common/point_cloud.h"
+#include "../common/profiler.h"
+#include "../common/sim_thread.h"
+#include "../common/sph_hydro.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdio>
-#include <deque>
+#include <utility>
 #include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kPi = 3.14159265358979323846f;
+constexpr float kDomainRadius = 10.0f;  // ambient medium filling a sphere this size
+constexpr float kEnergyScale = 25.0f;   // code energy per unit of the E control
+constexpr float kMaxAge = 28.0f;
+constexpr float kSimRate = 30.0f;       // simulation thread ticks per simulated second
+constexpr int kMaxStepsPerTick = 8;     // adaptive SPH steps allowed per tick before the blast slows down
+constexpr float kEjectaRadius = 1.2f;
+constexpr float kEjectaDensity = 8.0f;  // relative to the medium at the origin
+constexpr int kHistory = 360;
+constexpr uint64_t kGasSeed = 0x5EA0F1A5ull;
+constexpr std::array<int, 4> kParticleOptions = {25000, 100000, 250000, 1000000};
+
+struct RemnantParams {
+    float energy = 1.0f;
+    float density = 1.0f;
+    float gradient = 0.35f;
+    bool ejecta = false;  // ejecta-driven remnant instead of a point blast
+    int particleOption = 1;
+};
+
+struct RemnantScene {
+    RemnantParams params;  // of the running blast
+    astro_sph::SphSystem gas;
+    float ambientU = 0.0f;
+    float shockRadius = 0.0f;
+    std::vector<float> shockHistory;
+    std::vector<float> sedovHistory;
+    std::vector<float> radii;  // scratch for the shock percentile
+    int generation = 0;
+};
 
-struct ShellPoint {
-    Vector3 dir;
-    float phase;
+// What the renderer draws, indexed by particle id so every snapshot lists the
+// particles in the same order and can be blended with the one before it.
+struct RemnantView {
+    std::vector<Vector3> pos;
+    std::vector<Color> color;
+    RemnantParams params;
+    float age = 0.0f;
+    float shockRadius = 0.0f;
+    float sedovRadius = 0.0f;
+    std::vector<float> shockHistory;
+    std::vector<float> sedovHistory;
+    uint64_t steps = 0;
+    float dt = 0.0f;
+    float neighbours = 0.0f;
+    size_t cells = 0;
+    float stepMs = 0.0f;
+    int generation = 0;
 };
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
@@ -34,22 +86,203 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     });
 }
 
-std::vector<ShellPoint> BuildShellPoints(int n) {
-    std::vector<ShellPoint> pts;
-    pts.reserve(n);
-    for (int i = 0; i < n; ++i) {
-        float t = (i + 0.5f) / static_cast<float>(n);
-        float y = 1.0f - 2.0f * t;
-        float r = std::sqrt(std::max(0.0f, 1.0f - y * y));
-        float phi = (kPi * (3.0f - std::sqrt(5.0f))) * static_cast<float>(i);
-        Vector3 d = {r * std::cos(phi), y, r * std::sin(phi)};
-        pts.push_back({d, 0.13f * static_cast<float>(i)});
+// Denser medium on +X slows the expansion on that side.
+float AmbientDensity(const RemnantParams& params, float x) {
+    return params.density * std::max(0.25f, 1.0f + params.gradient * x / kDomainRadius);
+}
+
+// Sedov-Taylor radius for a point blast of energy E in a uniform medium (gamma = 5/3).
+float SedovRadius(const RemnantParams& params, float age) {
+    return 1.152f * std::pow(kEnergyScale * params.energy * age * age / params.density, 0.2f);
+}
+
+// The medium is a slightly jittered cubic lattice trimmed to a sphere, with the
+// gradient carried by the particle masses. A point blast puts all of E as heat into the
+// particles within two spacings of the origin; the ejecta-driven remnant replaces the
+// centre with a dense ball expanding homologously with clumpy speeds, which seed
+// Rayleigh-Taylor fingers where the decelerating ejecta meet the swept-up shell.
+std::vector<astro_sph::SphParticle> BuildRemnantGas(const RemnantParams& params, float* ambientU, astro_sph::SphConfig* config) {
+    const int target = kParticleOptions[static_cast<size_t>(params.particleOption)];
+    const float volume = 4.0f / 3.0f * kPi * kDomainRadius * kDomainRadius * kDomainRadius;
+    const float spacing = std::cbrt(volume / static_cast<float>(target));
+    const int side = static_cast<int>(2.0f * kDomainRadius / spacing);
+    const float energy = kEnergyScale * params.energy;
+    *ambientU = 1.0e-6f * energy / (params.density * volume);
+
+    astro_random::PhiloxStream rng(kGasSeed);
+    std::vector<astro_sph::SphParticle> gas;
+    gas.reserve(static_cast<size_t>(target) + static_cast<size_t>(target) / 50);
+    const auto jittered = [&](float x, float y, float z, float step) {
+        return Vector3{x + 0.1f * step * (rng.Uniform() - 0.5f), y + 0.1f * step * (rng.Uniform() - 0.5f),
+                       z + 0.1f * step * (rng.Uniform() - 0.5f)};
+    };
+    const float ejectaR2 = kEjectaRadius * kEjectaRadius;
+    for (int i = 0; i < side; ++i) {
+        for (int j = 0; j < side; ++j) {
+            for (int k = 0; k < side; ++k) {
+                const Vector3 p = jittered(-kDomainRadius + (i + 0.5f) * spacing, -kDomainRadius + (j + 0.5f) * spacing,
+                                           -kDomainRadius + (k + 0.5f) * spacing, spacing);
+                const float r2 = Vector3LengthSqr(p);
+                if (r2 > kDomainRadius * kDomainRadius || (params.ejecta && r2 < ejectaR2)) continue;
+                const float mass = AmbientDensity(params, p.x) * spacing * spacing * spacing;
+                gas.push_back({p, {0.0f, 0.0f, 0.0f}, mass, *ambientU, 0.0f});
+            }
+        }
+    }
+
+    if (params.ejecta) {
+        // Half the spacing at eight times the density keeps the ejecta particles at the
+        // ambient particle mass, which SPH mixes across the contact more cleanly.
+        const float fine = 0.5f * spacing;
+        const float mass = kEjectaDensity * params.density * fine * fine * fine;
+        const int n = static_cast<int>(2.0f * kEjectaRadius / fine) + 1;
+        const size_t first = gas.size();
+        double kinetic = 0.0;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                for (int k = 0; k < n; ++k) {
+                    const Vector3 p = jittered(-kEjectaRadius + (i + 0.5f) * fine, -kEjectaRadius + (j + 0.5f) * fine,
+                                               -kEjectaRadius + (k + 0.5f) * fine, fine);
+                    if (Vector3LengthSqr(p) >= ejectaR2) continue;
+                    const float clump = 1.0f + 0.25f * (rng.Uniform() - 0.5f) + 0.15f * std::sin(5.0f * std::atan2(p.z, p.x)) * std::cos(4.0f * p.y);
+                    const Vector3 v = Vector3Scale(p, clump / kEjectaRadius);
+                    kinetic += 0.5 * mass * Vector3LengthSqr(v);
+                    gas.push_back({p, v, mass, *ambientU, 1.0f});
+                }
+            }
+        }
+        // 95% of E as bulk motion, the rest as heat.
+        const float scale = static_cast<float>(std::sqrt(0.95 * energy / std::max(kinetic, 1.0e-12)));
+        const float heat = 0.05f * energy / (mass * static_cast<float>(std::max<size_t>(1, gas.size() - first)));
+        for (size_t i = first; i < gas.size(); ++i) {
+            gas[i].vel = Vector3Scale(gas[i].vel, scale);
+            gas[i].u = heat;
+        }
+    } else {
+        const float reach2 = 4.0f * spacing * spacing;
+        double heated = 0.0;
+        for (const astro_sph::SphParticle& p : gas) {
+            if (Vector3LengthSqr(p.pos) < reach2) heated += p.mass;
+        }
+        for (astro_sph::SphParticle& p : gas) {
+            if (Vector3LengthSqr(p.pos) < reach2) p.u = static_cast<float>(energy / heated);
+        }
+    }
+
+    config->hMin = 0.05f * spacing;
+    config->hMax = 3.0f * spacing;
+    config->maxDt = 1.0f / kSimRate;
+    return gas;
+}
+
+void DetonateRemnant(RemnantScene* scene, const RemnantParams& params) {
+    scene->params = params;
+    astro_sph::SphConfig config;
+    const std::vector<astro_sph::SphParticle> gas = BuildRemnantGas(params, &scene->ambientU, &config);
+    scene->gas.Reset(config, gas);
+    scene->shockRadius = 0.0f;
+    scene->shockHistory.clear();
+    scene->sedovHistory.clear();
+    ++scene->generation;
+}
+
+// Radius of the shock front: the 98th percentile radius of gas compressed past 1.5x the
+// medium it sits in.
+float MeasureShockRadius(RemnantScene* scene) {
+    const astro_sph::SphSystem& gas = scene->gas;
+    scene->radii.clear();
+    for (size_t i = 0; i < gas.size(); ++i) {
+        const Vector3 p = gas.position(i);
+        if (gas.density(i) > 1.5f * AmbientDensity(scene->params, p.x)) scene->radii.push_back(Vector3Length(p));
+    }
+    if (scene->radii.empty()) return 0.0f;
+    const size_t k = scene->radii.size() * 98 / 100;
+    std::nth_element(scene->radii.begin(), scene->radii.begin() + static_cast<std::ptrdiff_t>(k), scene->radii.end());
+    return scene->radii[k];
+}
+
+void AdvanceRemnant(RemnantScene* scene, float dt) {
+    scene->gas.Advance(dt, kMaxStepsPerTick);
+    scene->shockRadius = MeasureShockRadius(scene);
+    const float age = static_cast<float>(scene->gas.time());
+    // One history sample per kMaxAge / kHistory of age, so the plot spans a whole blast.
+    if (static_cast<float>(scene->shockHistory.size()) * kMaxAge < age * kHistory && scene->shockHistory.size() < kHistory) {
+        scene->shockHistory.push_back(scene->shockRadius);
+        scene->sedovHistory.push_back(SedovRadius(scene->params, age));
+    }
+    if (age > kMaxAge || scene->shockRadius > 0.92f * kDomainRadius) DetonateRemnant(scene, scene->params);
+}
+
+Color GasColor(const RemnantScene& scene, size_t i) {
+    const astro_sph::SphSystem& gas = scene.gas;
+    const Vector3 p = gas.position(i);
+    const float compression = std::clamp(gas.density(i) / AmbientDensity(scene.params, p.x) - 1.0f, 0.0f, 3.0f) / 3.0f;
+    const float heat = std::clamp(std::log10(gas.internalEnergy(i) / scene.ambientU) / 7.0f, 0.0f, 1.0f);
+    Color c = ColorLerp(Color{50, 70, 120, 255}, Color{255, 150, 90, 255}, std::min(1.0f, 2.0f * compression + 0.4f * heat));
+    c = ColorLerp(c, Color{205, 225, 255, 255}, std::max(0.0f, heat - 0.55f) / 0.45f);
+    if (gas.tag(i) > 0.5f) c = ColorLerp(c, Color{120, 255, 190, 255}, 0.6f);
+    c.a = static_cast<unsigned char>(std::clamp(18.0f + 200.0f * std::max(compression, 0.6f * heat) + 60.0f * gas.tag(i), 0.0f, 255.0f));
+    return c;
+}
+
+void PublishRemnant(const RemnantScene& scene, RemnantView& view) {
+    const astro_sph::SphSystem& gas = scene.gas;
+    view.pos.resize(gas.size());
+    view.color.resize(gas.size());
+    for (size_t i = 0; i < gas.size(); ++i) {
+        view.pos[gas.id(i)] = gas.position(i);
+        view.color[gas.id(i)] = GasColor(scene, i);
+    }
+    view.params = scene.params;
+    view.age = static_cast<float>(gas.time());
+    view.shockRadius = scene.shockRadius;
+    view.sedovRadius = SedovRadius(scene.params, view.age);
+    view.shockHistory = scene.shockHistory;
+    view.sedovHistory = scene.sedovHistory;
+    view.steps = gas.steps();
+    view.dt = gas.nextDt();
+    view.neighbours = gas.meanNeighbours();
+    view.cells = gas.cells();
+    view.stepMs = gas.sortMs() + gas.densityMs() + gas.forceMs();
+    view.generation = scene.generation;
+}
+
+void DrawRadiusHistory(const std::vector<float>& history, Color color) {
+    for (int i = 1; i < static_cast<int>(history.size()); ++i) {
+        const float r0 = std::min(kDomainRadius, history[static_cast<size_t>(i - 1)]);
+        const float r1 = std::min(kDomainRadius, history[static_cast<size_t>(i)]);
+        const int y0 = 732 - static_cast<int>((r0 / kDomainRadius) * 166.0f);
+        const int y1 = 732 - static_cast<int>((r1 / kDomainRadius) * 166.0f);
+        DrawLine(900 + i - 1, y0, 900 + i, y1, color);
     }
-    return pts;
 }
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    RemnantParams initial;
+    initial.ejecta = astro_bench::HasFlag(argc, argv, "--ejecta");
+    if (const int particles = astro_bench::IntArg(argc, argv, "--particles", 0); particles > 0) {
+        initial.particleOption = 0;
+        while (initial.particleOption + 1 < static_cast<int>(kParticleOptions.size()) &&
+               kParticleOptions[static_cast<size_t>(initial.particleOption)] < particles) {
+            ++initial.particleOption;
+        }
+    }
+
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 60, 1.0f / kSimRate);
+    if (bench.enabled) {
+        RemnantScene scene;
+        DetonateRemnant(&scene, initial);
+        return astro_bench::RunBench(
+            "supernova_remnant_expansion_viz", bench, [&](float dt) { AdvanceRemnant(&scene, dt); },
+            [&]() {
+                std::fprintf(stderr, "%zu particles, age %.2f, %llu SPH steps, shock R=%.3f (Sedov-Taylor %.3f)\n", scene.gas.size(),
+                             scene.gas.time(), static_cast<unsigned long long>(scene.gas.steps()), scene.shockRadius,
+                             SedovRadius(scene.params, static_cast<float>(scene.gas.time())));
+                return scene.gas.KineticEnergy() + scene.gas.ThermalEnergy() + scene.shockRadius;
+            });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Supernova Remnant Expansion 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -63,50 +296,68 @@ int main() {
     float camPitch = 0.35f;
     float camDistance = 26.0f;
 
-    float energy = 1.0f;
-    float density = 1.0f;
-    float gradient = 0.35f;
+    astro_render::PointCloudBuffer cloud;
+    cloud.Init(static_cast<size_t>(kParticleOptions.back()) * 11 / 10);
+    std::vector<astro_render::CloudPoint> points;
+
+    // The gas steps on its own thread; edits to the controls take effect at the next
+    // detonation, which Space triggers and which also happens once the shock nears the
+    // edge of the medium.
+    RemnantParams pending = initial;
     float timeScale = 1.0f;
     bool paused = false;
-    float age = 0.02f;
-    std::deque<float> shockHistory(360, 0.0f);
-    std::vector<ShellPoint> shell = BuildShellPoints(1300);
+    astro_sim::SimThread<RemnantScene, RemnantView> sim;
+    {
+        RemnantScene scene;
+        DetonateRemnant(&scene, initial);
+        sim.Start(std::move(scene), kSimRate,
+                  [](RemnantScene& state, float dt) {
+                      ASTRO_PROFILE_SCOPE("physics");
+                      AdvanceRemnant(&state, dt);
+                  },
+                  PublishRemnant, 2);
+    }
 
     while (!WindowShouldClose()) {
+        const float frameDt = GetFrameTime();
+        bool detonate = IsKeyPressed(KEY_SPACE);
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
-            energy = 1.0f;
-            density = 1.0f;
-            gradient = 0.35f;
+            pending = RemnantParams{};
+            pending.particleOption = initial.particleOption;
             timeScale = 1.0f;
             paused = false;
-            age = 0.02f;
-            shockHistory.assign(360, 0.0f);
+            detonate = true;
+        }
+        if (IsKeyPressed(KEY_M)) {
+            pending.ejecta = !pending.ejecta;
+            detonate = true;
         }
-        if (IsKeyDown(KEY_UP)) energy = std::min(5.0f, energy + 1.0f * GetFrameTime());
-        if (IsKeyDown(KEY_DOWN)) energy = std::max(0.2f, energy - 1.0f * GetFrameTime());
-        if (IsKeyDown(KEY_RIGHT)) density = std::min(4.0f, density + 1.0f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT)) density = std::max(0.2f, density - 1.0f * GetFrameTime());
-        if (IsKeyDown(KEY_RIGHT_BRACKET)) gradient = std::min(1.0f, gradient + 0.8f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT_BRACKET)) gradient = std::max(0.0f, gradient - 0.8f * GetFrameTime());
-        if (IsKeyDown(KEY_EQUAL)) timeScale = std::min(4.0f, timeScale + 1.2f * GetFrameTime());
-        if (IsKeyDown(KEY_MINUS)) timeScale = std::max(0.2f, timeScale - 1.2f * GetFrameTime());
+        if (IsKeyPressed(KEY_N)) {
+            pending.particleOption = (pending.particleOption + 1) % static_cast<int>(kParticleOptions.size());
+            detonate = true;
+        }
+        if (IsKeyDown(KEY_UP)) pending.energy = std::min(5.0f, pending.energy + 1.0f * frameDt);
+        if (IsKeyDown(KEY_DOWN)) pending.energy = std::max(0.2f, pending.energy - 1.0f * frameDt);
+        if (IsKeyDown(KEY_RIGHT)) pending.density = std::min(4.0f, pending.density + 1.0f * frameDt);
+        if (IsKeyDown(KEY_LEFT)) pending.density = std::max(0.2f, pending.density - 1.0f * frameDt);
+        if (IsKeyDown(KEY_RIGHT_BRACKET)) pending.gradient = std::min(1.0f, pending.gradient + 0.8f * frameDt);
+        if (IsKeyDown(KEY_LEFT_BRACKET)) pending.gradient = std::max(0.0f, pending.gradient - 0.8f * frameDt);
+        if (IsKeyDown(KEY_EQUAL)) timeScale = std::min(4.0f, timeScale + 1.2f * frameDt);
+        if (IsKeyDown(KEY_MINUS)) timeScale = std::max(0.2f, timeScale - 1.2f * frameDt);
+        if (detonate) sim.Reset([pending](RemnantScene& state) { DetonateRemnant(&state, pending); });
+        sim.SetTimeScale(paused ? 0.0f : timeScale);
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
-        if (!paused) {
-            age += GetFrameTime() * timeScale;
-            if (age > 28.0f) {
-                age = 0.02f;
-                shockHistory.assign(360, 0.0f);
-            }
-        }
-
-        float sedov = std::pow(std::max(0.02f, age), 0.4f) * std::pow(energy / std::max(0.18f, density), 0.2f);
-        float shellRadius = 2.2f * sedov;
-        float shockSpeed = 0.4f * shellRadius / std::max(0.04f, age);
-        shockHistory.push_back(shockSpeed);
-        if (shockHistory.size() > 360) shockHistory.pop_front();
+        const auto sample = sim.Sample();
+        const RemnantView* view = sample.current;
+        const RemnantView* previous = sample.previous;
+        const float alpha = previous->generation == view->generation && previous->pos.size() == view->pos.size() ? sample.alpha : 1.0f;
+        points.resize(view->pos.size());
+        for (size_t i = 0; i < points.size(); ++i) points[i] = {Vector3Lerp(previous->pos[i], view->pos[i], alpha), view->color[i]};
+        cloud.Clear();
+        cloud.Append(points.data(), points.size());
 
         BeginDrawing();
         ClearBackground(Color{6, 9, 16, 255});
@@ -114,48 +365,46 @@ int main() {
 
         DrawGrid(30, 1.2f);
         DrawSphere({0.0f, 0.0f, 0.0f}, 0.24f, Color{190, 215, 255, 255});  // Compact remnant.
+        BeginBlendMode(BLEND_ADDITIVE);
+        cloud.Draw(1.6f);
+        EndBlendMode();
 
-        for (const ShellPoint& p : shell) {
-            float localDensity = 1.0f + gradient * p.dir.x;  // Denser medium on +X slows expansion.
-            localDensity = std::max(0.25f, localDensity);
-            float localR = shellRadius / std::pow(localDensity, 0.23f);
-            float turbulence = 1.0f + 0.08f * std::sin(4.0f * age + p.phase);
-            Vector3 pos = Vector3Scale(p.dir, localR * turbulence);
-
-            float heat = std::exp(-age / 18.0f);
-            unsigned char rr = static_cast<unsigned char>(155 + 90 * heat);
-            unsigned char gg = static_cast<unsigned char>(95 + 70 * heat);
-            unsigned char bb = static_cast<unsigned char>(130 + 110 * (1.0f - heat));
-            DrawPoint3D(pos, Color{rr, gg, bb, 215});
-        }
-
-        DrawSphereWires({0.0f, 0.0f, 0.0f}, shellRadius, 18, 18, Fade(Color{255, 175, 120, 255}, 0.25f));
+        DrawSphereWires({0.0f, 0.0f, 0.0f}, view->sedovRadius, 18, 18, Fade(Color{255, 175, 120, 255}, 0.25f));
         DrawLine3D({-10.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f}, Fade(SKYBLUE, 0.3f));  // ISM gradient axis.
         EndMode3D();
 
         DrawRectangle(870, 516, 388, 236, Fade(Color{18, 26, 42, 255}, 0.92f));
-        DrawText("Shock Speed Proxy", 892, 536, 22, Color{220, 230, 244, 255});
-        for (int i = 1; i < static_cast<int>(shockHistory.size()); ++i) {
-            float s0 = std::min(16.0f, shockHistory[i - 1]);
-            float s1 = std::min(16.0f, shockHistory[i]);
-            int x0 = 900 + i - 1;
-            int x1 = 900 + i;
-            int y0 = 732 - static_cast<int>((s0 / 16.0f) * 166.0f);
-            int y1 = 732 - static_cast<int>((s1 / 16.0f) * 166.0f);
-            DrawLine(x0, y0, x1, y1, Color{130, 240, 188, 255});
-        }
+        DrawText("Shock Radius: SPH vs Sedov-Taylor", 892, 536, 20, Color{220, 230, 244, 255});
+        DrawRadiusHistory(view->sedovHistory, Color{255, 175, 120, 255});
+        DrawRadiusHistory(view->shockHistory, Color{130, 240, 188, 255});
 
-        DrawText("Supernova Remnant Expansion (Sedov-like)", 20, 18, 30, Color{232, 238, 248, 255});
+        DrawText("Supernova Remnant Expansion (SPH)", 20, 18, 30, Color{232, 238, 248, 255});
         DrawText("Mouse orbit | wheel zoom | Up/Down energy | Left/Right density | [ ] gradient | +/- time scale | P pause | R reset",
                  20, 54, 18, Color{164, 183, 210, 255});
         char status[230];
-        std::snprintf(status, sizeof(status), "E=%.2f  rho=%.2f  grad=%.2f  age=%.2f  R=%.2f%s",
-                      energy, density, gradient, age, shellRadius, paused ? " [PAUSED]" : "");
+        std::snprintf(status, sizeof(status), "E=%.2f  rho=%.2f  grad=%.2f  age=%.2f  R=%.2f (Sedov-Taylor %.2f)%s",
+                      view->params.energy, view->params.density, view->params.gradient, view->age, view->shockRadius,
+                      view->sedovRadius, paused ? " [PAUSED]" : "");
         DrawText(status, 20, 84, 20, Color{126, 224, 255, 255});
         DrawFPS(20, 112);
+        DrawText(TextFormat("sim %.0f Hz on its own thread, load %.0f%%", kSimRate, 100.0f * sim.load()), 120, 112, 18,
+                 Color{150, 165, 190, 255});
+        char gasStatus[230];
+        std::snprintf(gasStatus, sizeof(gasStatus), "%s  |  %zu particles  %llu steps  dt=%.4f  neighbours=%.0f  cells=%zu  step=%.1f ms",
+                      view->params.ejecta ? "ejecta-driven" : "point blast", view->pos.size(),
+                      static_cast<unsigned long long>(view->steps), view->dt, view->neighbours, view->cells, view->stepMs);
+        DrawText(gasStatus, 20, 140, 18, Color{255, 214, 150, 255});
+        DrawText(TextFormat("Space detonate with E=%.2f rho=%.2f grad=%.2f | M point blast/ejecta | N particles (%d)", pending.energy,
+                            pending.density, pending.gradient, kParticleOptions[static_cast<size_t>(pending.particleOption)]),
+                 20, 166, 18, Color{164, 183, 210, 255});
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    sim.Stop();
+    cloud.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
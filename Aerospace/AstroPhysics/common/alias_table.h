@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace astro_random {
+
+// Walker alias table over n weighted outcomes (Vose's construction): each of n columns
+// keeps its own outcome with probability prob[i] and hands the rest to alias[i], so a
+// draw is one multiply, a compare and at most two loads however skewed the weights.
+// Building is O(n); rebuild only when the distribution changes.
+class AliasTable {
+  public:
+    // Negative weights count as zero. All-zero weights give a uniform table.
+    void Build(const std::vector<double>& weights) {
+        const size_t n = weights.size();
+        prob_.assign(n, 1.0f);
+        alias_.resize(n);
+        for (size_t i = 0; i < n; ++i) alias_[i] = static_cast<uint32_t>(i);
+        double total = 0.0;
+        for (double w : weights) total += std::max(w, 0.0);
+        if (n == 0 || total <= 0.0) return;
+
+        // Scaled so the mean column holds exactly 1.
+        scaled_.resize(n);
+        small_.clear();
+        large_.clear();
+        for (size_t i = 0; i < n; ++i) {
+            scaled_[i] = std::max(weights[i], 0.0) * static_cast<double>(n) / total;
+            (scaled_[i] < 1.0 ? small_ : large_).push_back(static_cast<uint32_t>(i));
+        }
+        while (!small_.empty() && !large_.empty()) {
+            const uint32_t s = small_.back();
+            small_.pop_back();
+            const uint32_t l = large_.back();
+            prob_[s] = static_cast<float>(scaled_[s]);
+            alias_[s] = l;
+            scaled_[l] -= 1.0 - scaled_[s];
+            if (scaled_[l] < 1.0) {
+                large_.pop_back();
+                small_.push_back(l);
+            }
+        }
+        // What is left is 1 up to rounding.
+        for (uint32_t i : small_) prob_[i] = 1.0f;
+        for (uint32_t i : large_) prob_[i] = 1.0f;
+    }
+
+    // Outcome for one uniform u in [0, 1): the integer part of u * n picks the column and
+    // the fraction decides between it and its alias. With 24-bit uniforms that leaves
+    // 24 - log2(n) bits for the fraction, plenty for tables of a few thousand entries.
+    uint32_t Sample(float u) const {
+        const float x = u * static_cast<float>(prob_.size());
+        const uint32_t column = std::min(static_cast<uint32_t>(x), static_cast<uint32_t>(prob_.size() - 1));
+        return x - static_cast<float>(column) < prob_[column] ? column : alias_[column];
+    }
+
+    size_t size() const { return prob_.size(); }
+    bool empty() const { return prob_.empty(); }
+
+  private:
+    std::vector<float> prob_;
+    std::vector<uint32_t> alias_;
+    std::vector<double> scaled_;
+    std::vector<uint32_t> small_;
+    std::vector<uint32_t> large_;
+};
+
+}  // namespace astro_random
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace astro_nbody {
+
+// Leaves hold up to kLeafCapacity bodies and are summed directly; kMaxDepth stops
+// runaway subdivision when many bodies sit on (nearly) the same point.
+constexpr int kLeafCapacity = 8;
+constexpr int kMaxDepth = 28;
+
+struct OctreeNode {
+    Vector3 center{};
+    float halfSize = 0.0f;
+    Vector3 com{};
+    float mass = 0.0f;
+    int firstChild = -1;  // eight contiguous children, -1 for a leaf
+    int begin = 0;        // body range in tree order
+    int end = 0;
+};
+
+// Barnes-Hut octree rebuilt from scratch every step. Bodies are reordered along the
+// tree so a leaf's members are contiguous, which keeps both the leaf sums and the
+// per-body walks (issued in tree order) cache friendly.
+class BarnesHutOctree {
+  public:
+    void Build(const std::vector<Vector3>& positions, const std::vector<float>& masses) {
+        const int count = static_cast<int>(positions.size());
+        nodes_.clear();
+        order_.resize(static_cast<size_t>(count));
+        scratch_.resize(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) order_[static_cast<size_t>(i)] = i;
+
+        Vector3 lo = {0.0f, 0.0f, 0.0f};
+        Vector3 hi = {0.0f, 0.0f, 0.0f};
+        if (count > 0) {
+            lo = hi = positions[0];
+            for (const Vector3& p : positions) {
+                lo = Vector3Min(lo, p);
+                hi = Vector3Max(hi, p);
+            }
+        }
+        OctreeNode root{};
+        root.center = Vector3Scale(Vector3Add(lo, hi), 0.5f);
+        root.halfSize = 0.5f * std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z}) + 1.0e-3f;
+        root.begin = 0;
+        root.end = count;
+        nodes_.reserve(static_cast<size_t>(std::max(1, count / 2)));
+        nodes_.push_back(root);
+        BuildNode(0, positions, masses, 0);
+
+        points_.resize(static_cast<size_t>(count));
+        masses_.resize(static_cast<size_t>(count));
+        for (int k = 0; k < count; ++k) {
+            const int src = order_[static_cast<size_t>(k)];
+            points_[static_cast<size_t>(k)] = positions[static_cast<size_t>(src)];
+            masses_[static_cast<size_t>(k)] = masses[static_cast<size_t>(src)];
+        }
+    }
+
+    // Softened acceleration at p. Cells are accepted as a single monopole when
+    // size / distance < theta and p lies outside them; otherwise they are opened.
+    Vector3 AccelerationAt(Vector3 p, float theta, float g, float eps) const {
+        Vector3 acc = {0.0f, 0.0f, 0.0f};
+        if (nodes_.empty() || nodes_[0].mass <= 0.0f) return acc;
+
+        const float theta2 = theta * theta;
+        const float eps2 = eps * eps;
+        std::array<int, 8 * kMaxDepth + 8> stack{};
+        int top = 0;
+        stack[static_cast<size_t>(top++)] = 0;
+
+        while (top > 0) {
+            const OctreeNode& node = nodes_[static_cast<size_t>(stack[static_cast<size_t>(--top)])];
+            if (node.mass <= 0.0f) continue;
+
+            if (node.firstChild < 0) {
+                for (int k = node.begin; k < node.end; ++k) {
+                    const Vector3 q = points_[static_cast<size_t>(k)];
+                    const float dx = q.x - p.x;
+                    const float dy = q.y - p.y;
+                    const float dz = q.z - p.z;
+                    const float r2 = dx * dx + dy * dy + dz * dz + eps2;
+                    const float inv = 1.0f / std::sqrt(r2);
+                    const float s = g * masses_[static_cast<size_t>(k)] * inv * inv * inv;
+                    acc.x += dx * s;
+                    acc.y += dy * s;
+                    acc.z += dz * s;
+                }
+                continue;
+            }
+
+            const float dx = node.com.x - p.x;
+            const float dy = node.com.y - p.y;
+            const float dz = node.com.z - p.z;
+            const float r2 = dx * dx + dy * dy + dz * dz;
+            const float size = 2.0f * node.halfSize;
+            const bool inside = std::fabs(p.x - node.center.x) <= node.halfSize &&
+                                std::fabs(p.y - node.center.y) <= node.halfSize &&
+                                std::fabs(p.z - node.center.z) <= node.halfSize;
+            if (!inside && size * size < theta2 * r2) {
+                const float inv = 1.0f / std::sqrt(r2 + eps2);
+                const float s = g * node.mass * inv * inv * inv;
+                acc.x += dx * s;
+                acc.y += dy * s;
+                acc.z += dz * s;
+                continue;
+            }
+            for (int c = 0; c < 8; ++c) stack[static_cast<size_t>(top++)] = node.firstChild + c;
+        }
+        return acc;
+    }
+
+    // Accelerations for every body used in Build, split across worker threads. Each
+    // leaf walks the tree once against its own bounding box (Barnes' grouped walk) and
+    // the resulting interaction list is shared by all of its members.
+    void ComputeAccelerations(float theta, float g, float eps, std::vector<Vector3>* out, int threadCount = 0) const {
+        const int count = static_cast<int>(points_.size());
+        out->resize(static_cast<size_t>(count));
+        std::vector<int> leaves;
+        for (int n = 0; n < static_cast<int>(nodes_.size()); ++n) {
+            const OctreeNode& node = nodes_[static_cast<size_t>(n)];
+            if (node.firstChild < 0 && node.end > node.begin) leaves.push_back(n);
+        }
+        if (threadCount <= 0) threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        threadCount = std::clamp(threadCount, 1, std::max(1, static_cast<int>(leaves.size()) / 64));
+
+        auto work = [&](int lo, int hi) {
+            InteractionList list;
+            for (int l = lo; l < hi; ++l) {
+                const OctreeNode& leaf = nodes_[static_cast<size_t>(leaves[static_cast<size_t>(l)])];
+                GatherInteractions(leaf, theta, &list);
+                for (int k = leaf.begin; k < leaf.end; ++k) {
+                    (*out)[static_cast<size_t>(order_[static_cast<size_t>(k)])] =
+                        ApplyInteractions(list, points_[static_cast<size_t>(k)], g, eps);
+                }
+            }
+        };
+
+        const int leafCount = static_cast<int>(leaves.size());
+        if (threadCount == 1) {
+            work(0, leafCount);
+            return;
+        }
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<size_t>(threadCount - 1));
+        const int chunk = (leafCount + threadCount - 1) / threadCount;
+        for (int t = 1; t < threadCount; ++t) {
+            const int lo = std::min(leafCount, t * chunk);
+            const int hi = std::min(leafCount, lo + chunk);
+            workers.emplace_back(work, lo, hi);
+        }
+        work(0, std::min(leafCount, chunk));
+        for (std::thread& w : workers) w.join();
+    }
+
+    const std::vector<OctreeNode>& nodes() const { return nodes_; }
+    float totalMass() const { return nodes_.empty() ? 0.0f : nodes_[0].mass; }
+
+  private:
+    struct InteractionList {
+        std::vector<Vector3> cellCom;
+        std::vector<float> cellMass;
+        std::vector<int> leafBegin;
+        std::vector<int> leafEnd;
+    };
+
+    // Builds the interaction list of a leaf: cells far enough from every point of the
+    // leaf's bounding box become monopoles, unopenable leaves are summed directly.
+    void GatherInteractions(const OctreeNode& group, float theta, InteractionList* list) const {
+        list->cellCom.clear();
+        list->cellMass.clear();
+        list->leafBegin.clear();
+        list->leafEnd.clear();
+
+        Vector3 lo = points_[static_cast<size_t>(group.begin)];
+        Vector3 hi = lo;
+        for (int k = group.begin + 1; k < group.end; ++k) {
+            lo = Vector3Min(lo, points_[static_cast<size_t>(k)]);
+            hi = Vector3Max(hi, points_[static_cast<size_t>(k)]);
+        }
+
+        const float theta2 = theta * theta;
+        std::array<int, 8 * kMaxDepth + 8> stack{};
+        int top = 0;
+        stack[static_cast<size_t>(top++)] = 0;
+        while (top > 0) {
+            const OctreeNode& node = nodes_[static_cast<size_t>(stack[static_cast<size_t>(--top)])];
+            if (node.mass <= 0.0f) continue;
+            if (node.firstChild < 0) {
+                list->leafBegin.push_back(node.begin);
+                list->leafEnd.push_back(node.end);
+                continue;
+            }
+            const float dx = std::max({lo.x - node.com.x, 0.0f, node.com.x - hi.x});
+            const float dy = std::max({lo.y - node.com.y, 0.0f, node.com.y - hi.y});
+            const float dz = std::max({lo.z - node.com.z, 0.0f, node.com.z - hi.z});
+            const float size = 2.0f * node.halfSize;
+            const bool overlaps = lo.x <= node.center.x + node.halfSize && hi.x >= node.center.x - node.halfSize &&
+                                  lo.y <= node.center.y + node.halfSize && hi.y >= node.center.y - node.halfSize &&
+                                  lo.z <= node.center.z + node.halfSize && hi.z >= node.center.z - node.halfSize;
+            if (!overlaps && size * size < theta2 * (dx * dx + dy * dy + dz * dz)) {
+                list->cellCom.push_back(node.com);
+                list->cellMass.push_back(node.mass);
+                continue;
+            }
+            for (int c = 0; c < 8; ++c) stack[static_cast<size_t>(top++)] = node.firstChild + c;
+        }
+    }
+
+    Vector3 ApplyInteractions(const InteractionList& list, Vector3 p, float g, float eps) const {
+        const float eps2 = eps * eps;
+        float ax = 0.0f;
+        float ay = 0.0f;
+        float az = 0.0f;
+        const size_t cells = list.cellMass.size();
+        for (size_t c = 0; c < cells; ++c) {
+            const float dx = list.cellCom[c].x - p.x;
+            const float dy = list.cellCom[c].y - p.y;
+            const float dz = list.cellCom[c].z - p.z;
+            const float inv = 1.0f / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+            const float s = list.cellMass[c] * inv * inv * inv;
+            ax += dx * s;
+            ay += dy * s;
+            az += dz * s;
+        }
+        for (size_t l = 0; l < list.leafBegin.size(); ++l) {
+            for (int k = list.leafBegin[l]; k < list.leafEnd[l]; ++k) {
+                const Vector3 q = points_[static_cast<size_t>(k)];
+                const float dx = q.x - p.x;
+                const float dy = q.y - p.y;
+                const float dz = q.z - p.z;
+                const float inv = 1.0f / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+                const float s = masses_[static_cast<size_t>(k)] * inv * inv * inv;
+                ax += dx * s;
+                ay += dy * s;
+                az += dz * s;
+            }
+        }
+        return {g * ax, g * ay, g * az};
+    }
+
+    static int Octant(Vector3 p, Vector3 c) {
+        return (p.x >= c.x ? 1 : 0) | (p.y >= c.y ? 2 : 0) | (p.z >= c.z ? 4 : 0);
+    }
+
+    void BuildNode(int nodeIndex, const std::vector<Vector3>& positions, const std::vector<float>& masses, int depth) {
+        const int begin = nodes_[static_cast<size_t>(nodeIndex)].begin;
+        const int end = nodes_[static_cast<size_t>(nodeIndex)].end;
+
+        if (end - begin <= kLeafCapacity || depth >= kMaxDepth) {
+            float mass = 0.0f;
+            Vector3 weighted = {0.0f, 0.0f, 0.0f};
+            for (int k = begin; k < end; ++k) {
+                const int i = order_[static_cast<size_t>(k)];
+                const float m = masses[static_cast<size_t>(i)];
+                mass += m;
+                weighted = Vector3Add(weighted, Vector3Scale(positions[static_cast<size_t>(i)], m));
+            }
+            OctreeNode& node = nodes_[static_cast<size_t>(nodeIndex)];
+            node.mass = mass;
+            node.com = (mass > 0.0f) ? Vector3Scale(weighted, 1.0f / mass) : node.center;
+            return;
+        }
+
+        // Counting sort of the node's range into its eight octants.
+        const Vector3 center = nodes_[static_cast<size_t>(nodeIndex)].center;
+        const float childHalf = 0.5f * nodes_[static_cast<size_t>(nodeIndex)].halfSize;
+        std::array<int, 9> offsets{};
+        for (int k = begin; k < end; ++k) {
+            offsets[static_cast<size_t>(Octant(positions[static_cast<size_t>(order_[static_cast<size_t>(k)])], center) + 1)]++;
+        }
+        offsets[0] = begin;
+        for (int c = 1; c <= 8; ++c) offsets[static_cast<size_t>(c)] += offsets[static_cast<size_t>(c - 1)];
+        std::array<int, 8> cursor{};
+        std::copy(offsets.begin(), offsets.begin() + 8, cursor.begin());
+        for (int k = begin; k < end; ++k) {
+            const int i = order_[static_cast<size_t>(k)];
+            scratch_[static_cast<size_t>(cursor[static_cast<size_t>(Octant(positions[static_cast<size_t>(i)], center))]++)] = i;
+        }
+        std::copy(scratch_.begin() + begin, scratch_.begin() + end, order_.begin() + begin);
+
+        const int firstChild = static_cast<int>(nodes_.size());
+        nodes_[static_cast<size_t>(nodeIndex)].firstChild = firstChild;
+        for (int c = 0; c < 8; ++c) {
+            OctreeNode child{};
+            child.halfSize = childHalf;
+            child.center = {
+                center.x + ((c & 1) ? childHalf : -childHalf),
+                center.y + ((c & 2) ? childHalf : -childHalf),
+                center.z + ((c & 4) ? childHalf : -childHalf),
+            };
+            child.begin = offsets[static_cast<size_t>(c)];
+            child.end = offsets[static_cast<size_t>(c + 1)];
+            nodes_.push_back(child);
+        }
+
+        float mass = 0.0f;
+        Vector3 weighted = {0.0f, 0.0f, 0.0f};
+        for (int c = 0; c < 8; ++c) {
+            const int childIndex = firstChild + c;
+            if (nodes_[static_cast<size_t>(childIndex)].begin == nodes_[static_cast<size_t>(childIndex)].end) continue;
+            BuildNode(childIndex, positions, masses, depth + 1);
+            const OctreeNode& child = nodes_[static_cast<size_t>(childIndex)];
+            mass += child.mass;
+            weighted = Vector3Add(weighted, Vector3Scale(child.com, child.mass));
+        }
+        OctreeNode& node = nodes_[static_cast<size_t>(nodeIndex)];
+        node.mass = mass;
+        node.com = (mass > 0.0f) ? Vector3Scale(weighted, 1.0f / mass) : center;
+    }
+
+    std::vector<OctreeNode> nodes_;
+    std::vector<int> order_;
+    std::vector<int> scratch_;
+    std::vector<Vector3> points_;
+    std::vector<float> masses_;
+};
+
+}  // namespace astro_nbody
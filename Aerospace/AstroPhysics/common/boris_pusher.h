@@ -0,0 +1,231 @@
+#pragma once
+
+#include "particle_soa.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Charged-particle engine: Boris pushes over structure-of-arrays batches, one batch per
+// species so each runs at the sub-step its own gyro-frequency needs, plus an optional
+// axisymmetric particle-in-cell field (cloud-in-cell deposit onto an (R, Z) grid,
+// cylindrical Poisson solve by SOR, interpolated E back to the particles).
+//
+// Coordinates follow the demos: y is the symmetry axis, R = sqrt(x^2 + z^2). Fields come
+// from a caller functor so the coil model stays with the scene:
+//
+//   field(x, y, z, float e[3], float b[3])
+//
+// Pushes are split across the shared thread pool in kPushChunk blocks; the deposit keeps
+// one grid per block and sums them in block order, so results do not depend on the
+// thread count.
+
+namespace astro_plasma {
+
+struct ParticleBatch {
+    astro_soa::AlignedFloats x, y, z;
+    astro_soa::AlignedFloats vx, vy, vz;
+    float chargeOverMass = 1.0f;
+    float weight = 0.0f;  // charge per macro-particle deposited by the PIC field; 0 = test particles
+
+    size_t size() const { return x.size(); }
+
+    void resize(size_t n) {
+        for (astro_soa::AlignedFloats* a : {&x, &y, &z, &vx, &vy, &vz}) a->assign(n, 0.0f);
+    }
+};
+
+constexpr int kPushChunk = 4096;
+constexpr int kPushTile = 64;  // particles advanced together per sub-step, so their chains overlap
+
+// Advances particles [begin, end) by `steps` Boris steps of dt: half electric kick,
+// magnetic rotation (t = qB dt / 2m, s = 2t / (1 + t^2)), half kick, drift. The field is
+// evaluated once per step at the drifted position. Steps run outermost over small tiles:
+// one particle's steps are a serial dependency chain, a tile of them is not.
+template <typename Field>
+void BorisPushRange(ParticleBatch* batch, size_t begin, size_t end, float dt, int steps, const Field& field) {
+    const float k = 0.5f * batch->chargeOverMass * dt;
+    float* __restrict px = batch->x.data();
+    float* __restrict py = batch->y.data();
+    float* __restrict pz = batch->z.data();
+    float* __restrict qx = batch->vx.data();
+    float* __restrict qy = batch->vy.data();
+    float* __restrict qz = batch->vz.data();
+    for (size_t tile = begin; tile < end; tile += kPushTile) {
+        const size_t tileEnd = std::min(end, tile + kPushTile);
+        for (int s = 0; s < steps; ++s) {
+            for (size_t i = tile; i < tileEnd; ++i) {
+                float e[3], b[3];
+                field(px[i], py[i], pz[i], e, b);
+                const float mx = qx[i] + k * e[0], my = qy[i] + k * e[1], mz = qz[i] + k * e[2];
+                const float tx = k * b[0], ty = k * b[1], tz = k * b[2];
+                const float sScale = 2.0f / (1.0f + tx * tx + ty * ty + tz * tz);
+                const float rx = mx + (my * tz - mz * ty);
+                const float ry = my + (mz * tx - mx * tz);
+                const float rz = mz + (mx * ty - my * tx);
+                const float sx = sScale * tx, sy = sScale * ty, sz = sScale * tz;
+                const float vx = mx + (ry * sz - rz * sy) + k * e[0];
+                const float vy = my + (rz * sx - rx * sz) + k * e[1];
+                const float vz = mz + (rx * sy - ry * sx) + k * e[2];
+                qx[i] = vx;
+                qy[i] = vy;
+                qz[i] = vz;
+                px[i] += vx * dt;
+                py[i] += vy * dt;
+                pz[i] += vz * dt;
+            }
+        }
+    }
+}
+
+template <typename Field>
+void BorisPush(ParticleBatch* batch, float dt, int steps, const Field& field) {
+    const int n = static_cast<int>(batch->size());
+    astro_parallel::SharedPool().ParallelFor(n, kPushChunk, [&](int begin, int end) {
+        BorisPushRange(batch, static_cast<size_t>(begin), static_cast<size_t>(end), dt, steps, field);
+    });
+}
+
+// Electrostatic field of the deposited charge on a rectangle of the (R, Z) half-plane
+// with a grounded boundary (the vessel), assuming toroidal symmetry:
+//
+//   (1/R) d/dR (R dphi/dR) + d2phi/dZ2 = -rho / epsilon
+class AxisymmetricPoisson {
+  public:
+    static constexpr float kOverRelaxation = 1.85f;
+
+    void Configure(float rMin, float rMax, float zMin, float zMax, int nr, int nz) {
+        rMin_ = rMin;
+        zMin_ = zMin;
+        nr_ = nr;
+        nz_ = nz;
+        dr_ = (rMax - rMin) / (nr - 1);
+        dz_ = (zMax - zMin) / (nz - 1);
+        const size_t nodes = static_cast<size_t>(nr) * nz;
+        rho_.assign(nodes, 0.0f);
+        phi_.assign(nodes, 0.0f);
+        er_.assign(nodes, 0.0f);
+        ez_.assign(nodes, 0.0f);
+        blocks_.clear();
+    }
+
+    void ClearCharge() { std::fill(rho_.begin(), rho_.end(), 0.0f); }
+
+    // Cloud-in-cell deposit of a batch; charge is spread over the ring volume 2 pi R dR dZ.
+    void Deposit(const ParticleBatch& batch) {
+        if (batch.weight == 0.0f || batch.size() == 0) return;
+        const int n = static_cast<int>(batch.size());
+        const int blocks = (n + kPushChunk - 1) / kPushChunk;
+        if (blocks_.size() < static_cast<size_t>(blocks)) blocks_.resize(blocks);
+        astro_parallel::SharedPool().ParallelFor(blocks, 1, [&](int b0, int b1) {
+            for (int b = b0; b < b1; ++b) {
+                std::vector<float>& grid = blocks_[b];
+                grid.assign(rho_.size(), 0.0f);
+                const size_t end = std::min(static_cast<size_t>(n), static_cast<size_t>(b + 1) * kPushChunk);
+                for (size_t i = static_cast<size_t>(b) * kPushChunk; i < end; ++i) {
+                    const float r = std::sqrt(batch.x[i] * batch.x[i] + batch.z[i] * batch.z[i]);
+                    float fr, fz;
+                    int ir, iz;
+                    if (!Locate(r, batch.y[i], &ir, &iz, &fr, &fz)) continue;
+                    const size_t m = Node(ir, iz);
+                    grid[m] += batch.weight * (1.0f - fr) * (1.0f - fz);
+                    grid[m + 1] += batch.weight * fr * (1.0f - fz);
+                    grid[m + nr_] += batch.weight * (1.0f - fr) * fz;
+                    grid[m + nr_ + 1] += batch.weight * fr * fz;
+                }
+            }
+        });
+        const float ring = 2.0f * 3.14159265f * dr_ * dz_;
+        for (int b = 0; b < blocks; ++b) {
+            for (int iz = 0; iz < nz_; ++iz) {
+                for (int ir = 0; ir < nr_; ++ir) {
+                    const size_t m = Node(ir, iz);
+                    rho_[m] += blocks_[b][m] / (ring * (rMin_ + ir * dr_));
+                }
+            }
+        }
+    }
+
+    // Red-black SOR sweeps from the previous potential, then E = -grad phi.
+    void Solve(float epsilon, int sweeps) {
+        const float invDr2 = 1.0f / (dr_ * dr_);
+        const float invDz2 = 1.0f / (dz_ * dz_);
+        for (int sweep = 0; sweep < sweeps; ++sweep) {
+            for (int color = 0; color < 2; ++color) {
+                for (int iz = 1; iz + 1 < nz_; ++iz) {
+                    for (int ir = 1 + ((iz + color) & 1); ir + 1 < nr_; ir += 2) {
+                        const size_t m = Node(ir, iz);
+                        const float r = rMin_ + ir * dr_;
+                        const float out = 1.0f + 0.5f * dr_ / r;
+                        const float in = 1.0f - 0.5f * dr_ / r;
+                        const float sum = invDr2 * (out * phi_[m + 1] + in * phi_[m - 1]) + invDz2 * (phi_[m + nr_] + phi_[m - nr_]) +
+                                          rho_[m] / epsilon;
+                        const float target = sum / (2.0f * invDr2 + 2.0f * invDz2);
+                        phi_[m] += kOverRelaxation * (target - phi_[m]);
+                    }
+                }
+            }
+        }
+        for (int iz = 0; iz < nz_; ++iz) {
+            for (int ir = 0; ir < nr_; ++ir) {
+                const size_t m = Node(ir, iz);
+                const int r0 = std::max(0, ir - 1), r1 = std::min(nr_ - 1, ir + 1);
+                const int z0 = std::max(0, iz - 1), z1 = std::min(nz_ - 1, iz + 1);
+                er_[m] = -(phi_[Node(r1, iz)] - phi_[Node(r0, iz)]) / ((r1 - r0) * dr_);
+                ez_[m] = -(phi_[Node(ir, z1)] - phi_[Node(ir, z0)]) / ((z1 - z0) * dz_);
+            }
+        }
+    }
+
+    // Interpolated (E_R, E_Z); zero outside the grid.
+    void FieldAt(float r, float z, float* er, float* ez) const {
+        float fr, fz;
+        int ir, iz;
+        if (!Locate(r, z, &ir, &iz, &fr, &fz)) {
+            *er = *ez = 0.0f;
+            return;
+        }
+        const size_t m = Node(ir, iz);
+        const float w00 = (1.0f - fr) * (1.0f - fz), w10 = fr * (1.0f - fz), w01 = (1.0f - fr) * fz, w11 = fr * fz;
+        *er = w00 * er_[m] + w10 * er_[m + 1] + w01 * er_[m + nr_] + w11 * er_[m + nr_ + 1];
+        *ez = w00 * ez_[m] + w10 * ez_[m + 1] + w01 * ez_[m + nr_] + w11 * ez_[m + nr_ + 1];
+    }
+
+    float Potential(float r, float z) const {
+        float fr, fz;
+        int ir, iz;
+        if (!Locate(r, z, &ir, &iz, &fr, &fz)) return 0.0f;
+        const size_t m = Node(ir, iz);
+        return (1.0f - fr) * (1.0f - fz) * phi_[m] + fr * (1.0f - fz) * phi_[m + 1] + (1.0f - fr) * fz * phi_[m + nr_] +
+               fr * fz * phi_[m + nr_ + 1];
+    }
+
+    void Reset() {
+        std::fill(phi_.begin(), phi_.end(), 0.0f);
+        std::fill(er_.begin(), er_.end(), 0.0f);
+        std::fill(ez_.begin(), ez_.end(), 0.0f);
+    }
+
+  private:
+    size_t Node(int ir, int iz) const { return static_cast<size_t>(iz) * nr_ + ir; }
+
+    bool Locate(float r, float z, int* ir, int* iz, float* fr, float* fz) const {
+        const float gr = (r - rMin_) / dr_;
+        const float gz = (z - zMin_) / dz_;
+        if (!(gr >= 0.0f && gz >= 0.0f && gr < nr_ - 1 && gz < nz_ - 1)) return false;
+        *ir = static_cast<int>(gr);
+        *iz = static_cast<int>(gz);
+        *fr = gr - *ir;
+        *fz = gz - *iz;
+        return true;
+    }
+
+    float rMin_ = 0.0f, zMin_ = 0.0f, dr_ = 1.0f, dz_ = 1.0f;
+    int nr_ = 0, nz_ = 0;
+    std::vector<float> rho_, phi_, er_, ez_;
+    std::vector<std::vector<float>> blocks_;
+};
+
+}  // namespace astro_plasma
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Lowest bound states of a 1D potential,
+//     -psi'' + V psi = E psi        (hbar = 1, 2m = 1, as in split_step_schrodinger.h),
+// on a uniform grid of interior points with psi = 0 just outside both ends. The
+// three-point Laplacian makes H a symmetric tridiagonal matrix with diagonal 2/h^2 + V_i
+// and off-diagonal -1/h^2. Only the lowest few eigenpairs are needed, so instead of a
+// full QL sweep each eigenvalue is isolated by Sturm-sequence bisection and its vector
+// found by inverse iteration (the dstebz/dstein split, O(points) per state and step).
+// Given the states of a nearby potential, SolveLowestStates() instead starts Rayleigh
+// quotient iteration from them and keeps the result once a Sturm count confirms it is
+// still the same level; that is what keeps re-solving cheap while a slider moves.
+
+namespace astro_quantum {
+
+struct BoundStates {
+    int points = 0;
+    double h = 0.0;
+    std::vector<double> energy;  // ascending
+    std::vector<float> psi;      // energy.size() rows of `points`, sum psi^2 h = 1
+
+    int count() const { return static_cast<int>(energy.size()); }
+    const float* State(int s) const { return psi.data() + static_cast<size_t>(s) * points; }
+};
+
+namespace detail {
+
+// Number of eigenvalues below lambda (sign changes of the LDL^T pivots of H - lambda).
+inline int SturmCount(const std::vector<double>& diag, double off2, double lambda) {
+    int count = 0;
+    double d = 1.0;
+    for (size_t i = 0; i < diag.size(); ++i) {
+        d = diag[i] - lambda - (i > 0 ? off2 / d : 0.0);
+        if (d == 0.0) d = -std::numeric_limits<double>::epsilon() * (std::fabs(lambda) + 1.0);
+        if (d < 0.0) ++count;
+    }
+    return count;
+}
+
+inline double BisectEigenvalue(const std::vector<double>& diag, double off2, int index, double lo, double hi) {
+    for (int it = 0; it < 100 && hi - lo > 1e-13 * std::max(1.0, std::fabs(lo) + std::fabs(hi)); ++it) {
+        const double mid = 0.5 * (lo + hi);
+        if (SturmCount(diag, off2, mid) > index) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+// Solves (H - shift) y = x in place (Thomas algorithm); scratch holds the pivots.
+inline void ShiftedSolve(const std::vector<double>& diag, double off, double shift, std::vector<double>* x,
+                         std::vector<double>* scratch) {
+    const size_t n = diag.size();
+    std::vector<double>& pivot = *scratch;
+    pivot.resize(n);
+    const double tiny = 1e-14 * (std::fabs(shift) + 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        double p = diag[i] - shift - (i > 0 ? off * off / pivot[i - 1] : 0.0);
+        if (std::fabs(p) < tiny) p = p < 0.0 ? -tiny : tiny;
+        pivot[i] = p;
+        if (i > 0) (*x)[i] -= off / pivot[i - 1] * (*x)[i - 1];
+    }
+    (*x)[n - 1] /= pivot[n - 1];
+    for (size_t i = n - 1; i-- > 0;) (*x)[i] = ((*x)[i] - off * (*x)[i + 1]) / pivot[i];
+}
+
+// Removes the components along the `lower` states, then normalises to sum v^2 h = 1.
+inline void Orthonormalise(std::vector<double>* v, const std::vector<std::vector<double>>& lower, double h) {
+    for (const std::vector<double>& u : lower) {
+        double dot = 0.0;
+        for (size_t i = 0; i < v->size(); ++i) dot += (*v)[i] * u[i];
+        for (size_t i = 0; i < v->size(); ++i) (*v)[i] -= dot * u[i];
+    }
+    double norm = 0.0;
+    for (double x : *v) norm += x * x;
+    const double scale = 1.0 / std::sqrt(std::max(norm * h, 1e-300));
+    for (double& x : *v) x *= scale;
+}
+
+inline double RayleighQuotient(const std::vector<double>& diag, double off, const std::vector<double>& v) {
+    double num = 0.0, den = 0.0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        double hv = diag[i] * v[i];
+        if (i > 0) hv += off * v[i - 1];
+        if (i + 1 < v.size()) hv += off * v[i + 1];
+        num += v[i] * hv;
+        den += v[i] * v[i];
+    }
+    return num / den;
+}
+
+}  // namespace detail
+
+// Lowest `count` states for V sampled at the grid points, spacing h. `warm`, if given,
+// should be the states of a nearby potential on the same grid.
+inline BoundStates SolveLowestStates(const std::vector<double>& potential, double h, int count,
+                                     const BoundStates* warm = nullptr) {
+    const int n = static_cast<int>(potential.size());
+    BoundStates out;
+    out.points = n;
+    out.h = h;
+    count = std::clamp(count, 0, n);
+    if (count == 0) return out;
+
+    const double off = -1.0 / (h * h);
+    std::vector<double> diag(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) diag[static_cast<size_t>(i)] = 2.0 / (h * h) + potential[static_cast<size_t>(i)];
+    const auto [vMin, vMax] = std::minmax_element(potential.begin(), potential.end());
+    const double lower = *vMin, upper = *vMax + 4.0 / (h * h);  // Gershgorin
+    const bool useWarm = warm != nullptr && warm->points == n && warm->count() >= count;
+
+    std::vector<std::vector<double>> vectors;
+    std::vector<double> v(static_cast<size_t>(n)), scratch;
+    for (int s = 0; s < count; ++s) {
+        double e = 0.0;
+        bool found = false;
+        if (useWarm) {
+            const float* prev = warm->State(s);
+            for (int i = 0; i < n; ++i) v[static_cast<size_t>(i)] = prev[i];
+            e = warm->energy[static_cast<size_t>(s)];
+            for (int it = 0; it < 4; ++it) {
+                detail::ShiftedSolve(diag, off, e, &v, &scratch);
+                detail::Orthonormalise(&v, vectors, h);
+                e = detail::RayleighQuotient(diag, off, v);
+            }
+            const double tol = 1e-9 * std::max(1.0, std::fabs(e));
+            found = detail::SturmCount(diag, off * off, e - tol) == s && detail::SturmCount(diag, off * off, e + tol) == s + 1;
+        }
+        if (!found) {
+            e = detail::BisectEigenvalue(diag, off * off, s, lower, upper);
+            for (int i = 0; i < n; ++i) v[static_cast<size_t>(i)] = 1.0 + 0.01 * ((i * 7919) % 101);
+            for (int it = 0; it < 3; ++it) {
+                detail::ShiftedSolve(diag, off, e, &v, &scratch);
+                detail::Orthonormalise(&v, vectors, h);
+            }
+        }
+
+        // Stable sign from frame to frame: match the warm state, else make the first
+        // sizeable lobe positive.
+        double sign = 1.0;
+        if (useWarm) {
+            double dot = 0.0;
+            for (int i = 0; i < n; ++i) dot += v[static_cast<size_t>(i)] * warm->State(s)[i];
+            sign = dot < 0.0 ? -1.0 : 1.0;
+        } else {
+            const double peak = std::fabs(*std::max_element(v.begin(), v.end(), [](double x, double y) { return std::fabs(x) < std::fabs(y); }));
+            for (double x : v) {
+                if (std::fabs(x) > 0.1 * peak) {
+                    sign = x < 0.0 ? -1.0 : 1.0;
+                    break;
+                }
+            }
+        }
+        for (double& x : v) x *= sign;
+
+        out.energy.push_back(e);
+        vectors.push_back(v);
+    }
+
+    out.psi.resize(static_cast<size_t>(count) * n);
+    for (int s = 0; s < count; ++s) {
+        std::transform(vectors[static_cast<size_t>(s)].begin(), vectors[static_cast<size_t>(s)].end(),
+                       out.psi.begin() + static_cast<std::ptrdiff_t>(s) * n, [](double x) { return static_cast<float>(x); });
+    }
+    return out;
+}
+
+// Background solver with a small memo of recent results. Request() queues a parameter
+// tuple and its sampled potential (replacing any request not yet started); the worker
+// answers from the memo when the tuple was seen before, else solves warm-started from
+// its last result. Acquire() swaps in the newest finished states. Both belong to the
+// render thread, like FieldLineCache.
+class BoundStateCache {
+  public:
+    using Key = std::array<float, 4>;
+    static constexpr size_t kMemoSize = 64;
+
+    ~BoundStateCache() { Stop(); }
+
+    BoundStateCache() = default;
+    BoundStateCache(const BoundStateCache&) = delete;
+    BoundStateCache& operator=(const BoundStateCache&) = delete;
+
+    void Request(const Key& key, std::vector<double> potential, double h, int count) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (hasRequest_ && key == requestedKey_) return;
+            requestedKey_ = key;
+            hasRequest_ = true;
+            pendingKey_ = key;
+            pendingPotential_.swap(potential);
+            pendingH_ = h;
+            pendingCount_ = count;
+            pending_ = true;
+            stop_ = false;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!finished_) return false;
+        front_ = std::move(finished_);
+        frontKey_ = finishedKey_;
+        return true;
+    }
+
+    // Solves on the calling thread (start-up), filling the memo too.
+    void SolveNow(const Key& key, const std::vector<double>& potential, double h, int count) {
+        std::shared_ptr<const BoundStates> states = Lookup(key, count);
+        if (!states) {
+            states = std::make_shared<const BoundStates>(SolveLowestStates(potential, h, count, front_.get()));
+            Remember(key, states);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        front_ = states;
+        frontKey_ = key;
+        requestedKey_ = key;
+        hasRequest_ = true;
+        last_ = states;
+    }
+
+    bool Busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_ || solving_;
+    }
+
+    // Nullptr until the first solve lands.
+    const BoundStates* states() const { return front_.get(); }
+    const Key& key() const { return frontKey_; }
+    uint64_t solves() const { return solves_.load(); }
+    uint64_t memoHits() const { return memoHits_.load(); }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    std::shared_ptr<const BoundStates> Lookup(const Key& key, int count) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        for (size_t i = 0; i < memo_.size(); ++i) {
+            if (memo_[i].first != key || memo_[i].second->count() < count) continue;
+            std::rotate(memo_.begin(), memo_.begin() + static_cast<std::ptrdiff_t>(i), memo_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            ++memoHits_;
+            return memo_.front().second;
+        }
+        return nullptr;
+    }
+
+    void Remember(const Key& key, std::shared_ptr<const BoundStates> states) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        if (memo_.size() == kMemoSize) memo_.pop_back();
+        memo_.insert(memo_.begin(), {key, std::move(states)});
+        ++solves_;
+    }
+
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            const Key key = pendingKey_;
+            std::vector<double> potential;
+            potential.swap(pendingPotential_);
+            const double h = pendingH_;
+            const int count = pendingCount_;
+            std::shared_ptr<const BoundStates> warm = last_;
+            pending_ = false;
+            solving_ = true;
+            lock.unlock();
+
+            std::shared_ptr<const BoundStates> states = Lookup(key, count);
+            if (!states) {
+                states = std::make_shared<const BoundStates>(SolveLowestStates(potential, h, count, warm.get()));
+                Remember(key, states);
+            }
+
+            lock.lock();
+            finished_ = states;
+            finishedKey_ = key;
+            last_ = std::move(states);
+            solving_ = false;
+        }
+    }
+
+    std::shared_ptr<const BoundStates> front_;
+    Key frontKey_{};
+    Key requestedKey_{};
+    bool hasRequest_ = false;
+
+    std::shared_ptr<const BoundStates> finished_;
+    Key finishedKey_{};
+    std::shared_ptr<const BoundStates> last_;  // warm start for the next solve
+
+    Key pendingKey_{};
+    std::vector<double> pendingPotential_;
+    double pendingH_ = 0.0;
+    int pendingCount_ = 0;
+
+    std::vector<std::pair<Key, std::shared_ptr<const BoundStates>>> memo_;
+    std::mutex memoMutex_;
+    std::atomic<uint64_t> solves_{0};
+    std::atomic<uint64_t> memoHits_{0};
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool pending_ = false;
+    bool solving_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_quantum
@@ -0,0 +1,317 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Electrostatic field of point charges (Gaussian-like units, E = sum q r / |r|^3),
+// softened as r / (|r|^2 + eps^2)^{3/2} like the demos' direct sums.
+//
+// ChargeOctree is a Barnes-Hut tree for signed charges: a monopole is meaningless when
+// the charges in a cell cancel, so every cell keeps its total charge, dipole and
+// traceless quadrupole about its centre and far cells are evaluated from that expansion.
+// FieldLattice caches E on a lattice of sample points and re-evaluates only when the
+// charges or the lattice change; a few moved charges among many are folded in as an
+// exact difference instead of a full re-evaluation.
+
+namespace astro_efield {
+
+struct PointCharge {
+    Vector3 pos;
+    float q;
+};
+
+inline bool operator==(const PointCharge& a, const PointCharge& b) {
+    return a.q == b.q && a.pos.x == b.pos.x && a.pos.y == b.pos.y && a.pos.z == b.pos.z;
+}
+
+// Softened field of a single charge at p.
+inline Vector3 ChargeField(const PointCharge& c, Vector3 p, float eps2) {
+    const float dx = p.x - c.pos.x, dy = p.y - c.pos.y, dz = p.z - c.pos.z;
+    const float inv = 1.0f / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+    const float s = c.q * inv * inv * inv;
+    return {dx * s, dy * s, dz * s};
+}
+
+struct ChargeNode {
+    Vector3 center{};
+    float halfSize = 0.0f;
+    float charge = 0.0f;
+    Vector3 dipole{};                // sum q d, d = x - center
+    std::array<float, 6> quad{};     // sum q (3 d_i d_j - d^2 delta_ij): xx yy zz xy xz yz
+    int firstChild = -1;             // eight contiguous children, -1 for a leaf
+    int begin = 0;                   // charge range in tree order
+    int end = 0;
+};
+
+class ChargeOctree {
+  public:
+    static constexpr int kLeafCapacity = 8;
+    static constexpr int kMaxDepth = 24;
+
+    void Build(const std::vector<PointCharge>& charges) {
+        const int count = static_cast<int>(charges.size());
+        nodes_.clear();
+        charges_ = charges;
+        if (count == 0) return;
+        Vector3 lo = charges[0].pos, hi = lo;
+        for (const PointCharge& c : charges) {
+            lo = Vector3Min(lo, c.pos);
+            hi = Vector3Max(hi, c.pos);
+        }
+        ChargeNode root{};
+        root.center = Vector3Scale(Vector3Add(lo, hi), 0.5f);
+        root.halfSize = 0.5f * std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z}) + 1.0e-3f;
+        root.end = count;
+        nodes_.reserve(static_cast<size_t>(std::max(1, count / 2)));
+        nodes_.push_back(root);
+        scratch_.resize(charges_.size());
+        BuildNode(0, 0);
+    }
+
+    // Far cells (size / distance < theta, p outside) use the quadrupole expansion,
+    // everything else is opened down to direct softened sums over leaves.
+    Vector3 FieldAt(Vector3 p, float theta, float eps2) const {
+        Vector3 e = {0.0f, 0.0f, 0.0f};
+        if (nodes_.empty()) return e;
+        const float theta2 = theta * theta;
+        std::array<int, 8 * kMaxDepth + 8> stack{};
+        int top = 0;
+        stack[static_cast<size_t>(top++)] = 0;
+        while (top > 0) {
+            const ChargeNode& node = nodes_[static_cast<size_t>(stack[static_cast<size_t>(--top)])];
+            if (node.firstChild < 0) {
+                for (int k = node.begin; k < node.end; ++k) e = Vector3Add(e, ChargeField(charges_[static_cast<size_t>(k)], p, eps2));
+                continue;
+            }
+            const Vector3 r = Vector3Subtract(p, node.center);
+            const float r2 = Vector3DotProduct(r, r);
+            const float size = 2.0f * node.halfSize;
+            const bool inside = std::fabs(r.x) <= node.halfSize && std::fabs(r.y) <= node.halfSize && std::fabs(r.z) <= node.halfSize;
+            if (!inside && size * size < theta2 * r2) {
+                e = Vector3Add(e, Expansion(node, r, r2 + eps2));
+                continue;
+            }
+            for (int c = 0; c < 8; ++c) stack[static_cast<size_t>(top++)] = node.firstChild + c;
+        }
+        return e;
+    }
+
+    const std::vector<ChargeNode>& nodes() const { return nodes_; }
+
+  private:
+    // E = Q r/R^3 + (3 (p.r) r/R^5 - p/R^3) + (5/2 (r.Q.r) r/R^7 - Q.r/R^5), with the
+    // softening folded into R^2 so a cell matches the Plummer sum it replaces.
+    static Vector3 Expansion(const ChargeNode& n, Vector3 r, float r2) {
+        const float inv = 1.0f / std::sqrt(r2);
+        const float inv2 = inv * inv;
+        const float inv3 = inv * inv2;
+        const float inv5 = inv3 * inv2;
+        const float pr = Vector3DotProduct(n.dipole, r);
+        const std::array<float, 6>& q = n.quad;
+        const Vector3 qr = {q[0] * r.x + q[3] * r.y + q[4] * r.z, q[3] * r.x + q[1] * r.y + q[5] * r.z, q[4] * r.x + q[5] * r.y + q[2] * r.z};
+        const float rqr = Vector3DotProduct(r, qr);
+        const float radial = n.charge * inv3 + 3.0f * pr * inv5 + 2.5f * rqr * inv5 * inv2;
+        return {radial * r.x - n.dipole.x * inv3 - qr.x * inv5, radial * r.y - n.dipole.y * inv3 - qr.y * inv5,
+                radial * r.z - n.dipole.z * inv3 - qr.z * inv5};
+    }
+
+    void BuildNode(int index, int depth) {
+        ChargeNode node = nodes_[static_cast<size_t>(index)];
+        for (int k = node.begin; k < node.end; ++k) {
+            const PointCharge& c = charges_[static_cast<size_t>(k)];
+            const Vector3 d = Vector3Subtract(c.pos, node.center);
+            const float d2 = Vector3DotProduct(d, d);
+            node.charge += c.q;
+            node.dipole = Vector3Add(node.dipole, Vector3Scale(d, c.q));
+            node.quad[0] += c.q * (3.0f * d.x * d.x - d2);
+            node.quad[1] += c.q * (3.0f * d.y * d.y - d2);
+            node.quad[2] += c.q * (3.0f * d.z * d.z - d2);
+            node.quad[3] += c.q * 3.0f * d.x * d.y;
+            node.quad[4] += c.q * 3.0f * d.x * d.z;
+            node.quad[5] += c.q * 3.0f * d.y * d.z;
+        }
+        if (node.end - node.begin <= kLeafCapacity || depth >= kMaxDepth) {
+            nodes_[static_cast<size_t>(index)] = node;
+            return;
+        }
+
+        // Counting sort of the range into octants.
+        std::array<int, 9> start{};
+        const auto octant = [&](const PointCharge& c) {
+            return (c.pos.x >= node.center.x ? 1 : 0) | (c.pos.y >= node.center.y ? 2 : 0) | (c.pos.z >= node.center.z ? 4 : 0);
+        };
+        for (int k = node.begin; k < node.end; ++k) ++start[static_cast<size_t>(octant(charges_[static_cast<size_t>(k)]) + 1)];
+        start[0] = node.begin;
+        for (int o = 0; o < 8; ++o) start[static_cast<size_t>(o + 1)] += start[static_cast<size_t>(o)];
+        std::array<int, 8> fill{};
+        for (int o = 0; o < 8; ++o) fill[static_cast<size_t>(o)] = start[static_cast<size_t>(o)];
+        for (int k = node.begin; k < node.end; ++k) {
+            const PointCharge& c = charges_[static_cast<size_t>(k)];
+            scratch_[static_cast<size_t>(fill[static_cast<size_t>(octant(c))]++)] = c;
+        }
+        std::copy(scratch_.begin() + node.begin, scratch_.begin() + node.end, charges_.begin() + node.begin);
+
+        node.firstChild = static_cast<int>(nodes_.size());
+        nodes_[static_cast<size_t>(index)] = node;
+        const float h = 0.5f * node.halfSize;
+        for (int o = 0; o < 8; ++o) {
+            ChargeNode child{};
+            child.center = {node.center.x + ((o & 1) ? h : -h), node.center.y + ((o & 2) ? h : -h), node.center.z + ((o & 4) ? h : -h)};
+            child.halfSize = h;
+            child.begin = start[static_cast<size_t>(o)];
+            child.end = start[static_cast<size_t>(o + 1)];
+            nodes_.push_back(child);
+        }
+        for (int o = 0; o < 8; ++o) BuildNode(node.firstChild + o, depth + 1);
+    }
+
+    std::vector<ChargeNode> nodes_;
+    std::vector<PointCharge> charges_;  // tree order
+    std::vector<PointCharge> scratch_;
+};
+
+// Regular lattice of field sample points.
+struct FieldLatticeSpec {
+    Vector3 origin = {0.0f, 0.0f, 0.0f};  // first point
+    float spacing = 0.5f;
+    int nx = 1;
+    int ny = 1;
+    int nz = 1;
+};
+
+inline bool operator==(const FieldLatticeSpec& a, const FieldLatticeSpec& b) {
+    return a.spacing == b.spacing && a.nx == b.nx && a.ny == b.ny && a.nz == b.nz && a.origin.x == b.origin.x &&
+           a.origin.y == b.origin.y && a.origin.z == b.origin.z;
+}
+
+class FieldLattice {
+  public:
+    static constexpr int kDirectLimit = 256;    // below this many charges the tree is not worth building
+    static constexpr int kMaxDeltaCharges = 16; // more moved charges than this re-evaluate everything
+    static constexpr int kMaxDeltaUpdates = 64; // full re-evaluation after this many differences
+    static constexpr int kTreeWalkCost = 96;    // rough kernels per point of a tree evaluation
+
+    float softening2 = 0.08f;
+    float theta = 0.5f;
+
+    void SetLattice(const FieldLatticeSpec& spec) {
+        if (spec == spec_ && !points_.empty()) return;
+        spec_ = spec;
+        points_.clear();
+        for (int z = 0; z < spec.nz; ++z) {
+            for (int y = 0; y < spec.ny; ++y) {
+                for (int x = 0; x < spec.nx; ++x) {
+                    points_.push_back({spec.origin.x + spec.spacing * x, spec.origin.y + spec.spacing * y, spec.origin.z + spec.spacing * z});
+                }
+            }
+        }
+        field_.assign(points_.size(), {0.0f, 0.0f, 0.0f});
+        fullDirty_ = true;
+    }
+
+    // Records which charges differ from the last call; nothing is evaluated here.
+    void SetCharges(const std::vector<PointCharge>& charges) {
+        if (charges.size() != charges_.size()) {
+            charges_ = charges;
+            fullDirty_ = true;
+            moved_.clear();
+            return;
+        }
+        for (size_t i = 0; i < charges.size(); ++i) {
+            if (charges[i] == charges_[i]) continue;
+            if (std::find(moved_.begin(), moved_.end(), static_cast<int>(i)) == moved_.end()) {
+                moved_.push_back(static_cast<int>(i));
+                before_.push_back(evaluated_.size() == charges_.size() ? evaluated_[i] : charges_[i]);
+            }
+            charges_[i] = charges[i];
+        }
+    }
+
+    // Brings the cached field up to date; returns true if anything was re-evaluated.
+    bool Update() {
+        if (!fullDirty_ && moved_.empty()) return false;
+        const auto t0 = std::chrono::steady_clock::now();
+        const int n = static_cast<int>(charges_.size());
+        const int moved = static_cast<int>(moved_.size());
+        useTree_ = n >= kDirectLimit;
+        // A difference costs two kernels per moved charge against n (or a tree walk) per point.
+        const int fullCost = useTree_ ? kTreeWalkCost : n;
+        const bool delta = !fullDirty_ && moved <= kMaxDeltaCharges && 2 * moved < fullCost && deltaUpdates_ < kMaxDeltaUpdates;
+        if (useTree_) tree_.Build(charges_);
+
+        evaluated_ = charges_;
+        if (delta) {
+            Parallel([&](size_t i) {
+                Vector3 e = field_[i];
+                for (int m = 0; m < moved; ++m) {
+                    e = Vector3Subtract(e, ChargeField(before_[static_cast<size_t>(m)], points_[i], softening2));
+                    e = Vector3Add(e, ChargeField(charges_[static_cast<size_t>(moved_[static_cast<size_t>(m)])], points_[i], softening2));
+                }
+                field_[i] = e;
+            });
+            ++deltaUpdates_;
+        } else {
+            Parallel([&](size_t i) { field_[i] = FieldAt(points_[i]); });
+            deltaUpdates_ = 0;
+        }
+        moved_.clear();
+        before_.clear();
+        fullDirty_ = false;
+        ++version_;
+        lastMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        lastWasDelta_ = delta;
+        return true;
+    }
+
+    // Field anywhere from the charges as of the last Update().
+    Vector3 FieldAt(Vector3 p) const {
+        if (useTree_) return tree_.FieldAt(p, theta, softening2);
+        Vector3 e = {0.0f, 0.0f, 0.0f};
+        for (const PointCharge& c : evaluated_.empty() ? charges_ : evaluated_) e = Vector3Add(e, ChargeField(c, p, softening2));
+        return e;
+    }
+
+    size_t size() const { return points_.size(); }
+    Vector3 point(size_t i) const { return points_[i]; }
+    Vector3 field(size_t i) const { return field_[i]; }
+    const FieldLatticeSpec& spec() const { return spec_; }
+    // Bumped by every Update() that changed the field, so geometry built from it can be cached.
+    uint64_t version() const { return version_; }
+    float lastMs() const { return lastMs_; }
+    bool lastWasDelta() const { return lastWasDelta_; }
+    bool usingTree() const { return useTree_; }
+
+  private:
+    template <typename F>
+    void Parallel(F&& f) {
+        const int count = static_cast<int>(points_.size());
+        astro_parallel::SharedPool().ParallelFor(count, 128, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) f(static_cast<size_t>(i));
+        });
+    }
+
+    FieldLatticeSpec spec_;
+    std::vector<Vector3> points_;
+    std::vector<Vector3> field_;
+    std::vector<PointCharge> charges_;    // latest
+    std::vector<PointCharge> evaluated_;  // as of the last Update()
+    std::vector<int> moved_;
+    std::vector<PointCharge> before_;     // moved charges as evaluated
+    ChargeOctree tree_;
+    bool useTree_ = false;
+    bool fullDirty_ = true;
+    int deltaUpdates_ = 0;
+    uint64_t version_ = 0;
+    float lastMs_ = 0.0f;
+    bool lastWasDelta_ = false;
+};
+
+}  // namespace astro_efield
@@ -0,0 +1,453 @@
+#pragma once
+
+#include "fft.h"
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Matched-filter search for compact-binary inspirals in a simulated detector stream.
+//
+// StrainSource produces strain samples: coloured Gaussian noise (white plus an AR(1)
+// low-frequency wall, so the PSD is known in closed form) with Newtonian-order chirps
+// injected every few seconds at a chosen optimal SNR. ChirpSearch filters the stream
+// against a bank of the same chirps. It uses overlap-save blocks of `segment` samples.
+// Each block costs one forward FFT of the data, then one inverse FFT per template of
+//
+//   z_j = sum_{k > 0} D_k conj(H_k) / P_k exp(2 pi i j k / N),
+//
+// spread over the shared pool. Keeping only positive frequencies makes z the analytic
+// signal, so |z| maximises over the template's phase; with the bank pre-scaled by
+// sqrt(2) / sigma_t, |z| is the SNR (rho^2 averages 2 in pure noise). Each template
+// places its coalescence at the same offset, so every output sample is one coalescence
+// time for the whole bank. Filters and the FFT plan are built once in Configure().
+
+namespace astro_gw {
+
+using astro_fft::Complex;
+
+constexpr double kSolarMassSeconds = 4.925490947e-6;  // G M_sun / c^3
+constexpr double kPi = 3.14159265358979323846;
+
+struct SearchOptions {
+    int sampleRate = 4096;
+    int segment = 16384;           // overlap-save FFT length; grown to twice the longest template
+    int templates = 256;           // spaced uniformly in Newtonian chirp time
+    float fLow = 40.0f;            // Hz, where templates start
+    float minChirpMass = 8.0f;     // solar masses
+    float maxChirpMass = 30.0f;
+    float whiteSigma = 1.0f;       // per-sample noise, arbitrary strain units
+    float redGain = 0.1f;          // AR(1) innovation of the low-frequency noise
+    float redPole = 0.995f;
+    float threshold = 8.0f;        // trigger SNR
+    int snrDecimation = 32;        // samples per stored SNR value (max over the bin)
+    int history = 2048;            // stored SNR values
+    uint64_t seed = 20150914;
+};
+
+// Seconds from frequency f to coalescence at Newtonian order.
+inline double ChirpTime(double chirpMass, double f) {
+    const double m = chirpMass * kSolarMassSeconds;
+    return 5.0 / 256.0 * std::pow(m, -5.0 / 3.0) * std::pow(kPi * f, -8.0 / 3.0);
+}
+
+// Gravitational-wave frequency at the innermost stable circular orbit of an equal-mass
+// binary with this chirp mass (total mass 2^(6/5) Mc).
+inline double IscoFrequency(double chirpMass) {
+    const double total = std::pow(2.0, 1.2) * chirpMass * kSolarMassSeconds;
+    return 1.0 / (std::pow(6.0, 1.5) * kPi * total);
+}
+
+// Restricted Newtonian chirp h = f^(2/3) cos(phase - 2 (tau / 5 Mc)^(5/8)) from fLow to
+// the ISCO, tapered at both ends. The last sample is the coalescence; the peak is 1.
+inline void InspiralWaveform(double chirpMass, double fLow, double sampleRate, double phase, std::vector<float>* out) {
+    const double m = chirpMass * kSolarMassSeconds;
+    const double tauEnd = ChirpTime(chirpMass, IscoFrequency(chirpMass));
+    const double tauStart = ChirpTime(chirpMass, fLow);
+    const int n = std::max(2, static_cast<int>(std::ceil((tauStart - tauEnd) * sampleRate)) + 1);
+    out->resize(static_cast<size_t>(n));
+    const double fEnd = IscoFrequency(chirpMass);
+    const double amplitudeScale = std::pow(fEnd, -2.0 / 3.0);
+    const int headTaper = std::max(1, std::min(n / 4, static_cast<int>(4.0 * sampleRate / fLow)));
+    const int tailTaper = std::max(1, std::min(n / 8, static_cast<int>(sampleRate / fEnd)));
+    for (int i = 0; i < n; ++i) {
+        const double tau = tauEnd + static_cast<double>(n - 1 - i) / sampleRate;
+        const double f = std::pow(5.0 / (256.0 * tau), 0.375) * std::pow(m, -0.625) / kPi;
+        double w = std::pow(f, 2.0 / 3.0) * amplitudeScale;
+        if (i < headTaper) w *= 0.5 - 0.5 * std::cos(kPi * i / headTaper);
+        if (n - 1 - i < tailTaper) w *= 0.5 - 0.5 * std::cos(kPi * (n - 1 - i) / tailTaper);
+        (*out)[static_cast<size_t>(i)] = static_cast<float>(w * std::cos(phase - 2.0 * std::pow(tau / (5.0 * m), 0.625)));
+    }
+}
+
+// One-sided noise power per sample at angular frequency omega (rad / sample).
+inline double NoisePower(const SearchOptions& options, double omega) {
+    const double a = options.redPole;
+    return static_cast<double>(options.whiteSigma) * options.whiteSigma +
+           static_cast<double>(options.redGain) * options.redGain / (1.0 - 2.0 * a * std::cos(omega) + a * a);
+}
+
+// sigma^2 = sum_{k>0} |H_k|^2 / P_k of a waveform, zero-padded to `plan.size()`.
+inline double TemplateNorm(const SearchOptions& options, const std::vector<float>& wave, const astro_fft::Plan1D& plan,
+                           std::vector<Complex>* scratch) {
+    const int n = plan.size();
+    scratch->assign(static_cast<size_t>(n), Complex(0.0f, 0.0f));
+    for (size_t i = 0; i < wave.size() && i < static_cast<size_t>(n); ++i) (*scratch)[i] = Complex(wave[i], 0.0f);
+    plan.Forward(scratch->data());
+    double sum = 0.0;
+    for (int k = 1; k < n / 2; ++k) sum += std::norm((*scratch)[static_cast<size_t>(k)]) / (n * NoisePower(options, 2.0 * kPi * k / n));
+    return sum;
+}
+
+inline int NextPowerOfTwo(int n) {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Noise plus injected chirps, generated sample by sample so the stream is continuous
+// across calls.
+class StrainSource {
+  public:
+    struct Injection {
+        int64_t start = 0;
+        int64_t coalescence = 0;  // sample index of the last waveform sample
+        float chirpMass = 0.0f;
+        float snr = 0.0f;
+        std::vector<float> signal;  // scaled waveform
+    };
+
+    void Configure(const SearchOptions& options) {
+        options_ = options;
+        Reset();
+    }
+
+    void Reset() {
+        rng_ = astro_random::PhiloxStream(options_.seed, 0x57a1u);
+        red_ = 0.0f;
+        sample_ = 0;
+        injections_.clear();
+        ScheduleNext(static_cast<int64_t>(2.0 * options_.sampleRate));
+    }
+
+    // Appends `count` samples; `signalOut` (optional) receives the injected part alone.
+    void Generate(int count, float* out, float* signalOut = nullptr) {
+        const float white = options_.whiteSigma, gain = options_.redGain, pole = options_.redPole;
+        for (int i = 0; i < count; ++i) {
+            red_ = pole * red_ + gain * rng_.Normal();
+            out[i] = white * rng_.Normal() + red_;
+            if (signalOut) signalOut[i] = 0.0f;
+        }
+        const int64_t begin = sample_, end = sample_ + count;
+        while (nextStart_ < end) Inject();
+        for (const Injection& inj : injections_) {
+            const int64_t lo = std::max(begin, inj.start), hi = std::min(end, inj.coalescence + 1);
+            for (int64_t s = lo; s < hi; ++s) {
+                const float h = inj.signal[static_cast<size_t>(s - inj.start)];
+                out[s - begin] += h;
+                if (signalOut) signalOut[s - begin] += h;
+            }
+        }
+        sample_ = end;
+    }
+
+    int64_t sample() const { return sample_; }
+    const std::vector<Injection>& injections() const { return injections_; }
+
+    // Newest injection whose coalescence lies within `tolerance` samples of `sample`.
+    const Injection* InjectionNear(int64_t sample, int64_t tolerance) const {
+        for (auto it = injections_.rbegin(); it != injections_.rend(); ++it) {
+            if (std::llabs(it->coalescence - sample) <= tolerance) return &*it;
+        }
+        return nullptr;
+    }
+
+  private:
+    static constexpr size_t kKeptInjections = 16;
+
+    void ScheduleNext(int64_t after) {
+        nextStart_ = after;
+        nextMass_ = options_.minChirpMass * std::pow(options_.maxChirpMass / options_.minChirpMass, rng_.Uniform());
+    }
+
+    void Inject() {
+        Injection inj;
+        inj.chirpMass = nextMass_;
+        inj.snr = rng_.Uniform(9.0f, 24.0f);
+        InspiralWaveform(inj.chirpMass, options_.fLow, options_.sampleRate, rng_.Uniform(0.0f, 6.2831853f), &inj.signal);
+        plan_.Resize(NextPowerOfTwo(static_cast<int>(inj.signal.size()) * 2));
+        const double sigma = std::sqrt(TemplateNorm(options_, inj.signal, plan_, &scratch_));
+        const float scale = static_cast<float>(inj.snr / (std::sqrt(2.0) * std::max(sigma, 1.0e-30)));
+        for (float& h : inj.signal) h *= scale;
+        inj.start = nextStart_;
+        inj.coalescence = inj.start + static_cast<int64_t>(inj.signal.size()) - 1;
+        if (injections_.size() == kKeptInjections) injections_.erase(injections_.begin());
+        injections_.push_back(std::move(inj));
+        ScheduleNext(injections_.back().coalescence + static_cast<int64_t>(rng_.Uniform(3.0f, 8.0f) * options_.sampleRate));
+    }
+
+    SearchOptions options_;
+    astro_random::PhiloxStream rng_{0};
+    float red_ = 0.0f;
+    int64_t sample_ = 0;
+    int64_t nextStart_ = 0;
+    float nextMass_ = 10.0f;
+    std::vector<Injection> injections_;
+    astro_fft::Plan1D plan_;
+    std::vector<Complex> scratch_;
+};
+
+struct Trigger {
+    int64_t sample = 0;  // coalescence sample
+    float snr = 0.0f;
+    int templateIndex = 0;
+    float chirpMass = 0.0f;
+};
+
+class ChirpSearch {
+  public:
+    struct Template {
+        float chirpMass = 0.0f;
+        int length = 0;         // samples
+        int kHigh = 0;          // last stored frequency bin
+        std::vector<Complex> filter;  // sqrt(2) conj(H_k) / (P_k sigma), bins kLow..kHigh
+    };
+
+    void Configure(const SearchOptions& options) {
+        options_ = options;
+        const int count = std::max(1, options.templates);
+        // Uniform in tau0 = ChirpTime(Mc, fLow), which is close to uniform in match.
+        const double tauHi = ChirpTime(options.minChirpMass, options.fLow);
+        const double tauLo = ChirpTime(options.maxChirpMass, options.fLow);
+        std::vector<std::vector<float>> waves(static_cast<size_t>(count));
+        bank_.assign(static_cast<size_t>(count), Template{});
+        maxLength_ = 0;
+        for (int t = 0; t < count; ++t) {
+            const double tau = count == 1 ? tauHi : tauHi + (tauLo - tauHi) * t / (count - 1);
+            const double chirpMass = std::pow(5.0 / 256.0 * std::pow(kPi * options.fLow, -8.0 / 3.0) / tau, 0.6) / kSolarMassSeconds;
+            bank_[static_cast<size_t>(t)].chirpMass = static_cast<float>(chirpMass);
+            InspiralWaveform(chirpMass, options.fLow, options.sampleRate, 0.0, &waves[static_cast<size_t>(t)]);
+            bank_[static_cast<size_t>(t)].length = static_cast<int>(waves[static_cast<size_t>(t)].size());
+            maxLength_ = std::max(maxLength_, bank_[static_cast<size_t>(t)].length);
+        }
+        segment_ = NextPowerOfTwo(std::max(options.segment, 2 * maxLength_));
+        valid_ = segment_ - maxLength_ + 1;
+        plan_.Resize(segment_);
+        kLow_ = std::max(1, static_cast<int>(std::ceil(options.fLow * segment_ / options.sampleRate)) - 1);
+
+        std::vector<double> power(static_cast<size_t>(segment_ / 2));
+        for (int k = 0; k < segment_ / 2; ++k) power[static_cast<size_t>(k)] = segment_ * NoisePower(options, 2.0 * kPi * k / segment_);
+        astro_parallel::SharedPool().ParallelFor(count, 4, [&](int begin, int end) {
+            std::vector<Complex> spectrum(static_cast<size_t>(segment_));
+            for (int t = begin; t < end; ++t) {
+                Template& tmpl = bank_[static_cast<size_t>(t)];
+                const std::vector<float>& wave = waves[static_cast<size_t>(t)];
+                // Coalescence at maxLength_ - 1 for every template.
+                std::fill(spectrum.begin(), spectrum.end(), Complex(0.0f, 0.0f));
+                const int offset = maxLength_ - tmpl.length;
+                for (int i = 0; i < tmpl.length; ++i) spectrum[static_cast<size_t>(offset + i)] = Complex(wave[static_cast<size_t>(i)], 0.0f);
+                plan_.Forward(spectrum.data());
+                const double fCut = 2.0 * IscoFrequency(tmpl.chirpMass);
+                tmpl.kHigh = std::min(segment_ / 2 - 1, static_cast<int>(fCut * segment_ / options.sampleRate));
+                double sigma2 = 0.0;
+                for (int k = kLow_; k <= tmpl.kHigh; ++k) sigma2 += std::norm(spectrum[static_cast<size_t>(k)]) / power[static_cast<size_t>(k)];
+                const double scale = std::sqrt(2.0 / std::max(sigma2, 1.0e-300));
+                tmpl.filter.resize(static_cast<size_t>(tmpl.kHigh - kLow_ + 1));
+                for (int k = kLow_; k <= tmpl.kHigh; ++k) {
+                    const Complex h = std::conj(spectrum[static_cast<size_t>(k)]);
+                    tmpl.filter[static_cast<size_t>(k - kLow_)] = h * static_cast<float>(scale / power[static_cast<size_t>(k)]);
+                }
+            }
+        });
+
+        tasks_ = std::max(1, std::min(count, astro_parallel::SharedPool().size()));
+        lanes_.assign(static_cast<size_t>(tasks_), Lane{});
+        for (Lane& lane : lanes_) {
+            lane.scratch.resize(static_cast<size_t>(segment_));
+            lane.best.resize(static_cast<size_t>(valid_));
+            lane.index.resize(static_cast<size_t>(valid_));
+        }
+        data_.resize(static_cast<size_t>(segment_));
+        Reset();
+    }
+
+    void Reset() {
+        buffer_.clear();
+        bufferStart_ = 0;
+        snr_.assign(static_cast<size_t>(std::max(1, options_.history)), 0.0f);
+        snrTemplate_.assign(snr_.size(), -1);
+        snrCount_ = 0;
+        snrHead_ = 0;
+        binMax_ = 0.0f;
+        binTemplate_ = -1;
+        binFill_ = 0;
+        snrEndSample_ = maxLength_ - 1;
+        triggers_.clear();
+        open_ = false;
+        segments_ = 0;
+    }
+
+    // Appends strain samples and filters every complete overlap-save block.
+    void Push(const float* strain, int count) {
+        buffer_.insert(buffer_.end(), strain, strain + count);
+        while (static_cast<int>(buffer_.size()) >= segment_) {
+            ProcessSegment();
+            buffer_.erase(buffer_.begin(), buffer_.begin() + valid_);
+            bufferStart_ += valid_;
+        }
+    }
+
+    int templateCount() const { return static_cast<int>(bank_.size()); }
+    const Template& bankTemplate(int t) const { return bank_[static_cast<size_t>(t)]; }
+    int segment() const { return segment_; }
+    int validSamples() const { return valid_; }
+    int maxTemplateLength() const { return maxLength_; }
+    int64_t segmentsProcessed() const { return segments_; }
+    const SearchOptions& options() const { return options_; }
+
+    // Stored SNR values, k = 0 the newest; each is the bank maximum over snrDecimation
+    // coalescence samples ending at snrEndSample() - k * snrDecimation.
+    int snrCount() const { return snrCount_; }
+    float Snr(int k) const { return snr_[Slot(k)]; }
+    int SnrTemplate(int k) const { return snrTemplate_[Slot(k)]; }
+    int64_t snrEndSample() const { return snrEndSample_; }
+
+    // Closed clusters above threshold, oldest first (at most kMaxTriggers).
+    const std::vector<Trigger>& triggers() const { return triggers_; }
+
+  private:
+    static constexpr size_t kMaxTriggers = 64;
+
+    struct Lane {
+        std::vector<Complex> scratch;
+        std::vector<float> best;  // |z|^2
+        std::vector<int> index;
+    };
+
+    size_t Slot(int k) const {
+        const int n = static_cast<int>(snr_.size());
+        return static_cast<size_t>(((snrHead_ - 1 - k) % n + n) % n);
+    }
+
+    void ProcessSegment() {
+        for (int i = 0; i < segment_; ++i) data_[static_cast<size_t>(i)] = Complex(buffer_[static_cast<size_t>(i)], 0.0f);
+        plan_.Forward(data_.data());
+
+        const int count = templateCount();
+        astro_parallel::SharedPool().Run(tasks_, [&](int task) {
+            Lane& lane = lanes_[static_cast<size_t>(task)];
+            std::fill(lane.best.begin(), lane.best.end(), 0.0f);
+            std::fill(lane.index.begin(), lane.index.end(), 0);
+            const int first = count * task / tasks_, last = count * (task + 1) / tasks_;
+            for (int t = first; t < last; ++t) FilterTemplate(t, &lane);
+        });
+
+        for (int j = 0; j < valid_; ++j) {
+            float best = lanes_[0].best[static_cast<size_t>(j)];
+            int index = lanes_[0].index[static_cast<size_t>(j)];
+            for (int l = 1; l < tasks_; ++l) {
+                if (lanes_[static_cast<size_t>(l)].best[static_cast<size_t>(j)] > best) {
+                    best = lanes_[static_cast<size_t>(l)].best[static_cast<size_t>(j)];
+                    index = lanes_[static_cast<size_t>(l)].index[static_cast<size_t>(j)];
+                }
+            }
+            Accumulate(std::sqrt(best), index);
+        }
+        ++segments_;
+    }
+
+    void FilterTemplate(int t, Lane* lane) const {
+        const Template& tmpl = bank_[static_cast<size_t>(t)];
+        Complex* z = lane->scratch.data();
+        std::fill(z, z + kLow_, Complex(0.0f, 0.0f));
+        std::fill(z + tmpl.kHigh + 1, z + segment_, Complex(0.0f, 0.0f));
+        const float* d = reinterpret_cast<const float*>(data_.data() + kLow_);
+        const float* f = reinterpret_cast<const float*>(tmpl.filter.data());
+        float* out = reinterpret_cast<float*>(z + kLow_);
+        const int bins = tmpl.kHigh - kLow_ + 1;
+        for (int k = 0; k < bins; ++k) {
+            const float dr = d[2 * k], di = d[2 * k + 1], fr = f[2 * k], fi = f[2 * k + 1];
+            out[2 * k] = dr * fr - di * fi;
+            out[2 * k + 1] = dr * fi + di * fr;
+        }
+        plan_.Inverse(z);
+        const float* v = reinterpret_cast<const float*>(z);
+        float* best = lane->best.data();
+        int* index = lane->index.data();
+        for (int j = 0; j < valid_; ++j) {
+            const float m = v[2 * j] * v[2 * j] + v[2 * j + 1] * v[2 * j + 1];
+            const bool better = m > best[j];
+            best[j] = better ? m : best[j];
+            index[j] = better ? t : index[j];
+        }
+    }
+
+    // Folds one coalescence sample into the decimated SNR series and the trigger clusters.
+    void Accumulate(float snr, int templateIndex) {
+        if (snr > binMax_) {
+            binMax_ = snr;
+            binTemplate_ = templateIndex;
+        }
+        const int64_t sample = snrEndSample_ + binFill_;
+        if (snr >= options_.threshold) {
+            if (!open_ || snr > cluster_.snr) {
+                cluster_ = Trigger{sample, snr, templateIndex, bank_[static_cast<size_t>(templateIndex)].chirpMass};
+            }
+            open_ = true;
+            lastAbove_ = sample;
+        } else if (open_ && sample - lastAbove_ > kClusterGap * options_.sampleRate) {
+            CloseCluster();
+        }
+        if (++binFill_ < options_.snrDecimation) return;
+        snr_[static_cast<size_t>(snrHead_)] = binMax_;
+        snrTemplate_[static_cast<size_t>(snrHead_)] = binTemplate_;
+        snrHead_ = (snrHead_ + 1) % static_cast<int>(snr_.size());
+        snrCount_ = std::min(snrCount_ + 1, static_cast<int>(snr_.size()));
+        snrEndSample_ += binFill_;
+        binMax_ = 0.0f;
+        binTemplate_ = -1;
+        binFill_ = 0;
+    }
+
+    void CloseCluster() {
+        if (triggers_.size() == kMaxTriggers) triggers_.erase(triggers_.begin());
+        triggers_.push_back(cluster_);
+        open_ = false;
+    }
+
+    static constexpr double kClusterGap = 0.25;  // seconds below threshold that end a cluster
+
+    SearchOptions options_;
+    std::vector<Template> bank_;
+    astro_fft::Plan1D plan_;
+    int segment_ = 0;
+    int valid_ = 0;
+    int maxLength_ = 0;
+    int kLow_ = 1;
+    int tasks_ = 1;
+    std::vector<Lane> lanes_;
+    std::vector<Complex> data_;
+    std::vector<float> buffer_;
+    int64_t bufferStart_ = 0;
+    int64_t segments_ = 0;
+
+    std::vector<float> snr_;
+    std::vector<int> snrTemplate_;
+    int snrHead_ = 0;
+    int snrCount_ = 0;
+    float binMax_ = 0.0f;
+    int binTemplate_ = -1;
+    int binFill_ = 0;
+    int64_t snrEndSample_ = 0;
+
+    std::vector<Trigger> triggers_;
+    Trigger cluster_;
+    bool open_ = false;
+    int64_t lastAbove_ = 0;
+};
+
+}  // namespace astro_gw
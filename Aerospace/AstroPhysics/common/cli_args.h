@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+
+// "--name" / "--name=value" lookups shared by the headless bench runner and the offline
+// still renderer. Kept apart from headless_bench.h, which also replaces the global
+// allocation functions and so may only be included from a demo's main file.
+
+namespace astro_bench {
+
+// Value of a "--name=value" argument, or nullptr when absent.
+inline const char* FindArg(int argc, char** argv, const char* name) {
+    const size_t len = std::strlen(name);
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], name, len) == 0 && argv[i][len] == '=') return argv[i] + len + 1;
+    }
+    return nullptr;
+}
+
+inline bool HasFlag(int argc, char** argv, const char* name) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+inline int IntArg(int argc, char** argv, const char* name, int fallback) {
+    const char* value = FindArg(argc, argv, name);
+    return value != nullptr ? std::atoi(value) : fallback;
+}
+
+inline float FloatArg(int argc, char** argv, const char* name, float fallback) {
+    const char* value = FindArg(argc, argv, name);
+    return value != nullptr ? static_cast<float>(std::atof(value)) : fallback;
+}
+
+}  // namespace astro_bench
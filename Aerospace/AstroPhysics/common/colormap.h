@@ -0,0 +1,121 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <initializer_list>
+
+// Colour ramps baked once into 256-entry lookup tables, so a per-particle colour is an
+// index computation and a load instead of a chain of lerps. A map is built from colour
+// stops (piecewise linear; two stops at the same position make a hard edge) or by
+// sampling any function, over a domain that lookups clamp to:
+//
+//   const astro_color::Colormap kHeat = astro_color::Colormap::FromStops(
+//       {{0.0f, Color{214, 72, 30, 255}}, {1.0f, Color{255, 249, 228, 255}}});
+//   Color c = kHeat(particle.heat);
+//
+// LoadColormapTexture() uploads the same table as a 256x1 texture for shaders, which
+// read entry i at u = (i + 0.5) / 256; a domain-normalized value s in [0, 1] maps to
+// u = s * 255/256 + 0.5/256, so both ends land on texel centres.
+namespace astro_color {
+
+struct ColorStop {
+    float t;  // 0..1 across the map's domain
+    Color color;
+};
+
+class Colormap {
+  public:
+    static constexpr int kSize = 256;
+
+    Colormap() = default;
+
+    static Colormap FromStops(std::initializer_list<ColorStop> stops, float lo = 0.0f, float hi = 1.0f) {
+        Colormap map(lo, hi);
+        if (stops.size() == 0) return map;
+        const ColorStop* first = stops.begin();
+        const ColorStop* last = stops.end() - 1;
+        for (int i = 0; i < kSize; ++i) {
+            const float s = static_cast<float>(i) / (kSize - 1);
+            if (s <= first->t) {
+                map.lut_[i] = first->color;
+                continue;
+            }
+            if (s >= last->t) {
+                map.lut_[i] = last->color;
+                continue;
+            }
+            const ColorStop* a = first;
+            while (a + 1 < last && a[1].t < s) ++a;
+            const ColorStop* b = a + 1;
+            const float span = b->t - a->t;
+            map.lut_[i] = Mix(a->color, b->color, span > 0.0f ? (s - a->t) / span : 1.0f);
+        }
+        return map;
+    }
+
+    // `fn(x)` at kSize evenly spaced points of [lo, hi], endpoints included.
+    template <typename Fn>
+    static Colormap Bake(Fn&& fn, float lo = 0.0f, float hi = 1.0f) {
+        Colormap map(lo, hi);
+        for (int i = 0; i < kSize; ++i) {
+            map.lut_[i] = fn(lo + (hi - lo) * static_cast<float>(i) / (kSize - 1));
+        }
+        return map;
+    }
+
+    int Index(float x) const {
+        const float u = std::clamp((x - lo_) * scale_, 0.0f, static_cast<float>(kSize - 1));
+        return static_cast<int>(u + 0.5f);
+    }
+
+    Color operator()(float x) const { return lut_[Index(x)]; }
+
+    Color operator()(float x, float alpha) const {
+        Color c = lut_[Index(x)];
+        c.a = static_cast<unsigned char>(255.0f * std::clamp(alpha, 0.0f, 1.0f));
+        return c;
+    }
+
+    // Position across the domain, 0..1, for shaders sampling the texture.
+    float Normalized(float x) const { return std::clamp((x - lo_) * scale_ / (kSize - 1), 0.0f, 1.0f); }
+
+    const std::array<Color, kSize>& entries() const { return lut_; }
+    float lo() const { return lo_; }
+    float hi() const { return lo_ + (kSize - 1) / scale_; }
+
+  private:
+    Colormap(float lo, float hi) : lo_(lo), scale_((kSize - 1) / (hi != lo ? hi - lo : 1.0f)) {}
+
+    static Color Mix(Color a, Color b, float t) {
+        const auto channel = [t](unsigned char from, unsigned char to) {
+            return static_cast<unsigned char>(std::lround(from + (to - from) * t));
+        };
+        return Color{channel(a.r, b.r), channel(a.g, b.g), channel(a.b, b.b), channel(a.a, b.a)};
+    }
+
+    std::array<Color, kSize> lut_{};
+    float lo_ = 0.0f;
+    float scale_ = kSize - 1;
+};
+
+// The table as a 256x1 RGBA8 texture, bilinear and clamped. Needs a window; release
+// it with UnloadTexture() before CloseWindow().
+inline Texture2D LoadColormapTexture(const Colormap& map) {
+    Image image{};
+    image.data = const_cast<Color*>(map.entries().data());
+    image.width = Colormap::kSize;
+    image.height = 1;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    Texture2D texture = LoadTextureFromImage(image);
+    if (texture.id != 0) {
+        SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+        SetTextureWrap(texture, TEXTURE_WRAP_CLAMP);
+    }
+    return texture;
+}
+
+}  // namespace astro_color
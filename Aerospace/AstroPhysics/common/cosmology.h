@@ -0,0 +1,383 @@
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Friedmann-Lemaitre backgrounds for the cosmology demos. Units are Gyr and Gly, so
+// c = 1; comoving distances are normalised to a = 1 today.
+//
+// The expansion is integrated in conformal time eta, where the Friedmann equation
+// a'^2 = H0^2 (Or + Om a + Ok a^2 + OL a^4) differentiates to
+//
+//   a'' = H0^2 (Om / 2 + Ok a + 2 OL a^3),    dt / d eta = a,
+//
+// which is regular at the big bang (a = 0, a' = H0 sqrt(Or)) and runs straight through
+// a turnaround; a crunch ends the run. One run is resampled onto uniform
+// grids in t and in eta, so everything per frame is a linear interpolation: a(t), H(t)
+// and eta(t), and for light from comoving distance chi, a at eta(t) - chi gives the
+// redshift. Parameter sets whose Friedmann polynomial goes negative before a = 1 have
+// no big bang (they bounce); the run from a = 0 then recollapses and reachesToday is false.
+
+namespace astro_cosmo {
+
+constexpr double kPerGyrPerKmSMpc = 1.0227e-3;  // 1 km/s/Mpc in 1/Gyr
+
+struct CosmoParams {
+    float omegaM = 0.31f;
+    float omegaL = 0.69f;
+    float omegaR = 9.0e-5f;
+    float h0 = 67.7f;  // km/s/Mpc
+
+    float omegaK() const { return 1.0f - omegaM - omegaL - omegaR; }
+};
+
+class CosmoTable {
+  public:
+    static constexpr int kSamples = 4096;
+    static constexpr double kMaxScale = 12.0;   // the run stops here, or at a crunch
+    static constexpr double kMaxTime = 160.0;   // Gyr, for slowly coasting universes
+    static constexpr double kStepLogA = 0.004;  // RK4 step as a fraction of a / a'
+    static constexpr double kScaleFloor = 1.0e-4;
+
+    CosmoParams params;
+    double hubble0 = 0.0;      // H0 in 1/Gyr
+    double curvatureRadius = 0.0;  // Gly today; 0 when flat
+    int curvatureSign = 0;     // +1 open, -1 closed
+    bool reachesToday = false;
+    bool crunches = false;
+    double age = 0.0;          // Gyr at a = 1, or at the largest a if never reached
+    double horizon = 0.0;      // particle horizon today, Gly comoving
+    double endTime = 0.0;
+    double endEta = 0.0;
+    double maxScale = 0.0;
+
+    static CosmoTable Build(const CosmoParams& in);
+
+    double ScaleFactor(double t) const { return Sample(aOfT_, t, endTime); }
+    double ConformalTime(double t) const { return Sample(etaOfT_, t, endTime); }
+    double HubbleRate(double t) const { return Sample(hOfT_, t, endTime); }  // 1/Gyr
+    double Hubble(double t) const { return HubbleRate(t) / kPerGyrPerKmSMpc; }  // km/s/Mpc
+    double ScaleFactorAtConformal(double eta) const { return Sample(aOfEta_, eta, endEta); }
+    double TimeAtConformal(double eta) const { return Sample(tOfEta_, eta, endEta); }
+
+    // Comoving transverse distance S_k(chi) for the curvature.
+    double Transverse(double chi) const {
+        if (curvatureSign > 0) return curvatureRadius * std::sinh(chi / curvatureRadius);
+        if (curvatureSign < 0) return curvatureRadius * std::sin(chi / curvatureRadius);
+        return chi;
+    }
+
+    // Light reaching an observer at time t from comoving distance chi: the redshift, or
+    // infinity beyond the particle horizon. Negative during a collapse.
+    double Redshift(double t, double chi) const {
+        const double etaEmit = ConformalTime(t) - chi;
+        if (etaEmit <= 0.0) return std::numeric_limits<double>::infinity();
+        return ScaleFactor(t) / std::max(ScaleFactorAtConformal(etaEmit), 1.0e-12) - 1.0;
+    }
+
+    double LuminosityDistance(double t, double chi) const {
+        return (1.0 + Redshift(t, chi)) * ScaleFactor(t) * Transverse(chi);
+    }
+
+    // Per-frame batch for many sources seen from the origin at time t: redshift and
+    // luminosity distance (Gly) for each comoving distance, infinity past the horizon.
+    void Observe(double t, const float* chi, size_t count, float* z, float* luminosity) const {
+        const double aObs = ScaleFactor(t);
+        const double etaObs = ConformalTime(t);
+        const double invStep = static_cast<double>(kSamples - 1) / endEta;
+        const auto body = [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                const double etaEmit = etaObs - chi[i];
+                if (etaEmit <= 0.0) {
+                    z[i] = luminosity[i] = std::numeric_limits<float>::infinity();
+                    continue;
+                }
+                const double u = std::min(etaEmit * invStep, static_cast<double>(kSamples - 1));
+                const int k = std::min(static_cast<int>(u), kSamples - 2);
+                const double aEmit = aOfEta_[k] + (aOfEta_[k + 1] - aOfEta_[k]) * (u - k);
+                const double stretch = aObs / std::max(aEmit, 1.0e-12);
+                z[i] = static_cast<float>(stretch - 1.0);
+                luminosity[i] = static_cast<float>(stretch * aObs * Transverse(chi[i]));
+            }
+        };
+        const int n = static_cast<int>(count);
+        if (n >= 4 * kObserveChunk) {
+            astro_parallel::SharedPool().ParallelFor(n, kObserveChunk, body);
+        } else {
+            body(0, n);
+        }
+    }
+
+    // For an observer today: the comoving distance and lookback time (Gly, Gyr) to
+    // redshift z. Zero when the universe never reaches a = 1.
+    double ComovingDistance(double z) const { return reachesToday ? horizon - EtaAtScaleToday(1.0 / (1.0 + z)) : 0.0; }
+    double LookbackTime(double z) const { return reachesToday ? age - TimeAtConformal(EtaAtScaleToday(1.0 / (1.0 + z))) : 0.0; }
+
+    // Inverse of ComovingDistance: the redshift of light from chi reaching us today.
+    double RedshiftToday(double chi) const { return Redshift(age, chi); }
+
+  private:
+    static constexpr int kObserveChunk = 8192;
+
+    static double Sample(const std::vector<double>& y, double x, double span) {
+        const double u = std::clamp(x / span, 0.0, 1.0) * static_cast<double>(kSamples - 1);
+        const int k = std::min(static_cast<int>(u), kSamples - 2);
+        return y[k] + (y[k + 1] - y[k]) * (u - k);
+    }
+
+    // a(eta) rises monotonically up to today, so bisect the eta grid below the horizon.
+    double EtaAtScaleToday(double a) const {
+        const double step = endEta / static_cast<double>(kSamples - 1);
+        int lo = 0;
+        int hi = std::min(kSamples - 1, static_cast<int>(std::ceil(horizon / step)));
+        if (a <= aOfEta_[0]) return 0.0;
+        while (hi - lo > 1) {
+            const int mid = (lo + hi) / 2;
+            (aOfEta_[mid] < a ? lo : hi) = mid;
+        }
+        const double span = aOfEta_[hi] - aOfEta_[lo];
+        const double f = span > 0.0 ? std::clamp((a - aOfEta_[lo]) / span, 0.0, 1.0) : 0.0;
+        return std::min(horizon, (lo + f) * step);
+    }
+
+    std::vector<double> aOfT_, etaOfT_, hOfT_;
+    std::vector<double> aOfEta_, tOfEta_;
+};
+
+inline CosmoTable CosmoTable::Build(const CosmoParams& in) {
+    CosmoTable table;
+    CosmoParams p = in;
+    p.omegaR = std::max(0.0f, p.omegaR);
+    p.omegaM = std::max(p.omegaR > 0.0f ? 0.0f : 1.0e-3f, p.omegaM);  // a big bang needs matter or radiation
+    p.h0 = std::max(1.0f, p.h0);
+    table.params = p;
+
+    const double h0 = p.h0 * kPerGyrPerKmSMpc;
+    const double om = p.omegaM, ol = p.omegaL, og = p.omegaR, ok = p.omegaK();
+    table.hubble0 = h0;
+    if (std::fabs(ok) > 1.0e-5) {
+        table.curvatureSign = ok > 0.0 ? 1 : -1;
+        table.curvatureRadius = 1.0 / (h0 * std::sqrt(std::fabs(ok)));
+    }
+    const auto accel = [&](double a) { return h0 * h0 * (0.5 * om + ok * a + 2.0 * ol * a * a * a); };
+
+    // Raw run: (eta, a, a', t).
+    struct Raw {
+        double eta, a, v, t;
+    };
+    std::vector<Raw> raw;
+    raw.reserve(8192);
+    Raw s{0.0, 0.0, h0 * std::sqrt(og), 0.0};
+    raw.push_back(s);
+    const double stepMax = 0.02 / h0;
+    double todayEta = -1.0, todayTime = 0.0;
+    for (int iter = 0; iter < 1000000; ++iter) {
+        const double h = std::min(stepMax, kStepLogA * std::max(s.a, kScaleFloor) / std::max(std::fabs(s.v), 1.0e-12));
+        const double k1a = s.v, k1v = accel(s.a), k1t = s.a;
+        const double k2a = s.v + 0.5 * h * k1v, k2v = accel(s.a + 0.5 * h * k1a), k2t = s.a + 0.5 * h * k1a;
+        const double k3a = s.v + 0.5 * h * k2v, k3v = accel(s.a + 0.5 * h * k2a), k3t = s.a + 0.5 * h * k2a;
+        const double k4a = s.v + h * k3v, k4v = accel(s.a + h * k3a), k4t = s.a + h * k3a;
+        Raw n{s.eta + h, s.a + h / 6.0 * (k1a + 2.0 * k2a + 2.0 * k3a + k4a), s.v + h / 6.0 * (k1v + 2.0 * k2v + 2.0 * k3v + k4v),
+              s.t + h / 6.0 * (k1t + 2.0 * k2t + 2.0 * k3t + k4t)};
+        // Collapsing onto a = 0; without radiation a' vanishes there and the smooth
+        // solution would bounce, so the crunch is also the first minimum of a.
+        if (s.v < 0.0 && (n.a <= 0.0 || n.v >= 0.0)) {
+            const double f = n.a <= 0.0 ? s.a / (s.a - n.a) : 1.0;
+            n = {s.eta + f * h, 0.0, n.v, s.t + f * (n.t - s.t)};
+            raw.push_back(n);
+            table.crunches = true;
+            break;
+        }
+        if (todayEta < 0.0 && s.a < 1.0 && n.a >= 1.0) {
+            const double f = (1.0 - s.a) / (n.a - s.a);
+            todayEta = s.eta + f * h;
+            todayTime = s.t + f * (n.t - s.t);
+        }
+        raw.push_back(n);
+        s = n;
+        if (s.a >= kMaxScale || s.t >= kMaxTime) break;
+    }
+
+    table.reachesToday = todayEta >= 0.0;
+    size_t peak = 0;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i].a > raw[peak].a) peak = i;
+    }
+    table.maxScale = raw[peak].a;
+    table.age = table.reachesToday ? todayTime : raw[peak].t;
+    table.horizon = table.reachesToday ? todayEta : raw[peak].eta;
+    table.endTime = std::max(raw.back().t, 1.0e-6);
+    table.endEta = std::max(raw.back().eta, 1.0e-6);
+
+    // Both time coordinates increase along the run, so each grid is one forward walk.
+    const auto resample = [&](auto key, double span, std::vector<double>* a, std::vector<double>* other, std::vector<double>* rate,
+                              auto otherOf) {
+        a->resize(kSamples);
+        other->resize(kSamples);
+        if (rate != nullptr) rate->resize(kSamples);
+        size_t j = 0;
+        for (int k = 0; k < kSamples; ++k) {
+            const double x = span * static_cast<double>(k) / static_cast<double>(kSamples - 1);
+            while (j + 2 < raw.size() && key(raw[j + 1]) < x) ++j;
+            const Raw& r0 = raw[j];
+            const Raw& r1 = raw[j + 1];
+            const double d = key(r1) - key(r0);
+            const double f = d > 0.0 ? std::clamp((x - key(r0)) / d, 0.0, 1.0) : 0.0;
+            (*a)[k] = r0.a + f * (r1.a - r0.a);
+            (*other)[k] = otherOf(r0) + f * (otherOf(r1) - otherOf(r0));
+            if (rate != nullptr) {
+                const double v = r0.v + f * (r1.v - r0.v);
+                (*rate)[k] = v / std::max((*a)[k] * (*a)[k], 1.0e-12);
+            }
+        }
+    };
+    resample([](const Raw& r) { return r.t; }, table.endTime, &table.aOfT_, &table.etaOfT_, &table.hOfT_,
+             [](const Raw& r) { return r.eta; });
+    resample([](const Raw& r) { return r.eta; }, table.endEta, &table.aOfEta_, &table.tOfEta_, nullptr,
+             [](const Raw& r) { return r.t; });
+    return table;
+}
+
+// Background builder with the same shape as the other demo caches: Request() hands
+// parameters to a worker thread that builds (or recalls) the table, Acquire() swaps
+// the finished one in on the render thread. Requests coalesce, so holding a key to
+// sweep a parameter keeps only the latest set queued.
+class CosmologyCache {
+  public:
+    using Key = std::array<float, 4>;
+    static constexpr size_t kMemoSize = 16;
+
+    CosmologyCache() = default;
+    CosmologyCache(const CosmologyCache&) = delete;
+    CosmologyCache& operator=(const CosmologyCache&) = delete;
+    ~CosmologyCache() { Stop(); }
+
+    static Key KeyOf(const CosmoParams& p) { return {p.omegaM, p.omegaL, p.omegaR, p.h0}; }
+
+    void Request(const CosmoParams& params) {
+        const Key key = KeyOf(params);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (hasRequest_ && key == requestedKey_) return;
+            requestedKey_ = key;
+            hasRequest_ = true;
+            pendingParams_ = params;
+            pending_ = true;
+            stop_ = false;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!finished_) return false;
+        front_ = std::move(finished_);
+        return true;
+    }
+
+    // Builds on the calling thread (start-up), filling the memo too.
+    void BuildNow(const CosmoParams& params) {
+        std::shared_ptr<const CosmoTable> t = Lookup(KeyOf(params));
+        if (!t) {
+            t = std::make_shared<const CosmoTable>(CosmoTable::Build(params));
+            Remember(KeyOf(params), t);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        front_ = std::move(t);
+        requestedKey_ = KeyOf(params);
+        hasRequest_ = true;
+    }
+
+    bool Busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_ || building_;
+    }
+
+    // Nullptr until the first table lands.
+    const CosmoTable* table() const { return front_.get(); }
+    uint64_t built() const { return built_.load(); }
+    uint64_t memoHits() const { return memoHits_.load(); }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    std::shared_ptr<const CosmoTable> Lookup(const Key& key) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        for (size_t i = 0; i < memo_.size(); ++i) {
+            if (memo_[i].first != key) continue;
+            std::rotate(memo_.begin(), memo_.begin() + static_cast<std::ptrdiff_t>(i), memo_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            ++memoHits_;
+            return memo_.front().second;
+        }
+        return nullptr;
+    }
+
+    void Remember(const Key& key, std::shared_ptr<const CosmoTable> t) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        if (memo_.size() == kMemoSize) memo_.pop_back();
+        memo_.insert(memo_.begin(), {key, std::move(t)});
+        ++built_;
+    }
+
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            const CosmoParams params = pendingParams_;
+            pending_ = false;
+            building_ = true;
+            lock.unlock();
+
+            std::shared_ptr<const CosmoTable> t = Lookup(KeyOf(params));
+            if (!t) {
+                t = std::make_shared<const CosmoTable>(CosmoTable::Build(params));
+                Remember(KeyOf(params), t);
+            }
+
+            lock.lock();
+            finished_ = std::move(t);
+            building_ = false;
+        }
+    }
+
+    std::shared_ptr<const CosmoTable> front_;
+    std::shared_ptr<const CosmoTable> finished_;
+    Key requestedKey_{};
+    bool hasRequest_ = false;
+    CosmoParams pendingParams_{};
+
+    std::vector<std::pair<Key, std::shared_ptr<const CosmoTable>>> memo_;
+    std::mutex memoMutex_;
+    std::atomic<uint64_t> built_{0};
+    std::atomic<uint64_t> memoHits_{0};
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool pending_ = false;
+    bool building_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_cosmo
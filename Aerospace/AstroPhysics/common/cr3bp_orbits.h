@@ -0,0 +1,568 @@
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Periodic orbits of the circular restricted three-body problem about the collinear
+// points L1 and L2: planar Lyapunov orbits and the (northern) halo orbits that branch
+// from them.
+//
+// Synodic frame, unit separation and angular rate: the primaries 1 - mu and mu sit at
+// x = -mu and x = 1 - mu, z is out of the orbital plane, and
+//
+//   x'' = 2 y' + Wx,   y'' = -2 x' + Wy,   z'' = Wz,
+//   W = (x^2 + y^2) / 2 + (1 - mu) / r1 + mu / r2,
+//
+// with both distances softened by `softening` so a demo can match its own field. Each
+// orbit here is symmetric about the x-z plane, so it starts on y = 0 with x' = z' = 0
+// and is periodic when it crosses y = 0 again the same way. Single shooting integrates
+// the state with its 6x6 state-transition matrix to that crossing and Newton-corrects
+// the free initial values (y' for Lyapunov orbits at fixed x, x and y' for halos at
+// fixed z) until x' and z' vanish there.
+//
+// Families are followed by natural-parameter continuation: a batch of the next few
+// amplitudes, predicted by the secant through the last two orbits, is corrected in
+// parallel, and the step halves when a correction fails. The halo family starts where
+// the vertical stability index of the Lyapunov family crosses 1, which is where it
+// branches off.
+
+namespace astro_cr3bp {
+
+struct System {
+    double mu = 0.01215;
+    double softening = 0.0;
+};
+
+using State = std::array<double, 6>;
+using StateStm = std::array<double, 42>;  // state, then the STM row-major
+
+enum class FamilyKind { kLyapunov, kHalo };
+
+struct PeriodicOrbit {
+    State state{};           // at the y = 0 crossing with x' = z' = 0
+    double amplitude = 0.0;  // continuation parameter: x offset from L (Lyapunov) or z (halo)
+    double period = 0.0;
+    double jacobi = 0.0;
+    double stability = 0.0;  // largest stability index |nu|; 1 or less is linearly stable
+    double vertical = 0.0;   // planar orbits: vertical index, crossing 1 at the halo branch
+};
+
+struct PathPoint {
+    float x, y, z;
+};
+
+struct OrbitFamily {
+    FamilyKind kind = FamilyKind::kLyapunov;
+    int point = 1;
+    std::vector<PeriodicOrbit> members;
+    std::vector<std::vector<PathPoint>> paths;  // one closed orbit per member, uniform in time
+};
+
+constexpr double kStep = 2.0e-3;
+constexpr double kMaxHalfPeriod = 8.0;
+constexpr double kTolerance = 1.0e-10;
+constexpr int kMaxIterations = 24;
+constexpr int kFamilyMembers = 48;
+constexpr int kPathSamples = 240;
+constexpr double kMinPrimaryDistance = 0.06;
+
+// Gradient and Hessian of W at p.
+inline void Potential(const System& sys, const double p[3], double grad[3], double hess[3][3]) {
+    const double eps2 = sys.softening * sys.softening;
+    const double masses[2] = {1.0 - sys.mu, sys.mu};
+    const double centres[2] = {-sys.mu, 1.0 - sys.mu};
+    grad[0] = p[0];
+    grad[1] = p[1];
+    grad[2] = 0.0;
+    if (hess) {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) hess[i][j] = 0.0;
+        hess[0][0] = hess[1][1] = 1.0;
+    }
+    for (int b = 0; b < 2; ++b) {
+        const double d[3] = {p[0] - centres[b], p[1], p[2]};
+        const double r2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + eps2;
+        const double inv3 = masses[b] / (r2 * std::sqrt(r2));
+        for (int i = 0; i < 3; ++i) grad[i] -= inv3 * d[i];
+        if (!hess) continue;
+        const double inv5 = 3.0 * inv3 / r2;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) hess[i][j] += inv5 * d[i] * d[j] - (i == j ? inv3 : 0.0);
+        }
+    }
+}
+
+inline void Derivative(const System& sys, const double* s, double* d) {
+    double grad[3];
+    Potential(sys, s, grad, nullptr);
+    d[0] = s[3];
+    d[1] = s[4];
+    d[2] = s[5];
+    d[3] = 2.0 * s[4] + grad[0];
+    d[4] = -2.0 * s[3] + grad[1];
+    d[5] = grad[2];
+}
+
+// State and STM together: Phi' = A Phi with A = [0 I; H K], K the Coriolis block.
+inline void DerivativeWithStm(const System& sys, const double* s, double* d) {
+    double grad[3], hess[3][3];
+    Potential(sys, s, grad, hess);
+    d[0] = s[3];
+    d[1] = s[4];
+    d[2] = s[5];
+    d[3] = 2.0 * s[4] + grad[0];
+    d[4] = -2.0 * s[3] + grad[1];
+    d[5] = grad[2];
+    const double* phi = s + 6;
+    double* dphi = d + 6;
+    for (int j = 0; j < 6; ++j) {
+        for (int i = 0; i < 3; ++i) dphi[i * 6 + j] = phi[(i + 3) * 6 + j];
+        for (int i = 0; i < 3; ++i) {
+            dphi[(i + 3) * 6 + j] = hess[i][0] * phi[j] + hess[i][1] * phi[6 + j] + hess[i][2] * phi[12 + j];
+        }
+        dphi[3 * 6 + j] += 2.0 * phi[4 * 6 + j];
+        dphi[4 * 6 + j] -= 2.0 * phi[3 * 6 + j];
+    }
+}
+
+template <size_t N, typename Deriv>
+void Rk4(const System& sys, std::array<double, N>* s, double h, Deriv deriv) {
+    std::array<double, N> k1, k2, k3, k4, t;
+    deriv(sys, s->data(), k1.data());
+    for (size_t i = 0; i < N; ++i) t[i] = (*s)[i] + 0.5 * h * k1[i];
+    deriv(sys, t.data(), k2.data());
+    for (size_t i = 0; i < N; ++i) t[i] = (*s)[i] + 0.5 * h * k2[i];
+    deriv(sys, t.data(), k3.data());
+    for (size_t i = 0; i < N; ++i) t[i] = (*s)[i] + h * k3[i];
+    deriv(sys, t.data(), k4.data());
+    for (size_t i = 0; i < N; ++i) (*s)[i] += h / 6.0 * (k1[i] + 2.0 * (k2[i] + k3[i]) + k4[i]);
+}
+
+inline double Jacobi(const System& sys, const State& s) {
+    const double eps2 = sys.softening * sys.softening;
+    const double r1 = std::sqrt((s[0] + sys.mu) * (s[0] + sys.mu) + s[1] * s[1] + s[2] * s[2] + eps2);
+    const double r2 = std::sqrt((s[0] - 1.0 + sys.mu) * (s[0] - 1.0 + sys.mu) + s[1] * s[1] + s[2] * s[2] + eps2);
+    const double w = 0.5 * (s[0] * s[0] + s[1] * s[1]) + (1.0 - sys.mu) / r1 + sys.mu / r2;
+    return 2.0 * w - (s[3] * s[3] + s[4] * s[4] + s[5] * s[5]);
+}
+
+// x of L1 (between the primaries), L2 (beyond the smaller one) or L3, by bisection.
+inline double CollinearPoint(const System& sys, int which) {
+    auto wx = [&](double x) {
+        const double p[3] = {x, 0.0, 0.0};
+        double grad[3];
+        Potential(sys, p, grad, nullptr);
+        return grad[0];
+    };
+    double lo = which == 1 ? -sys.mu + 1.0e-3 : which == 2 ? 1.0 - sys.mu + 1.0e-3 : -3.0;
+    double hi = which == 1 ? 1.0 - sys.mu - 1.0e-3 : which == 2 ? 3.0 : -sys.mu - 1.0e-3;
+    double fLo = wx(lo);
+    for (int i = 0; i < 100; ++i) {
+        const double mid = 0.5 * (lo + hi);
+        const double fMid = wx(mid);
+        if (fLo * fMid <= 0.0) {
+            hi = mid;
+        } else {
+            lo = mid;
+            fLo = fMid;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+inline StateStm WithIdentity(const State& s) {
+    StateStm out{};
+    std::copy(s.begin(), s.end(), out.begin());
+    for (int i = 0; i < 6; ++i) out[6 + i * 7] = 1.0;
+    return out;
+}
+
+// Integrates state + STM from s0 to its next y = 0 crossing (refined by Newton on the
+// step length). False if there is none within kMaxHalfPeriod or the path grazes a
+// primary.
+inline bool ShootHalf(const System& sys, const State& s0, StateStm* out, double* halfPeriod) {
+    StateStm s = WithIdentity(s0);
+    double t = 0.0;
+    while (t < kMaxHalfPeriod) {
+        const StateStm prev = s;
+        Rk4(sys, &s, kStep, DerivativeWithStm);
+        t += kStep;
+        const double d1 = std::hypot(std::hypot(s[0] + sys.mu, s[1]), s[2]);
+        const double d2 = std::hypot(std::hypot(s[0] - 1.0 + sys.mu, s[1]), s[2]);
+        if (std::min(d1, d2) < kMinPrimaryDistance) return false;
+        if (t > 1.5 * kStep && prev[1] * s[1] < 0.0) {
+            double dt = -prev[1] / prev[4];
+            for (int it = 0; it < 4; ++it) {
+                s = prev;
+                Rk4(sys, &s, dt, DerivativeWithStm);
+                dt -= s[1] / s[4];
+            }
+            s = prev;
+            Rk4(sys, &s, dt, DerivativeWithStm);
+            *out = s;
+            *halfPeriod = t - kStep + dt;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Newton on the free initial values; orbit->state is the guess and orbit->amplitude is
+// unused here. Fills period and Jacobi constant on success.
+inline bool Correct(const System& sys, FamilyKind kind, PeriodicOrbit* orbit) {
+    State s0 = orbit->state;
+    s0[1] = s0[3] = s0[5] = 0.0;
+    if (kind == FamilyKind::kLyapunov) s0[2] = 0.0;
+    for (int it = 0; it < kMaxIterations; ++it) {
+        StateStm f;
+        double half = 0.0;
+        if (!ShootHalf(sys, s0, &f, &half)) return false;
+        double acc[6];
+        Derivative(sys, f.data(), acc);
+        const double* phi = f.data() + 6;
+        auto p = [&](int i, int j) { return phi[i * 6 + j]; };
+        const double vy = f[4];
+        if (std::fabs(f[3]) < kTolerance && (kind == FamilyKind::kLyapunov || std::fabs(f[5]) < kTolerance)) {
+            orbit->state = s0;
+            orbit->period = 2.0 * half;
+            orbit->jacobi = Jacobi(sys, s0);
+            return true;
+        }
+        if (kind == FamilyKind::kLyapunov) {
+            const double slope = p(3, 4) - acc[3] * p(1, 4) / vy;
+            if (std::fabs(slope) < 1.0e-14) return false;
+            s0[4] -= f[3] / slope;
+        } else {
+            const double a = p(3, 0) - acc[3] * p(1, 0) / vy, b = p(3, 4) - acc[3] * p(1, 4) / vy;
+            const double c = p(5, 0) - acc[5] * p(1, 0) / vy, d = p(5, 4) - acc[5] * p(1, 4) / vy;
+            const double det = a * d - b * c;
+            if (std::fabs(det) < 1.0e-14) return false;
+            const double dx = (-f[3] * d + f[5] * b) / det;
+            const double dvy = (-a * f[5] + c * f[3]) / det;
+            const double scale = std::min(1.0, 0.05 / std::max(std::fabs(dx), 1.0e-30));
+            s0[0] += dx * scale;
+            s0[4] += dvy * scale;
+        }
+    }
+    return false;
+}
+
+// Stability indices from the monodromy matrix over one full period. Its eigenvalues are
+// 1, 1, l1, 1/l1, l2, 1/l2, so the trace and the sum of principal 2x2 minors give
+// l1 + 1/l1 and l2 + 1/l2 as the roots of a quadratic.
+inline void Classify(const System& sys, PeriodicOrbit* orbit) {
+    const int steps = std::max(1, static_cast<int>(std::ceil(orbit->period / kStep)));
+    const double h = orbit->period / steps;
+    StateStm s = WithIdentity(orbit->state);
+    for (int i = 0; i < steps; ++i) Rk4(sys, &s, h, DerivativeWithStm);
+    const double* m = s.data() + 6;
+    double trace = 0.0, trace2 = 0.0;
+    for (int i = 0; i < 6; ++i) {
+        trace += m[i * 7];
+        for (int k = 0; k < 6; ++k) trace2 += m[i * 6 + k] * m[k * 6 + i];
+    }
+    const double sum = trace - 2.0;
+    const double product = 0.5 * (trace * trace - trace2) - 3.0 - 2.0 * sum;
+    const double disc = sum * sum - 4.0 * product;
+    if (disc >= 0.0) {
+        const double root = std::sqrt(disc);
+        orbit->stability = 0.25 * std::max(std::fabs(sum + root), std::fabs(sum - root));
+    } else {
+        orbit->stability = 0.5 * std::sqrt(std::fabs(product));
+    }
+    orbit->vertical = 0.5 * (m[2 * 7] + m[5 * 7]);
+}
+
+inline std::vector<PathPoint> TracePath(const System& sys, const PeriodicOrbit& orbit) {
+    std::vector<PathPoint> path;
+    path.reserve(kPathSamples + 1);
+    const double dt = orbit.period / kPathSamples;
+    const int sub = std::max(1, static_cast<int>(std::ceil(dt / kStep)));
+    State s = orbit.state;
+    path.push_back({static_cast<float>(s[0]), static_cast<float>(s[1]), static_cast<float>(s[2])});
+    for (int i = 0; i < kPathSamples; ++i) {
+        for (int k = 0; k < sub; ++k) Rk4(sys, &s, dt / sub, Derivative);
+        path.push_back({static_cast<float>(s[0]), static_cast<float>(s[1]), static_cast<float>(s[2])});
+    }
+    return path;
+}
+
+// Natural-parameter continuation from the last two members (already corrected) in
+// steps of `step` until kFamilyMembers, a failed step smaller than step / 8, or the end
+// of the amplitude range.
+inline void Continue(const System& sys, FamilyKind kind, double xL, double step, double maxAmplitude,
+                     astro_parallel::ThreadPool& pool, std::vector<PeriodicOrbit>* members) {
+    const int batch = std::clamp(pool.size(), 2, 8);
+    const double minStep = step / 8.0;
+    std::vector<PeriodicOrbit> trial(static_cast<size_t>(batch));
+    std::vector<char> ok(static_cast<size_t>(batch));
+    while (static_cast<int>(members->size()) < kFamilyMembers && step >= minStep) {
+        const PeriodicOrbit& last = members->back();
+        const PeriodicOrbit& before = (*members)[members->size() - 2];
+        const double span = last.amplitude - before.amplitude;
+        for (int j = 0; j < batch; ++j) {
+            PeriodicOrbit& guess = trial[static_cast<size_t>(j)];
+            guess.amplitude = last.amplitude + step * (j + 1);
+            const double f = (guess.amplitude - last.amplitude) / span;
+            for (int k = 0; k < 6; ++k) guess.state[k] = last.state[k] + f * (last.state[k] - before.state[k]);
+            if (kind == FamilyKind::kLyapunov) {
+                guess.state[0] = xL - guess.amplitude;
+            } else {
+                guess.state[2] = guess.amplitude;
+            }
+        }
+        pool.ParallelFor(batch, 1, [&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                ok[static_cast<size_t>(j)] = trial[static_cast<size_t>(j)].amplitude <= maxAmplitude &&
+                                              Correct(sys, kind, &trial[static_cast<size_t>(j)]);
+            }
+        });
+        int accepted = 0;
+        while (accepted < batch && ok[static_cast<size_t>(accepted)] && static_cast<int>(members->size()) < kFamilyMembers) {
+            members->push_back(trial[static_cast<size_t>(accepted)]);
+            ++accepted;
+        }
+        if (accepted < batch && static_cast<int>(members->size()) < kFamilyMembers) {
+            if (trial[static_cast<size_t>(accepted)].amplitude > maxAmplitude) break;
+            step *= 0.5;
+        }
+    }
+}
+
+// Lyapunov family about L1 or L2, seeded from the linearised in-plane oscillation
+// x = xL - A cos(w t), y = k A sin(w t).
+inline OrbitFamily LyapunovFamily(const System& sys, int point, astro_parallel::ThreadPool& pool) {
+    OrbitFamily family;
+    family.kind = FamilyKind::kLyapunov;
+    family.point = point;
+    const double xL = CollinearPoint(sys, point);
+    const double p[3] = {xL, 0.0, 0.0};
+    double grad[3], hess[3][3];
+    Potential(sys, p, grad, hess);
+    const double a = hess[0][0], b = hess[1][1];
+    const double beta = 4.0 - a - b;
+    const double w = std::sqrt(0.5 * (beta + std::sqrt(beta * beta - 4.0 * a * b)));
+    const double k = (w * w + a) / (2.0 * w);
+    const double gap = std::fabs(xL - (1.0 - sys.mu));
+    const double maxAmplitude = 0.9 * gap;
+    const double step = maxAmplitude / kFamilyMembers;
+
+    for (double amplitude : {0.5 * step, 1.5 * step}) {
+        PeriodicOrbit seed;
+        seed.amplitude = amplitude;
+        seed.state = {xL - amplitude, 0.0, 0.0, 0.0, k * amplitude * w, 0.0};
+        if (!Correct(sys, FamilyKind::kLyapunov, &seed)) return family;
+        family.members.push_back(seed);
+    }
+    Continue(sys, FamilyKind::kLyapunov, xL, step, maxAmplitude, pool, &family.members);
+    return family;
+}
+
+// Halo family branching from `lyapunov` where its vertical index crosses 1. The
+// Lyapunov members must already be classified.
+inline OrbitFamily HaloFamily(const System& sys, const OrbitFamily& lyapunov, astro_parallel::ThreadPool& pool) {
+    OrbitFamily family;
+    family.kind = FamilyKind::kHalo;
+    family.point = lyapunov.point;
+    const std::vector<PeriodicOrbit>& ly = lyapunov.members;
+    size_t branch = 0;
+    while (branch + 1 < ly.size() && (ly[branch].vertical - 1.0) * (ly[branch + 1].vertical - 1.0) > 0.0) ++branch;
+    if (branch + 1 >= ly.size()) return family;
+
+    const PeriodicOrbit& lo = ly[branch];
+    const PeriodicOrbit& hi = ly[branch + 1];
+    const double f = (1.0 - lo.vertical) / (hi.vertical - lo.vertical);
+    PeriodicOrbit bifurcation;
+    for (int k = 0; k < 6; ++k) bifurcation.state[k] = lo.state[k] + f * (hi.state[k] - lo.state[k]);
+    if (!Correct(sys, FamilyKind::kLyapunov, &bifurcation)) bifurcation = lo;
+
+    const double xL = CollinearPoint(sys, lyapunov.point);
+    const double maxAmplitude = 1.2 * std::fabs(xL - (1.0 - sys.mu));
+    const double step = maxAmplitude / kFamilyMembers;
+    // A halo's x shifts with z^2 off the branch point, so each seed starts from the one before.
+    PeriodicOrbit seed = bifurcation;
+    for (double amplitude : {0.5 * step, 1.5 * step}) {
+        seed.amplitude = amplitude;
+        seed.state[2] = amplitude;
+        if (!Correct(sys, FamilyKind::kHalo, &seed)) return family;
+        family.members.push_back(seed);
+    }
+    Continue(sys, FamilyKind::kHalo, xL, step, maxAmplitude, pool, &family.members);
+    return family;
+}
+
+inline void Finish(const System& sys, OrbitFamily* family, astro_parallel::ThreadPool& pool) {
+    family->paths.assign(family->members.size(), {});
+    pool.ParallelFor(static_cast<int>(family->members.size()), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            Classify(sys, &family->members[static_cast<size_t>(i)]);
+            family->paths[static_cast<size_t>(i)] = TracePath(sys, family->members[static_cast<size_t>(i)]);
+        }
+    });
+}
+
+// The four families in order: L1 Lyapunov, L1 halo, L2 Lyapunov, L2 halo. Any may be
+// empty when continuation cannot start (a halo family needs its branch point inside
+// the traced part of the Lyapunov family).
+struct FamilySet {
+    System system;
+    std::array<OrbitFamily, 4> families;
+};
+
+inline FamilySet BuildFamilies(const System& sys, astro_parallel::ThreadPool& pool) {
+    FamilySet set;
+    set.system = sys;
+    for (int point = 1; point <= 2; ++point) {
+        OrbitFamily& lyapunov = set.families[static_cast<size_t>(2 * (point - 1))];
+        lyapunov = LyapunovFamily(sys, point, pool);
+        Finish(sys, &lyapunov, pool);
+        OrbitFamily& halo = set.families[static_cast<size_t>(2 * (point - 1) + 1)];
+        halo = HaloFamily(sys, lyapunov, pool);
+        Finish(sys, &halo, pool);
+    }
+    return set;
+}
+
+// Family builder with a small memo of recent systems, answered on a worker thread with
+// its own pool (the shared one is not reentrant and the render thread may be using it).
+// Request() queues a system, replacing any request not yet started; Acquire() swaps in
+// the newest finished set. Both belong to the render thread.
+class FamilyCache {
+  public:
+    using Key = std::array<double, 2>;
+    static constexpr size_t kMemoSize = 16;
+
+    FamilyCache() = default;
+    FamilyCache(const FamilyCache&) = delete;
+    FamilyCache& operator=(const FamilyCache&) = delete;
+    ~FamilyCache() { Stop(); }
+
+    static Key KeyOf(const System& s) { return {s.mu, s.softening}; }
+
+    void Request(const System& sys) {
+        const Key key = KeyOf(sys);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (hasRequest_ && key == requestedKey_) return;
+            requestedKey_ = key;
+            hasRequest_ = true;
+            pendingSystem_ = sys;
+            pending_ = true;
+            stop_ = false;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!finished_) return false;
+        front_ = std::move(finished_);
+        return true;
+    }
+
+    // Builds on the calling thread, filling the memo too.
+    void BuildNow(const System& sys) {
+        std::shared_ptr<const FamilySet> set = Lookup(KeyOf(sys));
+        if (!set) {
+            set = std::make_shared<const FamilySet>(BuildFamilies(sys, pool_));
+            Remember(KeyOf(sys), set);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        front_ = std::move(set);
+        requestedKey_ = KeyOf(sys);
+        hasRequest_ = true;
+    }
+
+    bool Busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_ || building_;
+    }
+
+    // Nullptr until the first set lands.
+    const FamilySet* families() const { return front_.get(); }
+    uint64_t built() const { return built_.load(); }
+    uint64_t memoHits() const { return memoHits_.load(); }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    std::shared_ptr<const FamilySet> Lookup(const Key& key) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        for (size_t i = 0; i < memo_.size(); ++i) {
+            if (memo_[i].first != key) continue;
+            std::rotate(memo_.begin(), memo_.begin() + static_cast<std::ptrdiff_t>(i), memo_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            ++memoHits_;
+            return memo_.front().second;
+        }
+        return nullptr;
+    }
+
+    void Remember(const Key& key, std::shared_ptr<const FamilySet> set) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        if (memo_.size() == kMemoSize) memo_.pop_back();
+        memo_.insert(memo_.begin(), {key, std::move(set)});
+        ++built_;
+    }
+
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            const System sys = pendingSystem_;
+            pending_ = false;
+            building_ = true;
+            lock.unlock();
+
+            std::shared_ptr<const FamilySet> set = Lookup(KeyOf(sys));
+            if (!set) {
+                set = std::make_shared<const FamilySet>(BuildFamilies(sys, pool_));
+                Remember(KeyOf(sys), set);
+            }
+
+            lock.lock();
+            finished_ = std::move(set);
+            building_ = false;
+        }
+    }
+
+    astro_parallel::ThreadPool pool_;
+    std::shared_ptr<const FamilySet> front_;
+    std::shared_ptr<const FamilySet> finished_;
+    Key requestedKey_{};
+    bool hasRequest_ = false;
+    System pendingSystem_{};
+
+    std::vector<std::pair<Key, std::shared_ptr<const FamilySet>>> memo_;
+    std::mutex memoMutex_;
+    std::atomic<uint64_t> built_{0};
+    std::atomic<uint64_t> memoHits_{0};
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool pending_ = false;
+    bool building_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_cr3bp
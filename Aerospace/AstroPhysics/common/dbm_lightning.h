@@ -0,0 +1,364 @@
+#pragma once
+
+#include "philox.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Dielectric-breakdown-model (Niemeyer, Pietronero & Wiesmann 1984) lightning trees.
+//
+// The discharge grows cell by cell on a coarse 3D grid. The channel is held at potential
+// 0, the target electrode at 1 and the outer faces at the ambient ramp z / (nz - 1). After
+// every growth step a few red-black SOR sweeps relax the Laplace equation around the new
+// cell, then one candidate cell next to the channel joins it with probability
+// proportional to phi^eta.
+// A low eta gives bushy, branching discharges; a high eta gives nearly straight ones.
+//
+// Trees are grown in a normalized frame: root at the origin, target at (0, 0, 1), lateral
+// extent about +-0.25. A caller maps them onto any pair of endpoints with a similarity
+// transform, so one tree stays valid while its endpoints drift; regrowing is only needed
+// for a new look. ArcGrowthQueue grows them on a worker thread.
+
+namespace astro_lightning {
+
+struct ArcNode {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    int parent = -1;      // -1 for the root
+    float weight = 1.0f;  // 1 on the main channel, smaller on side branches
+};
+
+// Node 0 is the root and the last node is the target; parents always precede children,
+// so each node with parent >= 0 contributes one segment parent -> node.
+struct ArcTree {
+    std::vector<ArcNode> nodes;
+
+    void Clear() { nodes.clear(); }
+    bool empty() const { return nodes.size() < 2; }
+};
+
+struct GrowthOptions {
+    int lateralCells = 13;   // odd, so the axis runs through cell centres
+    int axialCells = 25;
+    float eta = 2.4f;
+    int sweepsPerStep = 2;   // over the window around the newest cell
+    int localRadius = 4;
+    int fullSweepInterval = 8;
+    int relaxSweeps = 24;    // before the first step
+    int maxSteps = 600;
+    float jitter = 0.38f;    // node offset within its cell, in cells
+    float minBranchWeight = 0.12f;
+};
+
+namespace detail {
+
+// Scratch reused across growths on one thread.
+struct GrowthGrid {
+    int nx = 0, ny = 0, nz = 0;
+    std::vector<float> phi;
+    std::vector<uint8_t> state;  // 0 free, 1 channel, 2 fixed (faces and target), 3 candidate
+    std::vector<int> node;       // tree node of a channel cell
+    std::vector<int> candidateParent;
+    std::vector<int> candidates;
+    std::vector<float> weights;
+
+    void Reset(int x, int y, int z) {
+        nx = x;
+        ny = y;
+        nz = z;
+        const size_t n = static_cast<size_t>(nx) * ny * nz;
+        phi.assign(n, 0.0f);
+        state.assign(n, 0);
+        node.assign(n, -1);
+        candidateParent.assign(n, -1);
+        candidates.clear();
+    }
+
+    int Index(int i, int j, int k) const { return (k * ny + j) * nx + i; }
+};
+
+// Red-black SOR over the cells of [lo, hi] (inclusive, clipped to the interior).
+inline void Relax(GrowthGrid& g, int sweeps, int lo[3], int hi[3]) {
+    constexpr float kOmega = 1.72f;
+    const int sx = 1, sy = g.nx, sz = g.nx * g.ny;
+    const int i0 = std::max(1, lo[0]), i1 = std::min(g.nx - 2, hi[0]);
+    const int j0 = std::max(1, lo[1]), j1 = std::min(g.ny - 2, hi[1]);
+    const int k0 = std::max(1, lo[2]), k1 = std::min(g.nz - 2, hi[2]);
+    for (int sweep = 0; sweep < sweeps; ++sweep) {
+        for (int colour = 0; colour < 2; ++colour) {
+            for (int k = k0; k <= k1; ++k) {
+                for (int j = j0; j <= j1; ++j) {
+                    int i = i0 + ((i0 + j + k + colour) & 1);
+                    for (int c = g.Index(i, j, k); i <= i1; i += 2, c += 2) {
+                        const uint8_t s = g.state[static_cast<size_t>(c)];
+                        if (s == 1 || s == 2) continue;
+                        const float sum = g.phi[static_cast<size_t>(c - sx)] + g.phi[static_cast<size_t>(c + sx)] +
+                                          g.phi[static_cast<size_t>(c - sy)] + g.phi[static_cast<size_t>(c + sy)] +
+                                          g.phi[static_cast<size_t>(c - sz)] + g.phi[static_cast<size_t>(c + sz)];
+                        float& p = g.phi[static_cast<size_t>(c)];
+                        p += kOmega * (sum * (1.0f / 6.0f) - p);
+                    }
+                }
+            }
+        }
+    }
+}
+
+inline void RelaxAll(GrowthGrid& g, int sweeps) {
+    int lo[3] = {1, 1, 1};
+    int hi[3] = {g.nx - 2, g.ny - 2, g.nz - 2};
+    Relax(g, sweeps, lo, hi);
+}
+
+}  // namespace detail
+
+// Grows one tree. Returns false (and a straight two-node tree) if the channel failed to
+// reach the target within options.maxSteps.
+inline bool GrowArcTree(uint64_t seed, const GrowthOptions& options, ArcTree* out, detail::GrowthGrid* scratch = nullptr) {
+    detail::GrowthGrid local;
+    detail::GrowthGrid& g = scratch ? *scratch : local;
+    const int nx = std::max(5, options.lateralCells | 1);
+    const int nz = std::max(5, options.axialCells);
+    g.Reset(nx, nx, nz);
+    astro_random::PhiloxStream rng(seed, 0x1D8Bu);
+
+    const int cx = nx / 2, cy = nx / 2;
+    const float h = 1.0f / static_cast<float>(nz - 1);
+    for (int k = 0; k < nz; ++k) {
+        const float ramp = static_cast<float>(k) * h;
+        for (int j = 0; j < nx; ++j) {
+            for (int i = 0; i < nx; ++i) {
+                const int c = g.Index(i, j, k);
+                g.phi[static_cast<size_t>(c)] = ramp;
+                if (i == 0 || j == 0 || k == 0 || i == nx - 1 || j == nx - 1 || k == nz - 1) g.state[static_cast<size_t>(c)] = 2;
+            }
+        }
+    }
+
+    out->nodes.clear();
+    const int root = g.Index(cx, cy, 0);
+    const int target = g.Index(cx, cy, nz - 1);
+    g.state[static_cast<size_t>(root)] = 1;
+    g.phi[static_cast<size_t>(root)] = 0.0f;
+    g.node[static_cast<size_t>(root)] = 0;
+    g.phi[static_cast<size_t>(target)] = 1.0f;
+    out->nodes.push_back(ArcNode{0.0f, 0.0f, 0.0f, -1, 1.0f});
+
+    auto addCandidates = [&](int cell) {
+        const int k0 = cell / (nx * nx), j0 = (cell / nx) % nx, i0 = cell % nx;
+        for (int dk = -1; dk <= 1; ++dk) {
+            for (int dj = -1; dj <= 1; ++dj) {
+                for (int di = -1; di <= 1; ++di) {
+                    const int i = i0 + di, j = j0 + dj, k = k0 + dk;
+                    if (i < 1 || j < 1 || k < 1 || i > nx - 2 || j > nx - 2 || k > nz - 2) continue;
+                    const int c = g.Index(i, j, k);
+                    if (g.state[static_cast<size_t>(c)] != 0) continue;
+                    g.state[static_cast<size_t>(c)] = 3;
+                    g.candidateParent[static_cast<size_t>(c)] = cell;
+                    g.candidates.push_back(c);
+                }
+            }
+        }
+    };
+    auto touchesTarget = [&](int cell) {
+        const int k = cell / (nx * nx), j = (cell / nx) % nx, i = cell % nx;
+        return k >= nz - 2 && std::abs(i - cx) <= 1 && std::abs(j - cy) <= 1;
+    };
+
+    // Root sits on the z = 0 face, so seed growth from the cell just above it.
+    const int first = g.Index(cx, cy, 1);
+    g.state[static_cast<size_t>(first)] = 3;
+    g.candidateParent[static_cast<size_t>(first)] = root;
+    g.candidates.push_back(first);
+    detail::RelaxAll(g, options.relaxSweeps);
+
+    int last = -1;
+    for (int step = 0; step < options.maxSteps && last < 0; ++step) {
+        if (g.candidates.empty()) break;
+        g.weights.resize(g.candidates.size());
+        float total = 0.0f;
+        for (size_t n = 0; n < g.candidates.size(); ++n) {
+            const float p = std::max(0.0f, g.phi[static_cast<size_t>(g.candidates[n])]);
+            total += p > 0.0f ? std::exp(options.eta * std::log(p)) : 0.0f;
+            g.weights[n] = total;
+        }
+        size_t pick = g.candidates.size() - 1;
+        if (total > 0.0f) {
+            const float r = rng.Uniform() * total;
+            pick = static_cast<size_t>(std::upper_bound(g.weights.begin(), g.weights.end(), r) - g.weights.begin());
+            pick = std::min(pick, g.candidates.size() - 1);
+        }
+
+        const int cell = g.candidates[pick];
+        g.candidates[pick] = g.candidates.back();
+        g.candidates.pop_back();
+
+        const int k = cell / (nx * nx), j = (cell / nx) % nx, i = cell % nx;
+        const int parentCell = g.candidateParent[static_cast<size_t>(cell)];
+        ArcNode node;
+        node.x = (static_cast<float>(i - cx) + rng.Uniform(-options.jitter, options.jitter)) * h;
+        node.y = (static_cast<float>(j - cy) + rng.Uniform(-options.jitter, options.jitter)) * h;
+        node.z = (static_cast<float>(k) + rng.Uniform(-options.jitter, options.jitter)) * h;
+        node.parent = g.node[static_cast<size_t>(parentCell)];
+        g.node[static_cast<size_t>(cell)] = static_cast<int>(out->nodes.size());
+        out->nodes.push_back(node);
+        g.state[static_cast<size_t>(cell)] = 1;
+        g.phi[static_cast<size_t>(cell)] = 0.0f;
+
+        if (touchesTarget(cell)) {
+            last = cell;
+            break;
+        }
+        addCandidates(cell);
+        // A new channel cell mostly disturbs its neighbourhood: relax a window around it
+        // each step and the whole grid only every few steps.
+        if ((step + 1) % options.fullSweepInterval == 0) {
+            detail::RelaxAll(g, 1);
+        } else {
+            int lo[3] = {i - options.localRadius, j - options.localRadius, k - options.localRadius};
+            int hi[3] = {i + options.localRadius, j + options.localRadius, k + options.localRadius};
+            detail::Relax(g, options.sweepsPerStep, lo, hi);
+        }
+    }
+
+    if (last < 0) {
+        out->nodes.assign(1, ArcNode{0.0f, 0.0f, 0.0f, -1, 1.0f});
+        out->nodes.push_back(ArcNode{0.0f, 0.0f, 1.0f, 0, 1.0f});
+        return false;
+    }
+    out->nodes.push_back(ArcNode{0.0f, 0.0f, 1.0f, g.node[static_cast<size_t>(last)], 1.0f});
+
+    // Main channel: the parent chain from the target. Side branches fade with the share of
+    // the tree they carry, so twigs of one or two cells are faint.
+    const int count = static_cast<int>(out->nodes.size());
+    std::vector<int> subtree(static_cast<size_t>(count), 1);
+    for (int n = count - 1; n > 0; --n) subtree[static_cast<size_t>(out->nodes[static_cast<size_t>(n)].parent)] += subtree[static_cast<size_t>(n)];
+    std::vector<uint8_t> main(static_cast<size_t>(count), 0);
+    int mainLength = 0;
+    for (int n = count - 1; n >= 0; n = out->nodes[static_cast<size_t>(n)].parent) {
+        main[static_cast<size_t>(n)] = 1;
+        ++mainLength;
+    }
+    const float branchScale = 1.0f / std::max(1.0f, 0.5f * static_cast<float>(mainLength));
+    for (int n = 0; n < count; ++n) {
+        ArcNode& node = out->nodes[static_cast<size_t>(n)];
+        node.weight = main[static_cast<size_t>(n)]
+                          ? 1.0f
+                          : std::min(0.7f, options.minBranchWeight + 0.6f * std::sqrt(static_cast<float>(subtree[static_cast<size_t>(n)]) * branchScale));
+    }
+    return true;
+}
+
+// Grows trees on a worker thread. Submit() queues (id, seed, options) jobs; a job for an
+// id that is still queued replaces it. Collect() hands back finished trees with the
+// ticket Submit() returned, so callers can drop results that were superseded.
+class ArcGrowthQueue {
+  public:
+    struct Result {
+        int id = 0;
+        uint32_t ticket = 0;
+        ArcTree tree;
+    };
+
+    ArcGrowthQueue() = default;
+    ~ArcGrowthQueue() { Stop(); }
+
+    ArcGrowthQueue(const ArcGrowthQueue&) = delete;
+    ArcGrowthQueue& operator=(const ArcGrowthQueue&) = delete;
+
+    uint32_t Submit(int id, uint64_t seed, const GrowthOptions& options) {
+        uint32_t ticket = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ticket = ++nextTicket_;
+            stop_ = false;
+            auto it = std::find_if(jobs_.begin(), jobs_.end(), [id](const Job& job) { return job.id == id; });
+            if (it != jobs_.end()) {
+                *it = Job{id, ticket, seed, options};
+            } else {
+                jobs_.push_back(Job{id, ticket, seed, options});
+            }
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+        return ticket;
+    }
+
+    // Moves finished trees into `out` (cleared first); their storage is recycled.
+    void Collect(std::vector<Result>* out) {
+        for (Result& r : *out) spare_.push_back(std::move(r.tree));
+        out->clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        out->swap(finished_);
+        for (ArcTree& tree : spare_) {
+            if (recycled_.size() < 64) recycled_.push_back(std::move(tree));
+        }
+        spare_.clear();
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return jobs_.size() + (growing_ ? 1u : 0u);
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    struct Job {
+        int id;
+        uint32_t ticket;
+        uint64_t seed;
+        GrowthOptions options;
+    };
+
+    void WorkerLoop() {
+        detail::GrowthGrid grid;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+            if (stop_) return;
+            const Job job = jobs_.front();
+            jobs_.erase(jobs_.begin());
+            Result result{job.id, job.ticket, {}};
+            if (!recycled_.empty()) {
+                result.tree = std::move(recycled_.back());
+                recycled_.pop_back();
+            }
+            growing_ = true;
+            lock.unlock();
+
+            GrowArcTree(job.seed, job.options, &result.tree, &grid);
+
+            lock.lock();
+            growing_ = false;
+            finished_.push_back(std::move(result));
+        }
+    }
+
+    std::vector<Job> jobs_;
+    std::vector<Result> finished_;
+    std::vector<ArcTree> recycled_;
+    std::vector<ArcTree> spare_;
+    uint32_t nextTicket_ = 0;
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool growing_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_lightning
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "particle_soa.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Schwarzschild light bending as a lookup table: impact parameter b (in Schwarzschild
+// radii) -> total deflection angle and time delay, from the exact photon orbit rather
+// than the weak-field 2 rs / b. Rays with b below the capture radius 3 sqrt(3) / 2 fall
+// into the hole.
+//
+// Samples are uniform in s = sqrt(1 - b_c / b), which maps [b_c, inf) onto [0, 1): the
+// logarithmic divergence at the photon sphere sits at s = 0 and the weak-field tail,
+// alpha ~ 2 (1 - s^2) / b_c, is smooth up to s = 1. Lookups are one sqrt, one divide
+// and a linear interpolation, batched with AVX2 gathers where available.
+//
+// Deflection:  alpha(b) = 2 int_0^u0 du / sqrt(1/b^2 - u^2 + u^3) - pi,  u = rs / r
+// Delay:       coordinate time along the orbit between radius R on both sides, minus the
+//              straight chord 2 sqrt(R^2 - b^2) and the b-independent 2 ln 2R, as
+//              R -> inf. Weak field it tends to the Shapiro term -2 ln b, so the table
+//              stores delay + 2 ln b; differences between images give their lag in rs/c.
+
+namespace astro_lensing {
+
+constexpr double kCaptureImpact = 2.5980762113533160;  // 3 sqrt(3) / 2 rs
+
+class DeflectionTable {
+  public:
+    static constexpr int kSamples = 2048;
+    static constexpr uint32_t kFileVersion = 1;
+
+    bool empty() const { return alpha_.empty(); }
+
+    void Build() {
+        alpha_.resize(kSamples);
+        delay_.resize(kSamples);
+        for (int i = 0; i < kSamples; ++i) {
+            // Knot 0 sits a quarter cell in so it stays finite; the last knot is b = inf.
+            const double s = i == 0 ? 0.25 / (kSamples - 1) : static_cast<double>(i) / (kSamples - 1);
+            if (i == kSamples - 1) {
+                alpha_[i] = 0.0f;
+                delay_[i] = 0.0f;
+                continue;
+            }
+            const double b = kCaptureImpact / (1.0 - s * s);
+            alpha_[i] = static_cast<float>(ExactDeflection(b));
+            delay_[i] = static_cast<float>(ExactDelay(b) + 2.0 * std::log(b));
+        }
+    }
+
+    // Cache file: the bytes "DFLT", little-endian uint32 version and sample count, then
+    // the deflection and reduced delay columns as float32.
+    bool Save(const std::string& path) const {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) return false;
+        const uint32_t header[2] = {kFileVersion, static_cast<uint32_t>(kSamples)};
+        bool ok = std::fwrite("DFLT", 1, 4, file) == 4 && std::fwrite(header, sizeof(header), 1, file) == 1 &&
+                  std::fwrite(alpha_.data(), sizeof(float), alpha_.size(), file) == alpha_.size() &&
+                  std::fwrite(delay_.data(), sizeof(float), delay_.size(), file) == delay_.size();
+        return std::fclose(file) == 0 && ok;
+    }
+
+    bool Load(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) return false;
+        char magic[4] = {};
+        uint32_t header[2] = {};
+        astro_soa::AlignedFloats alpha(kSamples), delay(kSamples);
+        const bool ok = std::fread(magic, 1, 4, file) == 4 && std::fread(header, sizeof(header), 1, file) == 1 &&
+                        std::equal(magic, magic + 4, "DFLT") && header[0] == kFileVersion && header[1] == kSamples &&
+                        std::fread(alpha.data(), sizeof(float), kSamples, file) == static_cast<size_t>(kSamples) &&
+                        std::fread(delay.data(), sizeof(float), kSamples, file) == static_cast<size_t>(kSamples);
+        std::fclose(file);
+        if (!ok) return false;
+        alpha_.swap(alpha);
+        delay_.swap(delay);
+        return true;
+    }
+
+    static bool Captured(float b) { return !(b > static_cast<float>(kCaptureImpact)); }
+
+    // Total deflection in radians; +inf for captured rays.
+    float Deflection(float b) const {
+        if (Captured(b)) return std::numeric_limits<float>::infinity();
+        float f;
+        const int i = Cell(b, &f);
+        return alpha_[i] + f * (alpha_[i + 1] - alpha_[i]);
+    }
+
+    // d alpha / d b from the interpolating segment (zero for captured rays).
+    float DeflectionSlope(float b) const {
+        if (Captured(b)) return 0.0f;
+        float f;
+        const int i = Cell(b, &f);
+        const float s = std::sqrt(1.0f - static_cast<float>(kCaptureImpact) / b);
+        const float dAlphaDs = (alpha_[i + 1] - alpha_[i]) * (kSamples - 1);
+        return dAlphaDs * static_cast<float>(kCaptureImpact) / (2.0f * std::max(s, 1.0e-6f) * b * b);
+    }
+
+    // Time delay in rs / c relative to the reference described above; +inf if captured.
+    float Delay(float b) const {
+        if (Captured(b)) return std::numeric_limits<float>::infinity();
+        float f;
+        const int i = Cell(b, &f);
+        return delay_[i] + f * (delay_[i + 1] - delay_[i]) - 2.0f * std::log(b);
+    }
+
+    // out[i] = Deflection(b[i]) for n impact parameters.
+    void DeflectionBatch(const float* b, float* out, size_t n) const {
+        size_t i = 0;
+
+#if defined(ASTRO_SOA_AVX2) || defined(ASTRO_SOA_NEON)
+        const float bc = static_cast<float>(kCaptureImpact);
+        const float scale = static_cast<float>(kSamples - 1);
+        const float* table = alpha_.data();
+#endif
+#if defined(ASTRO_SOA_AVX2)
+        const __m256 vbc = _mm256_set1_ps(bc), one = _mm256_set1_ps(1.0f), vscale = _mm256_set1_ps(scale);
+        const __m256 inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+        const __m256i last = _mm256_set1_epi32(kSamples - 2);
+        for (; i + 8 <= n; i += 8) {
+            const __m256 vb = _mm256_loadu_ps(b + i);
+            const __m256 captured = _mm256_cmp_ps(vb, vbc, _CMP_NGT_UQ);
+            const __m256 s2 = _mm256_max_ps(_mm256_sub_ps(one, _mm256_div_ps(vbc, vb)), _mm256_setzero_ps());
+            const __m256 x = _mm256_mul_ps(_mm256_sqrt_ps(s2), vscale);
+            const __m256i cell = _mm256_min_epi32(_mm256_cvttps_epi32(x), last);
+            const __m256 f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(cell));
+            const __m256 a0 = _mm256_i32gather_ps(table, cell, 4);
+            const __m256 a1 = _mm256_i32gather_ps(table + 1, cell, 4);
+            const __m256 alpha = _mm256_add_ps(a0, _mm256_mul_ps(f, _mm256_sub_ps(a1, a0)));
+            _mm256_storeu_ps(out + i, _mm256_blendv_ps(alpha, inf, captured));
+        }
+#elif defined(ASTRO_SOA_NEON)
+        const float32x4_t vbc = vdupq_n_f32(bc), one = vdupq_n_f32(1.0f), vscale = vdupq_n_f32(scale);
+        const float32x4_t inf = vdupq_n_f32(std::numeric_limits<float>::infinity());
+        const uint32x4_t last = vdupq_n_u32(kSamples - 2);
+        for (; i + 4 <= n; i += 4) {
+            const float32x4_t vb = vld1q_f32(b + i);
+            const uint32x4_t live = vcgtq_f32(vb, vbc);
+            const float32x4_t s2 = vmaxq_f32(vsubq_f32(one, vdivq_f32(vbc, vb)), vdupq_n_f32(0.0f));
+            const float32x4_t x = vmulq_f32(vsqrtq_f32(s2), vscale);
+            const uint32x4_t cell = vminq_u32(vcvtq_u32_f32(x), last);
+            const float32x4_t f = vsubq_f32(x, vcvtq_f32_u32(cell));
+            float a0[4], a1[4];
+            for (int lane = 0; lane < 4; ++lane) {
+                const uint32_t c = cell[lane];
+                a0[lane] = table[c];
+                a1[lane] = table[c + 1];
+            }
+            const float32x4_t v0 = vld1q_f32(a0);
+            const float32x4_t alpha = vfmaq_f32(v0, f, vsubq_f32(vld1q_f32(a1), v0));
+            vst1q_f32(out + i, vbslq_f32(live, alpha, inf));
+        }
+#endif
+
+        for (; i < n; ++i) out[i] = Deflection(b[i]);
+    }
+
+    // Exact deflection by quadrature; u = u0 (1 - t^2) removes the turning-point
+    // singularity, leaving 2 sqrt(u0 / G) with G the smooth cofactor of the radicand.
+    static double ExactDeflection(double b) {
+        const double u0 = TurningPoint(b);
+        auto integrand = [u0](double t) {
+            const double u = u0 * (1.0 - t * t);
+            const double g = (u0 + u) - (u0 * u0 + u0 * u + u * u);
+            return 2.0 * std::sqrt(u0 / g);
+        };
+        return 2.0 * GradedQuadrature(integrand, 1.0, 1.0e-9) - 3.14159265358979323846;
+    }
+
+    // Exact delay by quadrature in r = r0 + s^2 out to a large radius.
+    static double ExactDelay(double b) {
+        constexpr double kFar = 1.0e7;
+        const double r0 = 1.0 / TurningPoint(b);
+        auto integrand = [r0, b](double s) {
+            const double r = r0 + s * s;
+            const double k = (r + r0) - b * b / (r * r0);
+            return 2.0 * r / ((1.0 - 1.0 / r) * std::sqrt(k));
+        };
+        const double t = 2.0 * GradedQuadrature(integrand, std::sqrt(kFar - r0), 1.0e-9);
+        return t - 2.0 * std::sqrt(kFar * kFar - b * b) - 2.0 * std::log(2.0 * kFar);
+    }
+
+  private:
+    int Cell(float b, float* f) const {
+        const float x = std::sqrt(std::max(0.0f, 1.0f - static_cast<float>(kCaptureImpact) / b)) * (kSamples - 1);
+        const int i = std::min(static_cast<int>(x), kSamples - 2);
+        *f = x - i;
+        return i;
+    }
+
+    // Smallest positive root u0 of 1/b^2 - u^2 + u^3 (periapsis rs / r0). The radicand is
+    // positive at u = 0 and negative at the photon sphere's u = 2/3 for any b > b_c.
+    static double TurningPoint(double b) {
+        double lo = 0.0, hi = 2.0 / 3.0;
+        for (int it = 0; it < 64; ++it) {
+            const double u = 0.5 * (lo + hi);
+            (1.0 / (b * b) - u * u + u * u * u > 0.0 ? lo : hi) = u;
+        }
+        return 0.5 * (lo + hi);
+    }
+
+    // 8-point Gauss-Legendre on panels that double in width away from 0, where the
+    // integrands peak as b approaches capture.
+    template <typename F>
+    static double GradedQuadrature(F f, double upper, double first) {
+        static constexpr double kNodes[4] = {0.1834346424956498, 0.5255324099163290, 0.7966664774136267, 0.9602898564975363};
+        static constexpr double kWeights[4] = {0.3626837833783620, 0.3137066458778873, 0.2223810344533745, 0.1012285362903763};
+        auto panel = [&](double a, double c) {
+            const double mid = 0.5 * (a + c), half = 0.5 * (c - a);
+            double sum = 0.0;
+            for (int k = 0; k < 4; ++k) sum += kWeights[k] * (f(mid - half * kNodes[k]) + f(mid + half * kNodes[k]));
+            return sum * half;
+        };
+        double total = panel(0.0, std::min(first, upper));
+        for (double a = first; a < upper; a *= 2.0) total += panel(a, std::min(2.0 * a, upper));
+        return total;
+    }
+
+    astro_soa::AlignedFloats alpha_, delay_;
+};
+
+// The table every demo shares: loaded from `cachePath` when present and valid, else
+// built (a few milliseconds) and written back there.
+inline const DeflectionTable& SharedDeflectionTable(const std::string& cachePath = "geodesic_deflection.lut") {
+    static const DeflectionTable table = [&cachePath]() {
+        DeflectionTable t;
+        if (!t.Load(cachePath)) {
+            t.Build();
+            t.Save(cachePath);
+        }
+        return t;
+    }();
+    return table;
+}
+
+}  // namespace astro_lensing
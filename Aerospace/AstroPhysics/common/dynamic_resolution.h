@@ -0,0 +1,259 @@
+#pragma once
+
+#include "cli_args.h"
+#include "gpu_ping_pong.h"
+#include "raylib.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+// Dynamic resolution for the heavy 3D demos: the scene pass is drawn into the lower-left
+// part of a window-sized render texture, and that part is stretched back over the window
+// through a contrast-adaptive sharpening shader. The HUD is drawn afterwards at native
+// resolution. The fraction rendered follows the GPU time of the scene pass (a GL timer
+// query, read a few frames late so it never stalls) towards a target in milliseconds.
+//
+//   BeginDrawing();
+//   dynres.BeginScene();   // instead of drawing straight to the backbuffer
+//   ClearBackground(...); BeginMode3D(camera); ... EndMode3D();
+//   dynres.EndScene();     // upscale + sharpen to the window
+//   ...HUD...
+//   EndDrawing();
+//
+// The scene pass keeps the window's aspect and its 2D coordinates, so screen-space
+// draws inside it land where they would at full size. At scale 1 the scene draws
+// straight to the backbuffer, keeping MSAA. Without GL 3.3 or timer queries Init()
+// returns false and Begin/EndScene do nothing, so the demo draws as before.
+namespace astro_render {
+
+struct DynamicResolutionOptions {
+    bool enabled = true;
+    float targetMs = 16.6f;  // GPU time budget for the scene pass
+    float minScale = 0.5f;   // per axis
+    float sharpness = 0.5f;  // 0 soft .. 1 strongest
+
+    // --no-dynres, --target-ms=X, --min-scale=X, --sharpness=X
+    static DynamicResolutionOptions FromArgs(int argc, char** argv) {
+        DynamicResolutionOptions o;
+        o.enabled = !astro_bench::HasFlag(argc, argv, "--no-dynres");
+        o.targetMs = std::max(1.0f, astro_bench::FloatArg(argc, argv, "--target-ms", o.targetMs));
+        o.minScale = std::clamp(astro_bench::FloatArg(argc, argv, "--min-scale", o.minScale), 0.25f, 1.0f);
+        o.sharpness = std::clamp(astro_bench::FloatArg(argc, argv, "--sharpness", o.sharpness), 0.0f, 1.0f);
+        return o;
+    }
+};
+
+class DynamicResolution {
+  public:
+    static constexpr float kScaleStep = 0.05f;
+    static constexpr int kSettleFrames = 20;  // between changes, so the timing catches up
+    static constexpr int kQueries = 4;
+
+    bool Init(int width, int height, const DynamicResolutionOptions& options) {
+        Unload();
+        options_ = options;
+        if (!options.enabled || !LoadTimerQueries() || !astro_gpu::LoadPassShader(kSharpenShader, &sharpen_)) {
+            Unload();
+            return false;
+        }
+        locTexel_ = GetShaderLocation(sharpen_, "texel");
+        locBounds_ = GetShaderLocation(sharpen_, "bounds");
+        locSharpness_ = GetShaderLocation(sharpen_, "sharpness");
+        genQueries_(kQueries, queries_);
+        Resize(width, height);
+        scale_ = 1.0f;
+        ready_ = target_.id != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (target_.id != 0) UnloadRenderTexture(target_);
+        target_ = RenderTexture2D{};
+        if (deleteQueries_ != nullptr && queries_[0] != 0) deleteQueries_(kQueries, queries_);
+        for (unsigned& q : queries_) q = 0;
+        astro_gpu::UnloadPassShader(&sharpen_);
+        ready_ = false;
+        inScene_ = false;
+        frame_ = 0;
+        gpuMs_ = 0.0f;
+    }
+
+    // For resizable windows; the scale carries over.
+    void Resize(int width, int height) {
+        if (target_.id != 0 && target_.texture.width == width && target_.texture.height == height) return;
+        if (target_.id != 0) UnloadRenderTexture(target_);
+        target_ = LoadRenderTexture(std::max(1, width), std::max(1, height));
+        SetTextureFilter(target_.texture, TEXTURE_FILTER_BILINEAR);
+    }
+
+    bool ready() const { return ready_; }
+    float scale() const { return ready_ ? scale_ : 1.0f; }
+    float gpuMs() const { return gpuMs_; }
+    float targetMs() const { return options_.targetMs; }
+    void SetTargetMs(float ms) { options_.targetMs = std::max(1.0f, ms); }
+
+    void BeginScene() {
+        if (!ready_) return;
+        if (GetScreenWidth() != target_.texture.width || GetScreenHeight() != target_.texture.height) {
+            Resize(GetScreenWidth(), GetScreenHeight());
+        }
+        rlDrawRenderBatchActive();
+        const int slot = frame_ % kQueries;
+        if (frame_ >= kQueries) CollectQuery(slot);
+        beginQuery_(kTimeElapsed, queries_[slot]);
+        inScene_ = true;
+        if (scale_ >= 1.0f) return;
+        BeginTextureMode(target_);
+        rlViewport(0, 0, ScaledWidth(), ScaledHeight());
+    }
+
+    void EndScene() {
+        if (!inScene_) return;
+        inScene_ = false;
+        if (scale_ < 1.0f) {
+            EndTextureMode();
+            Upscale();
+        }
+        rlDrawRenderBatchActive();
+        endQuery_(kTimeElapsed);
+        ++frame_;
+    }
+
+    // "render 75% (scene 14.2 / 16.6 ms)", or "native" when inactive.
+    void FormatStatus(char* buffer, int size) const {
+        if (!ready_) {
+            std::snprintf(buffer, size, "render native");
+            return;
+        }
+        std::snprintf(buffer, size, "render %.0f%% (scene %.1f / %.1f ms)", 100.0f * scale_, gpuMs_, options_.targetMs);
+    }
+
+  private:
+    using GenQueriesFn = void(ASTRO_GL_CALL*)(int, unsigned*);
+    using QueryFn = void(ASTRO_GL_CALL*)(unsigned, unsigned);
+    using EndQueryFn = void(ASTRO_GL_CALL*)(unsigned);
+    using QueryObjectIvFn = void(ASTRO_GL_CALL*)(unsigned, unsigned, int*);
+    using QueryObjectUi64vFn = void(ASTRO_GL_CALL*)(unsigned, unsigned, uint64_t*);
+    static constexpr unsigned kTimeElapsed = 0x88BF;
+    static constexpr unsigned kQueryResult = 0x8866;
+    static constexpr unsigned kQueryResultAvailable = 0x8867;
+
+    bool LoadTimerQueries() {
+        const int version = rlGetVersion();
+        if (version != RL_OPENGL_33 && version != RL_OPENGL_43) return false;
+        genQueries_ = reinterpret_cast<GenQueriesFn>(glfwGetProcAddress("glGenQueries"));
+        deleteQueries_ = reinterpret_cast<GenQueriesFn>(glfwGetProcAddress("glDeleteQueries"));
+        beginQuery_ = reinterpret_cast<QueryFn>(glfwGetProcAddress("glBeginQuery"));
+        endQuery_ = reinterpret_cast<EndQueryFn>(glfwGetProcAddress("glEndQuery"));
+        queryObjectIv_ = reinterpret_cast<QueryObjectIvFn>(glfwGetProcAddress("glGetQueryObjectiv"));
+        queryObjectUi64v_ = reinterpret_cast<QueryObjectUi64vFn>(glfwGetProcAddress("glGetQueryObjectui64v"));
+        return genQueries_ != nullptr && deleteQueries_ != nullptr && beginQuery_ != nullptr && endQuery_ != nullptr &&
+               queryObjectIv_ != nullptr && queryObjectUi64v_ != nullptr;
+    }
+
+    int ScaledWidth() const { return std::max(1, static_cast<int>(std::lround(scale_ * target_.texture.width))); }
+    int ScaledHeight() const { return std::max(1, static_cast<int>(std::lround(scale_ * target_.texture.height))); }
+
+    // The query issued kQueries frames ago is normally done; if not, skip this sample.
+    void CollectQuery(int slot) {
+        int available = 0;
+        queryObjectIv_(queries_[slot], kQueryResultAvailable, &available);
+        if (available == 0) return;
+        uint64_t ns = 0;
+        queryObjectUi64v_(queries_[slot], kQueryResult, &ns);
+        Adjust(static_cast<float>(static_cast<double>(ns) * 1.0e-6));
+    }
+
+    // Pixel cost goes with the area, so an overrun shrinks each axis by sqrt(target / ms).
+    // Growth is one step at a time and only with clear headroom, so it does not oscillate.
+    void Adjust(float ms) {
+        gpuMs_ = gpuMs_ > 0.0f ? gpuMs_ + 0.15f * (ms - gpuMs_) : ms;
+        if (settle_ > 0) {
+            --settle_;
+            return;
+        }
+        float want = scale_;
+        if (gpuMs_ > options_.targetMs * 1.05f) {
+            want = scale_ * std::sqrt(0.9f * options_.targetMs / gpuMs_);
+            want = std::floor(want / kScaleStep + 1.0e-3f) * kScaleStep;
+        } else if (gpuMs_ < options_.targetMs * 0.7f) {
+            want = scale_ + kScaleStep;
+        }
+        want = std::clamp(want, options_.minScale, 1.0f);
+        if (std::fabs(want - scale_) < 0.5f * kScaleStep) return;
+        scale_ = want;
+        settle_ = kSettleFrames;
+    }
+
+    void Upscale() {
+        const float w = static_cast<float>(target_.texture.width), h = static_cast<float>(target_.texture.height);
+        const float sw = static_cast<float>(ScaledWidth()), sh = static_cast<float>(ScaledHeight());
+        const float texel[2] = {1.0f / w, 1.0f / h};
+        const float bounds[4] = {0.5f / w, 0.5f / h, (sw - 0.5f) / w, (sh - 0.5f) / h};
+        BeginShaderMode(sharpen_);
+        SetShaderValue(sharpen_, locTexel_, texel, SHADER_UNIFORM_VEC2);
+        SetShaderValue(sharpen_, locBounds_, bounds, SHADER_UNIFORM_VEC4);
+        SetShaderValue(sharpen_, locSharpness_, &options_.sharpness, SHADER_UNIFORM_FLOAT);
+        rlDisableColorBlend();
+        DrawTexturePro(target_.texture, Rectangle{0.0f, 0.0f, sw, -sh}, Rectangle{0.0f, 0.0f, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight())},
+                       Vector2{0.0f, 0.0f}, 0.0f, WHITE);
+        rlDrawRenderBatchActive();
+        rlEnableColorBlend();
+        EndShaderMode();
+    }
+
+    // Contrast-adaptive sharpening over the bilinear upscale: a negative-lobe cross whose
+    // weight backs off where the neighbourhood is already near black or white.
+    static constexpr const char* kSharpenShader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+uniform sampler2D texture0;
+uniform vec2 texel;       // one source texel in uv
+uniform vec4 bounds;      // uv rectangle of the rendered part
+uniform float sharpness;
+
+vec3 tap(vec2 uv) { return texture(texture0, clamp(uv, bounds.xy, bounds.zw)).rgb; }
+
+void main() {
+    vec2 uv = fragTexCoord;
+    vec3 c = tap(uv);
+    vec3 n = tap(uv + vec2(0.0, texel.y));
+    vec3 s = tap(uv - vec2(0.0, texel.y));
+    vec3 e = tap(uv + vec2(texel.x, 0.0));
+    vec3 w = tap(uv - vec2(texel.x, 0.0));
+    vec3 lo = min(c, min(min(n, s), min(e, w)));
+    vec3 hi = max(c, max(max(n, s), max(e, w)));
+    vec3 amp = sqrt(clamp(min(lo, 1.0 - hi) / max(hi, vec3(1.0e-4)), 0.0, 1.0));
+    vec3 lobe = -amp * mix(0.0625, 0.2, sharpness);
+    vec3 color = (c + (n + s + e + w) * lobe) / (1.0 + 4.0 * lobe);
+    finalColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
+)";
+
+    DynamicResolutionOptions options_{};
+    RenderTexture2D target_{};
+    Shader sharpen_{};
+    int locTexel_ = -1;
+    int locBounds_ = -1;
+    int locSharpness_ = -1;
+    bool ready_ = false;
+    bool inScene_ = false;
+    float scale_ = 1.0f;
+    float gpuMs_ = 0.0f;
+    int settle_ = 0;
+    int frame_ = 0;
+    unsigned queries_[kQueries] = {};
+    GenQueriesFn genQueries_ = nullptr;
+    GenQueriesFn deleteQueries_ = nullptr;
+    QueryFn beginQuery_ = nullptr;
+    EndQueryFn endQuery_ = nullptr;
+    QueryObjectIvFn queryObjectIv_ = nullptr;
+    QueryObjectUi64vFn queryObjectUi64v_ = nullptr;
+};
+
+}  // namespace astro_render
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cmath>
+
+// Heliocentric planet states from Keplerian mean elements (Standish, "Keplerian
+// Elements for Approximate Positions of the Major Planets", table 1: 1800-2050 AD,
+// J2000 ecliptic). Good to a few thousandths of an AU, which is plenty for porkchop
+// plots and transfer sketches. Units are AU, days and AU/day.
+
+namespace astro_ephem {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDegToRad = kPi / 180.0;
+constexpr double kJ2000 = 2451545.0;               // Julian date of the element epoch
+constexpr double kMuSun = 2.9591220828559093e-4;   // AU^3/day^2 (Gaussian constant squared)
+constexpr double kAuPerDayToKmPerS = 1731.45683681;
+
+struct Vec3d {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+};
+
+struct StateVector {
+    Vec3d position;  // AU
+    Vec3d velocity;  // AU/day
+};
+
+// Elements at J2000 plus their rates per Julian century. Angles in degrees.
+struct MeanElements {
+    double a, aRate;
+    double e, eRate;
+    double inclination, inclinationRate;
+    double meanLongitude, meanLongitudeRate;
+    double perihelionLongitude, perihelionLongitudeRate;
+    double ascendingNode, ascendingNodeRate;
+};
+
+constexpr MeanElements kMercury = {
+    0.38709927, 0.00000037,  0.20563593, 0.00001906,  7.00497902,  -0.00594749,
+    252.25032350, 149472.67411175, 77.45779628, 0.16047689, 48.33076593, -0.12534081,
+};
+
+constexpr MeanElements kVenus = {
+    0.72333566, 0.00000390,  0.00677672, -0.00004107, 3.39467605,  -0.00078890,
+    181.97909950, 58517.81538729, 131.60246718, 0.00268329, 76.67984255, -0.27769418,
+};
+
+constexpr MeanElements kEarthMoonBarycenter = {
+    1.00000261, 0.00000562,  0.01671123, -0.00004392, -0.00001531, -0.01294668,
+    100.46457166, 35999.37244981, 102.93768193, 0.32327364, 0.0, 0.0,
+};
+
+constexpr MeanElements kMars = {
+    1.52371034, 0.00001847,  0.09339410, 0.00007882,  1.84969142,  -0.00813131,
+    -4.55343205, 19140.30268499, -23.94362959, 0.44441088, 49.55953891, -0.29257343,
+};
+
+constexpr MeanElements kJupiter = {
+    5.20288700, -0.00011607, 0.04838624, -0.00013253, 1.30439695,  -0.00183714,
+    34.39644051, 3034.74612775, 14.72847983, 0.21252668, 100.47390909, 0.20469106,
+};
+
+constexpr MeanElements kSaturn = {
+    9.53667594, -0.00125060, 0.05386179, -0.00050991, 2.48599187,  0.00193609,
+    49.95424423, 1222.49362201, 92.59887831, -0.41897216, 113.66242448, -0.28867794,
+};
+
+constexpr MeanElements kUranus = {
+    19.18916464, -0.00196176, 0.04725744, -0.00004397, 0.77263783, -0.00242939,
+    313.23810451, 428.48202785, 170.95427630, 0.40805281, 74.01692503, 0.04240589,
+};
+
+constexpr MeanElements kNeptune = {
+    30.06992276, 0.00026291, 0.00859048, 0.00005105,  1.77004347,  0.00035372,
+    -55.12002969, 218.45945325, 44.96476227, -0.32241464, 131.78422574, -0.00508664,
+};
+
+// Heliocentric ecliptic state at the given Julian date.
+inline StateVector StateAt(const MeanElements& el, double julianDate, double mu = kMuSun) {
+    const double t = (julianDate - kJ2000) / 36525.0;
+    const double a = el.a + el.aRate * t;
+    const double e = el.e + el.eRate * t;
+    const double inc = (el.inclination + el.inclinationRate * t) * kDegToRad;
+    const double meanLon = (el.meanLongitude + el.meanLongitudeRate * t) * kDegToRad;
+    const double periLon = (el.perihelionLongitude + el.perihelionLongitudeRate * t) * kDegToRad;
+    const double node = (el.ascendingNode + el.ascendingNodeRate * t) * kDegToRad;
+    const double argPeri = periLon - node;
+
+    const double meanAnomaly = std::remainder(meanLon - periLon, 2.0 * kPi);
+    double eccAnomaly = meanAnomaly + e * std::sin(meanAnomaly);
+    for (int i = 0; i < 8; ++i) {
+        eccAnomaly -= (eccAnomaly - e * std::sin(eccAnomaly) - meanAnomaly) / (1.0 - e * std::cos(eccAnomaly));
+    }
+
+    const double cosE = std::cos(eccAnomaly);
+    const double sinE = std::sin(eccAnomaly);
+    const double rootOneMinusE2 = std::sqrt(1.0 - e * e);
+    const double r = a * (1.0 - e * cosE);
+    const double px = a * (cosE - e);
+    const double py = a * rootOneMinusE2 * sinE;
+    const double vScale = std::sqrt(mu * a) / r;
+    const double vx = -vScale * sinE;
+    const double vy = vScale * rootOneMinusE2 * cosE;
+
+    // Perifocal -> ecliptic: Rz(node) * Rx(inc) * Rz(argPeri).
+    const double cw = std::cos(argPeri), sw = std::sin(argPeri);
+    const double cn = std::cos(node), sn = std::sin(node);
+    const double ci = std::cos(inc), si = std::sin(inc);
+    const double xx = cw * cn - sw * sn * ci, xy = -sw * cn - cw * sn * ci;
+    const double yx = cw * sn + sw * cn * ci, yy = -sw * sn + cw * cn * ci;
+    const double zx = sw * si, zy = cw * si;
+
+    return {
+        {xx * px + xy * py, yx * px + yy * py, zx * px + zy * py},
+        {xx * vx + xy * vy, yx * vx + yy * vy, zx * vx + zy * vy},
+    };
+}
+
+}  // namespace astro_ephem
@@ -0,0 +1,478 @@
+#pragma once
+
+#include "particle_soa.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Yee-grid FDTD solver for Maxwell's equations in vacuum, for the electromagnetism demos.
+//
+// Units are normalised to the grid: c = eps0 = mu0 = 1 and the cell size is 1, so the
+// time step is the Courant number kCourant and E and H share a scale (a plane wave has
+// |E| == |H|). Ex lives at (i + 1/2, j, k), Hx at (i, j + 1/2, k + 1/2) and so on
+// cyclically, H half a step behind E. Each field component is its own 64-byte aligned
+// array indexed (k * ny + j) * nx + i.
+//
+// A step updates H then E in a branch-free bulk pass: z planes are split into slabs
+// across the shared thread pool, each slab walks blocks of kRowBlock rows plane by plane
+// so the neighbouring plane is still cached, and every row is one SIMD stencil call.
+// The outer faces are perfect conductors. In front of them a convolutional PML (CPML,
+// stretched coordinates with kappa = 1) of `pml` cells absorbs outgoing waves; its
+// auxiliary fields only exist inside the layers and are applied as a correction pass.
+
+namespace astro_fdtd {
+
+using astro_soa::AlignedFloats;
+
+enum Axis { kX = 0, kY = 1, kZ = 2 };
+
+enum class SliceField { kElectric, kMagnetic, kPoynting };
+
+// out[n] += coef * ((a[n + aOffset] - a[n]) - (b[n + bOffset] - b[n])) for n < count:
+// one row of any of the six curl updates.
+inline void CurlRow(float* __restrict out, const float* __restrict a, ptrdiff_t aOffset,
+                    const float* __restrict b, ptrdiff_t bOffset, float coef, int count) {
+    int n = 0;
+#if defined(ASTRO_SOA_AVX2)
+    const __m256 c = _mm256_set1_ps(coef);
+    for (; n + 8 <= count; n += 8) {
+        const __m256 da = _mm256_sub_ps(_mm256_loadu_ps(a + n + aOffset), _mm256_loadu_ps(a + n));
+        const __m256 db = _mm256_sub_ps(_mm256_loadu_ps(b + n + bOffset), _mm256_loadu_ps(b + n));
+        _mm256_storeu_ps(out + n, _mm256_add_ps(_mm256_loadu_ps(out + n), _mm256_mul_ps(c, _mm256_sub_ps(da, db))));
+    }
+#elif defined(ASTRO_SOA_NEON)
+    const float32x4_t c = vdupq_n_f32(coef);
+    for (; n + 4 <= count; n += 4) {
+        const float32x4_t da = vsubq_f32(vld1q_f32(a + n + aOffset), vld1q_f32(a + n));
+        const float32x4_t db = vsubq_f32(vld1q_f32(b + n + bOffset), vld1q_f32(b + n));
+        vst1q_f32(out + n, vfmaq_f32(vld1q_f32(out + n), c, vsubq_f32(da, db)));
+    }
+#endif
+    for (; n < count; ++n) out[n] += coef * ((a[n + aOffset] - a[n]) - (b[n + bOffset] - b[n]));
+}
+
+class YeeSolver {
+  public:
+    static constexpr float kCourant = 0.57f;  // just under the 3D limit 1/sqrt(3)
+    static constexpr int kRowBlock = 16;
+    static constexpr int kParallelCells = 32 * 32 * 32;
+    static constexpr float kPmlGrading = 3.0f;  // sigma ~ depth^m
+    static constexpr float kPmlAlpha = 0.05f;   // CFS shift, damps evanescent/low-f reflection
+
+    // Every side must be larger than 2 * pml + 2 cells.
+    void Configure(int nx, int ny, int nz, int pml) {
+        n_[kX] = nx;
+        n_[kY] = ny;
+        n_[kZ] = nz;
+        pml_ = pml;
+        stride_[kX] = 1;
+        stride_[kY] = nx;
+        stride_[kZ] = static_cast<ptrdiff_t>(nx) * ny;
+        const size_t cells = static_cast<size_t>(nx) * ny * nz;
+        for (int a = 0; a < 3; ++a) {
+            e_[a].assign(cells, 0.0f);
+            h_[a].assign(cells, 0.0f);
+        }
+        BuildPml();
+        conductor_.clear();
+        time_ = 0.0f;
+    }
+
+    void Clear() {
+        for (int a = 0; a < 3; ++a) {
+            std::fill(e_[a].begin(), e_[a].end(), 0.0f);
+            std::fill(h_[a].begin(), h_[a].end(), 0.0f);
+        }
+        for (PmlLayer& layer : layers_) {
+            for (std::vector<float>* psi : {&layer.psiE[0], &layer.psiE[1], &layer.psiH[0], &layer.psiH[1]}) {
+                std::fill(psi->begin(), psi->end(), 0.0f);
+            }
+        }
+        time_ = 0.0f;
+    }
+
+    // Marks the cells where inside(i, j, k) holds as perfect conductor: their E is held
+    // at zero after every update.
+    template <typename Inside>
+    void SetConductor(Inside&& inside) {
+        conductor_.clear();
+        for (int k = 0; k < n_[kZ]; ++k) {
+            for (int j = 0; j < n_[kY]; ++j) {
+                for (int i = 0; i < n_[kX]; ++i) {
+                    if (inside(i, j, k)) conductor_.push_back(static_cast<uint32_t>(Index(i, j, k)));
+                }
+            }
+        }
+        ZeroConductor();
+    }
+
+    void ClearConductor() { conductor_.clear(); }
+
+    // Advances `steps` leapfrog steps. After each E update source(time) is called with
+    // the new E time, so soft sources can add to E through AddE().
+    template <typename Source>
+    void Step(int steps, Source&& source) {
+        for (int s = 0; s < steps; ++s) {
+            UpdateH();
+            UpdateE();
+            time_ += kCourant;
+            source(time_);
+        }
+    }
+
+    void Step(int steps) {
+        Step(steps, [](float) {});
+    }
+
+    void AddE(Axis axis, int i, int j, int k, float value) { e_[axis][Index(i, j, k)] += value; }
+
+    // Soft sheet-current amplitude that radiates a plane wave of amplitude `field` to each
+    // side (E = J / 2 for a current sheet, J = increment / dt).
+    static float SheetIncrement(float field) { return 2.0f * kCourant * field; }
+
+    // Fields interpolated to the cell corner (i, j, k).
+    Vector3 ElectricAt(int i, int j, int k) const {
+        const size_t n = Index(i, j, k);
+        return {
+            0.5f * (e_[kX][n] + e_[kX][n - (i > 0 ? stride_[kX] : 0)]),
+            0.5f * (e_[kY][n] + e_[kY][n - (j > 0 ? stride_[kY] : 0)]),
+            0.5f * (e_[kZ][n] + e_[kZ][n - (k > 0 ? stride_[kZ] : 0)]),
+        };
+    }
+
+    Vector3 MagneticAt(int i, int j, int k) const {
+        const size_t n = Index(i, j, k);
+        const ptrdiff_t sx = i > 0 ? stride_[kX] : 0;
+        const ptrdiff_t sy = j > 0 ? stride_[kY] : 0;
+        const ptrdiff_t sz = k > 0 ? stride_[kZ] : 0;
+        const auto average = [&](const AlignedFloats& f, ptrdiff_t s1, ptrdiff_t s2) {
+            return 0.25f * (f[n] + f[n - s1] + f[n - s2] + f[n - s1 - s2]);
+        };
+        return {average(h_[kX], sy, sz), average(h_[kY], sz, sx), average(h_[kZ], sx, sy)};
+    }
+
+    Vector3 PoyntingAt(int i, int j, int k) const {
+        return Vector3CrossProduct(ElectricAt(i, j, k), MagneticAt(i, j, k));
+    }
+
+    // Resamples the plane index `index` normal to `normal` onto width x height texels
+    // (nearest cell, first texel axis = the next axis after `normal` cyclically).
+    void SampleSlice(Axis normal, int index, SliceField field, int width, int height, std::vector<Vector3>* out) const {
+        const int u = (normal + 1) % 3;
+        const int v = (normal + 2) % 3;
+        out->resize(static_cast<size_t>(width) * height);
+        int cell[3];
+        cell[normal] = std::clamp(index, 0, n_[normal] - 1);
+        for (int y = 0; y < height; ++y) {
+            cell[v] = std::min(n_[v] - 1, static_cast<int>((static_cast<float>(y) + 0.5f) * n_[v] / height));
+            for (int x = 0; x < width; ++x) {
+                cell[u] = std::min(n_[u] - 1, static_cast<int>((static_cast<float>(x) + 0.5f) * n_[u] / width));
+                Vector3& sample = (*out)[static_cast<size_t>(y) * width + x];
+                if (field == SliceField::kElectric) {
+                    sample = ElectricAt(cell[kX], cell[kY], cell[kZ]);
+                } else if (field == SliceField::kMagnetic) {
+                    sample = MagneticAt(cell[kX], cell[kY], cell[kZ]);
+                } else {
+                    sample = PoyntingAt(cell[kX], cell[kY], cell[kZ]);
+                }
+            }
+        }
+    }
+
+    // Total field energy (E^2 + H^2) / 2 over the grid, PML layers included.
+    double Energy() const {
+        double sum = 0.0;
+        for (int a = 0; a < 3; ++a) {
+            for (size_t n = 0; n < e_[a].size(); ++n) sum += e_[a][n] * e_[a][n] + h_[a][n] * h_[a][n];
+        }
+        return 0.5 * sum;
+    }
+
+    int nx() const { return n_[kX]; }
+    int ny() const { return n_[kY]; }
+    int nz() const { return n_[kZ]; }
+    int pml() const { return pml_; }
+    float time() const { return time_; }
+    size_t cells() const { return e_[kX].size(); }
+    size_t Index(int i, int j, int k) const {
+        return (static_cast<size_t>(k) * n_[kY] + j) * n_[kX] + i;
+    }
+    const float* E(Axis axis) const { return e_[axis].data(); }
+    const float* H(Axis axis) const { return h_[axis].data(); }
+
+  private:
+    // Auxiliary CPML fields for the derivatives along one axis, over both layers of that
+    // axis (2 * pml cells thick, full extent along the other two). psiE[0] corrects the
+    // next component after `axis`, psiE[1] the one after that; psiH likewise.
+    struct PmlLayer {
+        std::vector<float> psiE[2];
+        std::vector<float> psiH[2];
+        std::vector<float> bE, cE, bH, cH;  // per layer cell: psi = b psi + c dField
+    };
+
+    bool Parallel() const { return cells() >= static_cast<size_t>(kParallelCells); }
+
+    template <typename Body>
+    void ForPlanes(int begin, int end, Body&& body) {
+        const auto slab = [&](int k0, int k1) { body(begin + k0, begin + k1); };
+        if (Parallel()) {
+            astro_parallel::SharedPool().ParallelFor(end - begin, 1, slab);
+        } else {
+            slab(0, end - begin);
+        }
+    }
+
+    void UpdateH() {
+        const int nx = n_[kX];
+        const int ny = n_[kY];
+        const ptrdiff_t sy = stride_[kY];
+        const ptrdiff_t sz = stride_[kZ];
+        const float c = -kCourant;
+        float* hx = h_[kX].data();
+        float* hy = h_[kY].data();
+        float* hz = h_[kZ].data();
+        const float* ex = e_[kX].data();
+        const float* ey = e_[kY].data();
+        const float* ez = e_[kZ].data();
+        ForPlanes(0, n_[kZ] - 1, [&](int k0, int k1) {
+            for (int j0 = 0; j0 < ny - 1; j0 += kRowBlock) {
+                const int j1 = std::min(ny - 1, j0 + kRowBlock);
+                for (int k = k0; k < k1; ++k) {
+                    for (int j = j0; j < j1; ++j) {
+                        const size_t n = Index(0, j, k);
+                        CurlRow(hx + n, ez + n, sy, ey + n, sz, c, nx - 1);
+                        CurlRow(hy + n, ex + n, sz, ez + n, 1, c, nx - 1);
+                        CurlRow(hz + n, ey + n, 1, ex + n, sy, c, nx - 1);
+                    }
+                }
+            }
+        });
+        for (int a = 0; a < 3; ++a) CorrectPml<false>(static_cast<Axis>(a));
+    }
+
+    void UpdateE() {
+        const int nx = n_[kX];
+        const int ny = n_[kY];
+        const ptrdiff_t sy = stride_[kY];
+        const ptrdiff_t sz = stride_[kZ];
+        const float c = -kCourant;
+        float* ex = e_[kX].data();
+        float* ey = e_[kY].data();
+        float* ez = e_[kZ].data();
+        const float* hx = h_[kX].data();
+        const float* hy = h_[kY].data();
+        const float* hz = h_[kZ].data();
+        ForPlanes(1, n_[kZ], [&](int k0, int k1) {
+            for (int j0 = 1; j0 < ny; j0 += kRowBlock) {
+                const int j1 = std::min(ny, j0 + kRowBlock);
+                for (int k = k0; k < k1; ++k) {
+                    for (int j = j0; j < j1; ++j) {
+                        const size_t n = Index(1, j, k);
+                        CurlRow(ex + n, hz + n, -sy, hy + n, -sz, c, nx - 1);
+                        CurlRow(ey + n, hx + n, -sz, hz + n, -1, c, nx - 1);
+                        CurlRow(ez + n, hy + n, -1, hx + n, -sy, c, nx - 1);
+                    }
+                }
+            }
+        });
+        for (int a = 0; a < 3; ++a) CorrectPml<true>(static_cast<Axis>(a));
+        ZeroConductor();
+    }
+
+    void ZeroConductor() {
+        for (uint32_t n : conductor_) {
+            e_[kX][n] = 0.0f;
+            e_[kY][n] = 0.0f;
+            e_[kZ][n] = 0.0f;
+        }
+    }
+
+    // Layer cell p (0 .. 2 pml) to the grid coordinate along its axis.
+    int LayerCoordinate(int axis, int p) const { return p < pml_ ? p : n_[axis] - 2 * pml_ + p; }
+
+    void BuildPml() {
+        const float sigmaMax = 0.8f * (kPmlGrading + 1.0f);
+        for (int a = 0; a < 3; ++a) {
+            PmlLayer& layer = layers_[a];
+            const int thickness = 2 * pml_;
+            size_t cells = static_cast<size_t>(thickness);
+            for (int other = 0; other < 3; ++other) {
+                if (other != a) cells *= static_cast<size_t>(n_[other]);
+            }
+            for (int m = 0; m < 2; ++m) {
+                layer.psiE[m].assign(pml_ > 0 ? cells : 0, 0.0f);
+                layer.psiH[m].assign(pml_ > 0 ? cells : 0, 0.0f);
+            }
+            layer.bE.resize(thickness);
+            layer.cE.resize(thickness);
+            layer.bH.resize(thickness);
+            layer.cH.resize(thickness);
+            // E sits on integer positions along its derivative axis, H half a cell further.
+            const float inner0 = static_cast<float>(pml_);
+            const float inner1 = static_cast<float>(n_[a] - 1 - pml_);
+            const auto coefficients = [&](float x, float* b, float* c) {
+                const float depth = std::clamp(std::max(inner0 - x, x - inner1) / static_cast<float>(pml_), 0.0f, 1.0f);
+                const float sigma = sigmaMax * std::pow(depth, kPmlGrading);
+                const float alpha = kPmlAlpha * (1.0f - depth);
+                *b = std::exp(-(sigma + alpha) * kCourant);
+                *c = sigma + alpha > 0.0f ? sigma / (sigma + alpha) * (*b - 1.0f) : 0.0f;
+            };
+            for (int p = 0; p < thickness; ++p) {
+                const float x = static_cast<float>(LayerCoordinate(a, p));
+                coefficients(x, &layer.bE[p], &layer.cE[p]);
+                coefficients(x + 0.5f, &layer.bH[p], &layer.cH[p]);
+            }
+        }
+    }
+
+    // Adds the CPML terms for derivatives along `axis` to the two transverse components,
+    // over the cells of both layers that the bulk pass updated (1 .. n-1 on every axis
+    // for E, 0 .. n-2 for H). With b, c the components after `axis` cyclically:
+    //   E:  Eb -= C psi(d Hc),  Ec += C psi(d Hb)      H:  Hb += C psi(d Ec),  Hc -= C psi(d Eb)
+    // The work is split into contiguous x runs so the inner loop is branch-free.
+    template <bool kElectric>
+    void CorrectPml(Axis axis) {
+        if (pml_ <= 0) return;
+        PmlLayer& layer = layers_[axis];
+        const int b = (axis + 1) % 3;
+        const int c = (axis + 2) % 3;
+        float* __restrict outB = kElectric ? e_[b].data() : h_[b].data();
+        float* __restrict outC = kElectric ? e_[c].data() : h_[c].data();
+        const float* __restrict srcB = kElectric ? h_[b].data() : e_[b].data();
+        const float* __restrict srcC = kElectric ? h_[c].data() : e_[c].data();
+        float* __restrict psiB = kElectric ? layer.psiE[0].data() : layer.psiH[0].data();
+        float* __restrict psiC = kElectric ? layer.psiE[1].data() : layer.psiH[1].data();
+        const float* decay = kElectric ? layer.bE.data() : layer.bH.data();
+        const float* gain = kElectric ? layer.cE.data() : layer.cH.data();
+        const ptrdiff_t s = stride_[axis];
+        int dims[3] = {n_[kX], n_[kY], n_[kZ]};
+        dims[axis] = 2 * pml_;
+        const int lo = kElectric ? 1 : 0;
+        const int hiTrim = kElectric ? 0 : 1;
+
+        // count cells from grid index n / psi index q, layer cell m (or m0 + offset when
+        // the run goes along the layer's own axis).
+        const auto run = [&](size_t n, size_t q, int m0, bool alongAxis, int count) {
+            for (int x = 0; x < count; ++x) {
+                const int m = alongAxis ? m0 + x : m0;
+                const size_t g = n + x;
+                const size_t h = q + x;
+                const float dB = kElectric ? srcB[g] - srcB[g - s] : srcB[g + s] - srcB[g];
+                const float dC = kElectric ? srcC[g] - srcC[g - s] : srcC[g + s] - srcC[g];
+                psiB[h] = decay[m] * psiB[h] + gain[m] * dC;
+                psiC[h] = decay[m] * psiC[h] + gain[m] * dB;
+                const float sign = kElectric ? -kCourant : kCourant;
+                outB[g] += sign * psiB[h];
+                outC[g] -= sign * psiC[h];
+            }
+        };
+        // Coordinates along `d` that the pass visits: both layers for the PML axis, the
+        // whole updated range otherwise. Returned as (begin, end) segments.
+        const auto segments = [&](int d, int* bounds) {
+            const int hi = n_[d] - hiTrim;
+            if (d != axis) {
+                bounds[0] = lo;
+                bounds[1] = hi;
+                bounds[2] = bounds[3] = hi;
+                return;
+            }
+            bounds[0] = lo;
+            bounds[1] = pml_;
+            bounds[2] = n_[d] - pml_;
+            bounds[3] = hi;
+        };
+        const auto layerIndex = [&](int d, int coordinate) {
+            return d == axis && coordinate >= pml_ ? coordinate - (n_[d] - 2 * pml_) : coordinate;
+        };
+        int zs[4];
+        int ys[4];
+        int xs[4];
+        segments(kZ, zs);
+        segments(kY, ys);
+        segments(kX, xs);
+        const int zCount = (zs[1] - zs[0]) + (zs[3] - zs[2]);
+        const auto planes = [&](int begin, int end) {
+            for (int t = begin; t < end; ++t) {
+                const int z = t < zs[1] - zs[0] ? zs[0] + t : zs[2] + t - (zs[1] - zs[0]);
+                const int pz = layerIndex(kZ, z);
+                for (int half = 0; half < 2; ++half) {
+                    for (int y = ys[2 * half]; y < ys[2 * half + 1]; ++y) {
+                        const int py = layerIndex(kY, y);
+                        const int m = axis == kZ ? pz : py;
+                        for (int xh = 0; xh < 2; ++xh) {
+                            const int x0 = xs[2 * xh];
+                            const int count = xs[2 * xh + 1] - x0;
+                            if (count <= 0) continue;
+                            const int px0 = layerIndex(kX, x0);
+                            const size_t q = (static_cast<size_t>(pz) * dims[kY] + py) * dims[kX] + px0;
+                            run(Index(x0, y, z), q, axis == kX ? px0 : m, axis == kX, count);
+                        }
+                    }
+                }
+            }
+        };
+        if (Parallel()) {
+            astro_parallel::SharedPool().ParallelFor(zCount, 1, planes);
+        } else {
+            planes(0, zCount);
+        }
+    }
+
+    int n_[3] = {0, 0, 0};
+    ptrdiff_t stride_[3] = {1, 0, 0};
+    int pml_ = 0;
+    float time_ = 0.0f;
+    AlignedFloats e_[3];
+    AlignedFloats h_[3];
+    PmlLayer layers_[3];
+    std::vector<uint32_t> conductor_;
+};
+
+// Soft current sheet on the plane i = index with a Gaussian aperture across (j, k):
+// beams along +x (and -x, into the PML) for the wave demos. The weights are tabulated
+// once so Emit() is a single pass over the plane.
+class ApertureSource {
+  public:
+    // sigma is the aperture's standard deviation in cells, centred on the plane.
+    void Configure(const YeeSolver& solver, int index, float sigma) {
+        index_ = index;
+        ny_ = solver.ny();
+        nz_ = solver.nz();
+        weight_.resize(static_cast<size_t>(ny_) * nz_);
+        const float inv = 1.0f / std::max(sigma, 1.0f);
+        for (int k = 0; k < nz_; ++k) {
+            const float dz = (static_cast<float>(k) - 0.5f * static_cast<float>(nz_)) * inv;
+            for (int j = 0; j < ny_; ++j) {
+                const float dy = (static_cast<float>(j) - 0.5f * static_cast<float>(ny_)) * inv;
+                weight_[static_cast<size_t>(k) * ny_ + j] = std::exp(-0.5f * (dy * dy + dz * dz));
+            }
+        }
+    }
+
+    int index() const { return index_; }
+
+    // Drives the sheet so the on-axis wave leaving it has E = (0, ey, ez).
+    void Emit(YeeSolver* solver, float ey, float ez) const {
+        const float iy = YeeSolver::SheetIncrement(ey);
+        const float iz = YeeSolver::SheetIncrement(ez);
+        for (int k = 1; k < nz_; ++k) {
+            for (int j = 1; j < ny_; ++j) {
+                const float w = weight_[static_cast<size_t>(k) * ny_ + j];
+                solver->AddE(kY, index_, j, k, w * iy);
+                solver->AddE(kZ, index_, j, k, w * iz);
+            }
+        }
+    }
+
+  private:
+    int index_ = 0;
+    int ny_ = 0;
+    int nz_ = 0;
+    std::vector<float> weight_;
+};
+
+}  // namespace astro_fdtd
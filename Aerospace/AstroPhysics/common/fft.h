@@ -0,0 +1,174 @@
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// In-place radix-2 complex FFTs for the spectral solvers.
+//
+// A plan owns the bit-reversal table and the twiddle factors for one length, so a
+// solver builds it once and reuses it every step. Transforms are unnormalised in both
+// directions: Inverse(Forward(x)) == n * x. Solvers that multiply by a spectral factor
+// anyway fold the 1/n into that factor instead of spending a pass on it.
+
+namespace astro_fft {
+
+using Complex = std::complex<float>;
+
+inline bool IsPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+class Plan1D {
+  public:
+    Plan1D() = default;
+    explicit Plan1D(int n) { Resize(n); }
+
+    // n must be a power of two.
+    void Resize(int n) {
+        if (n == n_ || !IsPowerOfTwo(n)) return;
+        n_ = n;
+        swaps_.clear();
+        int bits = 0;
+        while ((1 << bits) < n) ++bits;
+        for (int i = 0; i < n; ++i) {
+            int r = 0;
+            for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+            if (i < r) swaps_.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(r)});
+        }
+        // Twiddles are stored stage by stage (1, 2, 4, ... entries) so every butterfly
+        // pass reads them with unit stride, and computed in double so long runs do not
+        // accumulate phase error.
+        forward_.clear();
+        inverse_.clear();
+        forward_.reserve(std::max(1, n - 1));
+        inverse_.reserve(std::max(1, n - 1));
+        for (int half = 1; half < n; half <<= 1) {
+            for (int k = 0; k < half; ++k) {
+                const double angle = -3.14159265358979323846 * k / half;
+                forward_.push_back(Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))));
+                inverse_.push_back(std::conj(forward_.back()));
+            }
+        }
+    }
+
+    int size() const { return n_; }
+
+    void Forward(Complex* data) const { Transform<false>(data); }
+    void Inverse(Complex* data) const { Transform<true>(data); }
+
+  private:
+    template <bool kInverse>
+    void Transform(Complex* data) const {
+        for (const std::pair<uint32_t, uint32_t>& s : swaps_) std::swap(data[s.first], data[s.second]);
+        // Written on raw floats: std::complex multiplication checks for NaN/inf.
+        float* v = reinterpret_cast<float*>(data);
+        const float* stageTwiddles = reinterpret_cast<const float*>(kInverse ? inverse_.data() : forward_.data());
+        for (int half = 1; half < n_; half <<= 1) {
+            for (int start = 0; start < n_; start += 2 * half) {
+                float* a = v + 2 * start;
+                float* b = a + 2 * half;
+                for (int k = 0; k < half; ++k) {
+                    const float wr = stageTwiddles[2 * k];
+                    const float wi = stageTwiddles[2 * k + 1];
+                    const float br = b[2 * k];
+                    const float bi = b[2 * k + 1];
+                    const float tr = br * wr - bi * wi;
+                    const float ti = br * wi + bi * wr;
+                    b[2 * k] = a[2 * k] - tr;
+                    b[2 * k + 1] = a[2 * k + 1] - ti;
+                    a[2 * k] += tr;
+                    a[2 * k + 1] += ti;
+                }
+            }
+            stageTwiddles += 2 * half;
+        }
+    }
+
+    int n_ = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> swaps_;
+    std::vector<Complex> forward_;
+    std::vector<Complex> inverse_;
+};
+
+// 2D transform of a row-major rows x cols grid: every row in place, then every column.
+// Columns are gathered in blocks into a column-major scratch copy, transformed there
+// and scattered back, so the strided pass touches each cache line once per block.
+// With `parallel` both passes are split across the shared thread pool; do not call it
+// from inside a pool task.
+class Plan2D {
+  public:
+    static constexpr int kColumnBlock = 8;
+
+    void Resize(int rows, int cols) {
+        rows_ = rows;
+        cols_ = cols;
+        rowPlan_.Resize(cols);
+        columnPlan_.Resize(rows);
+        scratch_.resize(static_cast<size_t>(rows) * cols);
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+    void Forward(Complex* data, bool parallel) { Transform<false>(data, parallel); }
+    void Inverse(Complex* data, bool parallel) { Transform<true>(data, parallel); }
+
+  private:
+    template <bool kInverse>
+    void Transform(Complex* data, bool parallel) {
+        const auto rowPass = [&](int begin, int end) {
+            for (int r = begin; r < end; ++r) {
+                Complex* row = data + static_cast<size_t>(r) * cols_;
+                if (kInverse) {
+                    rowPlan_.Inverse(row);
+                } else {
+                    rowPlan_.Forward(row);
+                }
+            }
+        };
+        const auto columnPass = [&](int blockBegin, int blockEnd) {
+            for (int block = blockBegin; block < blockEnd; ++block) {
+                const int c0 = block * kColumnBlock;
+                const int c1 = std::min(cols_, c0 + kColumnBlock);
+                Complex* columns = scratch_.data() + static_cast<size_t>(c0) * rows_;
+                for (int r = 0; r < rows_; ++r) {
+                    const Complex* row = data + static_cast<size_t>(r) * cols_;
+                    for (int c = c0; c < c1; ++c) columns[static_cast<size_t>(c - c0) * rows_ + r] = row[c];
+                }
+                for (int c = c0; c < c1; ++c) {
+                    Complex* column = columns + static_cast<size_t>(c - c0) * rows_;
+                    if (kInverse) {
+                        columnPlan_.Inverse(column);
+                    } else {
+                        columnPlan_.Forward(column);
+                    }
+                }
+                for (int r = 0; r < rows_; ++r) {
+                    Complex* row = data + static_cast<size_t>(r) * cols_;
+                    for (int c = c0; c < c1; ++c) row[c] = columns[static_cast<size_t>(c - c0) * rows_ + r];
+                }
+            }
+        };
+
+        const int blocks = (cols_ + kColumnBlock - 1) / kColumnBlock;
+        if (parallel) {
+            astro_parallel::SharedPool().ParallelFor(rows_, 8, rowPass);
+            astro_parallel::SharedPool().ParallelFor(blocks, 1, columnPass);
+        } else {
+            rowPass(0, rows_);
+            columnPass(0, blocks);
+        }
+    }
+
+    int rows_ = 0;
+    int cols_ = 0;
+    Plan1D rowPlan_;
+    Plan1D columnPlan_;
+    std::vector<Complex> scratch_;
+};
+
+}  // namespace astro_fft
@@ -0,0 +1,315 @@
+#pragma once
+
+#include "integrators.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Magnetic field-line tracing for the magnetosphere demos.
+//
+// Lines are streamlines of the unit field direction, integrated in arc length with the
+// Dormand-Prince 5(4) pair from integrators.h. The field is any functor
+//
+//   void field(float x, float y, float z, float b[3]);
+//
+// so scenes can trace their own models; MagnetosphereField below is the shared one.
+// FieldLineCache traces a seed set on its own worker thread and hands the finished
+// polylines to the render thread, which keeps drawing the previous set until then.
+
+namespace astro_fieldlines {
+
+// Planet-centred model, sun towards -x: a tilted dipole, its Chapman-Ferraro image
+// (dayside compression), a tail current sheet that stretches the nightside lobes, and
+// a uniform interplanetary field. Without a dipole, obstacleRadius > 0 adds the induced
+// field of a conducting obstacle so the IMF drapes around it instead.
+struct MagnetosphereField {
+    float moment = 0.0f;        // dipole moment; equatorial field is moment / r^3
+    float tilt = 0.0f;          // dipole axis rotation about z, radians (axis = (-sin, cos, 0))
+    float standoff = 10.0f;     // magnetopause nose distance; the image dipole sits at -2 * standoff
+    float imageStrength = 1.0f; // 1 doubles the field at the nose
+    float tailField = 0.0f;     // lobe field of the tail current sheet
+    float tailLength = 20.0f;
+    float sheetThickness = 0.5f;
+    float obstacleRadius = 0.0f;
+    std::array<float, 3> imf{};
+
+    void operator()(float x, float y, float z, float* b) const {
+        b[0] = imf[0];
+        b[1] = imf[1];
+        b[2] = imf[2];
+        const float ax = -std::sin(tilt), ay = std::cos(tilt);
+        if (moment != 0.0f) {
+            AddDipole(x, y, z, ax, ay, 0.0f, moment, b);
+            AddDipole(x + 2.0f * standoff, y, z, ax, ay, 0.0f, moment * imageStrength, b);
+        }
+        if (tailField != 0.0f && x > 0.0f) {
+            // Lobe field along +x north of the sheet and -x south of it, switched on past the
+            // terminator and fading down the tail and away from the axis.
+            const float onset = std::min(1.0f, x / std::max(1e-3f, standoff));
+            const float fade = onset * onset / (1.0f + x / tailLength);
+            const float lobe = std::exp(-(y * y + z * z) / (2.0f * standoff * standoff));
+            b[0] += tailField * std::tanh(y / sheetThickness) * fade * lobe;
+        }
+        if (obstacleRadius > 0.0f) {
+            // Dipole of moment -R^3 / 2 along the IMF cancels the normal field on the sphere.
+            const float strength = std::sqrt(imf[0] * imf[0] + imf[1] * imf[1] + imf[2] * imf[2]);
+            if (strength > 0.0f) {
+                const float k = -0.5f * obstacleRadius * obstacleRadius * obstacleRadius * strength;
+                AddDipole(x, y, z, imf[0] / strength, imf[1] / strength, imf[2] / strength, k, b);
+            }
+        }
+    }
+
+    static void AddDipole(float x, float y, float z, float ax, float ay, float az, float m, float* b) {
+        const float r2 = std::max(1e-6f, x * x + y * y + z * z);
+        const float invR = 1.0f / std::sqrt(r2);
+        const float invR3 = invR * invR * invR;
+        const float along = (ax * x + ay * y + az * z) * invR;
+        b[0] += m * invR3 * (3.0f * along * x * invR - ax);
+        b[1] += m * invR3 * (3.0f * along * y * invR - ay);
+        b[2] += m * invR3 * (3.0f * along * z * invR - az);
+    }
+};
+
+struct TraceOptions {
+    float sampleSpacing = 0.1f;  // arc length between emitted vertices
+    float maxLength = 60.0f;     // arc length per direction
+    float innerRadius = 1.0f;    // lines end on the body
+    float outerRadius = 30.0f;   // and when they leave the cylinder of this radius about x
+    float minX = -30.0f;         // or its end caps
+    float maxX = 30.0f;
+    float tolerance = 1e-4f;     // absolute and relative, per component
+};
+
+enum class LineEnd : unsigned char {
+    kBody,     // reached innerRadius: a closed line when both ends do
+    kEscaped,  // left the bounding cylinder
+    kStalled,  // null point or maxLength
+};
+
+struct Seed {
+    std::array<float, 3> pos{};
+    float direction = 1.0f;  // +1 follows B, -1 runs against it
+    bool bothWays = false;   // also trace backwards and join the halves
+    bool keepClosed = true;  // false drops lines that return to the body (the other footpoint keeps them)
+};
+
+struct FieldLineSet {
+    std::vector<float> xyz;          // vertices of all lines, packed
+    std::vector<int> lineStart;      // vertex offset of each line, plus one past the end
+    std::vector<unsigned char> closed;
+
+    int lineCount() const { return static_cast<int>(closed.size()); }
+    int vertexCount() const { return static_cast<int>(xyz.size() / 3); }
+
+    void Clear() {
+        xyz.clear();
+        lineStart.assign(1, 0);
+        closed.clear();
+    }
+};
+
+// Footpoints on a magnetic latitude/longitude grid at `radius` around a dipole model,
+// aimed away from the body. Closed lines would be found from both ends, so they are kept
+// from the northern footpoint only.
+inline std::vector<Seed> DipoleFootpointSeeds(const MagnetosphereField& field, float radius, int latitudes, int longitudes,
+                                              float latMin, float latMax) {
+    std::vector<Seed> seeds;
+    seeds.reserve(static_cast<size_t>(2 * latitudes * longitudes));
+    const float ct = std::cos(field.tilt), st = std::sin(field.tilt);
+    for (int hemisphere = -1; hemisphere <= 1; hemisphere += 2) {
+        for (int i = 0; i < latitudes; ++i) {
+            const float u = latitudes > 1 ? static_cast<float>(i) / (latitudes - 1) : 0.0f;
+            const float lat = hemisphere * (latMin + (latMax - latMin) * u);
+            for (int j = 0; j < longitudes; ++j) {
+                // Alternate rows are staggered by half a cell.
+                const float lon = 6.2831853f * (j + 0.5f * (i & 1)) / longitudes;
+                const float mx = radius * std::cos(lat) * std::cos(lon);
+                const float my = radius * std::sin(lat);
+                Seed seed;
+                seed.pos = {mx * ct - my * st, mx * st + my * ct, radius * std::cos(lat) * std::sin(lon)};
+                float b[3];
+                field(seed.pos[0], seed.pos[1], seed.pos[2], b);
+                seed.direction = b[0] * seed.pos[0] + b[1] * seed.pos[1] + b[2] * seed.pos[2] > 0.0f ? 1.0f : -1.0f;
+                seed.keepClosed = hemisphere > 0;
+                seeds.push_back(seed);
+            }
+        }
+    }
+    return seeds;
+}
+
+// Traces one direction from `start` and appends the vertices after it to `out`.
+template <typename Field>
+LineEnd TraceHalf(const Field& field, std::array<float, 3> start, float direction, const TraceOptions& options,
+                  std::vector<float>* out) {
+    astro_integrate::AdaptiveStepper ctl;
+    ctl.relTol = options.tolerance;
+    ctl.absTol = options.tolerance;
+    ctl.maxStep = options.sampleSpacing;
+    ctl.minStep = 1e-3f * options.sampleSpacing;
+    ctl.maxAttempts = 64;
+
+    auto tangent = [&](const std::array<float, 3>& p, std::array<float, 3>& dp) {
+        float b[3];
+        field(p[0], p[1], p[2], b);
+        const float mag = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+        const float scale = mag > 1e-12f ? direction / mag : 0.0f;
+        dp = {b[0] * scale, b[1] * scale, b[2] * scale};
+    };
+
+    const float inner2 = options.innerRadius * options.innerRadius;
+    const float outer2 = options.outerRadius * options.outerRadius;
+    std::array<float, 3> p = start;
+    for (float length = 0.0f; length < options.maxLength; length += options.sampleSpacing) {
+        const std::array<float, 3> prev = p;
+        astro_integrate::DormandPrince45Advance(p, options.sampleSpacing, tangent, ctl);
+        const float dx = p[0] - prev[0], dy = p[1] - prev[1], dz = p[2] - prev[2];
+        if (dx * dx + dy * dy + dz * dz < 1e-4f * options.sampleSpacing * options.sampleSpacing) return LineEnd::kStalled;
+
+        const float r2 = p[0] * p[0] + p[1] * p[1] + p[2] * p[2];
+        if (r2 < inner2) {
+            // Clip the last segment to the surface.
+            const float p2 = prev[0] * prev[0] + prev[1] * prev[1] + prev[2] * prev[2];
+            const float t = std::clamp((std::sqrt(p2) - options.innerRadius) / std::max(1e-6f, std::sqrt(p2) - std::sqrt(r2)), 0.0f, 1.0f);
+            for (int k = 0; k < 3; ++k) out->push_back(prev[k] + t * (p[k] - prev[k]));
+            return LineEnd::kBody;
+        }
+        for (int k = 0; k < 3; ++k) out->push_back(p[k]);
+        if (p[1] * p[1] + p[2] * p[2] > outer2 || p[0] < options.minX || p[0] > options.maxX) return LineEnd::kEscaped;
+    }
+    return LineEnd::kStalled;
+}
+
+// Traces every seed into `lines`, replacing its contents.
+template <typename Field>
+void TraceFieldLines(const Field& field, const std::vector<Seed>& seeds, const TraceOptions& options, FieldLineSet* lines) {
+    lines->Clear();
+    std::vector<float> back;
+    for (const Seed& seed : seeds) {
+        const size_t mark = lines->xyz.size();
+        LineEnd tail = LineEnd::kStalled;
+        if (seed.bothWays) {
+            back.clear();
+            tail = TraceHalf(field, seed.pos, -seed.direction, options, &back);
+            for (size_t i = back.size(); i >= 3; i -= 3) lines->xyz.insert(lines->xyz.end(), back.begin() + (i - 3), back.begin() + i);
+        }
+        lines->xyz.insert(lines->xyz.end(), seed.pos.begin(), seed.pos.end());
+        const LineEnd head = TraceHalf(field, seed.pos, seed.direction, options, &lines->xyz);
+        const bool closed = head == LineEnd::kBody && (!seed.bothWays || tail == LineEnd::kBody);
+        if ((closed && !seed.keepClosed) || lines->xyz.size() - mark < 6) {
+            lines->xyz.resize(mark);
+            continue;
+        }
+        lines->lineStart.push_back(static_cast<int>(lines->xyz.size() / 3));
+        lines->closed.push_back(closed ? 1 : 0);
+    }
+}
+
+// Background re-tracing for one seed set. Request() queues the newest field and seeds
+// (replacing any request the worker has not started yet); Acquire() swaps in the newest
+// finished set. Both belong to the render thread.
+template <typename Field>
+class FieldLineCache {
+  public:
+    FieldLineCache() { front_.Clear(); }
+    ~FieldLineCache() { Stop(); }
+
+    FieldLineCache(const FieldLineCache&) = delete;
+    FieldLineCache& operator=(const FieldLineCache&) = delete;
+
+    void Request(const Field& field, std::vector<Seed> seeds, const TraceOptions& options) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pendingField_ = field;
+            pendingSeeds_.swap(seeds);
+            pendingOptions_ = options;
+            pending_ = true;
+            stop_ = false;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ready_) return false;
+        std::swap(front_, finished_);
+        ready_ = false;
+        ++version_;
+        return true;
+    }
+
+    // Traces synchronously on the calling thread (start-up and headless runs).
+    void TraceNow(const Field& field, const std::vector<Seed>& seeds, const TraceOptions& options) {
+        TraceFieldLines(field, seeds, options, &front_);
+        ++version_;
+    }
+
+    bool Busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_ || tracing_;
+    }
+
+    const FieldLineSet& lines() const { return front_; }
+    uint64_t version() const { return version_; }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    void WorkerLoop() {
+        Field field{};
+        std::vector<Seed> seeds;
+        TraceOptions options;
+        FieldLineSet scratch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            field = pendingField_;
+            seeds.swap(pendingSeeds_);
+            options = pendingOptions_;
+            pending_ = false;
+            tracing_ = true;
+            lock.unlock();
+
+            TraceFieldLines(field, seeds, options, &scratch);
+
+            lock.lock();
+            std::swap(scratch, finished_);
+            ready_ = true;
+            tracing_ = false;
+        }
+    }
+
+    FieldLineSet front_;
+    FieldLineSet finished_;
+    uint64_t version_ = 0;
+
+    Field pendingField_{};
+    std::vector<Seed> pendingSeeds_;
+    TraceOptions pendingOptions_;
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool pending_ = false;
+    bool tracing_ = false;
+    bool ready_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_fieldlines
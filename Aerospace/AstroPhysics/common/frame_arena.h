@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator for buffers that live for one frame or one step.
+//
+//   std::pmr::vector<Vector3> points(&astro_frame::SharedArena());
+//
+// Allocation moves a pointer through one block; deallocation does nothing, and the
+// whole arena is rewound at once: astro_capture::CaptureFrame() resets the shared
+// arena every frame, and an ArenaScope rewinds to where it started when it goes out of
+// scope, for code that also runs headless (physics steps) where no frame ends. When a
+// frame needs more than the block holds, the excess comes from the heap and the block
+// grows to the high-water mark at the next reset, so steady state allocates nothing.
+//
+// The shared arena belongs to the window thread; worker threads keep their own.
+
+namespace astro_frame {
+
+constexpr size_t kDefaultArenaBytes = 256 * 1024;
+
+class FrameArena final : public std::pmr::memory_resource {
+  public:
+    explicit FrameArena(size_t bytes = kDefaultArenaBytes) { Grow(bytes); }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    struct Mark {
+        size_t offset = 0;
+        size_t overflowCount = 0;
+    };
+
+    Mark mark() const { return Mark{offset_, overflow_.size()}; }
+
+    // Frees everything allocated since `mark`. Storage handed out before it stays valid.
+    void Rewind(Mark mark) {
+        offset_ = mark.offset;
+        while (overflow_.size() > mark.overflowCount) {
+            const Overflow& spill = overflow_.back();
+            std::pmr::new_delete_resource()->deallocate(spill.data, spill.bytes, spill.align);
+            overflowBytes_ -= spill.bytes;
+            overflow_.pop_back();
+        }
+    }
+
+    // Frees everything; grows the block first if the last frame spilled to the heap.
+    void Reset() {
+        Rewind(Mark{});
+        if (peak_ > capacity_) Grow(peak_ + peak_ / 2);
+        peak_ = 0;
+    }
+
+    size_t used() const { return offset_ + overflowBytes_; }
+    size_t peak() const { return peak_; }
+    size_t capacity() const { return capacity_; }
+
+  private:
+    struct Overflow {
+        void* data;
+        size_t bytes;
+        size_t align;
+    };
+
+    void Grow(size_t bytes) {
+        block_.reset(new std::byte[bytes]);
+        capacity_ = bytes;
+        offset_ = 0;
+    }
+
+    void* do_allocate(size_t bytes, size_t align) override {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block_.get());
+        const uintptr_t start = (base + offset_ + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        void* data = nullptr;
+        if (start + bytes <= base + capacity_) {
+            offset_ = static_cast<size_t>(start - base) + bytes;
+            data = reinterpret_cast<void*>(start);
+        } else {
+            data = std::pmr::new_delete_resource()->allocate(bytes, align);
+            overflow_.push_back(Overflow{data, bytes, align});
+            overflowBytes_ += bytes;
+        }
+        peak_ = std::max(peak_, used());
+        return data;
+    }
+
+    void do_deallocate(void* /*p*/, size_t /*bytes*/, size_t /*align*/) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::unique_ptr<std::byte[]> block_;
+    size_t capacity_ = 0;
+    size_t offset_ = 0;
+    std::vector<Overflow> overflow_;
+    size_t overflowBytes_ = 0;
+    size_t peak_ = 0;
+};
+
+inline FrameArena& SharedArena() {
+    static FrameArena arena;
+    return arena;
+}
+
+// Rewinds the arena to where it stood at construction. Declare it before the buffers
+// it covers, so they are destroyed first.
+class ArenaScope {
+  public:
+    explicit ArenaScope(FrameArena& arena = SharedArena()) : arena_(arena), mark_(arena.mark()) {}
+    ~ArenaScope() { arena_.Rewind(mark_); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    FrameArena& arena() const { return arena_; }
+
+  private:
+    FrameArena& arena_;
+    FrameArena::Mark mark_;
+};
+
+}  // namespace astro_frame
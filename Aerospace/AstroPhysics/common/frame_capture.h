@@ -0,0 +1,356 @@
+#pragma once
+
+#include "frame_arena.h"
+#include "profiler.h"
+#include "raylib.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Screen capture for recording the demos without stalling the render thread.
+//
+// Every demo calls astro_capture::CaptureFrame() just before EndDrawing(). Nothing
+// happens unless the ASTRO_CAPTURE environment variable names an output:
+//
+//   ASTRO_CAPTURE=talk.mp4              raw frames piped to ffmpeg (any name without '%')
+//   ASTRO_CAPTURE=frames/shot_%05d.png  image sequence; .png via raylib, anything else PPM
+//   ASTRO_CAPTURE_FPS=30                frame rate handed to ffmpeg (default 60)
+//
+// On OpenGL 3.3+ each frame is read into a ring of pixel-pack buffers and only mapped two
+// frames later, so the readback overlaps the following frames instead of waiting for the
+// GPU. An encoder thread reads the mapped buffers in place and feeds ffmpeg or image
+// files. Older contexts fall back to a synchronous rlReadScreenPixels(); encoding stays
+// off-thread.
+
+#if defined(_WIN32) && !defined(_WIN64)
+#define ASTRO_GL_CALL __stdcall
+#else
+#define ASTRO_GL_CALL
+#endif
+
+extern "C" void* glfwGetProcAddress(const char* procname);  // raylib's desktop platform is GLFW
+
+namespace astro_capture {
+
+constexpr int kDefaultFps = 60;
+
+// The handful of GL 3.x entry points rlgl does not wrap, loaded through GLFW.
+struct GlReadback {
+    struct SyncObject;
+    using Sync = SyncObject*;  // GLsync
+    void(ASTRO_GL_CALL* GenBuffers)(int, unsigned*) = nullptr;
+    void(ASTRO_GL_CALL* DeleteBuffers)(int, const unsigned*) = nullptr;
+    void(ASTRO_GL_CALL* BindBuffer)(unsigned, unsigned) = nullptr;
+    void(ASTRO_GL_CALL* BufferData)(unsigned, std::ptrdiff_t, const void*, unsigned) = nullptr;
+    void*(ASTRO_GL_CALL* MapBufferRange)(unsigned, std::ptrdiff_t, std::ptrdiff_t, unsigned) = nullptr;
+    unsigned char(ASTRO_GL_CALL* UnmapBuffer)(unsigned) = nullptr;
+    void(ASTRO_GL_CALL* ReadPixels)(int, int, int, int, unsigned, unsigned, void*) = nullptr;
+    Sync(ASTRO_GL_CALL* FenceSync)(unsigned, unsigned) = nullptr;
+    unsigned(ASTRO_GL_CALL* ClientWaitSync)(Sync, unsigned, uint64_t) = nullptr;
+    void(ASTRO_GL_CALL* DeleteSync)(Sync) = nullptr;
+
+    static constexpr unsigned kPixelPackBuffer = 0x88EB;
+    static constexpr unsigned kStreamRead = 0x88E1;
+    static constexpr unsigned kMapRead = 0x0001;
+    static constexpr unsigned kRgba = 0x1908;
+    static constexpr unsigned kUnsignedByte = 0x1401;
+    static constexpr unsigned kSyncGpuCommandsComplete = 0x9117;
+    static constexpr unsigned kSyncFlushCommands = 0x0001;
+
+    bool Load() {
+        const int version = rlGetVersion();
+        if (version != RL_OPENGL_33 && version != RL_OPENGL_43) return false;
+        return Get(&GenBuffers, "glGenBuffers") && Get(&DeleteBuffers, "glDeleteBuffers") &&
+               Get(&BindBuffer, "glBindBuffer") && Get(&BufferData, "glBufferData") &&
+               Get(&MapBufferRange, "glMapBufferRange") && Get(&UnmapBuffer, "glUnmapBuffer") &&
+               Get(&ReadPixels, "glReadPixels") && Get(&FenceSync, "glFenceSync") &&
+               Get(&ClientWaitSync, "glClientWaitSync") && Get(&DeleteSync, "glDeleteSync");
+    }
+
+  private:
+    template <typename Fn>
+    static bool Get(Fn* fn, const char* name) {
+        *fn = reinterpret_cast<Fn>(glfwGetProcAddress(name));
+        return *fn != nullptr;
+    }
+};
+
+class FrameCapture {
+  public:
+    ~FrameCapture() { Stop(); }
+
+    bool active() const { return active_; }
+
+    // Locks the capture to the current render size. Returns false if the output can't
+    // be opened.
+    bool Start(const std::string& output, int fps) {
+        Stop();
+        width_ = GetRenderWidth();
+        height_ = GetRenderHeight();
+        frameBytes_ = static_cast<size_t>(width_) * static_cast<size_t>(height_) * 4;
+        if (frameBytes_ == 0) return false;
+        async_ = gl_.Load();
+        // glReadPixels rows run bottom-up; the synchronous fallback hands them over flipped.
+        bottomUp_ = async_;
+        output_ = output;
+        sequence_ = output.find('%') != std::string::npos;
+        if (!sequence_) {
+            char command[1024];
+            std::snprintf(command, sizeof(command),
+                          "ffmpeg -loglevel error -y -f rawvideo -pix_fmt rgba -s %dx%d -r %d -i - %s"
+                          "-c:v libx264 -preset veryfast -crf 18 -pix_fmt yuv420p \"%s\"",
+                          width_, height_, std::max(1, fps), bottomUp_ ? "-vf vflip " : "", output.c_str());
+#if defined(_WIN32)
+            pipe_ = _popen(command, "wb");
+#else
+            pipe_ = popen(command, "w");
+#endif
+            if (pipe_ == nullptr) {
+                std::fprintf(stderr, "capture: cannot start ffmpeg for %s\n", output.c_str());
+                return false;
+            }
+        }
+        if (async_) {
+            gl_.GenBuffers(kSlots, buffers_);
+            for (unsigned buffer : buffers_) {
+                gl_.BindBuffer(GlReadback::kPixelPackBuffer, buffer);
+                gl_.BufferData(GlReadback::kPixelPackBuffer, static_cast<std::ptrdiff_t>(frameBytes_), nullptr,
+                               GlReadback::kStreamRead);
+            }
+            gl_.BindBuffer(GlReadback::kPixelPackBuffer, 0);
+        } else {
+            for (std::vector<uint8_t>& owned : owned_) owned.assign(frameBytes_, 0);
+        }
+        for (int slot = 0; slot < kSlots; ++slot) {
+            fences_[slot] = nullptr;
+            pixels_[slot] = nullptr;
+            mapped_[slot] = false;
+        }
+        issued_ = 0;
+        skipped_ = 0;
+        renderSeconds_ = 0.0;
+        worstSeconds_ = 0.0;
+        published_.store(0, std::memory_order_relaxed);
+        encoded_.store(0, std::memory_order_relaxed);
+        stopping_.store(false, std::memory_order_relaxed);
+        encoder_ = std::thread([this]() { EncoderLoop(); });
+        active_ = true;
+        std::fprintf(stderr, "capture: %dx%d to %s (%s readback)\n", width_, height_, output.c_str(),
+                     async_ ? "async" : "synchronous");
+        return true;
+    }
+
+    // Call with the finished frame still in the back buffer, i.e. just before EndDrawing().
+    void Capture() {
+        if (!active_) return;
+        const auto start = std::chrono::steady_clock::now();
+        if (GetRenderWidth() != width_ || GetRenderHeight() != height_) {
+            ++skipped_;
+            return;
+        }
+        rlDrawRenderBatchActive();
+        const int slot = static_cast<int>(issued_ % kSlots);
+        if (issued_ >= static_cast<uint64_t>(kSlots)) Recycle(issued_ - kSlots);
+        if (async_) {
+            gl_.BindBuffer(GlReadback::kPixelPackBuffer, buffers_[slot]);
+            gl_.ReadPixels(0, 0, width_, height_, GlReadback::kRgba, GlReadback::kUnsignedByte, nullptr);
+            gl_.BindBuffer(GlReadback::kPixelPackBuffer, 0);
+            fences_[slot] = gl_.FenceSync(GlReadback::kSyncGpuCommandsComplete, 0);
+            ++issued_;
+            while (published_.load(std::memory_order_relaxed) + kMapLag < issued_) Publish();
+        } else {
+            unsigned char* pixels = rlReadScreenPixels(width_, height_);
+            std::memcpy(owned_[slot].data(), pixels, frameBytes_);
+            std::free(pixels);
+            pixels_[slot] = owned_[slot].data();
+            ++issued_;
+            published_.store(issued_, std::memory_order_release);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        renderSeconds_ += seconds;
+        worstSeconds_ = std::max(worstSeconds_, seconds);
+    }
+
+    // Maps the readbacks still in flight (while the GL context is alive), finishes the
+    // encode and prints the render-thread cost.
+    void Stop() {
+        if (!active_) return;
+        active_ = false;
+        const bool contextAlive = IsWindowReady();
+        if (async_ && contextAlive) {
+            while (published_.load(std::memory_order_relaxed) < issued_) Publish();
+        }
+        stopping_.store(true, std::memory_order_release);
+        encoder_.join();
+        if (async_ && contextAlive) {
+            for (int slot = 0; slot < kSlots; ++slot) {
+                if (mapped_[slot]) Unmap(slot);
+                if (fences_[slot] != nullptr) gl_.DeleteSync(fences_[slot]);
+            }
+            gl_.DeleteBuffers(kSlots, buffers_);
+        }
+        if (pipe_ != nullptr) {
+#if defined(_WIN32)
+            _pclose(pipe_);
+#else
+            pclose(pipe_);
+#endif
+            pipe_ = nullptr;
+        }
+        const double captured = static_cast<double>(std::max<uint64_t>(issued_, 1));
+        std::fprintf(stderr, "capture: %llu frames to %s, %llu skipped after a resize, render thread %.3f ms/frame (worst %.3f)\n",
+                     static_cast<unsigned long long>(encoded_.load()), output_.c_str(),
+                     static_cast<unsigned long long>(skipped_), 1e3 * renderSeconds_ / captured, 1e3 * worstSeconds_);
+    }
+
+  private:
+    // Frames live in slot frame % kSlots from readback until the encoder is done with
+    // them. The render thread advances published_ once a frame's pixels are mapped and the
+    // encoder advances encoded_ once they are written, so the two counters are the whole
+    // queue: no locks, and no copy out of the pixel-pack buffers.
+    static constexpr int kSlots = 6;
+    static constexpr uint64_t kMapLag = 2;  // readbacks left in flight on the GPU
+
+    // Waits for the readback of the oldest unpublished frame, normally finished a couple
+    // of frames ago, and hands its mapped pixels to the encoder.
+    void Publish() {
+        const uint64_t frame = published_.load(std::memory_order_relaxed);
+        const int slot = static_cast<int>(frame % kSlots);
+        gl_.ClientWaitSync(fences_[slot], GlReadback::kSyncFlushCommands, 1000000000ull);
+        gl_.DeleteSync(fences_[slot]);
+        fences_[slot] = nullptr;
+        gl_.BindBuffer(GlReadback::kPixelPackBuffer, buffers_[slot]);
+        pixels_[slot] = static_cast<const uint8_t*>(gl_.MapBufferRange(
+            GlReadback::kPixelPackBuffer, 0, static_cast<std::ptrdiff_t>(frameBytes_), GlReadback::kMapRead));
+        gl_.BindBuffer(GlReadback::kPixelPackBuffer, 0);
+        mapped_[slot] = pixels_[slot] != nullptr;
+        published_.store(frame + 1, std::memory_order_release);
+    }
+
+    // Before a slot is read into again, the encoder must be done with its last frame. A
+    // full ring means the encoder is behind; wait rather than drop, so the recording keeps
+    // every frame.
+    void Recycle(uint64_t frame) {
+        while (encoded_.load(std::memory_order_acquire) <= frame) std::this_thread::yield();
+        const int slot = static_cast<int>(frame % kSlots);
+        if (mapped_[slot]) Unmap(slot);
+    }
+
+    void Unmap(int slot) {
+        gl_.BindBuffer(GlReadback::kPixelPackBuffer, buffers_[slot]);
+        gl_.UnmapBuffer(GlReadback::kPixelPackBuffer);
+        gl_.BindBuffer(GlReadback::kPixelPackBuffer, 0);
+        mapped_[slot] = false;
+    }
+
+    void EncoderLoop() {
+        std::vector<uint8_t> rows(sequence_ ? frameBytes_ : 0);
+        for (;;) {
+            const uint64_t frame = encoded_.load(std::memory_order_relaxed);
+            if (frame == published_.load(std::memory_order_acquire)) {
+                if (stopping_.load(std::memory_order_acquire) && frame == published_.load(std::memory_order_acquire)) break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            const uint8_t* pixels = pixels_[frame % kSlots];
+            if (pixels != nullptr) {
+                if (sequence_) {
+                    WriteImage(pixels, frame, &rows);
+                } else {
+                    std::fwrite(pixels, 1, frameBytes_, pipe_);
+                }
+            }
+            encoded_.store(frame + 1, std::memory_order_release);
+        }
+    }
+
+    void WriteImage(const uint8_t* pixels, uint64_t frame, std::vector<uint8_t>* rows) const {
+        const size_t stride = static_cast<size_t>(width_) * 4;
+        for (int y = 0; y < height_; ++y) {
+            const int source = bottomUp_ ? height_ - 1 - y : y;
+            uint8_t* row = rows->data() + static_cast<size_t>(y) * stride;
+            std::memcpy(row, pixels + static_cast<size_t>(source) * stride, stride);
+            for (size_t x = 3; x < stride; x += 4) row[x] = 255;
+        }
+        char path[1024];
+        std::snprintf(path, sizeof(path), output_.c_str(), static_cast<int>(frame));
+        const size_t length = std::strlen(path);
+        if (length > 4 && std::strcmp(path + length - 4, ".png") == 0) {
+            Image image = {rows->data(), width_, height_, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+            ExportImage(image, path);
+            return;
+        }
+        FILE* file = std::fopen(path, "wb");
+        if (file == nullptr) return;
+        std::fprintf(file, "P6\n%d %d\n255\n", width_, height_);
+        std::vector<uint8_t> rgb(static_cast<size_t>(width_) * 3);
+        for (int y = 0; y < height_; ++y) {
+            const uint8_t* row = rows->data() + static_cast<size_t>(y) * stride;
+            for (int x = 0; x < width_; ++x) std::memcpy(&rgb[static_cast<size_t>(x) * 3], row + x * 4, 3);
+            std::fwrite(rgb.data(), 1, rgb.size(), file);
+        }
+        std::fclose(file);
+    }
+
+    GlReadback gl_;
+    unsigned buffers_[kSlots] = {};
+    GlReadback::Sync fences_[kSlots] = {};
+    const uint8_t* pixels_[kSlots] = {};
+    bool mapped_[kSlots] = {};
+    std::vector<uint8_t> owned_[kSlots];  // synchronous fallback only
+    std::thread encoder_;
+    alignas(64) std::atomic<uint64_t> published_{0};
+    alignas(64) std::atomic<uint64_t> encoded_{0};
+    std::atomic<bool> stopping_{false};
+    std::string output_;
+    FILE* pipe_ = nullptr;
+    bool active_ = false;
+    bool async_ = false;
+    bool bottomUp_ = false;
+    bool sequence_ = false;
+    int width_ = 0;
+    int height_ = 0;
+    size_t frameBytes_ = 0;
+    uint64_t issued_ = 0;
+    uint64_t skipped_ = 0;
+    double renderSeconds_ = 0.0;
+    double worstSeconds_ = 0.0;
+};
+
+inline FrameCapture& SharedCapture() {
+    static FrameCapture capture;
+    return capture;
+}
+
+// Per-frame hook; the first call starts a capture if ASTRO_CAPTURE is set. Also ends
+// the frame for astro_frame::SharedArena(), which every demo gets by making this call.
+inline void CaptureFrame() {
+    astro_frame::SharedArena().Reset();
+    static bool configured = false;
+    FrameCapture& capture = SharedCapture();
+    if (!configured) {
+        configured = true;
+        const char* output = std::getenv("ASTRO_CAPTURE");
+        if (output != nullptr && output[0] != '\0') {
+            const char* fps = std::getenv("ASTRO_CAPTURE_FPS");
+            capture.Start(output, fps != nullptr ? std::atoi(fps) : kDefaultFps);
+        }
+    }
+    ASTRO_PROFILE_SCOPE("capture");
+    capture.Capture();
+}
+
+// Call before CloseWindow() so the last frames still on the GPU reach the output.
+inline void StopCapture() { SharedCapture().Stop(); }
+
+}  // namespace astro_capture
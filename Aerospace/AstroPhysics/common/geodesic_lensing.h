@@ -0,0 +1,386 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Full-screen black-hole lensing: a fragment shader integrates one null geodesic per
+// pixel backwards from the camera, shades the accretion disk wherever the ray crosses
+// its plane, and looks the escaped direction up in a starfield cubemap.
+//
+// Units inside the shader are Schwarzschild radii (rs = 2M = 1). For a photon the
+// spatial orbit obeys x'' = -(3/2) h^2 x / r^5 with h = |x x x'|, which reproduces the
+// Schwarzschild photon sphere (r = 1.5) and shadow edge (b = 3 sqrt(3) / 2) exactly. An
+// optional spin adds the leading gravitomagnetic (frame-dragging) term about the disk
+// normal, which shifts the shadow toward the prograde side the way Kerr does. Steps are
+// kick-drift-kick, proportional to r and shortened near the photon sphere.
+//
+// The pass renders into an offscreen target `renderScale` times smaller than the window
+// and is stretched back with bilinear filtering, so slower GPUs can trade sharpness for
+// frame rate; UpdateAutoScale() does that from the measured frame time.
+
+namespace astro_render {
+
+struct SkyStar {
+    Vector3 dir;  // unit direction on the sky
+    float size;   // gaussian radius in cubemap texels
+    Color color;
+};
+
+struct LensingView {
+    Vector3 center{0.0f, 0.0f, 0.0f};          // black hole position, world units
+    float horizonRadius = 1.0f;                 // Schwarzschild radius, world units
+    Vector3 diskNormal{0.0f, 1.0f, 0.0f};       // also the spin axis
+    float diskInner = 3.0f;                     // world units
+    float diskOuter = 12.0f;
+    float spin = 0.0f;                          // a / M, 0..0.99
+    float diskBrightness = 1.0f;
+    float time = 0.0f;
+};
+
+constexpr int kLensingScales[] = {1, 2, 4};
+constexpr int kLensingScaleCount = static_cast<int>(sizeof(kLensingScales) / sizeof(kLensingScales[0]));
+
+// Splats the stars over a faint galactic band into the RGBA8 pixels of a 6-face
+// horizontal-strip cubemap. CPU only, so it can run off the main thread.
+inline std::vector<unsigned char> BakeStarfieldStrip(const std::vector<SkyStar>& stars, int faceSize, Vector3 bandNormal, float bandStrength) {
+    const int width = 6 * faceSize;
+    std::vector<float> rgb(static_cast<size_t>(width) * faceSize * 3, 0.0f);
+    bandNormal = Vector3Normalize(bandNormal);
+
+    // Texel (s, t) of face f looks along FaceDir (OpenGL cubemap convention).
+    auto faceDir = [](int face, float sc, float tc) -> Vector3 {
+        switch (face) {
+            case 0: return {1.0f, -tc, -sc};
+            case 1: return {-1.0f, -tc, sc};
+            case 2: return {sc, 1.0f, tc};
+            case 3: return {sc, -1.0f, -tc};
+            case 4: return {sc, -tc, 1.0f};
+            default: return {-sc, -tc, -1.0f};
+        }
+    };
+    for (int face = 0; face < 6; ++face) {
+        for (int row = 0; row < faceSize; ++row) {
+            for (int col = 0; col < faceSize; ++col) {
+                const float sc = 2.0f * (col + 0.5f) / faceSize - 1.0f;
+                const float tc = 2.0f * (row + 0.5f) / faceSize - 1.0f;
+                const Vector3 d = Vector3Normalize(faceDir(face, sc, tc));
+                const float h = Vector3DotProduct(d, bandNormal);
+                const float clump = 0.65f + 0.35f * std::sin(9.0f * d.x + 4.0f * std::sin(7.0f * d.z)) * std::cos(6.0f * d.y + 11.0f * d.z);
+                const float band = bandStrength * std::exp(-h * h / 0.018f) * clump;
+                float* px = &rgb[(static_cast<size_t>(row) * width + face * faceSize + col) * 3];
+                px[0] = 0.010f + 0.60f * band;
+                px[1] = 0.012f + 0.52f * band;
+                px[2] = 0.022f + 0.64f * band;
+            }
+        }
+    }
+
+    for (const SkyStar& star : stars) {
+        const Vector3 d = Vector3Normalize(star.dir);
+        const float ax = std::fabs(d.x), ay = std::fabs(d.y), az = std::fabs(d.z);
+        int face;
+        float sc, tc, ma;
+        if (ax >= ay && ax >= az) {
+            face = d.x > 0.0f ? 0 : 1;
+            ma = ax;
+            sc = d.x > 0.0f ? -d.z : d.z;
+            tc = -d.y;
+        } else if (ay >= az) {
+            face = d.y > 0.0f ? 2 : 3;
+            ma = ay;
+            sc = d.x;
+            tc = d.y > 0.0f ? d.z : -d.z;
+        } else {
+            face = d.z > 0.0f ? 4 : 5;
+            ma = az;
+            sc = d.z > 0.0f ? d.x : -d.x;
+            tc = -d.y;
+        }
+        const float cx = 0.5f * (sc / ma + 1.0f) * faceSize - 0.5f;
+        const float cy = 0.5f * (tc / ma + 1.0f) * faceSize - 0.5f;
+        const int reach = static_cast<int>(std::ceil(2.5f * star.size));
+        const float inv = 1.0f / (star.size * star.size);
+        for (int row = std::max(0, static_cast<int>(cy) - reach); row <= std::min(faceSize - 1, static_cast<int>(cy) + reach); ++row) {
+            for (int col = std::max(0, static_cast<int>(cx) - reach); col <= std::min(faceSize - 1, static_cast<int>(cx) + reach); ++col) {
+                const float dx = col - cx, dy = row - cy;
+                const float w = std::exp(-(dx * dx + dy * dy) * inv) * (star.color.a / 255.0f);
+                float* px = &rgb[(static_cast<size_t>(row) * width + face * faceSize + col) * 3];
+                px[0] += w * star.color.r / 255.0f;
+                px[1] += w * star.color.g / 255.0f;
+                px[2] += w * star.color.b / 255.0f;
+            }
+        }
+    }
+
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * faceSize * 4);
+    for (size_t i = 0, n = static_cast<size_t>(width) * faceSize; i < n; ++i) {
+        for (int c = 0; c < 3; ++c) pixels[i * 4 + c] = static_cast<unsigned char>(std::min(1.0f, rgb[i * 3 + c]) * 255.0f + 0.5f);
+        pixels[i * 4 + 3] = 255;
+    }
+    return pixels;
+}
+
+inline TextureCubemap UploadStarfieldStrip(std::vector<unsigned char>& pixels, int faceSize) {
+    Image strip{pixels.data(), 6 * faceSize, faceSize, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    return LoadTextureCubemap(strip, CUBEMAP_LAYOUT_LINE_HORIZONTAL);
+}
+
+inline TextureCubemap BuildStarfieldCubemap(const std::vector<SkyStar>& stars, int faceSize, Vector3 bandNormal, float bandStrength) {
+    std::vector<unsigned char> pixels = BakeStarfieldStrip(stars, faceSize, bandNormal, bandStrength);
+    return UploadStarfieldStrip(pixels, faceSize);
+}
+
+// Renders the lensed sky and disk at reduced resolution and composites it full-screen.
+// Init() after InitWindow(); Render() outside BeginMode3D (it switches to its own
+// target); Draw() after BeginDrawing, before any geometry meant to sit on top.
+// Unload() before CloseWindow(). Init() returns false without GL 3.3 shaders, in which
+// case callers keep their sprite-based lensing.
+class GeodesicLensingPass {
+  public:
+    static constexpr int kMaxSteps = 320;
+
+    bool Init(const std::vector<SkyStar>& stars, int faceSize = 512, Vector3 bandNormal = {0.25f, 0.92f, 0.30f}, float bandStrength = 0.22f) {
+        std::vector<unsigned char> strip = BakeStarfieldStrip(stars, faceSize, bandNormal, bandStrength);
+        return Init(strip, faceSize);
+    }
+
+    // Takes a strip from BakeStarfieldStrip(), baked ahead of time.
+    bool Init(std::vector<unsigned char>& strip, int faceSize) {
+        shader_ = LoadShaderFromMemory(nullptr, kFragmentShader);
+        if (shader_.id == 0 || shader_.id == rlGetShaderIdDefault()) {
+            shader_ = Shader{};
+            return false;
+        }
+        locResolution_ = GetShaderLocation(shader_, "resolution");
+        locCamPos_ = GetShaderLocation(shader_, "camPos");
+        locForward_ = GetShaderLocation(shader_, "camForward");
+        locRight_ = GetShaderLocation(shader_, "camRight");
+        locUp_ = GetShaderLocation(shader_, "camUp");
+        locTanHalfFov_ = GetShaderLocation(shader_, "tanHalfFov");
+        locDiskNormal_ = GetShaderLocation(shader_, "diskNormal");
+        locDiskRadii_ = GetShaderLocation(shader_, "diskRadii");
+        locSpin_ = GetShaderLocation(shader_, "spin");
+        locTime_ = GetShaderLocation(shader_, "time");
+        locDiskGain_ = GetShaderLocation(shader_, "diskGain");
+        locMaxSteps_ = GetShaderLocation(shader_, "maxSteps");
+        locEscape_ = GetShaderLocation(shader_, "escapeRadius");
+        locStarfield_ = GetShaderLocation(shader_, "starfield");
+
+        starfield_ = UploadStarfieldStrip(strip, faceSize);
+        ready_ = starfield_.id != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (target_.id != 0) UnloadRenderTexture(target_);
+        if (starfield_.id != 0) UnloadTexture(starfield_);
+        if (shader_.id != 0) UnloadShader(shader_);
+        target_ = RenderTexture2D{};
+        starfield_ = TextureCubemap{};
+        shader_ = Shader{};
+        ready_ = false;
+    }
+
+    bool ready() const { return ready_; }
+    int renderScale() const { return kLensingScales[scaleIndex_]; }
+    void CycleRenderScale() { scaleIndex_ = (scaleIndex_ + 1) % kLensingScaleCount; }
+
+    // Drops to the next coarser scale after a second below ~45 fps, and back up after
+    // a few seconds comfortably above 60.
+    void UpdateAutoScale(float frameSeconds) {
+        slowTime_ = frameSeconds > 1.0f / 45.0f ? slowTime_ + frameSeconds : 0.0f;
+        fastTime_ = frameSeconds < 1.0f / 75.0f ? fastTime_ + frameSeconds : 0.0f;
+        if (slowTime_ > 1.0f && scaleIndex_ + 1 < kLensingScaleCount) {
+            ++scaleIndex_;
+            slowTime_ = 0.0f;
+        } else if (fastTime_ > 4.0f && scaleIndex_ > 0) {
+            --scaleIndex_;
+            fastTime_ = 0.0f;
+        }
+    }
+
+    void Render(const Camera3D& camera, const LensingView& view) {
+        if (!ready_) return;
+        const int w = std::max(1, GetScreenWidth() / renderScale());
+        const int h = std::max(1, GetScreenHeight() / renderScale());
+        if (target_.id == 0 || target_.texture.width != w || target_.texture.height != h) {
+            if (target_.id != 0) UnloadRenderTexture(target_);
+            target_ = LoadRenderTexture(w, h);
+            SetTextureFilter(target_.texture, TEXTURE_FILTER_BILINEAR);
+        }
+
+        const float invRs = 1.0f / view.horizonRadius;
+        const Vector3 camPos = Vector3Scale(Vector3Subtract(camera.position, view.center), invRs);
+        const Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+        const Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+        const Vector3 up = Vector3CrossProduct(right, forward);
+        const Vector3 normal = Vector3Normalize(view.diskNormal);
+        const std::array<float, 2> resolution = {static_cast<float>(w), static_cast<float>(h)};
+        const std::array<float, 2> radii = {view.diskInner * invRs, view.diskOuter * invRs};
+        const float tanHalfFov = std::tan(0.5f * camera.fovy * DEG2RAD);
+        const float spin = std::clamp(view.spin, 0.0f, 0.99f);
+        const float escape = std::max(30.0f, 1.25f * Vector3Length(camPos));
+        const int maxSteps = kMaxSteps;
+        const int starSlot = 1;
+
+        BeginTextureMode(target_);
+        ClearBackground(BLACK);
+        BeginShaderMode(shader_);
+        SetShaderValue(shader_, locResolution_, resolution.data(), SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader_, locCamPos_, &camPos, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader_, locForward_, &forward, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader_, locRight_, &right, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader_, locUp_, &up, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader_, locTanHalfFov_, &tanHalfFov, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(shader_, locDiskNormal_, &normal, SHADER_UNIFORM_VEC3);
+        SetShaderValue(shader_, locDiskRadii_, radii.data(), SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader_, locSpin_, &spin, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(shader_, locTime_, &view.time, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(shader_, locDiskGain_, &view.diskBrightness, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(shader_, locMaxSteps_, &maxSteps, SHADER_UNIFORM_INT);
+        SetShaderValue(shader_, locEscape_, &escape, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(shader_, locStarfield_, &starSlot, SHADER_UNIFORM_INT);
+        // The batch only binds 2D textures on extra slots, so the cubemap is bound by hand
+        // and the quad flushed while it is live.
+        rlActiveTextureSlot(starSlot);
+        rlEnableTextureCubemap(starfield_.id);
+        rlActiveTextureSlot(0);
+        DrawRectangle(0, 0, w, h, WHITE);
+        rlDrawRenderBatchActive();
+        rlActiveTextureSlot(starSlot);
+        rlDisableTextureCubemap();
+        rlActiveTextureSlot(0);
+        EndShaderMode();
+        EndTextureMode();
+    }
+
+    void Draw(Color tint = WHITE) const {
+        if (!ready_ || target_.id == 0) return;
+        const Rectangle source = {0.0f, 0.0f, static_cast<float>(target_.texture.width), -static_cast<float>(target_.texture.height)};
+        const Rectangle dest = {0.0f, 0.0f, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight())};
+        DrawTexturePro(target_.texture, source, dest, Vector2{0.0f, 0.0f}, 0.0f, tint);
+    }
+
+  private:
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+uniform samplerCube starfield;
+uniform vec2 resolution;
+uniform vec3 camPos;
+uniform vec3 camForward;
+uniform vec3 camRight;
+uniform vec3 camUp;
+uniform float tanHalfFov;
+uniform vec3 diskNormal;
+uniform vec2 diskRadii;
+uniform float spin;
+uniform float time;
+uniform float diskGain;
+uniform int maxSteps;
+uniform float escapeRadius;
+
+vec3 Accel(vec3 p, vec3 v) {
+    float r2 = dot(p, p);
+    float r = sqrt(r2);
+    vec3 l = cross(p, v);
+    vec3 a = -1.5 * dot(l, l) * p / (r2 * r2 * r);
+    if (spin > 0.0) {
+        vec3 j = 0.5 * spin * diskNormal;
+        vec3 n = p / r;
+        vec3 bg = (3.0 * dot(j, n) * n - j) / (r2 * r);
+        a += 2.0 * cross(bg, v);
+    }
+    return a;
+}
+
+vec3 DiskColor(float t) {
+    vec3 c = mix(vec3(0.55, 0.08, 0.02), vec3(1.0, 0.52, 0.16), smoothstep(0.0, 0.45, t));
+    c = mix(c, vec3(1.0, 0.92, 0.78), smoothstep(0.45, 0.9, t));
+    return mix(c, vec3(0.70, 0.82, 1.0), smoothstep(0.9, 1.6, t));
+}
+
+vec4 ShadeDisk(vec3 hit, vec3 v) {
+    float r = length(hit);
+    float inner = diskRadii.x;
+    float outer = diskRadii.y;
+    if (r < inner || r > outer) return vec4(0.0);
+
+    // Novikov-Thorne-like temperature profile, Doppler and gravitational shift g.
+    float x = inner / r;
+    float temp = 2.05 * pow(x, 0.75) * pow(max(1.0 - sqrt(x), 0.0), 0.25);
+    vec3 orbit = normalize(cross(diskNormal, hit));
+    float beta = clamp(sqrt(0.5 / max(r - 1.0, 0.05)), 0.0, 0.92);
+    float gamma = inversesqrt(1.0 - beta * beta);
+    float g = sqrt(max(1.0 - 1.0 / r, 0.0)) / (gamma * (1.0 - beta * dot(orbit, -normalize(v))));
+
+    vec3 e1 = normalize(cross(diskNormal, abs(diskNormal.y) < 0.9 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 e2 = cross(diskNormal, e1);
+    float phi = atan(dot(hit, e2), dot(hit, e1)) - time * sqrt(0.5 / (r * r * r)) * 6.0;
+    float lr = log(r);
+    float streaks = 0.62 + 0.22 * sin(3.0 * phi + 17.0 * lr) + 0.16 * sin(7.0 * phi - 29.0 * lr + 1.3);
+
+    float edge = smoothstep(inner, inner * 1.12, r) * (1.0 - smoothstep(outer * 0.7, outer, r));
+    float alpha = clamp(0.92 * edge * (0.55 + 0.45 * streaks), 0.0, 1.0);
+    vec3 color = DiskColor(temp * g) * diskGain * streaks * pow(g, 3.0) * (0.35 + 1.6 * temp);
+    return vec4(color, alpha);
+}
+
+void main() {
+    vec2 ndc = 2.0 * gl_FragCoord.xy / resolution - 1.0;
+    float aspect = resolution.x / resolution.y;
+    vec3 v = normalize(camForward + tanHalfFov * (ndc.x * aspect * camRight + ndc.y * camUp));
+    vec3 p = camPos;
+
+    float horizon = 0.5 * (1.0 + sqrt(1.0 - spin * spin));
+    vec3 color = vec3(0.0);
+    float cover = 0.0;
+    bool escaped = false;
+    for (int i = 0; i < maxSteps; ++i) {
+        float r = length(p);
+        if (r < horizon) break;
+        if (r > escapeRadius && dot(p, v) > 0.0) {
+            escaped = true;
+            break;
+        }
+        float h = clamp(0.06 * r * (0.2 + 0.8 * smoothstep(0.0, 1.0, abs(r - 1.5))), 0.004, 2.0);
+        vec3 prev = p;
+        v += 0.5 * h * Accel(p, v);
+        p += h * v;
+        v += 0.5 * h * Accel(p, v);
+
+        float d0 = dot(prev, diskNormal);
+        float d1 = dot(p, diskNormal);
+        if (d0 * d1 < 0.0) {
+            vec4 disk = ShadeDisk(mix(prev, p, d0 / (d0 - d1)), v);
+            color += (1.0 - cover) * disk.a * disk.rgb;
+            cover += (1.0 - cover) * disk.a;
+            if (cover > 0.98) break;
+        }
+    }
+    if (escaped) color += (1.0 - cover) * texture(starfield, normalize(v)).rgb;
+    finalColor = vec4(1.0 - exp(-1.4 * color), 1.0);
+}
+)";
+
+    Shader shader_{};
+    TextureCubemap starfield_{};
+    RenderTexture2D target_{};
+    int locResolution_ = -1, locCamPos_ = -1, locForward_ = -1, locRight_ = -1, locUp_ = -1, locTanHalfFov_ = -1;
+    int locDiskNormal_ = -1, locDiskRadii_ = -1, locSpin_ = -1, locTime_ = -1, locDiskGain_ = -1, locMaxSteps_ = -1;
+    int locEscape_ = -1, locStarfield_ = -1;
+    int scaleIndex_ = 1;
+    float slowTime_ = 0.0f, fastTime_ = 0.0f;
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
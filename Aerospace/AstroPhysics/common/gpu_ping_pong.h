@@ -0,0 +1,161 @@
+#pragma once
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#include <algorithm>
+
+// Fragment-shader grid solvers: two RGBA32F render targets of the same size, each pass
+// drawing one from the other. Passes address texels through gl_FragCoord (texel (i, j)
+// is GL pixel (i, j), row 0 at the bottom), so nothing depends on the quad's texture
+// coordinates or on raylib's flipped render-texture convention. Readback is a synchronous
+// glReadPixels of just the rectangle asked for.
+//
+// Init() after InitWindow() returns false without GL 3.3 or float render targets; the
+// callers keep a CPU path for that case.
+
+#ifndef ASTRO_GL_CALL
+#if defined(_WIN32) && !defined(_WIN64)
+#define ASTRO_GL_CALL __stdcall
+#else
+#define ASTRO_GL_CALL
+#endif
+#endif
+
+extern "C" void* glfwGetProcAddress(const char* procname);  // raylib's desktop platform is GLFW
+
+namespace astro_gpu {
+
+// Loads a fragment shader over raylib's default vertex shader; false if it did not compile.
+inline bool LoadPassShader(const char* fragment, Shader* shader) {
+    *shader = LoadShaderFromMemory(nullptr, fragment);
+    if (shader->id == 0 || shader->id == rlGetShaderIdDefault()) {
+        *shader = Shader{};
+        return false;
+    }
+    return true;
+}
+
+inline void UnloadPassShader(Shader* shader) {
+    if (shader->id != 0 && shader->id != rlGetShaderIdDefault()) UnloadShader(*shader);
+    *shader = Shader{};
+}
+
+// Draws a quad covering the active target with `source` bound as texture0.
+inline void DrawTargetQuad(const Texture2D& source, int width, int height) {
+    const float w = static_cast<float>(width), h = static_cast<float>(height);
+    rlSetTexture(source.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex2f(0.0f, 0.0f);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex2f(0.0f, h);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex2f(w, h);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex2f(w, 0.0f);
+    rlEnd();
+    rlSetTexture(0);
+}
+
+class FloatPingPong {
+  public:
+    bool Init(int width, int height) {
+        Unload();
+        const int version = rlGetVersion();
+        if (version != RL_OPENGL_33 && version != RL_OPENGL_43) return false;
+        readPixels_ = reinterpret_cast<ReadPixelsFn>(glfwGetProcAddress("glReadPixels"));
+        if (readPixels_ == nullptr) return false;
+        width_ = width;
+        height_ = height;
+        for (RenderTexture2D& target : targets_) {
+            target.texture.id = rlLoadTexture(nullptr, width, height, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+            target.texture.width = width;
+            target.texture.height = height;
+            target.texture.mipmaps = 1;
+            target.texture.format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32;
+            target.id = rlLoadFramebuffer();
+            rlFramebufferAttach(target.id, target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+            if (target.texture.id == 0 || !rlFramebufferComplete(target.id)) {
+                Unload();
+                return false;
+            }
+        }
+        current_ = 0;
+        ready_ = true;
+        return true;
+    }
+
+    void Unload() {
+        for (RenderTexture2D& target : targets_) {
+            if (target.texture.id != 0) rlUnloadTexture(target.texture.id);
+            if (target.id != 0) rlUnloadFramebuffer(target.id);
+            target = RenderTexture2D{};
+        }
+        ready_ = false;
+    }
+
+    bool ready() const { return ready_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const Texture2D& current() const { return targets_[current_].texture; }
+
+    // Renders `shader` into the other target with current() as texture0, then swaps.
+    // setUniforms() runs inside the shader mode, before the quad.
+    template <typename Uniforms>
+    void Pass(const Shader& shader, Uniforms&& setUniforms) {
+        if (!ready_) return;
+        rlDrawRenderBatchActive();
+        rlDisableColorBlend();
+        BeginTextureMode(targets_[1 - current_]);
+        BeginShaderMode(shader);
+        setUniforms();
+        DrawTargetQuad(targets_[current_].texture, width_, height_);
+        EndShaderMode();
+        EndTextureMode();
+        rlEnableColorBlend();
+        current_ = 1 - current_;
+    }
+
+    // Renders `shader` over current() into an ordinary render texture, e.g. for display.
+    template <typename Uniforms>
+    void Render(const RenderTexture2D& target, const Shader& shader, Uniforms&& setUniforms) const {
+        if (!ready_) return;
+        BeginTextureMode(target);
+        BeginShaderMode(shader);
+        setUniforms();
+        DrawTargetQuad(targets_[current_].texture, target.texture.width, target.texture.height);
+        EndShaderMode();
+        EndTextureMode();
+    }
+
+    // Replaces the current state with width x height RGBA floats, row 0 first.
+    void Upload(const float* rgba) {
+        if (!ready_) return;
+        rlUpdateTexture(targets_[current_].texture.id, 0, 0, width_, height_, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, rgba);
+    }
+
+    // RGBA floats of the current state over [x, x + w) x [y, y + h), row y first.
+    void Read(int x, int y, int w, int h, float* rgba) {
+        if (!ready_) return;
+        rlDrawRenderBatchActive();
+        rlEnableFramebuffer(targets_[current_].id);
+        readPixels_(std::clamp(x, 0, width_ - 1), std::clamp(y, 0, height_ - 1), w, h, kRgba, kFloat, rgba);
+        rlDisableFramebuffer();
+    }
+
+  private:
+    using ReadPixelsFn = void(ASTRO_GL_CALL*)(int, int, int, int, unsigned, unsigned, void*);
+    static constexpr unsigned kRgba = 0x1908;
+    static constexpr unsigned kFloat = 0x1406;
+
+    bool ready_ = false;
+    int width_ = 0;
+    int height_ = 0;
+    int current_ = 0;
+    RenderTexture2D targets_[2] = {};
+    ReadPixelsFn readPixels_ = nullptr;
+};
+
+}  // namespace astro_gpu
@@ -0,0 +1,433 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace astro_render {
+
+// One batch of sparks, launched from `origin` into a cone of half-angle `spread`
+// (radians, PI for every direction) around `direction`.
+struct SparkBurst {
+    Vector3 origin{0.0f, 0.0f, 0.0f};
+    Vector3 direction{0.0f, 1.0f, 0.0f};
+    float spread = PI;
+    float speedMin = 1.0f;
+    float speedMax = 2.0f;
+    float lifeMin = 1.0f;
+    float lifeMax = 2.0f;
+    int count = 1024;
+};
+
+// Shared by every spark in the field.
+struct SparkMotion {
+    Vector3 gravity{0.0f, 0.0f, 0.0f};
+    float drag = 0.0f;       // 1/s
+    float curl = 0.0f;       // speed of the divergence-free drift field
+    float curlScale = 1.0f;  // its spatial frequency, 1/scene units
+};
+
+// Ballistic / curl-drift sparks that live entirely on the GPU, on the pattern of
+// GpuWindTracers: each spark is one texel in each of two RGBA32F state textures,
+// (position, age) and (velocity, life), and Step() renders the next state into the
+// other pair of a ping-pong with two colour attachments. Emit() only queues a
+// SparkBurst; the update shader seeds the sparks of queued bursts from a hash of their
+// index, so spawning a hundred thousand sparks costs a few uniforms, not an upload.
+// Sparks occupy a ring of `capacity` slots, and a new burst overwrites the oldest.
+// Draw() expands each live spark into a round billboard from gl_VertexID.
+//
+// Init() after InitWindow(); Step() outside BeginTextureMode; Draw() between
+// BeginMode3D/EndMode3D (additive blending suits it); Unload() before CloseWindow().
+// Init() returns false without GL 3.3 float render targets, in which case callers keep
+// their CPU particles.
+class GpuSparkField {
+  public:
+    static constexpr int kStateWidth = 1024;
+    static constexpr int kMaxBurstsPerPass = 8;
+
+    bool Init(int capacity) {
+        Unload();
+        const int version = rlGetVersion();
+        if (version != RL_OPENGL_33 && version != RL_OPENGL_43) return false;
+        width_ = kStateWidth;
+        height_ = std::max(1, (std::max(1, capacity) + kStateWidth - 1) / kStateWidth);
+        updateShader_ = rlLoadShaderCode(kFullscreenVertexShader, kUpdateFragmentShader);
+        drawShader_ = rlLoadShaderCode(kSparkVertexShader, kSparkFragmentShader);
+        if (updateShader_ == 0 || updateShader_ == rlGetShaderIdDefault() || drawShader_ == 0 || drawShader_ == rlGetShaderIdDefault()) {
+            Unload();
+            return false;
+        }
+        locPosAge_ = rlGetLocationUniform(updateShader_, "posAge");
+        locVelLife_ = rlGetLocationUniform(updateShader_, "velLife");
+        locDt_ = rlGetLocationUniform(updateShader_, "dt");
+        locTime_ = rlGetLocationUniform(updateShader_, "time");
+        locGravity_ = rlGetLocationUniform(updateShader_, "gravity");
+        locMotion_ = rlGetLocationUniform(updateShader_, "motion");
+        locCapacity_ = rlGetLocationUniform(updateShader_, "capacity");
+        locBurstCount_ = rlGetLocationUniform(updateShader_, "burstCount");
+        locBurstRange_ = rlGetLocationUniform(updateShader_, "burstRange");
+        locBurstOrigin_ = rlGetLocationUniform(updateShader_, "burstOrigin");
+        locBurstCone_ = rlGetLocationUniform(updateShader_, "burstCone");
+        locBurstLaunch_ = rlGetLocationUniform(updateShader_, "burstLaunch");
+        locDrawPosAge_ = rlGetLocationUniform(drawShader_, "posAge");
+        locDrawVelLife_ = rlGetLocationUniform(drawShader_, "velLife");
+        locDrawMvp_ = rlGetLocationUniform(drawShader_, "mvp");
+        locDrawRight_ = rlGetLocationUniform(drawShader_, "camRight");
+        locDrawUp_ = rlGetLocationUniform(drawShader_, "camUp");
+        locDrawWidth_ = rlGetLocationUniform(drawShader_, "stateWidth");
+        locDrawSize_ = rlGetLocationUniform(drawShader_, "size");
+        locDrawHot_ = rlGetLocationUniform(drawShader_, "hotColor");
+        locDrawCool_ = rlGetLocationUniform(drawShader_, "coolColor");
+
+        // Every slot starts dead: age 1 past a life of 0.
+        std::vector<float> dead(static_cast<size_t>(width_) * height_ * 4, 0.0f);
+        for (size_t i = 3; i < dead.size(); i += 4) dead[i] = 1.0f;
+        const std::vector<float> zero(dead.size(), 0.0f);
+        for (int k = 0; k < 2; ++k) {
+            posAge_[k] = LoadStateTexture(dead.data());
+            velLife_[k] = LoadStateTexture(zero.data());
+            fbo_[k] = rlLoadFramebuffer();
+            if (posAge_[k] == 0 || velLife_[k] == 0 || fbo_[k] == 0) {
+                Unload();
+                return false;
+            }
+            rlFramebufferAttach(fbo_[k], posAge_[k], RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+            rlFramebufferAttach(fbo_[k], velLife_[k], RL_ATTACHMENT_COLOR_CHANNEL1, RL_ATTACHMENT_TEXTURE2D, 0);
+            rlEnableFramebuffer(fbo_[k]);
+            rlActiveDrawBuffers(2);
+            rlDisableFramebuffer();
+            if (!rlFramebufferComplete(fbo_[k])) {
+                Unload();
+                return false;
+            }
+        }
+        vao_ = rlLoadVertexArray();  // attribute-less: the shaders work from gl_VertexID
+        ready_ = vao_ != 0;
+        if (!ready_) Unload();
+        return ready_;
+    }
+
+    void Unload() {
+        for (int k = 0; k < 2; ++k) {
+            if (fbo_[k] != 0) rlUnloadFramebuffer(fbo_[k]);
+            if (posAge_[k] != 0) rlUnloadTexture(posAge_[k]);
+            if (velLife_[k] != 0) rlUnloadTexture(velLife_[k]);
+            fbo_[k] = posAge_[k] = velLife_[k] = 0;
+        }
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (updateShader_ != 0 && updateShader_ != rlGetShaderIdDefault()) rlUnloadShaderProgram(updateShader_);
+        if (drawShader_ != 0 && drawShader_ != rlGetShaderIdDefault()) rlUnloadShaderProgram(drawShader_);
+        vao_ = updateShader_ = drawShader_ = 0;
+        pending_.clear();
+        ready_ = false;
+    }
+
+    bool ready() const { return ready_; }
+    int capacity() const { return width_ * height_; }
+    long long emitted() const { return emitted_; }
+
+    // Queues a burst for the next Step(); a burst larger than the ring is cut to fit.
+    void Emit(const SparkBurst& burst) {
+        if (!ready_ || burst.count <= 0) return;
+        Pending p;
+        p.burst = burst;
+        p.burst.count = std::min(burst.count, capacity());
+        p.first = next_;
+        next_ = (next_ + p.burst.count) % capacity();
+        emitted_ += p.burst.count;
+        pending_.push_back(p);
+    }
+
+    // Advances every spark by dt and seeds the queued bursts. More than
+    // kMaxBurstsPerPass queued bursts take extra passes with no time step.
+    void Step(float dt, const SparkMotion& motion) {
+        if (!ready_) return;
+        time_ += dt;
+        size_t done = 0;
+        do {
+            const int bursts = static_cast<int>(std::min<size_t>(kMaxBurstsPerPass, pending_.size() - done));
+            Pass(done == 0 ? dt : 0.0f, motion, done, bursts);
+            done += static_cast<size_t>(bursts);
+        } while (done < pending_.size());
+        pending_.clear();
+    }
+
+    // Sparks as round billboards `size` across, from `hot` at birth to `cool` at death.
+    void Draw(float size, Color hot, Color cool) const {
+        if (!ready_) return;
+        rlDrawRenderBatchActive();
+        const Matrix view = rlGetMatrixModelview();
+        const Matrix mvp = MatrixMultiply(view, rlGetMatrixProjection());
+        const std::array<float, 3> right = {view.m0, view.m4, view.m8};
+        const std::array<float, 3> up = {view.m1, view.m5, view.m9};
+        const Vector4 hotColor = ColorNormalize(hot);
+        const Vector4 coolColor = ColorNormalize(cool);
+        const float halfSize = 0.5f * size;
+        rlDisableDepthMask();
+        rlEnableShader(drawShader_);
+        rlSetUniformMatrix(locDrawMvp_, mvp);
+        rlSetUniform(locDrawRight_, right.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locDrawUp_, up.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locDrawWidth_, &width_, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(locDrawSize_, &halfSize, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locDrawHot_, &hotColor, RL_SHADER_UNIFORM_VEC4, 1);
+        rlSetUniform(locDrawCool_, &coolColor, RL_SHADER_UNIFORM_VEC4, 1);
+        BindState(locDrawPosAge_, locDrawVelLife_, current_);
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArray(0, 6 * capacity());
+        rlDisableVertexArray();
+        UnbindState();
+        rlDisableShader();
+        rlEnableDepthMask();
+    }
+
+  private:
+    struct Pending {
+        SparkBurst burst;
+        int first = 0;
+    };
+
+    unsigned int LoadStateTexture(const float* data) const {
+        const unsigned int id = rlLoadTexture(data, width_, height_, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+        if (id == 0) return 0;
+        rlTextureParameters(id, RL_TEXTURE_MIN_FILTER, RL_TEXTURE_FILTER_NEAREST);
+        rlTextureParameters(id, RL_TEXTURE_MAG_FILTER, RL_TEXTURE_FILTER_NEAREST);
+        return id;
+    }
+
+    void Pass(float dt, const SparkMotion& motion, size_t firstBurst, int bursts) {
+        std::array<int, 2 * kMaxBurstsPerPass> range{};
+        std::array<float, 4 * kMaxBurstsPerPass> origin{};
+        std::array<float, 4 * kMaxBurstsPerPass> cone{};
+        std::array<float, 4 * kMaxBurstsPerPass> launch{};
+        for (int b = 0; b < bursts; ++b) {
+            const Pending& p = pending_[firstBurst + static_cast<size_t>(b)];
+            const Vector3 dir = Vector3Length(p.burst.direction) > 1e-6f ? Vector3Normalize(p.burst.direction) : Vector3{0.0f, 1.0f, 0.0f};
+            range[2 * b] = p.first;
+            range[2 * b + 1] = p.burst.count;
+            origin[4 * b] = p.burst.origin.x;
+            origin[4 * b + 1] = p.burst.origin.y;
+            origin[4 * b + 2] = p.burst.origin.z;
+            origin[4 * b + 3] = static_cast<float>((p.first * 7919 + p.burst.count) % 65521) * (1.0f / 65521.0f);  // seed
+            cone[4 * b] = dir.x;
+            cone[4 * b + 1] = dir.y;
+            cone[4 * b + 2] = dir.z;
+            cone[4 * b + 3] = std::cos(std::clamp(p.burst.spread, 0.0f, PI));
+            launch[4 * b] = p.burst.speedMin;
+            launch[4 * b + 1] = p.burst.speedMax;
+            launch[4 * b + 2] = p.burst.lifeMin;
+            launch[4 * b + 3] = std::max(p.burst.lifeMin, p.burst.lifeMax);
+        }
+        const std::array<float, 3> gravity = {motion.gravity.x, motion.gravity.y, motion.gravity.z};
+        const std::array<float, 3> coefficients = {motion.drag, motion.curl, motion.curlScale};
+        const int capacityValue = capacity();
+
+        const int src = current_;
+        const int dst = 1 - current_;
+        rlDrawRenderBatchActive();
+        rlEnableFramebuffer(fbo_[dst]);
+        rlViewport(0, 0, width_, height_);
+        rlDisableColorBlend();
+        rlEnableShader(updateShader_);
+        BindState(locPosAge_, locVelLife_, src);
+        rlSetUniform(locDt_, &dt, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locTime_, &time_, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locGravity_, gravity.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locMotion_, coefficients.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locCapacity_, &capacityValue, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(locBurstCount_, &bursts, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(locBurstRange_, range.data(), RL_SHADER_UNIFORM_IVEC2, kMaxBurstsPerPass);
+        rlSetUniform(locBurstOrigin_, origin.data(), RL_SHADER_UNIFORM_VEC4, kMaxBurstsPerPass);
+        rlSetUniform(locBurstCone_, cone.data(), RL_SHADER_UNIFORM_VEC4, kMaxBurstsPerPass);
+        rlSetUniform(locBurstLaunch_, launch.data(), RL_SHADER_UNIFORM_VEC4, kMaxBurstsPerPass);
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArray(0, 3);
+        rlDisableVertexArray();
+        UnbindState();
+        rlDisableShader();
+        rlEnableColorBlend();
+        rlDisableFramebuffer();
+        rlViewport(0, 0, rlGetFramebufferWidth(), rlGetFramebufferHeight());
+        current_ = dst;
+    }
+
+    void BindState(int locPosAge, int locVelLife, int k) const {
+        const int posSlot = 0;
+        const int velSlot = 1;
+        rlActiveTextureSlot(posSlot);
+        rlEnableTexture(posAge_[k]);
+        rlSetUniform(locPosAge, &posSlot, RL_SHADER_UNIFORM_INT, 1);
+        rlActiveTextureSlot(velSlot);
+        rlEnableTexture(velLife_[k]);
+        rlSetUniform(locVelLife, &velSlot, RL_SHADER_UNIFORM_INT, 1);
+    }
+
+    static void UnbindState() {
+        rlActiveTextureSlot(1);
+        rlDisableTexture();
+        rlActiveTextureSlot(0);
+        rlDisableTexture();
+    }
+
+    static constexpr const char* kFullscreenVertexShader = R"(#version 330
+void main() {
+    vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(2.0 * p - 1.0, 0.0, 1.0);
+}
+)";
+
+    // motion = (drag, curl speed, curl frequency). The drift is the curl of
+    // A = (sin(k z + t), sin(k x + 1.3 t), sin(k y + 1.7 t)) plus a second octave
+    // with the axes cycled the other way. Each component varies only along the other
+    // axes, so the field is divergence-free and sparks neither bunch up nor thin out.
+    static constexpr const char* kUpdateFragmentShader = R"(#version 330
+uniform sampler2D posAge;
+uniform sampler2D velLife;
+uniform float dt;
+uniform float time;
+uniform vec3 gravity;
+uniform vec3 motion;
+uniform int capacity;
+uniform int burstCount;
+uniform ivec2 burstRange[8];
+uniform vec4 burstOrigin[8];
+uniform vec4 burstCone[8];
+uniform vec4 burstLaunch[8];
+layout(location = 0) out vec4 outPosAge;
+layout(location = 1) out vec4 outVelLife;
+const float PI = 3.14159265;
+float Hash(float n) {
+    return fract(sin(n * 12.9898 + 4.1414) * 43758.5453);
+}
+vec3 Drift(vec3 p) {
+    float k = motion.z;
+    vec3 a = k * cos(k * p.yzx + time * vec3(1.7, 1.0, 1.3));
+    vec3 b = (0.5 * k) * cos(2.0 * k * p.zxy + time * vec3(0.9, 2.1, 1.5));
+    return motion.y * (a + b) / (1.5 * k + 1e-6);
+}
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    int index = texel.y * textureSize(posAge, 0).x + texel.x;
+    vec4 pa = texelFetch(posAge, texel, 0);
+    vec4 vl = texelFetch(velLife, texel, 0);
+    for (int b = 0; b < burstCount; ++b) {
+        int offset = index - burstRange[b].x;
+        if (offset < 0) offset += capacity;
+        if (offset >= burstRange[b].y) continue;
+        float seed = burstOrigin[b].w * 977.0 + float(offset) * 0.6180339;
+        float z = mix(burstCone[b].w, 1.0, Hash(seed));
+        float phi = 2.0 * PI * Hash(seed + 17.0);
+        vec3 axis = burstCone[b].xyz;
+        vec3 helper = abs(axis.y) < 0.9 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+        vec3 u = normalize(cross(helper, axis));
+        vec3 v = cross(axis, u);
+        float ring = sqrt(max(0.0, 1.0 - z * z));
+        vec3 dir = axis * z + (u * cos(phi) + v * sin(phi)) * ring;
+        float speed = mix(burstLaunch[b].x, burstLaunch[b].y, Hash(seed + 31.0));
+        float life = mix(burstLaunch[b].z, burstLaunch[b].w, Hash(seed + 53.0));
+        outPosAge = vec4(burstOrigin[b].xyz, 0.0);
+        outVelLife = vec4(dir * speed, life);
+        return;
+    }
+    if (pa.w >= vl.w) {
+        outPosAge = pa;
+        outVelLife = vl;
+        return;
+    }
+    vec3 vel = vl.xyz + dt * (gravity - motion.x * vl.xyz);
+    vec3 pos = pa.xyz + dt * (vel + Drift(pa.xyz));
+    outPosAge = vec4(pos, pa.w + dt);
+    outVelLife = vec4(vel, vl.w);
+}
+)";
+
+    static constexpr const char* kSparkVertexShader = R"(#version 330
+uniform sampler2D posAge;
+uniform sampler2D velLife;
+uniform mat4 mvp;
+uniform vec3 camRight;
+uniform vec3 camUp;
+uniform int stateWidth;
+uniform float size;
+uniform vec4 hotColor;
+uniform vec4 coolColor;
+out vec4 fragColor;
+out vec2 fragLocal;
+void main() {
+    int spark = gl_VertexID / 6;
+    int corner = gl_VertexID % 6;
+    ivec2 texel = ivec2(spark % stateWidth, spark / stateWidth);
+    vec4 pa = texelFetch(posAge, texel, 0);
+    float life = texelFetch(velLife, texel, 0).w;
+    if (pa.w >= life) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);  // dead: outside the clip volume
+        fragColor = vec4(0.0);
+        fragLocal = vec2(0.0);
+        return;
+    }
+    float t = pa.w / life;
+    vec2 local = vec2((corner == 1 || corner == 2 || corner == 4) ? 1.0 : -1.0,
+                      (corner == 2 || corner == 4 || corner == 5) ? 1.0 : -1.0);
+    float radius = size * (1.0 - 0.6 * t);
+    vec3 world = pa.xyz + (camRight * local.x + camUp * local.y) * radius;
+    fragColor = mix(hotColor, coolColor, t);
+    fragColor.a *= 1.0 - t;
+    fragLocal = local;
+    gl_Position = mvp * vec4(world, 1.0);
+}
+)";
+
+    static constexpr const char* kSparkFragmentShader = R"(#version 330
+in vec4 fragColor;
+in vec2 fragLocal;
+out vec4 finalColor;
+void main() {
+    float r2 = dot(fragLocal, fragLocal);
+    if (r2 > 1.0) discard;
+    finalColor = vec4(fragColor.rgb, fragColor.a * (1.0 - r2));
+}
+)";
+
+    int width_ = kStateWidth;
+    int height_ = 1;
+    int current_ = 0;
+    int next_ = 0;
+    float time_ = 0.0f;
+    long long emitted_ = 0;
+    std::vector<Pending> pending_;
+    unsigned int posAge_[2] = {0, 0};
+    unsigned int velLife_[2] = {0, 0};
+    unsigned int fbo_[2] = {0, 0};
+    unsigned int vao_ = 0;
+    unsigned int updateShader_ = 0;
+    unsigned int drawShader_ = 0;
+    int locPosAge_ = -1;
+    int locVelLife_ = -1;
+    int locDt_ = -1;
+    int locTime_ = -1;
+    int locGravity_ = -1;
+    int locMotion_ = -1;
+    int locCapacity_ = -1;
+    int locBurstCount_ = -1;
+    int locBurstRange_ = -1;
+    int locBurstOrigin_ = -1;
+    int locBurstCone_ = -1;
+    int locBurstLaunch_ = -1;
+    int locDrawPosAge_ = -1;
+    int locDrawVelLife_ = -1;
+    int locDrawMvp_ = -1;
+    int locDrawRight_ = -1;
+    int locDrawUp_ = -1;
+    int locDrawWidth_ = -1;
+    int locDrawSize_ = -1;
+    int locDrawHot_ = -1;
+    int locDrawCool_ = -1;
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
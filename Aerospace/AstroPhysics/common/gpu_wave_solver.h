@@ -0,0 +1,228 @@
+#pragma once
+
+#include "gpu_ping_pong.h"
+#include "raylib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace astro_wave {
+
+// Scalar wave equation u_tt = c^2 laplacian(u) - sigma(x) u_t + f(x, t) on a grid of
+// square cells, stepped in fragment shaders. The state texel holds (u now, u one step
+// ago, running mean of u^2, 1). The medium is an RGBA8 mask texture: red marks rigid
+// walls (u = 0), green the absorbing sponge profile s^2 along the edges, with sigma =
+// spongeStrength * s^2 treated implicitly so any strength stays stable. The source is a
+// Gaussian blob driven at angular frequency omega.
+//
+// The running mean of u^2 relaxes over intensityTau, so it settles to the time-averaged
+// intensity a few periods after the geometry changes. ReadColumn() is the only readback:
+// one column of that mean, for an intensity plot on the CPU. Init() returns false without
+// GL 3.3 float render targets.
+struct WaveDomain {
+    float x0 = 0.0f;     // world coordinates of the grid's lower-left corner
+    float y0 = 0.0f;
+    float width = 1.0f;  // world size along x; the height follows from the cell counts
+    int nx = 256;
+    int ny = 256;
+
+    float dx() const { return width / static_cast<float>(nx); }
+    float height() const { return dx() * static_cast<float>(ny); }
+    float X(int i) const { return x0 + (static_cast<float>(i) + 0.5f) * dx(); }
+    float Y(int j) const { return y0 + (static_cast<float>(j) + 0.5f) * dx(); }
+    int Column(float x) const { return std::clamp(static_cast<int>((x - x0) / dx()), 0, nx - 1); }
+};
+
+struct WaveSource {
+    float x = 0.0f;
+    float y = 0.0f;
+    float radius = 0.15f;
+    float amplitude = 40.0f;
+    float omega = 6.0f;
+};
+
+class GpuWaveSolver {
+  public:
+    static constexpr float kCourant = 0.5f;  // c dt / dx, under the 2D limit 1/sqrt(2)
+
+    bool Init(const WaveDomain& domain) {
+        Unload();
+        if (!astro_gpu::LoadPassShader(kStepShader, &stepShader_) || !astro_gpu::LoadPassShader(kColorShader, &colorShader_) ||
+            !state_.Init(domain.nx, domain.ny)) {
+            Unload();
+            return false;
+        }
+        domain_ = domain;
+        Image image = GenImageColor(domain.nx, domain.ny, BLANK);
+        medium_ = LoadTextureFromImage(image);
+        UnloadImage(image);
+        display_ = LoadRenderTexture(domain.nx, domain.ny);
+        SetTextureFilter(display_.texture, TEXTURE_FILTER_BILINEAR);
+        locMedium_ = GetShaderLocation(stepShader_, "medium");
+        locCoef_ = GetShaderLocation(stepShader_, "coef");
+        locSource_ = GetShaderLocation(stepShader_, "source");
+        locDrive_ = GetShaderLocation(stepShader_, "drive");
+        locColorMedium_ = GetShaderLocation(colorShader_, "medium");
+        locGain_ = GetShaderLocation(colorShader_, "gain");
+        Clear();
+        return true;
+    }
+
+    void Unload() {
+        state_.Unload();
+        if (medium_.id != 0) UnloadTexture(medium_);
+        if (display_.id != 0) UnloadRenderTexture(display_);
+        medium_ = Texture2D{};
+        display_ = RenderTexture2D{};
+        astro_gpu::UnloadPassShader(&stepShader_);
+        astro_gpu::UnloadPassShader(&colorShader_);
+    }
+
+    bool ready() const { return state_.ready(); }
+    const WaveDomain& domain() const { return domain_; }
+    const Texture2D& display() const { return display_.texture; }
+    float time() const { return time_; }
+    float MaxDt(float c) const { return kCourant * domain_.dx() / std::max(c, 1.0e-3f); }
+
+    // Zero field and intensity; the source phase restarts too.
+    void Clear() {
+        if (!ready()) return;
+        std::vector<float> zero(static_cast<size_t>(domain_.nx) * domain_.ny * 4, 0.0f);
+        state_.Upload(zero.data());
+        time_ = 0.0f;
+    }
+
+    // isWall(x, y) in world coordinates; the sponge ramps in over spongeWidth from every edge.
+    template <typename Wall>
+    void SetMedium(Wall&& isWall, float spongeWidth) {
+        if (!ready()) return;
+        std::vector<Color> pixels(static_cast<size_t>(domain_.nx) * domain_.ny);
+        const float inv = 1.0f / std::max(spongeWidth, 1.0e-4f);
+        for (int j = 0; j < domain_.ny; ++j) {
+            const float y = domain_.Y(j);
+            const float ey = std::min(y - domain_.y0, domain_.y0 + domain_.height() - y);
+            for (int i = 0; i < domain_.nx; ++i) {
+                const float x = domain_.X(i);
+                const float ex = std::min(x - domain_.x0, domain_.x0 + domain_.width - x);
+                const float s = std::clamp(1.0f - std::min(ex, ey) * inv, 0.0f, 1.0f);
+                pixels[static_cast<size_t>(j) * domain_.nx + i] = {static_cast<unsigned char>(isWall(x, y) ? 255 : 0),
+                                                                    static_cast<unsigned char>(255.0f * s * s), 0, 255};
+            }
+        }
+        UpdateTexture(medium_, pixels.data());
+    }
+
+    void Step(const WaveSource& source, float c, float spongeStrength, float intensityTau, float dt, int steps) {
+        if (!ready()) return;
+        const float invDx = 1.0f / domain_.dx();
+        const float coef[4] = {c * c * dt * dt * invDx * invDx, spongeStrength * dt, std::min(1.0f, dt / intensityTau), 0.0f};
+        const float where[4] = {(source.x - domain_.x0) * invDx, (source.y - domain_.y0) * invDx, source.radius * invDx, 0.0f};
+        for (int s = 0; s < steps; ++s) {
+            const float drive = source.amplitude * dt * dt * std::sin(source.omega * time_);
+            state_.Pass(stepShader_, [&]() {
+                SetShaderValueTexture(stepShader_, locMedium_, medium_);
+                SetShaderValue(stepShader_, locCoef_, coef, SHADER_UNIFORM_VEC4);
+                SetShaderValue(stepShader_, locSource_, where, SHADER_UNIFORM_VEC4);
+                SetShaderValue(stepShader_, locDrive_, &drive, SHADER_UNIFORM_FLOAT);
+            });
+            time_ += dt;
+        }
+    }
+
+    // Mean u^2 down the column at world x, one value per row from y0 up.
+    void ReadColumn(float x, std::vector<float>* intensity) {
+        intensity->assign(static_cast<size_t>(domain_.ny), 0.0f);
+        if (!ready()) return;
+        column_.resize(static_cast<size_t>(domain_.ny) * 4);
+        state_.Read(domain_.Column(x), 0, 1, domain_.ny, column_.data());
+        for (int j = 0; j < domain_.ny; ++j) (*intensity)[static_cast<size_t>(j)] = column_[static_cast<size_t>(j) * 4 + 2];
+    }
+
+    // Field colours into display(): blue and orange for the sign of u and the time-averaged
+    // intensity as a soft glow, both through x / (1 + x) of gain times the amplitude so the
+    // bright region near the source does not swamp the fringes; walls in grey.
+    void Colorize(float gain) {
+        if (!ready()) return;
+        state_.Render(display_, colorShader_, [&]() {
+            SetShaderValueTexture(colorShader_, locColorMedium_, medium_);
+            SetShaderValue(colorShader_, locGain_, &gain, SHADER_UNIFORM_FLOAT);
+        });
+    }
+
+  private:
+    static constexpr const char* kStepShader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+uniform sampler2D texture0;
+uniform sampler2D medium;
+uniform vec4 coef;    // (c dt / dx)^2, sigma_max dt, dt / tau
+uniform vec4 source;  // centre and radius in cells
+uniform float drive;  // amplitude dt^2 sin(omega t)
+
+void main() {
+    ivec2 size = textureSize(texture0, 0);
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    vec4 s = texelFetch(texture0, p, 0);
+    vec4 m = texelFetch(medium, p, 0);
+    float decay = coef.z;
+    if (m.r > 0.5) {
+        finalColor = vec4(0.0, 0.0, s.b * (1.0 - decay), 1.0);
+        return;
+    }
+    ivec2 hi = size - 1;
+    float l = texelFetch(texture0, clamp(p - ivec2(1, 0), ivec2(0), hi), 0).r;
+    float r = texelFetch(texture0, clamp(p + ivec2(1, 0), ivec2(0), hi), 0).r;
+    float d = texelFetch(texture0, clamp(p - ivec2(0, 1), ivec2(0), hi), 0).r;
+    float u = texelFetch(texture0, clamp(p + ivec2(0, 1), ivec2(0), hi), 0).r;
+    float half_sigma = 0.5 * coef.y * m.g;
+    vec2 q = (vec2(p) + 0.5 - source.xy) / max(source.z, 0.5);
+    float f = drive * exp(-dot(q, q));
+    float next = (2.0 * s.r - (1.0 - half_sigma) * s.g + coef.x * (l + r + d + u - 4.0 * s.r) + f) / (1.0 + half_sigma);
+    finalColor = vec4(next, s.r, s.b + decay * (next * next - s.b), 1.0);
+}
+)";
+
+    static constexpr const char* kColorShader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+uniform sampler2D texture0;
+uniform sampler2D medium;
+uniform float gain;
+
+void main() {
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    vec4 s = texelFetch(texture0, p, 0);
+    vec4 m = texelFetch(medium, p, 0);
+    float x = s.r * gain;
+    float v = x / (1.0 + abs(x));
+    float e = sqrt(max(s.b, 0.0)) * gain;
+    float glow = e / (1.0 + e);
+    vec3 c = vec3(0.03, 0.04, 0.08) + (v >= 0.0 ? vec3(1.0, 0.72, 0.36) : vec3(0.32, 0.66, 1.0)) * abs(v) * 0.85;
+    c += vec3(0.22, 0.26, 0.42) * glow;
+    c = mix(c, vec3(0.42, 0.45, 0.52), m.r);
+    finalColor = vec4(min(c, vec3(1.0)), 1.0);
+}
+)";
+
+    WaveDomain domain_{};
+    float time_ = 0.0f;
+    astro_gpu::FloatPingPong state_;
+    Texture2D medium_{};
+    RenderTexture2D display_{};
+    Shader stepShader_{};
+    Shader colorShader_{};
+    int locMedium_ = -1;
+    int locCoef_ = -1;
+    int locSource_ = -1;
+    int locDrive_ = -1;
+    int locColorMedium_ = -1;
+    int locGain_ = -1;
+    std::vector<float> column_;
+};
+
+}  // namespace astro_wave
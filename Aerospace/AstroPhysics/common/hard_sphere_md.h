@@ -0,0 +1,493 @@
+#pragma once
+
+#include "philox.h"
+#include "raylib.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Event-driven molecular dynamics for equal hard spheres (unit mass, k_B = 1) in a box,
+// optionally split by a partition wall normal to x.
+//
+// Particles fly ballistically between events and are only advanced when an event touches
+// them, so the cost is per collision rather than per frame. Each particle owns exactly one
+// pending event -- the earliest of its pair contacts, wall hits and cell-list crossings --
+// in a binary heap. Events carry the collision counters of both particles at scheduling
+// time: a popped event whose owner has since changed course is dropped, and one whose
+// partner has changed is re-predicted for the owner, so nothing is ever searched for and
+// erased from the heap. Pair predictions only look at the 27 neighbouring cells of a grid
+// at least one diameter wide, which keeps the cost flat up to 10^5 spheres.
+//
+// The speed histogram and the coarse-grained Boltzmann entropy are updated by the events
+// that change them (collisions and cell crossings), never by rescanning the particles.
+
+namespace astro_md {
+
+using Vec3d = std::array<double, 3>;
+
+struct HardSphere {
+    Vec3d pos;
+    Vec3d vel;
+    int species = 0;
+};
+
+struct HardSphereConfig {
+    Vec3d lo = {-1.0, -1.0, -1.0};  // box walls; centres stay `radius` inside
+    Vec3d hi = {1.0, 1.0, 1.0};
+    double radius = 0.05;
+    bool partition = false;
+    double partitionX = 0.0;
+    double partitionHalfWidth = 0.0;
+    std::array<int, 3> entropyCells = {8, 4, 6};  // coarse-graining grid for the entropy
+    double maxSpeed = 4.0;                        // speed histogram range
+    int histogramBins = 48;
+};
+
+class HardSphereGas {
+  public:
+    static constexpr int kMaxSpecies = 4;
+
+    void Reset(const HardSphereConfig& config, const std::vector<HardSphere>& spheres) {
+        config_ = config;
+        const size_t n = spheres.size();
+        s_.assign(n, Sphere{});
+        species_.resize(n);
+        side_.resize(n);
+        cell_.resize(n);
+        prev_.resize(n);
+        now_ = 0.0;
+        wallImpulse_ = 0.0;
+        collisions_ = events_ = 0;
+        for (size_t i = 0; i < n; ++i) {
+            s_[i].pos = spheres[i].pos;
+            s_[i].vel = spheres[i].vel;
+            species_[i] = static_cast<uint8_t>(std::clamp(spheres[i].species, 0, kMaxSpecies - 1));
+            side_[i] = s_[i].pos[0] < config_.partitionX ? -1 : 1;
+        }
+        BuildGrid();
+        for (size_t i = 0; i < n; ++i) Insert(static_cast<uint32_t>(i), CellOf(s_[i].pos));
+        BuildEntropy();
+        BuildHistogram();
+        Reschedule();
+    }
+
+    // Runs every event up to time() + dt.
+    void Advance(double dt) {
+        const double target = now_ + dt;
+        while (!heap_.empty() && heap_.front().t <= target) {
+            std::pop_heap(heap_.begin(), heap_.end(), Later{});
+            const Event e = heap_.back();
+            heap_.pop_back();
+            if (e.ownerCount != s_[e.owner].counter) continue;  // owner already re-predicted
+            now_ = std::max(now_, e.t);
+            if (e.kind == kPair && e.partnerCount != s_[e.partner].counter) {
+                Predict(e.owner);
+                continue;
+            }
+            ++events_;
+            Process(e);
+        }
+        now_ = target;
+    }
+
+    // Raising the partition pushes spheres out of its slab onto the side of their centre.
+    void SetPartition(bool on) {
+        if (on == config_.partition) return;
+        Synchronise();
+        config_.partition = on;
+        for (size_t i = 0; i < s_.size(); ++i) {
+            side_[i] = s_[i].pos[0] < config_.partitionX ? -1 : 1;
+            if (!on) continue;
+            const double gap = config_.partitionHalfWidth + config_.radius;
+            if (std::fabs(s_[i].pos[0] - config_.partitionX) < gap) {
+                s_[i].pos[0] = config_.partitionX + side_[i] * gap;
+                Move(static_cast<uint32_t>(i), CellOf(s_[i].pos));
+            }
+        }
+        Reschedule();
+    }
+
+    // Multiplies every velocity by `factor` (temperature by factor^2).
+    void ScaleSpeeds(double factor) {
+        Synchronise();
+        for (Sphere& sphere : s_) {
+            for (double& c : sphere.vel) c *= factor;
+        }
+        BuildHistogram();
+        Reschedule();
+    }
+
+    size_t size() const { return s_.size(); }
+    double time() const { return now_; }
+    const HardSphereConfig& config() const { return config_; }
+    int species(size_t i) const { return species_[i]; }
+    const Vec3d& velocity(size_t i) const { return s_[i].vel; }
+
+    Vector3 Position(size_t i) const {
+        const double dt = now_ - s_[i].time;
+        return {static_cast<float>(s_[i].pos[0] + s_[i].vel[0] * dt), static_cast<float>(s_[i].pos[1] + s_[i].vel[1] * dt),
+                static_cast<float>(s_[i].pos[2] + s_[i].vel[2] * dt)};
+    }
+
+    // Total momentum delivered to the six box walls (not the partition) since Reset().
+    double WallImpulse() const { return wallImpulse_; }
+    // Face area and volume of the box the centres can reach (walls set in by the radius),
+    // so WallImpulse() / (WallArea() t) = N kT / Volume() for an ideal gas.
+    double WallArea() const {
+        const Vec3d l = ReachableSize();
+        return 2.0 * (l[0] * l[1] + l[1] * l[2] + l[2] * l[0]);
+    }
+    double Volume() const {
+        const Vec3d l = ReachableSize();
+        return l[0] * l[1] * l[2];
+    }
+
+    double KineticEnergy() const { return kineticEnergy_; }
+    double Temperature() const { return s_.empty() ? 0.0 : 2.0 * kineticEnergy_ / (3.0 * static_cast<double>(s_.size())); }
+
+    const std::vector<uint32_t>& SpeedHistogram() const { return histogram_; }
+    double HistogramBinWidth() const { return config_.maxSpeed / static_cast<double>(histogram_.size()); }
+
+    // S = sum over species of ln(N_s! / prod_c n_sc!) over the coarse cells, and the value
+    // it takes when every species is spread evenly.
+    double Entropy() const { return entropyBase_ - logFactorialSum_; }
+    double MaxEntropy() const { return maxEntropy_; }
+    const std::array<int, 3>& EntropyCells() const { return macroDims_; }
+    int Occupancy(int species, int ix, int iy, int iz) const {
+        return macroCount_[static_cast<size_t>(species) * macroCells_ + static_cast<size_t>((iz * macroDims_[1] + iy) * macroDims_[0] + ix)];
+    }
+
+    uint64_t collisions() const { return collisions_; }
+    uint64_t events() const { return events_; }
+
+  private:
+    enum Kind : uint8_t { kPair, kWall, kPartition, kCell };
+
+    struct Event {
+        double t;
+        uint32_t owner;
+        uint32_t partner;
+        uint32_t ownerCount;
+        uint32_t partnerCount;
+        Kind kind;
+        int8_t axis;
+        int8_t dir;
+    };
+
+    // Everything a pair prediction reads from a neighbour, in one cache line.
+    struct alignas(64) Sphere {
+        Vec3d pos{};  // at `time`
+        double time = 0.0;
+        Vec3d vel{};
+        int32_t next = -1;  // next sphere in the same cell
+        uint32_t counter = 0;  // bumped whenever the velocity changes
+    };
+
+    struct Later {
+        bool operator()(const Event& a, const Event& b) const { return a.t > b.t; }
+    };
+
+    Vec3d ReachableSize() const {
+        const double d = 2.0 * config_.radius;
+        return {config_.hi[0] - config_.lo[0] - d, config_.hi[1] - config_.lo[1] - d, config_.hi[2] - config_.lo[2] - d};
+    }
+
+    void BuildGrid() {
+        const double d = 2.0 * config_.radius;
+        for (int a = 0; a < 3; ++a) {
+            const double length = config_.hi[a] - config_.lo[a];
+            const int maxCells = std::max(1, static_cast<int>(length / d));
+            macroDims_[a] = std::clamp(config_.entropyCells[a], 1, maxCells);
+            perMacro_[a] = std::max(1, static_cast<int>(length / (macroDims_[a] * d)));
+            dims_[a] = macroDims_[a] * perMacro_[a];
+            cellSize_[a] = length / dims_[a];
+        }
+        head_.assign(static_cast<size_t>(dims_[0]) * dims_[1] * dims_[2], -1);
+        macroCells_ = static_cast<size_t>(macroDims_[0]) * macroDims_[1] * macroDims_[2];
+    }
+
+    int CellOf(const Vec3d& p) const {
+        std::array<int, 3> c{};
+        for (int a = 0; a < 3; ++a) c[a] = std::clamp(static_cast<int>((p[a] - config_.lo[a]) / cellSize_[a]), 0, dims_[a] - 1);
+        return (c[2] * dims_[1] + c[1]) * dims_[0] + c[0];
+    }
+
+    std::array<int, 3> CellCoords(int cell) const {
+        return {cell % dims_[0], (cell / dims_[0]) % dims_[1], cell / (dims_[0] * dims_[1])};
+    }
+
+    size_t MacroOf(int cell) const {
+        const std::array<int, 3> c = CellCoords(cell);
+        return static_cast<size_t>(((c[2] / perMacro_[2]) * macroDims_[1] + c[1] / perMacro_[1]) * macroDims_[0] + c[0] / perMacro_[0]);
+    }
+
+    void Insert(uint32_t i, int cell) {
+        cell_[i] = cell;
+        prev_[i] = -1;
+        s_[i].next = head_[static_cast<size_t>(cell)];
+        if (s_[i].next >= 0) prev_[static_cast<size_t>(s_[i].next)] = static_cast<int32_t>(i);
+        head_[static_cast<size_t>(cell)] = static_cast<int32_t>(i);
+    }
+
+    void Remove(uint32_t i) {
+        if (prev_[i] >= 0) {
+            s_[static_cast<size_t>(prev_[i])].next = s_[i].next;
+        } else {
+            head_[static_cast<size_t>(cell_[i])] = s_[i].next;
+        }
+        if (s_[i].next >= 0) prev_[static_cast<size_t>(s_[i].next)] = prev_[i];
+    }
+
+    // Moves sphere i to another cell, keeping the coarse occupancy and entropy current.
+    void Move(uint32_t i, int cell) {
+        if (cell == cell_[i]) return;
+        const size_t from = MacroOf(cell_[i]);
+        const size_t to = MacroOf(cell);
+        Remove(i);
+        Insert(i, cell);
+        if (from == to) return;
+        const size_t base = static_cast<size_t>(species_[i]) * macroCells_;
+        logFactorialSum_ -= logInt_[static_cast<size_t>(macroCount_[base + from]--)];
+        logFactorialSum_ += logInt_[static_cast<size_t>(++macroCount_[base + to])];
+    }
+
+    void BuildEntropy() {
+        macroCount_.assign(kMaxSpecies * macroCells_, 0);
+        logInt_.resize(s_.size() + 1);
+        logInt_[0] = 0.0;
+        for (size_t k = 1; k < logInt_.size(); ++k) logInt_[k] = std::log(static_cast<double>(k));
+        std::array<double, kMaxSpecies> perSpecies{};
+        for (size_t i = 0; i < s_.size(); ++i) {
+            ++macroCount_[species_[i] * macroCells_ + MacroOf(cell_[i])];
+            perSpecies[species_[i]] += 1.0;
+        }
+        logFactorialSum_ = 0.0;
+        for (int n : macroCount_) logFactorialSum_ += std::lgamma(n + 1.0);
+        entropyBase_ = maxEntropy_ = 0.0;
+        const double cells = static_cast<double>(macroCells_);
+        for (double count : perSpecies) {
+            entropyBase_ += std::lgamma(count + 1.0);
+            maxEntropy_ += std::lgamma(count + 1.0) - cells * std::lgamma(count / cells + 1.0);
+        }
+    }
+
+    size_t SpeedBin(const Vec3d& v) const {
+        const double speed = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        const double bins = static_cast<double>(histogram_.size());
+        return static_cast<size_t>(std::min(bins - 1.0, speed / config_.maxSpeed * bins));
+    }
+
+    void BuildHistogram() {
+        histogram_.assign(static_cast<size_t>(std::max(1, config_.histogramBins)), 0);
+        kineticEnergy_ = 0.0;
+        for (const Sphere& sphere : s_) {
+            const Vec3d& v = sphere.vel;
+            ++histogram_[SpeedBin(v)];
+            kineticEnergy_ += 0.5 * (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        }
+    }
+
+    void Synchronise() {
+        for (size_t i = 0; i < s_.size(); ++i) AdvanceSphere(static_cast<uint32_t>(i));
+    }
+
+    void AdvanceSphere(uint32_t i) {
+        const double dt = now_ - s_[i].time;
+        for (int a = 0; a < 3; ++a) s_[i].pos[a] += s_[i].vel[a] * dt;
+        s_[i].time = now_;
+    }
+
+    void Reschedule() {
+        heap_.clear();
+        heap_.reserve(2 * s_.size() + 16);
+        for (size_t i = 0; i < s_.size(); ++i) Predict(static_cast<uint32_t>(i));
+    }
+
+    // Wall range for the centre of sphere i along `axis`, with the partition if it is up.
+    std::array<double, 2> Bounds(uint32_t i, int axis, bool* partitionLo, bool* partitionHi) const {
+        double lo = config_.lo[axis] + config_.radius;
+        double hi = config_.hi[axis] - config_.radius;
+        *partitionLo = *partitionHi = false;
+        if (axis == 0 && config_.partition) {
+            const double gap = config_.partitionHalfWidth + config_.radius;
+            if (side_[i] < 0) {
+                hi = config_.partitionX - gap;
+                *partitionHi = true;
+            } else {
+                lo = config_.partitionX + gap;
+                *partitionLo = true;
+            }
+        }
+        return {lo, hi};
+    }
+
+    // Schedules the earliest event of sphere i after now.
+    void Predict(uint32_t i) {
+        AdvanceSphere(i);
+        const Vec3d& p = s_[i].pos;
+        const Vec3d& v = s_[i].vel;
+        Event best{std::numeric_limits<double>::infinity(), i, i, s_[i].counter, 0, kWall, 0, 0};
+        const auto consider = [&](double dt, Kind kind, uint32_t partner, int axis, int dir) {
+            dt = std::max(0.0, dt);
+            if (now_ + dt >= best.t) return;
+            best.t = now_ + dt;
+            best.kind = kind;
+            best.partner = partner;
+            best.partnerCount = s_[partner].counter;
+            best.axis = static_cast<int8_t>(axis);
+            best.dir = static_cast<int8_t>(dir);
+        };
+
+        const std::array<int, 3> c = CellCoords(cell_[i]);
+        for (int a = 0; a < 3; ++a) {
+            if (v[a] == 0.0) continue;
+            bool partitionLo = false, partitionHi = false;
+            const std::array<double, 2> range = Bounds(i, a, &partitionLo, &partitionHi);
+            if (v[a] > 0.0) {
+                consider((range[1] - p[a]) / v[a], partitionHi ? kPartition : kWall, i, a, 1);
+                if (c[a] + 1 < dims_[a]) consider((config_.lo[a] + (c[a] + 1) * cellSize_[a] - p[a]) / v[a], kCell, i, a, 1);
+            } else {
+                consider((range[0] - p[a]) / v[a], partitionLo ? kPartition : kWall, i, a, -1);
+                if (c[a] > 0) consider((config_.lo[a] + c[a] * cellSize_[a] - p[a]) / v[a], kCell, i, a, -1);
+            }
+        }
+
+        const double contact2 = 4.0 * config_.radius * config_.radius;
+        for (int dz = -1; dz <= 1; ++dz) {
+            const int z = c[2] + dz;
+            if (z < 0 || z >= dims_[2]) continue;
+            for (int dy = -1; dy <= 1; ++dy) {
+                const int y = c[1] + dy;
+                if (y < 0 || y >= dims_[1]) continue;
+                for (int dx = -1; dx <= 1; ++dx) {
+                    const int x = c[0] + dx;
+                    if (x < 0 || x >= dims_[0]) continue;
+                    for (int32_t j = head_[static_cast<size_t>((z * dims_[1] + y) * dims_[0] + x)]; j >= 0; j = s_[static_cast<size_t>(j)].next) {
+                        if (static_cast<uint32_t>(j) == i) continue;
+                        const size_t k = static_cast<size_t>(j);
+                        const double lag = now_ - s_[k].time;
+                        Vec3d r{}, u{};
+                        for (int a = 0; a < 3; ++a) {
+                            r[a] = p[a] - (s_[k].pos[a] + s_[k].vel[a] * lag);
+                            u[a] = v[a] - s_[k].vel[a];
+                        }
+                        const double b = r[0] * u[0] + r[1] * u[1] + r[2] * u[2];
+                        if (b >= 0.0) continue;  // separating
+                        const double u2 = u[0] * u[0] + u[1] * u[1] + u[2] * u[2];
+                        const double r2 = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+                        const double disc = b * b - u2 * (r2 - contact2);
+                        if (disc < 0.0) continue;
+                        consider(r2 <= contact2 ? 0.0 : (-b - std::sqrt(disc)) / u2, kPair, static_cast<uint32_t>(j), 0, 0);
+                    }
+                }
+            }
+        }
+
+        if (std::isinf(best.t)) return;  // at rest with nothing approaching
+        heap_.push_back(best);
+        std::push_heap(heap_.begin(), heap_.end(), Later{});
+    }
+
+    void Process(const Event& e) {
+        const uint32_t i = e.owner;
+        AdvanceSphere(i);
+        if (e.kind == kCell) {
+            std::array<int, 3> c = CellCoords(cell_[i]);
+            c[e.axis] += e.dir;
+            Move(i, (c[2] * dims_[1] + c[1]) * dims_[0] + c[0]);
+            Predict(i);
+            return;
+        }
+        if (e.kind == kWall || e.kind == kPartition) {
+            if (e.kind == kWall) wallImpulse_ += 2.0 * std::fabs(s_[i].vel[e.axis]);
+            s_[i].vel[e.axis] = e.dir > 0 ? -std::fabs(s_[i].vel[e.axis]) : std::fabs(s_[i].vel[e.axis]);
+            ++s_[i].counter;
+            Predict(i);
+            return;
+        }
+
+        // Elastic collision of equal masses: swap the velocity components along the normal.
+        const uint32_t j = e.partner;
+        AdvanceSphere(j);
+        Vec3d n{};
+        double n2 = 0.0;
+        for (int a = 0; a < 3; ++a) {
+            n[a] = s_[j].pos[a] - s_[i].pos[a];
+            n2 += n[a] * n[a];
+        }
+        --histogram_[SpeedBin(s_[i].vel)];
+        --histogram_[SpeedBin(s_[j].vel)];
+        const double approach = n2 > 0.0 ? ((s_[i].vel[0] - s_[j].vel[0]) * n[0] + (s_[i].vel[1] - s_[j].vel[1]) * n[1] + (s_[i].vel[2] - s_[j].vel[2]) * n[2]) / n2 : 0.0;
+        for (int a = 0; a < 3; ++a) {
+            s_[i].vel[a] -= approach * n[a];
+            s_[j].vel[a] += approach * n[a];
+        }
+        ++histogram_[SpeedBin(s_[i].vel)];
+        ++histogram_[SpeedBin(s_[j].vel)];
+        ++s_[i].counter;
+        ++s_[j].counter;
+        ++collisions_;
+        Predict(i);
+        Predict(j);
+    }
+
+    HardSphereConfig config_;
+    std::vector<Sphere> s_;
+    std::vector<uint8_t> species_;
+    std::vector<int8_t> side_;  // side of the partition, fixed while it is up
+    std::vector<int32_t> cell_;
+    std::vector<int32_t> prev_;  // cell lists are doubly linked through Sphere::next
+    std::vector<int32_t> head_;
+    std::array<int, 3> dims_{};
+    std::array<double, 3> cellSize_{};
+    std::array<int, 3> macroDims_{};
+    std::array<int, 3> perMacro_{};
+    size_t macroCells_ = 1;
+    std::vector<int> macroCount_;  // [species][coarse cell]
+    std::vector<double> logInt_;
+    double logFactorialSum_ = 0.0;
+    double entropyBase_ = 0.0;
+    double maxEntropy_ = 0.0;
+    std::vector<uint32_t> histogram_;
+    double kineticEnergy_ = 0.0;
+    std::vector<Event> heap_;
+    double now_ = 0.0;
+    double wallImpulse_ = 0.0;
+    uint64_t collisions_ = 0;
+    uint64_t events_ = 0;
+};
+
+// `count` non-overlapping centres for spheres of `radius` inside [lo, hi] (centre bounds),
+// on a jittered cubic lattice with the sites shuffled. Returns fewer if they cannot fit.
+inline std::vector<Vec3d> LatticeStart(const Vec3d& lo, const Vec3d& hi, size_t count, double radius,
+                                       astro_random::PhiloxStream& rng) {
+    const Vec3d size = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]};
+    double spacing = std::cbrt(size[0] * size[1] * size[2] / std::max<double>(1.0, static_cast<double>(count)));
+    std::array<int, 3> sites{};
+    for (;;) {
+        for (int a = 0; a < 3; ++a) sites[a] = static_cast<int>(size[a] / spacing) + 1;
+        if (static_cast<size_t>(sites[0]) * sites[1] * sites[2] >= count || spacing <= 2.0 * radius) break;
+        spacing = std::max(2.0 * radius, spacing * 0.97);
+    }
+    std::vector<Vec3d> out;
+    out.reserve(static_cast<size_t>(sites[0]) * sites[1] * sites[2]);
+    for (int z = 0; z < sites[2]; ++z) {
+        for (int y = 0; y < sites[1]; ++y) {
+            for (int x = 0; x < sites[0]; ++x) out.push_back({lo[0] + x * spacing, lo[1] + y * spacing, lo[2] + z * spacing});
+        }
+    }
+    for (size_t i = out.size(); i > 1; --i) std::swap(out[i - 1], out[static_cast<size_t>(rng.Range(0, static_cast<int>(i - 1)))]);
+    out.resize(std::min(out.size(), count));
+    const double jitter = std::max(0.0, 0.5 * spacing - radius);
+    for (Vec3d& p : out) {
+        for (int a = 0; a < 3; ++a) p[a] = std::clamp(p[a] + rng.Uniform(-static_cast<float>(jitter), static_cast<float>(jitter)), lo[a], hi[a]);
+    }
+    return out;
+}
+
+}  // namespace astro_md
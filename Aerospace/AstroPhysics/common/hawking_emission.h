@@ -0,0 +1,303 @@
+#pragma once
+
+#include "alias_table.h"
+#include "hydrogen_orbitals.h"
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Monte Carlo Hawking emission from a Schwarzschild hole, in Planck units
+// (G = c = hbar = k = 1, T = 1 / 8 pi M).
+//
+// Per degree of freedom, a species of spin s and mass m is emitted at
+//
+//   d2N / dt dE = sigma_s(M p) p^2 / (2 pi^2 (e^(E/T) +- 1)),
+//
+// with the absorption cross-section sigma_s = 27 pi M^2 h_s(M p). The greybody fits
+// h_s run from each spin's low-energy limit up to the geometric-optics value:
+// 2 pi M^2 for s = 1/2, ~(M omega)^2 for s = 1 and ~(M omega)^4 for s = 2. Their
+// turnover scales reproduce Page (1976), whose massless species were two neutrino
+// flavours, photons and gravitons: 81 / 17 / 2 per cent of the power, and a total power
+// of 2.06e-4 / M^2 against his 2.011e-4. In x = M E, the spectrum shape depends on M
+// only through M m. EmissionTables therefore keeps, for each log-spaced mass bin, each
+// species' rate, an alias table over species, and an inverse-CDF table of x
+// (astro_quantum::QuantileTable).
+//
+// Evaporator draws quanta from the table of the hole's current mass. Each quantum takes
+// four Philox uniforms indexed by its emission number, so batches split across the
+// shared pool give the same quanta on any thread count. One batch carries at most 1%
+// of the mass, and the mass drops by the energy emitted, so the burn keeps up with the
+// rising temperature. Emission stops at `finalMass`, where the semiclassical picture
+// ends; the last batch can overshoot it slightly.
+
+namespace astro_hawking {
+
+constexpr double kPi = 3.14159265358979323846;
+
+struct Species {
+    const char* name;
+    int twiceSpin;  // 1, 2 or 4
+    double dof;     // helicities x particle/antiparticle x flavours
+    double mass;    // Planck masses
+};
+
+inline double Temperature(double holeMass) { return 1.0 / (8.0 * kPi * holeMass); }
+
+// Massless neutrinos, photons and gravitons, plus e+- and mu+- with the electron mass at
+// `electronOverT` times the temperature of a hole of `referenceMass`. The muon mass
+// keeps the real 206.8 ratio. Real Standard Model masses would all be negligible next to
+// the temperature of a hole small enough to watch evaporate.
+inline std::vector<Species> StandardSpecies(double referenceMass, double electronOverT = 2.0) {
+    const double electron = electronOverT * Temperature(referenceMass);
+    return {
+        {"neutrinos", 1, 6.0, 0.0},
+        {"photons", 2, 2.0, 0.0},
+        {"gravitons", 4, 2.0, 0.0},
+        {"electrons", 1, 4.0, electron},
+        {"muons", 1, 4.0, 206.8 * electron},
+    };
+}
+
+// sigma_s / 27 pi M^2 at y = M p.
+inline double Greybody(int twiceSpin, double y) {
+    constexpr double kFermionScale = 0.10, kPhotonScale = 0.26, kGravitonScale = 0.48;
+    if (twiceSpin == 1) {
+        const double t = (y / kFermionScale) * (y / kFermionScale);
+        return (2.0 / 27.0 + t) / (1.0 + t);
+    }
+    if (twiceSpin == 2) {
+        const double t = (y / kPhotonScale) * (y / kPhotonScale);
+        return t / (1.0 + t);
+    }
+    const double t = std::pow(y / kGravitonScale, 4.0);
+    return t / (1.0 + t);
+}
+
+// Emission density in x = M E, for all the species' degrees of freedom: the number rate is
+// integral(density dx) / M, and the power is integral(x density dx) / M^2.
+inline double SpectrumDensity(const Species& s, double holeMass, double x) {
+    const double mu = holeMass * s.mass;
+    if (x <= mu) return 0.0;
+    const double p2 = x * x - mu * mu;
+    const double boltzmann = std::exp(8.0 * kPi * x);
+    const double occupation = 1.0 / (boltzmann + (s.twiceSpin % 2 == 1 ? 1.0 : -1.0));
+    return 27.0 * s.dof / (2.0 * kPi) * Greybody(s.twiceSpin, std::sqrt(p2)) * p2 * occupation;
+}
+
+class EmissionTables {
+  public:
+    static constexpr double kSpan = 1.6;  // x beyond threshold; e^(-8 pi x) is 1e-17 there
+
+    // Mass bins log-spaced over [minMass, maxMass]; massless species share one table.
+    void Build(std::vector<Species> species, double minMass, double maxMass, int bins) {
+        species_ = std::move(species);
+        minMass_ = minMass;
+        logStep_ = std::log(maxMass / minMass) / std::max(1, bins - 1);
+        bins_.assign(static_cast<size_t>(bins), {});
+        std::vector<std::shared_ptr<const astro_quantum::QuantileTable>> massless(species_.size());
+        for (int b = 0; b < bins; ++b) {
+            Bin& bin = bins_[static_cast<size_t>(b)];
+            const double mass = minMass * std::exp(logStep_ * b);
+            std::vector<double> weights;
+            for (size_t i = 0; i < species_.size(); ++i) {
+                const Species& s = species_[i];
+                const double lo = mass * s.mass;
+                double rate = 0.0, power = 0.0;
+                constexpr int kSteps = 4096;
+                const double dx = kSpan / kSteps;
+                for (int k = 0; k < kSteps; ++k) {
+                    const double x = lo + (k + 0.5) * dx;
+                    const double d = SpectrumDensity(s, mass, x);
+                    rate += d * dx;
+                    power += x * d * dx;
+                }
+                bin.rate[i] = rate;
+                bin.power[i] = power;
+                bin.totalRate += rate;
+                bin.totalPower += power;
+                weights.push_back(rate);
+
+                if (s.mass == 0.0 && massless[i]) {
+                    bin.energy[i] = massless[i];
+                    continue;
+                }
+                auto table = std::make_shared<astro_quantum::QuantileTable>();
+                table->Build(lo, lo + kSpan, [&](double x) { return SpectrumDensity(s, mass, x); });
+                bin.energy[i] = table;
+                if (s.mass == 0.0) massless[i] = table;
+            }
+            bin.meanX = bin.totalPower / std::max(bin.totalRate, 1e-300);
+            bin.species.Build(weights);
+        }
+    }
+
+    const std::vector<Species>& species() const { return species_; }
+    int bins() const { return static_cast<int>(bins_.size()); }
+
+    int BinOf(double mass) const {
+        const int b = static_cast<int>(std::lround(std::log(std::max(mass, minMass_) / minMass_) / logStep_));
+        return std::clamp(b, 0, bins() - 1);
+    }
+
+    // Per hole mass: number rate = totalRate / M, power = totalPower / M^2.
+    double rate(int bin, size_t species) const { return bins_[static_cast<size_t>(bin)].rate[species]; }
+    double power(int bin, size_t species) const { return bins_[static_cast<size_t>(bin)].power[species]; }
+    double totalRate(int bin) const { return bins_[static_cast<size_t>(bin)].totalRate; }
+    double totalPower(int bin) const { return bins_[static_cast<size_t>(bin)].totalPower; }
+    double meanX(int bin) const { return bins_[static_cast<size_t>(bin)].meanX; }
+
+    // Species and x = M E for two uniforms.
+    void Sample(int bin, float speciesDraw, float energyDraw, int* species, float* x) const {
+        const Bin& b = bins_[static_cast<size_t>(bin)];
+        *species = static_cast<int>(b.species.Sample(speciesDraw));
+        *x = (*b.energy[static_cast<size_t>(*species)])(energyDraw);
+    }
+
+  private:
+    static constexpr size_t kMaxSpecies = 8;
+
+    struct Bin {
+        std::array<double, kMaxSpecies> rate{};
+        std::array<double, kMaxSpecies> power{};
+        std::array<std::shared_ptr<const astro_quantum::QuantileTable>, kMaxSpecies> energy{};
+        astro_random::AliasTable species;
+        double totalRate = 0.0;
+        double totalPower = 0.0;
+        double meanX = 0.0;
+    };
+
+    std::vector<Species> species_;
+    std::vector<Bin> bins_;
+    double minMass_ = 1.0;
+    double logStep_ = 1.0;
+};
+
+// One emitted quantum as handed to the sink. `slot` is its place in this Emit() call, and
+// `spread` holds two spare uniforms, for a direction say.
+struct Quantum {
+    int slot;
+    int species;
+    float energy;
+    float spread[2];
+};
+
+class Evaporator {
+  public:
+    static constexpr int kSpectrumBins = 48;
+    static constexpr float kSpectrumMax = 20.0f;  // E / T
+    static constexpr float kBatchMassFraction = 0.01f;
+
+    Evaporator(const EmissionTables* tables, double mass, double finalMass = 1.0, uint64_t seed = 7)
+        : tables_(tables), key_(astro_random::SeedKey(seed)), finalMass_(finalMass) {
+        Reset(mass);
+    }
+
+    void Reset(double mass) {
+        mass_ = initialMass_ = mass;
+        time_ = 0.0;
+        emitted_ = 0;
+        emittedCount_.assign(tables_->species().size(), 0);
+        emittedEnergy_.assign(tables_->species().size(), 0.0);
+        spectrum_.assign(tables_->species().size() * kSpectrumBins, 0.0);
+    }
+
+    double mass() const { return mass_; }
+    double initialMass() const { return initialMass_; }
+    double time() const { return time_; }  // Planck times since Reset
+    uint64_t emitted() const { return emitted_; }
+    bool evaporated() const { return mass_ <= finalMass_; }
+    double temperature() const { return Temperature(mass_); }
+    int bin() const { return tables_->BinOf(mass_); }
+
+    // Remaining lifetime if the current species mix held: M^3 / (3 P M^2).
+    double lifetime() const { return mass_ * mass_ * mass_ / (3.0 * std::max(tables_->totalPower(bin()), 1e-300)); }
+
+    uint64_t emittedCount(size_t species) const { return emittedCount_[species]; }
+    double emittedEnergy(size_t species) const { return emittedEnergy_[species]; }
+
+    // Recent quanta per species in bins of E / T at emission; Decay() ages them.
+    double spectrum(size_t species, int bin) const { return spectrum_[species * kSpectrumBins + static_cast<size_t>(bin)]; }
+    void Decay(double factor) {
+        for (double& s : spectrum_) s *= factor;
+    }
+
+    // Emits up to `count` quanta and returns how many. sink(const Quantum&) runs on pool
+    // threads, once per slot in [0, returned).
+    template <typename Sink>
+    int Emit(int count, Sink&& sink) {
+        const size_t speciesCount = tables_->species().size();
+        int done = 0;
+        std::mutex merge;
+        while (done < count && !evaporated()) {
+            const int b = bin();
+            const double mass = mass_;
+            const double meanEnergy = tables_->meanX(b) / mass;
+            const int cap = std::max(1, static_cast<int>(kBatchMassFraction * (mass - finalMass_) / meanEnergy));
+            const int n = std::min(count - done, cap);
+            const uint64_t first = emitted_;
+            const int slotBase = done;
+            double energy = 0.0;
+
+            astro_parallel::SharedPool().ParallelFor(n, 4096, [&](int begin, int end) {
+                std::vector<uint64_t> counts(speciesCount, 0);
+                std::vector<double> energies(speciesCount, 0.0);
+                std::vector<double> spectrum(speciesCount * kSpectrumBins, 0.0);
+                for (int k = begin; k < end; ++k) {
+                    const uint64_t index = first + static_cast<uint64_t>(k);
+                    const astro_random::PhiloxCounter bits = astro_random::Philox4x32(
+                        {static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32), 0u, 0u}, key_);
+                    Quantum q;
+                    float x = 0.0f;
+                    tables_->Sample(b, astro_random::UnitFloat(bits[0]), astro_random::UnitFloat(bits[1]), &q.species, &x);
+                    q.slot = slotBase + k;
+                    q.energy = static_cast<float>(x / mass);
+                    q.spread[0] = astro_random::UnitFloat(bits[2]);
+                    q.spread[1] = astro_random::UnitFloat(bits[3]);
+                    sink(q);
+
+                    const size_t s = static_cast<size_t>(q.species);
+                    ++counts[s];
+                    energies[s] += q.energy;
+                    const int h = static_cast<int>(8.0 * kPi * x / kSpectrumMax * kSpectrumBins);
+                    if (h < kSpectrumBins) spectrum[s * kSpectrumBins + static_cast<size_t>(h)] += 1.0;
+                }
+                std::lock_guard<std::mutex> lock(merge);
+                for (size_t s = 0; s < speciesCount; ++s) {
+                    emittedCount_[s] += counts[s];
+                    emittedEnergy_[s] += energies[s];
+                    energy += energies[s];
+                }
+                for (size_t i = 0; i < spectrum.size(); ++i) spectrum_[i] += spectrum[i];
+            });
+
+            // The batch's quanta leave over n / (rate / M) Planck times.
+            time_ += n * mass / std::max(tables_->totalRate(b), 1e-300);
+            mass_ = std::max(finalMass_, mass - energy);
+            emitted_ += static_cast<uint64_t>(n);
+            done += n;
+        }
+        return done;
+    }
+
+  private:
+    const EmissionTables* tables_;
+    astro_random::PhiloxKey key_;
+    double finalMass_;
+    double mass_ = 0.0;
+    double initialMass_ = 0.0;
+    double time_ = 0.0;
+    uint64_t emitted_ = 0;
+    std::vector<uint64_t> emittedCount_;
+    std::vector<double> emittedEnergy_;
+    std::vector<double> spectrum_;
+};
+
+}  // namespace astro_hawking
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "cli_args.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// Headless benchmark runner shared by the *_viz demos. A demo checks
+// ParseBenchArgs() before InitWindow(); when started with --headless it runs its
+// physics step a fixed number of times without opening a window and prints one JSON
+// object with the timing and allocation counts.
+//
+//   demo --headless [--steps=N] [--warmup=N] [--dt=X] [--json=path] [demo flags]
+//
+// This header also replaces the global allocation functions so heap traffic can be
+// counted. Include it from exactly one translation unit (the demo's main file).
+
+namespace astro_bench {
+
+inline std::atomic<uint64_t> gAllocationCount{0};
+inline std::atomic<uint64_t> gAllocatedBytes{0};
+
+struct BenchOptions {
+    bool enabled = false;
+    int steps = 0;
+    int warmup = 0;
+    float dt = 0.0f;
+    std::string jsonPath;
+};
+
+inline BenchOptions ParseBenchArgs(int argc, char** argv, int defaultSteps, float defaultDt) {
+    BenchOptions options;
+    options.enabled = HasFlag(argc, argv, "--headless");
+    options.steps = IntArg(argc, argv, "--steps", defaultSteps);
+    if (options.steps < 1) options.steps = 1;
+    options.warmup = IntArg(argc, argv, "--warmup", options.steps / 10);
+    if (options.warmup < 0) options.warmup = 0;
+    options.dt = FloatArg(argc, argv, "--dt", defaultDt);
+    if (const char* path = FindArg(argc, argv, "--json")) options.jsonPath = path;
+    return options;
+}
+
+// Runs step(dt) warmup + steps times and reports the timed part. checksum() is
+// evaluated once at the end, is written to the report so a regression in the
+// physics shows up next to a regression in speed, and keeps the work observable.
+template <typename Step, typename Checksum>
+int RunBench(const char* name, const BenchOptions& options, Step&& step, Checksum&& checksum) {
+    using Clock = std::chrono::steady_clock;
+    for (int i = 0; i < options.warmup; ++i) step(options.dt);
+
+    const uint64_t allocs0 = gAllocationCount.load(std::memory_order_relaxed);
+    const uint64_t bytes0 = gAllocatedBytes.load(std::memory_order_relaxed);
+    const Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < options.steps; ++i) step(options.dt);
+    const Clock::time_point t1 = Clock::now();
+    const uint64_t allocs = gAllocationCount.load(std::memory_order_relaxed) - allocs0;
+    const uint64_t bytes = gAllocatedBytes.load(std::memory_order_relaxed) - bytes0;
+
+    const double totalNs = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    const double value = static_cast<double>(checksum());
+
+    char report[512];
+    std::snprintf(report, sizeof(report),
+                  "{\"target\":\"%s\",\"steps\":%d,\"warmup\":%d,\"dt\":%.6g,\"total_ms\":%.3f,\"ns_per_step\":%.1f,"
+                  "\"allocations\":%llu,\"allocated_bytes\":%llu,\"allocations_per_step\":%.3f,\"checksum\":%.9g}\n",
+                  name, options.steps, options.warmup, options.dt, totalNs * 1e-6, totalNs / options.steps,
+                  static_cast<unsigned long long>(allocs), static_cast<unsigned long long>(bytes),
+                  static_cast<double>(allocs) / options.steps, value);
+    std::fputs(report, stdout);
+
+    if (!options.jsonPath.empty()) {
+        std::FILE* file = std::fopen(options.jsonPath.c_str(), "w");
+        if (file == nullptr) {
+            std::fprintf(stderr, "%s: cannot write %s\n", name, options.jsonPath.c_str());
+            return 1;
+        }
+        std::fputs(report, file);
+        std::fclose(file);
+    }
+    return 0;
+}
+
+inline void* CountedAlloc(std::size_t size) {
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+inline void* CountedAlignedAlloc(std::size_t size, std::size_t alignment) {
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+#if defined(_MSC_VER)
+    void* p = _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+    // aligned_alloc wants the size to be a multiple of the alignment.
+    const std::size_t rounded = ((size == 0 ? 1 : size) + alignment - 1) / alignment * alignment;
+    void* p = std::aligned_alloc(alignment, rounded);
+#endif
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+inline void CountedAlignedFree(void* p) {
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+}  // namespace astro_bench
+
+// The remaining standard forms (array, nothrow) forward to these by default.
+void* operator new(std::size_t size) { return astro_bench::CountedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return astro_bench::CountedAlignedAlloc(size, static_cast<std::size_t>(alignment));
+}
+void operator delete(void* p, std::align_val_t) noexcept { astro_bench::CountedAlignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { astro_bench::CountedAlignedFree(p); }
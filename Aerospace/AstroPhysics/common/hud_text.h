@@ -0,0 +1,361 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Retained HUD text. Drop-in for DrawText(TextFormat(...)) in the frame loop:
+//
+//   hud.Begin();
+//   hud.Print(22, 154, 18, color, "front=%.2f  bulb=%.2f", front, bulb);
+//   hud.Text("Controls: ...", 22, 178, 18, color);
+//   ... HUD shapes as before ...
+//   hud.Draw();            // every line, one draw call, above the HUD's shapes
+//
+// Lines are matched to last frame's by call order. A line only re-runs snprintf when
+// one of its arguments changes by at least the format's display precision (%.2f
+// compares values in steps of 0.01, integers exactly, strings by content), and only
+// rebuilds its glyph quads when the formatted text or its placement differs. The quads
+// of all lines live in one vertex buffer that is re-uploaded on the frames where
+// something changed and drawn with a single glDrawArrays. Without GL 3.3 the cached
+// strings go through DrawTextEx instead.
+namespace astro_render {
+
+class HudTextLayer {
+  public:
+    static constexpr int kMaxArgs = 12;
+    static constexpr size_t kLineBytes = 256;
+
+    // After InitWindow(); the default font unless another is given.
+    bool Init(Font font = GetFontDefault()) {
+        Unload();
+        font_ = font;
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locPosition_ = rlGetLocationAttrib(shader_, "vertexPosition");
+        locTexCoord_ = rlGetLocationAttrib(shader_, "vertexTexCoord");
+        locColor_ = rlGetLocationAttrib(shader_, "vertexColor");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locTexture_ = rlGetLocationUniform(shader_, "texture0");
+        vao_ = rlLoadVertexArray();
+        ready_ = vao_ != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (vbo_ != 0) rlUnloadVertexBuffer(vbo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        vbo_ = vao_ = shader_ = 0;
+        capacity_ = 0;
+        ready_ = false;
+        lines_.clear();
+        used_ = drawn_ = 0;
+        dirty_ = true;
+    }
+
+    void Begin() { used_ = 0; }
+
+    // printf-style line. Arguments: arithmetic types and C strings.
+    template <typename... Args>
+    void Print(int x, int y, int fontSize, Color color, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= kMaxArgs, "too many HUD arguments");
+        Line& line = Next();
+        if (line.format != format) {
+            line.format = format;
+            ParseFormat(format, &line.specs);
+            line.valid = false;
+        }
+        uint64_t keys[sizeof...(Args) + 1] = {};
+        size_t k = 0;
+        ((keys[k] = KeyOf(k < line.specs.size() ? line.specs[k] : Spec{}, args), ++k), ...);
+        if (!line.valid || line.keys.size() != k || !std::equal(keys, keys + k, line.keys.begin())) {
+            line.keys.assign(keys, keys + k);
+            char buffer[kLineBytes];
+            if constexpr (sizeof...(Args) == 0) {
+                size_t n = 0;
+                for (const char* p = format; *p != '\0' && n + 1 < sizeof(buffer); ++p) {
+                    if (p[0] == '%' && p[1] == '%') ++p;
+                    buffer[n++] = *p;
+                }
+                buffer[n] = '\0';
+            } else {
+                std::snprintf(buffer, sizeof(buffer), format, args...);
+            }
+            SetText(&line, buffer);
+            line.valid = true;
+        }
+        Place(&line, x, y, fontSize, color);
+    }
+
+    // A fixed or caller-formatted string, compared by content.
+    void Text(const char* text, int x, int y, int fontSize, Color color) {
+        Line& line = Next();
+        line.format = nullptr;
+        line.specs.clear();
+        line.keys.clear();
+        SetText(&line, text);
+        line.valid = true;
+        Place(&line, x, y, fontSize, color);
+    }
+
+    // Width in pixels as DrawText would measure it, for right-aligned or boxed lines.
+    int Measure(const char* text, int fontSize) const {
+        return static_cast<int>(MeasureTextEx(font_, text, static_cast<float>(fontSize), Spacing(fontSize)).x);
+    }
+
+    void Draw() {
+        // Slots past this frame's last line keep their cache for when they come back.
+        if (used_ != drawn_) {
+            drawn_ = used_;
+            dirty_ = true;
+        }
+        if (!ready_) {
+            for (size_t i = 0; i < drawn_; ++i) {
+                const Line& line = lines_[i];
+                DrawTextEx(font_, line.text.c_str(), {static_cast<float>(line.x), static_cast<float>(line.y)},
+                           static_cast<float>(line.fontSize), Spacing(line.fontSize), line.color);
+            }
+            return;
+        }
+        if (dirty_) Upload();
+        if (vertexCount_ == 0) return;
+
+        rlDrawRenderBatchActive();
+        const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        const int unit = 0;
+        rlSetUniform(locTexture_, &unit, RL_SHADER_UNIFORM_SAMPLER2D, 1);
+        rlActiveTextureSlot(0);
+        rlEnableTexture(font_.texture.id);
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArray(0, vertexCount_);
+        rlDisableVertexArray();
+        rlDisableTexture();
+        rlDisableShader();
+    }
+
+    size_t lines() const { return drawn_; }
+    uint64_t reformats() const { return reformats_; }  // lines re-rasterised since Init
+
+  private:
+    struct Spec {
+        char conversion = 0;  // f, e, g, d, s, ...
+        int precision = -1;
+    };
+
+    struct Vertex {
+        float x, y, u, v;
+        Color color;
+    };
+
+    struct Line {
+        const char* format = nullptr;
+        std::vector<Spec> specs;
+        std::vector<uint64_t> keys;
+        std::string text;
+        bool valid = false;
+        int x = 0, y = 0, fontSize = 0;
+        Color color{};
+        bool placed = false;
+        std::vector<Vertex> quads;
+    };
+
+    Line& Next() {
+        if (used_ == lines_.size()) {
+            lines_.emplace_back();
+            dirty_ = true;
+        }
+        return lines_[used_++];
+    }
+
+    static float Spacing(int fontSize) { return static_cast<float>(fontSize) / 10.0f; }
+
+    static void ParseFormat(const char* format, std::vector<Spec>* specs) {
+        specs->clear();
+        for (const char* p = format; *p != '\0'; ++p) {
+            if (*p != '%') continue;
+            if (*++p == '%' || *p == '\0') {
+                if (*p == '\0') break;
+                continue;
+            }
+            Spec spec;
+            while (std::strchr("-+ #0", *p) != nullptr && *p != '\0') ++p;
+            while (*p >= '0' && *p <= '9') ++p;
+            if (*p == '.') {
+                spec.precision = 0;
+                while (*++p >= '0' && *p <= '9') spec.precision = spec.precision * 10 + (*p - '0');
+            }
+            while (std::strchr("hlLzjt", *p) != nullptr && *p != '\0') ++p;
+            spec.conversion = *p;
+            specs->push_back(spec);
+            if (*p == '\0') break;
+        }
+    }
+
+    static uint64_t HashString(const char* s) {
+        uint64_t h = 1469598103934665603ull;  // FNV-1a
+        for (; s != nullptr && *s != '\0'; ++s) h = (h ^ static_cast<unsigned char>(*s)) * 1099511628211ull;
+        return h;
+    }
+
+    // The value as the format would show it: fixed-point steps for %f, a few significant
+    // digits for %e and %g, exact for everything else.
+    template <typename T>
+    static uint64_t KeyOf(const Spec& spec, const T& value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            const double v = static_cast<double>(value);
+            if (!std::isfinite(v)) return std::isnan(v) ? 0x7ff8000000000001ull : (v > 0.0 ? 0x7ff0000000000001ull : 0xfff0000000000001ull);
+            const int precision = spec.precision < 0 ? 6 : spec.precision;
+            if (spec.conversion == 'f' || spec.conversion == 'F') {
+                return static_cast<uint64_t>(std::llround(v * std::pow(10.0, precision)));
+            }
+            if (v == 0.0) return 0;
+            const int digits = std::max(1, precision) + 1;
+            const double exponent = std::floor(std::log10(std::fabs(v)));
+            const double mantissa = std::round(v * std::pow(10.0, digits - 1 - exponent));
+            return static_cast<uint64_t>(static_cast<int64_t>(mantissa)) * 1315423911ull ^ static_cast<uint64_t>(static_cast<int64_t>(exponent));
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            return static_cast<uint64_t>(value);
+        } else if constexpr (std::is_convertible_v<T, const char*>) {
+            return HashString(static_cast<const char*>(value));
+        } else {
+            static_assert(std::is_arithmetic_v<T>, "HUD arguments are numbers or C strings");
+            return 0;
+        }
+    }
+
+    void SetText(Line* line, const char* text) {
+        if (line->text == text) return;
+        line->text = text;
+        line->placed = false;
+        ++reformats_;
+    }
+
+    // Glyph quads laid out the way DrawTextEx lays them out.
+    void Place(Line* line, int x, int y, int fontSize, Color color) {
+        if (line->placed && line->x == x && line->y == y && line->fontSize == fontSize && ColorToInt(line->color) == ColorToInt(color)) return;
+        line->x = x;
+        line->y = y;
+        line->fontSize = fontSize;
+        line->color = color;
+        line->placed = true;
+        dirty_ = true;
+        line->quads.clear();
+        if (!ready_) return;
+
+        const float scale = static_cast<float>(fontSize) / static_cast<float>(font_.baseSize);
+        const float spacing = Spacing(fontSize);
+        const float pad = static_cast<float>(font_.glyphPadding);
+        const float tw = static_cast<float>(font_.texture.width), th = static_cast<float>(font_.texture.height);
+        float penX = 0.0f, penY = 0.0f;
+        const char* s = line->text.c_str();
+        for (int i = 0; s[i] != '\0';) {
+            int bytes = 0;
+            const int codepoint = GetCodepointNext(s + i, &bytes);
+            i += std::max(bytes, 1);
+            if (codepoint == '\n') {
+                penY += static_cast<float>(fontSize + 2);
+                penX = 0.0f;
+                continue;
+            }
+            const int g = GetGlyphIndex(font_, codepoint);
+            const Rectangle rec = font_.recs[g];
+            if (codepoint != ' ' && codepoint != '\t') {
+                const float x0 = x + penX + (font_.glyphs[g].offsetX - pad) * scale;
+                const float y0 = y + penY + (font_.glyphs[g].offsetY - pad) * scale;
+                const float x1 = x0 + (rec.width + 2.0f * pad) * scale;
+                const float y1 = y0 + (rec.height + 2.0f * pad) * scale;
+                const float u0 = (rec.x - pad) / tw, v0 = (rec.y - pad) / th;
+                const float u1 = (rec.x + rec.width + pad) / tw, v1 = (rec.y + rec.height + pad) / th;
+                const Vertex quad[6] = {{x0, y0, u0, v0, color}, {x0, y1, u0, v1, color}, {x1, y1, u1, v1, color},
+                                        {x0, y0, u0, v0, color}, {x1, y1, u1, v1, color}, {x1, y0, u1, v0, color}};
+                line->quads.insert(line->quads.end(), quad, quad + 6);
+            }
+            const float advance = font_.glyphs[g].advanceX == 0 ? rec.width : static_cast<float>(font_.glyphs[g].advanceX);
+            penX += advance * scale + spacing;
+        }
+    }
+
+    void Upload() {
+        dirty_ = false;
+        staging_.clear();
+        for (size_t i = 0; i < drawn_; ++i) staging_.insert(staging_.end(), lines_[i].quads.begin(), lines_[i].quads.end());
+        vertexCount_ = static_cast<int>(staging_.size());
+        if (staging_.empty()) return;
+        rlEnableVertexArray(vao_);
+        if (staging_.size() > capacity_) {
+            if (vbo_ != 0) rlUnloadVertexBuffer(vbo_);
+            capacity_ = std::max<size_t>(staging_.size() * 2, 6 * 1024);
+            vbo_ = rlLoadVertexBuffer(nullptr, static_cast<int>(capacity_ * sizeof(Vertex)), true);
+            const int stride = static_cast<int>(sizeof(Vertex));
+            rlSetVertexAttribute(static_cast<unsigned int>(locPosition_), 2, RL_FLOAT, false, stride, 0);
+            rlEnableVertexAttribute(static_cast<unsigned int>(locPosition_));
+            rlSetVertexAttribute(static_cast<unsigned int>(locTexCoord_), 2, RL_FLOAT, false, stride, static_cast<int>(offsetof(Vertex, u)));
+            rlEnableVertexAttribute(static_cast<unsigned int>(locTexCoord_));
+            rlSetVertexAttribute(static_cast<unsigned int>(locColor_), 4, RL_UNSIGNED_BYTE, true, stride, static_cast<int>(offsetof(Vertex, color)));
+            rlEnableVertexAttribute(static_cast<unsigned int>(locColor_));
+        }
+        rlUpdateVertexBuffer(vbo_, staging_.data(), static_cast<int>(staging_.size() * sizeof(Vertex)), 0);
+        rlDisableVertexArray();
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec2 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;
+uniform mat4 mvp;
+out vec2 fragTexCoord;
+out vec4 fragColor;
+void main() {
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+    gl_Position = mvp * vec4(vertexPosition, 0.0, 1.0);
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+out vec4 finalColor;
+void main() {
+    finalColor = texture(texture0, fragTexCoord) * fragColor;
+}
+)";
+
+    Font font_{};
+    bool ready_ = false;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int vbo_ = 0;
+    size_t capacity_ = 0;
+    int vertexCount_ = 0;
+    int locPosition_ = -1;
+    int locTexCoord_ = -1;
+    int locColor_ = -1;
+    int locMvp_ = -1;
+    int locTexture_ = -1;
+    std::vector<Line> lines_;
+    size_t used_ = 0;
+    size_t drawn_ = 0;
+    bool dirty_ = true;
+    uint64_t reformats_ = 0;
+    std::vector<Vertex> staging_;
+};
+
+}  // namespace astro_render
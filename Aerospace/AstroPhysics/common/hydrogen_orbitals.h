@@ -0,0 +1,194 @@
+#pragma once
+
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Monte Carlo sampler for hydrogen eigenstate densities |psi_nlm|^2 (lengths in Bohr radii).
+// The density separates as r^2 R_nl(r)^2 dr * P_l^|m|(u)^2 du * dphi / 2 pi with
+// u = cos(theta), so each coordinate is drawn independently by inverse-CDF lookup in a
+// quantile table built once per (n, l, m): three uniforms per sample, no rejections.
+// Uniforms come from a Philox stream indexed by sample number, so any range of samples
+// can be produced on any thread and the cloud does not depend on the split.
+
+namespace astro_quantum {
+
+// Radial function up to normalisation: rho^l e^{-rho/2} L_{n-l-1}^{2l+1}(rho), rho = 2r/n.
+inline double HydrogenRadial(int n, int l, double r) {
+    const double rho = 2.0 * r / n;
+    const int k = n - l - 1;
+    const double alpha = 2.0 * l + 1.0;
+    double prev = 1.0, cur = 1.0 + alpha - rho;  // generalised Laguerre L_0, L_1
+    if (k == 0) cur = 1.0;
+    for (int j = 1; j < k; ++j) {
+        const double next = ((2.0 * j + 1.0 + alpha - rho) * cur - (j + alpha) * prev) / (j + 1.0);
+        prev = cur;
+        cur = next;
+    }
+    return std::pow(rho, l) * std::exp(-0.5 * rho) * cur;
+}
+
+// Associated Legendre P_l^m(u) for m >= 0.
+inline double AssociatedLegendre(int l, int m, double u) {
+    double pmm = 1.0;
+    const double s = std::sqrt(std::max(0.0, 1.0 - u * u));
+    for (int i = 1; i <= m; ++i) pmm *= -(2.0 * i - 1.0) * s;
+    if (l == m) return pmm;
+    double pm1 = u * (2.0 * m + 1.0) * pmm;
+    for (int ll = m + 2; ll <= l; ++ll) {
+        const double next = ((2.0 * ll - 1.0) * u * pm1 - (ll + m - 1.0) * pmm) / (ll - m);
+        pmm = pm1;
+        pm1 = next;
+    }
+    return pm1;
+}
+
+// Tabulated inverse CDF of a density on [lo, hi].
+class QuantileTable {
+  public:
+    static constexpr int kBins = 8192;  // density samples
+    static constexpr int kQuantiles = 4096;
+
+    template <typename Density>
+    void Build(double lo, double hi, Density&& density) {
+        std::vector<double> cdf(kBins + 1, 0.0);
+        const double dx = (hi - lo) / kBins;
+        double prev = density(lo);
+        for (int i = 1; i <= kBins; ++i) {
+            const double cur = density(lo + i * dx);
+            cdf[static_cast<size_t>(i)] = cdf[static_cast<size_t>(i - 1)] + 0.5 * (prev + cur) * dx;
+            prev = cur;
+        }
+        const double total = std::max(cdf.back(), 1e-300);
+        int bin = 0;
+        for (int q = 0; q < kQuantiles; ++q) {
+            const double target = total * q / (kQuantiles - 1);
+            while (bin < kBins - 1 && cdf[static_cast<size_t>(bin + 1)] < target) ++bin;
+            const double c0 = cdf[static_cast<size_t>(bin)], c1 = cdf[static_cast<size_t>(bin + 1)];
+            const double f = c1 > c0 ? std::clamp((target - c0) / (c1 - c0), 0.0, 1.0) : 0.0;
+            quantile_[static_cast<size_t>(q)] = static_cast<float>(lo + (bin + f) * dx);
+        }
+    }
+
+    float operator()(float u) const {
+        const float x = u * (kQuantiles - 1);
+        const int i = std::min(static_cast<int>(x), kQuantiles - 2);
+        const float f = x - static_cast<float>(i);
+        return quantile_[static_cast<size_t>(i)] + f * (quantile_[static_cast<size_t>(i + 1)] - quantile_[static_cast<size_t>(i)]);
+    }
+
+  private:
+    std::array<float, kQuantiles> quantile_{};
+};
+
+class HydrogenOrbitalSampler {
+  public:
+    static constexpr int kMaxN = 7;
+    static constexpr int kBlock = 256;  // samples per uniform batch
+
+    // Returns false (and keeps the old state) unless 1 <= n <= kMaxN, 0 <= l < n, |m| <= l.
+    bool Configure(int n, int l, int m, uint64_t seed = 1) {
+        if (n < 1 || n > kMaxN || l < 0 || l >= n || std::abs(m) > l) return false;
+        n_ = n;
+        l_ = l;
+        m_ = m;
+        key_ = astro_random::SeedKey(seed);
+        stream_ = static_cast<uint32_t>(100 * n + 10 * l + (m + 10));
+        const double rMax = n * (2.0 * n + 12.0);  // beyond this the radial tail is < 1e-9
+        radial_.Build(0.0, rMax, [&](double r) {
+            const double R = HydrogenRadial(n, l, r);
+            return r * r * R * R;
+        });
+        polar_.Build(-1.0, 1.0, [&](double u) {
+            const double p = AssociatedLegendre(l, std::abs(m), u);
+            return p * p;
+        });
+        radialNodes_ = FindNodes(0.0, rMax, [&](double r) { return HydrogenRadial(n, l, r); });
+        polarNodes_ = FindNodes(-1.0, 1.0, [&](double u) { return AssociatedLegendre(l, std::abs(m), u); });
+        r99_ = radial_(0.99f);
+        return true;
+    }
+
+    int n() const { return n_; }
+    int l() const { return l_; }
+    int m() const { return m_; }
+    // Radius enclosing 99% of the probability, for choosing a display scale.
+    float Radius99() const { return r99_; }
+
+    // Samples [first, first + count) into xyz (3 floats each, scaled by `scale`) and the
+    // sign of R_nl(r) P_l^|m|(u) relative to the innermost lobe, to tell the lobes apart.
+    // Splits across the shared pool.
+    void Sample(uint64_t first, size_t count, float scale, float* xyz, int8_t* sign) const {
+        const int blocks = static_cast<int>((count + kBlock - 1) / kBlock);
+        astro_parallel::SharedPool().ParallelFor(blocks, 16, [&](int begin, int end) {
+            float u[3 * kBlock];
+            for (int b = begin; b < end; ++b) {
+                const size_t offset = static_cast<size_t>(b) * kBlock;
+                const size_t n = std::min<size_t>(kBlock, count - offset);
+                astro_random::FillUniform(key_, stream_, 0, 0, u, 3 * n, 3 * (first + offset));
+                for (size_t i = 0; i < n; ++i) {
+                    const float r = radial_(u[3 * i]);
+                    const float c = std::clamp(polar_(u[3 * i + 1]), -1.0f, 1.0f);
+                    const float phi = 6.28318530718f * u[3 * i + 2];
+                    const float s = std::sqrt(std::max(0.0f, 1.0f - c * c));
+                    float* p = xyz + 3 * (offset + i);
+                    p[0] = scale * r * s * std::cos(phi);
+                    p[1] = scale * r * c;  // quantisation axis up (+y on screen)
+                    p[2] = scale * r * s * std::sin(phi);
+                    sign[offset + i] = static_cast<int8_t>(Parity(radialNodes_, r) * Parity(polarNodes_, c));
+                }
+            }
+        });
+    }
+
+  private:
+    // Sign changes of f on [lo, hi], located by bisection; at most kMaxN - 1 per factor.
+    template <typename F>
+    static std::vector<float> FindNodes(double lo, double hi, F&& f) {
+        constexpr int kScan = 4096;
+        std::vector<float> nodes;
+        const double dx = (hi - lo) / kScan;
+        double a = lo + 1e-9, fa = f(a);
+        for (int i = 1; i <= kScan; ++i) {
+            const double b = lo + i * dx - 1e-9, fb = f(b);
+            if ((fa < 0.0) != (fb < 0.0) && fa != 0.0 && fb != 0.0) {
+                double x0 = a, x1 = b;
+                for (int it = 0; it < 40; ++it) {
+                    const double mid = 0.5 * (x0 + x1);
+                    ((f(mid) < 0.0) == (fa < 0.0) ? x0 : x1) = mid;
+                }
+                nodes.push_back(static_cast<float>(0.5 * (x0 + x1)));
+            }
+            a = b;
+            fa = fb;
+        }
+        return nodes;
+    }
+
+    // Sign of the factor at x, taking it positive below the first node.
+    static int Parity(const std::vector<float>& nodes, float x) {
+        int flips = 0;
+        for (float node : nodes) flips += x > node;
+        return (flips & 1) ? -1 : 1;
+    }
+
+    int n_ = 1;
+    int l_ = 0;
+    int m_ = 0;
+    float r99_ = 1.0f;
+    astro_random::PhiloxKey key_{};
+    uint32_t stream_ = 0;
+    QuantileTable radial_;
+    QuantileTable polar_;
+    std::vector<float> radialNodes_;
+    std::vector<float> polarNodes_;
+};
+
+}  // namespace astro_quantum
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "cli_args.h"
+#include "frame_capture.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+extern "C" void glfwPostEmptyEvent(void);  // raylib's desktop platform is GLFW; safe from any thread
+
+// Power-aware frame policy. A demo that is paused, has a still camera and gets no input
+// or live-control packets keeps redrawing an identical frame sixty times a second; this
+// notices that and stops. After `idleAfter` seconds of quiet the last full frame, kept
+// in a render texture, is re-presented instead of redrawing the scene, and EndDrawing()
+// blocks in GLFW's event wait (EnableEventWaiting) rather than spinning. The wait ends
+// on any window event or on a tick a small helper thread posts every `tickSeconds`, so
+// code that only changes off the event queue (live controls, a background solver) is
+// still looked at a few times a second. Any input, an animating scene or a live packet
+// returns to full-rate drawing on the same frame.
+//
+//   while (!WindowShouldClose()) {
+//       const bool draw = idle.BeginFrame(!paused, live.Poll(GetTime()));
+//       if (draw) { ...input handling, simulation... }
+//       BeginDrawing();
+//       if (draw) { ...scene and HUD... }
+//       idle.EndFrame();   // caches a quiet frame or re-presents the cached one
+//       EndDrawing();
+//   }
+//
+// Skipping input handling on idle frames is safe: a frame with input is never idle.
+// Keys held down, mouse motion, buttons, the wheel, touches and resizes all count.
+// Without GL 3.3 there is nothing to blit into, so idle frames are drawn normally and
+// only the wait applies. An ASTRO_CAPTURE recording keeps every frame live.
+namespace astro_power {
+
+struct IdleOptions {
+    bool enabled = true;
+    float idleAfter = 0.5f;    // seconds of quiet before the frame is frozen
+    float tickSeconds = 0.1f;  // longest a frozen frame sleeps before looking again
+
+    // --no-idle, --idle-after=X
+    static IdleOptions FromArgs(int argc, char** argv) {
+        IdleOptions o;
+        o.enabled = !astro_bench::HasFlag(argc, argv, "--no-idle");
+        o.idleAfter = std::max(0.05f, astro_bench::FloatArg(argc, argv, "--idle-after", o.idleAfter));
+        return o;
+    }
+};
+
+class IdleFramePolicy {
+  public:
+    IdleFramePolicy() = default;
+    IdleFramePolicy(const IdleFramePolicy&) = delete;
+    IdleFramePolicy& operator=(const IdleFramePolicy&) = delete;
+    ~IdleFramePolicy() { StopTicker(); }
+
+    // After InitWindow(). The cache needs GL 3.3 framebuffer blits; without them the
+    // policy still sleeps between frames but every frame is drawn.
+    void Init(const IdleOptions& options = IdleOptions{}) {
+        Unload();
+        options_ = options;
+        const int version = rlGetVersion();
+        blit_ = version == RL_OPENGL_33 || version == RL_OPENGL_43;
+        lastBusy_ = GetTime();
+        if (options_.enabled) StartTicker();
+    }
+
+    // Before CloseWindow().
+    void Unload() {
+        SetIdle(false);
+        StopTicker();
+        if (cache_.id != 0) UnloadRenderTexture(cache_);
+        cache_ = RenderTexture2D{};
+        cached_ = false;
+    }
+
+    // Start of the frame: true when the scene must be updated and drawn. `animating`
+    // is anything that changes the picture without input (an unpaused simulation, an
+    // auto-rotating or easing camera); `liveInput` is a new live-control packet.
+    bool BeginFrame(bool animating, bool liveInput = false) {
+        const double now = GetTime();
+        busy_ = !options_.enabled || animating || liveInput || wake_ || astro_capture::SharedCapture().active() ||
+                InputThisFrame();
+        wake_ = false;
+        if (busy_) {
+            lastBusy_ = now;
+            cached_ = false;
+        }
+        SetIdle(!busy_ && now - lastBusy_ >= options_.idleAfter);
+        drawing_ = !idle_ || !cached_ || !CacheMatchesWindow();
+        if (idle_) ++idleFrames_;
+        return drawing_;
+    }
+
+    // Just before EndDrawing(), after the HUD: stores a quiet frame, or re-presents
+    // the stored one when BeginFrame() returned false.
+    void EndFrame() {
+        if (!blit_ || !options_.enabled) return;
+        if (drawing_) {
+            if (!busy_) Store();
+            return;
+        }
+        const Rectangle source{0.0f, 0.0f, static_cast<float>(cache_.texture.width), -static_cast<float>(cache_.texture.height)};
+        const Rectangle dest{0.0f, 0.0f, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight())};
+        DrawTexturePro(cache_.texture, source, dest, Vector2{0.0f, 0.0f}, 0.0f, WHITE);
+    }
+
+    // Forces the next frame to be drawn, for changes the policy cannot see.
+    void Wake() { wake_ = true; }
+
+    bool idle() const { return idle_; }
+    bool enabled() const { return options_.enabled; }
+    long idleFrames() const { return idleFrames_; }
+
+  private:
+    static bool InputThisFrame() {
+        const Vector2 delta = GetMouseDelta();
+        if (delta.x != 0.0f || delta.y != 0.0f) return true;
+        const Vector2 wheel = GetMouseWheelMoveV();
+        if (wheel.x != 0.0f || wheel.y != 0.0f) return true;
+        for (int button = MOUSE_BUTTON_LEFT; button <= MOUSE_BUTTON_BACK; ++button) {
+            if (IsMouseButtonDown(button) || IsMouseButtonReleased(button)) return true;
+        }
+        for (int key = KEY_SPACE; key <= KEY_KB_MENU; ++key) {
+            if (IsKeyDown(key) || IsKeyReleased(key)) return true;
+        }
+        return GetTouchPointCount() > 0 || IsWindowResized();
+    }
+
+    bool CacheMatchesWindow() const {
+        return cache_.id != 0 && cache_.texture.width == GetRenderWidth() && cache_.texture.height == GetRenderHeight();
+    }
+
+    // Copies the back buffer into the cache. Blitting out of a multisampled window
+    // resolves it; blitting back in would not be allowed, so EndFrame() draws the
+    // cache as a textured quad instead.
+    void Store() {
+        const int width = GetRenderWidth();
+        const int height = GetRenderHeight();
+        if (width <= 0 || height <= 0) return;
+        if (!CacheMatchesWindow()) {
+            if (cache_.id != 0) UnloadRenderTexture(cache_);
+            cache_ = LoadRenderTexture(width, height);
+            if (cache_.id == 0) {
+                blit_ = false;
+                return;
+            }
+        }
+        rlDrawRenderBatchActive();
+        rlBindFramebuffer(RL_READ_FRAMEBUFFER, 0);
+        rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, cache_.id);
+        rlBlitFramebuffer(0, 0, width, height, 0, 0, width, height, kColorBufferBit);
+        rlBindFramebuffer(RL_READ_FRAMEBUFFER, 0);
+        rlBindFramebuffer(RL_DRAW_FRAMEBUFFER, 0);
+        cached_ = true;
+    }
+
+    void SetIdle(bool idle) {
+        if (idle == idle_) return;
+        idle_ = idle;
+        if (idle) {
+            EnableEventWaiting();
+        } else {
+            DisableEventWaiting();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ticking_ = idle;
+        }
+        changed_.notify_one();
+    }
+
+    void StartTicker() {
+        stopping_ = false;
+        ticker_ = std::thread([this]() {
+            const auto tick = std::chrono::duration<float>(options_.tickSeconds);
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stopping_) {
+                if (!ticking_) {
+                    changed_.wait(lock, [this]() { return stopping_ || ticking_; });
+                    continue;
+                }
+                if (changed_.wait_for(lock, tick, [this]() { return stopping_ || !ticking_; })) continue;
+                glfwPostEmptyEvent();
+            }
+        });
+    }
+
+    void StopTicker() {
+        if (!ticker_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_one();
+        ticker_.join();
+    }
+
+    static constexpr int kColorBufferBit = 0x00004000;  // GL_COLOR_BUFFER_BIT
+
+    IdleOptions options_{};
+    RenderTexture2D cache_{};
+    bool blit_ = false;
+    bool cached_ = false;
+    bool busy_ = true;
+    bool drawing_ = true;
+    bool idle_ = false;
+    bool wake_ = false;
+    double lastBusy_ = 0.0;
+    long idleFrames_ = 0;
+
+    std::thread ticker_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool ticking_ = false;
+    bool stopping_ = false;
+};
+
+}  // namespace astro_power
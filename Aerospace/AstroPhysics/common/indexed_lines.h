@@ -0,0 +1,145 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <cstdint>
+#include <vector>
+
+#if defined(_WIN32)
+#define ASTRO_LINES_GL_CALL __stdcall
+#else
+#define ASTRO_LINES_GL_CALL
+#endif
+
+extern "C" void* glfwGetProcAddress(const char* procname);  // raylib's desktop platform is GLFW
+
+namespace astro_render {
+
+// A wireframe whose connectivity is fixed but whose vertices move every frame: a
+// dynamic vertex buffer of vec4s (position plus one shading scalar) and a static
+// GL_LINES index buffer, drawn with a single glDrawElements. Update() re-uploads the
+// vertices only, so a 1200-edge wireframe costs one small buffer write and one draw
+// instead of 1200 DrawLine3D calls. The colour runs from `low` to `high` as the
+// scalar goes from the gradient's lower to upper bound.
+//
+// Init() returns false without GL 3.3; keep a DrawLine3D path for that case. Unload()
+// must run before CloseWindow().
+class IndexedLineBuffer {
+  public:
+    bool Init(int vertexCapacity, const std::vector<uint32_t>& indices) {
+        Unload();
+        if (vertexCapacity <= 0 || indices.empty() || !LoadDrawElements()) return false;
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locVertex_ = rlGetLocationAttrib(shader_, "vertexData");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locLow_ = rlGetLocationUniform(shader_, "lowColor");
+        locHigh_ = rlGetLocationUniform(shader_, "highColor");
+        locRange_ = rlGetLocationUniform(shader_, "range");
+
+        vao_ = rlLoadVertexArray();
+        rlEnableVertexArray(vao_);
+        vbo_ = rlLoadVertexBuffer(nullptr, vertexCapacity * static_cast<int>(sizeof(Vector4)), true);
+        rlSetVertexAttribute(static_cast<unsigned int>(locVertex_), 4, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locVertex_));
+        ebo_ = rlLoadVertexBufferElement(indices.data(), static_cast<int>(indices.size() * sizeof(uint32_t)), false);
+        rlDisableVertexArray();
+
+        capacity_ = vertexCapacity;
+        indexCount_ = static_cast<int>(indices.size());
+        return vao_ != 0 && vbo_ != 0 && ebo_ != 0;
+    }
+
+    void Unload() {
+        if (vbo_ != 0) rlUnloadVertexBuffer(vbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        vbo_ = ebo_ = vao_ = shader_ = 0;
+        capacity_ = indexCount_ = 0;
+    }
+
+    bool ready() const { return vao_ != 0; }
+
+    void Update(const Vector4* vertices, int count) {
+        if (!ready() || count <= 0) return;
+        rlUpdateVertexBuffer(vbo_, vertices, (count < capacity_ ? count : capacity_) * static_cast<int>(sizeof(Vector4)), 0);
+    }
+
+    void SetGradient(Color low, Color high, float lowValue, float highValue) {
+        low_ = ColorNormalize(low);
+        high_ = ColorNormalize(high);
+        range_ = {lowValue, highValue};
+    }
+
+    void Draw() const {
+        if (!ready()) return;
+        rlDrawRenderBatchActive();
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+        rlSetUniform(locLow_, &low_, RL_SHADER_UNIFORM_VEC4, 1);
+        rlSetUniform(locHigh_, &high_, RL_SHADER_UNIFORM_VEC4, 1);
+        rlSetUniform(locRange_, &range_, RL_SHADER_UNIFORM_VEC2, 1);
+        rlEnableVertexArray(vao_);
+        drawElements_(kGlLines, indexCount_, kGlUnsignedInt, nullptr);
+        rlDisableVertexArray();
+        rlDisableShader();
+    }
+
+  private:
+    static constexpr unsigned kGlLines = 0x0001;
+    static constexpr unsigned kGlUnsignedInt = 0x1405;
+
+    // rlgl only draws indexed triangles, so glDrawElements comes straight from GLFW.
+    bool LoadDrawElements() {
+        const int version = rlGetVersion();
+        if (version != RL_OPENGL_33 && version != RL_OPENGL_43) return false;
+        drawElements_ = reinterpret_cast<DrawElementsFn>(glfwGetProcAddress("glDrawElements"));
+        return drawElements_ != nullptr;
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec4 vertexData;
+uniform mat4 mvp;
+uniform vec4 lowColor;
+uniform vec4 highColor;
+uniform vec2 range;
+out vec4 fragColor;
+void main() {
+    float s = clamp((vertexData.w - range.x) / max(range.y - range.x, 1e-6), 0.0, 1.0);
+    fragColor = mix(lowColor, highColor, s);
+    gl_Position = mvp * vec4(vertexData.xyz, 1.0);
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main() { finalColor = fragColor; }
+)";
+
+    using DrawElementsFn = void(ASTRO_LINES_GL_CALL*)(unsigned, int, unsigned, const void*);
+
+    DrawElementsFn drawElements_ = nullptr;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int vbo_ = 0;
+    unsigned int ebo_ = 0;
+    int locVertex_ = -1;
+    int locMvp_ = -1;
+    int locLow_ = -1;
+    int locHigh_ = -1;
+    int locRange_ = -1;
+    int capacity_ = 0;
+    int indexCount_ = 0;
+    Vector4 low_{0.47f, 0.75f, 1.0f, 0.67f};
+    Vector4 high_{1.0f, 0.67f, 0.47f, 0.65f};
+    Vector2 range_{-1.0f, 1.0f};
+};
+
+}  // namespace astro_render
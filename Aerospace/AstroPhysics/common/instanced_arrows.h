@@ -0,0 +1,211 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace astro_render {
+
+// One arrow (32 bytes): from `base` to base + dir, shaft radius `width` in world units.
+struct ArrowInstance {
+    Vector3 base;
+    float width;
+    Vector3 dir;
+    Color color;
+};
+
+// Arrow lattice kept in a vertex buffer: Upload() replaces the instances only when the
+// caller's arrows change (e.g. a cached field was re-evaluated), Draw() is one instanced
+// call of a six-sided shaft and cone every frame. The mesh is oriented along `dir` in the
+// vertex shader and given a fixed-light shade so dense 3D lattices read as solid. Draw
+// between BeginMode3D/EndMode3D; Unload() must run before CloseWindow(). Without GL 3.3
+// Draw() falls back to line arrows.
+class InstancedArrowRenderer {
+  public:
+    static constexpr float kHeadFraction = 0.32f;  // of the arrow length
+    static constexpr float kHeadWidth = 2.6f;      // head radius in shaft radii
+
+    bool Init(int initialCapacity = 1024) {
+        BuildBaseMesh();
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locVertex_ = rlGetLocationAttrib(shader_, "vertexPosition");
+        locBaseWidth_ = rlGetLocationAttrib(shader_, "arrowBaseWidth");
+        locDir_ = rlGetLocationAttrib(shader_, "arrowDir");
+        locColor_ = rlGetLocationAttrib(shader_, "arrowColor");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+
+        vao_ = rlLoadVertexArray();
+        rlEnableVertexArray(vao_);
+        meshVbo_ = rlLoadVertexBuffer(baseVertices_.data(), static_cast<int>(baseVertices_.size() * sizeof(float)), false);
+        rlSetVertexAttribute(static_cast<unsigned int>(locVertex_), 3, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locVertex_));
+        ebo_ = rlLoadVertexBufferElement(baseIndices_.data(), static_cast<int>(baseIndices_.size() * sizeof(unsigned short)), false);
+        AllocateInstanceBuffer(std::max(1, initialCapacity));
+        rlDisableVertexArray();
+
+        ready_ = vao_ != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (instanceVbo_ != 0) rlUnloadVertexBuffer(instanceVbo_);
+        if (meshVbo_ != 0) rlUnloadVertexBuffer(meshVbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        instanceVbo_ = meshVbo_ = ebo_ = vao_ = shader_ = 0;
+        capacity_ = 0;
+        ready_ = false;
+    }
+
+    void Upload(const std::vector<ArrowInstance>& arrows) {
+        arrows_ = arrows;
+        if (!ready_ || arrows_.empty()) return;
+        const int count = static_cast<int>(arrows_.size());
+        if (count > capacity_) {
+            rlEnableVertexArray(vao_);
+            rlUnloadVertexBuffer(instanceVbo_);
+            AllocateInstanceBuffer(std::max(count, capacity_ * 2));
+            rlDisableVertexArray();
+        }
+        rlUpdateVertexBuffer(instanceVbo_, arrows_.data(), count * static_cast<int>(sizeof(ArrowInstance)), 0);
+    }
+
+    size_t count() const { return arrows_.size(); }
+    bool ready() const { return ready_; }
+
+    void Draw() const {
+        if (arrows_.empty()) return;
+        if (!ready_) {
+            DrawImmediate();
+            return;
+        }
+        rlDrawRenderBatchActive();
+        const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArrayElementsInstanced(0, static_cast<int>(baseIndices_.size()), nullptr, static_cast<int>(arrows_.size()));
+        rlDisableVertexArray();
+        rlDisableShader();
+    }
+
+  private:
+    void AllocateInstanceBuffer(int capacity) {
+        capacity_ = capacity;
+        instanceVbo_ = rlLoadVertexBuffer(nullptr, capacity_ * static_cast<int>(sizeof(ArrowInstance)), true);
+        const int stride = static_cast<int>(sizeof(ArrowInstance));
+        rlSetVertexAttribute(static_cast<unsigned int>(locBaseWidth_), 4, RL_FLOAT, false, stride, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locBaseWidth_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locBaseWidth_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locDir_), 3, RL_FLOAT, false, stride, static_cast<int>(offsetof(ArrowInstance, dir)));
+        rlEnableVertexAttribute(static_cast<unsigned int>(locDir_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locDir_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locColor_), 4, RL_UNSIGNED_BYTE, true, stride,
+                             static_cast<int>(offsetof(ArrowInstance, color)));
+        rlEnableVertexAttribute(static_cast<unsigned int>(locColor_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locColor_), 1);
+    }
+
+    // Unit arrow along +z: (x, y) in shaft radii around the axis, z in arrow lengths.
+    void BuildBaseMesh() {
+        constexpr int kSides = 6;
+        baseVertices_.clear();
+        baseIndices_.clear();
+        const float neck = 1.0f - kHeadFraction;
+        const auto ring = [&](float radius, float z) {
+            for (int s = 0; s < kSides; ++s) {
+                const float a = 2.0f * PI * static_cast<float>(s) / static_cast<float>(kSides);
+                baseVertices_.insert(baseVertices_.end(), {radius * std::cos(a), radius * std::sin(a), z});
+            }
+        };
+        ring(1.0f, 0.0f);         // shaft start
+        ring(1.0f, neck);         // shaft end
+        ring(kHeadWidth, neck);   // head rim
+        baseVertices_.insert(baseVertices_.end(), {0.0f, 0.0f, 1.0f});  // tip
+        baseVertices_.insert(baseVertices_.end(), {0.0f, 0.0f, neck});  // head base centre
+        const unsigned short tip = 3 * kSides;
+        const unsigned short hub = tip + 1;
+        for (int s = 0; s < kSides; ++s) {
+            const unsigned short a = static_cast<unsigned short>(s);
+            const unsigned short b = static_cast<unsigned short>((s + 1) % kSides);
+            baseIndices_.insert(baseIndices_.end(), {a, b, static_cast<unsigned short>(kSides + b)});
+            baseIndices_.insert(baseIndices_.end(), {a, static_cast<unsigned short>(kSides + b), static_cast<unsigned short>(kSides + a)});
+            baseIndices_.insert(baseIndices_.end(), {static_cast<unsigned short>(2 * kSides + a), static_cast<unsigned short>(2 * kSides + b), tip});
+            baseIndices_.insert(baseIndices_.end(), {static_cast<unsigned short>(2 * kSides + b), static_cast<unsigned short>(2 * kSides + a), hub});
+        }
+    }
+
+    void DrawImmediate() const {
+        for (const ArrowInstance& a : arrows_) {
+            const Vector3 tip = Vector3Add(a.base, a.dir);
+            DrawLine3D(a.base, tip, a.color);
+            const float len = Vector3Length(a.dir);
+            if (len < 1e-6f) continue;
+            const Vector3 d = Vector3Scale(a.dir, 1.0f / len);
+            Vector3 s = Vector3CrossProduct(d, {0.0f, 1.0f, 0.0f});
+            s = Vector3Length(s) < 1e-4f ? Vector3{1.0f, 0.0f, 0.0f} : Vector3Normalize(s);
+            const Vector3 back = Vector3Scale(d, -kHeadFraction * len);
+            const Vector3 side = Vector3Scale(s, kHeadWidth * a.width);
+            DrawLine3D(tip, Vector3Add(tip, Vector3Add(back, side)), a.color);
+            DrawLine3D(tip, Vector3Add(tip, Vector3Subtract(back, side)), a.color);
+        }
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec3 vertexPosition;
+in vec4 arrowBaseWidth;
+in vec3 arrowDir;
+in vec4 arrowColor;
+uniform mat4 mvp;
+out vec4 fragColor;
+void main() {
+    float len = length(arrowDir);
+    vec3 w = len > 1e-6 ? arrowDir / len : vec3(0.0, 1.0, 0.0);
+    vec3 ref = abs(w.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 u = normalize(cross(w, ref));
+    vec3 v = cross(w, u);
+    vec3 radial = u * vertexPosition.x + v * vertexPosition.y;
+    vec3 world = arrowBaseWidth.xyz + arrowDir * vertexPosition.z + radial * arrowBaseWidth.w;
+    vec3 n = normalize(radial + 0.3 * w + vec3(1e-5));
+    float shade = 0.7 + 0.3 * max(0.0, dot(n, normalize(vec3(0.35, 0.85, 0.4))));
+    fragColor = vec4(arrowColor.rgb * shade, arrowColor.a);
+    gl_Position = mvp * vec4(world, 1.0);
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main() {
+    finalColor = fragColor;
+}
+)";
+
+    std::vector<float> baseVertices_;
+    std::vector<unsigned short> baseIndices_;
+    std::vector<ArrowInstance> arrows_;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int meshVbo_ = 0;
+    unsigned int ebo_ = 0;
+    unsigned int instanceVbo_ = 0;
+    int capacity_ = 0;
+    int locVertex_ = -1;
+    int locBaseWidth_ = -1;
+    int locDir_ = -1;
+    int locColor_ = -1;
+    int locMvp_ = -1;
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "colormap.h"
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace astro_render {
+
+// Interleaved per-instance record uploaded once per frame (20 bytes).
+struct ParticleInstance {
+    Vector3 pos;
+    float size;
+    Color color;
+};
+
+enum class InstanceShape {
+    kSphere,       // low-poly sphere of radius `size` (replaces DrawSphere)
+    kBillboard,    // camera-facing round sprite of radius `size` in world units
+    kScreenPoint,  // round sprite `size` pixels across (replaces DrawPoint3D)
+};
+
+// Collects particles during a frame and draws them with one instanced draw call.
+// Call Draw() between BeginMode3D/EndMode3D; any immediate-mode geometry queued
+// before it is flushed first so ordering is preserved. Unload() must run before
+// CloseWindow(). If the shader cannot be built (e.g. no GL 3.3), Draw() falls back
+// to the per-particle raylib calls.
+//
+// With SetColormap() the renderer colours instances from a colormap instead:
+// AddMapped() stores the table index in the colour's red byte and the alpha in its
+// alpha byte, and the shader reads the colour out of the map's texture. Use either
+// Add() or AddMapped() on one renderer, not both.
+class InstancedParticleRenderer {
+  public:
+    bool Init(InstanceShape shape, int initialCapacity = 4096) {
+        shape_ = shape;
+        BuildBaseMesh();
+
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locVertex_ = rlGetLocationAttrib(shader_, "vertexPosition");
+        locPosSize_ = rlGetLocationAttrib(shader_, "instancePosSize");
+        locColor_ = rlGetLocationAttrib(shader_, "instanceColor");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locRight_ = rlGetLocationUniform(shader_, "camRight");
+        locUp_ = rlGetLocationUniform(shader_, "camUp");
+        locMode_ = rlGetLocationUniform(shader_, "mode");
+        locViewport_ = rlGetLocationUniform(shader_, "viewport");
+        locMapped_ = rlGetLocationUniform(shader_, "mapped");
+        locColormap_ = rlGetLocationUniform(shader_, "colormap");
+
+        vao_ = rlLoadVertexArray();
+        rlEnableVertexArray(vao_);
+        meshVbo_ = rlLoadVertexBuffer(baseVertices_.data(), static_cast<int>(baseVertices_.size() * sizeof(float)), false);
+        rlSetVertexAttribute(static_cast<unsigned int>(locVertex_), 3, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locVertex_));
+        ebo_ = rlLoadVertexBufferElement(baseIndices_.data(), static_cast<int>(baseIndices_.size() * sizeof(unsigned short)), false);
+        AllocateInstanceBuffer(std::max(1, initialCapacity));
+        rlDisableVertexArray();
+
+        ready_ = vao_ != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (instanceVbo_ != 0) rlUnloadVertexBuffer(instanceVbo_);
+        if (meshVbo_ != 0) rlUnloadVertexBuffer(meshVbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        instanceVbo_ = meshVbo_ = ebo_ = vao_ = shader_ = 0;
+        capacity_ = 0;
+        ready_ = false;
+    }
+
+    void Clear() {
+        instances_.clear();
+        resolved_ = 0;
+    }
+    void Reserve(size_t n) { instances_.reserve(n); }
+    void Add(Vector3 pos, float size, Color color) { instances_.push_back({pos, size, color}); }
+
+    // `texture` is LoadColormapTexture(*map), owned by the caller; with id 0 the
+    // colours are looked up on the CPU at Draw() instead.
+    void SetColormap(const astro_color::Colormap* map, Texture2D texture) {
+        colormap_ = map;
+        colormapTexture_ = texture;
+    }
+
+    void AddMapped(Vector3 pos, float size, float value, unsigned char alpha = 255) {
+        const unsigned char index = static_cast<unsigned char>(colormap_ != nullptr ? colormap_->Index(value) : 0);
+        instances_.push_back({pos, size, Color{index, 0, 0, alpha}});
+    }
+
+    size_t count() const { return instances_.size(); }
+    bool ready() const { return ready_; }
+
+    void Draw() {
+        if (instances_.empty()) return;
+        const bool gpuMapped = colormap_ != nullptr && colormapTexture_.id != 0;
+        if (colormap_ != nullptr && (!ready_ || !gpuMapped)) ResolveMappedColors();
+        if (!ready_) {
+            DrawImmediate();
+            return;
+        }
+
+        rlDrawRenderBatchActive();
+        const int count = static_cast<int>(instances_.size());
+        if (count > capacity_) {
+            rlEnableVertexArray(vao_);
+            rlUnloadVertexBuffer(instanceVbo_);
+            AllocateInstanceBuffer(std::max(count, capacity_ * 2));
+            rlDisableVertexArray();
+        }
+        rlUpdateVertexBuffer(instanceVbo_, instances_.data(), count * static_cast<int>(sizeof(ParticleInstance)), 0);
+
+        const Matrix view = rlGetMatrixModelview();
+        const Matrix mvp = MatrixMultiply(view, rlGetMatrixProjection());
+        const std::array<float, 3> right = {view.m0, view.m4, view.m8};
+        const std::array<float, 3> up = {view.m1, view.m5, view.m9};
+        const std::array<float, 2> viewport = {static_cast<float>(GetRenderWidth()), static_cast<float>(GetRenderHeight())};
+        const int mode = static_cast<int>(shape_);
+        const int mapped = gpuMapped ? 1 : 0;
+        const int colormapSlot = 0;
+
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        rlSetUniform(locRight_, right.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locUp_, up.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locViewport_, viewport.data(), RL_SHADER_UNIFORM_VEC2, 1);
+        rlSetUniform(locMode_, &mode, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(locMapped_, &mapped, RL_SHADER_UNIFORM_INT, 1);
+        if (gpuMapped) {
+            rlActiveTextureSlot(colormapSlot);
+            rlEnableTexture(colormapTexture_.id);
+            rlSetUniform(locColormap_, &colormapSlot, RL_SHADER_UNIFORM_SAMPLER2D, 1);
+        }
+
+        // Sprites are translucent; keep them from punching holes in each other.
+        if (shape_ != InstanceShape::kSphere) rlDisableDepthMask();
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArrayElementsInstanced(0, static_cast<int>(baseIndices_.size()), nullptr, count);
+        rlDisableVertexArray();
+        if (shape_ != InstanceShape::kSphere) rlEnableDepthMask();
+        if (gpuMapped) rlDisableTexture();
+        rlDisableShader();
+    }
+
+  private:
+    void AllocateInstanceBuffer(int capacity) {
+        capacity_ = capacity;
+        instanceVbo_ = rlLoadVertexBuffer(nullptr, capacity_ * static_cast<int>(sizeof(ParticleInstance)), true);
+        const int stride = static_cast<int>(sizeof(ParticleInstance));
+        rlSetVertexAttribute(static_cast<unsigned int>(locPosSize_), 4, RL_FLOAT, false, stride, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locPosSize_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locPosSize_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locColor_), 4, RL_UNSIGNED_BYTE, true, stride,
+                             static_cast<int>(offsetof(ParticleInstance, color)));
+        rlEnableVertexAttribute(static_cast<unsigned int>(locColor_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locColor_), 1);
+    }
+
+    void BuildBaseMesh() {
+        baseVertices_.clear();
+        baseIndices_.clear();
+        if (shape_ != InstanceShape::kSphere) {
+            baseVertices_ = {-1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f};
+            baseIndices_ = {0, 1, 2, 0, 2, 3};
+            return;
+        }
+
+        constexpr int kRings = 6;
+        constexpr int kSlices = 10;
+        for (int r = 0; r <= kRings; ++r) {
+            const float v = PI * static_cast<float>(r) / static_cast<float>(kRings);
+            for (int s = 0; s <= kSlices; ++s) {
+                const float u = 2.0f * PI * static_cast<float>(s) / static_cast<float>(kSlices);
+                baseVertices_.push_back(std::sin(v) * std::cos(u));
+                baseVertices_.push_back(std::cos(v));
+                baseVertices_.push_back(std::sin(v) * std::sin(u));
+            }
+        }
+        for (int r = 0; r < kRings; ++r) {
+            for (int s = 0; s < kSlices; ++s) {
+                const unsigned short a = static_cast<unsigned short>(r * (kSlices + 1) + s);
+                const unsigned short b = static_cast<unsigned short>(a + kSlices + 1);
+                baseIndices_.insert(baseIndices_.end(), {a, b, static_cast<unsigned short>(a + 1)});
+                baseIndices_.insert(baseIndices_.end(), {static_cast<unsigned short>(a + 1), b, static_cast<unsigned short>(b + 1)});
+            }
+        }
+    }
+
+    void ResolveMappedColors() {
+        const auto& lut = colormap_->entries();
+        for (; resolved_ < instances_.size(); ++resolved_) {
+            ParticleInstance& p = instances_[resolved_];
+            const unsigned char alpha = p.color.a;
+            p.color = lut[p.color.r];
+            p.color.a = alpha;
+        }
+    }
+
+    void DrawImmediate() const {
+        for (const ParticleInstance& p : instances_) {
+            if (shape_ == InstanceShape::kScreenPoint) {
+                DrawPoint3D(p.pos, p.color);
+            } else {
+                DrawSphere(p.pos, p.size, p.color);
+            }
+        }
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec3 vertexPosition;
+in vec4 instancePosSize;
+in vec4 instanceColor;
+uniform mat4 mvp;
+uniform vec3 camRight;
+uniform vec3 camUp;
+uniform vec2 viewport;
+uniform int mode;
+uniform int mapped;
+uniform sampler2D colormap;
+out vec4 fragColor;
+out vec2 fragLocal;
+flat out int fragMode;
+void main() {
+    fragColor = instanceColor;
+    if (mapped != 0) {
+        // Red byte = table index; sample that entry's texel centre.
+        vec3 rgb = texture(colormap, vec2((instanceColor.r * 255.0 + 0.5) / 256.0, 0.5)).rgb;
+        fragColor = vec4(rgb, instanceColor.a);
+    }
+    fragLocal = vertexPosition.xy;
+    fragMode = mode;
+    if (mode == 0) {
+        gl_Position = mvp * vec4(instancePosSize.xyz + vertexPosition * instancePosSize.w, 1.0);
+    } else if (mode == 1) {
+        vec3 world = instancePosSize.xyz + (camRight * vertexPosition.x + camUp * vertexPosition.y) * instancePosSize.w;
+        gl_Position = mvp * vec4(world, 1.0);
+    } else {
+        vec4 clip = mvp * vec4(instancePosSize.xyz, 1.0);
+        clip.xy += vertexPosition.xy * instancePosSize.w / viewport * clip.w;
+        gl_Position = clip;
+    }
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+in vec2 fragLocal;
+flat in int fragMode;
+out vec4 finalColor;
+void main() {
+    if (fragMode != 0 && dot(fragLocal, fragLocal) > 1.0) discard;
+    finalColor = fragColor;
+}
+)";
+
+    InstanceShape shape_ = InstanceShape::kSphere;
+    std::vector<float> baseVertices_;
+    std::vector<unsigned short> baseIndices_;
+    std::vector<ParticleInstance> instances_;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int meshVbo_ = 0;
+    unsigned int ebo_ = 0;
+    unsigned int instanceVbo_ = 0;
+    int capacity_ = 0;
+    int locVertex_ = -1;
+    int locPosSize_ = -1;
+    int locColor_ = -1;
+    int locMvp_ = -1;
+    int locRight_ = -1;
+    int locUp_ = -1;
+    int locMode_ = -1;
+    int locViewport_ = -1;
+    int locMapped_ = -1;
+    int locColormap_ = -1;
+    const astro_color::Colormap* colormap_ = nullptr;
+    Texture2D colormapTexture_{};
+    size_t resolved_ = 0;  // mapped instances already turned into colours
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
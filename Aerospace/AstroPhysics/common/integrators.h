@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+// Time integrators shared by the orbital demos.
+//
+// The symplectic methods work on any drift/kick system, i.e. a type with
+//   void Drift(float h);  // positions += h * velocities
+//   void Kick(float h);   // velocities += h * accelerations at the current positions
+// Leapfrog is 2nd order for one force evaluation per step; Yoshida-4 composes three
+// leapfrog sub-steps into a 4th-order method. Both keep the energy error bounded over
+// long runs instead of letting it drift.
+//
+// Rk4Step and DormandPrince45Advance work on flat state vectors (std::array<Real, N>)
+// with a derivative callback f(y, dydt). The Dormand-Prince 5(4) pair adapts its step
+// to the local error, so close encounters get small steps only while they last.
+// Rosenbrock23Advance has the same interface for stiff systems, where an explicit
+// method's step is pinned to the fastest decay rate long after it stopped mattering.
+
+namespace astro_integrate {
+
+enum class Method {
+    Rk4 = 0,
+    Leapfrog,
+    Yoshida4,
+    DormandPrince45,
+};
+
+constexpr int kMethodCount = 4;
+
+inline const char* MethodName(Method method) {
+    switch (method) {
+        case Method::Rk4: return "RK4";
+        case Method::Leapfrog: return "Leapfrog";
+        case Method::Yoshida4: return "Yoshida-4";
+        case Method::DormandPrince45: return "Dormand-Prince 5(4)";
+    }
+    return "?";
+}
+
+inline Method NextMethod(Method method) {
+    return static_cast<Method>((static_cast<int>(method) + 1) % kMethodCount);
+}
+
+// Accepts "rk4", "leapfrog", "yoshida4" and "dopri5" (the --integrator= values).
+inline bool ParseMethod(const char* name, Method* out) {
+    struct Entry {
+        const char* name;
+        Method method;
+    };
+    static constexpr Entry kNames[] = {
+        {"rk4", Method::Rk4},
+        {"leapfrog", Method::Leapfrog},
+        {"yoshida4", Method::Yoshida4},
+        {"dopri5", Method::DormandPrince45},
+    };
+    for (const Entry& entry : kNames) {
+        if (std::strcmp(name, entry.name) == 0) {
+            *out = entry.method;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool IsSymplectic(Method method) {
+    return method == Method::Leapfrog || method == Method::Yoshida4;
+}
+
+// Drift-kick-drift: one force evaluation per step.
+template <typename System>
+void LeapfrogStep(System& system, float h) {
+    system.Drift(0.5f * h);
+    system.Kick(h);
+    system.Drift(0.5f * h);
+}
+
+// Yoshida (1990) 4th-order composition of three leapfrog steps; the middle one runs
+// backwards in time.
+template <typename System>
+void Yoshida4Step(System& system, float h) {
+    constexpr double kCbrt2 = 1.2599210498948731648;
+    constexpr double kW1 = 1.0 / (2.0 - kCbrt2);
+    constexpr double kW0 = -kCbrt2 / (2.0 - kCbrt2);
+    constexpr float kC1 = static_cast<float>(0.5 * kW1);
+    constexpr float kC2 = static_cast<float>(0.5 * (kW0 + kW1));
+    constexpr float kD1 = static_cast<float>(kW1);
+    constexpr float kD2 = static_cast<float>(kW0);
+
+    system.Drift(kC1 * h);
+    system.Kick(kD1 * h);
+    system.Drift(kC2 * h);
+    system.Kick(kD2 * h);
+    system.Drift(kC2 * h);
+    system.Kick(kD1 * h);
+    system.Drift(kC1 * h);
+}
+
+template <typename System>
+void SymplecticStep(Method method, System& system, float h) {
+    if (method == Method::Yoshida4) {
+        Yoshida4Step(system, h);
+    } else {
+        LeapfrogStep(system, h);
+    }
+}
+
+template <typename Real, size_t N, typename Deriv>
+void Rk4Step(std::array<Real, N>& y, Real h, Deriv&& f) {
+    std::array<Real, N> k1, k2, k3, k4, tmp;
+    f(y, k1);
+    for (size_t i = 0; i < N; ++i) tmp[i] = y[i] + Real(0.5) * h * k1[i];
+    f(tmp, k2);
+    for (size_t i = 0; i < N; ++i) tmp[i] = y[i] + Real(0.5) * h * k2[i];
+    f(tmp, k3);
+    for (size_t i = 0; i < N; ++i) tmp[i] = y[i] + h * k3[i];
+    f(tmp, k4);
+    for (size_t i = 0; i < N; ++i) y[i] += h / Real(6) * (k1[i] + Real(2) * (k2[i] + k3[i]) + k4[i]);
+}
+
+// Step-size state carried between DormandPrince45Advance calls.
+struct AdaptiveStepper {
+    float relTol = 1.0e-5f;
+    float absTol = 1.0e-5f;
+    float minStep = 1.0e-6f;
+    float maxStep = 0.05f;
+    // Upper bound on attempted steps per Advance call, so a near-singular encounter
+    // slows the scene down instead of stalling the frame.
+    int maxAttempts = 20000;
+
+    float step = 0.0f;  // next step to try; 0 picks maxStep
+    int lastAccepted = 0;
+    int lastRejected = 0;
+};
+
+// Advances y by `duration` in as many adaptive steps as the error control needs and
+// returns the time actually covered (less than `duration` only if maxAttempts ran out).
+template <typename Real, size_t N, typename Deriv>
+Real DormandPrince45Advance(std::array<Real, N>& y, Real duration, Deriv&& f, AdaptiveStepper& ctl) {
+    constexpr Real a21 = Real(1.0 / 5.0);
+    constexpr Real a31 = Real(3.0 / 40.0), a32 = Real(9.0 / 40.0);
+    constexpr Real a41 = Real(44.0 / 45.0), a42 = Real(-56.0 / 15.0), a43 = Real(32.0 / 9.0);
+    constexpr Real a51 = Real(19372.0 / 6561.0), a52 = Real(-25360.0 / 2187.0), a53 = Real(64448.0 / 6561.0),
+                   a54 = Real(-212.0 / 729.0);
+    constexpr Real a61 = Real(9017.0 / 3168.0), a62 = Real(-355.0 / 33.0), a63 = Real(46732.0 / 5247.0),
+                   a64 = Real(49.0 / 176.0), a65 = Real(-5103.0 / 18656.0);
+    constexpr Real b1 = Real(35.0 / 384.0), b3 = Real(500.0 / 1113.0), b4 = Real(125.0 / 192.0),
+                   b5 = Real(-2187.0 / 6784.0), b6 = Real(11.0 / 84.0);
+    // 5th minus embedded 4th order weights.
+    constexpr Real e1 = Real(71.0 / 57600.0), e3 = Real(-71.0 / 16695.0), e4 = Real(71.0 / 1920.0),
+                   e5 = Real(-17253.0 / 339200.0), e6 = Real(22.0 / 525.0), e7 = Real(-1.0 / 40.0);
+
+    ctl.lastAccepted = 0;
+    ctl.lastRejected = 0;
+    if (!(duration > Real(0))) return Real(0);
+    if (!(ctl.step > 0.0f)) ctl.step = ctl.maxStep;
+
+    std::array<Real, N> k1, k2, k3, k4, k5, k6, k7, tmp, next;
+    f(y, k1);
+
+    Real covered = Real(0);
+    int attempts = 0;
+    while (covered < duration && attempts < ctl.maxAttempts) {
+        ++attempts;
+        const Real remaining = duration - covered;
+        const bool truncated = static_cast<Real>(ctl.step) >= remaining;
+        const Real h = truncated ? remaining : static_cast<Real>(ctl.step);
+
+        for (size_t i = 0; i < N; ++i) tmp[i] = y[i] + h * a21 * k1[i];
+        f(tmp, k2);
+        for (size_t i = 0; i < N; ++i) tmp[i] = y[i] + h * (a31 * k1[i] + a32 * k2[i]);
+        f(tmp, k3);
+        for (size_t i = 0; i < N; ++i) tmp[i] = y[i] + h * (a41 * k1[i] + a42 * k2[i] + a43 * k3[i]);
+        f(tmp, k4);
+        for (size_t i = 0; i < N; ++i) tmp[i] = y[i] + h * (a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i]);
+        f(tmp, k5);
+        for (size_t i = 0; i < N; ++i) {
+            tmp[i] = y[i] + h * (a61 * k1[i] + a62 * k2[i] + a63 * k3[i] + a64 * k4[i] + a65 * k5[i]);
+        }
+        f(tmp, k6);
+        for (size_t i = 0; i < N; ++i) {
+            next[i] = y[i] + h * (b1 * k1[i] + b3 * k3[i] + b4 * k4[i] + b5 * k5[i] + b6 * k6[i]);
+        }
+        f(next, k7);
+
+        Real errSum = Real(0);
+        for (size_t i = 0; i < N; ++i) {
+            const Real err = h * (e1 * k1[i] + e3 * k3[i] + e4 * k4[i] + e5 * k5[i] + e6 * k6[i] + e7 * k7[i]);
+            const Real scale = Real(ctl.absTol) + Real(ctl.relTol) * std::max(std::fabs(y[i]), std::fabs(next[i]));
+            errSum += (err / scale) * (err / scale);
+        }
+        const Real errNorm = std::sqrt(errSum / Real(N));
+        const Real factor = errNorm > Real(0) ? Real(0.9) * std::pow(errNorm, Real(-0.2)) : Real(5);
+
+        if (errNorm <= Real(1) || h <= Real(ctl.minStep)) {
+            y = next;
+            k1 = k7;  // first-same-as-last
+            covered = truncated ? duration : covered + h;
+            ++ctl.lastAccepted;
+            // A step shortened to land on `duration` says little about the next one.
+            if (!truncated) {
+                ctl.step = static_cast<float>(std::clamp(h * std::min(factor, Real(5)), Real(ctl.minStep), Real(ctl.maxStep)));
+            }
+        } else {
+            ++ctl.lastRejected;
+            ctl.step = static_cast<float>(std::max(Real(ctl.minStep), h * std::max(factor, Real(0.2))));
+        }
+    }
+    return covered;
+}
+
+namespace detail {
+
+// In-place LU factorisation with partial pivoting; false if the matrix is singular.
+template <typename Real, size_t N>
+bool LuFactor(std::array<std::array<Real, N>, N>& a, std::array<size_t, N>& pivot) {
+    for (size_t k = 0; k < N; ++k) {
+        size_t p = k;
+        for (size_t i = k + 1; i < N; ++i) {
+            if (std::fabs(a[i][k]) > std::fabs(a[p][k])) p = i;
+        }
+        if (a[p][k] == Real(0)) return false;
+        pivot[k] = p;
+        if (p != k) std::swap(a[p], a[k]);
+        const Real inv = Real(1) / a[k][k];
+        for (size_t i = k + 1; i < N; ++i) {
+            const Real m = a[i][k] * inv;
+            a[i][k] = m;
+            for (size_t j = k + 1; j < N; ++j) a[i][j] -= m * a[k][j];
+        }
+    }
+    return true;
+}
+
+template <typename Real, size_t N>
+void LuSolve(const std::array<std::array<Real, N>, N>& lu, const std::array<size_t, N>& pivot, std::array<Real, N>& x) {
+    // Whole rows were swapped during factorisation, so the permutation goes first.
+    for (size_t k = 0; k < N; ++k) std::swap(x[k], x[pivot[k]]);
+    for (size_t k = 0; k < N; ++k) {
+        for (size_t i = k + 1; i < N; ++i) x[i] -= lu[i][k] * x[k];
+    }
+    for (size_t k = N; k-- > 0;) {
+        for (size_t j = k + 1; j < N; ++j) x[k] -= lu[k][j] * x[j];
+        x[k] /= lu[k][k];
+    }
+}
+
+}  // namespace detail
+
+// Shampine and Reichelt's L-stable Rosenbrock 2(3) pair (MATLAB's ode23s) for an
+// autonomous y' = f(y). Each step solves three linear systems with W = I - h d J, where
+// J is a forward-difference Jacobian refreshed whenever a step is accepted; a rejected
+// step only refactors W. Stiff modes are damped instead of resolved, so the step grows
+// with the slow dynamics. Returns the time covered, as DormandPrince45Advance does.
+template <typename Real, size_t N, typename Deriv>
+Real Rosenbrock23Advance(std::array<Real, N>& y, Real duration, Deriv&& f, AdaptiveStepper& ctl) {
+    const Real d = Real(1) / (Real(2) + std::sqrt(Real(2)));
+    const Real e32 = Real(6) + std::sqrt(Real(2));
+
+    ctl.lastAccepted = 0;
+    ctl.lastRejected = 0;
+    if (!(duration > Real(0))) return Real(0);
+    if (!(ctl.step > 0.0f)) ctl.step = ctl.maxStep;
+
+    std::array<std::array<Real, N>, N> jac, w;
+    std::array<size_t, N> pivot;
+    std::array<Real, N> f0, f1, f2, k1, k2, k3, tmp, next;
+    bool fresh = false;
+    f(y, f0);
+
+    Real covered = Real(0);
+    int attempts = 0;
+    while (covered < duration && attempts < ctl.maxAttempts) {
+        ++attempts;
+        if (!fresh) {
+            for (size_t j = 0; j < N; ++j) {
+                const Real delta = std::sqrt(std::numeric_limits<Real>::epsilon()) * std::max(std::fabs(y[j]), Real(1));
+                tmp = y;
+                tmp[j] += delta;
+                f(tmp, f1);
+                for (size_t i = 0; i < N; ++i) jac[i][j] = (f1[i] - f0[i]) / delta;
+            }
+            fresh = true;
+        }
+        const Real remaining = duration - covered;
+        const bool truncated = static_cast<Real>(ctl.step) >= remaining;
+        const Real h = truncated ? remaining : static_cast<Real>(ctl.step);
+
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < N; ++j) w[i][j] = (i == j ? Real(1) : Real(0)) - h * d * jac[i][j];
+        }
+        if (!detail::LuFactor(w, pivot)) {
+            ++ctl.lastRejected;
+            ctl.step = static_cast<float>(std::max(Real(ctl.minStep), h * Real(0.25)));
+            continue;
+        }
+        k1 = f0;
+        detail::LuSolve(w, pivot, k1);
+        for (size_t i = 0; i < N; ++i) tmp[i] = y[i] + Real(0.5) * h * k1[i];
+        f(tmp, f1);
+        for (size_t i = 0; i < N; ++i) k2[i] = f1[i] - k1[i];
+        detail::LuSolve(w, pivot, k2);
+        for (size_t i = 0; i < N; ++i) {
+            k2[i] += k1[i];
+            next[i] = y[i] + h * k2[i];
+        }
+        f(next, f2);
+        for (size_t i = 0; i < N; ++i) k3[i] = f2[i] - e32 * (k2[i] - f1[i]) - Real(2) * (k1[i] - f0[i]);
+        detail::LuSolve(w, pivot, k3);
+
+        // The raw estimate stays O(1) in stiff components however small h gets; passing it
+        // through W^-1 damps those by 1 / (h d |lambda|), as Hairer and Wanner do for Radau5.
+        for (size_t i = 0; i < N; ++i) tmp[i] = h / Real(6) * (k1[i] - Real(2) * k2[i] + k3[i]);
+        detail::LuSolve(w, pivot, tmp);
+        Real errSum = Real(0);
+        for (size_t i = 0; i < N; ++i) {
+            const Real scale = Real(ctl.absTol) + Real(ctl.relTol) * std::max(std::fabs(y[i]), std::fabs(next[i]));
+            errSum += (tmp[i] / scale) * (tmp[i] / scale);
+        }
+        const Real errNorm = std::sqrt(errSum / Real(N));
+        const Real factor = errNorm > Real(0) ? Real(0.8) * std::pow(errNorm, Real(-1) / Real(3)) : Real(5);
+
+        if ((errNorm <= Real(1) && std::isfinite(errNorm)) || h <= Real(ctl.minStep)) {
+            y = next;
+            f0 = f2;
+            fresh = false;
+            covered = truncated ? duration : covered + h;
+            ++ctl.lastAccepted;
+            if (!truncated) {
+                ctl.step = static_cast<float>(std::clamp(h * std::min(factor, Real(5)), Real(ctl.minStep), Real(ctl.maxStep)));
+            }
+        } else {
+            ++ctl.lastRejected;
+            const Real shrink = std::isfinite(factor) ? std::max(factor, Real(0.2)) : Real(0.2);
+            ctl.step = static_cast<float>(std::max(Real(ctl.minStep), h * shrink));
+        }
+    }
+    return covered;
+}
+
+}  // namespace astro_integrate
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "lambert.h"
+
+#include <cmath>
+#include <cstddef>
+
+// Exact two-body steps about a point mass at the origin, in universal variables
+// (Curtis, algorithms 3.3 and 3.4), so circular, eccentric and escape orbits share one
+// code path. PropagateBatch() advances kLanes bodies side by side with a fixed number
+// of Newton steps on the universal anomaly, reusing the Lambert solver's lane-wise
+// Stumpff functions, so the loops stay branch-free like astro_lambert::SolveBatch().
+//
+// The step is exact however long dt is, up to the Stumpff series range (z = alpha chi^2
+// below about 64, several orbits), so frame hitches do not wreck an orbit the way an
+// explicit integrator step of the same size would.
+
+namespace astro_kepler {
+
+using astro_lambert::kLanes;
+
+constexpr int kNewtonSteps = 4;  // chi0 = sqrt(mu) dt / r0 is already second-order accurate
+
+struct Batch {
+    double x[kLanes], y[kLanes], z[kLanes];
+    double vx[kLanes], vy[kLanes], vz[kLanes];
+};
+
+// Advances every lane by dt in place. Lanes must not sit at the origin; pad partial
+// batches with any orbit (PadLane) and ignore what comes back.
+inline void PropagateBatch(Batch* b, double mu, double dt) {
+    const double sqrtMu = std::sqrt(mu);
+    double r0[kLanes], radialTerm[kLanes], energyTerm[kLanes], alpha[kLanes], chi[kLanes];
+    for (int l = 0; l < kLanes; ++l) {
+        r0[l] = std::sqrt(b->x[l] * b->x[l] + b->y[l] * b->y[l] + b->z[l] * b->z[l]);
+        const double v2 = b->vx[l] * b->vx[l] + b->vy[l] * b->vy[l] + b->vz[l] * b->vz[l];
+        const double rv = b->x[l] * b->vx[l] + b->y[l] * b->vy[l] + b->z[l] * b->vz[l];
+        alpha[l] = 2.0 / r0[l] - v2 / mu;
+        radialTerm[l] = rv / sqrtMu;  // r0 vr0 / sqrt(mu)
+        energyTerm[l] = 1.0 - alpha[l] * r0[l];
+        chi[l] = sqrtMu * dt / r0[l];
+    }
+
+    // F(chi) = r0 vr0/sqrt(mu) chi^2 C + (1 - alpha r0) chi^3 S + r0 chi - sqrt(mu) dt;
+    // F'(chi) is the radius at the new point, which is never zero.
+    double zz[kLanes], c[kLanes], s[kLanes];
+    for (int it = 0; it < kNewtonSteps; ++it) {
+        for (int l = 0; l < kLanes; ++l) zz[l] = alpha[l] * chi[l] * chi[l];
+        astro_lambert::Stumpff(zz, c, s);
+        for (int l = 0; l < kLanes; ++l) {
+            const double chi2 = chi[l] * chi[l];
+            const double f = radialTerm[l] * chi2 * c[l] + energyTerm[l] * chi2 * chi[l] * s[l] + r0[l] * chi[l] - sqrtMu * dt;
+            const double df = radialTerm[l] * chi[l] * (1.0 - zz[l] * s[l]) + energyTerm[l] * chi2 * c[l] + r0[l];
+            chi[l] -= f / df;
+        }
+    }
+
+    for (int l = 0; l < kLanes; ++l) zz[l] = alpha[l] * chi[l] * chi[l];
+    astro_lambert::Stumpff(zz, c, s);
+    for (int l = 0; l < kLanes; ++l) {
+        const double chi2 = chi[l] * chi[l];
+        const double f = 1.0 - chi2 / r0[l] * c[l];
+        const double g = dt - chi2 * chi[l] * s[l] / sqrtMu;
+        const double x = f * b->x[l] + g * b->vx[l];
+        const double y = f * b->y[l] + g * b->vy[l];
+        const double z = f * b->z[l] + g * b->vz[l];
+        const double r = std::sqrt(x * x + y * y + z * z);
+        const double fDot = sqrtMu / (r * r0[l]) * chi[l] * (zz[l] * s[l] - 1.0);
+        const double gDot = 1.0 - chi2 / r * c[l];
+        const double vx = fDot * b->x[l] + gDot * b->vx[l];
+        const double vy = fDot * b->y[l] + gDot * b->vy[l];
+        const double vz = fDot * b->z[l] + gDot * b->vz[l];
+        b->x[l] = x;
+        b->y[l] = y;
+        b->z[l] = z;
+        b->vx[l] = vx;
+        b->vy[l] = vy;
+        b->vz[l] = vz;
+    }
+}
+
+inline void PadLane(Batch* b, int l, double mu) {
+    b->x[l] = 1.0;
+    b->y[l] = b->z[l] = 0.0;
+    b->vx[l] = b->vz[l] = 0.0;
+    b->vy[l] = std::sqrt(mu);
+}
+
+// Advances `count` bodies by dt, kLanes at a time. body(k) returns a reference to
+// something with Vector3 `pos` and `vel` members.
+template <typename BodyOf>
+void Propagate(size_t count, float mu, float dt, BodyOf&& body) {
+    Batch batch;
+    for (size_t first = 0; first < count; first += kLanes) {
+        const int lanes = static_cast<int>(count - first < static_cast<size_t>(kLanes) ? count - first : kLanes);
+        for (int l = 0; l < kLanes; ++l) {
+            if (l >= lanes) {
+                PadLane(&batch, l, mu);
+                continue;
+            }
+            const auto& b = body(first + static_cast<size_t>(l));
+            batch.x[l] = b.pos.x;
+            batch.y[l] = b.pos.y;
+            batch.z[l] = b.pos.z;
+            batch.vx[l] = b.vel.x;
+            batch.vy[l] = b.vel.y;
+            batch.vz[l] = b.vel.z;
+        }
+        PropagateBatch(&batch, mu, dt);
+        for (int l = 0; l < lanes; ++l) {
+            auto& b = body(first + static_cast<size_t>(l));
+            b.pos = {static_cast<float>(batch.x[l]), static_cast<float>(batch.y[l]), static_cast<float>(batch.z[l])};
+            b.vel = {static_cast<float>(batch.vx[l]), static_cast<float>(batch.vy[l]), static_cast<float>(batch.vz[l])};
+        }
+    }
+}
+
+}  // namespace astro_kepler
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "ephemeris.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Zero-revolution, prograde Lambert solver in universal variables (Bate, Mueller &
+// White; Curtis ch. 5). SolveBatch() runs kLanes independent problems side by side:
+// the Stumpff functions come from a short series plus angle doubling and the root is
+// found by a fixed number of bisection then Illinois (regula falsi) steps, so every
+// loop over lanes is branch-free arithmetic the compiler can keep in vector registers.
+
+namespace astro_lambert {
+
+using astro_ephem::StateVector;
+using astro_ephem::Vec3d;
+
+constexpr int kLanes = 8;
+
+// Root bracket for z: the upper end is the one-revolution limit, the lower end allows
+// hyperbolic transfers down to a few tens of days between the inner planets.
+// Bisection narrows it to ~0.4 before Illinois steps converge on the root (C3 to
+// ~1e-10 relative on Earth-Mars grids).
+constexpr double kMinZ = -64.0;
+constexpr double kMaxZ = 4.0 * astro_ephem::kPi * astro_ephem::kPi - 1.0e-9;
+constexpr int kBisectionSteps = 8;
+constexpr int kIllinoisSteps = 4;
+
+// Stumpff C(z) and S(z) for every lane. z is scaled by 4^-5 into the series range
+// (|z| < 0.07 for the bracket above) and the double-angle identities of c0..c3 undo
+// the scaling. The doubling loop sits outside the lane loops so those stay flat.
+inline void Stumpff(const double* z, double* c, double* s) {
+    double c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+    for (int l = 0; l < kLanes; ++l) {
+        const double x = z[l] * (1.0 / 1024.0);
+        c0[l] = 1.0 - x * (1.0 / 2.0) * (1.0 - x * (1.0 / 12.0) * (1.0 - x * (1.0 / 30.0) * (1.0 - x * (1.0 / 56.0) * (1.0 - x * (1.0 / 90.0)))));
+        c1[l] = 1.0 - x * (1.0 / 6.0) * (1.0 - x * (1.0 / 20.0) * (1.0 - x * (1.0 / 42.0) * (1.0 - x * (1.0 / 72.0) * (1.0 - x * (1.0 / 110.0)))));
+        c2[l] = 0.5 * (1.0 - x * (1.0 / 12.0) * (1.0 - x * (1.0 / 30.0) * (1.0 - x * (1.0 / 56.0) * (1.0 - x * (1.0 / 90.0)))));
+        c3[l] = (1.0 / 6.0) * (1.0 - x * (1.0 / 20.0) * (1.0 - x * (1.0 / 42.0) * (1.0 - x * (1.0 / 72.0) * (1.0 - x * (1.0 / 110.0)))));
+    }
+    for (int i = 0; i < 5; ++i) {
+        for (int l = 0; l < kLanes; ++l) {
+            const double n3 = 0.25 * (c2[l] + c0[l] * c3[l]);
+            const double n2 = 0.5 * c1[l] * c1[l];
+            const double n1 = c0[l] * c1[l];
+            c0[l] = 2.0 * c0[l] * c0[l] - 1.0;
+            c1[l] = n1;
+            c2[l] = n2;
+            c3[l] = n3;
+        }
+    }
+    for (int l = 0; l < kLanes; ++l) {
+        c[l] = c2[l];
+        s[l] = c3[l];
+    }
+}
+
+inline double Norm(const Vec3d& v) {
+    return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+// One batch of transfers: departure positions and transfer times per lane, a shared
+// arrival position. Lanes with tof <= 0 come back as NaN; pad partial batches with them.
+struct Batch {
+    double r1x[kLanes], r1y[kLanes], r1z[kLanes];
+    double tof[kLanes];
+    Vec3d r2;
+};
+
+// Departure and arrival velocities per lane, or NaN where there is no solution
+// (transfer angle at 180 degrees, or time of flight past the one-revolution limit).
+struct BatchResult {
+    double v1x[kLanes], v1y[kLanes], v1z[kLanes];
+    double v2x[kLanes], v2y[kLanes], v2z[kLanes];
+};
+
+inline void SolveBatch(const Batch& in, double mu, BatchResult* out) {
+    double r1n[kLanes], a[kLanes], lo[kLanes], hi[kLanes], target[kLanes];
+    const double r2n = Norm(in.r2);
+    const double sqrtMu = std::sqrt(mu);
+    for (int l = 0; l < kLanes; ++l) {
+        r1n[l] = std::sqrt(in.r1x[l] * in.r1x[l] + in.r1y[l] * in.r1y[l] + in.r1z[l] * in.r1z[l]);
+        const double cosTheta = std::clamp(
+            (in.r1x[l] * in.r2.x + in.r1y[l] * in.r2.y + in.r1z[l] * in.r2.z) / (r1n[l] * r2n), -1.0, 1.0);
+        const double crossZ = in.r1x[l] * in.r2.y - in.r1y[l] * in.r2.x;
+        // sin(theta) of the prograde transfer angle: negative once it passes 180 degrees.
+        const double sinTheta = std::copysign(std::sqrt(std::max(0.0, 1.0 - cosTheta * cosTheta)), crossZ);
+        a[l] = sinTheta * std::sqrt(r1n[l] * r2n / std::max(1.0e-12, 1.0 - cosTheta));
+        lo[l] = kMinZ;
+        hi[l] = kMaxZ;
+        target[l] = sqrtMu * std::max(in.tof[l], 0.0);
+    }
+
+    // F(z) = (y/C)^1.5 S + A sqrt(y) - sqrt(mu) t grows with z wherever y(z) > 0.
+    // y < 0 only happens below the root; clamping y to 0 there keeps F continuous
+    // (it bottoms out at -sqrt(mu) t), which is all bisection and regula falsi need.
+    double z[kLanes], c[kLanes], s[kLanes], y[kLanes], f[kLanes];
+    const auto timeResidual = [&]() {
+        Stumpff(z, c, s);
+        for (int l = 0; l < kLanes; ++l) {
+            const double invRootC = 1.0 / std::sqrt(c[l]);
+            y[l] = r1n[l] + r2n + a[l] * (z[l] * s[l] - 1.0) * invRootC;
+            const double rootY = std::sqrt(std::max(y[l], 0.0));
+            const double chi = rootY * invRootC;
+            f[l] = chi * chi * chi * s[l] + a[l] * rootY - target[l];
+        }
+    };
+
+    for (int it = 0; it < kBisectionSteps; ++it) {
+        for (int l = 0; l < kLanes; ++l) z[l] = 0.5 * (lo[l] + hi[l]);
+        timeResidual();
+        for (int l = 0; l < kLanes; ++l) {
+            const bool below = f[l] < 0.0;
+            lo[l] = below ? z[l] : lo[l];
+            hi[l] = below ? hi[l] : z[l];
+        }
+    }
+
+    double fLo[kLanes], fHi[kLanes], side[kLanes];
+    for (int l = 0; l < kLanes; ++l) z[l] = lo[l];
+    timeResidual();
+    for (int l = 0; l < kLanes; ++l) fLo[l] = f[l];
+    for (int l = 0; l < kLanes; ++l) z[l] = hi[l];
+    timeResidual();
+    for (int l = 0; l < kLanes; ++l) {
+        fHi[l] = f[l];
+        side[l] = 0.0;
+    }
+
+    // Illinois: a regula falsi step, halving the stale end's residual whenever the
+    // same end moves twice in a row so the bracket keeps shrinking from both sides.
+    const auto falsePosition = [&]() {
+        for (int l = 0; l < kLanes; ++l) {
+            const double span = fHi[l] - fLo[l];
+            const double secant = (lo[l] * fHi[l] - hi[l] * fLo[l]) / (span > 0.0 ? span : 1.0);
+            z[l] = span > 0.0 ? secant : 0.5 * (lo[l] + hi[l]);
+        }
+    };
+    for (int it = 0; it < kIllinoisSteps; ++it) {
+        falsePosition();
+        timeResidual();
+        for (int l = 0; l < kLanes; ++l) {
+            const bool below = f[l] < 0.0;
+            fHi[l] = below ? (side[l] < 0.0 ? 0.5 * fHi[l] : fHi[l]) : f[l];
+            fLo[l] = below ? f[l] : (side[l] > 0.0 ? 0.5 * fLo[l] : fLo[l]);
+            lo[l] = below ? z[l] : lo[l];
+            hi[l] = below ? hi[l] : z[l];
+            side[l] = below ? -1.0 : 1.0;
+        }
+    }
+
+    falsePosition();
+    timeResidual();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (int l = 0; l < kLanes; ++l) {
+        const double lagrangeF = 1.0 - y[l] / r1n[l];
+        const double g = a[l] * std::sqrt(std::max(y[l], 0.0) / mu);
+        const double gDot = 1.0 - y[l] / r2n;
+        // A root at either bracket end means none inside it: the transfer needs more
+        // than one revolution or is faster than the bracket allows. A ~ 0 is the
+        // 180 degree singularity.
+        const bool ok = in.tof[l] > 0.0 && y[l] > 0.0 && std::fabs(g) > 1.0e-12 && hi[l] < kMaxZ && lo[l] > kMinZ;
+        const double invG = ok ? 1.0 / (ok ? g : 1.0) : nan;
+        out->v1x[l] = (in.r2.x - lagrangeF * in.r1x[l]) * invG;
+        out->v1y[l] = (in.r2.y - lagrangeF * in.r1y[l]) * invG;
+        out->v1z[l] = (in.r2.z - lagrangeF * in.r1z[l]) * invG;
+        out->v2x[l] = (gDot * in.r2.x - in.r1x[l]) * invG;
+        out->v2y[l] = (gDot * in.r2.y - in.r1y[l]) * invG;
+        out->v2z[l] = (gDot * in.r2.z - in.r1z[l]) * invG;
+    }
+}
+
+// Scalar convenience wrapper: departure and arrival velocities of the transfer from
+// r1 to r2 in tof days. Returns false when there is no zero-revolution solution.
+inline bool Solve(const Vec3d& r1, const Vec3d& r2, double tof, double mu, Vec3d* v1, Vec3d* v2) {
+    Batch batch{};
+    for (int l = 0; l < kLanes; ++l) {
+        batch.r1x[l] = r1.x;
+        batch.r1y[l] = r1.y;
+        batch.r1z[l] = r1.z;
+        batch.tof[l] = l == 0 ? tof : 0.0;
+    }
+    batch.r2 = r2;
+    BatchResult result;
+    SolveBatch(batch, mu, &result);
+    if (!std::isfinite(result.v1x[0])) return false;
+    if (v1 != nullptr) *v1 = {result.v1x[0], result.v1y[0], result.v1z[0]};
+    if (v2 != nullptr) *v2 = {result.v2x[0], result.v2y[0], result.v2z[0]};
+    return true;
+}
+
+}  // namespace astro_lambert
@@ -0,0 +1,338 @@
+#pragma once
+
+#include "raylib.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// D3Q19 lattice-Boltzmann wind tunnel (BGK collision) in lattice units: cell size 1,
+// one step per tick, reference density 1, sound speed 1/sqrt(3).
+//
+// Each step is a fused pull: a fluid cell gathers the 19 populations streaming into it
+// from the source buffer, takes their moments, relaxes toward equilibrium and writes the
+// result to the destination buffer. Populations are stored SoA (one array per direction)
+// so the gathers along x read contiguous memory. Cells away from every boundary take a
+// branch-free path; the rest consult a per-cell link mask. Links into the body bounce
+// back half-way and accumulate the momentum-exchange force on it; the tunnel walls are
+// free-slip mirrors, with a velocity inlet at x min and a pressure outlet at x max.
+//
+// z planes are split across the shared thread pool once the lattice has kParallelCells
+// cells; the force is summed per plane so it does not depend on the thread count.
+
+namespace astro_lbm {
+
+struct LatticeConfig {
+    int nx = 64;
+    int ny = 32;
+    int nz = 32;
+    float cell = 0.1f;                    // world size of one lattice cell
+    Vector3 origin = {0.0f, 0.0f, 0.0f};  // world position of the lattice's min corner
+    float tau = 0.56f;                    // BGK relaxation time; viscosity (tau - 1/2) / 3
+    float inflow = 0.05f;                 // x velocity at the inflow face, lattice units
+};
+
+class D3Q19Solver {
+  public:
+    static constexpr int kQ = 19;
+    static constexpr int kParallelCells = 24 * 24 * 24;
+    static constexpr uint8_t kFluid = 0;
+    static constexpr uint8_t kBody = 1;
+    static constexpr float kMeanBlend = 1.0f / 64.0f;  // per-step weight of the running mean density
+
+    // Rest, six faces, twelve edges; kOpposite[q] reverses kC[q].
+    static constexpr int kC[kQ][3] = {
+        {0, 0, 0},  {1, 0, 0},  {-1, 0, 0}, {0, 1, 0},  {0, -1, 0}, {0, 0, 1},  {0, 0, -1},
+        {1, 1, 0},  {-1, -1, 0}, {1, -1, 0}, {-1, 1, 0}, {1, 0, 1},  {-1, 0, -1}, {1, 0, -1},
+        {-1, 0, 1}, {0, 1, 1},  {0, -1, -1}, {0, 1, -1}, {0, -1, 1}};
+    static constexpr int kOpposite[kQ] = {0, 2, 1, 4, 3, 6, 5, 8, 7, 10, 9, 12, 11, 14, 13, 16, 15, 18, 17};
+    static constexpr float kW[kQ] = {1.0f / 3.0f,  1.0f / 18.0f, 1.0f / 18.0f, 1.0f / 18.0f, 1.0f / 18.0f,
+                                     1.0f / 18.0f, 1.0f / 18.0f, 1.0f / 36.0f, 1.0f / 36.0f, 1.0f / 36.0f,
+                                     1.0f / 36.0f, 1.0f / 36.0f, 1.0f / 36.0f, 1.0f / 36.0f, 1.0f / 36.0f,
+                                     1.0f / 36.0f, 1.0f / 36.0f, 1.0f / 36.0f, 1.0f / 36.0f};
+
+    void Configure(const LatticeConfig& config) {
+        config_ = config;
+        nx_ = config.nx;
+        ny_ = config.ny;
+        nz_ = config.nz;
+        const size_t cells = static_cast<size_t>(nx_) * ny_ * nz_;
+        for (int q = 0; q < kQ; ++q) {
+            src_[q].assign(cells, 0.0f);
+            dst_[q].assign(cells, 0.0f);
+        }
+        kind_.assign(cells, kFluid);
+        rho_.assign(cells, 1.0f);
+        meanRho_.assign(cells, 1.0f);
+        ux_.assign(cells, 0.0f);
+        uy_.assign(cells, 0.0f);
+        uz_.assign(cells, 0.0f);
+        planeForce_.assign(static_cast<size_t>(nz_) * 3, 0.0);
+        force_ = {0.0f, 0.0f, 0.0f};
+        steps_ = 0;
+        for (int q = 0; q < kQ; ++q) {
+            mirror_[0][q] = Mirror(q, 0);
+            mirror_[1][q] = Mirror(q, 1);
+        }
+        BuildLinks();
+        Reset();
+    }
+
+    // Body wherever sdf(world) < 0 at a cell centre. Newly freed cells restart at rest.
+    template <typename Sdf>
+    void SetObstacle(Sdf&& sdf) {
+        for (int k = 0; k < nz_; ++k) {
+            for (int j = 0; j < ny_; ++j) {
+                for (int i = 0; i < nx_; ++i) {
+                    const size_t n = Cell(i, j, k);
+                    const uint8_t kind = sdf(CellCenter(i, j, k)) < 0.0f ? kBody : kFluid;
+                    if (kind == kFluid && kind_[n] == kBody) SetEquilibrium(n, 1.0f, 0.0f, 0.0f, 0.0f);
+                    kind_[n] = kind;
+                    if (kind == kBody) {
+                        rho_[n] = 1.0f;
+                        ux_[n] = uy_[n] = uz_[n] = 0.0f;
+                    }
+                }
+            }
+        }
+        BuildLinks();
+    }
+
+    // Refills every fluid cell with the inflow equilibrium.
+    void Reset() {
+        for (size_t n = 0; n < kind_.size(); ++n) {
+            const float u = kind_[n] == kFluid ? config_.inflow : 0.0f;
+            SetEquilibrium(n, 1.0f, u, 0.0f, 0.0f);
+            rho_[n] = 1.0f;
+            meanRho_[n] = 1.0f;
+            ux_[n] = u;
+            uy_[n] = uz_[n] = 0.0f;
+        }
+    }
+
+    void SetInflow(float inflow) { config_.inflow = inflow; }
+
+    void Step(int steps) {
+        Equilibrium(1.0f, config_.inflow, 0.0f, 0.0f, inflowEq_);
+        for (int s = 0; s < steps; ++s) {
+            const auto planes = [this](int k0, int k1) {
+                for (int k = k0; k < k1; ++k) StreamCollidePlane(k);
+            };
+            if (kind_.size() >= static_cast<size_t>(kParallelCells)) {
+                astro_parallel::SharedPool().ParallelFor(nz_, 1, planes);
+            } else {
+                planes(0, nz_);
+            }
+            for (int q = 0; q < kQ; ++q) src_[q].swap(dst_[q]);
+            double fx = 0.0, fy = 0.0, fz = 0.0;
+            for (int k = 0; k < nz_; ++k) {
+                fx += planeForce_[3 * k];
+                fy += planeForce_[3 * k + 1];
+                fz += planeForce_[3 * k + 2];
+            }
+            force_ = {static_cast<float>(fx), static_cast<float>(fy), static_cast<float>(fz)};
+            ++steps_;
+        }
+    }
+
+    // Macroscopic fields at the nearest cell; zero velocity inside the body.
+    Vector3 Velocity(Vector3 world) const {
+        const size_t n = NearestCell(world);
+        return {ux_[n], uy_[n], uz_[n]};
+    }
+
+    float Density(Vector3 world) const { return rho_[NearestCell(world)]; }
+
+    // Density averaged over the last ~1/kMeanBlend steps, which filters out the sound
+    // waves a compressible scheme carries and leaves the hydrodynamic pressure.
+    float MeanDensity(Vector3 world) const { return meanRho_[NearestCell(world)]; }
+
+    bool Contains(Vector3 world) const {
+        const float inv = 1.0f / config_.cell;
+        const float x = (world.x - config_.origin.x) * inv;
+        const float y = (world.y - config_.origin.y) * inv;
+        const float z = (world.z - config_.origin.z) * inv;
+        return x >= 0.0f && y >= 0.0f && z >= 0.0f && x <= nx_ && y <= ny_ && z <= nz_;
+    }
+
+    // Momentum-exchange force on the body from the last step, lattice units.
+    Vector3 BodyForce() const { return force_; }
+    float Viscosity() const { return (config_.tau - 0.5f) / 3.0f; }
+    float inflow() const { return config_.inflow; }
+    long long steps() const { return steps_; }
+    int nx() const { return nx_; }
+    int ny() const { return ny_; }
+    int nz() const { return nz_; }
+    size_t cells() const { return kind_.size(); }
+
+    Vector3 CellCenter(int i, int j, int k) const {
+        const float h = config_.cell;
+        return {config_.origin.x + (i + 0.5f) * h, config_.origin.y + (j + 0.5f) * h, config_.origin.z + (k + 0.5f) * h};
+    }
+
+  private:
+    size_t Cell(int i, int j, int k) const { return (static_cast<size_t>(k) * ny_ + j) * nx_ + i; }
+
+    size_t NearestCell(Vector3 world) const {
+        const float inv = 1.0f / config_.cell;
+        const int i = std::clamp(static_cast<int>((world.x - config_.origin.x) * inv), 0, nx_ - 1);
+        const int j = std::clamp(static_cast<int>((world.y - config_.origin.y) * inv), 0, ny_ - 1);
+        const int k = std::clamp(static_cast<int>((world.z - config_.origin.z) * inv), 0, nz_ - 1);
+        return Cell(i, j, k);
+    }
+
+    // Second-order equilibrium. Opposite directions share c.u squared, so they are
+    // written in pairs with +-3 c.u.
+    static void Equilibrium(float rho, float ux, float uy, float uz, float* feq) {
+        const float base = 1.0f - 1.5f * (ux * ux + uy * uy + uz * uz);
+        const auto pair = [&](int plus, int minus, float weight, float cu) {
+            const float even = weight * rho * (base + 4.5f * cu * cu);
+            const float odd = weight * rho * 3.0f * cu;
+            feq[plus] = even + odd;
+            feq[minus] = even - odd;
+        };
+        feq[0] = kW[0] * rho * base;
+        pair(1, 2, kW[1], ux);
+        pair(3, 4, kW[3], uy);
+        pair(5, 6, kW[5], uz);
+        pair(7, 8, kW[7], ux + uy);
+        pair(9, 10, kW[9], ux - uy);
+        pair(11, 12, kW[11], ux + uz);
+        pair(13, 14, kW[13], ux - uz);
+        pair(15, 16, kW[15], uy + uz);
+        pair(17, 18, kW[17], uy - uz);
+    }
+
+    void SetEquilibrium(size_t n, float rho, float ux, float uy, float uz) {
+        float feq[kQ];
+        Equilibrium(rho, ux, uy, uz, feq);
+        for (int q = 0; q < kQ; ++q) src_[q][n] = feq[q];
+    }
+
+    // Moments, BGK relaxation and store for one cell whose incoming populations are in f.
+    void Collide(size_t n, float* f) {
+        float rho = 0.0f;
+        for (int q = 0; q < kQ; ++q) rho += f[q];
+        const float mx = f[1] - f[2] + f[7] - f[8] + f[9] - f[10] + f[11] - f[12] + f[13] - f[14];
+        const float my = f[3] - f[4] + f[7] - f[8] - f[9] + f[10] + f[15] - f[16] + f[17] - f[18];
+        const float mz = f[5] - f[6] + f[11] - f[12] - f[13] + f[14] + f[15] - f[16] - f[17] + f[18];
+        const float inv = 1.0f / rho;
+        const float ux = mx * inv, uy = my * inv, uz = mz * inv;
+        rho_[n] = rho;
+        meanRho_[n] += kMeanBlend * (rho - meanRho_[n]);
+        ux_[n] = ux;
+        uy_[n] = uy;
+        uz_[n] = uz;
+        float feq[kQ];
+        Equilibrium(rho, ux, uy, uz, feq);
+        const float omega = 1.0f / config_.tau;
+        for (int q = 0; q < kQ; ++q) dst_[q][n] = f[q] + omega * (feq[q] - f[q]);
+    }
+
+    // Bit q marks a cell whose q-population does not simply stream from a fluid
+    // neighbour, so the pull can skip every boundary test elsewhere.
+    void BuildLinks() {
+        links_.assign(kind_.size(), 0);
+        for (int k = 0; k < nz_; ++k) {
+            for (int j = 0; j < ny_; ++j) {
+                for (int i = 0; i < nx_; ++i) {
+                    uint32_t mask = 0;
+                    for (int q = 1; q < kQ; ++q) {
+                        const int si = i - kC[q][0], sj = j - kC[q][1], sk = k - kC[q][2];
+                        const bool inside = si >= 0 && si < nx_ && sj >= 0 && sj < ny_ && sk >= 0 && sk < nz_;
+                        if (!inside || kind_[Cell(si, sj, sk)] != kFluid) mask |= 1u << q;
+                    }
+                    links_[Cell(i, j, k)] = mask;
+                }
+            }
+        }
+    }
+
+    // Direction q with its y (axis 0) or z (axis 1) component reversed.
+    static int Mirror(int q, int axis) {
+        const int c[3] = {kC[q][0], axis == 0 ? -kC[q][1] : kC[q][1], axis == 1 ? -kC[q][2] : kC[q][2]};
+        for (int r = 0; r < kQ; ++r) {
+            if (kC[r][0] == c[0] && kC[r][1] == c[1] && kC[r][2] == c[2]) return r;
+        }
+        return q;
+    }
+
+    // Incoming population q at cell (i, j, k) across a boundary link. The y and z walls
+    // reflect specularly (free slip), the x min face is a velocity inlet at the cell's
+    // density, the x max face a pressure outlet at density 1, and body cells bounce back.
+    float BoundaryPopulation(int q, int i, int j, int k, size_t n, double* force) const {
+        int si = i - kC[q][0], sj = j - kC[q][1], sk = k - kC[q][2];
+        int source = q;
+        if (sj < 0 || sj >= ny_) {
+            sj = j;
+            source = mirror_[0][source];
+        }
+        if (sk < 0 || sk >= nz_) {
+            sk = k;
+            source = mirror_[1][source];
+        }
+        if (si < 0) return rho_[n] * inflowEq_[q];
+        if (si >= nx_) {
+            float feq[kQ];
+            Equilibrium(1.0f, ux_[n], uy_[n], uz_[n], feq);
+            return feq[q];
+        }
+        const size_t m = Cell(si, sj, sk);
+        if (kind_[m] == kFluid) return src_[source][m];
+        // Half-way bounce-back: the population that left toward the body returns
+        // reversed and hands the body twice its momentum.
+        const int opp = kOpposite[q];
+        const float out = src_[opp][n];
+        force[0] += 2.0 * kC[opp][0] * out;
+        force[1] += 2.0 * kC[opp][1] * out;
+        force[2] += 2.0 * kC[opp][2] * out;
+        return out;
+    }
+
+    void StreamCollidePlane(int k) {
+        const ptrdiff_t strideY = nx_;
+        const ptrdiff_t strideZ = strideY * ny_;
+        ptrdiff_t offset[kQ];
+        for (int q = 0; q < kQ; ++q) offset[q] = -(kC[q][0] + kC[q][1] * strideY + kC[q][2] * strideZ);
+        double force[3] = {0.0, 0.0, 0.0};
+        float f[kQ];
+        for (int j = 0; j < ny_; ++j) {
+            for (int i = 0; i < nx_; ++i) {
+                const size_t n = Cell(i, j, k);
+                if (kind_[n] != kFluid) continue;
+                const uint32_t mask = links_[n];
+                if (mask == 0) {
+                    for (int q = 0; q < kQ; ++q) f[q] = src_[q][static_cast<size_t>(static_cast<ptrdiff_t>(n) + offset[q])];
+                } else {
+                    for (int q = 0; q < kQ; ++q) {
+                        f[q] = mask & (1u << q) ? BoundaryPopulation(q, i, j, k, n, force)
+                                                : src_[q][static_cast<size_t>(static_cast<ptrdiff_t>(n) + offset[q])];
+                    }
+                }
+                Collide(n, f);
+            }
+        }
+        planeForce_[3 * static_cast<size_t>(k)] = force[0];
+        planeForce_[3 * static_cast<size_t>(k) + 1] = force[1];
+        planeForce_[3 * static_cast<size_t>(k) + 2] = force[2];
+    }
+
+    LatticeConfig config_;
+    int nx_ = 0;
+    int ny_ = 0;
+    int nz_ = 0;
+    long long steps_ = 0;
+    std::vector<float> src_[kQ];
+    std::vector<float> dst_[kQ];
+    std::vector<uint8_t> kind_;
+    std::vector<uint32_t> links_;
+    int mirror_[2][kQ] = {};
+    std::vector<float> rho_, meanRho_, ux_, uy_, uz_;
+    std::vector<double> planeForce_;
+    float inflowEq_[kQ] = {};
+    Vector3 force_ = {0.0f, 0.0f, 0.0f};
+};
+
+}  // namespace astro_lbm
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+// Level-of-detail replacements for DrawSphere and DrawCylinderEx.
+//
+// The tessellation is picked from the object's projected radius in pixels under the
+// current rlgl modelview and projection, so any camera set by BeginMode3D and any
+// rlPushMatrix transform are honoured without passing the camera around. Unit-sphere
+// triangle lists and ring tables are built once per level and emitted into the rlgl batch
+// like the raylib helpers. Spheres smaller than a few pixels fall back to camera-facing
+// discs: raylib's spheres are unlit, so a flat disc of the same radius looks the same
+// there. The largest level matches raylib's DrawSphere (16 rings, 16 slices).
+
+namespace astro_render {
+
+struct SphereLod {
+    int rings;
+    int slices;
+    float minPixels;  // projected radius at which this level starts
+};
+
+// Coarsest first; below the last entry's minPixels the sphere is drawn as a disc.
+constexpr std::array<SphereLod, 4> kSphereLods = {{{3, 6, 3.0f}, {6, 8, 6.0f}, {10, 12, 16.0f}, {16, 16, 48.0f}}};
+constexpr float kDiscMinPixels = 1.2f;  // below this a disc degrades to a quad
+constexpr float kLineMaxPixels = 0.75f;  // cylinders thinner than this draw as a line
+constexpr int kMaxLodSides = 64;
+
+// Projected radius in framebuffer pixels of a sphere at `center` (in the current
+// modelview space) with the given radius.
+inline float ProjectedRadiusPixels(Vector3 center, float radius) {
+    const Matrix view = rlGetMatrixModelview();
+    const Matrix proj = rlGetMatrixProjection();
+    const float scale = std::sqrt(view.m0 * view.m0 + view.m1 * view.m1 + view.m2 * view.m2);
+    const float halfHeight = 0.5f * static_cast<float>(std::max(1, rlGetFramebufferHeight()));
+    const float worldRadius = radius * scale;
+    if (proj.m15 != 0.0f) return worldRadius * std::fabs(proj.m5) * halfHeight;  // orthographic
+    const float depth = -(view.m2 * center.x + view.m6 * center.y + view.m10 * center.z + view.m14);
+    if (depth <= worldRadius) return 1.0e6f;  // camera inside or at the sphere
+    return worldRadius * proj.m5 * halfHeight / depth;
+}
+
+// Triangle list of a unit sphere, same layout and winding as raylib's DrawSphereEx.
+inline const std::vector<Vector3>& UnitSphereTriangles(int level) {
+    static std::array<std::vector<Vector3>, kSphereLods.size()> cache;
+    std::vector<Vector3>& tris = cache[static_cast<size_t>(level)];
+    if (!tris.empty()) return tris;
+
+    const int rings = kSphereLods[static_cast<size_t>(level)].rings;
+    const int slices = kSphereLods[static_cast<size_t>(level)].slices;
+    const float ringAngle = DEG2RAD * (180.0f / static_cast<float>(rings + 1));
+    const float sliceAngle = DEG2RAD * (360.0f / static_cast<float>(slices));
+    const float cosRing = std::cos(ringAngle), sinRing = std::sin(ringAngle);
+    const float cosSlice = std::cos(sliceAngle), sinSlice = std::sin(sliceAngle);
+    tris.reserve(static_cast<size_t>((rings + 1) * slices * 6));
+
+    Vector3 v[4] = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {sinRing, cosRing, 0.0f}};
+    for (int i = 0; i < rings + 1; ++i) {
+        for (int j = 0; j < slices; ++j) {
+            v[0] = v[2];
+            v[1] = v[3];
+            v[2] = {cosSlice * v[2].x - sinSlice * v[2].z, v[2].y, sinSlice * v[2].x + cosSlice * v[2].z};
+            v[3] = {cosSlice * v[3].x - sinSlice * v[3].z, v[3].y, sinSlice * v[3].x + cosSlice * v[3].z};
+            tris.insert(tris.end(), {v[0], v[3], v[1], v[0], v[2], v[3]});
+        }
+        v[2] = v[3];
+        v[3] = {cosRing * v[3].x + sinRing * v[3].y, -sinRing * v[3].x + cosRing * v[3].y, v[3].z};
+    }
+    return tris;
+}
+
+// sin/cos of 2*pi*i/sides for i in [0, sides], cached per side count.
+inline const std::vector<Vector2>& RingTable(int sides) {
+    static std::array<std::vector<Vector2>, kMaxLodSides + 1> cache;
+    std::vector<Vector2>& ring = cache[static_cast<size_t>(sides)];
+    if (!ring.empty()) return ring;
+    ring.resize(static_cast<size_t>(sides + 1));
+    for (int i = 0; i <= sides; ++i) {
+        const float a = 2.0f * PI * static_cast<float>(i) / static_cast<float>(sides);
+        ring[static_cast<size_t>(i)] = {std::sin(a), std::cos(a)};
+    }
+    return ring;
+}
+
+// Camera-facing disc (or, below kDiscMinPixels, a quad) of the sphere's radius.
+inline void DrawSphereDisc(Vector3 center, float radius, float pixels, Color color) {
+    const Matrix view = rlGetMatrixModelview();
+    const Vector3 right = Vector3Scale(Vector3Normalize({view.m0, view.m4, view.m8}), radius);
+    const Vector3 up = Vector3Scale(Vector3Normalize({view.m1, view.m5, view.m9}), radius);
+    const int segments = pixels < kDiscMinPixels ? 4 : 6;
+    const std::vector<Vector2>& ring = RingTable(segments);
+    rlCheckRenderBatchLimit(3 * segments);
+    rlBegin(RL_TRIANGLES);
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    for (int i = 0; i < segments; ++i) {
+        const Vector2 a = ring[static_cast<size_t>(i)];
+        const Vector2 b = ring[static_cast<size_t>(i + 1)];
+        rlVertex3f(center.x, center.y, center.z);
+        rlVertex3f(center.x + a.y * right.x + a.x * up.x, center.y + a.y * right.y + a.x * up.y, center.z + a.y * right.z + a.x * up.z);
+        rlVertex3f(center.x + b.y * right.x + b.x * up.x, center.y + b.y * right.y + b.x * up.y, center.z + b.y * right.z + b.x * up.z);
+    }
+    rlEnd();
+}
+
+// Drop-in for DrawSphere(center, radius, color).
+inline void DrawSphereLod(Vector3 center, float radius, Color color) {
+    const float pixels = ProjectedRadiusPixels(center, radius);
+    int level = -1;
+    for (int i = 0; i < static_cast<int>(kSphereLods.size()); ++i) {
+        if (pixels >= kSphereLods[static_cast<size_t>(i)].minPixels) level = i;
+    }
+    if (level < 0) {
+        DrawSphereDisc(center, radius, pixels, color);
+        return;
+    }
+
+    const std::vector<Vector3>& tris = UnitSphereTriangles(level);
+    rlCheckRenderBatchLimit(static_cast<int>(tris.size()));
+    rlBegin(RL_TRIANGLES);
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    for (const Vector3& v : tris) rlVertex3f(center.x + radius * v.x, center.y + radius * v.y, center.z + radius * v.z);
+    rlEnd();
+}
+
+// Side count for a cylinder or cone from its projected radius, capped at maxSides; 0 means
+// it is thinner than a pixel and should be drawn as a line.
+inline int CylinderSidesLod(Vector3 start, Vector3 end, float startRadius, float endRadius, int maxSides) {
+    const float pixels = ProjectedRadiusPixels(Vector3Lerp(start, end, 0.5f), std::max(startRadius, endRadius));
+    if (pixels < kLineMaxPixels) return 0;
+    const int sides = pixels < 3.0f ? 4 : pixels < 8.0f ? 6 : pixels < 20.0f ? 10 : maxSides;
+    return std::clamp(std::min(sides, maxSides), 3, kMaxLodSides);
+}
+
+// Drop-in for DrawCylinderEx(start, end, startRadius, endRadius, maxSides, color), with the
+// same faces and caps.
+inline void DrawCylinderLod(Vector3 start, Vector3 end, float startRadius, float endRadius, int maxSides, Color color) {
+    const Vector3 direction = Vector3Subtract(end, start);
+    if (direction.x == 0.0f && direction.y == 0.0f && direction.z == 0.0f) return;
+    const int sides = CylinderSidesLod(start, end, startRadius, endRadius, maxSides);
+    if (sides == 0) {
+        DrawLine3D(start, end, color);
+        return;
+    }
+
+    const Vector3 b1 = Vector3Normalize(Vector3Perpendicular(direction));
+    const Vector3 b2 = Vector3Normalize(Vector3CrossProduct(b1, direction));
+    const std::vector<Vector2>& ring = RingTable(sides);
+    const auto at = [&](Vector3 base, float radius, Vector2 sc) {
+        return Vector3{base.x + radius * (sc.x * b1.x + sc.y * b2.x), base.y + radius * (sc.x * b1.y + sc.y * b2.y),
+                       base.z + radius * (sc.x * b1.z + sc.y * b2.z)};
+    };
+
+    rlCheckRenderBatchLimit(12 * sides);
+    rlBegin(RL_TRIANGLES);
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    for (int i = 0; i < sides; ++i) {
+        const Vector2 s0 = ring[static_cast<size_t>(i)];
+        const Vector2 s1 = ring[static_cast<size_t>(i + 1)];
+        const Vector3 w1 = at(start, startRadius, s0);
+        const Vector3 w2 = at(start, startRadius, s1);
+        const Vector3 w3 = at(end, endRadius, s0);
+        const Vector3 w4 = at(end, endRadius, s1);
+        if (startRadius > 0.0f) {
+            rlVertex3f(start.x, start.y, start.z);
+            rlVertex3f(w2.x, w2.y, w2.z);
+            rlVertex3f(w1.x, w1.y, w1.z);
+        }
+        rlVertex3f(w1.x, w1.y, w1.z);
+        rlVertex3f(w2.x, w2.y, w2.z);
+        rlVertex3f(w3.x, w3.y, w3.z);
+        rlVertex3f(w2.x, w2.y, w2.z);
+        rlVertex3f(w4.x, w4.y, w4.z);
+        rlVertex3f(w3.x, w3.y, w3.z);
+        if (endRadius > 0.0f) {
+            rlVertex3f(end.x, end.y, end.z);
+            rlVertex3f(w3.x, w3.y, w3.z);
+            rlVertex3f(w4.x, w4.y, w4.z);
+        }
+    }
+    rlEnd();
+}
+
+}  // namespace astro_render
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Binary-lens microlensing magnification maps by inverse ray shooting.
+//
+// Lengths are in Einstein radii of the total lens mass. The lenses, with mass ratio
+// q = m2 / m1, sit on the x axis with the centre of mass at the origin; s is their
+// separation. Rays on a regular image-plane grid are sent through the lens equation
+//
+//   beta = theta - sum_i m_i (theta - z_i) / |theta - z_i|^2
+//
+// and deposited, with bilinear weights, on the source-plane pixels around where they
+// land. A pixel's magnification is its total weight divided by the rays an unlensed
+// pixel would receive. Rows of rays are split across the pool; each task accumulates
+// into its own float tile and the tiles are summed afterwards, so no counter is shared.
+// Once a map exists, a light curve for any straight source track is a bilinear lookup
+// per sample, and many tracks can be evaluated at once.
+
+namespace astro_lensing {
+
+struct BinaryLens {
+    float q = 0.1f;  // m2 / m1, <= 1
+    float s = 1.0f;  // separation
+};
+
+struct MapOptions {
+    int resolution = 384;       // source-plane pixels per side
+    float halfWidth = 2.0f;     // source-plane half extent
+    int raysPerPixelSide = 8;   // rays per unlensed pixel = this squared
+};
+
+// Straight source track: position (tau cos a - u0 sin a, tau sin a + u0 cos a) with
+// tau = (t - t0) / tE.
+struct SourceTrack {
+    float u0 = 0.3f;
+    float alpha = 0.0f;
+    float t0 = 0.0f;
+    float tE = 1.0f;
+};
+
+inline float PointLensMagnification(float u) {
+    u = std::max(u, 1.0e-4f);
+    return (u * u + 2.0f) / (u * std::sqrt(u * u + 4.0f));
+}
+
+// Lens positions for a binary: m1 = 1 / (1 + q) on the left, m2 on the right.
+inline void LensPositions(const BinaryLens& lens, float* x1, float* x2) {
+    *x1 = -lens.s * lens.q / (1.0f + lens.q);
+    *x2 = lens.s / (1.0f + lens.q);
+}
+
+class MagnificationMap {
+  public:
+    const BinaryLens& lens() const { return lens_; }
+    int resolution() const { return resolution_; }
+    float halfWidth() const { return halfWidth_; }
+    float maximum() const { return maximum_; }
+    const std::vector<float>& pixels() const { return pixels_; }  // row 0 = most negative y
+
+    // Bilinear magnification at source position (x, y); outside the map the binary is
+    // treated as a point lens of the total mass.
+    float At(float x, float y) const {
+        const float scale = resolution_ / (2.0f * halfWidth_);
+        const float fx = (x + halfWidth_) * scale - 0.5f;
+        const float fy = (y + halfWidth_) * scale - 0.5f;
+        if (!(fx >= 0.0f && fy >= 0.0f && fx < resolution_ - 1 && fy < resolution_ - 1)) {
+            return std::max(1.0f, PointLensMagnification(std::sqrt(x * x + y * y)));
+        }
+        const int ix = static_cast<int>(fx), iy = static_cast<int>(fy);
+        const float tx = fx - ix, ty = fy - iy;
+        const float* row = pixels_.data() + static_cast<size_t>(iy) * resolution_ + ix;
+        const float top = row[0] + (row[1] - row[0]) * tx;
+        const float bottom = row[resolution_] + (row[resolution_ + 1] - row[resolution_]) * tx;
+        return top + (bottom - top) * ty;
+    }
+
+    // out[track * samples + i] = magnification of `tracks[track]` at times[i].
+    void LightCurves(const SourceTrack* tracks, int trackCount, const float* times, int samples, float* out) const {
+        for (int k = 0; k < trackCount; ++k) {
+            const SourceTrack& track = tracks[k];
+            const float c = std::cos(track.alpha), s = std::sin(track.alpha);
+            const float invTe = 1.0f / std::max(track.tE, 1.0e-6f);
+            float* curve = out + static_cast<size_t>(k) * samples;
+            for (int i = 0; i < samples; ++i) {
+                const float tau = (times[i] - track.t0) * invTe;
+                curve[i] = At(tau * c - track.u0 * s, tau * s + track.u0 * c);
+            }
+        }
+    }
+
+    void Build(const BinaryLens& lens, const MapOptions& options, astro_parallel::ThreadPool& pool) {
+        lens_ = lens;
+        resolution_ = std::max(2, options.resolution);
+        halfWidth_ = options.halfWidth;
+        const int n = resolution_;
+        const float pixel = 2.0f * halfWidth_ / n;
+        const float spacing = pixel / std::max(1, options.raysPerPixelSide);
+        // Every image of a source inside the map lies within about one Einstein radius of
+        // it, or of a lens.
+        const float reach = halfWidth_ + 1.0f + 0.5f * lens.s;
+        const int rays = static_cast<int>(std::ceil(2.0f * reach / spacing));
+        const float weight = 1.0f / (static_cast<float>(options.raysPerPixelSide) * options.raysPerPixelSide);
+
+        float x1, x2;
+        LensPositions(lens, &x1, &x2);
+        const float m1 = 1.0f / (1.0f + lens.q), m2 = lens.q / (1.0f + lens.q);
+        const float toPixel = 1.0f / pixel;
+
+        const int tasks = std::max(1, std::min(pool.size(), (rays + kRowsPerChunk - 1) / kRowsPerChunk));
+        tiles_.resize(static_cast<size_t>(tasks));
+        for (std::vector<float>& tile : tiles_) tile.assign(static_cast<size_t>(n) * n, 0.0f);
+        std::atomic<int> nextRow{0};
+        pool.Run(tasks, [&](int task) {
+            float* tile = tiles_[static_cast<size_t>(task)].data();
+            std::vector<float> bx(static_cast<size_t>(rays)), by(static_cast<size_t>(rays));
+            for (int row0 = nextRow.fetch_add(kRowsPerChunk); row0 < rays; row0 = nextRow.fetch_add(kRowsPerChunk)) {
+                for (int r = row0; r < std::min(rays, row0 + kRowsPerChunk); ++r) {
+                    const float ty = -reach + (r + 0.5f) * spacing;
+                    const float ty2 = ty * ty;
+                    for (int c = 0; c < rays; ++c) {
+                        const float tx = -reach + (c + 0.5f) * spacing;
+                        const float d1 = tx - x1, d2 = tx - x2;
+                        const float k1 = m1 / (d1 * d1 + ty2 + 1.0e-12f);
+                        const float k2 = m2 / (d2 * d2 + ty2 + 1.0e-12f);
+                        bx[static_cast<size_t>(c)] = (tx - k1 * d1 - k2 * d2 + halfWidth_) * toPixel;
+                        by[static_cast<size_t>(c)] = (ty - (k1 + k2) * ty + halfWidth_) * toPixel;
+                    }
+                    // Cloud-in-cell deposit onto the four nearest pixel centres: counting rays in
+                    // the pixel they hit beats the ray lattice against the pixel grid.
+                    for (int c = 0; c < rays; ++c) {
+                        const float px = bx[static_cast<size_t>(c)] - 0.5f, py = by[static_cast<size_t>(c)] - 0.5f;
+                        if (!(px >= 0.0f && py >= 0.0f && px < n - 1 && py < n - 1)) continue;
+                        const int ix = static_cast<int>(px), iy = static_cast<int>(py);
+                        const float fx = px - ix, fy = py - iy;
+                        float* cell = tile + static_cast<size_t>(iy) * n + ix;
+                        cell[0] += weight * (1.0f - fx) * (1.0f - fy);
+                        cell[1] += weight * fx * (1.0f - fy);
+                        cell[n] += weight * (1.0f - fx) * fy;
+                        cell[n + 1] += weight * fx * fy;
+                    }
+                }
+            }
+        });
+
+        pixels_.assign(static_cast<size_t>(n) * n, 0.0f);
+        pool.ParallelFor(n, 16, [&](int begin, int end) {
+            for (const std::vector<float>& tile : tiles_) {
+                for (size_t i = static_cast<size_t>(begin) * n; i < static_cast<size_t>(end) * n; ++i) pixels_[i] += tile[i];
+            }
+        });
+        maximum_ = *std::max_element(pixels_.begin(), pixels_.end());
+        tiles_.clear();
+        tiles_.shrink_to_fit();
+    }
+
+  private:
+    static constexpr int kRowsPerChunk = 16;
+
+    BinaryLens lens_;
+    int resolution_ = 0;
+    float halfWidth_ = 1.0f;
+    float maximum_ = 1.0f;
+    std::vector<float> pixels_;
+    std::vector<std::vector<float>> tiles_;
+};
+
+// Maps keyed by (q, s) rounded to a grid fine enough that neighbouring keys look alike
+// (log10 q in steps of 0.02, s in steps of 0.01). Get() returns a cached map or queues
+// its build on a worker thread with a private pool; only the newest request is kept, so
+// sweeping a slider does not stack up builds. The least recently used map is evicted.
+// All public calls belong to one thread.
+class MagnificationMapCache {
+  public:
+    explicit MagnificationMapCache(const MapOptions& options = MapOptions{}, size_t capacity = 12)
+        : options_(options), capacity_(std::max<size_t>(1, capacity)) {}
+    ~MagnificationMapCache() { Stop(); }
+
+    MagnificationMapCache(const MagnificationMapCache&) = delete;
+    MagnificationMapCache& operator=(const MagnificationMapCache&) = delete;
+
+    static BinaryLens Quantize(float q, float s) {
+        BinaryLens lens;
+        lens.q = std::pow(10.0f, std::round(std::log10(std::clamp(q, 1.0e-4f, 1.0f)) / 0.02f) * 0.02f);
+        lens.s = std::max(0.05f, std::round(s / 0.01f) * 0.01f);
+        return lens;
+    }
+
+    std::shared_ptr<const MagnificationMap> Get(float q, float s) {
+        const BinaryLens key = Quantize(q, s);
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++clock_;
+        for (Entry& e : entries_) {
+            if (Same(e.map->lens(), key)) {
+                e.lastUse = clock_;
+                return e.map;
+            }
+        }
+        if (!(building_ && Same(buildingLens_, key))) {
+            pendingLens_ = key;
+            pending_ = true;
+            if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+            wake_.notify_one();
+        }
+        return nullptr;
+    }
+
+    bool busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return building_ || pending_;
+    }
+    int threads() const { return threads_; }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    struct Entry {
+        std::shared_ptr<const MagnificationMap> map;
+        uint64_t lastUse = 0;
+    };
+
+    static bool Same(const BinaryLens& a, const BinaryLens& b) { return a.q == b.q && a.s == b.s; }
+
+    void WorkerLoop() {
+        astro_parallel::ThreadPool pool(threads_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            buildingLens_ = pendingLens_;
+            pending_ = false;
+            building_ = true;
+            lock.unlock();
+
+            auto map = std::make_shared<MagnificationMap>();
+            map->Build(buildingLens_, options_, pool);
+
+            lock.lock();
+            building_ = false;
+            if (entries_.size() == capacity_) {
+                entries_.erase(std::min_element(entries_.begin(), entries_.end(),
+                                                [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; }));
+            }
+            entries_.push_back(Entry{std::move(map), clock_});
+        }
+    }
+
+    const MapOptions options_;
+    const size_t capacity_;
+    const int threads_ = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<Entry> entries_;
+    uint64_t clock_ = 0;
+    BinaryLens pendingLens_;
+    BinaryLens buildingLens_;
+    bool pending_ = false;
+    bool building_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_lensing
@@ -0,0 +1,532 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "cli_args.h"
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Offline still renderer for the immediate-mode demos. A demo rebuilds the frame it
+// would draw as a TraceScene -- bodies as opaque spheres, particles, streaks and glows
+// as emissive Gaussian volumes -- and RenderStill() path-traces it on the CPU into a
+// PNG (tonemapped) or EXR (linear float) image, without opening a window.
+//
+//   demo --render[=out.png|out.exr] [--width=3840] [--height=2160] [--spp=64]
+//        [--time=T] [--preset=N] [--exposure=X]
+//
+// Volumes only emit, so their contribution along a ray is the closed-form line integral
+// of the Gaussian up to the first opaque hit; one BVH per primitive kind keeps the
+// thousands of particles in a frame cheap to query. Opaque hits scatter diffusely for a
+// couple of bounces, so the disk and jets light the bodies. Samples accumulate pass by
+// pass (one jittered sample per pixel per pass) and the file is rewritten after passes
+// 1, 2, 4, 8, ... so an interrupted render still leaves its best image so far.
+
+namespace astro_render {
+
+struct TraceSphere {
+    Vector3 center;
+    float radius;
+    Vector3 albedo;    // linear RGB
+    Vector3 emission;  // linear RGB radiance
+};
+
+// Emits emission * exp(-|x - center|^2 / sigma^2) per unit length.
+struct TraceVolume {
+    Vector3 center;
+    float sigma;
+    Vector3 emission;
+};
+
+// sRGB 8-bit colour (alpha as coverage) to linear RGB times `intensity`.
+inline Vector3 LinearRgb(Color c, float intensity = 1.0f) {
+    auto decode = [](unsigned char v) {
+        const float x = v / 255.0f;
+        return x <= 0.04045f ? x / 12.92f : std::pow((x + 0.055f) / 1.055f, 2.4f);
+    };
+    const float scale = intensity * c.a / 255.0f;
+    return {decode(c.r) * scale, decode(c.g) * scale, decode(c.b) * scale};
+}
+
+struct StillOptions {
+    bool enabled = false;
+    std::string path;
+    int width = 3840;
+    int height = 2160;
+    int samples = 64;
+    int preset = 0;
+    float time = 6.0f;
+    float exposure = 1.0f;
+};
+
+// `--render` alone writes `<defaultStem>.png`.
+inline StillOptions ParseStillArgs(int argc, char** argv, const char* defaultStem) {
+    StillOptions options;
+    const char* path = astro_bench::FindArg(argc, argv, "--render");
+    options.enabled = path != nullptr || astro_bench::HasFlag(argc, argv, "--render");
+    options.path = path != nullptr ? path : std::string(defaultStem) + ".png";
+    options.width = std::max(16, astro_bench::IntArg(argc, argv, "--width", options.width));
+    options.height = std::max(16, astro_bench::IntArg(argc, argv, "--height", options.height));
+    options.samples = std::max(1, astro_bench::IntArg(argc, argv, "--spp", options.samples));
+    options.preset = astro_bench::IntArg(argc, argv, "--preset", options.preset);
+    options.time = std::max(0.0f, astro_bench::FloatArg(argc, argv, "--time", options.time));
+    options.exposure = astro_bench::FloatArg(argc, argv, "--exposure", options.exposure);
+    return options;
+}
+
+class TraceScene {
+  public:
+    Vector3 background{0.0f, 0.0f, 0.0f};
+
+    void AddBody(Vector3 center, float radius, Color albedo, Vector3 emission = {0.0f, 0.0f, 0.0f}) {
+        spheres_.push_back({center, radius, LinearRgb(albedo), emission});
+    }
+
+    // Stand-in for DrawSphere(center, radius, Fade(color, opacity)) blended over the
+    // scene: a Gaussian of the same radius whose line integral through the centre is
+    // the sprite's colour times its opacity, scaled by `intensity`.
+    void AddGlow(Vector3 center, float radius, Color color, float intensity = 1.0f) {
+        if (radius <= 0.0f || color.a == 0) return;
+        const float sigma = radius;
+        volumes_.push_back({center, sigma, Vector3Scale(LinearRgb(color, intensity), 1.0f / (sigma * kSqrtPi))});
+    }
+
+    // A line (DrawLine3D) as a row of glows at most `radius` apart. Neighbours overlap,
+    // so each bead is scaled by spacing / (radius sqrt(pi)) to keep a ray crossing the
+    // streak at the brightness of one glow.
+    void AddStreak(Vector3 from, Vector3 to, float radius, Color color, float intensity = 1.0f) {
+        AddTaperedStreak(from, to, radius, radius, color, intensity);
+    }
+
+    // The same with the radius running from `fromRadius` to `toRadius`, for cones and
+    // cylinders (DrawCylinderEx).
+    void AddTaperedStreak(Vector3 from, Vector3 to, float fromRadius, float toRadius, Color color, float intensity = 1.0f) {
+        const float length = Vector3Distance(from, to);
+        const float minRadius = std::max(1.0e-4f, std::min(fromRadius, toRadius));
+        const int beads = std::clamp(static_cast<int>(std::ceil(length / minRadius)) + 1, 2, 256);
+        const float spacing = length / static_cast<float>(beads - 1);
+        for (int i = 0; i < beads; ++i) {
+            const float t = static_cast<float>(i) / static_cast<float>(beads - 1);
+            const float radius = fromRadius + (toRadius - fromRadius) * t;
+            AddGlow(Vector3Lerp(from, to, t), radius, color, intensity * std::min(1.0f, spacing / (radius * kSqrtPi)));
+        }
+    }
+
+    // A filled quad (two DrawTriangle3D) of `area` as one glow at its centre. The glow's
+    // total emission is spread over the quad, so a mesh of patches keeps the colour's
+    // surface brightness.
+    void AddPatch(Vector3 center, float area, Color color, float intensity = 1.0f) {
+        const float radius = 0.6f * std::sqrt(area);
+        AddGlow(center, radius, color, intensity * area / (PI * radius * radius));
+    }
+
+    size_t bodyCount() const { return spheres_.size(); }
+    size_t volumeCount() const { return volumes_.size(); }
+
+    void Build() {
+        std::vector<Bounds> items;
+        items.reserve(spheres_.size());
+        for (const TraceSphere& s : spheres_) items.push_back(SphereBounds(s.center, s.radius));
+        sphereTree_.Build(items);
+        items.clear();
+        items.reserve(volumes_.size());
+        for (const TraceVolume& v : volumes_) items.push_back(SphereBounds(v.center, kVolumeCutoff * v.sigma));
+        volumeTree_.Build(items);
+    }
+
+    // Radiance along origin + t dir (dir normalised).
+    Vector3 Radiance(Vector3 origin, Vector3 dir, astro_random::PhiloxStream* rng) const {
+        Vector3 radiance{0.0f, 0.0f, 0.0f};
+        Vector3 throughput{1.0f, 1.0f, 1.0f};
+        for (int bounce = 0; bounce <= kMaxBounces; ++bounce) {
+            int hit = -1;
+            const float tHit = NearestBody(origin, dir, &hit);
+            radiance = Vector3Add(radiance, Vector3Multiply(throughput, VolumeEmission(origin, dir, tHit)));
+            if (hit < 0) {
+                if (bounce == 0) radiance = Vector3Add(radiance, background);
+                break;
+            }
+
+            const TraceSphere& body = spheres_[static_cast<size_t>(hit)];
+            radiance = Vector3Add(radiance, Vector3Multiply(throughput, body.emission));
+            throughput = Vector3Multiply(throughput, body.albedo);
+            if (std::max({throughput.x, throughput.y, throughput.z}) < 1.0e-3f) break;
+
+            const Vector3 p = Vector3Add(origin, Vector3Scale(dir, tHit));
+            const Vector3 n = Vector3Normalize(Vector3Subtract(p, body.center));
+            origin = Vector3Add(p, Vector3Scale(n, 1.0e-4f * (1.0f + body.radius)));
+            dir = CosineSample(n, rng->Uniform(), rng->Uniform());
+        }
+        return radiance;
+    }
+
+  private:
+    static constexpr float kSqrtPi = 1.7724538509055160f;
+    static constexpr float kVolumeCutoff = 3.0f;  // exp(-9): volumes end at 3 sigma
+    static constexpr int kMaxBounces = 2;
+
+    struct Bounds {
+        Vector3 lo;
+        Vector3 hi;
+    };
+
+    static Bounds SphereBounds(Vector3 c, float r) {
+        return {{c.x - r, c.y - r, c.z - r}, {c.x + r, c.y + r, c.z + r}};
+    }
+
+    // Median-split BVH over item bounds. Leaves hold up to kLeafSize items, stored as a
+    // run of `order`; an inner node's left child follows it and `first` is the right.
+    class Bvh {
+      public:
+        void Build(const std::vector<Bounds>& items) {
+            nodes_.clear();
+            order_.resize(items.size());
+            for (size_t i = 0; i < items.size(); ++i) order_[i] = static_cast<int>(i);
+            if (!items.empty()) BuildNode(items, 0, static_cast<int>(items.size()));
+        }
+
+        // Calls visit(item) for every leaf item whose box the ray meets before tMax;
+        // visit may shrink *tMax to prune the rest.
+        template <typename Visit>
+        void Traverse(Vector3 origin, Vector3 invDir, float* tMax, Visit&& visit) const {
+            if (nodes_.empty()) return;
+            int stack[64];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0) {
+                const Node& node = nodes_[static_cast<size_t>(stack[--top])];
+                if (!Overlaps(node.box, origin, invDir, *tMax)) continue;
+                if (node.count > 0) {
+                    for (int i = 0; i < node.count; ++i) visit(order_[static_cast<size_t>(node.first + i)], tMax);
+                } else {
+                    const int self = static_cast<int>(&node - nodes_.data());
+                    stack[top++] = node.first;
+                    stack[top++] = self + 1;
+                }
+            }
+        }
+
+      private:
+        static constexpr int kLeafSize = 4;
+
+        struct Node {
+            Bounds box;
+            int first;
+            int count;
+        };
+
+        static bool Overlaps(const Bounds& b, Vector3 o, Vector3 inv, float tMax) {
+            float t0 = 0.0f, t1 = tMax;
+            const float ro[3] = {o.x, o.y, o.z}, ri[3] = {inv.x, inv.y, inv.z};
+            const float lo[3] = {b.lo.x, b.lo.y, b.lo.z}, hi[3] = {b.hi.x, b.hi.y, b.hi.z};
+            for (int a = 0; a < 3; ++a) {
+                float n = (lo[a] - ro[a]) * ri[a], f = (hi[a] - ro[a]) * ri[a];
+                if (n > f) std::swap(n, f);
+                t0 = std::max(t0, n);
+                t1 = std::min(t1, f);
+                if (t0 > t1) return false;
+            }
+            return true;
+        }
+
+        int BuildNode(const std::vector<Bounds>& items, int begin, int end) {
+            Bounds box = items[static_cast<size_t>(order_[static_cast<size_t>(begin)])];
+            for (int i = begin + 1; i < end; ++i) {
+                const Bounds& b = items[static_cast<size_t>(order_[static_cast<size_t>(i)])];
+                box.lo = Vector3Min(box.lo, b.lo);
+                box.hi = Vector3Max(box.hi, b.hi);
+            }
+            const int index = static_cast<int>(nodes_.size());
+            nodes_.push_back({box, begin, end - begin});
+            if (end - begin <= kLeafSize) return index;
+
+            const Vector3 extent = Vector3Subtract(box.hi, box.lo);
+            const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+            auto centre = [&](int item) {
+                const Bounds& b = items[static_cast<size_t>(item)];
+                return axis == 0 ? b.lo.x + b.hi.x : axis == 1 ? b.lo.y + b.hi.y : b.lo.z + b.hi.z;
+            };
+            const int mid = (begin + end) / 2;
+            std::nth_element(order_.begin() + begin, order_.begin() + mid, order_.begin() + end,
+                             [&](int a, int b) { return centre(a) < centre(b); });
+            BuildNode(items, begin, mid);
+            const int right = BuildNode(items, mid, end);
+            nodes_[static_cast<size_t>(index)].first = right;
+            nodes_[static_cast<size_t>(index)].count = 0;
+            return index;
+        }
+
+        std::vector<Node> nodes_;
+        std::vector<int> order_;
+    };
+
+    static Vector3 InverseDir(Vector3 d) {
+        auto inv = [](float v) { return 1.0f / (std::fabs(v) > 1.0e-12f ? v : 1.0e-12f); };
+        return {inv(d.x), inv(d.y), inv(d.z)};
+    }
+
+    float NearestBody(Vector3 origin, Vector3 dir, int* hit) const {
+        float tMax = std::numeric_limits<float>::infinity();
+        sphereTree_.Traverse(origin, InverseDir(dir), &tMax, [&](int i, float* t) {
+            const TraceSphere& s = spheres_[static_cast<size_t>(i)];
+            const Vector3 oc = Vector3Subtract(origin, s.center);
+            const float b = Vector3DotProduct(oc, dir);
+            const float disc = b * b - (Vector3DotProduct(oc, oc) - s.radius * s.radius);
+            if (disc < 0.0f) return;
+            const float root = std::sqrt(disc);
+            const float tNear = -b - root > 0.0f ? -b - root : -b + root;
+            if (tNear > 0.0f && tNear < *t) {
+                *t = tNear;
+                *hit = i;
+            }
+        });
+        return tMax;
+    }
+
+    // Emission gathered over [0, tEnd): for each volume the Gaussian's line integral
+    // exp(-d^2/s^2) * s sqrt(pi) / 2 * (erf((tEnd - tc)/s) - erf(-tc/s)), with d the
+    // ray's miss distance and tc its closest approach.
+    Vector3 VolumeEmission(Vector3 origin, Vector3 dir, float tEnd) const {
+        Vector3 sum{0.0f, 0.0f, 0.0f};
+        float tLimit = tEnd;
+        volumeTree_.Traverse(origin, InverseDir(dir), &tLimit, [&](int i, float*) {
+            const TraceVolume& v = volumes_[static_cast<size_t>(i)];
+            const Vector3 oc = Vector3Subtract(v.center, origin);
+            const float tc = Vector3DotProduct(oc, dir);
+            const float miss2 = Vector3DotProduct(oc, oc) - tc * tc;
+            const float s2 = v.sigma * v.sigma;
+            if (miss2 > kVolumeCutoff * kVolumeCutoff * s2) return;
+            const float inv = 1.0f / v.sigma;
+            const float upper = std::isinf(tEnd) ? 1.0f : std::erf((tEnd - tc) * inv);
+            const float weight = std::exp(-miss2 / s2) * 0.5f * kSqrtPi * v.sigma * (upper - std::erf(-tc * inv));
+            sum = Vector3Add(sum, Vector3Scale(v.emission, weight));
+        });
+        return sum;
+    }
+
+    static Vector3 CosineSample(Vector3 n, float u1, float u2) {
+        const Vector3 helper = std::fabs(n.x) > 0.5f ? Vector3{0.0f, 1.0f, 0.0f} : Vector3{1.0f, 0.0f, 0.0f};
+        const Vector3 t = Vector3Normalize(Vector3CrossProduct(helper, n));
+        const Vector3 b = Vector3CrossProduct(n, t);
+        const float r = std::sqrt(u1), phi = 2.0f * PI * u2;
+        return Vector3Normalize(Vector3Add(Vector3Add(Vector3Scale(t, r * std::cos(phi)), Vector3Scale(b, r * std::sin(phi))),
+                                           Vector3Scale(n, std::sqrt(std::max(0.0f, 1.0f - u1)))));
+    }
+
+    std::vector<TraceSphere> spheres_;
+    std::vector<TraceVolume> volumes_;
+    Bvh sphereTree_;
+    Bvh volumeTree_;
+};
+
+// Tiles are dealt out in contiguous runs, one per worker, each with its own cursor. A
+// worker drains its run and then steals from whichever run has the most tiles left, so
+// the expensive tiles around the disk do not leave the other threads idle.
+class TileQueues {
+  public:
+    void Reset(int tileCount, int workers) {
+        workers_ = std::max(1, workers);
+        cursors_ = std::make_unique<std::atomic<int>[]>(static_cast<size_t>(workers_));
+        ends_.assign(static_cast<size_t>(workers_), 0);
+        for (int w = 0; w < workers_; ++w) {
+            cursors_[static_cast<size_t>(w)].store(static_cast<int>(static_cast<int64_t>(tileCount) * w / workers_));
+            ends_[static_cast<size_t>(w)] = static_cast<int>(static_cast<int64_t>(tileCount) * (w + 1) / workers_);
+        }
+    }
+
+    // Next tile for `worker`, or -1 once every run is empty.
+    int Next(int worker) {
+        const int own = cursors_[static_cast<size_t>(worker)].fetch_add(1);
+        if (own < ends_[static_cast<size_t>(worker)]) return own;
+        while (true) {
+            int victim = -1, most = 0;
+            for (int w = 0; w < workers_; ++w) {
+                const int left = ends_[static_cast<size_t>(w)] - cursors_[static_cast<size_t>(w)].load(std::memory_order_relaxed);
+                if (left > most) {
+                    most = left;
+                    victim = w;
+                }
+            }
+            if (victim < 0) return -1;
+            const int stolen = cursors_[static_cast<size_t>(victim)].fetch_add(1);
+            if (stolen < ends_[static_cast<size_t>(victim)]) return stolen;
+        }
+    }
+
+  private:
+    int workers_ = 1;
+    std::unique_ptr<std::atomic<int>[]> cursors_;
+    std::vector<int> ends_;
+};
+
+// Linear RGB as PNG: exposure, 1 - exp(-x) shoulder, sRGB encode. Uses raylib's
+// CPU-side image export, which needs no window.
+inline bool WriteStillPng(const std::string& path, const std::vector<float>& rgb, int width, int height, float exposure) {
+    std::vector<unsigned char> bytes(static_cast<size_t>(width) * height * 3);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        const float mapped = 1.0f - std::exp(-std::max(0.0f, rgb[i]) * exposure);
+        const float srgb = mapped <= 0.0031308f ? 12.92f * mapped : 1.055f * std::pow(mapped, 1.0f / 2.4f) - 0.055f;
+        bytes[i] = static_cast<unsigned char>(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+    Image image{bytes.data(), width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8};
+    return ExportImage(image, path.c_str());
+}
+
+// Linear RGB as an uncompressed scanline OpenEXR file with 32-bit float B, G, R
+// channels (the format stores channels in name order).
+inline bool WriteStillExr(const std::string& path, const std::vector<float>& rgb, int width, int height) {
+    std::vector<unsigned char> header;
+    auto put = [&](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        header.insert(header.end(), bytes, bytes + size);
+    };
+    auto putInt = [&](int32_t v) { put(&v, 4); };
+    auto putFloat = [&](float v) { put(&v, 4); };
+    auto attribute = [&](const char* name, const char* type, int32_t size) {
+        put(name, std::strlen(name) + 1);
+        put(type, std::strlen(type) + 1);
+        putInt(size);
+    };
+
+    const unsigned char magic[4] = {0x76, 0x2f, 0x31, 0x01};
+    put(magic, 4);
+    putInt(2);  // version 2, single-part scanline
+    attribute("channels", "chlist", 3 * 18 + 1);
+    for (const char* channel : {"B", "G", "R"}) {
+        put(channel, 2);
+        putInt(2);  // FLOAT
+        const unsigned char linearAndReserved[4] = {0, 0, 0, 0};
+        put(linearAndReserved, 4);
+        putInt(1);
+        putInt(1);
+    }
+    header.push_back(0);
+    attribute("compression", "compression", 1);
+    header.push_back(0);  // NO_COMPRESSION
+    for (const char* window : {"dataWindow", "displayWindow"}) {
+        attribute(window, "box2i", 16);
+        putInt(0);
+        putInt(0);
+        putInt(width - 1);
+        putInt(height - 1);
+    }
+    attribute("lineOrder", "lineOrder", 1);
+    header.push_back(0);  // INCREASING_Y
+    attribute("pixelAspectRatio", "float", 4);
+    putFloat(1.0f);
+    attribute("screenWindowCenter", "v2f", 8);
+    putFloat(0.0f);
+    putFloat(0.0f);
+    attribute("screenWindowWidth", "float", 4);
+    putFloat(1.0f);
+    header.push_back(0);
+
+    const uint64_t lineBytes = static_cast<uint64_t>(width) * 3 * sizeof(float);
+    const uint64_t firstLine = header.size() + static_cast<uint64_t>(height) * sizeof(uint64_t);
+    for (int y = 0; y < height; ++y) {
+        const uint64_t offset = firstLine + static_cast<uint64_t>(y) * (8 + lineBytes);
+        put(&offset, sizeof(offset));
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    std::vector<float> line(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height && ok; ++y) {
+        for (int c = 0; c < 3; ++c) {
+            const int source = 2 - c;  // B, G, R planes from interleaved RGB
+            for (int x = 0; x < width; ++x) {
+                line[static_cast<size_t>(c) * width + x] = rgb[(static_cast<size_t>(y) * width + x) * 3 + source];
+            }
+        }
+        const int32_t lineHeader[2] = {y, static_cast<int32_t>(lineBytes)};
+        ok = std::fwrite(lineHeader, sizeof(lineHeader), 1, file) == 1 &&
+             std::fwrite(line.data(), sizeof(float), line.size(), file) == line.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+inline bool WriteStill(const StillOptions& options, const std::vector<float>& rgb) {
+    const std::string& path = options.path;
+    const bool exr = path.size() >= 4 && path.compare(path.size() - 4, 4, ".exr") == 0;
+    return exr ? WriteStillExr(path, rgb, options.width, options.height)
+               : WriteStillPng(path, rgb, options.width, options.height, options.exposure);
+}
+
+// Path-traces `scene` (already Build()-ed) through the raylib perspective camera and
+// writes options.path; prints a one-line JSON summary like the headless bench. Returns
+// the process exit code.
+inline int RenderStill(const char* name, const TraceScene& scene, const Camera3D& camera, const StillOptions& options) {
+    constexpr int kTileSize = 32;
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point t0 = Clock::now();
+
+    const int width = options.width, height = options.height;
+    const Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    const Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+    const Vector3 up = Vector3CrossProduct(right, forward);
+    const float halfHeight = std::tan(0.5f * camera.fovy * DEG2RAD);
+    const float halfWidth = halfHeight * static_cast<float>(width) / static_cast<float>(height);
+
+    const int tilesX = (width + kTileSize - 1) / kTileSize;
+    const int tilesY = (height + kTileSize - 1) / kTileSize;
+    std::vector<float> sum(static_cast<size_t>(width) * height * 3, 0.0f);
+    std::vector<float> image(sum.size());
+
+    astro_parallel::ThreadPool& pool = astro_parallel::SharedPool();
+    TileQueues queues;
+    bool written = true;
+    for (int pass = 0; pass < options.samples; ++pass) {
+        queues.Reset(tilesX * tilesY, pool.size());
+        pool.Run(pool.size(), [&](int worker) {
+            for (int tile = queues.Next(worker); tile >= 0; tile = queues.Next(worker)) {
+                const int x0 = (tile % tilesX) * kTileSize, y0 = (tile / tilesX) * kTileSize;
+                const int x1 = std::min(width, x0 + kTileSize), y1 = std::min(height, y0 + kTileSize);
+                for (int y = y0; y < y1; ++y) {
+                    for (int x = x0; x < x1; ++x) {
+                        const uint32_t pixel = static_cast<uint32_t>(y) * static_cast<uint32_t>(width) + static_cast<uint32_t>(x);
+                        astro_random::PhiloxStream rng({0x5eedu, 0x7ace5u}, pixel, static_cast<uint32_t>(pass));
+                        const float sx = (2.0f * (x + rng.Uniform()) / width - 1.0f) * halfWidth;
+                        const float sy = (1.0f - 2.0f * (y + rng.Uniform()) / height) * halfHeight;
+                        const Vector3 dir = Vector3Normalize(Vector3Add(forward, Vector3Add(Vector3Scale(right, sx), Vector3Scale(up, sy))));
+                        const Vector3 L = scene.Radiance(camera.position, dir, &rng);
+                        float* out = &sum[static_cast<size_t>(pixel) * 3];
+                        out[0] += L.x;
+                        out[1] += L.y;
+                        out[2] += L.z;
+                    }
+                }
+            }
+        });
+
+        const int done = pass + 1;
+        if ((done & (done - 1)) == 0 || done == options.samples) {
+            const float inv = 1.0f / static_cast<float>(done);
+            for (size_t i = 0; i < sum.size(); ++i) image[i] = sum[i] * inv;
+            written = WriteStill(options, image);
+            std::fprintf(stderr, "%s: %d/%d samples per pixel, %.1f s%s\n", name, done, options.samples,
+                         std::chrono::duration<double>(Clock::now() - t0).count(), written ? "" : " (write failed)");
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    std::printf("{\"target\":\"%s\",\"render\":\"%s\",\"width\":%d,\"height\":%d,\"spp\":%d,\"bodies\":%zu,\"volumes\":%zu,"
+                "\"threads\":%d,\"seconds\":%.3f,\"written\":%s}\n",
+                name, options.path.c_str(), width, height, options.samples, scene.bodyCount(), scene.volumeCount(),
+                pool.size(), seconds, written ? "true" : "false");
+    return written ? 0 : 1;
+}
+
+}  // namespace astro_render
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <vector>
+
+#if defined(_WIN32)
+#define ASTRO_MESH_GL_CALL __stdcall
+#else
+#define ASTRO_MESH_GL_CALL
+#endif
+
+extern "C" void* glfwGetProcAddress(const char* procname);  // raylib's desktop platform is GLFW
+
+namespace astro_render {
+
+// Surfaces and line families that are a fixed function of a few parameters, built
+// once on the GPU instead of re-evaluated with DrawTriangle3D/DrawLine3D every frame.
+//
+// Every vertex stores a vec4 of surface coordinates (say u and theta, plus whatever
+// the shading needs, such as the cell a flat-shaded triangle belongs to). The caller's
+// vertex shader declares `in vec4 vertexParams;` and `uniform mat4 mvp;` and maps the
+// coordinates to a position and colour; shape parameters (throat radius, minor radius,
+// stretch) and time-varying effects (breathing, drifting bands) are uniforms, so one
+// buffer serves every parameter set and never has to be rebuilt. Lines are a line-list
+// buffer drawn with one GL_LINES call.
+//
+// Init() returns false without GL 3.3 or when the shader does not build; keep the
+// immediate-mode path for that case. Unload() must run before CloseWindow().
+enum class ParametricPrimitive {
+    kTriangles,
+    kLines,
+};
+
+class ParametricMesh {
+  public:
+    bool Init(const char* vertexShader, const char* fragmentShader, ParametricPrimitive primitive,
+              const std::vector<Vector4>& params) {
+        Unload();
+        if (params.empty() || !LoadDrawArrays()) return false;
+        shader_ = rlLoadShaderCode(vertexShader, fragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locParams_ = rlGetLocationAttrib(shader_, "vertexParams");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        if (locParams_ < 0) {
+            Unload();
+            return false;
+        }
+
+        vao_ = rlLoadVertexArray();
+        rlEnableVertexArray(vao_);
+        vbo_ = rlLoadVertexBuffer(params.data(), static_cast<int>(params.size() * sizeof(Vector4)), false);
+        rlSetVertexAttribute(static_cast<unsigned int>(locParams_), 4, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locParams_));
+        rlDisableVertexArray();
+
+        primitive_ = primitive;
+        count_ = static_cast<int>(params.size());
+        return vao_ != 0;
+    }
+
+    void Unload() {
+        if (vbo_ != 0) rlUnloadVertexBuffer(vbo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        vbo_ = vao_ = shader_ = 0;
+        count_ = 0;
+    }
+
+    bool ready() const { return vao_ != 0; }
+    int count() const { return count_; }
+
+    int Uniform(const char* name) const { return rlGetLocationUniform(shader_, name); }
+
+    // Flushes queued immediate geometry so draw order holds, then binds the shader
+    // with the current camera's mvp. Set uniforms and Draw() until End().
+    void Begin() const {
+        rlDrawRenderBatchActive();
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+        rlEnableVertexArray(vao_);
+    }
+
+    void SetFloat(int location, float value) const { rlSetUniform(location, &value, RL_SHADER_UNIFORM_FLOAT, 1); }
+    void SetVec4(int location, Vector4 value) const { rlSetUniform(location, &value, RL_SHADER_UNIFORM_VEC4, 1); }
+    void SetVec4s(int location, const Vector4* values, int count) const {
+        rlSetUniform(location, values, RL_SHADER_UNIFORM_VEC4, count);
+    }
+
+    // Vertices [first, first + count); count < 0 draws to the end.
+    void Draw(int first = 0, int count = -1) const {
+        if (count < 0) count = count_ - first;
+        if (count <= 0) return;
+        drawArrays_(primitive_ == ParametricPrimitive::kLines ? kGlLines : kGlTriangles, first, count);
+    }
+
+    void End() const {
+        rlDisableVertexArray();
+        rlDisableShader();
+    }
+
+  private:
+    static constexpr unsigned kGlLines = 0x0001;
+    static constexpr unsigned kGlTriangles = 0x0004;
+
+    // glDrawArrays with a primitive of our choosing; rlDrawVertexArray is triangles only.
+    bool LoadDrawArrays() {
+        const int version = rlGetVersion();
+        if (version != RL_OPENGL_33 && version != RL_OPENGL_43) return false;
+        drawArrays_ = reinterpret_cast<DrawArraysFn>(glfwGetProcAddress("glDrawArrays"));
+        return drawArrays_ != nullptr;
+    }
+
+    using DrawArraysFn = void(ASTRO_MESH_GL_CALL*)(unsigned, int, int);
+
+    DrawArraysFn drawArrays_ = nullptr;
+    ParametricPrimitive primitive_ = ParametricPrimitive::kTriangles;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int vbo_ = 0;
+    int locParams_ = -1;
+    int locMvp_ = -1;
+    int count_ = 0;
+};
+
+}  // namespace astro_render
@@ -0,0 +1,416 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Kinematic Parker-spiral solar wind in scene units, y up and the ecliptic in x-z.
+// Plasma leaves the source surface radially at a speed set by its angular distance
+// from the heliospheric current sheet (slow in a band around it, fast above); the Sun
+// turns underneath at `rotation`, so the frozen-in field winds into the Archimedean
+// spiral B_phi / B_r = -rotation r cos(lat) / speed. The current sheet is the neutral
+// line of a dipole tilted by `sheetTilt`, carried out along the same spiral, and its
+// two sides have opposite polarity. The free functions below are the CPU model;
+// GpuParkerTracers runs the same model in GLSL.
+
+namespace astro_helio {
+
+struct ParkerWind {
+    float slowSpeed = 4.6f;        // scene units per sim second
+    float fastSpeed = 9.6f;
+    float rotation = 0.8f;         // rad per sim second; winds to 45 degrees near r = slowSpeed / rotation
+    float sourceRadius = 1.65f;
+    float sheetTilt = 0.26f;       // rad, dipole tilt against the rotation axis
+    float sheetHalfWidth = 0.12f;  // rad of slow wind either side of the sheet
+    float extent = 34.0f;          // tracers leaving this radius respawn
+};
+
+// Longitude, in the Sun's rotating frame, of the source point a parcel at `pos` left
+// from. The sheet and the sector pattern are fixed in that frame.
+inline float SourceLongitude(const ParkerWind& w, Vector3 pos, float time) {
+    const float r = Vector3Length(pos);
+    return std::atan2(pos.z, pos.x) - w.rotation * time + w.rotation * (r - w.sourceRadius) / w.slowSpeed;
+}
+
+inline float SheetLatitude(const ParkerWind& w, float sourceLongitude) {
+    return std::atan(std::tan(w.sheetTilt) * std::sin(sourceLongitude));
+}
+
+inline float Latitude(Vector3 pos) {
+    return std::asin(std::clamp(pos.y / std::max(Vector3Length(pos), 1.0e-6f), -1.0f, 1.0f));
+}
+
+// +1 above the current sheet, -1 below.
+inline float Polarity(const ParkerWind& w, Vector3 pos, float time) {
+    return Latitude(pos) >= SheetLatitude(w, SourceLongitude(w, pos, time)) ? 1.0f : -1.0f;
+}
+
+inline float Speed(const ParkerWind& w, Vector3 pos, float time) {
+    const float fromSheet = std::fabs(Latitude(pos) - SheetLatitude(w, SourceLongitude(w, pos, time)));
+    const float x = std::clamp((fromSheet - w.sheetHalfWidth) / (1.5f * w.sheetHalfWidth), 0.0f, 1.0f);
+    return w.slowSpeed + (w.fastSpeed - w.slowSpeed) * x * x * (3.0f - 2.0f * x);
+}
+
+// Unit field direction at `pos` for outward polarity.
+inline Vector3 FieldDirection(const ParkerWind& w, Vector3 pos, float time) {
+    const float r = std::max(Vector3Length(pos), 1.0e-6f);
+    const float lon = std::atan2(pos.z, pos.x);
+    const float cosLat = std::sqrt(std::max(0.0f, 1.0f - (pos.y / r) * (pos.y / r)));
+    const float wind = w.rotation * r * cosLat / Speed(w, pos, time);
+    const Vector3 radial = Vector3Scale(pos, 1.0f / r);
+    return Vector3Normalize(Vector3Subtract(radial, Vector3Scale({-std::sin(lon), 0.0f, std::cos(lon)}, wind)));
+}
+
+// A magnetosphere the wind bends around: tracers inside `influence` are pushed
+// sideways around it and, for a strong tail, downwind; inside `shield` they are
+// absorbed and respawn.
+struct Obstacle {
+    Vector3 pos{};
+    float shield = 0.0f;
+    float influence = 0.0f;
+    float deflection = 0.0f;
+    float tailPush = 0.0f;
+};
+
+// Point on the current sheet whose source longitude was `sourceLongitude`, at radius r.
+inline Vector3 SheetPoint(const ParkerWind& w, float sourceLongitude, float r, float time) {
+    const float lon = sourceLongitude + w.rotation * time - w.rotation * (r - w.sourceRadius) / w.slowSpeed;
+    const float lat = SheetLatitude(w, sourceLongitude);
+    return {r * std::cos(lat) * std::cos(lon), r * std::sin(lat), r * std::cos(lat) * std::sin(lon)};
+}
+
+// Up to a million tracers riding the wind entirely on the GPU, in the style of
+// astro_render::GpuWindTracers: one RGBA32F texel per tracer holds (position, age), a
+// fullscreen pass renders the next state into the other half of a ping-pong pair, and
+// Draw() expands each texel into a camera-facing streak along the local spiral field
+// from gl_VertexID. Per frame the CPU only uploads the wind parameters and up to
+// kMaxObstacles planet spheres; each tracer rejects a planet with one squared-distance
+// test before any deflection work.
+//
+// Init() after InitWindow(); Advect() outside BeginDrawing/BeginTextureMode; Draw()
+// between BeginMode3D/EndMode3D; Unload() before CloseWindow(). Init() returns false
+// without GL 3.3 float render targets, in which case callers keep CPU tracers.
+class GpuParkerTracers {
+  public:
+    static constexpr int kStateWidth = 1024;
+    static constexpr int kMaxObstacles = 8;
+
+    bool Init(int count, const ParkerWind& wind, uint32_t seed) {
+        width_ = kStateWidth;
+        height_ = std::max(1, (count + kStateWidth - 1) / kStateWidth);
+        updateShader_ = rlLoadShaderCode(kFullscreenVertexShader, kUpdateFragmentShader);
+        drawShader_ = rlLoadShaderCode(kStreakVertexShader, kStreakFragmentShader);
+        if (updateShader_ == 0 || updateShader_ == rlGetShaderIdDefault() || drawShader_ == 0 || drawShader_ == rlGetShaderIdDefault()) {
+            Unload();
+            return false;
+        }
+        locUpdateState_ = rlGetLocationUniform(updateShader_, "state");
+        locUpdateDt_ = rlGetLocationUniform(updateShader_, "dt");
+        locUpdateSeed_ = rlGetLocationUniform(updateShader_, "seed");
+        locUpdateTime_ = rlGetLocationUniform(updateShader_, "time");
+        locUpdateWind_ = rlGetLocationUniform(updateShader_, "wind");
+        locUpdateSheet_ = rlGetLocationUniform(updateShader_, "sheet");
+        locUpdateObstacleCount_ = rlGetLocationUniform(updateShader_, "obstacleCount");
+        locUpdateObstacles_ = rlGetLocationUniform(updateShader_, "obstacles");
+        locUpdateObstacleFields_ = rlGetLocationUniform(updateShader_, "obstacleFields");
+        locDrawState_ = rlGetLocationUniform(drawShader_, "state");
+        locDrawMvp_ = rlGetLocationUniform(drawShader_, "mvp");
+        locDrawWidth_ = rlGetLocationUniform(drawShader_, "stateWidth");
+        locDrawEye_ = rlGetLocationUniform(drawShader_, "eye");
+        locDrawTime_ = rlGetLocationUniform(drawShader_, "time");
+        locDrawWind_ = rlGetLocationUniform(drawShader_, "wind");
+        locDrawSheet_ = rlGetLocationUniform(drawShader_, "sheet");
+        locDrawStreak_ = rlGetLocationUniform(drawShader_, "streak");
+        locDrawHalfWidth_ = rlGetLocationUniform(drawShader_, "halfWidth");
+        locDrawAlpha_ = rlGetLocationUniform(drawShader_, "alpha");
+
+        // Spread over the whole flow at the start, so the spiral is there on frame one.
+        std::vector<float> initial(static_cast<size_t>(width_) * height_ * 4);
+        uint32_t state = seed * 747796405u + 2891336453u;
+        const auto random = [&state]() {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 16777216.0f;
+        };
+        for (size_t i = 0; i < initial.size(); i += 4) {
+            const float lon = 2.0f * PI * random();
+            const float lat = 0.8f * std::asin(2.0f * random() - 1.0f);
+            const float r = wind.sourceRadius + (wind.extent - wind.sourceRadius) * random();
+            initial[i + 0] = r * std::cos(lat) * std::cos(lon);
+            initial[i + 1] = r * std::sin(lat);
+            initial[i + 2] = r * std::cos(lat) * std::sin(lon);
+            initial[i + 3] = 1.0f;
+        }
+        for (int k = 0; k < 2; ++k) {
+            state_[k] = rlLoadTexture(initial.data(), width_, height_, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+            rlTextureParameters(state_[k], RL_TEXTURE_MIN_FILTER, RL_TEXTURE_FILTER_NEAREST);
+            rlTextureParameters(state_[k], RL_TEXTURE_MAG_FILTER, RL_TEXTURE_FILTER_NEAREST);
+            fbo_[k] = rlLoadFramebuffer();
+            rlFramebufferAttach(fbo_[k], state_[k], RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+            if (state_[k] == 0 || fbo_[k] == 0 || !rlFramebufferComplete(fbo_[k])) {
+                Unload();
+                return false;
+            }
+        }
+        vao_ = rlLoadVertexArray();  // attribute-less: the shaders work from gl_VertexID
+        ready_ = vao_ != 0;
+        if (!ready_) Unload();
+        return ready_;
+    }
+
+    void Unload() {
+        for (int k = 0; k < 2; ++k) {
+            if (fbo_[k] != 0) rlUnloadFramebuffer(fbo_[k]);
+            if (state_[k] != 0) rlUnloadTexture(state_[k]);
+            fbo_[k] = state_[k] = 0;
+        }
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (updateShader_ != 0 && updateShader_ != rlGetShaderIdDefault()) rlUnloadShaderProgram(updateShader_);
+        if (drawShader_ != 0 && drawShader_ != rlGetShaderIdDefault()) rlUnloadShaderProgram(drawShader_);
+        vao_ = updateShader_ = drawShader_ = 0;
+        ready_ = false;
+    }
+
+    bool ready() const { return ready_; }
+    int count() const { return width_ * height_; }
+
+    // Obstacles past kMaxObstacles are ignored.
+    void Advect(const ParkerWind& wind, const Obstacle* obstacles, int obstacleCount, float time, float dt) {
+        if (!ready_ || dt <= 0.0f) return;
+        const int src = current_;
+        const int dst = 1 - current_;
+        seedPhase_ = seedPhase_ + 0.618034f - static_cast<float>(static_cast<int>(seedPhase_ + 0.618034f));
+
+        const int n = std::clamp(obstacleCount, 0, kMaxObstacles);
+        std::array<float, 4 * kMaxObstacles> spheres{};
+        std::array<float, 4 * kMaxObstacles> fields{};
+        for (int i = 0; i < n; ++i) {
+            const Obstacle& o = obstacles[i];
+            const size_t k = static_cast<size_t>(4 * i);
+            spheres[k + 0] = o.pos.x;
+            spheres[k + 1] = o.pos.y;
+            spheres[k + 2] = o.pos.z;
+            spheres[k + 3] = o.shield;
+            fields[k + 0] = o.influence;
+            fields[k + 1] = o.deflection;
+            fields[k + 2] = o.tailPush;
+        }
+
+        rlDrawRenderBatchActive();
+        rlEnableFramebuffer(fbo_[dst]);
+        rlViewport(0, 0, width_, height_);
+        rlDisableColorBlend();
+        rlEnableShader(updateShader_);
+        BindState(locUpdateState_, state_[src]);
+        SetWindUniforms(wind, time, locUpdateTime_, locUpdateWind_, locUpdateSheet_);
+        rlSetUniform(locUpdateDt_, &dt, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locUpdateSeed_, &seedPhase_, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locUpdateObstacleCount_, &n, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(locUpdateObstacles_, spheres.data(), RL_SHADER_UNIFORM_VEC4, kMaxObstacles);
+        rlSetUniform(locUpdateObstacleFields_, fields.data(), RL_SHADER_UNIFORM_VEC4, kMaxObstacles);
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArray(0, 3);
+        rlDisableVertexArray();
+        UnbindState();
+        rlDisableShader();
+        rlEnableColorBlend();
+        rlDisableFramebuffer();
+        rlViewport(0, 0, rlGetFramebufferWidth(), rlGetFramebufferHeight());
+        current_ = dst;
+    }
+
+    // Streaks `streak` scene units long along the field, coloured by polarity.
+    void Draw(const ParkerWind& wind, Vector3 eye, float time, float streak, float halfWidth, float alpha) const {
+        if (!ready_) return;
+        rlDrawRenderBatchActive();
+        const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        const std::array<float, 3> eyeValue = {eye.x, eye.y, eye.z};
+        rlDisableDepthMask();
+        rlDisableBackfaceCulling();
+        rlEnableShader(drawShader_);
+        rlSetUniformMatrix(locDrawMvp_, mvp);
+        BindState(locDrawState_, state_[current_]);
+        SetWindUniforms(wind, time, locDrawTime_, locDrawWind_, locDrawSheet_);
+        rlSetUniform(locDrawWidth_, &width_, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(locDrawEye_, eyeValue.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locDrawStreak_, &streak, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locDrawHalfWidth_, &halfWidth, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locDrawAlpha_, &alpha, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArray(0, 6 * count());
+        rlDisableVertexArray();
+        UnbindState();
+        rlDisableShader();
+        rlEnableBackfaceCulling();
+        rlEnableDepthMask();
+    }
+
+  private:
+    static void SetWindUniforms(const ParkerWind& w, float time, int locTime, int locWind, int locSheet) {
+        const std::array<float, 4> wind = {w.slowSpeed, w.fastSpeed, w.rotation, w.sourceRadius};
+        const std::array<float, 4> sheet = {w.sheetTilt, w.sheetHalfWidth, w.extent, 0.0f};
+        rlSetUniform(locTime, &time, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locWind, wind.data(), RL_SHADER_UNIFORM_VEC4, 1);
+        rlSetUniform(locSheet, sheet.data(), RL_SHADER_UNIFORM_VEC4, 1);
+    }
+
+    static void BindState(int locState, unsigned int state) {
+        const int slot = 0;
+        rlActiveTextureSlot(slot);
+        rlEnableTexture(state);
+        rlSetUniform(locState, &slot, RL_SHADER_UNIFORM_INT, 1);
+    }
+
+    static void UnbindState() {
+        rlActiveTextureSlot(0);
+        rlDisableTexture();
+    }
+
+    static constexpr const char* kFullscreenVertexShader = R"(#version 330
+void main() {
+    vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(2.0 * p - 1.0, 0.0, 1.0);
+}
+)";
+
+    // Speed() and the sheet geometry mirror the astro_helio free functions.
+    static constexpr const char* kUpdateFragmentShader = R"(#version 330
+uniform sampler2D state;
+uniform float dt;
+uniform float seed;
+uniform float time;
+uniform vec4 wind;   // slow speed, fast speed, rotation, source radius
+uniform vec4 sheet;  // tilt, half width, extent
+uniform int obstacleCount;
+uniform vec4 obstacles[8];       // centre, shield radius
+uniform vec4 obstacleFields[8];  // influence radius, deflection, tail push
+out vec4 result;
+const float PI = 3.14159265;
+float Speed(vec3 p) {
+    float r = length(p);
+    float lat = asin(clamp(p.y / r, -1.0, 1.0));
+    float source = atan(p.z, p.x) - wind.z * time + wind.z * (r - wind.w) / wind.x;
+    float sheetLat = atan(tan(sheet.x) * sin(source));
+    return mix(wind.x, wind.y, smoothstep(sheet.y, 2.5 * sheet.y, abs(lat - sheetLat)));
+}
+float Hash(vec2 p) {
+    return fract(sin(dot(p, vec2(12.9898, 78.233))) * 43758.5453);
+}
+void main() {
+    vec4 s = texelFetch(state, ivec2(gl_FragCoord.xy), 0);
+    vec3 radial = s.xyz / max(length(s.xyz), 1e-4);
+    vec3 p = s.xyz + radial * Speed(s.xyz) * dt;
+    bool respawn = length(p) > sheet.z;
+    for (int i = 0; i < obstacleCount; ++i) {
+        vec3 rel = p - obstacles[i].xyz;
+        float d2 = dot(rel, rel);
+        float influence = obstacleFields[i].x;
+        if (d2 >= influence * influence) continue;
+        float d = sqrt(d2);
+        if (d < obstacles[i].w) {
+            respawn = true;
+            break;
+        }
+        vec3 relDir = rel / max(d, 1e-4);
+        vec3 tangent = cross(relDir, cross(radial, relDir));
+        float tl = length(tangent);
+        tangent = tl > 1e-4 ? tangent / tl : vec3(0.0, 1.0, 0.0);
+        float strength = (1.0 - d / influence) * obstacleFields[i].y;
+        p += tangent * (strength * dt * 14.0) + normalize(obstacles[i].xyz) * (strength * obstacleFields[i].z * dt);
+    }
+    float age = s.w + dt;
+    if (respawn) {
+        vec2 h = gl_FragCoord.xy * 0.0137 + seed * vec2(91.7, 37.3);
+        float lon = 2.0 * PI * Hash(h);
+        float lat = 0.8 * asin(2.0 * Hash(h + 7.31) - 1.0);
+        float r = wind.w + 0.6 * Hash(h + 3.17);
+        p = r * vec3(cos(lat) * cos(lon), sin(lat), cos(lat) * sin(lon));
+        age = 0.0;
+    }
+    result = vec4(p, age);
+}
+)";
+
+    static constexpr const char* kStreakVertexShader = R"(#version 330
+uniform sampler2D state;
+uniform mat4 mvp;
+uniform int stateWidth;
+uniform vec3 eye;
+uniform float time;
+uniform vec4 wind;
+uniform vec4 sheet;
+uniform float streak;
+uniform float halfWidth;
+uniform float alpha;
+out vec4 fragColor;
+void main() {
+    int tracer = gl_VertexID / 6;
+    int corner = gl_VertexID % 6;
+    vec4 s = texelFetch(state, ivec2(tracer % stateWidth, tracer / stateWidth), 0);
+    vec3 p = s.xyz;
+    float r = max(length(p), 1e-4);
+    float lat = asin(clamp(p.y / r, -1.0, 1.0));
+    float lon = atan(p.z, p.x);
+    float sheetLat = atan(tan(sheet.x) * sin(lon - wind.z * time + wind.z * (r - wind.w) / wind.x));
+    float fast = smoothstep(sheet.y, 2.5 * sheet.y, abs(lat - sheetLat));
+    float speed = mix(wind.x, wind.y, fast);
+    vec3 east = vec3(-sin(lon), 0.0, cos(lon));
+    vec3 b = normalize(p / r - east * (wind.z * r * cos(lat) / speed));
+    vec3 side = cross(b, eye - p);
+    float sl = length(side);
+    side = (sl > 1e-5 ? side / sl : east) * halfWidth;
+    float along = (corner == 1 || corner == 2 || corner == 4) ? 1.0 : 0.0;
+    float across = (corner == 0 || corner == 1 || corner == 3) ? -1.0 : 1.0;
+    vec3 color = lat >= sheetLat ? vec3(1.0, 0.62, 0.32) : vec3(0.36, 0.70, 1.0);
+    color = mix(color, vec3(1.0), 0.35 * fast);
+    float fade = clamp(s.w / 0.4, 0.0, 1.0) * clamp((sheet.z - r) / 3.0, 0.0, 1.0);
+    fragColor = vec4(color, alpha * fade * (0.15 + 0.85 * along));
+    gl_Position = mvp * vec4(p - b * (streak * (1.0 - along)) + side * across, 1.0);
+}
+)";
+
+    static constexpr const char* kStreakFragmentShader = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main() {
+    finalColor = fragColor;
+}
+)";
+
+    int width_ = kStateWidth;
+    int height_ = 1;
+    int current_ = 0;
+    float seedPhase_ = 0.0f;
+    unsigned int state_[2] = {0, 0};
+    unsigned int fbo_[2] = {0, 0};
+    unsigned int vao_ = 0;
+    unsigned int updateShader_ = 0;
+    unsigned int drawShader_ = 0;
+    int locUpdateState_ = -1;
+    int locUpdateDt_ = -1;
+    int locUpdateSeed_ = -1;
+    int locUpdateTime_ = -1;
+    int locUpdateWind_ = -1;
+    int locUpdateSheet_ = -1;
+    int locUpdateObstacleCount_ = -1;
+    int locUpdateObstacles_ = -1;
+    int locUpdateObstacleFields_ = -1;
+    int locDrawState_ = -1;
+    int locDrawMvp_ = -1;
+    int locDrawWidth_ = -1;
+    int locDrawEye_ = -1;
+    int locDrawTime_ = -1;
+    int locDrawWind_ = -1;
+    int locDrawSheet_ = -1;
+    int locDrawStreak_ = -1;
+    int locDrawHalfWidth_ = -1;
+    int locDrawAlpha_ = -1;
+    bool ready_ = false;
+};
+
+}  // namespace astro_helio
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "fft.h"
+#include "particle_soa.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Particle-mesh gravity (G = 1) with isolated boundaries.
+//
+// Masses are deposited cloud-in-cell on an n^3 grid of cell centres spanning
+// [-halfWidth, halfWidth]^3, and the potential is the convolution of that mass grid with
+// a softened kernel -1 / sqrt(d^2 + eps^2), eps one cell. The convolution is done with
+// FFTs on a zero-padded (2n)^3 grid (Hockney's method): the padding keeps the periodic
+// images out of the region and the kernel's transform is computed once per grid. Only
+// the octant holding mass is transformed on the way in and only the cells the gradient
+// reads on the way out, which saves about 40% of the FFT work. Accelerations are
+// central differences of the potential, interpolated back with the same CIC weights.
+// A step costs O(N + G log G); the deposit, every FFT pass and the interpolation run
+// on the shared pool. Particles outside the grid feel the monopole of the gridded mass
+// and do not themselves contribute.
+
+namespace astro_pm {
+
+using astro_fft::Complex;
+
+class ParticleMesh {
+  public:
+    static constexpr int kPencilBlock = 8;
+
+    // n must be a power of two.
+    void Configure(int n, float halfWidth) {
+        if (n == n_ && halfWidth == halfWidth_) return;
+        n_ = n;
+        m_ = 2 * n;
+        halfWidth_ = halfWidth;
+        h_ = 2.0f * halfWidth / n;
+        plan_.Resize(m_);
+        const size_t padded = static_cast<size_t>(m_) * m_ * m_;
+        const size_t active = static_cast<size_t>(n_) * n_ * n_;
+        grid_.assign(padded, Complex(0.0f, 0.0f));
+        for (astro_soa::AlignedFloats* a : {&mass_, &gx_, &gy_, &gz_}) a->assign(active, 0.0f);
+        scratch_.resize(static_cast<size_t>(Tasks()) * kPencilBlock * m_);
+        BuildKernel();
+    }
+
+    int cells() const { return n_; }
+    float cellSize() const { return h_; }
+    float halfWidth() const { return halfWidth_; }
+    double gridMass() const { return gridMass_; }
+    float lastMs() const { return lastMs_; }
+
+    // Writes the acceleration at every particle of `p` into p->ax/ay/az.
+    void Accelerations(astro_soa::ParticleSoA* p, const astro_soa::AlignedFloats& mass) {
+        const auto t0 = std::chrono::steady_clock::now();
+        Deposit(*p, mass);
+        Transform(false);
+        const size_t padded = grid_.size();
+        astro_parallel::SharedPool().ParallelFor(static_cast<int>(padded / 4096), 1, [&](int begin, int end) {
+            for (size_t i = static_cast<size_t>(begin) * 4096; i < static_cast<size_t>(end) * 4096; ++i) grid_[i] *= kernel_[i];
+        });
+        Transform(true);
+        Gradient();
+        Interpolate(p);
+        lastMs_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+  private:
+    static int Tasks() { return 4 * astro_parallel::SharedPool().size(); }
+
+    size_t Active(int x, int y, int z) const { return static_cast<size_t>(x) + static_cast<size_t>(n_) * (y + static_cast<size_t>(n_) * z); }
+    size_t Padded(int x, int y, int z) const { return static_cast<size_t>(x) + static_cast<size_t>(m_) * (y + static_cast<size_t>(m_) * z); }
+    // Padded indices the gradient reads: the active cells and one on either side.
+    bool Needed(int k) const { return k <= n_ || k == m_ - 1; }
+
+    void BuildKernel() {
+        kernel_.assign(grid_.size(), 0.0f);
+        for (int z = 0; z < m_; ++z) {
+            for (int y = 0; y < m_; ++y) {
+                for (int x = 0; x < m_; ++x) {
+                    const float dx = h_ * std::min(x, m_ - x), dy = h_ * std::min(y, m_ - y), dz = h_ * std::min(z, m_ - z);
+                    grid_[Padded(x, y, z)] = Complex(-1.0f / std::sqrt(dx * dx + dy * dy + dz * dz + h_ * h_), 0.0f);
+                }
+            }
+        }
+        Transform(false, true);
+        // The kernel is even, so its transform is real; fold the inverse's 1/m^3 in here.
+        const float norm = 1.0f / static_cast<float>(grid_.size());
+        for (size_t i = 0; i < grid_.size(); ++i) kernel_[i] = grid_[i].real() * norm;
+    }
+
+    void Deposit(const astro_soa::ParticleSoA& p, const astro_soa::AlignedFloats& mass) {
+        const int tasks = astro_parallel::SharedPool().size();
+        const size_t active = mass_.size();
+        partial_.resize(static_cast<size_t>(tasks) * active);
+        const size_t count = p.size();
+        const float inv = 1.0f / h_;
+        astro_parallel::SharedPool().Run(tasks, [&](int t) {
+            float* g = partial_.data() + static_cast<size_t>(t) * active;
+            std::fill(g, g + active, 0.0f);
+            const size_t begin = count * t / tasks, end = count * (t + 1) / tasks;
+            for (size_t i = begin; i < end; ++i) {
+                int c[3];
+                float w[3];
+                if (!Locate(p.x[i] * inv, p.y[i] * inv, p.z[i] * inv, c, w)) continue;
+                const float m = mass[i];
+                for (int k = 0; k < 8; ++k) {
+                    const int ox = k & 1, oy = (k >> 1) & 1, oz = k >> 2;
+                    const float wk = (ox ? w[0] : 1.0f - w[0]) * (oy ? w[1] : 1.0f - w[1]) * (oz ? w[2] : 1.0f - w[2]);
+                    g[Active(std::min(c[0] + ox, n_ - 1), std::min(c[1] + oy, n_ - 1), std::min(c[2] + oz, n_ - 1))] += m * wk;
+                }
+            }
+        });
+
+        std::fill(grid_.begin(), grid_.end(), Complex(0.0f, 0.0f));
+        astro_parallel::SharedPool().ParallelFor(n_, 1, [&](int z0, int z1) {
+            for (int z = z0; z < z1; ++z) {
+                for (int y = 0; y < n_; ++y) {
+                    for (int x = 0; x < n_; ++x) {
+                        const size_t a = Active(x, y, z);
+                        float sum = 0.0f;
+                        for (int t = 0; t < tasks; ++t) sum += partial_[static_cast<size_t>(t) * active + a];
+                        mass_[a] = sum;
+                        grid_[Padded(x, y, z)] = Complex(sum, 0.0f);
+                    }
+                }
+            }
+        });
+        gridMass_ = 0.0;
+        for (float m : mass_) gridMass_ += m;
+    }
+
+    // Lower CIC cell and weights for a position in cell units; false outside the grid.
+    bool Locate(float ux, float uy, float uz, int* c, float* w) const {
+        const float u[3] = {ux + 0.5f * n_ - 0.5f, uy + 0.5f * n_ - 0.5f, uz + 0.5f * n_ - 0.5f};
+        for (int d = 0; d < 3; ++d) {
+            if (!(u[d] > -0.5f && u[d] < n_ - 0.5f)) return false;
+            const float f = std::floor(u[d]);
+            c[d] = static_cast<int>(f);
+            w[d] = u[d] - f;
+            if (c[d] < 0) {
+                c[d] = 0;
+                w[d] = 0.0f;
+            }
+        }
+        return true;
+    }
+
+    // 3D transform as x rows, then y and z pencils gathered in blocks. Forward skips
+    // pencils that are still all zero; inverse skips pencils the gradient never reads.
+    void Transform(bool inverse, bool full = false) {
+        const auto run = [&](Complex* data) {
+            if (inverse) {
+                plan_.Inverse(data);
+            } else {
+                plan_.Forward(data);
+            }
+        };
+        const auto live = [&](int k, bool zeroBeyond) { return full || (zeroBeyond ? k < n_ : Needed(k)); };
+        const int m = m_;
+        const auto xPass = [&](bool zeroBeyond) {
+            astro_parallel::SharedPool().ParallelFor(m * m, 16, [&](int begin, int end) {
+                for (int r = begin; r < end; ++r) {
+                    const int y = r % m, z = r / m;
+                    if (live(y, zeroBeyond) && live(z, zeroBeyond)) run(&grid_[Padded(0, y, z)]);
+                }
+            });
+        };
+        // Pencils along `axis` (1 = y, 2 = z) in blocks of kPencilBlock adjacent x; the
+        // y pass also skips planes whose z is not live.
+        const auto pencilPass = [&](int axis, bool zeroBeyond) {
+            const int blocks = m / kPencilBlock;
+            const int jobs = m * blocks;
+            const int tasks = Tasks();
+            astro_parallel::SharedPool().Run(tasks, [&](int t) {
+                Complex* tmp = scratch_.data() + static_cast<size_t>(t) * kPencilBlock * m;
+                for (int job = jobs * t / tasks; job < jobs * (t + 1) / tasks; ++job) {
+                    const int other = job / blocks;
+                    const int x0 = (job % blocks) * kPencilBlock;
+                    if (axis == 1 && !live(other, zeroBeyond)) continue;
+                    const auto at = [&](int x, int k) { return axis == 1 ? Padded(x, k, other) : Padded(x, other, k); };
+                    for (int k = 0; k < m; ++k) {
+                        for (int x = 0; x < kPencilBlock; ++x) tmp[static_cast<size_t>(x) * m + k] = grid_[at(x0 + x, k)];
+                    }
+                    for (int x = 0; x < kPencilBlock; ++x) run(tmp + static_cast<size_t>(x) * m);
+                    for (int k = 0; k < m; ++k) {
+                        for (int x = 0; x < kPencilBlock; ++x) grid_[at(x0 + x, k)] = tmp[static_cast<size_t>(x) * m + k];
+                    }
+                }
+            });
+        };
+        if (!inverse) {
+            xPass(true);          // rows with y, z < n
+            pencilPass(1, true);  // y pencils in the planes z < n
+            pencilPass(2, true);  // every z pencil
+        } else {
+            pencilPass(2, false);
+            pencilPass(1, false);
+            xPass(false);
+        }
+    }
+
+    void Gradient() {
+        const float scale = -0.5f / h_;
+        const auto phi = [&](int x, int y, int z) { return grid_[Padded((x + m_) % m_, (y + m_) % m_, (z + m_) % m_)].real(); };
+        astro_parallel::SharedPool().ParallelFor(n_, 1, [&](int z0, int z1) {
+            for (int z = z0; z < z1; ++z) {
+                for (int y = 0; y < n_; ++y) {
+                    for (int x = 0; x < n_; ++x) {
+                        const size_t a = Active(x, y, z);
+                        gx_[a] = scale * (phi(x + 1, y, z) - phi(x - 1, y, z));
+                        gy_[a] = scale * (phi(x, y + 1, z) - phi(x, y - 1, z));
+                        gz_[a] = scale * (phi(x, y, z + 1) - phi(x, y, z - 1));
+                    }
+                }
+            }
+        });
+    }
+
+    void Interpolate(astro_soa::ParticleSoA* p) {
+        const float inv = 1.0f / h_;
+        const float mass = static_cast<float>(gridMass_);
+        const float eps2 = h_ * h_;
+        astro_parallel::SharedPool().ParallelFor(static_cast<int>(p->size()), 1024, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                int c[3];
+                float w[3];
+                if (!Locate(p->x[i] * inv, p->y[i] * inv, p->z[i] * inv, c, w)) {
+                    const float r2 = p->x[i] * p->x[i] + p->y[i] * p->y[i] + p->z[i] * p->z[i] + eps2;
+                    const float s = -mass / (r2 * std::sqrt(r2));
+                    p->ax[i] = s * p->x[i];
+                    p->ay[i] = s * p->y[i];
+                    p->az[i] = s * p->z[i];
+                    continue;
+                }
+                float ax = 0.0f, ay = 0.0f, az = 0.0f;
+                for (int k = 0; k < 8; ++k) {
+                    const int ox = k & 1, oy = (k >> 1) & 1, oz = k >> 2;
+                    const float wk = (ox ? w[0] : 1.0f - w[0]) * (oy ? w[1] : 1.0f - w[1]) * (oz ? w[2] : 1.0f - w[2]);
+                    const size_t a = Active(std::min(c[0] + ox, n_ - 1), std::min(c[1] + oy, n_ - 1), std::min(c[2] + oz, n_ - 1));
+                    ax += wk * gx_[a];
+                    ay += wk * gy_[a];
+                    az += wk * gz_[a];
+                }
+                p->ax[i] = ax;
+                p->ay[i] = ay;
+                p->az[i] = az;
+            }
+        });
+    }
+
+    int n_ = 0;
+    int m_ = 0;
+    float halfWidth_ = 1.0f;
+    float h_ = 1.0f;
+    astro_fft::Plan1D plan_;
+    std::vector<Complex> grid_;     // padded (2n)^3 mass, then potential
+    std::vector<float> kernel_;     // transformed kernel / (2n)^3
+    std::vector<Complex> scratch_;  // one pencil block per pool thread
+    std::vector<float> partial_;    // per-task deposit grids
+    astro_soa::AlignedFloats mass_, gx_, gy_, gz_;
+    double gridMass_ = 0.0;
+    float lastMs_ = 0.0f;
+};
+
+}  // namespace astro_pm
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Short-lived particles (jet packets, streaks, burst fragments) in a fixed-capacity
+// pool. Storage is reserved once, so spawning never reallocates; a death moves the last
+// live particle into the dead one's slot, so culling is O(1) per death instead of the
+// O(n) shuffle of erase(remove_if). Iteration order is therefore not spawn order.
+// Spawns beyond capacity are dropped and counted.
+//
+//   astro_fx::ParticlePool<Spark> sparks(4096);
+//   sparks.SpawnBatch(64, [&](Spark& s, int i) { ... });
+//   sparks.Update([&](Spark& s) { s.age += dt; return s.age < s.life; });
+namespace astro_fx {
+
+template <typename T>
+class ParticlePool {
+  public:
+    explicit ParticlePool(size_t capacity = 0) { Reset(capacity); }
+
+    // Drops every particle and re-reserves `capacity` slots.
+    void Reset(size_t capacity) {
+        items_.clear();
+        items_.reserve(capacity);
+        capacity_ = capacity;
+        dropped_ = 0;
+    }
+
+    void Clear() { items_.clear(); }
+
+    bool Spawn(const T& item) {
+        if (items_.size() >= capacity_) {
+            ++dropped_;
+            return false;
+        }
+        items_.push_back(item);
+        return true;
+    }
+
+    // Up to `count` particles, each filled by init(T&, i); returns how many fit.
+    template <typename Init>
+    int SpawnBatch(int count, Init&& init) {
+        const size_t room = capacity_ - items_.size();
+        const int spawned = static_cast<int>(std::min(room, static_cast<size_t>(count > 0 ? count : 0)));
+        dropped_ += static_cast<size_t>(count - spawned);
+        for (int i = 0; i < spawned; ++i) {
+            items_.emplace_back();
+            init(items_.back(), i);
+        }
+        return spawned;
+    }
+
+    // Steps every particle; step(T&) returns false when the particle died.
+    template <typename Step>
+    void Update(Step&& step) {
+        for (size_t i = 0; i < items_.size();) {
+            if (step(items_[i])) {
+                ++i;
+            } else {
+                Kill(i);
+            }
+        }
+    }
+
+    template <typename Dead>
+    void RemoveIf(Dead&& dead) {
+        for (size_t i = 0; i < items_.size();) {
+            if (dead(static_cast<const T&>(items_[i]))) {
+                Kill(i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    size_t size() const { return items_.size(); }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return items_.empty(); }
+    size_t dropped() const { return dropped_; }
+
+    T& operator[](size_t i) { return items_[i]; }
+    const T& operator[](size_t i) const { return items_[i]; }
+    typename std::vector<T>::iterator begin() { return items_.begin(); }
+    typename std::vector<T>::iterator end() { return items_.end(); }
+    typename std::vector<T>::const_iterator begin() const { return items_.begin(); }
+    typename std::vector<T>::const_iterator end() const { return items_.end(); }
+
+  private:
+    void Kill(size_t i) {
+        if (i + 1 != items_.size()) items_[i] = std::move(items_.back());
+        items_.pop_back();
+    }
+
+    std::vector<T> items_;
+    size_t capacity_ = 0;
+    size_t dropped_ = 0;
+};
+
+}  // namespace astro_fx
@@ -0,0 +1,242 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ASTRO_SOA_AVX2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ASTRO_SOA_NEON 1
+#endif
+
+namespace astro_soa {
+
+constexpr size_t kSoaAlignment = 64;
+
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(kSoaAlignment)));
+    }
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(kSoaAlignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+using AlignedFloats = std::vector<float, AlignedAllocator<float>>;
+
+// Structure-of-arrays kinematic store. Scene-specific attributes (colour, galaxy id,
+// heat, ...) stay in the scene's own parallel arrays indexed the same way.
+struct ParticleSoA {
+    AlignedFloats x, y, z;
+    AlignedFloats vx, vy, vz;
+    AlignedFloats ax, ay, az;
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+
+    void clear() {
+        for (AlignedFloats* a : {&x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az}) a->clear();
+    }
+
+    void reserve(size_t n) {
+        for (AlignedFloats* a : {&x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az}) a->reserve(n);
+    }
+
+    void push_back(Vector3 pos, Vector3 vel) {
+        x.push_back(pos.x);
+        y.push_back(pos.y);
+        z.push_back(pos.z);
+        vx.push_back(vel.x);
+        vy.push_back(vel.y);
+        vz.push_back(vel.z);
+        ax.push_back(0.0f);
+        ay.push_back(0.0f);
+        az.push_back(0.0f);
+    }
+
+    Vector3 position(size_t i) const { return {x[i], y[i], z[i]}; }
+    Vector3 velocity(size_t i) const { return {vx[i], vy[i], vz[i]}; }
+};
+
+struct PointMass {
+    Vector3 pos;
+    float gm;  // G * mass
+};
+
+// a_i = sum_c gm_c (r_c - r_i) / (|r_c - r_i|^2 + eps^2)^(3/2), written to ax/ay/az.
+inline void TwoCenterAcceleration(ParticleSoA* p, PointMass c1, PointMass c2, float eps) {
+    const size_t n = p->size();
+    const float eps2 = eps * eps;
+    size_t i = 0;
+
+#if defined(ASTRO_SOA_AVX2)
+    const __m256 c1x = _mm256_set1_ps(c1.pos.x), c1y = _mm256_set1_ps(c1.pos.y), c1z = _mm256_set1_ps(c1.pos.z);
+    const __m256 c2x = _mm256_set1_ps(c2.pos.x), c2y = _mm256_set1_ps(c2.pos.y), c2z = _mm256_set1_ps(c2.pos.z);
+    const __m256 gm1 = _mm256_set1_ps(c1.gm), gm2 = _mm256_set1_ps(c2.gm);
+    const __m256 e2 = _mm256_set1_ps(eps2);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= n; i += 8) {
+        const __m256 px = _mm256_load_ps(p->x.data() + i);
+        const __m256 py = _mm256_load_ps(p->y.data() + i);
+        const __m256 pz = _mm256_load_ps(p->z.data() + i);
+
+        const __m256 d1x = _mm256_sub_ps(c1x, px), d1y = _mm256_sub_ps(c1y, py), d1z = _mm256_sub_ps(c1z, pz);
+        const __m256 d2x = _mm256_sub_ps(c2x, px), d2y = _mm256_sub_ps(c2y, py), d2z = _mm256_sub_ps(c2z, pz);
+        const __m256 r1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(d1x, d1x), _mm256_mul_ps(d1y, d1y)),
+                                        _mm256_add_ps(_mm256_mul_ps(d1z, d1z), e2));
+        const __m256 r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(d2x, d2x), _mm256_mul_ps(d2y, d2y)),
+                                        _mm256_add_ps(_mm256_mul_ps(d2z, d2z), e2));
+        const __m256 inv1 = _mm256_div_ps(one, _mm256_mul_ps(r1, _mm256_sqrt_ps(r1)));
+        const __m256 inv2 = _mm256_div_ps(one, _mm256_mul_ps(r2, _mm256_sqrt_ps(r2)));
+        const __m256 s1 = _mm256_mul_ps(gm1, inv1);
+        const __m256 s2 = _mm256_mul_ps(gm2, inv2);
+
+        _mm256_store_ps(p->ax.data() + i, _mm256_add_ps(_mm256_mul_ps(d1x, s1), _mm256_mul_ps(d2x, s2)));
+        _mm256_store_ps(p->ay.data() + i, _mm256_add_ps(_mm256_mul_ps(d1y, s1), _mm256_mul_ps(d2y, s2)));
+        _mm256_store_ps(p->az.data() + i, _mm256_add_ps(_mm256_mul_ps(d1z, s1), _mm256_mul_ps(d2z, s2)));
+    }
+#elif defined(ASTRO_SOA_NEON)
+    const float32x4_t c1x = vdupq_n_f32(c1.pos.x), c1y = vdupq_n_f32(c1.pos.y), c1z = vdupq_n_f32(c1.pos.z);
+    const float32x4_t c2x = vdupq_n_f32(c2.pos.x), c2y = vdupq_n_f32(c2.pos.y), c2z = vdupq_n_f32(c2.pos.z);
+    const float32x4_t gm1 = vdupq_n_f32(c1.gm), gm2 = vdupq_n_f32(c2.gm);
+    const float32x4_t e2 = vdupq_n_f32(eps2);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t px = vld1q_f32(p->x.data() + i);
+        const float32x4_t py = vld1q_f32(p->y.data() + i);
+        const float32x4_t pz = vld1q_f32(p->z.data() + i);
+
+        const float32x4_t d1x = vsubq_f32(c1x, px), d1y = vsubq_f32(c1y, py), d1z = vsubq_f32(c1z, pz);
+        const float32x4_t d2x = vsubq_f32(c2x, px), d2y = vsubq_f32(c2y, py), d2z = vsubq_f32(c2z, pz);
+        const float32x4_t r1 = vfmaq_f32(vfmaq_f32(vfmaq_f32(e2, d1x, d1x), d1y, d1y), d1z, d1z);
+        const float32x4_t r2 = vfmaq_f32(vfmaq_f32(vfmaq_f32(e2, d2x, d2x), d2y, d2y), d2z, d2z);
+        const float32x4_t s1 = vdivq_f32(gm1, vmulq_f32(r1, vsqrtq_f32(r1)));
+        const float32x4_t s2 = vdivq_f32(gm2, vmulq_f32(r2, vsqrtq_f32(r2)));
+
+        vst1q_f32(p->ax.data() + i, vfmaq_f32(vmulq_f32(d1x, s1), d2x, s2));
+        vst1q_f32(p->ay.data() + i, vfmaq_f32(vmulq_f32(d1y, s1), d2y, s2));
+        vst1q_f32(p->az.data() + i, vfmaq_f32(vmulq_f32(d1z, s1), d2z, s2));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        const float d1x = c1.pos.x - p->x[i], d1y = c1.pos.y - p->y[i], d1z = c1.pos.z - p->z[i];
+        const float d2x = c2.pos.x - p->x[i], d2y = c2.pos.y - p->y[i], d2z = c2.pos.z - p->z[i];
+        const float r1 = d1x * d1x + d1y * d1y + d1z * d1z + eps2;
+        const float r2 = d2x * d2x + d2y * d2y + d2z * d2z + eps2;
+        const float s1 = c1.gm / (r1 * std::sqrt(r1));
+        const float s2 = c2.gm / (r2 * std::sqrt(r2));
+        p->ax[i] = d1x * s1 + d2x * s2;
+        p->ay[i] = d1y * s1 + d2y * s2;
+        p->az[i] = d1z * s1 + d2z * s2;
+    }
+}
+
+// Semi-implicit Euler: v += a dt, then x += v dt (the update the demos already use).
+inline void KickDrift(ParticleSoA* p, float dt) {
+    const size_t n = p->size();
+    size_t i = 0;
+
+#if defined(ASTRO_SOA_AVX2)
+    const __m256 h = _mm256_set1_ps(dt);
+    for (; i + 8 <= n; i += 8) {
+        const __m256 vx = _mm256_add_ps(_mm256_load_ps(p->vx.data() + i), _mm256_mul_ps(_mm256_load_ps(p->ax.data() + i), h));
+        const __m256 vy = _mm256_add_ps(_mm256_load_ps(p->vy.data() + i), _mm256_mul_ps(_mm256_load_ps(p->ay.data() + i), h));
+        const __m256 vz = _mm256_add_ps(_mm256_load_ps(p->vz.data() + i), _mm256_mul_ps(_mm256_load_ps(p->az.data() + i), h));
+        _mm256_store_ps(p->vx.data() + i, vx);
+        _mm256_store_ps(p->vy.data() + i, vy);
+        _mm256_store_ps(p->vz.data() + i, vz);
+        _mm256_store_ps(p->x.data() + i, _mm256_add_ps(_mm256_load_ps(p->x.data() + i), _mm256_mul_ps(vx, h)));
+        _mm256_store_ps(p->y.data() + i, _mm256_add_ps(_mm256_load_ps(p->y.data() + i), _mm256_mul_ps(vy, h)));
+        _mm256_store_ps(p->z.data() + i, _mm256_add_ps(_mm256_load_ps(p->z.data() + i), _mm256_mul_ps(vz, h)));
+    }
+#elif defined(ASTRO_SOA_NEON)
+    const float32x4_t h = vdupq_n_f32(dt);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t vx = vfmaq_f32(vld1q_f32(p->vx.data() + i), vld1q_f32(p->ax.data() + i), h);
+        const float32x4_t vy = vfmaq_f32(vld1q_f32(p->vy.data() + i), vld1q_f32(p->ay.data() + i), h);
+        const float32x4_t vz = vfmaq_f32(vld1q_f32(p->vz.data() + i), vld1q_f32(p->az.data() + i), h);
+        vst1q_f32(p->vx.data() + i, vx);
+        vst1q_f32(p->vy.data() + i, vy);
+        vst1q_f32(p->vz.data() + i, vz);
+        vst1q_f32(p->x.data() + i, vfmaq_f32(vld1q_f32(p->x.data() + i), vx, h));
+        vst1q_f32(p->y.data() + i, vfmaq_f32(vld1q_f32(p->y.data() + i), vy, h));
+        vst1q_f32(p->z.data() + i, vfmaq_f32(vld1q_f32(p->z.data() + i), vz, h));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        p->vx[i] += p->ax[i] * dt;
+        p->vy[i] += p->ay[i] * dt;
+        p->vz[i] += p->az[i] * dt;
+        p->x[i] += p->vx[i] * dt;
+        p->y[i] += p->vy[i] * dt;
+        p->z[i] += p->vz[i] * dt;
+    }
+}
+
+// Split halves of the update for the astro_integrate drift/kick integrators.
+inline void Kick(ParticleSoA* p, float h) {
+    const size_t n = p->size();
+    for (size_t i = 0; i < n; ++i) {
+        p->vx[i] += p->ax[i] * h;
+        p->vy[i] += p->ay[i] * h;
+        p->vz[i] += p->az[i] * h;
+    }
+}
+
+inline void Drift(ParticleSoA* p, float h) {
+    const size_t n = p->size();
+    for (size_t i = 0; i < n; ++i) {
+        p->x[i] += p->vx[i] * h;
+        p->y[i] += p->vy[i] * h;
+        p->z[i] += p->vz[i] * h;
+    }
+}
+
+// Adds an externally computed acceleration field (e.g. a tree walk) into ax/ay/az.
+inline void AddAcceleration(ParticleSoA* p, const std::vector<Vector3>& extra) {
+    const size_t n = std::min(p->size(), extra.size());
+    for (size_t i = 0; i < n; ++i) {
+        p->ax[i] += extra[i].x;
+        p->ay[i] += extra[i].y;
+        p->az[i] += extra[i].z;
+    }
+}
+
+inline void GatherPositions(const ParticleSoA& p, std::vector<Vector3>* out) {
+    out->resize(p.size());
+    for (size_t i = 0; i < p.size(); ++i) (*out)[i] = {p.x[i], p.y[i], p.z[i]};
+}
+
+inline const char* SimdPathName() {
+#if defined(ASTRO_SOA_AVX2)
+    return "AVX2";
+#elif defined(ASTRO_SOA_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+}  // namespace astro_soa
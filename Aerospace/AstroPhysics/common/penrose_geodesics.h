@@ -0,0 +1,432 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Families of radial geodesics drawn in the compactified (Penrose) coordinates of a
+// black hole with two horizons or one, for the Penrose diagram demos.
+//
+// Units G = c = M = 1. Radial motion in Schwarzschild, Reissner-Nordstrom (charge Q) and
+// along the spin axis of Kerr (spin a) only sees a two-dimensional metric
+//
+//   ds^2 = -f dt^2 + dr^2 / f,   f = (r - r+)(r - r-) / g(r),   r+- = 1 +- sqrt(1 - Q^2 or a^2),
+//
+// with g = r^2, or r^2 + a^2 on the Kerr axis. The tortoise coordinate is
+// r* = r + A ln|r - r+| + B ln|r - r-| with A = g(r+) / (r+ - r-), B = -g(r-) / (r+ - r-),
+// and the outer horizon's Kruskal coordinates U = -+exp(-(t - r*) / 2A), V = exp((t + r*) / 2A)
+// cover the outside and the black-hole interior in one chart, with
+//
+//   U V = W(r) = (1 - r/r+) exp(r/A) |1 - r/r-|^(B/A).
+//
+// W is zero on the outer horizon. In Schwarzschild W = 1 at the singularity r = 0. In
+// Reissner-Nordstrom and Kerr, W goes to infinity at the inner (Cauchy) horizon. The
+// diagram point is p = atan V, q = atan U, x = (p - q) / (pi/2), y = (p + q) / (pi/2). This
+// puts the bifurcation sphere at the origin, spatial infinity at (2, 0) and future
+// timelike infinity at (1, 1). A radial light ray keeps U or V fixed, so it is a
+// straight 45-degree line.
+//
+// Timelike geodesics fall in from rest at an apex radius (bound) or from far away with
+// E > 1 (unbound). RK4 integrates them in proper time on r'' = -f'/2, and their
+// ingoing null coordinate follows v' = 1/(E - r'), which stays regular through the
+// outer horizon. Integration stops at the singularity or the Cauchy horizon. Bound
+// orbits are mirrored about their apex to get the white-hole half. Every family is
+// also mirrored into the parallel exterior, and unbound falls are time-reversed into
+// white-hole ejecta.
+//
+// BundleCache builds bundles on its own thread with a memo of recent parameter sets,
+// like astro_cr3bp::FamilyCache, so only moving the charge or spin costs a rebuild.
+
+namespace astro_penrose {
+
+enum class Metric { kSchwarzschild, kReissnerNordstrom, kKerrAxis };
+
+struct Spacetime {
+    Metric metric = Metric::kSchwarzschild;
+    double charge = 0.0;  // Q / M, Reissner-Nordstrom only, below 1
+    double spin = 0.0;    // a / M, Kerr only, below 1
+};
+
+class Chart {
+  public:
+    explicit Chart(const Spacetime& s) : spacetime_(s) {
+        const double q = s.metric == Metric::kReissnerNordstrom ? s.charge : s.metric == Metric::kKerrAxis ? s.spin : 0.0;
+        const double root = std::sqrt(std::max(1e-6, 1.0 - q * q));
+        outer_ = 1.0 + root;
+        inner_ = metric() == Metric::kSchwarzschild || q == 0.0 ? 0.0 : 1.0 - root;
+        a2_ = s.metric == Metric::kKerrAxis ? s.spin * s.spin : 0.0;
+        q2_ = s.metric == Metric::kReissnerNordstrom ? s.charge * s.charge : 0.0;
+        scale_ = G(outer_) / (outer_ - inner_);
+        innerPower_ = inner_ > 0.0 ? -G(inner_) / (outer_ - inner_) / scale_ : 0.0;
+    }
+
+    Metric metric() const { return spacetime_.metric; }
+    const Spacetime& spacetime() const { return spacetime_; }
+    double outer() const { return outer_; }
+    double inner() const { return inner_; }  // 0 when the future edge is the r = 0 singularity
+    double kappa() const { return 0.5 / scale_; }  // outer surface gravity
+    bool hasCauchyHorizon() const { return inner_ > 0.0; }
+
+    double Lapse(double r) const {
+        if (metric() == Metric::kKerrAxis) return (r * r - 2.0 * r + a2_) / (r * r + a2_);
+        return 1.0 - 2.0 / r + q2_ / (r * r);
+    }
+
+    double LapseSlope(double r) const {
+        if (metric() == Metric::kKerrAxis) {
+            const double s = r * r + a2_;
+            return 2.0 * (r * r - a2_) / (s * s);
+        }
+        return 2.0 / (r * r) - 2.0 * q2_ / (r * r * r);
+    }
+
+    // U V at radius r, for r above the inner horizon (or at r = 0 without one).
+    double Kruskal(double r) const {
+        double w = (1.0 - r / outer_) * std::exp(r / scale_);
+        if (inner_ > 0.0) w *= std::pow(std::fabs(1.0 - r / inner_), innerPower_);
+        return w;
+    }
+
+  private:
+    double G(double r) const { return r * r + a2_; }
+
+    Spacetime spacetime_;
+    double outer_ = 2.0;
+    double inner_ = 0.0;
+    double a2_ = 0.0;
+    double q2_ = 0.0;
+    double scale_ = 2.0;  // A = 1 / (2 kappa)
+    double innerPower_ = 0.0;
+};
+
+inline Vector2 Compactify(double u, double v) {
+    const double p = std::atan(v);
+    const double q = std::atan(u);
+    constexpr double kQuarter = 0.5 * 3.14159265358979323846;
+    return {static_cast<float>((p - q) / kQuarter), static_cast<float>((p + q) / kQuarter)};
+}
+
+struct BundleOptions {
+    int nullRays = 64;       // ingoing rays; outgoing and mirrored copies make four times as many
+    int apexRadii = 16;      // bound falls, apex from 1.15 r+ to 10 r+
+    int releaseTimes = 48;   // apex or start times, spread over +-3 e-folds of the horizon redshift
+    int energies = 4;        // unbound falls, E from 1.05 to 2
+    double startRadius = 40.0;
+    float minSpacing = 0.02f;  // decimation, diagram units
+};
+
+// xy is the diagram point, z a family lane in [-1, 1] (0 for light), w = r / r+.
+struct GeodesicBundle {
+    Spacetime spacetime;
+    double outer = 2.0;
+    double inner = 0.0;
+    std::vector<Vector4> vertices;
+    std::vector<uint32_t> indices;  // GL_LINES pairs
+    int nullCurves = 0;
+    int timelikeCurves = 0;
+};
+
+namespace detail {
+
+struct CurvePoint {
+    double u, v;
+    float r;
+};
+
+// Falls from r with r' = rDot <= 0 and ln V = lnV until the future edge.
+inline void Infall(const Chart& chart, double r, double rDot, double energy, double lnV, std::vector<CurvePoint>* out) {
+    constexpr double kStep = 0.02;
+    constexpr int kMaxSteps = 40000;
+    const double edge = chart.inner();
+    const double stop = chart.hasCauchyHorizon() ? edge + 1e-10 * chart.outer() : 1e-4;
+    const double k = chart.kappa();
+    auto deriv = [&](double rr, double rd, double out3[3]) {
+        out3[0] = rd;
+        out3[1] = -0.5 * chart.LapseSlope(rr);
+        out3[2] = k / (energy - rd);
+    };
+
+    out->clear();
+    for (int step = 0; step < kMaxSteps && r > stop; ++step) {
+        const double vv = std::exp(lnV);
+        out->push_back({chart.Kruskal(r) / vv, vv, static_cast<float>(r)});
+
+        const double h = kStep * std::min(r * std::sqrt(r), (r - edge) / std::max(std::fabs(rDot), 0.05));
+        double k1[3], k2[3], k3[3], k4[3];
+        deriv(r, rDot, k1);
+        deriv(r + 0.5 * h * k1[0], rDot + 0.5 * h * k1[1], k2);
+        deriv(r + 0.5 * h * k2[0], rDot + 0.5 * h * k2[1], k3);
+        deriv(r + h * k3[0], rDot + h * k3[1], k4);
+        r += h / 6.0 * (k1[0] + 2.0 * k2[0] + 2.0 * k3[0] + k4[0]);
+        rDot += h / 6.0 * (k1[1] + 2.0 * k2[1] + 2.0 * k3[1] + k4[1]);
+        lnV += h / 6.0 * (k1[2] + 2.0 * k2[2] + 2.0 * k3[2] + k4[2]);
+    }
+
+    // The last stretch is too thin in r to step through: close on the edge itself.
+    const double vv = std::exp(lnV);
+    if (chart.hasCauchyHorizon()) {
+        out->push_back({std::numeric_limits<double>::infinity(), vv, static_cast<float>(edge)});
+    } else {
+        out->push_back({chart.Kruskal(0.0) / vv, vv, 0.0f});
+    }
+}
+
+// Ingoing light ray V = v from startRadius to the future edge.
+inline void IngoingRay(const Chart& chart, double v, double startRadius, std::vector<CurvePoint>* out) {
+    constexpr int kSamples = 1024;
+    const double edge = chart.inner();
+    out->clear();
+    for (int i = kSamples; i >= 0; --i) {
+        const double s = static_cast<double>(i) / kSamples;
+        const double r = edge + (startRadius - edge) * s * s * s * s;
+        if (chart.hasCauchyHorizon() && i == 0) {
+            out->push_back({std::numeric_limits<double>::infinity(), v, static_cast<float>(edge)});
+        } else {
+            out->push_back({chart.Kruskal(r) / v, v, static_cast<float>(r)});
+        }
+    }
+}
+
+// Appends one copy of `curve` with (U, V) mapped by `map`, dropping points closer than
+// minSpacing to the last one kept.
+template <typename Map>
+void Emit(const std::vector<CurvePoint>& curve, Map&& map, float lane, float invOuter, float minSpacing, GeodesicBundle* bundle) {
+    if (curve.size() < 2) return;
+    const uint32_t first = static_cast<uint32_t>(bundle->vertices.size());
+    Vector2 last{};
+    for (size_t i = 0; i < curve.size(); ++i) {
+        const std::pair<double, double> uv = map(curve[i].u, curve[i].v);
+        const Vector2 p = Compactify(uv.first, uv.second);
+        const bool end = i + 1 == curve.size();
+        if (i > 0 && !end && std::fabs(p.x - last.x) + std::fabs(p.y - last.y) < minSpacing) continue;
+        bundle->vertices.push_back({p.x, p.y, lane, curve[i].r * invOuter});
+        last = p;
+    }
+    const uint32_t count = static_cast<uint32_t>(bundle->vertices.size()) - first;
+    for (uint32_t i = 1; i < count; ++i) {
+        bundle->indices.push_back(first + i - 1);
+        bundle->indices.push_back(first + i);
+    }
+}
+
+inline std::pair<double, double> Identity(double u, double v) { return {u, v}; }
+inline std::pair<double, double> MirrorX(double u, double v) { return {v, u}; }    // parallel exterior
+inline std::pair<double, double> MirrorT(double u, double v) { return {-v, -u}; }  // time reversal about t = 0
+inline std::pair<double, double> MirrorXT(double u, double v) { return {-u, -v}; }
+
+}  // namespace detail
+
+inline GeodesicBundle BuildBundle(const Spacetime& spacetime, const BundleOptions& options = {}) {
+    const Chart chart(spacetime);
+    GeodesicBundle bundle;
+    bundle.spacetime = spacetime;
+    bundle.outer = chart.outer();
+    bundle.inner = chart.inner();
+    const float invOuter = static_cast<float>(1.0 / chart.outer());
+    const double twoKappa = 2.0 * chart.kappa();
+    const float spacing = options.minSpacing;
+
+    std::vector<detail::CurvePoint> curve, past;
+    constexpr double kQuarter = 0.5 * 3.14159265358979323846;
+
+    for (int i = 0; i < options.nullRays; ++i) {
+        const double p = kQuarter * (static_cast<double>(i) + 0.5) / options.nullRays;
+        detail::IngoingRay(chart, std::tan(p), options.startRadius, &curve);
+        detail::Emit(curve, detail::Identity, 0.0f, invOuter, spacing, &bundle);
+        detail::Emit(curve, detail::MirrorX, 0.0f, invOuter, spacing, &bundle);
+        detail::Emit(curve, detail::MirrorT, 0.0f, invOuter, spacing, &bundle);
+        detail::Emit(curve, detail::MirrorXT, 0.0f, invOuter, spacing, &bundle);
+        bundle.nullCurves += 4;
+    }
+
+    // Release times in units of the horizon e-folding time, so every charge or spin
+    // spreads its bundle over the same part of the diagram.
+    auto releaseTime = [&](int j) {
+        return (-3.0 + 6.0 * (static_cast<double>(j) + 0.5) / options.releaseTimes) / twoKappa;
+    };
+
+    for (int k = 0; k < options.apexRadii; ++k) {
+        const double f = options.apexRadii > 1 ? static_cast<double>(k) / (options.apexRadii - 1) : 0.0;
+        const double apex = chart.outer() * 1.15 * std::pow(10.0 / 1.15, f);
+        const float lane = static_cast<float>(-1.0 + 2.0 * f);
+        const double energy = std::sqrt(chart.Lapse(apex));
+        const double w = chart.Kruskal(apex);
+        for (int j = 0; j < options.releaseTimes; ++j) {
+            const double t0 = releaseTime(j);
+            detail::Infall(chart, apex, 0.0, energy, twoKappa * 0.5 * t0 + 0.5 * std::log(-w), &curve);
+            // The fall is symmetric about the apex: (U, V) -> (-e^(-2 kappa t0) V, -e^(2 kappa t0) U).
+            const double boost = std::exp(twoKappa * t0);
+            past.clear();
+            for (size_t n = curve.size(); n-- > 1;) past.push_back({-curve[n].v / boost, -curve[n].u * boost, curve[n].r});
+            past.insert(past.end(), curve.begin(), curve.end());
+            detail::Emit(past, detail::Identity, lane, invOuter, spacing, &bundle);
+            detail::Emit(past, detail::MirrorX, -lane, invOuter, spacing, &bundle);
+            bundle.timelikeCurves += 2;
+        }
+    }
+
+    const double r0 = options.startRadius;
+    const double w0 = chart.Kruskal(r0);
+    for (int e = 0; e < options.energies; ++e) {
+        const double f = options.energies > 1 ? static_cast<double>(e) / (options.energies - 1) : 0.0;
+        const double energy = 1.05 * std::pow(2.0 / 1.05, f);
+        const float lane = static_cast<float>(-0.9 + 1.8 * f);
+        const double rDot = -std::sqrt(energy * energy - chart.Lapse(r0));
+        for (int j = 0; j < options.releaseTimes; ++j) {
+            detail::Infall(chart, r0, rDot, energy, twoKappa * 0.5 * releaseTime(j) + 0.5 * std::log(-w0), &curve);
+            detail::Emit(curve, detail::Identity, lane, invOuter, spacing, &bundle);
+            detail::Emit(curve, detail::MirrorX, -lane, invOuter, spacing, &bundle);
+            detail::Emit(curve, detail::MirrorT, lane, invOuter, spacing, &bundle);
+            detail::Emit(curve, detail::MirrorXT, -lane, invOuter, spacing, &bundle);
+            bundle.timelikeCurves += 4;
+        }
+    }
+    return bundle;
+}
+
+// Bundle builder with a small memo of recent spacetimes, answered on a worker thread.
+// Request() queues a spacetime, replacing any request not yet started; Acquire() swaps
+// in the newest finished bundle. Both belong to the render thread. Callers quantise
+// the charge or spin so a held key does not queue a rebuild every frame.
+class BundleCache {
+  public:
+    using Key = std::array<double, 2>;
+    static constexpr size_t kMemoSize = 4;  // a near-extremal bundle is about 12 MB
+
+    explicit BundleCache(const BundleOptions& options = {}) : options_(options) {}
+    BundleCache(const BundleCache&) = delete;
+    BundleCache& operator=(const BundleCache&) = delete;
+    ~BundleCache() { Stop(); }
+
+    static Key KeyOf(const Spacetime& s) {
+        const double parameter = s.metric == Metric::kReissnerNordstrom ? s.charge : s.metric == Metric::kKerrAxis ? s.spin : 0.0;
+        return {static_cast<double>(s.metric), parameter};
+    }
+
+    void Request(const Spacetime& s) {
+        const Key key = KeyOf(s);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (hasRequest_ && key == requestedKey_) return;
+            requestedKey_ = key;
+            hasRequest_ = true;
+            pendingSpacetime_ = s;
+            pending_ = true;
+            stop_ = false;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!finished_) return false;
+        front_ = std::move(finished_);
+        return true;
+    }
+
+    // Builds on the calling thread, filling the memo too.
+    void BuildNow(const Spacetime& s) {
+        std::shared_ptr<const GeodesicBundle> bundle = Lookup(KeyOf(s));
+        if (!bundle) {
+            bundle = std::make_shared<const GeodesicBundle>(BuildBundle(s, options_));
+            Remember(KeyOf(s), bundle);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        front_ = std::move(bundle);
+        requestedKey_ = KeyOf(s);
+        hasRequest_ = true;
+    }
+
+    bool Busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_ || building_;
+    }
+
+    // Nullptr until the first bundle lands.
+    const GeodesicBundle* bundle() const { return front_.get(); }
+    uint64_t built() const { return built_.load(); }
+    uint64_t memoHits() const { return memoHits_.load(); }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    std::shared_ptr<const GeodesicBundle> Lookup(const Key& key) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        for (size_t i = 0; i < memo_.size(); ++i) {
+            if (memo_[i].first != key) continue;
+            std::rotate(memo_.begin(), memo_.begin() + static_cast<std::ptrdiff_t>(i), memo_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            ++memoHits_;
+            return memo_.front().second;
+        }
+        return nullptr;
+    }
+
+    void Remember(const Key& key, std::shared_ptr<const GeodesicBundle> bundle) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        if (memo_.size() == kMemoSize) memo_.pop_back();
+        memo_.insert(memo_.begin(), {key, std::move(bundle)});
+        ++built_;
+    }
+
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            const Spacetime s = pendingSpacetime_;
+            pending_ = false;
+            building_ = true;
+            lock.unlock();
+
+            std::shared_ptr<const GeodesicBundle> bundle = Lookup(KeyOf(s));
+            if (!bundle) {
+                bundle = std::make_shared<const GeodesicBundle>(BuildBundle(s, options_));
+                Remember(KeyOf(s), bundle);
+            }
+
+            lock.lock();
+            finished_ = std::move(bundle);
+            building_ = false;
+        }
+    }
+
+    BundleOptions options_;
+    std::shared_ptr<const GeodesicBundle> front_;
+    std::shared_ptr<const GeodesicBundle> finished_;
+    Key requestedKey_{};
+    bool hasRequest_ = false;
+    Spacetime pendingSpacetime_{};
+
+    std::vector<std::pair<Key, std::shared_ptr<const GeodesicBundle>>> memo_;
+    std::mutex memoMutex_;
+    std::atomic<uint64_t> built_{0};
+    std::atomic<uint64_t> memoHits_{0};
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool pending_ = false;
+    bool building_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_penrose
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ASTRO_PHILOX_AVX2 1
+#endif
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy
+// as 1, 2, 3"). Every (counter, key) pair maps to four independent 32-bit words with no
+// state carried between calls, so worker threads can draw for any particle without
+// sharing a generator: use the particle index and its respawn count as the counter and
+// a per-stream seed as the key.
+//
+// Draw i of the stream (key, c0, c1, c2) is word i % 4 of the block at counter
+// {i / 4, c0, c1, c2}. PhiloxStream, UniformAt and FillUniform all follow that order, so
+// a sequence filled in one batch matches the same draws taken one at a time.
+
+namespace astro_random {
+
+using PhiloxCounter = std::array<uint32_t, 4>;
+using PhiloxKey = std::array<uint32_t, 2>;
+
+inline PhiloxCounter Philox4x32(PhiloxCounter ctr, PhiloxKey key) {
+    constexpr uint32_t kMul0 = 0xD2511F53u, kMul1 = 0xCD9E8D57u;
+    constexpr uint32_t kWeyl0 = 0x9E3779B9u, kWeyl1 = 0xBB67AE85u;
+    for (int round = 0; round < 10; ++round) {
+        const uint64_t p0 = static_cast<uint64_t>(kMul0) * ctr[0];
+        const uint64_t p1 = static_cast<uint64_t>(kMul1) * ctr[2];
+        ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<uint32_t>(p1),
+               static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<uint32_t>(p0)};
+        key[0] += kWeyl0;
+        key[1] += kWeyl1;
+    }
+    return ctr;
+}
+
+// Uniform in [0, 1) from the top 24 bits.
+inline float UnitFloat(uint32_t bits) { return static_cast<float>(bits >> 8) * (1.0f / 16777216.0f); }
+
+// SplitMix64 finaliser; spreads small or sequential seeds over the whole key space.
+inline uint64_t SplitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Key for a user-facing seed (e.g. a demo constant or --seed value).
+inline PhiloxKey SeedKey(uint64_t seed) {
+    const uint64_t mixed = SplitMix64(seed);
+    return {static_cast<uint32_t>(mixed), static_cast<uint32_t>(mixed >> 32)};
+}
+
+// Draw `index` of the stream (key, c0, c1, c2) without a generator object.
+inline float UniformAt(PhiloxKey key, uint64_t index, uint32_t c0 = 0, uint32_t c1 = 0, uint32_t c2 = 0) {
+    const PhiloxCounter block = Philox4x32({static_cast<uint32_t>(index >> 2), c0, c1, c2}, key);
+    return UnitFloat(block[static_cast<size_t>(index & 3u)]);
+}
+
+inline float UniformAt(uint64_t seed, uint64_t index) { return UniformAt(SeedKey(seed), index); }
+
+#if ASTRO_PHILOX_AVX2
+namespace detail {
+
+// 32x32 -> 64-bit products of all eight lanes, split into low and high words.
+inline void MulHiLo(__m256i a, __m256i mul, __m256i* lo, __m256i* hi) {
+    const __m256i even = _mm256_mul_epu32(a, mul);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), mul);
+    *lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    *hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// Eight Philox blocks at once, one per lane; words[w] holds word w of every block.
+inline void Philox4x32x8(__m256i words[4], PhiloxKey key) {
+    const __m256i mul0 = _mm256_set1_epi32(static_cast<int>(0xD2511F53u));
+    const __m256i mul1 = _mm256_set1_epi32(static_cast<int>(0xCD9E8D57u));
+    for (int round = 0; round < 10; ++round) {
+        __m256i lo0, hi0, lo1, hi1;
+        MulHiLo(words[0], mul0, &lo0, &hi0);
+        MulHiLo(words[2], mul1, &lo1, &hi1);
+        const __m256i k0 = _mm256_set1_epi32(static_cast<int>(key[0]));
+        const __m256i k1 = _mm256_set1_epi32(static_cast<int>(key[1]));
+        words[0] = _mm256_xor_si256(_mm256_xor_si256(hi1, words[1]), k0);
+        words[1] = lo1;
+        words[2] = _mm256_xor_si256(_mm256_xor_si256(hi0, words[3]), k1);
+        words[3] = lo0;
+        key[0] += 0x9E3779B9u;
+        key[1] += 0xBB67AE85u;
+    }
+}
+
+}  // namespace detail
+#endif
+
+// Fills out[0, count) with draws firstIndex, firstIndex + 1, ... of the stream
+// (key, c0, c1, c2). With AVX2 eight blocks (32 draws) are generated per pass; the
+// result is bit-identical to the scalar path.
+inline void FillUniform(PhiloxKey key, uint32_t c0, uint32_t c1, uint32_t c2, float* out, size_t count,
+                        uint64_t firstIndex = 0) {
+    size_t i = 0;
+    // Leading draws up to a block boundary.
+    while (i < count && ((firstIndex + i) & 3u) != 0) {
+        out[i] = UniformAt(key, firstIndex + i, c0, c1, c2);
+        ++i;
+    }
+#if ASTRO_PHILOX_AVX2
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 scale = _mm256_set1_ps(1.0f / 16777216.0f);
+    for (; i + 32 <= count; i += 32) {
+        const uint32_t block = static_cast<uint32_t>((firstIndex + i) >> 2);
+        __m256i words[4] = {_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(block)), lane),
+                            _mm256_set1_epi32(static_cast<int>(c0)), _mm256_set1_epi32(static_cast<int>(c1)),
+                            _mm256_set1_epi32(static_cast<int>(c2))};
+        detail::Philox4x32x8(words, key);
+        alignas(32) float unit[4][8];
+        for (int w = 0; w < 4; ++w) {
+            const __m256 f = _mm256_cvtepi32_ps(_mm256_srli_epi32(words[w], 8));
+            _mm256_store_ps(unit[w], _mm256_mul_ps(f, scale));
+        }
+        for (int b = 0; b < 8; ++b) {
+            for (int w = 0; w < 4; ++w) out[i + static_cast<size_t>(4 * b + w)] = unit[w][b];
+        }
+    }
+#endif
+    for (; i + 4 <= count; i += 4) {
+        const PhiloxCounter block = Philox4x32({static_cast<uint32_t>((firstIndex + i) >> 2), c0, c1, c2}, key);
+        for (int w = 0; w < 4; ++w) out[i + static_cast<size_t>(w)] = UnitFloat(block[static_cast<size_t>(w)]);
+    }
+    for (; i < count; ++i) out[i] = UniformAt(key, firstIndex + i, c0, c1, c2);
+}
+
+// Four uniforms per call; Next() advances the low counter word.
+class PhiloxStream {
+  public:
+    PhiloxStream(PhiloxKey key, uint32_t c0, uint32_t c1 = 0, uint32_t c2 = 0) : key_(key), ctr_{0u, c0, c1, c2} {}
+    explicit PhiloxStream(uint64_t seed, uint32_t c0 = 0) : PhiloxStream(SeedKey(seed), c0) {}
+
+    float Uniform() { return UnitFloat(Bits()); }
+
+    float Uniform(float lo, float hi) { return lo + (hi - lo) * Uniform(); }
+
+    // Integer in [lo, hi], inclusive like raylib's GetRandomValue.
+    int Range(int lo, int hi) {
+        if (hi <= lo) return lo;
+        const uint64_t span = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1u;
+        return lo + static_cast<int>((static_cast<uint64_t>(Bits()) * span) >> 32);
+    }
+
+    // Standard normal (Box-Muller; uses two draws).
+    float Normal() {
+        const float u = 1.0f - Uniform();  // (0, 1]
+        const float v = Uniform();
+        return std::sqrt(-2.0f * std::log(u)) * std::cos(6.28318530718f * v);
+    }
+
+    uint32_t Bits() {
+        if (used_ == 4) Refill();
+        return block_[used_++];
+    }
+
+  private:
+    void Refill() {
+        block_ = Philox4x32(ctr_, key_);
+        ++ctr_[0];
+        used_ = 0;
+    }
+
+    PhiloxKey key_;
+    PhiloxCounter ctr_;
+    PhiloxCounter block_{};
+    int used_ = 4;
+};
+
+}  // namespace astro_random
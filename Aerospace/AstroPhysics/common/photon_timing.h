@@ -0,0 +1,596 @@
+#pragma once
+
+#include "fft.h"
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Simulated photon-counting pulsar observation: a detector that time-tags individual
+// photons and a streaming period search that recovers the spin from them.
+//
+// PhotonSource draws Poisson arrivals whose rate follows the beam's pulse shape at the
+// spin phase phi(t) = phi0 + f (t - t0) + fdot (t - t0)^2 / 2. Time is cut into short
+// bins; each bin gets a Poisson count at its centre rate and uniform arrival times from
+// Philox, keyed by the bin index so a run is reproducible. On its own thread it follows
+// a clock the demo advances and pushes events into an SpscRing, a lock-free
+// single-producer single-consumer ring; a full ring drops events, like detector dead
+// time.
+//
+// PeriodSearch bins the events into a sliding light curve and, every searchInterval of
+// data, searches it in two stages:
+//   1. FFT of the coarsened light curve with H harmonics summed, which picks the spin
+//      frequency to within a bin.
+//   2. A Z^2_n grid over (f, fdot) around that peak. Each trial folds the light curve
+//      into a phase histogram, and Z^2_n = 2/N sum_k |sum_m h_m e^(2 pi i k m / M)|^2
+//      over the first n harmonics. Trials are split across the search's thread pool.
+// Between searches each event is folded into the live profile at the current ephemeris,
+// so the profile tracks the stream without waiting for the next search.
+
+namespace astro_photon {
+
+constexpr int kProfileBins = 64;
+constexpr int kSpectrumPoints = 256;
+constexpr int kTrialBins = 128;
+constexpr int kMaxHarmonics = 16;
+constexpr double kLockZ2 = 60.0;
+
+// Spin ephemeris; phases are in turns.
+struct SpinModel {
+    double t0 = 0.0;
+    double phase0 = 0.0;
+    double f0 = 1.0;
+    double fdot = 0.0;
+
+    double Phase(double t) const {
+        const double d = t - t0;
+        return phase0 + d * (f0 + 0.5 * fdot * d);
+    }
+    double Frequency(double t) const { return f0 + fdot * (t - t0); }
+    // Continues the same phase through t with a new spin.
+    SpinModel Reanchored(double t, double f, double fd) const { return {t, Phase(t), f, fd}; }
+};
+
+// Lock-free ring for one producer thread and one consumer thread. Capacity is rounded
+// up to a power of two.
+template <typename T>
+class SpscRing {
+  public:
+    explicit SpscRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        buffer_.resize(n);
+        mask_ = n - 1;
+    }
+
+    size_t capacity() const { return buffer_.size(); }
+    size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+    // Producer side: copies as many items as fit and returns how many.
+    size_t Push(const T* items, size_t n) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        n = std::min(n, buffer_.size() - (head - tail));
+        const size_t first = std::min(n, buffer_.size() - (head & mask_));
+        std::copy(items, items + first, buffer_.begin() + static_cast<std::ptrdiff_t>(head & mask_));
+        std::copy(items + first, items + n, buffer_.begin());
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side: moves up to `max` items out and returns how many.
+    size_t Pop(T* out, size_t max) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t n = std::min(max, head - tail);
+        const size_t first = std::min(n, buffer_.size() - (tail & mask_));
+        const auto begin = buffer_.begin() + static_cast<std::ptrdiff_t>(tail & mask_);
+        std::copy(begin, begin + static_cast<std::ptrdiff_t>(first), out);
+        std::copy(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(n - first), out + first);
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+  private:
+    std::vector<T> buffer_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+struct SourceOptions {
+    double meanRate = 1.0e7;       // photons per second averaged over a turn
+    double pulsedFraction = 0.3;   // share of them that follow the pulse shape
+    double bin = 1.0e-5;           // s; the rate is held at its bin-centre value
+    double chunk = 2.0e-3;         // s of events generated per push on the thread
+    double maxLag = 0.25;          // s behind the clock before the thread skips ahead
+    uint64_t seed = 1;
+};
+
+class PhotonSource {
+  public:
+    explicit PhotonSource(const SourceOptions& options = {}) : options_(options), key_(astro_random::SeedKey(options.seed)) {
+        shape_.assign(2, 1.0f);
+    }
+    PhotonSource(const PhotonSource&) = delete;
+    PhotonSource& operator=(const PhotonSource&) = delete;
+    ~PhotonSource() { Stop(); }
+
+    void SetModel(const SpinModel& model) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        model_ = model;
+    }
+
+    // Pulse shape sampled uniformly over one turn (any positive length).
+    void SetShape(const std::vector<float>& shape) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!shape.empty()) shape_ = shape;
+    }
+
+    // Appends the arrivals of every whole bin up to time `until` to `out`.
+    void Generate(double until, std::vector<double>* out) {
+        SpinModel model;
+        std::vector<float> shape;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            model = model_;
+            shape = shape_;
+        }
+        double mean = 0.0;
+        for (float s : shape) mean += s;
+        mean /= static_cast<double>(shape.size());
+        const double dt = options_.bin;
+        const double steady = options_.meanRate * (mean > 1.0e-6 ? 1.0 - options_.pulsedFraction : 1.0) * dt;
+        const double pulsed = mean > 1.0e-6 ? options_.meanRate * options_.pulsedFraction / mean * dt : 0.0;
+        const int64_t lastBin = static_cast<int64_t>(std::floor(until / dt));
+        for (; nextBin_ < lastBin; ++nextBin_) {
+            const double start = static_cast<double>(nextBin_) * dt;
+            const double phase = model.Phase(start + 0.5 * dt);
+            const double turn = (phase - std::floor(phase)) * static_cast<double>(shape.size());
+            const size_t i0 = std::min(static_cast<size_t>(turn), shape.size() - 1);
+            const size_t i1 = (i0 + 1) % shape.size();
+            const double f = turn - static_cast<double>(i0);
+            const double level = shape[i0] + f * (shape[i1] - shape[i0]);
+            const uint32_t lo = static_cast<uint32_t>(nextBin_), hi = static_cast<uint32_t>(nextBin_ >> 32);
+            const int count = PoissonCount(steady + pulsed * level, lo, hi);
+            uniforms_.resize(static_cast<size_t>(count));
+            astro_random::FillUniform(key_, lo, hi, 0, uniforms_.data(), uniforms_.size());
+            for (float u : uniforms_) out->push_back(start + dt * u);
+        }
+        emitted_ += out->size();
+    }
+
+    // Runs Generate() on a thread that follows AdvanceTo() and pushes into `ring`.
+    void Start(SpscRing<double>* ring) {
+        Stop();
+        stop_.store(false);
+        worker_ = std::thread([this, ring]() { Run(ring); });
+    }
+
+    void Stop() {
+        stop_.store(true);
+        if (worker_.joinable()) worker_.join();
+    }
+
+    // Restarts the event clock at t (after a reset); call with the thread stopped.
+    void Rewind(double t) {
+        nextBin_ = static_cast<int64_t>(std::floor(t / options_.bin));
+        target_.store(t);
+    }
+
+    void AdvanceTo(double t) { target_.store(t, std::memory_order_release); }
+
+    uint64_t emitted() const { return emitted_.load(); }
+    uint64_t dropped() const { return dropped_.load(); }
+    double skipped() const { return skipped_.load(); }
+
+  private:
+    // Knuth's product method for small means, a rounded normal above it.
+    int PoissonCount(double mean, uint32_t lo, uint32_t hi) const {
+        astro_random::PhiloxStream rng(key_, lo, hi, 1u);
+        if (mean > 30.0) {
+            const double n = mean + std::sqrt(mean) * rng.Normal();
+            return std::max(0, static_cast<int>(std::lround(n)));
+        }
+        const double limit = std::exp(-mean);
+        double product = 1.0 - rng.Uniform();
+        int k = 0;
+        while (product > limit) {
+            product *= 1.0 - rng.Uniform();
+            ++k;
+        }
+        return k;
+    }
+
+    void Run(SpscRing<double>* ring) {
+        std::vector<double> chunk;
+        while (!stop_.load()) {
+            const double target = target_.load(std::memory_order_acquire);
+            const double next = static_cast<double>(nextBin_) * options_.bin;
+            if (next + options_.bin > target) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+            if (target - next > options_.maxLag) {
+                const int64_t resume = static_cast<int64_t>(std::floor((target - options_.chunk) / options_.bin));
+                skipped_.store(skipped_.load() + static_cast<double>(resume - nextBin_) * options_.bin);
+                nextBin_ = resume;
+            }
+            chunk.clear();
+            Generate(std::min(target, static_cast<double>(nextBin_) * options_.bin + options_.chunk), &chunk);
+            const size_t pushed = ring->Push(chunk.data(), chunk.size());
+            dropped_ += chunk.size() - pushed;
+        }
+    }
+
+    SourceOptions options_;
+    astro_random::PhiloxKey key_;
+    int64_t nextBin_ = 0;
+    std::vector<float> uniforms_;
+
+    mutable std::mutex mutex_;
+    SpinModel model_;
+    std::vector<float> shape_;
+
+    std::thread worker_;
+    std::atomic<bool> stop_{true};
+    std::atomic<double> target_{0.0};
+    std::atomic<uint64_t> emitted_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<double> skipped_{0.0};
+};
+
+struct SearchOptions {
+    double fineBin = 1.0e-4;      // s; light-curve resolution the profile is folded from
+    int fineBins = 1 << 18;       // sliding window (about 26 s)
+    int coarseFactor = 8;         // FFT and Z^2 trials use fineBin * coarseFactor
+    double minFrequency = 0.2;    // Hz
+    double maxFrequency = 40.0;   // Hz
+    int harmonics = 4;            // FFT harmonic sum and Z^2_n
+    double maxFdot = 0.03;        // |fdot| searched, Hz/s
+    int maxFdotTrials = 81;
+    double searchInterval = 1.0;  // s of data between searches
+    double minSpan = 4.0;         // s of data before the first search
+};
+
+struct SearchSnapshot {
+    bool locked = false;
+    double frequency = 0.0;  // at epoch
+    double fdot = 0.0;
+    double epoch = 0.0;
+    double z2 = 0.0;
+    double span = 0.0;       // s of light curve in the last search
+    int trials = 0;
+    int searches = 0;
+    double searchMs = 0.0;
+    uint64_t events = 0;
+    double eventsPerSecond = 0.0;  // consumed, per wall second
+    std::array<float, kProfileBins> profile{};     // folded counts over one turn, peak 1
+    std::array<float, kSpectrumPoints> spectrum{};  // harmonic-summed power, 0..maxFrequency, peak 1
+
+    double FrequencyAt(double t) const { return frequency + fdot * (t - epoch); }
+};
+
+class PeriodSearch {
+  public:
+    explicit PeriodSearch(const SearchOptions& options = {}) : options_(options) {
+        counts_.assign(static_cast<size_t>(options_.fineBins), 0.0f);
+        coarseSize_ = options_.fineBins / options_.coarseFactor;
+        coarse_.assign(static_cast<size_t>(coarseSize_), 0.0f);
+        offsets_.assign(static_cast<size_t>(coarseSize_), 0.0);
+        fft_.assign(static_cast<size_t>(coarseSize_), astro_fft::Complex(0.0f, 0.0f));
+        plan_.Resize(coarseSize_);
+        for (int k = 0; k < kMaxHarmonics; ++k) {
+            for (int m = 0; m < kTrialBins; ++m) {
+                const double a = 6.283185307179586 * (k + 1) * (m + 0.5) / kTrialBins;
+                cos_[static_cast<size_t>(k)][static_cast<size_t>(m)] = std::cos(a);
+                sin_[static_cast<size_t>(k)][static_cast<size_t>(m)] = std::sin(a);
+            }
+        }
+        ResetState();
+    }
+    PeriodSearch(const PeriodSearch&) = delete;
+    PeriodSearch& operator=(const PeriodSearch&) = delete;
+    ~PeriodSearch() { Stop(); }
+
+    // Bins a batch of arrival times (roughly in order) and folds them into the profile.
+    void Consume(const double* times, size_t n) {
+        if (resetRequested_.exchange(false)) ResetState();
+        const int64_t mask = options_.fineBins - 1;
+        const double inv = 1.0 / options_.fineBin;
+        for (size_t i = 0; i < n; ++i) {
+            const int64_t bin = static_cast<int64_t>(std::floor(times[i] * inv));
+            if (firstBin_ < 0) firstBin_ = newestBin_ = bin;
+            if (bin > newestBin_) {
+                const int64_t clear = std::min<int64_t>(bin - newestBin_, options_.fineBins);
+                for (int64_t b = bin - clear + 1; b <= bin; ++b) counts_[static_cast<size_t>(b & mask)] = 0.0f;
+                newestBin_ = bin;
+            } else if (bin <= newestBin_ - options_.fineBins || bin < firstBin_) {
+                continue;
+            }
+            counts_[static_cast<size_t>(bin & mask)] += 1.0f;
+            if (result_.locked) {
+                const double d = times[i] - result_.epoch;
+                const double phase = d * (result_.frequency + 0.5 * result_.fdot * d);
+                live_[static_cast<size_t>((phase - std::floor(phase)) * kProfileBins) % kProfileBins] += 1.0;
+            }
+        }
+        result_.events += n;
+    }
+
+    double dataSpan() const { return firstBin_ < 0 ? 0.0 : static_cast<double>(newestBin_ - firstBin_) * options_.fineBin; }
+
+    bool Due() const {
+        const double newest = static_cast<double>(newestBin_) * options_.fineBin;
+        return dataSpan() >= options_.minSpan && newest >= lastSearch_ + options_.searchInterval;
+    }
+
+    void Search() {
+        const auto start = std::chrono::steady_clock::now();
+        const int64_t mask = options_.fineBins - 1;
+        const int64_t last = newestBin_ - 1;  // the newest bin may still be filling
+        const int64_t first = std::max(firstBin_, last - options_.fineBins + 1);
+        const int cf = options_.coarseFactor;
+        const int used = static_cast<int>(std::min<int64_t>((last - first + 1) / cf, coarseSize_));
+        if (used < 64) return;
+        const int64_t begin = last + 1 - static_cast<int64_t>(used) * cf;
+        const double coarseBin = options_.fineBin * cf;
+        const double span = used * coarseBin;
+        const double epoch = static_cast<double>(begin) * options_.fineBin + 0.5 * span;
+        double total = 0.0;
+        for (int j = 0; j < used; ++j) {
+            float sum = 0.0f;
+            for (int q = 0; q < cf; ++q) sum += counts_[static_cast<size_t>((begin + static_cast<int64_t>(j) * cf + q) & mask)];
+            coarse_[static_cast<size_t>(j)] = sum;
+            offsets_[static_cast<size_t>(j)] = (j + 0.5) * coarseBin - 0.5 * span;
+            total += sum;
+        }
+        if (total <= 0.0) return;
+
+        // Stage 1: harmonic-summed FFT power over the zero-padded light curve.
+        const float mean = static_cast<float>(total / used);
+        for (int j = 0; j < coarseSize_; ++j) {
+            fft_[static_cast<size_t>(j)] = astro_fft::Complex(j < used ? coarse_[static_cast<size_t>(j)] - mean : 0.0f, 0.0f);
+        }
+        plan_.Forward(fft_.data());
+        const int half = coarseSize_ / 2;
+        const int h = std::max(1, options_.harmonics);
+        const double df = 1.0 / (coarseSize_ * coarseBin);
+        const int kMin = std::max(1, static_cast<int>(std::ceil(options_.minFrequency / df)));
+        const int kMax = std::min((half - 1) / h, static_cast<int>(options_.maxFrequency / df));
+        if (kMax <= kMin) return;
+        std::vector<float> summed(static_cast<size_t>(kMax + 1), 0.0f);
+        int kBest = kMin;
+        for (int k = kMin; k <= kMax; ++k) {
+            float p = 0.0f;
+            for (int m = 1; m <= h; ++m) p += std::norm(fft_[static_cast<size_t>(m * k)]);
+            summed[static_cast<size_t>(k)] = p;
+            if (p > summed[static_cast<size_t>(kBest)]) kBest = k;
+        }
+
+        // Stage 2: Z^2_n over (f, fdot) around the FFT peak, folding the coarse curve.
+        const double fStep = 1.0 / (2.0 * h * span);
+        const int nf = 2 * static_cast<int>(std::ceil(1.5 * df / fStep)) + 1;
+        const double fdStep = 2.0 / (h * span * span);
+        const int nfd = std::min(options_.maxFdotTrials, 2 * static_cast<int>(std::ceil(options_.maxFdot / fdStep)) + 1);
+        const double fdSpacing = nfd > 1 ? options_.maxFdot / (nfd / 2) : 0.0;
+        double f = kBest * df, fd = 0.0, z = 0.0;
+        int trials = GridSearch(f, nf, fStep, fd, nfd, fdSpacing, used, h, total, &f, &fd, &z);
+
+        // Three halving passes of a 5x5 grid pull the peak in below the grid spacing.
+        double fs = fStep, fds = fdSpacing;
+        for (int pass = 0; pass < 3; ++pass) {
+            fs *= 0.5;
+            fds *= 0.5;
+            trials += GridSearch(f, 5, fs, fd, nfd > 1 ? 5 : 1, fds, used, h, total, &f, &fd, &z);
+        }
+
+        // Harmonic summing favours 2f or 3f when the profile has several similar peaks.
+        // A real fundamental at f/d leaves power in the harmonics that are not multiples
+        // of d; without it those hold only noise and the tails of the pulse aliased back
+        // by the phase histogram, so the test asks for a share of the main peak too and
+        // takes the divisor that leaves the most.
+        int divisor = 1;
+        double divisorZ2 = std::max(kLockZ2, 0.01 * z);
+        for (int d = 2; d <= 3; ++d) {
+            // Whole turns at f/d only: a partial turn weights one of the d sub-periods
+            // more and fakes exactly the power being tested for.
+            const int whole = static_cast<int>(std::floor(span * f / d) * d / f / coarseBin);
+            if (f / d < options_.minFrequency || whole < 64) continue;
+            double wholeTotal = 0.0;
+            for (int j = 0; j < whole; ++j) wholeTotal += coarse_[static_cast<size_t>(j)];
+            const double extra = TrialZ2(f / d, fd / d, whole, h * d, d, wholeTotal);
+            trials += 1;
+            if (extra > divisorZ2) {
+                divisor = d;
+                divisorZ2 = extra;
+            }
+        }
+        if (divisor > 1) {
+            f /= divisor;
+            fd /= divisor;
+            z = TrialZ2(f, fd, used, h, 0, total);
+        }
+
+        result_.frequency = f;
+        result_.fdot = fd;
+        result_.epoch = epoch;
+        result_.z2 = z;
+        result_.locked = result_.z2 > kLockZ2;
+        result_.span = span;
+        result_.trials = trials;
+        ++result_.searches;
+
+        // The live profile restarts from the window folded at the new ephemeris.
+        live_.fill(0.0);
+        if (result_.locked) {
+            for (int64_t b = first; b <= last; ++b) {
+                const float c = counts_[static_cast<size_t>(b & mask)];
+                if (c == 0.0f) continue;
+                const double d = (static_cast<double>(b) + 0.5) * options_.fineBin - epoch;
+                const double phase = d * (result_.frequency + 0.5 * result_.fdot * d);
+                live_[static_cast<size_t>((phase - std::floor(phase)) * kProfileBins) % kProfileBins] += c;
+            }
+        }
+        spectrum_.fill(0.0f);
+        for (int k = kMin; k <= kMax; ++k) {
+            const int point = std::min(kSpectrumPoints - 1, static_cast<int>(k * df / options_.maxFrequency * kSpectrumPoints));
+            spectrum_[static_cast<size_t>(point)] = std::max(spectrum_[static_cast<size_t>(point)], summed[static_cast<size_t>(k)]);
+        }
+        const float peak = *std::max_element(spectrum_.begin(), spectrum_.end());
+        if (peak > 0.0f)
+            for (float& s : spectrum_) s /= peak;
+        lastSearch_ = static_cast<double>(newestBin_) * options_.fineBin;
+        result_.searchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Latest result with the live profile; thread-safe while Start() runs.
+    SearchSnapshot snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return published_;
+    }
+
+    // For synchronous use (benches); the thread publishes on its own.
+    void Publish() {
+        SearchSnapshot s = result_;
+        const double peak = *std::max_element(live_.begin(), live_.end());
+        for (int b = 0; b < kProfileBins; ++b) s.profile[static_cast<size_t>(b)] = peak > 0.0 ? static_cast<float>(live_[static_cast<size_t>(b)] / peak) : 0.0f;
+        s.spectrum = spectrum_;
+        s.eventsPerSecond = rate_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        published_ = s;
+    }
+
+    // Forgets the light curve and ephemeris before the next batch (any thread).
+    void RequestReset() { resetRequested_.store(true); }
+
+    // Consumes `ring` on a worker thread, searching whenever enough new data is in.
+    void Start(SpscRing<double>* ring) {
+        Stop();
+        stop_.store(false);
+        worker_ = std::thread([this, ring]() { Run(ring); });
+    }
+
+    void Stop() {
+        stop_.store(true);
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    // Z^2 over harmonics 1..harmonics, leaving out multiples of `skip` when it is > 1.
+    double TrialZ2(double f, double fd, int used, int harmonics, int skip, double total) const {
+        std::array<double, kTrialBins> hist;
+        hist.fill(0.0);
+        for (int j = 0; j < used; ++j) {
+            const double d = offsets_[static_cast<size_t>(j)];
+            const double phase = d * (f + 0.5 * fd * d);
+            hist[static_cast<size_t>((phase - std::floor(phase)) * kTrialBins) % kTrialBins] += coarse_[static_cast<size_t>(j)];
+        }
+        double z = 0.0;
+        for (int k = 1; k <= std::min(harmonics, kMaxHarmonics); ++k) {
+            if (skip > 1 && k % skip == 0) continue;
+            double c = 0.0, s = 0.0;
+            for (int m = 0; m < kTrialBins; ++m) {
+                c += hist[static_cast<size_t>(m)] * cos_[static_cast<size_t>(k - 1)][static_cast<size_t>(m)];
+                s += hist[static_cast<size_t>(m)] * sin_[static_cast<size_t>(k - 1)][static_cast<size_t>(m)];
+            }
+            z += c * c + s * s;
+        }
+        return 2.0 * z / total;
+    }
+
+    // nf x nfd trials centred on (f, fd) across the pool; returns the trial count.
+    int GridSearch(double f, int nf, double fStep, double fd, int nfd, double fdStep, int used, int harmonics,
+                   double total, double* bestF, double* bestFd, double* bestZ) {
+        const int trials = nf * nfd;
+        trialZ2_.assign(static_cast<size_t>(trials), 0.0);
+        pool_.ParallelFor(trials, 4, [&](int t0, int t1) {
+            for (int t = t0; t < t1; ++t) {
+                trialZ2_[static_cast<size_t>(t)] =
+                    TrialZ2(f + (t % nf - nf / 2) * fStep, fd + (t / nf - nfd / 2) * fdStep, used, harmonics, 0, total);
+            }
+        });
+        const int best = static_cast<int>(std::max_element(trialZ2_.begin(), trialZ2_.end()) - trialZ2_.begin());
+        if (trialZ2_[static_cast<size_t>(best)] > *bestZ) {
+            *bestF = f + (best % nf - nf / 2) * fStep;
+            *bestFd = fd + (best / nf - nfd / 2) * fdStep;
+            *bestZ = trialZ2_[static_cast<size_t>(best)];
+        }
+        return trials;
+    }
+
+    void ResetState() {
+        std::fill(counts_.begin(), counts_.end(), 0.0f);
+        firstBin_ = -1;
+        newestBin_ = -1;
+        lastSearch_ = -1.0e30;
+        const int searches = result_.searches;
+        result_ = {};
+        result_.searches = searches;
+        live_.fill(0.0);
+        spectrum_.fill(0.0f);
+    }
+
+    void Run(SpscRing<double>* ring) {
+        std::vector<double> batch(1 << 16);
+        auto windowStart = std::chrono::steady_clock::now();
+        uint64_t windowEvents = 0;
+        auto lastPublish = windowStart;
+        while (!stop_.load()) {
+            const size_t n = ring->Pop(batch.data(), batch.size());
+            if (n == 0 && !resetRequested_.load()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            } else {
+                Consume(batch.data(), n);
+                windowEvents += n;
+            }
+            if (Due()) Search();
+            const auto now = std::chrono::steady_clock::now();
+            const double elapsed = std::chrono::duration<double>(now - windowStart).count();
+            if (elapsed >= 0.5) {
+                rate_ = windowEvents / elapsed;
+                windowEvents = 0;
+                windowStart = now;
+            }
+            if (now - lastPublish >= std::chrono::milliseconds(30)) {
+                Publish();
+                lastPublish = now;
+            }
+        }
+    }
+
+    SearchOptions options_;
+    std::vector<float> counts_;  // fine light curve, ring-indexed by bin
+    int64_t firstBin_ = -1;
+    int64_t newestBin_ = -1;
+    double lastSearch_ = 0.0;
+    int coarseSize_ = 0;
+    std::vector<float> coarse_;
+    std::vector<double> offsets_;
+    std::vector<astro_fft::Complex> fft_;
+    std::vector<double> trialZ2_;
+    std::array<std::array<double, kTrialBins>, kMaxHarmonics> cos_{};
+    std::array<std::array<double, kTrialBins>, kMaxHarmonics> sin_{};
+    astro_fft::Plan1D plan_;
+    SearchSnapshot result_;
+    std::array<double, kProfileBins> live_{};
+    std::array<float, kSpectrumPoints> spectrum_{};
+    double rate_ = 0.0;
+    astro_parallel::ThreadPool pool_;
+
+    mutable std::mutex mutex_;
+    SearchSnapshot published_;
+    std::atomic<bool> resetRequested_{false};
+    std::thread worker_;
+    std::atomic<bool> stop_{true};
+};
+
+}  // namespace astro_photon
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Binary black hole waveforms for the merger demos, in geometric units (G = c = 1, times
+// in units of the total mass M, strain times distance over M).
+//
+// The inspiral is TaylorT4: the orbital parameter x = (M omega)^(2/3) obeys
+//
+//   dx/dt = (64/5) eta x^5 [1 + a1 x + a1.5 x^1.5 + a2 x^2 + a2.5 x^2.5 + a3 x^3 + a3.5 x^3.5]
+//
+// with the non-spinning coefficients through 3.5PN and aligned spins at leading
+// spin-orbit (1.5PN, -beta) and spin-spin (2PN, +sigma) order, and d phi / dt = x^1.5.
+// It runs from x0 until the ISCO of a Kerr hole with the binary's effective spin.
+// The strain is the leading-order quadrupole h = 4 eta x (cos 2 phi, sin 2 phi), seen face on.
+//
+// The remnant's mass and spin come from fits (Tichy-Marronetti style quadratic-cubic
+// mass loss; Rezzolla et al. 2008 spin), its l = m = 2 fundamental mode from Berti,
+// Cardoso and Will (2006). The ringdown is a damped sinusoid that starts with the
+// inspiral's amplitude and phase; its frequency relaxes onto the mode's so the phase
+// has no kink where they join.
+
+namespace astro_gw {
+
+struct BinaryParams {
+    float massRatio = 1.0f;  // q = m1 / m2 >= 1
+    float spin = 0.0f;       // dimensionless spin of both holes, along L
+    float x0 = 0.075f;       // starting (M omega)^(2/3); separation about M / x0
+};
+
+struct WaveformSample {
+    float x = 0.0f;             // orbital (M omega)^(2/3), frozen after merger
+    float orbitalPhase = 0.0f;  // radians, frozen after merger
+    float hPlus = 0.0f;
+    float hCross = 0.0f;
+    float amplitude = 0.0f;
+    float gwPhase = 0.0f;
+};
+
+struct Waveform {
+    static constexpr float kSampleStep = 0.25f;  // M
+
+    BinaryParams params;
+    float eta = 0.25f;
+    float mass1 = 0.5f;  // fractions of M
+    float mass2 = 0.5f;
+    float mergerTime = 0.0f;  // end of the inspiral, M after the start
+    float finalMass = 1.0f;
+    float finalSpin = 0.0f;
+    float ringOmega = 0.0f;  // rad / M
+    float ringTau = 0.0f;    // M
+    std::vector<WaveformSample> samples;
+
+    float duration() const { return samples.empty() ? 0.0f : kSampleStep * static_cast<float>(samples.size() - 1); }
+
+    // Linear in between samples, the end values outside.
+    WaveformSample At(float t) const {
+        if (samples.empty()) return {};
+        if (samples.size() == 1) return samples.front();
+        const float u = std::clamp(t / kSampleStep, 0.0f, static_cast<float>(samples.size() - 1));
+        const size_t i = std::min(static_cast<size_t>(u), samples.size() - 2);
+        const float f = u - static_cast<float>(i);
+        const WaveformSample& a = samples[i];
+        const WaveformSample& b = samples[i + 1];
+        auto lerp = [f](float p, float q) { return p + (q - p) * f; };
+        return {lerp(a.x, b.x), lerp(a.orbitalPhase, b.orbitalPhase), lerp(a.hPlus, b.hPlus),
+                lerp(a.hCross, b.hCross), lerp(a.amplitude, b.amplitude), lerp(a.gwPhase, b.gwPhase)};
+    }
+};
+
+// Orbital x at the prograde ISCO of a Kerr hole with spin a (Bardeen, Press, Teukolsky).
+inline double KerrIscoX(double a) {
+    a = std::clamp(a, -0.998, 0.998);
+    const double z1 = 1.0 + std::cbrt(1.0 - a * a) * (std::cbrt(1.0 + a) + std::cbrt(1.0 - a));
+    const double z2 = std::sqrt(3.0 * a * a + z1 * z1);
+    const double r = 3.0 + z2 - (a >= 0.0 ? 1.0 : -1.0) * std::sqrt((3.0 - z1) * (3.0 + z1 + 2.0 * z2));
+    return std::pow(1.0 / (std::pow(r, 1.5) + a), 2.0 / 3.0);
+}
+
+class TaylorT4 {
+  public:
+    explicit TaylorT4(const BinaryParams& p) {
+        constexpr double kPi = 3.14159265358979323846;
+        constexpr double kEulerGamma = 0.57721566490153286;
+        const double q = std::max(1.0, static_cast<double>(p.massRatio));
+        m1_ = q / (1.0 + q);
+        m2_ = 1.0 / (1.0 + q);
+        eta_ = m1_ * m2_;
+        const double chi = p.spin;
+        const double e = eta_, e2 = e * e, e3 = e2 * e;
+        const double beta = chi * (113.0 / 12.0 * (m1_ * m1_ + m2_ * m2_) + 2.0 * 25.0 / 4.0 * e);
+        const double sigma = e / 48.0 * 474.0 * chi * chi;
+
+        a1_ = -(743.0 / 336.0 + 11.0 / 4.0 * e);
+        a15_ = 4.0 * kPi - beta;
+        a2_ = 34103.0 / 18144.0 + 13661.0 / 2016.0 * e + 59.0 / 18.0 * e2 + sigma;
+        a25_ = -kPi * (4159.0 / 672.0 + 189.0 / 8.0 * e);
+        a3_ = 16447322263.0 / 139708800.0 + 16.0 / 3.0 * kPi * kPi - 1712.0 / 105.0 * kEulerGamma +
+              (-56198689.0 / 217728.0 + 451.0 / 48.0 * kPi * kPi) * e + 541.0 / 896.0 * e2 - 5605.0 / 2592.0 * e3;
+        a3Log_ = -856.0 / 105.0;
+        a35_ = -kPi * (4415.0 / 4032.0 - 358675.0 / 6048.0 * e - 91495.0 / 1512.0 * e2);
+    }
+
+    double eta() const { return eta_; }
+    double mass1() const { return m1_; }
+    double mass2() const { return m2_; }
+
+    double Rate(double x) const {
+        const double sx = std::sqrt(x);
+        const double series = 1.0 + x * (a1_ + sx * (a15_ + sx * (a2_ + sx * (a25_ + sx * (a3_ + a3Log_ * std::log(16.0 * x) + sx * a35_)))));
+        return 64.0 / 5.0 * eta_ * std::pow(x, 5.0) * series;
+    }
+
+  private:
+    double m1_ = 0.5, m2_ = 0.5, eta_ = 0.25;
+    double a1_ = 0.0, a15_ = 0.0, a2_ = 0.0, a25_ = 0.0, a3_ = 0.0, a3Log_ = 0.0, a35_ = 0.0;
+};
+
+inline Waveform GenerateWaveform(const BinaryParams& params) {
+    const TaylorT4 t4(params);
+    Waveform w;
+    w.params = params;
+    w.eta = static_cast<float>(t4.eta());
+    w.mass1 = static_cast<float>(t4.mass1());
+    w.mass2 = static_cast<float>(t4.mass2());
+
+    // Remnant. The fit's (a1 + a2 q^2) / (1 + q^2) is just the spin when both are equal.
+    const double eta = t4.eta(), chi = params.spin;
+    const double aTilde = chi;
+    const double finalSpin = std::clamp(
+        aTilde + aTilde * eta * (-0.129 * aTilde - 0.384 * eta - 2.686) + eta * (2.0 * std::sqrt(3.0) - 3.454 * eta + 2.353 * eta * eta),
+        -0.998, 0.998);
+    const double finalMass = 1.0 + (std::sqrt(8.0 / 9.0) - 1.0) * eta - 0.4333 * eta * eta - 0.4392 * eta * eta * eta;
+    const double oneMinus = 1.0 - std::fabs(finalSpin);
+    const double ringOmega = (1.5251 - 1.1568 * std::pow(oneMinus, 0.1292)) / finalMass;
+    const double quality = 0.7000 + 1.4187 * std::pow(oneMinus, -0.4990);
+    w.finalMass = static_cast<float>(finalMass);
+    w.finalSpin = static_cast<float>(finalSpin);
+    w.ringOmega = static_cast<float>(ringOmega);
+    w.ringTau = static_cast<float>(2.0 * quality / ringOmega);
+
+    // Inspiral: RK4 in time, a few steps per stored sample.
+    constexpr int kSubsteps = 4;
+    const double h = Waveform::kSampleStep / kSubsteps;
+    const double xStop = std::min(KerrIscoX(chi), 0.25);
+    double x = params.x0, phi = 0.0;
+    auto push = [&](double xs, double ph) {
+        const double amp = 4.0 * eta * xs;
+        const double gw = 2.0 * ph;
+        w.samples.push_back({static_cast<float>(xs), static_cast<float>(ph), static_cast<float>(amp * std::cos(gw)),
+                             static_cast<float>(amp * std::sin(gw)), static_cast<float>(amp), static_cast<float>(gw)});
+    };
+    push(x, phi);
+    bool done = x >= xStop;
+    while (!done && w.samples.size() < 4000000) {
+        for (int s = 0; s < kSubsteps && !done; ++s) {
+            const double k1 = t4.Rate(x);
+            const double k2 = t4.Rate(x + 0.5 * h * k1);
+            const double k3 = t4.Rate(x + 0.5 * h * k2);
+            const double k4 = t4.Rate(x + h * k3);
+            const double xNext = x + h / 6.0 * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+            // d phi / dt = x^1.5 by Simpson's rule over the step.
+            const double xMid = x + 0.125 * h * (k1 - k4) + 0.5 * (xNext - x);
+            phi += h / 6.0 * (std::pow(x, 1.5) + 4.0 * std::pow(xMid, 1.5) + std::pow(xNext, 1.5));
+            // A non-positive or blown-up rate means the series has broken down: call it merger.
+            if (!(k1 > 0.0) || !std::isfinite(xNext) || xNext <= x) done = true;
+            x = std::isfinite(xNext) ? std::max(x, xNext) : x;
+            if (x >= xStop) done = true;
+        }
+        push(std::min(x, xStop), phi);
+    }
+    w.mergerTime = Waveform::kSampleStep * static_cast<float>(w.samples.size() - 1);
+
+    // Ringdown until the amplitude has fallen a thousandfold.
+    const WaveformSample end = w.samples.back();
+    const double omegaEnd = 2.0 * std::pow(static_cast<double>(end.x), 1.5);
+    const double relax = 0.5 * w.ringTau;
+    double gw = end.gwPhase;
+    const int ringSamples = static_cast<int>(std::ceil(w.ringTau * std::log(1000.0) / Waveform::kSampleStep));
+    for (int i = 1; i <= ringSamples; ++i) {
+        const double t = Waveform::kSampleStep * i;
+        const double omega = ringOmega + (omegaEnd - ringOmega) * std::exp(-t / relax);
+        gw += omega * Waveform::kSampleStep;
+        const double amp = end.amplitude * std::exp(-t / w.ringTau);
+        w.samples.push_back({end.x, end.orbitalPhase, static_cast<float>(amp * std::cos(gw)), static_cast<float>(amp * std::sin(gw)),
+                             static_cast<float>(amp), static_cast<float>(gw)});
+    }
+    return w;
+}
+
+// Background generator with a memo keyed by (mass ratio, spin), for parameter sweeps
+// that revisit the same binaries. Request() replaces any request not yet started;
+// Acquire() swaps in the newest finished waveform. Both belong to the render thread,
+// like BoundStateCache.
+class WaveformCache {
+  public:
+    using Key = std::array<float, 2>;
+    static constexpr size_t kMemoSize = 32;
+
+    WaveformCache() = default;
+    WaveformCache(const WaveformCache&) = delete;
+    WaveformCache& operator=(const WaveformCache&) = delete;
+    ~WaveformCache() { Stop(); }
+
+    static Key KeyOf(const BinaryParams& p) { return {p.massRatio, p.spin}; }
+
+    void Request(const BinaryParams& params) {
+        const Key key = KeyOf(params);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (hasRequest_ && key == requestedKey_) return;
+            requestedKey_ = key;
+            hasRequest_ = true;
+            pendingParams_ = params;
+            pending_ = true;
+            stop_ = false;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!finished_) return false;
+        front_ = std::move(finished_);
+        return true;
+    }
+
+    // Generates on the calling thread (start-up), filling the memo too.
+    void GenerateNow(const BinaryParams& params) {
+        std::shared_ptr<const Waveform> w = Lookup(KeyOf(params));
+        if (!w) {
+            w = std::make_shared<const Waveform>(GenerateWaveform(params));
+            Remember(KeyOf(params), w);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        front_ = std::move(w);
+        requestedKey_ = KeyOf(params);
+        hasRequest_ = true;
+    }
+
+    bool Busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_ || generating_;
+    }
+
+    // Nullptr until the first waveform lands.
+    const Waveform* waveform() const { return front_.get(); }
+    uint64_t generated() const { return generated_.load(); }
+    uint64_t memoHits() const { return memoHits_.load(); }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    std::shared_ptr<const Waveform> Lookup(const Key& key) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        for (size_t i = 0; i < memo_.size(); ++i) {
+            if (memo_[i].first != key) continue;
+            std::rotate(memo_.begin(), memo_.begin() + static_cast<std::ptrdiff_t>(i), memo_.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            ++memoHits_;
+            return memo_.front().second;
+        }
+        return nullptr;
+    }
+
+    void Remember(const Key& key, std::shared_ptr<const Waveform> w) {
+        std::lock_guard<std::mutex> lock(memoMutex_);
+        if (memo_.size() == kMemoSize) memo_.pop_back();
+        memo_.insert(memo_.begin(), {key, std::move(w)});
+        ++generated_;
+    }
+
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            const BinaryParams params = pendingParams_;
+            pending_ = false;
+            generating_ = true;
+            lock.unlock();
+
+            std::shared_ptr<const Waveform> w = Lookup(KeyOf(params));
+            if (!w) {
+                w = std::make_shared<const Waveform>(GenerateWaveform(params));
+                Remember(KeyOf(params), w);
+            }
+
+            lock.lock();
+            finished_ = std::move(w);
+            generating_ = false;
+        }
+    }
+
+    std::shared_ptr<const Waveform> front_;
+    std::shared_ptr<const Waveform> finished_;
+    Key requestedKey_{};
+    bool hasRequest_ = false;
+    BinaryParams pendingParams_{};
+
+    std::vector<std::pair<Key, std::shared_ptr<const Waveform>>> memo_;
+    std::mutex memoMutex_;
+    std::atomic<uint64_t> generated_{0};
+    std::atomic<uint64_t> memoHits_{0};
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool pending_ = false;
+    bool generating_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_gw
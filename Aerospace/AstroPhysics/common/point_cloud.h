@@ -0,0 +1,256 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace astro_render {
+
+// One cloud point (16 bytes).
+struct CloudPoint {
+    Vector3 pos;
+    Color color;
+};
+
+// Persistent point cloud for progressive sampling: a fixed-capacity vertex buffer that
+// Append() fills a slice at a time with glBufferSubData, so only the new points cross the
+// bus each frame and the cloud refines in place. Once full it wraps and overwrites the
+// oldest points. Draw() is one instanced call of pixel-sized soft discs at world
+// positions; wrap it in BeginBlendMode(BLEND_ADDITIVE) to read the cloud as a density.
+// Unload() must run before CloseWindow(). Without GL 3.3 Draw() falls back to DrawPoint3D
+// on the first kFallbackPoints points.
+class PointCloudBuffer {
+  public:
+    static constexpr size_t kFallbackPoints = 40000;
+
+    bool Init(size_t capacity) {
+        Unload();
+        capacity_ = capacity;
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locVertex_ = rlGetLocationAttrib(shader_, "vertexPosition");
+        locPos_ = rlGetLocationAttrib(shader_, "pointPos");
+        locColor_ = rlGetLocationAttrib(shader_, "pointColor");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locViewport_ = rlGetLocationUniform(shader_, "viewport");
+        locSize_ = rlGetLocationUniform(shader_, "size");
+        locFade_ = rlGetLocationUniform(shader_, "fade");
+
+        static constexpr std::array<float, 12> kQuad = {-1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f};
+        static constexpr std::array<unsigned short, 6> kQuadIndices = {0, 1, 2, 0, 2, 3};
+        vao_ = rlLoadVertexArray();
+        rlEnableVertexArray(vao_);
+        quadVbo_ = rlLoadVertexBuffer(kQuad.data(), static_cast<int>(sizeof(kQuad)), false);
+        rlSetVertexAttribute(static_cast<unsigned int>(locVertex_), 3, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locVertex_));
+        ebo_ = rlLoadVertexBufferElement(kQuadIndices.data(), static_cast<int>(sizeof(kQuadIndices)), false);
+
+        const int stride = static_cast<int>(sizeof(CloudPoint));
+        pointVbo_ = rlLoadVertexBuffer(nullptr, static_cast<int>(capacity_) * stride, true);
+        rlSetVertexAttribute(static_cast<unsigned int>(locPos_), 3, RL_FLOAT, false, stride, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locPos_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locPos_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locColor_), 4, RL_UNSIGNED_BYTE, true, stride,
+                             static_cast<int>(offsetof(CloudPoint, color)));
+        rlEnableVertexAttribute(static_cast<unsigned int>(locColor_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locColor_), 1);
+        rlDisableVertexArray();
+
+        ready_ = vao_ != 0 && pointVbo_ != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (pointVbo_ != 0) rlUnloadVertexBuffer(pointVbo_);
+        if (quadVbo_ != 0) rlUnloadVertexBuffer(quadVbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        pointVbo_ = quadVbo_ = ebo_ = vao_ = shader_ = 0;
+        ready_ = false;
+        Clear();
+    }
+
+    // Forgets the points; the buffer keeps its storage.
+    void Clear() {
+        count_ = 0;
+        write_ = 0;
+        fallback_.clear();
+    }
+
+    void Append(const CloudPoint* points, size_t n) {
+        if (!ready_) {
+            const size_t room = std::min(n, kFallbackPoints - std::min(kFallbackPoints, fallback_.size()));
+            fallback_.insert(fallback_.end(), points, points + room);
+            count_ = fallback_.size();
+            return;
+        }
+        if (capacity_ == 0) return;
+        if (n > capacity_) {
+            points += n - capacity_;
+            n = capacity_;
+        }
+        const size_t first = std::min(n, capacity_ - write_);
+        Upload(points, first, write_);
+        if (first < n) Upload(points + first, n - first, 0);
+        write_ = (write_ + n) % capacity_;
+        count_ = std::min(capacity_, count_ + n);
+    }
+
+    // Slot-style use for streamed data: WriteAt() overwrites n points starting at `at`
+    // without moving the ring cursor, and DrawRanges() draws only the listed runs. Don't
+    // mix with Append() on the same buffer.
+    void WriteAt(const CloudPoint* points, size_t n, size_t at) {
+        if (!ready_) {
+            if (at >= kFallbackPoints) return;
+            n = std::min(n, kFallbackPoints - at);
+            if (fallback_.size() < at + n) fallback_.resize(at + n, CloudPoint{{0.0f, 0.0f, 0.0f}, BLANK});
+            std::copy(points, points + n, fallback_.begin() + static_cast<std::ptrdiff_t>(at));
+            return;
+        }
+        if (at >= capacity_) return;
+        Upload(points, std::min(n, capacity_ - at), at);
+    }
+
+    size_t size() const { return count_; }
+    size_t capacity() const { return ready_ ? capacity_ : kFallbackPoints; }
+    bool full() const { return count_ >= capacity(); }
+    bool ready() const { return ready_; }
+
+    // `pixels` is the disc radius; `fade` multiplies each point's alpha.
+    void Draw(float pixels, float fade = 1.0f) {
+        if (count_ == 0 || fade <= 0.0f) return;
+        if (!ready_) {
+            for (const CloudPoint& p : fallback_) DrawPoint3D(p.pos, Fade(p.color, fade * p.color.a / 255.0f));
+            return;
+        }
+
+        rlDrawRenderBatchActive();
+        const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        const std::array<float, 2> viewport = {static_cast<float>(GetRenderWidth()), static_cast<float>(GetRenderHeight())};
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        rlSetUniform(locViewport_, viewport.data(), RL_SHADER_UNIFORM_VEC2, 1);
+        rlSetUniform(locSize_, &pixels, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locFade_, &fade, RL_SHADER_UNIFORM_FLOAT, 1);
+
+        rlDisableDepthMask();
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArrayElementsInstanced(0, 6, nullptr, static_cast<int>(count_));
+        rlDisableVertexArray();
+        rlEnableDepthMask();
+        rlDisableShader();
+    }
+
+    struct Range {
+        size_t first;
+        size_t count;
+    };
+
+    // One instanced draw per run; the instance attributes are re-pointed at each run's
+    // first point, since GL 3.3 has no base-instance draw.
+    void DrawRanges(const std::vector<Range>& ranges, float pixels, float fade = 1.0f) {
+        if (ranges.empty() || fade <= 0.0f) return;
+        if (!ready_) {
+            for (const Range& range : ranges) {
+                const size_t end = std::min(fallback_.size(), range.first + range.count);
+                for (size_t i = range.first; i < end; ++i) {
+                    DrawPoint3D(fallback_[i].pos, Fade(fallback_[i].color, fade * fallback_[i].color.a / 255.0f));
+                }
+            }
+            return;
+        }
+
+        rlDrawRenderBatchActive();
+        const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        const std::array<float, 2> viewport = {static_cast<float>(GetRenderWidth()), static_cast<float>(GetRenderHeight())};
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        rlSetUniform(locViewport_, viewport.data(), RL_SHADER_UNIFORM_VEC2, 1);
+        rlSetUniform(locSize_, &pixels, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locFade_, &fade, RL_SHADER_UNIFORM_FLOAT, 1);
+
+        const int stride = static_cast<int>(sizeof(CloudPoint));
+        rlDisableDepthMask();
+        rlEnableVertexArray(vao_);
+        rlEnableVertexBuffer(pointVbo_);
+        for (const Range& range : ranges) {
+            if (range.count == 0 || range.first >= capacity_) continue;
+            const int offset = static_cast<int>(range.first) * stride;
+            rlSetVertexAttribute(static_cast<unsigned int>(locPos_), 3, RL_FLOAT, false, stride, offset);
+            rlSetVertexAttribute(static_cast<unsigned int>(locColor_), 4, RL_UNSIGNED_BYTE, true, stride,
+                                 offset + static_cast<int>(offsetof(CloudPoint, color)));
+            rlDrawVertexArrayElementsInstanced(0, 6, nullptr, static_cast<int>(std::min(range.count, capacity_ - range.first)));
+        }
+        rlSetVertexAttribute(static_cast<unsigned int>(locPos_), 3, RL_FLOAT, false, stride, 0);
+        rlSetVertexAttribute(static_cast<unsigned int>(locColor_), 4, RL_UNSIGNED_BYTE, true, stride,
+                             static_cast<int>(offsetof(CloudPoint, color)));
+        rlDisableVertexBuffer();
+        rlDisableVertexArray();
+        rlEnableDepthMask();
+        rlDisableShader();
+    }
+
+  private:
+    void Upload(const CloudPoint* points, size_t n, size_t at) {
+        rlUpdateVertexBuffer(pointVbo_, points, static_cast<int>(n * sizeof(CloudPoint)), static_cast<int>(at * sizeof(CloudPoint)));
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec3 vertexPosition;
+in vec3 pointPos;
+in vec4 pointColor;
+uniform mat4 mvp;
+uniform vec2 viewport;
+uniform float size;
+uniform float fade;
+out vec4 fragColor;
+out vec2 fragLocal;
+void main() {
+    fragColor = vec4(pointColor.rgb, pointColor.a * fade);
+    fragLocal = vertexPosition.xy;
+    vec4 clip = mvp * vec4(pointPos, 1.0);
+    clip.xy += vertexPosition.xy * size * 2.0 / viewport * clip.w;
+    gl_Position = clip;
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+in vec2 fragLocal;
+out vec4 finalColor;
+void main() {
+    float r2 = dot(fragLocal, fragLocal);
+    if (r2 > 1.0) discard;
+    finalColor = vec4(fragColor.rgb, fragColor.a * (1.0 - r2));
+}
+)";
+
+    size_t capacity_ = 0;
+    size_t count_ = 0;
+    size_t write_ = 0;
+    std::vector<CloudPoint> fallback_;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int quadVbo_ = 0;
+    unsigned int ebo_ = 0;
+    unsigned int pointVbo_ = 0;
+    int locVertex_ = -1;
+    int locPos_ = -1;
+    int locColor_ = -1;
+    int locMvp_ = -1;
+    int locViewport_ = -1;
+    int locSize_ = -1;
+    int locFade_ = -1;
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
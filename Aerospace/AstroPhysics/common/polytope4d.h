@@ -0,0 +1,254 @@
+#pragma once
+
+#include "particle_soa.h"
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Regular 4D polytopes built from their Coxeter data, and a batched rotate-and-project
+// step for drawing them.
+//
+// A regular polytope {p,q,r} is the orbit of one point under the reflection group whose
+// four mirrors meet at angles pi/p, pi/q, pi/r along a chain (all other pairs at right
+// angles). The mirror normals come from a Cholesky factor of the Gram matrix
+// n_i . n_j = -cos(pi / m_ij). The generating vertex lies on mirrors 1-3 and off mirror
+// 0, and its images under the group are the vertices. Edges join vertices at the
+// distance between the generator and its reflection in mirror 0, which for a regular
+// polytope is the shortest vertex distance.
+//
+//   {3,3,3} 5-cell        5 vertices     10 edges
+//   {4,3,3} tesseract     16             32
+//   {3,3,4} 16-cell       8              24
+//   {3,4,3} 24-cell       24             96
+//   {5,3,3} 120-cell      600            1200
+//   {3,3,5} 600-cell      120            720
+//
+// Project() applies one composed 4x4 rotation and the perspective divide from a camera
+// on the w axis to every vertex, eight (AVX2) or four (NEON) lanes at a time from SoA
+// coordinates, and writes interleaved (x, y, z, w') ready to upload as a vertex buffer.
+
+namespace astro_polytope {
+
+constexpr float kCircumradius = 2.0f;
+
+struct Schlafli {
+    int p, q, r;
+};
+
+class Polytope {
+  public:
+    std::string name;
+    Schlafli symbol{4, 3, 3};
+    std::vector<uint32_t> edges;  // index pairs, two per edge
+    float edgeLength = 0.0f;
+
+    int vertexCount() const { return count_; }
+    int edgeCount() const { return static_cast<int>(edges.size() / 2); }
+    int paddedCount() const { return static_cast<int>(x_.size()); }
+    const astro_soa::AlignedFloats& x() const { return x_; }
+    const astro_soa::AlignedFloats& y() const { return y_; }
+    const astro_soa::AlignedFloats& z() const { return z_; }
+    const astro_soa::AlignedFloats& w() const { return w_; }
+
+    static Polytope Build(Schlafli symbol, const char* name);
+
+  private:
+    int count_ = 0;
+    astro_soa::AlignedFloats x_, y_, z_, w_;  // padded to a multiple of 8 with zeros
+};
+
+// Row-major 4x4 rotation acting on column vectors (x, y, z, w).
+struct Rotation4 {
+    std::array<std::array<float, 4>, 4> m{};
+
+    static Rotation4 Identity() {
+        Rotation4 r;
+        for (int i = 0; i < 4; ++i) r.m[i][i] = 1.0f;
+        return r;
+    }
+
+    // Rotation by `angle` in the plane of axes a and b (0 = x ... 3 = w).
+    static Rotation4 Plane(int a, int b, float angle) {
+        Rotation4 r = Identity();
+        const float c = std::cos(angle), s = std::sin(angle);
+        r.m[a][a] = c;
+        r.m[a][b] = -s;
+        r.m[b][a] = s;
+        r.m[b][b] = c;
+        return r;
+    }
+
+    // (this * o) applies o first.
+    Rotation4 operator*(const Rotation4& o) const {
+        Rotation4 r;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                float sum = 0.0f;
+                for (int k = 0; k < 4; ++k) sum += m[i][k] * o.m[k][j];
+                r.m[i][j] = sum;
+            }
+        }
+        return r;
+    }
+};
+
+inline Polytope Polytope::Build(Schlafli symbol, const char* name) {
+    using V = std::array<double, 4>;
+    constexpr double kPi = 3.14159265358979323846;
+    const auto dot = [](const V& a, const V& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]; };
+
+    // Gram matrix of the chain p - q - r, then its Cholesky rows are the mirror normals.
+    const int orders[3] = {symbol.p, symbol.q, symbol.r};
+    double gram[4][4] = {};
+    for (int i = 0; i < 4; ++i) gram[i][i] = 1.0;
+    for (int i = 0; i < 3; ++i) gram[i][i + 1] = gram[i + 1][i] = -std::cos(kPi / orders[i]);
+    std::array<V, 4> normal{};
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = gram[i][j];
+            for (int k = 0; k < j; ++k) sum -= normal[i][k] * normal[j][k];
+            normal[i][j] = i == j ? std::sqrt(std::max(sum, 1.0e-12)) : sum / normal[j][j];
+        }
+    }
+
+    // Generator: on mirrors 1..3, off mirror 0. The normals form a lower-triangular
+    // matrix N, so N v = e0 is a forward substitution.
+    V seed{};
+    for (int i = 0; i < 4; ++i) {
+        double rhs = i == 0 ? 1.0 : 0.0;
+        for (int k = 0; k < i; ++k) rhs -= normal[i][k] * seed[k];
+        seed[i] = rhs / normal[i][i];
+    }
+    const auto reflect = [&](const V& v, int mirror) {
+        const double d = 2.0 * dot(v, normal[mirror]);
+        return V{v[0] - d * normal[mirror][0], v[1] - d * normal[mirror][1], v[2] - d * normal[mirror][2], v[3] - d * normal[mirror][3]};
+    };
+    const auto distance2 = [](const V& a, const V& b) {
+        double s = 0.0;
+        for (int k = 0; k < 4; ++k) s += (a[k] - b[k]) * (a[k] - b[k]);
+        return s;
+    };
+
+    // Orbit by breadth-first reflection; at most 600 points, so a linear scan dedupes.
+    const double scale = kCircumradius / std::sqrt(dot(seed, seed));
+    for (double& c : seed) c *= scale;
+    const double edge2 = distance2(seed, reflect(seed, 0));
+    const double same2 = 1.0e-6 * edge2;
+    std::vector<V> vertices{seed};
+    for (size_t head = 0; head < vertices.size() && vertices.size() < 4096; ++head) {
+        for (int mirror = 0; mirror < 4; ++mirror) {
+            const V image = reflect(vertices[head], mirror);
+            bool known = false;
+            for (const V& v : vertices) {
+                if (distance2(v, image) < same2) {
+                    known = true;
+                    break;
+                }
+            }
+            if (!known) vertices.push_back(image);
+        }
+    }
+
+    Polytope poly;
+    poly.name = name;
+    poly.symbol = symbol;
+    poly.edgeLength = static_cast<float>(std::sqrt(edge2));
+    poly.count_ = static_cast<int>(vertices.size());
+    const size_t padded = (vertices.size() + 7) & ~size_t{7};
+    for (astro_soa::AlignedFloats* a : {&poly.x_, &poly.y_, &poly.z_, &poly.w_}) a->assign(padded, 0.0f);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        poly.x_[i] = static_cast<float>(vertices[i][0]);
+        poly.y_[i] = static_cast<float>(vertices[i][1]);
+        poly.z_[i] = static_cast<float>(vertices[i][2]);
+        poly.w_[i] = static_cast<float>(vertices[i][3]);
+    }
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        for (size_t j = i + 1; j < vertices.size(); ++j) {
+            if (std::fabs(distance2(vertices[i], vertices[j]) - edge2) < 1.0e-4 * edge2) {
+                poly.edges.push_back(static_cast<uint32_t>(i));
+                poly.edges.push_back(static_cast<uint32_t>(j));
+            }
+        }
+    }
+    return poly;
+}
+
+inline const std::vector<Polytope>& RegularPolytopes() {
+    static const std::vector<Polytope> all = {
+        Polytope::Build({3, 3, 3}, "5-cell"),   Polytope::Build({4, 3, 3}, "tesseract"), Polytope::Build({3, 3, 4}, "16-cell"),
+        Polytope::Build({3, 4, 3}, "24-cell"),  Polytope::Build({5, 3, 3}, "120-cell"),  Polytope::Build({3, 3, 5}, "600-cell"),
+    };
+    return all;
+}
+
+// out[i] = (x f, y f, z f, w') with (x, y, z, w') = rotation * vertex_i and
+// f = scale / (wCamera - w'). `out` is resized to paddedCount(); only the first
+// vertexCount() entries are vertices.
+inline void Project(const Polytope& poly, const Rotation4& rotation, float wCamera, float scale, std::vector<Vector4>* out) {
+    const int n = poly.paddedCount();
+    out->resize(static_cast<size_t>(n));
+    const float* xs = poly.x().data();
+    const float* ys = poly.y().data();
+    const float* zs = poly.z().data();
+    const float* ws = poly.w().data();
+    const auto& m = rotation.m;
+    int i = 0;
+#if defined(ASTRO_SOA_AVX2)
+    float* dst = reinterpret_cast<float*>(out->data());
+    __m256 r[4][4];
+    for (int a = 0; a < 4; ++a)
+        for (int b = 0; b < 4; ++b) r[a][b] = _mm256_set1_ps(m[a][b]);
+    const __m256 cam = _mm256_set1_ps(wCamera), sc = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) {
+        const __m256 x = _mm256_load_ps(xs + i), y = _mm256_load_ps(ys + i), z = _mm256_load_ps(zs + i), w = _mm256_load_ps(ws + i);
+        __m256 o[4];
+        for (int a = 0; a < 4; ++a) {
+            o[a] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[a][0], x), _mm256_mul_ps(r[a][1], y)),
+                                 _mm256_add_ps(_mm256_mul_ps(r[a][2], z), _mm256_mul_ps(r[a][3], w)));
+        }
+        const __m256 f = _mm256_div_ps(sc, _mm256_sub_ps(cam, o[3]));
+        const __m256 px = _mm256_mul_ps(o[0], f), py = _mm256_mul_ps(o[1], f), pz = _mm256_mul_ps(o[2], f);
+        // 4x8 -> 8x4 transpose into interleaved (x, y, z, w').
+        const __m256 t0 = _mm256_unpacklo_ps(px, py), t1 = _mm256_unpackhi_ps(px, py);
+        const __m256 t2 = _mm256_unpacklo_ps(pz, o[3]), t3 = _mm256_unpackhi_ps(pz, o[3]);
+        const __m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44), u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+        const __m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44), u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+        float* d = dst + 4 * i;
+        _mm256_storeu_ps(d, _mm256_permute2f128_ps(u0, u1, 0x20));
+        _mm256_storeu_ps(d + 8, _mm256_permute2f128_ps(u2, u3, 0x20));
+        _mm256_storeu_ps(d + 16, _mm256_permute2f128_ps(u0, u1, 0x31));
+        _mm256_storeu_ps(d + 24, _mm256_permute2f128_ps(u2, u3, 0x31));
+    }
+#elif defined(ASTRO_SOA_NEON)
+    float* dst = reinterpret_cast<float*>(out->data());
+    const float32x4_t cam = vdupq_n_f32(wCamera), sc = vdupq_n_f32(scale);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t x = vld1q_f32(xs + i), y = vld1q_f32(ys + i), z = vld1q_f32(zs + i), w = vld1q_f32(ws + i);
+        float32x4_t o[4];
+        for (int a = 0; a < 4; ++a) {
+            o[a] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(x, m[a][0]), y, m[a][1]), z, m[a][2]), w, m[a][3]);
+        }
+        const float32x4_t f = vdivq_f32(sc, vsubq_f32(cam, o[3]));
+        float32x4x4_t packed;
+        packed.val[0] = vmulq_f32(o[0], f);
+        packed.val[1] = vmulq_f32(o[1], f);
+        packed.val[2] = vmulq_f32(o[2], f);
+        packed.val[3] = o[3];
+        vst4q_f32(dst + 4 * i, packed);
+    }
+#endif
+    for (; i < n; ++i) {
+        float o[4];
+        for (int a = 0; a < 4; ++a) o[a] = m[a][0] * xs[i] + m[a][1] * ys[i] + m[a][2] * zs[i] + m[a][3] * ws[i];
+        const float f = scale / (wCamera - o[3]);
+        (*out)[static_cast<size_t>(i)] = {o[0] * f, o[1] * f, o[2] * f, o[3]};
+    }
+}
+
+}  // namespace astro_polytope
@@ -0,0 +1,414 @@
+#pragma once
+
+// Frame-time profiler: scoped section timers, an on-screen overlay and Chrome trace export.
+//
+//   ASTRO_PROFILE_SCOPE("physics");   times the enclosing block under "physics"
+//   ASTRO_PROFILE_FRAME();            once per frame, just before EndDrawing()
+//
+// Every demo calls ASTRO_PROFILE_FRAME(). All of it compiles to nothing unless the build
+// defines ASTRO_PROFILE=1 (the CMake option of the same name). When enabled, each thread
+// records the samples it times into its own single-producer ring, so timing a section
+// takes no lock. The frame hook drains the rings on the main thread and keeps per-section
+// history. The overlay (F3 toggles it) shows the last, mean, p50 and p99 milliseconds per
+// frame for each section, summed over threads, along with the draw calls and vertices
+// submitted through rlgl on the previous frame. If ASTRO_TRACE names a file, every sample
+// is also streamed there as Chrome trace JSON (load it in chrome://tracing or Perfetto).
+//
+// Draw counts come from wrapping the GL draw entry points raylib's GLAD loader resolved.
+// That needs those symbols to be linkable, so on other platforms the counts show as n/a.
+
+#ifndef ASTRO_PROFILE
+#define ASTRO_PROFILE 0
+#endif
+
+#if ASTRO_PROFILE
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__) && defined(__GNUC__)
+#define ASTRO_PROFILE_GL_HOOKS 1
+// GLAD's function pointers inside the raylib library. Weak, so a raylib build that does
+// not export them still links and the draw counters read n/a.
+extern "C" {
+extern __attribute__((weak)) void (*glad_glDrawArrays)(unsigned mode, int first, int count);
+extern __attribute__((weak)) void (*glad_glDrawElements)(unsigned mode, int count, unsigned type, const void* indices);
+extern __attribute__((weak)) void (*glad_glDrawArraysInstanced)(unsigned mode, int first, int count, int instances);
+extern __attribute__((weak)) void (*glad_glDrawElementsInstanced)(unsigned mode, int count, unsigned type, const void* indices,
+                                                                  int instances);
+}
+#else
+#define ASTRO_PROFILE_GL_HOOKS 0
+#endif
+
+namespace astro_profile {
+
+inline uint64_t NowNs() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+struct Sample {
+    const char* name = nullptr;
+    uint64_t beginNs = 0;
+    uint64_t endNs = 0;
+};
+
+// Samples timed on one thread. The owning thread is the only writer and the frame hook
+// the only reader, so head and tail are plain atomics; a full ring drops new samples.
+class ThreadLog {
+  public:
+    static constexpr uint32_t kCapacity = 8192;
+
+    explicit ThreadLog(int id) : id_(id) {}
+
+    int id() const { return id_; }
+
+    void Push(const char* name, uint64_t beginNs, uint64_t endNs) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring_[head % kCapacity] = {name, beginNs, endNs};
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    template <typename Fn>
+    void Drain(Fn&& fn) {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) fn(ring_[tail % kCapacity]);
+        tail_.store(tail, std::memory_order_release);
+    }
+
+    uint32_t TakeDropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+  private:
+    int id_;
+    std::atomic<uint32_t> head_{0};
+    std::atomic<uint32_t> tail_{0};
+    std::atomic<uint32_t> dropped_{0};
+    std::array<Sample, kCapacity> ring_{};
+};
+
+// Draws submitted through the hooked GL entry points; rendering is single-threaded.
+struct DrawCounters {
+    uint64_t calls = 0;
+    uint64_t vertices = 0;
+};
+
+inline DrawCounters& LiveDrawCounters() {
+    static DrawCounters counters;
+    return counters;
+}
+
+#if ASTRO_PROFILE_GL_HOOKS
+struct GlDrawOriginals {
+    void (*drawArrays)(unsigned, int, int) = nullptr;
+    void (*drawElements)(unsigned, int, unsigned, const void*) = nullptr;
+    void (*drawArraysInstanced)(unsigned, int, int, int) = nullptr;
+    void (*drawElementsInstanced)(unsigned, int, unsigned, const void*, int) = nullptr;
+};
+
+inline GlDrawOriginals& GlOriginals() {
+    static GlDrawOriginals originals;
+    return originals;
+}
+
+inline void CountedDrawArrays(unsigned mode, int first, int count) {
+    LiveDrawCounters().calls += 1;
+    LiveDrawCounters().vertices += static_cast<uint64_t>(count);
+    GlOriginals().drawArrays(mode, first, count);
+}
+
+inline void CountedDrawElements(unsigned mode, int count, unsigned type, const void* indices) {
+    LiveDrawCounters().calls += 1;
+    LiveDrawCounters().vertices += static_cast<uint64_t>(count);
+    GlOriginals().drawElements(mode, count, type, indices);
+}
+
+inline void CountedDrawArraysInstanced(unsigned mode, int first, int count, int instances) {
+    LiveDrawCounters().calls += 1;
+    LiveDrawCounters().vertices += static_cast<uint64_t>(count) * static_cast<uint64_t>(instances);
+    GlOriginals().drawArraysInstanced(mode, first, count, instances);
+}
+
+inline void CountedDrawElementsInstanced(unsigned mode, int count, unsigned type, const void* indices, int instances) {
+    LiveDrawCounters().calls += 1;
+    LiveDrawCounters().vertices += static_cast<uint64_t>(count) * static_cast<uint64_t>(instances);
+    GlOriginals().drawElementsInstanced(mode, count, type, indices, instances);
+}
+
+// Swaps the counting wrappers in once GLAD has loaded the context's entry points.
+inline bool InstallGlHooks() {
+    if (&glad_glDrawArrays == nullptr || &glad_glDrawElements == nullptr) return false;
+    if (glad_glDrawArrays == nullptr || glad_glDrawElements == nullptr) return false;
+    GlDrawOriginals& originals = GlOriginals();
+    originals.drawArrays = glad_glDrawArrays;
+    originals.drawElements = glad_glDrawElements;
+    glad_glDrawArrays = &CountedDrawArrays;
+    glad_glDrawElements = &CountedDrawElements;
+    if (&glad_glDrawArraysInstanced != nullptr && glad_glDrawArraysInstanced != nullptr) {
+        originals.drawArraysInstanced = glad_glDrawArraysInstanced;
+        glad_glDrawArraysInstanced = &CountedDrawArraysInstanced;
+    }
+    if (&glad_glDrawElementsInstanced != nullptr && glad_glDrawElementsInstanced != nullptr) {
+        originals.drawElementsInstanced = glad_glDrawElementsInstanced;
+        glad_glDrawElementsInstanced = &CountedDrawElementsInstanced;
+    }
+    return true;
+}
+#else
+inline bool InstallGlHooks() { return false; }
+#endif
+
+class Profiler {
+  public:
+    static constexpr int kHistory = 240;
+    static constexpr int kMaxSections = 48;
+
+    Profiler() {
+        const char* trace = std::getenv("ASTRO_TRACE");
+        if (trace != nullptr && trace[0] != '\0') {
+            trace_ = std::fopen(trace, "w");
+            if (trace_ != nullptr) {
+                tracePath_ = trace;
+                std::fputs("[\n", trace_);
+            } else {
+                std::fprintf(stderr, "astro_profile: cannot open %s\n", trace);
+            }
+        }
+    }
+
+    ~Profiler() {
+        if (trace_ == nullptr) return;
+        std::fputs("\n]\n", trace_);
+        std::fclose(trace_);
+        std::fprintf(stderr, "astro_profile: wrote %llu trace events to %s\n", static_cast<unsigned long long>(traceEvents_), tracePath_);
+    }
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // The calling thread's ring, registered on first use.
+    ThreadLog* LocalLog() {
+        static thread_local ThreadLog* log = nullptr;
+        if (log == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            logs_.push_back(std::make_unique<ThreadLog>(static_cast<int>(logs_.size())));
+            log = logs_.back().get();
+        }
+        return log;
+    }
+
+    // Closes the frame: drains every ring, updates the statistics, streams the trace and
+    // draws the overlay. Call from the render thread inside BeginDrawing().
+    void EndFrame() {
+        const uint64_t now = NowNs();
+        LocalLog();
+        if (!hooksTried_ && IsWindowReady()) {
+            hooksTried_ = true;
+            hooked_ = InstallGlHooks();
+        }
+        if (IsKeyPressed(KEY_F3)) visible_ = !visible_;
+
+        const int slot = frame_ % kHistory;
+        for (int s = 0; s < sectionCount_; ++s) {
+            sections_[s].ms[slot] = 0.0f;
+            sections_[s].calls = 0;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const std::unique_ptr<ThreadLog>& log : logs_) {
+                const int tid = log->id();
+                if (trace_ != nullptr && tid >= tracedThreads_) WriteThreadName(tid);
+                dropped_ += log->TakeDropped();
+                log->Drain([&](const Sample& sample) {
+                    Section* section = Find(sample.name);
+                    if (section != nullptr) {
+                        section->ms[slot] += static_cast<float>(static_cast<double>(sample.endNs - sample.beginNs) * 1.0e-6);
+                        section->calls += 1;
+                        section->lastFrame = frame_;
+                    }
+                    if (trace_ != nullptr) WriteSample(sample, tid);
+                });
+            }
+            tracedThreads_ = std::max(tracedThreads_, static_cast<int>(logs_.size()));
+        }
+
+        frameMs_[slot] = lastFrameNs_ == 0 ? 0.0f : static_cast<float>(static_cast<double>(now - lastFrameNs_) * 1.0e-6);
+        lastFrameNs_ = now;
+        const DrawCounters draws = LiveDrawCounters();
+        LiveDrawCounters() = {};
+        if (trace_ != nullptr && hooked_) {
+            BeginTraceEvent();
+            std::fprintf(trace_, "{\"name\":\"draws\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":0,\"args\":{\"calls\":%llu,\"vertices\":%llu}}",
+                         static_cast<double>(now) * 1.0e-3, static_cast<unsigned long long>(draws.calls),
+                         static_cast<unsigned long long>(draws.vertices));
+        }
+
+        if (visible_) DrawOverlay(slot, draws);
+        ++frame_;
+    }
+
+  private:
+    struct Section {
+        const char* name = nullptr;
+        std::array<float, kHistory> ms{};
+        int calls = 0;
+        int lastFrame = 0;
+    };
+
+    struct Percentiles {
+        float mean = 0.0f;
+        float p50 = 0.0f;
+        float p99 = 0.0f;
+    };
+
+    Section* Find(const char* name) {
+        for (int s = 0; s < sectionCount_; ++s) {
+            if (sections_[s].name == name || std::strcmp(sections_[s].name, name) == 0) return &sections_[s];
+        }
+        if (sectionCount_ == kMaxSections) return nullptr;
+        Section& section = sections_[sectionCount_++];
+        section.name = name;
+        section.ms.fill(0.0f);
+        return &section;
+    }
+
+    Percentiles Summarize(const std::array<float, kHistory>& history) const {
+        const int count = std::min(frame_ + 1, kHistory);
+        std::array<float, kHistory> sorted;
+        std::copy(history.begin(), history.begin() + count, sorted.begin());
+        std::sort(sorted.begin(), sorted.begin() + count);
+        Percentiles result;
+        for (int i = 0; i < count; ++i) result.mean += sorted[i];
+        result.mean /= static_cast<float>(count);
+        result.p50 = sorted[(count - 1) / 2];
+        result.p99 = sorted[std::min(count - 1, (count * 99) / 100)];
+        return result;
+    }
+
+    void DrawOverlay(int slot, const DrawCounters& draws) const {
+        constexpr int kFont = 10;
+        constexpr int kLine = 13;
+        constexpr int kWidth = 330;
+        int shown = 0;
+        for (int s = 0; s < sectionCount_; ++s) shown += frame_ - sections_[s].lastFrame < kHistory ? 1 : 0;
+        const int height = (3 + shown) * kLine + 10;
+        int x = GetScreenWidth() - kWidth - 10;
+        int y = GetScreenHeight() - height - 10;
+        DrawRectangle(x, y, kWidth, height, Fade(BLACK, 0.72f));
+        x += 6;
+        y += 5;
+
+        const Percentiles frame = Summarize(frameMs_);
+        DrawText(TextFormat("frame %6.2f ms  p50 %6.2f  p99 %6.2f  (F3)", frameMs_[slot], frame.p50, frame.p99), x, y, kFont, RAYWHITE);
+        y += kLine;
+        if (hooked_) {
+            DrawText(TextFormat("rlgl draws %llu  vertices %.1fk%s", static_cast<unsigned long long>(draws.calls),
+                                static_cast<double>(draws.vertices) * 1.0e-3, dropped_ > 0 ? "  [samples dropped]" : ""),
+                     x, y, kFont, Color{150, 214, 255, 255});
+        } else {
+            DrawText(dropped_ > 0 ? "rlgl draws n/a  [samples dropped]" : "rlgl draws n/a", x, y, kFont, Color{150, 214, 255, 255});
+        }
+        y += kLine;
+        DrawText("section              last    mean     p50     p99  calls", x, y, kFont, GRAY);
+        y += kLine;
+        for (int s = 0; s < sectionCount_; ++s) {
+            const Section& section = sections_[s];
+            if (frame_ - section.lastFrame >= kHistory) continue;
+            const Percentiles stats = Summarize(section.ms);
+            DrawText(TextFormat("%-18.18s %6.2f  %6.2f  %6.2f  %6.2f  %5d", section.name, section.ms[slot], stats.mean, stats.p50, stats.p99,
+                                section.calls),
+                     x, y, kFont, Color{236, 240, 248, 255});
+            y += kLine;
+        }
+    }
+
+    // Writes the separator before the next event, so the file stays valid JSON once the
+    // closing bracket is written.
+    void BeginTraceEvent() {
+        std::fputs(traceEvents_ == 0 ? "" : ",\n", trace_);
+        ++traceEvents_;
+    }
+
+    void WriteThreadName(int tid) {
+        BeginTraceEvent();
+        std::fprintf(trace_, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}", tid,
+                     tid == 0 ? "main" : "thread", tid);
+    }
+
+    void WriteSample(const Sample& sample, int tid) {
+        BeginTraceEvent();
+        std::fputs("{\"name\":\"", trace_);
+        for (const char* c = sample.name; *c != '\0'; ++c) {
+            if (*c == '"' || *c == '\\') std::fputc('\\', trace_);
+            std::fputc(*c, trace_);
+        }
+        std::fprintf(trace_, "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d}", static_cast<double>(sample.beginNs) * 1.0e-3,
+                     static_cast<double>(sample.endNs - sample.beginNs) * 1.0e-3, tid);
+    }
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadLog>> logs_;
+    std::array<Section, kMaxSections> sections_{};
+    int sectionCount_ = 0;
+    std::array<float, kHistory> frameMs_{};
+    uint64_t lastFrameNs_ = 0;
+    int frame_ = 0;
+    uint64_t dropped_ = 0;
+    bool visible_ = true;
+    bool hooksTried_ = false;
+    bool hooked_ = false;
+    FILE* trace_ = nullptr;
+    const char* tracePath_ = "";
+    uint64_t traceEvents_ = 0;
+    int tracedThreads_ = 0;
+};
+
+inline Profiler& SharedProfiler() {
+    static Profiler profiler;
+    return profiler;
+}
+
+// Times its scope into the calling thread's ring. `name` must outlive the profiler
+// (a string literal, or a name owned for the whole run).
+class ScopedTimer {
+  public:
+    explicit ScopedTimer(const char* name) : name_(name), beginNs_(NowNs()) {}
+    ~ScopedTimer() { SharedProfiler().LocalLog()->Push(name_, beginNs_, NowNs()); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  private:
+    const char* name_;
+    uint64_t beginNs_;
+};
+
+}  // namespace astro_profile
+
+#define ASTRO_PROFILE_CONCAT_INNER(a, b) a##b
+#define ASTRO_PROFILE_CONCAT(a, b) ASTRO_PROFILE_CONCAT_INNER(a, b)
+#define ASTRO_PROFILE_SCOPE(name) const astro_profile::ScopedTimer ASTRO_PROFILE_CONCAT(astroProfileScope, __LINE__)(name)
+#define ASTRO_PROFILE_FRAME() astro_profile::SharedProfiler().EndFrame()
+
+#else
+
+#define ASTRO_PROFILE_SCOPE(name) ((void)0)
+#define ASTRO_PROFILE_FRAME() ((void)0)
+
+#endif
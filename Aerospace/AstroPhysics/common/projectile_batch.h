@@ -0,0 +1,397 @@
+#pragma once
+
+#include "particle_soa.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Batched projectile flights under gravity, quadratic drag and a steady horizontal wind,
+//
+//   dv/dt = g - k |v - w| (v - w),
+//
+// stepped with the same semi-implicit Euler as projectile_drag_viz at a fixed step, so
+// a shot the solver finds is exactly the one the demo then flies. Candidates are SoA
+// columns integrated 8 (AVX2) or 4 (NEON) lanes at a time until every lane has come down
+// through y = 0; the landing point and time are interpolated inside the last step.
+//
+// AimSolver is a shooting method over elevation, azimuth and speed. Each iteration flies
+// a grid of a few thousand launches around the current best, keeps the slowest one
+// landing within a tolerance of the target (or the closest, if none does), and shrinks
+// the grid around it. The least launch speed is chosen because at any speed above it a
+// two-parameter launch has a whole curve of solutions; with wind the azimuth is a free
+// parameter too, since a crosswind carries the shell off its launch bearing.
+
+namespace astro_ballistics {
+
+struct Ballistics {
+    float gravity = 9.81f;
+    float drag = 0.08f;  // k, per metre
+    float windX = 0.0f;
+    float windZ = 0.0f;
+    float dt = 1.0f / 240.0f;
+    float maxTime = 12.0f;  // flights still airborne after this count as misses
+};
+
+struct Launch {
+    float elevation = 0.0f;  // radians above the horizon
+    float azimuth = 0.0f;    // radians from +x towards +z
+    float speed = 0.0f;
+};
+
+inline void LaunchVelocity(const Launch& launch, float* vx, float* vy, float* vz) {
+    const float horizontal = launch.speed * std::cos(launch.elevation);
+    *vx = horizontal * std::cos(launch.azimuth);
+    *vy = launch.speed * std::sin(launch.elevation);
+    *vz = horizontal * std::sin(launch.azimuth);
+}
+
+// One step of the shared integrator.
+inline void Step(const Ballistics& b, float* p, float* v) {
+    const float rx = v[0] - b.windX, ry = v[1], rz = v[2] - b.windZ;
+    const float kS = b.drag * std::sqrt(rx * rx + ry * ry + rz * rz);
+    v[0] -= kS * rx * b.dt;
+    v[1] += (-b.gravity - kS * ry) * b.dt;
+    v[2] -= kS * rz * b.dt;
+    p[0] += v[0] * b.dt;
+    p[1] += v[1] * b.dt;
+    p[2] += v[2] * b.dt;
+}
+
+// Calls emit(x, y, z) at the start and after every `stride` steps until the shell lands;
+// the last point is the interpolated landing point. Returns the flight time, or a
+// negative value if it was still airborne at maxTime.
+template <typename Emit>
+float TracePath(const Ballistics& b, const float origin[3], const Launch& launch, int stride, Emit&& emit) {
+    float p[3] = {origin[0], origin[1], origin[2]};
+    float v[3];
+    LaunchVelocity(launch, &v[0], &v[1], &v[2]);
+    emit(p[0], p[1], p[2]);
+    const int steps = static_cast<int>(b.maxTime / b.dt);
+    for (int s = 1; s <= steps; ++s) {
+        const float prev[3] = {p[0], p[1], p[2]};
+        Step(b, p, v);
+        if (p[1] <= 0.0f) {
+            const float f = prev[1] / std::max(prev[1] - p[1], 1.0e-12f);
+            emit(prev[0] + f * (p[0] - prev[0]), 0.0f, prev[2] + f * (p[2] - prev[2]));
+            return (static_cast<float>(s - 1) + f) * b.dt;
+        }
+        if (s % std::max(1, stride) == 0) emit(p[0], p[1], p[2]);
+    }
+    return -1.0f;
+}
+
+class TrajectoryBatch {
+  public:
+    static constexpr int kParallelFlights = 512;
+
+    void Resize(int count) {
+        count_ = std::max(0, count);
+        const size_t padded = (static_cast<size_t>(count_) + 7) & ~size_t{7};
+        for (auto* column : {&vx_, &vy_, &vz_, &landX_, &landZ_, &time_}) column->assign(padded, 0.0f);
+    }
+
+    int size() const { return count_; }
+
+    void SetLaunch(int i, const Launch& launch) {
+        const size_t n = static_cast<size_t>(i);
+        LaunchVelocity(launch, &vx_[n], &vy_[n], &vz_[n]);
+    }
+
+    float landX(int i) const { return landX_[static_cast<size_t>(i)]; }
+    float landZ(int i) const { return landZ_[static_cast<size_t>(i)]; }
+    // Negative when the flight had not landed by maxTime.
+    float time(int i) const { return time_[static_cast<size_t>(i)]; }
+
+    // Flies every launch from `origin` (y > 0) down to the ground.
+    void Integrate(const Ballistics& b, const float origin[3]) {
+        const int blocks = static_cast<int>(vx_.size() / 8);
+        auto body = [&](int begin, int end) {
+            for (int block = begin; block < end; ++block) FlyBlock(b, origin, static_cast<size_t>(block) * 8);
+        };
+        if (count_ >= kParallelFlights) {
+            astro_parallel::SharedPool().ParallelFor(blocks, 4, body);
+        } else {
+            body(0, blocks);
+        }
+    }
+
+  private:
+    // Eight lanes starting at `first`: one AVX2 register or two NEON registers wide.
+    void FlyBlock(const Ballistics& b, const float origin[3], size_t first) {
+        const int steps = static_cast<int>(b.maxTime / b.dt);
+#if defined(ASTRO_SOA_AVX2)
+        const __m256 dt = _mm256_set1_ps(b.dt), k = _mm256_set1_ps(b.drag), g = _mm256_set1_ps(b.gravity * b.dt);
+        const __m256 wx = _mm256_set1_ps(b.windX), wz = _mm256_set1_ps(b.windZ), zero = _mm256_setzero_ps();
+        __m256 px = _mm256_set1_ps(origin[0]), py = _mm256_set1_ps(origin[1]), pz = _mm256_set1_ps(origin[2]);
+        __m256 vx = _mm256_loadu_ps(&vx_[first]), vy = _mm256_loadu_ps(&vy_[first]), vz = _mm256_loadu_ps(&vz_[first]);
+        __m256 landX = zero, landZ = zero, landT = _mm256_set1_ps(-1.0f);
+        __m256 flying = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int s = 0; s < steps && _mm256_movemask_ps(flying) != 0; ++s) {
+            const __m256 rx = _mm256_sub_ps(vx, wx), rz = _mm256_sub_ps(vz, wz);
+            const __m256 speed2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(rz, rz));
+            const __m256 kSdt = _mm256_mul_ps(_mm256_mul_ps(k, _mm256_sqrt_ps(speed2)), dt);
+            vx = _mm256_sub_ps(vx, _mm256_mul_ps(kSdt, rx));
+            vy = _mm256_sub_ps(_mm256_sub_ps(vy, g), _mm256_mul_ps(kSdt, vy));
+            vz = _mm256_sub_ps(vz, _mm256_mul_ps(kSdt, rz));
+            const __m256 nx = _mm256_add_ps(px, _mm256_mul_ps(vx, dt));
+            const __m256 ny = _mm256_add_ps(py, _mm256_mul_ps(vy, dt));
+            const __m256 nz = _mm256_add_ps(pz, _mm256_mul_ps(vz, dt));
+            const __m256 down = _mm256_and_ps(flying, _mm256_cmp_ps(ny, zero, _CMP_LE_OQ));
+            if (_mm256_movemask_ps(down) != 0) {
+                const __m256 f = _mm256_div_ps(py, _mm256_max_ps(_mm256_sub_ps(py, ny), _mm256_set1_ps(1.0e-12f)));
+                landX = _mm256_blendv_ps(landX, _mm256_add_ps(px, _mm256_mul_ps(f, _mm256_sub_ps(nx, px))), down);
+                landZ = _mm256_blendv_ps(landZ, _mm256_add_ps(pz, _mm256_mul_ps(f, _mm256_sub_ps(nz, pz))), down);
+                landT = _mm256_blendv_ps(landT, _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(s)), f), dt), down);
+                flying = _mm256_andnot_ps(down, flying);
+            }
+            px = nx;
+            py = ny;
+            pz = nz;
+        }
+        _mm256_storeu_ps(&landX_[first], landX);
+        _mm256_storeu_ps(&landZ_[first], landZ);
+        _mm256_storeu_ps(&time_[first], landT);
+#elif defined(ASTRO_SOA_NEON)
+        for (size_t half = first; half < first + 8; half += 4) {
+            const float32x4_t dt = vdupq_n_f32(b.dt), k = vdupq_n_f32(b.drag), g = vdupq_n_f32(b.gravity * b.dt);
+            const float32x4_t wx = vdupq_n_f32(b.windX), wz = vdupq_n_f32(b.windZ), zero = vdupq_n_f32(0.0f);
+            float32x4_t px = vdupq_n_f32(origin[0]), py = vdupq_n_f32(origin[1]), pz = vdupq_n_f32(origin[2]);
+            float32x4_t vx = vld1q_f32(&vx_[half]), vy = vld1q_f32(&vy_[half]), vz = vld1q_f32(&vz_[half]);
+            float32x4_t landX = zero, landZ = zero, landT = vdupq_n_f32(-1.0f);
+            uint32x4_t flying = vdupq_n_u32(0xffffffffu);
+            for (int s = 0; s < steps && vmaxvq_u32(flying) != 0; ++s) {
+                const float32x4_t rx = vsubq_f32(vx, wx), rz = vsubq_f32(vz, wz);
+                const float32x4_t speed2 = vfmaq_f32(vfmaq_f32(vmulq_f32(rx, rx), vy, vy), rz, rz);
+                const float32x4_t kSdt = vmulq_f32(vmulq_f32(k, vsqrtq_f32(speed2)), dt);
+                vx = vmlsq_f32(vx, kSdt, rx);
+                vy = vmlsq_f32(vsubq_f32(vy, g), kSdt, vy);
+                vz = vmlsq_f32(vz, kSdt, rz);
+                const float32x4_t nx = vfmaq_f32(px, vx, dt);
+                const float32x4_t ny = vfmaq_f32(py, vy, dt);
+                const float32x4_t nz = vfmaq_f32(pz, vz, dt);
+                const uint32x4_t down = vandq_u32(flying, vcleq_f32(ny, zero));
+                if (vmaxvq_u32(down) != 0) {
+                    const float32x4_t f = vdivq_f32(py, vmaxq_f32(vsubq_f32(py, ny), vdupq_n_f32(1.0e-12f)));
+                    landX = vbslq_f32(down, vfmaq_f32(px, f, vsubq_f32(nx, px)), landX);
+                    landZ = vbslq_f32(down, vfmaq_f32(pz, f, vsubq_f32(nz, pz)), landZ);
+                    landT = vbslq_f32(down, vmulq_f32(vaddq_f32(vdupq_n_f32(static_cast<float>(s)), f), dt), landT);
+                    flying = vbicq_u32(flying, down);
+                }
+                px = nx;
+                py = ny;
+                pz = nz;
+            }
+            vst1q_f32(&landX_[half], landX);
+            vst1q_f32(&landZ_[half], landZ);
+            vst1q_f32(&time_[half], landT);
+        }
+#else
+        for (size_t n = first; n < first + 8; ++n) {
+            float p[3] = {origin[0], origin[1], origin[2]};
+            float v[3] = {vx_[n], vy_[n], vz_[n]};
+            landX_[n] = landZ_[n] = 0.0f;
+            time_[n] = -1.0f;
+            for (int s = 0; s < steps; ++s) {
+                const float prev[3] = {p[0], p[1], p[2]};
+                Step(b, p, v);
+                if (p[1] <= 0.0f) {
+                    const float f = prev[1] / std::max(prev[1] - p[1], 1.0e-12f);
+                    landX_[n] = prev[0] + f * (p[0] - prev[0]);
+                    landZ_[n] = prev[2] + f * (p[2] - prev[2]);
+                    time_[n] = (static_cast<float>(s) + f) * b.dt;
+                    break;
+                }
+            }
+        }
+#endif
+    }
+
+    int count_ = 0;
+    std::vector<float> vx_, vy_, vz_;
+    std::vector<float> landX_, landZ_, time_;
+};
+
+struct AimResult {
+    Launch launch;
+    bool hit = false;         // landed within tolerance of the target at no more than maxSpeed
+    float miss = 0.0f;        // landing distance from the target
+    float flightTime = 0.0f;
+    int flights = 0;          // trajectories integrated, all iterations
+};
+
+struct AimOptions {
+    float maxSpeed = 30.0f;
+    float tolerance = 0.01f;     // landing error counted as a hit
+    int elevations = 512;        // Newton lanes per round, three flights each per iteration
+    int newtonIterations = 7;
+    int rounds = 2;              // each round spans a few lane spacings around the last best
+    float minElevation = 0.02f;  // radians
+    float maxElevation = 1.45f;
+};
+
+class AimSolver {
+  public:
+    AimResult Solve(const Ballistics& b, const float origin[3], float targetX, float targetZ, const AimOptions& options) {
+        const float dx = targetX - origin[0], dz = targetZ - origin[2];
+        const float distance = std::max(std::sqrt(dx * dx + dz * dz), 1.0e-3f);
+        const float bearing = std::atan2(dz, dx);
+        const int count = std::max(1, options.elevations);
+        lanes_.resize(static_cast<size_t>(count));
+
+        AimResult result;
+        float lo = options.minElevation, hi = options.maxElevation;
+        bool found = false;
+        for (int round = 0; round < std::max(1, options.rounds); ++round) {
+            for (int e = 0; e < count; ++e) {
+                Lane& lane = lanes_[static_cast<size_t>(e)];
+                lane.launch.elevation = Lerp(lo, hi, e, count);
+                lane.launch.azimuth = bearing;
+                // Vacuum speed for the range, a fair start with or without drag.
+                const float lift = std::max(std::sin(2.0f * lane.launch.elevation), 0.05f);
+                lane.launch.speed = std::min(std::sqrt(b.gravity * distance / lift), kSpeedCeiling * options.maxSpeed);
+            }
+            for (int iteration = 0; iteration < options.newtonIterations; ++iteration) {
+                NewtonStep(b, origin, targetX, targetZ, options, iteration + 1 == options.newtonIterations);
+                result.flights += batch_.size();
+            }
+
+            // The slowest lane that converged onto the target.
+            int best = -1;
+            for (int e = 0; e < count; ++e) {
+                const Lane& lane = lanes_[static_cast<size_t>(e)];
+                if (lane.time < 0.0f || lane.miss > options.tolerance || lane.launch.speed > options.maxSpeed) continue;
+                if (best < 0 || lane.launch.speed < lanes_[static_cast<size_t>(best)].launch.speed) best = e;
+            }
+            if (best < 0) break;
+            const Lane& lane = lanes_[static_cast<size_t>(best)];
+            result.launch = lane.launch;
+            result.miss = lane.miss;
+            result.flightTime = lane.time;
+            found = true;
+            const float spacing = (hi - lo) / static_cast<float>(std::max(1, count - 1));
+            lo = std::max(options.minElevation, lane.launch.elevation - 2.0f * spacing);
+            hi = std::min(options.maxElevation, lane.launch.elevation + 2.0f * spacing);
+        }
+        if (found) {
+            result.hit = true;
+            return result;
+        }
+
+        // Out of reach: the closest landing at full speed along the bearing.
+        batch_.Resize(count);
+        for (int e = 0; e < count; ++e) {
+            batch_.SetLaunch(e, Launch{Lerp(options.minElevation, options.maxElevation, e, count), bearing, options.maxSpeed});
+        }
+        batch_.Integrate(b, origin);
+        result.flights += count;
+        float bestMiss = -1.0f;
+        for (int e = 0; e < count; ++e) {
+            if (batch_.time(e) < 0.0f) continue;
+            const float miss = std::sqrt(Square(batch_.landX(e) - targetX) + Square(batch_.landZ(e) - targetZ));
+            if (bestMiss < 0.0f || miss < bestMiss) {
+                bestMiss = miss;
+                result.launch = Launch{Lerp(options.minElevation, options.maxElevation, e, count), bearing, options.maxSpeed};
+                result.miss = miss;
+                result.flightTime = batch_.time(e);
+            }
+        }
+        return result;
+    }
+
+    // Farthest landing point on each of `bearings` launch azimuths at `speed`, over
+    // `elevations` elevations: the edge of the reachable ground, as x, z pairs.
+    void Envelope(const Ballistics& b, const float origin[3], float speed, int bearings, int elevations, std::vector<float>* xz) {
+        batch_.Resize(bearings * elevations);
+        for (int a = 0; a < bearings; ++a) {
+            for (int e = 0; e < elevations; ++e) {
+                Launch launch;
+                launch.azimuth = 2.0f * kPi * static_cast<float>(a) / static_cast<float>(bearings);
+                launch.elevation = 1.55f * static_cast<float>(e + 1) / static_cast<float>(elevations);
+                launch.speed = speed;
+                batch_.SetLaunch(a * elevations + e, launch);
+            }
+        }
+        batch_.Integrate(b, origin);
+        xz->assign(static_cast<size_t>(bearings) * 2, 0.0f);
+        for (int a = 0; a < bearings; ++a) {
+            float best = -1.0f;
+            for (int e = 0; e < elevations; ++e) {
+                const int i = a * elevations + e;
+                if (batch_.time(i) < 0.0f) continue;
+                const float r2 = Square(batch_.landX(i) - origin[0]) + Square(batch_.landZ(i) - origin[2]);
+                if (r2 > best) {
+                    best = r2;
+                    (*xz)[static_cast<size_t>(a) * 2] = batch_.landX(i);
+                    (*xz)[static_cast<size_t>(a) * 2 + 1] = batch_.landZ(i);
+                }
+            }
+        }
+    }
+
+  private:
+    static constexpr float kPi = 3.14159265358979f;
+    static constexpr float kSpeedCeiling = 1.25f;  // lanes needing more than this x maxSpeed are abandoned
+    static constexpr float kAzimuthProbe = 1.0e-3f;
+    static constexpr float kSpeedProbe = 1.0e-3f;  // relative
+
+    // One elevation held fixed while Newton solves azimuth and speed for the landing point.
+    struct Lane {
+        Launch launch;
+        float miss = 0.0f;
+        float time = -1.0f;
+    };
+
+    static float Square(float x) { return x * x; }
+
+    static float Lerp(float a, float b, int i, int n) {
+        return n <= 1 ? 0.5f * (a + b) : a + (b - a) * static_cast<float>(i) / static_cast<float>(n - 1);
+    }
+
+    // Flies every lane plus an azimuth and a speed probe, then takes a damped Newton step
+    // on the 2x2 finite-difference Jacobian of the landing point. The last call only
+    // records the miss of the current launches.
+    void NewtonStep(const Ballistics& b, const float origin[3], float targetX, float targetZ, const AimOptions& options,
+                    bool measureOnly) {
+        const int count = static_cast<int>(lanes_.size());
+        batch_.Resize(3 * count);
+        for (int e = 0; e < count; ++e) {
+            const Launch& launch = lanes_[static_cast<size_t>(e)].launch;
+            batch_.SetLaunch(3 * e, launch);
+            batch_.SetLaunch(3 * e + 1, Launch{launch.elevation, launch.azimuth + kAzimuthProbe, launch.speed});
+            batch_.SetLaunch(3 * e + 2, Launch{launch.elevation, launch.azimuth, launch.speed * (1.0f + kSpeedProbe)});
+        }
+        batch_.Integrate(b, origin);
+
+        for (int e = 0; e < count; ++e) {
+            Lane& lane = lanes_[static_cast<size_t>(e)];
+            const int base = 3 * e;
+            lane.time = batch_.time(base);
+            if (lane.time < 0.0f || batch_.time(base + 1) < 0.0f || batch_.time(base + 2) < 0.0f) {
+                lane.time = -1.0f;
+                continue;
+            }
+            const float rx = batch_.landX(base) - targetX, rz = batch_.landZ(base) - targetZ;
+            lane.miss = std::sqrt(rx * rx + rz * rz);
+            if (measureOnly) continue;
+
+            const float ds = lane.launch.speed * kSpeedProbe;
+            const float jxa = (batch_.landX(base + 1) - batch_.landX(base)) / kAzimuthProbe;
+            const float jza = (batch_.landZ(base + 1) - batch_.landZ(base)) / kAzimuthProbe;
+            const float jxs = (batch_.landX(base + 2) - batch_.landX(base)) / ds;
+            const float jzs = (batch_.landZ(base + 2) - batch_.landZ(base)) / ds;
+            const float det = jxa * jzs - jxs * jza;
+            if (std::fabs(det) < 1.0e-9f) continue;
+            const float stepA = std::clamp(-(jzs * rx - jxs * rz) / det, -0.3f, 0.3f);
+            const float stepS = std::clamp(-(jxa * rz - jza * rx) / det, -0.3f * lane.launch.speed, 0.3f * lane.launch.speed);
+            lane.launch.azimuth += stepA;
+            lane.launch.speed = std::clamp(lane.launch.speed + stepS, 0.05f, kSpeedCeiling * options.maxSpeed);
+        }
+    }
+
+    TrajectoryBatch batch_;
+    std::vector<Lane> lanes_;
+};
+
+}  // namespace astro_ballistics
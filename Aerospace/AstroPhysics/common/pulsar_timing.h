@@ -0,0 +1,374 @@
+#pragma once
+
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Simulated pulsar timing array.
+//
+// Every epoch each pulsar gets one timing residual (ns): the response to a stochastic
+// gravitational-wave background plus its own white (radiometer) and red (spin) noise.
+// The background is a sum of monochromatic plane waves from random directions. Their
+// residual amplitudes follow the f^-13/3 power spectrum of a population of
+// supermassive-black-hole binaries, sampled on log-spaced frequencies. A wave from
+// direction Omega with polarization tensors e+ and ex shifts pulsar p by
+//
+//   r(t) = 1/2 p^i p^j e_ij / (1 + Omega.p) * [H(t) - H(t - L (1 + Omega.p) / c)],
+//
+// where H is the time integral of the strain: the Earth term minus the pulsar term. Both
+// terms are linear in the wave's sin and cos, so each pulsar's GW residual is one dot
+// product of fixed coefficients with a basis of 4 values per wave shared by the whole
+// array. Epochs are generated in parallel over pulsars on the shared pool.
+//
+// Residuals live in a ring of `window` epochs per pulsar. The pair sums sum r_a r_b and
+// sum r_a over that window are updated incrementally as epochs enter and leave, so the
+// Hellings-Downs cross-correlation curve can be re-binned at any time in O(P^2) without
+// touching the history.
+
+namespace astro_pta {
+
+// Hellings & Downs (1983) correlation of two distinct pulsars separated by angle zeta,
+// normalized to 1/2 at zero separation.
+inline double HellingsDowns(double zeta) {
+    const double x = 0.5 * (1.0 - std::cos(zeta));
+    return x > 0.0 ? 0.5 - 0.25 * x + 1.5 * x * std::log(x) : 0.5;
+}
+
+struct ArrayOptions {
+    int pulsars = 200;
+    int sources = 96;                  // plane waves in the background
+    int window = 520;                  // epochs kept per pulsar (20 yr at two-week cadence)
+    double cadenceYears = 14.0 / 365.25;
+    float gwRmsNs = 120.0f;            // rms GW residual, before SetGwScale()
+    float redRmsNs = 40.0f;
+    float redMemory = 0.97f;           // AR(1) coefficient per epoch
+    float whiteMinNs = 60.0f;          // per-pulsar white noise, log-uniform in [min, max]
+    float whiteMaxNs = 500.0f;
+    int bins = 12;                     // angular-separation bins of the correlation curve
+    uint64_t seed = 20230629;
+};
+
+struct Pulsar {
+    float x = 0.0f, y = 0.0f, z = 1.0f;  // unit sky direction
+    float distanceKpc = 1.0f;
+    float whiteNs = 100.0f;
+};
+
+struct CorrelationBin {
+    float zeta = 0.0f;      // bin centre (radians)
+    float mean = 0.0f;      // mean normalized cross-correlation of the pairs in the bin
+    float error = 0.0f;     // standard error of that mean
+    int pairs = 0;
+};
+
+class TimingArray {
+  public:
+    void Configure(const ArrayOptions& options) {
+        options_ = options;
+        const int P = std::max(2, options.pulsars);
+        const int S = std::max(1, options.sources);
+        options_.pulsars = P;
+        options_.sources = S;
+        options_.window = std::max(4, options.window);
+        options_.bins = std::max(1, options.bins);
+        astro_random::PhiloxStream rng(options.seed, 0x5A17u);
+
+        pulsars_.assign(static_cast<size_t>(P), Pulsar{});
+        for (Pulsar& p : pulsars_) {
+            const float z = rng.Uniform(-1.0f, 1.0f);
+            const float phi = rng.Uniform(0.0f, 6.2831853f);
+            const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            p.x = r * std::cos(phi);
+            p.y = z;
+            p.z = r * std::sin(phi);
+            p.distanceKpc = rng.Uniform(0.4f, 3.0f);
+            p.whiteNs = options.whiteMinNs * std::pow(options.whiteMaxNs / options.whiteMinNs, rng.Uniform());
+        }
+
+        // Waves: log-spaced frequencies from 1/T up to 30/T of the window, amplitude per
+        // wave ~ f^-13/6 for the spectrum times sqrt(df) ~ sqrt(f) for the log spacing.
+        const double span = options_.window * options_.cadenceYears;
+        waves_.assign(static_cast<size_t>(S), Wave{});
+        for (int s = 0; s < S; ++s) {
+            Wave& w = waves_[static_cast<size_t>(s)];
+            const double f = std::pow(30.0, rng.Uniform()) / span;
+            w.omega = 2.0 * 3.14159265358979 * f;
+            w.phasePlus = rng.Uniform(0.0f, 6.2831853f);
+            w.phaseCross = rng.Uniform(0.0f, 6.2831853f);
+            const double amplitude = std::pow(f * span, -5.0 / 3.0);
+            w.plus = static_cast<float>(amplitude * rng.Normal());
+            w.cross = static_cast<float>(amplitude * rng.Normal());
+        }
+
+        // Per pulsar, per wave: pattern functions and pulsar-term phase -> 4 coefficients
+        // on (sin+, cos+, sinx, cosx). Normalized so the array-averaged GW rms is gwRmsNs.
+        coefficients_.assign(static_cast<size_t>(P) * 4 * S, 0.0f);
+        double response = 0.0;
+        for (int s = 0; s < S; ++s) {
+            Wave& w = waves_[static_cast<size_t>(s)];
+            const float cz = rng.Uniform(-1.0f, 1.0f);
+            const float az = rng.Uniform(0.0f, 6.2831853f);
+            const float sz = std::sqrt(std::max(0.0f, 1.0f - cz * cz));
+            const float omega[3] = {sz * std::cos(az), cz, sz * std::sin(az)};
+            // m, n span the wave's transverse plane, rotated by a random polarization angle.
+            float m[3], n[3];
+            Transverse(omega, rng.Uniform(0.0f, 3.14159265f), m, n);
+            for (int a = 0; a < P; ++a) {
+                const Pulsar& p = pulsars_[static_cast<size_t>(a)];
+                const float dir[3] = {p.x, p.y, p.z};
+                const float mp = m[0] * dir[0] + m[1] * dir[1] + m[2] * dir[2];
+                const float np = n[0] * dir[0] + n[1] * dir[1] + n[2] * dir[2];
+                const float cosine = omega[0] * dir[0] + omega[1] * dir[1] + omega[2] * dir[2];
+                const float denom = std::max(1.0e-3f, 1.0f + cosine);
+                const float fPlus = 0.5f * (mp * mp - np * np) / denom;
+                const float fCross = 0.5f * (2.0f * mp * np) / denom;
+                // Pulsar term: H(t - tau) with tau = L (1 + Omega.p) / c, 1 kpc = 3261.6 ly.
+                const double lag = w.omega * 3261.6 * p.distanceKpc * (1.0 + cosine);
+                const float c = static_cast<float>(std::cos(std::fmod(lag, 2.0 * 3.14159265358979)));
+                const float sn = static_cast<float>(std::sin(std::fmod(lag, 2.0 * 3.14159265358979)));
+                // sin(x) - sin(x - l) = sin(x) (1 - cos l) + cos(x) sin l
+                float* k = &coefficients_[(static_cast<size_t>(a) * S + s) * 4];
+                k[0] = fPlus * w.plus * (1.0f - c);
+                k[1] = fPlus * w.plus * sn;
+                k[2] = fCross * w.cross * (1.0f - c);
+                k[3] = fCross * w.cross * sn;
+                response += 0.5 * (k[0] * k[0] + k[1] * k[1] + k[2] * k[2] + k[3] * k[3]);
+            }
+        }
+        const float norm = response > 0.0 ? static_cast<float>(options.gwRmsNs / std::sqrt(response / P)) : 0.0f;
+        for (float& k : coefficients_) k *= norm;
+
+        // Pair geometry: separation bin and Hellings-Downs value of every a < b.
+        pairBin_.assign(static_cast<size_t>(P) * P, 0);
+        pairCurve_.assign(static_cast<size_t>(P) * P, 0.0f);
+        for (int a = 0; a < P; ++a) {
+            for (int b = a + 1; b < P; ++b) {
+                const Pulsar& pa = pulsars_[static_cast<size_t>(a)];
+                const Pulsar& pb = pulsars_[static_cast<size_t>(b)];
+                const double zeta = std::acos(std::clamp(static_cast<double>(pa.x * pb.x + pa.y * pb.y + pa.z * pb.z), -1.0, 1.0));
+                const size_t ab = static_cast<size_t>(a) * P + b;
+                pairBin_[ab] = static_cast<uint8_t>(std::min(options_.bins - 1, static_cast<int>(zeta / 3.14159265358979 * options_.bins)));
+                pairCurve_[ab] = static_cast<float>(HellingsDowns(zeta));
+            }
+        }
+        Reset();
+    }
+
+    // Forgets every residual but keeps the sky and the background.
+    void Reset() {
+        const size_t P = pulsars_.size();
+        residuals_.assign(P * static_cast<size_t>(options_.window), 0.0f);
+        red_.assign(P, 0.0f);
+        current_.assign(P, 0.0f);
+        leaving_.assign(P, 0.0f);
+        gram_.assign(P * P, 0.0);
+        sums_.assign(P, 0.0);
+        epoch_ = 0;
+        head_ = 0;
+    }
+
+    void SetGwScale(float scale) { gwScale_ = scale; }
+    float gwScale() const { return gwScale_; }
+
+    // Generates `epochs` new epochs and folds them into the pair sums.
+    void Step(int epochs) {
+        const int P = static_cast<int>(pulsars_.size());
+        const int S = static_cast<int>(waves_.size());
+        if (P == 0) return;
+        basis_.resize(static_cast<size_t>(4) * S);
+        astro_parallel::ThreadPool& pool = astro_parallel::SharedPool();
+        for (int e = 0; e < epochs; ++e) {
+            const double t = static_cast<double>(epoch_) * options_.cadenceYears;
+            for (int s = 0; s < S; ++s) {
+                const Wave& w = waves_[static_cast<size_t>(s)];
+                const double xp = std::fmod(w.omega * t + w.phasePlus, 2.0 * 3.14159265358979);
+                const double xc = std::fmod(w.omega * t + w.phaseCross, 2.0 * 3.14159265358979);
+                basis_[static_cast<size_t>(4) * s + 0] = static_cast<float>(std::sin(xp));
+                basis_[static_cast<size_t>(4) * s + 1] = static_cast<float>(std::cos(xp));
+                basis_[static_cast<size_t>(4) * s + 2] = static_cast<float>(std::sin(xc));
+                basis_[static_cast<size_t>(4) * s + 3] = static_cast<float>(std::cos(xc));
+            }
+
+            const bool full = epoch_ >= static_cast<uint64_t>(options_.window);
+            const size_t slot = static_cast<size_t>(head_);
+            pool.ParallelFor(P, 16, [&](int begin, int end) {
+                for (int a = begin; a < end; ++a) GenerateResidual(a, slot, full);
+            });
+
+            // Sliding-window pair sums: G += r r^T - r_old r_old^T on the upper triangle.
+            pool.ParallelFor(P, 8, [&](int begin, int end) {
+                for (int a = begin; a < end; ++a) UpdateRow(a, full);
+            });
+            head_ = (head_ + 1) % options_.window;
+            ++epoch_;
+        }
+    }
+
+    // Normalized cross-correlation binned by separation, the pair-weighted least-squares
+    // amplitude A of A * HD(zeta), and its significance; O(P^2) over the pair sums.
+    void Correlate(std::vector<CorrelationBin>* bins, float* amplitude, float* significance = nullptr) const {
+        const int P = static_cast<int>(pulsars_.size());
+        const int B = options_.bins;
+        bins->assign(static_cast<size_t>(B), CorrelationBin{});
+        for (int b = 0; b < B; ++b) (*bins)[static_cast<size_t>(b)].zeta = (b + 0.5f) * 3.14159265f / B;
+        *amplitude = 0.0f;
+        if (significance) *significance = 0.0f;
+        const double n = static_cast<double>(samples());
+        if (n < 4.0) return;
+
+        std::vector<double> mean(static_cast<size_t>(P)), inv(static_cast<size_t>(P));
+        for (int a = 0; a < P; ++a) {
+            mean[static_cast<size_t>(a)] = sums_[static_cast<size_t>(a)] / n;
+            const double var = gram_[static_cast<size_t>(a) * P + a] / n - mean[static_cast<size_t>(a)] * mean[static_cast<size_t>(a)];
+            inv[static_cast<size_t>(a)] = var > 0.0 ? 1.0 / std::sqrt(var) : 0.0;
+        }
+
+        std::vector<double> sum(static_cast<size_t>(B), 0.0), sumSq(static_cast<size_t>(B), 0.0);
+        std::vector<int> count(static_cast<size_t>(B), 0);
+        std::vector<double> rho(static_cast<size_t>(P));
+        double rhoCurve = 0.0, curveCurve = 0.0, rhoRho = 0.0;
+        long pairs = 0;
+        for (int a = 0; a < P; ++a) {
+            const double* g = &gram_[static_cast<size_t>(a) * P];
+            const double ma = mean[static_cast<size_t>(a)], ia = inv[static_cast<size_t>(a)];
+            for (int b = a + 1; b < P; ++b) rho[static_cast<size_t>(b)] = (g[b] / n - ma * mean[static_cast<size_t>(b)]) * ia * inv[static_cast<size_t>(b)];
+            const uint8_t* bin = &pairBin_[static_cast<size_t>(a) * P];
+            const float* curve = &pairCurve_[static_cast<size_t>(a) * P];
+            for (int b = a + 1; b < P; ++b) {
+                const double r = rho[static_cast<size_t>(b)];
+                sum[bin[b]] += r;
+                sumSq[bin[b]] += r * r;
+                ++count[bin[b]];
+                rhoCurve += r * curve[b];
+                curveCurve += static_cast<double>(curve[b]) * curve[b];
+                rhoRho += r * r;
+            }
+            pairs += P - 1 - a;
+        }
+        for (int b = 0; b < B; ++b) {
+            CorrelationBin& out = (*bins)[static_cast<size_t>(b)];
+            out.pairs = count[static_cast<size_t>(b)];
+            if (out.pairs == 0) continue;
+            const double m = sum[static_cast<size_t>(b)] / out.pairs;
+            const double var = std::max(0.0, sumSq[static_cast<size_t>(b)] / out.pairs - m * m);
+            out.mean = static_cast<float>(m);
+            out.error = static_cast<float>(std::sqrt(var / out.pairs));
+        }
+        if (curveCurve > 0.0) {
+            const double a = rhoCurve / curveCurve;
+            *amplitude = static_cast<float>(a);
+            if (significance && pairs > 1) {
+                // Residual scatter about the fit sets the amplitude's standard error.
+                const double resid = std::max(0.0, rhoRho - a * rhoCurve) / static_cast<double>(pairs - 1);
+                *significance = resid > 0.0 ? static_cast<float>(a / std::sqrt(resid / curveCurve)) : 0.0f;
+            }
+        }
+    }
+
+    // Normalized correlation of one pair over the window, from the running sums.
+    float Correlation(int a, int b) const {
+        const double n = static_cast<double>(samples());
+        if (n < 2.0) return 0.0f;
+        const int P = static_cast<int>(pulsars_.size());
+        if (a > b) std::swap(a, b);
+        const double ma = sums_[static_cast<size_t>(a)] / n, mb = sums_[static_cast<size_t>(b)] / n;
+        const double va = gram_[static_cast<size_t>(a) * P + a] / n - ma * ma;
+        const double vb = gram_[static_cast<size_t>(b) * P + b] / n - mb * mb;
+        if (!(va > 0.0 && vb > 0.0)) return 0.0f;
+        return static_cast<float>((gram_[static_cast<size_t>(a) * P + b] / n - ma * mb) / std::sqrt(va * vb));
+    }
+
+    int pulsars() const { return static_cast<int>(pulsars_.size()); }
+    const Pulsar& pulsar(int a) const { return pulsars_[static_cast<size_t>(a)]; }
+    const ArrayOptions& options() const { return options_; }
+    uint64_t epoch() const { return epoch_; }
+    double years() const { return static_cast<double>(epoch_) * options_.cadenceYears; }
+    int samples() const { return static_cast<int>(std::min<uint64_t>(epoch_, static_cast<uint64_t>(options_.window))); }
+
+    // Residual k epochs back from the newest (k = 0), in ns.
+    float Residual(int a, int k) const {
+        const int w = options_.window;
+        const int slot = ((head_ - 1 - k) % w + w) % w;
+        return residuals_[static_cast<size_t>(a) * w + slot];
+    }
+    float Latest(int a) const { return current_[static_cast<size_t>(a)]; }
+
+  private:
+    struct Wave {
+        double omega = 1.0;  // rad / yr
+        float phasePlus = 0.0f;
+        float phaseCross = 0.0f;
+        float plus = 0.0f;
+        float cross = 0.0f;
+    };
+
+    static void Transverse(const float omega[3], float psi, float m[3], float n[3]) {
+        const float ref[3] = {std::fabs(omega[1]) < 0.9f ? 0.0f : 1.0f, std::fabs(omega[1]) < 0.9f ? 1.0f : 0.0f, 0.0f};
+        float u[3] = {ref[1] * omega[2] - ref[2] * omega[1], ref[2] * omega[0] - ref[0] * omega[2], ref[0] * omega[1] - ref[1] * omega[0]};
+        const float len = std::sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+        for (float& c : u) c /= len;
+        const float v[3] = {omega[1] * u[2] - omega[2] * u[1], omega[2] * u[0] - omega[0] * u[2], omega[0] * u[1] - omega[1] * u[0]};
+        const float c = std::cos(psi), s = std::sin(psi);
+        for (int i = 0; i < 3; ++i) {
+            m[i] = c * u[i] + s * v[i];
+            n[i] = -s * u[i] + c * v[i];
+        }
+    }
+
+    void GenerateResidual(int a, size_t slot, bool full) {
+        const int S = static_cast<int>(waves_.size());
+        const float* k = &coefficients_[static_cast<size_t>(a) * 4 * S];
+        float gw = 0.0f;
+        for (int i = 0; i < 4 * S; ++i) gw += k[i] * basis_[static_cast<size_t>(i)];
+
+        astro_random::PhiloxStream rng(options_.seed ^ (0x9E3779B97F4A7C15ull * static_cast<uint64_t>(a + 1)), static_cast<uint32_t>(epoch_));
+        const float memory = options_.redMemory;
+        float& red = red_[static_cast<size_t>(a)];
+        red = memory * red + options_.redRmsNs * std::sqrt(1.0f - memory * memory) * rng.Normal();
+        const float r = gwScale_ * gw + red + pulsars_[static_cast<size_t>(a)].whiteNs * rng.Normal();
+
+        float& cell = residuals_[static_cast<size_t>(a) * options_.window + slot];
+        leaving_[static_cast<size_t>(a)] = full ? cell : 0.0f;
+        cell = r;
+        current_[static_cast<size_t>(a)] = r;
+    }
+
+    void UpdateRow(int a, bool full) {
+        const int P = static_cast<int>(pulsars_.size());
+        double* g = &gram_[static_cast<size_t>(a) * P];
+        const double ra = current_[static_cast<size_t>(a)];
+        const double oa = leaving_[static_cast<size_t>(a)];
+        const float* rn = current_.data();
+        const float* ro = leaving_.data();
+        if (full) {
+            for (int b = a; b < P; ++b) g[b] += ra * rn[b] - oa * ro[b];
+        } else {
+            for (int b = a; b < P; ++b) g[b] += ra * rn[b];
+        }
+        sums_[static_cast<size_t>(a)] += ra - oa;
+    }
+
+    ArrayOptions options_;
+    std::vector<Pulsar> pulsars_;
+    std::vector<Wave> waves_;
+    std::vector<float> coefficients_;  // [pulsar][wave][4]
+    std::vector<float> basis_;         // [wave][4] for the epoch being generated
+    std::vector<uint8_t> pairBin_;     // [a][b], a < b
+    std::vector<float> pairCurve_;     // HD(zeta_ab), a < b
+    std::vector<float> residuals_;     // [pulsar][window] ring
+    std::vector<float> red_;
+    std::vector<float> current_;
+    std::vector<float> leaving_;
+    std::vector<double> gram_;         // [a][b], b >= a: sum r_a r_b over the window
+    std::vector<double> sums_;
+    float gwScale_ = 1.0f;
+    uint64_t epoch_ = 0;
+    int head_ = 0;
+};
+
+}  // namespace astro_pta
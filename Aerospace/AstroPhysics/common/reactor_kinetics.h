@@ -0,0 +1,324 @@
+#pragma once
+
+#include "integrators.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// A pressurised-water reactor plant as one stiff ODE system: six-group point kinetics
+// with fuel (Doppler) and moderator temperature feedback, decay heat, iodine-xenon
+// poisoning, and a lumped primary loop feeding a steam generator and a secondary side
+// drained by the turbine.
+//
+// Point kinetics uses precursor concentrations scaled so that c_i = n at equilibrium:
+//
+//   dn/dt   = (rho - beta) / Lambda n + sum_i beta_i / Lambda c_i
+//   dc_i/dt = lambda_i (n - c_i)
+//
+// where n is fission power over nominal. Decay heat (three groups, 6% of power at
+// equilibrium) and iodine/xenon are normalised the same way, so steady full power is
+// all ones. The loop is a chain of well-mixed nodes, each at its outlet temperature,
+// carrying heat at the pump flow w: fuel -> core coolant -> hot leg -> steam generator
+// (-> secondary) -> cold leg -> core. Without pumps the flow coasts down to natural
+// circulation.
+//
+// Lambda is tens of microseconds while xenon evolves over hours. PlantSimulator moves
+// the rods between short control steps and integrates each stretch with
+// Rosenbrock23Advance; while the rods are still it hands the solver long stretches and
+// the steps grow to seconds, so an hour of plant time costs a few thousand steps.
+
+namespace astro_reactor {
+
+constexpr int kDelayedGroups = 6;
+constexpr int kDecayHeatGroups = 3;
+
+// Keepin's thermal U-235 delayed-neutron data.
+constexpr std::array<double, kDelayedGroups> kBeta = {0.000215, 0.001424, 0.001274, 0.002568, 0.000748, 0.000273};
+constexpr std::array<double, kDelayedGroups> kLambda = {0.0124, 0.0305, 0.111, 0.301, 1.14, 3.01};  // 1/s
+constexpr std::array<double, kDecayHeatGroups> kDecayFraction = {0.025, 0.020, 0.015};
+constexpr std::array<double, kDecayHeatGroups> kDecayRate = {1.0e-1, 3.3e-3, 1.0e-4};  // 1/s
+
+enum StateIndex : size_t {
+    kPower = 0,
+    kPrecursor = 1,                              // kDelayedGroups entries
+    kDecayHeat = kPrecursor + kDelayedGroups,    // kDecayHeatGroups entries
+    kFuelTemp = kDecayHeat + kDecayHeatGroups,   // degrees C
+    kCoreTemp,                                   // core outlet
+    kHotLegTemp,
+    kSteamGenTemp,                               // steam generator primary outlet
+    kColdLegTemp,
+    kSecondaryTemp,                              // secondary saturation temperature
+    kFlow,                                       // primary flow / nominal
+    kIodine,
+    kXenon,
+    kStateSize,
+};
+
+using PlantState = std::array<double, kStateSize>;
+
+struct PlantParameters {
+    double nominalPower = 3.0e9;        // W thermal
+    double generationTime = 2.0e-5;     // Lambda, s
+    double dopplerCoefficient = -2.8e-5;    // 1/K of fuel temperature
+    double moderatorCoefficient = -2.0e-4;  // 1/K of core coolant temperature
+    double rodWorth = 0.06;             // total bank worth
+    double xenonWorth = 0.027;          // equilibrium full-power xenon
+    double nominalRodDepth = 0.32;      // critical at full power with equilibrium xenon
+
+    double fuelTemp = 620.0;            // nominal temperatures, C
+    double coreTemp = 325.0;
+    double coldLegTemp = 290.0;
+    double secondaryTemp = 275.0;
+    double condenserTemp = 40.0;
+    double noLoadTemp = 292.0;          // steam dump setpoint
+    double steamDumpGain = 0.4;         // dump capacity per K above it, / nominal power
+
+    double fuelHeatCapacity = 4.0e7;    // J/K
+    double coreHeatCapacity = 6.6e7;    // coolant inventories times c_p
+    double hotLegHeatCapacity = 1.1e8;
+    double steamGenHeatCapacity = 2.2e8;
+    double coldLegHeatCapacity = 1.65e8;
+    double secondaryHeatCapacity = 8.0e8;
+
+    double pumpSpinUp = 5.0;            // s
+    double pumpCoastDown = 12.0;        // s
+    double naturalCirculation = 0.06;   // flow fraction at the nominal core temperature rise
+
+    // Iodine-xenon chain (per second): decay constants, fission yields, and xenon burn-up
+    // at full flux.
+    double iodineDecay = 2.87e-5;
+    double xenonDecay = 2.09e-5;
+    double iodineYield = 0.0639;
+    double xenonYield = 0.00237;
+    double xenonBurnup = 7.8e-5;
+};
+
+struct PlantInputs {
+    double rodDepth = 0.32;      // 0 withdrawn .. 1 fully inserted
+    double turbineValve = 1.0;   // steam draw at the nominal secondary temperature, / nominal
+    bool pumps = true;
+};
+
+inline double TotalBeta() {
+    double beta = 0.0;
+    for (double b : kBeta) beta += b;
+    return beta;
+}
+
+// Integral worth of a bank with a cosine-shaped differential worth, taken negative.
+inline double RodReactivity(const PlantParameters& p, double depth) {
+    const double d = std::clamp(depth, 0.0, 1.0);
+    return -p.rodWorth * (d - std::sin(2.0 * 3.14159265358979 * d) / (2.0 * 3.14159265358979));
+}
+
+class PlantModel {
+  public:
+    explicit PlantModel(const PlantParameters& parameters = PlantParameters{}) : p_(parameters) {
+        const double power = p_.nominalPower;
+        fuelConductance_ = power / (p_.fuelTemp - p_.coreTemp);
+        flowHeat_ = power / (p_.coreTemp - p_.coldLegTemp);
+        steamGenConductance_ = power / (p_.coldLegTemp - p_.secondaryTemp);
+        // Critical at nominal: rods + bias + xenon = 0.
+        reactivityBias_ = -RodReactivity(p_, p_.nominalRodDepth) + p_.xenonWorth;
+    }
+
+    const PlantParameters& parameters() const { return p_; }
+
+    // Full power, equilibrium xenon, pumps on.
+    PlantState Nominal() const {
+        PlantState y{};
+        for (size_t i = 0; i < kFuelTemp; ++i) y[i] = 1.0;
+        y[kFuelTemp] = p_.fuelTemp;
+        y[kCoreTemp] = p_.coreTemp;
+        y[kHotLegTemp] = p_.coreTemp;
+        y[kSteamGenTemp] = p_.coldLegTemp;
+        y[kColdLegTemp] = p_.coldLegTemp;
+        y[kSecondaryTemp] = p_.secondaryTemp;
+        y[kFlow] = y[kIodine] = y[kXenon] = 1.0;
+        return y;
+    }
+
+    double Reactivity(const PlantState& y, const PlantInputs& in) const {
+        return reactivityBias_ + RodReactivity(p_, in.rodDepth) + p_.dopplerCoefficient * (y[kFuelTemp] - p_.fuelTemp) +
+               p_.moderatorCoefficient * (y[kCoreTemp] - p_.coreTemp) - p_.xenonWorth * y[kXenon];
+    }
+
+    double XenonReactivity(const PlantState& y) const { return -p_.xenonWorth * y[kXenon]; }
+
+    // Heat deposited in the fuel (fission plus decay), / nominal.
+    double ThermalPower(const PlantState& y) const {
+        double decay = 0.0, fraction = 0.0;
+        for (int g = 0; g < kDecayHeatGroups; ++g) {
+            decay += kDecayFraction[static_cast<size_t>(g)] * y[kDecayHeat + static_cast<size_t>(g)];
+            fraction += kDecayFraction[static_cast<size_t>(g)];
+        }
+        return (1.0 - fraction) * y[kPower] + decay;
+    }
+
+    double SteamGenHeat(const PlantState& y) const { return steamGenConductance_ * (y[kSteamGenTemp] - y[kSecondaryTemp]); }
+
+    // Steam drawn by the turbine, W: the valve opening times a flow that scales with the
+    // secondary temperature above the condenser's.
+    double TurbineHeat(const PlantState& y, const PlantInputs& in) const {
+        return p_.nominalPower * std::max(0.0, in.turbineValve) *
+               std::max(0.0, y[kSecondaryTemp] - p_.condenserTemp) / (p_.secondaryTemp - p_.condenserTemp);
+    }
+
+    // Steam dumped to the condenser, W, which keeps an unloaded plant at its no-load
+    // temperature instead of letting the moderator cool it back to criticality.
+    double SteamDumpHeat(const PlantState& y) const {
+        return p_.nominalPower * p_.steamDumpGain * std::max(0.0, y[kSecondaryTemp] - p_.noLoadTemp);
+    }
+
+    void Derivatives(const PlantState& y, const PlantInputs& in, PlantState& dydt) const {
+        const double lambdaGen = p_.generationTime;
+        const double n = y[kPower];
+        double delayed = 0.0;
+        for (int g = 0; g < kDelayedGroups; ++g) {
+            const size_t i = kPrecursor + static_cast<size_t>(g);
+            delayed += kBeta[static_cast<size_t>(g)] * y[i];
+            dydt[i] = kLambda[static_cast<size_t>(g)] * (n - y[i]);
+        }
+        dydt[kPower] = ((Reactivity(y, in) - TotalBeta()) * n + delayed) / lambdaGen;
+        for (int g = 0; g < kDecayHeatGroups; ++g) {
+            const size_t i = kDecayHeat + static_cast<size_t>(g);
+            dydt[i] = kDecayRate[static_cast<size_t>(g)] * (n - y[i]);
+        }
+
+        const double flow = flowHeat_ * y[kFlow];  // W/K carried around the loop
+        const double fuelToCoolant = fuelConductance_ * (y[kFuelTemp] - y[kCoreTemp]);
+        const double steamGen = SteamGenHeat(y);
+        dydt[kFuelTemp] = (p_.nominalPower * ThermalPower(y) - fuelToCoolant) / p_.fuelHeatCapacity;
+        dydt[kCoreTemp] = (fuelToCoolant + flow * (y[kColdLegTemp] - y[kCoreTemp])) / p_.coreHeatCapacity;
+        dydt[kHotLegTemp] = flow * (y[kCoreTemp] - y[kHotLegTemp]) / p_.hotLegHeatCapacity;
+        dydt[kSteamGenTemp] = (flow * (y[kHotLegTemp] - y[kSteamGenTemp]) - steamGen) / p_.steamGenHeatCapacity;
+        dydt[kColdLegTemp] = flow * (y[kSteamGenTemp] - y[kColdLegTemp]) / p_.coldLegHeatCapacity;
+        dydt[kSecondaryTemp] = (steamGen - TurbineHeat(y, in) - SteamDumpHeat(y)) / p_.secondaryHeatCapacity;
+
+        // Natural circulation grows with the cube root of the core temperature rise; the
+        // +0.5 K keeps its derivative finite at zero.
+        const double rise = std::max(0.0, y[kCoreTemp] - y[kColdLegTemp]) + 0.5;
+        const double natural = p_.naturalCirculation * std::cbrt(rise / (p_.coreTemp - p_.coldLegTemp + 0.5));
+        const double target = in.pumps ? 1.0 : natural;
+        const double tau = in.pumps && y[kFlow] < 1.0 ? p_.pumpSpinUp : p_.pumpCoastDown;
+        dydt[kFlow] = (std::max(target, natural) - y[kFlow]) / tau;
+
+        const double burn = p_.xenonDecay + p_.xenonBurnup;
+        const double yields = p_.iodineYield + p_.xenonYield;
+        dydt[kIodine] = p_.iodineDecay * (n - y[kIodine]);
+        dydt[kXenon] = burn * (p_.xenonYield * n + p_.iodineYield * y[kIodine]) / yields -
+                       (p_.xenonDecay + p_.xenonBurnup * n) * y[kXenon];
+    }
+
+  private:
+    PlantParameters p_;
+    double fuelConductance_ = 0.0;
+    double flowHeat_ = 0.0;
+    double steamGenConductance_ = 0.0;
+    double reactivityBias_ = 0.0;
+};
+
+// The plant plus its rod drive. Rods move at a limited speed toward a target depth,
+// drop on a scram, and in automatic mode follow the average coolant temperature
+// program: Tavg falls linearly from nominal with the turbine load, and rods insert when
+// Tavg runs hot. A scram also trips the turbine.
+class PlantSimulator {
+  public:
+    static constexpr double kControlStep = 0.1;    // s of plant time while rods move
+    static constexpr double kIdleStep = 5.0;       // s of plant time while they do not
+    static constexpr double kRodSpeed = 0.02;      // depth per second when driven
+    static constexpr double kRodDropSpeed = 0.6;   // depth per second when scrammed
+    static constexpr double kTavgProgramSpan = 12.0;  // K between full and zero load
+    static constexpr double kRodControlGain = 0.004;  // depth per second per K
+    static constexpr double kRodControlDeadband = 0.25;  // K
+
+    explicit PlantSimulator(const PlantParameters& parameters = PlantParameters{}) : model_(parameters) { Reset(); }
+
+    void Reset() {
+        state_ = model_.Nominal();
+        inputs_ = PlantInputs{};
+        inputs_.rodDepth = model_.parameters().nominalRodDepth;
+        rodTarget_ = inputs_.rodDepth;
+        time_ = 0.0;
+        scrammed_ = false;
+        stepper_ = astro_integrate::AdaptiveStepper{};
+        stepper_.relTol = 1.0e-5f;
+        stepper_.absTol = 1.0e-7f;
+        stepper_.minStep = 1.0e-7f;
+        stepper_.maxStep = 60.0f;
+        stepper_.maxAttempts = 4000;
+        solverSteps_ = solverRejects_ = 0;
+    }
+
+    const PlantModel& model() const { return model_; }
+    const PlantState& state() const { return state_; }
+    const PlantInputs& inputs() const { return inputs_; }
+    double time() const { return time_; }
+    bool scrammed() const { return scrammed_; }
+    bool automatic() const { return automatic_; }
+    double rodTarget() const { return rodTarget_; }
+    long solverSteps() const { return solverSteps_; }
+    long solverRejects() const { return solverRejects_; }
+
+    double AverageCoolantTemp() const { return 0.5 * (state_[kCoreTemp] + state_[kColdLegTemp]); }
+    double ProgramTemp() const {
+        const PlantParameters& p = model_.parameters();
+        const double nominal = 0.5 * (p.coreTemp + p.coldLegTemp);
+        return nominal - kTavgProgramSpan * (1.0 - std::clamp(inputs_.turbineValve, 0.0, 1.0));
+    }
+
+    void SetTurbineValve(double valve) { inputs_.turbineValve = std::clamp(valve, 0.0, 1.1); }
+    void SetPumps(bool on) { inputs_.pumps = on; }
+    void SetAutomatic(bool on) { automatic_ = on && !scrammed_; }
+    void SetRodTarget(double depth) {
+        if (!scrammed_) rodTarget_ = std::clamp(depth, 0.0, 1.0);
+    }
+    void Scram() {
+        scrammed_ = true;
+        automatic_ = false;
+        rodTarget_ = 1.0;
+        inputs_.turbineValve = 0.0;
+    }
+    // Clears a scram; rods stay in until withdrawn.
+    void ResetScram() { scrammed_ = false; }
+
+    void Advance(double seconds) {
+        while (seconds > 0.0) {
+            if (automatic_) {
+                const double error = AverageCoolantTemp() - ProgramTemp();
+                const double speed = std::fabs(error) > kRodControlDeadband ? std::clamp(kRodControlGain * error, -kRodSpeed, kRodSpeed) : 0.0;
+                rodTarget_ = std::clamp(inputs_.rodDepth + speed * kControlStep, 0.0, 1.0);
+            }
+            const bool moving = std::fabs(rodTarget_ - inputs_.rodDepth) > 1.0e-9;
+            const double chunk = std::min(seconds, moving ? kControlStep : kIdleStep);
+            const double speed = scrammed_ ? kRodDropSpeed : kRodSpeed;
+            inputs_.rodDepth += std::clamp(rodTarget_ - inputs_.rodDepth, -speed * chunk, speed * chunk);
+
+            const PlantInputs in = inputs_;
+            astro_integrate::Rosenbrock23Advance(state_, chunk, [&](const PlantState& y, PlantState& dydt) {
+                model_.Derivatives(y, in, dydt);
+            }, stepper_);
+            state_[kPower] = std::max(state_[kPower], 1.0e-12);
+            solverSteps_ += stepper_.lastAccepted;
+            solverRejects_ += stepper_.lastRejected;
+            time_ += chunk;
+            seconds -= chunk;
+        }
+    }
+
+  private:
+    PlantModel model_;
+    PlantState state_{};
+    PlantInputs inputs_;
+    astro_integrate::AdaptiveStepper stepper_;
+    double rodTarget_ = 0.32;
+    double time_ = 0.0;
+    bool scrammed_ = false;
+    bool automatic_ = true;
+    long solverSteps_ = 0;
+    long solverRejects_ = 0;
+};
+
+}  // namespace astro_reactor
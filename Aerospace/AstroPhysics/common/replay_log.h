@@ -0,0 +1,436 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "cli_args.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Deterministic record/replay for the interactive demos. A demo reads its per-frame
+// input through InputFrame instead of calling IsKeyPressed()/GetFrameTime() directly.
+// With --record=path the live frames are appended to a log. With --replay=path the
+// same update code is driven from the log without a window, as fast as it will go,
+// and the frame costs are reported. Keyframes (an opaque state snapshot from the demo)
+// are written every kKeyframeInterval frames. On replay the live state is compared
+// against them, so a divergence is caught at the first keyframe after it happens.
+//
+// Log layout, little-endian:
+//   "ARPL", u32 version (1), u32 seed, u32 keyframe interval, u32 name length, name
+//   then records: u8 type, u32 frame, u32 raw size, u32 coded size, coded bytes
+// Frame and keyframe payloads are delta-coded against the previous record of the same
+// type (XOR, then zero runs); input bytes rarely change between frames so most frames
+// take a dozen bytes. Blob records (e.g. a hand TrackingPacket) are stored raw and
+// come back with the frame they were logged on.
+
+namespace astro_replay {
+
+constexpr uint32_t kLogVersion = 1;
+constexpr int kKeyframeInterval = 120;
+constexpr int kKeyCount = KEY_KB_MENU + 1;
+constexpr int kKeyBytes = (kKeyCount + 7) / 8;
+constexpr int kMouseButtons = 3;
+
+enum RecordType : uint8_t { kRecordFrame = 1, kRecordKeyframe = 2, kRecordBlob = 3 };
+
+// One frame of input: frame time, keyboard and mouse state.
+struct InputFrame {
+    float dt = 0.0f;
+    float wheel = 0.0f;
+    Vector2 mouseDelta = {0.0f, 0.0f};
+    Vector2 mousePosition = {0.0f, 0.0f};
+    uint8_t mouseDown = 0;
+    uint8_t mousePressed = 0;
+    uint8_t keysDown[kKeyBytes] = {};
+    uint8_t keysPressed[kKeyBytes] = {};
+
+    bool Down(int key) const { return key >= 0 && key < kKeyCount && (keysDown[key >> 3] >> (key & 7)) & 1; }
+    bool Pressed(int key) const { return key >= 0 && key < kKeyCount && (keysPressed[key >> 3] >> (key & 7)) & 1; }
+    bool MouseDown(int button) const { return button >= 0 && button < kMouseButtons && (mouseDown >> button) & 1; }
+    bool MousePressed(int button) const { return button >= 0 && button < kMouseButtons && (mousePressed >> button) & 1; }
+};
+
+static_assert(std::is_trivially_copyable<InputFrame>::value, "InputFrame is logged as raw bytes");
+
+// Polls raylib for the current frame. Call once per frame before the update; raylib
+// refreshes its input state in EndDrawing().
+inline InputFrame CaptureInput() {
+    InputFrame in;
+    std::memset(static_cast<void*>(&in), 0, sizeof(in));  // padding too, so unchanged frames code to nothing
+    in.dt = GetFrameTime();
+    in.wheel = GetMouseWheelMove();
+    in.mouseDelta = GetMouseDelta();
+    in.mousePosition = GetMousePosition();
+    for (int b = 0; b < kMouseButtons; ++b) {
+        if (IsMouseButtonDown(b)) in.mouseDown |= static_cast<uint8_t>(1u << b);
+        if (IsMouseButtonPressed(b)) in.mousePressed |= static_cast<uint8_t>(1u << b);
+    }
+    for (int key = 1; key < kKeyCount; ++key) {
+        if (IsKeyDown(key)) in.keysDown[key >> 3] |= static_cast<uint8_t>(1u << (key & 7));
+        if (IsKeyPressed(key)) in.keysPressed[key >> 3] |= static_cast<uint8_t>(1u << (key & 7));
+    }
+    return in;
+}
+
+// Appends trivially copyable values to a byte buffer (keyframe serialisation).
+class ByteWriter {
+  public:
+    explicit ByteWriter(std::vector<uint8_t>* out) : out_(out) { out_->clear(); }
+
+    template <typename T>
+    void Put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Put() copies raw bytes");
+        const size_t at = out_->size();
+        out_->resize(at + sizeof(T));
+        std::memcpy(out_->data() + at, &value, sizeof(T));
+    }
+
+    template <typename T>
+    void PutArray(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "PutArray() copies raw bytes");
+        Put(static_cast<uint32_t>(count));
+        const size_t at = out_->size();
+        out_->resize(at + count * sizeof(T));
+        if (count > 0) std::memcpy(out_->data() + at, values, count * sizeof(T));
+    }
+
+  private:
+    std::vector<uint8_t>* out_;
+};
+
+// XOR against `previous` (zero-extended), coded as (u16 zero run, u16 literal count,
+// literals) pairs.
+inline void DeltaEncode(const std::vector<uint8_t>& previous, const uint8_t* data, size_t size, std::vector<uint8_t>* out) {
+    out->clear();
+    const size_t overlap = std::min(previous.size(), size);
+    auto delta = [&](size_t i) { return static_cast<uint8_t>(data[i] ^ (i < overlap ? previous[i] : 0)); };
+    auto put16 = [&](size_t value) {
+        out->push_back(static_cast<uint8_t>(value & 0xff));
+        out->push_back(static_cast<uint8_t>(value >> 8));
+    };
+    size_t i = 0;
+    while (i < size) {
+        size_t zeros = 0;
+        while (i + zeros < size && zeros < 0xffff && delta(i + zeros) == 0) ++zeros;
+        i += zeros;
+        size_t literals = 0;
+        while (i + literals < size && literals < 0xffff && delta(i + literals) != 0) ++literals;
+        put16(zeros);
+        put16(literals);
+        for (size_t k = 0; k < literals; ++k) out->push_back(delta(i + k));
+        i += literals;
+    }
+}
+
+// Inverse of DeltaEncode; `previous` becomes the decoded record. False on a corrupt code.
+inline bool DeltaDecode(const uint8_t* code, size_t codeSize, size_t rawSize, std::vector<uint8_t>* previous) {
+    previous->resize(rawSize, 0);
+    uint8_t* out = previous->data();
+    size_t at = 0;
+    size_t i = 0;
+    while (i + 4 <= codeSize) {
+        const size_t zeros = code[i] | (code[i + 1] << 8);
+        const size_t literals = code[i + 2] | (code[i + 3] << 8);
+        i += 4;
+        if (at + zeros + literals > rawSize || i + literals > codeSize) return false;
+        at += zeros;
+        for (size_t k = 0; k < literals; ++k) out[at + k] ^= code[i + k];
+        at += literals;
+        i += literals;
+    }
+    return i == codeSize;
+}
+
+// Live-side log writer. Frame(), Keyframe() and Blob() only copy bytes into a queue;
+// the delta coding and file writes happen on the writer thread.
+class Recorder {
+  public:
+    Recorder() = default;
+    ~Recorder() { Close(); }
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    bool Open(const std::string& path, const char* name, uint32_t seed) {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (file_ == nullptr) return false;
+        const uint32_t nameLength = static_cast<uint32_t>(std::strlen(name));
+        const uint32_t header[4] = {kLogVersion, seed, static_cast<uint32_t>(kKeyframeInterval), nameLength};
+        std::fwrite("ARPL", 1, 4, file_);
+        std::fwrite(header, sizeof(header), 1, file_);
+        std::fwrite(name, 1, nameLength, file_);
+        stop_ = false;
+        writer_ = std::thread([this]() { WriterLoop(); });
+        return true;
+    }
+
+    bool recording() const { return file_ != nullptr; }
+
+    static bool KeyframeDue(uint32_t frame) { return (frame + 1) % kKeyframeInterval == 0; }
+
+    void Frame(uint32_t frame, const InputFrame& input) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&input);
+        Push(kRecordFrame, frame, bytes, sizeof(InputFrame));
+    }
+
+    void Keyframe(uint32_t frame, const std::vector<uint8_t>& state) { Push(kRecordKeyframe, frame, state.data(), state.size()); }
+
+    void Blob(uint32_t frame, const void* data, size_t size) { Push(kRecordBlob, frame, static_cast<const uint8_t*>(data), size); }
+
+    void Close() {
+        if (file_ == nullptr) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (writer_.joinable()) writer_.join();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+  private:
+    struct Pending {
+        uint8_t type;
+        uint32_t frame;
+        std::vector<uint8_t> bytes;
+    };
+
+    void Push(uint8_t type, uint32_t frame, const uint8_t* data, size_t size) {
+        if (file_ == nullptr) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back({type, frame, std::vector<uint8_t>(data, data + size)});
+        }
+        wake_.notify_one();
+    }
+
+    void WriterLoop() {
+        std::vector<Pending> batch;
+        std::vector<uint8_t> previousFrame;
+        std::vector<uint8_t> previousKeyframe;
+        std::vector<uint8_t> code;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            batch.swap(queue_);
+            const bool last = stop_;
+            lock.unlock();
+
+            for (Pending& record : batch) {
+                const uint32_t rawSize = static_cast<uint32_t>(record.bytes.size());
+                const uint8_t* payload = record.bytes.data();
+                size_t payloadSize = record.bytes.size();
+                if (record.type != kRecordBlob) {
+                    std::vector<uint8_t>& previous = record.type == kRecordFrame ? previousFrame : previousKeyframe;
+                    DeltaEncode(previous, record.bytes.data(), record.bytes.size(), &code);
+                    previous.swap(record.bytes);
+                    payload = code.data();
+                    payloadSize = code.size();
+                }
+                const uint32_t sizes[3] = {record.frame, rawSize, static_cast<uint32_t>(payloadSize)};
+                std::fwrite(&record.type, 1, 1, file_);
+                std::fwrite(sizes, sizeof(sizes), 1, file_);
+                if (payloadSize > 0) std::fwrite(payload, 1, payloadSize, file_);
+            }
+            batch.clear();
+            std::fflush(file_);
+
+            lock.lock();
+            if (last && queue_.empty()) return;
+        }
+    }
+
+    std::FILE* file_ = nullptr;
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<Pending> queue_;
+    bool stop_ = false;
+};
+
+struct ReplayFrame {
+    InputFrame input;
+    int keyframe = -1;              // index into Player::keyframes(), or -1
+    std::vector<int> blobs;         // indices into Player::blobs()
+};
+
+// Loads a whole log and decodes it into per-frame inputs, keyframes and blobs.
+class Player {
+  public:
+    bool Load(const std::string& path, std::string* error) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            *error = "cannot open " + path;
+            return false;
+        }
+        std::vector<uint8_t> data;
+        uint8_t chunk[1 << 16];
+        for (size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0;) data.insert(data.end(), chunk, chunk + n);
+        std::fclose(file);
+
+        size_t at = 0;
+        auto read32 = [&](uint32_t* v) {
+            if (at + 4 > data.size()) return false;
+            std::memcpy(v, data.data() + at, 4);
+            at += 4;
+            return true;
+        };
+        uint32_t version = 0, interval = 0, nameLength = 0;
+        if (data.size() < 4 || std::memcmp(data.data(), "ARPL", 4) != 0) {
+            *error = path + " is not a replay log";
+            return false;
+        }
+        at = 4;
+        if (!read32(&version) || version != kLogVersion || !read32(&seed_) || !read32(&interval) || !read32(&nameLength) ||
+            at + nameLength > data.size()) {
+            *error = path + ": unsupported or truncated header";
+            return false;
+        }
+        name_.assign(reinterpret_cast<const char*>(data.data() + at), nameLength);
+        at += nameLength;
+
+        std::vector<uint8_t> previousFrame;
+        std::vector<uint8_t> previousKeyframe;
+        while (at < data.size()) {
+            const uint8_t type = data[at++];
+            uint32_t frame = 0, rawSize = 0, codedSize = 0;
+            if (!read32(&frame) || !read32(&rawSize) || !read32(&codedSize) || at + codedSize > data.size()) break;  // torn tail
+            const uint8_t* code = data.data() + at;
+            at += codedSize;
+            if (type == kRecordFrame) {
+                if (frame != frames_.size() || rawSize != sizeof(InputFrame) || !DeltaDecode(code, codedSize, rawSize, &previousFrame)) {
+                    *error = "corrupt frame record " + std::to_string(frame);
+                    return false;
+                }
+                frames_.emplace_back();
+                std::memcpy(&frames_.back().input, previousFrame.data(), sizeof(InputFrame));
+            } else if (type == kRecordKeyframe) {
+                if (frame + 1 != frames_.size() || !DeltaDecode(code, codedSize, rawSize, &previousKeyframe)) {
+                    *error = "corrupt keyframe record " + std::to_string(frame);
+                    return false;
+                }
+                frames_.back().keyframe = static_cast<int>(keyframes_.size());
+                keyframes_.push_back(previousKeyframe);
+            } else if (type == kRecordBlob && frame + 1 == frames_.size()) {
+                frames_.back().blobs.push_back(static_cast<int>(blobs_.size()));
+                blobs_.emplace_back(code, code + codedSize);
+            }
+        }
+        return true;
+    }
+
+    uint32_t seed() const { return seed_; }
+    const std::string& name() const { return name_; }
+    const std::vector<ReplayFrame>& frames() const { return frames_; }
+    const std::vector<std::vector<uint8_t>>& keyframes() const { return keyframes_; }
+    const std::vector<std::vector<uint8_t>>& blobs() const { return blobs_; }
+
+  private:
+    uint32_t seed_ = 0;
+    std::string name_;
+    std::vector<ReplayFrame> frames_;
+    std::vector<std::vector<uint8_t>> keyframes_;
+    std::vector<std::vector<uint8_t>> blobs_;
+};
+
+struct ReplayOptions {
+    std::string recordPath;  // --record=path
+    std::string replayPath;  // --replay=path
+    std::string jsonPath;    // --json=path (replay report)
+    int slowest = 10;        // --slowest=N frames listed in the report
+};
+
+inline ReplayOptions ParseReplayArgs(int argc, char** argv) {
+    ReplayOptions options;
+    if (const char* path = astro_bench::FindArg(argc, argv, "--record")) options.recordPath = path;
+    if (const char* path = astro_bench::FindArg(argc, argv, "--replay")) options.replayPath = path;
+    if (const char* path = astro_bench::FindArg(argc, argv, "--json")) options.jsonPath = path;
+    options.slowest = std::max(1, astro_bench::IntArg(argc, argv, "--slowest", options.slowest));
+    return options;
+}
+
+// Drives update(input, blobs) over every logged frame and compares snapshot() against
+// each keyframe. Prints one JSON report: total and per-frame cost, the slowest frames
+// both as replayed and by their live frame time, and the first diverging keyframe.
+template <typename Update, typename Snapshot>
+int RunReplay(const char* name, const ReplayOptions& options, Update&& update, Snapshot&& snapshot) {
+    using Clock = std::chrono::steady_clock;
+    Player player;
+    std::string error;
+    if (!player.Load(options.replayPath, &error)) {
+        std::fprintf(stderr, "%s: %s\n", name, error.c_str());
+        return 1;
+    }
+    if (player.name() != name) std::fprintf(stderr, "%s: log was recorded by %s\n", name, player.name().c_str());
+
+    const std::vector<ReplayFrame>& frames = player.frames();
+    std::vector<float> costMs(frames.size(), 0.0f);
+    std::vector<const std::vector<uint8_t>*> blobs;
+    std::vector<uint8_t> state;
+    int checked = 0;
+    long firstMismatch = -1;
+    const Clock::time_point start = Clock::now();
+    for (size_t f = 0; f < frames.size(); ++f) {
+        blobs.clear();
+        for (int b : frames[f].blobs) blobs.push_back(&player.blobs()[static_cast<size_t>(b)]);
+        const Clock::time_point t0 = Clock::now();
+        update(frames[f].input, blobs);
+        costMs[f] = std::chrono::duration<float, std::milli>(Clock::now() - t0).count();
+        if (frames[f].keyframe >= 0) {
+            snapshot(&state);
+            ++checked;
+            if (firstMismatch < 0 && state != player.keyframes()[static_cast<size_t>(frames[f].keyframe)]) {
+                firstMismatch = static_cast<long>(f);
+            }
+        }
+    }
+    const double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    auto topFrames = [&](auto&& key) {
+        std::vector<size_t> order(frames.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        const size_t count = std::min(order.size(), static_cast<size_t>(options.slowest));
+        std::partial_sort(order.begin(), order.begin() + count, order.end(), [&](size_t a, size_t b) { return key(a) > key(b); });
+        std::string list = "[";
+        for (size_t i = 0; i < count; ++i) {
+            char item[64];
+            std::snprintf(item, sizeof(item), "%s{\"frame\":%zu,\"ms\":%.3f}", i ? "," : "", order[i], key(order[i]));
+            list += item;
+        }
+        return list + "]";
+    };
+    const std::string slowReplay = topFrames([&](size_t i) { return static_cast<double>(costMs[i]); });
+    const std::string slowLive = topFrames([&](size_t i) { return 1000.0 * frames[i].input.dt; });
+
+    std::string report = "{\"target\":\"" + std::string(name) + "\",\"frames\":" + std::to_string(frames.size());
+    char numbers[160];
+    std::snprintf(numbers, sizeof(numbers), ",\"total_ms\":%.3f,\"ms_per_frame\":%.4f,\"keyframes_checked\":%d,\"first_mismatch\":%ld",
+                  totalMs, frames.empty() ? 0.0 : totalMs / frames.size(), checked, firstMismatch);
+    report += numbers;
+    report += ",\"slowest_replayed\":" + slowReplay + ",\"slowest_live\":" + slowLive + "}\n";
+    std::fputs(report.c_str(), stdout);
+
+    if (!options.jsonPath.empty()) {
+        std::FILE* file = std::fopen(options.jsonPath.c_str(), "w");
+        if (file == nullptr) {
+            std::fprintf(stderr, "%s: cannot write %s\n", name, options.jsonPath.c_str());
+            return 1;
+        }
+        std::fputs(report.c_str(), file);
+        std::fclose(file);
+    }
+    return firstMismatch < 0 ? 0 : 2;
+}
+
+}  // namespace astro_replay
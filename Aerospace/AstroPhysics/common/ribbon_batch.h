@@ -0,0 +1,192 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace astro_render {
+
+// One glowing segment (32 bytes): a capsule of radius `width` from `a` to `b`.
+struct RibbonSegment {
+    Vector3 a;
+    float width;
+    Vector3 b;
+    Color color;
+};
+
+// Camera-facing glow ribbons for arcs, filaments and plasma channels, collected during
+// the frame and drawn in one instanced call. Each segment becomes a quad that the vertex
+// shader turns toward the eye and extends by `width` past both ends. The fragment shader
+// shades the capsule distance as a hot white core inside a coloured halo, so segments of
+// one polyline join without seams and no separate glow pass is needed. The alpha of
+// `color` scales brightness. Draw between BeginMode3D/EndMode3D; it adds light, ignores
+// the depth buffer for writes and tests against it. Unload() must run before
+// CloseWindow(). Without GL 3.3 Draw() falls back to DrawLine3D.
+class RibbonBatch {
+  public:
+    bool Init(int initialCapacity = 4096) {
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locVertex_ = rlGetLocationAttrib(shader_, "vertexPosition");
+        locStartWidth_ = rlGetLocationAttrib(shader_, "segmentStartWidth");
+        locEnd_ = rlGetLocationAttrib(shader_, "segmentEnd");
+        locColor_ = rlGetLocationAttrib(shader_, "segmentColor");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locEye_ = rlGetLocationUniform(shader_, "eye");
+
+        // x: 0 at the start, 1 at the end; y: -1..1 across.
+        static constexpr float kQuad[12] = {0.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+        static constexpr unsigned short kQuadIndices[6] = {0, 1, 2, 0, 2, 3};
+        vao_ = rlLoadVertexArray();
+        rlEnableVertexArray(vao_);
+        quadVbo_ = rlLoadVertexBuffer(kQuad, static_cast<int>(sizeof(kQuad)), false);
+        rlSetVertexAttribute(static_cast<unsigned int>(locVertex_), 3, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locVertex_));
+        ebo_ = rlLoadVertexBufferElement(kQuadIndices, static_cast<int>(sizeof(kQuadIndices)), false);
+        AllocateInstanceBuffer(std::max(1, initialCapacity));
+        rlDisableVertexArray();
+
+        ready_ = vao_ != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (instanceVbo_ != 0) rlUnloadVertexBuffer(instanceVbo_);
+        if (quadVbo_ != 0) rlUnloadVertexBuffer(quadVbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        instanceVbo_ = quadVbo_ = ebo_ = vao_ = shader_ = 0;
+        capacity_ = 0;
+        ready_ = false;
+    }
+
+    void Clear() { segments_.clear(); }
+
+    void Add(Vector3 a, Vector3 b, float width, Color color) {
+        if (color.a == 0 || width <= 0.0f) return;
+        segments_.push_back(RibbonSegment{a, width, b, color});
+    }
+
+    size_t size() const { return segments_.size(); }
+    bool ready() const { return ready_; }
+
+    // Draws everything added since Clear() with additive blending.
+    void Draw() {
+        if (segments_.empty()) return;
+        if (!ready_) {
+            for (const RibbonSegment& s : segments_) DrawLine3D(s.a, s.b, s.color);
+            return;
+        }
+        const int count = static_cast<int>(segments_.size());
+        rlDrawRenderBatchActive();
+        rlEnableVertexArray(vao_);
+        if (count > capacity_) {
+            rlUnloadVertexBuffer(instanceVbo_);
+            AllocateInstanceBuffer(std::max(count, capacity_ * 2));
+        }
+        rlUpdateVertexBuffer(instanceVbo_, segments_.data(), count * static_cast<int>(sizeof(RibbonSegment)), 0);
+
+        const Matrix modelview = rlGetMatrixModelview();
+        const Matrix mvp = MatrixMultiply(modelview, rlGetMatrixProjection());
+        const Matrix view = MatrixInvert(modelview);
+        const float eye[3] = {view.m12, view.m13, view.m14};
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        rlSetUniform(locEye_, eye, RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetBlendMode(RL_BLEND_ADDITIVE);
+        rlDisableDepthMask();
+        rlDrawVertexArrayElementsInstanced(0, 6, nullptr, count);
+        rlEnableDepthMask();
+        rlSetBlendMode(RL_BLEND_ALPHA);
+        rlDisableVertexArray();
+        rlDisableShader();
+    }
+
+  private:
+    void AllocateInstanceBuffer(int capacity) {
+        capacity_ = capacity;
+        instanceVbo_ = rlLoadVertexBuffer(nullptr, capacity_ * static_cast<int>(sizeof(RibbonSegment)), true);
+        const int stride = static_cast<int>(sizeof(RibbonSegment));
+        rlSetVertexAttribute(static_cast<unsigned int>(locStartWidth_), 4, RL_FLOAT, false, stride, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locStartWidth_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locStartWidth_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locEnd_), 3, RL_FLOAT, false, stride, static_cast<int>(offsetof(RibbonSegment, b)));
+        rlEnableVertexAttribute(static_cast<unsigned int>(locEnd_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locEnd_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locColor_), 4, RL_UNSIGNED_BYTE, true, stride,
+                             static_cast<int>(offsetof(RibbonSegment, color)));
+        rlEnableVertexAttribute(static_cast<unsigned int>(locColor_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locColor_), 1);
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec3 vertexPosition;
+in vec4 segmentStartWidth;
+in vec3 segmentEnd;
+in vec4 segmentColor;
+uniform mat4 mvp;
+uniform vec3 eye;
+out vec4 fragColor;
+out vec2 fragLocal;
+flat out float fragLength;
+void main() {
+    vec3 a = segmentStartWidth.xyz;
+    float width = segmentStartWidth.w;
+    vec3 axis = segmentEnd - a;
+    float len = length(axis);
+    vec3 dir = len > 1e-6 ? axis / len : vec3(0.0, 1.0, 0.0);
+    vec3 p = mix(a, segmentEnd, vertexPosition.x);
+    vec3 side = cross(dir, eye - p);
+    float sideLen = length(side);
+    side = sideLen > 1e-6 ? side / sideLen : normalize(cross(dir, vec3(0.0, 0.0, 1.0)) + vec3(1e-4));
+    float along = vertexPosition.x * 2.0 - 1.0;
+    p += side * vertexPosition.y * width + dir * along * width;
+    fragColor = segmentColor;
+    fragLength = len / max(width, 1e-6);
+    fragLocal = vec2(vertexPosition.x * fragLength + along, vertexPosition.y);
+    gl_Position = mvp * vec4(p, 1.0);
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+in vec2 fragLocal;
+flat in float fragLength;
+out vec4 finalColor;
+void main() {
+    float t = clamp(fragLocal.x, 0.0, fragLength);
+    vec2 d = vec2(fragLocal.x - t, fragLocal.y);
+    float r2 = dot(d, d);
+    if (r2 > 1.0) discard;
+    float core = exp(-r2 * 26.0);
+    float halo = exp(-r2 * 4.0) - exp(-4.0);
+    vec3 hot = mix(fragColor.rgb, vec3(1.0), 0.75 * core);
+    finalColor = vec4(hot * (0.55 * halo + core) * fragColor.a, 1.0);
+}
+)";
+
+    std::vector<RibbonSegment> segments_;
+    int capacity_ = 0;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int quadVbo_ = 0;
+    unsigned int ebo_ = 0;
+    unsigned int instanceVbo_ = 0;
+    int locVertex_ = -1;
+    int locStartWidth_ = -1;
+    int locEnd_ = -1;
+    int locColor_ = -1;
+    int locMvp_ = -1;
+    int locEye_ = -1;
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
@@ -0,0 +1,350 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Batched rigid bodies turning about a fixed point: free bodies about their centre of
+// mass, heavy tops about their pivot under uniform gravity along -y. Each body keeps a
+// unit quaternion (principal frame to world) and its angular momentum in the principal
+// frame, Pi, and is advanced with the Lie-Poisson splitting of Touma & Wisdom /
+// McLachlan: a half kick from the gravity torque, the free rotor as five exact
+// rotations about single principal axes (X/2 Y/2 Z Y/2 X/2), then the other half kick.
+// Every sub-step is an exact rotation of Pi and of the orientation, so |Pi| and the
+// world angular momentum of a free body are kept to round-off, the vertical momentum
+// of a top likewise, and the energy error stays bounded over long runs rather than
+// drifting. Per-body momentum and energy drift are recomputed on every Step().
+//
+// Inertia tensors are given in the model frame about the body origin (the pivot) and
+// diagonalised once by Jacobi rotations; the batch itself stores double SoA columns in
+// the principal frame and converts back to model orientation on the way out.
+
+namespace astro_rigid {
+
+// Symmetric inertia tensor; the off-diagonal entries are the products of inertia as
+// they appear in the matrix (-sum m x y, and so on).
+struct InertiaTensor {
+    double xx = 1.0, yy = 1.0, zz = 1.0;
+    double xy = 0.0, xz = 0.0, yz = 0.0;
+};
+
+// Solid box about its centre.
+inline InertiaTensor BoxInertia(double mass, Vector3 size) {
+    const double x2 = size.x * size.x, y2 = size.y * size.y, z2 = size.z * size.z;
+    InertiaTensor t;
+    t.xx = mass * (y2 + z2) / 12.0;
+    t.yy = mass * (x2 + z2) / 12.0;
+    t.zz = mass * (x2 + y2) / 12.0;
+    return t;
+}
+
+// Solid cylinder about its centre, axis along y.
+inline InertiaTensor CylinderInertia(double mass, double radius, double height) {
+    InertiaTensor t;
+    t.yy = 0.5 * mass * radius * radius;
+    t.xx = t.zz = mass * (3.0 * radius * radius + height * height) / 12.0;
+    return t;
+}
+
+// Parallel-axis theorem: the tensor about a point from which the centre of mass sits
+// at `offset`, given the tensor about the centre of mass.
+inline InertiaTensor ShiftInertia(const InertiaTensor& center, double mass, Vector3 offset) {
+    const double dx = offset.x, dy = offset.y, dz = offset.z;
+    InertiaTensor t = center;
+    t.xx += mass * (dy * dy + dz * dz);
+    t.yy += mass * (dx * dx + dz * dz);
+    t.zz += mass * (dx * dx + dy * dy);
+    t.xy -= mass * dx * dy;
+    t.xz -= mass * dx * dz;
+    t.yz -= mass * dy * dz;
+    return t;
+}
+
+struct PrincipalAxes {
+    double moments[3] = {1.0, 1.0, 1.0};
+    Quaternion frame = {0.0f, 0.0f, 0.0f, 1.0f};  // principal axes to model frame
+};
+
+// Cyclic Jacobi sweeps on the 3x3 tensor; the eigenvectors become a proper rotation.
+inline PrincipalAxes Diagonalize(const InertiaTensor& t) {
+    double a[3][3] = {{t.xx, t.xy, t.xz}, {t.xy, t.yy, t.yz}, {t.xz, t.yz, t.zz}};
+    double v[3][3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+    for (int sweep = 0; sweep < 16; ++sweep) {
+        const double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        const double diag = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+        if (off <= 1.0e-30 * diag) break;
+        for (int p = 0; p < 2; ++p) {
+            for (int q = p + 1; q < 3; ++q) {
+                if (a[p][q] == 0.0) continue;
+                const double theta = 0.5 * (a[q][q] - a[p][p]) / a[p][q];
+                const double tan = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt(tan * tan + 1.0), s = tan * c;
+                for (int k = 0; k < 3; ++k) {
+                    const double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    const double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    const double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    const double det = v[0][0] * (v[1][1] * v[2][2] - v[1][2] * v[2][1]) - v[0][1] * (v[1][0] * v[2][2] - v[1][2] * v[2][0]) +
+                       v[0][2] * (v[1][0] * v[2][1] - v[1][1] * v[2][0]);
+    if (det < 0.0) {
+        for (int k = 0; k < 3; ++k) v[k][2] = -v[k][2];
+    }
+
+    PrincipalAxes axes;
+    for (int k = 0; k < 3; ++k) axes.moments[k] = a[k][k];
+    Matrix m = MatrixIdentity();
+    m.m0 = static_cast<float>(v[0][0]);
+    m.m4 = static_cast<float>(v[0][1]);
+    m.m8 = static_cast<float>(v[0][2]);
+    m.m1 = static_cast<float>(v[1][0]);
+    m.m5 = static_cast<float>(v[1][1]);
+    m.m9 = static_cast<float>(v[1][2]);
+    m.m2 = static_cast<float>(v[2][0]);
+    m.m6 = static_cast<float>(v[2][1]);
+    m.m10 = static_cast<float>(v[2][2]);
+    axes.frame = QuaternionNormalize(QuaternionFromMatrix(m));
+    return axes;
+}
+
+struct BodyDesc {
+    InertiaTensor inertia;                            // model frame, about the body origin
+    Quaternion orientation = {0.0f, 0.0f, 0.0f, 1.0f};  // model to world
+    Vector3 angularVelocity{};                        // world frame
+    Vector3 centerOfMass{};                           // model frame from the origin; zero for a free body
+    double mass = 1.0;                                // only weighs in through the gravity torque
+};
+
+struct Drift {
+    double momentum = 0.0;  // max |L - L0| / |L0|, vertical component only for tops
+    double energy = 0.0;    // max |E - E0| / (kinetic + |potential|) at the start
+};
+
+class RigidBodyBatch {
+  public:
+    static constexpr int kParallelBodies = 512;
+
+    explicit RigidBodyBatch(double gravity = 9.81) : gravity_(gravity) {}
+
+    void Clear() {
+        for (auto* column : Columns()) column->clear();
+        frames_.clear();
+    }
+
+    void Reserve(size_t n) {
+        for (auto* column : Columns()) column->reserve(n);
+        frames_.reserve(n);
+    }
+
+    size_t size() const { return frames_.size(); }
+    double gravity() const { return gravity_; }
+
+    int Add(const BodyDesc& desc) {
+        const PrincipalAxes axes = Diagonalize(desc.inertia);
+        const Quaternion q = QuaternionNormalize(QuaternionMultiply(desc.orientation, axes.frame));
+        const Quaternion toPrincipal = QuaternionInvert(q);
+        const Vector3 omega = Vector3RotateByQuaternion(desc.angularVelocity, toPrincipal);
+        const Vector3 com = Vector3RotateByQuaternion(desc.centerOfMass, QuaternionInvert(axes.frame));
+
+        frames_.push_back(axes.frame);
+        const double norm = 1.0 / std::sqrt(static_cast<double>(q.w) * q.w + static_cast<double>(q.x) * q.x +
+                                            static_cast<double>(q.y) * q.y + static_cast<double>(q.z) * q.z);
+        qw_.push_back(q.w * norm);
+        qx_.push_back(q.x * norm);
+        qy_.push_back(q.y * norm);
+        qz_.push_back(q.z * norm);
+        px_.push_back(axes.moments[0] * omega.x);
+        py_.push_back(axes.moments[1] * omega.y);
+        pz_.push_back(axes.moments[2] * omega.z);
+        invIx_.push_back(1.0 / axes.moments[0]);
+        invIy_.push_back(1.0 / axes.moments[1]);
+        invIz_.push_back(1.0 / axes.moments[2]);
+        wx_.push_back(desc.mass * gravity_ * com.x);
+        wy_.push_back(desc.mass * gravity_ * com.y);
+        wz_.push_back(desc.mass * gravity_ * com.z);
+        const bool top = desc.mass * gravity_ * Vector3Length(desc.centerOfMass) > 0.0;
+        horizontal_.push_back(top ? 0.0 : 1.0);
+
+        const size_t n = size() - 1;
+        const Vector3d l = WorldMomentum(n);
+        lx0_.push_back(l.x);
+        ly0_.push_back(l.y);
+        lz0_.push_back(l.z);
+        lScale_.push_back(1.0 / std::max(std::sqrt(l.x * l.x + l.y * l.y + l.z * l.z), 1.0e-12));
+        double kinetic = 0.0, potential = 0.0;
+        Energy(n, &kinetic, &potential);
+        e0_.push_back(kinetic + potential);
+        eScale_.push_back(1.0 / std::max(kinetic + std::fabs(potential), 1.0e-12));
+        momentumDrift_.push_back(0.0);
+        energyDrift_.push_back(0.0);
+        return static_cast<int>(n);
+    }
+
+    // Advances every body by dt, using the shared pool once the batch is large enough.
+    void Step(double dt) {
+        const int count = static_cast<int>(size());
+        auto body = [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) StepBody(static_cast<size_t>(i), dt);
+        };
+        if (count >= kParallelBodies) {
+            astro_parallel::SharedPool().ParallelFor(count, 64, body);
+        } else {
+            body(0, count);
+        }
+    }
+
+    // Worst drift over the batch as of the last Step().
+    Drift MaxDrift() const {
+        Drift d;
+        for (size_t i = 0; i < size(); ++i) {
+            d.momentum = std::max(d.momentum, momentumDrift_[i]);
+            d.energy = std::max(d.energy, energyDrift_[i]);
+        }
+        return d;
+    }
+
+    // Model-to-world orientation.
+    Quaternion orientation(size_t i) const {
+        const Quaternion q = {static_cast<float>(qx_[i]), static_cast<float>(qy_[i]), static_cast<float>(qz_[i]), static_cast<float>(qw_[i])};
+        return QuaternionMultiply(q, QuaternionInvert(frames_[i]));
+    }
+
+    Vector3 angularMomentum(size_t i) const {
+        const Vector3d l = WorldMomentum(i);
+        return {static_cast<float>(l.x), static_cast<float>(l.y), static_cast<float>(l.z)};
+    }
+
+    Vector3 angularVelocity(size_t i) const {
+        double r[3][3];
+        Rotation(i, r);
+        const double w[3] = {px_[i] * invIx_[i], py_[i] * invIy_[i], pz_[i] * invIz_[i]};
+        return {static_cast<float>(r[0][0] * w[0] + r[0][1] * w[1] + r[0][2] * w[2]),
+                static_cast<float>(r[1][0] * w[0] + r[1][1] * w[1] + r[1][2] * w[2]),
+                static_cast<float>(r[2][0] * w[0] + r[2][1] * w[1] + r[2][2] * w[2])};
+    }
+
+  private:
+    struct Vector3d {
+        double x, y, z;
+    };
+
+    std::vector<std::vector<double>*> Columns() {
+        return {&qw_, &qx_, &qy_, &qz_, &px_, &py_, &pz_, &invIx_, &invIy_, &invIz_, &wx_, &wy_, &wz_, &horizontal_,
+                &lx0_, &ly0_, &lz0_, &lScale_, &e0_, &eScale_, &momentumDrift_, &energyDrift_};
+    }
+
+    // Principal-to-world rotation matrix of body i.
+    void Rotation(size_t i, double r[3][3]) const {
+        const double w = qw_[i], x = qx_[i], y = qy_[i], z = qz_[i];
+        r[0][0] = 1.0 - 2.0 * (y * y + z * z);
+        r[0][1] = 2.0 * (x * y - w * z);
+        r[0][2] = 2.0 * (x * z + w * y);
+        r[1][0] = 2.0 * (x * y + w * z);
+        r[1][1] = 1.0 - 2.0 * (x * x + z * z);
+        r[1][2] = 2.0 * (y * z - w * x);
+        r[2][0] = 2.0 * (x * z - w * y);
+        r[2][1] = 2.0 * (y * z + w * x);
+        r[2][2] = 1.0 - 2.0 * (x * x + y * y);
+    }
+
+    Vector3d WorldMomentum(size_t i) const {
+        double r[3][3];
+        Rotation(i, r);
+        const double p[3] = {px_[i], py_[i], pz_[i]};
+        return {r[0][0] * p[0] + r[0][1] * p[1] + r[0][2] * p[2], r[1][0] * p[0] + r[1][1] * p[1] + r[1][2] * p[2],
+                r[2][0] * p[0] + r[2][1] * p[1] + r[2][2] * p[2]};
+    }
+
+    // Kinetic energy, and the potential m g (R c).y of the centre of mass above the pivot.
+    void Energy(size_t i, double* kinetic, double* potential) const {
+        double r[3][3];
+        Rotation(i, r);
+        *kinetic = 0.5 * (px_[i] * px_[i] * invIx_[i] + py_[i] * py_[i] * invIy_[i] + pz_[i] * pz_[i] * invIz_[i]);
+        *potential = r[1][0] * wx_[i] + r[1][1] * wy_[i] + r[1][2] * wz_[i];
+    }
+
+    // Free rotation by angle h Pi_a / I_a about principal axis a: Pi turns by -theta in
+    // the body frame while the orientation turns by +theta, so R Pi is unchanged.
+    static void RotateAbout(int a, double h, double invI, double* p, double* q) {
+        const int b = (a + 1) % 3, c = (a + 2) % 3;
+        const double theta = h * p[a] * invI;
+        const double cs = std::cos(theta), sn = std::sin(theta);
+        const double pb = p[b], pc = p[c];
+        p[b] = cs * pb + sn * pc;
+        p[c] = cs * pc - sn * pb;
+        // q = (w, v) times (cos theta/2, sin theta/2 e_a).
+        const double ch = std::cos(0.5 * theta), sh = std::sin(0.5 * theta);
+        const double w = q[0], va = q[1 + a], vb = q[1 + b], vc = q[1 + c];
+        q[0] = w * ch - va * sh;
+        q[1 + a] = va * ch + w * sh;
+        q[1 + b] = vb * ch + vc * sh;
+        q[1 + c] = vc * ch - vb * sh;
+    }
+
+    // Half kick from the gravity torque c x (m g gamma), gamma = R^T (0, -1, 0).
+    void Kick(size_t i, double h, double* p, const double* q) const {
+        const double w = q[0], x = q[1], y = q[2], z = q[3];
+        const double gx = -2.0 * (x * y + w * z), gy = -(1.0 - 2.0 * (x * x + z * z)), gz = -2.0 * (y * z - w * x);
+        p[0] += h * (wy_[i] * gz - wz_[i] * gy);
+        p[1] += h * (wz_[i] * gx - wx_[i] * gz);
+        p[2] += h * (wx_[i] * gy - wy_[i] * gx);
+    }
+
+    void StepBody(size_t i, double dt) {
+        double p[3] = {px_[i], py_[i], pz_[i]};
+        double q[4] = {qw_[i], qx_[i], qy_[i], qz_[i]};
+        const double invI[3] = {invIx_[i], invIy_[i], invIz_[i]};
+        Kick(i, 0.5 * dt, p, q);
+        RotateAbout(0, 0.5 * dt, invI[0], p, q);
+        RotateAbout(1, 0.5 * dt, invI[1], p, q);
+        RotateAbout(2, dt, invI[2], p, q);
+        RotateAbout(1, 0.5 * dt, invI[1], p, q);
+        RotateAbout(0, 0.5 * dt, invI[0], p, q);
+        Kick(i, 0.5 * dt, p, q);
+        const double norm = 1.0 / std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        qw_[i] = q[0] * norm;
+        qx_[i] = q[1] * norm;
+        qy_[i] = q[2] * norm;
+        qz_[i] = q[3] * norm;
+        px_[i] = p[0];
+        py_[i] = p[1];
+        pz_[i] = p[2];
+
+        const Vector3d l = WorldMomentum(i);
+        const double dx = (l.x - lx0_[i]) * horizontal_[i], dy = l.y - ly0_[i], dz = (l.z - lz0_[i]) * horizontal_[i];
+        momentumDrift_[i] = std::sqrt(dx * dx + dy * dy + dz * dz) * lScale_[i];
+        double kinetic = 0.0, potential = 0.0;
+        Energy(i, &kinetic, &potential);
+        energyDrift_[i] = std::fabs(kinetic + potential - e0_[i]) * eScale_[i];
+    }
+
+    double gravity_;
+    std::vector<Quaternion> frames_;
+    std::vector<double> qw_, qx_, qy_, qz_;
+    std::vector<double> px_, py_, pz_;
+    std::vector<double> invIx_, invIy_, invIz_;
+    std::vector<double> wx_, wy_, wz_;  // m g times the centre of mass, principal frame
+    std::vector<double> horizontal_;    // 1 for free bodies, 0 for tops (only L.y is conserved)
+    std::vector<double> lx0_, ly0_, lz0_, lScale_, e0_, eScale_;
+    std::vector<double> momentumDrift_, energyDrift_;
+};
+
+}  // namespace astro_rigid
@@ -0,0 +1,212 @@
+#pragma once
+
+#include "particle_soa.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Rotation curves as radial lookup tables, and a disc of stars on circular orbits that
+// is advanced from them.
+//
+// A galaxy model's enclosed mass, and so its circular speed v(r) and angular speed
+// v(r) / r, depend only on radius and the model parameters. RadialTable samples such a
+// function once on a uniform grid over [0, rMax]; lookups are one multiply and a linear
+// interpolation, batched with AVX2 gathers where available. Rebuild it when the
+// parameters change.
+//
+// DiskOrbits keeps each star as (cos theta, sin theta) rather than theta, so a step is a
+// rotation by omega dt with no trigonometry: the rotation's cos/sin come from
+// half-angle polynomials, squared back up, and the pair is renormalised to first order
+// each step. A second phase pair per star rotates by one shared angle (a vertical
+// wobble, say). Steps are clamped to kMaxStep radians; anything larger aliases at frame
+// rate anyway.
+
+namespace astro_galaxy {
+
+class RadialTable {
+  public:
+    static constexpr int kSamples = 1024;
+
+    bool empty() const { return values_.empty(); }
+    float rMax() const { return rMax_; }
+
+    // values[i] = f(i * rMax / (kSamples - 1)); lookups clamp to [0, rMax].
+    template <typename F>
+    void Build(float rMax, F&& f) {
+        rMax_ = rMax;
+        scale_ = (kSamples - 1) / rMax;
+        values_.resize(kSamples);
+        for (int i = 0; i < kSamples; ++i) values_[static_cast<size_t>(i)] = f(rMax * static_cast<float>(i) / (kSamples - 1));
+    }
+
+    float operator()(float r) const {
+        const float x = std::clamp(r * scale_, 0.0f, static_cast<float>(kSamples - 1));
+        const int i = std::min(static_cast<int>(x), kSamples - 2);
+        const float f = x - static_cast<float>(i);
+        return values_[static_cast<size_t>(i)] + f * (values_[static_cast<size_t>(i) + 1] - values_[static_cast<size_t>(i)]);
+    }
+
+    // out[i] = (*this)(r[i]) for n radii.
+    void LookupBatch(const float* r, float* out, size_t n) const {
+        size_t i = 0;
+#if defined(ASTRO_SOA_AVX2)
+        const __m256 vscale = _mm256_set1_ps(scale_), top = _mm256_set1_ps(static_cast<float>(kSamples - 1));
+        const __m256i last = _mm256_set1_epi32(kSamples - 2);
+        const float* table = values_.data();
+        for (; i + 8 <= n; i += 8) {
+            const __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(r + i), vscale), _mm256_setzero_ps()), top);
+            const __m256i cell = _mm256_min_epi32(_mm256_cvttps_epi32(x), last);
+            const __m256 f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(cell));
+            const __m256 a0 = _mm256_i32gather_ps(table, cell, 4);
+            const __m256 a1 = _mm256_i32gather_ps(table + 1, cell, 4);
+            _mm256_storeu_ps(out + i, _mm256_add_ps(a0, _mm256_mul_ps(f, _mm256_sub_ps(a1, a0))));
+        }
+#endif
+        for (; i < n; ++i) out[i] = (*this)(r[i]);
+    }
+
+  private:
+    astro_soa::AlignedFloats values_;
+    float rMax_ = 1.0f;
+    float scale_ = 1.0f;
+};
+
+// Stars on circular orbits in structure-of-arrays form. `rate` scales the table's
+// angular speed per star; `height` is the amplitude of the shared-phase wobble.
+struct DiskOrbits {
+    astro_soa::AlignedFloats radius, rate, height;
+    astro_soa::AlignedFloats cosTheta, sinTheta;
+    astro_soa::AlignedFloats cosPhase, sinPhase;
+
+    size_t size() const { return radius.size(); }
+
+    void clear() {
+        for (astro_soa::AlignedFloats* a : {&radius, &rate, &height, &cosTheta, &sinTheta, &cosPhase, &sinPhase}) a->clear();
+    }
+
+    void reserve(size_t n) {
+        for (astro_soa::AlignedFloats* a : {&radius, &rate, &height, &cosTheta, &sinTheta, &cosPhase, &sinPhase}) a->reserve(n);
+    }
+
+    void push_back(float r, float theta, float rateScale, float wobbleHeight, float phase) {
+        radius.push_back(r);
+        rate.push_back(rateScale);
+        height.push_back(wobbleHeight);
+        cosTheta.push_back(std::cos(theta));
+        sinTheta.push_back(std::sin(theta));
+        cosPhase.push_back(std::cos(phase));
+        sinPhase.push_back(std::sin(phase));
+    }
+
+    void SetAngle(size_t i, float theta) {
+        cosTheta[i] = std::cos(theta);
+        sinTheta[i] = std::sin(theta);
+    }
+
+    float Angle(size_t i) const { return std::atan2(sinTheta[i], cosTheta[i]); }
+    Vector3 Position(size_t i) const { return {radius[i] * cosTheta[i], height[i] * sinPhase[i], radius[i] * sinTheta[i]}; }
+};
+
+constexpr float kMaxStep = 1.5f;   // radians per step
+constexpr int kOrbitBlock = 4096;  // stars per parallel task (a multiple of the SIMD width)
+
+// theta_i += omega(r_i) * rate_i * dt and phase_i += phaseStep for stars [begin, end).
+inline void AdvanceOrbitRange(DiskOrbits* d, const RadialTable& omega, float dt, float phaseCos, float phaseSin, size_t begin, size_t end) {
+    float* const c = d->cosTheta.data();
+    float* const s = d->sinTheta.data();
+    float* const pc = d->cosPhase.data();
+    float* const ps = d->sinPhase.data();
+    const float* const rate = d->rate.data();
+    size_t i = begin;
+
+#if defined(ASTRO_SOA_AVX2)
+    alignas(32) float w[8];
+    const __m256 vdt = _mm256_set1_ps(0.5f * dt), lim = _mm256_set1_ps(0.5f * kMaxStep), nlim = _mm256_set1_ps(-0.5f * kMaxStep);
+    const __m256 one = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f), threeHalves = _mm256_set1_ps(1.5f);
+    const __m256 k2 = _mm256_set1_ps(-1.0f / 2.0f), k4 = _mm256_set1_ps(1.0f / 24.0f), k6 = _mm256_set1_ps(-1.0f / 720.0f);
+    const __m256 k3 = _mm256_set1_ps(-1.0f / 6.0f), k5 = _mm256_set1_ps(1.0f / 120.0f), k7 = _mm256_set1_ps(-1.0f / 5040.0f);
+    const __m256 qc = _mm256_set1_ps(phaseCos), qs = _mm256_set1_ps(phaseSin);
+    for (; i + 8 <= end; i += 8) {
+        omega.LookupBatch(d->radius.data() + i, w, 8);
+        __m256 h = _mm256_mul_ps(_mm256_mul_ps(_mm256_load_ps(w), _mm256_load_ps(rate + i)), vdt);
+        h = _mm256_min_ps(_mm256_max_ps(h, nlim), lim);
+        const __m256 h2 = _mm256_mul_ps(h, h);
+        const __m256 ch = _mm256_add_ps(one, _mm256_mul_ps(h2, _mm256_add_ps(k2, _mm256_mul_ps(h2, _mm256_add_ps(k4, _mm256_mul_ps(h2, k6))))));
+        const __m256 sh = _mm256_mul_ps(h, _mm256_add_ps(one, _mm256_mul_ps(h2, _mm256_add_ps(k3, _mm256_mul_ps(h2, _mm256_add_ps(k5, _mm256_mul_ps(h2, k7)))))));
+        const __m256 rc = _mm256_sub_ps(_mm256_mul_ps(ch, ch), _mm256_mul_ps(sh, sh));
+        const __m256 rs = _mm256_mul_ps(_mm256_add_ps(sh, sh), ch);
+
+        const __m256 c0 = _mm256_load_ps(c + i), s0 = _mm256_load_ps(s + i);
+        __m256 c1 = _mm256_sub_ps(_mm256_mul_ps(c0, rc), _mm256_mul_ps(s0, rs));
+        __m256 s1 = _mm256_add_ps(_mm256_mul_ps(s0, rc), _mm256_mul_ps(c0, rs));
+        const __m256 norm = _mm256_sub_ps(threeHalves, _mm256_mul_ps(half, _mm256_add_ps(_mm256_mul_ps(c1, c1), _mm256_mul_ps(s1, s1))));
+        _mm256_store_ps(c + i, _mm256_mul_ps(c1, norm));
+        _mm256_store_ps(s + i, _mm256_mul_ps(s1, norm));
+
+        const __m256 p0 = _mm256_load_ps(pc + i), q0 = _mm256_load_ps(ps + i);
+        c1 = _mm256_sub_ps(_mm256_mul_ps(p0, qc), _mm256_mul_ps(q0, qs));
+        s1 = _mm256_add_ps(_mm256_mul_ps(q0, qc), _mm256_mul_ps(p0, qs));
+        const __m256 pnorm = _mm256_sub_ps(threeHalves, _mm256_mul_ps(half, _mm256_add_ps(_mm256_mul_ps(c1, c1), _mm256_mul_ps(s1, s1))));
+        _mm256_store_ps(pc + i, _mm256_mul_ps(c1, pnorm));
+        _mm256_store_ps(ps + i, _mm256_mul_ps(s1, pnorm));
+    }
+#endif
+
+    for (; i < end; ++i) {
+        const float h = std::clamp(0.5f * dt * omega(d->radius[i]) * rate[i], -0.5f * kMaxStep, 0.5f * kMaxStep);
+        const float h2 = h * h;
+        const float ch = 1.0f + h2 * (-1.0f / 2.0f + h2 * (1.0f / 24.0f + h2 * (-1.0f / 720.0f)));
+        const float sh = h * (1.0f + h2 * (-1.0f / 6.0f + h2 * (1.0f / 120.0f + h2 * (-1.0f / 5040.0f))));
+        const float rc = ch * ch - sh * sh;
+        const float rs = 2.0f * sh * ch;
+        float c1 = c[i] * rc - s[i] * rs;
+        float s1 = s[i] * rc + c[i] * rs;
+        float norm = 1.5f - 0.5f * (c1 * c1 + s1 * s1);
+        c[i] = c1 * norm;
+        s[i] = s1 * norm;
+        c1 = pc[i] * phaseCos - ps[i] * phaseSin;
+        s1 = ps[i] * phaseCos + pc[i] * phaseSin;
+        norm = 1.5f - 0.5f * (c1 * c1 + s1 * s1);
+        pc[i] = c1 * norm;
+        ps[i] = s1 * norm;
+    }
+}
+
+// Advances every star on the shared pool; `phaseStep` is the wobble's angle this step.
+inline void AdvanceOrbits(DiskOrbits* d, const RadialTable& omega, float dt, float phaseStep) {
+    const float phaseCos = std::cos(phaseStep), phaseSin = std::sin(phaseStep);
+    const size_t n = d->size();
+    const int blocks = static_cast<int>((n + kOrbitBlock - 1) / kOrbitBlock);
+    astro_parallel::SharedPool().ParallelFor(blocks, 1, [&](int first, int last) {
+        const size_t begin = static_cast<size_t>(first) * kOrbitBlock;
+        const size_t end = std::min(n, static_cast<size_t>(last) * kOrbitBlock);
+        AdvanceOrbitRange(d, omega, dt, phaseCos, phaseSin, begin, end);
+    });
+}
+
+// Mean tangential speed about the y axis of particles [begin, end) of `p`, in equal
+// cylindrical-radius bins over [0, rMax); `speed` is resized to `bins`. Bins with no
+// particles read 0 with a count of 0.
+inline void MeasureRotationCurve(const astro_soa::ParticleSoA& p, size_t begin, size_t end, float rMax, int bins,
+                                 std::vector<float>* speed, std::vector<int>* counts) {
+    std::vector<double> sum(static_cast<size_t>(bins), 0.0);
+    counts->assign(static_cast<size_t>(bins), 0);
+    const float scale = bins / rMax;
+    for (size_t i = begin; i < end; ++i) {
+        const float r = std::sqrt(p.x[i] * p.x[i] + p.z[i] * p.z[i]);
+        const int bin = static_cast<int>(r * scale);
+        if (bin >= bins || r <= 0.0f) continue;
+        sum[static_cast<size_t>(bin)] += (p.x[i] * p.vz[i] - p.z[i] * p.vx[i]) / r;
+        ++(*counts)[static_cast<size_t>(bin)];
+    }
+    speed->resize(static_cast<size_t>(bins));
+    for (int b = 0; b < bins; ++b) {
+        const int c = (*counts)[static_cast<size_t>(b)];
+        (*speed)[static_cast<size_t>(b)] = c > 0 ? static_cast<float>(sum[static_cast<size_t>(b)] / c) : 0.0f;
+    }
+}
+
+}  // namespace astro_galaxy
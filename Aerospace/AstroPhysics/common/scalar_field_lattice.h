@@ -0,0 +1,473 @@
+#pragma once
+
+#include "gpu_ping_pong.h"
+#include "particle_soa.h"
+#include "philox.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Real phi^4 scalar field on a periodic 2D lattice, for the Higgs demos:
+//
+//     d2phi/dt2 + gamma dphi/dt = laplacian(phi) - dV/dphi,  V = lambda/4 phi^4 - mu2/2 phi^2
+//
+// mu2 > 0 is the broken phase with vacua phi = +-sqrt(mu2 / lambda) and domain walls
+// (kinks) between them; mu2 < 0 restores the symmetry about phi = 0. Flipping the sign
+// of mu2 on a noisy symmetric field is a quench: the field falls into both vacua at
+// random and the walls it leaves behind coarsen under the damping gamma.
+//
+// Phi4Lattice steps on the CPU with a staggered leapfrog (pi = dphi/dt kept half a step
+// behind phi, the damping treated implicitly). Each row is one SIMD stencil call that
+// writes the new momentum in place and the new field into a second buffer, so a step is
+// a single pass: rows are split into blocks across the shared thread pool and the field
+// buffers swap afterwards. Phi4GpuLattice runs the same update as a fragment shader
+// ping-ponging between two float render targets (gpu_ping_pong.h); the CPU lattice stays
+// the place where states are built and edited, and the two copy between each other.
+
+namespace astro_field {
+
+using astro_soa::AlignedFloats;
+
+struct Phi4Params {
+    float lambda = 1.0f;
+    float mu2 = 1.0f;      // > 0 broken phase, < 0 symmetric
+    float damping = 0.02f;  // gamma
+
+    float vev() const { return mu2 > 0.0f ? std::sqrt(mu2 / lambda) : 0.0f; }
+};
+
+// Per-step constants of the row update, so the stencil does no divisions.
+struct Phi4Coefficients {
+    float invDx2;
+    float mu2;
+    float lambda;
+    float keep;   // (1 - gamma dt / 2) / (1 + gamma dt / 2)
+    float kick;   // dt / (1 + gamma dt / 2)
+    float dt;
+
+    static Phi4Coefficients Make(const Phi4Params& p, float dx, float dt) {
+        const float g = 0.5f * p.damping * dt;
+        return {1.0f / (dx * dx), p.mu2, p.lambda, (1.0f - g) / (1.0f + g), dt / (1.0f + g), dt};
+    }
+};
+
+// One lattice row: pi[n] advances with the stencil of mid[] between the rows up[] and
+// down[], and phiOut[n] = mid[n] + dt * pi[n]. The row wraps around at both ends.
+inline void Phi4Row(float* __restrict phiOut, float* __restrict pi, const float* __restrict up, const float* __restrict mid,
+                    const float* __restrict down, int count, const Phi4Coefficients& c) {
+    const auto cell = [&](int n, float left, float right) {
+        const float phi = mid[n];
+        const float lap = (up[n] + down[n] + left + right - 4.0f * phi) * c.invDx2;
+        const float p = c.keep * pi[n] + c.kick * (lap + (c.mu2 - c.lambda * phi * phi) * phi);
+        pi[n] = p;
+        phiOut[n] = phi + c.dt * p;
+    };
+    cell(0, mid[count - 1], mid[count > 1 ? 1 : 0]);
+    int n = 1;
+#if defined(ASTRO_SOA_AVX2)
+    const __m256 invDx2 = _mm256_set1_ps(c.invDx2), mu2 = _mm256_set1_ps(c.mu2), lambda = _mm256_set1_ps(c.lambda);
+    const __m256 keep = _mm256_set1_ps(c.keep), kick = _mm256_set1_ps(c.kick), dt = _mm256_set1_ps(c.dt), four = _mm256_set1_ps(4.0f);
+    for (; n + 8 <= count - 1; n += 8) {
+        const __m256 phi = _mm256_loadu_ps(mid + n);
+        const __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(up + n), _mm256_loadu_ps(down + n)),
+                                         _mm256_add_ps(_mm256_loadu_ps(mid + n - 1), _mm256_loadu_ps(mid + n + 1)));
+        const __m256 lap = _mm256_mul_ps(_mm256_sub_ps(sum, _mm256_mul_ps(four, phi)), invDx2);
+        const __m256 restoring = _mm256_mul_ps(_mm256_sub_ps(mu2, _mm256_mul_ps(lambda, _mm256_mul_ps(phi, phi))), phi);
+        const __m256 p = _mm256_add_ps(_mm256_mul_ps(keep, _mm256_loadu_ps(pi + n)), _mm256_mul_ps(kick, _mm256_add_ps(lap, restoring)));
+        _mm256_storeu_ps(pi + n, p);
+        _mm256_storeu_ps(phiOut + n, _mm256_add_ps(phi, _mm256_mul_ps(dt, p)));
+    }
+#elif defined(ASTRO_SOA_NEON)
+    const float32x4_t invDx2 = vdupq_n_f32(c.invDx2), mu2 = vdupq_n_f32(c.mu2), lambda = vdupq_n_f32(c.lambda);
+    const float32x4_t keep = vdupq_n_f32(c.keep), kick = vdupq_n_f32(c.kick), dt = vdupq_n_f32(c.dt);
+    for (; n + 4 <= count - 1; n += 4) {
+        const float32x4_t phi = vld1q_f32(mid + n);
+        const float32x4_t sum = vaddq_f32(vaddq_f32(vld1q_f32(up + n), vld1q_f32(down + n)), vaddq_f32(vld1q_f32(mid + n - 1), vld1q_f32(mid + n + 1)));
+        const float32x4_t lap = vmulq_f32(vmlsq_n_f32(sum, phi, 4.0f), invDx2);
+        const float32x4_t restoring = vmulq_f32(vmlsq_f32(mu2, lambda, vmulq_f32(phi, phi)), phi);
+        const float32x4_t p = vfmaq_f32(vmulq_f32(keep, vld1q_f32(pi + n)), kick, vaddq_f32(lap, restoring));
+        vst1q_f32(pi + n, p);
+        vst1q_f32(phiOut + n, vfmaq_f32(phi, dt, p));
+    }
+#endif
+    for (; n < count - 1; ++n) cell(n, mid[n - 1], mid[n + 1]);
+    if (count > 1) cell(count - 1, mid[count - 2], mid[0]);
+}
+
+struct LatticeStats {
+    double energy = 0.0;     // above the vacuum, integrated over the box
+    float meanPhi = 0.0f;
+    float meanAbsPhi = 0.0f;
+    float wallLength = 0.0f;  // total length of phi = 0 contours, from sign changes between neighbours
+};
+
+class Phi4Lattice {
+  public:
+    static constexpr float kCourant = 0.5f;  // dt / dx, under the 2D limit 1/sqrt(2)
+    static constexpr int kParallelCells = 128 * 128;
+
+    // An n x n lattice covering a periodic square of side `length`.
+    void Configure(int n, float length, const Phi4Params& params) {
+        n_ = std::max(n, 4);
+        length_ = length;
+        dx_ = length / static_cast<float>(n_);
+        params_ = params;
+        const size_t cells = static_cast<size_t>(n_) * n_;
+        phi_.assign(cells, 0.0f);
+        next_.assign(cells, 0.0f);
+        pi_.assign(cells, 0.0f);
+        time_ = 0.0;
+    }
+
+    void SetParams(const Phi4Params& params) { params_ = params; }
+
+    // phi = mean + noise and pi = noise, each uniform in [-amplitude, amplitude].
+    void Thermalize(float mean, float amplitude, uint64_t seed) {
+        const astro_random::PhiloxKey key = astro_random::SeedKey(seed);
+        ForRows([&](int begin, int end) {
+            for (size_t c = static_cast<size_t>(begin) * n_; c < static_cast<size_t>(end) * n_; ++c) {
+                phi_[c] = mean + amplitude * (2.0f * astro_random::UniformAt(key, c, 0) - 1.0f);
+                pi_[c] = amplitude * (2.0f * astro_random::UniformAt(key, c, 1) - 1.0f);
+            }
+        });
+        time_ = 0.0;
+    }
+
+    // A kink at x = -separation/2 and an antikink at +separation/2 (the lattice's x
+    // axis runs along i), boosted towards each other at `speed`, in the broken vacuum.
+    void SetKinkPair(float separation, float speed) {
+        const float v = params_.vev();
+        const float k = v * std::sqrt(0.5f * params_.lambda);
+        const float gamma = 1.0f / std::sqrt(std::max(1.0e-4f, 1.0f - speed * speed));
+        std::vector<float> rowPhi(static_cast<size_t>(n_)), rowPi(static_cast<size_t>(n_));
+        for (int i = 0; i < n_; ++i) {
+            const float x = X(i);
+            const float a = gamma * k * (x + 0.5f * separation);
+            const float b = gamma * k * (x - 0.5f * separation);
+            const float sa = 1.0f / std::cosh(a), sb = 1.0f / std::cosh(b);
+            rowPhi[static_cast<size_t>(i)] = v * (std::tanh(a) - std::tanh(b) - 1.0f);
+            rowPi[static_cast<size_t>(i)] = -speed * gamma * k * v * (sa * sa + sb * sb);
+        }
+        for (int j = 0; j < n_; ++j) {
+            std::copy(rowPhi.begin(), rowPhi.end(), phi_.begin() + static_cast<ptrdiff_t>(j) * n_);
+            std::copy(rowPi.begin(), rowPi.end(), pi_.begin() + static_cast<ptrdiff_t>(j) * n_);
+        }
+        time_ = 0.0;
+    }
+
+    // Adds a Gaussian kick to dphi/dt around (x, y).
+    void AddPulse(float x, float y, float amplitude, float width) {
+        const float inv = 1.0f / (width * width);
+        ForRows([&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                const float dy = Wrap(Y(j) - y);
+                for (int i = 0; i < n_; ++i) {
+                    const float dxw = Wrap(X(i) - x);
+                    pi_[Index(i, j)] += amplitude * std::exp(-(dxw * dxw + dy * dy) * inv);
+                }
+            }
+        });
+    }
+
+    void Step(float dt) {
+        const Phi4Coefficients c = Phi4Coefficients::Make(params_, dx_, dt);
+        ForRows([&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                const float* up = phi_.data() + static_cast<size_t>(j == 0 ? n_ - 1 : j - 1) * n_;
+                const float* down = phi_.data() + static_cast<size_t>(j == n_ - 1 ? 0 : j + 1) * n_;
+                const size_t row = static_cast<size_t>(j) * n_;
+                Phi4Row(next_.data() + row, pi_.data() + row, up, phi_.data() + row, down, n_, c);
+            }
+        });
+        phi_.swap(next_);
+        time_ += dt;
+    }
+
+    // Bilinear sample in box coordinates, x and y in [-length/2, length/2).
+    float Sample(float x, float y) const {
+        const float gx = (x + 0.5f * length_) / dx_ - 0.5f;
+        const float gy = (y + 0.5f * length_) / dx_ - 0.5f;
+        const float fx = std::floor(gx), fy = std::floor(gy);
+        const int i0 = WrapIndex(static_cast<int>(fx)), j0 = WrapIndex(static_cast<int>(fy));
+        const int i1 = WrapIndex(i0 + 1), j1 = WrapIndex(j0 + 1);
+        const float tx = gx - fx, ty = gy - fy;
+        const float a = phi_[Index(i0, j0)] + tx * (phi_[Index(i1, j0)] - phi_[Index(i0, j0)]);
+        const float b = phi_[Index(i0, j1)] + tx * (phi_[Index(i1, j1)] - phi_[Index(i0, j1)]);
+        return a + ty * (b - a);
+    }
+
+    LatticeStats Measure() const {
+        rowEnergy_.assign(static_cast<size_t>(n_), 0.0);
+        rowPhi_.assign(static_cast<size_t>(n_), 0.0);
+        rowAbs_.assign(static_cast<size_t>(n_), 0.0);
+        rowWalls_.assign(static_cast<size_t>(n_), 0);
+        const float v2 = params_.vev() * params_.vev();
+        const float vacuum = params_.mu2 > 0.0f ? -0.25f * params_.lambda * v2 * v2 : 0.0f;
+        const float invDx = 1.0f / dx_;
+        ForRows([&](int begin, int end) {
+            for (int j = begin; j < end; ++j) {
+                const int jn = j == n_ - 1 ? 0 : j + 1;
+                double e = 0.0, sum = 0.0, abs = 0.0;
+                int walls = 0;
+                for (int i = 0; i < n_; ++i) {
+                    const int in = i == n_ - 1 ? 0 : i + 1;
+                    const float phi = phi_[Index(i, j)];
+                    const float gx = (phi_[Index(in, j)] - phi) * invDx;
+                    const float gy = (phi_[Index(i, jn)] - phi) * invDx;
+                    const float p = pi_[Index(i, j)];
+                    const float phi2 = phi * phi;
+                    e += 0.5f * (p * p + gx * gx + gy * gy) + 0.25f * params_.lambda * phi2 * phi2 - 0.5f * params_.mu2 * phi2 - vacuum;
+                    sum += phi;
+                    abs += std::fabs(phi);
+                    walls += (phi < 0.0f) != (phi_[Index(in, j)] < 0.0f);
+                    walls += (phi < 0.0f) != (phi_[Index(i, jn)] < 0.0f);
+                }
+                rowEnergy_[static_cast<size_t>(j)] = e;
+                rowPhi_[static_cast<size_t>(j)] = sum;
+                rowAbs_[static_cast<size_t>(j)] = abs;
+                rowWalls_[static_cast<size_t>(j)] = walls;
+            }
+        });
+        LatticeStats stats;
+        double sum = 0.0, abs = 0.0;
+        long walls = 0;
+        for (size_t j = 0; j < rowEnergy_.size(); ++j) {
+            stats.energy += rowEnergy_[j];
+            sum += rowPhi_[j];
+            abs += rowAbs_[j];
+            walls += rowWalls_[j];
+        }
+        const double cells = static_cast<double>(n_) * n_;
+        stats.energy *= static_cast<double>(dx_) * dx_;
+        stats.meanPhi = static_cast<float>(sum / cells);
+        stats.meanAbsPhi = static_cast<float>(abs / cells);
+        // A straight wall crosses about 4/pi links per cell length at a random angle.
+        stats.wallLength = static_cast<float>(walls) * dx_ * 0.785398f;
+        return stats;
+    }
+
+    int size() const { return n_; }
+    float length() const { return length_; }
+    float dx() const { return dx_; }
+    float maxDt() const { return kCourant * dx_; }
+    double time() const { return time_; }
+    const Phi4Params& params() const { return params_; }
+    float X(int i) const { return (static_cast<float>(i) + 0.5f) * dx_ - 0.5f * length_; }
+    float Y(int j) const { return (static_cast<float>(j) + 0.5f) * dx_ - 0.5f * length_; }
+    size_t Index(int i, int j) const { return static_cast<size_t>(j) * n_ + i; }
+
+    // Row-major, n x n; writable so the GPU backend can copy its state back.
+    AlignedFloats& phi() { return phi_; }
+    AlignedFloats& pi() { return pi_; }
+    const AlignedFloats& phi() const { return phi_; }
+    const AlignedFloats& pi() const { return pi_; }
+    void SetTime(double t) { time_ = t; }
+
+  private:
+    template <typename Body>
+    void ForRows(Body&& body) const {
+        if (static_cast<size_t>(n_) * n_ < kParallelCells) {
+            body(0, n_);
+            return;
+        }
+        astro_parallel::SharedPool().ParallelFor(n_, 8, body);
+    }
+
+    float Wrap(float d) const { return d - length_ * std::round(d / length_); }
+    int WrapIndex(int i) const { return ((i % n_) + n_) % n_; }
+
+    int n_ = 0;
+    float length_ = 1.0f;
+    float dx_ = 1.0f;
+    Phi4Params params_{};
+    double time_ = 0.0;
+    AlignedFloats phi_;
+    AlignedFloats next_;
+    AlignedFloats pi_;
+    mutable std::vector<double> rowEnergy_, rowPhi_, rowAbs_;
+    mutable std::vector<int> rowWalls_;
+};
+
+// Field colours shared by the CPU texture and the GPU colour pass: orange in the +v
+// vacuum, teal in the -v vacuum, dark where the field sits near zero, and a bright
+// rim on domain walls.
+inline Color FieldColor(float phi, float vev) {
+    const float scale = 1.0f / std::max(vev, 0.5f);
+    const float s = std::clamp(phi * scale / 1.3f, -1.0f, 1.0f);
+    const float m = std::fabs(s);
+    const float wall = vev > 0.0f ? std::exp(-phi * phi * scale * scale * 8.0f) : 0.0f;
+    const float r = (s >= 0.0f ? 0.20f + 0.80f * m : 0.12f + 0.08f * m) + 0.6f * wall;
+    const float g = (s >= 0.0f ? 0.18f + 0.44f * m : 0.18f + 0.60f * m) + 0.6f * wall;
+    const float b = (s >= 0.0f ? 0.30f - 0.10f * m : 0.30f + 0.55f * m) + 0.5f * wall;
+    return {static_cast<unsigned char>(255.0f * std::min(r, 1.0f)), static_cast<unsigned char>(255.0f * std::min(g, 1.0f)),
+            static_cast<unsigned char>(255.0f * std::min(b, 1.0f)), 255};
+}
+
+// The same lattice on the GPU: phi and pi live in the red and green channels of an
+// astro_gpu::FloatPingPong and each step is one pass. Init() after InitWindow() returns
+// false without GL 3.3 or float render targets; callers then keep stepping Phi4Lattice.
+// Upload()/Download() copy the state to and from a CPU lattice of the same size,
+// ReadRow() fetches one row of phi (for probes that ride on the field) and Colorize()
+// renders FieldColor() into display(), all without touching the rest.
+class Phi4GpuLattice {
+  public:
+    bool Init(int n) {
+        Unload();
+        if (!astro_gpu::LoadPassShader(kStepShader, &stepShader_) || !astro_gpu::LoadPassShader(kColorShader, &colorShader_) ||
+            !state_.Init(n, n)) {
+            Unload();
+            return false;
+        }
+        n_ = n;
+        display_ = LoadRenderTexture(n, n);
+        SetTextureFilter(display_.texture, TEXTURE_FILTER_BILINEAR);
+        locSize_ = GetShaderLocation(stepShader_, "size");
+        locCoef_ = GetShaderLocation(stepShader_, "coef");
+        locKick_ = GetShaderLocation(stepShader_, "kick");
+        locColorSize_ = GetShaderLocation(colorShader_, "size");
+        locVev_ = GetShaderLocation(colorShader_, "vev");
+        return true;
+    }
+
+    void Unload() {
+        state_.Unload();
+        if (display_.id != 0) UnloadRenderTexture(display_);
+        display_ = RenderTexture2D{};
+        astro_gpu::UnloadPassShader(&stepShader_);
+        astro_gpu::UnloadPassShader(&colorShader_);
+    }
+
+    bool ready() const { return state_.ready(); }
+    int size() const { return n_; }
+    const Texture2D& display() const { return display_.texture; }
+
+    void Upload(const Phi4Lattice& lattice) {
+        if (!ready() || lattice.size() != n_) return;
+        staging_.resize(static_cast<size_t>(n_) * n_ * 4);
+        for (size_t c = 0, cells = static_cast<size_t>(n_) * n_; c < cells; ++c) {
+            staging_[c * 4 + 0] = lattice.phi()[c];
+            staging_[c * 4 + 1] = lattice.pi()[c];
+            staging_[c * 4 + 2] = 0.0f;
+            staging_[c * 4 + 3] = 1.0f;
+        }
+        state_.Upload(staging_.data());
+        time_ = lattice.time();
+    }
+
+    void Download(Phi4Lattice* lattice) {
+        if (!ready() || lattice->size() != n_) return;
+        staging_.resize(static_cast<size_t>(n_) * n_ * 4);
+        state_.Read(0, 0, n_, n_, staging_.data());
+        for (size_t c = 0, cells = static_cast<size_t>(n_) * n_; c < cells; ++c) {
+            lattice->phi()[c] = staging_[c * 4 + 0];
+            lattice->pi()[c] = staging_[c * 4 + 1];
+        }
+        lattice->SetTime(time_);
+    }
+
+    void Step(const Phi4Params& params, float dx, float dt, int steps) {
+        if (!ready()) return;
+        const Phi4Coefficients c = Phi4Coefficients::Make(params, dx, dt);
+        const float coef[4] = {c.invDx2, c.mu2, c.lambda, c.keep};
+        const float kick[2] = {c.kick, c.dt};
+        const float size = static_cast<float>(n_);
+        for (int s = 0; s < steps; ++s) {
+            state_.Pass(stepShader_, [&]() {
+                SetShaderValue(stepShader_, locSize_, &size, SHADER_UNIFORM_FLOAT);
+                SetShaderValue(stepShader_, locCoef_, coef, SHADER_UNIFORM_VEC4);
+                SetShaderValue(stepShader_, locKick_, kick, SHADER_UNIFORM_VEC2);
+            });
+            time_ += dt;
+        }
+    }
+
+    // phi along row j, n values.
+    void ReadRow(int j, std::vector<float>* phi) {
+        phi->resize(static_cast<size_t>(n_));
+        if (!ready()) return;
+        row_.resize(static_cast<size_t>(n_) * 4);
+        state_.Read(0, std::clamp(j, 0, n_ - 1), n_, 1, row_.data());
+        for (int i = 0; i < n_; ++i) (*phi)[static_cast<size_t>(i)] = row_[static_cast<size_t>(i) * 4];
+    }
+
+    void Colorize(float vev) {
+        if (!ready()) return;
+        const float size = static_cast<float>(n_);
+        state_.Render(display_, colorShader_, [&]() {
+            SetShaderValue(colorShader_, locColorSize_, &size, SHADER_UNIFORM_FLOAT);
+            SetShaderValue(colorShader_, locVev_, &vev, SHADER_UNIFORM_FLOAT);
+        });
+    }
+
+    double time() const { return time_; }
+
+  private:
+    static constexpr const char* kStepShader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+uniform sampler2D texture0;
+uniform float size;
+uniform vec4 coef;   // invDx2, mu2, lambda, keep
+uniform vec2 kick;   // kick, dt
+
+void main() {
+    int n = int(size);
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    vec2 here = texelFetch(texture0, p, 0).rg;
+    float left = texelFetch(texture0, ivec2((p.x + n - 1) % n, p.y), 0).r;
+    float right = texelFetch(texture0, ivec2((p.x + 1) % n, p.y), 0).r;
+    float down = texelFetch(texture0, ivec2(p.x, (p.y + n - 1) % n), 0).r;
+    float up = texelFetch(texture0, ivec2(p.x, (p.y + 1) % n), 0).r;
+    float phi = here.r;
+    float lap = (left + right + up + down - 4.0 * phi) * coef.x;
+    float pi = coef.w * here.g + kick.x * (lap + (coef.y - coef.z * phi * phi) * phi);
+    finalColor = vec4(phi + kick.y * pi, pi, 0.0, 1.0);
+}
+)";
+
+    static constexpr const char* kColorShader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+out vec4 finalColor;
+
+uniform sampler2D texture0;
+uniform float size;
+uniform float vev;
+
+void main() {
+    float phi = texelFetch(texture0, ivec2(gl_FragCoord.xy), 0).r;
+    float scale = 1.0 / max(vev, 0.5);
+    float s = clamp(phi * scale / 1.3, -1.0, 1.0);
+    float m = abs(s);
+    float wall = vev > 0.0 ? exp(-phi * phi * scale * scale * 8.0) : 0.0;
+    vec3 pos = vec3(0.20 + 0.80 * m, 0.18 + 0.44 * m, 0.30 - 0.10 * m);
+    vec3 neg = vec3(0.12 + 0.08 * m, 0.18 + 0.60 * m, 0.30 + 0.55 * m);
+    vec3 c = (s >= 0.0 ? pos : neg) + wall * vec3(0.6, 0.6, 0.5);
+    finalColor = vec4(min(c, vec3(1.0)), 1.0);
+}
+)";
+
+    int n_ = 0;
+    double time_ = 0.0;
+    astro_gpu::FloatPingPong state_;
+    RenderTexture2D display_{};
+    Shader stepShader_{};
+    Shader colorShader_{};
+    int locSize_ = -1;
+    int locCoef_ = -1;
+    int locKick_ = -1;
+    int locColorSize_ = -1;
+    int locVev_ = -1;
+    std::vector<float> staging_;
+    std::vector<float> row_;
+};
+
+}  // namespace astro_field
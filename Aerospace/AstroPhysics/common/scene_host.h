@@ -0,0 +1,291 @@
+#pragma once
+
+#include "raylib.h"
+#include "frame_capture.h"
+#include "idle_frames.h"
+#include "profiler.h"
+#include "../vision/live_controls.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Demos as scenes: one window, one GL context and one set of session resources shared
+// by any number of demos, so moving between them does not tear the window down.
+//
+// A demo's main() becomes RunStandalone(MakeXScene(), options); scene_launcher_cpp
+// links several demos built with ASTRO_SCENE_HOST (which drops their main) and hosts
+// them together. While one scene runs, the host prepares the next one in the list on a
+// worker thread and uploads its GPU resources as soon as that finishes, so Tab
+// normally lands on a scene that is already loaded. Loaded scenes stay resident up to
+// kMaxResidentScenes, least recently shown first out.
+
+namespace astro_scene {
+
+constexpr int kMaxResidentScenes = 4;
+
+// Session resources the host owns and lends to every scene.
+struct SceneContext {
+    astro_hand::LiveControlsWatcher* liveControls = nullptr;  // polled once per frame by the host
+    Font font{};                                              // the window's UI font
+    bool audioReady = false;                                  // InitAudioDevice() succeeded
+    double now = 0.0;                                         // GetTime() at the start of the frame
+};
+
+// Lifecycle, in order:
+//   Prepare()   CPU-side setup. May run on a worker thread while another scene draws,
+//               so it must not call into raylib's window, input or GL state.
+//   Init()      GPU uploads, on the main thread; false leaves the scene unloadable.
+//   Enter()     each time the scene becomes the active one.
+//   Update()    once per active frame, before BeginDrawing (render-to-texture is fine).
+//   Draw()      once per active frame, between BeginDrawing and EndDrawing.
+//   Shutdown()  frees what Init() made; runs before CloseWindow() or on eviction.
+//
+// Animating() says whether the picture would change with no input. While it is false
+// and nothing arrives, the host's IdleFramePolicy re-presents the last frame and skips
+// both Update() and Draw(); the default keeps a scene drawn every frame.
+class Scene {
+  public:
+    virtual ~Scene() = default;
+
+    virtual void Prepare() {}
+    virtual bool Init(SceneContext& ctx) = 0;
+    virtual void Enter(SceneContext& /*ctx*/) {}
+    virtual void Update(SceneContext& ctx, float dt) = 0;
+    virtual void Draw(SceneContext& ctx) = 0;
+    virtual void Shutdown() {}
+    virtual bool Animating() const { return true; }
+};
+
+using SceneFactory = std::unique_ptr<Scene> (*)();
+
+struct SceneEntry {
+    const char* name;
+    SceneFactory make;
+};
+
+struct WindowOptions {
+    const char* title = "AstroPhysics";
+    int width = 1280;
+    int height = 820;
+    unsigned int flags = 0;
+    int minWidth = 0;
+    int minHeight = 0;
+    int targetFps = 60;
+    bool audio = false;
+    bool liveControls = true;
+    astro_power::IdleOptions idle{};
+};
+
+class SceneHost {
+  public:
+    explicit SceneHost(std::vector<SceneEntry> entries) : slots_(entries.size()) {
+        for (size_t i = 0; i < entries.size(); ++i) slots_[i].entry = entries[i];
+    }
+
+    SceneHost(const SceneHost&) = delete;
+    SceneHost& operator=(const SceneHost&) = delete;
+
+    int Run(const WindowOptions& options, int first = 0) {
+        if (slots_.empty()) return 1;
+        if (options.flags != 0) SetConfigFlags(options.flags);
+        InitWindow(options.width, options.height, options.title);
+        if (options.minWidth > 0) SetWindowMinSize(options.minWidth, options.minHeight);
+        SetTargetFPS(options.targetFps);
+        if (options.audio) {
+            InitAudioDevice();
+            ctx_.audioReady = IsAudioDeviceReady();
+        }
+        ctx_.font = GetFontDefault();
+        idle_.Init(options.idle);
+        if (options.liveControls) {
+            liveControls_.Start();
+            liveControls_.ListenUdp();
+            ctx_.liveControls = &liveControls_;
+        }
+
+        const bool hosting = slots_.size() > 1;
+        if (!Activate(std::clamp(first, 0, static_cast<int>(slots_.size()) - 1))) {
+            std::fprintf(stderr, "scene %s failed to load\n", slots_[static_cast<size_t>(std::max(first, 0))].entry.name);
+            Close(options);
+            return 1;
+        }
+
+        while (!WindowShouldClose()) {
+            ctx_.now = GetTime();
+            const bool live = ctx_.liveControls != nullptr && liveControls_.Poll(ctx_.now);
+
+            if (hosting) {
+                const int count = static_cast<int>(slots_.size());
+                int target = -1;
+                if (IsKeyPressed(KEY_TAB)) {
+                    const bool back = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
+                    target = (active_ + (back ? count - 1 : 1)) % count;
+                }
+                for (int i = 0; i < std::min(count, 12); ++i) {
+                    if (IsKeyPressed(KEY_F1 + i)) target = i;
+                }
+                if (target >= 0 && target != active_) Activate(target);
+                FinishPreload();
+            }
+
+            Slot& slot = slots_[static_cast<size_t>(active_)];
+            const bool draw = idle_.BeginFrame(slot.scene->Animating() || preloading_ >= 0, live);
+            if (draw) slot.scene->Update(ctx_, GetFrameTime());
+
+            BeginDrawing();
+            if (draw) {
+                slot.scene->Draw(ctx_);
+                if (hosting) DrawHostBar();
+            }
+            idle_.EndFrame();
+            astro_capture::CaptureFrame();
+            ASTRO_PROFILE_FRAME();
+            EndDrawing();
+
+            if (hosting) StartPreload((active_ + 1) % static_cast<int>(slots_.size()));
+        }
+
+        Close(options);
+        return 0;
+    }
+
+  private:
+    enum class State { kEmpty, kPreparing, kReady, kFailed };
+
+    struct Slot {
+        SceneEntry entry{};
+        State state = State::kEmpty;
+        std::unique_ptr<Scene> scene;
+        std::future<void> prepared;
+        long lastShown = 0;
+    };
+
+    static double Millis(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    void StartPreload(int index) {
+        Slot& slot = slots_[static_cast<size_t>(index)];
+        if (slot.state != State::kEmpty || preloading_ >= 0) return;
+        slot.scene = slot.entry.make();
+        Scene* scene = slot.scene.get();
+        slot.prepared = std::async(std::launch::async, [scene]() { scene->Prepare(); });
+        slot.state = State::kPreparing;
+        preloading_ = index;
+    }
+
+    // Uploads the background-prepared scene once its worker is done; never waits.
+    void FinishPreload() {
+        if (preloading_ < 0) return;
+        Slot& slot = slots_[static_cast<size_t>(preloading_)];
+        if (slot.prepared.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+        preloading_ = -1;
+        InitSlot(slot);
+    }
+
+    bool InitSlot(Slot& slot) {
+        if (slot.prepared.valid()) slot.prepared.get();
+        const auto start = std::chrono::steady_clock::now();
+        if (!slot.scene->Init(ctx_)) {
+            slot.scene.reset();
+            slot.state = State::kFailed;
+            return false;
+        }
+        slot.state = State::kReady;
+        lastUploadMs_ = Millis(start);
+        EvictIfFull();
+        return true;
+    }
+
+    // Makes `index` active, loading it in the foreground when the preload has not got
+    // to it yet.
+    bool Activate(int index) {
+        const auto start = std::chrono::steady_clock::now();
+        Slot& slot = slots_[static_cast<size_t>(index)];
+        if (slot.state == State::kFailed) return false;
+        if (slot.state == State::kEmpty) {
+            slot.scene = slot.entry.make();
+            slot.scene->Prepare();
+            slot.state = State::kPreparing;
+        }
+        if (slot.state == State::kPreparing) {
+            if (preloading_ == index) preloading_ = -1;
+            if (!InitSlot(slot)) return false;
+        }
+        active_ = index;
+        slot.lastShown = ++frameStamp_;
+        slot.scene->Enter(ctx_);
+        lastSwitchMs_ = Millis(start);
+        SetWindowTitle(slot.entry.name);
+        return true;
+    }
+
+    void EvictIfFull() {
+        int resident = 0;
+        for (const Slot& s : slots_) resident += s.state == State::kReady ? 1 : 0;
+        while (resident > kMaxResidentScenes) {
+            Slot* oldest = nullptr;
+            for (size_t i = 0; i < slots_.size(); ++i) {
+                Slot& s = slots_[i];
+                if (s.state != State::kReady || static_cast<int>(i) == active_ || static_cast<int>(i) == preloading_) continue;
+                if (s.lastShown == 0) continue;  // a preload nobody has seen yet
+                if (oldest == nullptr || s.lastShown < oldest->lastShown) oldest = &s;
+            }
+            if (oldest == nullptr) return;
+            oldest->scene->Shutdown();
+            oldest->scene.reset();
+            oldest->state = State::kEmpty;
+            --resident;
+        }
+    }
+
+    void DrawHostBar() const {
+        const int w = GetScreenWidth();
+        const int h = GetScreenHeight();
+        const Slot& slot = slots_[static_cast<size_t>(active_)];
+        const char* next = slots_[static_cast<size_t>((active_ + 1) % static_cast<int>(slots_.size()))].state == State::kReady ? "ready" : "loading";
+        const char* text = TextFormat("[%d/%d] %s   Tab next (%s)  F1-F%d pick   switch %.1f ms  upload %.1f ms", active_ + 1,
+                                      static_cast<int>(slots_.size()), slot.entry.name, next,
+                                      std::min(12, static_cast<int>(slots_.size())), lastSwitchMs_, lastUploadMs_);
+        const int width = MeasureText(text, 16);
+        DrawRectangle(w - width - 24, h - 30, width + 16, 24, Color{0, 0, 0, 150});
+        DrawText(text, w - width - 16, h - 26, 16, Color{200, 214, 236, 255});
+    }
+
+    void Close(const WindowOptions& options) {
+        for (Slot& slot : slots_) {
+            if (slot.prepared.valid()) slot.prepared.wait();
+            if (slot.state == State::kReady) slot.scene->Shutdown();
+            slot.scene.reset();
+            slot.state = State::kEmpty;
+        }
+        liveControls_.Close();
+        idle_.Unload();
+        astro_capture::StopCapture();
+        if (options.audio && ctx_.audioReady) CloseAudioDevice();
+        CloseWindow();
+    }
+
+    std::vector<Slot> slots_;
+    SceneContext ctx_{};
+    astro_hand::LiveControlsWatcher liveControls_;
+    astro_power::IdleFramePolicy idle_;
+    int active_ = 0;
+    int preloading_ = -1;
+    long frameStamp_ = 0;
+    double lastSwitchMs_ = 0.0;
+    double lastUploadMs_ = 0.0;
+};
+
+// A demo on its own: the host with a single scene and no switching.
+inline int RunStandalone(SceneFactory make, const WindowOptions& options) {
+    SceneHost host({SceneEntry{options.title, make}});
+    return host.Run(options);
+}
+
+}  // namespace astro_scene
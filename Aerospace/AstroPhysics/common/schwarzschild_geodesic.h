@@ -0,0 +1,309 @@
+#pragma once
+
+#include "particle_soa.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Massive test particles around a Schwarzschild black hole, moved along exact timelike
+// geodesics in geometric units (G = c = M = 1: horizon r = 2, photon sphere 3, ISCO 6)
+// and stepped in the distant observer's coordinate time t.
+//
+// Each particle carries its conserved energy E and squared angular momentum L^2 and
+// moves in flat-embedding Cartesian x, with r = |x| the Schwarzschild radius. Given L,
+// the orbit in proper time is exactly
+//
+//   x'' = -x / r^3 (1 + 3 L^2 / r^2),
+//
+// which is r'' = -1/r^2 + L^2/r^3 - 3 L^2/r^4 with phi' = L/r^2 and needs no trigonometry;
+// dt/dtau = E / (1 - 2/r) turns it into coordinate time. Perihelion precession, plunges
+// inside the ISCO and capture (L < 4 for a particle falling from rest at infinity) come
+// out of the equation on their own. E also gives a drift check,
+//
+//   E^2 = |x'|^2 + 1 - 2/r - 2 L^2 / r^3.
+//
+// Particles are SoA columns padded to blocks of 8 lanes (one AVX2 register, two NEON).
+// A block shares each RK4 step, h = stepFactor r_min^1.5, shortened further inside the
+// ISCO where orbits plunge towards the horizon; blocks are spread over the shared thread
+// pool. Lanes that cross captureRadius or escapeRadius stop and are flagged for the
+// caller to respawn.
+
+namespace astro_geodesic {
+
+constexpr float kHorizonRadius = 2.0f;
+constexpr float kPhotonSphereRadius = 3.0f;
+constexpr float kIscoRadius = 6.0f;
+
+enum class Fate : uint8_t { kOrbiting, kCaptured, kEscaped };
+
+struct GeodesicOptions {
+    float stepFactor = 0.05f;  // about 125 steps per circular orbit
+    int maxSubsteps = 64;      // per Advance() and block; the last one takes the time left
+    float captureRadius = 2.05f;
+    float escapeRadius = 400.0f;
+};
+
+// Angular momentum and energy per unit mass of the circular orbit at r (> 3).
+inline float CircularAngularMomentum(float r) { return r / std::sqrt(r - 3.0f); }
+inline float CircularEnergy(float r) { return (r - 2.0f) / std::sqrt(r * (r - 3.0f)); }
+
+// Proper-time velocity of the prograde circular orbit through `pos` about `normal`
+// (which need not be unit or exactly perpendicular to pos).
+inline void CircularVelocity(const float pos[3], const float normal[3], float vel[3]) {
+    const float r = std::sqrt(pos[0] * pos[0] + pos[1] * pos[1] + pos[2] * pos[2]);
+    float t[3] = {normal[1] * pos[2] - normal[2] * pos[1], normal[2] * pos[0] - normal[0] * pos[2],
+                  normal[0] * pos[1] - normal[1] * pos[0]};
+    const float len = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+    const float speed = len > 0.0f ? CircularAngularMomentum(r) / (r * len) : 0.0f;
+    for (int k = 0; k < 3; ++k) vel[k] = t[k] * speed;
+}
+
+// Largest step for a block whose innermost moving lane sits at r.
+inline float StepLimit(float r, const GeodesicOptions& options) {
+    const float plunge = std::clamp((r - kHorizonRadius) / (kIscoRadius - kHorizonRadius), 0.2f, 1.0f);
+    return options.stepFactor * r * std::sqrt(r) * plunge;
+}
+
+class GeodesicBatch {
+  public:
+    static constexpr int kParallelParticles = 4096;
+
+    // Every lane starts parked (not moving) until Set().
+    void Resize(int count) {
+        count_ = std::max(0, count);
+        const size_t padded = (static_cast<size_t>(count_) + 7) & ~size_t{7};
+        for (astro_soa::AlignedFloats* column : {&x_, &y_, &z_, &vx_, &vy_, &vz_, &energy_, &l2_, &rate_}) column->assign(padded, 0.0f);
+        std::fill(x_.begin(), x_.end(), 1000.0f);
+        std::fill(energy_.begin(), energy_.end(), 1.0f);
+        fate_.assign(padded, Fate::kEscaped);
+    }
+
+    int size() const { return count_; }
+
+    // pos in units of M, vel = dx/dtau. Particles inside the capture radius stay parked.
+    void Set(int i, const float pos[3], const float vel[3]) {
+        const size_t n = static_cast<size_t>(i);
+        x_[n] = pos[0];
+        y_[n] = pos[1];
+        z_[n] = pos[2];
+        vx_[n] = vel[0];
+        vy_[n] = vel[1];
+        vz_[n] = vel[2];
+        const float lx = pos[1] * vel[2] - pos[2] * vel[1];
+        const float ly = pos[2] * vel[0] - pos[0] * vel[2];
+        const float lz = pos[0] * vel[1] - pos[1] * vel[0];
+        l2_[n] = lx * lx + ly * ly + lz * lz;
+        const float r = radius(i);
+        const float e2 = vel[0] * vel[0] + vel[1] * vel[1] + vel[2] * vel[2] + 1.0f - 2.0f / r - 2.0f * l2_[n] / (r * r * r);
+        energy_[n] = std::sqrt(std::max(e2, 1.0e-12f));
+        const bool outside = r > kHorizonRadius;
+        rate_[n] = outside ? 1.0f / energy_[n] : 0.0f;
+        fate_[n] = outside ? Fate::kOrbiting : Fate::kCaptured;
+    }
+
+    float x(int i) const { return x_[static_cast<size_t>(i)]; }
+    float y(int i) const { return y_[static_cast<size_t>(i)]; }
+    float z(int i) const { return z_[static_cast<size_t>(i)]; }
+    float radius(int i) const { return std::sqrt(x(i) * x(i) + y(i) * y(i) + z(i) * z(i)); }
+    float energy(int i) const { return energy_[static_cast<size_t>(i)]; }
+    float angularMomentum(int i) const { return std::sqrt(l2_[static_cast<size_t>(i)]); }
+    Fate fate(int i) const { return fate_[static_cast<size_t>(i)]; }
+
+    // Relative error of E^2 recomputed from the current state.
+    float EnergyDrift(int i) const {
+        const size_t n = static_cast<size_t>(i);
+        const double r = radius(i);
+        const double v2 = double(vx_[n]) * vx_[n] + double(vy_[n]) * vy_[n] + double(vz_[n]) * vz_[n];
+        const double e2 = double(energy_[n]) * energy_[n];
+        return static_cast<float>(std::fabs(v2 + 1.0 - 2.0 / r - 2.0 * l2_[n] / (r * r * r) - e2) / e2);
+    }
+
+    // Substeps taken by all blocks in the last Advance().
+    int substeps() const { return substeps_; }
+
+    // Moves every orbiting particle forward by dt of coordinate time.
+    void Advance(float dt, const GeodesicOptions& options) {
+        const int blocks = static_cast<int>(x_.size() / 8);
+        std::atomic<int> substeps{0};
+        auto body = [&](int begin, int end) {
+            int taken = 0;
+            for (int block = begin; block < end; ++block) taken += AdvanceBlock(dt, options, static_cast<size_t>(block) * 8);
+            substeps.fetch_add(taken, std::memory_order_relaxed);
+        };
+        if (count_ >= kParallelParticles) {
+            astro_parallel::SharedPool().ParallelFor(blocks, 32, body);
+        } else {
+            body(0, blocks);
+        }
+        substeps_ = substeps.load(std::memory_order_relaxed);
+    }
+
+  private:
+    // Innermost moving lane of the block, or a huge radius when none is moving.
+    float InnermostRadius(size_t first) const {
+        float r2 = 1.0e30f;
+        for (size_t n = first; n < first + 8; ++n) {
+            if (rate_[n] != 0.0f) r2 = std::min(r2, x_[n] * x_[n] + y_[n] * y_[n] + z_[n] * z_[n]);
+        }
+        return std::sqrt(r2);
+    }
+
+    // Eight lanes starting at `first`; returns the number of RK4 steps taken.
+    int AdvanceBlock(float dt, const GeodesicOptions& options, size_t first) {
+        float remaining = dt;
+        int steps = 0;
+        while (remaining > 0.0f) {
+            const float rMin = InnermostRadius(first);
+            if (rMin > 1.0e10f) break;
+            float h = StepLimit(rMin, options);
+            if (++steps >= options.maxSubsteps || h >= remaining) h = remaining;
+            Rk4(h, first);
+            remaining -= h;
+            Stop(options, first);
+        }
+        return steps;
+    }
+
+    // Parks lanes that have crossed the capture or escape radius.
+    void Stop(const GeodesicOptions& options, size_t first) {
+        const float capture2 = options.captureRadius * options.captureRadius;
+        const float escape2 = options.escapeRadius * options.escapeRadius;
+        for (size_t n = first; n < first + 8; ++n) {
+            if (rate_[n] == 0.0f) continue;
+            const float r2 = x_[n] * x_[n] + y_[n] * y_[n] + z_[n] * z_[n];
+            if (r2 < capture2 || r2 > escape2) {
+                rate_[n] = 0.0f;
+                fate_[n] = r2 < capture2 ? Fate::kCaptured : Fate::kEscaped;
+            }
+        }
+    }
+
+#if defined(ASTRO_SOA_AVX2)
+    struct Lanes {
+        __m256 x, y, z, vx, vy, vz;
+    };
+
+    // d/dt of the state: rate = 1/E (0 parks the lane), so dtau/dt = (1 - 2/r) rate.
+    static Lanes Derivative(const Lanes& s, __m256 rate, __m256 l2) {
+        const __m256 one = _mm256_set1_ps(1.0f), three = _mm256_set1_ps(3.0f);
+        const __m256 r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(s.x, s.x), _mm256_mul_ps(s.y, s.y)), _mm256_mul_ps(s.z, s.z));
+        const __m256 invR = _mm256_div_ps(one, _mm256_sqrt_ps(r2));
+        const __m256 invR2 = _mm256_mul_ps(invR, invR);
+        const __m256 g = _mm256_mul_ps(_mm256_max_ps(_mm256_sub_ps(one, _mm256_add_ps(invR, invR)), _mm256_setzero_ps()), rate);
+        const __m256 pull = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(invR2, invR), _mm256_add_ps(one, _mm256_mul_ps(three, _mm256_mul_ps(l2, invR2)))), g);
+        const __m256 k = _mm256_sub_ps(_mm256_setzero_ps(), pull);
+        return {_mm256_mul_ps(s.vx, g), _mm256_mul_ps(s.vy, g), _mm256_mul_ps(s.vz, g),
+                _mm256_mul_ps(s.x, k),  _mm256_mul_ps(s.y, k),  _mm256_mul_ps(s.z, k)};
+    }
+
+    static Lanes Axpy(const Lanes& s, __m256 h, const Lanes& d) {
+        return {_mm256_add_ps(s.x, _mm256_mul_ps(h, d.x)),   _mm256_add_ps(s.y, _mm256_mul_ps(h, d.y)),
+                _mm256_add_ps(s.z, _mm256_mul_ps(h, d.z)),   _mm256_add_ps(s.vx, _mm256_mul_ps(h, d.vx)),
+                _mm256_add_ps(s.vy, _mm256_mul_ps(h, d.vy)), _mm256_add_ps(s.vz, _mm256_mul_ps(h, d.vz))};
+    }
+
+    void Rk4(float step, size_t first) {
+        const __m256 rate = _mm256_load_ps(&rate_[first]), l2 = _mm256_load_ps(&l2_[first]);
+        const __m256 h = _mm256_set1_ps(step), half = _mm256_set1_ps(0.5f * step), sixth = _mm256_set1_ps(step / 6.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const Lanes s = {_mm256_load_ps(&x_[first]),  _mm256_load_ps(&y_[first]),  _mm256_load_ps(&z_[first]),
+                         _mm256_load_ps(&vx_[first]), _mm256_load_ps(&vy_[first]), _mm256_load_ps(&vz_[first])};
+        const Lanes k1 = Derivative(s, rate, l2);
+        const Lanes k2 = Derivative(Axpy(s, half, k1), rate, l2);
+        const Lanes k3 = Derivative(Axpy(s, half, k2), rate, l2);
+        const Lanes k4 = Derivative(Axpy(s, h, k3), rate, l2);
+        auto sum = [&](__m256 a, __m256 b, __m256 c, __m256 d) {
+            return _mm256_add_ps(_mm256_add_ps(a, d), _mm256_mul_ps(two, _mm256_add_ps(b, c)));
+        };
+        const Lanes d = {sum(k1.x, k2.x, k3.x, k4.x),    sum(k1.y, k2.y, k3.y, k4.y),    sum(k1.z, k2.z, k3.z, k4.z),
+                         sum(k1.vx, k2.vx, k3.vx, k4.vx), sum(k1.vy, k2.vy, k3.vy, k4.vy), sum(k1.vz, k2.vz, k3.vz, k4.vz)};
+        const Lanes next = Axpy(s, sixth, d);
+        _mm256_store_ps(&x_[first], next.x);
+        _mm256_store_ps(&y_[first], next.y);
+        _mm256_store_ps(&z_[first], next.z);
+        _mm256_store_ps(&vx_[first], next.vx);
+        _mm256_store_ps(&vy_[first], next.vy);
+        _mm256_store_ps(&vz_[first], next.vz);
+    }
+#elif defined(ASTRO_SOA_NEON)
+    struct Lanes {
+        float32x4_t x, y, z, vx, vy, vz;
+    };
+
+    static Lanes Derivative(const Lanes& s, float32x4_t rate, float32x4_t l2) {
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t r2 = vfmaq_f32(vfmaq_f32(vmulq_f32(s.x, s.x), s.y, s.y), s.z, s.z);
+        const float32x4_t invR = vdivq_f32(one, vsqrtq_f32(r2));
+        const float32x4_t invR2 = vmulq_f32(invR, invR);
+        const float32x4_t g = vmulq_f32(vmaxq_f32(vsubq_f32(one, vaddq_f32(invR, invR)), vdupq_n_f32(0.0f)), rate);
+        const float32x4_t k = vnegq_f32(vmulq_f32(vmulq_f32(vmulq_f32(invR2, invR), vfmaq_f32(one, vdupq_n_f32(3.0f), vmulq_f32(l2, invR2))), g));
+        return {vmulq_f32(s.vx, g), vmulq_f32(s.vy, g), vmulq_f32(s.vz, g), vmulq_f32(s.x, k), vmulq_f32(s.y, k), vmulq_f32(s.z, k)};
+    }
+
+    static Lanes Axpy(const Lanes& s, float32x4_t h, const Lanes& d) {
+        return {vfmaq_f32(s.x, h, d.x),   vfmaq_f32(s.y, h, d.y),   vfmaq_f32(s.z, h, d.z),
+                vfmaq_f32(s.vx, h, d.vx), vfmaq_f32(s.vy, h, d.vy), vfmaq_f32(s.vz, h, d.vz)};
+    }
+
+    void Rk4(float step, size_t first) {
+        const float32x4_t h = vdupq_n_f32(step), half = vdupq_n_f32(0.5f * step), sixth = vdupq_n_f32(step / 6.0f);
+        const float32x4_t two = vdupq_n_f32(2.0f);
+        auto sum = [&](float32x4_t a, float32x4_t b, float32x4_t c, float32x4_t d) { return vfmaq_f32(vaddq_f32(a, d), two, vaddq_f32(b, c)); };
+        for (size_t n = first; n < first + 8; n += 4) {
+            const float32x4_t rate = vld1q_f32(&rate_[n]), l2 = vld1q_f32(&l2_[n]);
+            const Lanes s = {vld1q_f32(&x_[n]), vld1q_f32(&y_[n]), vld1q_f32(&z_[n]), vld1q_f32(&vx_[n]), vld1q_f32(&vy_[n]), vld1q_f32(&vz_[n])};
+            const Lanes k1 = Derivative(s, rate, l2);
+            const Lanes k2 = Derivative(Axpy(s, half, k1), rate, l2);
+            const Lanes k3 = Derivative(Axpy(s, half, k2), rate, l2);
+            const Lanes k4 = Derivative(Axpy(s, h, k3), rate, l2);
+            const Lanes d = {sum(k1.x, k2.x, k3.x, k4.x),    sum(k1.y, k2.y, k3.y, k4.y),    sum(k1.z, k2.z, k3.z, k4.z),
+                             sum(k1.vx, k2.vx, k3.vx, k4.vx), sum(k1.vy, k2.vy, k3.vy, k4.vy), sum(k1.vz, k2.vz, k3.vz, k4.vz)};
+            const Lanes next = Axpy(s, sixth, d);
+            vst1q_f32(&x_[n], next.x);
+            vst1q_f32(&y_[n], next.y);
+            vst1q_f32(&z_[n], next.z);
+            vst1q_f32(&vx_[n], next.vx);
+            vst1q_f32(&vy_[n], next.vy);
+            vst1q_f32(&vz_[n], next.vz);
+        }
+    }
+#else
+    static void Derivative(const float s[6], float rate, float l2, float d[6]) {
+        const float r = std::sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+        const float g = std::max(1.0f - 2.0f / r, 0.0f) * rate;
+        const float k = -(1.0f + 3.0f * l2 / (r * r)) / (r * r * r) * g;
+        for (int c = 0; c < 3; ++c) {
+            d[c] = s[c + 3] * g;
+            d[c + 3] = s[c] * k;
+        }
+    }
+
+    void Rk4(float h, size_t first) {
+        float* columns[6] = {x_.data(), y_.data(), z_.data(), vx_.data(), vy_.data(), vz_.data()};
+        for (size_t n = first; n < first + 8; ++n) {
+            float s[6], t[6], k1[6], k2[6], k3[6], k4[6];
+            for (int c = 0; c < 6; ++c) s[c] = columns[c][n];
+            Derivative(s, rate_[n], l2_[n], k1);
+            for (int c = 0; c < 6; ++c) t[c] = s[c] + 0.5f * h * k1[c];
+            Derivative(t, rate_[n], l2_[n], k2);
+            for (int c = 0; c < 6; ++c) t[c] = s[c] + 0.5f * h * k2[c];
+            Derivative(t, rate_[n], l2_[n], k3);
+            for (int c = 0; c < 6; ++c) t[c] = s[c] + h * k3[c];
+            Derivative(t, rate_[n], l2_[n], k4);
+            for (int c = 0; c < 6; ++c) columns[c][n] = s[c] + h / 6.0f * (k1[c] + 2.0f * (k2[c] + k3[c]) + k4[c]);
+        }
+    }
+#endif
+
+    int count_ = 0;
+    int substeps_ = 0;
+    astro_soa::AlignedFloats x_, y_, z_, vx_, vy_, vz_;
+    astro_soa::AlignedFloats energy_, l2_, rate_;
+    std::vector<Fate> fate_;
+};
+
+}  // namespace astro_geodesic
@@ -0,0 +1,582 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Rotating shallow-water equations on an equiangular cubed sphere, in vector-invariant
+// form with the velocity held as a 3D Cartesian vector tangent to the sphere:
+//
+//   du/dt = -(zeta + f) n x u - grad(g h + |u|^2 / 2) - u / tauDrag
+//   dh/dt = -div(h u) + (hEq - h) / tauRadiative + storms
+//   dT/dt = -u . grad T + (TEq - T) / tauThermal        (passive "temperature")
+//
+// n is the outward unit normal and f = 2 Omega . n. Longitude in the demos' GlobePoint
+// convention increases from +x toward +z, so a planet turning toward the east spins
+// about -y and f = -2 omega n.y. Gradient, divergence and vorticity all come
+// from one least-squares stencil per cell over its eight neighbours, found
+// geometrically so the seams and corners between faces need no special cases. The
+// tangent-plane projection of the Cartesian gradient gives the exact surface operators
+// for tangent fields, and no metric terms appear. Those operators are not exact adjoints
+// on the irregular stencils, so the collocated scheme has weakly growing grid-scale
+// modes; a biharmonic filter built from the neighbour-mean Laplacian removes them while
+// barely touching the large scales. Time stepping is SSP-RK3. Each stage updates the six
+// faces as separate tasks on the shared thread pool.
+//
+// A zonally forced shallow layer settles into steady, stable jets, so weather is stirred
+// by storm cells: Gaussian mass sinks (lows) and sources (highs) in the mid-latitudes
+// that ramp up and down over a few time units while drifting with the local wind.
+//
+// Units: sphere radius 1, Omega 1 (a day is 2 pi), mean depth 1.
+
+namespace astro_weather {
+
+struct ShallowWaterConfig {
+    int faceCells = 48;              // cells along a face edge; 6 n^2 cells in total
+    float gravity = 0.2f;            // gravity wave speed sqrt(g) for unit depth
+    float omega = 1.0f;
+    float equatorPoleContrast = 0.6f;  // hEq = 1 + contrast (1/3 - sin^2 lat) + ...
+    float dayNightContrast = 0.05f;    // ... + contrast cos(lat) cos(lon - sun)
+    float tauRadiative = 8.0f;
+    float tauThermal = 6.0f;
+    float tauDrag = 24.0f;
+    float hyperFilter = 5.0f;         // biharmonic damping rate of the grid-scale mode
+    float maxStep = 0.03f;
+    int stormCount = 14;
+    float stormDepthRate = 0.2f;      // peak depth change per unit time at a storm centre
+};
+
+// A storm cell: strength < 0 removes mass (a cyclone), > 0 adds it.
+struct StormCell {
+    Vector3 center{1.0f, 0.0f, 0.0f};
+    float radius = 0.1f;
+    float strength = -1.0f;
+    float age = 0.0f;
+    float life = 1.0f;
+    float Envelope() const { return std::sin(PI * std::clamp(age / life, 0.0f, 1.0f)); }
+};
+
+// Field values at a point: eastward/northward speed, depth, temperature in [0, 1].
+struct SurfaceSample {
+    float east = 0.0f;
+    float north = 0.0f;
+    float depth = 1.0f;
+    float temperature = 0.5f;
+};
+
+class ShallowWaterSolver {
+  public:
+    static constexpr int kNeighbours = 8;
+
+    void Configure(const ShallowWaterConfig& config, uint32_t seed = 1) {
+        config_ = config;
+        n_ = std::max(4, config.faceCells);
+        BuildGrid();
+        Reset(seed);
+    }
+
+    // Start from rest at the radiative equilibrium depth plus small random bumps, so
+    // the jets form by geostrophic adjustment and then go unstable on their own.
+    void Reset(uint32_t seed) {
+        SetTime(0.0f);
+        pending_ = 0.0f;
+        const size_t cells = size();
+        cur_.Resize(cells);
+        rng_ = seed * 747796405u + 2891336453u;
+        std::array<Vector3, 12> bumps{};
+        for (Vector3& b : bumps) {
+            const float z = 2.0f * Random() - 1.0f;
+            const float phi = 2.0f * PI * Random();
+            const float s = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            b = {s * std::cos(phi), z, s * std::sin(phi)};
+        }
+        storms_.assign(static_cast<size_t>(std::max(0, config_.stormCount)), StormCell{});
+        for (StormCell& storm : storms_) {
+            SpawnStorm(&storm);
+            storm.age = Random() * storm.life;  // staggered, so they do not all start together
+        }
+        UpdateStorms(0.0f);
+        for (size_t c = 0; c < cells; ++c) {
+            float bump = 0.0f;
+            for (size_t k = 0; k < bumps.size(); ++k) {
+                const float d = Vector3DotProduct(pos_[c], bumps[k]);
+                bump += ((k & 1) ? -0.012f : 0.012f) * std::exp(-(1.0f - d) * 40.0f);
+            }
+            cur_.h[c] = EquilibriumDepth(c) + bump;
+            cur_.t[c] = EquilibriumTemperature(c);
+        }
+    }
+
+    // Advances in fixed maxStep steps; the remainder of dt carries over to the next call,
+    // so a frame-rate caller pays for simulated time rather than for frames.
+    void Step(float dt) {
+        if (dt <= 0.0f) return;
+        pending_ += dt;
+        while (pending_ >= config_.maxStep) {
+            StepRk3(config_.maxStep);
+            UpdateStorms(config_.maxStep);
+            pending_ -= config_.maxStep;
+        }
+    }
+
+    size_t size() const { return pos_.size(); }
+    int faceCells() const { return n_; }
+    float time() const { return time_; }
+    Vector3 position(size_t c) const { return pos_[c]; }
+    Vector3 velocity(size_t c) const { return {cur_.ux[c], cur_.uy[c], cur_.uz[c]}; }
+    float depth(size_t c) const { return cur_.h[c]; }
+    float temperature(size_t c) const { return cur_.t[c]; }
+    float SunLongitude() const { return -config_.omega * time_; }
+    const std::vector<StormCell>& storms() const { return storms_; }
+
+    // Cell containing the unit vector p.
+    size_t Locate(Vector3 p) const {
+        int face = 0;
+        float a = 0.0f, b = 0.0f;
+        FaceCoords(p, &face, &a, &b);
+        return CellIndex(face, CellOf(a), CellOf(b));
+    }
+
+    // Bilinear sample at the unit vector p. Near a face edge the stencil is clamped to
+    // the face, which is within a cell of the true value.
+    SurfaceSample Sample(Vector3 p) const {
+        std::array<size_t, 4> cells{};
+        std::array<float, 4> weights{};
+        Stencil(p, &cells, &weights);
+        Vector3 u = {0.0f, 0.0f, 0.0f};
+        SurfaceSample s{0.0f, 0.0f, 0.0f, 0.0f};
+        for (int k = 0; k < 4; ++k) {
+            const size_t c = cells[static_cast<size_t>(k)];
+            const float w = weights[static_cast<size_t>(k)];
+            u = Vector3Add(u, Vector3Scale(velocity(c), w));
+            s.depth += w * cur_.h[c];
+            s.temperature += w * cur_.t[c];
+        }
+        const Vector3 east = Vector3Normalize(Vector3{-p.z, 0.0f, p.x});
+        const Vector3 north = Vector3CrossProduct(east, p);
+        s.east = Vector3DotProduct(u, east);
+        s.north = Vector3DotProduct(u, north);
+        return s;
+    }
+
+    // Four cells and bilinear weights around the unit vector p.
+    void Stencil(Vector3 p, std::array<size_t, 4>* cells, std::array<float, 4>* weights) const {
+        int face = 0;
+        float a = 0.0f, b = 0.0f;
+        FaceCoords(p, &face, &a, &b);
+        const float x = std::clamp((a + kQuarterPi) / step_ - 0.5f, 0.0f, static_cast<float>(n_ - 1));
+        const float y = std::clamp((b + kQuarterPi) / step_ - 0.5f, 0.0f, static_cast<float>(n_ - 1));
+        const int i = std::min(static_cast<int>(x), n_ - 2);
+        const int j = std::min(static_cast<int>(y), n_ - 2);
+        const float fx = x - static_cast<float>(i);
+        const float fy = y - static_cast<float>(j);
+        *cells = {CellIndex(face, i, j), CellIndex(face, i + 1, j), CellIndex(face, i, j + 1), CellIndex(face, i + 1, j + 1)};
+        *weights = {(1.0f - fx) * (1.0f - fy), fx * (1.0f - fy), (1.0f - fx) * fy, fx * fy};
+    }
+
+    // Kinetic energy and mass, for checks.
+    double TotalEnergy() const {
+        double e = 0.0;
+        for (size_t c = 0; c < size(); ++c) {
+            const double u2 = Vector3DotProduct(velocity(c), velocity(c));
+            e += area_[c] * (0.5 * cur_.h[c] * u2 + 0.5 * config_.gravity * cur_.h[c] * cur_.h[c]);
+        }
+        return e;
+    }
+    double TotalMass() const {
+        double m = 0.0;
+        for (size_t c = 0; c < size(); ++c) m += area_[c] * cur_.h[c];
+        return m;
+    }
+
+    // Overwrites the state, e.g. with an analytic test flow.
+    void SetCell(size_t c, float depth, Vector3 velocity, float temperature) {
+        const Vector3 n = pos_[c];
+        const Vector3 u = Vector3Subtract(velocity, Vector3Scale(n, Vector3DotProduct(velocity, n)));
+        cur_.h[c] = depth;
+        cur_.ux[c] = u.x;
+        cur_.uy[c] = u.y;
+        cur_.uz[c] = u.z;
+        cur_.t[c] = temperature;
+    }
+
+  private:
+    static constexpr float kQuarterPi = 0.25f * PI;
+
+    struct Face {
+        Vector3 normal;
+        Vector3 a;
+        Vector3 b;
+    };
+    static constexpr std::array<Face, 6> kFaces = {{
+        {{1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+        {{-1, 0, 0}, {0, 0, -1}, {0, 1, 0}},
+        {{0, 1, 0}, {1, 0, 0}, {0, 0, 1}},
+        {{0, -1, 0}, {1, 0, 0}, {0, 0, -1}},
+        {{0, 0, 1}, {-1, 0, 0}, {0, 1, 0}},
+        {{0, 0, -1}, {1, 0, 0}, {0, 1, 0}},
+    }};
+
+    struct Fields {
+        std::vector<float> h, ux, uy, uz, t;
+        void Resize(size_t n) {
+            for (auto* f : {&h, &ux, &uy, &uz, &t}) f->assign(n, 0.0f);
+        }
+    };
+
+    size_t CellIndex(int face, int i, int j) const {
+        return (static_cast<size_t>(face) * n_ + static_cast<size_t>(j)) * n_ + static_cast<size_t>(i);
+    }
+    int CellOf(float angle) const { return std::clamp(static_cast<int>((angle + kQuarterPi) / step_), 0, n_ - 1); }
+
+    static void FaceCoords(Vector3 p, int* face, float* a, float* b) {
+        const float ax = std::fabs(p.x), ay = std::fabs(p.y), az = std::fabs(p.z);
+        if (ax >= ay && ax >= az) {
+            *face = p.x > 0.0f ? 0 : 1;
+        } else if (ay >= az) {
+            *face = p.y > 0.0f ? 2 : 3;
+        } else {
+            *face = p.z > 0.0f ? 4 : 5;
+        }
+        const Face& f = kFaces[static_cast<size_t>(*face)];
+        const float d = Vector3DotProduct(p, f.normal);
+        *a = std::atan(Vector3DotProduct(p, f.a) / d);
+        *b = std::atan(Vector3DotProduct(p, f.b) / d);
+    }
+
+    // Face point at equiangular coordinates (a, b); valid a little past the face edge.
+    static Vector3 FacePoint(int face, float a, float b) {
+        const Face& f = kFaces[static_cast<size_t>(face)];
+        return Vector3Normalize(Vector3Add(f.normal, Vector3Add(Vector3Scale(f.a, std::tan(a)), Vector3Scale(f.b, std::tan(b)))));
+    }
+
+    float CellAngle(int i) const { return -kQuarterPi + (static_cast<float>(i) + 0.5f) * step_; }
+
+    void BuildGrid() {
+        step_ = 2.0f * kQuarterPi / static_cast<float>(n_);
+        const size_t cells = static_cast<size_t>(6) * n_ * n_;
+        pos_.resize(cells);
+        area_.resize(cells);
+        depthBase_.resize(cells);
+        temperatureBase_.resize(cells);
+        neighbours_.assign(cells * kNeighbours, 0);
+        neighbourCount_.assign(cells, 0);
+        weights_.assign(cells * kNeighbours, Vector3{0.0f, 0.0f, 0.0f});
+        for (int face = 0; face < 6; ++face) {
+            for (int j = 0; j < n_; ++j) {
+                for (int i = 0; i < n_; ++i) {
+                    const size_t c = CellIndex(face, i, j);
+                    pos_[c] = FacePoint(face, CellAngle(i), CellAngle(j));
+                    // Solid angle of the cell is ~ step^2 / (cos^2 a cos^2 b (1 + tan^2 a + tan^2 b)^1.5).
+                    const float ta = std::tan(CellAngle(i)), tb = std::tan(CellAngle(j));
+                    const float r2 = 1.0f + ta * ta + tb * tb;
+                    area_[c] = step_ * step_ * (1.0f + ta * ta) * (1.0f + tb * tb) / (r2 * std::sqrt(r2));
+                    const float sinLat = pos_[c].y;
+                    depthBase_[c] = 1.0f + config_.equatorPoleContrast * (1.0f / 3.0f - sinLat * sinLat);
+                    temperatureBase_[c] = 1.0f - std::pow(std::fabs(std::asin(sinLat)) / (0.5f * PI), 1.28f);
+                }
+            }
+        }
+        for (int face = 0; face < 6; ++face) {
+            for (int j = 0; j < n_; ++j) {
+                for (int i = 0; i < n_; ++i) BuildStencil(face, i, j);
+            }
+        }
+    }
+
+    // Neighbours are the cells under the eight surrounding cell centres of this face's
+    // coordinate grid, extended past the edge; near cube corners two of them coincide.
+    void BuildStencil(int face, int i, int j) {
+        const size_t c = CellIndex(face, i, j);
+        const Vector3 n = pos_[c];
+        size_t* nb = &neighbours_[c * kNeighbours];
+        int count = 0;
+        for (int dj = -1; dj <= 1; ++dj) {
+            for (int di = -1; di <= 1; ++di) {
+                if (di == 0 && dj == 0) continue;
+                const size_t k = Locate(FacePoint(face, CellAngle(i + di), CellAngle(j + dj)));
+                if (k == c || std::find(nb, nb + count, k) != nb + count) continue;
+                nb[count++] = k;
+            }
+        }
+        neighbourCount_[c] = count;
+
+        // Least-squares gradient in the tangent plane: grad f = sum_k w_k (f_k - f_c),
+        // with w_k = M^-1 d_k expressed back as a 3D tangent vector.
+        const Vector3 e1 = Vector3Normalize(Vector3Subtract(kFaces[static_cast<size_t>(face)].a,
+                                                            Vector3Scale(n, Vector3DotProduct(kFaces[static_cast<size_t>(face)].a, n))));
+        const Vector3 e2 = Vector3CrossProduct(n, e1);
+        float m11 = 0.0f, m12 = 0.0f, m22 = 0.0f;
+        std::array<Vector2, kNeighbours> d{};
+        for (int k = 0; k < count; ++k) {
+            const Vector3 delta = Vector3Subtract(pos_[nb[k]], n);
+            d[static_cast<size_t>(k)] = {Vector3DotProduct(delta, e1), Vector3DotProduct(delta, e2)};
+            m11 += d[static_cast<size_t>(k)].x * d[static_cast<size_t>(k)].x;
+            m12 += d[static_cast<size_t>(k)].x * d[static_cast<size_t>(k)].y;
+            m22 += d[static_cast<size_t>(k)].y * d[static_cast<size_t>(k)].y;
+        }
+        const float det = m11 * m22 - m12 * m12;
+        for (int k = 0; k < count; ++k) {
+            const Vector2 dk = d[static_cast<size_t>(k)];
+            const float w1 = (m22 * dk.x - m12 * dk.y) / det;
+            const float w2 = (m11 * dk.y - m12 * dk.x) / det;
+            weights_[c * kNeighbours + static_cast<size_t>(k)] = Vector3Add(Vector3Scale(e1, w1), Vector3Scale(e2, w2));
+        }
+    }
+
+    // cos(lat) cos(lon - sun) from the cell position: p.x = cos lat cos lon, p.z = cos lat sin lon.
+    float Daylight(size_t c) const { return pos_[c].x * sunCos_ + pos_[c].z * sunSin_; }
+
+    float EquilibriumDepth(size_t c) const { return depthBase_[c] + config_.dayNightContrast * Daylight(c); }
+    float EquilibriumTemperature(size_t c) const { return std::clamp(temperatureBase_[c] + 0.15f * Daylight(c), 0.0f, 1.0f); }
+
+    void SetTime(float t) {
+        time_ = t;
+        sunCos_ = std::cos(SunLongitude());
+        sunSin_ = std::sin(SunLongitude());
+    }
+
+    // Neighbour mean minus the cell value, per field, for the cells of one face.
+    void Laplacian(const Fields& s, int face, Fields* out) const {
+        const size_t begin = CellIndex(face, 0, 0);
+        const size_t end = begin + static_cast<size_t>(n_) * n_;
+        const auto pass = [&](const std::vector<float>& f, std::vector<float>* of) {
+            for (size_t c = begin; c < end; ++c) {
+                const int count = neighbourCount_[c];
+                float sum = 0.0f;
+                for (int k = 0; k < count; ++k) sum += f[neighbours_[c * kNeighbours + static_cast<size_t>(k)]];
+                (*of)[c] = sum / static_cast<float>(count) - f[c];
+            }
+        };
+        pass(s.h, &out->h);
+        pass(s.ux, &out->ux);
+        pass(s.uy, &out->uy);
+        pass(s.uz, &out->uz);
+        pass(s.t, &out->t);
+    }
+
+    // Right-hand side for the cells of one face; `lap` holds Laplacian() of s.
+    void Tendency(const Fields& s, const Fields& lap, int face, Fields* out) const {
+        const float g = config_.gravity;
+        const size_t begin = CellIndex(face, 0, 0);
+        const size_t end = begin + static_cast<size_t>(n_) * n_;
+        for (size_t c = begin; c < end; ++c) {
+            const Vector3 n = pos_[c];
+            const Vector3 u = {s.ux[c], s.uy[c], s.uz[c]};
+            const float bc = g * s.h[c] + 0.5f * Vector3DotProduct(u, u);
+            const Vector3 fluxC = Vector3Scale(u, s.h[c]);
+            Vector3 gradB = {0.0f, 0.0f, 0.0f};
+            Vector3 gradT = {0.0f, 0.0f, 0.0f};
+            Vector3 lapU = {0.0f, 0.0f, 0.0f};
+            float divFlux = 0.0f, vorticity = 0.0f, lapH = 0.0f, lapT = 0.0f;
+            const int count = neighbourCount_[c];
+            for (int k = 0; k < count; ++k) {
+                const size_t nb = neighbours_[c * kNeighbours + static_cast<size_t>(k)];
+                const Vector3 w = weights_[c * kNeighbours + static_cast<size_t>(k)];
+                const Vector3 uk = {s.ux[nb], s.uy[nb], s.uz[nb]};
+                const float bk = g * s.h[nb] + 0.5f * Vector3DotProduct(uk, uk);
+                gradB = Vector3Add(gradB, Vector3Scale(w, bk - bc));
+                gradT = Vector3Add(gradT, Vector3Scale(w, s.t[nb] - s.t[c]));
+                divFlux += Vector3DotProduct(w, Vector3Subtract(Vector3Scale(uk, s.h[nb]), fluxC));
+                vorticity += Vector3DotProduct(Vector3CrossProduct(n, w), Vector3Subtract(uk, u));
+                lapU = Vector3Add(lapU, Vector3{lap.ux[nb], lap.uy[nb], lap.uz[nb]});
+                lapH += lap.h[nb];
+                lapT += lap.t[nb];
+            }
+            const float inv = 1.0f / static_cast<float>(count);
+            const float filter = -config_.hyperFilter;
+            lapU = Vector3Subtract(Vector3Scale(lapU, inv), Vector3{lap.ux[c], lap.uy[c], lap.uz[c]});
+            lapH = lapH * inv - lap.h[c];
+            lapT = lapT * inv - lap.t[c];
+            const float absVorticity = vorticity - 2.0f * config_.omega * n.y;
+            Vector3 du = Vector3Scale(Vector3CrossProduct(n, u), -absVorticity);
+            du = Vector3Subtract(du, gradB);
+            du = Vector3Subtract(du, Vector3Scale(u, 1.0f / config_.tauDrag));
+            du = Vector3Add(du, Vector3Scale(lapU, filter));
+            du = Vector3Subtract(du, Vector3Scale(n, Vector3DotProduct(du, n)));
+            out->ux[c] = du.x;
+            out->uy[c] = du.y;
+            out->uz[c] = du.z;
+            out->h[c] = -divFlux + (EquilibriumDepth(c) - s.h[c]) / config_.tauRadiative + filter * lapH + StormForcing(n);
+            out->t[c] = -Vector3DotProduct(u, gradT) + (EquilibriumTemperature(c) - s.t[c]) / config_.tauThermal +
+                        filter * lapT;
+        }
+    }
+
+    // out = a * x + b * (y + dt * k), cell by cell within one face.
+    void Combine(int face, float a, const Fields& x, float b, const Fields& y, float dt, const Fields& k, Fields* out) const {
+        const size_t begin = CellIndex(face, 0, 0);
+        const size_t end = begin + static_cast<size_t>(n_) * n_;
+        const auto blend = [&](const std::vector<float>& xf, const std::vector<float>& yf, const std::vector<float>& kf,
+                               std::vector<float>* of) {
+            for (size_t c = begin; c < end; ++c) (*of)[c] = a * xf[c] + b * (yf[c] + dt * kf[c]);
+        };
+        blend(x.h, y.h, k.h, &out->h);
+        blend(x.ux, y.ux, k.ux, &out->ux);
+        blend(x.uy, y.uy, k.uy, &out->uy);
+        blend(x.uz, y.uz, k.uz, &out->uz);
+        blend(x.t, y.t, k.t, &out->t);
+    }
+
+    float Random() {
+        rng_ = rng_ * 1664525u + 1013904223u;
+        return static_cast<float>(rng_ >> 8) / 16777216.0f;
+    }
+
+    // Mid-latitude position (15 to 70 degrees, either hemisphere), mostly lows.
+    void SpawnStorm(StormCell* storm) {
+        const float sinLat = std::sin((15.0f + 55.0f * Random()) * DEG2RAD) * (Random() < 0.5f ? -1.0f : 1.0f);
+        const float cosLat = std::sqrt(1.0f - sinLat * sinLat);
+        const float lon = 2.0f * PI * Random();
+        storm->center = {cosLat * std::cos(lon), sinLat, cosLat * std::sin(lon)};
+        storm->radius = 0.08f + 0.06f * Random();
+        storm->strength = Random() < 0.7f ? -1.0f : 1.0f;
+        storm->age = 0.0f;
+        storm->life = 2.0f + 3.0f * Random();
+    }
+
+    void UpdateStorms(float dt) {
+        stormRates_.resize(storms_.size());
+        for (size_t k = 0; k < storms_.size(); ++k) {
+            StormCell& storm = storms_[k];
+            storm.age += dt;
+            if (storm.age >= storm.life) SpawnStorm(&storm);
+            const SurfaceSample wind = Sample(storm.center);
+            const Vector3 east = Vector3Normalize(Vector3{-storm.center.z, 0.0f, storm.center.x});
+            const Vector3 north = Vector3CrossProduct(east, storm.center);
+            const Vector3 u = Vector3Add(Vector3Scale(east, wind.east), Vector3Scale(north, wind.north));
+            storm.center = Vector3Normalize(Vector3Add(storm.center, Vector3Scale(u, dt)));
+            stormRates_[k] = config_.stormDepthRate * storm.strength * storm.Envelope();
+        }
+    }
+
+    // Depth tendency of all storm cells at unit position n, cut off beyond three radii.
+    float StormForcing(Vector3 n) const {
+        float rate = 0.0f;
+        for (size_t k = 0; k < stormRates_.size(); ++k) {
+            const StormCell& storm = storms_[k];
+            const float gap = 1.0f - Vector3DotProduct(n, storm.center);  // ~ distance^2 / 2
+            const float r2 = storm.radius * storm.radius;
+            if (gap > 4.5f * r2) continue;
+            rate += stormRates_[k] * std::exp(-gap / r2);
+        }
+        return rate;
+    }
+
+    // Shu-Osher SSP-RK3. Every stage is a tendency pass then a combine pass, each split
+    // into one task per face; the tendency of a face reads its neighbours' stage values.
+    void StepRk3(float dt) {
+        const size_t cells = size();
+        if (stage1_.h.size() != cells) {
+            stage1_.Resize(cells);
+            stage2_.Resize(cells);
+            rate_.Resize(cells);
+            lap_.Resize(cells);
+        }
+        astro_parallel::ThreadPool& pool = astro_parallel::SharedPool();
+        const float t0 = time_;
+        // out = a * cur + b * (in + dt * rate(in)), with the forcing evaluated at time t.
+        const auto stage = [&](const Fields& in, float t, float a, float b, Fields* out) {
+            SetTime(t);
+            pool.Run(6, [&](int face) { Laplacian(in, face, &lap_); });
+            pool.Run(6, [&](int face) { Tendency(in, lap_, face, &rate_); });
+            pool.Run(6, [&](int face) { Combine(face, a, cur_, b, in, dt, rate_, out); });
+        };
+        stage(cur_, t0, 0.0f, 1.0f, &stage1_);
+        stage(stage1_, t0 + dt, 0.75f, 0.25f, &stage2_);
+        stage(stage2_, t0 + 0.5f * dt, 1.0f / 3.0f, 2.0f / 3.0f, &stage1_);
+        std::swap(cur_, stage1_);
+        SetTime(t0 + dt);
+    }
+
+    ShallowWaterConfig config_;
+    int n_ = 0;
+    float step_ = 0.0f;
+    float time_ = 0.0f;
+    float pending_ = 0.0f;
+    float sunCos_ = 1.0f;
+    float sunSin_ = 0.0f;
+    std::vector<Vector3> pos_;
+    std::vector<float> area_;
+    std::vector<float> depthBase_;        // equilibrium depth without the day-night term
+    std::vector<float> temperatureBase_;  // likewise for temperature
+    std::vector<size_t> neighbours_;
+    std::vector<int> neighbourCount_;
+    std::vector<Vector3> weights_;
+    Fields cur_, stage1_, stage2_, rate_, lap_;
+    std::vector<StormCell> storms_;
+    std::vector<float> stormRates_;
+    uint32_t rng_ = 1;
+};
+
+// Resamples the solver onto a longitude-latitude texture, RGBA = (eastward speed,
+// northward speed, temperature, depth). Texel (i, j) sits at longitude -pi + (i + 0.5)
+// 2 pi / width and latitude -pi/2 + (j + 0.5) pi / height, so a shader reads it at
+// uv = (lon / 2 pi + 0.5, lat / pi + 0.5). The bilinear stencils are built once.
+class EquirectBaker {
+  public:
+    void Configure(const ShallowWaterSolver& solver, int width, int height) {
+        width_ = width;
+        height_ = height;
+        const size_t texels = static_cast<size_t>(width) * height;
+        cells_.resize(texels);
+        weights_.resize(texels);
+        east_.resize(texels);
+        north_.resize(texels);
+        pixels_.assign(texels * 4, 0.0f);
+        for (int j = 0; j < height; ++j) {
+            const float lat = -0.5f * PI + (static_cast<float>(j) + 0.5f) * PI / static_cast<float>(height);
+            for (int i = 0; i < width; ++i) {
+                const float lon = -PI + (static_cast<float>(i) + 0.5f) * 2.0f * PI / static_cast<float>(width);
+                const size_t t = static_cast<size_t>(j) * width + static_cast<size_t>(i);
+                const Vector3 p = {std::cos(lat) * std::cos(lon), std::sin(lat), std::cos(lat) * std::sin(lon)};
+                solver.Stencil(p, &cells_[t], &weights_[t]);
+                east_[t] = {-std::sin(lon), 0.0f, std::cos(lon)};
+                north_[t] = Vector3CrossProduct(east_[t], p);
+            }
+        }
+    }
+
+    // Fills pixels() from the solver's current state, rows split across the thread pool.
+    void Bake(const ShallowWaterSolver& solver) {
+        astro_parallel::SharedPool().ParallelFor(height_, 8, [&](int begin, int end) {
+            for (size_t t = static_cast<size_t>(begin) * width_; t < static_cast<size_t>(end) * width_; ++t) {
+                Vector3 u = {0.0f, 0.0f, 0.0f};
+                float depth = 0.0f, temperature = 0.0f;
+                for (size_t k = 0; k < 4; ++k) {
+                    const size_t c = cells_[t][k];
+                    const float w = weights_[t][k];
+                    u = Vector3Add(u, Vector3Scale(solver.velocity(c), w));
+                    depth += w * solver.depth(c);
+                    temperature += w * solver.temperature(c);
+                }
+                float* out = &pixels_[t * 4];
+                out[0] = Vector3DotProduct(u, east_[t]);
+                out[1] = Vector3DotProduct(u, north_[t]);
+                out[2] = temperature;
+                out[3] = depth;
+            }
+        });
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const std::vector<float>& pixels() const { return pixels_; }
+
+  private:
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<std::array<size_t, 4>> cells_;
+    std::vector<std::array<float, 4>> weights_;
+    std::vector<Vector3> east_;
+    std::vector<Vector3> north_;
+    std::vector<float> pixels_;
+};
+
+}  // namespace astro_weather
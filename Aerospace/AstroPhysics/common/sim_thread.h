@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Simulation on its own thread at a fixed step, decoupled from the frame rate.
+//
+// The thread owns the State and steps it `rate` times per simulated second; time scale
+// sets how many simulated seconds pass per wall second. After each batch of steps it
+// fills a Snapshot (whatever the renderer needs, through `publish`) and publishes it.
+// The renderer's Sample() returns the two newest snapshots and how far to blend between
+// them: drawing one publish interval behind the newest makes motion continuous at any
+// display rate, whatever the simulation rate is. When the steps cannot keep up, the
+// owed time is dropped rather than accumulated, so the simulation slows down instead of
+// spiralling, and the frame rate is not affected.
+//
+// Snapshots live in a small pool: the two the renderer holds since its last Sample()
+// and the two newest are never reused, so neither side copies under the lock or waits
+// on the other.
+
+namespace astro_sim {
+
+template <typename State, typename Snapshot>
+class SimThread {
+  public:
+    using StepFn = std::function<void(State&, float)>;
+    using PublishFn = std::function<void(const State&, Snapshot&)>;
+    using Command = std::function<void(State&)>;
+
+    struct Frame {
+        const Snapshot* previous = nullptr;
+        const Snapshot* current = nullptr;
+        float alpha = 1.0f;  // 0 draws `previous`, 1 draws `current`
+    };
+
+    SimThread() = default;
+    ~SimThread() { Stop(); }
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    // Takes `state` and steps it at 1/rate simulated seconds per step, at most
+    // maxStepsPerWake steps for each 1/rate wall seconds of real time.
+    void Start(State state, float rate, StepFn step, PublishFn publish, int maxStepsPerWake = 8) {
+        Stop();
+        state_ = std::move(state);
+        rate_ = rate;
+        step_ = std::move(step);
+        publish_ = std::move(publish);
+        maxStepsPerWake_ = std::max(1, maxStepsPerWake);
+        for (Slot& slot : slots_) slot.stamp = 0.0;
+        newest_ = previous_ = held_[0] = held_[1] = -1;
+        Publish(true);
+        stop_.store(false);
+        thread_ = std::thread([this]() { Loop(); });
+    }
+
+    void Stop() {
+        stop_.store(true);
+        if (thread_.joinable()) thread_.join();
+    }
+
+    // Simulated seconds per wall second; 0 pauses.
+    void SetTimeScale(float scale) { timeScale_.store(std::max(0.0f, scale)); }
+    float timeScale() const { return timeScale_.load(); }
+
+    // Runs `command` on the simulation thread before its next step.
+    void Post(Command command) { Queue(std::move(command), false); }
+
+    // As Post(), for edits that make the state discontinuous (resets, new presets):
+    // the renderer jumps to the result instead of blending into it.
+    void Reset(Command command) { Queue(std::move(command), true); }
+
+    // Render side: the two newest snapshots and the blend between them for now. The
+    // pointers stay valid until the next Sample().
+    Frame Sample() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_[0] = previous_;
+        held_[1] = newest_;
+        Frame frame;
+        if (newest_ < 0) return frame;
+        const Slot& cur = slots_[static_cast<size_t>(newest_)];
+        const Slot& prev = slots_[static_cast<size_t>(previous_)];
+        frame.current = &cur.snapshot;
+        frame.previous = &prev.snapshot;
+        const double interval = cur.stamp - prev.stamp;
+        if (interval > 0.0) frame.alpha = static_cast<float>(std::clamp((Now() - cur.stamp) / interval, 0.0, 1.0));
+        return frame;
+    }
+
+    // Steps taken so far, and the share of wall time the stepping used lately.
+    uint64_t steps() const { return steps_.load(); }
+    float load() const { return load_.load(); }
+
+  private:
+    struct Slot {
+        Snapshot snapshot{};
+        double stamp = 0.0;
+    };
+
+    static double Now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void Queue(Command command, bool jump) {
+        std::lock_guard<std::mutex> lock(commandMutex_);
+        commands_.push_back(std::move(command));
+        jump_ = jump_ || jump;
+    }
+
+    void Loop() {
+        using Clock = std::chrono::steady_clock;
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate_));
+        const float dt = 1.0f / rate_;
+        std::vector<Command> commands;
+        Clock::time_point next = Clock::now();
+        double owed = 0.0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            next += period;
+            std::this_thread::sleep_until(next);
+
+            bool jump = false;
+            {
+                std::lock_guard<std::mutex> lock(commandMutex_);
+                commands.swap(commands_);
+                jump = jump_;
+                jump_ = false;
+            }
+            for (Command& command : commands) command(state_);
+            const bool edited = !commands.empty();
+            commands.clear();
+
+            owed += timeScale_.load(std::memory_order_relaxed);
+            int count = static_cast<int>(owed);
+            if (count > maxStepsPerWake_) {
+                count = maxStepsPerWake_;
+                owed = 0.0;
+            } else {
+                owed -= count;
+            }
+
+            const Clock::time_point begin = Clock::now();
+            for (int i = 0; i < count; ++i) step_(state_, dt);
+            steps_.fetch_add(static_cast<uint64_t>(count), std::memory_order_relaxed);
+            if (count > 0 || edited) Publish(jump);
+
+            const Clock::time_point end = Clock::now();
+            const float busy = std::chrono::duration<float>(end - begin).count() * rate_;
+            load_.store(0.95f * load_.load(std::memory_order_relaxed) + 0.05f * busy, std::memory_order_relaxed);
+            // Behind by more than a period: drop the backlog instead of bursting.
+            if (end - next > period) next = end;
+        }
+    }
+
+    void Publish(bool jump) {
+        int free = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int i = 0; i < static_cast<int>(slots_.size()); ++i) {
+                if (i != newest_ && i != previous_ && i != held_[0] && i != held_[1]) {
+                    free = i;
+                    break;
+                }
+            }
+        }
+        Slot& slot = slots_[static_cast<size_t>(free)];
+        publish_(state_, slot.snapshot);
+        slot.stamp = Now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        previous_ = (jump || newest_ < 0) ? free : newest_;
+        newest_ = free;
+    }
+
+    State state_{};
+    float rate_ = 60.0f;
+    StepFn step_;
+    PublishFn publish_;
+    int maxStepsPerWake_ = 8;
+
+    std::array<Slot, 5> slots_{};
+    std::mutex mutex_;
+    int newest_ = -1;
+    int previous_ = -1;
+    std::array<int, 2> held_{{-1, -1}};
+
+    std::mutex commandMutex_;
+    std::vector<Command> commands_;
+    bool jump_ = false;
+
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::atomic<float> timeScale_{1.0f};
+    std::atomic<uint64_t> steps_{0};
+    std::atomic<float> load_{0.0f};
+};
+
+}  // namespace astro_sim
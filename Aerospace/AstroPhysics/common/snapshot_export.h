@@ -0,0 +1,375 @@
+#pragma once
+
+#include "raylib.h"
+
+#include "cli_args.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Particle-state snapshots for offline analysis. A demo hands over position, velocity,
+// mass and id every `every` steps; the bytes are encoded and written on a background
+// thread, so the simulation only pays for copying its arrays into one of two buffers.
+// When both buffers are still waiting for the disk the snapshot is skipped and counted
+// instead of blocking the step. Due() and Capture() belong to the simulation thread.
+//
+//   astro_snapshot::SnapshotWriter snapshots;
+//   snapshots.Open(astro_snapshot::SnapshotOptions::FromArgs(argc, argv), "demo", &error);
+//   if (snapshots.Due(step)) snapshots.Capture(step, time, n, [&](astro_snapshot::SnapshotFrame& f) {
+//       for (size_t i = 0; i < n; ++i) f.Set(i, id[i], mass[i], pos[i], vel[i]);
+//   });
+//   ...
+//   astro_snapshot::CloseSnapshots(&snapshots, "demo");
+//
+// A step is due once it reaches the next multiple of `every` after the last snapshot,
+// so a paused scene is not written twice and a tick of several steps cannot jump over
+// the cadence. A step count that goes backwards (a reset) is due at once.
+//
+// File layout, little-endian, every array at a 16-byte boundary so a reader can view
+// it in place (snapshot_reader.py does this with numpy.memmap):
+//   header (64 B): "ASNP", u32 version, u32 encoding, u32 name length, char name[48]
+//   chunks, each starting on a 64-byte boundary:
+//     ChunkHeader (96 B), u32 id[n], f32 mass[n], pos[n][3], vel[n][3]
+//   index: IndexEntry (32 B) per chunk
+//   footer (16 B): u64 index offset, u32 chunk count, "ASNI"
+// pos and vel are f32, or with --snapshot-quantize u16 per component scaled to the
+// chunk's bounding box (value = origin + q * scale), which halves the file and keeps
+// the error to half a step of scale. A run killed before Close() has no index; the
+// chunk headers alone are enough to walk the file.
+namespace astro_snapshot {
+
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kChunkAlign = 64;
+constexpr size_t kArrayAlign = 16;
+
+enum class Encoding : uint32_t { kFloat32 = 0, kQuantized16 = 1 };
+
+struct SnapshotOptions {
+    std::string path;
+    int every = 10;
+    Encoding encoding = Encoding::kFloat32;
+
+    bool enabled() const { return !path.empty(); }
+
+    // --snapshot=path, --snapshot-every=N (steps), --snapshot-quantize
+    static SnapshotOptions FromArgs(int argc, char** argv) {
+        SnapshotOptions o;
+        if (const char* path = astro_bench::FindArg(argc, argv, "--snapshot")) o.path = path;
+        o.every = std::max(1, astro_bench::IntArg(argc, argv, "--snapshot-every", o.every));
+        if (astro_bench::HasFlag(argc, argv, "--snapshot-quantize")) o.encoding = Encoding::kQuantized16;
+        return o;
+    }
+};
+
+struct ChunkHeader {
+    char magic[4];
+    uint32_t count;
+    uint64_t step;
+    double time;
+    float posOrigin[3];
+    float posScale[3];
+    float velOrigin[3];
+    float velScale[3];
+    uint32_t massOffset;  // array offsets from the start of the chunk; ids follow the header
+    uint32_t posOffset;
+    uint32_t velOffset;
+    uint32_t bytes;  // whole chunk, header and padding included
+    uint32_t reserved[2];
+};
+
+struct IndexEntry {
+    uint64_t offset;
+    uint64_t step;
+    double time;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ChunkHeader) == 96, "ChunkHeader is part of the file format");
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry is part of the file format");
+
+// One snapshot as the simulation fills it; positions and velocities interleaved xyz.
+struct SnapshotFrame {
+    uint64_t step = 0;
+    double time = 0.0;
+    std::vector<uint32_t> id;
+    std::vector<float> mass;
+    std::vector<float> pos;
+    std::vector<float> vel;
+
+    size_t size() const { return id.size(); }
+
+    void Resize(size_t n) {
+        id.resize(n);
+        mass.resize(n);
+        pos.resize(3 * n);
+        vel.resize(3 * n);
+    }
+
+    void Set(size_t i, uint32_t particleId, float particleMass, Vector3 p, Vector3 v) {
+        id[i] = particleId;
+        mass[i] = particleMass;
+        pos[3 * i] = p.x;
+        pos[3 * i + 1] = p.y;
+        pos[3 * i + 2] = p.z;
+        vel[3 * i] = v.x;
+        vel[3 * i + 1] = v.y;
+        vel[3 * i + 2] = v.z;
+    }
+};
+
+class SnapshotWriter {
+  public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter() { Close(); }
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Does nothing and returns true when the options name no file.
+    bool Open(const SnapshotOptions& options, const char* name, std::string* error) {
+        Close();
+        if (!options.enabled()) return true;
+        file_ = std::fopen(options.path.c_str(), "wb");
+        if (file_ == nullptr) {
+            if (error != nullptr) *error = "cannot write " + options.path;
+            return false;
+        }
+        path_ = options.path;
+        every_ = static_cast<uint64_t>(std::max(1, options.every));
+        nextStep_ = lastStep_ = 0;
+        encoding_ = options.encoding;
+        char header[64] = {'A', 'S', 'N', 'P'};
+        const uint32_t nameLength = static_cast<uint32_t>(std::min<size_t>(std::strlen(name), 48));
+        const uint32_t fields[3] = {kFormatVersion, static_cast<uint32_t>(encoding_), nameLength};
+        std::memcpy(header + 4, fields, sizeof(fields));
+        std::memcpy(header + 16, name, nameLength);
+        offset_ = 0;
+        failed_ = false;
+        Write(header, sizeof(header));
+        index_.clear();
+        written_ = skipped_ = 0;
+        free_ = {&buffers_[0], &buffers_[1]};
+        queue_.clear();
+        stop_ = false;
+        writer_ = std::thread([this]() { WriterLoop(); });
+        return true;
+    }
+
+    bool open() const { return file_ != nullptr; }
+    bool Due(uint64_t step) const { return file_ != nullptr && (step >= nextStep_ || step < lastStep_); }
+
+    // A free buffer sized for `count` particles, or nullptr (and a skipped snapshot)
+    // when both are still queued for the disk.
+    SnapshotFrame* Acquire(uint64_t step, double time, size_t count) {
+        if (file_ == nullptr) return nullptr;
+        lastStep_ = step;
+        nextStep_ = (step / every_ + 1) * every_;
+        SnapshotFrame* frame = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_.empty()) {
+                ++skipped_;
+                return nullptr;
+            }
+            frame = free_.back();
+            free_.pop_back();
+        }
+        frame->step = step;
+        frame->time = time;
+        frame->Resize(count);
+        return frame;
+    }
+
+    void Submit(SnapshotFrame* frame) {
+        if (frame == nullptr) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(frame);
+        }
+        wake_.notify_one();
+    }
+
+    // Acquire(), fill(SnapshotFrame&), Submit(); false when the snapshot was skipped.
+    template <typename Fill>
+    bool Capture(uint64_t step, double time, size_t count, Fill&& fill) {
+        SnapshotFrame* frame = Acquire(step, time, count);
+        if (frame == nullptr) return false;
+        fill(*frame);
+        Submit(frame);
+        return true;
+    }
+
+    // Writes what is queued, then the index and footer. False if any write failed.
+    bool Close(std::string* error = nullptr) {
+        if (file_ == nullptr) return true;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (writer_.joinable()) writer_.join();
+        Pad(kChunkAlign);
+        const uint64_t indexOffset = offset_;
+        if (!index_.empty()) Write(index_.data(), index_.size() * sizeof(IndexEntry));
+        char footer[16] = {};
+        const uint32_t chunks = static_cast<uint32_t>(index_.size());
+        std::memcpy(footer, &indexOffset, sizeof(indexOffset));
+        std::memcpy(footer + 8, &chunks, sizeof(chunks));
+        std::memcpy(footer + 12, "ASNI", 4);
+        Write(footer, sizeof(footer));
+        if (std::fclose(file_) != 0) failed_ = true;
+        file_ = nullptr;
+        if (failed_ && error != nullptr) *error = "snapshot write failed";
+        return !failed_;
+    }
+
+    const std::string& path() const { return path_; }
+    size_t written() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return written_;
+    }
+    size_t skipped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return skipped_;
+    }
+
+  private:
+    static size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+    void Write(const void* data, size_t size) {
+        if (size > 0 && std::fwrite(data, 1, size, file_) != size) failed_ = true;
+        offset_ += size;
+    }
+
+    void Pad(size_t alignment) {
+        static const char kZeros[kChunkAlign] = {};
+        Write(kZeros, AlignUp(offset_, alignment) - offset_);
+    }
+
+    void WriterLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            SnapshotFrame* frame = queue_.front();
+            queue_.pop_front();
+            lock.unlock();
+            WriteChunk(*frame);
+            lock.lock();
+            free_.push_back(frame);
+            ++written_;
+        }
+    }
+
+    // Per-axis box of interleaved xyz values and the u16 step that spans it.
+    static void QuantizeRange(const std::vector<float>& xyz, float origin[3], float scale[3]) {
+        for (int axis = 0; axis < 3; ++axis) {
+            float lo = xyz.empty() ? 0.0f : xyz[axis];
+            float hi = lo;
+            for (size_t i = axis + 3; i < xyz.size(); i += 3) {
+                lo = std::min(lo, xyz[i]);
+                hi = std::max(hi, xyz[i]);
+            }
+            origin[axis] = lo;
+            scale[axis] = (hi - lo) / 65535.0f;
+        }
+    }
+
+    static void Quantize(const std::vector<float>& xyz, const float origin[3], const float scale[3], uint16_t* out) {
+        for (size_t i = 0; i < xyz.size(); ++i) {
+            const int axis = static_cast<int>(i % 3);
+            const float q = scale[axis] > 0.0f ? (xyz[i] - origin[axis]) / scale[axis] : 0.0f;
+            out[i] = static_cast<uint16_t>(std::clamp(std::lround(q), 0L, 65535L));
+        }
+    }
+
+    void WriteChunk(const SnapshotFrame& frame) {
+        const size_t n = frame.size();
+        const bool quantized = encoding_ == Encoding::kQuantized16;
+        const size_t vectorBytes = 3 * n * (quantized ? sizeof(uint16_t) : sizeof(float));
+
+        ChunkHeader header{};
+        std::memcpy(header.magic, "ASNC", 4);
+        header.count = static_cast<uint32_t>(n);
+        header.step = frame.step;
+        header.time = frame.time;
+        header.massOffset = static_cast<uint32_t>(AlignUp(sizeof(ChunkHeader) + n * sizeof(uint32_t), kArrayAlign));
+        header.posOffset = static_cast<uint32_t>(AlignUp(header.massOffset + n * sizeof(float), kArrayAlign));
+        header.velOffset = static_cast<uint32_t>(AlignUp(header.posOffset + vectorBytes, kArrayAlign));
+        header.bytes = static_cast<uint32_t>(header.velOffset + vectorBytes);
+        if (quantized) {
+            QuantizeRange(frame.pos, header.posOrigin, header.posScale);
+            QuantizeRange(frame.vel, header.velOrigin, header.velScale);
+        } else {
+            std::fill(std::begin(header.posScale), std::end(header.posScale), 1.0f);
+            std::fill(std::begin(header.velScale), std::end(header.velScale), 1.0f);
+        }
+
+        chunk_.assign(header.bytes, 0);
+        uint8_t* base = chunk_.data();
+        std::memcpy(base, &header, sizeof(header));
+        if (n > 0) {
+            std::memcpy(base + sizeof(ChunkHeader), frame.id.data(), n * sizeof(uint32_t));
+            std::memcpy(base + header.massOffset, frame.mass.data(), n * sizeof(float));
+            if (quantized) {
+                quantized_.resize(3 * n);
+                Quantize(frame.pos, header.posOrigin, header.posScale, quantized_.data());
+                std::memcpy(base + header.posOffset, quantized_.data(), vectorBytes);
+                Quantize(frame.vel, header.velOrigin, header.velScale, quantized_.data());
+                std::memcpy(base + header.velOffset, quantized_.data(), vectorBytes);
+            } else {
+                std::memcpy(base + header.posOffset, frame.pos.data(), vectorBytes);
+                std::memcpy(base + header.velOffset, frame.vel.data(), vectorBytes);
+            }
+        }
+
+        Pad(kChunkAlign);
+        index_.push_back({offset_, frame.step, frame.time, header.count, 0});
+        Write(chunk_.data(), chunk_.size());
+        std::fflush(file_);
+    }
+
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    uint64_t every_ = 1;
+    uint64_t nextStep_ = 0;
+    uint64_t lastStep_ = 0;
+    Encoding encoding_ = Encoding::kFloat32;
+    uint64_t offset_ = 0;
+    bool failed_ = false;
+    std::vector<IndexEntry> index_;
+    std::vector<uint8_t> chunk_;
+    std::vector<uint16_t> quantized_;
+
+    SnapshotFrame buffers_[2];
+    std::vector<SnapshotFrame*> free_;
+    std::deque<SnapshotFrame*> queue_;
+    size_t written_ = 0;
+    size_t skipped_ = 0;
+    std::thread writer_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+// Close() plus a one-line report on stderr; for the end of a demo's main.
+inline bool CloseSnapshots(SnapshotWriter* writer, const char* name) {
+    if (!writer->open()) return true;
+    std::string error;
+    const bool ok = writer->Close(&error);
+    std::fprintf(stderr, "%s: %zu snapshots written to %s, %zu skipped%s%s\n", name, writer->written(), writer->path().c_str(),
+                 writer->skipped(), ok ? "" : ", ", ok ? "" : error.c_str());
+    return ok;
+}
+
+}  // namespace astro_snapshot
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace astro_sheet {
+
+// Colour of one family of sheet lines: base + gain * glow, where glow is 1 on the flat
+// sheet and fades to 0 at `depth` below (or above) it.
+struct LineStyle {
+    Color base;
+    Color gain;
+};
+
+// Square "rubber sheet" height field over [-extent, extent]^2 with grid x grid
+// vertices. A frame fills the heights once per vertex (Fill, AddWell, Apply, then
+// ScaleClamp) and Draw() streams both line families from that cache in one RL_LINES
+// batch, instead of re-evaluating every vertex for each line direction.
+//
+// Grid coordinates are tabulated once in Configure(), and AddWell() splits the
+// distance into a per-column and a per-row term, so a point well costs one sqrt and
+// one divide per vertex. Large grids are split by rows across the shared thread pool;
+// do not fill a sheet from inside a pool task.
+class SpacetimeSheet {
+  public:
+    // Sheets with fewer vertices than this are filled on the calling thread.
+    static constexpr int kParallelVertices = 128 * 128;
+
+    void Configure(int grid, float extent) {
+        grid = std::max(grid, 2);
+        if (grid == grid_ && extent == extent_) return;
+        grid_ = grid;
+        extent_ = extent;
+        coords_.resize(grid_);
+        for (int i = 0; i < grid_; ++i) {
+            coords_[i] = -extent_ + 2.0f * extent_ * static_cast<float>(i) / static_cast<float>(grid_ - 1);
+        }
+        heights_.assign(static_cast<size_t>(grid_) * grid_, 0.0f);
+        columnTerm_.resize(grid_);
+    }
+
+    int grid() const { return grid_; }
+    float extent() const { return extent_; }
+    // x of column i and z of row i share one table.
+    float Coordinate(int i) const { return coords_[i]; }
+    float Height(int row, int column) const { return heights_[static_cast<size_t>(row) * grid_ + column]; }
+
+    void Fill(float height) { std::fill(heights_.begin(), heights_.end(), height); }
+
+    // h += -strength / sqrt(dx^2 + dz^2 + core^2) for a well centred at (x, z).
+    void AddWell(float x, float z, float strength, float core) {
+        for (int j = 0; j < grid_; ++j) {
+            const float dx = coords_[j] - x;
+            columnTerm_[j] = dx * dx + core * core;
+        }
+        ForRows([&](int row, float* heights) {
+            const float dz = coords_[row] - z;
+            const float dz2 = dz * dz;
+            for (int j = 0; j < grid_; ++j) heights[j] -= strength / std::sqrt(columnTerm_[j] + dz2);
+        });
+    }
+
+    // h = f(x, z, h) at every vertex, for terms that do not separate into wells.
+    template <typename F>
+    void Apply(F&& f) {
+        ForRows([&](int row, float* heights) {
+            const float z = coords_[row];
+            for (int j = 0; j < grid_; ++j) heights[j] = f(coords_[j], z, heights[j]);
+        });
+    }
+
+    // h = max(floor, h * scale): the warp slider and the depth limit of the well.
+    void ScaleClamp(float scale, float floor) {
+        for (float& h : heights_) h = std::max(floor, h * scale);
+    }
+
+    // Lines along x (one per row) in `rows` style, then lines along z in `columns`
+    // style. Each segment takes its colour from its first vertex. Call between
+    // BeginMode3D/EndMode3D.
+    void Draw(const LineStyle& rows, const LineStyle& columns, float depth) const {
+        if (grid_ < 2) return;
+        const float invDepth = 1.0f / depth;
+        const auto emit = [&](const LineStyle& style, float x0, float z0, float h0, float x1, float z1, float h1) {
+            const float glow = 1.0f - std::min(1.0f, std::fabs(h0) * invDepth);
+            rlColor4ub(static_cast<unsigned char>(style.base.r + style.gain.r * glow),
+                       static_cast<unsigned char>(style.base.g + style.gain.g * glow),
+                       static_cast<unsigned char>(style.base.b + style.gain.b * glow),
+                       static_cast<unsigned char>(style.base.a + style.gain.a * glow));
+            rlVertex3f(x0, h0, z0);
+            rlVertex3f(x1, h1, z1);
+        };
+
+        rlBegin(RL_LINES);
+        for (int i = 0; i < grid_; ++i) {
+            const float z = coords_[i];
+            const float* row = &heights_[static_cast<size_t>(i) * grid_];
+            for (int j = 0; j < grid_ - 1; ++j) emit(rows, coords_[j], z, row[j], coords_[j + 1], z, row[j + 1]);
+        }
+        for (int j = 0; j < grid_; ++j) {
+            const float x = coords_[j];
+            for (int i = 0; i < grid_ - 1; ++i) emit(columns, x, coords_[i], Height(i, j), x, coords_[i + 1], Height(i + 1, j));
+        }
+        rlEnd();
+    }
+
+  private:
+    template <typename RowFn>
+    void ForRows(RowFn&& fn) {
+        const auto rows = [&](int begin, int end) {
+            for (int row = begin; row < end; ++row) fn(row, &heights_[static_cast<size_t>(row) * grid_]);
+        };
+        if (grid_ * grid_ < kParallelVertices) {
+            rows(0, grid_);
+        } else {
+            astro_parallel::SharedPool().ParallelFor(grid_, 8, rows);
+        }
+    }
+
+    int grid_ = 0;
+    float extent_ = 0.0f;
+    std::vector<float> coords_;
+    std::vector<float> heights_;  // row-major, rows along z
+    std::vector<float> columnTerm_;
+};
+
+}  // namespace astro_sheet
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "raylib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace astro_spatial {
+
+// Uniform-grid broadphase for point sets. Build() bins every point into a hashed cell
+// with a counting sort, so the cell table, the sorted index list and the per-point cell
+// ids all live in vectors that are reused from frame to frame: once they have grown to
+// the largest point count seen, rebuilding does not allocate.
+//
+// Queries return candidates from the cells a sphere overlaps; distinct cells can share
+// a bucket, so callers still do the exact distance test.
+class SpatialHash {
+  public:
+    // positionOf(i) gives point i. cellSize should be at least the largest query or
+    // pair radius so a query touches a 2x2x2 block of cells.
+    template <typename PositionOf>
+    void Build(size_t count, float cellSize, PositionOf&& positionOf) {
+        cellSize_ = std::max(cellSize, 1.0e-6f);
+        invCellSize_ = 1.0f / cellSize_;
+        size_t buckets = 64;
+        while (buckets < 2 * count) buckets <<= 1;
+        mask_ = static_cast<uint32_t>(buckets - 1);
+
+        bucketStart_.assign(buckets + 1, 0);
+        pointBucket_.resize(count);
+        cellCoords_.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const Vector3 p = positionOf(i);
+            const CellCoord cell = CellOf(p);
+            cellCoords_[i] = cell;
+            pointBucket_[i] = Bucket(cell.x, cell.y, cell.z);
+            ++bucketStart_[pointBucket_[i] + 1];
+        }
+        for (size_t b = 0; b < buckets; ++b) bucketStart_[b + 1] += bucketStart_[b];
+
+        entries_.resize(count);
+        fill_.assign(bucketStart_.begin(), bucketStart_.end() - 1);
+        for (size_t i = 0; i < count; ++i) entries_[fill_[pointBucket_[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    size_t size() const { return entries_.size(); }
+
+    // Calls f(index) for every point whose bucket one of the cells overlapping the
+    // sphere (center, radius) maps to. Each point is reported once as long as the
+    // sphere spans at most kMaxVisited cells.
+    template <typename F>
+    void ForEachCandidate(Vector3 center, float radius, F&& f) const {
+        if (entries_.empty()) return;
+        const CellCoord lo = CellOf({center.x - radius, center.y - radius, center.z - radius});
+        const CellCoord hi = CellOf({center.x + radius, center.y + radius, center.z + radius});
+        uint32_t seen[kMaxVisited];
+        int seenCount = 0;
+        for (int32_t x = lo.x; x <= hi.x; ++x) {
+            for (int32_t y = lo.y; y <= hi.y; ++y) {
+                for (int32_t z = lo.z; z <= hi.z; ++z) {
+                    const uint32_t bucket = Bucket(x, y, z);
+                    if (AlreadyVisited(bucket, seen, &seenCount)) continue;
+                    for (uint32_t e = bucketStart_[bucket]; e < bucketStart_[bucket + 1]; ++e) f(entries_[e]);
+                }
+            }
+        }
+    }
+
+    // Calls f(i, j) with i < j once for every pair of points in the same or adjacent
+    // cells. With cellSize >= radius that covers every pair closer than radius.
+    template <typename F>
+    void ForEachCandidatePair(F&& f) const {
+        for (size_t i = 0; i < cellCoords_.size(); ++i) {
+            const CellCoord c = cellCoords_[i];
+            uint32_t seen[kMaxVisited];
+            int seenCount = 0;
+            for (int32_t dx = -1; dx <= 1; ++dx) {
+                for (int32_t dy = -1; dy <= 1; ++dy) {
+                    for (int32_t dz = -1; dz <= 1; ++dz) {
+                        const uint32_t bucket = Bucket(c.x + dx, c.y + dy, c.z + dz);
+                        if (AlreadyVisited(bucket, seen, &seenCount)) continue;
+                        for (uint32_t e = bucketStart_[bucket]; e < bucketStart_[bucket + 1]; ++e) {
+                            const uint32_t j = entries_[e];
+                            if (j > i) f(static_cast<uint32_t>(i), j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+  private:
+    struct CellCoord {
+        int32_t x, y, z;
+    };
+
+    // A query spans at most 3 cells per axis when radius <= cellSize.
+    static constexpr int kMaxVisited = 64;
+
+    CellCoord CellOf(Vector3 p) const {
+        return {
+            static_cast<int32_t>(std::floor(p.x * invCellSize_)),
+            static_cast<int32_t>(std::floor(p.y * invCellSize_)),
+            static_cast<int32_t>(std::floor(p.z * invCellSize_)),
+        };
+    }
+
+    uint32_t Bucket(int32_t x, int32_t y, int32_t z) const {
+        const uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^
+                           static_cast<uint32_t>(z) * 83492791u;
+        return h & mask_;
+    }
+
+    // Neighbouring cells can hash to the same bucket; visiting it twice would report
+    // its points twice. Queries wider than kMaxVisited cells skip the check.
+    static bool AlreadyVisited(uint32_t bucket, uint32_t* seen, int* seenCount) {
+        for (int k = 0; k < *seenCount; ++k) {
+            if (seen[k] == bucket) return true;
+        }
+        if (*seenCount < kMaxVisited) seen[(*seenCount)++] = bucket;
+        return false;
+    }
+
+    float cellSize_ = 1.0f;
+    float invCellSize_ = 1.0f;
+    uint32_t mask_ = 0;
+    std::vector<uint32_t> bucketStart_;
+    std::vector<uint32_t> fill_;
+    std::vector<uint32_t> entries_;
+    std::vector<uint32_t> pointBucket_;
+    std::vector<CellCoord> cellCoords_;
+};
+
+}  // namespace astro_spatial
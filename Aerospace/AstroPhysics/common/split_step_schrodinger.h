@@ -0,0 +1,263 @@
+#pragma once
+
+#include "fft.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+namespace astro_quantum {
+
+using astro_fft::Complex;
+
+// Split-step Fourier propagator for the time-dependent Schrodinger equation
+//     i dpsi/dt = -laplacian(psi) + V psi        (hbar = 1, 2m = 1, so E = k^2)
+// on a periodic nx x ny grid covering [-lx/2, lx/2) x [-ly/2, ly/2); ny = 1 gives the
+// 1D equation. A step is Strang-split into half a potential kick, a kinetic drift in
+// k-space and another half kick. Advance(n) merges the half kicks of consecutive steps,
+// so a step costs one forward and one inverse FFT plus two pointwise multiplies.
+//
+// The kick and drift factors are tabulated once per potential/time step, psi is
+// transformed in place, and grids of kParallelCells or more split every pass across the
+// shared thread pool. An absorbing layer of the given width along the edges damps what
+// leaves the region of interest instead of letting it wrap around the periodic box; the
+// probability it removes is tallied separately for the x < 0 and x >= 0 halves, so a
+// scattering run can count what left on each side.
+class SplitStepSolver {
+  public:
+    static constexpr int kParallelCells = 128 * 128;
+
+    // nx and ny must be powers of two.
+    void Configure(int nx, int ny, float lx, float ly, float dt) {
+        nx_ = nx;
+        ny_ = std::max(ny, 1);
+        lx_ = lx;
+        ly_ = ny_ > 1 ? ly : 1.0f;
+        dt_ = dt;
+        const size_t cells = static_cast<size_t>(nx_) * ny_;
+        psi_.assign(cells, Complex(0.0f, 0.0f));
+        potential_.assign(cells, 0.0f);
+        halfKick_.resize(cells);
+        fullKick_.resize(cells);
+        drift_.resize(cells);
+        if (ny_ > 1) {
+            plan2D_.Resize(ny_, nx_);
+        } else {
+            plan1D_.Resize(nx_);
+        }
+        BuildDrift();
+        BuildKicks();
+        time_ = 0.0f;
+        absorbedLeft_ = 0.0;
+        absorbedRight_ = 0.0;
+    }
+
+    // Damping rate strength * s^2 per unit time, s running 0 -> 1 across the layer.
+    void SetAbsorber(float width, float strength) {
+        absorberWidth_ = width;
+        absorberStrength_ = strength;
+        BuildKicks();
+    }
+
+    // Samples v(x, y) at every cell centre and rebuilds the kick factors.
+    template <typename V>
+    void SetPotential(V&& v) {
+        for (int j = 0; j < ny_; ++j) {
+            for (int i = 0; i < nx_; ++i) potential_[Index(i, j)] = v(X(i), Y(j));
+        }
+        BuildKicks();
+    }
+
+    // Normalised Gaussian packet; sigmaX/sigmaY are the standard deviations of |psi|^2
+    // and (kx, ky) its mean wave vector, so its mean kinetic energy is about kx^2 + ky^2.
+    void SetGaussianPacket(float x0, float y0, float sigmaX, float sigmaY, float kx, float ky) {
+        double norm = 0.0;
+        for (int j = 0; j < ny_; ++j) {
+            const float dy = ny_ > 1 ? (Y(j) - y0) / sigmaY : 0.0f;
+            for (int i = 0; i < nx_; ++i) {
+                const float dx = (X(i) - x0) / sigmaX;
+                const float amplitude = std::exp(-0.25f * (dx * dx + dy * dy));
+                const float phase = kx * X(i) + (ny_ > 1 ? ky * Y(j) : 0.0f);
+                psi_[Index(i, j)] = Complex(amplitude * std::cos(phase), amplitude * std::sin(phase));
+                norm += static_cast<double>(amplitude) * amplitude;
+            }
+        }
+        const float scale = static_cast<float>(1.0 / std::sqrt(norm * CellArea()));
+        for (Complex& c : psi_) c *= scale;
+        time_ = 0.0f;
+        absorbedLeft_ = 0.0;
+        absorbedRight_ = 0.0;
+    }
+
+    void Advance(int steps) {
+        if (steps <= 0) return;
+        Absorb(halfLoss_);
+        Multiply(halfKick_);
+        for (int s = 0; s < steps; ++s) {
+            Forward();
+            Multiply(drift_);
+            Inverse();
+            const bool last = s + 1 == steps;
+            Absorb(last ? halfLoss_ : fullLoss_);
+            Multiply(last ? halfKick_ : fullKick_);
+        }
+        time_ += dt_ * static_cast<float>(steps);
+    }
+
+    // Integral of |psi|^2 over x0 <= x < x1 (and every y).
+    float ProbabilityBetween(float x0, float x1) const {
+        const int i0 = std::clamp(static_cast<int>(std::ceil((x0 + 0.5f * lx_) / Dx())), 0, nx_);
+        const int i1 = std::clamp(static_cast<int>(std::ceil((x1 + 0.5f * lx_) / Dx())), 0, nx_);
+        double sum = 0.0;
+        for (int j = 0; j < ny_; ++j) {
+            const Complex* row = &psi_[Index(0, j)];
+            for (int i = i0; i < i1; ++i) sum += std::norm(row[i]);
+        }
+        return static_cast<float>(sum * CellArea());
+    }
+
+    float Norm() const { return ProbabilityBetween(-0.5f * lx_, 0.5f * lx_); }
+
+    // Probability removed by the absorbing layer since the last packet was set, on the
+    // x < 0 and x >= 0 sides.
+    float AbsorbedLeft() const { return static_cast<float>(absorbedLeft_); }
+    float AbsorbedRight() const { return static_cast<float>(absorbedRight_); }
+
+    int nx() const { return nx_; }
+    int ny() const { return ny_; }
+    float time() const { return time_; }
+    float dt() const { return dt_; }
+    float Dx() const { return lx_ / static_cast<float>(nx_); }
+    float Dy() const { return ny_ > 1 ? ly_ / static_cast<float>(ny_) : 1.0f; }
+    float X(int i) const { return -0.5f * lx_ + Dx() * static_cast<float>(i); }
+    float Y(int j) const { return ny_ > 1 ? -0.5f * ly_ + Dy() * static_cast<float>(j) : 0.0f; }
+    size_t Index(int i, int j) const { return static_cast<size_t>(j) * nx_ + i; }
+    const Complex* psi() const { return psi_.data(); }
+    Complex Psi(int i, int j) const { return psi_[Index(i, j)]; }
+
+  private:
+    float CellArea() const { return Dx() * Dy(); }
+    bool Parallel() const { return nx_ * ny_ >= kParallelCells; }
+
+    static float WaveNumber(int i, int n, float length) {
+        const int m = i < n / 2 ? i : i - n;
+        return 2.0f * 3.14159265f * static_cast<float>(m) / length;
+    }
+
+    // exp(-i k^2 dt), with the 1/(nx ny) of the unnormalised inverse FFT folded in.
+    void BuildDrift() {
+        const float scale = 1.0f / static_cast<float>(nx_ * ny_);
+        for (int j = 0; j < ny_; ++j) {
+            const float ky = ny_ > 1 ? WaveNumber(j, ny_, ly_) : 0.0f;
+            for (int i = 0; i < nx_; ++i) {
+                const float kx = WaveNumber(i, nx_, lx_);
+                const float phase = -(kx * kx + ky * ky) * dt_;
+                drift_[Index(i, j)] = Complex(scale * std::cos(phase), scale * std::sin(phase));
+            }
+        }
+    }
+
+    // exp(-i V dt/2) times half the absorber damping; the full kick is its square. Cells
+    // inside the layer are also listed with the fraction of |psi|^2 each kick removes.
+    void BuildKicks() {
+        if (psi_.empty()) return;
+        absorbingCells_.clear();
+        halfLoss_.clear();
+        fullLoss_.clear();
+        const auto layer = [&](float coordinate, float length) {
+            if (absorberWidth_ <= 0.0f) return 0.0f;
+            const float s = std::clamp((std::fabs(coordinate) - (0.5f * length - absorberWidth_)) / absorberWidth_, 0.0f, 1.0f);
+            return s * s;
+        };
+        for (int j = 0; j < ny_; ++j) {
+            const float layerY = ny_ > 1 ? layer(Y(j), ly_) : 0.0f;
+            for (int i = 0; i < nx_; ++i) {
+                const size_t index = Index(i, j);
+                const float damping = std::exp(-0.5f * absorberStrength_ * (layer(X(i), lx_) + layerY) * dt_);
+                const float phase = -0.5f * potential_[index] * dt_;
+                halfKick_[index] = Complex(damping * std::cos(phase), damping * std::sin(phase));
+                fullKick_[index] = halfKick_[index] * halfKick_[index];
+                if (damping < 1.0f) {
+                    absorbingCells_.push_back(static_cast<uint32_t>(index));
+                    halfLoss_.push_back(1.0f - damping * damping);
+                    fullLoss_.push_back(1.0f - damping * damping * damping * damping);
+                }
+            }
+        }
+    }
+
+    // Tallies what the next kick will remove, before it is applied.
+    void Absorb(const std::vector<float>& loss) {
+        double left = 0.0;
+        double right = 0.0;
+        for (size_t n = 0; n < absorbingCells_.size(); ++n) {
+            const uint32_t index = absorbingCells_[n];
+            const double removed = static_cast<double>(std::norm(psi_[index])) * loss[n];
+            if (static_cast<int>(index % nx_) < nx_ / 2) {
+                left += removed;
+            } else {
+                right += removed;
+            }
+        }
+        absorbedLeft_ += left * CellArea();
+        absorbedRight_ += right * CellArea();
+    }
+
+    void Forward() {
+        if (ny_ > 1) {
+            plan2D_.Forward(psi_.data(), Parallel());
+        } else {
+            plan1D_.Forward(psi_.data());
+        }
+    }
+
+    void Inverse() {
+        if (ny_ > 1) {
+            plan2D_.Inverse(psi_.data(), Parallel());
+        } else {
+            plan1D_.Inverse(psi_.data());
+        }
+    }
+
+    void Multiply(const std::vector<Complex>& factor) {
+        const auto multiply = [&](int begin, int end) {
+            for (int n = begin; n < end; ++n) {
+                const Complex a = psi_[n];
+                const Complex b = factor[n];
+                psi_[n] = Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+            }
+        };
+        const int cells = nx_ * ny_;
+        if (Parallel()) {
+            astro_parallel::SharedPool().ParallelFor(cells, 4096, multiply);
+        } else {
+            multiply(0, cells);
+        }
+    }
+
+    int nx_ = 0;
+    int ny_ = 1;
+    float lx_ = 1.0f;
+    float ly_ = 1.0f;
+    float dt_ = 0.0f;
+    float time_ = 0.0f;
+    float absorberWidth_ = 0.0f;
+    float absorberStrength_ = 0.0f;
+    double absorbedLeft_ = 0.0;
+    double absorbedRight_ = 0.0;
+    astro_fft::Plan1D plan1D_;
+    astro_fft::Plan2D plan2D_;
+    std::vector<Complex> psi_;
+    std::vector<float> potential_;
+    std::vector<Complex> halfKick_;
+    std::vector<Complex> fullKick_;
+    std::vector<Complex> drift_;
+    std::vector<uint32_t> absorbingCells_;
+    std::vector<float> halfLoss_;
+    std::vector<float> fullLoss_;
+};
+
+}  // namespace astro_quantum
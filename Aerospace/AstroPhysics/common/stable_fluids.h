@@ -0,0 +1,757 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Incompressible Navier-Stokes on a staggered (MAC) grid, "stable fluids" style:
+//
+//   advect  semi-Lagrangian, RK2 backtrace, trilinear sampling per face component
+//   diffuse optional implicit viscosity, a fixed number of Jacobi sweeps
+//   project pressure Poisson solve by conjugate gradients preconditioned with one
+//           multigrid V-cycle (red-black Gauss-Seidel, piecewise-constant transfers)
+//
+// Cells are solid where the obstacle SDF is negative at the cell centre; faces touching
+// a solid cell or a domain wall carry no normal flow. The x faces can instead be an
+// inflow (x min, prescribed speed) and outflow (x max, zero pressure) pair for tunnels
+// and channels. Every pass walks z planes and splits them across the shared thread
+// pool once the grid has kParallelCells cells; reductions are summed per plane first so
+// the result does not depend on the thread count.
+//
+// Units: world lengths and seconds, density 1, so Pressure() is kinematic pressure.
+
+namespace astro_fluid {
+
+struct FluidConfig {
+    int nx = 32;
+    int ny = 32;
+    int nz = 32;
+    float cell = 0.1f;
+    Vector3 origin = {0.0f, 0.0f, 0.0f};  // world position of the grid's min corner
+    bool openX = false;                   // inflow at x min, outflow at x max
+    float inflow = 0.0f;                  // x velocity through the x min face when openX
+    float viscosity = 0.0f;               // kinematic; 0 leaves only numerical diffusion
+    bool noSlip = false;                  // viscous walls and obstacles (free slip otherwise)
+};
+
+class MacFluidSolver {
+  public:
+    static constexpr int kParallelCells = 24 * 24 * 24;
+    static constexpr int kMaxIterations = 40;
+    static constexpr float kTolerance = 1.0e-4f;  // max residual, relative to the largest initial divergence
+    static constexpr int kViscousSweeps = 12;
+    static constexpr int kSmoothSweeps = 2;
+    static constexpr int kBottomSweeps = 24;
+
+    void Configure(const FluidConfig& config) {
+        config_ = config;
+        nx_ = config.nx;
+        ny_ = config.ny;
+        nz_ = config.nz;
+        const size_t cells = static_cast<size_t>(nx_) * ny_ * nz_;
+        u_.assign(static_cast<size_t>(nx_ + 1) * ny_ * nz_, 0.0f);
+        v_.assign(static_cast<size_t>(nx_) * (ny_ + 1) * nz_, 0.0f);
+        w_.assign(static_cast<size_t>(nx_) * ny_ * (nz_ + 1), 0.0f);
+        u0_ = u_;
+        v0_ = v_;
+        w0_ = w_;
+        solid_.assign(cells, 0);
+        pressure_.assign(cells, 0.0f);
+        rhs_.assign(cells, 0.0f);
+        residual_.assign(cells, 0.0f);
+        search_.assign(cells, 0.0f);
+        product_.assign(cells, 0.0f);
+        preconditioned_.assign(cells, 0.0f);
+        planeSums_.assign(nz_, 0.0);
+        if (config.openX) {
+            for (int k = 0; k < nz_; ++k) {
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i <= nx_; ++i) u_[U(i, j, k)] = config.inflow;
+                }
+            }
+        }
+        BuildLevels();
+        BuildFaceMasks();
+        ApplyBoundaries();
+    }
+
+    // Solid wherever sdf(world) < 0 at a cell centre. Clears the flow inside the body.
+    template <typename Sdf>
+    void SetObstacle(Sdf&& sdf) {
+        for (int k = 0; k < nz_; ++k) {
+            for (int j = 0; j < ny_; ++j) {
+                for (int i = 0; i < nx_; ++i) solid_[Cell(i, j, k)] = sdf(CellCenter(i, j, k)) < 0.0f ? 1 : 0;
+            }
+        }
+        for (size_t n = 0; n < solid_.size(); ++n) {
+            if (solid_[n]) pressure_[n] = 0.0f;
+        }
+        BuildLevels();
+        BuildFaceMasks();
+        ApplyBoundaries();
+    }
+
+    void ClearObstacle() {
+        std::fill(solid_.begin(), solid_.end(), 0);
+        BuildLevels();
+        BuildFaceMasks();
+        ApplyBoundaries();
+    }
+
+    void SetInflow(float inflow) { config_.inflow = inflow; }
+    void SetViscosity(float viscosity) { config_.viscosity = viscosity; }
+
+    // Adds dt * accel(world) to every face, e.g. a pressure-gradient drive or a stirrer.
+    template <typename Accel>
+    void AddForce(float dt, Accel&& accel) {
+        ForPlanes(nz_, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i <= nx_; ++i) u_[U(i, j, k)] += dt * accel(FacePosition(0, i, j, k)).x;
+                }
+                for (int j = 0; j <= ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) v_[V(i, j, k)] += dt * accel(FacePosition(1, i, j, k)).y;
+                }
+            }
+        });
+        ForPlanes(nz_ + 1, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) w_[W(i, j, k)] += dt * accel(FacePosition(2, i, j, k)).z;
+                }
+            }
+        });
+    }
+
+    // Pulls each face toward target(world) at rate(world) per second (exponentially, so
+    // any rate is stable). Face-local, which makes it a safe stirrer or sponge layer.
+    template <typename Target, typename Rate>
+    void Relax(float dt, Target&& target, Rate&& rate) {
+        const auto pull = [&](float* face, const Vector3& p, int axis) {
+            const float blend = 1.0f - std::exp(-dt * rate(p));
+            const Vector3 goal = target(p);
+            const float value = axis == 0 ? goal.x : (axis == 1 ? goal.y : goal.z);
+            *face += blend * (value - *face);
+        };
+        ForPlanes(nz_, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i <= nx_; ++i) pull(&u_[U(i, j, k)], FacePosition(0, i, j, k), 0);
+                }
+                for (int j = 0; j <= ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) pull(&v_[V(i, j, k)], FacePosition(1, i, j, k), 1);
+                }
+            }
+        });
+        ForPlanes(nz_ + 1, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) pull(&w_[W(i, j, k)], FacePosition(2, i, j, k), 2);
+                }
+            }
+        });
+    }
+
+    void Step(float dt) {
+        if (dt <= 0.0f) return;
+        Advect(dt);
+        ApplyBoundaries();
+        if (config_.viscosity > 0.0f) Diffuse(dt);
+        Project(dt);
+        time_ += dt;
+    }
+
+    // Trilinear velocity at a world position; zero inside solids and outside the grid.
+    Vector3 Velocity(Vector3 world) const {
+        const Vector3 g = Grid(world);
+        if (g.x < 0.0f || g.y < 0.0f || g.z < 0.0f || g.x > nx_ || g.y > ny_ || g.z > nz_) return {0.0f, 0.0f, 0.0f};
+        const int ci = std::min(nx_ - 1, static_cast<int>(g.x));
+        const int cj = std::min(ny_ - 1, static_cast<int>(g.y));
+        const int ck = std::min(nz_ - 1, static_cast<int>(g.z));
+        if (solid_[Cell(ci, cj, ck)]) return {0.0f, 0.0f, 0.0f};
+        return SampleVelocity(g);
+    }
+
+    // Kinematic pressure of the last projection in the cell containing world.
+    float Pressure(Vector3 world) const {
+        const Vector3 g = Grid(world);
+        const int i = std::clamp(static_cast<int>(g.x), 0, nx_ - 1);
+        const int j = std::clamp(static_cast<int>(g.y), 0, ny_ - 1);
+        const int k = std::clamp(static_cast<int>(g.z), 0, nz_ - 1);
+        return pressure_[Cell(i, j, k)] * config_.cell / std::max(lastDt_, 1.0e-6f);
+    }
+
+    // Pressure force on all solid cells (density 1), summed over fluid-solid faces.
+    // Shear is left out, so this is form drag and lift only.
+    Vector3 ObstacleForce() const {
+        const float scale = config_.cell * config_.cell * config_.cell / std::max(lastDt_, 1.0e-6f);
+        double force[3] = {0.0, 0.0, 0.0};
+        for (int k = 0; k < nz_; ++k) {
+            for (int j = 0; j < ny_; ++j) {
+                for (int i = 0; i < nx_; ++i) {
+                    const size_t n = Cell(i, j, k);
+                    if (solid_[n]) continue;
+                    const double p = pressure_[n];
+                    if (SolidCell(i + 1, j, k)) force[0] += p;
+                    if (SolidCell(i - 1, j, k)) force[0] -= p;
+                    if (SolidCell(i, j + 1, k)) force[1] += p;
+                    if (SolidCell(i, j - 1, k)) force[1] -= p;
+                    if (SolidCell(i, j, k + 1)) force[2] += p;
+                    if (SolidCell(i, j, k - 1)) force[2] -= p;
+                }
+            }
+        }
+        return {static_cast<float>(force[0] * scale), static_cast<float>(force[1] * scale), static_cast<float>(force[2] * scale)};
+    }
+
+    bool Solid(Vector3 world) const {
+        const Vector3 g = Grid(world);
+        if (g.x < 0.0f || g.y < 0.0f || g.z < 0.0f || g.x >= nx_ || g.y >= ny_ || g.z >= nz_) return false;
+        return solid_[Cell(static_cast<int>(g.x), static_cast<int>(g.y), static_cast<int>(g.z))] != 0;
+    }
+
+    bool Contains(Vector3 world) const {
+        const Vector3 g = Grid(world);
+        return g.x >= 0.0f && g.y >= 0.0f && g.z >= 0.0f && g.x <= nx_ && g.y <= ny_ && g.z <= nz_;
+    }
+
+    // Largest |divergence| * h left after the last projection, in velocity units.
+    float MaxDivergence() const { return lastDivergence_; }
+    int Iterations() const { return lastIterations_; }
+    float time() const { return time_; }
+    int nx() const { return nx_; }
+    int ny() const { return ny_; }
+    int nz() const { return nz_; }
+    size_t cells() const { return solid_.size(); }
+    const FluidConfig& config() const { return config_; }
+
+    Vector3 CellCenter(int i, int j, int k) const {
+        const float h = config_.cell;
+        return {config_.origin.x + (i + 0.5f) * h, config_.origin.y + (j + 0.5f) * h, config_.origin.z + (k + 0.5f) * h};
+    }
+
+  private:
+    // One multigrid level of the pressure operator: A p = sum over open neighbours of
+    // (p - p_n), plus p for each Dirichlet (outflow) face. Coarse cells are fluid when
+    // any of their eight children is.
+    struct Level {
+        int nx = 0, ny = 0, nz = 0;
+        std::vector<uint8_t> fluid;
+        std::vector<float> diagonal;  // open neighbours plus Dirichlet faces
+        std::vector<float> x, b, r;
+        size_t Cell(int i, int j, int k) const { return (static_cast<size_t>(k) * ny + j) * nx + i; }
+    };
+
+    size_t Cell(int i, int j, int k) const { return (static_cast<size_t>(k) * ny_ + j) * nx_ + i; }
+    size_t U(int i, int j, int k) const { return (static_cast<size_t>(k) * ny_ + j) * (nx_ + 1) + i; }
+    size_t V(int i, int j, int k) const { return (static_cast<size_t>(k) * (ny_ + 1) + j) * nx_ + i; }
+    size_t W(int i, int j, int k) const { return (static_cast<size_t>(k) * ny_ + j) * nx_ + i; }
+
+    bool Parallel() const { return cells() >= static_cast<size_t>(kParallelCells); }
+
+    template <typename Body>
+    void ForPlanes(int count, Body&& body) const {
+        if (Parallel()) {
+            astro_parallel::SharedPool().ParallelFor(count, 1, body);
+        } else {
+            body(0, count);
+        }
+    }
+
+    Vector3 Grid(Vector3 world) const {
+        const float inv = 1.0f / config_.cell;
+        return {(world.x - config_.origin.x) * inv, (world.y - config_.origin.y) * inv, (world.z - config_.origin.z) * inv};
+    }
+
+    Vector3 FacePosition(int axis, int i, int j, int k) const {
+        const float h = config_.cell;
+        return {config_.origin.x + (i + (axis == 0 ? 0.0f : 0.5f)) * h,
+                config_.origin.y + (j + (axis == 1 ? 0.0f : 0.5f)) * h,
+                config_.origin.z + (k + (axis == 2 ? 0.0f : 0.5f)) * h};
+    }
+
+    static float Trilinear(const std::vector<float>& f, int sx, int sy, int sz, float x, float y, float z) {
+        x = std::clamp(x, 0.0f, static_cast<float>(sx - 1));
+        y = std::clamp(y, 0.0f, static_cast<float>(sy - 1));
+        z = std::clamp(z, 0.0f, static_cast<float>(sz - 1));
+        const int i = std::min(static_cast<int>(x), std::max(0, sx - 2));
+        const int j = std::min(static_cast<int>(y), std::max(0, sy - 2));
+        const int k = std::min(static_cast<int>(z), std::max(0, sz - 2));
+        const float fx = x - i, fy = y - j, fz = z - k;
+        const int i1 = std::min(i + 1, sx - 1), j1 = std::min(j + 1, sy - 1), k1 = std::min(k + 1, sz - 1);
+        const auto at = [&](int a, int b, int c) { return f[(static_cast<size_t>(c) * sy + b) * sx + a]; };
+        const float c00 = at(i, j, k) + fx * (at(i1, j, k) - at(i, j, k));
+        const float c10 = at(i, j1, k) + fx * (at(i1, j1, k) - at(i, j1, k));
+        const float c01 = at(i, j, k1) + fx * (at(i1, j, k1) - at(i, j, k1));
+        const float c11 = at(i, j1, k1) + fx * (at(i1, j1, k1) - at(i, j1, k1));
+        const float c0 = c00 + fy * (c10 - c00);
+        const float c1 = c01 + fy * (c11 - c01);
+        return c0 + fz * (c1 - c0);
+    }
+
+    // g in cell units; each component is sampled on its own staggered lattice.
+    Vector3 SampleVelocity(Vector3 g) const { return SampleFrom(u_, v_, w_, g); }
+
+    Vector3 SampleFrom(const std::vector<float>& u, const std::vector<float>& v, const std::vector<float>& w, Vector3 g) const {
+        return {Trilinear(u, nx_ + 1, ny_, nz_, g.x, g.y - 0.5f, g.z - 0.5f),
+                Trilinear(v, nx_, ny_ + 1, nz_, g.x - 0.5f, g.y, g.z - 0.5f),
+                Trilinear(w, nx_, ny_, nz_ + 1, g.x - 0.5f, g.y - 0.5f, g.z)};
+    }
+
+    void Advect(float dt) {
+        u0_.swap(u_);
+        v0_.swap(v_);
+        w0_.swap(w_);
+        const float step = dt / config_.cell;
+        // Backtrace from a face position (cell units) through the old field.
+        const auto departure = [&](Vector3 g) {
+            const Vector3 v1 = SampleFrom(u0_, v0_, w0_, g);
+            const Vector3 mid = Vector3Subtract(g, Vector3Scale(v1, 0.5f * step));
+            const Vector3 v2 = SampleFrom(u0_, v0_, w0_, mid);
+            return Vector3Subtract(g, Vector3Scale(v2, step));
+        };
+        ForPlanes(nz_ + 1, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                if (k < nz_) {
+                    for (int j = 0; j < ny_; ++j) {
+                        for (int i = 0; i <= nx_; ++i) {
+                            const Vector3 p = departure({static_cast<float>(i), j + 0.5f, k + 0.5f});
+                            u_[U(i, j, k)] = Trilinear(u0_, nx_ + 1, ny_, nz_, p.x, p.y - 0.5f, p.z - 0.5f);
+                        }
+                    }
+                    for (int j = 0; j <= ny_; ++j) {
+                        for (int i = 0; i < nx_; ++i) {
+                            const Vector3 p = departure({i + 0.5f, static_cast<float>(j), k + 0.5f});
+                            v_[V(i, j, k)] = Trilinear(v0_, nx_, ny_ + 1, nz_, p.x - 0.5f, p.y, p.z - 0.5f);
+                        }
+                    }
+                }
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) {
+                        const Vector3 p = departure({i + 0.5f, j + 0.5f, static_cast<float>(k)});
+                        w_[W(i, j, k)] = Trilinear(w0_, nx_, ny_, nz_ + 1, p.x - 0.5f, p.y - 0.5f, p.z);
+                    }
+                }
+            }
+        });
+    }
+
+    bool SolidCell(int i, int j, int k) const {
+        return i < 0 || j < 0 || k < 0 || i >= nx_ || j >= ny_ || k >= nz_ ? false : solid_[Cell(i, j, k)] != 0;
+    }
+
+    // Normal flow through walls and solid faces is zero (inflow at x min when open);
+    // the outflow face copies its upstream neighbour before the projection corrects it.
+    void ApplyBoundaries() {
+        ForPlanes(nz_ + 1, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                for (int j = 0; j < ny_ && k < nz_; ++j) {
+                    for (int i = 0; i <= nx_; ++i) {
+                        float& face = u_[U(i, j, k)];
+                        if (i == 0) {
+                            face = config_.openX && !SolidCell(0, j, k) ? config_.inflow : 0.0f;
+                        } else if (i == nx_) {
+                            face = config_.openX && !SolidCell(nx_ - 1, j, k) ? u_[U(nx_ - 1, j, k)] : 0.0f;
+                        } else if (SolidCell(i - 1, j, k) || SolidCell(i, j, k)) {
+                            face = 0.0f;
+                        }
+                    }
+                }
+                for (int j = 0; j <= ny_ && k < nz_; ++j) {
+                    for (int i = 0; i < nx_; ++i) {
+                        if (j == 0 || j == ny_ || SolidCell(i, j - 1, k) || SolidCell(i, j, k)) v_[V(i, j, k)] = 0.0f;
+                    }
+                }
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) {
+                        if (k == 0 || k == nz_ || SolidCell(i, j, k - 1) || SolidCell(i, j, k)) w_[W(i, j, k)] = 0.0f;
+                    }
+                }
+            }
+        });
+    }
+
+    // Implicit (I - nu dt laplacian) u = u* by Jacobi sweeps per component. With no-slip
+    // the walls and solid faces act as zero-velocity neighbours; with free slip missing
+    // neighbours are simply left out.
+    void Diffuse(float dt) {
+        const float alpha = config_.viscosity * dt / (config_.cell * config_.cell);
+        DiffuseComponent(&u_, &u0_, nx_ + 1, ny_, nz_, alpha, 0);
+        DiffuseComponent(&v_, &v0_, nx_, ny_ + 1, nz_, alpha, 1);
+        DiffuseComponent(&w_, &w0_, nx_, ny_, nz_ + 1, alpha, 2);
+        ApplyBoundaries();
+    }
+
+    void DiffuseComponent(std::vector<float>* field, std::vector<float>* scratch, int sx, int sy, int sz, float alpha, int axis) {
+        diffuseSource_ = *field;
+        const std::vector<uint8_t>& fixed = faceFixed_[axis];
+        // A missing neighbour is a zero-velocity ghost under no-slip, absent otherwise.
+        const float ghost = config_.noSlip ? 1.0f : 0.0f;
+        const size_t strideY = static_cast<size_t>(sx);
+        const size_t strideZ = strideY * sy;
+        for (int sweep = 0; sweep < kViscousSweeps; ++sweep) {
+            const float* in = field->data();
+            float* out = scratch->data();
+            ForPlanes(sz, [&](int k0, int k1) {
+                for (int k = k0; k < k1; ++k) {
+                    for (int j = 0; j < sy; ++j) {
+                        const bool down = j > 0, up = j + 1 < sy, back = k > 0, front = k + 1 < sz;
+                        const float rowCount = (down ? 1.0f : ghost) + (up ? 1.0f : ghost) + (back ? 1.0f : ghost) + (front ? 1.0f : ghost);
+                        const size_t row = static_cast<size_t>(k) * strideZ + j * strideY;
+                        for (int i = 0; i < sx; ++i) {
+                            const size_t n = row + i;
+                            if (fixed[n]) {
+                                out[n] = in[n];
+                                continue;
+                            }
+                            const bool left = i > 0, right = i + 1 < sx;
+                            const float sum = (left ? in[n - 1] : 0.0f) + (right ? in[n + 1] : 0.0f) + (down ? in[n - strideY] : 0.0f) +
+                                              (up ? in[n + strideY] : 0.0f) + (back ? in[n - strideZ] : 0.0f) + (front ? in[n + strideZ] : 0.0f);
+                            const float count = rowCount + (left ? 1.0f : ghost) + (right ? 1.0f : ghost);
+                            out[n] = (diffuseSource_[n] + alpha * sum) / (1.0f + alpha * count);
+                        }
+                    }
+                }
+            });
+            field->swap(*scratch);
+        }
+    }
+
+    // Faces on a wall or touching a solid cell; viscosity leaves them at their boundary value.
+    void BuildFaceMasks() {
+        faceFixed_[0].assign(u_.size(), 0);
+        faceFixed_[1].assign(v_.size(), 0);
+        faceFixed_[2].assign(w_.size(), 0);
+        for (int k = 0; k <= nz_; ++k) {
+            for (int j = 0; j <= ny_; ++j) {
+                for (int i = 0; i <= nx_; ++i) {
+                    if (j < ny_ && k < nz_) {
+                        faceFixed_[0][U(i, j, k)] = i == 0 || i == nx_ || SolidCell(i - 1, j, k) || SolidCell(i, j, k);
+                    }
+                    if (i < nx_ && k < nz_) {
+                        faceFixed_[1][V(i, j, k)] = j == 0 || j == ny_ || SolidCell(i, j - 1, k) || SolidCell(i, j, k);
+                    }
+                    if (i < nx_ && j < ny_) {
+                        faceFixed_[2][W(i, j, k)] = k == 0 || k == nz_ || SolidCell(i, j, k - 1) || SolidCell(i, j, k);
+                    }
+                }
+            }
+        }
+    }
+
+    void BuildLevels() {
+        levels_.clear();
+        Level fine;
+        fine.nx = nx_;
+        fine.ny = ny_;
+        fine.nz = nz_;
+        fine.fluid.resize(solid_.size());
+        for (size_t n = 0; n < solid_.size(); ++n) fine.fluid[n] = solid_[n] ? 0 : 1;
+        levels_.push_back(std::move(fine));
+        while (true) {
+            const Level& prev = levels_.back();
+            if (prev.nx % 2 || prev.ny % 2 || prev.nz % 2 || std::min({prev.nx, prev.ny, prev.nz}) < 8) break;
+            Level coarse;
+            coarse.nx = prev.nx / 2;
+            coarse.ny = prev.ny / 2;
+            coarse.nz = prev.nz / 2;
+            coarse.fluid.assign(static_cast<size_t>(coarse.nx) * coarse.ny * coarse.nz, 0);
+            for (int k = 0; k < prev.nz; ++k) {
+                for (int j = 0; j < prev.ny; ++j) {
+                    for (int i = 0; i < prev.nx; ++i) {
+                        if (prev.fluid[prev.Cell(i, j, k)]) coarse.fluid[coarse.Cell(i / 2, j / 2, k / 2)] = 1;
+                    }
+                }
+            }
+            levels_.push_back(std::move(coarse));
+        }
+        for (Level& level : levels_) {
+            const size_t cells = level.fluid.size();
+            level.x.assign(cells, 0.0f);
+            level.b.assign(cells, 0.0f);
+            level.r.assign(cells, 0.0f);
+            level.diagonal.assign(cells, 0.0f);
+            const size_t sy = static_cast<size_t>(level.nx);
+            const size_t sz = sy * level.ny;
+            for (int k = 0; k < level.nz; ++k) {
+                for (int j = 0; j < level.ny; ++j) {
+                    for (int i = 0; i < level.nx; ++i) {
+                        const size_t n = level.Cell(i, j, k);
+                        if (!level.fluid[n]) continue;
+                        float diag = 0.0f;
+                        diag += i > 0 && level.fluid[n - 1] ? 1.0f : 0.0f;
+                        diag += i + 1 < level.nx && level.fluid[n + 1] ? 1.0f : 0.0f;
+                        diag += j > 0 && level.fluid[n - sy] ? 1.0f : 0.0f;
+                        diag += j + 1 < level.ny && level.fluid[n + sy] ? 1.0f : 0.0f;
+                        diag += k > 0 && level.fluid[n - sz] ? 1.0f : 0.0f;
+                        diag += k + 1 < level.nz && level.fluid[n + sz] ? 1.0f : 0.0f;
+                        if (config_.openX && i + 1 == level.nx) diag += 1.0f;  // outflow: p = 0 beyond the face
+                        level.diagonal[n] = diag;
+                    }
+                }
+            }
+        }
+    }
+
+    // Neighbour sum and diagonal of the pressure operator at a fluid cell. Every field
+    // the operator sees is zero on solid cells, so neighbours need only a bounds check.
+    template <typename Field>
+    void Stencil(const Level& level, const Field& p, int i, int j, int k, float* neighbours, float* diagonal) const {
+        const size_t n = level.Cell(i, j, k);
+        const size_t sy = static_cast<size_t>(level.nx);
+        const size_t sz = sy * level.ny;
+        *neighbours = (i > 0 ? p[n - 1] : 0.0f) + (i + 1 < level.nx ? p[n + 1] : 0.0f) + (j > 0 ? p[n - sy] : 0.0f) +
+                      (j + 1 < level.ny ? p[n + sy] : 0.0f) + (k > 0 ? p[n - sz] : 0.0f) + (k + 1 < level.nz ? p[n + sz] : 0.0f);
+        *diagonal = level.diagonal[n];
+    }
+
+    void SmoothRedBlack(Level* level, int sweeps, bool reverse) const {
+        for (int sweep = 0; sweep < sweeps; ++sweep) {
+            for (int pass = 0; pass < 2; ++pass) {
+                const int color = reverse ? 1 - pass : pass;
+                const auto planes = [&](int k0, int k1) {
+                    for (int k = k0; k < k1; ++k) {
+                        for (int j = 0; j < level->ny; ++j) {
+                            for (int i = (j + k + color) & 1; i < level->nx; i += 2) {
+                                const size_t n = level->Cell(i, j, k);
+                                if (!level->fluid[n]) continue;
+                                float sum = 0.0f;
+                                float diag = 0.0f;
+                                Stencil(*level, level->x, i, j, k, &sum, &diag);
+                                if (diag > 0.0f) level->x[n] = (level->b[n] + sum) / diag;
+                            }
+                        }
+                    }
+                };
+                if (level->fluid.size() >= static_cast<size_t>(kParallelCells)) {
+                    astro_parallel::SharedPool().ParallelFor(level->nz, 1, planes);
+                } else {
+                    planes(0, level->nz);
+                }
+            }
+        }
+    }
+
+    void Residual(Level* level) const {
+        for (int k = 0; k < level->nz; ++k) {
+            for (int j = 0; j < level->ny; ++j) {
+                for (int i = 0; i < level->nx; ++i) {
+                    const size_t n = level->Cell(i, j, k);
+                    if (!level->fluid[n]) {
+                        level->r[n] = 0.0f;
+                        continue;
+                    }
+                    float sum = 0.0f;
+                    float diag = 0.0f;
+                    Stencil(*level, level->x, i, j, k, &sum, &diag);
+                    level->r[n] = level->b[n] - (diag * level->x[n] - sum);
+                }
+            }
+        }
+    }
+
+    // z ~= A^-1 r by one V-cycle. Pre- and post-smoothing visit the colours in opposite
+    // order and restriction is (1/2) of the prolongation's transpose (A scales by 4 per
+    // level), so the preconditioner stays symmetric as CG requires.
+    void VCycle(const std::vector<float>& r, std::vector<float>* z) {
+        levels_[0].b = r;
+        std::fill(levels_[0].x.begin(), levels_[0].x.end(), 0.0f);
+        for (size_t l = 0; l + 1 < levels_.size(); ++l) {
+            Level& fine = levels_[l];
+            Level& coarse = levels_[l + 1];
+            SmoothRedBlack(&fine, kSmoothSweeps, false);
+            Residual(&fine);
+            std::fill(coarse.b.begin(), coarse.b.end(), 0.0f);
+            std::fill(coarse.x.begin(), coarse.x.end(), 0.0f);
+            for (int k = 0; k < fine.nz; ++k) {
+                for (int j = 0; j < fine.ny; ++j) {
+                    for (int i = 0; i < fine.nx; ++i) coarse.b[coarse.Cell(i / 2, j / 2, k / 2)] += 0.5f * fine.r[fine.Cell(i, j, k)];
+                }
+            }
+        }
+        SmoothRedBlack(&levels_.back(), kBottomSweeps, false);
+        SmoothRedBlack(&levels_.back(), kBottomSweeps, true);
+        for (size_t l = levels_.size() - 1; l > 0; --l) {
+            Level& coarse = levels_[l];
+            Level& fine = levels_[l - 1];
+            for (int k = 0; k < fine.nz; ++k) {
+                for (int j = 0; j < fine.ny; ++j) {
+                    for (int i = 0; i < fine.nx; ++i) {
+                        const size_t n = fine.Cell(i, j, k);
+                        if (fine.fluid[n]) fine.x[n] += coarse.x[coarse.Cell(i / 2, j / 2, k / 2)];
+                    }
+                }
+            }
+            SmoothRedBlack(&fine, kSmoothSweeps, true);
+        }
+        z->swap(levels_[0].x);
+        levels_[0].x.assign(z->size(), 0.0f);
+    }
+
+    // Deterministic parallel dot product over fluid cells.
+    double Dot(const std::vector<float>& a, const std::vector<float>& b) {
+        const size_t plane = static_cast<size_t>(nx_) * ny_;
+        ForPlanes(nz_, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                double sum = 0.0;
+                for (size_t n = k * plane; n < (k + 1) * plane; ++n) sum += static_cast<double>(a[n]) * b[n];
+                planeSums_[k] = sum;
+            }
+        });
+        double total = 0.0;
+        for (double s : planeSums_) total += s;
+        return total;
+    }
+
+    float MaxAbs(const std::vector<float>& a) const {
+        float m = 0.0f;
+        for (float x : a) m = std::max(m, std::fabs(x));
+        return m;
+    }
+
+    void Apply(const std::vector<float>& p, std::vector<float>* out) {
+        const Level& level = levels_[0];
+        ForPlanes(nz_, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) {
+                        const size_t n = Cell(i, j, k);
+                        if (!level.fluid[n]) {
+                            (*out)[n] = 0.0f;
+                            continue;
+                        }
+                        float sum = 0.0f;
+                        float diag = 0.0f;
+                        Stencil(level, p, i, j, k, &sum, &diag);
+                        (*out)[n] = diag * p[n] - sum;
+                    }
+                }
+            }
+        });
+    }
+
+    // Solves A q = -div(u) with q = p dt / h (warm-started from the last step), then
+    // subtracts the gradient of q from every interior face.
+    void Project(float dt) {
+        lastDt_ = dt;
+        ForPlanes(nz_, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) {
+                        const size_t n = Cell(i, j, k);
+                        rhs_[n] = solid_[n] ? 0.0f : -Divergence(i, j, k);
+                    }
+                }
+            }
+        });
+        if (!config_.openX) {
+            // Closed box: the operator has the constants in its null space, so keep the
+            // right-hand side consistent.
+            double sum = 0.0;
+            size_t fluid = 0;
+            for (size_t n = 0; n < rhs_.size(); ++n) {
+                if (!solid_[n]) {
+                    sum += rhs_[n];
+                    ++fluid;
+                }
+            }
+            const float mean = fluid > 0 ? static_cast<float>(sum / fluid) : 0.0f;
+            for (size_t n = 0; n < rhs_.size(); ++n) {
+                if (!solid_[n]) rhs_[n] -= mean;
+            }
+        }
+
+        Apply(pressure_, &product_);
+        for (size_t n = 0; n < rhs_.size(); ++n) residual_[n] = rhs_[n] - product_[n];
+        const float tolerance = kTolerance * std::max(1.0f, MaxAbs(rhs_));
+        int iteration = 0;
+        if (MaxAbs(residual_) > tolerance) {
+            VCycle(residual_, &preconditioned_);
+            search_ = preconditioned_;
+            double rz = Dot(residual_, preconditioned_);
+            for (iteration = 1; iteration <= kMaxIterations; ++iteration) {
+                Apply(search_, &product_);
+                const double sq = Dot(search_, product_);
+                if (std::fabs(sq) < 1.0e-30) break;
+                const float alpha = static_cast<float>(rz / sq);
+                for (size_t n = 0; n < rhs_.size(); ++n) {
+                    pressure_[n] += alpha * search_[n];
+                    residual_[n] -= alpha * product_[n];
+                }
+                if (MaxAbs(residual_) <= tolerance) break;
+                VCycle(residual_, &preconditioned_);
+                const double rzNext = Dot(residual_, preconditioned_);
+                const float beta = static_cast<float>(rzNext / std::max(rz, 1.0e-30));
+                rz = rzNext;
+                for (size_t n = 0; n < rhs_.size(); ++n) search_[n] = preconditioned_[n] + beta * search_[n];
+            }
+        }
+        lastIterations_ = iteration;
+
+        ForPlanes(nz_ + 1, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) {
+                for (int j = 0; j < ny_ && k < nz_; ++j) {
+                    for (int i = 1; i <= nx_; ++i) {
+                        if (i == nx_ && !config_.openX) continue;
+                        if (SolidCell(i - 1, j, k) || SolidCell(i, j, k)) continue;
+                        const float right = i < nx_ ? pressure_[Cell(i, j, k)] : 0.0f;
+                        u_[U(i, j, k)] -= right - pressure_[Cell(i - 1, j, k)];
+                    }
+                }
+                for (int j = 1; j < ny_ && k < nz_; ++j) {
+                    for (int i = 0; i < nx_; ++i) {
+                        if (SolidCell(i, j - 1, k) || SolidCell(i, j, k)) continue;
+                        v_[V(i, j, k)] -= pressure_[Cell(i, j, k)] - pressure_[Cell(i, j - 1, k)];
+                    }
+                }
+                if (k == 0 || k == nz_) continue;
+                for (int j = 0; j < ny_; ++j) {
+                    for (int i = 0; i < nx_; ++i) {
+                        if (SolidCell(i, j, k - 1) || SolidCell(i, j, k)) continue;
+                        w_[W(i, j, k)] -= pressure_[Cell(i, j, k)] - pressure_[Cell(i, j, k - 1)];
+                    }
+                }
+            }
+        });
+
+        float maxDiv = 0.0f;
+        for (int k = 0; k < nz_; ++k) {
+            for (int j = 0; j < ny_; ++j) {
+                for (int i = 0; i < nx_; ++i) {
+                    if (!solid_[Cell(i, j, k)]) maxDiv = std::max(maxDiv, std::fabs(Divergence(i, j, k)));
+                }
+            }
+        }
+        lastDivergence_ = maxDiv;
+    }
+
+    // Net outflow velocity of a cell (divergence times h).
+    float Divergence(int i, int j, int k) const {
+        return (u_[U(i + 1, j, k)] - u_[U(i, j, k)]) + (v_[V(i, j + 1, k)] - v_[V(i, j, k)]) + (w_[W(i, j, k + 1)] - w_[W(i, j, k)]);
+    }
+
+    FluidConfig config_;
+    int nx_ = 0;
+    int ny_ = 0;
+    int nz_ = 0;
+    float time_ = 0.0f;
+    float lastDt_ = 0.0f;
+    float lastDivergence_ = 0.0f;
+    int lastIterations_ = 0;
+    std::vector<float> u_, v_, w_;
+    std::vector<float> u0_, v0_, w0_;
+    std::vector<uint8_t> solid_;
+    std::vector<float> pressure_;  // q = p dt / h
+    std::vector<float> rhs_, residual_, search_, product_, preconditioned_;
+    std::vector<double> planeSums_;
+    std::vector<float> diffuseSource_;
+    std::vector<uint8_t> faceFixed_[3];
+    std::vector<Level> levels_;
+};
+
+}  // namespace astro_fluid
@@ -0,0 +1,773 @@
+#pragma once
+
+#include "philox.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Memory-mapped, octree-indexed star catalogs streamed under a fixed memory budget.
+//
+// PackCatalog() turns a flat star list (a HYG or Gaia-derived CSV, or the synthetic disk
+// below) into one file laid out for mapping:
+//
+//   CatalogHeader    64 bytes, magic "ASTROCAT"
+//   CatalogNode[]    breadth-first octree, children of a node stored contiguously
+//   CatalogStar[]    16 bytes each, page-aligned, grouped by node in node order
+//
+// The octree is layered the way Potree builds point-cloud LODs: stars are sorted
+// brightest first and every node keeps the brightest `nodeCapacity` stars that reach it,
+// passing the rest down to its octants. A node therefore never holds more than one slot's
+// worth of stars, the root alone is a full-sky sample of the brightest stars, and drawing
+// any parent-closed set of nodes gives a view whose detail grows where the camera looks.
+//
+// StarCatalog maps the file read-only (mmap, or CreateFileMapping on Windows) and hands
+// out node and star pointers without reading anything up front. CatalogStreamer keeps a
+// fixed arena of slots, one node each, picks the nodes worth drawing from a caller-supplied
+// priority (typically projected size), and pages missing nodes in on a worker thread: the
+// worker copies the node's stars out of the mapping into the node's slot, applies an
+// optional remap (e.g. into scene space), and drops the mapped pages again, so the process
+// holds at most the arena plus the node table however large the catalog is. Slots are
+// recycled least-recently-used first. Everything except the worker belongs to the caller's
+// (render) thread.
+
+namespace astro_catalog {
+
+constexpr uint32_t kCatalogVersion = 1;
+constexpr uint32_t kNoChild = 0;            // node 0 is the root, so it is never a child
+constexpr uint64_t kStarBlockAlign = 4096;
+constexpr double kLightYearsPerParsec = 3.26156;
+
+struct CatalogHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeCount;
+    uint64_t starCount;
+    uint64_t nodeOffset;
+    uint64_t starOffset;
+    float rootCenter[3];
+    float rootHalf;
+    uint32_t nodeCapacity;
+    uint32_t maxNodeStars;  // largest starCount of any node (> nodeCapacity only at maxDepth)
+};
+
+struct CatalogNode {
+    float center[3];  // parsecs, heliocentric
+    float half;
+    uint64_t firstStar;
+    uint32_t starCount;
+    uint32_t firstChild;  // index of the first child, or kNoChild
+    uint8_t childMask;    // octant i present when bit i is set; children follow in octant order
+    uint8_t depth;
+    uint16_t childCount;
+    uint32_t subtreeStars;
+};
+
+// Position in parsecs and an RGBA colour whose alpha encodes luminosity. Same layout as
+// astro_render::CloudPoint so slots upload without conversion.
+struct CatalogStar {
+    float pos[3];
+    uint8_t rgba[4];
+};
+
+static_assert(sizeof(CatalogHeader) == 64, "catalog header layout");
+static_assert(sizeof(CatalogNode) == 40, "catalog node layout");
+static_assert(sizeof(CatalogStar) == 16, "catalog star layout");
+
+// One input star for the packer.
+struct PackStar {
+    float pos[3];     // parsecs
+    float absMag;     // absolute visual magnitude
+    float colorIndex; // B - V
+};
+
+struct PackOptions {
+    uint32_t nodeCapacity = 4096;
+    int maxDepth = 14;
+};
+
+// sRGB of a blackbody at `kelvin` (Tanner Helland's fit), clamped to 1000..40000 K.
+inline std::array<uint8_t, 3> BlackbodyColor(float kelvin) {
+    const float t = std::clamp(kelvin, 1000.0f, 40000.0f) / 100.0f;
+    float r, g, b;
+    if (t <= 66.0f) {
+        r = 255.0f;
+        g = 99.47f * std::log(t) - 161.12f;
+        b = t <= 19.0f ? 0.0f : 138.52f * std::log(t - 10.0f) - 305.04f;
+    } else {
+        r = 329.70f * std::pow(t - 60.0f, -0.1332f);
+        g = 288.12f * std::pow(t - 60.0f, -0.0755f);
+        b = 255.0f;
+    }
+    const auto byte = [](float v) { return static_cast<uint8_t>(std::clamp(v, 0.0f, 255.0f)); };
+    return {byte(r), byte(g), byte(b)};
+}
+
+// sRGB of a star from its B - V index: Ballesteros' temperature fit and a blackbody
+// colour approximation.
+inline std::array<uint8_t, 3> StarColor(float colorIndex) {
+    const float bv = std::clamp(colorIndex, -0.4f, 2.0f);
+    return BlackbodyColor(4600.0f * (1.0f / (0.92f * bv + 1.7f) + 1.0f / (0.92f * bv + 0.62f)));
+}
+
+// Alpha from absolute magnitude: M = -6 and brighter saturate, M = 14 is barely visible.
+inline uint8_t LuminosityAlpha(float absMag) {
+    const float t = std::clamp((14.0f - absMag) / 20.0f, 0.0f, 1.0f);
+    return static_cast<uint8_t>(36.0f + 219.0f * t);
+}
+
+inline bool PackCatalog(std::vector<PackStar> stars, const PackOptions& options, const std::string& path,
+                        std::string* error) {
+    if (stars.empty()) {
+        *error = "no stars to pack";
+        return false;
+    }
+    const uint32_t capacity = std::max<uint32_t>(1, options.nodeCapacity);
+    std::stable_sort(stars.begin(), stars.end(), [](const PackStar& a, const PackStar& b) { return a.absMag < b.absMag; });
+
+    float lo[3] = {stars[0].pos[0], stars[0].pos[1], stars[0].pos[2]};
+    float hi[3] = {lo[0], lo[1], lo[2]};
+    for (const PackStar& s : stars) {
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = std::min(lo[k], s.pos[k]);
+            hi[k] = std::max(hi[k], s.pos[k]);
+        }
+    }
+
+    CatalogHeader header{};
+    std::memcpy(header.magic, "ASTROCAT", 8);
+    header.version = kCatalogVersion;
+    header.starCount = stars.size();
+    header.nodeCapacity = capacity;
+    for (int k = 0; k < 3; ++k) header.rootCenter[k] = 0.5f * (lo[k] + hi[k]);
+    header.rootHalf = 0.5f * std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]}) * 1.001f + 1.0e-3f;
+
+    // Breadth first: every node's children are appended together, so they end up
+    // contiguous, and stars are emitted in node order. Each queued node owns its star
+    // indices, still in brightest-first order.
+    std::vector<CatalogNode> nodes;
+    std::vector<uint32_t> order;
+    order.reserve(stars.size());
+    std::vector<std::vector<uint32_t>> members(1);
+    members[0].resize(stars.size());
+    for (uint32_t i = 0; i < stars.size(); ++i) members[0][i] = i;
+    CatalogNode root{};
+    std::memcpy(root.center, header.rootCenter, sizeof(root.center));
+    root.half = header.rootHalf;
+    nodes.push_back(root);
+
+    std::array<std::vector<uint32_t>, 8> octants;
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        std::vector<uint32_t> own;
+        own.swap(members[n]);
+        const bool leaf = own.size() <= capacity || nodes[n].depth >= options.maxDepth;
+        const size_t keep = leaf ? own.size() : capacity;
+        nodes[n].firstStar = order.size();
+        nodes[n].starCount = static_cast<uint32_t>(keep);
+        header.maxNodeStars = std::max(header.maxNodeStars, nodes[n].starCount);
+        order.insert(order.end(), own.begin(), own.begin() + static_cast<std::ptrdiff_t>(keep));
+        if (leaf) continue;
+
+        for (std::vector<uint32_t>& o : octants) o.clear();
+        const CatalogNode parent = nodes[n];
+        for (size_t i = keep; i < own.size(); ++i) {
+            const float* p = stars[own[i]].pos;
+            const int octant = (p[0] >= parent.center[0] ? 1 : 0) | (p[1] >= parent.center[1] ? 2 : 0) |
+                               (p[2] >= parent.center[2] ? 4 : 0);
+            octants[static_cast<size_t>(octant)].push_back(own[i]);
+        }
+        nodes[n].firstChild = static_cast<uint32_t>(nodes.size());
+        for (int octant = 0; octant < 8; ++octant) {
+            if (octants[static_cast<size_t>(octant)].empty()) continue;
+            CatalogNode child{};
+            child.half = 0.5f * parent.half;
+            child.center[0] = parent.center[0] + ((octant & 1) ? child.half : -child.half);
+            child.center[1] = parent.center[1] + ((octant & 2) ? child.half : -child.half);
+            child.center[2] = parent.center[2] + ((octant & 4) ? child.half : -child.half);
+            child.depth = static_cast<uint8_t>(parent.depth + 1);
+            nodes[n].childMask = static_cast<uint8_t>(nodes[n].childMask | (1u << octant));
+            ++nodes[n].childCount;
+            nodes.push_back(child);
+            members.emplace_back();
+            members.back().swap(octants[static_cast<size_t>(octant)]);
+        }
+    }
+    // Children always follow their parent, so one backwards pass folds every subtree.
+    for (size_t n = nodes.size(); n-- > 0;) {
+        nodes[n].subtreeStars = nodes[n].starCount;
+        for (uint32_t c = 0; c < nodes[n].childCount; ++c) nodes[n].subtreeStars += nodes[nodes[n].firstChild + c].subtreeStars;
+    }
+
+    header.nodeCount = static_cast<uint32_t>(nodes.size());
+    header.nodeOffset = sizeof(CatalogHeader);
+    header.starOffset = (header.nodeOffset + nodes.size() * sizeof(CatalogNode) + kStarBlockAlign - 1) / kStarBlockAlign * kStarBlockAlign;
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        *error = "cannot create " + path;
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(nodes.data(), sizeof(CatalogNode), nodes.size(), file) == nodes.size();
+    const std::vector<char> pad(header.starOffset - header.nodeOffset - nodes.size() * sizeof(CatalogNode), 0);
+    ok = ok && (pad.empty() || std::fwrite(pad.data(), 1, pad.size(), file) == pad.size());
+    std::vector<CatalogStar> block;
+    block.reserve(16384);
+    for (size_t i = 0; ok && i < order.size(); ++i) {
+        const PackStar& s = stars[order[i]];
+        const std::array<uint8_t, 3> rgb = StarColor(s.colorIndex);
+        block.push_back({{s.pos[0], s.pos[1], s.pos[2]}, {rgb[0], rgb[1], rgb[2], LuminosityAlpha(s.absMag)}});
+        if (block.size() == block.capacity() || i + 1 == order.size()) {
+            ok = std::fwrite(block.data(), sizeof(CatalogStar), block.size(), file) == block.size();
+            block.clear();
+        }
+    }
+    if (std::fclose(file) != 0 || !ok) {
+        *error = "write failed: " + path;
+        return false;
+    }
+    return true;
+}
+
+// Reads stars from a CSV with a header row naming at least x, y, z (parsecs) and absmag;
+// ci (B - V) is optional. This is the HYG database layout; Gaia extracts converted to
+// the same columns load the same way. Rows with missing values, and the Sun (distance 0),
+// are skipped.
+inline bool ReadStarCsv(const std::string& path, std::vector<PackStar>* stars, std::string* error) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        *error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    const auto readLine = [&]() {
+        line.clear();
+        for (int c; (c = std::fgetc(file)) != EOF;) {
+            if (c == '\n') return true;
+            if (c != '\r') line.push_back(static_cast<char>(c));
+        }
+        return !line.empty();
+    };
+    const auto split = [](const std::string& text, std::vector<std::string>* fields) {
+        fields->clear();
+        std::string field;
+        bool quoted = false;
+        for (char c : text) {
+            if (c == '"') {
+                quoted = !quoted;
+            } else if (c == ',' && !quoted) {
+                fields->push_back(field);
+                field.clear();
+            } else {
+                field.push_back(c);
+            }
+        }
+        fields->push_back(field);
+    };
+
+    std::vector<std::string> fields;
+    if (!readLine()) {
+        std::fclose(file);
+        *error = path + " is empty";
+        return false;
+    }
+    split(line, &fields);
+    int col[5] = {-1, -1, -1, -1, -1};  // x y z absmag ci
+    const char* names[5] = {"x", "y", "z", "absmag", "ci"};
+    for (int i = 0; i < static_cast<int>(fields.size()); ++i) {
+        for (int k = 0; k < 5; ++k) {
+            if (fields[static_cast<size_t>(i)] == names[k]) col[k] = i;
+        }
+    }
+    if (col[0] < 0 || col[1] < 0 || col[2] < 0 || col[3] < 0) {
+        std::fclose(file);
+        *error = path + ": header needs x, y, z and absmag columns";
+        return false;
+    }
+    const int needed = *std::max_element(col, col + 5);
+    while (readLine()) {
+        split(line, &fields);
+        if (static_cast<int>(fields.size()) <= needed) continue;
+        float v[5] = {0.0f, 0.0f, 0.0f, 0.0f, 0.65f};
+        bool ok = true;
+        for (int k = 0; k < 5 && ok; ++k) {
+            if (col[k] < 0) continue;
+            const std::string& text = fields[static_cast<size_t>(col[k])];
+            char* end = nullptr;
+            const float value = std::strtof(text.c_str(), &end);
+            if (end == text.c_str()) {
+                ok = k == 4;  // a blank colour index keeps the solar default
+                continue;
+            }
+            v[k] = value;
+        }
+        if (!ok || v[0] * v[0] + v[1] * v[1] + v[2] * v[2] <= 0.0f) continue;
+        stars->push_back({{v[0], v[1], v[2]}, v[3], v[4]});
+    }
+    std::fclose(file);
+    return true;
+}
+
+// A stand-in for a real catalog: `count` stars in an exponential thin disk (scale height
+// 300 pc) centred on the Sun out to `radiusPc`, a handful of open clusters, and a
+// main-sequence-like luminosity function so the faint stars vastly outnumber the bright.
+inline std::vector<PackStar> SyntheticDiskStars(size_t count, float radiusPc, uint64_t seed) {
+    astro_random::PhiloxStream rng(seed);
+    std::vector<PackStar> stars;
+    stars.reserve(count);
+    constexpr int kClusters = 24;
+    std::array<std::array<float, 4>, kClusters> clusters{};
+    for (auto& c : clusters) {
+        const float r = radiusPc * std::sqrt(rng.Uniform());
+        const float a = rng.Uniform(0.0f, 6.2831853f);
+        c = {r * std::cos(a), 120.0f * rng.Normal(), r * std::sin(a), rng.Uniform(2.0f, 12.0f)};
+    }
+    for (size_t i = 0; i < count; ++i) {
+        PackStar s{};
+        if (i % 10 == 0) {
+            const auto& c = clusters[static_cast<size_t>(rng.Range(0, kClusters - 1))];
+            for (int k = 0; k < 3; ++k) s.pos[k] = c[static_cast<size_t>(k)] + c[3] * rng.Normal();
+        } else {
+            const float r = radiusPc * std::sqrt(rng.Uniform());
+            const float a = rng.Uniform(0.0f, 6.2831853f);
+            const float u = rng.Uniform(1.0e-6f, 1.0f);
+            s.pos[0] = r * std::cos(a);
+            s.pos[1] = (rng.Uniform() < 0.5f ? -300.0f : 300.0f) * std::log(u);
+            s.pos[2] = r * std::sin(a);
+        }
+        // Luminosity function: exponential in magnitude toward the faint end, plus giants.
+        const bool giant = rng.Uniform() < 0.04f;
+        s.absMag = giant ? rng.Uniform(-5.0f, 1.5f) : std::min(16.0f, -2.0f + 18.0f * std::sqrt(rng.Uniform()));
+        s.colorIndex = giant ? rng.Uniform(0.8f, 1.8f) : std::clamp(-0.25f + 0.11f * (s.absMag + 2.0f) + 0.08f * rng.Normal(), -0.35f, 2.0f);
+        stars.push_back(s);
+    }
+    return stars;
+}
+
+// Read-only mapping of a whole file.
+class MappedFile {
+  public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path, std::string* error) {
+        Close();
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            *error = "cannot open " + path;
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+            *error = path + " is empty";
+            Close();
+            return false;
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        data_ = mapping_ != nullptr ? static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            *error = "cannot open " + path;
+            return false;
+        }
+        struct stat info;
+        if (::fstat(fd_, &info) != 0 || info.st_size == 0) {
+            *error = path + " is empty";
+            Close();
+            return false;
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        data_ = data != MAP_FAILED ? static_cast<const uint8_t*>(data) : nullptr;
+        if (data_ != nullptr) ::madvise(data, size_, MADV_RANDOM);
+#endif
+        if (data_ == nullptr) {
+            *error = "cannot map " + path;
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close() {
+#if defined(_WIN32)
+        if (data_ != nullptr) UnmapViewOfFile(data_);
+        if (mapping_ != nullptr) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_ != nullptr) ::munmap(const_cast<uint8_t*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    // Lets the OS drop the pages backing [offset, offset + bytes) from this process; they
+    // are re-read from the file if touched again. A hint only: a no-op on Windows, where
+    // the working-set manager trims clean file pages by itself.
+    void Release(size_t offset, size_t bytes) const {
+#if !defined(_WIN32)
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t begin = (offset + page - 1) / page * page;
+        const size_t end = std::min(size_, offset + bytes) / page * page;
+        if (end > begin) ::madvise(const_cast<uint8_t*>(data_) + begin, end - begin, MADV_DONTNEED);
+#else
+        (void)offset;
+        (void)bytes;
+#endif
+    }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+  private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+class StarCatalog {
+  public:
+    bool Open(const std::string& path, std::string* error) {
+        if (!file_.Open(path, error)) return false;
+        if (file_.size() < sizeof(CatalogHeader)) {
+            *error = path + " is not a star catalog";
+            file_.Close();
+            return false;
+        }
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        const uint64_t nodeEnd = header_.nodeOffset + static_cast<uint64_t>(header_.nodeCount) * sizeof(CatalogNode);
+        const uint64_t starEnd = header_.starOffset + header_.starCount * sizeof(CatalogStar);
+        if (std::memcmp(header_.magic, "ASTROCAT", 8) != 0 || header_.version != kCatalogVersion || header_.nodeCount == 0 ||
+            nodeEnd > header_.starOffset || starEnd > file_.size() || header_.nodeOffset % alignof(CatalogNode) != 0) {
+            *error = path + ": unsupported or truncated catalog";
+            file_.Close();
+            return false;
+        }
+        nodes_ = reinterpret_cast<const CatalogNode*>(file_.data() + header_.nodeOffset);
+        for (uint32_t i = 0; i < header_.nodeCount; ++i) {
+            const CatalogNode& node = nodes_[i];
+            if (node.firstStar + node.starCount > header_.starCount || node.starCount > header_.maxNodeStars ||
+                (node.childCount > 0 && (node.firstChild <= i || node.firstChild + node.childCount > header_.nodeCount))) {
+                *error = path + ": corrupt node " + std::to_string(i);
+                file_.Close();
+                nodes_ = nullptr;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool open() const { return nodes_ != nullptr; }
+    const CatalogHeader& header() const { return header_; }
+    uint32_t nodeCount() const { return header_.nodeCount; }
+    uint64_t starCount() const { return header_.starCount; }
+    const CatalogNode& node(uint32_t i) const { return nodes_[i]; }
+
+    const CatalogStar* stars(const CatalogNode& node) const {
+        return reinterpret_cast<const CatalogStar*>(file_.data() + header_.starOffset) + node.firstStar;
+    }
+
+    // Drops the mapped pages of one node's stars.
+    void Release(const CatalogNode& node) const {
+        file_.Release(static_cast<size_t>(header_.starOffset + node.firstStar * sizeof(CatalogStar)),
+                      node.starCount * sizeof(CatalogStar));
+    }
+
+  private:
+    MappedFile file_;
+    CatalogHeader header_{};
+    const CatalogNode* nodes_ = nullptr;
+};
+
+struct StreamerStats {
+    size_t slots = 0;
+    size_t residentNodes = 0;
+    size_t pendingNodes = 0;
+    size_t selectedNodes = 0;
+    size_t drawnStars = 0;
+    uint64_t pageIns = 0;
+    uint64_t evictions = 0;
+    uint64_t bytesPaged = 0;
+};
+
+class CatalogStreamer {
+  public:
+    using Remap = std::function<void(CatalogStar*, size_t)>;
+
+    struct Arrival {
+        uint32_t slot;
+        uint32_t node;
+    };
+    struct DrawRun {
+        size_t first;  // star index into the arena (slot * slotStars())
+        size_t count;
+    };
+
+    static constexpr size_t kMaxQueued = 24;
+
+    CatalogStreamer() = default;
+    ~CatalogStreamer() { Stop(); }
+    CatalogStreamer(const CatalogStreamer&) = delete;
+    CatalogStreamer& operator=(const CatalogStreamer&) = delete;
+
+    // Sizes the arena to floor(budgetBytes / slot bytes) slots, at least one and no more
+    // than the catalog has nodes. The catalog must outlive the streamer.
+    void Configure(const StarCatalog* catalog, size_t budgetBytes, Remap remap = nullptr) {
+        Stop();
+        catalog_ = catalog;
+        remap_ = std::move(remap);
+        slotStars_ = catalog->header().maxNodeStars;
+        const size_t slotBytes = slotStars_ * sizeof(CatalogStar);
+        slotCount_ = std::clamp<size_t>(budgetBytes / std::max<size_t>(1, slotBytes), 1, catalog->nodeCount());
+        arena_.assign(slotCount_ * slotStars_, CatalogStar{});
+        slotNode_.assign(slotCount_, kFreeSlot);
+        slotUsed_.assign(slotCount_, 0);
+        freeSlots_.clear();
+        for (size_t s = slotCount_; s-- > 0;) freeSlots_.push_back(static_cast<uint32_t>(s));
+        nodeState_.assign(catalog->nodeCount(), kAbsent);
+        nodeSlot_.assign(catalog->nodeCount(), kFreeSlot);
+        selectedStamp_.assign(catalog->nodeCount(), 0);
+        frame_ = 0;
+        stats_ = StreamerStats{};
+        stats_.slots = slotCount_;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.clear();
+            finished_.clear();
+            stop_ = false;
+        }
+        worker_ = std::thread([this]() { WorkerLoop(); });
+    }
+
+    // Once per frame: takes in finished page-ins (listed in arrivals() for upload), picks
+    // the highest-priority nodes that fit the arena, parents before children and none
+    // below minPriority, and queues the missing ones, evicting least-recently-selected
+    // nodes for room.
+    // `priority` is any callable float(const CatalogNode&).
+    template <typename Priority>
+    void Update(const Priority& priority, float minPriority) {
+        ++frame_;
+        arrivals_.clear();
+        draws_.clear();
+        reclaimed_.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            arrivals_.insert(arrivals_.end(), finished_.begin(), finished_.end());
+            finished_.clear();
+            reclaimed_.swap(pending_);
+        }
+        for (const Arrival& a : arrivals_) {
+            nodeState_[a.node] = kResident;
+            ++stats_.pageIns;
+            stats_.bytesPaged += catalog_->node(a.node).starCount * sizeof(CatalogStar);
+        }
+        for (const auto& [node, slot] : reclaimed_) {
+            nodeState_[node] = kAbsent;
+            nodeSlot_[node] = kFreeSlot;
+            slotNode_[slot] = kFreeSlot;
+            freeSlots_.push_back(slot);
+        }
+
+        selected_.clear();
+        frontier_.clear();
+        frontier_.push_back({priority(catalog_->node(0)), 0});
+        while (!frontier_.empty() && selected_.size() < slotCount_) {
+            std::pop_heap(frontier_.begin(), frontier_.end());
+            const auto [score, index] = frontier_.back();
+            frontier_.pop_back();
+            if (index != 0 && score < minPriority) break;
+            selected_.push_back(index);
+            selectedStamp_[index] = frame_;
+            const CatalogNode& node = catalog_->node(index);
+            for (uint32_t c = 0; c < node.childCount; ++c) {
+                const uint32_t child = node.firstChild + c;
+                frontier_.push_back({priority(catalog_->node(child)), child});
+                std::push_heap(frontier_.begin(), frontier_.end());
+            }
+        }
+
+        queue_.clear();
+        for (uint32_t index : selected_) {
+            if (nodeState_[index] == kResident) {
+                slotUsed_[nodeSlot_[index]] = frame_;
+                draws_.push_back({static_cast<size_t>(nodeSlot_[index]) * slotStars_, catalog_->node(index).starCount});
+                continue;
+            }
+            if (nodeState_[index] != kAbsent || queue_.size() >= kMaxQueued) continue;
+            const uint32_t slot = TakeSlot();
+            if (slot == kFreeSlot) continue;
+            nodeState_[index] = kQueued;
+            nodeSlot_[index] = slot;
+            slotNode_[slot] = index;
+            slotUsed_[slot] = frame_;
+            queue_.emplace_back(index, slot);
+        }
+        if (!queue_.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_.swap(queue_);
+            }
+            wake_.notify_one();
+        }
+
+        stats_.selectedNodes = selected_.size();
+        stats_.residentNodes = slotCount_ - freeSlots_.size();
+        stats_.pendingNodes = 0;
+        stats_.drawnStars = 0;
+        for (uint32_t index : selected_) stats_.pendingNodes += nodeState_[index] == kQueued ? 1 : 0;
+        for (const DrawRun& run : draws_) stats_.drawnStars += run.count;
+    }
+
+    // Blocks until every queued page-in has finished (headless runs and tests).
+    void Drain() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this]() { return pending_.empty() && !loading_; });
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+    // Nodes whose stars landed in their slot since the previous Update().
+    const std::vector<Arrival>& arrivals() const { return arrivals_; }
+    // Selected, resident nodes as runs of the arena.
+    const std::vector<DrawRun>& draws() const { return draws_; }
+    const std::vector<uint32_t>& selected() const { return selected_; }
+    const CatalogStar* slotStars(uint32_t slot) const { return arena_.data() + static_cast<size_t>(slot) * slotStars_; }
+    size_t slotStars() const { return slotStars_; }
+    size_t slotCount() const { return slotCount_; }
+    size_t arenaBytes() const { return arena_.size() * sizeof(CatalogStar); }
+    const StreamerStats& stats() const { return stats_; }
+
+  private:
+    static constexpr uint32_t kFreeSlot = 0xffffffffu;
+    static constexpr uint8_t kAbsent = 0;
+    static constexpr uint8_t kQueued = 1;
+    static constexpr uint8_t kResident = 2;
+
+    // A free slot, else the least recently selected resident one that is not selected now.
+    uint32_t TakeSlot() {
+        if (!freeSlots_.empty()) {
+            const uint32_t slot = freeSlots_.back();
+            freeSlots_.pop_back();
+            return slot;
+        }
+        uint32_t best = kFreeSlot;
+        uint64_t oldest = frame_;
+        for (uint32_t s = 0; s < slotCount_; ++s) {
+            const uint32_t node = slotNode_[s];
+            if (node == kFreeSlot || nodeState_[node] != kResident || selectedStamp_[node] == frame_) continue;
+            if (slotUsed_[s] < oldest) {
+                oldest = slotUsed_[s];
+                best = s;
+            }
+        }
+        if (best == kFreeSlot) return kFreeSlot;
+        const uint32_t node = slotNode_[best];
+        nodeState_[node] = kAbsent;
+        nodeSlot_[node] = kFreeSlot;
+        slotNode_[best] = kFreeSlot;
+        ++stats_.evictions;
+        return best;
+    }
+
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+            if (stop_) return;
+            const auto [index, slot] = pending_.front();
+            pending_.erase(pending_.begin());
+            loading_ = true;
+            lock.unlock();
+
+            const CatalogNode& node = catalog_->node(index);
+            CatalogStar* out = arena_.data() + static_cast<size_t>(slot) * slotStars_;
+            std::memcpy(out, catalog_->stars(node), node.starCount * sizeof(CatalogStar));
+            catalog_->Release(node);
+            if (remap_) remap_(out, node.starCount);
+
+            lock.lock();
+            finished_.push_back({slot, index});
+            loading_ = false;
+            if (pending_.empty()) idle_.notify_all();
+        }
+    }
+
+    const StarCatalog* catalog_ = nullptr;
+    Remap remap_;
+    size_t slotStars_ = 0;
+    size_t slotCount_ = 0;
+    std::vector<CatalogStar> arena_;
+    std::vector<uint32_t> slotNode_;
+    std::vector<uint64_t> slotUsed_;
+    std::vector<uint32_t> freeSlots_;
+    std::vector<uint8_t> nodeState_;
+    std::vector<uint32_t> nodeSlot_;
+    std::vector<uint64_t> selectedStamp_;
+    std::vector<uint32_t> selected_;
+    std::vector<Arrival> arrivals_;
+    std::vector<DrawRun> draws_;
+    std::vector<std::pair<float, uint32_t>> frontier_;     // max-heap on priority
+    std::vector<std::pair<uint32_t, uint32_t>> reclaimed_;
+    std::vector<std::pair<uint32_t, uint32_t>> queue_;
+    uint64_t frame_ = 0;
+    StreamerStats stats_;
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::vector<std::pair<uint32_t, uint32_t>> pending_;  // (node, slot), highest priority first
+    std::vector<Arrival> finished_;
+    bool loading_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_catalog
@@ -0,0 +1,256 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace astro_render {
+
+// One backdrop star (32 bytes, uploaded once). Twinkle is evaluated on the GPU as
+// pulse = sin(time * twinkleRate + twinklePhase), scaling alpha by (1 + alphaTwinkle * pulse)
+// and size by (1 + sizeTwinkle * pulse); color.a is the mean alpha.
+struct StarfieldStar {
+    Vector3 pos;
+    float size;
+    Color color;
+    float twinkleRate;
+    float twinklePhase;
+    float alphaTwinkle;
+    float sizeTwinkle;
+};
+
+enum class StarfieldSpace {
+    kWorldBillboard,  // camera-facing disc of radius `size` in world units (replaces DrawSphere)
+    kWorldPoint,      // disc of radius `size` pixels at a world position (replaces DrawPoint3D)
+    kScreen,          // pos.xy in [0, 1] of the screen, radius `size` pixels (replaces DrawCircle)
+};
+
+// Per-draw parameters shared by the whole layer.
+struct StarfieldView {
+    float time = 0.0f;
+    float spin = 0.0f;           // rotation about +y applied before `offset`, radians
+    Vector3 offset = {0.0f, 0.0f, 0.0f};
+    float fade = 1.0f;           // alpha multiplier
+    Color tint = {255, 255, 255, 255};
+    float tintAmount = 0.0f;     // 0 keeps each star's colour, 1 replaces it with `tint`
+};
+
+// Static starfield baked into a vertex buffer once and drawn with one instanced call;
+// twinkle, spin and fading are uniforms, so the per-frame cost does not depend on the
+// star count. World layers draw between BeginMode3D/EndMode3D, screen layers outside
+// it. Unload() must run before CloseWindow(). Without GL 3.3 Draw() falls back to the
+// per-star raylib calls.
+class StarfieldLayer {
+  public:
+    bool Init(StarfieldSpace space, const std::vector<StarfieldStar>& stars) {
+        Unload();
+        space_ = space;
+        stars_ = stars;
+
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locVertex_ = rlGetLocationAttrib(shader_, "vertexPosition");
+        locPosSize_ = rlGetLocationAttrib(shader_, "starPosSize");
+        locColor_ = rlGetLocationAttrib(shader_, "starColor");
+        locTwinkle_ = rlGetLocationAttrib(shader_, "starTwinkle");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locRight_ = rlGetLocationUniform(shader_, "camRight");
+        locUp_ = rlGetLocationUniform(shader_, "camUp");
+        locViewport_ = rlGetLocationUniform(shader_, "viewport");
+        locMode_ = rlGetLocationUniform(shader_, "mode");
+        locTime_ = rlGetLocationUniform(shader_, "time");
+        locSpin_ = rlGetLocationUniform(shader_, "spin");
+        locOffset_ = rlGetLocationUniform(shader_, "offset");
+        locFade_ = rlGetLocationUniform(shader_, "fade");
+        locTint_ = rlGetLocationUniform(shader_, "tint");
+
+        static constexpr std::array<float, 12> kQuad = {-1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f};
+        static constexpr std::array<unsigned short, 6> kQuadIndices = {0, 1, 2, 0, 2, 3};
+        vao_ = rlLoadVertexArray();
+        rlEnableVertexArray(vao_);
+        quadVbo_ = rlLoadVertexBuffer(kQuad.data(), static_cast<int>(sizeof(kQuad)), false);
+        rlSetVertexAttribute(static_cast<unsigned int>(locVertex_), 3, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locVertex_));
+        ebo_ = rlLoadVertexBufferElement(kQuadIndices.data(), static_cast<int>(sizeof(kQuadIndices)), false);
+
+        const int stride = static_cast<int>(sizeof(StarfieldStar));
+        starVbo_ = rlLoadVertexBuffer(stars_.data(), static_cast<int>(stars_.size()) * stride, false);
+        rlSetVertexAttribute(static_cast<unsigned int>(locPosSize_), 4, RL_FLOAT, false, stride, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locPosSize_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locPosSize_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locColor_), 4, RL_UNSIGNED_BYTE, true, stride,
+                             static_cast<int>(offsetof(StarfieldStar, color)));
+        rlEnableVertexAttribute(static_cast<unsigned int>(locColor_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locColor_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locTwinkle_), 4, RL_FLOAT, false, stride,
+                             static_cast<int>(offsetof(StarfieldStar, twinkleRate)));
+        rlEnableVertexAttribute(static_cast<unsigned int>(locTwinkle_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locTwinkle_), 1);
+        rlDisableVertexArray();
+
+        ready_ = vao_ != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (starVbo_ != 0) rlUnloadVertexBuffer(starVbo_);
+        if (quadVbo_ != 0) rlUnloadVertexBuffer(quadVbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        starVbo_ = quadVbo_ = ebo_ = vao_ = shader_ = 0;
+        ready_ = false;
+    }
+
+    size_t size() const { return stars_.size(); }
+    bool ready() const { return ready_; }
+
+    void Draw(float time) { Draw(StarfieldView{time}); }
+
+    void Draw(const StarfieldView& view) {
+        if (stars_.empty() || view.fade <= 0.0f) return;
+        if (!ready_) {
+            DrawImmediate(view);
+            return;
+        }
+
+        rlDrawRenderBatchActive();
+        const Matrix modelview = rlGetMatrixModelview();
+        const Matrix mvp = MatrixMultiply(modelview, rlGetMatrixProjection());
+        const std::array<float, 3> right = {modelview.m0, modelview.m4, modelview.m8};
+        const std::array<float, 3> up = {modelview.m1, modelview.m5, modelview.m9};
+        const std::array<float, 2> viewport = {static_cast<float>(GetRenderWidth()), static_cast<float>(GetRenderHeight())};
+        const std::array<float, 2> spin = {std::cos(view.spin), std::sin(view.spin)};
+        const std::array<float, 3> offset = {view.offset.x, view.offset.y, view.offset.z};
+        const std::array<float, 4> tint = {view.tint.r / 255.0f, view.tint.g / 255.0f, view.tint.b / 255.0f, view.tintAmount};
+        const int mode = static_cast<int>(space_);
+
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        rlSetUniform(locRight_, right.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locUp_, up.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locViewport_, viewport.data(), RL_SHADER_UNIFORM_VEC2, 1);
+        rlSetUniform(locMode_, &mode, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(locTime_, &view.time, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locSpin_, spin.data(), RL_SHADER_UNIFORM_VEC2, 1);
+        rlSetUniform(locOffset_, offset.data(), RL_SHADER_UNIFORM_VEC3, 1);
+        rlSetUniform(locFade_, &view.fade, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locTint_, tint.data(), RL_SHADER_UNIFORM_VEC4, 1);
+
+        rlDisableDepthMask();
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArrayElementsInstanced(0, 6, nullptr, static_cast<int>(stars_.size()));
+        rlDisableVertexArray();
+        rlEnableDepthMask();
+        rlDisableShader();
+    }
+
+  private:
+    // Same star model on the CPU, for contexts without instancing.
+    void DrawImmediate(const StarfieldView& view) const {
+        const float c = std::cos(view.spin);
+        const float s = std::sin(view.spin);
+        for (const StarfieldStar& star : stars_) {
+            const float pulse = std::sin(view.time * star.twinkleRate + star.twinklePhase);
+            const float size = star.size * (1.0f + star.sizeTwinkle * pulse);
+            const float alpha = std::clamp(star.color.a / 255.0f * (1.0f + star.alphaTwinkle * pulse), 0.0f, 1.0f) * view.fade;
+            Color color = ColorLerp(star.color, view.tint, view.tintAmount);
+            color.a = static_cast<unsigned char>(255.0f * std::clamp(alpha, 0.0f, 1.0f));
+            if (space_ == StarfieldSpace::kScreen) {
+                DrawCircleV({star.pos.x * GetScreenWidth(), star.pos.y * GetScreenHeight()}, size, color);
+                continue;
+            }
+            const Vector3 p = {c * star.pos.x - s * star.pos.z + view.offset.x, star.pos.y + view.offset.y,
+                               s * star.pos.x + c * star.pos.z + view.offset.z};
+            if (space_ == StarfieldSpace::kWorldPoint) {
+                DrawPoint3D(p, color);
+            } else {
+                DrawSphere(p, size, color);
+            }
+        }
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec3 vertexPosition;
+in vec4 starPosSize;
+in vec4 starColor;
+in vec4 starTwinkle;
+uniform mat4 mvp;
+uniform vec3 camRight;
+uniform vec3 camUp;
+uniform vec2 viewport;
+uniform int mode;
+uniform float time;
+uniform vec2 spin;
+uniform vec3 offset;
+uniform float fade;
+uniform vec4 tint;
+out vec4 fragColor;
+out vec2 fragLocal;
+void main() {
+    float pulse = sin(time * starTwinkle.x + starTwinkle.y);
+    float size = starPosSize.w * (1.0 + starTwinkle.w * pulse);
+    fragColor = vec4(mix(starColor.rgb, tint.rgb, tint.a), clamp(starColor.a * (1.0 + starTwinkle.z * pulse), 0.0, 1.0) * fade);
+    fragLocal = vertexPosition.xy;
+    if (mode == 2) {
+        vec2 ndc = vec2(starPosSize.x * 2.0 - 1.0, 1.0 - starPosSize.y * 2.0);
+        gl_Position = vec4(ndc + vertexPosition.xy * size * 2.0 / viewport, 0.0, 1.0);
+        return;
+    }
+    vec3 p = starPosSize.xyz;
+    p = vec3(spin.x * p.x - spin.y * p.z, p.y, spin.y * p.x + spin.x * p.z) + offset;
+    if (mode == 0) {
+        gl_Position = mvp * vec4(p + (camRight * vertexPosition.x + camUp * vertexPosition.y) * size, 1.0);
+    } else {
+        vec4 clip = mvp * vec4(p, 1.0);
+        clip.xy += vertexPosition.xy * size * 2.0 / viewport * clip.w;
+        gl_Position = clip;
+    }
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+in vec2 fragLocal;
+out vec4 finalColor;
+void main() {
+    float r2 = dot(fragLocal, fragLocal);
+    if (r2 > 1.0) discard;
+    finalColor = fragColor;
+}
+)";
+
+    StarfieldSpace space_ = StarfieldSpace::kWorldBillboard;
+    std::vector<StarfieldStar> stars_;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int quadVbo_ = 0;
+    unsigned int ebo_ = 0;
+    unsigned int starVbo_ = 0;
+    int locVertex_ = -1;
+    int locPosSize_ = -1;
+    int locColor_ = -1;
+    int locTwinkle_ = -1;
+    int locMvp_ = -1;
+    int locRight_ = -1;
+    int locUp_ = -1;
+    int locViewport_ = -1;
+    int locMode_ = -1;
+    int locTime_ = -1;
+    int locSpin_ = -1;
+    int locOffset_ = -1;
+    int locFade_ = -1;
+    int locTint_ = -1;
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
@@ -0,0 +1,531 @@
+#pragma once
+
+#include "particle_soa.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Qubit state-vector simulator. The 2^n amplitudes are kept as split real/imaginary
+// arrays, 64-byte aligned, so a gate kernel streams whole vectors of the amplitude pairs
+// (or quadruples) a gate mixes. Qubit q is bit q of the basis index.
+//
+// A single-qubit gate mixes amplitudes i and i + 2^q; for q >= 3 (AVX2) or q >= 2 (NEON)
+// runs of those pairs are contiguous and go through the SIMD path. With AVX2, gates on
+// qubits 0-2 use lane permutes inside each vector instead; elsewhere they fall through to
+// the scalar loop. Passes over states of kParallelAmplitudes or more split
+// across the shared thread pool. A Circuit records gates, and Fused() folds runs of
+// single-qubit gates into one matrix per qubit and then into neighbouring two-qubit gates,
+// so a layer of n Hadamards costs n / 2 passes over memory instead of n.
+
+namespace astro_quantum {
+
+using Amplitude = std::complex<float>;
+using Gate1 = std::array<Amplitude, 4>;   // row-major 2x2
+using Gate2 = std::array<Amplitude, 16>;  // row-major 4x4 on local index bitA + 2 * bitB
+
+inline Gate1 Hadamard() {
+    const float s = 0.70710678f;
+    return {Amplitude(s), Amplitude(s), Amplitude(s), Amplitude(-s)};
+}
+
+inline Gate1 PauliX() { return {Amplitude(0.0f), Amplitude(1.0f), Amplitude(1.0f), Amplitude(0.0f)}; }
+
+inline Gate1 PhaseShift(float phi) { return {Amplitude(1.0f), Amplitude(0.0f), Amplitude(0.0f), std::polar(1.0f, phi)}; }
+
+// Control on qubit A, target on qubit B.
+inline Gate2 ControlledNot() {
+    Gate2 g{};
+    g[0 * 4 + 0] = 1.0f;  // A=0: B unchanged
+    g[2 * 4 + 2] = 1.0f;
+    g[3 * 4 + 1] = 1.0f;  // A=1: B flipped
+    g[1 * 4 + 3] = 1.0f;
+    return g;
+}
+
+inline Gate1 Multiply(const Gate1& a, const Gate1& b) {
+    return {a[0] * b[0] + a[1] * b[2], a[0] * b[1] + a[1] * b[3], a[2] * b[0] + a[3] * b[2], a[2] * b[1] + a[3] * b[3]};
+}
+
+inline Gate2 Multiply(const Gate2& a, const Gate2& b) {
+    Gate2 out{};
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            Amplitude sum(0.0f);
+            for (int k = 0; k < 4; ++k) sum += a[static_cast<size_t>(4 * r + k)] * b[static_cast<size_t>(4 * k + c)];
+            out[static_cast<size_t>(4 * r + c)] = sum;
+        }
+    }
+    return out;
+}
+
+// gb (x) ga on the local index bitA + 2 * bitB.
+inline Gate2 Kron(const Gate1& ga, const Gate1& gb) {
+    Gate2 out{};
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            out[static_cast<size_t>(4 * r + c)] = gb[static_cast<size_t>(2 * (r >> 1) + (c >> 1))] * ga[static_cast<size_t>(2 * (r & 1) + (c & 1))];
+        }
+    }
+    return out;
+}
+
+inline Gate1 Identity1() { return {Amplitude(1.0f), Amplitude(0.0f), Amplitude(0.0f), Amplitude(1.0f)}; }
+
+namespace detail {
+
+#if ASTRO_SOA_AVX2
+inline __m256 MulAdd(__m256 a, __m256 b, __m256 acc) {
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, acc);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), acc);
+#endif
+}
+#endif
+
+// out_r = sum_c m[r][c] * in_c over n consecutive amplitudes of K streams, in place.
+// Real matrices (Hadamard layers and their Kron products) skip the imaginary terms,
+// which halves the arithmetic and keeps the 4x4 coefficients in registers.
+template <int K, bool kReal>
+void ApplyRun(float* const re[K], float* const im[K], size_t n, const Amplitude* m) {
+    size_t j = 0;
+#if ASTRO_SOA_AVX2
+    __m256 mr[K * K], mi[kReal ? 1 : K * K];
+    for (int e = 0; e < K * K; ++e) {
+        mr[e] = _mm256_set1_ps(m[e].real());
+        if (!kReal) mi[e] = _mm256_set1_ps(m[e].imag());
+    }
+    for (; j + 8 <= n; j += 8) {
+        __m256 xr[K], xi[K];
+        for (int c = 0; c < K; ++c) {
+            xr[c] = _mm256_load_ps(re[c] + j);
+            xi[c] = _mm256_load_ps(im[c] + j);
+        }
+        for (int r = 0; r < K; ++r) {
+            __m256 accR = _mm256_mul_ps(mr[r * K], xr[0]), accI = _mm256_mul_ps(mr[r * K], xi[0]);
+            for (int c = 1; c < K; ++c) {
+                accR = MulAdd(mr[r * K + c], xr[c], accR);
+                accI = MulAdd(mr[r * K + c], xi[c], accI);
+            }
+            if (!kReal) {
+                for (int c = 0; c < K; ++c) {
+                    const int e = r * K + c;
+                    accR = _mm256_sub_ps(accR, _mm256_mul_ps(mi[e], xi[c]));
+                    accI = MulAdd(mi[e], xr[c], accI);
+                }
+            }
+            _mm256_store_ps(re[r] + j, accR);
+            _mm256_store_ps(im[r] + j, accI);
+        }
+    }
+#elif ASTRO_SOA_NEON
+    float32x4_t mr[K * K], mi[kReal ? 1 : K * K];
+    for (int e = 0; e < K * K; ++e) {
+        mr[e] = vdupq_n_f32(m[e].real());
+        if (!kReal) mi[e] = vdupq_n_f32(m[e].imag());
+    }
+    for (; j + 4 <= n; j += 4) {
+        float32x4_t xr[K], xi[K];
+        for (int c = 0; c < K; ++c) {
+            xr[c] = vld1q_f32(re[c] + j);
+            xi[c] = vld1q_f32(im[c] + j);
+        }
+        for (int r = 0; r < K; ++r) {
+            float32x4_t accR = vmulq_f32(mr[r * K], xr[0]), accI = vmulq_f32(mr[r * K], xi[0]);
+            for (int c = 1; c < K; ++c) {
+                accR = vfmaq_f32(accR, mr[r * K + c], xr[c]);
+                accI = vfmaq_f32(accI, mr[r * K + c], xi[c]);
+            }
+            if (!kReal) {
+                for (int c = 0; c < K; ++c) {
+                    const int e = r * K + c;
+                    accR = vfmsq_f32(accR, mi[e], xi[c]);
+                    accI = vfmaq_f32(accI, mi[e], xr[c]);
+                }
+            }
+            vst1q_f32(re[r] + j, accR);
+            vst1q_f32(im[r] + j, accI);
+        }
+    }
+#endif
+    for (; j < n; ++j) {
+        float xr[K], xi[K];
+        for (int c = 0; c < K; ++c) {
+            xr[c] = re[c][j];
+            xi[c] = im[c][j];
+        }
+        for (int r = 0; r < K; ++r) {
+            float accR = 0.0f, accI = 0.0f;
+            for (int c = 0; c < K; ++c) {
+                const float mr = m[r * K + c].real(), mi = m[r * K + c].imag();
+                accR += mr * xr[c] - mi * xi[c];
+                accI += mr * xi[c] + mi * xr[c];
+            }
+            re[r][j] = accR;
+            im[r][j] = accI;
+        }
+    }
+}
+
+#if ASTRO_SOA_AVX2
+// Gates touching qubits 0-2 mix amplitudes inside one 8-wide vector. Each aligned group
+// of eight is combined with lane permutes of itself (and of the group 2^h away when the
+// gate's other qubit h is >= 3): out_r = sum over partner streams s and in-lane xor masks
+// x of coef[r][s][x] * permute(in_s, lane ^ x), with per-lane coefficients from the matrix.
+struct LaneGate {
+    int streams = 1;       // 1, or 2 when one qubit is >= 3
+    int masks = 0;         // in-lane partners per stream
+    uint64_t streamStride = 0;
+    __m256i permute[4];
+    alignas(32) float coefRe[2][2][4][8];
+    alignas(32) float coefIm[2][2][4][8];
+
+    // pos[j] is the qubit of local bit j; at least one of them is below 3.
+    LaneGate(const int* pos, int bits, const Amplitude* m) {
+        const int k = 1 << bits;
+        int lowMask = 0, highBit = -1;
+        for (int j = 0; j < bits; ++j) {
+            if (pos[j] < 3) {
+                lowMask |= 1 << j;
+            } else {
+                highBit = j;
+            }
+        }
+        if (highBit >= 0) {
+            streams = 2;
+            streamStride = uint64_t{1} << pos[highBit];
+        }
+        for (int x = 0; x < k; ++x) {
+            if ((x & ~lowMask) != 0) continue;
+            int laneXor = 0;
+            for (int j = 0; j < bits; ++j) {
+                if ((x >> j) & 1) laneXor |= 1 << pos[j];
+            }
+            alignas(32) int idx[8];
+            for (int l = 0; l < 8; ++l) idx[l] = l ^ laneXor;
+            permute[masks] = _mm256_load_si256(reinterpret_cast<const __m256i*>(idx));
+            for (int l = 0; l < 8; ++l) {
+                int own = 0;  // the lane's local index restricted to the low bits
+                for (int j = 0; j < bits; ++j) {
+                    if ((lowMask >> j) & 1) own |= ((l >> pos[j]) & 1) << j;
+                }
+                for (int r = 0; r < streams; ++r) {
+                    for (int c = 0; c < streams; ++c) {
+                        const int row = own | (highBit >= 0 ? r << highBit : 0);
+                        const int col = (own ^ x) | (highBit >= 0 ? c << highBit : 0);
+                        coefRe[r][c][masks][l] = m[row * k + col].real();
+                        coefIm[r][c][masks][l] = m[row * k + col].imag();
+                    }
+                }
+            }
+            ++masks;
+        }
+    }
+
+    // n consecutive groups of eight starting at re0/im0.
+    void Apply(float* re0, float* im0, size_t n) const {
+        for (size_t g = 0; g < n; ++g) {
+            float* re[2] = {re0 + 8 * g, re0 + 8 * g + streamStride};
+            float* im[2] = {im0 + 8 * g, im0 + 8 * g + streamStride};
+            __m256 xr[2], xi[2];
+            for (int c = 0; c < streams; ++c) {
+                xr[c] = _mm256_load_ps(re[c]);
+                xi[c] = _mm256_load_ps(im[c]);
+            }
+            __m256 outR[2], outI[2];
+            for (int r = 0; r < streams; ++r) {
+                __m256 accR = _mm256_setzero_ps(), accI = _mm256_setzero_ps();
+                for (int c = 0; c < streams; ++c) {
+                    for (int x = 0; x < masks; ++x) {
+                        const __m256 pr = _mm256_permutevar8x32_ps(xr[c], permute[x]);
+                        const __m256 pi = _mm256_permutevar8x32_ps(xi[c], permute[x]);
+                        const __m256 cr = _mm256_load_ps(coefRe[r][c][x]);
+                        const __m256 ci = _mm256_load_ps(coefIm[r][c][x]);
+                        accR = _mm256_sub_ps(MulAdd(cr, pr, accR), _mm256_mul_ps(ci, pi));
+                        accI = MulAdd(ci, pr, MulAdd(cr, pi, accI));
+                    }
+                }
+                outR[r] = accR;
+                outI[r] = accI;
+            }
+            for (int r = 0; r < streams; ++r) {
+                _mm256_store_ps(re[r], outR[r]);
+                _mm256_store_ps(im[r], outI[r]);
+            }
+        }
+    }
+};
+#endif
+
+template <size_t N>
+bool IsReal(const std::array<Amplitude, N>& g) {
+    return std::all_of(g.begin(), g.end(), [](Amplitude a) { return a.imag() == 0.0f; });
+}
+
+// Index with a zero bit inserted at position q.
+inline uint64_t InsertZeroBit(uint64_t p, int q) {
+    const uint64_t low = (uint64_t{1} << q) - 1;
+    return ((p & ~low) << 1) | (p & low);
+}
+
+}  // namespace detail
+
+class StateVector {
+  public:
+    static constexpr int kMaxQubits = 30;
+    static constexpr uint64_t kParallelAmplitudes = uint64_t{1} << 16;
+
+    // |0...0> on the given number of qubits (clamped to [1, kMaxQubits]).
+    void Reset(int qubits) {
+        qubits_ = std::clamp(qubits, 1, kMaxQubits);
+        re_.assign(static_cast<size_t>(size()), 0.0f);
+        im_.assign(static_cast<size_t>(size()), 0.0f);
+        re_[0] = 1.0f;
+    }
+
+    int qubits() const { return qubits_; }
+    uint64_t size() const { return uint64_t{1} << qubits_; }
+
+    Amplitude amplitude(uint64_t basis) const { return {re_[basis], im_[basis]}; }
+    float Probability(uint64_t basis) const { return re_[basis] * re_[basis] + im_[basis] * im_[basis]; }
+
+    double Norm() const {
+        double sum = 0.0;
+        for (size_t i = 0; i < re_.size(); ++i) sum += static_cast<double>(re_[i]) * re_[i] + static_cast<double>(im_[i]) * im_[i];
+        return sum;
+    }
+
+    void Apply(int q, const Gate1& g) {
+#if ASTRO_SOA_AVX2
+        if (q < 3 && qubits_ >= 3) {
+            ApplyInLanes(&q, 1, g.data());
+            return;
+        }
+#endif
+        const uint64_t stride = uint64_t{1} << q;
+        const bool real = detail::IsReal(g);
+        ForRuns(size() / 2, q, [&](uint64_t p, uint64_t n) {
+            const uint64_t i = detail::InsertZeroBit(p, q);
+            float* const re[2] = {&re_[i], &re_[i + stride]};
+            float* const im[2] = {&im_[i], &im_[i + stride]};
+            if (real) {
+                detail::ApplyRun<2, true>(re, im, n, g.data());
+            } else {
+                detail::ApplyRun<2, false>(re, im, n, g.data());
+            }
+        });
+    }
+
+    void Apply(int qa, int qb, const Gate2& g) {
+        const int lo = std::min(qa, qb), hi = std::max(qa, qb);
+#if ASTRO_SOA_AVX2
+        if (lo < 3 && qubits_ >= 3) {
+            const int pos[2] = {qa, qb};
+            ApplyInLanes(pos, 2, g.data());
+            return;
+        }
+#endif
+        const uint64_t a = uint64_t{1} << qa, b = uint64_t{1} << qb;
+        const bool real = detail::IsReal(g);
+        ForRuns(size() / 4, lo, [&](uint64_t p, uint64_t n) {
+            const uint64_t i = detail::InsertZeroBit(detail::InsertZeroBit(p, lo), hi);
+            float* const re[4] = {&re_[i], &re_[i + a], &re_[i + b], &re_[i + a + b]};
+            float* const im[4] = {&im_[i], &im_[i + a], &im_[i + b], &im_[i + a + b]};
+            if (real) {
+                detail::ApplyRun<4, true>(re, im, n, g.data());
+            } else {
+                detail::ApplyRun<4, false>(re, im, n, g.data());
+            }
+        });
+    }
+
+    // Diagonal oracle term: multiplies one basis amplitude by -1.
+    void PhaseFlip(uint64_t basis) {
+        re_[basis] = -re_[basis];
+        im_[basis] = -im_[basis];
+    }
+
+  private:
+#if ASTRO_SOA_AVX2
+    void ApplyInLanes(const int* pos, int bits, const Amplitude* m) {
+        const detail::LaneGate gate(pos, bits, m);
+        if (gate.streams == 1) {
+            ForRuns(size() / 8, qubits_, [&](uint64_t p, uint64_t n) { gate.Apply(&re_[8 * p], &im_[8 * p], n); });
+            return;
+        }
+        int high = pos[0];
+        for (int j = 1; j < bits; ++j) high = std::max(high, pos[j]);
+        ForRuns(size() / 16, high - 3, [&](uint64_t p, uint64_t n) {
+            const uint64_t i = detail::InsertZeroBit(p, high - 3) * 8;
+            gate.Apply(&re_[i], &im_[i], n);
+        });
+    }
+#endif
+
+    // Calls run(p, n) over [0, count) in runs that stay inside one contiguous block of
+    // 2^lowBit indices, so each run maps to n consecutive amplitudes per stream.
+    template <typename Run>
+    void ForRuns(uint64_t count, int lowBit, Run&& run) const {
+        const uint64_t block = uint64_t{1} << lowBit;
+        const auto range = [&](uint64_t begin, uint64_t end) {
+            for (uint64_t p = begin; p < end;) {
+                const uint64_t n = std::min(end - p, block - (p & (block - 1)));
+                run(p, n);
+                p += n;
+            }
+        };
+        if (size() >= kParallelAmplitudes) {
+            // Chunks are whole multiples of 8 pairs so SIMD runs are not split.
+            const int chunks = static_cast<int>(std::min<uint64_t>(count / 4096, 256));
+            const uint64_t chunk = ((count + chunks - 1) / chunks + 7) & ~uint64_t{7};
+            using Range = decltype(range);
+            struct Pass {
+                const Range& body;
+                uint64_t count, chunk;
+            } pass{range, count, chunk};
+            // One captured reference keeps the std::function in its small buffer.
+            astro_parallel::SharedPool().Run(chunks, [&pass](int c) {
+                const uint64_t begin = static_cast<uint64_t>(c) * pass.chunk;
+                pass.body(std::min(begin, pass.count), std::min(begin + pass.chunk, pass.count));
+            });
+        } else {
+            range(0, count);
+        }
+    }
+
+    int qubits_ = 0;
+    astro_soa::AlignedFloats re_, im_;
+};
+
+// Gate list with a fusion pass. Apply order is the order of the Add calls.
+class Circuit {
+  public:
+    enum class Kind { kGate1, kGate2, kPhaseFlip };
+
+    struct Op {
+        Kind kind;
+        int qa = 0;
+        int qb = 0;
+        Gate2 m{};  // first four entries hold a Gate1
+        uint64_t basis = 0;
+    };
+
+    void Add(int q, const Gate1& g) {
+        Op op{Kind::kGate1, q, q, {}, 0};
+        std::copy(g.begin(), g.end(), op.m.begin());
+        ops_.push_back(op);
+    }
+
+    void Add(int qa, int qb, const Gate2& g) { ops_.push_back({Kind::kGate2, qa, qb, g, 0}); }
+
+    void AddPhaseFlip(uint64_t basis) { ops_.push_back({Kind::kPhaseFlip, 0, 0, {}, basis}); }
+
+    // Same gate on every qubit in [0, qubits).
+    void AddLayer(int qubits, const Gate1& g) {
+        for (int q = 0; q < qubits; ++q) Add(q, g);
+    }
+
+    const std::vector<Op>& ops() const { return ops_; }
+
+    // Full passes over the state vector one Run() makes; phase flips touch one amplitude.
+    int Passes() const {
+        return static_cast<int>(std::count_if(ops_.begin(), ops_.end(), [](const Op& op) { return op.kind != Kind::kPhaseFlip; }));
+    }
+
+    void Run(StateVector* state) const {
+        for (const Op& op : ops_) {
+            switch (op.kind) {
+            case Kind::kGate1:
+                state->Apply(op.qa, Gate1{op.m[0], op.m[1], op.m[2], op.m[3]});
+                break;
+            case Kind::kGate2:
+                state->Apply(op.qa, op.qb, op.m);
+                break;
+            case Kind::kPhaseFlip:
+                state->PhaseFlip(op.basis);
+                break;
+            }
+        }
+    }
+
+    // Equivalent circuit with fewer passes. Single-qubit gates on the same qubit are
+    // multiplied together until something else touches that qubit; they are then folded
+    // into the two-qubit gate that does, or, in front of a phase flip and at the end,
+    // paired up into Kron products. Back-to-back two-qubit gates on the same pair merge.
+    Circuit Fused() const {
+        Circuit out;
+        std::array<Gate1, StateVector::kMaxQubits> pending{};
+        std::array<bool, StateVector::kMaxQubits> has{};
+        const auto take = [&](int q) {
+            const Gate1 g = has[static_cast<size_t>(q)] ? pending[static_cast<size_t>(q)] : Identity1();
+            has[static_cast<size_t>(q)] = false;
+            return g;
+        };
+        const auto flushAll = [&]() {
+            int waiting = -1;
+            for (int q = 0; q < StateVector::kMaxQubits; ++q) {
+                if (!has[static_cast<size_t>(q)]) continue;
+                if (waiting < 0) {
+                    waiting = q;
+                    continue;
+                }
+                const Gate1 ga = take(waiting);
+                out.Add(waiting, q, Kron(ga, take(q)));
+                waiting = -1;
+            }
+            if (waiting >= 0) out.Add(waiting, take(waiting));
+        };
+
+        for (const Op& op : ops_) {
+            switch (op.kind) {
+            case Kind::kGate1: {
+                const size_t q = static_cast<size_t>(op.qa);
+                const Gate1 g{op.m[0], op.m[1], op.m[2], op.m[3]};
+                pending[q] = has[q] ? Multiply(g, pending[q]) : g;
+                has[q] = true;
+                break;
+            }
+            case Kind::kGate2: {
+                const Gate1 ga = take(op.qa);
+                const Gate2 g = Multiply(op.m, Kron(ga, take(op.qb)));
+                if (!out.ops_.empty() && out.ops_.back().kind == Kind::kGate2 && out.ops_.back().qa == op.qa &&
+                    out.ops_.back().qb == op.qb) {
+                    out.ops_.back().m = Multiply(g, out.ops_.back().m);
+                } else {
+                    out.Add(op.qa, op.qb, g);
+                }
+                break;
+            }
+            case Kind::kPhaseFlip:
+                flushAll();
+                out.ops_.push_back(op);
+                break;
+            }
+        }
+        flushAll();
+        return out;
+    }
+
+  private:
+    std::vector<Op> ops_;
+};
+
+// One Grover iteration: the oracle flips the marked states, then the diffusion
+// H^n (2|0><0| - I) H^n, here with the global phase of -1 dropped so the reflection
+// is a single phase flip of |0>.
+inline Circuit GroverIteration(int qubits, const std::vector<uint64_t>& marked) {
+    Circuit c;
+    for (uint64_t m : marked) c.AddPhaseFlip(m);
+    c.AddLayer(qubits, Hadamard());
+    c.AddPhaseFlip(0);
+    c.AddLayer(qubits, Hadamard());
+    return c;
+}
+
+}  // namespace astro_quantum
@@ -0,0 +1,741 @@
+#pragma once
+
+#include "particle_soa.h"
+#include "philox.h"
+#include "star_catalog.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Stellar evolution tracks on a (mass, [Fe/H]) grid, packed into one mappable file and
+// interpolated for whole clusters at once.
+//
+// Each track is a star's path sampled at equivalent evolutionary points (EEPs, as in
+// MIST): the k-th EEP of every track marks the same stage of evolution, so tracks of
+// neighbouring masses and metallicities can be blended point by point. PackTracks()
+// writes a TrackGrid as
+//
+//   TrackHeader      64 bytes, magic "ASTROTRK"
+//   float[]          log10 masses, then [Fe/H] values, both ascending
+//   float[]          page-aligned; for each [Fe/H], for each mass, kTrackFields rows
+//                    of eepCount values (log age, log Teff, log L, phase)
+//
+// and TrackTable maps it read-only. A star of mass m and metallicity z draws on the four
+// tracks around it with bilinear weights (a TrackStencil). Its log age is monotonic along
+// the EEPs, so at a given age it sits between the two EEPs that bracket it, and its log
+// Teff and log L are interpolated there. ClusterEvolver keeps the stencils of a whole
+// cluster in SoA arrays with one EEP cursor per star. Clusters age smoothly, so a cursor
+// usually still brackets the new age or is one EEP behind it; only a jump in age sends a
+// star back to bisection. The blends are AVX2 gathers over the mapped table where
+// available.
+//
+// Tracks come from MIST .eep files (ReadMistDirectory) or from SyntheticTrackGrid(), a
+// stand-in built from textbook scaling laws that follows the same EEP layout.
+
+namespace astro_stellar {
+
+constexpr uint32_t kTrackVersion = 1;
+constexpr uint64_t kTrackBlockAlign = 4096;
+constexpr int kTrackFields = 4;
+enum TrackField : int { kFieldLogAge = 0, kFieldLogTeff = 1, kFieldLogL = 2, kFieldPhase = 3 };
+
+// MIST phase codes, plus kPhaseRemnant for EEPs past the end of a track.
+constexpr int kPhasePreMainSequence = -1;
+constexpr int kPhaseMainSequence = 0;
+constexpr int kPhaseRedGiant = 2;
+constexpr int kPhaseCoreHelium = 3;
+constexpr int kPhaseEarlyAgb = 4;
+constexpr int kPhaseThermalPulseAgb = 5;
+constexpr int kPhasePostAgb = 6;
+constexpr int kPhaseWolfRayet = 9;
+constexpr int kPhaseRemnant = 10;
+
+struct TrackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t massCount;
+    uint32_t fehCount;
+    uint32_t eepCount;
+    uint64_t gridOffset;
+    uint64_t dataOffset;
+    float minLogMass;
+    float maxLogMass;
+    float minFeh;
+    float maxFeh;
+    uint32_t reserved[2];
+};
+
+static_assert(sizeof(TrackHeader) == 64, "track header layout");
+
+struct TrackRow {
+    float logAge;  // years
+    float logTeff; // kelvin
+    float logL;    // solar luminosities
+    float phase;
+};
+
+// A grid in memory, laid out exactly as the file's data block.
+struct TrackGrid {
+    std::vector<float> logMass;
+    std::vector<float> feh;
+    int eepCount = 0;
+    std::vector<float> data;
+
+    float* Track(size_t fehIndex, size_t massIndex) {
+        return data.data() + (fehIndex * logMass.size() + massIndex) * kTrackFields * static_cast<size_t>(eepCount);
+    }
+};
+
+// Copies `rows` into the grid's track at (fehIndex, massIndex). Ages are forced strictly
+// increasing; EEPs past the end of a shorter track are marked kPhaseRemnant at the last
+// position, a few years apart, so the star ends when the track does.
+inline void StoreTrack(TrackGrid* grid, size_t fehIndex, size_t massIndex, const std::vector<TrackRow>& rows) {
+    float* track = grid->Track(fehIndex, massIndex);
+    const int eeps = grid->eepCount;
+    TrackRow last{5.0f, 3.5f, 0.0f, static_cast<float>(kPhaseRemnant)};
+    float previousAge = -1.0e30f;
+    for (int e = 0; e < eeps; ++e) {
+        TrackRow row = last;
+        if (e < static_cast<int>(rows.size())) {
+            row = rows[static_cast<size_t>(e)];
+        } else {
+            row.phase = static_cast<float>(kPhaseRemnant);
+        }
+        row.logAge = std::max(row.logAge, previousAge + 1.0e-6f);
+        previousAge = row.logAge;
+        last = row;
+        track[kFieldLogAge * eeps + e] = row.logAge;
+        track[kFieldLogTeff * eeps + e] = row.logTeff;
+        track[kFieldLogL * eeps + e] = row.logL;
+        track[kFieldPhase * eeps + e] = row.phase;
+    }
+}
+
+// EEPs per phase of a synthetic track: pre-main sequence, main sequence, subgiant branch,
+// red giant branch, core helium burning, AGB, post-AGB and white-dwarf cooling.
+constexpr std::array<int, 7> kSyntheticSegments = {40, 80, 20, 60, 40, 30, 50};
+
+// A track from scaling laws: piecewise ZAMS mass-luminosity and mass-radius fits,
+// t_MS ~ 10 Gyr M / L, a Hayashi-then-Henyey contraction, a red giant branch that
+// climbs to the helium flash below 2.2 Msun, a red clump that turns blue at low
+// metallicity, blue loops for intermediate masses, red supergiants that end in a
+// supernova above 8 Msun, and Mestel cooling for the white dwarfs. Only the shapes and
+// time scales are meant to be right.
+inline void SyntheticTrack(float mass, float feh, std::vector<TrackRow>* rows) {
+    rows->clear();
+    const float lm = std::log10(mass);
+    const auto teff = [](float logL, float logR) { return 3.7613f + 0.25f * (logL - 2.0f * logR); };
+    const bool low = mass < 2.2f, massive = mass >= 8.0f;
+
+    float logL0 = mass < 0.43f ? std::log10(0.23f) + 2.3f * lm
+                  : mass < 2.0f ? 4.0f * lm
+                  : mass < 20.0f ? std::log10(1.4f) + 3.5f * lm
+                                 : std::log10(1.4f) + 3.5f * std::log10(20.0f) + 1.8f * (lm - std::log10(20.0f));
+    logL0 -= 0.15f * feh;  // metal-poor stars are brighter and bluer at fixed mass
+    const float logR0 = (mass < 1.0f ? 0.8f * lm : 0.57f * lm) + 0.05f * feh;
+    const float logT0 = teff(logL0, logR0);
+    const float tMs = 1.0e10f * mass / std::pow(10.0f, logL0) + 2.5e6f;
+    const float tPms = std::max(3.0e5f, 4.0e7f * std::pow(mass, mass < 1.0f ? -1.5f : -2.5f));
+
+    double age = 1.0e5;
+    float logT = 0.0f, logL = 0.0f;
+    const auto push = [&](float phase) { rows->push_back({static_cast<float>(std::log10(age)), logT, logL, phase}); };
+    // Runs `count` EEPs after the current one; `at(u)` sets logT/logL and returns the
+    // age fraction of the segment's duration reached at u in (0, 1].
+    const auto segment = [&](int count, float duration, float phase, auto&& at) {
+        const double start = age;
+        for (int k = 1; k <= count; ++k) {
+            const float u = static_cast<float>(k) / count;
+            age = start + duration * at(u);
+            push(phase);
+        }
+    };
+
+    // Pre-main sequence, log-spaced in age: down the Hayashi track, then (above 0.5 Msun)
+    // across to the ZAMS along the Henyey track.
+    const float logTh = 3.63f + 0.12f * lm;
+    const float logLs = logL0 + 1.2f - 0.5f * std::max(0.0f, lm);
+    const float hayashi = mass < 0.5f ? 1.0f : 0.6f;
+    const float logLh = mass < 0.5f ? logL0 : logL0 - 0.3f;
+    const int pms = kSyntheticSegments[0];
+    for (int k = 0; k < pms; ++k) {
+        const float u = static_cast<float>(k) / (pms - 1);
+        age = std::pow(10.0, 5.0 + u * (std::log10(tPms) - 5.0));
+        if (u <= hayashi) {
+            const float v = u / hayashi;
+            logT = mass < 0.5f ? logTh + (logT0 - logTh) * v : logTh;
+            logL = logLs + (logLh - logLs) * v;
+        } else {
+            const float v = (u - hayashi) / (1.0f - hayashi);
+            logT = logTh + (logT0 - logTh) * v;
+            logL = logLh + (logL0 - logLh) * v;
+        }
+        push(static_cast<float>(kPhasePreMainSequence));
+    }
+
+    // Main sequence: brightening and swelling while core hydrogen burns.
+    const float dL = std::clamp(0.25f + 0.12f * lm, 0.12f, 0.45f);
+    const float dR = std::clamp(0.22f + 0.18f * lm, 0.03f, 0.55f);
+    segment(kSyntheticSegments[1], tMs, static_cast<float>(kPhaseMainSequence), [&](float u) {
+        logL = logL0 + dL * u;
+        logT = teff(logL, logR0 + dR * std::pow(u, 1.5f));
+        return u;
+    });
+
+    // Subgiant branch (the Hertzsprung gap above 2.2 Msun) to the base of the giant branch.
+    const float logT1 = logT, logL1 = logL;
+    const float logTBase = std::clamp(3.70f - 0.06f * lm - 0.04f * feh, 3.56f, 3.72f);
+    const float logLBase = logL1 + (low ? 0.05f : 0.1f);
+    segment(kSyntheticSegments[2], (low ? 0.08f : massive ? 0.01f : 0.02f) * tMs, static_cast<float>(kPhaseRedGiant),
+            [&](float u) {
+                logT = logT1 + (logTBase - logT1) * u;
+                logL = logL1 + (logLBase - logL1) * u;
+                return u;
+            });
+
+    // Red giant branch: most of the time is spent near its base.
+    const float logLTip = low ? 3.35f - 0.05f * feh : logLBase + (massive ? 0.15f : 0.5f);
+    const float logTTip = low ? std::clamp(3.58f - 0.05f * feh, 3.52f, 3.66f) : massive ? 3.56f : 3.60f;
+    segment(kSyntheticSegments[3], (low ? 0.06f : massive ? 0.01f : 0.02f) * tMs, static_cast<float>(kPhaseRedGiant),
+            [&](float u) {
+                logT = logTBase + (logTTip - logTBase) * u;
+                logL = logLBase + (logLTip - logLBase) * u;
+                return 1.0f - std::pow(1.0f - u, 4.0f);
+            });
+
+    // Core helium burning: the horizontal branch / red clump after the flash, a blue loop
+    // for intermediate masses, a red supergiant that keeps brightening above 8 Msun.
+    const float logTHb = std::clamp(3.68f - 0.12f * feh, 3.66f, 3.95f);
+    const float logLHb = 1.65f - 0.1f * feh;
+    const float logTLoop = std::clamp(3.65f + 0.2f * (lm - 0.35f), 3.65f, 4.1f);
+    const float tHe = low ? 1.1e8f : (massive ? 0.1f : 0.2f) * tMs;
+    segment(kSyntheticSegments[4], tHe, static_cast<float>(kPhaseCoreHelium), [&](float u) {
+        if (low) {
+            logT = logTHb - 0.05f * u;
+            logL = logLHb + 0.25f * u;
+        } else if (massive) {
+            logT = logTTip;
+            logL = logLTip + 0.1f * u;
+        } else {
+            logT = logTTip + (logTLoop - logTTip) * std::sin(3.14159265f * u);
+            logL = logLTip - 0.15f;
+        }
+        return u;
+    });
+
+    // AGB up to the superwind, or the last burning stages of a massive star.
+    const float logT2 = logT, logL2 = logL;
+    const float logLAgb = std::clamp(3.4f + 0.6f * lm, 3.3f, 4.6f);
+    const int agb = kSyntheticSegments[5];
+    segment(agb, massive ? 0.01f * tMs : 0.15f * tHe, static_cast<float>(kPhaseEarlyAgb), [&](float u) {
+        logT = massive ? logT2 : logT2 + (3.50f - logT2) * u;
+        logL = massive ? logL2 + 0.05f * u : logL2 + (logLAgb - logL2) * u;
+        return u;
+    });
+    if (massive) return;  // core collapse; StoreTrack pads the rest as a remnant
+    for (int k = agb * 2 / 3; k < agb; ++k) (*rows)[rows->size() - static_cast<size_t>(agb - k)].phase = static_cast<float>(kPhaseThermalPulseAgb);
+
+    // Post-AGB: across to ~125 kK at constant luminosity in a few tens of kyr, then white
+    // dwarf cooling, L ~ t^-1.4 on a 0.012 Rsun radius.
+    const int post = kSyntheticSegments[6], crossing = 10;
+    const float logT3 = logT, logL3 = logL;
+    segment(crossing, 3.0e4f, static_cast<float>(kPhasePostAgb), [&](float u) {
+        logT = logT3 + (5.1f - logT3) * u;
+        logL = logL3;
+        return u;
+    });
+    const double tAgbEnd = age;
+    for (int k = 1; k <= post - crossing; ++k) {
+        const float logCool = 5.0f + 5.0f * static_cast<float>(k) / (post - crossing);
+        age = tAgbEnd + std::pow(10.0, logCool);
+        logL = std::clamp(-1.4f * (logCool - 8.0f) - 2.5f, -4.6f, logL3);
+        logT = std::min(5.1f, teff(logL, std::log10(0.012f)));
+        push(static_cast<float>(kPhasePostAgb));
+    }
+}
+
+// `massCount` log-spaced masses over [minMass, maxMass] at every [Fe/H] in `fehValues`.
+inline TrackGrid SyntheticTrackGrid(int massCount = 96, float minMass = 0.1f, float maxMass = 40.0f,
+                                    const std::vector<float>& fehValues = {-2.0f, -1.75f, -1.5f, -1.25f, -1.0f, -0.75f, -0.5f,
+                                                                           -0.25f, 0.0f, 0.25f, 0.5f}) {
+    TrackGrid grid;
+    massCount = std::max(2, massCount);
+    for (int i = 0; i < massCount; ++i) {
+        grid.logMass.push_back(std::log10(minMass) + (std::log10(maxMass) - std::log10(minMass)) * i / (massCount - 1));
+    }
+    grid.feh = fehValues;
+    std::sort(grid.feh.begin(), grid.feh.end());
+    grid.eepCount = 0;
+    for (int n : kSyntheticSegments) grid.eepCount += n;
+    grid.data.assign(grid.feh.size() * grid.logMass.size() * kTrackFields * static_cast<size_t>(grid.eepCount), 0.0f);
+    std::vector<TrackRow> rows;
+    for (size_t f = 0; f < grid.feh.size(); ++f) {
+        for (size_t m = 0; m < grid.logMass.size(); ++m) {
+            SyntheticTrack(std::pow(10.0f, grid.logMass[m]), grid.feh[f], &rows);
+            StoreTrack(&grid, f, m, rows);
+        }
+    }
+    return grid;
+}
+
+// Reads one MIST .eep file: initial mass and [Fe/H] from the comment header, and
+// star_age, log_Teff, log_L and phase from the data rows (row k is EEP k + 1).
+inline bool ReadMistTrack(const std::string& path, float* mass, float* feh, std::vector<TrackRow>* rows, std::string* error) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        *error = "cannot open " + path;
+        return false;
+    }
+    const auto tokens = [](const std::string& line) {
+        std::vector<std::string> out;
+        size_t i = 0;
+        while (i < line.size()) {
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+            const size_t start = i;
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t') ++i;
+            if (i > start) out.push_back(line.substr(start, i - start));
+        }
+        return out;
+    };
+    rows->clear();
+    *mass = *feh = std::nanf("");
+    int col[4] = {-1, -1, -1, -1};  // star_age log_Teff log_L phase
+    std::string line, pendingKey;
+    int pendingIndex = -1;
+    std::vector<std::string> fields;
+    for (int c = 0; c != EOF;) {
+        line.clear();
+        while ((c = std::fgetc(file)) != EOF && c != '\n') {
+            if (c != '\r') line.push_back(static_cast<char>(c));
+        }
+        fields = tokens(line);
+        if (fields.empty()) continue;
+        if (fields[0] == "#") {
+            if (pendingIndex >= 0 && pendingIndex < static_cast<int>(fields.size())) {
+                const float value = std::strtof(fields[static_cast<size_t>(pendingIndex)].c_str(), nullptr);
+                (pendingKey == "[Fe/H]" ? *feh : *mass) = value;
+            }
+            pendingIndex = -1;
+            for (size_t i = 0; i < fields.size(); ++i) {
+                if (fields[i] == "[Fe/H]" || fields[i] == "initial_mass") {
+                    pendingKey = fields[i];
+                    pendingIndex = static_cast<int>(i);
+                }
+                const char* names[4] = {"star_age", "log_Teff", "log_L", "phase"};
+                for (int k = 0; k < 4; ++k) {
+                    if (fields[i] == names[k]) col[k] = static_cast<int>(i) - 1;  // data rows have no leading '#'
+                }
+            }
+            continue;
+        }
+        if (col[0] < 0 || col[1] < 0 || col[2] < 0) continue;
+        const int needed = std::max({col[0], col[1], col[2], col[3]});
+        if (static_cast<int>(fields.size()) <= needed) continue;
+        const auto at = [&](int k) { return std::strtod(fields[static_cast<size_t>(col[k])].c_str(), nullptr); };
+        const double starAge = at(0);
+        rows->push_back({static_cast<float>(std::log10(std::max(starAge, 1.0))), static_cast<float>(at(1)), static_cast<float>(at(2)),
+                         col[3] >= 0 ? static_cast<float>(at(3)) : static_cast<float>(kPhaseMainSequence)});
+    }
+    std::fclose(file);
+    if (col[0] < 0 || col[1] < 0 || col[2] < 0) {
+        *error = path + ": no star_age, log_Teff and log_L columns";
+        return false;
+    }
+    if (!(std::isfinite(*mass) && std::isfinite(*feh)) || rows->empty()) {
+        *error = path + ": missing initial_mass, [Fe/H] or data rows";
+        return false;
+    }
+    return true;
+}
+
+// Every *.eep file in `directory` (one MIST track each). The files must cover the full
+// cross product of their masses and metallicities. Tracks shorter than the longest are
+// padded as remnants.
+inline bool ReadMistDirectory(const std::string& directory, TrackGrid* grid, std::string* error) {
+    std::error_code ec;
+    std::vector<std::string> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".eep") paths.push_back(entry.path().string());
+    }
+    if (ec || paths.empty()) {
+        *error = "no .eep files in " + directory;
+        return false;
+    }
+    // Keys are rounded so 0.1 vs 0.10000001 land together: log mass to 1e-4, [Fe/H] to 0.01.
+    std::map<std::pair<long, long>, std::vector<TrackRow>> tracks;
+    std::map<long, float> masses, fehs;
+    std::vector<TrackRow> rows;
+    int eeps = 0;
+    for (const std::string& path : paths) {
+        float mass = 0.0f, feh = 0.0f;
+        if (!ReadMistTrack(path, &mass, &feh, &rows, error)) return false;
+        const long mKey = std::lround(std::log10(mass) * 1.0e4f), fKey = std::lround(feh * 100.0f);
+        masses[mKey] = std::log10(mass);
+        fehs[fKey] = feh;
+        eeps = std::max(eeps, static_cast<int>(rows.size()));
+        tracks[{fKey, mKey}] = rows;
+    }
+    if (masses.size() < 2 || tracks.size() != masses.size() * fehs.size()) {
+        *error = directory + ": tracks do not form a full mass x [Fe/H] grid (need >= 2 masses)";
+        return false;
+    }
+    grid->logMass.clear();
+    grid->feh.clear();
+    for (const auto& m : masses) grid->logMass.push_back(m.second);
+    for (const auto& f : fehs) grid->feh.push_back(f.second);
+    grid->eepCount = eeps;
+    grid->data.assign(grid->feh.size() * grid->logMass.size() * kTrackFields * static_cast<size_t>(eeps), 0.0f);
+    size_t f = 0;
+    for (const auto& fKey : fehs) {
+        size_t m = 0;
+        for (const auto& mKey : masses) StoreTrack(grid, f, m++, tracks[{fKey.first, mKey.first}]);
+        ++f;
+    }
+    return true;
+}
+
+inline bool PackTracks(const TrackGrid& grid, const std::string& path, std::string* error) {
+    if (grid.logMass.size() < 2 || grid.feh.empty() || grid.eepCount < 2 ||
+        grid.data.size() != grid.logMass.size() * grid.feh.size() * kTrackFields * static_cast<size_t>(grid.eepCount)) {
+        *error = "track grid is empty or inconsistent";
+        return false;
+    }
+    TrackHeader header{};
+    std::memcpy(header.magic, "ASTROTRK", 8);
+    header.version = kTrackVersion;
+    header.massCount = static_cast<uint32_t>(grid.logMass.size());
+    header.fehCount = static_cast<uint32_t>(grid.feh.size());
+    header.eepCount = static_cast<uint32_t>(grid.eepCount);
+    header.gridOffset = sizeof(TrackHeader);
+    const uint64_t gridBytes = (grid.logMass.size() + grid.feh.size()) * sizeof(float);
+    header.dataOffset = (header.gridOffset + gridBytes + kTrackBlockAlign - 1) / kTrackBlockAlign * kTrackBlockAlign;
+    header.minLogMass = grid.logMass.front();
+    header.maxLogMass = grid.logMass.back();
+    header.minFeh = grid.feh.front();
+    header.maxFeh = grid.feh.back();
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        *error = "cannot create " + path;
+        return false;
+    }
+    const std::vector<char> pad(header.dataOffset - header.gridOffset - gridBytes, 0);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(grid.logMass.data(), sizeof(float), grid.logMass.size(), file) == grid.logMass.size() &&
+              std::fwrite(grid.feh.data(), sizeof(float), grid.feh.size(), file) == grid.feh.size() &&
+              (pad.empty() || std::fwrite(pad.data(), 1, pad.size(), file) == pad.size()) &&
+              std::fwrite(grid.data.data(), sizeof(float), grid.data.size(), file) == grid.data.size();
+    if (std::fclose(file) != 0 || !ok) {
+        *error = "write failed: " + path;
+        return false;
+    }
+    return true;
+}
+
+// The four tracks around one star: float offsets of each track's first row in the data
+// block, bilinear weights summing to one, and the track with the largest weight (whose
+// phase the star reports).
+struct TrackStencil {
+    std::array<int32_t, 4> offset;
+    std::array<float, 4> weight;
+    int32_t dominant;
+};
+
+class TrackTable {
+  public:
+    bool Open(const std::string& path, std::string* error) {
+        if (!file_.Open(path, error)) return false;
+        const auto fail = [&](const char* why) {
+            *error = path + ": " + why;
+            file_.Close();
+            return false;
+        };
+        if (file_.size() < sizeof(TrackHeader)) return fail("not a track table");
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, "ASTROTRK", 8) != 0) return fail("not a track table");
+        if (header_.version != kTrackVersion) return fail("unsupported track table version");
+        const uint64_t values = static_cast<uint64_t>(header_.massCount) * header_.fehCount * kTrackFields * header_.eepCount;
+        if (header_.massCount < 2 || header_.fehCount < 1 || header_.eepCount < 2 || values >= (1ull << 31) ||
+            header_.gridOffset + (header_.massCount + header_.fehCount) * sizeof(float) > header_.dataOffset ||
+            header_.dataOffset % alignof(float) != 0 || header_.dataOffset + values * sizeof(float) > file_.size()) {
+            return fail("truncated or corrupt track table");
+        }
+        logMass_ = reinterpret_cast<const float*>(file_.data() + header_.gridOffset);
+        feh_ = logMass_ + header_.massCount;
+        data_ = reinterpret_cast<const float*>(file_.data() + header_.dataOffset);
+        return true;
+    }
+
+    bool open() const { return data_ != nullptr && file_.data() != nullptr; }
+    int massCount() const { return static_cast<int>(header_.massCount); }
+    int fehCount() const { return static_cast<int>(header_.fehCount); }
+    int eepCount() const { return static_cast<int>(header_.eepCount); }
+    float minMass() const { return std::pow(10.0f, header_.minLogMass); }
+    float maxMass() const { return std::pow(10.0f, header_.maxLogMass); }
+    float minFeh() const { return header_.minFeh; }
+    float maxFeh() const { return header_.maxFeh; }
+    size_t bytes() const { return file_.size(); }
+    const float* data() const { return data_; }
+
+    TrackStencil Stencil(float mass, float feh) const {
+        const auto cell = [](const float* grid, int n, float v, int* i0, int* i1, float* t) {
+            const int hi = static_cast<int>(std::upper_bound(grid, grid + n, v) - grid);
+            *i0 = std::clamp(hi - 1, 0, n - 1);
+            *i1 = std::min(*i0 + 1, n - 1);
+            *t = *i1 > *i0 ? std::clamp((v - grid[*i0]) / (grid[*i1] - grid[*i0]), 0.0f, 1.0f) : 0.0f;
+        };
+        int m0, m1, f0, f1;
+        float tm, tf;
+        cell(logMass_, massCount(), std::log10(std::max(mass, 1.0e-3f)), &m0, &m1, &tm);
+        cell(feh_, fehCount(), feh, &f0, &f1, &tf);
+        const auto base = [&](int f, int m) { return static_cast<int32_t>((static_cast<int64_t>(f) * massCount() + m) * kTrackFields * eepCount()); };
+        TrackStencil s;
+        s.offset = {base(f0, m0), base(f0, m1), base(f1, m0), base(f1, m1)};
+        s.weight = {(1.0f - tm) * (1.0f - tf), tm * (1.0f - tf), (1.0f - tm) * tf, tm * tf};
+        s.dominant = s.offset[static_cast<size_t>(std::max_element(s.weight.begin(), s.weight.end()) - s.weight.begin())];
+        return s;
+    }
+
+    float Blend(const TrackStencil& s, int field, int eep) const {
+        const int32_t at = field * eepCount() + eep;
+        return s.weight[0] * data_[s.offset[0] + at] + s.weight[1] * data_[s.offset[1] + at] +
+               s.weight[2] * data_[s.offset[2] + at] + s.weight[3] * data_[s.offset[3] + at];
+    }
+
+    // Largest EEP in [0, eepCount - 2] whose blended age is <= logAge (0 if none).
+    int Locate(const TrackStencil& s, float logAge) const {
+        int lo = 0, hi = eepCount() - 2;
+        if (Blend(s, kFieldLogAge, lo) > logAge) return lo;
+        while (lo < hi) {
+            const int mid = (lo + hi + 1) / 2;
+            if (Blend(s, kFieldLogAge, mid) <= logAge) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        return lo;
+    }
+
+    // Cursor for logAge given a stale cursor c whose EEP ages were [a0, a1): the next EEP
+    // if that brackets it, else a fresh bisection (*bisected is set then).
+    int Advance(const TrackStencil& s, float logAge, int c, float a1, bool* bisected) const {
+        const int last = eepCount() - 2;
+        if (logAge >= a1 && c < last && (c + 1 == last || Blend(s, kFieldLogAge, c + 2) > logAge)) return c + 1;
+        *bisected = true;
+        return Locate(s, logAge);
+    }
+
+    // The star at logAge; *cursor is a hint on entry and the bracketing EEP on return.
+    // *bisected says whether the hint was too far off and had to be re-bisected.
+    TrackRow Sample(const TrackStencil& s, float logAge, int* cursor, bool* bisected = nullptr) const {
+        const int last = eepCount() - 2;
+        int c = std::clamp(*cursor, 0, last);
+        float a0 = Blend(s, kFieldLogAge, c), a1 = Blend(s, kFieldLogAge, c + 1);
+        bool ignored = false;
+        if (bisected == nullptr) bisected = &ignored;
+        *bisected = false;
+        if (!((a0 <= logAge || c == 0) && (logAge < a1 || c == last))) {
+            c = Advance(s, logAge, c, a1, bisected);
+            a0 = Blend(s, kFieldLogAge, c);
+            a1 = Blend(s, kFieldLogAge, c + 1);
+        }
+        *cursor = c;
+        const float f = std::clamp((logAge - a0) / (a1 - a0), 0.0f, 1.0f);
+        TrackRow row;
+        row.logAge = logAge;
+        row.logTeff = Blend(s, kFieldLogTeff, c) + f * (Blend(s, kFieldLogTeff, c + 1) - Blend(s, kFieldLogTeff, c));
+        row.logL = Blend(s, kFieldLogL, c) + f * (Blend(s, kFieldLogL, c + 1) - Blend(s, kFieldLogL, c));
+        row.phase = logAge >= a1 && c == last ? static_cast<float>(kPhaseRemnant)
+                                               : data_[s.dominant + kFieldPhase * eepCount() + (f < 0.5f ? c : c + 1)];
+        return row;
+    }
+
+    // The whole interpolated track of one star, EEP by EEP.
+    void Track(float mass, float feh, std::vector<TrackRow>* rows) const {
+        const TrackStencil s = Stencil(mass, feh);
+        rows->resize(static_cast<size_t>(eepCount()));
+        for (int e = 0; e < eepCount(); ++e) {
+            (*rows)[static_cast<size_t>(e)] = {Blend(s, kFieldLogAge, e), Blend(s, kFieldLogTeff, e), Blend(s, kFieldLogL, e),
+                                               data_[s.dominant + kFieldPhase * eepCount() + e]};
+        }
+    }
+
+  private:
+    astro_catalog::MappedFile file_;
+    TrackHeader header_{};
+    const float* logMass_ = nullptr;
+    const float* feh_ = nullptr;
+    const float* data_ = nullptr;
+};
+
+// Inverse-CDF draw from the Kroupa (2001) IMF, dN/dm ~ m^-1.3 below 0.5 Msun and m^-2.3
+// above, restricted to [lo, hi].
+inline float SampleKroupaMass(astro_random::PhiloxStream& rng, float lo, float hi) {
+    constexpr float kBreak = 0.5f;
+    // Integral of k m^-a over [m0, m1], and its inverse.
+    const auto integral = [](float k, float a, float m0, float m1) {
+        return k * (std::pow(m1, 1.0f - a) - std::pow(m0, 1.0f - a)) / (1.0f - a);
+    };
+    const auto invert = [](float k, float a, float m0, float area) {
+        return std::pow(std::pow(m0, 1.0f - a) + area * (1.0f - a) / k, 1.0f / (1.0f - a));
+    };
+    const float k1 = 1.0f, k2 = kBreak;  // continuous at the break
+    const float split = std::clamp(kBreak, lo, hi);
+    const float lowArea = integral(k1, 1.3f, lo, split), highArea = integral(k2, 2.3f, split, hi);
+    const float u = rng.Uniform() * (lowArea + highArea);
+    const float m = u < lowArea ? invert(k1, 1.3f, lo, u) : invert(k2, 2.3f, split, u - lowArea);
+    return std::clamp(m, lo, hi);
+}
+
+// A population evaluated against a TrackTable: fixed masses and metallicities, an age
+// shared by all. Evaluate() fills logTeff, logL and phase per star.
+class ClusterEvolver {
+  public:
+    static constexpr int kBlock = 4096;  // stars per parallel task (a multiple of the SIMD width)
+
+    void Bind(const TrackTable* table, const float* mass, const float* feh, size_t count) {
+        table_ = table;
+        for (auto* a : {&offset0_, &offset1_, &offset2_, &offset3_, &dominant_, &cursor_}) a->resize(count);
+        for (auto* a : {&weight0_, &weight1_, &weight2_, &weight3_, &logTeff_, &logL_, &phase_}) a->assign(count, 0.0f);
+        for (size_t i = 0; i < count; ++i) {
+            const TrackStencil s = table->Stencil(mass[i], feh[i]);
+            offset0_[i] = s.offset[0];
+            offset1_[i] = s.offset[1];
+            offset2_[i] = s.offset[2];
+            offset3_[i] = s.offset[3];
+            weight0_[i] = s.weight[0];
+            weight1_[i] = s.weight[1];
+            weight2_[i] = s.weight[2];
+            weight3_[i] = s.weight[3];
+            dominant_[i] = s.dominant;
+            cursor_[i] = 0;
+        }
+    }
+
+    size_t size() const { return cursor_.size(); }
+    const float* logTeff() const { return logTeff_.data(); }
+    const float* logL() const { return logL_.data(); }
+    const float* phase() const { return phase_.data(); }
+    // Stars whose cursor had to be re-bisected in the last Evaluate().
+    size_t bisected() const { return bisected_; }
+
+    void Evaluate(float logAge, astro_parallel::ThreadPool& pool) {
+        if (table_ == nullptr || size() == 0) return;
+        const int n = static_cast<int>(size());
+        const int blocks = (n + kBlock - 1) / kBlock;
+        bisectedPerBlock_.assign(static_cast<size_t>(blocks), 0);
+        pool.ParallelFor(blocks, 1, [&](int begin, int end) {
+            for (int b = begin; b < end; ++b) {
+                bisectedPerBlock_[static_cast<size_t>(b)] =
+                    EvaluateRange(logAge, static_cast<size_t>(b) * kBlock, std::min<size_t>(size(), static_cast<size_t>(b + 1) * kBlock));
+            }
+        });
+        bisected_ = 0;
+        for (size_t r : bisectedPerBlock_) bisected_ += r;
+    }
+
+  private:
+    using AlignedInts = std::vector<int32_t, astro_soa::AlignedAllocator<int32_t>>;
+
+    TrackStencil StencilAt(size_t i) const {
+        return TrackStencil{{offset0_[i], offset1_[i], offset2_[i], offset3_[i]}, {weight0_[i], weight1_[i], weight2_[i], weight3_[i]}, dominant_[i]};
+    }
+
+    size_t EvaluateScalar(float logAge, size_t i) {
+        int cursor = cursor_[i];
+        bool bisected = false;
+        const TrackRow row = table_->Sample(StencilAt(i), logAge, &cursor, &bisected);
+        cursor_[i] = cursor;
+        logTeff_[i] = row.logTeff;
+        logL_[i] = row.logL;
+        phase_[i] = row.phase;
+        return bisected ? 1 : 0;
+    }
+
+    size_t EvaluateRange(float logAge, size_t begin, size_t end) {
+        size_t i = begin, bisected = 0;
+#if defined(ASTRO_SOA_AVX2)
+        const float* d = table_->data();
+        const int eeps = table_->eepCount();
+        const __m256 t = _mm256_set1_ps(logAge);
+        const __m256i one = _mm256_set1_epi32(1), lastCursor = _mm256_set1_epi32(eeps - 2);
+        const __m256i rowTeff = _mm256_set1_epi32(kFieldLogTeff * eeps), rowL = _mm256_set1_epi32(kFieldLogL * eeps);
+        const __m256i rowPhase = _mm256_set1_epi32(kFieldPhase * eeps);
+        for (; i + 8 <= end; i += 8) {
+            const __m256i o0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(offset0_.data() + i));
+            const __m256i o1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(offset1_.data() + i));
+            const __m256i o2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(offset2_.data() + i));
+            const __m256i o3 = _mm256_load_si256(reinterpret_cast<const __m256i*>(offset3_.data() + i));
+            const __m256 w0 = _mm256_load_ps(weight0_.data() + i), w1 = _mm256_load_ps(weight1_.data() + i);
+            const __m256 w2 = _mm256_load_ps(weight2_.data() + i), w3 = _mm256_load_ps(weight3_.data() + i);
+            const auto blend = [&](__m256i at) {
+                __m256 v = _mm256_mul_ps(w0, _mm256_i32gather_ps(d, _mm256_add_epi32(o0, at), 4));
+                v = _mm256_add_ps(v, _mm256_mul_ps(w1, _mm256_i32gather_ps(d, _mm256_add_epi32(o1, at), 4)));
+                v = _mm256_add_ps(v, _mm256_mul_ps(w2, _mm256_i32gather_ps(d, _mm256_add_epi32(o2, at), 4)));
+                return _mm256_add_ps(v, _mm256_mul_ps(w3, _mm256_i32gather_ps(d, _mm256_add_epi32(o3, at), 4)));
+            };
+
+            __m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(cursor_.data() + i));
+            __m256 a0 = blend(c), a1 = blend(_mm256_add_epi32(c, one));
+            // A cursor is fine if [a0, a1) brackets the age, or it is pinned at either end.
+            const __m256i atFirst = _mm256_cmpeq_epi32(c, _mm256_setzero_si256()), atLast = _mm256_cmpeq_epi32(c, lastCursor);
+            const __m256 below = _mm256_or_ps(_mm256_cmp_ps(a0, t, _CMP_LE_OQ), _mm256_castsi256_ps(atFirst));
+            const __m256 above = _mm256_or_ps(_mm256_cmp_ps(t, a1, _CMP_LT_OQ), _mm256_castsi256_ps(atLast));
+            const int stale = ~_mm256_movemask_ps(_mm256_and_ps(below, above)) & 0xff;
+            if (stale != 0) {
+                alignas(32) float ages[8];
+                _mm256_store_ps(ages, a1);
+                for (int lane = 0; lane < 8; ++lane) {
+                    if ((stale >> lane) & 1) {
+                        const size_t star = i + static_cast<size_t>(lane);
+                        bool moved = false;
+                        cursor_[star] = table_->Advance(StencilAt(star), logAge, cursor_[star], ages[lane], &moved);
+                        bisected += moved ? 1 : 0;
+                    }
+                }
+                c = _mm256_load_si256(reinterpret_cast<const __m256i*>(cursor_.data() + i));
+                a0 = blend(c);
+                a1 = blend(_mm256_add_epi32(c, one));
+            }
+            const __m256i c1 = _mm256_add_epi32(c, one);
+            const __m256 f = _mm256_min_ps(_mm256_max_ps(_mm256_div_ps(_mm256_sub_ps(t, a0), _mm256_sub_ps(a1, a0)), _mm256_setzero_ps()),
+                                           _mm256_set1_ps(1.0f));
+            const __m256 teff0 = blend(_mm256_add_epi32(c, rowTeff)), teff1 = blend(_mm256_add_epi32(c1, rowTeff));
+            const __m256 l0 = blend(_mm256_add_epi32(c, rowL)), l1 = blend(_mm256_add_epi32(c1, rowL));
+            _mm256_store_ps(logTeff_.data() + i, _mm256_add_ps(teff0, _mm256_mul_ps(f, _mm256_sub_ps(teff1, teff0))));
+            _mm256_store_ps(logL_.data() + i, _mm256_add_ps(l0, _mm256_mul_ps(f, _mm256_sub_ps(l1, l0))));
+
+            // Phase of the dominant track at the nearer EEP; past the last EEP the star is gone.
+            const __m256i nearer = _mm256_add_epi32(c, _mm256_castps_si256(_mm256_and_ps(_mm256_cmp_ps(f, _mm256_set1_ps(0.5f), _CMP_GE_OQ),
+                                                                                            _mm256_castsi256_ps(one))));
+            const __m256i dom = _mm256_load_si256(reinterpret_cast<const __m256i*>(dominant_.data() + i));
+            const __m256 phase = _mm256_i32gather_ps(d, _mm256_add_epi32(dom, _mm256_add_epi32(nearer, rowPhase)), 4);
+            const __m256 ended = _mm256_and_ps(_mm256_cmp_ps(t, a1, _CMP_GE_OQ), _mm256_castsi256_ps(_mm256_cmpeq_epi32(c, lastCursor)));
+            _mm256_store_ps(phase_.data() + i, _mm256_blendv_ps(phase, _mm256_set1_ps(static_cast<float>(kPhaseRemnant)), ended));
+        }
+#endif
+        for (; i < end; ++i) bisected += EvaluateScalar(logAge, i);
+        return bisected;
+    }
+
+    const TrackTable* table_ = nullptr;
+    AlignedInts offset0_, offset1_, offset2_, offset3_, dominant_, cursor_;
+    astro_soa::AlignedFloats weight0_, weight1_, weight2_, weight3_;
+    astro_soa::AlignedFloats logTeff_, logL_, phase_;
+    std::vector<size_t> bisectedPerBlock_;
+    size_t bisected_ = 0;
+};
+
+}  // namespace astro_stellar
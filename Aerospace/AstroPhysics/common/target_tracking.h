@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Multi-target tracking for the turret demos: a bank of constant-velocity Kalman
+// filters, a closed-form intercept solver, and a uniform grid for ray and segment
+// queries against many moving spheres.
+//
+// The filters run per target and per axis. With white-noise acceleration the three
+// axes decouple, so a track is three 2-state filters (position, velocity) and a 2x2
+// covariance per axis. The bank stores them as SoA columns, and Predict() is one
+// straight-line pass over all tracks that the compiler vectorises.
+//
+// An intercept is the first time t >= 0 at which a shell fired from `origin` at
+// `speed`, in a straight line, meets a track moving at constant velocity:
+//
+//   |r + v t| = speed t,  r = p - origin
+//   (v.v - s^2) t^2 + 2 (r.v) t + r.r = 0
+//
+// SolveIntercepts() does this for every track in one pass, selecting roots with
+// arithmetic instead of branches.
+
+namespace astro_track {
+
+struct FilterOptions {
+    float measurementSigma = 0.6f;       // radar position noise per axis
+    float accelerationSigma = 6.0f;      // unmodelled manoeuvre, per axis
+    float initialVelocitySigma = 30.0f;  // before the second measurement
+    float gateSigmas = 6.0f;             // innovations beyond this restart the track
+};
+
+class TrackBank {
+  public:
+    explicit TrackBank(const FilterOptions& options = FilterOptions{}) : options_(options) {}
+
+    void Resize(int count) {
+        const size_t n = static_cast<size_t>(std::max(0, count));
+        for (int a = 0; a < 3; ++a) {
+            pos_[a].assign(n, 0.0f);
+            vel_[a].assign(n, 0.0f);
+            pp_[a].assign(n, 0.0f);
+            pv_[a].assign(n, 0.0f);
+            vv_[a].assign(n, 0.0f);
+        }
+        valid_.assign(n, 0);
+        age_.assign(n, 0.0f);
+        updates_.assign(n, 0);
+    }
+
+    int size() const { return static_cast<int>(valid_.size()); }
+    const FilterOptions& options() const { return options_; }
+
+    bool valid(int i) const { return valid_[static_cast<size_t>(i)] != 0; }
+    // Seconds since the last measurement.
+    float age(int i) const { return age_[static_cast<size_t>(i)]; }
+    int updates(int i) const { return updates_[static_cast<size_t>(i)]; }
+    float pos(int axis, int i) const { return pos_[axis][static_cast<size_t>(i)]; }
+    float vel(int axis, int i) const { return vel_[axis][static_cast<size_t>(i)]; }
+    float positionVariance(int axis, int i) const { return pp_[axis][static_cast<size_t>(i)]; }
+    const float* positions(int axis) const { return pos_[axis].data(); }
+    const float* velocities(int axis) const { return vel_[axis].data(); }
+
+    void Drop(int i) {
+        valid_[static_cast<size_t>(i)] = 0;
+        updates_[static_cast<size_t>(i)] = 0;
+    }
+
+    // Tracks not measured for `timeout` seconds are dropped.
+    void DropStale(float timeout) {
+        for (size_t i = 0; i < valid_.size(); ++i) {
+            if (age_[i] > timeout) {
+                valid_[i] = 0;
+                updates_[i] = 0;
+            }
+        }
+    }
+
+    // Propagates every track by dt: x += v dt, P = F P F' + Q.
+    void Predict(float dt) {
+        const float q = options_.accelerationSigma * options_.accelerationSigma;
+        const float qpp = 0.25f * q * dt * dt * dt * dt, qpv = 0.5f * q * dt * dt * dt, qvv = q * dt * dt;
+        const size_t n = valid_.size();
+        for (int a = 0; a < 3; ++a) {
+            float* x = pos_[a].data();
+            const float* v = vel_[a].data();
+            float* pp = pp_[a].data();
+            float* pv = pv_[a].data();
+            float* vv = vv_[a].data();
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += v[i] * dt;
+                pp[i] += dt * (2.0f * pv[i] + dt * vv[i]) + qpp;
+                pv[i] += dt * vv[i] + qpv;
+                vv[i] += qvv;
+            }
+        }
+        for (size_t i = 0; i < n; ++i) age_[i] += dt;
+    }
+
+    // Folds in one position measurement of track i. The first measurement starts the
+    // track at rest with a wide velocity prior; so does one far outside the gate (the
+    // target was replaced, or the filter lost it). Returns false when it restarted.
+    bool Update(int i, float zx, float zy, float zz) {
+        const size_t k = static_cast<size_t>(i);
+        const float z[3] = {zx, zy, zz};
+        const float r = options_.measurementSigma * options_.measurementSigma;
+        bool restart = valid_[k] == 0;
+        if (!restart) {
+            float d2 = 0.0f;
+            for (int a = 0; a < 3; ++a) {
+                const float y = z[a] - pos_[a][k];
+                d2 += y * y / (pp_[a][k] + r);
+            }
+            restart = d2 > options_.gateSigmas * options_.gateSigmas;
+        }
+        if (restart) {
+            for (int a = 0; a < 3; ++a) {
+                pos_[a][k] = z[a];
+                vel_[a][k] = 0.0f;
+                pp_[a][k] = r;
+                pv_[a][k] = 0.0f;
+                vv_[a][k] = options_.initialVelocitySigma * options_.initialVelocitySigma;
+            }
+            valid_[k] = 1;
+            age_[k] = 0.0f;
+            updates_[k] = 1;
+            return false;
+        }
+        for (int a = 0; a < 3; ++a) {
+            const float pp = pp_[a][k], pv = pv_[a][k];
+            const float s = pp + r;
+            const float k0 = pp / s, k1 = pv / s;
+            const float y = z[a] - pos_[a][k];
+            pos_[a][k] += k0 * y;
+            vel_[a][k] += k1 * y;
+            pp_[a][k] = (1.0f - k0) * pp;
+            pv_[a][k] = (1.0f - k0) * pv;
+            vv_[a][k] -= k1 * pv;
+        }
+        age_[k] = 0.0f;
+        ++updates_[k];
+        return true;
+    }
+
+  private:
+    FilterOptions options_;
+    std::array<std::vector<float>, 3> pos_, vel_;
+    std::array<std::vector<float>, 3> pp_, pv_, vv_;
+    std::vector<uint8_t> valid_;
+    std::vector<float> age_;
+    std::vector<int> updates_;
+};
+
+struct InterceptSolution {
+    std::vector<float> time;  // < 0 where the shell cannot catch the track
+    std::array<std::vector<float>, 3> point;
+};
+
+// Intercept times and points for every track against a shell fired from origin at
+// `speed`; `latency` seconds pass before the shell leaves (the turret's slew and the
+// trigger path), during which the tracks keep moving. Invalid tracks get -1.
+inline void SolveIntercepts(const TrackBank& bank, const float origin[3], float speed, float latency, InterceptSolution* out) {
+    const size_t n = static_cast<size_t>(bank.size());
+    out->time.resize(n);
+    for (int a = 0; a < 3; ++a) out->point[a].resize(n);
+    const float* px = bank.positions(0);
+    const float* py = bank.positions(1);
+    const float* pz = bank.positions(2);
+    const float* vx = bank.velocities(0);
+    const float* vy = bank.velocities(1);
+    const float* vz = bank.velocities(2);
+    float* t = out->time.data();
+    float* ix = out->point[0].data();
+    float* iy = out->point[1].data();
+    float* iz = out->point[2].data();
+    const float s2 = speed * speed;
+    for (size_t i = 0; i < n; ++i) {
+        const float rx = px[i] + vx[i] * latency - origin[0];
+        const float ry = py[i] + vy[i] * latency - origin[1];
+        const float rz = pz[i] + vz[i] * latency - origin[2];
+        const float a = vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i] - s2;
+        const float b = rx * vx[i] + ry * vy[i] + rz * vz[i];  // half of the linear coefficient
+        const float c = rx * rx + ry * ry + rz * rz;
+        // Roots (-b +- sqrt(b^2 - a c)) / a, written as c / (-b -+ sqrt(...)) so a
+        // near-zero `a` (target as fast as the shell) stays finite. With a < 0, the
+        // usual case, exactly one root is positive.
+        const float disc = b * b - a * c;
+        const float root = std::sqrt(std::max(disc, 0.0f));
+        const float q = -b + (b > 0.0f ? -root : root);
+        const float t1 = q != 0.0f ? c / q : -1.0f;
+        const float t2 = a != 0.0f ? q / a : -1.0f;
+        float best = t1 >= 0.0f ? t1 : t2;
+        best = (t2 >= 0.0f && t2 < best) ? t2 : best;
+        best = disc >= 0.0f && best >= 0.0f ? best : -1.0f;
+        t[i] = best;
+        ix[i] = rx + origin[0] + vx[i] * best;
+        iy[i] = ry + origin[1] + vy[i] * best;
+        iz[i] = rz + origin[2] + vz[i] * best;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (!bank.valid(static_cast<int>(i))) t[i] = -1.0f;
+    }
+}
+
+// Uniform grid over an axis-aligned box. Each sphere is listed in every cell its
+// bounding box overlaps, so a query walks only the cells its segment crosses
+// (Amanatides-Woo traversal). Build() is a counting sort and reuses its storage.
+class SphereGrid {
+  public:
+    SphereGrid(const float lo[3], const float hi[3], float cell) : cell_(cell) {
+        for (int a = 0; a < 3; ++a) {
+            lo_[a] = lo[a];
+            dims_[a] = std::max(1, static_cast<int>(std::ceil((hi[a] - lo[a]) / cell)));
+        }
+        starts_.assign(static_cast<size_t>(dims_[0]) * dims_[1] * dims_[2] + 1, 0);
+    }
+
+    // Spheres with radius <= 0 are left out.
+    void Build(int count, const float* x, const float* y, const float* z, const float* radius) {
+        std::fill(starts_.begin(), starts_.end(), 0);
+        ForEachCell(count, x, y, z, radius, [&](int, size_t cell) { ++starts_[cell + 1]; });
+        for (size_t c = 1; c < starts_.size(); ++c) starts_[c] += starts_[c - 1];
+        items_.resize(static_cast<size_t>(starts_.back()));
+        cursor_.assign(starts_.begin(), starts_.end() - 1);
+        ForEachCell(count, x, y, z, radius, [&](int i, size_t cell) { items_[static_cast<size_t>(cursor_[cell]++)] = i; });
+    }
+
+    int entries() const { return static_cast<int>(items_.size()); }
+
+    // Calls visit(index) for the spheres listed in every cell the segment from a to b
+    // crosses, nearest cells first; a sphere spanning several cells is seen once per
+    // cell. visit returns false to stop early, e.g. after a hit in the current cell
+    // when the caller keeps the nearest one.
+    template <typename Visit>
+    void QuerySegment(const float a[3], const float b[3], Visit&& visit) const {
+        float d[3], t0 = 0.0f, t1 = 1.0f;
+        for (int k = 0; k < 3; ++k) {
+            d[k] = b[k] - a[k];
+            const float hi = lo_[k] + dims_[k] * cell_;
+            if (std::fabs(d[k]) < 1.0e-12f) {
+                if (a[k] < lo_[k] || a[k] > hi) return;
+                continue;
+            }
+            float ta = (lo_[k] - a[k]) / d[k], tb = (hi - a[k]) / d[k];
+            if (ta > tb) std::swap(ta, tb);
+            t0 = std::max(t0, ta);
+            t1 = std::min(t1, tb);
+        }
+        if (t0 > t1) return;
+
+        int c[3], step[3];
+        float next[3], delta[3];
+        for (int k = 0; k < 3; ++k) {
+            const float p = (a[k] + d[k] * t0 - lo_[k]) / cell_;
+            c[k] = std::clamp(static_cast<int>(std::floor(p)), 0, dims_[k] - 1);
+            if (d[k] > 0.0f) {
+                step[k] = 1;
+                delta[k] = cell_ / d[k];
+                next[k] = (lo_[k] + (c[k] + 1) * cell_ - a[k]) / d[k];
+            } else if (d[k] < 0.0f) {
+                step[k] = -1;
+                delta[k] = -cell_ / d[k];
+                next[k] = (lo_[k] + c[k] * cell_ - a[k]) / d[k];
+            } else {
+                step[k] = 0;
+                delta[k] = next[k] = 2.0f;  // never crossed
+            }
+        }
+        while (true) {
+            const size_t cell = Cell(c[0], c[1], c[2]);
+            for (int j = starts_[cell]; j < starts_[cell + 1]; ++j) {
+                if (!visit(items_[static_cast<size_t>(j)])) return;
+            }
+            const int k = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+            if (next[k] > t1) return;
+            c[k] += step[k];
+            if (c[k] < 0 || c[k] >= dims_[k]) return;
+            next[k] += delta[k];
+        }
+    }
+
+  private:
+    size_t Cell(int x, int y, int z) const {
+        return (static_cast<size_t>(z) * dims_[1] + y) * dims_[0] + x;
+    }
+
+    template <typename Fn>
+    void ForEachCell(int count, const float* x, const float* y, const float* z, const float* radius, Fn&& fn) const {
+        const float inv = 1.0f / cell_;
+        for (int i = 0; i < count; ++i) {
+            const float r = radius[i];
+            if (!(r > 0.0f)) continue;
+            const float p[3] = {x[i], y[i], z[i]};
+            int lo[3], hi[3];
+            bool inside = true;
+            for (int k = 0; k < 3; ++k) {
+                lo[k] = std::max(0, static_cast<int>(std::floor((p[k] - r - lo_[k]) * inv)));
+                hi[k] = std::min(dims_[k] - 1, static_cast<int>(std::floor((p[k] + r - lo_[k]) * inv)));
+                inside = inside && lo[k] <= hi[k];
+            }
+            if (!inside) continue;
+            for (int cz = lo[2]; cz <= hi[2]; ++cz) {
+                for (int cy = lo[1]; cy <= hi[1]; ++cy) {
+                    for (int cx = lo[0]; cx <= hi[0]; ++cx) fn(i, Cell(cx, cy, cz));
+                }
+            }
+        }
+    }
+
+    float lo_[3] = {};
+    int dims_[3] = {1, 1, 1};
+    float cell_ = 1.0f;
+    std::vector<int> starts_;
+    std::vector<int> cursor_;
+    std::vector<int> items_;
+};
+
+// Earliest t in [0, 1] at which the segment a + (b - a) t comes within `radius` of
+// `center`, or -1.
+inline float SegmentSphereHit(const float a[3], const float b[3], const float center[3], float radius) {
+    float d[3], m[3];
+    for (int k = 0; k < 3; ++k) {
+        d[k] = b[k] - a[k];
+        m[k] = a[k] - center[k];
+    }
+    const float dd = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    const float md = m[0] * d[0] + m[1] * d[1] + m[2] * d[2];
+    const float mm = m[0] * m[0] + m[1] * m[1] + m[2] * m[2] - radius * radius;
+    if (mm <= 0.0f) return 0.0f;
+    if (dd <= 0.0f || md >= 0.0f) return -1.0f;
+    const float disc = md * md - dd * mm;
+    if (disc < 0.0f) return -1.0f;
+    const float t = (-md - std::sqrt(disc)) / dd;
+    return t <= 1.0f ? t : -1.0f;
+}
+
+}  // namespace astro_track
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "profiler.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Work-stealing job system and a per-frame task graph for scenes that step several
+// independent simulation subsystems.
+//
+// A scene registers its update stages once with TaskGraph::Add(name, fn, after) and calls
+// Run() every frame before BeginDrawing(). Stages whose dependencies have finished run
+// concurrently on the JobSystem workers and the calling thread; Run() returns when all of
+// them are done, so rendering stays on the main thread. Each thread owns a deque of jobs:
+// it pushes and pops its own work at the back, and idle threads steal from the front of
+// the others. A ThreadPool pass issued from inside a stage (the SharedPool() kernels in
+// common/) forks onto the same deques instead of the non-reentrant pool, so nested data
+// parallelism keeps every core busy.
+
+namespace astro_parallel {
+
+class JobSystem final : public NestedForkJoin {
+  public:
+    // A unit of work. `pending` is decremented once run() returns.
+    struct Job {
+        void (*run)(void* context, int index) = nullptr;
+        void* context = nullptr;
+        int index = 0;
+        std::atomic<int>* pending = nullptr;
+    };
+
+    // threadCount includes the thread that calls Run()/Wait() (slot 0).
+    explicit JobSystem(int threadCount = 0) {
+        if (threadCount <= 0) threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        deques_ = std::make_unique<Deque[]>(static_cast<size_t>(threadCount));
+        slotCount_ = threadCount;
+        workers_.reserve(static_cast<size_t>(threadCount - 1));
+        for (int slot = 1; slot < threadCount; ++slot) workers_.emplace_back([this, slot]() { WorkerLoop(slot); });
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) worker.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Worker threads plus the caller.
+    int size() const { return slotCount_; }
+
+    // Slot of the calling thread while it runs jobs for this system, or -1.
+    int CurrentSlot() const { return Tls().system == this ? Tls().slot : -1; }
+
+    // Fork/join over [0, taskCount). Unlike ThreadPool::Run this may be called from inside
+    // a job; the caller keeps executing queued work until every index has run.
+    void Run(int taskCount, const std::function<void(int)>& task) override {
+        if (taskCount <= 0) return;
+        if (taskCount == 1 || slotCount_ == 1) {
+            for (int i = 0; i < taskCount; ++i) task(i);
+            return;
+        }
+        SlotScope scope(this);
+        std::atomic<int> pending{taskCount};
+        void* context = const_cast<std::function<void(int)>*>(&task);
+        for (int i = taskCount - 1; i >= 1; --i) Push({&RunIndexed, context, i, &pending});
+        Execute({&RunIndexed, context, 0, &pending});
+        Wait(pending);
+    }
+
+    // Queues a job on the calling thread's deque (slot 0 for threads outside the system), or
+    // runs it inline if the deque is full. Follow with Wait() on the job's counter.
+    void Push(const Job& job) {
+        const int slot = std::max(0, CurrentSlot());
+        if (!deques_[static_cast<size_t>(slot)].PushBack(job)) {
+            Execute(job);
+            return;
+        }
+        queued_.fetch_add(1, std::memory_order_release);
+        if (sleepers_.load(std::memory_order_acquire) > 0) {
+            // Taking the lock orders this notify after a sleeper's predicate check.
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            wake_.notify_one();
+        }
+    }
+
+    // Runs queued jobs (own deque first, then stolen) until `pending` reaches zero.
+    void Wait(const std::atomic<int>& pending) {
+        SlotScope scope(this);
+        const int slot = Tls().slot;
+        while (pending.load(std::memory_order_acquire) > 0) {
+            Job job;
+            if (Find(slot, &job)) {
+                Execute(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+  private:
+    static constexpr size_t kDequeCapacity = 1024;
+
+    // Bounded ring guarded by a spinlock; the critical sections are a few loads and stores.
+    struct alignas(64) Deque {
+        bool PushBack(const Job& job) {
+            Lock();
+            const bool ok = bottom - top < kDequeCapacity;
+            if (ok) ring[bottom++ % kDequeCapacity] = job;
+            Unlock();
+            return ok;
+        }
+
+        bool PopBack(Job* job) {
+            Lock();
+            const bool ok = bottom != top;
+            if (ok) *job = ring[--bottom % kDequeCapacity];
+            Unlock();
+            return ok;
+        }
+
+        bool StealFront(Job* job) {
+            Lock();
+            const bool ok = bottom != top;
+            if (ok) *job = ring[top++ % kDequeCapacity];
+            Unlock();
+            return ok;
+        }
+
+        void Lock() {
+            while (busy.exchange(true, std::memory_order_acquire)) {
+                while (busy.load(std::memory_order_relaxed)) std::this_thread::yield();
+            }
+        }
+        void Unlock() { busy.store(false, std::memory_order_release); }
+
+        std::atomic<bool> busy{false};
+        size_t top = 0;
+        size_t bottom = 0;
+        std::array<Job, kDequeCapacity> ring{};
+    };
+
+    struct ThreadState {
+        JobSystem* system = nullptr;
+        int slot = -1;
+    };
+
+    // Binds the calling thread to slot 0 for the duration of a Run()/Wait() issued from
+    // outside the job system, and routes its ThreadPool passes here meanwhile.
+    class SlotScope {
+      public:
+        explicit SlotScope(JobSystem* system) : saved_(Tls()), savedNested_(CurrentForkJoin()) {
+            if (saved_.system != system) Tls() = {system, 0};
+            CurrentForkJoin() = system;
+        }
+        ~SlotScope() {
+            Tls() = saved_;
+            CurrentForkJoin() = savedNested_;
+        }
+        SlotScope(const SlotScope&) = delete;
+        SlotScope& operator=(const SlotScope&) = delete;
+
+      private:
+        ThreadState saved_;
+        NestedForkJoin* savedNested_;
+    };
+
+    static ThreadState& Tls() {
+        static thread_local ThreadState state;
+        return state;
+    }
+
+    static void RunIndexed(void* context, int index) { (*static_cast<const std::function<void(int)>*>(context))(index); }
+
+    static void Execute(const Job& job) {
+        job.run(job.context, job.index);
+        job.pending->fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    bool Find(int slot, Job* job) {
+        if (queued_.load(std::memory_order_acquire) <= 0) return false;
+        bool found = deques_[static_cast<size_t>(slot)].PopBack(job);
+        for (int k = 1; !found && k < slotCount_; ++k) {
+            found = deques_[static_cast<size_t>((slot + k) % slotCount_)].StealFront(job);
+        }
+        if (found) queued_.fetch_sub(1, std::memory_order_acq_rel);
+        return found;
+    }
+
+    void WorkerLoop(int slot) {
+        Tls() = {this, slot};
+        CurrentForkJoin() = this;
+        while (true) {
+            Job job;
+            if (Find(slot, &job)) {
+                Execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleepers_.fetch_add(1, std::memory_order_acq_rel);
+            wake_.wait(lock, [this]() { return stop_ || queued_.load(std::memory_order_acquire) > 0; });
+            sleepers_.fetch_sub(1, std::memory_order_acq_rel);
+            if (stop_) return;
+        }
+    }
+
+    std::unique_ptr<Deque[]> deques_;
+    int slotCount_ = 1;
+    std::vector<std::thread> workers_;
+    std::atomic<int> queued_{0};
+    std::atomic<int> sleepers_{0};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+};
+
+// Process-wide job system sized to the machine, created on first use.
+inline JobSystem& SharedJobs() {
+    static JobSystem jobs;
+    return jobs;
+}
+
+// Dependency graph of named per-frame stages. Build it once; Run() forks the stages whose
+// dependencies are satisfied, releases dependents as their inputs finish, and joins. Run()
+// does not allocate. Stage timings from the last frame and a smoothed average are kept for
+// the HUD.
+class TaskGraph {
+  public:
+    using TaskId = int;
+
+    // `after` lists stages that must finish first; they must already have been added.
+    TaskId Add(std::string name, std::function<void()> run, std::initializer_list<TaskId> after = {}) {
+        const TaskId id = static_cast<TaskId>(tasks_.size());
+        auto task = std::make_unique<Task>();
+        task->name = std::move(name);
+        task->run = std::move(run);
+        for (TaskId dependency : after) {
+            if (dependency < 0 || dependency >= id) continue;
+            tasks_[static_cast<size_t>(dependency)]->dependents.push_back(id);
+            ++task->dependencies;
+        }
+        tasks_.push_back(std::move(task));
+        return id;
+    }
+
+    void Run(JobSystem& jobs = SharedJobs()) {
+        if (tasks_.empty()) return;
+        const auto start = std::chrono::steady_clock::now();
+        std::atomic<int> pending{static_cast<int>(tasks_.size())};
+        jobs_ = &jobs;
+        pending_ = &pending;
+        for (const std::unique_ptr<Task>& task : tasks_) task->remaining.store(task->dependencies, std::memory_order_relaxed);
+        for (size_t i = 0; i < tasks_.size(); ++i) {
+            if (tasks_[i]->dependencies == 0) jobs.Push({&RunTask, this, static_cast<int>(i), &pending});
+        }
+        jobs.Wait(pending);
+        jobs_ = nullptr;
+        pending_ = nullptr;
+        frameMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    int size() const { return static_cast<int>(tasks_.size()); }
+    const std::string& Name(TaskId id) const { return tasks_[static_cast<size_t>(id)]->name; }
+    double LastMs(TaskId id) const { return tasks_[static_cast<size_t>(id)]->lastMs; }
+    double AverageMs(TaskId id) const { return tasks_[static_cast<size_t>(id)]->averageMs; }
+    // Job-system slot that ran the stage last frame (0 = the calling thread).
+    int LastThread(TaskId id) const { return tasks_[static_cast<size_t>(id)]->thread; }
+    // Wall time of the last Run(), and the summed stage time it covered.
+    double FrameMs() const { return frameMs_; }
+    double BusyMs() const {
+        double busy = 0.0;
+        for (const std::unique_ptr<Task>& task : tasks_) busy += task->lastMs;
+        return busy;
+    }
+
+    // One-line "name avg ms@thread ..." summary of the smoothed stage timings.
+    void FormatTimings(char* out, size_t size) const {
+        if (size == 0) return;
+        size_t used = static_cast<size_t>(std::snprintf(out, size, "tasks %.2f ms (busy %.2f):", frameMs_, BusyMs()));
+        for (const std::unique_ptr<Task>& task : tasks_) {
+            if (used >= size) break;
+            used += static_cast<size_t>(
+                std::snprintf(out + used, size - used, " %s %.2f@%d", task->name.c_str(), task->averageMs, task->thread));
+        }
+    }
+
+  private:
+    struct Task {
+        std::string name;
+        std::function<void()> run;
+        std::vector<TaskId> dependents;
+        int dependencies = 0;
+        std::atomic<int> remaining{0};
+        double lastMs = 0.0;
+        double averageMs = 0.0;
+        int thread = -1;
+        bool timed = false;
+    };
+
+    static void RunTask(void* context, int id) {
+        TaskGraph& graph = *static_cast<TaskGraph*>(context);
+        Task& task = *graph.tasks_[static_cast<size_t>(id)];
+        const auto start = std::chrono::steady_clock::now();
+        {
+            ASTRO_PROFILE_SCOPE(task.name.c_str());
+            task.run();
+        }
+        task.lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        task.averageMs = task.timed ? 0.9 * task.averageMs + 0.1 * task.lastMs : task.lastMs;
+        task.timed = true;
+        task.thread = graph.jobs_->CurrentSlot();
+        for (TaskId dependent : task.dependents) {
+            Task& next = *graph.tasks_[static_cast<size_t>(dependent)];
+            if (next.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                graph.jobs_->Push({&RunTask, &graph, dependent, graph.pending_});
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Task>> tasks_;
+    JobSystem* jobs_ = nullptr;
+    std::atomic<int>* pending_ = nullptr;
+    double frameMs_ = 0.0;
+};
+
+}  // namespace astro_parallel
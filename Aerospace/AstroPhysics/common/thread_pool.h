@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace astro_parallel {
+
+// Implemented by JobSystem (task_graph.h). While a thread is running jobs for one, passes
+// it issues through a ThreadPool fork onto that job system instead: the pool is not
+// reentrant, and several jobs may issue passes at once.
+class NestedForkJoin {
+  public:
+    virtual void Run(int taskCount, const std::function<void(int)>& task) = 0;
+
+  protected:
+    ~NestedForkJoin() = default;
+};
+
+inline NestedForkJoin*& CurrentForkJoin() {
+    static thread_local NestedForkJoin* current = nullptr;
+    return current;
+}
+
+// Small persistent pool for per-frame data-parallel passes. Run() hands out task
+// indices [0, taskCount) to the workers and the calling thread, and returns once
+// every task has finished. It is not reentrant: do not call Run() from inside a task.
+class ThreadPool {
+  public:
+    explicit ThreadPool(int threadCount = 0) {
+        if (threadCount <= 0) threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        workers_.reserve(static_cast<size_t>(threadCount - 1));
+        for (int i = 1; i < threadCount; ++i) workers_.emplace_back([this]() { WorkerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Worker threads plus the caller.
+    int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+    void Run(int taskCount, const std::function<void(int)>& task) {
+        if (taskCount <= 0) return;
+        if (NestedForkJoin* nested = CurrentForkJoin()) {
+            nested->Run(taskCount, task);
+            return;
+        }
+        if (workers_.empty() || taskCount == 1) {
+            for (int i = 0; i < taskCount; ++i) task(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            taskCount_ = taskCount;
+            next_.store(0);
+            active_ = static_cast<int>(workers_.size());
+            ++generation_;
+        }
+        wake_.notify_all();
+        Drain(task, taskCount);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return active_ == 0; });
+        task_ = nullptr;
+    }
+
+    // Splits [0, count) into contiguous chunks of at least minChunk items and calls
+    // body(begin, end) for each.
+    void ParallelFor(int count, int minChunk, const std::function<void(int, int)>& body) {
+        if (count <= 0) return;
+        const int chunks = std::clamp(count / std::max(1, minChunk), 1, 4 * size());
+        const int chunkSize = (count + chunks - 1) / chunks;
+        Run(chunks, [&](int c) {
+            const int begin = c * chunkSize;
+            const int end = std::min(count, begin + chunkSize);
+            if (begin < end) body(begin, end);
+        });
+    }
+
+  private:
+    void Drain(const std::function<void(int)>& task, int taskCount) {
+        for (int i = next_.fetch_add(1); i < taskCount; i = next_.fetch_add(1)) task(i);
+    }
+
+    void WorkerLoop() {
+        uint64_t seen = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            const std::function<void(int)>* task = task_;
+            const int taskCount = taskCount_;
+            lock.unlock();
+
+            Drain(*task, taskCount);
+
+            lock.lock();
+            if (--active_ == 0) done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(int)>* task_ = nullptr;
+    int taskCount_ = 0;
+    int active_ = 0;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+    std::atomic<int> next_{0};
+};
+
+// Process-wide pool sized to the machine, created on first use.
+inline ThreadPool& SharedPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+}  // namespace astro_parallel
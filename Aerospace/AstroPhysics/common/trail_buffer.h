@@ -0,0 +1,274 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace astro_render {
+
+// Fixed-capacity trail of the last `Capacity` positions, oldest first. Points are stored
+// relative to a movable origin, so shifting the whole trail (recentering on the centre of
+// mass) is one vector add. Every write is mirrored `Capacity` slots ahead, which keeps
+// the live window contiguous for a single upload.
+template <int Capacity>
+class TrailBuffer {
+    static_assert(Capacity >= 2, "a trail needs at least one segment");
+
+  public:
+    static constexpr int kCapacity = Capacity;
+
+    void Clear() {
+        head_ = 0;
+        count_ = 0;
+    }
+
+    // Appends a world-space point, dropping the oldest once full.
+    void Push(Vector3 world) {
+        const Vector3 local = Vector3Subtract(world, origin_);
+        int slot = head_ + count_;
+        if (count_ < Capacity) {
+            ++count_;
+        } else {
+            slot = head_;
+            head_ = head_ + 1 == Capacity ? 0 : head_ + 1;
+        }
+        if (slot >= Capacity) slot -= Capacity;
+        points_[static_cast<size_t>(slot)] = local;
+        points_[static_cast<size_t>(slot + Capacity)] = local;
+    }
+
+    // Moves every stored point by `offset`.
+    void Translate(Vector3 offset) { origin_ = Vector3Add(origin_, offset); }
+
+    int size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    Vector3 origin() const { return origin_; }
+
+    // size() contiguous points relative to origin(), oldest first.
+    const Vector3* data() const { return points_.data() + head_; }
+
+    Vector3 operator[](int i) const { return Vector3Add(data()[i], origin_); }
+
+  private:
+    std::array<Vector3, 2 * Capacity> points_{};
+    Vector3 origin_{0.0f, 0.0f, 0.0f};
+    int head_ = 0;
+    int count_ = 0;
+};
+
+// Collects trails during a frame and draws each with one instanced call: a segment quad
+// per instance, its ends read from consecutive points of the trail's window, widened in
+// screen space and faded from `oldestAlpha` to the colour's alpha in the shader. All
+// trails queued in a frame share one upload. Draw() goes between BeginMode3D/EndMode3D
+// and flushes queued immediate-mode geometry first; Unload() runs before CloseWindow().
+// Without GL 3.3 Draw() falls back to DrawLine3D per segment.
+class TrailRenderer {
+  public:
+    bool Init(float widthPixels = 1.5f, int initialPoints = 8192) {
+        widthPixels_ = widthPixels;
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locCorner_ = rlGetLocationAttrib(shader_, "vertexPosition");
+        locStart_ = rlGetLocationAttrib(shader_, "segmentStart");
+        locEnd_ = rlGetLocationAttrib(shader_, "segmentEnd");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locOrigin_ = rlGetLocationUniform(shader_, "origin");
+        locViewport_ = rlGetLocationUniform(shader_, "viewport");
+        locHalfWidth_ = rlGetLocationUniform(shader_, "halfWidth");
+        locColor_ = rlGetLocationUniform(shader_, "newestColor");
+        locOldestAlpha_ = rlGetLocationUniform(shader_, "oldestAlpha");
+        locSegments_ = rlGetLocationUniform(shader_, "segments");
+
+        // x runs along the segment (0 start, 1 end), y across it.
+        static constexpr float kCorners[] = {0.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+        static constexpr unsigned short kIndices[] = {0, 1, 2, 0, 2, 3};
+        vao_ = rlLoadVertexArray();
+        rlEnableVertexArray(vao_);
+        cornerVbo_ = rlLoadVertexBuffer(kCorners, static_cast<int>(sizeof(kCorners)), false);
+        rlSetVertexAttribute(static_cast<unsigned int>(locCorner_), 3, RL_FLOAT, false, 0, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locCorner_));
+        ebo_ = rlLoadVertexBufferElement(kIndices, static_cast<int>(sizeof(kIndices)), false);
+        AllocatePointBuffer(std::max(2, initialPoints));
+        rlDisableVertexArray();
+
+        ready_ = vao_ != 0;
+        return ready_;
+    }
+
+    void Unload() {
+        if (pointVbo_ != 0) rlUnloadVertexBuffer(pointVbo_);
+        if (cornerVbo_ != 0) rlUnloadVertexBuffer(cornerVbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        pointVbo_ = cornerVbo_ = ebo_ = vao_ = shader_ = 0;
+        capacity_ = 0;
+        ready_ = false;
+    }
+
+    void Clear() {
+        points_.clear();
+        trails_.clear();
+    }
+
+    // Queues a trail drawn from `oldestAlpha` at its first point to color.a at its last.
+    template <int Capacity>
+    void Add(const TrailBuffer<Capacity>& trail, Color color, unsigned char oldestAlpha) {
+        if (trail.size() < 2) return;
+        trails_.push_back({static_cast<int>(points_.size()), trail.size(), trail.origin(), color, oldestAlpha});
+        points_.insert(points_.end(), trail.data(), trail.data() + trail.size());
+    }
+
+    bool ready() const { return ready_; }
+
+    void Draw() {
+        if (trails_.empty()) return;
+        if (!ready_) {
+            DrawImmediate();
+            return;
+        }
+
+        rlDrawRenderBatchActive();
+        const int count = static_cast<int>(points_.size());
+        if (count > capacity_) {
+            rlEnableVertexArray(vao_);
+            rlUnloadVertexBuffer(pointVbo_);
+            AllocatePointBuffer(std::max(count, capacity_ * 2));
+            rlDisableVertexArray();
+        }
+        rlUpdateVertexBuffer(pointVbo_, points_.data(), count * static_cast<int>(sizeof(Vector3)), 0);
+
+        const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        const std::array<float, 2> viewport = {static_cast<float>(GetRenderWidth()), static_cast<float>(GetRenderHeight())};
+        const float halfWidth = 0.5f * widthPixels_;
+
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        rlSetUniform(locViewport_, viewport.data(), RL_SHADER_UNIFORM_VEC2, 1);
+        rlSetUniform(locHalfWidth_, &halfWidth, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlDisableDepthMask();
+        rlEnableVertexArray(vao_);
+        rlEnableVertexBuffer(pointVbo_);
+        const int stride = static_cast<int>(sizeof(Vector3));
+        for (const QueuedTrail& trail : trails_) {
+            // Re-point both per-instance attributes at this trail's run of the buffer.
+            const int offset = trail.first * stride;
+            rlSetVertexAttribute(static_cast<unsigned int>(locStart_), 3, RL_FLOAT, false, stride, offset);
+            rlSetVertexAttribute(static_cast<unsigned int>(locEnd_), 3, RL_FLOAT, false, stride, offset + stride);
+            const std::array<float, 3> origin = {trail.origin.x, trail.origin.y, trail.origin.z};
+            const std::array<float, 4> color = {trail.color.r / 255.0f, trail.color.g / 255.0f, trail.color.b / 255.0f,
+                                                trail.color.a / 255.0f};
+            const float oldestAlpha = trail.oldestAlpha / 255.0f;
+            const int segments = trail.count - 1;
+            rlSetUniform(locOrigin_, origin.data(), RL_SHADER_UNIFORM_VEC3, 1);
+            rlSetUniform(locColor_, color.data(), RL_SHADER_UNIFORM_VEC4, 1);
+            rlSetUniform(locOldestAlpha_, &oldestAlpha, RL_SHADER_UNIFORM_FLOAT, 1);
+            rlSetUniform(locSegments_, &segments, RL_SHADER_UNIFORM_INT, 1);
+            rlDrawVertexArrayElementsInstanced(0, 6, nullptr, segments);
+        }
+        rlDisableVertexBuffer();
+        rlDisableVertexArray();
+        rlEnableDepthMask();
+        rlDisableShader();
+    }
+
+  private:
+    struct QueuedTrail {
+        int first;
+        int count;
+        Vector3 origin;
+        Color color;
+        unsigned char oldestAlpha;
+    };
+
+    void AllocatePointBuffer(int capacity) {
+        capacity_ = capacity;
+        pointVbo_ = rlLoadVertexBuffer(nullptr, capacity_ * static_cast<int>(sizeof(Vector3)), true);
+        const int stride = static_cast<int>(sizeof(Vector3));
+        rlSetVertexAttribute(static_cast<unsigned int>(locStart_), 3, RL_FLOAT, false, stride, 0);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locStart_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locStart_), 1);
+        rlSetVertexAttribute(static_cast<unsigned int>(locEnd_), 3, RL_FLOAT, false, stride, stride);
+        rlEnableVertexAttribute(static_cast<unsigned int>(locEnd_));
+        rlSetVertexAttributeDivisor(static_cast<unsigned int>(locEnd_), 1);
+    }
+
+    // Same fade as the shader, one alpha per segment.
+    void DrawImmediate() const {
+        for (const QueuedTrail& trail : trails_) {
+            const Vector3* p = points_.data() + trail.first;
+            for (int i = 1; i < trail.count; ++i) {
+                const float t = static_cast<float>(i) / static_cast<float>(trail.count - 1);
+                Color c = trail.color;
+                c.a = static_cast<unsigned char>(trail.oldestAlpha + (trail.color.a - trail.oldestAlpha) * t);
+                DrawLine3D(Vector3Add(p[i - 1], trail.origin), Vector3Add(p[i], trail.origin), c);
+            }
+        }
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec3 vertexPosition;
+in vec3 segmentStart;
+in vec3 segmentEnd;
+uniform mat4 mvp;
+uniform vec3 origin;
+uniform vec2 viewport;
+uniform float halfWidth;
+uniform vec4 newestColor;
+uniform float oldestAlpha;
+uniform int segments;
+out vec4 fragColor;
+void main() {
+    vec4 c0 = mvp * vec4(segmentStart + origin, 1.0);
+    vec4 c1 = mvp * vec4(segmentEnd + origin, 1.0);
+    vec2 s0 = c0.xy / max(c0.w, 1e-4) * viewport;
+    vec2 s1 = c1.xy / max(c1.w, 1e-4) * viewport;
+    vec2 along = s1 - s0;
+    along = dot(along, along) > 1e-8 ? normalize(along) : vec2(1.0, 0.0);
+    vec4 clip = mix(c0, c1, vertexPosition.x);
+    clip.xy += vec2(-along.y, along.x) * vertexPosition.y * halfWidth * 2.0 / viewport * clip.w;
+    gl_Position = clip;
+    float t = (float(gl_InstanceID) + vertexPosition.x) / float(segments);
+    fragColor = vec4(newestColor.rgb, mix(oldestAlpha, newestColor.a, t));
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main() {
+    finalColor = fragColor;
+}
+)";
+
+    std::vector<Vector3> points_;
+    std::vector<QueuedTrail> trails_;
+    float widthPixels_ = 1.5f;
+    unsigned int shader_ = 0;
+    unsigned int vao_ = 0;
+    unsigned int cornerVbo_ = 0;
+    unsigned int ebo_ = 0;
+    unsigned int pointVbo_ = 0;
+    int capacity_ = 0;
+    int locCorner_ = -1;
+    int locStart_ = -1;
+    int locEnd_ = -1;
+    int locMvp_ = -1;
+    int locOrigin_ = -1;
+    int locViewport_ = -1;
+    int locHalfWidth_ = -1;
+    int locColor_ = -1;
+    int locOldestAlpha_ = -1;
+    int locSegments_ = -1;
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
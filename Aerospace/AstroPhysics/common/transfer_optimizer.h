@@ -0,0 +1,818 @@
+#pragma once
+
+#include "kepler_propagator.h"
+#include "lambert.h"
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Coplanar transfers between circular orbits about a point mass, and a multi-objective
+// search over them for the delta-v / time-of-flight trade.
+//
+// Each family maps a genome in [0, 1]^n onto a transfer. Bi-elliptic transfers have one
+// gene, the intermediate apoapsis. Two-impulse transfers have two: sweep angle and time
+// of flight. Three-impulse transfers have five: an intermediate point and two legs.
+// Low-thrust spirals also have two: the acceleration and a constant steering angle off
+// the velocity. Impulsive legs come from astro_lambert::SolveBatch. Each lane is scaled
+// so that its arrival point sits at (1, 0, 0), which lets one batch hold legs of any
+// radius. Spirals are RK4 lanes that stop at the target radius and circularise there
+// with a final impulse.
+//
+// Search runs differential evolution (DE/rand/1/bin) decomposed MOEA/D-style: every
+// family keeps sub-populations, each minimising a Tchebycheff blend of normalised
+// delta-v and log time of flight under its own weight. Together they cover the front,
+// including its non-convex parts. Every evaluated transfer is offered to the family's
+// Pareto archive. SearchThread runs generations on a worker and publishes a Front after
+// each one, following astro_cr3bp::FamilyCache.
+
+namespace astro_transfer {
+
+constexpr double kPi = 3.14159265358979323846;
+using astro_lambert::kLanes;
+
+enum class Family { kHohmann, kBiElliptic, kTwoImpulse, kThreeImpulse, kLowThrust };
+constexpr int kFamilyCount = 5;
+constexpr int kMaxGenes = 5;
+
+// Genome ranges. Times are in units of the Hohmann transfer time and the thrust in
+// units of the parking orbit's gravity.
+constexpr double kBiEllipticSpan = 40.0;  // apoapsis up to 40x the larger radius
+constexpr double kMinSweep = 0.04 * kPi;
+constexpr double kMinLegTime = 0.08, kMaxLegTime = 4.0;
+constexpr double kMinThrust = 1.5e-3, kMaxThrust = 0.25;
+constexpr double kMaxSteer = 0.3 * kPi;
+constexpr int kSpiralStepsPerOrbit = 96;
+constexpr int kMaxSpiralSteps = 60000;
+
+inline const char* FamilyName(Family f) {
+    switch (f) {
+        case Family::kHohmann: return "Hohmann";
+        case Family::kBiElliptic: return "bi-elliptic";
+        case Family::kTwoImpulse: return "two-impulse";
+        case Family::kThreeImpulse: return "three-impulse";
+        case Family::kLowThrust: return "low-thrust";
+    }
+    return "?";
+}
+
+inline int GeneCount(Family f) {
+    switch (f) {
+        case Family::kHohmann: return 0;
+        case Family::kBiElliptic: return 1;
+        case Family::kTwoImpulse: return 2;
+        case Family::kThreeImpulse: return 5;
+        case Family::kLowThrust: return 2;
+    }
+    return 0;
+}
+
+struct Problem {
+    double mu = 1.0;
+    double r1 = 1.0;  // parking orbit radius
+    double r2 = 2.0;  // target orbit radius
+
+    bool operator==(const Problem& o) const { return mu == o.mu && r1 == o.r1 && r2 == o.r2; }
+    bool operator!=(const Problem& o) const { return !(*this == o); }
+};
+
+inline double CircularSpeed(const Problem& p, double r) { return std::sqrt(p.mu / r); }
+
+inline double HohmannTime(const Problem& p) {
+    const double a = 0.5 * (p.r1 + p.r2);
+    return kPi * std::sqrt(a * a * a / p.mu);
+}
+
+struct Transfer {
+    Family family = Family::kHohmann;
+    std::array<double, kMaxGenes> genes{};
+    double dv = std::numeric_limits<double>::infinity();
+    double tof = std::numeric_limits<double>::infinity();
+
+    bool feasible() const { return std::isfinite(dv) && std::isfinite(tof); }
+};
+
+inline double LogBetween(double lo, double hi, double u) { return lo * std::exp(u * std::log(hi / lo)); }
+inline double Sweep(double u) { return kMinSweep + u * (2.0 * kPi - 2.0 * kMinSweep); }
+inline double LegTime(const Problem& p, double u) { return HohmannTime(p) * LogBetween(kMinLegTime, kMaxLegTime, u); }
+inline double Thrust(const Problem& p, double u) { return p.mu / (p.r1 * p.r1) * LogBetween(kMinThrust, kMaxThrust, u); }
+inline double Steer(double u) { return (2.0 * u - 1.0) * kMaxSteer; }
+inline double IntermediateRadius(const Problem& p, double u) {
+    return LogBetween(0.6 * std::min(p.r1, p.r2), 10.0 * std::max(p.r1, p.r2), u);
+}
+inline double BiEllipticApoapsis(const Problem& p, double u) { return std::max(p.r1, p.r2) * LogBetween(1.0, kBiEllipticSpan, u); }
+
+inline Transfer Hohmann(const Problem& p) {
+    Transfer t;
+    const double sum = p.r1 + p.r2;
+    t.dv = std::fabs(CircularSpeed(p, p.r1) * (std::sqrt(2.0 * p.r2 / sum) - 1.0)) +
+           std::fabs(CircularSpeed(p, p.r2) * (1.0 - std::sqrt(2.0 * p.r1 / sum)));
+    t.tof = HohmannTime(p);
+    return t;
+}
+
+inline void EvaluateBiElliptic(const Problem& p, Transfer* t) {
+    const double rb = BiEllipticApoapsis(p, t->genes[0]);
+    const double a1 = 0.5 * (p.r1 + rb), a2 = 0.5 * (rb + p.r2);
+    const double depart = std::sqrt(p.mu * (2.0 / p.r1 - 1.0 / a1));
+    const double apo1 = std::sqrt(p.mu * (2.0 / rb - 1.0 / a1));
+    const double apo2 = std::sqrt(p.mu * (2.0 / rb - 1.0 / a2));
+    const double arrive = std::sqrt(p.mu * (2.0 / p.r2 - 1.0 / a2));
+    t->dv = std::fabs(depart - CircularSpeed(p, p.r1)) + std::fabs(apo2 - apo1) + std::fabs(arrive - CircularSpeed(p, p.r2));
+    t->tof = kPi * (std::sqrt(a1 * a1 * a1 / p.mu) + std::sqrt(a2 * a2 * a2 / p.mu));
+}
+
+// Prograde zero-revolution legs from radius ra to radius rb through `sweep`, in a frame
+// per lane with the arrival point on +x (so the departure point is at angle -sweep).
+// Velocities are NaN where Lambert has no solution.
+struct LegBatch {
+    double ra[kLanes], rb[kLanes], sweep[kLanes], tof[kLanes];
+};
+
+struct LegResult {
+    double departX[kLanes], departY[kLanes], arriveX[kLanes], arriveY[kLanes];
+};
+
+inline void SolveLegs(const LegBatch& in, double mu, LegResult* out) {
+    // Lengths scale by 1 / rb and times by rb^-1.5, which leaves mu unchanged, so every
+    // lane can share the arrival point (1, 0, 0). Velocities scale back by 1 / sqrt(rb).
+    astro_lambert::Batch batch{};
+    batch.r2 = {1.0, 0.0, 0.0};
+    for (int l = 0; l < kLanes; ++l) {
+        const double s = in.ra[l] / in.rb[l];
+        batch.r1x[l] = s * std::cos(in.sweep[l]);
+        batch.r1y[l] = -s * std::sin(in.sweep[l]);
+        batch.r1z[l] = 0.0;
+        batch.tof[l] = in.tof[l] / (in.rb[l] * std::sqrt(in.rb[l]));
+    }
+    astro_lambert::BatchResult result;
+    astro_lambert::SolveBatch(batch, mu, &result);
+    for (int l = 0; l < kLanes; ++l) {
+        const double k = 1.0 / std::sqrt(in.rb[l]);
+        out->departX[l] = result.v1x[l] * k;
+        out->departY[l] = result.v1y[l] * k;
+        out->arriveX[l] = result.v2x[l] * k;
+        out->arriveY[l] = result.v2y[l] * k;
+    }
+}
+
+inline void PadLeg(LegBatch* b, int l) {
+    b->ra[l] = b->rb[l] = 1.0;
+    b->sweep[l] = 0.5 * kPi;
+    b->tof[l] = 1.0;
+}
+
+// Impulses to leave the circular orbit at the leg's departure and to join the one at
+// its arrival, in the leg frame.
+inline double DepartureBurn(double mu, const LegBatch& in, const LegResult& out, int l) {
+    const double v = std::sqrt(mu / in.ra[l]);
+    return std::hypot(out.departX[l] - v * std::sin(in.sweep[l]), out.departY[l] - v * std::cos(in.sweep[l]));
+}
+
+inline double ArrivalBurn(double mu, const LegBatch& in, const LegResult& out, int l) {
+    return std::hypot(out.arriveX[l], out.arriveY[l] - std::sqrt(mu / in.rb[l]));
+}
+
+// Thrust along the velocity turned by a constant steering angle (against it when the
+// target is lower). Lanes stop where they first reach the target radius.
+struct SpiralLanes {
+    double x[kLanes], y[kLanes], vx[kLanes], vy[kLanes];
+};
+
+inline void SpiralRates(const SpiralLanes& s, const double* thrust, const double* cosSteer, const double* sinSteer, double mu,
+                        SpiralLanes* d) {
+    for (int l = 0; l < kLanes; ++l) {
+        const double r2 = s.x[l] * s.x[l] + s.y[l] * s.y[l];
+        const double gravity = -mu / (r2 * std::sqrt(r2));
+        const double invSpeed = 1.0 / std::max(1e-12, std::hypot(s.vx[l], s.vy[l]));
+        const double ux = s.vx[l] * invSpeed, uy = s.vy[l] * invSpeed;
+        d->x[l] = s.vx[l];
+        d->y[l] = s.vy[l];
+        d->vx[l] = gravity * s.x[l] + thrust[l] * (ux * cosSteer[l] - uy * sinSteer[l]);
+        d->vy[l] = gravity * s.y[l] + thrust[l] * (ux * sinSteer[l] + uy * cosSteer[l]);
+    }
+}
+
+struct PathPoint {
+    double t, x, y;
+};
+
+// Spirals from the parking orbit at (r1, 0). dv is the thrust integral plus the final
+// circularising impulse; lanes that never arrive come back as infinity. `trace` records
+// lane 0 after every step.
+inline void RunSpirals(const Problem& p, const double* accel, const double* steer, double* dv, double* tof,
+                       std::vector<PathPoint>* trace = nullptr) {
+    const double sign = p.r2 >= p.r1 ? 1.0 : -1.0;
+    double c[kLanes], s[kLanes], thrust[kLanes], t[kLanes];
+    bool active[kLanes];
+    SpiralLanes state, k1, k2, k3, k4, probe;
+    for (int l = 0; l < kLanes; ++l) {
+        c[l] = std::cos(steer[l]);
+        s[l] = std::sin(steer[l]);
+        thrust[l] = sign * accel[l];
+        t[l] = 0.0;
+        active[l] = true;
+        state.x[l] = p.r1;
+        state.y[l] = 0.0;
+        state.vx[l] = 0.0;
+        state.vy[l] = CircularSpeed(p, p.r1);
+        dv[l] = tof[l] = std::numeric_limits<double>::infinity();
+    }
+    if (trace != nullptr) trace->push_back({0.0, p.r1, 0.0});
+
+    double dt[kLanes];
+    int remaining = kLanes;
+    for (int step = 0; step < kMaxSpiralSteps && remaining > 0; ++step) {
+        for (int l = 0; l < kLanes; ++l) {
+            const double r = std::hypot(state.x[l], state.y[l]);
+            dt[l] = active[l] ? 2.0 * kPi * r * std::sqrt(r / p.mu) / kSpiralStepsPerOrbit : 0.0;
+        }
+        const auto advance = [&](const SpiralLanes& k, double f) {
+            for (int l = 0; l < kLanes; ++l) {
+                probe.x[l] = state.x[l] + f * dt[l] * k.x[l];
+                probe.y[l] = state.y[l] + f * dt[l] * k.y[l];
+                probe.vx[l] = state.vx[l] + f * dt[l] * k.vx[l];
+                probe.vy[l] = state.vy[l] + f * dt[l] * k.vy[l];
+            }
+        };
+        SpiralRates(state, thrust, c, s, p.mu, &k1);
+        advance(k1, 0.5);
+        SpiralRates(probe, thrust, c, s, p.mu, &k2);
+        advance(k2, 0.5);
+        SpiralRates(probe, thrust, c, s, p.mu, &k3);
+        advance(k3, 1.0);
+        SpiralRates(probe, thrust, c, s, p.mu, &k4);
+
+        for (int l = 0; l < kLanes; ++l) {
+            if (!active[l]) continue;
+            const double before = std::hypot(state.x[l], state.y[l]);
+            const double h = dt[l] / 6.0;
+            SpiralLanes next;
+            next.x[l] = state.x[l] + h * (k1.x[l] + 2.0 * k2.x[l] + 2.0 * k3.x[l] + k4.x[l]);
+            next.y[l] = state.y[l] + h * (k1.y[l] + 2.0 * k2.y[l] + 2.0 * k3.y[l] + k4.y[l]);
+            next.vx[l] = state.vx[l] + h * (k1.vx[l] + 2.0 * k2.vx[l] + 2.0 * k3.vx[l] + k4.vx[l]);
+            next.vy[l] = state.vy[l] + h * (k1.vy[l] + 2.0 * k2.vy[l] + 2.0 * k3.vy[l] + k4.vy[l]);
+            const double after = std::hypot(next.x[l], next.y[l]);
+            if (sign * (after - p.r2) < 0.0) {
+                state.x[l] = next.x[l];
+                state.y[l] = next.y[l];
+                state.vx[l] = next.vx[l];
+                state.vy[l] = next.vy[l];
+                t[l] += dt[l];
+                continue;
+            }
+            // Crossed the target radius inside this step: interpolate to it.
+            const double f = std::clamp((p.r2 - before) / (after - before), 0.0, 1.0);
+            const double x = state.x[l] + f * (next.x[l] - state.x[l]);
+            const double y = state.y[l] + f * (next.y[l] - state.y[l]);
+            const double vx = state.vx[l] + f * (next.vx[l] - state.vx[l]);
+            const double vy = state.vy[l] + f * (next.vy[l] - state.vy[l]);
+            const double r = std::hypot(x, y);
+            const double v = CircularSpeed(p, p.r2);
+            t[l] += f * dt[l];
+            tof[l] = t[l];
+            dv[l] = accel[l] * t[l] + std::hypot(vx + v * y / r, vy - v * x / r);
+            state.x[l] = x;
+            state.y[l] = y;
+            active[l] = false;
+            --remaining;
+        }
+        if (trace != nullptr) {
+            trace->push_back({t[0], state.x[0], state.y[0]});
+            if (!active[0]) trace = nullptr;
+        }
+    }
+}
+
+// Fills dv and tof for `count` (at most kLanes) transfers of one family.
+inline void EvaluateLanes(const Problem& p, Family family, Transfer* const* transfers, int count) {
+    switch (family) {
+        case Family::kHohmann:
+            for (int l = 0; l < count; ++l) *transfers[l] = Hohmann(p);
+            return;
+        case Family::kBiElliptic:
+            for (int l = 0; l < count; ++l) EvaluateBiElliptic(p, transfers[l]);
+            return;
+        case Family::kTwoImpulse: {
+            LegBatch legs;
+            for (int l = 0; l < kLanes; ++l) {
+                if (l >= count) {
+                    PadLeg(&legs, l);
+                    continue;
+                }
+                legs.ra[l] = p.r1;
+                legs.rb[l] = p.r2;
+                legs.sweep[l] = Sweep(transfers[l]->genes[0]);
+                legs.tof[l] = LegTime(p, transfers[l]->genes[1]);
+            }
+            LegResult out;
+            SolveLegs(legs, p.mu, &out);
+            for (int l = 0; l < count; ++l) {
+                const double dv = DepartureBurn(p.mu, legs, out, l) + ArrivalBurn(p.mu, legs, out, l);
+                transfers[l]->dv = std::isfinite(dv) ? dv : std::numeric_limits<double>::infinity();
+                transfers[l]->tof = legs.tof[l];
+            }
+            return;
+        }
+        case Family::kThreeImpulse: {
+            LegBatch first, second;
+            for (int l = 0; l < kLanes; ++l) {
+                if (l >= count) {
+                    PadLeg(&first, l);
+                    PadLeg(&second, l);
+                    continue;
+                }
+                const std::array<double, kMaxGenes>& g = transfers[l]->genes;
+                const double rm = IntermediateRadius(p, g[0]);
+                first.ra[l] = p.r1;
+                first.rb[l] = second.ra[l] = rm;
+                second.rb[l] = p.r2;
+                first.sweep[l] = Sweep(g[1]);
+                first.tof[l] = LegTime(p, g[2]);
+                second.sweep[l] = Sweep(g[3]);
+                second.tof[l] = LegTime(p, g[4]);
+            }
+            LegResult a, b;
+            SolveLegs(first, p.mu, &a);
+            SolveLegs(second, p.mu, &b);
+            for (int l = 0; l < count; ++l) {
+                // The second leg's frame is the first's turned by its sweep.
+                const double cs = std::cos(second.sweep[l]), sn = std::sin(second.sweep[l]);
+                const double vx = cs * b.departX[l] - sn * b.departY[l];
+                const double vy = sn * b.departX[l] + cs * b.departY[l];
+                const double dv = DepartureBurn(p.mu, first, a, l) + std::hypot(vx - a.arriveX[l], vy - a.arriveY[l]) +
+                                  ArrivalBurn(p.mu, second, b, l);
+                transfers[l]->dv = std::isfinite(dv) ? dv : std::numeric_limits<double>::infinity();
+                transfers[l]->tof = first.tof[l] + second.tof[l];
+            }
+            return;
+        }
+        case Family::kLowThrust: {
+            double accel[kLanes], steer[kLanes], dv[kLanes], tof[kLanes];
+            for (int l = 0; l < kLanes; ++l) {
+                const Transfer* t = transfers[std::min(l, count - 1)];
+                accel[l] = Thrust(p, t->genes[0]);
+                steer[l] = Steer(t->genes[1]);
+            }
+            RunSpirals(p, accel, steer, dv, tof);
+            for (int l = 0; l < count; ++l) {
+                transfers[l]->dv = dv[l];
+                transfers[l]->tof = tof[l];
+            }
+            return;
+        }
+    }
+}
+
+// A transfer laid out for drawing, starting at (r1, 0): sampled positions and the
+// impulses, or the thrust arc for spirals.
+struct Burn {
+    double t, x, y, dv;
+};
+
+struct TransferPath {
+    std::vector<PathPoint> points;
+    std::vector<Burn> burns;
+    bool thrusting = false;  // points trace a powered spiral
+    double tof = 0.0;
+};
+
+// Kepler coast of (x, y, vx, vy) for `duration`, appending `samples` points.
+inline void AppendCoast(double mu, double t0, double duration, int samples, double* state, TransferPath* path) {
+    astro_kepler::Batch batch;
+    for (int l = 1; l < kLanes; ++l) astro_kepler::PadLane(&batch, l, mu);
+    batch.x[0] = state[0];
+    batch.y[0] = state[1];
+    batch.z[0] = 0.0;
+    batch.vx[0] = state[2];
+    batch.vy[0] = state[3];
+    batch.vz[0] = 0.0;
+    const double dt = duration / samples;
+    for (int i = 1; i <= samples; ++i) {
+        astro_kepler::PropagateBatch(&batch, mu, dt);
+        path->points.push_back({t0 + i * dt, batch.x[0], batch.y[0]});
+    }
+    state[0] = batch.x[0];
+    state[1] = batch.y[0];
+    state[2] = batch.vx[0];
+    state[3] = batch.vy[0];
+}
+
+inline TransferPath BuildPath(const Problem& p, const Transfer& transfer, int samplesPerArc = 180) {
+    TransferPath path;
+    path.tof = transfer.tof;
+    path.points.push_back({0.0, p.r1, 0.0});
+    if (!transfer.feasible()) return path;
+    const double v1 = CircularSpeed(p, p.r1);
+    const auto coastEllipse = [&](double t0, double from, double to, double* state) {
+        // Half an ellipse from an apsis at `from` to the opposite one at `to`.
+        const double a = 0.5 * (from + to);
+        const double half = kPi * std::sqrt(a * a * a / p.mu);
+        AppendCoast(p.mu, t0, half, samplesPerArc, state, &path);
+        return half;
+    };
+    const auto speedAt = [&](double r, double a) { return std::sqrt(p.mu * (2.0 / r - 1.0 / a)); };
+
+    switch (transfer.family) {
+        case Family::kHohmann: {
+            const double a = 0.5 * (p.r1 + p.r2);
+            double state[4] = {p.r1, 0.0, 0.0, speedAt(p.r1, a)};
+            path.burns.push_back({0.0, p.r1, 0.0, std::fabs(state[3] - v1)});
+            const double t = coastEllipse(0.0, p.r1, p.r2, state);
+            path.burns.push_back({t, state[0], state[1], std::fabs(CircularSpeed(p, p.r2) - std::hypot(state[2], state[3]))});
+            break;
+        }
+        case Family::kBiElliptic: {
+            const double rb = BiEllipticApoapsis(p, transfer.genes[0]);
+            const double a1 = 0.5 * (p.r1 + rb), a2 = 0.5 * (rb + p.r2);
+            double state[4] = {p.r1, 0.0, 0.0, speedAt(p.r1, a1)};
+            path.burns.push_back({0.0, p.r1, 0.0, std::fabs(state[3] - v1)});
+            const double t1 = coastEllipse(0.0, p.r1, rb, state);
+            const double apo = speedAt(rb, a2);
+            path.burns.push_back({t1, state[0], state[1], std::fabs(apo - std::hypot(state[2], state[3]))});
+            state[2] = 0.0;
+            state[3] = -apo;
+            const double t2 = coastEllipse(t1, rb, p.r2, state);
+            path.burns.push_back({t1 + t2, state[0], state[1], std::fabs(CircularSpeed(p, p.r2) - std::hypot(state[2], state[3]))});
+            break;
+        }
+        case Family::kTwoImpulse:
+        case Family::kThreeImpulse: {
+            const bool three = transfer.family == Family::kThreeImpulse;
+            const std::array<double, kMaxGenes>& g = transfer.genes;
+            double radii[3] = {p.r1, three ? IntermediateRadius(p, g[0]) : p.r2, p.r2};
+            double sweeps[2] = {Sweep(three ? g[1] : g[0]), three ? Sweep(g[3]) : 0.0};
+            double times[2] = {LegTime(p, three ? g[2] : g[1]), three ? LegTime(p, g[4]) : 0.0};
+            const int legs = three ? 2 : 1;
+            double state[4] = {p.r1, 0.0, 0.0, v1};
+            double angle = 0.0, t = 0.0;
+            for (int leg = 0; leg < legs; ++leg) {
+                LegBatch batch;
+                for (int l = 1; l < kLanes; ++l) PadLeg(&batch, l);
+                batch.ra[0] = radii[leg];
+                batch.rb[0] = radii[leg + 1];
+                batch.sweep[0] = sweeps[leg];
+                batch.tof[0] = times[leg];
+                LegResult out;
+                SolveLegs(batch, p.mu, &out);
+                // Leg frame to inertial: turn by the angle of its arrival point.
+                angle += sweeps[leg];
+                const double cs = std::cos(angle), sn = std::sin(angle);
+                const double vx = cs * out.departX[0] - sn * out.departY[0];
+                const double vy = sn * out.departX[0] + cs * out.departY[0];
+                path.burns.push_back({t, state[0], state[1], std::hypot(vx - state[2], vy - state[3])});
+                state[2] = vx;
+                state[3] = vy;
+                AppendCoast(p.mu, t, times[leg], samplesPerArc, state, &path);
+                t += times[leg];
+            }
+            const double r = std::hypot(state[0], state[1]);
+            const double v = CircularSpeed(p, p.r2);
+            path.burns.push_back({t, state[0], state[1], std::hypot(state[2] + v * state[1] / r, state[3] - v * state[0] / r)});
+            break;
+        }
+        case Family::kLowThrust: {
+            double accel[kLanes], steer[kLanes], dv[kLanes], tof[kLanes];
+            for (int l = 0; l < kLanes; ++l) {
+                accel[l] = Thrust(p, transfer.genes[0]);
+                steer[l] = Steer(transfer.genes[1]);
+            }
+            path.points.clear();
+            RunSpirals(p, accel, steer, dv, tof, &path.points);
+            path.thrusting = true;
+            const PathPoint& end = path.points.back();
+            path.burns.push_back({end.t, end.x, end.y, dv[0] - accel[0] * tof[0]});
+            break;
+        }
+    }
+    return path;
+}
+
+// Non-dominated transfers sorted by time of flight. Past `capacity`, the interior point
+// whose neighbours are closest together (in normalised delta-v and log time) goes.
+class ParetoArchive {
+  public:
+    explicit ParetoArchive(size_t capacity = 96) : capacity_(capacity) {}
+
+    void Clear(double dvScale) {
+        points_.clear();
+        dvScale_ = dvScale;
+    }
+
+    bool Offer(const Transfer& t) {
+        if (!t.feasible()) return false;
+        for (const Transfer& a : points_)
+            if (a.dv <= t.dv && a.tof <= t.tof) return false;
+        points_.erase(std::remove_if(points_.begin(), points_.end(), [&](const Transfer& a) { return t.dv <= a.dv && t.tof <= a.tof; }),
+                      points_.end());
+        points_.insert(std::upper_bound(points_.begin(), points_.end(), t, [](const Transfer& a, const Transfer& b) { return a.tof < b.tof; }), t);
+        if (points_.size() > capacity_) Thin();
+        return true;
+    }
+
+    const std::vector<Transfer>& points() const { return points_; }
+
+  private:
+    void Thin() {
+        size_t drop = 1;
+        double closest = std::numeric_limits<double>::infinity();
+        for (size_t i = 1; i + 1 < points_.size(); ++i) {
+            const double gap = std::hypot((points_[i + 1].dv - points_[i - 1].dv) / dvScale_, std::log(points_[i + 1].tof / points_[i - 1].tof));
+            if (gap < closest) {
+                closest = gap;
+                drop = i;
+            }
+        }
+        points_.erase(points_.begin() + static_cast<std::ptrdiff_t>(drop));
+    }
+
+    size_t capacity_;
+    double dvScale_ = 1.0;
+    std::vector<Transfer> points_;
+};
+
+struct SearchOptions {
+    int weights = 8;               // sub-populations per family
+    int populationPerWeight = 12;  // DE needs at least 4
+    int maxGenerations = 500;
+    double scale = 0.6;      // DE F
+    double crossover = 0.9;  // DE CR
+    uint64_t seed = 11;
+};
+
+// What the panel draws: every family's own front, their union and progress counters.
+struct Front {
+    Problem problem;
+    std::array<std::vector<Transfer>, kFamilyCount> families;
+    std::vector<Transfer> combined;
+    int generation = 0;
+    uint64_t evaluations = 0;
+};
+
+// Synchronous search: Step() runs one generation of every family on `pool`.
+class Search {
+  public:
+    static constexpr std::array<Family, 4> kSearched = {{Family::kBiElliptic, Family::kTwoImpulse, Family::kThreeImpulse, Family::kLowThrust}};
+
+    void Reset(const Problem& p, const SearchOptions& options = {}) {
+        problem_ = p;
+        options_ = options;
+        options_.populationPerWeight = std::max(4, options_.populationPerWeight);
+        key_ = astro_random::SeedKey(options_.seed);
+        generation_ = 0;
+        evaluations_ = 0;
+        dvScale_ = CircularSpeed(p, p.r1);
+        for (ParetoArchive& a : archives_) a.Clear(dvScale_);
+        const Transfer hohmann = Hohmann(p);
+        archives_[static_cast<size_t>(Family::kHohmann)].Offer(hohmann);
+        idealDv_ = hohmann.dv;
+        idealLogTof_ = std::log(hohmann.tof);
+
+        const int size = options_.weights * options_.populationPerWeight;
+        for (size_t f = 0; f < kSearched.size(); ++f) {
+            parents_[f].assign(static_cast<size_t>(size), Transfer{});
+            trials_[f].assign(static_cast<size_t>(size), Transfer{});
+            for (int i = 0; i < size; ++i) {
+                parents_[f][static_cast<size_t>(i)].family = kSearched[f];
+                const astro_random::PhiloxCounter bits = Draw(static_cast<uint32_t>(f), static_cast<uint32_t>(i), 0xffffffffu);
+                const astro_random::PhiloxCounter more = Draw(static_cast<uint32_t>(f), static_cast<uint32_t>(i), 0xfffffffeu);
+                for (int g = 0; g < kMaxGenes; ++g)
+                    parents_[f][static_cast<size_t>(i)].genes[static_cast<size_t>(g)] = astro_random::UnitFloat(g < 4 ? bits[g] : more[g - 4]);
+            }
+        }
+    }
+
+    void Step(astro_parallel::ThreadPool& pool) {
+        if (done()) return;
+        // Generation 0 scores the initial population; later ones score DE trials.
+        const bool initial = generation_ == 0;
+        if (!initial) MakeTrials();
+        std::array<std::vector<Transfer>, kSearched.size()>& scored = initial ? parents_ : trials_;
+
+        struct Group {
+            size_t family;
+            size_t first;
+            int count;
+        };
+        std::vector<Group> groups;
+        for (size_t f = 0; f < kSearched.size(); ++f)
+            for (size_t i = 0; i < scored[f].size(); i += kLanes)
+                groups.push_back({f, i, static_cast<int>(std::min<size_t>(kLanes, scored[f].size() - i))});
+        pool.Run(static_cast<int>(groups.size()), [&](int task) {
+            const Group& g = groups[static_cast<size_t>(task)];
+            Transfer* lanes[kLanes];
+            for (int l = 0; l < g.count; ++l) lanes[l] = &scored[g.family][g.first + static_cast<size_t>(l)];
+            EvaluateLanes(problem_, kSearched[g.family], lanes, g.count);
+        });
+
+        for (size_t f = 0; f < kSearched.size(); ++f) {
+            ParetoArchive& archive = archives_[static_cast<size_t>(kSearched[f])];
+            for (const Transfer& t : scored[f]) {
+                ++evaluations_;
+                if (!t.feasible()) continue;
+                archive.Offer(t);
+                idealDv_ = std::min(idealDv_, t.dv);
+                idealLogTof_ = std::min(idealLogTof_, std::log(t.tof));
+            }
+        }
+        if (!initial) {
+            for (size_t f = 0; f < kSearched.size(); ++f) {
+                for (size_t i = 0; i < parents_[f].size(); ++i) {
+                    const double w = WeightOf(i);
+                    if (Cost(trials_[f][i], w) <= Cost(parents_[f][i], w)) parents_[f][i] = trials_[f][i];
+                }
+            }
+        }
+        ++generation_;
+    }
+
+    Front Snapshot() const {
+        Front front;
+        front.problem = problem_;
+        front.generation = generation_;
+        front.evaluations = evaluations_;
+        ParetoArchive combined(static_cast<size_t>(-1));
+        combined.Clear(dvScale_);
+        for (int f = 0; f < kFamilyCount; ++f) {
+            front.families[static_cast<size_t>(f)] = archives_[static_cast<size_t>(f)].points();
+            for (const Transfer& t : archives_[static_cast<size_t>(f)].points()) combined.Offer(t);
+        }
+        front.combined = combined.points();
+        return front;
+    }
+
+    int generation() const { return generation_; }
+    bool done() const { return generation_ > options_.maxGenerations; }
+
+  private:
+    astro_random::PhiloxCounter Draw(uint32_t family, uint32_t index, uint32_t round) const {
+        return astro_random::Philox4x32({family, index, round, 0u}, key_);
+    }
+
+    double WeightOf(size_t i) const {
+        const int k = static_cast<int>(i) / options_.populationPerWeight;
+        return (k + 0.5) / options_.weights;
+    }
+
+    // Tchebycheff distance to the ideal point; infeasible transfers lose to any other.
+    double Cost(const Transfer& t, double w) const {
+        if (!t.feasible()) return std::numeric_limits<double>::infinity();
+        return std::max(w * (t.dv - idealDv_) / dvScale_, (1.0 - w) * (std::log(t.tof) - idealLogTof_) / std::log(kBiEllipticSpan));
+    }
+
+    // DE/rand/1/bin inside each weight's sub-population, reflected back into [0, 1].
+    void MakeTrials() {
+        const int n = options_.populationPerWeight;
+        for (size_t f = 0; f < kSearched.size(); ++f) {
+            const int genes = GeneCount(kSearched[f]);
+            for (size_t i = 0; i < parents_[f].size(); ++i) {
+                const int base = static_cast<int>(i) / n * n;
+                const int self = static_cast<int>(i) - base;
+                const uint32_t round = 2u * static_cast<uint32_t>(generation_);
+                const astro_random::PhiloxCounter bits = Draw(static_cast<uint32_t>(f), static_cast<uint32_t>(i), round);
+                const astro_random::PhiloxCounter cross = Draw(static_cast<uint32_t>(f), static_cast<uint32_t>(i), round + 1u);
+                // Three distinct donors other than i: offsets 1..n-1 from self, kept apart.
+                int picks[3];
+                picks[0] = 1 + static_cast<int>(bits[0] % static_cast<uint32_t>(n - 1));
+                picks[1] = 1 + static_cast<int>(bits[1] % static_cast<uint32_t>(n - 2));
+                if (picks[1] >= picks[0]) ++picks[1];
+                picks[2] = 1 + static_cast<int>(bits[2] % static_cast<uint32_t>(n - 3));
+                for (int lower : {std::min(picks[0], picks[1]), std::max(picks[0], picks[1])})
+                    if (picks[2] >= lower) ++picks[2];
+                const Transfer& a = parents_[f][static_cast<size_t>(base + (self + picks[0]) % n)];
+                const Transfer& b = parents_[f][static_cast<size_t>(base + (self + picks[1]) % n)];
+                const Transfer& c = parents_[f][static_cast<size_t>(base + (self + picks[2]) % n)];
+
+                Transfer& trial = trials_[f][i];
+                trial = parents_[f][i];
+                const int forced = static_cast<int>(bits[3] % static_cast<uint32_t>(genes));
+                for (int g = 0; g < genes; ++g) {
+                    const size_t gi = static_cast<size_t>(g);
+                    // The fifth gene reuses the low bits UnitFloat drops from the first.
+                    const float u = g < 4 ? astro_random::UnitFloat(cross[gi]) : static_cast<float>(cross[0] & 0xffu) / 256.0f;
+                    if (g != forced && u >= options_.crossover) continue;
+                    double v = a.genes[gi] + options_.scale * (b.genes[gi] - c.genes[gi]);
+                    if (v < 0.0) v = -v;
+                    if (v > 1.0) v = 2.0 - v;
+                    trial.genes[gi] = std::clamp(v, 0.0, 1.0);
+                }
+                trial.dv = trial.tof = std::numeric_limits<double>::infinity();
+            }
+        }
+    }
+
+    Problem problem_;
+    SearchOptions options_;
+    astro_random::PhiloxKey key_{};
+    int generation_ = 0;
+    uint64_t evaluations_ = 0;
+    double dvScale_ = 1.0;
+    double idealDv_ = 0.0;
+    double idealLogTof_ = 0.0;
+    std::array<ParetoArchive, kFamilyCount> archives_;
+    std::array<std::vector<Transfer>, kSearched.size()> parents_;
+    std::array<std::vector<Transfer>, kSearched.size()> trials_;
+};
+
+// Runs Search on a worker thread with its own pool. Request() restarts it when the
+// problem changes; Acquire() swaps in the newest published front.
+class SearchThread {
+  public:
+    SearchThread() = default;
+    SearchThread(const SearchThread&) = delete;
+    SearchThread& operator=(const SearchThread&) = delete;
+    ~SearchThread() { Stop(); }
+
+    void Request(const Problem& p, const SearchOptions& options = {}) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (hasRequest_ && p == requested_) return;
+            requested_ = p;
+            options_ = options;
+            hasRequest_ = true;
+            pending_ = true;
+            stop_ = false;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!finished_) return false;
+        front_ = std::move(finished_);
+        return true;
+    }
+
+    // True while generations are still being run for the latest request.
+    bool Busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_ || searching_;
+    }
+
+    // Nullptr until the first generation lands.
+    const Front* front() const { return front_.get(); }
+    uint64_t generations() const { return generations_.load(); }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_ || searching_; });
+            if (stop_) return;
+            if (pending_) {
+                search_.Reset(requested_, options_);
+                pending_ = false;
+                searching_ = true;
+            }
+            lock.unlock();
+
+            search_.Step(pool_);
+            ++generations_;
+            std::shared_ptr<const Front> front = std::make_shared<const Front>(search_.Snapshot());
+
+            lock.lock();
+            // A request that landed mid-generation makes this front stale.
+            if (!pending_) finished_ = std::move(front);
+            searching_ = !search_.done();
+        }
+    }
+
+    astro_parallel::ThreadPool pool_;
+    Search search_;
+    std::shared_ptr<const Front> front_;
+    std::shared_ptr<const Front> finished_;
+    Problem requested_{};
+    SearchOptions options_{};
+    bool hasRequest_ = false;
+    std::atomic<uint64_t> generations_{0};
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool pending_ = false;
+    bool searching_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_transfer
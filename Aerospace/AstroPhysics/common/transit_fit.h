@@ -0,0 +1,628 @@
+#pragma once
+
+#include "philox.h"
+#include "thread_pool.h"
+#include "transit_model.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Fitting the transit model of transit_model.h to a photometric time series.
+//
+// Photometry keeps the samples sorted by time with prefix sums of w, w y and w y^2
+// (w = 1 / sigma^2). Out of transit the model is the constant baseline, so ChiSquare()
+// takes the whole out-of-transit part from the sums and only evaluates the model in a
+// window around each predicted transit: a 10^5-point light curve with a few per cent of
+// its samples in transit costs a few thousand model points per evaluation.
+//
+// RunTransitFit() first runs Levenberg-Marquardt from the guess (forward-difference
+// Jacobian over the in-window points, accumulated across the shared thread pool), then
+// an affine-invariant ensemble sampler (Goodman & Weare's stretch move, as in emcee)
+// started in a ball sized by the least-squares covariance; each half-ensemble update
+// evaluates its walkers in parallel on the pool. Limb darkening is sampled as Kipping's
+// (q1, q2), which keeps (u1, u2) physical for any point of the unit square.
+// TransitFitter runs that on a background thread and publishes FitSnapshots.
+
+namespace astro_transit {
+
+constexpr int kFitParams = 8;  // t0, period, rp, aRs, b, q1, q2, f0
+using FitVector = std::array<double, kFitParams>;
+
+inline const char* FitParamName(int i) {
+    static const char* const kNames[kFitParams] = {"t0", "P", "Rp/R*", "a/R*", "b", "q1", "q2", "f0"};
+    return kNames[i];
+}
+
+inline TransitParams ToParams(const FitVector& v) {
+    TransitParams params;
+    params.t0 = v[0];
+    params.period = v[1];
+    params.rp = v[2];
+    params.aRs = v[3];
+    params.b = v[4];
+    const double root = std::sqrt(std::max(0.0, v[5]));
+    params.u1 = 2.0 * root * v[6];
+    params.u2 = root * (1.0 - 2.0 * v[6]);
+    params.f0 = v[7];
+    return params;
+}
+
+inline FitVector ToFitVector(const TransitParams& params) {
+    const double sum = params.u1 + params.u2;
+    return {params.t0, params.period, params.rp, params.aRs, params.b, std::clamp(sum * sum, 0.0, 1.0),
+            sum > 0.0 ? std::clamp(params.u1 / (2.0 * sum), 0.0, 1.0) : 0.5, params.f0};
+}
+
+inline bool InFitBounds(const FitVector& v) {
+    return v[1] > 0.0 && v[2] > 1.0e-4 && v[2] < 0.6 && v[3] > 1.05 && v[3] < 500.0 && v[4] >= 0.0 && v[4] < 1.0 + v[2] &&
+           v[5] >= 0.0 && v[5] <= 1.0 && v[6] >= 0.0 && v[6] <= 1.0 && v[7] > 0.0;
+}
+
+inline void ClampToFitBounds(FitVector* v) {
+    FitVector& x = *v;
+    x[1] = std::max(x[1], 1.0e-6);
+    x[2] = std::clamp(x[2], 2.0e-4, 0.59);
+    x[3] = std::clamp(x[3], 1.1, 499.0);
+    x[4] = std::clamp(x[4], 0.0, 0.999 * (1.0 + x[2]));
+    x[5] = std::clamp(x[5], 0.0, 1.0);
+    x[6] = std::clamp(x[6], 0.0, 1.0);
+    x[7] = std::max(x[7], 1.0e-6);
+}
+
+struct Photometry {
+    std::vector<double> t;
+    std::vector<double> flux;
+    std::vector<double> weight;  // 1 / sigma^2
+    double sumW = 0.0, sumWY = 0.0, sumWYY = 0.0;
+
+    size_t size() const { return t.size(); }
+    bool empty() const { return t.empty(); }
+    double span() const { return t.empty() ? 0.0 : t.back() - t.front(); }
+
+    // Sorts by time and rebuilds the sums; call after filling t, flux and weight.
+    void Finalize() {
+        std::vector<size_t> order(t.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return t[a] < t[b]; });
+        std::vector<double> st(t.size()), sf(t.size()), sw(t.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            st[i] = t[order[i]];
+            sf[i] = flux[order[i]];
+            sw[i] = weight[order[i]];
+        }
+        t.swap(st);
+        flux.swap(sf);
+        weight.swap(sw);
+        sumW = sumWY = sumWYY = 0.0;
+        for (size_t i = 0; i < t.size(); ++i) {
+            sumW += weight[i];
+            sumWY += weight[i] * flux[i];
+            sumWYY += weight[i] * flux[i] * flux[i];
+        }
+    }
+};
+
+// Reads "time,flux[,flux_err]" rows. A header row is skipped; columns named time/bjd/t,
+// flux and flux_err/err/sigma are used when present, otherwise the first three columns.
+// A missing error column weights every point by the scatter of the whole series.
+inline bool LoadPhotometryCsv(const std::string& path, Photometry* out, std::string* error) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        *error = "cannot open " + path;
+        return false;
+    }
+    Photometry data;
+    int colT = 0, colF = 1, colE = 2;
+    bool haveErrors = false, first = true;
+    std::vector<double> errors;
+    char line[4096];
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        std::vector<std::string> fields;
+        std::string field;
+        for (const char* c = line; *c != '\0' && *c != '\n' && *c != '\r'; ++c) {
+            if (*c == ',' || *c == '\t' || *c == ';') {
+                fields.push_back(field);
+                field.clear();
+            } else if (*c != '"' && *c != ' ') {
+                field.push_back(*c);
+            }
+        }
+        fields.push_back(field);
+        if (fields.empty() || line[0] == '#') continue;
+        char* end = nullptr;
+        std::strtod(fields[0].c_str(), &end);
+        if (first && end == fields[0].c_str()) {
+            colE = -1;
+            for (int i = 0; i < static_cast<int>(fields.size()); ++i) {
+                const std::string& name = fields[static_cast<size_t>(i)];
+                if (name == "time" || name == "bjd" || name == "t" || name == "TIME") colT = i;
+                if (name == "flux" || name == "FLUX" || name == "pdcsap_flux") colF = i;
+                if (name == "flux_err" || name == "err" || name == "sigma" || name == "FLUX_ERR") colE = i;
+            }
+            first = false;
+            continue;
+        }
+        first = false;
+        const int needed = std::max(colT, colF);
+        if (static_cast<int>(fields.size()) <= needed) continue;
+        const double tv = std::strtod(fields[static_cast<size_t>(colT)].c_str(), &end);
+        if (end == fields[static_cast<size_t>(colT)].c_str()) continue;
+        const double fv = std::strtod(fields[static_cast<size_t>(colF)].c_str(), &end);
+        if (end == fields[static_cast<size_t>(colF)].c_str() || !std::isfinite(fv) || !std::isfinite(tv)) continue;
+        double ev = 0.0;
+        if (colE >= 0 && colE < static_cast<int>(fields.size())) {
+            ev = std::strtod(fields[static_cast<size_t>(colE)].c_str(), &end);
+            if (end != fields[static_cast<size_t>(colE)].c_str() && ev > 0.0) haveErrors = true;
+        }
+        data.t.push_back(tv);
+        data.flux.push_back(fv);
+        errors.push_back(ev);
+    }
+    std::fclose(file);
+    if (data.t.size() < 16) {
+        *error = path + ": fewer than 16 usable rows";
+        return false;
+    }
+
+    double scatter = 0.0;
+    if (!haveErrors) {
+        // Point-to-point scatter is insensitive to the transits and any slow trend.
+        for (size_t i = 1; i < data.flux.size(); ++i) scatter += (data.flux[i] - data.flux[i - 1]) * (data.flux[i] - data.flux[i - 1]);
+        scatter = std::sqrt(scatter / (2.0 * static_cast<double>(data.flux.size() - 1)));
+        if (!(scatter > 0.0)) scatter = 1.0e-3;
+    }
+    data.weight.resize(data.t.size());
+    for (size_t i = 0; i < data.t.size(); ++i) {
+        const double sigma = haveErrors && errors[i] > 0.0 ? errors[i] : scatter;
+        data.weight[i] = sigma > 0.0 ? 1.0 / (sigma * sigma) : 0.0;
+    }
+    data.Finalize();
+    *out = std::move(data);
+    return true;
+}
+
+// `count` evenly spaced samples over `span` of `truth` with Gaussian noise `sigma`.
+inline Photometry SyntheticPhotometry(const TransitParams& truth, size_t count, double span, double sigma, uint64_t seed) {
+    astro_random::PhiloxStream rng(seed);
+    Photometry data;
+    data.t.resize(count);
+    data.flux.resize(count);
+    data.weight.assign(count, 1.0 / (sigma * sigma));
+    for (size_t i = 0; i < count; ++i) data.t[i] = span * static_cast<double>(i) / static_cast<double>(std::max<size_t>(1, count - 1));
+    ModelFlux(truth, data.t.data(), data.flux.data(), count);
+    for (double& f : data.flux) f += sigma * rng.Normal();
+    data.Finalize();
+    return data;
+}
+
+// Calls visit(begin, end) for every run of samples within `halfWindow` of a predicted
+// mid-transit.
+template <typename Visit>
+void ForEachTransitWindow(const TransitParams& params, const Photometry& data, double halfWindow, Visit&& visit) {
+    if (data.empty() || !(params.period > 0.0)) return;
+    const double first = std::ceil((data.t.front() - params.t0 - halfWindow) / params.period);
+    const double last = std::floor((data.t.back() - params.t0 + halfWindow) / params.period);
+    size_t from = 0;
+    for (double epoch = first; epoch <= last; epoch += 1.0) {
+        const double mid = params.t0 + epoch * params.period;
+        const size_t begin = static_cast<size_t>(std::lower_bound(data.t.begin() + static_cast<std::ptrdiff_t>(from), data.t.end(), mid - halfWindow) - data.t.begin());
+        const size_t end = static_cast<size_t>(std::upper_bound(data.t.begin() + static_cast<std::ptrdiff_t>(begin), data.t.end(), mid + halfWindow) - data.t.begin());
+        if (end > begin) visit(begin, end);
+        from = end;
+    }
+}
+
+// Sum of w (y - model)^2 over every sample: the baseline-only sum from the prefix sums,
+// corrected inside the transit windows. Serial; callers parallelise across parameter sets.
+inline double ChiSquare(const TransitParams& params, const Photometry& data) {
+    const double f0 = params.f0;
+    double chi2 = data.sumWYY - 2.0 * f0 * data.sumWY + f0 * f0 * data.sumW;
+    ForEachTransitWindow(params, data, TransitHalfWindow(params), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const double m = ModelFluxAt(params, data.t[i]);
+            const double y = data.flux[i];
+            chi2 += data.weight[i] * ((y - m) * (y - m) - (y - f0) * (y - f0));
+        }
+    });
+    return std::max(0.0, chi2);
+}
+
+struct FitOptions {
+    int maxIterations = 60;  // Levenberg-Marquardt
+    int walkers = 24;        // even, >= 2 * kFitParams
+    int steps = 400;         // ensemble steps, burn-in included
+    int burnIn = 120;
+    uint64_t seed = 0x7a5c0ffee;
+};
+
+struct FitSnapshot {
+    enum class Stage { kIdle, kLeastSquares, kSampling, kDone, kFailed };
+    Stage stage = Stage::kIdle;
+    TransitParams best;
+    FitVector sigma{};        // least-squares errors, replaced by posterior widths once sampled
+    FitVector posteriorMean{};
+    double chi2 = 0.0;
+    size_t samples = 0;       // photometric points
+    int iteration = 0;
+    int iterations = 0;       // of the current stage
+    double acceptance = 0.0;
+    double seconds = 0.0;
+    bool hasPosterior = false;
+    uint64_t version = 0;
+};
+
+namespace detail {
+
+// Solves A x = rhs in place (n x n, row-major) by Gaussian elimination with partial
+// pivoting; false if A is singular.
+inline bool SolveDense(std::vector<double> a, std::vector<double>* rhs, int n) {
+    std::vector<double>& x = *rhs;
+    for (int c = 0; c < n; ++c) {
+        int pivot = c;
+        for (int r = c + 1; r < n; ++r) {
+            if (std::fabs(a[static_cast<size_t>(r * n + c)]) > std::fabs(a[static_cast<size_t>(pivot * n + c)])) pivot = r;
+        }
+        if (std::fabs(a[static_cast<size_t>(pivot * n + c)]) < 1.0e-300) return false;
+        if (pivot != c) {
+            for (int k = 0; k < n; ++k) std::swap(a[static_cast<size_t>(c * n + k)], a[static_cast<size_t>(pivot * n + k)]);
+            std::swap(x[static_cast<size_t>(c)], x[static_cast<size_t>(pivot)]);
+        }
+        for (int r = c + 1; r < n; ++r) {
+            const double f = a[static_cast<size_t>(r * n + c)] / a[static_cast<size_t>(c * n + c)];
+            for (int k = c; k < n; ++k) a[static_cast<size_t>(r * n + k)] -= f * a[static_cast<size_t>(c * n + k)];
+            x[static_cast<size_t>(r)] -= f * x[static_cast<size_t>(c)];
+        }
+    }
+    for (int r = n - 1; r >= 0; --r) {
+        double v = x[static_cast<size_t>(r)];
+        for (int k = r + 1; k < n; ++k) v -= a[static_cast<size_t>(r * n + k)] * x[static_cast<size_t>(k)];
+        x[static_cast<size_t>(r)] = v / a[static_cast<size_t>(r * n + r)];
+    }
+    return true;
+}
+
+// J^T J and J^T r of the weighted residuals at v. Samples outside the (widened) transit
+// windows only depend on f0 and come from the prefix sums.
+inline void NormalEquations(const FitVector& v, const Photometry& data, std::vector<double>* jtj, std::vector<double>* jtr) {
+    const TransitParams params = ToParams(v);
+    std::array<TransitParams, kFitParams - 1> shifted;
+    std::array<double, kFitParams - 1> steps{};
+    // Forward-difference steps: t0 by a small fraction of the transit, the rest relative
+    // to the value with a floor for parameters that may sit at zero.
+    static constexpr std::array<double, kFitParams - 1> kFloor = {0.0, 0.0, 1.0e-2, 1.0, 1.0e-1, 1.0e-1, 1.0e-1};
+    for (int j = 0; j < kFitParams - 1; ++j) {
+        FitVector w = v;
+        steps[static_cast<size_t>(j)] = j == 0 ? 1.0e-4 * TransitHalfWindow(params)
+                                               : 1.0e-6 * std::max(std::fabs(v[static_cast<size_t>(j)]), kFloor[static_cast<size_t>(j)]);
+        w[static_cast<size_t>(j)] += steps[static_cast<size_t>(j)];
+        shifted[static_cast<size_t>(j)] = ToParams(w);
+    }
+
+    std::vector<std::pair<size_t, size_t>> runs;
+    ForEachTransitWindow(params, data, 1.25 * TransitHalfWindow(params) + 4.0 * steps[0], [&](size_t begin, size_t end) {
+        runs.emplace_back(begin, end);
+    });
+
+    constexpr int n = kFitParams;
+    astro_parallel::ThreadPool& pool = astro_parallel::SharedPool();
+    const int chunks = std::max(1, std::min(static_cast<int>(runs.size()), 4 * pool.size()));
+    std::vector<std::array<double, n * n + n + 2>> partial(static_cast<size_t>(chunks));
+    pool.Run(chunks, [&](int c) {
+        std::array<double, n * n + n + 2>& acc = partial[static_cast<size_t>(c)];
+        acc.fill(0.0);
+        std::array<double, n> jac{};
+        for (size_t r = static_cast<size_t>(c); r < runs.size(); r += static_cast<size_t>(chunks)) {
+            for (size_t i = runs[r].first; i < runs[r].second; ++i) {
+                const double ti = data.t[i];
+                const double m = ModelFluxAt(params, ti);
+                for (int j = 0; j < n - 1; ++j) {
+                    jac[static_cast<size_t>(j)] = (ModelFluxAt(shifted[static_cast<size_t>(j)], ti) - m) / steps[static_cast<size_t>(j)];
+                }
+                jac[n - 1] = m / params.f0;
+                const double w = data.weight[i];
+                const double resid = data.flux[i] - m;
+                for (int j = 0; j < n; ++j) {
+                    for (int k = 0; k <= j; ++k) acc[static_cast<size_t>(j * n + k)] += w * jac[static_cast<size_t>(j)] * jac[static_cast<size_t>(k)];
+                    acc[static_cast<size_t>(n * n + j)] += w * jac[static_cast<size_t>(j)] * resid;
+                }
+                acc[n * n + n] += w;
+                acc[n * n + n + 1] += w * data.flux[i];
+            }
+        }
+    });
+
+    jtj->assign(n * n, 0.0);
+    jtr->assign(n, 0.0);
+    double inW = 0.0, inWY = 0.0;
+    for (const auto& acc : partial) {
+        for (int j = 0; j < n; ++j) {
+            for (int k = 0; k <= j; ++k) (*jtj)[static_cast<size_t>(j * n + k)] += acc[static_cast<size_t>(j * n + k)];
+            (*jtr)[static_cast<size_t>(j)] += acc[static_cast<size_t>(n * n + j)];
+        }
+        inW += acc[n * n + n];
+        inWY += acc[n * n + n + 1];
+    }
+    // Out of the windows: model f0, d model / d f0 = 1.
+    (*jtj)[n * n - 1] += data.sumW - inW;
+    (*jtr)[n - 1] += (data.sumWY - inWY) - params.f0 * (data.sumW - inW);
+    for (int j = 0; j < n; ++j) {
+        for (int k = j + 1; k < n; ++k) (*jtj)[static_cast<size_t>(j * n + k)] = (*jtj)[static_cast<size_t>(k * n + j)];
+    }
+}
+
+}  // namespace detail
+
+// Least squares then ensemble sampling from `guess`. progress(snapshot) is called after
+// every iteration and step; returning false cancels the fit. The returned snapshot holds
+// the best parameters found and, unless cancelled early, posterior means and widths.
+template <typename Progress>
+FitSnapshot RunTransitFit(const Photometry& data, const TransitParams& guess, const FitOptions& options, Progress&& progress) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    FitSnapshot snap;
+    snap.samples = data.size();
+    const auto elapsed = [&]() { return std::chrono::duration<double>(Clock::now() - start).count(); };
+    constexpr int n = kFitParams;
+
+    FitVector v = ToFitVector(guess);
+    ClampToFitBounds(&v);
+    double chi2 = ChiSquare(ToParams(v), data);
+    double lambda = 1.0e-3;
+    snap.stage = FitSnapshot::Stage::kLeastSquares;
+    snap.iterations = options.maxIterations;
+    std::vector<double> jtj, jtr;
+    for (int it = 0; it < options.maxIterations; ++it) {
+        detail::NormalEquations(v, data, &jtj, &jtr);
+        bool improved = false;
+        for (int tries = 0; tries < 12 && !improved; ++tries) {
+            std::vector<double> a = jtj;
+            double maxDiag = 0.0;
+            for (int j = 0; j < n; ++j) maxDiag = std::max(maxDiag, a[static_cast<size_t>(j * n + j)]);
+            for (int j = 0; j < n; ++j) a[static_cast<size_t>(j * n + j)] = a[static_cast<size_t>(j * n + j)] * (1.0 + lambda) + 1.0e-12 * maxDiag;
+            std::vector<double> step = jtr;
+            if (!detail::SolveDense(a, &step, n)) {
+                lambda *= 10.0;
+                continue;
+            }
+            FitVector trial = v;
+            for (int j = 0; j < n; ++j) trial[static_cast<size_t>(j)] += step[static_cast<size_t>(j)];
+            ClampToFitBounds(&trial);
+            const double trialChi2 = ChiSquare(ToParams(trial), data);
+            if (trialChi2 < chi2) {
+                improved = chi2 - trialChi2 > 1.0e-9 * chi2;
+                v = trial;
+                chi2 = trialChi2;
+                lambda = std::max(1.0e-9, lambda * 0.2);
+                if (!improved) break;
+            } else {
+                lambda *= 10.0;
+            }
+        }
+        snap.best = ToParams(v);
+        snap.chi2 = chi2;
+        snap.iteration = it + 1;
+        snap.seconds = elapsed();
+        ++snap.version;
+        if (!progress(snap)) return snap;
+        if (!improved) break;
+    }
+
+    // Parameter errors from the inverse of J^T J at the optimum, lightly regularised: a
+    // parameter pinned at a bound (q1 = 0 leaves q2 unconstrained) makes it singular.
+    detail::NormalEquations(v, data, &jtj, &jtr);
+    double maxDiag = 0.0;
+    for (int j = 0; j < n; ++j) maxDiag = std::max(maxDiag, jtj[static_cast<size_t>(j * n + j)]);
+    for (int j = 0; j < n; ++j) jtj[static_cast<size_t>(j * n + j)] += 1.0e-10 * maxDiag;
+    FitVector sigma{};
+    for (int j = 0; j < n; ++j) {
+        std::vector<double> e(n, 0.0);
+        e[static_cast<size_t>(j)] = 1.0;
+        const bool ok = detail::SolveDense(jtj, &e, n);
+        sigma[static_cast<size_t>(j)] = ok && e[static_cast<size_t>(j)] > 0.0 ? std::sqrt(e[static_cast<size_t>(j)]) : 0.0;
+    }
+    snap.sigma = sigma;
+    // The walkers start in a ball no narrower than a small fraction of each scale, so a
+    // degenerate covariance cannot freeze the ensemble.
+    static constexpr FitVector kBallFloor = {0.0, 0.0, 1.0e-4, 1.0e-3, 1.0e-3, 1.0e-3, 1.0e-3, 1.0e-6};
+    FitVector ball{};
+    for (int j = 0; j < n; ++j) {
+        const double floor = j == 0 ? 1.0e-3 * TransitHalfWindow(ToParams(v)) : j == 1 ? 1.0e-7 * v[1] : kBallFloor[static_cast<size_t>(j)];
+        ball[static_cast<size_t>(j)] = std::max(sigma[static_cast<size_t>(j)], floor);
+    }
+
+    // Ensemble sampler.
+    const int walkers = std::max(2 * n, options.walkers + (options.walkers & 1));
+    const int half = walkers / 2;
+    std::vector<FitVector> position(static_cast<size_t>(walkers));
+    std::vector<double> logProb(static_cast<size_t>(walkers));
+    std::vector<astro_random::PhiloxStream> rngs;
+    rngs.reserve(static_cast<size_t>(walkers));
+    for (int w = 0; w < walkers; ++w) rngs.emplace_back(options.seed, static_cast<uint32_t>(w));
+    const auto logProbability = [&](const FitVector& x) {
+        return InFitBounds(x) ? -0.5 * ChiSquare(ToParams(x), data) : -std::numeric_limits<double>::infinity();
+    };
+    for (int w = 0; w < walkers; ++w) {
+        FitVector& x = position[static_cast<size_t>(w)];
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            for (int j = 0; j < n; ++j) x[static_cast<size_t>(j)] = v[static_cast<size_t>(j)] + ball[static_cast<size_t>(j)] * rngs[static_cast<size_t>(w)].Normal();
+            if (InFitBounds(x)) break;
+            x = v;
+        }
+    }
+    astro_parallel::ThreadPool& pool = astro_parallel::SharedPool();
+    pool.Run(walkers, [&](int w) { logProb[static_cast<size_t>(w)] = logProbability(position[static_cast<size_t>(w)]); });
+
+    snap.stage = FitSnapshot::Stage::kSampling;
+    snap.iterations = options.steps;
+    FitVector bestX = v;
+    double bestLogProb = -0.5 * chi2;
+    FitVector sum{}, sumSq{};
+    size_t kept = 0, accepted = 0, proposed = 0;
+    std::vector<uint8_t> acceptFlag(static_cast<size_t>(walkers));
+    for (int step = 0; step < options.steps; ++step) {
+        for (int side = 0; side < 2; ++side) {
+            const int self = side * half, other = (1 - side) * half;
+            pool.Run(half, [&](int i) {
+                const size_t w = static_cast<size_t>(self + i);
+                astro_random::PhiloxStream& rng = rngs[w];
+                const FitVector& partner = position[static_cast<size_t>(other + rng.Range(0, half - 1))];
+                const double u = rng.Uniform();
+                const double z = (1.0 + u) * (1.0 + u) / 2.0;  // g(z) ~ 1 / sqrt(z) on [1/2, 2]
+                FitVector proposal;
+                for (int j = 0; j < n; ++j) {
+                    proposal[static_cast<size_t>(j)] = partner[static_cast<size_t>(j)] + z * (position[w][static_cast<size_t>(j)] - partner[static_cast<size_t>(j)]);
+                }
+                const double lp = logProbability(proposal);
+                const double logAccept = (n - 1) * std::log(z) + lp - logProb[w];
+                acceptFlag[w] = 0;
+                if (std::isfinite(lp) && std::log(std::max(1.0e-300, static_cast<double>(rng.Uniform()))) < logAccept) {
+                    position[w] = proposal;
+                    logProb[w] = lp;
+                    acceptFlag[w] = 1;
+                }
+            });
+            for (int i = 0; i < half; ++i) accepted += acceptFlag[static_cast<size_t>(self + i)];
+            proposed += static_cast<size_t>(half);
+        }
+        for (int w = 0; w < walkers; ++w) {
+            if (logProb[static_cast<size_t>(w)] > bestLogProb) {
+                bestLogProb = logProb[static_cast<size_t>(w)];
+                bestX = position[static_cast<size_t>(w)];
+            }
+            if (step < options.burnIn) continue;
+            for (int j = 0; j < n; ++j) {
+                const double x = position[static_cast<size_t>(w)][static_cast<size_t>(j)];
+                sum[static_cast<size_t>(j)] += x;
+                sumSq[static_cast<size_t>(j)] += x * x;
+            }
+            ++kept;
+        }
+        snap.best = ToParams(bestX);
+        snap.chi2 = -2.0 * bestLogProb;
+        snap.iteration = step + 1;
+        snap.acceptance = static_cast<double>(accepted) / static_cast<double>(std::max<size_t>(1, proposed));
+        if (kept > 1) {
+            for (int j = 0; j < n; ++j) {
+                const double mean = sum[static_cast<size_t>(j)] / static_cast<double>(kept);
+                snap.posteriorMean[static_cast<size_t>(j)] = mean;
+                snap.sigma[static_cast<size_t>(j)] = std::sqrt(std::max(0.0, sumSq[static_cast<size_t>(j)] / static_cast<double>(kept) - mean * mean));
+            }
+            snap.hasPosterior = true;
+        }
+        snap.seconds = elapsed();
+        ++snap.version;
+        if (!progress(snap)) return snap;
+    }
+    snap.stage = FitSnapshot::Stage::kDone;
+    snap.seconds = elapsed();
+    ++snap.version;
+    progress(snap);
+    return snap;
+}
+
+// Runs RunTransitFit() on a worker thread. Start() cancels any running fit and begins a
+// new one; Snapshot() copies the latest progress. The photometry must stay alive and
+// unchanged until the fit is done or Stop() returns. The fit uses the shared thread
+// pool, so the caller should not run passes on it meanwhile.
+class TransitFitter {
+  public:
+    TransitFitter() = default;
+    ~TransitFitter() { Stop(); }
+    TransitFitter(const TransitFitter&) = delete;
+    TransitFitter& operator=(const TransitFitter&) = delete;
+
+    void Start(const Photometry* data, const TransitParams& guess, const FitOptions& options = FitOptions{}) {
+        cancel_.store(true);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pendingData_ = data;
+            pendingGuess_ = guess;
+            pendingOptions_ = options;
+            pending_ = true;
+            stop_ = false;
+            latest_ = FitSnapshot{};
+            latest_.stage = FitSnapshot::Stage::kLeastSquares;
+            latest_.best = guess;
+            latest_.version = ++generation_ << 32;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    FitSnapshot Snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return latest_;
+    }
+
+    bool Busy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_ || running_;
+    }
+
+    void Stop() {
+        cancel_.store(true);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            const Photometry* data = pendingData_;
+            const TransitParams guess = pendingGuess_;
+            const FitOptions options = pendingOptions_;
+            const uint64_t generation = generation_;
+            pending_ = false;
+            running_ = true;
+            cancel_.store(false);
+            lock.unlock();
+
+            RunTransitFit(*data, guess, options, [&](const FitSnapshot& snap) {
+                std::lock_guard<std::mutex> guard(mutex_);
+                if (generation_ != generation) return false;
+                latest_ = snap;
+                latest_.version |= generation << 32;
+                return !cancel_.load();
+            });
+
+            lock.lock();
+            running_ = false;
+        }
+    }
+
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> cancel_{false};
+    const Photometry* pendingData_ = nullptr;
+    TransitParams pendingGuess_;
+    FitOptions pendingOptions_;
+    FitSnapshot latest_;
+    uint64_t generation_ = 0;
+    bool pending_ = false;
+    bool running_ = false;
+    bool stop_ = false;
+};
+
+}  // namespace astro_transit
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Mandel & Agol (2002) transit light curve of a star with quadratic limb darkening,
+// I(mu) / I(1) = 1 - u1 (1 - mu) - u2 (1 - mu)^2, occulted by an opaque planet of radius
+// p (in stellar radii) at projected centre separation z (stellar radii). The complete
+// elliptic integrals come from Bulirsch's cel, so a limb-darkened point costs two short
+// AGM-style loops; samples outside the transit return before any of it.
+
+namespace astro_transit {
+
+namespace detail {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Bulirsch's general complete elliptic integral
+//   cel(kc, p, a, b) = int_0^pi/2 (a cos^2 + b sin^2) / ((cos^2 + p sin^2) sqrt(cos^2 + kc^2 sin^2)),
+// which gives K, E and Pi from one quadratically converging loop each. kc != 0.
+inline double Cel(double kc, double p, double a, double b) {
+    constexpr double kTolerance = 1.0e-8;  // error is about the square of this
+    double qc = std::fabs(kc), e = qc, em = 1.0;
+    if (p > 0.0) {
+        p = std::sqrt(p);
+        b /= p;
+    } else {
+        double f = qc * qc;
+        double q = 1.0 - f;
+        const double g = 1.0 - p;
+        f -= p;
+        q *= b - a * p;
+        p = std::sqrt(f / g);
+        a = (a - b) / g;
+        b = -q / (g * g * p) + a * p;
+    }
+    for (int i = 0; i < 64; ++i) {
+        const double f = a;
+        a += b / p;
+        double g = e / p;
+        b += f * g;
+        b += b;
+        p += g;
+        g = em;
+        em += qc;
+        if (std::fabs(g - qc) <= g * kTolerance) break;
+        qc = 2.0 * std::sqrt(e);
+        e = qc * em;
+    }
+    return 0.5 * kPi * (b + a * em) / (em * (em + p));
+}
+
+// cK K(k) + cE E(k) with modulus k, in one cel call.
+inline double EllipticKE(double k, double cK, double cE) {
+    const double kc = std::sqrt(std::max(1.0e-300, 1.0 - k * k));
+    return Cel(kc, 1.0, cK + cE, cK + cE * kc * kc);
+}
+
+// Pi(n, k) with the characteristic convention 1 / (1 - n sin^2).
+inline double EllipticPi(double n, double k) {
+    const double kc = std::sqrt(std::max(1.0e-300, 1.0 - k * k));
+    return Cel(kc, 1.0 - n, 1.0, 1.0);
+}
+
+}  // namespace detail
+
+// Relative flux (1 out of transit) for separation z and radius ratio p; the planet is
+// assumed in front of the star. Cases and notation follow Mandel & Agol's Table 1.
+inline double OccultQuad(double z, double p, double u1, double u2) {
+    using detail::kPi;
+    z = std::fabs(z);
+    if (p <= 0.0 || z >= 1.0 + p) return 1.0;
+    if (p >= 1.0 && z <= p - 1.0) return 0.0;
+
+    constexpr double kTouch = 1.0e-7;  // |z - p|, |z - (1 - p)| and z below this use the limit forms
+    const double p2 = p * p, z2 = z * z;
+    const double a = (z - p) * (z - p), b = (z + p) * (z + p), q = p2 - z2;
+    constexpr double kMaxModulus = 1.0 - 1.0e-12;  // K and Pi diverge together at k = 1; their sum does not
+    const bool partial = z > std::fabs(1.0 - p);
+
+    double lambdaE, eta;
+    const double eta2 = 0.5 * p2 * (p2 + 2.0 * z2);
+    if (partial) {
+        const double kappa0 = std::acos(std::clamp((p2 + z2 - 1.0) / (2.0 * p * z), -1.0, 1.0));
+        const double kappa1 = std::acos(std::clamp((1.0 - p2 + z2) / (2.0 * z), -1.0, 1.0));
+        const double root = std::sqrt(std::max(0.0, (1.0 - a) * (b - 1.0)));
+        lambdaE = (p2 * kappa0 + kappa1 - 0.5 * std::sqrt(std::max(0.0, 4.0 * z2 - (1.0 + z2 - p2) * (1.0 + z2 - p2)))) / kPi;
+        eta = (kappa1 + 2.0 * eta2 * kappa0 - 0.25 * (1.0 + 5.0 * p2 + z2) * root) / (2.0 * kPi);
+    } else {
+        lambdaE = p2;
+        eta = eta2;
+    }
+
+    double lambdaD;
+    if (z < kTouch && p < 1.0) {
+        lambdaD = -2.0 / 3.0 * std::pow(1.0 - p2, 1.5);  // lambda_6
+    } else if (std::fabs(z - p) < kTouch) {
+        if (std::fabs(p - 0.5) < kTouch) {
+            lambdaD = 1.0 / 3.0 - 4.0 / (9.0 * kPi);
+            eta = 3.0 / 32.0;
+        } else if (p < 0.5) {
+            const double k = 2.0 * p;  // lambda_4
+            lambdaD = 1.0 / 3.0 + 2.0 / (9.0 * kPi) * detail::EllipticKE(k, 1.0 - 4.0 * p2, 4.0 * (2.0 * p2 - 1.0));
+        } else {
+            const double k = 0.5 / p;  // lambda_3
+            lambdaD = 1.0 / 3.0 + detail::EllipticKE(k, -(1.0 - 4.0 * p2) * (3.0 - 8.0 * p2) / (9.0 * kPi * p),
+                                                      16.0 * p / (9.0 * kPi) * (2.0 * p2 - 1.0));
+        }
+    } else if (p < 0.5 && std::fabs(z - (1.0 - p)) < kTouch) {
+        lambdaD = 2.0 / (3.0 * kPi) * std::acos(1.0 - 2.0 * p) -
+                  4.0 / (9.0 * kPi) * (3.0 + 2.0 * p - 8.0 * p2) * std::sqrt(p * (1.0 - p));  // lambda_5
+    } else if (partial) {
+        const double k = std::min(kMaxModulus, std::sqrt((1.0 - a) / (4.0 * z * p)));  // lambda_1
+        lambdaD = (detail::EllipticKE(k, (1.0 - b) * (2.0 * b + a - 3.0) - 3.0 * q * (b - 2.0), 4.0 * p * z * (z2 + 7.0 * p2 - 4.0)) -
+                   3.0 * (q / a) * detail::EllipticPi((a - 1.0) / a, k)) /
+                  (9.0 * kPi * std::sqrt(p * z));
+    } else {
+        const double k = std::min(kMaxModulus, std::sqrt(4.0 * z * p / (1.0 - a)));  // lambda_2, modulus 1 / k of the paper
+        lambdaD = 2.0 / (9.0 * kPi * std::sqrt(1.0 - a)) *
+                  (detail::EllipticKE(k, 1.0 - 5.0 * z2 + p2 + q * q, (1.0 - a) * (z2 + 7.0 * p2 - 4.0)) -
+                   3.0 * (q / a) * detail::EllipticPi((a - b) / a, k));
+    }
+
+    const double omega = 1.0 - u1 / 3.0 - u2 / 6.0;
+    const double inside = p > z + kTouch ? 2.0 / 3.0 : 0.0;  // the z = p limit forms already include it
+    return 1.0 - ((1.0 - u1 - 2.0 * u2) * lambdaE + (u1 + 2.0 * u2) * (lambdaD + inside) + u2 * eta) / omega;
+}
+
+// Circular-orbit transit of one planet. Times are in the light curve's own unit.
+struct TransitParams {
+    double t0 = 0.0;      // mid-transit time
+    double period = 1.0;
+    double rp = 0.1;      // planet radius / stellar radius
+    double aRs = 10.0;    // semi-major axis / stellar radius
+    double b = 0.3;       // impact parameter, aRs cos(inclination)
+    double u1 = 0.4;      // quadratic limb darkening
+    double u2 = 0.25;
+    double f0 = 1.0;      // out-of-transit flux
+};
+
+// Largest |t - t_mid| at which the planet can still touch the disk, capped at a quarter
+// period so every sample inside is on the near side of the orbit.
+inline double TransitHalfWindow(const TransitParams& params) {
+    const double s = (1.0 + params.rp) / std::max(params.aRs, 1.0e-9);
+    return s >= 1.0 ? 0.25 * params.period : std::asin(s) / (2.0 * detail::kPi) * params.period;
+}
+
+// Projected separation in stellar radii, or a value past 1 + rp when the planet is
+// behind the star.
+inline double SeparationAt(const TransitParams& params, double t) {
+    const double phase = 2.0 * detail::kPi * (t - params.t0) / params.period;
+    const double c = std::cos(phase), s = std::sin(phase);
+    if (c <= 0.0) return 2.0 + params.rp;
+    const double cosInc = params.b / std::max(params.aRs, 1.0e-9);
+    return params.aRs * std::sqrt(s * s + cosInc * cosInc * c * c);
+}
+
+inline double ModelFluxAt(const TransitParams& params, double t) {
+    return params.f0 * OccultQuad(SeparationAt(params, t), params.rp, params.u1, params.u2);
+}
+
+// out[i] = model flux at t[i]. Separations are computed in one tight pass; only samples
+// that overlap the disk pay for the occultation integrals.
+inline void ModelFlux(const TransitParams& params, const double* t, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = SeparationAt(params, t[i]);
+    const double contact = 1.0 + params.rp;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = out[i] < contact ? params.f0 * OccultQuad(out[i], params.rp, params.u1, params.u2) : params.f0;
+    }
+}
+
+}  // namespace astro_transit
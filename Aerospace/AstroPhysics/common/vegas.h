@@ -0,0 +1,233 @@
+#pragma once
+
+#include "philox.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// VEGAS adaptive importance sampling (Lepage 1978) over the unit hypercube.
+//
+// Each axis carries a piecewise-uniform density made of `bins` variable-width bins. A
+// point is drawn by picking a bin uniformly and a position inside it, so the sampling
+// density is 1 / (bins * width) and the weight is its inverse. After every iteration the
+// bins are moved so each one carries an equal share of the (smoothed, damped) squared
+// integrand along that axis, and the grid follows the peaks. Iterations are combined
+// with inverse-variance weights into a running estimate, and chi^2 per degree of freedom
+// says whether they agree.
+//
+// An iteration is split into a fixed number of tasks on a pool. Every task has its own
+// Philox stream keyed by (seed, iteration, task) and private accumulators, so results
+// do not depend on the thread count. Points are handed to the integrand in SoA batches,
+// letting it evaluate a whole batch with straight-line loops.
+
+namespace astro_mc {
+
+constexpr int kMaxDimensions = 8;
+
+struct VegasOptions {
+    int bins = 50;
+    int callsPerIteration = 16384;
+    double alpha = 1.5;  // grid damping; 0 freezes the grid
+    int tasks = 16;
+    uint64_t seed = 0x5e6a5u;
+};
+
+// One batch of points: x[d][i] in (0, 1) for d < dims. The integrand writes f[i].
+struct VegasBatch {
+    int count = 0;
+    int dims = 0;
+    const double* x[kMaxDimensions] = {};
+    double* f = nullptr;
+};
+
+struct VegasEstimate {
+    double value = 0.0;
+    double error = 0.0;
+    double chi2PerDof = 0.0;
+    int iterations = 0;
+    int64_t calls = 0;
+
+    double relativeError() const { return value != 0.0 ? error / std::fabs(value) : 0.0; }
+};
+
+class VegasIntegrator {
+  public:
+    static constexpr int kBatch = 256;
+
+    VegasIntegrator(int dims, const VegasOptions& options = VegasOptions{}) : options_(options) {
+        dims_ = std::clamp(dims, 1, kMaxDimensions);
+        options_.bins = std::max(2, options_.bins);
+        options_.tasks = std::max(1, options_.tasks);
+        ResetGrid();
+    }
+
+    int dims() const { return dims_; }
+
+    // Uniform grid and no history.
+    void ResetGrid() {
+        edges_.assign(static_cast<size_t>(dims_) * (options_.bins + 1), 0.0);
+        for (int d = 0; d < dims_; ++d) {
+            for (int i = 0; i <= options_.bins; ++i) Edge(d, i) = static_cast<double>(i) / options_.bins;
+        }
+        ResetEstimate();
+        iteration_ = 0;
+    }
+
+    // Forgets accumulated iterations but keeps the adapted grid, e.g. to warm-start a
+    // neighbouring integrand.
+    void ResetEstimate() {
+        sumWeighted_ = sumWeights_ = sumSquaresWeighted_ = 0.0;
+        estimate_ = VegasEstimate{};
+    }
+
+    const VegasEstimate& estimate() const { return estimate_; }
+
+    // One iteration: sample, fold the result into the estimate when `accumulate`, and
+    // refine the grid. `integrand(const VegasBatch&)` must be safe to call concurrently.
+    template <typename Integrand>
+    void Iterate(const Integrand& integrand, astro_parallel::ThreadPool& pool, bool accumulate = true) {
+        const int bins = options_.bins;
+        const int tasks = options_.tasks;
+        const int64_t calls = std::max<int64_t>(tasks, options_.callsPerIteration);
+        lanes_.resize(static_cast<size_t>(tasks));
+        const uint64_t iteration = iteration_++;
+        pool.Run(tasks, [&](int task) {
+            Lane& lane = lanes_[static_cast<size_t>(task)];
+            lane.sum = lane.sumSquares = 0.0;
+            lane.binSquares.assign(static_cast<size_t>(dims_) * bins, 0.0);
+            astro_random::PhiloxStream rng(astro_random::SeedKey(options_.seed), static_cast<uint32_t>(iteration),
+                                           static_cast<uint32_t>(iteration >> 32), static_cast<uint32_t>(task));
+            const int64_t begin = calls * task / tasks, end = calls * (task + 1) / tasks;
+            VegasBatch batch;
+            batch.dims = dims_;
+            for (int d = 0; d < dims_; ++d) batch.x[d] = lane.x[static_cast<size_t>(d)].data();
+            batch.f = lane.f.data();
+            for (int64_t start = begin; start < end; start += kBatch) {
+                const int n = static_cast<int>(std::min<int64_t>(kBatch, end - start));
+                for (int i = 0; i < n; ++i) lane.weight[static_cast<size_t>(i)] = 1.0;
+                for (int d = 0; d < dims_; ++d) {
+                    double* x = lane.x[static_cast<size_t>(d)].data();
+                    int* bin = lane.bin[static_cast<size_t>(d)].data();
+                    for (int i = 0; i < n; ++i) {
+                        // One 32-bit draw picks the bin and the position inside it.
+                        const double y = (static_cast<double>(rng.Bits()) + 0.5) * (1.0 / 4294967296.0) * bins;
+                        const int b = std::min(bins - 1, static_cast<int>(y));
+                        const double lo = Edge(d, b), width = Edge(d, b + 1) - lo;
+                        x[i] = lo + (y - b) * width;
+                        bin[i] = b;
+                        lane.weight[static_cast<size_t>(i)] *= width * bins;
+                    }
+                }
+                batch.count = n;
+                integrand(batch);
+                for (int i = 0; i < n; ++i) {
+                    const double v = lane.f[static_cast<size_t>(i)] * lane.weight[static_cast<size_t>(i)];
+                    const double v2 = std::isfinite(v) ? v * v : 0.0;
+                    lane.sum += std::isfinite(v) ? v : 0.0;
+                    lane.sumSquares += v2;
+                    for (int d = 0; d < dims_; ++d) {
+                        lane.binSquares[static_cast<size_t>(d) * bins + lane.bin[static_cast<size_t>(d)][static_cast<size_t>(i)]] += v2;
+                    }
+                }
+            }
+        });
+
+        double sum = 0.0, sumSquares = 0.0;
+        std::vector<double> binSquares(static_cast<size_t>(dims_) * bins, 0.0);
+        for (const Lane& lane : lanes_) {
+            sum += lane.sum;
+            sumSquares += lane.sumSquares;
+            for (size_t i = 0; i < binSquares.size(); ++i) binSquares[i] += lane.binSquares[i];
+        }
+        const double n = static_cast<double>(calls);
+        const double mean = sum / n;
+        const double variance = std::max((sumSquares / n - mean * mean) / (n - 1.0), 1.0e-300 + 1.0e-28 * mean * mean);
+        if (accumulate) {
+            const double w = 1.0 / variance;
+            sumWeighted_ += w * mean;
+            sumWeights_ += w;
+            sumSquaresWeighted_ += w * mean * mean;
+            estimate_.iterations += 1;
+            estimate_.calls += calls;
+            estimate_.value = sumWeighted_ / sumWeights_;
+            estimate_.error = std::sqrt(1.0 / sumWeights_);
+            estimate_.chi2PerDof = estimate_.iterations > 1
+                                       ? std::max(0.0, sumSquaresWeighted_ - estimate_.value * estimate_.value * sumWeights_) /
+                                             (estimate_.iterations - 1)
+                                       : 0.0;
+        }
+        if (options_.alpha > 0.0) Refine(binSquares);
+    }
+
+  private:
+    struct Lane {
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        std::vector<double> binSquares;
+        std::array<std::array<double, kBatch>, kMaxDimensions> x{};
+        std::array<std::array<int, kBatch>, kMaxDimensions> bin{};
+        std::array<double, kBatch> weight{};
+        std::array<double, kBatch> f{};
+    };
+
+    double& Edge(int d, int i) { return edges_[static_cast<size_t>(d) * (options_.bins + 1) + i]; }
+    double Edge(int d, int i) const { return edges_[static_cast<size_t>(d) * (options_.bins + 1) + i]; }
+
+    // Lepage's rebinning: smooth the per-bin importance, compress its dynamic range
+    // with ((1 - r) / ln(1 / r))^alpha, then place new edges at equal cumulative shares.
+    void Refine(const std::vector<double>& binSquares) {
+        const int bins = options_.bins;
+        std::vector<double> importance(static_cast<size_t>(bins)), newEdges(static_cast<size_t>(bins) + 1);
+        for (int d = 0; d < dims_; ++d) {
+            const double* raw = binSquares.data() + static_cast<size_t>(d) * bins;
+            double total = 0.0;
+            for (int i = 0; i < bins; ++i) {
+                const double left = raw[std::max(0, i - 1)], right = raw[std::min(bins - 1, i + 1)];
+                const double smooth = (i == 0 || i == bins - 1) ? 0.5 * (raw[i] + (i == 0 ? right : left)) : (left + raw[i] + right) / 3.0;
+                importance[static_cast<size_t>(i)] = smooth;
+                total += smooth;
+            }
+            if (!(total > 0.0)) continue;
+            double share = 0.0;
+            for (int i = 0; i < bins; ++i) {
+                const double r = importance[static_cast<size_t>(i)] / total;
+                const double m = r > 0.0 && r < 1.0 ? std::pow((1.0 - r) / std::log(1.0 / r), options_.alpha) : (r >= 1.0 ? 1.0 : 0.0);
+                importance[static_cast<size_t>(i)] = m;
+                share += m;
+            }
+            if (!(share > 0.0)) continue;
+            share /= bins;
+            newEdges[0] = 0.0;
+            newEdges[static_cast<size_t>(bins)] = 1.0;
+            int old = 0;
+            double carried = 0.0;  // importance left in bin `old` before the next cut
+            double filled = importance[0];
+            for (int i = 1; i < bins; ++i) {
+                carried += share;
+                while (carried > filled && old < bins - 1) {
+                    carried -= filled;
+                    filled = importance[static_cast<size_t>(++old)];
+                }
+                const double lo = Edge(d, old), hi = Edge(d, old + 1);
+                newEdges[static_cast<size_t>(i)] = filled > 0.0 ? lo + (hi - lo) * std::min(1.0, carried / filled) : hi;
+            }
+            for (int i = 0; i <= bins; ++i) Edge(d, i) = newEdges[static_cast<size_t>(i)];
+        }
+    }
+
+    VegasOptions options_;
+    int dims_ = 1;
+    std::vector<double> edges_;
+    std::vector<Lane> lanes_;
+    uint64_t iteration_ = 0;
+    double sumWeighted_ = 0.0;
+    double sumWeights_ = 0.0;
+    double sumSquaresWeighted_ = 0.0;
+    VegasEstimate estimate_;
+};
+
+}  // namespace astro_mc
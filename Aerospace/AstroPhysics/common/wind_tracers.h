@@ -0,0 +1,266 @@
+#pragma once
+
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace astro_render {
+
+// Wind tracers on a sphere that live entirely on the GPU. Each tracer is one texel of a
+// float state texture, (lat, lon, age, life). Advect() renders the next state into the
+// other texture of a ping-pong pair: an RK2 step through a longitude-latitude wind
+// texture whose r, g channels hold eastward and northward speed in sphere radii per time
+// unit (the layout of astro_weather::EquirectBaker), with respawn at a random point when
+// a tracer's life runs out. Draw() expands every tracer into a wind-aligned streak in
+// the vertex shader from gl_VertexID, so no per-tracer data crosses the bus.
+//
+// Init() after InitWindow(); Advect() outside BeginDrawing/BeginTextureMode; Draw()
+// between BeginMode3D/EndMode3D; Unload() before CloseWindow(). Init() returns false
+// without GL 3.3 float render targets, in which case callers keep CPU tracers.
+class GpuWindTracers {
+  public:
+    static constexpr int kStateWidth = 512;
+
+    bool Init(int count, uint32_t seed) {
+        width_ = kStateWidth;
+        height_ = std::max(1, (count + kStateWidth - 1) / kStateWidth);
+        updateShader_ = rlLoadShaderCode(kFullscreenVertexShader, kUpdateFragmentShader);
+        drawShader_ = rlLoadShaderCode(kStreakVertexShader, kStreakFragmentShader);
+        if (updateShader_ == 0 || updateShader_ == rlGetShaderIdDefault() || drawShader_ == 0 || drawShader_ == rlGetShaderIdDefault()) {
+            Unload();
+            return false;
+        }
+        locUpdateState_ = rlGetLocationUniform(updateShader_, "state");
+        locUpdateWind_ = rlGetLocationUniform(updateShader_, "wind");
+        locUpdateDt_ = rlGetLocationUniform(updateShader_, "dt");
+        locUpdateSeed_ = rlGetLocationUniform(updateShader_, "seed");
+        locDrawState_ = rlGetLocationUniform(drawShader_, "state");
+        locDrawWind_ = rlGetLocationUniform(drawShader_, "wind");
+        locDrawMvp_ = rlGetLocationUniform(drawShader_, "mvp");
+        locDrawWidth_ = rlGetLocationUniform(drawShader_, "stateWidth");
+        locDrawRadius_ = rlGetLocationUniform(drawShader_, "radius");
+        locDrawStreak_ = rlGetLocationUniform(drawShader_, "streakTime");
+        locDrawHalfWidth_ = rlGetLocationUniform(drawShader_, "halfWidth");
+        locDrawAlpha_ = rlGetLocationUniform(drawShader_, "alpha");
+
+        // Uniform on the sphere, with lives of 3 to 9 time units and staggered ages.
+        std::vector<float> initial(static_cast<size_t>(width_) * height_ * 4);
+        uint32_t state = seed * 747796405u + 2891336453u;
+        const auto random = [&state]() {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / 16777216.0f;
+        };
+        for (size_t i = 0; i < initial.size(); i += 4) {
+            initial[i + 0] = std::asin(2.0f * random() - 1.0f);
+            initial[i + 1] = PI * (2.0f * random() - 1.0f);
+            initial[i + 3] = 3.0f + 6.0f * random();
+            initial[i + 2] = random() * initial[i + 3];
+        }
+        for (int k = 0; k < 2; ++k) {
+            state_[k] = rlLoadTexture(initial.data(), width_, height_, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+            rlTextureParameters(state_[k], RL_TEXTURE_MIN_FILTER, RL_TEXTURE_FILTER_NEAREST);
+            rlTextureParameters(state_[k], RL_TEXTURE_MAG_FILTER, RL_TEXTURE_FILTER_NEAREST);
+            fbo_[k] = rlLoadFramebuffer();
+            rlFramebufferAttach(fbo_[k], state_[k], RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+            if (state_[k] == 0 || fbo_[k] == 0 || !rlFramebufferComplete(fbo_[k])) {
+                Unload();
+                return false;
+            }
+        }
+        vao_ = rlLoadVertexArray();  // attribute-less: the shaders work from gl_VertexID
+        ready_ = vao_ != 0;
+        if (!ready_) Unload();
+        return ready_;
+    }
+
+    void Unload() {
+        for (int k = 0; k < 2; ++k) {
+            if (fbo_[k] != 0) rlUnloadFramebuffer(fbo_[k]);
+            if (state_[k] != 0) rlUnloadTexture(state_[k]);
+            fbo_[k] = state_[k] = 0;
+        }
+        if (vao_ != 0) rlUnloadVertexArray(vao_);
+        if (updateShader_ != 0 && updateShader_ != rlGetShaderIdDefault()) rlUnloadShaderProgram(updateShader_);
+        if (drawShader_ != 0 && drawShader_ != rlGetShaderIdDefault()) rlUnloadShaderProgram(drawShader_);
+        vao_ = updateShader_ = drawShader_ = 0;
+        ready_ = false;
+    }
+
+    bool ready() const { return ready_; }
+    int count() const { return width_ * height_; }
+
+    void Advect(unsigned int windTexture, float dt) {
+        if (!ready_ || dt <= 0.0f) return;
+        const int src = current_;
+        const int dst = 1 - current_;
+        seedPhase_ = seedPhase_ + 0.618034f - static_cast<float>(static_cast<int>(seedPhase_ + 0.618034f));
+
+        rlDrawRenderBatchActive();
+        rlEnableFramebuffer(fbo_[dst]);
+        rlViewport(0, 0, width_, height_);
+        rlDisableColorBlend();
+        rlEnableShader(updateShader_);
+        BindTextures(locUpdateState_, state_[src], locUpdateWind_, windTexture);
+        rlSetUniform(locUpdateDt_, &dt, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locUpdateSeed_, &seedPhase_, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArray(0, 3);
+        rlDisableVertexArray();
+        UnbindTextures();
+        rlDisableShader();
+        rlEnableColorBlend();
+        rlDisableFramebuffer();
+        rlViewport(0, 0, rlGetFramebufferWidth(), rlGetFramebufferHeight());
+        current_ = dst;
+    }
+
+    // Streaks at `radius`, `streakTime` time units of travel long.
+    void Draw(unsigned int windTexture, float radius, float streakTime, float halfWidth, float alpha) const {
+        if (!ready_) return;
+        rlDrawRenderBatchActive();
+        const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        rlDisableDepthMask();
+        rlDisableBackfaceCulling();
+        rlEnableShader(drawShader_);
+        rlSetUniformMatrix(locDrawMvp_, mvp);
+        BindTextures(locDrawState_, state_[current_], locDrawWind_, windTexture);
+        rlSetUniform(locDrawWidth_, &width_, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(locDrawRadius_, &radius, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locDrawStreak_, &streakTime, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locDrawHalfWidth_, &halfWidth, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(locDrawAlpha_, &alpha, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlEnableVertexArray(vao_);
+        rlDrawVertexArray(0, 6 * count());
+        rlDisableVertexArray();
+        UnbindTextures();
+        rlDisableShader();
+        rlEnableBackfaceCulling();
+        rlEnableDepthMask();
+    }
+
+  private:
+    static void BindTextures(int locState, unsigned int state, int locWind, unsigned int wind) {
+        const int stateSlot = 0;
+        const int windSlot = 1;
+        rlActiveTextureSlot(stateSlot);
+        rlEnableTexture(state);
+        rlSetUniform(locState, &stateSlot, RL_SHADER_UNIFORM_INT, 1);
+        rlActiveTextureSlot(windSlot);
+        rlEnableTexture(wind);
+        rlSetUniform(locWind, &windSlot, RL_SHADER_UNIFORM_INT, 1);
+    }
+
+    static void UnbindTextures() {
+        rlActiveTextureSlot(1);
+        rlDisableTexture();
+        rlActiveTextureSlot(0);
+        rlDisableTexture();
+    }
+
+    static constexpr const char* kFullscreenVertexShader = R"(#version 330
+void main() {
+    vec2 p = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(2.0 * p - 1.0, 0.0, 1.0);
+}
+)";
+
+    static constexpr const char* kUpdateFragmentShader = R"(#version 330
+uniform sampler2D state;
+uniform sampler2D wind;
+uniform float dt;
+uniform float seed;
+out vec4 result;
+const float PI = 3.14159265;
+// (dlat/dt, dlon/dt) at (lat, lon).
+vec2 Rate(vec2 p) {
+    vec4 w = texture(wind, vec2(p.y / (2.0 * PI) + 0.5, p.x / PI + 0.5));
+    return vec2(w.y, w.x / max(cos(p.x), 0.05));
+}
+float Hash(vec2 p) {
+    return fract(sin(dot(p, vec2(12.9898, 78.233))) * 43758.5453);
+}
+void main() {
+    vec4 s = texelFetch(state, ivec2(gl_FragCoord.xy), 0);
+    vec2 p = s.xy + dt * Rate(s.xy + 0.5 * dt * Rate(s.xy));
+    p.y = mod(p.y + PI, 2.0 * PI) - PI;
+    float age = s.z + dt;
+    if (age > s.w || abs(p.x) > 1.45) {
+        vec2 h = gl_FragCoord.xy * 0.0137 + seed * vec2(91.7, 37.3);
+        p = vec2(asin(2.0 * Hash(h) - 1.0), PI * (2.0 * Hash(h + 7.31) - 1.0));
+        age = 0.0;
+    }
+    result = vec4(p, age, s.w);
+}
+)";
+
+    static constexpr const char* kStreakVertexShader = R"(#version 330
+uniform sampler2D state;
+uniform sampler2D wind;
+uniform mat4 mvp;
+uniform int stateWidth;
+uniform float radius;
+uniform float streakTime;
+uniform float halfWidth;
+uniform float alpha;
+out vec4 fragColor;
+const float PI = 3.14159265;
+void main() {
+    int tracer = gl_VertexID / 6;
+    int corner = gl_VertexID % 6;
+    vec4 s = texelFetch(state, ivec2(tracer % stateWidth, tracer / stateWidth), 0);
+    vec3 up = vec3(cos(s.x) * cos(s.y), sin(s.x), cos(s.x) * sin(s.y));
+    vec3 east = vec3(-sin(s.y), 0.0, cos(s.y));
+    vec3 north = cross(east, up);
+    vec4 w = texture(wind, vec2(s.y / (2.0 * PI) + 0.5, s.x / PI + 0.5));
+    vec3 v = east * w.x + north * w.y;
+    float speed = length(v);
+    vec3 dir = speed > 1e-5 ? v / speed : east;
+    vec3 head = up * radius;
+    vec3 tail = head - v * (streakTime * radius);
+    float along = (corner == 1 || corner == 2 || corner == 4) ? 1.0 : 0.0;
+    float across = (corner == 0 || corner == 1 || corner == 3) ? -1.0 : 1.0;
+    vec3 side = cross(up, dir) * halfWidth * (0.4 + 0.6 * along);
+    float fade = clamp(min(s.z, s.w - s.z) / 0.6, 0.0, 1.0);
+    vec3 color = mix(vec3(0.62, 0.78, 0.95), vec3(1.0), clamp(speed * 8.0, 0.0, 1.0));
+    fragColor = vec4(color, alpha * fade * (0.1 + 0.9 * along));
+    gl_Position = mvp * vec4(mix(tail, head, along) + side * across, 1.0);
+}
+)";
+
+    static constexpr const char* kStreakFragmentShader = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main() {
+    finalColor = fragColor;
+}
+)";
+
+    int width_ = kStateWidth;
+    int height_ = 1;
+    int current_ = 0;
+    float seedPhase_ = 0.0f;
+    unsigned int state_[2] = {0, 0};
+    unsigned int fbo_[2] = {0, 0};
+    unsigned int vao_ = 0;
+    unsigned int updateShader_ = 0;
+    unsigned int drawShader_ = 0;
+    int locUpdateState_ = -1;
+    int locUpdateWind_ = -1;
+    int locUpdateDt_ = -1;
+    int locUpdateSeed_ = -1;
+    int locDrawState_ = -1;
+    int locDrawWind_ = -1;
+    int locDrawMvp_ = -1;
+    int locDrawWidth_ = -1;
+    int locDrawRadius_ = -1;
+    int locDrawStreak_ = -1;
+    int locDrawHalfWidth_ = -1;
+    int locDrawAlpha_ = -1;
+    bool ready_ = false;
+};
+
+}  // namespace astro_render
@@ -1,8 +1,15 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/idle_frames.h"
+#include "../common/indexed_lines.h"
+#include "../common/polytope4d.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
-#include <array>
+#include <chrono>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -13,10 +20,12 @@ namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
-
-struct V4 {
-    float x, y, z, w;
-};
+constexpr float kWCamera = 3.4f;
+constexpr float kProjectionScale = 2.4f;
+constexpr int kDefaultPolytope = 1;      // tesseract
+constexpr int kVertexSphereLimit = 120;  // the 120-cell's 600 vertices read better as edges alone
+constexpr Color kFarColor = {120, 190, 255, 170};
+constexpr Color kNearColor = {255, 170, 120, 170};
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -37,34 +46,56 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     camera->position = Vector3Add(camera->target, offset);
 }
 
-V4 RotateZW(const V4& p, float a) {
-    return {p.x, p.y, p.z * std::cos(a) - p.w * std::sin(a), p.z * std::sin(a) + p.w * std::cos(a)};
-}
-
-V4 RotateXW(const V4& p, float a) {
-    return {p.x * std::cos(a) - p.w * std::sin(a), p.y, p.z, p.x * std::sin(a) + p.w * std::cos(a)};
-}
-
-V4 RotateYZ(const V4& p, float a) {
-    return {p.x, p.y * std::cos(a) - p.z * std::sin(a), p.y * std::sin(a) + p.z * std::cos(a), p.w};
+// The same three plane rotations the tesseract always used, composed once per frame:
+// ZW first, then XW, then YZ.
+astro_polytope::Rotation4 RotationAt(float t) {
+    using astro_polytope::Rotation4;
+    return Rotation4::Plane(1, 2, t * 0.6f) * Rotation4::Plane(0, 3, t * 0.7f) * Rotation4::Plane(2, 3, t * 0.9f);
 }
 
-Vector3 Project4Dto3D(const V4& p, float wCamera, float scale) {
-    float f = scale / (wCamera - p.w);
-    return {p.x * f, p.y * f, p.z * f};
+Color DepthColor(float w, unsigned char alpha) {
+    Color c = ColorLerp(kFarColor, kNearColor, std::clamp(0.5f + 0.5f * w / astro_polytope::kCircumradius, 0.0f, 1.0f));
+    c.a = alpha;
+    return c;
 }
 
-std::string Hud(float speed4D, bool paused) {
+std::string Hud(const astro_polytope::Polytope& poly, float speed4D, double projectUs, bool gpuLines, bool paused) {
     std::ostringstream os;
-    os << std::fixed << std::setprecision(2) << "4D rotation speed=" << speed4D;
+    os << poly.name << " {" << poly.symbol.p << "," << poly.symbol.q << "," << poly.symbol.r << "}  V=" << poly.vertexCount()
+       << " E=" << poly.edgeCount() << std::fixed << std::setprecision(2) << "  4D rotation speed=" << speed4D << "  project "
+       << projectUs << " us (" << astro_soa::SimdPathName() << ")  " << (gpuLines ? "line VBO" : "DrawLine3D");
     if (paused) os << "  [PAUSED]";
     return os.str();
 }
 
 }  // namespace
 
-int main() {
-    InitWindow(kScreenWidth, kScreenHeight, "4D Hypercube Projection 3D - C++ (raylib)");
+int main(int argc, char** argv) {
+    const std::vector<astro_polytope::Polytope>& polytopes = astro_polytope::RegularPolytopes();
+    std::vector<Vector4> projected;
+
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 2000, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // One bench step is a frame's rotation and projection of the 120-cell.
+        const astro_polytope::Polytope& poly = polytopes[4];
+        float t = 0.0f;
+        return astro_bench::RunBench(
+            "4th_dimension_viz", bench,
+            [&](float dt) {
+                t += dt;
+                astro_polytope::Project(poly, RotationAt(t), kWCamera, kProjectionScale, &projected);
+            },
+            [&]() {
+                double sum = 0.0;
+                for (int i = 0; i < poly.vertexCount(); ++i) {
+                    const Vector4& v = projected[static_cast<size_t>(i)];
+                    sum += v.x * v.w + v.z * v.z;
+                }
+                return sum;
+            });
+    }
+
+    InitWindow(kScreenWidth, kScreenHeight, "4D Regular Polytope Projection 3D - C++ (raylib)");
     SetTargetFPS(60);
 
     Camera3D camera{};
@@ -78,32 +109,32 @@ int main() {
     float camPitch = 0.32f;
     float camDistance = 13.8f;
 
-    std::vector<V4> vertices;
-    vertices.reserve(16);
-    for (int i = 0; i < 16; ++i) {
-        vertices.push_back({
-            (i & 1) ? 1.0f : -1.0f,
-            (i & 2) ? 1.0f : -1.0f,
-            (i & 4) ? 1.0f : -1.0f,
-            (i & 8) ? 1.0f : -1.0f,
-        });
-    }
-
-    std::vector<std::pair<int, int>> edges;
-    for (int i = 0; i < 16; ++i) {
-        for (int j = i + 1; j < 16; ++j) {
-            int diff = i ^ j;
-            if (diff && ((diff & (diff - 1)) == 0)) {
-                edges.push_back({i, j});
-            }
+    int selected = kDefaultPolytope;
+    astro_render::IndexedLineBuffer lines;
+    const auto loadLines = [&]() {
+        const astro_polytope::Polytope& poly = polytopes[static_cast<size_t>(selected)];
+        if (lines.Init(poly.paddedCount(), poly.edges)) {
+            lines.SetGradient(kFarColor, kNearColor, -astro_polytope::kCircumradius, astro_polytope::kCircumradius);
         }
-    }
+    };
+    loadLines();
+    astro_power::IdleFramePolicy idle;
+    idle.Init(astro_power::IdleOptions::FromArgs(argc, argv));
 
     float t = 0.0f;
     float speed4D = 1.0f;
     bool paused = false;
+    double projectUs = 0.0;
 
     while (!WindowShouldClose()) {
+        if (!idle.BeginFrame(!paused)) {
+            BeginDrawing();
+            idle.EndFrame();
+            astro_capture::CaptureFrame();
+            ASTRO_PROFILE_FRAME();
+            EndDrawing();
+            continue;
+        }
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
             t = 0.0f;
@@ -112,6 +143,13 @@ int main() {
         }
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) speed4D = std::max(0.1f, speed4D - 0.1f);
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) speed4D = std::min(5.0f, speed4D + 0.1f);
+        for (int k = 0; k < static_cast<int>(polytopes.size()); ++k) {
+            if (IsKeyPressed(KEY_ONE + k) && k != selected) {
+                selected = k;
+                loadLines();
+            }
+        }
+        const astro_polytope::Polytope& poly = polytopes[static_cast<size_t>(selected)];
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
@@ -119,47 +157,54 @@ int main() {
             t += GetFrameTime() * speed4D;
         }
 
-        std::vector<Vector3> projected(16);
-        for (int i = 0; i < 16; ++i) {
-            V4 p = vertices[i];
-            p = RotateZW(p, t * 0.9f);
-            p = RotateXW(p, t * 0.7f);
-            p = RotateYZ(p, t * 0.6f);
-            projected[i] = Project4Dto3D(p, 3.4f, 2.4f);
-        }
+        const auto projectStart = std::chrono::steady_clock::now();
+        astro_polytope::Project(poly, RotationAt(t), kWCamera, kProjectionScale, &projected);
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - projectStart).count();
+        projectUs = projectUs <= 0.0 ? us : 0.95 * projectUs + 0.05 * us;
+        lines.Update(projected.data(), poly.vertexCount());
 
         BeginDrawing();
         ClearBackground(Color{6, 9, 17, 255});
 
         BeginMode3D(camera);
 
-        for (const auto& e : edges) {
-            int a = e.first;
-            int b = e.second;
-            float wa = vertices[a].w;
-            float wb = vertices[b].w;
-            Color c = (wa * wb > 0) ? Color{120, 190, 255, 170} : Color{255, 170, 120, 165};
-            DrawLine3D(projected[a], projected[b], c);
+        if (lines.ready()) {
+            lines.Draw();
+        } else {
+            for (size_t e = 0; e + 1 < poly.edges.size(); e += 2) {
+                const Vector4& a = projected[poly.edges[e]];
+                const Vector4& b = projected[poly.edges[e + 1]];
+                DrawLine3D({a.x, a.y, a.z}, {b.x, b.y, b.z}, DepthColor(0.5f * (a.w + b.w), 170));
+            }
         }
 
-        for (int i = 0; i < 16; ++i) {
-            float w = vertices[i].w;
-            Color c = (w > 0.0f) ? Color{120, 230, 255, 255} : Color{255, 170, 130, 255};
-            DrawSphere(projected[i], 0.08f, c);
+        if (poly.vertexCount() <= kVertexSphereLimit) {
+            const float radius = std::min(0.08f, 0.12f * poly.edgeLength);
+            for (int i = 0; i < poly.vertexCount(); ++i) {
+                const Vector4& v = projected[static_cast<size_t>(i)];
+                DrawSphereEx({v.x, v.y, v.z}, radius, 6, 8, DepthColor(v.w, 255));
+            }
         }
 
         EndMode3D();
 
-        DrawText("4D Tesseract Projection into 3D", 20, 18, 29, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | +/- 4D speed | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
-        std::string hud = Hud(speed4D, paused);
+        DrawText("4D Regular Polytope Projection into 3D", 20, 18, 29, Color{232, 238, 248, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | 1-6 polytope | +/- 4D speed | P pause | R reset", 20, 54, 18,
+                 Color{164, 183, 210, 255});
+        std::string hud = Hud(poly, speed4D, projectUs, lines.ready(), paused);
         DrawText(hud.c_str(), 20, 82, 20, Color{126, 224, 255, 255});
-        DrawText("Blue/orange vertices indicate opposite w-hyperplanes", 20, 110, 18, Color{185, 198, 215, 255});
+        DrawText("Blue to orange: rotated w, from far to near the 4D camera", 20, 110, 18, Color{185, 198, 215, 255});
         DrawFPS(20, 138);
 
+        idle.EndFrame();
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    lines.Unload();
+    idle.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,17 +1,17 @@
+#include "../common/dynamic_resolution.h"
+#include "../common/frame_capture.h"
+#include "../common/hud_text.h"
+#include "../common/profiler.h"
 #include "../vision/hand_tracking_scene_shared.h"
+#include "../vision/live_controls.h"
 
 #include "raylib.h"
 #include "raymath.h"
 
 #include <algorithm>
-#include <cctype>
 #include <chrono>
 #include <cstdint>
 #include <cmath>
-#include <filesystem>
-#include <fstream>
-#include <optional>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -48,25 +48,6 @@ enum class FaultMode {
     BreakerTrip = 5,
 };
 
-struct LiveControls {
-    float zoom = 1.0f;
-    float rotationDeg = 0.0f;
-    float pitchDeg = 0.0f;
-    int nIncCount = 0;
-    int nDecCount = 0;
-    bool zoomLineActive = false;
-    std::string label = "Unknown";
-    std::string gesture = "none";
-    std::int64_t timestampMs = 0;
-};
-
-std::string Trim(std::string s) {
-    auto notSpace = [](unsigned char ch) { return !std::isspace(ch); };
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
-    s.erase(std::find_if(s.rbegin(), s.rend(), notSpace).base(), s.end());
-    return s;
-}
-
 std::int64_t UnixMsNow() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
@@ -82,64 +63,6 @@ float AngleDeltaDeg(float current, float previous) {
     return NormalizeDeg(current - previous);
 }
 
-std::optional<LiveControls> ParseLiveControlsFile(const std::filesystem::path& path) {
-    std::ifstream in(path);
-    if (!in.is_open()) return std::nullopt;
-
-    LiveControls lc;
-    std::string line;
-    while (std::getline(in, line)) {
-        const std::size_t eq = line.find('=');
-        if (eq == std::string::npos) continue;
-        const std::string key = Trim(line.substr(0, eq));
-        const std::string val = Trim(line.substr(eq + 1));
-        try {
-            if (key == "zoom") lc.zoom = std::stof(val);
-            else if (key == "rotation_deg") lc.rotationDeg = std::stof(val);
-            else if (key == "pitch_deg") lc.pitchDeg = std::stof(val);
-            else if (key == "n_inc_count") lc.nIncCount = std::stoi(val);
-            else if (key == "n_dec_count") lc.nDecCount = std::stoi(val);
-            else if (key == "zoom_line_active") lc.zoomLineActive = (val == "1" || val == "true" || val == "True");
-            else if (key == "label") lc.label = val;
-            else if (key == "gesture") lc.gesture = val;
-            else if (key == "timestamp_ms") lc.timestampMs = std::stoll(val);
-        } catch (...) {
-        }
-    }
-
-    if (lc.timestampMs <= 0) return std::nullopt;
-    return lc;
-}
-
-std::optional<LiveControls> LoadLiveControls() {
-    static std::optional<std::filesystem::path> cachedPath;
-
-    auto tryPath = [](const std::filesystem::path& p) -> std::optional<LiveControls> {
-        if (!std::filesystem::exists(p)) return std::nullopt;
-        return ParseLiveControlsFile(p);
-    };
-
-    if (cachedPath) {
-        if (auto parsed = tryPath(*cachedPath)) return parsed;
-    }
-
-    const std::vector<std::filesystem::path> candidates = {
-        "vision/live_controls.txt",
-        "../vision/live_controls.txt",
-        "../../vision/live_controls.txt",
-        "AstroPhysics/vision/live_controls.txt",
-        std::filesystem::path(__FILE__).parent_path().parent_path() / "vision" / "live_controls.txt",
-    };
-
-    for (const auto& p : candidates) {
-        if (auto parsed = tryPath(p)) {
-            cachedPath = p;
-            return parsed;
-        }
-    }
-    return std::nullopt;
-}
-
 void UpdateCameraFromOrbit(Camera3D* camera, float yaw, float pitch, float distance) {
     const float cp = std::cos(pitch);
     const Vector3 offset = {
@@ -775,20 +698,20 @@ void DrawOutletAssembly(const Vector3& center, ViewMode viewMode, float outletPo
     }
 }
 
-void DrawStatusBadge(int x, int y, int w, const char* label, Color accent) {
+void DrawStatusBadge(astro_render::HudTextLayer* hud, int x, int y, int w, const char* label, Color accent) {
     const Rectangle r{static_cast<float>(x), static_cast<float>(y), static_cast<float>(w), 28.0f};
     DrawRectangleRounded(r, 0.35f, 8, WithAlpha(accent, 34));
     DrawRectangleLinesEx(r, 1.2f, WithAlpha(accent, 150));
-    DrawText(label, x + 10, y + 6, 16, accent);
+    hud->Text(label, x + 10, y + 6, 16, accent);
 }
 
-void DrawWorldCallout(const Camera3D& camera, const Vector3& worldPos, const char* text, Color accent) {
+void DrawWorldCallout(astro_render::HudTextLayer* hud, const Camera3D& camera, const Vector3& worldPos, const char* text, Color accent) {
     const Vector2 screen = GetWorldToScreen(worldPos, camera);
-    const int textW = MeasureText(text, 16);
+    const int textW = hud->Measure(text, 16);
     const Rectangle r{screen.x - textW * 0.5f - 8.0f, screen.y - 26.0f, static_cast<float>(textW + 16), 22.0f};
     DrawRectangleRounded(r, 0.30f, 8, Color{8, 12, 18, 180});
     DrawRectangleLinesEx(r, 1.0f, WithAlpha(accent, 180));
-    DrawText(text, static_cast<int>(r.x) + 8, static_cast<int>(r.y) + 4, 16, accent);
+    hud->Text(text, static_cast<int>(r.x) + 8, static_cast<int>(r.y) + 4, 16, accent);
 }
 
 void DrawFieldIndicatorsAlongPath(const std::vector<Vector3>& path, float activeDistance, float time) {
@@ -934,6 +857,18 @@ const char* FaultModeLabel(FaultMode mode) {
     return "none";
 }
 
+const char* FaultBadgeLabel(FaultMode mode) {
+    switch (mode) {
+        case FaultMode::None: return "FAULT none";
+        case FaultMode::OpenNeutral: return "FAULT open neutral";
+        case FaultMode::ShortCircuit: return "FAULT short circuit";
+        case FaultMode::MissingGround: return "FAULT missing ground";
+        case FaultMode::Overload: return "FAULT overload";
+        case FaultMode::BreakerTrip: return "FAULT breaker trip";
+    }
+    return "FAULT none";
+}
+
 void UpdateProbeVectors(ProbeState* probe, float time, float magnitudeScale, float flowSign) {
     Vector3 n1{};
     Vector3 n2{};
@@ -956,26 +891,24 @@ void DrawProbeGlyph(const ProbeState& probe) {
     DrawArrow3D(probe.pos, Vector3Add(probe.pos, Vector3Scale(probe.sDir, 0.48f)), 0.012f, Color{150, 255, 176, 255});
 }
 
-std::string HudText(bool switchClosed, bool breakerClosed, bool acMode, FaultMode faultMode, float front, float bulbPower, bool paused) {
-    std::ostringstream os;
-    os.setf(std::ios::fixed);
-    os.precision(2);
-    os << "switch=" << (switchClosed ? "on" : "off")
-       << "  breaker=" << (breakerClosed ? "closed" : "tripped")
-       << "  mode=" << (acMode ? "ac" : "pulse")
-       << "  fault=" << FaultModeLabel(faultMode)
-       << "  front=" << front
-       << "  bulb=" << bulbPower;
-    if (paused) os << "  [PAUSED]";
-    return os.str();
+// Re-formatted only when a shown value changes.
+void PrintHud(astro_render::HudTextLayer* hud, bool switchClosed, bool breakerClosed, bool acMode, FaultMode faultMode, float front, float bulbPower,
+              bool paused) {
+    hud->Print(22, 154, 18, Color{84, 194, 230, 255}, "switch=%s  breaker=%s  mode=%s  fault=%s  front=%.2f  bulb=%.2f%s", switchClosed ? "on" : "off",
+               breakerClosed ? "closed" : "tripped", acMode ? "ac" : "pulse", FaultModeLabel(faultMode), front, bulbPower,
+               paused ? "  [PAUSED]" : "");
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(kScreenWidth, kScreenHeight, "Wall Switch EM Helix to Bulb 3D - C++ (raylib)");
     SetTargetFPS(60);
+    astro_render::DynamicResolution dynres;
+    dynres.Init(GetScreenWidth(), GetScreenHeight(), astro_render::DynamicResolutionOptions::FromArgs(argc, argv));
+    astro_render::HudTextLayer hud;
+    hud.Init();
 
     Camera3D camera{};
     camera.position = {6.8f, 4.5f, 8.0f};
@@ -1027,6 +960,9 @@ int main() {
     std::int64_t leftPinchDeadlineMs = 0;
     int pendingRightPinches = 0;
     std::int64_t rightPinchDeadlineMs = 0;
+    astro_hand::LiveControlsWatcher liveControls;
+    liveControls.Start();
+    liveControls.ListenUdp();
     std::string bridgeStatus = "tracker: waiting for AstroPhysics/vision/live_controls.txt";
     astro_hand::UdpFrameReceiver frameReceiver;
     const bool frameReceiverOk = frameReceiver.Start(static_cast<uint16_t>(astro_hand::kFrameUdpPort));
@@ -1093,7 +1029,8 @@ int main() {
         }
         previewLive = frameReceiverOk && webcamTexture.id > 0 && ((wallNow - lastFrameWallClock) < astro_hand::kLinkTimeout);
 
-        if (auto live = LoadLiveControls()) {
+        liveControls.Poll(GetTime());
+        if (const auto& live = liveControls.Latest()) {
             const std::int64_t ageMs = nowMs - live->timestampMs;
             if (ageMs <= kControlStaleMs) {
                 if (!hasPrevLive) {
@@ -1142,11 +1079,8 @@ int main() {
                 camDistance = kCameraDistanceMax + (kCameraDistanceMin - kCameraDistanceMax) * liveZoomNorm;
                 UpdateCameraFromOrbit(&camera, camYaw, camPitch, camDistance);
 
-                std::ostringstream cs;
-                cs << "tracker: live  hand=" << live->label
-                   << "  gesture=" << live->gesture
-                   << "  age=" << ageMs << "ms";
-                bridgeStatus = cs.str();
+                bridgeStatus = TextFormat("tracker: live  hand=%s  gesture=%s  age=%lldms", live->label.c_str(),
+                                          live->gesture.c_str(), static_cast<long long>(ageMs));
             } else {
                 hasPrevLive = false;
                 bridgeStatus = "tracker: stale";
@@ -1267,6 +1201,7 @@ int main() {
         }
 
         BeginDrawing();
+        dynres.BeginScene();
         ClearBackground(Color{6, 8, 12, 255});
 
         BeginMode3D(camera);
@@ -1359,50 +1294,51 @@ int main() {
         DrawProbeGlyph(probe);
 
         EndMode3D();
+        dynres.EndScene();
 
-        DrawText("House Circuit EM Visualizer", 22, 18, 28, Color{234, 238, 244, 255});
-        DrawText("Hot feeds the switch and outlet. Neutral returns. Ground is safety only.", 22, 50, 18, Color{112, 128, 150, 255});
+        hud.Begin();
+        hud.Text("House Circuit EM Visualizer", 22, 18, 28, Color{234, 238, 244, 255});
+        hud.Text("Hot feeds the switch and outlet. Neutral returns. Ground is safety only.", 22, 50, 18, Color{112, 128, 150, 255});
 
-        DrawStatusBadge(22, 80, 112, breakerClosed ? "BREAKER ON" : "BREAKER TRIP", breakerClosed ? Color{255, 214, 140, 255} : Color{244, 126, 114, 255});
-        DrawStatusBadge(142, 80, 96, switchClosed ? "SWITCH ON" : "SWITCH OFF", switchClosed ? Color{255, 214, 140, 255} : Color{172, 182, 196, 255});
-        DrawStatusBadge(246, 80, 82, acMode ? "AC MODE" : "PULSE", acMode ? Color{120, 188, 255, 255} : Color{150, 255, 176, 255});
-        DrawStatusBadge(336, 80, 148, TextFormat("FAULT %s", FaultModeLabel(faultMode)), faultMode == FaultMode::None ? Color{172, 182, 196, 255} : Color{244, 126, 114, 255});
+        DrawStatusBadge(&hud, 22, 80, 112, breakerClosed ? "BREAKER ON" : "BREAKER TRIP", breakerClosed ? Color{255, 214, 140, 255} : Color{244, 126, 114, 255});
+        DrawStatusBadge(&hud, 142, 80, 96, switchClosed ? "SWITCH ON" : "SWITCH OFF", switchClosed ? Color{255, 214, 140, 255} : Color{172, 182, 196, 255});
+        DrawStatusBadge(&hud, 246, 80, 82, acMode ? "AC MODE" : "PULSE", acMode ? Color{120, 188, 255, 255} : Color{150, 255, 176, 255});
+        DrawStatusBadge(&hud, 336, 80, 148, FaultBadgeLabel(faultMode), faultMode == FaultMode::None ? Color{172, 182, 196, 255} : Color{244, 126, 114, 255});
 
-        DrawStatusBadge(22, 114, 104, neutralIntact ? "NEUTRAL OK" : "NEUTRAL OPEN", neutralIntact ? Color{120, 188, 255, 255} : Color{244, 126, 114, 255});
-        DrawStatusBadge(134, 114, 96, groundIntact ? "GROUND OK" : "GROUND OFF", groundIntact ? Color{150, 214, 120, 255} : Color{244, 126, 114, 255});
-        DrawStatusBadge(238, 114, 100, bulbPower > 0.08f ? "LAMP LIVE" : "LAMP IDLE", bulbPower > 0.08f ? Color{255, 214, 140, 255} : Color{172, 182, 196, 255});
-        DrawStatusBadge(346, 114, 110, outletPower > 0.10f ? "OUTLET LIVE" : "OUTLET OFF", outletPower > 0.10f ? Color{150, 255, 176, 255} : Color{172, 182, 196, 255});
+        DrawStatusBadge(&hud, 22, 114, 104, neutralIntact ? "NEUTRAL OK" : "NEUTRAL OPEN", neutralIntact ? Color{120, 188, 255, 255} : Color{244, 126, 114, 255});
+        DrawStatusBadge(&hud, 134, 114, 96, groundIntact ? "GROUND OK" : "GROUND OFF", groundIntact ? Color{150, 214, 120, 255} : Color{244, 126, 114, 255});
+        DrawStatusBadge(&hud, 238, 114, 100, bulbPower > 0.08f ? "LAMP LIVE" : "LAMP IDLE", bulbPower > 0.08f ? Color{255, 214, 140, 255} : Color{172, 182, 196, 255});
+        DrawStatusBadge(&hud, 346, 114, 110, outletPower > 0.10f ? "OUTLET LIVE" : "OUTLET OFF", outletPower > 0.10f ? Color{150, 255, 176, 255} : Color{172, 182, 196, 255});
 
-        const std::string hud = HudText(switchClosed, breakerClosed, acMode, faultMode, signalDistance / std::max(0.01f, loopLength), bulbPower, paused);
-        DrawText(hud.c_str(), 22, 154, 18, Color{84, 194, 230, 255});
-        DrawText("Controls: F11 fullscreen   1/2/3 view   A AC   F fault   B reset breaker   RMB probe", 22, 178, 18, Color{130, 146, 168, 255});
-        DrawText("Gestures: dual pinch move/zoom   right pinch switch   left pinch slow   left double pinch fast", 22, 202, 18, Color{130, 146, 168, 255});
-        DrawText(bridgeStatus.c_str(), 22, 226, 18, Color{142, 255, 190, 255});
+        PrintHud(&hud, switchClosed, breakerClosed, acMode, faultMode, signalDistance / std::max(0.01f, loopLength), bulbPower, paused);
+        hud.Text("Controls: F11 fullscreen   1/2/3 view   A AC   F fault   B reset breaker   RMB probe", 22, 178, 18, Color{130, 146, 168, 255});
+        hud.Text("Gestures: dual pinch move/zoom   right pinch switch   left pinch slow   left double pinch fast", 22, 202, 18, Color{130, 146, 168, 255});
+        hud.Text(bridgeStatus.c_str(), 22, 226, 18, Color{142, 255, 190, 255});
 
-        DrawWorldCallout(camera, {-4.88f, 1.54f, 0.22f}, "breaker panel", Color{255, 214, 140, 255});
-        DrawWorldCallout(camera, {-2.70f, 1.94f, 0.18f}, "switch cuts hot", Color{255, 214, 140, 255});
-        DrawWorldCallout(camera, {2.92f, 2.84f, 0.24f}, "lamp load", Color{255, 214, 140, 255});
-        DrawWorldCallout(camera, {1.70f, 1.46f, 0.14f}, "outlet + fan", Color{150, 255, 176, 255});
+        DrawWorldCallout(&hud, camera, {-4.88f, 1.54f, 0.22f}, "breaker panel", Color{255, 214, 140, 255});
+        DrawWorldCallout(&hud, camera, {-2.70f, 1.94f, 0.18f}, "switch cuts hot", Color{255, 214, 140, 255});
+        DrawWorldCallout(&hud, camera, {2.92f, 2.84f, 0.24f}, "lamp load", Color{255, 214, 140, 255});
+        DrawWorldCallout(&hud, camera, {1.70f, 1.46f, 0.14f}, "outlet + fan", Color{150, 255, 176, 255});
 
         if (probe.active) {
             DrawRectangleRounded({20.0f, 708.0f, 520.0f, 120.0f}, 0.05f, 10, Color{8, 12, 18, 220});
             DrawRectangleLinesEx({20.0f, 708.0f, 520.0f, 120.0f}, 1.2f, probe.accent);
-            DrawText(TextFormat("probe: %s", probe.conductor.c_str()), 34, 722, 22, probe.accent);
-            DrawText(TextFormat("E %.1f V/m   B %.3f T   S %.1f W/m^2", probe.eMag, probe.bMag, probe.sMag), 34, 752, 20, Color{214, 222, 236, 255});
-            DrawText(TextFormat("position %.2f %.2f %.2f", probe.pos.x, probe.pos.y, probe.pos.z), 34, 780, 18, Color{130, 146, 168, 255});
+            hud.Print(34, 722, 22, probe.accent, "probe: %s", probe.conductor.c_str());
+            hud.Print(34, 752, 20, Color{214, 222, 236, 255}, "E %.1f V/m   B %.3f T   S %.1f W/m^2", probe.eMag, probe.bMag, probe.sMag);
+            hud.Print(34, 780, 18, Color{130, 146, 168, 255}, "position %.2f %.2f %.2f", probe.pos.x, probe.pos.y, probe.pos.z);
         }
 
         const Rectangle panel{static_cast<float>(GetScreenWidth() - 302), 20.0f, 282.0f, 190.0f};
         DrawRectangleRounded(panel, 0.06f, 10, Color{8, 12, 18, 210});
         DrawRectangleLinesEx(panel, 1.5f, Color{92, 110, 138, 255});
-        DrawText("Webcam Feed", static_cast<int>(panel.x) + 14, static_cast<int>(panel.y) + 12, 20, Color{222, 230, 244, 255});
+        hud.Text("Webcam Feed", static_cast<int>(panel.x) + 14, static_cast<int>(panel.y) + 12, 20, Color{222, 230, 244, 255});
         if (previewLive) {
             const Rectangle src = {0.0f, 0.0f, static_cast<float>(webcamTexture.width), static_cast<float>(webcamTexture.height)};
             const Rectangle dst = {panel.x + 12.0f, panel.y + 42.0f, panel.width - 24.0f, panel.height - 54.0f};
             DrawTexturePro(webcamTexture, src, dst, {0.0f, 0.0f}, 0.0f, WHITE);
         } else {
             DrawRectangle(static_cast<int>(panel.x) + 12, static_cast<int>(panel.y) + 42, static_cast<int>(panel.width) - 24, static_cast<int>(panel.height) - 54, Color{20, 24, 32, 255});
-            DrawText(frameReceiverOk ? "waiting for preview" : "preview receiver failed",
+            hud.Text(frameReceiverOk ? "waiting for preview" : "preview receiver failed",
                      static_cast<int>(panel.x) + 22,
                      static_cast<int>(panel.y) + 112,
                      18,
@@ -1410,11 +1346,18 @@ int main() {
         }
 
         DrawFPS(22, 250);
+        hud.Print(110, 252, 16, Color{130, 146, 168, 255}, "render %.0f%% (scene %.1f / %.1f ms)", 100.0f * dynres.scale(), dynres.gpuMs(), dynres.targetMs());
+        hud.Draw();
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
     frameReceiver.Close();
     if (webcamTexture.id > 0) UnloadTexture(webcamTexture);
+    hud.Unload();
+    dynres.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,45 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/charge_field.h"
+#include "../common/frame_capture.h"
+#include "../common/instanced_arrows.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <deque>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+constexpr float kCoulomb = 4.5f;
+constexpr float kSoftening2 = 0.1f;
+
+// 13x13 arrows through the plane of motion.
+astro_efield::FieldLatticeSpec FieldSlice() {
+    astro_efield::FieldLatticeSpec spec;
+    spec.origin = {-4.5f, 0.6f, -4.5f};
+    spec.spacing = 0.75f;
+    spec.nx = 13;
+    spec.nz = 13;
+    return spec;
+}
+
+void BuildArrows(const astro_efield::FieldLattice& field, std::vector<astro_render::ArrowInstance>* arrows) {
+    arrows->clear();
+    for (size_t i = 0; i < field.size(); ++i) {
+        const Vector3 e = field.field(i);
+        const float m = Vector3Length(e);
+        if (m < 0.03f) continue;
+        const Vector3 d = Vector3Scale(e, std::min(0.5f, 0.15f + 0.12f * m) / m);
+        arrows->push_back({field.point(i), 0.018f, d, Color{static_cast<unsigned char>(110 + std::min(140.0f, 50.0f * m)), 170, 240, 170}});
+    }
+}
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -50,6 +79,15 @@ int main() {
     std::deque<Vector3> trail1, trail2;
     trail1.push_back(p1); trail2.push_back(p2);
 
+    astro_efield::FieldLattice field;
+    field.softening2 = kSoftening2;
+    field.SetLattice(FieldSlice());
+    astro_render::InstancedArrowRenderer arrowRenderer;
+    arrowRenderer.Init();
+    std::vector<astro_render::ArrowInstance> arrows;
+    uint64_t arrowVersion = 0;
+    bool showField = true;
+
     bool paused = false;
 
     while (!WindowShouldClose()) {
@@ -63,18 +101,14 @@ int main() {
         }
         if (IsKeyPressed(KEY_ONE)) q1 *= -1.0f;
         if (IsKeyPressed(KEY_TWO)) q2 *= -1.0f;
+        if (IsKeyPressed(KEY_F)) showField = !showField;
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
         if (!paused) {
             float dt = GetFrameTime();
-            Vector3 r12 = Vector3Subtract(p2, p1);
-            float d2 = Vector3DotProduct(r12, r12) + 0.1f;
-            float invR = 1.0f / std::sqrt(d2);
-            float invR3 = invR * invR * invR;
-            float k = 4.5f;
-
-            Vector3 fOn1 = Vector3Scale(r12, k * q1 * q2 * invR3);
+            // Force on each charge from the other's softened field; the self term is excluded.
+            Vector3 fOn1 = Vector3Scale(astro_efield::ChargeField({p2, q2}, p1, kSoftening2), kCoulomb * q1);
             Vector3 fOn2 = Vector3Negate(fOn1);
 
             v1 = Vector3Add(v1, Vector3Scale(fOn1, dt / m1));
@@ -91,10 +125,22 @@ int main() {
             if (trail2.size() > 900) trail2.pop_front();
         }
 
+        if (showField) {
+            field.SetCharges({{p1, q1}, {p2, q2}});
+            field.Update();
+            if (field.version() != arrowVersion) {
+                BuildArrows(field, &arrows);
+                arrowRenderer.Upload(arrows);
+                arrowVersion = field.version();
+            }
+        }
+
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
 
+        if (showField) arrowRenderer.Draw();
+
         for (size_t i=1; i<trail1.size(); ++i) DrawLine3D(trail1[i-1], trail1[i], Color{255,140,140,120});
         for (size_t i=1; i<trail2.size(); ++i) DrawLine3D(trail2[i-1], trail2[i], Color{140,180,255,120});
 
@@ -106,7 +152,7 @@ int main() {
         EndMode3D();
 
         DrawText("Two Electric Charges Interaction", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | 1/2 flip sign | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | 1/2 flip sign | F field arrows | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
 
         std::ostringstream os;
         os << std::fixed << std::setprecision(2)
@@ -116,9 +162,13 @@ int main() {
         DrawText(os.str().c_str(), 20, 82, 20, Color{126,224,255,255});
         DrawFPS(20, 110);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    arrowRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
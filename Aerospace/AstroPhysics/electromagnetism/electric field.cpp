@@ -1,7 +1,16 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/charge_field.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/instanced_arrows.h"
+#include "../common/instanced_particles.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -11,12 +20,102 @@
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+constexpr float kSliceY = 0.6f;
+constexpr int kCloudCharges = 400;
+constexpr int kPlateSide = 12;          // charges per plate edge
+constexpr float kDriftAmplitude = 0.25f;
+constexpr uint64_t kCloudSeed = 2024;
+
+enum class Scene { kDipole, kCloud, kPlates };
+constexpr std::array<const char*, 3> kSceneNames = {"dipole", "random cloud", "parallel plates"};
+
+using astro_efield::PointCharge;
 
-struct Charge {
-    Vector3 pos;
-    float q;
+// A 13x13 slice through the charges, or a 21x11x21 volume around them.
+astro_efield::FieldLatticeSpec LatticeFor(bool volume) {
+    astro_efield::FieldLatticeSpec spec;
+    if (volume) {
+        spec.spacing = 0.3f;
+        spec.nx = 21;
+        spec.ny = 11;
+        spec.nz = 21;
+        spec.origin = {-3.0f, kSliceY - 1.5f, -3.0f};
+    } else {
+        spec.spacing = 0.5f;
+        spec.nx = 13;
+        spec.nz = 13;
+        spec.origin = {-3.0f, kSliceY, -3.0f};
+    }
+    return spec;
+}
+
+// Each scene keeps its rest positions so the cloud can drift about them.
+struct SceneCharges {
+    std::vector<PointCharge> home;
+    std::vector<Vector3> phase;
 };
 
+SceneCharges MakeScene(Scene scene) {
+    SceneCharges s;
+    switch (scene) {
+        case Scene::kDipole:
+            s.home = {{{-1.4f, kSliceY, 0.0f}, +1.0f}, {{1.4f, kSliceY, 0.0f}, -1.0f}};
+            break;
+        case Scene::kCloud: {
+            astro_random::PhiloxStream rng(kCloudSeed);
+            for (int i = 0; i < kCloudCharges; ++i) {
+                const Vector3 p = {rng.Uniform(-2.6f, 2.6f), rng.Uniform(kSliceY - 1.2f, kSliceY + 1.2f), rng.Uniform(-2.6f, 2.6f)};
+                s.home.push_back({p, (i % 2 == 0 ? 0.3f : -0.3f)});
+                s.phase.push_back({rng.Uniform(0.0f, 2.0f * PI), rng.Uniform(0.0f, 2.0f * PI), rng.Uniform(0.0f, 2.0f * PI)});
+            }
+            break;
+        }
+        case Scene::kPlates:
+            for (int sign = -1; sign <= 1; sign += 2) {
+                for (int j = 0; j < kPlateSide; ++j) {
+                    for (int k = 0; k < kPlateSide; ++k) {
+                        const float y = kSliceY - 1.1f + 2.2f * j / (kPlateSide - 1);
+                        const float z = -2.2f + 4.4f * k / (kPlateSide - 1);
+                        s.home.push_back({{1.2f * sign, y, z}, -0.08f * sign});
+                    }
+                }
+            }
+            break;
+    }
+    if (s.phase.empty()) s.phase.assign(s.home.size(), {0.0f, 0.0f, 0.0f});
+    return s;
+}
+
+// Slow Lissajous drift of every cloud charge about its rest position.
+void Drift(const SceneCharges& scene, float t, std::vector<PointCharge>* charges) {
+    for (size_t i = 0; i < charges->size(); ++i) {
+        const Vector3 h = scene.home[i].pos;
+        const Vector3 ph = scene.phase[i];
+        (*charges)[i].pos = {h.x + kDriftAmplitude * std::sin(0.7f * t + ph.x), h.y + kDriftAmplitude * std::sin(0.5f * t + ph.y),
+                             h.z + kDriftAmplitude * std::sin(0.6f * t + ph.z)};
+    }
+}
+
+// One arrow per lattice point, scaled with the lattice spacing.
+void BuildArrows(const astro_efield::FieldLattice& field, std::vector<astro_render::ArrowInstance>* arrows) {
+    arrows->clear();
+    const float scale = field.spec().spacing / 0.5f;
+    for (size_t i = 0; i < field.size(); ++i) {
+        const Vector3 e = field.field(i);
+        const float m = Vector3Length(e);
+        if (m < 0.05f) continue;
+        const Vector3 d = Vector3Scale(e, scale * std::min(0.35f, 0.12f + 0.08f * m) / m);
+        const Color c = Color{static_cast<unsigned char>(120 + std::min(130.0f, 40.0f * m)), 180, 255, 220};
+        arrows->push_back({field.point(i), 0.012f * scale, d, c});
+    }
+}
+
+double FieldChecksum(const astro_efield::FieldLattice& field) {
+    double sum = 0.0;
+    for (size_t i = 0; i < field.size(); ++i) sum += Vector3Length(field.field(i));
+    return sum;
+}
+
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 d = GetMouseDelta();
@@ -30,30 +129,27 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
     c->position = Vector3Add(c->target, {*distance * cp * std::cos(*yaw), *distance * std::sin(*pitch), *distance * cp * std::sin(*yaw)});
 }
 
-Vector3 EFieldAt(Vector3 p, const std::vector<Charge>& charges) {
-    Vector3 e{0,0,0};
-    for (const Charge& c : charges) {
-        Vector3 r = Vector3Subtract(p, c.pos);
-        float d2 = Vector3DotProduct(r, r) + 0.08f;
-        float invR = 1.0f / std::sqrt(d2);
-        float invR3 = invR * invR * invR;
-        e = Vector3Add(e, Vector3Scale(r, c.q * invR3));
-    }
-    return e;
 }
 
-void DrawArrow(Vector3 a, Vector3 b, Color c) {
-    DrawLine3D(a,b,c);
-    Vector3 d = Vector3Normalize(Vector3Subtract(b,a));
-    Vector3 s = Vector3Normalize(Vector3CrossProduct(d, {0,1,0}));
-    if (Vector3Length(s) < 1e-4f) s = {1,0,0};
-    DrawLine3D(b, Vector3Add(b, Vector3Add(Vector3Scale(d,-0.12f), Vector3Scale(s,0.06f))), c);
-    DrawLine3D(b, Vector3Add(b, Vector3Add(Vector3Scale(d,-0.12f), Vector3Scale(s,-0.06f))), c);
-}
-
-}
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 120, 1.0f / 60.0f);
+    if (bench.enabled) {
+        const SceneCharges scene = MakeScene(Scene::kCloud);
+        std::vector<PointCharge> charges = scene.home;
+        astro_efield::FieldLattice field;
+        field.SetLattice(LatticeFor(true));
+        float t = 0.0f;
+        return astro_bench::RunBench(
+            "electric_field", bench,
+            [&](float dt) {
+                t += dt;
+                Drift(scene, t, &charges);
+                field.SetCharges(charges);
+                field.Update();
+            },
+            [&]() { return static_cast<float>(FieldChecksum(field)); });
+    }
 
-int main() {
     InitWindow(kScreenWidth, kScreenHeight, "Electric Field 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -66,66 +162,105 @@ int main() {
 
     float camYaw=0.84f, camPitch=0.34f, camDistance=13.0f;
 
-    std::vector<Charge> charges = {
-        {{-1.4f, 0.6f, 0.0f}, +1.0f},
-        {{ 1.4f, 0.6f, 0.0f}, -1.0f}
-    };
+    astro_render::InstancedArrowRenderer arrowRenderer;
+    arrowRenderer.Init();
+    astro_render::InstancedParticleRenderer chargeRenderer;
+    chargeRenderer.Init(astro_render::InstanceShape::kSphere);
+
+    Scene sceneId = Scene::kDipole;
+    SceneCharges scene = MakeScene(sceneId);
+    std::vector<PointCharge> charges = scene.home;
+    bool volume = false;
+    astro_efield::FieldLattice field;
+    field.SetLattice(LatticeFor(volume));
+    std::vector<astro_render::ArrowInstance> arrows;
+    uint64_t arrowVersion = 0;
 
     bool paused = false;
+    bool drift = false;
     float t = 0.0f;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
+        if (IsKeyPressed(KEY_N)) {
+            sceneId = static_cast<Scene>((static_cast<int>(sceneId) + 1) % static_cast<int>(kSceneNames.size()));
+            scene = MakeScene(sceneId);
+            charges = scene.home;
+            drift = false;
+        }
         if (IsKeyPressed(KEY_R)) {
-            charges[0].q = +1.0f; charges[1].q = -1.0f;
-            charges[0].pos = {-1.4f,0.6f,0}; charges[1].pos = {1.4f,0.6f,0};
-            paused = false; t = 0.0f;
+            charges = scene.home;
+            paused = false; drift = false; t = 0.0f;
+        }
+        if (IsKeyPressed(KEY_L)) {
+            volume = !volume;
+            field.SetLattice(LatticeFor(volume));
         }
+        if (IsKeyPressed(KEY_M) && sceneId == Scene::kCloud) drift = !drift;
         if (IsKeyPressed(KEY_ONE)) charges[0].q *= -1.0f;
         if (IsKeyPressed(KEY_TWO)) charges[1].q *= -1.0f;
-        if (IsKeyDown(KEY_LEFT)) charges[1].pos.x -= 0.9f * GetFrameTime();
-        if (IsKeyDown(KEY_RIGHT)) charges[1].pos.x += 0.9f * GetFrameTime();
-        charges[1].pos.x = std::clamp(charges[1].pos.x, -3.0f, 3.0f);
+        // Arrows move the last charge: a single moved charge is folded into the cached field.
+        PointCharge& moving = charges.back();
+        if (IsKeyDown(KEY_LEFT)) moving.pos.x -= 0.9f * GetFrameTime();
+        if (IsKeyDown(KEY_RIGHT)) moving.pos.x += 0.9f * GetFrameTime();
+        moving.pos.x = std::clamp(moving.pos.x, -3.0f, 3.0f);
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
-        if (!paused) t += GetFrameTime();
+        if (!paused) {
+            t += GetFrameTime();
+            if (drift) Drift(scene, t, &charges);
+        }
+
+        field.SetCharges(charges);
+        field.Update();
+        if (field.version() != arrowVersion) {
+            BuildArrows(field, &arrows);
+            arrowRenderer.Upload(arrows);
+            arrowVersion = field.version();
+        }
 
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
 
-        for (int ix=-6; ix<=6; ++ix) {
-            for (int iz=-6; iz<=6; ++iz) {
-                Vector3 p = {0.5f*ix, 0.6f, 0.5f*iz};
-                Vector3 e = EFieldAt(p, charges);
-                float m = Vector3Length(e);
-                if (m < 0.05f) continue;
-                Vector3 d = Vector3Scale(Vector3Normalize(e), std::min(0.35f, 0.12f + 0.08f*m));
-                Color c = Color{static_cast<unsigned char>(120 + std::min(130.0f, 40.0f*m)), 180, 255, 220};
-                DrawArrow(p, Vector3Add(p,d), c);
-            }
-        }
+        arrowRenderer.Draw();
 
-        for (const Charge& c : charges) {
-            Color col = (c.q > 0) ? Color{255,120,120,255} : Color{120,160,255,255};
-            DrawSphere(c.pos, 0.18f, col);
+        const float chargeRadius = charges.size() > 2 ? 0.06f : 0.18f;
+        chargeRenderer.Clear();
+        chargeRenderer.Reserve(charges.size());
+        for (const PointCharge& c : charges) {
+            chargeRenderer.Add(c.pos, chargeRadius, (c.q > 0) ? Color{255,120,120,255} : Color{120,160,255,255});
         }
+        chargeRenderer.Draw();
 
         EndMode3D();
 
         DrawText("Electric Field of Point Charges", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | 1/2 flip charge sign | arrows move charge 2 | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | N scene | L slice/volume | M drift (cloud) | 1/2 flip sign | arrows move last charge | P pause | R reset",
+                 20, 54, 18, Color{164,183,210,255});
 
         std::ostringstream os;
-        os << std::fixed << std::setprecision(2)
-           << "q1=" << charges[0].q << "  q2=" << charges[1].q << "  x2=" << charges[1].pos.x;
+        os << std::fixed << std::setprecision(2) << kSceneNames[static_cast<size_t>(sceneId)] << "  charges=" << charges.size();
+        if (sceneId == Scene::kDipole) os << "  q1=" << charges[0].q << "  q2=" << charges[1].q << "  x2=" << charges[1].pos.x;
+        if (drift) os << "  [drifting]";
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{126,224,255,255});
-        DrawFPS(20,110);
 
+        std::ostringstream info;
+        info << std::fixed << std::setprecision(2) << "field: " << field.size() << " points, " << arrowRenderer.count() << " arrows, "
+             << (field.usingTree() ? "multipole tree" : "direct sum") << ", last update " << field.lastMs() << " ms ("
+             << (field.lastWasDelta() ? "delta" : "full") << ")  version " << field.version();
+        DrawText(info.str().c_str(), 20, 108, 18, Color{164,183,210,255});
+        DrawFPS(20,134);
+
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    chargeRenderer.Unload();
+    arrowRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,38 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+
+#include "../common/fdtd_maxwell.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
 constexpr int kScreenWidth = 1360;
 constexpr int kScreenHeight = 860;
+// The FDTD cube spans [-kDomainHalf, kDomainHalf]^3 in world units, PML included. The
+// aperture sheet at kSourceX drives E_y and E_z with the chosen polarisation, and the
+// helices, arrows and floor slice are all sampled from the simulated fields.
+constexpr float kDomainHalf = 9.5f;
+constexpr float kHelixMinX = -7.0f;
+constexpr float kHelixMaxX = 7.0f;
+constexpr float kSourceX = -7.0f;
+constexpr float kBeamSigma = 3.0f;   // aperture standard deviation, world units
+constexpr float kWaveSpeed = 1.38f;  // world units per second (the old omega / k)
+constexpr int kPmlCells = 8;
+constexpr int kMaxStepsPerFrame = 6;
+constexpr std::array<int, 3> kGridSizes = {64, 128, 256};
+constexpr int kDefaultGrid = 128;
+constexpr int kSliceTexels = 192;
+constexpr float kFloorY = -2.0f;
 
 enum class PolarizationMode {
     kLinear,
@@ -52,24 +74,77 @@ const char* PolarizationName(PolarizationMode mode) {
     return "unknown";
 }
 
-Vector3 ElectricField(float x, float t, float amplitude, float waveNumber, float omega, PolarizationMode mode, float ellipticity, bool rightHanded) {
-    const float phi = waveNumber * x - omega * t;
-    const float handed = rightHanded ? 1.0f : -1.0f;
+enum class SliceMode { kElectric, kMagnetic, kPoynting };
+
+const char* SliceName(SliceMode mode) {
+    switch (mode) {
+        case SliceMode::kElectric: return "|E|";
+        case SliceMode::kMagnetic: return "|B|";
+        case SliceMode::kPoynting: return "S_x";
+    }
+    return "?";
+}
 
-    float ey = amplitude * std::cos(phi);
-    float ez = 0.0f;
+struct HelixScene {
+    astro_fdtd::YeeSolver solver;
+    astro_fdtd::ApertureSource source;
+    int grid = kDefaultGrid;
+    float phase = 0.0f;       // source phase, integrated so omega can change mid-run
+    float sourceTime = 0.0f;  // world seconds since the source was switched on
+    float accumulator = 0.0f;
+};
 
-    if (mode == PolarizationMode::kCircular) {
-        ez = handed * amplitude * std::sin(phi);
-    } else if (mode == PolarizationMode::kElliptical) {
-        ez = handed * amplitude * ellipticity * std::sin(phi);
+float CellSize(const HelixScene& scene) { return 2.0f * kDomainHalf / static_cast<float>(scene.grid); }
+// One solver step in world seconds.
+float StepSeconds(const HelixScene& scene) { return astro_fdtd::YeeSolver::kCourant * CellSize(scene) / kWaveSpeed; }
+
+void ConfigureScene(HelixScene* scene) {
+    const int n = scene->grid;
+    scene->solver.Configure(n, n, n, kPmlCells);
+    const int sourceCell = static_cast<int>(std::lround(kSourceX / CellSize(*scene) + 0.5f * static_cast<float>(n)));
+    scene->source.Configure(scene->solver, std::max(kPmlCells + 1, sourceCell), kBeamSigma / CellSize(*scene));
+    scene->phase = 0.0f;
+    scene->sourceTime = 0.0f;
+    scene->accumulator = 0.0f;
+}
+
+// Runs the solver at its fixed step for dt of scene time. The sheet drives
+// E = A (cos phi, h e sin phi) in (y, z), ramped up over the first period, which is the
+// old analytic wave at the source plane.
+void StepScene(HelixScene* scene, float dt, float amplitude, float omega, PolarizationMode mode, float ellipticity, bool rightHanded) {
+    const float stepSeconds = StepSeconds(*scene);
+    scene->accumulator += dt;
+    int steps = static_cast<int>(scene->accumulator / stepSeconds);
+    if (steps > kMaxStepsPerFrame) {
+        steps = kMaxStepsPerFrame;
+        scene->accumulator = 0.0f;
+    } else {
+        scene->accumulator -= static_cast<float>(steps) * stepSeconds;
     }
+    if (steps == 0) return;
 
-    return {0.0f, ey, ez};
+    const float handed = rightHanded ? 1.0f : -1.0f;
+    const float zShare = mode == PolarizationMode::kCircular ? 1.0f : mode == PolarizationMode::kElliptical ? ellipticity : 0.0f;
+    scene->solver.Step(steps, [&](float) {
+        scene->phase += omega * stepSeconds;
+        scene->sourceTime += stepSeconds;
+        const float ramp = 0.5f - 0.5f * std::cos(PI * std::min(1.0f, scene->sourceTime * omega / (2.0f * PI)));
+        const float a = amplitude * ramp;
+        // At the sheet phi = k x0 - omega t: up to that constant, cos(phi) = cos(omega t) and
+        // sin(phi) = -sin(omega t).
+        scene->source.Emit(&scene->solver, a * std::cos(scene->phase), -handed * a * zShare * std::sin(scene->phase));
+    });
 }
 
-Vector3 MagneticFieldFromE(const Vector3& eField) {
-    return {0.0f, -eField.z, eField.y};
+// Fields on the propagation axis, linearly interpolated between cells.
+Vector3 AxisField(const HelixScene& scene, float x, bool electric) {
+    const float u = std::clamp(x / CellSize(scene) + 0.5f * static_cast<float>(scene.grid), 0.0f, static_cast<float>(scene.grid - 2));
+    const int i = static_cast<int>(u);
+    const float f = u - static_cast<float>(i);
+    const int mid = scene.grid / 2;
+    const Vector3 a = electric ? scene.solver.ElectricAt(i, mid, mid) : scene.solver.MagneticAt(i, mid, mid);
+    const Vector3 b = electric ? scene.solver.ElectricAt(i + 1, mid, mid) : scene.solver.MagneticAt(i + 1, mid, mid);
+    return Vector3Lerp(a, b, f);
 }
 
 void DrawArrow3D(const Vector3& from, const Vector3& to, float radius, Color color) {
@@ -83,30 +158,23 @@ void DrawArrow3D(const Vector3& from, const Vector3& to, float radius, Color col
     DrawCylinderEx(tipBase, to, radius * 1.9f, 0.0f, 8, color);
 }
 
-void DrawHelixCurve(bool electric,
-                    float t,
-                    float amplitude,
-                    float waveNumber,
-                    float omega,
-                    PolarizationMode mode,
-                    float ellipticity,
-                    bool rightHanded,
-                    Color color) {
+// Arrow length factor for the energy flow: |E x B| relative to a full-amplitude wave,
+// so the arrows grow in as the wave arrives instead of snapping to full length.
+float FlowShare(Vector3 e, Vector3 b, float amplitude) {
+    return std::min(1.0f, Vector3Length(Vector3CrossProduct(e, b)) / (amplitude * amplitude));
+}
+
+void DrawHelixCurve(const HelixScene& scene, bool electric, float scale, Color color) {
     constexpr int kSegments = 260;
-    constexpr float kXMin = -7.0f;
-    constexpr float kXMax = 7.0f;
 
     auto curvePoint = [&](float x) {
-        const Vector3 field = electric
-            ? ElectricField(x, t, amplitude, waveNumber, omega, mode, ellipticity, rightHanded)
-            : MagneticFieldFromE(ElectricField(x, t, amplitude, waveNumber, omega, mode, ellipticity, rightHanded));
-        return Vector3Add({x, 0.0f, 0.0f}, field);
+        return Vector3Add({x, 0.0f, 0.0f}, Vector3Scale(AxisField(scene, x, electric), scale));
     };
 
-    Vector3 prev = curvePoint(kXMin);
+    Vector3 prev = curvePoint(kHelixMinX);
     for (int i = 1; i <= kSegments; ++i) {
         const float u = static_cast<float>(i) / static_cast<float>(kSegments);
-        const float x = kXMin + (kXMax - kXMin) * u;
+        const float x = kHelixMinX + (kHelixMaxX - kHelixMinX) * u;
         const Vector3 cur = curvePoint(x);
         DrawCylinderEx(prev, cur, electric ? 0.048f : 0.04f, electric ? 0.048f : 0.04f, 8, color);
         DrawCylinderEx(prev, cur, electric ? 0.082f : 0.072f, electric ? 0.082f : 0.072f, 8, WithAlpha(color, 22));
@@ -114,13 +182,50 @@ void DrawHelixCurve(bool electric,
     }
 }
 
-std::string HudLine(PolarizationMode mode, bool rightHanded, float amplitude, float waveNumber, float omega, bool paused) {
+// Horizontal slice through the axis, drawn on the floor: field magnitude (or S_x)
+// relative to the source amplitude.
+void UpdateSliceTexture(const HelixScene& scene, SliceMode mode, float amplitude, std::vector<Vector3>* samples, std::vector<Color>* pixels, Texture2D texture) {
+    const astro_fdtd::SliceField field = mode == SliceMode::kElectric ? astro_fdtd::SliceField::kElectric
+                                         : mode == SliceMode::kMagnetic ? astro_fdtd::SliceField::kMagnetic
+                                                                        : astro_fdtd::SliceField::kPoynting;
+    scene.solver.SampleSlice(astro_fdtd::kY, scene.grid / 2, field, kSliceTexels, kSliceTexels, samples);
+    pixels->resize(samples->size());
+    const float scale = mode == SliceMode::kPoynting ? 1.0f / (amplitude * amplitude) : 1.0f / amplitude;
+    for (size_t n = 0; n < samples->size(); ++n) {
+        const Vector3 f = (*samples)[n];
+        const float value = mode == SliceMode::kPoynting ? std::max(0.0f, f.x) : Vector3Length(f);
+        const float m = std::clamp(value * scale, 0.0f, 1.0f);
+        (*pixels)[n] = mode == SliceMode::kPoynting
+                           ? Color{static_cast<unsigned char>(40 + 120 * m), static_cast<unsigned char>(60 + 195 * m), static_cast<unsigned char>(50 + 120 * m), static_cast<unsigned char>(10 + 210 * m)}
+                           : Color{static_cast<unsigned char>(40 + 200 * m), static_cast<unsigned char>(70 + 160 * m), static_cast<unsigned char>(110 + 145 * m), static_cast<unsigned char>(10 + 210 * m)};
+    }
+    UpdateTexture(texture, pixels->data());
+}
+
+// The slice's first texel axis is world z, the second world x.
+void DrawSlicePlane(Texture2D texture) {
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex3f(-kDomainHalf, kFloorY + 0.02f, -kDomainHalf);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex3f(-kDomainHalf, kFloorY + 0.02f, kDomainHalf);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex3f(kDomainHalf, kFloorY + 0.02f, kDomainHalf);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex3f(kDomainHalf, kFloorY + 0.02f, -kDomainHalf);
+    rlEnd();
+    rlSetTexture(0);
+}
+
+std::string HudLine(PolarizationMode mode, bool rightHanded, float amplitude, float omega, bool paused) {
     std::ostringstream os;
     os << std::fixed << std::setprecision(2)
        << "mode=" << PolarizationName(mode)
        << "  handedness=" << (rightHanded ? "right" : "left")
        << "  A=" << amplitude
-       << "  k=" << waveNumber
+       << "  k=" << omega / kWaveSpeed
        << "  omega=" << omega;
     if (paused) os << "  [PAUSED]";
     return os.str();
@@ -146,24 +251,32 @@ int main() {
     PolarizationMode mode = PolarizationMode::kCircular;
     bool rightHanded = true;
     bool paused = false;
-    float t = 0.0f;
 
     float amplitude = 1.05f;
-    float waveNumber = 1.45f;
     float omega = 2.0f;
     float ellipticity = 0.52f;
 
+    HelixScene scene;
+    ConfigureScene(&scene);
+    SliceMode slice = SliceMode::kPoynting;
+
+    Image sliceImage = GenImageColor(kSliceTexels, kSliceTexels, BLANK);
+    Texture2D sliceTexture = LoadTextureFromImage(sliceImage);
+    UnloadImage(sliceImage);
+    SetTextureFilter(sliceTexture, TEXTURE_FILTER_BILINEAR);
+    std::vector<Vector3> sliceSamples;
+    std::vector<Color> slicePixels;
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
             mode = PolarizationMode::kCircular;
             rightHanded = true;
             paused = false;
-            t = 0.0f;
             amplitude = 1.05f;
-            waveNumber = 1.45f;
             omega = 2.0f;
             ellipticity = 0.52f;
+            ConfigureScene(&scene);
         }
         if (IsKeyPressed(KEY_ONE)) mode = PolarizationMode::kLinear;
         if (IsKeyPressed(KEY_TWO)) mode = PolarizationMode::kCircular;
@@ -173,13 +286,19 @@ int main() {
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) amplitude = std::min(1.9f, amplitude + 0.08f);
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) omega = std::max(0.4f, omega - 0.1f);
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) omega = std::min(6.0f, omega + 0.1f);
-        if (IsKeyPressed(KEY_COMMA)) waveNumber = std::max(0.5f, waveNumber - 0.08f);
-        if (IsKeyPressed(KEY_PERIOD)) waveNumber = std::min(3.0f, waveNumber + 0.08f);
+        if (IsKeyPressed(KEY_V)) slice = static_cast<SliceMode>((static_cast<int>(slice) + 1) % 3);
+        if (IsKeyPressed(KEY_N)) {
+            const auto current = std::find(kGridSizes.begin(), kGridSizes.end(), scene.grid);
+            const size_t next = current == kGridSizes.end() ? 0 : (current - kGridSizes.begin() + 1) % kGridSizes.size();
+            scene.grid = kGridSizes[next];
+            ConfigureScene(&scene);
+        }
         if (IsKeyPressed(KEY_SEMICOLON)) ellipticity = std::max(0.1f, ellipticity - 0.05f);
         if (IsKeyPressed(KEY_APOSTROPHE)) ellipticity = std::min(1.0f, ellipticity + 0.05f);
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
-        if (!paused) t += GetFrameTime();
+        if (!paused) StepScene(&scene, GetFrameTime(), amplitude, omega, mode, ellipticity, rightHanded);
+        UpdateSliceTexture(scene, slice, amplitude, &sliceSamples, &slicePixels, sliceTexture);
 
         BeginDrawing();
         ClearBackground(Color{6, 9, 16, 255});
@@ -189,7 +308,8 @@ int main() {
 
         BeginMode3D(camera);
 
-        DrawPlane({0.0f, -2.0f, 0.0f}, {18.0f, 18.0f}, Color{13, 18, 27, 255});
+        DrawPlane({0.0f, kFloorY, 0.0f}, {18.0f, 18.0f}, Color{13, 18, 27, 255});
+        DrawSlicePlane(sliceTexture);
         DrawLine3D({-7.4f, 0.0f, 0.0f}, {7.4f, 0.0f, 0.0f}, Color{170, 200, 240, 180});
         DrawLine3D({-7.4f, 0.0f, 0.0f}, {7.4f, 0.0f, 0.0f}, Color{170, 200, 240, 40});
 
@@ -197,17 +317,17 @@ int main() {
             DrawLine3D({static_cast<float>(i), -0.04f, -1.8f}, {static_cast<float>(i), -0.04f, 1.8f}, Color{40, 60, 90, 70});
         }
 
-        DrawHelixCurve(true, t, amplitude, waveNumber, omega, mode, ellipticity, rightHanded, Color{110, 225, 255, 255});
-        DrawHelixCurve(false, t, amplitude * 0.82f, waveNumber, omega, mode, ellipticity, rightHanded, Color{255, 175, 115, 255});
+        DrawHelixCurve(scene, true, 1.0f, Color{110, 225, 255, 255});
+        DrawHelixCurve(scene, false, 0.82f, Color{255, 175, 115, 255});
 
         constexpr int kSamples = 13;
         for (int i = 0; i < kSamples; ++i) {
             const float u = static_cast<float>(i) / static_cast<float>(kSamples - 1);
             const float x = -6.0f + 12.0f * u;
             const Vector3 base = {x, 0.0f, 0.0f};
-            const Vector3 e = ElectricField(x, t, amplitude, waveNumber, omega, mode, ellipticity, rightHanded);
-            const Vector3 b = MagneticFieldFromE(e);
-            const Vector3 s = Vector3Scale(Vector3Normalize(Vector3CrossProduct(e, b)), 0.78f);
+            const Vector3 e = AxisField(scene, x, true);
+            const Vector3 b = AxisField(scene, x, false);
+            const Vector3 s = Vector3Scale(Vector3Normalize(Vector3CrossProduct(e, b)), 0.78f * FlowShare(e, b, amplitude));
 
             DrawArrow3D(base, Vector3Add(base, e), 0.018f, Color{110, 225, 255, 255});
             DrawArrow3D(base, Vector3Add(base, b), 0.018f, Color{255, 175, 115, 255});
@@ -218,9 +338,9 @@ int main() {
 
         const float probeX = 1.4f;
         const Vector3 probeBase = {probeX, 0.0f, 0.0f};
-        const Vector3 probeE = ElectricField(probeX, t, amplitude, waveNumber, omega, mode, ellipticity, rightHanded);
-        const Vector3 probeB = MagneticFieldFromE(probeE);
-        const Vector3 probeS = Vector3Scale(Vector3Normalize(Vector3CrossProduct(probeE, probeB)), 1.35f);
+        const Vector3 probeE = AxisField(scene, probeX, true);
+        const Vector3 probeB = AxisField(scene, probeX, false);
+        const Vector3 probeS = Vector3Scale(Vector3Normalize(Vector3CrossProduct(probeE, probeB)), 1.35f * FlowShare(probeE, probeB, amplitude));
         DrawSphere(probeBase, 0.07f, Color{255, 235, 170, 255});
         DrawArrow3D(probeBase, Vector3Add(probeBase, probeE), 0.03f, Color{110, 225, 255, 255});
         DrawArrow3D(probeBase, Vector3Add(probeBase, probeB), 0.03f, Color{255, 175, 115, 255});
@@ -231,9 +351,9 @@ int main() {
         DrawText("Helical EM Wave + Poynting Flow", 20, 18, 31, Color{235, 240, 252, 255});
         DrawText("The electric and magnetic fields rotate as the wave propagates along +x. The green arrows show forward energy transport via the Poynting vector.", 20, 56, 18, Color{170, 186, 214, 255});
         DrawText("Mouse drag: orbit | wheel: zoom | 1 linear | 2 circular | 3 elliptical | H handedness", 20, 84, 17, Color{170, 186, 214, 255});
-        DrawText("[ ] amplitude | +/- omega | , . wave number | ; ' ellipticity | P pause | R reset", 20, 108, 17, Color{170, 186, 214, 255});
+        DrawText("[ ] amplitude | +/- omega | ; ' ellipticity | V floor slice | N grid | P pause | R reset", 20, 108, 17, Color{170, 186, 214, 255});
 
-        const std::string hud = HudLine(mode, rightHanded, amplitude, waveNumber, omega, paused);
+        const std::string hud = HudLine(mode, rightHanded, amplitude, omega, paused);
         DrawText(hud.c_str(), 20, 138, 20, Color{130, 225, 255, 255});
 
         DrawRectangleRounded({1010.0f, 20.0f, 322.0f, 118.0f}, 0.08f, 14, Color{10, 18, 31, 205});
@@ -244,10 +364,18 @@ int main() {
         DrawText("magnetic field B", 1030, 106, 16, Color{178, 193, 216, 255});
 
         DrawText("green arrows below axis: Poynting vector S = E x B", 20, kScreenHeight - 44, 17, Color{170, 255, 180, 255});
+        std::ostringstream solverHud;
+        solverHud << std::fixed << std::setprecision(1) << "FDTD " << scene.grid << "^3 Yee grid, PML " << kPmlCells
+                  << "  t=" << scene.sourceTime << "s  floor slice=" << SliceName(slice);
+        DrawText(solverHud.str().c_str(), 20, kScreenHeight - 70, 17, Color{170, 200, 170, 255});
         DrawFPS(20, 166);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    UnloadTexture(sliceTexture);
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
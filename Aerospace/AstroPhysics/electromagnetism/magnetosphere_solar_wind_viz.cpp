@@ -1,6 +1,10 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/field_line_tracer.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <random>
@@ -13,6 +17,9 @@ constexpr int kScreenHeight = 900;
 constexpr int kWindParticleCount = 720;
 constexpr float kPlanetRadius = 1.55f;
 constexpr float kMagnetopauseRadius = 4.8f;
+constexpr float kTailLength = 14.0f;
+constexpr int kFieldLatitudes = 10;
+constexpr int kFieldLongitudes = 14;
 
 struct OrbitCameraState {
     float yaw = 0.62f;
@@ -69,33 +76,41 @@ std::vector<WindParticle> MakeWindParticles() {
     return particles;
 }
 
-Vector3 DipoleCurvePoint(float shellRadius, float latitude, float longitude) {
-    const float c = std::cos(latitude);
-    const float s = std::sin(latitude);
-    const float radial = shellRadius * c * c;
-    Vector3 p = {radial * c, radial * s, 0.0f};
-    p = Vector3RotateByAxisAngle(p, {0.0f, 1.0f, 0.0f}, longitude);
-    return p;
+// Dipole compressed by its Chapman-Ferraro image at the magnetopause, a stretched tail
+// and a weak southward IMF, traced once at start-up.
+astro_fieldlines::MagnetosphereField MakeMagnetosphereField() {
+    astro_fieldlines::MagnetosphereField field;
+    const float noseField = std::pow(kPlanetRadius / kMagnetopauseRadius, 3.0f);
+    field.moment = kPlanetRadius * kPlanetRadius * kPlanetRadius;
+    field.standoff = kMagnetopauseRadius;
+    field.tailLength = kTailLength;
+    field.sheetThickness = 0.6f;
+    field.tailField = 1.4f * noseField;
+    field.imf = {0.0f, -0.3f * noseField, 0.12f * noseField};
+    return field;
+}
+
+void TraceMagnetosphere(astro_fieldlines::FieldLineCache<astro_fieldlines::MagnetosphereField>* cache) {
+    const astro_fieldlines::MagnetosphereField field = MakeMagnetosphereField();
+    astro_fieldlines::TraceOptions options;
+    options.sampleSpacing = 0.16f;
+    options.innerRadius = kPlanetRadius * 1.02f;
+    options.outerRadius = 9.0f;
+    options.minX = -8.0f;
+    options.maxX = kTailLength;
+    options.maxLength = 80.0f;
+    options.tolerance = 5e-4f;
+    cache->TraceNow(field, astro_fieldlines::DipoleFootpointSeeds(field, kPlanetRadius * 1.03f, kFieldLatitudes, kFieldLongitudes,
+                                                                   22.0f * DEG2RAD, 78.0f * DEG2RAD),
+                    options);
 }
 
-void DrawDipoleFieldLines() {
-    for (int shell = 0; shell < 5; ++shell) {
-        const float shellRadius = 3.1f + shell * 0.9f;
-        for (int az = 0; az < 8; ++az) {
-            const float longitude = (2.0f * PI * az) / 8.0f;
-            Vector3 prev{};
-            bool hasPrev = false;
-            for (int i = 0; i <= 120; ++i) {
-                const float t = -1.22f + 2.44f * static_cast<float>(i) / 120.0f;
-                const Vector3 p = DipoleCurvePoint(shellRadius, t, longitude);
-                if (Vector3Length(p) < kPlanetRadius * 1.02f) {
-                    hasPrev = false;
-                    continue;
-                }
-                if (hasPrev) DrawLine3D(prev, p, Fade(Color{110, 192, 255, 255}, 0.32f));
-                prev = p;
-                hasPrev = true;
-            }
+void DrawDipoleFieldLines(const astro_fieldlines::FieldLineSet& lines) {
+    const float* xyz = lines.xyz.data();
+    for (int line = 0; line < lines.lineCount(); ++line) {
+        const Color color = lines.closed[line] ? Fade(Color{110, 192, 255, 255}, 0.32f) : Fade(Color{150, 170, 255, 255}, 0.22f);
+        for (int v = lines.lineStart[line] + 1; v < lines.lineStart[line + 1]; ++v) {
+            DrawLine3D({xyz[3 * v - 3], xyz[3 * v - 2], xyz[3 * v - 1]}, {xyz[3 * v], xyz[3 * v + 1], xyz[3 * v + 2]}, color);
         }
     }
 }
@@ -163,6 +178,8 @@ int main() {
 
     OrbitCameraState orbit{};
     std::vector<WindParticle> wind = MakeWindParticles();
+    astro_fieldlines::FieldLineCache<astro_fieldlines::MagnetosphereField> fieldLines;
+    TraceMagnetosphere(&fieldLines);
 
     while (!WindowShouldClose()) {
         const float dt = std::max(1.0e-4f, GetFrameTime());
@@ -176,7 +193,7 @@ int main() {
 
         DrawGrid(30, 1.0f);
         DrawBowShock(time);
-        DrawDipoleFieldLines();
+        DrawDipoleFieldLines(fieldLines.lines());
 
         DrawSphere({0.0f, 0.0f, 0.0f}, kPlanetRadius * 1.34f, Fade(Color{72, 168, 255, 255}, 0.08f));
         DrawSphere({0.0f, 0.0f, 0.0f}, kPlanetRadius, Color{52, 102, 188, 255});
@@ -198,9 +215,12 @@ int main() {
         DrawText("Solar wind compresses the dayside field and stretches the nightside magnetotail.", 26, 58, 19, Color{170, 192, 223, 255});
         DrawText("Mouse orbit | wheel zoom", 26, 82, 18, Color{132, 220, 255, 255});
         DrawFPS(GetScreenWidth() - 96, 18);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
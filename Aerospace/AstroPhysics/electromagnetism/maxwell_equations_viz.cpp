@@ -1,6 +1,9 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
@@ -111,9 +114,12 @@ int main() {
         if (paused) DrawText("[PAUSED]", 20, 110, 20, Color{255, 210, 150, 255});
         DrawFPS(20, 138);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,15 +1,106 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+
+#include "../common/fdtd_maxwell.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+// The FDTD cube spans [-kDomainHalf, kDomainHalf]^3 in world units, PML included; the
+// wave is launched by an aperture sheet at kSourceX and shown over |x| <= kViewHalfX.
+constexpr float kDomainHalf = 8.0f;
+constexpr float kViewHalfX = 5.5f;
+constexpr float kSourceX = -5.75f;
+constexpr float kBeamSigma = 2.6f;   // aperture standard deviation, world units
+constexpr float kWaveSpeed = 1.67f;  // world units per second (the old omega / k)
+constexpr int kPmlCells = 8;
+constexpr int kMaxStepsPerFrame = 6;
+constexpr std::array<int, 3> kGridSizes = {64, 128, 256};
+constexpr int kDefaultGrid = 128;
+constexpr int kSliceTexels = 192;
+constexpr Vector3 kObstacleCenter = {2.0f, 0.0f, 0.0f};
+constexpr float kObstacleRadius = 1.0f;
+
+enum class SliceMode { kElectric, kMagnetic, kPoynting };
+
+struct WaveScene {
+    astro_fdtd::YeeSolver solver;
+    astro_fdtd::ApertureSource source;
+    int grid = kDefaultGrid;
+    float amp = 1.0f;
+    float omega = 2.0f;
+    float phase = 0.0f;        // source phase, integrated so omega can change mid-run
+    float sourceTime = 0.0f;   // world seconds since the source was switched on
+    float accumulator = 0.0f;
+    bool obstacle = false;
+};
+
+float CellSize(const WaveScene& scene) { return 2.0f * kDomainHalf / static_cast<float>(scene.grid); }
+float WorldOf(const WaveScene& scene, int i) { return (static_cast<float>(i) - 0.5f * static_cast<float>(scene.grid)) * CellSize(scene); }
+int CellOf(const WaveScene& scene, float x) {
+    return std::clamp(static_cast<int>(std::lround(x / CellSize(scene) + 0.5f * static_cast<float>(scene.grid))), 0, scene.grid - 1);
+}
+// One solver step in world seconds.
+float StepSeconds(const WaveScene& scene) { return astro_fdtd::YeeSolver::kCourant * CellSize(scene) / kWaveSpeed; }
+
+void ApplyObstacle(WaveScene* scene) {
+    if (!scene->obstacle) {
+        scene->solver.ClearConductor();
+        return;
+    }
+    const float r2 = kObstacleRadius * kObstacleRadius;
+    scene->solver.SetConductor([&](int i, int j, int k) {
+        const Vector3 p = {WorldOf(*scene, i), WorldOf(*scene, j), WorldOf(*scene, k)};
+        return Vector3LengthSqr(Vector3Subtract(p, kObstacleCenter)) <= r2;
+    });
+}
+
+void ConfigureScene(WaveScene* scene) {
+    const int n = scene->grid;
+    scene->solver.Configure(n, n, n, kPmlCells);
+    scene->source.Configure(scene->solver, std::max(kPmlCells + 1, CellOf(*scene, kSourceX)), kBeamSigma / CellSize(*scene));
+    scene->phase = 0.0f;
+    scene->sourceTime = 0.0f;
+    scene->accumulator = 0.0f;
+    ApplyObstacle(scene);
+}
+
+// Advances whole solver steps; the source ramps up over its first period.
+void AdvanceScene(WaveScene* scene, int steps) {
+    const float stepSeconds = StepSeconds(*scene);
+    scene->solver.Step(steps, [&](float) {
+        scene->phase += scene->omega * stepSeconds;
+        scene->sourceTime += stepSeconds;
+        const float period = 2.0f * PI / scene->omega;
+        const float ramp = 0.5f - 0.5f * std::cos(PI * std::min(1.0f, scene->sourceTime / period));
+        scene->source.Emit(&scene->solver, scene->amp * ramp * std::sin(scene->phase), 0.0f);
+    });
+}
+
+void StepScene(WaveScene* scene, float dt) {
+    const float stepSeconds = StepSeconds(*scene);
+    scene->accumulator += dt;
+    int steps = static_cast<int>(scene->accumulator / stepSeconds);
+    if (steps > kMaxStepsPerFrame) {
+        steps = kMaxStepsPerFrame;
+        scene->accumulator = 0.0f;
+    } else {
+        scene->accumulator -= static_cast<float>(steps) * stepSeconds;
+    }
+    if (steps > 0) AdvanceScene(scene, steps);
+}
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -32,9 +123,68 @@ void DrawArrow(Vector3 a, Vector3 b, Color c) {
     DrawLine3D(b, Vector3Add(b, Vector3Add(Vector3Scale(d, -0.18f), Vector3Scale(s, 0.09f))), c);
     DrawLine3D(b, Vector3Add(b, Vector3Add(Vector3Scale(d, -0.18f), Vector3Scale(s, -0.09f))), c);
 }
+
+const char* SliceName(SliceMode mode) {
+    switch (mode) {
+        case SliceMode::kElectric: return "E_y";
+        case SliceMode::kMagnetic: return "B_z";
+        case SliceMode::kPoynting: return "S_x";
+    }
+    return "?";
+}
+
+// Horizontal y = 0 slice through the beam: blue/red for the signed component, relative
+// to the source amplitude (S relative to amp^2).
+void UpdateSliceTexture(const WaveScene& scene, SliceMode mode, std::vector<Vector3>* samples, std::vector<Color>* pixels, Texture2D texture) {
+    const astro_fdtd::SliceField field = mode == SliceMode::kElectric ? astro_fdtd::SliceField::kElectric
+                                         : mode == SliceMode::kMagnetic ? astro_fdtd::SliceField::kMagnetic
+                                                                        : astro_fdtd::SliceField::kPoynting;
+    scene.solver.SampleSlice(astro_fdtd::kY, scene.grid / 2, field, kSliceTexels, kSliceTexels, samples);
+    pixels->resize(samples->size());
+    const float scale = mode == SliceMode::kPoynting ? 1.0f / (scene.amp * scene.amp) : 1.0f / scene.amp;
+    for (size_t n = 0; n < samples->size(); ++n) {
+        const Vector3 f = (*samples)[n];
+        const float value = (mode == SliceMode::kElectric ? f.y : mode == SliceMode::kMagnetic ? f.z : f.x) * scale;
+        const float v = std::clamp(value, -1.0f, 1.0f);
+        const float m = std::fabs(v);
+        (*pixels)[n] = v >= 0.0f ? Color{static_cast<unsigned char>(60 + 195 * m), static_cast<unsigned char>(70 + 110 * m), 90, static_cast<unsigned char>(20 + 200 * m)}
+                                 : Color{60, static_cast<unsigned char>(90 + 130 * m), static_cast<unsigned char>(120 + 135 * m), static_cast<unsigned char>(20 + 200 * m)};
+    }
+    UpdateTexture(texture, pixels->data());
+}
+
+// The slice's first texel axis is world z, the second world x.
+void DrawSlicePlane(Texture2D texture) {
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex3f(-kDomainHalf, -0.02f, -kDomainHalf);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex3f(-kDomainHalf, -0.02f, kDomainHalf);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex3f(kDomainHalf, -0.02f, kDomainHalf);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex3f(kDomainHalf, -0.02f, -kDomainHalf);
+    rlEnd();
+    rlSetTexture(0);
+}
 } // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 100, 1.0f / 60.0f);
+    if (bench.enabled) {
+        WaveScene scene;
+        scene.grid = std::max(2 * kPmlCells + 8, astro_bench::IntArg(argc, argv, "--grid", kDefaultGrid));
+        scene.obstacle = astro_bench::HasFlag(argc, argv, "--obstacle");
+        ConfigureScene(&scene);
+        // One bench step is one solver step, whatever the grid.
+        return astro_bench::RunBench(
+            "maxwell_wave_viz", bench,
+            [&](float) { AdvanceScene(&scene, 1); },
+            [&]() { return static_cast<float>(scene.solver.Energy()); });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Maxwell Electromagnetic Wave 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -47,55 +197,94 @@ int main() {
 
     float camYaw = 0.82f, camPitch = 0.34f, camDistance = 14.0f;
 
-    float amp = 1.0f;
-    float k = 1.2f;
-    float omega = 2.0f;
+    WaveScene scene;
+    ConfigureScene(&scene);
+    SliceMode slice = SliceMode::kElectric;
+    bool showSlice = true;
     bool paused = false;
-    float t = 0.0f;
+
+    Image sliceImage = GenImageColor(kSliceTexels, kSliceTexels, BLANK);
+    Texture2D sliceTexture = LoadTextureFromImage(sliceImage);
+    UnloadImage(sliceImage);
+    SetTextureFilter(sliceTexture, TEXTURE_FILTER_BILINEAR);
+    std::vector<Vector3> sliceSamples;
+    std::vector<Color> slicePixels;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_R)) { amp = 1.0f; k = 1.2f; omega = 2.0f; paused = false; t = 0.0f; }
-        if (IsKeyPressed(KEY_LEFT_BRACKET)) amp = std::max(0.2f, amp - 0.1f);
-        if (IsKeyPressed(KEY_RIGHT_BRACKET)) amp = std::min(2.0f, amp + 0.1f);
-        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) omega = std::max(0.3f, omega - 0.1f);
-        if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) omega = std::min(6.0f, omega + 0.1f);
+        if (IsKeyPressed(KEY_R)) {
+            scene.amp = 1.0f;
+            scene.omega = 2.0f;
+            scene.obstacle = false;
+            paused = false;
+            ConfigureScene(&scene);
+        }
+        if (IsKeyPressed(KEY_LEFT_BRACKET)) scene.amp = std::max(0.2f, scene.amp - 0.1f);
+        if (IsKeyPressed(KEY_RIGHT_BRACKET)) scene.amp = std::min(2.0f, scene.amp + 0.1f);
+        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) scene.omega = std::max(0.3f, scene.omega - 0.1f);
+        if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) scene.omega = std::min(6.0f, scene.omega + 0.1f);
+        if (IsKeyPressed(KEY_O)) {
+            scene.obstacle = !scene.obstacle;
+            ApplyObstacle(&scene);
+        }
+        if (IsKeyPressed(KEY_V)) slice = static_cast<SliceMode>((static_cast<int>(slice) + 1) % 3);
+        if (IsKeyPressed(KEY_H)) showSlice = !showSlice;
+        if (IsKeyPressed(KEY_N)) {
+            const auto current = std::find(kGridSizes.begin(), kGridSizes.end(), scene.grid);
+            const size_t next = current == kGridSizes.end() ? 0 : (current - kGridSizes.begin() + 1) % kGridSizes.size();
+            scene.grid = kGridSizes[next];
+            ConfigureScene(&scene);
+        }
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
-        if (!paused) t += GetFrameTime();
+        if (!paused) StepScene(&scene, GetFrameTime());
+        if (showSlice) UpdateSliceTexture(scene, slice, &sliceSamples, &slicePixels, sliceTexture);
 
         BeginDrawing();
         ClearBackground(Color{6, 9, 16, 255});
         BeginMode3D(camera);
         DrawLine3D({-6.0f, 0.0f, 0.0f}, {6.0f, 0.0f, 0.0f}, Color{120, 140, 180, 130});
+        if (showSlice) DrawSlicePlane(sliceTexture);
+        if (scene.obstacle) DrawSphereWires(kObstacleCenter, kObstacleRadius, 10, 14, Color{220, 210, 170, 160});
 
         const int N = 60;
+        const int mid = scene.grid / 2;
+        const float xStart = std::max(-kViewHalfX, WorldOf(scene, scene.source.index()));
         for (int i = 0; i < N; ++i) {
-            float x = -5.5f + 11.0f * static_cast<float>(i) / (N - 1);
-            float ph = k * x - omega * t;
-            float Ey = amp * std::sin(ph);
-            float Bz = Ey;
+            const float x = xStart + (kViewHalfX - xStart) * static_cast<float>(i) / (N - 1);
+            const int cell = CellOf(scene, x);
+            const Vector3 e = scene.solver.ElectricAt(cell, mid, mid);
+            const Vector3 b = scene.solver.MagneticAt(cell, mid, mid);
 
             Vector3 base = {x, 0.0f, 0.0f};
-            DrawArrow(base, {x, Ey, 0.0f}, Color{120, 220, 255, 255});
-            DrawArrow(base, {x, 0.0f, Bz}, Color{255, 180, 120, 255});
+            DrawArrow(base, Vector3Add(base, e), Color{120, 220, 255, 255});
+            DrawArrow(base, Vector3Add(base, b), Color{255, 180, 120, 255});
         }
 
         EndMode3D();
 
         DrawText("Maxwell Wave: E and B Orthogonal Fields", 20, 18, 29, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] amplitude | +/- omega | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] amplitude | +/- omega | O obstacle | V slice field | H slice | N grid | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
 
         std::ostringstream os;
-        os << std::fixed << std::setprecision(2) << "A=" << amp << "  k=" << k << "  omega=" << omega;
+        os << std::fixed << std::setprecision(2) << "A=" << scene.amp << "  k=" << scene.omega / kWaveSpeed << "  omega=" << scene.omega;
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{126, 224, 255, 255});
         DrawText("Blue arrows: Electric field E  |  Orange arrows: Magnetic field B", 20, 110, 18, Color{190, 205, 225, 255});
-        DrawFPS(20, 138);
 
+        std::ostringstream solverHud;
+        solverHud << std::fixed << std::setprecision(1) << "FDTD " << scene.grid << "^3 Yee grid, PML " << kPmlCells
+                  << "  t=" << scene.sourceTime << "s  slice=" << SliceName(slice) << (scene.obstacle ? "  conductor sphere" : "");
+        DrawText(solverHud.str().c_str(), 20, 138, 18, Color{170, 200, 170, 255});
+        DrawFPS(20, 166);
+
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    UnloadTexture(sliceTexture);
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
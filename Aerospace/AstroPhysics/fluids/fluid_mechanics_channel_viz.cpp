@@ -1,6 +1,10 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/stable_fluids.h"
+
 #include <algorithm>
 #include <cmath>
 #include <deque>
@@ -10,6 +14,20 @@ namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 
+// Viscous duct between no-slip walls: uniform inflow at x min, zero-pressure outflow at
+// x max. The profile develops inside the channel instead of being imposed.
+constexpr float kCell = 0.15f;
+constexpr int kGridX = 72;
+constexpr int kGridY = 16;
+constexpr int kGridZ = 14;
+constexpr float kChannelY = 0.6f;
+constexpr float kViscosity = 0.15f;
+constexpr float kDefaultInflow = 1.6f;
+constexpr float kMaxStep = 1.0f / 60.0f;
+constexpr float kProbeX = 4.0f;
+constexpr Vector3 kPostCenter = {-2.0f, kChannelY, 0.0f};
+constexpr float kPostRadius = 0.35f;
+
 struct Marker { Vector3 pos; std::deque<Vector3> trail; };
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
@@ -25,6 +43,49 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
     c->position = Vector3Add(c->target, {*distance * cp * std::cos(*yaw), *distance * std::sin(*pitch), *distance * cp * std::sin(*yaw)});
 }
 
+void ConfigureChannel(astro_fluid::MacFluidSolver* fluid, float inflow, bool post) {
+    astro_fluid::FluidConfig config;
+    config.nx = kGridX;
+    config.ny = kGridY;
+    config.nz = kGridZ;
+    config.cell = kCell;
+    config.origin = {-0.5f * kGridX * kCell, kChannelY - 0.5f * kGridY * kCell, -0.5f * kGridZ * kCell};
+    config.openX = true;
+    config.inflow = inflow;
+    config.viscosity = kViscosity;
+    config.noSlip = true;
+    fluid->Configure(config);
+    if (post) fluid->SetObstacle([](Vector3 p) { return std::hypot(p.x - kPostCenter.x, p.y - kPostCenter.y) - kPostRadius; });
+}
+
+void StepChannel(astro_fluid::MacFluidSolver* fluid, float dt) {
+    while (dt > 0.0f) {
+        const float h = std::min(dt, kMaxStep);
+        fluid->Step(h);
+        dt -= h;
+    }
+}
+
+// Fastest streamwise speed across the section at the probe station.
+float CenterlineMax(const astro_fluid::MacFluidSolver& fluid) {
+    float best = 0.0f;
+    for (int j = 0; j < kGridY; ++j) {
+        for (int k = 0; k < kGridZ; ++k) {
+            const Vector3 c = fluid.CellCenter(0, j, k);
+            best = std::max(best, fluid.Velocity({kProbeX, c.y, c.z}).x);
+        }
+    }
+    return best;
+}
+
+Vector3 MarkerSeed(int idx) {
+    const int iy = idx / 7;
+    const int iz = idx % 7;
+    float y = -1.2f + 2.4f * iy / 8.0f;
+    float z = -1.0f + 2.0f * iz / 6.0f;
+    return {-5.2f, y + kChannelY, z};
+}
+
 }
 
 int main() {
@@ -39,50 +100,54 @@ int main() {
     camera.projection = CAMERA_PERSPECTIVE;
     float camYaw=0.84f, camPitch=0.34f, camDistance=13.2f;
 
-    float umax = 3.2f;
+    float inflow = kDefaultInflow;
     bool paused = false;
+    bool post = false;
+
+    astro_fluid::MacFluidSolver fluid;
+    ConfigureChannel(&fluid, inflow, post);
 
     std::vector<Marker> markers;
-    for (int iy=0; iy<9; ++iy) {
-        for (int iz=0; iz<7; ++iz) {
-            float y = -1.2f + 2.4f * iy / 8.0f;
-            float z = -1.0f + 2.0f * iz / 6.0f;
-            Marker m;
-            m.pos = {-5.2f, y + 0.6f, z};
-            m.trail.push_back(m.pos);
-            markers.push_back(m);
-        }
+    for (int idx=0; idx<9*7; ++idx) {
+        Marker m;
+        m.pos = MarkerSeed(idx);
+        m.trail.push_back(m.pos);
+        markers.push_back(m);
     }
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
+        if (IsKeyPressed(KEY_O)) {
+            post = !post;
+            ConfigureChannel(&fluid, inflow, post);
+        }
         if (IsKeyPressed(KEY_R)) {
-            int idx = 0;
-            for (int iy=0; iy<9; ++iy) {
-                for (int iz=0; iz<7; ++iz) {
-                    float y = -1.2f + 2.4f * iy / 8.0f;
-                    float z = -1.0f + 2.0f * iz / 6.0f;
-                    markers[idx].pos = {-5.2f, y + 0.6f, z};
-                    markers[idx].trail.clear();
-                    markers[idx].trail.push_back(markers[idx].pos);
-                    idx++;
-                }
+            for (int idx=0; idx<static_cast<int>(markers.size()); ++idx) {
+                markers[idx].pos = MarkerSeed(idx);
+                markers[idx].trail.clear();
+                markers[idx].trail.push_back(markers[idx].pos);
             }
             paused = false;
-            umax = 3.2f;
+            inflow = kDefaultInflow;
+            ConfigureChannel(&fluid, inflow, post);
         }
-        if (IsKeyPressed(KEY_LEFT_BRACKET)) umax = std::max(0.5f, umax - 0.2f);
-        if (IsKeyPressed(KEY_RIGHT_BRACKET)) umax = std::min(8.0f, umax + 0.2f);
+        if (IsKeyPressed(KEY_LEFT_BRACKET)) inflow = std::max(0.3f, inflow - 0.1f);
+        if (IsKeyPressed(KEY_RIGHT_BRACKET)) inflow = std::min(5.0f, inflow + 0.1f);
+        fluid.SetInflow(inflow);
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
         if (!paused) {
-            float dt = GetFrameTime();
-            for (auto& m : markers) {
-                float yRel = (m.pos.y - 0.6f) / 1.2f; // -1..1
-                float u = umax * (1.0f - yRel * yRel); // parabolic profile
-                m.pos.x += u * dt;
-                if (m.pos.x > 5.2f) m.pos.x = -5.2f;
+            float dt = std::min(GetFrameTime(), 1.0f / 20.0f);
+            StepChannel(&fluid, dt);
+            for (int idx=0; idx<static_cast<int>(markers.size()); ++idx) {
+                Marker& m = markers[idx];
+                Vector3 mid = Vector3Add(m.pos, Vector3Scale(fluid.Velocity(m.pos), 0.5f*dt));
+                m.pos = Vector3Add(m.pos, Vector3Scale(fluid.Velocity(mid), dt));
+                if (m.pos.x > 5.2f || !fluid.Contains(m.pos) || fluid.Solid(m.pos)) {
+                    m.pos = MarkerSeed(idx);
+                    m.trail.clear();
+                }
                 m.trail.push_back(m.pos);
                 if (m.trail.size() > 120) m.trail.pop_front();
             }
@@ -91,7 +156,11 @@ int main() {
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
-        DrawCubeWires({0.0f, 0.6f, 0.0f}, 10.8f, 2.5f, 2.2f, Color{130,180,255,180});
+        DrawCubeWires({0.0f, kChannelY, 0.0f}, kGridX*kCell, kGridY*kCell, kGridZ*kCell, Color{130,180,255,180});
+        if (post) {
+            DrawCylinderEx({kPostCenter.x, kPostCenter.y, -0.5f*kGridZ*kCell}, {kPostCenter.x, kPostCenter.y, 0.5f*kGridZ*kCell},
+                           kPostRadius, kPostRadius, 20, Color{200,210,230,170});
+        }
 
         for (const auto& m : markers) {
             for (size_t i=1;i<m.trail.size();++i) DrawLine3D(m.trail[i-1], m.trail[i], Color{120,200,255,100});
@@ -100,17 +169,21 @@ int main() {
 
         EndMode3D();
 
-        DrawText("Channel Flow (Laminar Poiseuille Profile)", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] max center velocity | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Channel Flow (Developing Laminar Duct Flow)", 20, 18, 29, Color{232,238,248,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] inflow velocity | O cylinder | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
 
         char buf[180];
-        snprintf(buf, sizeof(buf), "Umax=%.2f (center fastest, wall near zero)%s", umax, paused ? "  [PAUSED]" : "");
+        snprintf(buf, sizeof(buf), "U_in=%.2f  centre max=%.2f at x=%.0f  Re=%.0f%s", inflow, CenterlineMax(fluid), kProbeX,
+                 inflow * kGridY * kCell / kViscosity, paused ? "  [PAUSED]" : "");
         DrawText(buf, 20, 82, 20, Color{126,224,255,255});
         DrawFPS(20, 110);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,34 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/stable_fluids.h"
+#include "../common/trail_buffer.h"
+
 #include <algorithm>
 #include <cmath>
-#include <deque>
 #include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 
-struct Marker { Vector3 pos; std::deque<Vector3> trail; };
+// Quasi-2D free-slip tank: a thin slab of MAC cells around the marker plane.
+constexpr int kGridCells = 64;
+constexpr int kGridLayers = 2;
+constexpr float kTankHalf = 4.5f;
+constexpr float kCell = 2.0f * kTankHalf / kGridCells;
+constexpr float kMarkerY = 0.5f;
+constexpr float kRotorRadius = 0.18f;
+constexpr float kStirRadius = 2.4f;   // gaussian reach of the stirrer's forcing
+constexpr float kStirRate = 1.6f;     // 1/s relaxation toward the target swirl
+constexpr float kMaxStep = 1.0f / 60.0f;
+constexpr Vector3 kPostCenter = {2.1f, kMarkerY, 0.0f};
+constexpr float kPostRadius = 0.35f;
+constexpr int kMarkerTrail = 150;
+
+struct Marker { Vector3 pos; astro_render::TrailBuffer<kMarkerTrail> trail; };
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -25,11 +43,44 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
     c->position = Vector3Add(c->target, {*distance * cp * std::cos(*yaw), *distance * std::sin(*pitch), *distance * cp * std::sin(*yaw)});
 }
 
+// Target swirl the stirrer relaxes the fluid toward; the solver supplies the actual flow.
 Vector3 VortexVel(Vector3 p, float strength) {
     float r2 = p.x*p.x + p.z*p.z + 0.12f;
     return {-strength * p.z / r2, 0.0f, strength * p.x / r2};
 }
 
+void ConfigureTank(astro_fluid::MacFluidSolver* fluid, bool post) {
+    astro_fluid::FluidConfig config;
+    config.nx = kGridCells;
+    config.ny = kGridLayers;
+    config.nz = kGridCells;
+    config.cell = kCell;
+    config.origin = {-kTankHalf, kMarkerY - 0.5f * kGridLayers * kCell, -kTankHalf};
+    fluid->Configure(config);
+    fluid->SetObstacle([post](Vector3 p) {
+        float d = std::sqrt(p.x*p.x + p.z*p.z) - kRotorRadius;
+        if (post) d = std::min(d, std::hypot(p.x - kPostCenter.x, p.z - kPostCenter.z) - kPostRadius);
+        return d;
+    });
+}
+
+void StepTank(astro_fluid::MacFluidSolver* fluid, float strength, float dt) {
+    while (dt > 0.0f) {
+        const float h = std::min(dt, kMaxStep);
+        fluid->Relax(
+            h, [strength](Vector3 p) { return VortexVel(p, strength); },
+            [](Vector3 p) { return kStirRate * std::exp(-(p.x*p.x + p.z*p.z) / (kStirRadius * kStirRadius)); });
+        fluid->Step(h);
+        dt -= h;
+    }
+}
+
+Vector3 MarkerSeed(size_t i) {
+    float a = 2.0f*PI*static_cast<float>(i)/70.0f;
+    float r = 0.6f + 2.8f * std::fmod(i * 0.617f, 1.0f);
+    return {r*std::cos(a), kMarkerY, r*std::sin(a)};
+}
+
 }
 
 int main() {
@@ -46,29 +97,36 @@ int main() {
 
     float strength = 2.0f;
     bool paused = false;
+    bool post = false;
+
+    astro_fluid::MacFluidSolver fluid;
+    ConfigureTank(&fluid, post);
 
     std::vector<Marker> marks;
+    astro_render::TrailRenderer trailRenderer;
+    trailRenderer.Init();
     for (int i=0;i<70;++i) {
-        float a = 2.0f*PI*static_cast<float>(i)/70.0f;
-        float r = 0.6f + 2.8f * std::fmod(i * 0.617f, 1.0f);
         Marker m;
-        m.pos = {r*std::cos(a), 0.5f, r*std::sin(a)};
-        m.trail.push_back(m.pos);
+        m.pos = MarkerSeed(i);
+        m.trail.Push(m.pos);
         marks.push_back(m);
     }
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
+        if (IsKeyPressed(KEY_O)) {
+            post = !post;
+            ConfigureTank(&fluid, post);
+        }
         if (IsKeyPressed(KEY_R)) {
             for (size_t i=0;i<marks.size();++i) {
-                float a = 2.0f*PI*static_cast<float>(i)/70.0f;
-                float r = 0.6f + 2.8f * std::fmod(i * 0.617f, 1.0f);
-                marks[i].pos = {r*std::cos(a), 0.5f, r*std::sin(a)};
-                marks[i].trail.clear();
-                marks[i].trail.push_back(marks[i].pos);
+                marks[i].pos = MarkerSeed(i);
+                marks[i].trail.Clear();
+                marks[i].trail.Push(marks[i].pos);
             }
             paused = false;
             strength = 2.0f;
+            ConfigureTank(&fluid, post);
         }
         if (IsKeyPressed(KEY_LEFT_BRACKET)) strength = std::max(0.2f, strength - 0.2f);
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) strength = std::min(6.0f, strength + 0.2f);
@@ -76,38 +134,52 @@ int main() {
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
         if (!paused) {
-            float dt = GetFrameTime();
-            for (auto& m : marks) {
-                Vector3 v = VortexVel(m.pos, strength);
-                m.pos = Vector3Add(m.pos, Vector3Scale(v, dt));
-                m.trail.push_back(m.pos);
-                if (m.trail.size() > 150) m.trail.pop_front();
+            float dt = std::min(GetFrameTime(), 1.0f / 20.0f);
+            StepTank(&fluid, strength, dt);
+            for (size_t i=0;i<marks.size();++i) {
+                Marker& m = marks[i];
+                Vector3 mid = Vector3Add(m.pos, Vector3Scale(fluid.Velocity(m.pos), 0.5f*dt));
+                m.pos = Vector3Add(m.pos, Vector3Scale(fluid.Velocity(mid), dt));
+                if (!fluid.Contains(m.pos) || fluid.Solid(m.pos)) {
+                    m.pos = MarkerSeed(i);
+                    m.trail.Clear();
+                }
+                m.trail.Push(m.pos);
             }
         }
 
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
-        DrawCylinder({0,0.5f,0}, 0.18f, 0.18f, 1.1f, 20, Color{255,170,120,180});
+        DrawCylinder({0,0.5f,0}, kRotorRadius, kRotorRadius, 1.1f, 20, Color{255,170,120,180});
+        if (post) DrawCylinder({kPostCenter.x, 0.0f, kPostCenter.z}, kPostRadius, kPostRadius, 1.1f, 20, Color{200,210,230,170});
+        DrawCubeWires({0.0f, kMarkerY, 0.0f}, 2.0f*kTankHalf, kGridLayers*kCell, 2.0f*kTankHalf, Color{70,90,120,140});
 
+        trailRenderer.Clear();
         for (const auto& m : marks) {
-            for (size_t i=1;i<m.trail.size();++i) DrawLine3D(m.trail[i-1], m.trail[i], Color{120,200,255,120});
+            trailRenderer.Add(m.trail, Color{120,200,255,120}, 120);
             DrawSphere(m.pos, 0.04f, Color{140,220,255,230});
         }
+        trailRenderer.Draw();
 
         EndMode3D();
 
         DrawText("Fluid Vortex (Swirl Flow Field)", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] vortex strength | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] vortex strength | O post | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
 
         char buf[160];
-        snprintf(buf, sizeof(buf), "strength=%.2f%s", strength, paused ? "  [PAUSED]" : "");
+        snprintf(buf, sizeof(buf), "strength=%.2f  grid=%dx%dx%d  CG iters=%d%s", strength, fluid.nx(), fluid.ny(), fluid.nz(),
+                 fluid.Iterations(), paused ? "  [PAUSED]" : "");
         DrawText(buf, 20, 82, 20, Color{126,224,255,255});
         DrawFPS(20, 110);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    trailRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,6 +1,9 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
@@ -100,9 +103,12 @@ int main() {
         std::snprintf(s, sizeof(s), "M_BH=%.1f%s", mass, paused ? "  [PAUSED]" : "");
         DrawText(s, 20, 82, 20, Color{126, 224, 255, 255});
         DrawFPS(20, 110);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
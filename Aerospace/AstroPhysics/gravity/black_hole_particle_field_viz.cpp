@@ -1,8 +1,16 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/point_cloud.h"
+#include "../common/profiler.h"
+#include "../common/schwarzschild_geodesic.h"
+#include "../common/thread_pool.h"
+
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <random>
 #include <vector>
 
@@ -10,14 +18,22 @@ namespace {
 
 constexpr int kScreenWidth = 1440;
 constexpr int kScreenHeight = 900;
-constexpr int kDiskParticleCount = 2400;
+constexpr int kDefaultDiskParticles = 60000;
+constexpr int kMaxDiskParticles = 1000000;
 constexpr int kOrbitalStarCount = 180;
 constexpr int kGridHalfCount = 15;
 constexpr float kGridSpacing = 1.2f;
-constexpr float kEventHorizonRadius = 1.0f;
-constexpr float kPhotonRingRadius = 1.34f;
-constexpr float kDiskInnerRadius = 1.8f;
-constexpr float kDiskOuterRadius = 8.6f;
+// Geodesics run in units of M (horizon at 2M); the scene is drawn at half a unit per M.
+constexpr float kSceneUnitsPerM = 0.5f;
+constexpr float kMPerSecond = 20.0f;  // coordinate time per second of playback at 1x
+constexpr float kEventHorizonRadius = astro_geodesic::kHorizonRadius * kSceneUnitsPerM;
+constexpr float kPhotonRingRadius = astro_geodesic::kPhotonSphereRadius * kSceneUnitsPerM;
+constexpr float kDiskInnerM = 6.4f;
+constexpr float kDiskOuterM = 17.2f;
+constexpr float kStarInnerM = 14.0f;
+constexpr float kStarOuterM = 32.0f;
+constexpr float kDiskTiltX = 0.92f;
+constexpr float kDiskTiltZ = -0.36f;
 
 struct OrbitCameraState {
     float yaw = 0.52f;
@@ -25,26 +41,6 @@ struct OrbitCameraState {
     float distance = 20.0f;
 };
 
-struct DiskParticle {
-    float radius = 0.0f;
-    float angle = 0.0f;
-    float angularSpeed = 0.0f;
-    float height = 0.0f;
-    float size = 0.0f;
-    float heat = 0.0f;
-};
-
-struct OrbitalStar {
-    float orbitRadius = 0.0f;
-    float phase = 0.0f;
-    float speed = 0.0f;
-    float incline = 0.0f;
-    float yaw = 0.0f;
-    float lift = 0.0f;
-    float size = 0.0f;
-    Color color{};
-};
-
 float RandRange(std::mt19937& rng, float lo, float hi) {
     std::uniform_real_distribution<float> dist(lo, hi);
     return dist(rng);
@@ -89,67 +85,146 @@ void UpdateOrbitCamera360(Camera3D* camera, OrbitCameraState* orbit) {
     camera->up = Vector3Normalize(Vector3CrossProduct(forward, right));
 }
 
-std::vector<DiskParticle> MakeDiskParticles() {
-    std::mt19937 rng(1337);
-    std::vector<DiskParticle> particles;
-    particles.reserve(kDiskParticleCount);
-
-    for (int i = 0; i < kDiskParticleCount; ++i) {
-        const float radius = RandRange(rng, kDiskInnerRadius, kDiskOuterRadius);
-        const float band = 0.5f + 0.5f * std::sin(radius * 2.8f + RandRange(rng, 0.0f, 6.28f));
-        particles.push_back({
-            radius,
-            RandRange(rng, 0.0f, 2.0f * PI),
-            0.22f / std::pow(radius, 0.92f) + RandRange(rng, -0.0025f, 0.0025f),
-            RandRange(rng, -0.10f, 0.10f) * (0.3f + radius / kDiskOuterRadius),
-            RandRange(rng, 0.024f, 0.085f),
-            0.30f + band * 0.70f,
-        });
-    }
+// The disk and the stars live in units of M; the scene draws them kSceneUnitsPerM big.
+Vector3 ToScene(const astro_geodesic::GeodesicBatch& batch, int i) {
+    return {batch.x(i) * kSceneUnitsPerM, batch.y(i) * kSceneUnitsPerM, batch.z(i) * kSceneUnitsPerM};
+}
+
+void SetFromVectors(astro_geodesic::GeodesicBatch* batch, int i, Vector3 pos, Vector3 vel) {
+    const float p[3] = {pos.x, pos.y, pos.z};
+    const float v[3] = {vel.x, vel.y, vel.z};
+    batch->Set(i, p, v);
+}
 
-    return particles;
+// Prograde circular velocity at pos about normal, tilted by `tilt` about the radius and
+// scaled by (1 + boost); a negative boost drops the particle onto an eccentric orbit.
+Vector3 OrbitVelocity(Vector3 pos, Vector3 normal, float tilt, float boost) {
+    const float p[3] = {pos.x, pos.y, pos.z};
+    const float n[3] = {normal.x, normal.y, normal.z};
+    float v[3];
+    astro_geodesic::CircularVelocity(p, n, v);
+    const Vector3 vel = Vector3RotateByAxisAngle({v[0], v[1], v[2]}, Vector3Normalize(pos), tilt);
+    return Vector3Scale(vel, 1.0f + boost);
 }
 
-std::vector<OrbitalStar> MakeOrbitalStars() {
-    std::mt19937 rng(4242);
-    std::vector<OrbitalStar> stars;
-    stars.reserve(kOrbitalStarCount);
-
-    for (int i = 0; i < kOrbitalStarCount; ++i) {
-        const float orbitRadius = RandRange(rng, 7.0f, 16.0f);
-        const float temp = RandRange(rng, 0.0f, 1.0f);
-        stars.push_back({
-            orbitRadius,
-            RandRange(rng, 0.0f, 2.0f * PI),
-            0.045f / std::pow(orbitRadius, 0.70f),
-            RandRange(rng, -1.25f, 1.25f),
-            RandRange(rng, 0.0f, 2.0f * PI),
-            RandRange(rng, -1.6f, 1.6f),
-            RandRange(rng, 0.07f, 0.18f),
-            LerpColor(Color{150, 198, 255, 255}, Color{255, 233, 176, 255}, temp),
-        });
+struct DiskField {
+    astro_geodesic::GeodesicBatch batch;
+    std::vector<float> heat;
+    std::mt19937 rng{1337};
+    Vector3 normal{};
+    Vector3 axisU{};
+    Vector3 axisV{};
+    int captured = 0;
+    int escaped = 0;
+};
+
+// Fresh particles fill the disk on nearly circular orbits; respawned ones enter at the
+// rim on eccentric orbits, so some precess into rosettes and some plunge.
+void SpawnDiskParticle(DiskField* field, int i, bool fresh) {
+    std::mt19937& rng = field->rng;
+    const float r = fresh ? RandRange(rng, kDiskInnerM, kDiskOuterM) : RandRange(rng, 0.85f * kDiskOuterM, kDiskOuterM);
+    const float a = RandRange(rng, 0.0f, 2.0f * PI);
+    const Vector3 pos = Vector3Add(Vector3Scale(field->axisU, r * std::cos(a)), Vector3Scale(field->axisV, r * std::sin(a)));
+    const float tilt = RandRange(rng, -0.03f, 0.03f);
+    const float boost = fresh ? RandRange(rng, -0.05f, 0.02f) : RandRange(rng, -0.45f, 0.0f);
+    SetFromVectors(&field->batch, i, pos, OrbitVelocity(pos, field->normal, tilt, boost));
+    const float band = 0.5f + 0.5f * std::sin(r * 1.4f + RandRange(rng, 0.0f, 6.28f));
+    field->heat[static_cast<size_t>(i)] = 0.30f + band * 0.70f;
+}
+
+void ResetDiskField(DiskField* field, int count) {
+    field->rng.seed(1337);
+    field->normal = Vector3RotateByAxisAngle(Vector3RotateByAxisAngle({0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, kDiskTiltX), {0.0f, 0.0f, 1.0f}, kDiskTiltZ);
+    field->axisU = Vector3RotateByAxisAngle(Vector3RotateByAxisAngle({1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, kDiskTiltX), {0.0f, 0.0f, 1.0f}, kDiskTiltZ);
+    field->axisV = Vector3CrossProduct(field->axisU, field->normal);
+    field->batch.Resize(count);
+    field->heat.assign(static_cast<size_t>(count), 0.0f);
+    field->captured = field->escaped = 0;
+    for (int i = 0; i < count; ++i) SpawnDiskParticle(field, i, true);
+}
+
+// Advances the disk by dtM (in M) and respawns whatever was captured or escaped.
+void StepDiskField(DiskField* field, float dtM) {
+    field->batch.Advance(dtM, astro_geodesic::GeodesicOptions{});
+    for (int i = 0; i < field->batch.size(); ++i) {
+        const astro_geodesic::Fate fate = field->batch.fate(i);
+        if (fate == astro_geodesic::Fate::kOrbiting) continue;
+        (fate == astro_geodesic::Fate::kCaptured ? field->captured : field->escaped)++;
+        SpawnDiskParticle(field, i, false);
     }
+}
+
+// Hotter towards the ISCO, dimmed by the gravitational redshift sqrt(1 - 2/r).
+void FillDiskPoints(const DiskField& field, std::vector<astro_render::CloudPoint>* points) {
+    const int n = field.batch.size();
+    points->resize(static_cast<size_t>(n));
+    astro_parallel::SharedPool().ParallelFor(n, 8192, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const float r = field.batch.radius(i);
+            const float inner = std::clamp((kDiskOuterM - r) / (kDiskOuterM - astro_geodesic::kIscoRadius), 0.0f, 1.0f);
+            Color c = LerpColor(Color{255, 116, 42, 255}, Color{255, 239, 170, 255}, 0.55f * field.heat[static_cast<size_t>(i)] + 0.45f * inner);
+            c.a = static_cast<unsigned char>(200.0f * std::sqrt(std::max(0.0f, 1.0f - 2.0f / r)));
+            (*points)[static_cast<size_t>(i)] = {ToScene(field.batch, i), c};
+        }
+    });
+}
 
-    return stars;
+// Worst |dE^2 / E^2| over an evenly strided sample of the disk.
+float SampledEnergyDrift(const astro_geodesic::GeodesicBatch& batch, int samples) {
+    const int stride = std::max(1, batch.size() / samples);
+    float drift = 0.0f;
+    for (int i = 0; i < batch.size(); i += stride) drift = std::max(drift, batch.EnergyDrift(i));
+    return drift;
 }
 
-Vector3 DiskParticlePosition(const DiskParticle& p, float time) {
-    const float a = p.angle + time * p.angularSpeed;
-    const float x = std::cos(a) * p.radius;
-    const float z = std::sin(a) * p.radius;
-    const float y = p.height + 0.06f * std::sin(a * 3.0f + time * 1.5f);
-    Vector3 pos = {x, y, z};
-    pos = Vector3RotateByAxisAngle(pos, {1.0f, 0.0f, 0.0f}, 0.92f);
-    pos = Vector3RotateByAxisAngle(pos, {0.0f, 0.0f, 1.0f}, -0.36f);
-    return pos;
+struct StarField {
+    astro_geodesic::GeodesicBatch batch;
+    std::vector<float> size;
+    std::vector<Color> color;
+    std::mt19937 rng{4242};
+};
+
+void SpawnOrbitalStar(StarField* stars, int i) {
+    std::mt19937& rng = stars->rng;
+    const float r = RandRange(rng, kStarInnerM, kStarOuterM);
+    const float a = RandRange(rng, 0.0f, 2.0f * PI);
+    const float incline = RandRange(rng, -1.25f, 1.25f);
+    const float yaw = RandRange(rng, 0.0f, 2.0f * PI);
+    auto orient = [&](Vector3 v) {
+        return Vector3RotateByAxisAngle(Vector3RotateByAxisAngle(v, {1.0f, 0.0f, 0.0f}, incline), {0.0f, 1.0f, 0.0f}, yaw);
+    };
+    const Vector3 pos = orient({std::cos(a) * r, 0.0f, std::sin(a) * r});
+    SetFromVectors(&stars->batch, i, pos, OrbitVelocity(pos, orient({0.0f, 1.0f, 0.0f}), 0.0f, RandRange(rng, -0.12f, 0.04f)));
+    stars->size[static_cast<size_t>(i)] = RandRange(rng, 0.07f, 0.18f);
+    stars->color[static_cast<size_t>(i)] = LerpColor(Color{150, 198, 255, 255}, Color{255, 233, 176, 255}, RandRange(rng, 0.0f, 1.0f));
 }
 
-Vector3 OrbitalStarPosition(const OrbitalStar& s, float time) {
-    const float a = s.phase + time * s.speed;
-    Vector3 pos = {std::cos(a) * s.orbitRadius, s.lift, std::sin(a) * s.orbitRadius};
-    pos = Vector3RotateByAxisAngle(pos, {1.0f, 0.0f, 0.0f}, s.incline);
-    pos = Vector3RotateByAxisAngle(pos, {0.0f, 1.0f, 0.0f}, s.yaw);
-    return pos;
+void ResetStarField(StarField* stars) {
+    stars->rng.seed(4242);
+    stars->batch.Resize(kOrbitalStarCount);
+    stars->size.assign(kOrbitalStarCount, 0.0f);
+    stars->color.assign(kOrbitalStarCount, WHITE);
+    for (int i = 0; i < kOrbitalStarCount; ++i) SpawnOrbitalStar(stars, i);
+}
+
+void StepStarField(StarField* stars, float dtM) {
+    stars->batch.Advance(dtM, astro_geodesic::GeodesicOptions{});
+    for (int i = 0; i < stars->batch.size(); ++i) {
+        if (stars->batch.fate(i) != astro_geodesic::Fate::kOrbiting) SpawnOrbitalStar(stars, i);
+    }
+}
+
+// Circle of radius rM (in M) in the disk plane.
+void DrawDiskCircle(const DiskField& field, float rM, Color color) {
+    constexpr int kSegments = 96;
+    const float r = rM * kSceneUnitsPerM;
+    Vector3 prev = Vector3Scale(field.axisU, r);
+    for (int k = 1; k <= kSegments; ++k) {
+        const float a = 2.0f * PI * k / kSegments;
+        const Vector3 p = Vector3Add(Vector3Scale(field.axisU, r * std::cos(a)), Vector3Scale(field.axisV, r * std::sin(a)));
+        DrawLine3D(prev, p, color);
+        prev = p;
+    }
 }
 
 Vector3 WarpGridPoint(Vector3 p, float time) {
@@ -208,7 +283,27 @@ void DrawBackdropStars(const Camera3D& camera) {
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const int particleCount = std::clamp(astro_bench::IntArg(argc, argv, "--particles", kDefaultDiskParticles), 8, kMaxDiskParticles);
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // One bench step is a frame at 1x: the geodesic step, respawns and the point fill.
+        DiskField disk;
+        ResetDiskField(&disk, particleCount);
+        std::vector<astro_render::CloudPoint> points;
+        return astro_bench::RunBench(
+            "black_hole_particle_field_viz", bench,
+            [&](float dt) {
+                StepDiskField(&disk, dt * kMPerSecond);
+                FillDiskPoints(disk, &points);
+            },
+            [&]() {
+                double sum = 0.0;
+                for (int i = 0; i < disk.batch.size(); ++i) sum += disk.batch.radius(i);
+                return sum / disk.batch.size() + disk.captured;
+            });
+    }
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
     InitWindow(kScreenWidth, kScreenHeight, "Black Hole Particle Field - C++ (raylib)");
     SetWindowMinSize(980, 620);
@@ -222,11 +317,39 @@ int main() {
     camera.projection = CAMERA_PERSPECTIVE;
 
     OrbitCameraState orbit{};
-    std::vector<DiskParticle> disk = MakeDiskParticles();
-    std::vector<OrbitalStar> stars = MakeOrbitalStars();
+    DiskField disk;
+    ResetDiskField(&disk, particleCount);
+    StarField stars;
+    ResetStarField(&stars);
+    std::vector<astro_render::CloudPoint> points;
+    astro_render::PointCloudBuffer cloud;
+    cloud.Init(static_cast<size_t>(particleCount));
+
+    float time = 0.0f;
+    float timeScale = 1.0f;
+    bool paused = false;
+    float drift = 0.0f;
+    int frame = 0;
 
     while (!WindowShouldClose()) {
-        const float time = static_cast<float>(GetTime());
+        if (IsKeyPressed(KEY_SPACE)) paused = !paused;
+        if (IsKeyPressed(KEY_UP)) timeScale = std::min(timeScale * 1.5f, 16.0f);
+        if (IsKeyPressed(KEY_DOWN)) timeScale = std::max(timeScale / 1.5f, 0.25f);
+        if (IsKeyPressed(KEY_R)) {
+            ResetDiskField(&disk, particleCount);
+            ResetStarField(&stars);
+        }
+
+        const float dt = std::min(GetFrameTime(), 1.0f / 30.0f);
+        time += dt;
+        if (!paused) {
+            StepDiskField(&disk, dt * timeScale * kMPerSecond);
+            StepStarField(&stars, dt * timeScale * kMPerSecond);
+        }
+        FillDiskPoints(disk, &points);
+        cloud.Clear();
+        cloud.Append(points.data(), points.size());
+        if (frame++ % 30 == 0) drift = SampledEnergyDrift(disk.batch, 4096);
         UpdateOrbitCamera360(&camera, &orbit);
 
         BeginDrawing();
@@ -236,19 +359,18 @@ int main() {
         DrawBackdropStars(camera);
         DrawWarpedGrid(time);
 
-        for (const OrbitalStar& star : stars) {
-            const Vector3 p = OrbitalStarPosition(star, time);
-            DrawSphere(p, star.size * 1.9f, Fade(star.color, 0.08f));
-            DrawSphere(p, star.size, star.color);
+        for (int i = 0; i < stars.batch.size(); ++i) {
+            const Vector3 p = ToScene(stars.batch, i);
+            const float size = stars.size[static_cast<size_t>(i)];
+            const Color color = stars.color[static_cast<size_t>(i)];
+            DrawSphere(p, size * 1.9f, Fade(color, 0.08f));
+            DrawSphere(p, size, color);
         }
 
-        for (const DiskParticle& particle : disk) {
-            const Vector3 p = DiskParticlePosition(particle, time);
-            const float heat = particle.heat;
-            const Color c = LerpColor(Color{255, 116, 42, 255}, Color{255, 239, 170, 255}, heat);
-            DrawSphere(p, particle.size * 1.65f, Fade(c, 0.12f + 0.10f * heat));
-            DrawSphere(p, particle.size, Fade(c, 0.75f));
-        }
+        BeginBlendMode(BLEND_ADDITIVE);
+        cloud.Draw(2.0f);
+        EndBlendMode();
+        DrawDiskCircle(disk, astro_geodesic::kIscoRadius, Fade(Color{120, 220, 255, 255}, 0.35f));
 
         DrawSphere({0.0f, 0.0f, 0.0f}, kPhotonRingRadius * 1.55f, Fade(Color{98, 144, 255, 255}, 0.05f));
         DrawSphere({0.0f, 0.0f, 0.0f}, kPhotonRingRadius, Fade(Color{255, 194, 120, 255}, 0.20f));
@@ -257,13 +379,24 @@ int main() {
 
         EndMode3D();
 
-        DrawRectangle(12, 12, 350, 86, Fade(BLACK, 0.28f));
+        char line[160];
+        DrawRectangle(12, 12, 560, 144, Fade(BLACK, 0.28f));
         DrawText("Black Hole Particle Field", 24, 24, 28, Color{234, 240, 252, 255});
-        DrawText("Mouse drag: 360 orbit   Wheel: zoom", 24, 58, 20, Color{162, 184, 220, 255});
+        DrawText("Mouse drag: 360 orbit   Wheel: zoom   Space: pause   Up/Down: speed   R: reset", 24, 58, 18, Color{162, 184, 220, 255});
+        std::snprintf(line, sizeof(line), "%d geodesics (%s RK4, %d steps)   %.2fx%s", disk.batch.size(), astro_soa::SimdPathName(),
+                      disk.batch.substeps(), timeScale, paused ? "  paused" : "");
+        DrawText(line, 24, 84, 18, Color{200, 214, 236, 255});
+        std::snprintf(line, sizeof(line), "captured %d   escaped %d   |dE/E| %.1e", disk.captured, disk.escaped, drift);
+        DrawText(line, 24, 106, 18, Color{255, 206, 150, 255});
+        DrawText("Cyan ring: ISCO (6M)   Photon sphere 3M   Horizon 2M", 24, 128, 18, Color{150, 214, 240, 255});
         DrawFPS(GetScreenWidth() - 98, 18);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    cloud.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
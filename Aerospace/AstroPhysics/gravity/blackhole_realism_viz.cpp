@@ -1,5 +1,11 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/colormap.h"
+#include "../common/frame_capture.h"
+#include "../common/geodesic_lensing.h"
+#include "../common/parametric_mesh.h"
+#include "../common/profiler.h"
+#include "../common/starfield.h"
 
 #include <algorithm>
 #include <cmath>
@@ -23,6 +29,14 @@ constexpr int kExitStarCount = 980;
 constexpr int kGasCloudCount = 42;
 constexpr float kDiskInnerRadius = 2.2f;
 constexpr float kDiskOuterRadius = 12.0f;
+constexpr int kFaintSkyStarCount = 2600;
+constexpr int kTunnelRings = 96;      // surface rings across the window around the camera
+constexpr int kTunnelSegments = 64;   // around the throat
+constexpr int kTunnelWireRings = 16;
+constexpr float kTunnelBehind = 22.0f;  // window of the tunnel drawn around the camera's z
+constexpr float kTunnelAhead = 16.0f;
+constexpr float kLensingSpins[] = {0.0f, 0.6f, 0.95f};
+constexpr int kLensingSpinCount = static_cast<int>(sizeof(kLensingSpins) / sizeof(kLensingSpins[0]));
 
 struct BackgroundStar {
     float theta = 0.0f;
@@ -144,9 +158,12 @@ std::string FormatFloat(float value, int decimals = 2) {
     return out.str();
 }
 
-Color TemperatureColor(float t) {
-    return LerpColor(Color{150, 196, 255, 255}, Color{255, 230, 174, 255}, t);
-}
+const astro_color::Colormap kTemperatureMap = astro_color::Colormap::FromStops({
+    {0.0f, Color{150, 196, 255, 255}},
+    {1.0f, Color{255, 230, 174, 255}},
+});
+
+Color TemperatureColor(float t) { return kTemperatureMap(t); }
 
 Color ShiftSpectrum(Color base, float shift) {
     const float t = Clamp01((shift - 0.8f) / 4.0f);
@@ -175,6 +192,28 @@ std::vector<BackgroundStar> BuildStars() {
     return stars;
 }
 
+// The sprite stars plus a faint population, as directions for the lensing cubemap.
+std::vector<astro_render::SkyStar> BuildSkyStars(const std::vector<BackgroundStar>& stars) {
+    std::mt19937 rng(515151);
+    std::uniform_real_distribution<float> unitDist(0.0f, 1.0f);
+
+    std::vector<astro_render::SkyStar> sky;
+    sky.reserve(stars.size() + kFaintSkyStarCount);
+    for (const BackgroundStar& star : stars) {
+        const Vector3 dir = {std::cos(star.phi) * std::cos(star.theta), std::sin(star.phi), std::cos(star.phi) * std::sin(star.theta)};
+        sky.push_back({dir, 0.6f + 6.0f * star.size, TemperatureColor(star.temperature)});
+    }
+    for (int i = 0; i < kFaintSkyStarCount; ++i) {
+        const float z = Mix(-1.0f, 1.0f, unitDist(rng));
+        const float phi = 2.0f * PI * unitDist(rng);
+        const float ring = std::sqrt(1.0f - z * z);
+        Color c = TemperatureColor(unitDist(rng));
+        c.a = static_cast<unsigned char>(40 + 120 * unitDist(rng));
+        sky.push_back({{ring * std::cos(phi), z, ring * std::sin(phi)}, 0.7f, c});
+    }
+    return sky;
+}
+
 std::vector<DiskParticle> BuildDiskParticles() {
     std::mt19937 rng(31337);
     std::uniform_real_distribution<float> angleDist(0.0f, 2.0f * PI);
@@ -333,6 +372,13 @@ Vector3 DiskParticlePosition(const DiskParticle& p, float timeSeconds, const Phy
     return pos;
 }
 
+// Orbital angular momentum direction of the disk particles: they circle -y before
+// DiskParticlePosition applies its tilt.
+Vector3 DiskNormal() {
+    Vector3 n = Vector3RotateByAxisAngle({0.0f, -1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, 0.95f);
+    return Vector3RotateByAxisAngle(n, {0.0f, 0.0f, 1.0f}, -0.28f);
+}
+
 Vector3 InfallPathPosition(float radiusRs, float timeSeconds) {
     const float angle = -0.30f + 0.04f * std::sin(timeSeconds * 0.25f);
     Vector3 p = {
@@ -461,44 +507,58 @@ void DrawBackgroundGradient(const PhysicsState& state) {
     DrawRectangleGradientV(0, 0, GetScreenWidth(), GetScreenHeight(), top, bottom);
 }
 
-void DrawBackgroundStars3D(const std::vector<BackgroundStar>& stars, const PhysicsState& state, float timeSeconds) {
-    const float fade = 1.0f - 0.72f * state.wormholeBlend;
-    for (const BackgroundStar& star : stars) {
-        const float theta = star.theta + timeSeconds * 0.0016f;
-        const float phi = star.phi + 0.015f * std::sin(timeSeconds * 0.12f + star.twinkle);
-        const Vector3 p = {
-            star.radius * std::cos(phi) * std::cos(theta),
-            star.radius * std::sin(phi),
-            star.radius * std::cos(phi) * std::sin(theta)
-        };
-        const float twinkle = 0.55f + 0.45f * std::sin(timeSeconds * 1.2f + star.twinkle);
-        Color c = ShiftSpectrum(TemperatureColor(star.temperature), Mix(1.0f, state.frontShift, 0.15f));
-        c = ScaleColor(c, fade * twinkle, static_cast<unsigned char>((90 + 110 * twinkle) * fade));
-        DrawSphere(p, star.size, c);
-    }
+// The twinkle used to scale both colour and alpha; on the GPU it scales alpha only, with
+// the mean and swing of their product: (0.55 + 0.45 sin) * (90 + 110 * that) / 255.
+astro_render::StarfieldStar BackgroundStarSprite(const BackgroundStar& star) {
+    const Vector3 pos = {
+        star.radius * std::cos(star.phi) * std::cos(star.theta),
+        star.radius * std::sin(star.phi),
+        star.radius * std::cos(star.phi) * std::sin(star.theta)
+    };
+    Color color = TemperatureColor(star.temperature);
+    color.a = static_cast<unsigned char>(255.0f * 0.325f);
+    return {pos, star.size, color, 1.2f, star.twinkle, 0.372f / 0.325f, 0.0f};
 }
 
-void DrawExitStars3D(const std::vector<BackgroundStar>& stars, const PhysicsState& state, float timeSeconds) {
-    const float fade = state.exitProgress * state.wormholeBlend;
-    if (fade <= 0.01f) return;
+// Exit-side stars: (0.68 + 0.32 sin) * (80 + 130 * that) / 255.
+astro_render::StarfieldStar ExitStarSprite(const BackgroundStar& star) {
+    const Vector3 pos = {
+        star.radius * std::cos(star.phi) * std::cos(star.theta),
+        star.radius * std::sin(star.phi),
+        star.radius * std::cos(star.phi) * std::sin(star.theta)
+    };
+    Color color = LerpColor(Color{160, 205, 255, 255}, Color{190, 255, 248, 255}, star.temperature);
+    color.a = static_cast<unsigned char>(255.0f * 0.449f);
+    return {pos, star.size, color, 1.6f, star.twinkle, 0.322f / 0.449f, 0.0f};
+}
 
-    for (const BackgroundStar& star : stars) {
-        const float theta = star.theta + timeSeconds * 0.0008f;
-        const float phi = star.phi + 0.008f * std::sin(timeSeconds * 0.18f + star.twinkle);
-        Vector3 p = {
-            star.radius * std::cos(phi) * std::cos(theta),
-            star.radius * std::sin(phi),
-            star.radius * std::cos(phi) * std::sin(theta)
-        };
-        p.z -= 78.0f;
-        p.x += 10.0f;
-        p.y += 4.0f;
-
-        const float twinkle = 0.68f + 0.32f * std::sin(timeSeconds * 1.6f + star.twinkle);
-        Color c = LerpColor(Color{160, 205, 255, 255}, Color{190, 255, 248, 255}, star.temperature);
-        c = ScaleColor(c, fade * twinkle, static_cast<unsigned char>((80 + 130 * twinkle) * fade));
-        DrawSphere(p, star.size, c);
-    }
+std::vector<astro_render::StarfieldStar> StarSprites(const std::vector<BackgroundStar>& stars,
+                                                     astro_render::StarfieldStar (*sprite)(const BackgroundStar&)) {
+    std::vector<astro_render::StarfieldStar> sprites;
+    sprites.reserve(stars.size());
+    for (const BackgroundStar& star : stars) sprites.push_back(sprite(star));
+    return sprites;
+}
+
+void DrawBackgroundStars3D(astro_render::StarfieldLayer* stars, const PhysicsState& state, float timeSeconds) {
+    astro_render::StarfieldView view;
+    view.time = timeSeconds;
+    view.spin = timeSeconds * 0.0016f;
+    view.fade = 1.0f - 0.72f * state.wormholeBlend;
+    // ShiftSpectrum() at the blueshifted end, as one uniform for the whole sky.
+    view.tint = Color{110, 220, 255, 255};
+    view.tintAmount = Clamp01((Mix(1.0f, state.frontShift, 0.15f) - 0.8f) / 4.0f);
+    stars->Draw(view);
+}
+
+void DrawExitStars3D(astro_render::StarfieldLayer* stars, const PhysicsState& state, float timeSeconds) {
+    astro_render::StarfieldView view;
+    view.time = timeSeconds;
+    view.spin = timeSeconds * 0.0008f;
+    view.offset = {10.0f, 4.0f, -78.0f};
+    view.fade = state.exitProgress * state.wormholeBlend;
+    if (view.fade <= 0.01f) return;
+    stars->Draw(view);
 }
 
 void DrawAccretionDisk3D(const std::vector<DiskParticle>& particles, const Camera3D& camera,
@@ -555,16 +615,135 @@ void DrawBlackHoleCore(const PhysicsState& state, float timeSeconds, float fade)
     DrawSphereWires({0.0f, 0.0f, 0.0f}, 1.06f, 20, 20, Fade(Color{180, 205, 230, 255}, 0.14f * fade));
 }
 
-void DrawWormholeSurface(const PhysicsState& state, float timeSeconds, float cameraZ) {
+// The wormhole throat on the GPU: both buffers hold (u fraction across the window,
+// theta, flat-shading cell) and the shader evaluates WormholePoint and the cell colour
+// from uniforms, so the morphing throat, the window following the camera and the
+// pulse cost nothing on the CPU. Same lattice as DrawWormholeSurfaceImmediate.
+class WormholeTunnelMesh {
+  public:
+    bool Init() {
+        const float ringStep = 1.0f / static_cast<float>(kTunnelRings - 1);
+        const float segStep = 2.0f * PI / static_cast<float>(kTunnelSegments);
+        std::vector<Vector4> triangles;
+        triangles.reserve(static_cast<size_t>((kTunnelRings - 1) * kTunnelSegments * 3));
+        for (int i = 0; i < kTunnelRings - 1; ++i) {
+            const float f0 = ringStep * static_cast<float>(i);
+            const float f1 = ringStep * static_cast<float>(i + 1);
+            const float mid = 0.5f * (f0 + f1);
+            for (int j = 0; j < kTunnelSegments; ++j) {
+                const float t0 = segStep * static_cast<float>(j);
+                const float t1 = segStep * static_cast<float>(j + 1);
+                triangles.push_back({f0, t0, mid, t0});
+                triangles.push_back({f1, t0, mid, t0});
+                triangles.push_back({f0, t1, mid, t0});
+            }
+        }
+        std::vector<Vector4> lines;
+        lines.reserve(static_cast<size_t>(kTunnelWireRings * kTunnelSegments * 2));
+        for (int ring = 0; ring < kTunnelWireRings; ++ring) {
+            const float f = static_cast<float>(ring) / static_cast<float>(kTunnelWireRings - 1);
+            for (int j = 0; j < kTunnelSegments; ++j) {
+                lines.push_back({f, segStep * static_cast<float>(j), f, 0.0f});
+                lines.push_back({f, segStep * static_cast<float>(j + 1), f, 0.0f});
+            }
+        }
+        if (!surface_.Init(kVertexShader, kFragmentShader, astro_render::ParametricPrimitive::kTriangles, triangles) ||
+            !wire_.Init(kVertexShader, kFragmentShader, astro_render::ParametricPrimitive::kLines, lines)) {
+            Unload();
+            return false;
+        }
+        surfaceLocs_ = Locations::Of(surface_);
+        wireLocs_ = Locations::Of(wire_);
+        return true;
+    }
+
+    void Unload() {
+        surface_.Unload();
+        wire_.Unload();
+    }
+
+    bool ready() const { return surface_.ready() && wire_.ready(); }
+
+    void Draw(const PhysicsState& state, float timeSeconds, float cameraZ) const {
+        const float blend = state.wormholeBlend;
+        const Vector4 profile = {Mix(1.25f, 2.60f, blend), Mix(0.18f, 0.055f, blend), cameraZ - kTunnelBehind, cameraZ + kTunnelAhead};
+        const Vector4 view = {cameraZ, timeSeconds, blend * (1.0f - 0.55f * state.exitProgress), blend};
+        const float wireAlpha = (0.04f + 0.12f * blend) * (1.0f - 0.60f * state.exitProgress);
+        DrawPass(surface_, surfaceLocs_, profile, view, {0.0f, 0.0f, 0.0f, -1.0f});
+        DrawPass(wire_, wireLocs_, profile, view, {90.0f / 255.0f, 190.0f / 255.0f, 1.0f, wireAlpha});
+    }
+
+  private:
+    struct Locations {
+        int profile = -1;
+        int view = -1;
+        int wireColor = -1;
+
+        static Locations Of(const astro_render::ParametricMesh& mesh) {
+            return {mesh.Uniform("profile"), mesh.Uniform("view"), mesh.Uniform("wireColor")};
+        }
+    };
+
+    static void DrawPass(const astro_render::ParametricMesh& mesh, const Locations& locs, Vector4 profile, Vector4 view,
+                         Vector4 wireColor) {
+        mesh.Begin();
+        mesh.SetVec4(locs.profile, profile);
+        mesh.SetVec4(locs.view, view);
+        mesh.SetVec4(locs.wireColor, wireColor);
+        mesh.Draw();
+        mesh.End();
+    }
+
+    // Surface cells skip the ring band right around the camera, as the immediate path does.
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec4 vertexParams;
+uniform mat4 mvp;
+uniform vec4 profile;    // throat radius, flare, window start, window end
+uniform vec4 view;       // camera z, time, colour scale, blend
+uniform vec4 wireColor;  // alpha < 0 for the surface
+out vec4 fragColor;
+void main() {
+    float u = mix(profile.z, profile.w, vertexParams.x);
+    float r = profile.x + profile.y * u * u;
+    gl_Position = mvp * vec4(r * cos(vertexParams.y), r * sin(vertexParams.y), u, 1.0);
+    if (wireColor.a >= 0.0) {
+        fragColor = abs(u - view.x) < 1.4 ? vec4(0.0) : wireColor;
+        return;
+    }
+    float uMid = mix(profile.z, profile.w, vertexParams.z);
+    float glow = 0.24 + 0.76 * (1.0 - min(1.0, abs(uMid - view.x) / 20.0));
+    float pulse = 0.60 + 0.40 * sin(view.y * 1.3 + uMid * 1.2 + vertexParams.w * 4.0);
+    vec3 c = mix(vec3(38.0, 84.0, 126.0), vec3(98.0, 236.0, 255.0), clamp(glow * pulse, 0.0, 1.0)) / 255.0;
+    float alpha = (18.0 + 74.0 * view.w * glow) / 255.0;
+    fragColor = abs(uMid - view.x) < 1.8 ? vec4(0.0) : vec4(clamp(c * max(view.z, 0.0), 0.0, 1.0), alpha);
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main() {
+    if (fragColor.a <= 0.0) discard;
+    finalColor = fragColor;
+}
+)";
+
+    astro_render::ParametricMesh surface_;
+    astro_render::ParametricMesh wire_;
+    Locations surfaceLocs_;
+    Locations wireLocs_;
+};
+
+void DrawWormholeSurfaceImmediate(const PhysicsState& state, float timeSeconds, float cameraZ) {
     const float blend = state.wormholeBlend;
     if (blend <= 0.01f) return;
 
     const float throatRadius = Mix(1.25f, 2.60f, blend);
     const float flare = Mix(0.18f, 0.055f, blend);
-    const int rings = 96;
-    const int segs = 64;
-    const float uMin = cameraZ - 22.0f;
-    const float uMax = cameraZ + 16.0f;
+    const int rings = kTunnelRings;
+    const int segs = kTunnelSegments;
+    const float uMin = cameraZ - kTunnelBehind;
+    const float uMax = cameraZ + kTunnelAhead;
 
     for (int i = 0; i < rings - 1; ++i) {
         const float u0 = uMin + (uMax - uMin) * static_cast<float>(i) / static_cast<float>(rings - 1);
@@ -586,8 +765,8 @@ void DrawWormholeSurface(const PhysicsState& state, float timeSeconds, float cam
         }
     }
 
-    for (int ring = 0; ring < 16; ++ring) {
-        const float u = uMin + (uMax - uMin) * static_cast<float>(ring) / 15.0f;
+    for (int ring = 0; ring < kTunnelWireRings; ++ring) {
+        const float u = uMin + (uMax - uMin) * static_cast<float>(ring) / static_cast<float>(kTunnelWireRings - 1);
         if (std::fabs(u - cameraZ) < 1.4f) continue;
         for (int j = 0; j < segs; ++j) {
             const float t0 = 2.0f * PI * static_cast<float>(j) / static_cast<float>(segs);
@@ -599,6 +778,15 @@ void DrawWormholeSurface(const PhysicsState& state, float timeSeconds, float cam
     }
 }
 
+void DrawWormholeSurface(const WormholeTunnelMesh& mesh, const PhysicsState& state, float timeSeconds, float cameraZ) {
+    if (state.wormholeBlend <= 0.01f) return;
+    if (mesh.ready()) {
+        mesh.Draw(state, timeSeconds, cameraZ);
+    } else {
+        DrawWormholeSurfaceImmediate(state, timeSeconds, cameraZ);
+    }
+}
+
 void DrawDestinationGasClouds(const std::vector<GasCloud>& clouds, const PhysicsState& state, float timeSeconds) {
     const float fade = state.exitProgress * state.wormholeBlend;
     if (fade <= 0.01f) return;
@@ -708,7 +896,8 @@ void DrawExitBloom(const PhysicsState& state) {
                        Color{0, 0, 0, 0});
 }
 
-void DrawScene(const Camera3D& camera, const std::vector<BackgroundStar>& stars, const std::vector<BackgroundStar>& exitStars,
+void DrawScene(const Camera3D& camera, astro_render::StarfieldLayer* stars, astro_render::StarfieldLayer* exitStars,
+               const WormholeTunnelMesh& tunnelMesh,
                const std::vector<DiskParticle>& disk, const std::vector<TunnelParticle>& tunnel,
                const std::vector<DestinationPlanet>& planets, const std::vector<GasCloud>& clouds,
                const PhysicsState& state, float timeSeconds) {
@@ -716,7 +905,7 @@ void DrawScene(const Camera3D& camera, const std::vector<BackgroundStar>& stars,
     DrawBackgroundStars3D(stars, state, timeSeconds);
     DrawExitStars3D(exitStars, state, timeSeconds);
     DrawDestinationGasClouds(clouds, state, timeSeconds);
-    DrawWormholeSurface(state, timeSeconds, camera.position.z);
+    DrawWormholeSurface(tunnelMesh, state, timeSeconds, camera.position.z);
     DrawTunnelParticles(tunnel, state, timeSeconds);
     DrawExitQuasar(state, timeSeconds);
     DrawQuasarLensingArcs(state, timeSeconds);
@@ -739,8 +928,8 @@ std::string PhaseLabel(const PhysicsState& state) {
     return "exit galaxy";
 }
 
-void DrawCompactHud(const PhysicsState& state, float currentRadiusRs, bool autoDive) {
-    Rectangle card = {24.0f, static_cast<float>(GetScreenHeight()) - 116.0f, 420.0f, 86.0f};
+void DrawCompactHud(const PhysicsState& state, float currentRadiusRs, bool autoDive, const std::string& lensLine) {
+    Rectangle card = {24.0f, static_cast<float>(GetScreenHeight()) - 136.0f, 420.0f, 106.0f};
     DrawRectangleRounded(card, 0.18f, 12, Color{7, 10, 15, 168});
     DrawRectangleRoundedLinesEx(card, 0.18f, 12, 1.0f, Color{62, 78, 102, 190});
 
@@ -749,12 +938,14 @@ void DrawCompactHud(const PhysicsState& state, float currentRadiusRs, bool autoD
     std::string line2 = "clock " + FormatFloat(state.clockRate, 3) + "   tidal " + FormatFloat(state.tidal, 2) + "   blend " + FormatFloat(state.wormholeBlend, 2);
     DrawText(line1.c_str(), static_cast<int>(card.x) + 14, static_cast<int>(card.y) + 40, 17, Color{162, 186, 214, 255});
     DrawText(line2.c_str(), static_cast<int>(card.x) + 14, static_cast<int>(card.y) + 60, 17, Color{110, 220, 255, 255});
+    DrawText(lensLine.c_str(), static_cast<int>(card.x) + 14, static_cast<int>(card.y) + 80, 17, Color{255, 196, 132, 255});
     if (autoDive) DrawText("AUTO DIVE", static_cast<int>(card.x) + 314, static_cast<int>(card.y) + 10, 15, Color{255, 144, 96, 255});
 }
 
 void DrawHelpOverlay() {
     DrawText("drag to look   wheel / W,S change depth   space auto-dive   R reset   H hide help",
              24, 24, 18, Color{176, 184, 196, 185});
+    DrawText("L geodesic lensing   K spin   F render scale", 24, 48, 18, Color{176, 184, 196, 185});
 
     Rectangle note = {static_cast<float>(GetScreenWidth()) - 360.0f, 24.0f, 328.0f, 88.0f};
     DrawRectangleRounded(note, 0.16f, 12, Color{8, 12, 18, 158});
@@ -773,7 +964,10 @@ int main() {
     SetTargetFPS(60);
 
     const std::vector<BackgroundStar> stars = BuildStars();
-    const std::vector<BackgroundStar> exitStars = BuildExitStars();
+    astro_render::StarfieldLayer starLayer;
+    starLayer.Init(astro_render::StarfieldSpace::kWorldBillboard, StarSprites(stars, BackgroundStarSprite));
+    astro_render::StarfieldLayer exitStarLayer;
+    exitStarLayer.Init(astro_render::StarfieldSpace::kWorldBillboard, StarSprites(BuildExitStars(), ExitStarSprite));
     const std::vector<DiskParticle> disk = BuildDiskParticles();
     const std::vector<TunnelParticle> tunnel = BuildTunnelParticles();
     const std::vector<DestinationPlanet> planets = BuildDestinationPlanets();
@@ -787,6 +981,15 @@ int main() {
     bool autoDive = false;
     bool showHelp = true;
 
+    WormholeTunnelMesh tunnelMesh;
+    tunnelMesh.Init();
+
+    astro_render::GeodesicLensingPass lensing;
+    const bool lensingAvailable = lensing.Init(BuildSkyStars(stars), 512, {0.30f, 0.88f, -0.36f}, 0.26f);
+    bool lensingMode = lensingAvailable;
+    bool autoScale = true;
+    int spinIndex = 0;
+
     while (!WindowShouldClose()) {
         const float dt = GetFrameTime();
         timeSeconds += dt;
@@ -800,6 +1003,12 @@ int main() {
             autoDive = false;
             look = {};
         }
+        if (IsKeyPressed(KEY_L) && lensingAvailable) lensingMode = !lensingMode;
+        if (IsKeyPressed(KEY_K)) spinIndex = (spinIndex + 1) % kLensingSpinCount;
+        if (IsKeyPressed(KEY_F)) {
+            autoScale = false;
+            lensing.CycleRenderScale();
+        }
 
         targetZoom01 += GetMouseWheelMove() * 0.05f;
         if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) targetZoom01 += dt * 0.46f;
@@ -813,16 +1022,50 @@ int main() {
         const PhysicsState state = EvaluatePhysics(currentRadiusRs, currentZoom01);
         const Camera3D camera = BuildFallingCamera(state, &look, timeSeconds, dt);
 
+        // The geodesic pass covers the approach; the backward trace has no view from inside
+        // the horizon, so it hands over to the sprite scene just before the crossing.
+        const float lensFade = lensingMode ? 1.0f - SmoothStep(0.34f, 0.42f, state.phase01) : 0.0f;
+        if (lensFade > 0.0f) {
+            if (autoScale) lensing.UpdateAutoScale(dt);
+            astro_render::LensingView view;
+            view.horizonRadius = kEventHorizonRs;
+            view.diskNormal = DiskNormal();
+            view.diskInner = kDiskInnerRadius;
+            view.diskOuter = kDiskOuterRadius;
+            view.spin = kLensingSpins[spinIndex];
+            view.diskBrightness = 0.8f + 0.4f * state.photonRingStrength;
+            view.time = timeSeconds;
+            lensing.Render(camera, view);
+        }
+
+        std::string lensLine = "lensing: sprites";
+        if (!lensingAvailable) {
+            lensLine = "lensing: sprites (no geodesic shader)";
+        } else if (lensingMode) {
+            lensLine = "lensing: geodesic   spin " + FormatFloat(kLensingSpins[spinIndex]) + "   1/" +
+                       std::to_string(lensing.renderScale()) + " res" + (autoScale ? " (auto)" : "");
+        }
+
         BeginDrawing();
-        DrawBackgroundGradient(state);
-        DrawExitBloom(state);
-        DrawScene(camera, stars, exitStars, disk, tunnel, planets, clouds, state, timeSeconds);
-        DrawScreenSpaceBlackHoleAnchor(camera, state);
-        DrawCompactHud(state, currentRadiusRs, autoDive);
+        if (lensFade < 1.0f) {
+            DrawBackgroundGradient(state);
+            DrawExitBloom(state);
+            DrawScene(camera, &starLayer, &exitStarLayer, tunnelMesh, disk, tunnel, planets, clouds, state, timeSeconds);
+            DrawScreenSpaceBlackHoleAnchor(camera, state);
+        }
+        if (lensFade > 0.0f) lensing.Draw(Fade(WHITE, lensFade));
+        DrawCompactHud(state, currentRadiusRs, autoDive, lensLine);
         if (showHelp) DrawHelpOverlay();
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    lensing.Unload();
+    tunnelMesh.Unload();
+    starLayer.Unload();
+    exitStarLayer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
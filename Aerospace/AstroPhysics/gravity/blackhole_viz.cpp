@@ -1,14 +1,17 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/colormap.h"
+#include "../common/deflection_table.h"
+#include "../common/geodesic_lensing.h"
+#include "../common/scene_host.h"
+#include "../vision/live_controls.h"
 
 #include <algorithm>
-#include <cctype>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
-#include <filesystem>
-#include <fstream>
 #include <iomanip>
+#include <memory>
 #include <optional>
 #include <random>
 #include <sstream>
@@ -29,6 +32,13 @@ constexpr float kGravityMu = 12.0f;
 constexpr float kSheetExtent = 11.0f;
 constexpr int kSheetGrid = 52;
 constexpr int kLensStarCount = 520;
+constexpr int kSkyStarCount = 3200;
+constexpr int kSkyFaceSize = 512;
+constexpr Vector3 kSkyBandNormal = {0.25f, 0.92f, 0.30f};
+constexpr float kSkyBandStrength = 0.22f;
+constexpr float kShadowImpactRs = 2.598f;  // Schwarzschild capture impact parameter, 3 sqrt(3) / 2 rs
+constexpr float kLensingSpins[] = {0.0f, 0.6f, 0.95f};
+constexpr int kLensingSpinCount = static_cast<int>(sizeof(kLensingSpins) / sizeof(kLensingSpins[0]));
 constexpr int kMatterStep = 100;
 constexpr float kSpeedStep = 0.25f;
 constexpr std::int64_t kControlStaleMs = 1200;
@@ -48,24 +58,15 @@ struct BackgroundStar {
     float phase;
 };
 
-struct LiveControls {
-    float zoom = 1.0f;
-    float rotationDeg = 0.0f;
-    float pitchDeg = 0.0f;
-    int nIncCount = 0;
-    int nDecCount = 0;
-    std::string label = "Unknown";
-    std::string gesture = "none";
-    std::int64_t timestampMs = 0;
+// Per-frame work arrays for the sprite lens solve: one slot per (star, image) pair.
+struct LensSolveScratch {
+    std::vector<float> target;
+    std::vector<float> lo;
+    std::vector<float> hi;
+    std::vector<float> impact;
+    std::vector<float> alpha;
 };
 
-std::string Trim(std::string s) {
-    auto notSpace = [](unsigned char ch) { return !std::isspace(ch); };
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
-    s.erase(std::find_if(s.rbegin(), s.rend(), notSpace).base(), s.end());
-    return s;
-}
-
 std::int64_t UnixMsNow() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
@@ -81,64 +82,6 @@ float AngleDeltaDeg(float current, float previous) {
     return NormalizeDeg(current - previous);
 }
 
-std::optional<LiveControls> ParseLiveControlsFile(const std::filesystem::path& path) {
-    std::ifstream in(path);
-    if (!in.is_open()) return std::nullopt;
-
-    LiveControls lc;
-    std::string line;
-    while (std::getline(in, line)) {
-        const std::size_t eq = line.find('=');
-        if (eq == std::string::npos) continue;
-        const std::string key = Trim(line.substr(0, eq));
-        const std::string val = Trim(line.substr(eq + 1));
-        try {
-            if (key == "zoom") lc.zoom = std::stof(val);
-            else if (key == "rotation_deg") lc.rotationDeg = std::stof(val);
-            else if (key == "pitch_deg") lc.pitchDeg = std::stof(val);
-            else if (key == "n_inc_count") lc.nIncCount = std::stoi(val);
-            else if (key == "n_dec_count") lc.nDecCount = std::stoi(val);
-            else if (key == "label") lc.label = val;
-            else if (key == "gesture") lc.gesture = val;
-            else if (key == "timestamp_ms") lc.timestampMs = std::stoll(val);
-        } catch (...) {
-            // Ignore malformed values and keep defaults.
-        }
-    }
-
-    if (lc.timestampMs <= 0) return std::nullopt;
-    return lc;
-}
-
-std::optional<LiveControls> LoadLiveControls() {
-    static std::optional<std::filesystem::path> cachedPath;
-
-    auto tryPath = [](const std::filesystem::path& p) -> std::optional<LiveControls> {
-        if (!std::filesystem::exists(p)) return std::nullopt;
-        return ParseLiveControlsFile(p);
-    };
-
-    if (cachedPath) {
-        if (auto parsed = tryPath(*cachedPath)) return parsed;
-    }
-
-    const std::vector<std::filesystem::path> candidates = {
-        "vision/live_controls.txt",
-        "../vision/live_controls.txt",
-        "../../vision/live_controls.txt",
-        "AstroPhysics/vision/live_controls.txt",
-        std::filesystem::path(__FILE__).parent_path().parent_path() / "vision" / "live_controls.txt",
-    };
-
-    for (const auto& p : candidates) {
-        if (auto parsed = tryPath(p)) {
-            cachedPath = p;
-            return parsed;
-        }
-    }
-    return std::nullopt;
-}
-
 float RandRange(std::mt19937& rng, float lo, float hi) {
     std::uniform_real_distribution<float> d(lo, hi);
     return d(rng);
@@ -172,12 +115,25 @@ void ResetDisk(std::vector<DustParticle>* disk, std::mt19937& rng, int count) {
     }
 }
 
-Color DiskColor(float heat) {
-    const float h = std::clamp(heat, 0.0f, 1.0f);
-    const unsigned char r = static_cast<unsigned char>(230 + 25 * h);
-    const unsigned char g = static_cast<unsigned char>(165 + 85 * h);
-    const unsigned char b = static_cast<unsigned char>(28 + 35 * (1.0f - h));
-    return Color{r, g, b, 228};
+const astro_color::Colormap kDiskMap = astro_color::Colormap::FromStops({
+    {0.0f, Color{230, 165, 63, 228}},
+    {1.0f, Color{255, 250, 28, 228}},
+});
+
+Color DiskColor(float heat) { return kDiskMap(heat); }
+
+std::string LensingHud(bool shaderMode, bool available, float spin, int renderScale, bool autoScale) {
+    std::ostringstream os;
+    if (!available) {
+        os << "lensing=sprites (geodesic shader unavailable)";
+    } else if (!shaderMode) {
+        os << "L lensing=sprites";
+    } else {
+        os << std::fixed << std::setprecision(2)
+           << "L lensing=geodesic shader  K spin a=" << spin
+           << "  F res=1/" << renderScale << (autoScale ? " (auto)" : "");
+    }
+    return os.str();
 }
 
 std::string HudText(float t, float speed, int particles, int swallowed, bool paused) {
@@ -294,6 +250,36 @@ std::vector<BackgroundStar> BuildBackgroundStars(std::mt19937& rng, int count) {
     return stars;
 }
 
+std::vector<astro_render::SkyStar> BuildSkyStars(std::mt19937& rng, int count) {
+    std::vector<astro_render::SkyStar> stars;
+    stars.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const float z = RandRange(rng, -1.0f, 1.0f);
+        const float phi = RandRange(rng, 0.0f, 2.0f * PI);
+        const float ring = std::sqrt(1.0f - z * z);
+        const float heat = RandRange(rng, 0.0f, 1.0f);
+        const float brightness = std::pow(RandRange(rng, 0.0f, 1.0f), 3.0f);
+        const Color color = {
+            static_cast<unsigned char>(200 + 55 * heat),
+            static_cast<unsigned char>(205 + 40 * heat),
+            static_cast<unsigned char>(255 - 70 * heat),
+            static_cast<unsigned char>(50 + 205 * brightness),
+        };
+        stars.push_back({{ring * std::cos(phi), z, ring * std::sin(phi)}, 0.7f + 1.1f * brightness, color});
+    }
+    return stars;
+}
+
+// True when the straight sight line to p passes behind the shadow of the hole, so a
+// particle drawn over the shader's lensed image would show through it.
+bool HiddenByShadow(Vector3 p, Vector3 eye) {
+    const Vector3 d = Vector3Subtract(p, eye);
+    const float t = -Vector3DotProduct(eye, d) / std::max(1.0e-6f, Vector3DotProduct(d, d));
+    if (t <= 0.0f || t >= 1.0f) return false;
+    const float miss = Vector3Length(Vector3Add(eye, Vector3Scale(d, t)));
+    return miss < kShadowImpactRs * kEventHorizonRadius;
+}
+
 void DrawAccretionRibbon(float t) {
     const int segments = 180;
     for (int i = 0; i < segments; ++i) {
@@ -320,28 +306,87 @@ void DrawAccretionRibbon(float t) {
     }
 }
 
+// Sprite-mode background: each star's major and minor image from the exact Schwarzschild
+// lens equation beta = theta - f alpha(theta / h) for a sky at infinity, in pixels with h
+// the horizon radius and f the focal length. theta - f alpha is monotonic above the
+// capture radius, so all roots are bracketed there and bisected together, one batched
+// table lookup per step.
+void SolveLensedImages(const std::vector<BackgroundStar>& stars,
+                       Vector2 lensCenter,
+                       float horizonPx,
+                       float focalPx,
+                       LensSolveScratch* scratch) {
+    const astro_lensing::DeflectionTable& deflection = astro_lensing::SharedDeflectionTable();
+    const size_t n = 2 * stars.size();
+    scratch->target.resize(n);
+    scratch->lo.resize(n);
+    scratch->hi.resize(n);
+    scratch->impact.resize(n);
+    scratch->alpha.resize(n);
+
+    const float weakRing = std::sqrt(2.0f * focalPx * horizonPx);
+    const float captureTheta = static_cast<float>(astro_lensing::kCaptureImpact) * horizonPx;
+    for (size_t i = 0; i < stars.size(); ++i) {
+        const float beta = std::max(Vector2Length(Vector2Subtract(stars[i].baseScreenPos, lensCenter)), 1.0f);
+        // Slot 2i solves theta - f alpha = +beta (major), 2i + 1 the -beta branch (minor).
+        scratch->target[2 * i] = beta;
+        scratch->target[2 * i + 1] = -beta;
+        for (size_t k = 2 * i; k <= 2 * i + 1; ++k) {
+            scratch->lo[k] = captureTheta;
+            scratch->hi[k] = beta + 2.0f * weakRing + captureTheta;
+        }
+    }
+
+    const float invHorizon = 1.0f / horizonPx;
+    for (int it = 0; it < 24; ++it) {
+        for (size_t k = 0; k < n; ++k) scratch->impact[k] = 0.5f * (scratch->lo[k] + scratch->hi[k]) * invHorizon;
+        deflection.DeflectionBatch(scratch->impact.data(), scratch->alpha.data(), n);
+        for (size_t k = 0; k < n; ++k) {
+            const float mid = scratch->impact[k] * horizonPx;
+            const bool below = mid - focalPx * scratch->alpha[k] < scratch->target[k];
+            (below ? scratch->lo[k] : scratch->hi[k]) = mid;
+        }
+    }
+}
+
 void DrawLensedBackground(const std::vector<BackgroundStar>& stars,
                           Vector2 lensCenter,
                           float shadowRadiusPx,
-                          float einsteinRadiusPx,
-                          float t) {
-    const float thetaE = std::max(6.0f, einsteinRadiusPx);
+                          float horizonPx,
+                          float focalPx,
+                          float t,
+                          LensSolveScratch* scratch) {
+    const astro_lensing::DeflectionTable& deflection = astro_lensing::SharedDeflectionTable();
+    SolveLensedImages(stars, lensCenter, horizonPx, focalPx, scratch);
+
+    // Einstein ring: the beta = 0 root, for the ring glow and the halo around it.
+    float ringLo = static_cast<float>(astro_lensing::kCaptureImpact) * horizonPx;
+    float ringHi = ringLo + 2.0f * std::sqrt(2.0f * focalPx * horizonPx);
+    for (int it = 0; it < 32; ++it) {
+        const float mid = 0.5f * (ringLo + ringHi);
+        (mid - focalPx * deflection.Deflection(mid / horizonPx) < 0.0f ? ringLo : ringHi) = mid;
+    }
+    const float thetaE = std::max(6.0f, 0.5f * (ringLo + ringHi));
 
-    for (const BackgroundStar& s : stars) {
+    // |mu| = |theta / beta| / (d beta / d theta), d beta / d theta = 1 - f alpha'(b) / h.
+    auto magnification = [&](float theta, float beta) {
+        const float radial = 1.0f - focalPx * deflection.DeflectionSlope(theta / horizonPx) / horizonPx;
+        return theta / (beta * std::max(radial, 1.0e-3f));
+    };
+
+    for (size_t i = 0; i < stars.size(); ++i) {
+        const BackgroundStar& s = stars[i];
         const Vector2 rel = Vector2Subtract(s.baseScreenPos, lensCenter);
         const float beta = Vector2Length(rel);
         if (beta < 0.001f) continue;
 
         const Vector2 dir = Vector2Scale(rel, 1.0f / beta);
         const float betaSafe = std::max(beta, 1.0f);
-        const float root = std::sqrt(betaSafe * betaSafe + 4.0f * thetaE * thetaE);
-        const float thetaPlus = 0.5f * (betaSafe + root);
-        const float thetaMinus = 0.5f * (betaSafe - root);
-
-        const float u = betaSafe / thetaE;
-        const float den = std::max(0.2f, u * std::sqrt(u * u + 4.0f));
-        const float muPlus = std::clamp(0.5f + (u * u + 2.0f) / (2.0f * den), 0.0f, 4.0f);
-        const float muMinus = std::clamp(std::fabs(0.5f - (u * u + 2.0f) / (2.0f * den)), 0.0f, 2.5f);
+        const float thetaPlus = 0.5f * (scratch->lo[2 * i] + scratch->hi[2 * i]);
+        const float thetaMinus = -0.5f * (scratch->lo[2 * i + 1] + scratch->hi[2 * i + 1]);
+
+        const float muPlus = std::clamp(magnification(thetaPlus, betaSafe), 0.0f, 4.0f);
+        const float muMinus = std::clamp(magnification(-thetaMinus, betaSafe), 0.0f, 2.5f);
         const float twinkle = 0.72f + 0.28f * std::sin(2.2f * t + s.phase);
 
         auto drawImage = [&](float theta, float magnification, bool secondary) {
@@ -374,162 +419,97 @@ void DrawLensedBackground(const std::vector<BackgroundStar>& stars,
     DrawCircleV(lensCenter, shadowRadiusPx * 1.07f, Color{0, 0, 0, 238});
 }
 
-}  // namespace
+class BlackholeScene : public astro_scene::Scene {
+  public:
+    BlackholeScene() : rng_(std::random_device{}()) {}
+
+    void Prepare() override {
+        ResetDisk(&disk_, rng_, desiredParticles_);
+        backgroundStars_ = BuildBackgroundStars(rng_, kLensStarCount);
+        skyStrip_ = astro_render::BakeStarfieldStrip(BuildSkyStars(rng_, kSkyStarCount), kSkyFaceSize, kSkyBandNormal, kSkyBandStrength);
+    }
 
-int main() {
-    InitWindow(kScreenWidth, kScreenHeight, "Black Hole 3D Visualization - C++ (raylib)");
-    SetTargetFPS(60);
-
-    Camera3D camera{};
-    camera.position = {7.5f, 4.0f, 7.5f};
-    camera.target = {0.0f, 0.0f, 0.0f};
-    camera.up = {0.0f, 1.0f, 0.0f};
-    camera.fovy = 45.0f;
-    camera.projection = CAMERA_PERSPECTIVE;
-
-    std::random_device rd;
-    std::mt19937 rng(rd());
-
-    int desiredParticles = 520;
-    int swallowed = 0;
-    float simTime = 0.0f;
-    float speed = 1.0f;
-    bool paused = false;
-    float camYaw = 0.78f;
-    float camPitch = 0.38f;
-    float camDistance = 11.0f;
-    float warpScale = 1.0f;
-    bool showWarp = true;
-    bool hasPrevLive = false;
-    float prevLiveZoom = 1.0f;
-    float prevLiveRotDeg = 0.0f;
-    float prevLivePitchDeg = 0.0f;
-    int prevLiveNIncCount = 0;
-    int prevLiveNDecCount = 0;
-    int pendingRightPinches = 0;
-    int pendingLeftPinches = 0;
-    std::int64_t rightPendingDeadlineMs = 0;
-    std::int64_t leftPendingDeadlineMs = 0;
-    std::string bridgeStatus = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
-
-    std::vector<DustParticle> disk;
-    ResetDisk(&disk, rng, desiredParticles);
-    const std::vector<BackgroundStar> backgroundStars = BuildBackgroundStars(rng, kLensStarCount);
-
-    while (!WindowShouldClose()) {
+    bool Init(astro_scene::SceneContext& /*ctx*/) override {
+        camera_.position = {7.5f, 4.0f, 7.5f};
+        camera_.target = {0.0f, 0.0f, 0.0f};
+        camera_.up = {0.0f, 1.0f, 0.0f};
+        camera_.fovy = 45.0f;
+        camera_.projection = CAMERA_PERSPECTIVE;
+        lensingAvailable_ = lensing_.Init(skyStrip_, kSkyFaceSize);
+        lensingMode_ = lensingAvailable_;
+        skyStrip_ = {};
+        return true;
+    }
+
+    void Enter(astro_scene::SceneContext& /*ctx*/) override {
+        hasPrevLive_ = false;
+        pendingRightPinches_ = pendingLeftPinches_ = 0;
+        rightPendingDeadlineMs_ = leftPendingDeadlineMs_ = 0;
+    }
+
+    void Update(astro_scene::SceneContext& ctx, float dt) override {
         if (IsKeyPressed(KEY_P)) {
-            paused = !paused;
+            paused_ = !paused_;
         }
         if (IsKeyPressed(KEY_R)) {
-            simTime = 0.0f;
-            swallowed = 0;
-            warpScale = 1.0f;
-            ResetDisk(&disk, rng, desiredParticles);
+            simTime_ = 0.0f;
+            swallowed_ = 0;
+            warpScale_ = 1.0f;
+            ResetDisk(&disk_, rng_, desiredParticles_);
         }
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) {
-            speed = std::min(4.0f, speed + 0.25f);
+            speed_ = std::min(4.0f, speed_ + 0.25f);
         }
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) {
-            speed = std::max(0.25f, speed - 0.25f);
+            speed_ = std::max(0.25f, speed_ - 0.25f);
         }
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) {
-            desiredParticles = std::min(1400, desiredParticles + 100);
-            ResetDisk(&disk, rng, desiredParticles);
+            desiredParticles_ = std::min(1400, desiredParticles_ + 100);
+            ResetDisk(&disk_, rng_, desiredParticles_);
         }
         if (IsKeyPressed(KEY_LEFT_BRACKET)) {
-            desiredParticles = std::max(120, desiredParticles - 100);
-            ResetDisk(&disk, rng, desiredParticles);
+            desiredParticles_ = std::max(120, desiredParticles_ - 100);
+            ResetDisk(&disk_, rng_, desiredParticles_);
+        }
+        if (IsKeyPressed(KEY_PERIOD)) warpScale_ = std::min(1.8f, warpScale_ + 0.05f);
+        if (IsKeyPressed(KEY_COMMA)) warpScale_ = std::max(0.45f, warpScale_ - 0.05f);
+        if (IsKeyPressed(KEY_W)) showWarp_ = !showWarp_;
+        if (IsKeyPressed(KEY_L) && lensingAvailable_) lensingMode_ = !lensingMode_;
+        if (IsKeyPressed(KEY_K)) spinIndex_ = (spinIndex_ + 1) % kLensingSpinCount;
+        if (IsKeyPressed(KEY_F)) {
+            autoScale_ = false;
+            lensing_.CycleRenderScale();
         }
-        if (IsKeyPressed(KEY_PERIOD)) warpScale = std::min(1.8f, warpScale + 0.05f);
-        if (IsKeyPressed(KEY_COMMA)) warpScale = std::max(0.45f, warpScale - 0.05f);
-        if (IsKeyPressed(KEY_W)) showWarp = !showWarp;
 
         const std::int64_t nowMs = UnixMsNow();
-        if (auto live = LoadLiveControls()) {
-            const std::int64_t ageMs = nowMs - live->timestampMs;
-            if (ageMs <= kControlStaleMs) {
-                if (!hasPrevLive) {
-                    hasPrevLive = true;
-                    prevLiveZoom = std::max(0.05f, live->zoom);
-                    prevLiveRotDeg = live->rotationDeg;
-                    prevLivePitchDeg = live->pitchDeg;
-                    prevLiveNIncCount = live->nIncCount;
-                    prevLiveNDecCount = live->nDecCount;
-                } else {
-                    const float currentLiveZoom = std::max(0.05f, live->zoom);
-                    float zoomRatio = currentLiveZoom / std::max(0.05f, prevLiveZoom);
-                    zoomRatio = std::clamp(zoomRatio, 0.65f, 1.55f);
-                    camDistance = std::clamp(camDistance / zoomRatio, 3.0f, 26.0f);
-                    prevLiveZoom = currentLiveZoom;
-
-                    const float rotDeltaDeg = AngleDeltaDeg(live->rotationDeg, prevLiveRotDeg);
-                    prevLiveRotDeg = live->rotationDeg;
-                    camYaw += rotDeltaDeg * DEG2RAD;
-
-                    const float pitchDeltaDeg = live->pitchDeg - prevLivePitchDeg;
-                    prevLivePitchDeg = live->pitchDeg;
-                    camPitch += pitchDeltaDeg * DEG2RAD;
-                    camPitch = std::clamp(camPitch, -1.35f, 1.35f);
-
-                    if (live->nIncCount >= prevLiveNIncCount) {
-                        const int incDelta = live->nIncCount - prevLiveNIncCount;
-                        if (incDelta > 0) {
-                            pendingRightPinches += incDelta;
-                            rightPendingDeadlineMs = nowMs + kPinchSequenceWindowMs;
-                        }
-                    }
-                    if (live->nDecCount >= prevLiveNDecCount) {
-                        const int decDelta = live->nDecCount - prevLiveNDecCount;
-                        if (decDelta > 0) {
-                            pendingLeftPinches += decDelta;
-                            leftPendingDeadlineMs = nowMs + kPinchSequenceWindowMs;
-                        }
-                    }
-                    prevLiveNIncCount = live->nIncCount;
-                    prevLiveNDecCount = live->nDecCount;
-                }
-
-                UpdateCameraFromOrbit(&camera, camYaw, camPitch, camDistance);
-                std::ostringstream cs;
-                cs << "bridge: live  hand=" << live->label
-                   << "  gesture=" << live->gesture
-                   << "  age=" << ageMs << "ms";
-                bridgeStatus = cs.str();
-            } else {
-                bridgeStatus = "bridge: stale";
-                hasPrevLive = false;
-            }
-        } else {
-            bridgeStatus = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
-            hasPrevLive = false;
-        }
+        UpdateLiveControls(ctx.liveControls, nowMs);
 
         auto applyPinchBuffer = [&](int* pending, std::int64_t* deadline, int matterDir, float speedDir) {
             if (*pending >= 2) {
                 const int doubleCount = *pending / 2;
-                speed = std::clamp(speed + speedDir * kSpeedStep * static_cast<float>(doubleCount), 0.25f, 4.0f);
+                speed_ = std::clamp(speed_ + speedDir * kSpeedStep * static_cast<float>(doubleCount), 0.25f, 4.0f);
                 *pending %= 2;
                 *deadline = (*pending > 0) ? (nowMs + kPinchSequenceWindowMs) : 0;
             }
 
             if (*pending == 1 && *deadline > 0 && nowMs >= *deadline) {
-                desiredParticles = std::clamp(desiredParticles + matterDir * kMatterStep, 120, 1400);
-                ResetDisk(&disk, rng, desiredParticles);
+                desiredParticles_ = std::clamp(desiredParticles_ + matterDir * kMatterStep, 120, 1400);
+                ResetDisk(&disk_, rng_, desiredParticles_);
                 *pending = 0;
                 *deadline = 0;
             }
         };
 
-        applyPinchBuffer(&pendingRightPinches, &rightPendingDeadlineMs, +1, +1.0f);
-        applyPinchBuffer(&pendingLeftPinches, &leftPendingDeadlineMs, -1, -1.0f);
+        applyPinchBuffer(&pendingRightPinches_, &rightPendingDeadlineMs_, +1, +1.0f);
+        applyPinchBuffer(&pendingLeftPinches_, &leftPendingDeadlineMs_, -1, -1.0f);
 
-        UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
+        UpdateOrbitCameraDragOnly(&camera_, &camYaw_, &camPitch_, &camDistance_);
 
-        if (!paused) {
-            const float frameDt = GetFrameTime() * speed;
-            simTime += frameDt;
+        if (!paused_) {
+            const float frameDt = dt * speed_;
+            simTime_ += frameDt;
 
-            for (DustParticle& d : disk) {
+            for (DustParticle& d : disk_) {
                 const Vector3 r = d.pos;
                 const float r2 = Vector3DotProduct(r, r) + 0.04f;
                 const float invR = 1.0f / std::sqrt(r2);
@@ -544,48 +524,68 @@ int main() {
                 d.heat = std::clamp(1.25f - (radius - kDiskInnerRadius) / (kDiskOuterRadius - kDiskInnerRadius), 0.2f, 1.0f);
             }
 
-            const int before = static_cast<int>(disk.size());
-            disk.erase(
-                std::remove_if(disk.begin(), disk.end(), [](const DustParticle& d) {
+            const int before = static_cast<int>(disk_.size());
+            disk_.erase(
+                std::remove_if(disk_.begin(), disk_.end(), [](const DustParticle& d) {
                     const float r = std::sqrt(Vector3DotProduct(d.pos, d.pos));
                     return r < kEventHorizonRadius * 1.02f || r > 11.0f;
                 }),
-                disk.end()
+                disk_.end()
             );
-            swallowed += before - static_cast<int>(disk.size());
+            swallowed_ += before - static_cast<int>(disk_.size());
 
-            while (static_cast<int>(disk.size()) < desiredParticles) {
-                disk.push_back(SpawnDust(rng));
+            while (static_cast<int>(disk_.size()) < desiredParticles_) {
+                disk_.push_back(SpawnDust(rng_));
             }
         }
 
-        const Vector2 lensCenter = GetWorldToScreen({0.0f, 0.0f, 0.0f}, camera);
-        const float eventHorizonPx = Vector2Distance(lensCenter, GetWorldToScreen({kEventHorizonRadius, 0.0f, 0.0f}, camera));
-        const float photonRingPx = Vector2Distance(lensCenter, GetWorldToScreen({kPhotonRingRadius, 0.0f, 0.0f}, camera));
+        if (lensingMode_) {
+            if (autoScale_) lensing_.UpdateAutoScale(dt);
+            astro_render::LensingView view;
+            view.horizonRadius = kEventHorizonRadius;
+            view.diskInner = kDiskInnerRadius;
+            view.diskOuter = kDiskOuterRadius;
+            view.spin = kLensingSpins[spinIndex_];
+            view.time = simTime_;
+            lensing_.Render(camera_, view);
+        }
+    }
+
+    void Draw(astro_scene::SceneContext& /*ctx*/) override {
+        const Vector2 lensCenter = GetWorldToScreen({0.0f, 0.0f, 0.0f}, camera_);
+        const float eventHorizonPx = Vector2Distance(lensCenter, GetWorldToScreen({kEventHorizonRadius, 0.0f, 0.0f}, camera_));
         const float shadowRadiusPx = std::max(8.0f, eventHorizonPx * 1.02f);
-        const float einsteinRadiusPx = std::max(photonRingPx * 1.08f, shadowRadiusPx * 1.35f);
+        const float focalPx = 0.5f * static_cast<float>(GetScreenHeight()) / std::tan(0.5f * camera_.fovy * DEG2RAD);
 
-        BeginDrawing();
         ClearBackground(Color{4, 6, 14, 255});
-        DrawLensedBackground(backgroundStars, lensCenter, shadowRadiusPx, einsteinRadiusPx, simTime);
+        if (lensingMode_) {
+            lensing_.Draw();
+        } else {
+            DrawLensedBackground(backgroundStars_, lensCenter, shadowRadiusPx, std::max(1.0f, eventHorizonPx), focalPx, simTime_, &lensScratch_);
+        }
 
-        BeginMode3D(camera);
+        BeginMode3D(camera_);
 
-        if (showWarp) DrawWarpSheet(warpScale);
-        DrawCircle3DXZ(kDiskInnerRadius, 96, Color{255, 210, 90, 95});
-        DrawCircle3DXZ(kPhotonRingRadius, 120, Color{255, 232, 160, 110});
-        DrawCircle3DXZ(kDiskOuterRadius, 120, Color{232, 168, 58, 55});
+        if (showWarp_) DrawWarpSheet(warpScale_);
+        if (!lensingMode_) {
+            DrawCircle3DXZ(kDiskInnerRadius, 96, Color{255, 210, 90, 95});
+            DrawCircle3DXZ(kPhotonRingRadius, 120, Color{255, 232, 160, 110});
+            DrawCircle3DXZ(kDiskOuterRadius, 120, Color{232, 168, 58, 55});
+        }
 
-        float sheetCenter = WarpHeight(0.0f, 0.0f, warpScale);
+        float sheetCenter = WarpHeight(0.0f, 0.0f, warpScale_);
         DrawLine3D({0.0f, sheetCenter, 0.0f}, {0.0f, 0.0f, 0.0f}, Color{170, 220, 255, 110});
         DrawSphere({0.0f, sheetCenter, 0.0f}, 0.11f, Color{130, 190, 255, 90});
 
-        DrawSphere({0.0f, 0.0f, 0.0f}, kPhotonRingRadius, Color{255, 228, 165, 22});
-        DrawSphere({0.0f, 0.0f, 0.0f}, kShadowCutoffRadius, Color{0, 0, 0, 248});
-        DrawSphere({0.0f, 0.0f, 0.0f}, kEventHorizonRadius, BLACK);
-        DrawAccretionRibbon(simTime);
+        if (!lensingMode_) {
+            DrawSphere({0.0f, 0.0f, 0.0f}, kPhotonRingRadius, Color{255, 228, 165, 22});
+            DrawSphere({0.0f, 0.0f, 0.0f}, kShadowCutoffRadius, Color{0, 0, 0, 248});
+            DrawSphere({0.0f, 0.0f, 0.0f}, kEventHorizonRadius, BLACK);
+            DrawAccretionRibbon(simTime_);
+        }
 
-        for (const DustParticle& d : disk) {
+        for (const DustParticle& d : disk_) {
+            if (lensingMode_ && HiddenByShadow(d.pos, camera_.position)) continue;
             DrawSphere(d.pos, d.size, DiskColor(d.heat));
         }
 
@@ -593,19 +593,146 @@ int main() {
 
         DrawText("Black Hole + Accretion Disk (3D)", 20, 18, 30, Color{232, 238, 248, 255});
         DrawText("Hold left mouse: orbit | wheel: zoom | P pause | +/- speed | [ ] density | , . warp | W warp | R reset", 20, 54, 20, Color{164, 183, 210, 255});
-        const std::string hud = HudText(simTime, speed, static_cast<int>(disk.size()), swallowed, paused);
+        const std::string hud = HudText(simTime_, speed_, static_cast<int>(disk_.size()), swallowed_, paused_);
         DrawText(hud.c_str(), 20, 84, 21, Color{126, 224, 255, 255});
         std::ostringstream warpHud;
         warpHud << std::fixed << std::setprecision(2)
-                << "warp=" << warpScale
-                << "  warpVisible=" << (showWarp ? "yes" : "no");
+                << "warp=" << warpScale_
+                << "  warpVisible=" << (showWarp_ ? "yes" : "no");
         DrawText(warpHud.str().c_str(), 20, 110, 20, Color{149, 201, 255, 255});
-        DrawText(bridgeStatus.c_str(), 20, 136, 19, Color{152, 234, 198, 255});
-        DrawFPS(20, 162);
+        DrawText(bridgeStatus_.c_str(), 20, 136, 19, Color{152, 234, 198, 255});
+        const std::string lensHud = LensingHud(lensingMode_, lensingAvailable_, kLensingSpins[spinIndex_], lensing_.renderScale(), autoScale_);
+        DrawText(lensHud.c_str(), 20, 162, 19, Color{255, 214, 150, 255});
+        DrawFPS(20, 188);
+    }
 
-        EndDrawing();
+    void Shutdown() override {
+        lensing_.Unload();
     }
 
-    CloseWindow();
-    return 0;
+    // A pinch waiting out its double-pinch window still has to land.
+    bool Animating() const override {
+        return !paused_ || pendingRightPinches_ > 0 || pendingLeftPinches_ > 0;
+    }
+
+  private:
+    void UpdateLiveControls(const astro_hand::LiveControlsWatcher* liveControls, std::int64_t nowMs) {
+        const std::optional<astro_hand::LiveControls> none;
+        const auto& live = liveControls != nullptr ? liveControls->Latest() : none;
+        if (!live) {
+            bridgeStatus_ = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
+            hasPrevLive_ = false;
+            return;
+        }
+        const std::int64_t ageMs = nowMs - live->timestampMs;
+        if (ageMs > kControlStaleMs) {
+            bridgeStatus_ = "bridge: stale";
+            hasPrevLive_ = false;
+            return;
+        }
+        if (!hasPrevLive_) {
+            hasPrevLive_ = true;
+            prevLiveZoom_ = std::max(0.05f, live->zoom);
+            prevLiveRotDeg_ = live->rotationDeg;
+            prevLivePitchDeg_ = live->pitchDeg;
+            prevLiveNIncCount_ = live->nIncCount;
+            prevLiveNDecCount_ = live->nDecCount;
+        } else {
+            const float currentLiveZoom = std::max(0.05f, live->zoom);
+            float zoomRatio = currentLiveZoom / std::max(0.05f, prevLiveZoom_);
+            zoomRatio = std::clamp(zoomRatio, 0.65f, 1.55f);
+            camDistance_ = std::clamp(camDistance_ / zoomRatio, 3.0f, 26.0f);
+            prevLiveZoom_ = currentLiveZoom;
+
+            const float rotDeltaDeg = AngleDeltaDeg(live->rotationDeg, prevLiveRotDeg_);
+            prevLiveRotDeg_ = live->rotationDeg;
+            camYaw_ += rotDeltaDeg * DEG2RAD;
+
+            const float pitchDeltaDeg = live->pitchDeg - prevLivePitchDeg_;
+            prevLivePitchDeg_ = live->pitchDeg;
+            camPitch_ += pitchDeltaDeg * DEG2RAD;
+            camPitch_ = std::clamp(camPitch_, -1.35f, 1.35f);
+
+            if (live->nIncCount >= prevLiveNIncCount_) {
+                const int incDelta = live->nIncCount - prevLiveNIncCount_;
+                if (incDelta > 0) {
+                    pendingRightPinches_ += incDelta;
+                    rightPendingDeadlineMs_ = nowMs + kPinchSequenceWindowMs;
+                }
+            }
+            if (live->nDecCount >= prevLiveNDecCount_) {
+                const int decDelta = live->nDecCount - prevLiveNDecCount_;
+                if (decDelta > 0) {
+                    pendingLeftPinches_ += decDelta;
+                    leftPendingDeadlineMs_ = nowMs + kPinchSequenceWindowMs;
+                }
+            }
+            prevLiveNIncCount_ = live->nIncCount;
+            prevLiveNDecCount_ = live->nDecCount;
+        }
+
+        UpdateCameraFromOrbit(&camera_, camYaw_, camPitch_, camDistance_);
+        std::ostringstream cs;
+        cs << "bridge: live  hand=" << live->label
+           << "  gesture=" << live->gesture
+           << "  age=" << ageMs << "ms";
+        bridgeStatus_ = cs.str();
+    }
+
+    std::mt19937 rng_;
+    Camera3D camera_{};
+
+    int desiredParticles_ = 520;
+    int swallowed_ = 0;
+    float simTime_ = 0.0f;
+    float speed_ = 1.0f;
+    bool paused_ = false;
+    float camYaw_ = 0.78f;
+    float camPitch_ = 0.38f;
+    float camDistance_ = 11.0f;
+    float warpScale_ = 1.0f;
+    bool showWarp_ = true;
+    bool hasPrevLive_ = false;
+    float prevLiveZoom_ = 1.0f;
+    float prevLiveRotDeg_ = 0.0f;
+    float prevLivePitchDeg_ = 0.0f;
+    int prevLiveNIncCount_ = 0;
+    int prevLiveNDecCount_ = 0;
+    int pendingRightPinches_ = 0;
+    int pendingLeftPinches_ = 0;
+    std::int64_t rightPendingDeadlineMs_ = 0;
+    std::int64_t leftPendingDeadlineMs_ = 0;
+    std::string bridgeStatus_ = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
+
+    std::vector<DustParticle> disk_;
+    std::vector<BackgroundStar> backgroundStars_;
+    LensSolveScratch lensScratch_;
+    std::vector<unsigned char> skyStrip_;
+
+    astro_render::GeodesicLensingPass lensing_;
+    bool lensingAvailable_ = false;
+    bool lensingMode_ = false;
+    bool autoScale_ = true;
+    int spinIndex_ = 0;
+};
+
+}  // namespace
+
+namespace astro_scene {
+
+std::unique_ptr<Scene> MakeBlackholeScene() {
+    return std::make_unique<BlackholeScene>();
+}
+
+}  // namespace astro_scene
+
+#if !defined(ASTRO_SCENE_HOST)
+int main(int argc, char** argv) {
+    astro_scene::WindowOptions window;
+    window.idle = astro_power::IdleOptions::FromArgs(argc, argv);
+    window.title = "Black Hole 3D Visualization - C++ (raylib)";
+    window.width = kScreenWidth;
+    window.height = kScreenHeight;
+    return astro_scene::RunStandalone(astro_scene::MakeBlackholeScene, window);
 }
+#endif
@@ -1,5 +1,9 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/frame_capture.h"
+#include "../common/pn_waveform.h"
+#include "../common/profiler.h"
+#include "../common/spacetime_sheet.h"
 
 #include <algorithm>
 #include <cmath>
@@ -14,6 +18,24 @@ constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kWarpExtent = 9.0f;
 constexpr int kWarpGrid = 44;
+constexpr float kWarpSoftening = 0.42f;
+constexpr float kWarpDepth = 4.8f;
+constexpr astro_sheet::LineStyle kWarpRows = {{35, 80, 148, 68}, {65, 88, 90, 90}};
+constexpr astro_sheet::LineStyle kWarpColumns = {{30, 70, 132, 56}, {52, 74, 94, 78}};
+
+// Demo seconds per unit of total mass: the equal-mass, non-spinning inspiral from
+// x0 = 0.075 (about 2080 M) plays in about nine seconds.
+constexpr float kSecondsPerM = 0.0043f;
+constexpr float kSeparationScale = 0.27f;  // world units per M of orbital separation
+constexpr float kWaveSpeed = 2.15f;        // world units per demo second, rings and ripples
+constexpr float kRingGain = 0.8f;          // ring wobble per unit strain
+constexpr float kRingSpacing = 1.6f;
+constexpr float kRingInner = 1.2f;
+constexpr int kRingCount = 5;
+constexpr float kPlotSpanM = 600.0f;
+constexpr float kMinMassRatio = 1.0f;
+constexpr float kMaxMassRatio = 8.0f;
+constexpr float kMaxSpin = 0.9f;
 
 struct BurstParticle {
     Vector3 dir;
@@ -66,14 +88,15 @@ std::string Hud(float t, float speed, bool paused, bool merged) {
     return os.str();
 }
 
-void DrawWaveRing(float radius, float amp, Color c) {
+// Quadrupole (m = 2) wobble, rotated to the strain's phase when the ring was emitted.
+void DrawWaveRing(float radius, float amp, float phase, Color c) {
     int segs = 128;
     for (int i = 0; i < segs; ++i) {
         float a0 = 2.0f * PI * static_cast<float>(i) / static_cast<float>(segs);
         float a1 = 2.0f * PI * static_cast<float>(i + 1) / static_cast<float>(segs);
 
-        float wob0 = amp * std::sin(2.0f * a0);
-        float wob1 = amp * std::sin(2.0f * a1);
+        float wob0 = amp * std::sin(2.0f * a0 - phase);
+        float wob1 = amp * std::sin(2.0f * a1 - phase);
 
         Vector3 p0 = {(radius + wob0) * std::cos(a0), 0.0f, (radius + wob0) * std::sin(a0)};
         Vector3 p1 = {(radius + wob1) * std::cos(a1), 0.0f, (radius + wob1) * std::sin(a1)};
@@ -81,72 +104,86 @@ void DrawWaveRing(float radius, float amp, Color c) {
     }
 }
 
-float WarpHeightBinary(float x, float z, Vector3 bh1, Vector3 bh2, bool merged, float warpScale, float ringdownT) {
-    const float soft = 0.42f;
-    const float soft2 = soft * soft;
-    float h = 0.0f;
-
+// Two softened wells during the inspiral; one well plus outgoing, damped ripples
+// after the merger (ringdown).
+void UpdateWarpSheetBinary(astro_sheet::SpacetimeSheet* sheet, Vector3 bh1, Vector3 bh2, float mass1, float mass2,
+                           float finalMass, bool merged, float warpScale, float ringdownT) {
+    sheet->Fill(0.0f);
     if (!merged) {
-        float dx1 = x - bh1.x;
-        float dz1 = z - bh1.z;
-        float dx2 = x - bh2.x;
-        float dz2 = z - bh2.z;
-        h += -1.55f / std::sqrt(dx1 * dx1 + dz1 * dz1 + soft2);
-        h += -1.45f / std::sqrt(dx2 * dx2 + dz2 * dz2 + soft2);
+        sheet->AddWell(bh1.x, bh1.z, 3.0f * mass1, kWarpSoftening);
+        sheet->AddWell(bh2.x, bh2.z, 3.0f * mass2, kWarpSoftening);
     } else {
-        h += -2.75f / std::sqrt(x * x + z * z + soft2);
-
-        // Outgoing, damped spacetime ripples after merger (ringdown).
-        float r = std::sqrt(x * x + z * z);
-        float waveSpeed = 2.15f;
-        float wavelength = 1.65f;
-        float k = 2.0f * PI / wavelength;
-        float phase = k * (r - waveSpeed * ringdownT);
-        float envelope = std::exp(-0.22f * r) * std::exp(-0.6f * ringdownT);
-        float front = std::clamp((waveSpeed * ringdownT + 1.0f - r) * 0.8f + 0.5f, 0.0f, 1.0f);
-        h += 0.33f * warpScale * envelope * front * std::sin(phase);
+        sheet->AddWell(0.0f, 0.0f, 2.9f * finalMass, kWarpSoftening);
+
+        constexpr float kWavelength = 1.65f;
+        constexpr float k = 2.0f * PI / kWavelength;
+        const float timeDecay = std::exp(-0.6f * ringdownT);
+        const float rippleAmp = 0.33f * warpScale * timeDecay;
+        sheet->Apply([&](float x, float z, float h) {
+            const float r = std::sqrt(x * x + z * z);
+            const float phase = k * (r - kWaveSpeed * ringdownT);
+            const float front = std::clamp((kWaveSpeed * ringdownT + 1.0f - r) * 0.8f + 0.5f, 0.0f, 1.0f);
+            return h + rippleAmp * std::exp(-0.22f * r) * front * std::sin(phase);
+        });
     }
-
-    h *= warpScale;
-    return std::max(-4.8f, h);
+    sheet->ScaleClamp(warpScale, -kWarpDepth);
 }
 
-void DrawWarpSheetBinary(Vector3 bh1, Vector3 bh2, bool merged, float warpScale, float ringdownT) {
-    for (int i = 0; i < kWarpGrid; ++i) {
-        float z = -kWarpExtent + 2.0f * kWarpExtent * static_cast<float>(i) / static_cast<float>(kWarpGrid - 1);
-        for (int j = 0; j < kWarpGrid - 1; ++j) {
-            float x0 = -kWarpExtent + 2.0f * kWarpExtent * static_cast<float>(j) / static_cast<float>(kWarpGrid - 1);
-            float x1 = -kWarpExtent + 2.0f * kWarpExtent * static_cast<float>(j + 1) / static_cast<float>(kWarpGrid - 1);
-            Vector3 p0 = {x0, WarpHeightBinary(x0, z, bh1, bh2, merged, warpScale, ringdownT), z};
-            Vector3 p1 = {x1, WarpHeightBinary(x1, z, bh1, bh2, merged, warpScale, ringdownT), z};
-            float glow = 1.0f - std::min(1.0f, std::fabs(p0.y) / 4.8f);
-            Color c = {
-                static_cast<unsigned char>(35 + 65 * glow),
-                static_cast<unsigned char>(80 + 88 * glow),
-                static_cast<unsigned char>(148 + 90 * glow),
-                static_cast<unsigned char>(68 + 90 * glow),
-            };
-            DrawLine3D(p0, p1, c);
-        }
+// Outgoing shells at fixed spacing; each shows the strain emitted when it left the
+// source, so the chirp and the merger burst travel outwards.
+void DrawWaveRings(const astro_gw::Waveform& wave, float simT) {
+    const float drift = std::fmod(simT * kWaveSpeed, kRingSpacing);
+    for (int k = 0; k < kRingCount; ++k) {
+        const float radius = kRingInner + drift + kRingSpacing * static_cast<float>(k);
+        const float emitted = (simT - (radius - kRingInner) / kWaveSpeed) / kSecondsPerM;
+        if (emitted < 0.0f) continue;
+        const astro_gw::WaveformSample s = wave.At(emitted);
+        const float fade = 1.0f - 0.7f * static_cast<float>(k) / static_cast<float>(kRingCount);
+        const bool ringdown = emitted > wave.mergerTime;
+        const Color c = ringdown ? Color{255, 210, 140, static_cast<unsigned char>(170 * fade)}
+                                 : Color{120, 170, 255, static_cast<unsigned char>(120 * fade)};
+        DrawWaveRing(radius, kRingGain * s.amplitude, s.gwPhase, c);
     }
+}
 
-    for (int j = 0; j < kWarpGrid; ++j) {
-        float x = -kWarpExtent + 2.0f * kWarpExtent * static_cast<float>(j) / static_cast<float>(kWarpGrid - 1);
-        for (int i = 0; i < kWarpGrid - 1; ++i) {
-            float z0 = -kWarpExtent + 2.0f * kWarpExtent * static_cast<float>(i) / static_cast<float>(kWarpGrid - 1);
-            float z1 = -kWarpExtent + 2.0f * kWarpExtent * static_cast<float>(i + 1) / static_cast<float>(kWarpGrid - 1);
-            Vector3 p0 = {x, WarpHeightBinary(x, z0, bh1, bh2, merged, warpScale, ringdownT), z0};
-            Vector3 p1 = {x, WarpHeightBinary(x, z1, bh1, bh2, merged, warpScale, ringdownT), z1};
-            float glow = 1.0f - std::min(1.0f, std::fabs(p0.y) / 4.8f);
-            Color c = {
-                static_cast<unsigned char>(30 + 52 * glow),
-                static_cast<unsigned char>(70 + 74 * glow),
-                static_cast<unsigned char>(132 + 94 * glow),
-                static_cast<unsigned char>(56 + 78 * glow),
-            };
-            DrawLine3D(p0, p1, c);
+// Scrolling h+ over the last kPlotSpanM, scaled to the waveform's peak.
+void DrawStrainPlot(const astro_gw::Waveform& wave, float tM, bool busy) {
+    const Rectangle panel = {static_cast<float>(kScreenWidth) - 470.0f, static_cast<float>(kScreenHeight) - 190.0f, 450.0f, 170.0f};
+    DrawRectangleRec(panel, Color{10, 16, 30, 210});
+    DrawRectangleLinesEx(panel, 1.0f, Color{60, 90, 130, 255});
+    const float plotX = panel.x + 10.0f, plotW = panel.width - 20.0f;
+    const float midY = panel.y + 92.0f, halfH = 58.0f;
+    DrawLine(static_cast<int>(plotX), static_cast<int>(midY), static_cast<int>(plotX + plotW), static_cast<int>(midY), Color{50, 70, 100, 255});
+
+    const float peak = std::max(wave.At(wave.mergerTime).amplitude, 1.0e-6f);
+    const int columns = static_cast<int>(plotW);
+    Vector2 prev{};
+    bool havePrev = false;
+    for (int c = 0; c <= columns; ++c) {
+        const float t = tM - kPlotSpanM + kPlotSpanM * static_cast<float>(c) / static_cast<float>(columns);
+        if (t < 0.0f || t > wave.duration()) {
+            havePrev = false;
+            continue;
         }
+        const Vector2 p = {plotX + static_cast<float>(c), midY - halfH * wave.At(t).hPlus / peak};
+        if (havePrev) DrawLineV(prev, p, t > wave.mergerTime ? Color{255, 200, 130, 255} : Color{126, 224, 255, 255});
+        prev = p;
+        havePrev = true;
     }
+    const float mergeX = plotX + plotW * (wave.mergerTime - (tM - kPlotSpanM)) / kPlotSpanM;
+    if (mergeX >= plotX && mergeX <= plotX + plotW) {
+        DrawLine(static_cast<int>(mergeX), static_cast<int>(midY - halfH), static_cast<int>(mergeX), static_cast<int>(midY + halfH),
+                 Color{255, 150, 90, 160});
+    }
+
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2) << "h+ (TaylorT4 3.5PN + ringdown)  q=" << wave.params.massRatio
+       << "  chi=" << wave.params.spin << (busy ? "  generating..." : "");
+    DrawText(os.str().c_str(), static_cast<int>(panel.x) + 10, static_cast<int>(panel.y) + 8, 16, Color{210, 225, 245, 255});
+    std::ostringstream rem;
+    rem << std::fixed << std::setprecision(3) << "remnant Mf=" << wave.finalMass << "M  af=" << wave.finalSpin
+        << "  M w_qnm=" << wave.ringOmega << "  tau=" << std::setprecision(1) << wave.ringTau << "M";
+    DrawText(rem.str().c_str(), static_cast<int>(panel.x) + 10, static_cast<int>(panel.y) + 28, 15, Color{160, 185, 215, 255});
 }
 
 }  // namespace
@@ -175,7 +212,13 @@ int main() {
     bool merged = false;
     float mergeTime = 0.0f;
 
+    astro_gw::BinaryParams binary;
+    astro_gw::WaveformCache waveforms;
+    waveforms.GenerateNow(binary);
+
     std::vector<BurstParticle> burst;
+    astro_sheet::SpacetimeSheet warpSheet;
+    warpSheet.Configure(kWarpGrid, kWarpExtent);
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
@@ -188,12 +231,33 @@ int main() {
             merged = false;
             mergeTime = 0.0f;
             burst.clear();
+            binary = astro_gw::BinaryParams{};
+            waveforms.Request(binary);
         }
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) speed = std::max(0.25f, speed - 0.25f);
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) speed = std::min(6.0f, speed + 0.25f);
         if (IsKeyPressed(KEY_W)) showWarp = !showWarp;
         if (IsKeyPressed(KEY_COMMA)) warpScale = std::max(0.45f, warpScale - 0.05f);
         if (IsKeyPressed(KEY_PERIOD)) warpScale = std::min(1.9f, warpScale + 0.05f);
+        const astro_gw::BinaryParams previous = binary;
+        if (IsKeyPressed(KEY_LEFT_BRACKET)) binary.massRatio = std::max(kMinMassRatio, binary.massRatio - 0.5f);
+        if (IsKeyPressed(KEY_RIGHT_BRACKET)) binary.massRatio = std::min(kMaxMassRatio, binary.massRatio + 0.5f);
+        if (IsKeyPressed(KEY_SEMICOLON)) binary.spin = std::max(-kMaxSpin, std::round((binary.spin - 0.1f) * 10.0f) / 10.0f);
+        if (IsKeyPressed(KEY_APOSTROPHE)) binary.spin = std::min(kMaxSpin, std::round((binary.spin + 0.1f) * 10.0f) / 10.0f);
+        if (binary.massRatio != previous.massRatio || binary.spin != previous.spin) waveforms.Request(binary);
+
+        // A new waveform keeps the time to merger (or since it), so a sweep does not jump.
+        const float oldMergeSeconds = waveforms.waveform()->mergerTime * kSecondsPerM;
+        if (waveforms.Acquire()) {
+            const float newMergeSeconds = waveforms.waveform()->mergerTime * kSecondsPerM;
+            if (merged) {
+                mergeTime += newMergeSeconds - oldMergeSeconds;
+                simT += newMergeSeconds - oldMergeSeconds;
+            } else {
+                simT = std::max(0.0f, simT + newMergeSeconds - oldMergeSeconds);
+            }
+        }
+        const astro_gw::Waveform& wave = *waveforms.waveform();
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
@@ -201,9 +265,9 @@ int main() {
         if (!paused) {
             simT += dt;
 
-            if (!merged && simT > 9.0f) {
+            if (!merged && simT >= wave.mergerTime * kSecondsPerM) {
                 merged = true;
-                mergeTime = simT;
+                mergeTime = wave.mergerTime * kSecondsPerM;
                 ResetBurst(&burst);
             }
 
@@ -214,21 +278,18 @@ int main() {
             }
         }
 
-        float sep = 0.0f;
-        float omega = 0.0f;
-        float ang = 0.0f;
+        const float tM = simT / kSecondsPerM;
+        const astro_gw::WaveformSample now = wave.At(tM);
 
         Vector3 bh1{0.0f, 0.0f, 0.0f};
         Vector3 bh2{0.0f, 0.0f, 0.0f};
 
+        // Separation M / x about the centre of mass; the heavier hole m1 orbits closer in.
         if (!merged) {
-            float tau = std::clamp(simT / 9.0f, 0.0f, 1.0f);
-            sep = 3.2f * std::pow(1.0f - tau, 0.58f) + 0.45f;
-            omega = 0.55f + 3.6f * tau * tau;
-            ang = simT * omega;
-
-            bh1 = {-0.5f * sep * std::cos(ang), 0.12f * std::sin(ang * 0.6f), -0.5f * sep * std::sin(ang)};
-            bh2 = { 0.5f * sep * std::cos(ang), -0.12f * std::sin(ang * 0.6f),  0.5f * sep * std::sin(ang)};
+            const float sep = kSeparationScale / std::max(now.x, 1.0e-3f);
+            const float ang = now.orbitalPhase;
+            bh1 = {-wave.mass2 * sep * std::cos(ang), 0.0f, -wave.mass2 * sep * std::sin(ang)};
+            bh2 = { wave.mass1 * sep * std::cos(ang), 0.0f,  wave.mass1 * sep * std::sin(ang)};
         }
 
         BeginDrawing();
@@ -238,33 +299,24 @@ int main() {
 
         float ringdownT = merged ? (simT - mergeTime) : 0.0f;
         if (showWarp) {
-            DrawWarpSheetBinary(bh1, bh2, merged, warpScale, ringdownT);
+            UpdateWarpSheetBinary(&warpSheet, bh1, bh2, wave.mass1, wave.mass2, wave.finalMass, merged, warpScale, ringdownT);
+            warpSheet.Draw(kWarpRows, kWarpColumns, kWarpDepth);
         }
 
         if (!merged) {
-            DrawSphere(bh1, 0.34f, BLACK);
-            DrawSphere(bh2, 0.32f, BLACK);
+            DrawSphere(bh1, 0.68f * wave.mass1, BLACK);
+            DrawSphere(bh2, 0.68f * wave.mass2, BLACK);
 
-            DrawSphere(bh1, 0.48f, Color{130, 200, 255, 30});
-            DrawSphere(bh2, 0.46f, Color{130, 200, 255, 30});
-
-            float waveBase = 1.3f + simT * 1.25f;
-            DrawWaveRing(waveBase, 0.08f + 0.05f * std::sin(simT * 3.0f), Color{120, 170, 255, 120});
-            DrawWaveRing(waveBase + 1.6f, 0.06f, Color{120, 170, 255, 85});
-            DrawWaveRing(waveBase + 3.2f, 0.04f, Color{120, 170, 255, 60});
+            DrawSphere(bh1, 0.68f * wave.mass1 + 0.14f, Color{130, 200, 255, 30});
+            DrawSphere(bh2, 0.68f * wave.mass2 + 0.14f, Color{130, 200, 255, 30});
 
             DrawLine3D(bh1, bh2, Color{90, 130, 200, 80});
         } else {
-            float remnantR = 0.44f + 0.05f * std::exp(-1.8f * ringdownT) * std::sin(15.0f * ringdownT);
+            // The horizon rings with the l = m = 2 strain it is shedding.
+            float remnantR = 0.46f * wave.finalMass + 0.3f * now.hPlus;
             DrawSphere({0.0f, 0.0f, 0.0f}, remnantR, BLACK);
             DrawSphere({0.0f, 0.0f, 0.0f}, remnantR + 0.17f, Color{255, 190, 110, 40});
 
-            float w1 = 1.2f + ringdownT * 2.1f;
-            float decay = std::exp(-0.85f * ringdownT);
-            DrawWaveRing(w1, 0.14f * decay, Color{255, 210, 140, 170});
-            DrawWaveRing(w1 + 2.0f, 0.09f * decay, Color{190, 220, 255, 120});
-            DrawWaveRing(w1 + 4.0f, 0.06f * decay, Color{150, 200, 255, 80});
-
             for (const BurstParticle& p : burst) {
                 if (p.age > p.life) continue;
                 float a = 1.0f - p.age / p.life;
@@ -274,10 +326,12 @@ int main() {
             }
         }
 
+        DrawWaveRings(wave, simT);
+
         EndMode3D();
 
         DrawText("Black Hole Merger (Inspiral -> Ringdown)", 20, 18, 30, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | +/- speed | P pause | , . warp | W warp | R reset", 20, 56, 20, Color{164, 183, 210, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | +/- speed | P pause | , . warp | W warp | [ ] mass ratio | ; ' spin | R reset", 20, 56, 20, Color{164, 183, 210, 255});
         std::string hud = Hud(simT, speed, paused, merged);
         DrawText(hud.c_str(), 20, 86, 21, Color{126, 224, 255, 255});
         std::ostringstream warpHud;
@@ -285,11 +339,16 @@ int main() {
                 << "warp=" << warpScale
                 << "  warpVisible=" << (showWarp ? "yes" : "no");
         DrawText(warpHud.str().c_str(), 20, 112, 20, Color{149, 201, 255, 255});
-        DrawFPS(20, 118);
+        DrawFPS(20, 140);
+        DrawStrainPlot(wave, tM, waveforms.Busy());
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    waveforms.Stop();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,8 +1,17 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/instanced_particles.h"
+#include "../common/lod.h"
+#include "../common/offline_tracer.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+#include "../common/task_graph.h"
+
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <string>
 #include <vector>
@@ -25,6 +34,11 @@ constexpr float kDiskOuterScale = 7.4f;
 constexpr float kBridgeBounds = 28.0f;
 constexpr float kMaxParticleSpeed = 18.0f;
 
+// --render: fixed step used to advance the scene to --time, and the seed that makes two
+// renders of the same time identical.
+constexpr float kRenderStep = 1.0f / 60.0f;
+constexpr unsigned int kRenderSeed = 4096;
+
 struct Star {
     Vector3 position;
     float radius;
@@ -160,12 +174,29 @@ RenderQuality BuildRenderQuality(float fpsSmoothed) {
     return q;
 }
 
-float Rand01() {
-    return static_cast<float>(GetRandomValue(0, 10000)) / 10000.0f;
+// Each particle system draws from its own stream so the systems can update on different
+// threads; the streams are keyed by kRenderSeed, so a run is reproducible.
+using Rng = astro_random::PhiloxStream;
+enum RngStream : uint32_t { kStarStream, kDiskStream, kBridgeStream, kJetStream, kWormStream };
+
+Rng MakeRng(RngStream stream) {
+    return Rng({kRenderSeed, stream}, 0u);
 }
 
-float RandRange(float lo, float hi) {
-    return lo + (hi - lo) * Rand01();
+struct SceneRngs {
+    Rng stars = MakeRng(kStarStream);
+    Rng disk = MakeRng(kDiskStream);
+    Rng bridge = MakeRng(kBridgeStream);
+    Rng jets = MakeRng(kJetStream);
+    Rng worm = MakeRng(kWormStream);
+};
+
+float Rand01(Rng* rng) {
+    return rng->Uniform();
+}
+
+float RandRange(Rng* rng, float lo, float hi) {
+    return rng->Uniform(lo, hi);
 }
 
 float Clamp01(float v) {
@@ -196,13 +227,26 @@ void UpdateHoleScale(Hole* hole) {
     hole->horizon = 0.62f + std::sqrt(std::max(1.0f, hole->massMsun)) * 0.082f;
 }
 
-std::vector<Star> BuildStars() {
+std::vector<Hole> BuildHoles() {
+    std::vector<Hole> holes = {
+        {"Black Hole", {-6.2f, 0.0f, 0.0f}, 145.0f, 1.4f, false, BLACK, Color{80, 100, 140, 255}, Color{255, 145, 95, 255}},
+        {"White Hole", { 6.2f, 0.0f, 0.0f}, 116.0f, 1.3f, true,  Color{245, 248, 255, 255}, Color{180, 210, 255, 255}, Color{170, 215, 255, 255}},
+    };
+    for (Hole& hole : holes) UpdateHoleScale(&hole);
+    return holes;
+}
+
+Wormhole BuildWormhole() {
+    return Wormhole{{15.2f, 0.0f, 0.0f}, 1.22f, 0.62f, 4.8f, Color{105, 165, 255, 255}, Color{170, 245, 255, 255}};
+}
+
+std::vector<Star> BuildStars(Rng* rng) {
     std::vector<Star> stars;
     stars.reserve(kStarCount);
     for (int i = 0; i < kStarCount; ++i) {
-        const float theta = RandRange(0.0f, 2.0f * PI);
-        const float phi = RandRange(-0.42f * PI, 0.42f * PI);
-        const float radius = RandRange(95.0f, 130.0f);
+        const float theta = RandRange(rng, 0.0f, 2.0f * PI);
+        const float phi = RandRange(rng, -0.42f * PI, 0.42f * PI);
+        const float radius = RandRange(rng, 95.0f, 130.0f);
         const float cp = std::cos(phi);
         const Vector3 p = {
             radius * cp * std::cos(theta),
@@ -211,91 +255,91 @@ std::vector<Star> BuildStars() {
         };
         stars.push_back({
             p,
-            RandRange(0.03f, 0.15f),
-            RandRange(0.5f, 1.6f),
-            RandRange(0.0f, 2.0f * PI),
-            LerpColor(Color{160, 195, 255, 255}, Color{255, 220, 170, 255}, Rand01()),
+            RandRange(rng, 0.03f, 0.15f),
+            RandRange(rng, 0.5f, 1.6f),
+            RandRange(rng, 0.0f, 2.0f * PI),
+            LerpColor(Color{160, 195, 255, 255}, Color{255, 220, 170, 255}, Rand01(rng)),
         });
     }
     return stars;
 }
 
-void ResetDiskParticle(DiskParticle* p, const Hole& hole) {
+void ResetDiskParticle(DiskParticle* p, const Hole& hole, Rng* rng) {
     const float inner = hole.horizon * kDiskInnerScale;
     const float outer = hole.horizon * kDiskOuterScale;
     const bool white = hole.white;
 
-    const float u = std::pow(Rand01(), white ? 0.72f : 0.55f);
+    const float u = std::pow(Rand01(rng), white ? 0.72f : 0.55f);
     p->radius = Mix(inner, outer, u);
-    p->angle = RandRange(0.0f, 2.0f * PI);
-    p->phase = RandRange(0.0f, 2.0f * PI);
-    p->height = RandRange(-0.20f, 0.20f);
+    p->angle = RandRange(rng, 0.0f, 2.0f * PI);
+    p->phase = RandRange(rng, 0.0f, 2.0f * PI);
+    p->height = RandRange(rng, -0.20f, 0.20f);
     p->heat = 1.0f - Clamp01((p->radius - inner) / std::max(0.01f, (outer - inner)));
-    p->size = Mix(0.025f, 0.08f, Rand01());
+    p->size = Mix(0.025f, 0.08f, Rand01(rng));
 
     const float grav = std::sqrt(hole.massMsun / std::max(0.2f, p->radius));
-    p->angularSpeed = (white ? 0.045f : 0.070f) * grav * RandRange(0.85f, 1.15f);
-    p->drift = (white ? 0.40f : 0.28f) * RandRange(0.75f, 1.25f);
+    p->angularSpeed = (white ? 0.045f : 0.070f) * grav * RandRange(rng, 0.85f, 1.15f);
+    p->drift = (white ? 0.40f : 0.28f) * RandRange(rng, 0.75f, 1.25f);
 }
 
-std::vector<DiskParticle> BuildDiskParticles(const std::vector<Hole>& holes) {
+std::vector<DiskParticle> BuildDiskParticles(const std::vector<Hole>& holes, Rng* rng) {
     std::vector<DiskParticle> particles;
     particles.reserve(kDiskParticlesPerHole * static_cast<int>(holes.size()));
     for (int holeIndex = 0; holeIndex < static_cast<int>(holes.size()); ++holeIndex) {
         for (int i = 0; i < kDiskParticlesPerHole; ++i) {
             DiskParticle p;
             p.holeIndex = holeIndex;
-            ResetDiskParticle(&p, holes[holeIndex]);
+            ResetDiskParticle(&p, holes[holeIndex], rng);
             particles.push_back(p);
         }
     }
     return particles;
 }
 
-void ResetBridgeParticle(BridgeParticle* p) {
+void ResetBridgeParticle(BridgeParticle* p, Rng* rng) {
     p->position = {
-        RandRange(-9.0f, 9.0f),
-        RandRange(-3.0f, 3.0f),
-        RandRange(-8.5f, 8.5f),
+        RandRange(rng, -9.0f, 9.0f),
+        RandRange(rng, -3.0f, 3.0f),
+        RandRange(rng, -8.5f, 8.5f),
     };
     p->prev = p->position;
     p->velocity = {
-        RandRange(-0.8f, 0.8f),
-        RandRange(-0.35f, 0.35f),
-        RandRange(-0.8f, 0.8f),
+        RandRange(rng, -0.8f, 0.8f),
+        RandRange(rng, -0.35f, 0.35f),
+        RandRange(rng, -0.8f, 0.8f),
     };
-    p->life = RandRange(4.0f, 11.0f);
-    p->size = RandRange(0.018f, 0.052f);
+    p->life = RandRange(rng, 4.0f, 11.0f);
+    p->size = RandRange(rng, 0.018f, 0.052f);
 }
 
-std::vector<BridgeParticle> BuildBridgeParticles() {
+std::vector<BridgeParticle> BuildBridgeParticles(Rng* rng) {
     std::vector<BridgeParticle> particles;
     particles.reserve(kBridgeParticleCount);
     for (int i = 0; i < kBridgeParticleCount; ++i) {
         BridgeParticle p;
-        ResetBridgeParticle(&p);
+        ResetBridgeParticle(&p, rng);
         particles.push_back(p);
     }
     return particles;
 }
 
-void ResetJetParticle(JetParticle* p) {
-    p->lane = Rand01() < 0.5f ? -1.0f : 1.0f;
-    p->y = RandRange(0.0f, 22.0f);
+void ResetJetParticle(JetParticle* p, Rng* rng) {
+    p->lane = Rand01(rng) < 0.5f ? -1.0f : 1.0f;
+    p->y = RandRange(rng, 0.0f, 22.0f);
     p->prevY = p->y;
-    p->speed = RandRange(4.0f, 9.5f);
-    p->radius = RandRange(0.09f, 0.62f);
-    p->swirl = RandRange(0.6f, 2.2f);
-    p->phase = RandRange(0.0f, 2.0f * PI);
-    p->heat = RandRange(0.35f, 1.0f);
+    p->speed = RandRange(rng, 4.0f, 9.5f);
+    p->radius = RandRange(rng, 0.09f, 0.62f);
+    p->swirl = RandRange(rng, 0.6f, 2.2f);
+    p->phase = RandRange(rng, 0.0f, 2.0f * PI);
+    p->heat = RandRange(rng, 0.35f, 1.0f);
 }
 
-std::vector<JetParticle> BuildWhiteJetParticles() {
+std::vector<JetParticle> BuildWhiteJetParticles(Rng* rng) {
     std::vector<JetParticle> particles;
     particles.reserve(kWhiteJetParticleCount);
     for (int i = 0; i < kWhiteJetParticleCount; ++i) {
         JetParticle p;
-        ResetJetParticle(&p);
+        ResetJetParticle(&p, rng);
         particles.push_back(p);
     }
     return particles;
@@ -314,21 +358,21 @@ Vector3 WormPoint(const Wormhole& worm, float uNorm, float theta) {
     };
 }
 
-void ResetWormParticle(WormParticle* p, bool startAtInlet) {
-    p->u = startAtInlet ? -1.02f : RandRange(-1.0f, 1.0f);
-    p->theta = RandRange(0.0f, 2.0f * PI);
-    p->speed = RandRange(0.45f, 1.25f);
-    p->swirl = RandRange(1.2f, 3.2f);
-    p->heat = RandRange(0.25f, 1.0f);
-    p->size = RandRange(0.016f, 0.05f);
+void ResetWormParticle(WormParticle* p, bool startAtInlet, Rng* rng) {
+    p->u = startAtInlet ? -1.02f : RandRange(rng, -1.0f, 1.0f);
+    p->theta = RandRange(rng, 0.0f, 2.0f * PI);
+    p->speed = RandRange(rng, 0.45f, 1.25f);
+    p->swirl = RandRange(rng, 1.2f, 3.2f);
+    p->heat = RandRange(rng, 0.25f, 1.0f);
+    p->size = RandRange(rng, 0.016f, 0.05f);
 }
 
-std::vector<WormParticle> BuildWormParticles(const Wormhole& worm) {
+std::vector<WormParticle> BuildWormParticles(const Wormhole& worm, Rng* rng) {
     std::vector<WormParticle> particles;
     particles.reserve(kWormholeParticleCount);
     for (int i = 0; i < kWormholeParticleCount; ++i) {
         WormParticle p;
-        ResetWormParticle(&p, false);
+        ResetWormParticle(&p, false, rng);
         p.position = WormPoint(worm, p.u, p.theta);
         p.prev = p.position;
         particles.push_back(p);
@@ -377,7 +421,7 @@ void DrawWormholeSurface(const Wormhole& worm, float time, const RenderQuality&
     DrawSphereWires(mouthOut, worm.throatRadius * 1.06f, 22, 22, WithAlpha(worm.colorB, 180));
 }
 
-float UpdateWormParticles(std::vector<WormParticle>* particles, const Wormhole& worm, float dt, float simSpeed) {
+float UpdateWormParticles(std::vector<WormParticle>* particles, const Wormhole& worm, float dt, float simSpeed, Rng* rng) {
     float speedSum = 0.0f;
     for (WormParticle& p : *particles) {
         p.prev = p.position;
@@ -385,7 +429,7 @@ float UpdateWormParticles(std::vector<WormParticle>* particles, const Wormhole&
         p.u += p.speed * dt * simSpeed * speedScale;
         p.theta += p.swirl * dt * simSpeed * (1.5f - 0.7f * std::fabs(p.u));
 
-        if (p.u > 1.05f) ResetWormParticle(&p, true);
+        if (p.u > 1.05f) ResetWormParticle(&p, true, rng);
         p.position = WormPoint(worm, p.u, p.theta);
         speedSum += Vector3Length(Vector3Scale(Vector3Subtract(p.position, p.prev), 1.0f / std::max(1e-4f, dt)));
     }
@@ -402,7 +446,7 @@ void DrawWormParticles(const std::vector<WormParticle>& particles, const RenderQ
         if (quality.pointMode && (i % 3 != 0)) {
             DrawPoint3D(p.position, c);
         } else {
-            DrawSphere(p.position, p.size * (0.65f + 0.8f * centerBoost), c);
+            astro_render::DrawSphereLod(p.position, p.size * (0.65f + 0.8f * centerBoost), c);
         }
     }
 }
@@ -437,7 +481,7 @@ void DrawStars(const std::vector<Star>& stars, float time, const RenderQuality&
         if (quality.pointMode && (i % 4 != 0)) {
             DrawPoint3D(s.position, c);
         } else {
-            DrawSphere(s.position, s.radius * glow, c);
+            astro_render::DrawSphereLod(s.position, s.radius * glow, c);
         }
     }
 }
@@ -453,13 +497,13 @@ void DrawPhotonRings(const Hole& hole, float time) {
 
 void DrawHoleBody(const Hole& hole, float time) {
     const float pulse = 0.5f + 0.5f * std::sin(time * 2.4f + (hole.white ? 1.3f : 0.0f));
-    DrawSphere(hole.center, hole.horizon * 0.92f, hole.core);
-    DrawSphere(hole.center, hole.horizon * 1.22f, WithAlpha(hole.halo, static_cast<unsigned char>(40 + 35 * pulse)));
+    astro_render::DrawSphereLod(hole.center, hole.horizon * 0.92f, hole.core);
+    astro_render::DrawSphereLod(hole.center, hole.horizon * 1.22f, WithAlpha(hole.halo, static_cast<unsigned char>(40 + 35 * pulse)));
     DrawSphereWires(hole.center, hole.horizon * 1.28f, 22, 22, WithAlpha(hole.accent, static_cast<unsigned char>(90 + 90 * pulse)));
     DrawPhotonRings(hole, time);
 }
 
-void UpdateDiskParticles(std::vector<DiskParticle>* particles, const std::vector<Hole>& holes, float dt, float simSpeed, float* blackSpeedOut, float* whiteSpeedOut) {
+void UpdateDiskParticles(std::vector<DiskParticle>* particles, const std::vector<Hole>& holes, float dt, float simSpeed, float* blackSpeedOut, float* whiteSpeedOut, Rng* rng) {
     float blackSpeedSum = 0.0f;
     float whiteSpeedSum = 0.0f;
     int blackCount = 0;
@@ -477,10 +521,10 @@ void UpdateDiskParticles(std::vector<DiskParticle>* particles, const std::vector
         p.angle += p.angularSpeed * scaledDt * whirl * (1.0f + 0.24f / std::max(inner, p.radius));
         if (white) {
             p.radius += p.drift * scaledDt * radialStrength * (0.6f + 0.4f * p.heat);
-            if (p.radius > outer) ResetDiskParticle(&p, hole);
+            if (p.radius > outer) ResetDiskParticle(&p, hole, rng);
         } else {
             p.radius -= p.drift * scaledDt * radialStrength * (0.7f + 0.8f * p.heat);
-            if (p.radius < inner * 0.96f) ResetDiskParticle(&p, hole);
+            if (p.radius < inner * 0.96f) ResetDiskParticle(&p, hole, rng);
         }
 
         const float yWave = std::sin(p.phase + p.angle * 3.0f) * 0.12f;
@@ -517,7 +561,19 @@ void UpdateDiskParticles(std::vector<DiskParticle>* particles, const std::vector
     *whiteSpeedOut = whiteCount > 0 ? whiteSpeedSum / static_cast<float>(whiteCount) : 0.0f;
 }
 
-void DrawDiskParticles(const std::vector<DiskParticle>& particles, const std::vector<Hole>& holes, const RenderQuality& quality) {
+// Disk sprites go through the instanced renderers when they are given; tails stay
+// immediate-mode lines.
+struct DiskInstancing {
+    astro_render::InstancedParticleRenderer spheres;
+    astro_render::InstancedParticleRenderer points;
+};
+
+void DrawDiskParticles(const std::vector<DiskParticle>& particles, const std::vector<Hole>& holes, const RenderQuality& quality,
+                       DiskInstancing* instanced) {
+    if (instanced != nullptr) {
+        instanced->spheres.Clear();
+        instanced->points.Clear();
+    }
     for (std::size_t i = 0; i < particles.size(); i += static_cast<std::size_t>(quality.diskStride)) {
         const DiskParticle& p = particles[i];
         const Hole& hole = holes[p.holeIndex];
@@ -541,14 +597,24 @@ void DrawDiskParticles(const std::vector<DiskParticle>& particles, const std::ve
             DrawLine3D(tail, p.position, WithAlpha(c, 130));
         }
         if (quality.pointMode && (i % 3 != 0)) {
-            DrawPoint3D(p.position, c);
+            if (instanced != nullptr) {
+                instanced->points.Add(p.position, 1.0f, c);
+            } else {
+                DrawPoint3D(p.position, c);
+            }
+        } else if (instanced != nullptr) {
+            instanced->spheres.Add(p.position, p.size * (0.8f + 0.6f * hot), c);
         } else {
-            DrawSphere(p.position, p.size * (0.8f + 0.6f * hot), c);
+            astro_render::DrawSphereLod(p.position, p.size * (0.8f + 0.6f * hot), c);
         }
     }
+    if (instanced != nullptr) {
+        instanced->spheres.Draw();
+        instanced->points.Draw();
+    }
 }
 
-void UpdateBridgeParticles(std::vector<BridgeParticle>* particles, const std::vector<Hole>& holes, const Wormhole& worm, float dt, float simSpeed, int* capturedByBlackOut, int* wormTransfersOut) {
+void UpdateBridgeParticles(std::vector<BridgeParticle>* particles, const std::vector<Hole>& holes, const Wormhole& worm, float dt, float simSpeed, int* capturedByBlackOut, int* wormTransfersOut, Rng* rng) {
     constexpr float kGravScale = 0.085f;
     int capturedByBlack = 0;
     int wormTransfers = 0;
@@ -596,8 +662,8 @@ void UpdateBridgeParticles(std::vector<BridgeParticle>* particles, const std::ve
         p.life -= dt * 0.55f;
 
         if (Vector3Distance(p.position, mouthIn) < worm.throatRadius * 0.62f) {
-            const float a = RandRange(0.0f, 2.0f * PI);
-            const float rr = worm.throatRadius * RandRange(0.4f, 0.92f);
+            const float a = RandRange(rng, 0.0f, 2.0f * PI);
+            const float rr = worm.throatRadius * RandRange(rng, 0.4f, 0.92f);
             p.position = {
                 mouthOut.x + rr * std::cos(a),
                 mouthOut.y + rr * std::sin(a),
@@ -605,8 +671,8 @@ void UpdateBridgeParticles(std::vector<BridgeParticle>* particles, const std::ve
             };
             p.prev = p.position;
             const Vector3 outDir = Vector3Normalize(Vector3{std::cos(a), std::sin(a), 1.45f});
-            p.velocity = Vector3Scale(outDir, RandRange(4.0f, 8.4f));
-            p.life = RandRange(4.5f, 10.5f);
+            p.velocity = Vector3Scale(outDir, RandRange(rng, 4.0f, 8.4f));
+            p.life = RandRange(rng, 4.5f, 10.5f);
             wormTransfers += 1;
         }
 
@@ -621,7 +687,7 @@ void UpdateBridgeParticles(std::vector<BridgeParticle>* particles, const std::ve
             if (hole.white && dist < hole.horizon * 0.82f) {
                 const Vector3 out = Vector3Normalize(Vector3Subtract(p.position, hole.center));
                 p.position = Vector3Add(hole.center, Vector3Scale(out, hole.horizon * 1.05f));
-                p.velocity = Vector3Scale(out, RandRange(3.0f, 7.2f));
+                p.velocity = Vector3Scale(out, RandRange(rng, 3.0f, 7.2f));
             }
         }
 
@@ -630,7 +696,7 @@ void UpdateBridgeParticles(std::vector<BridgeParticle>* particles, const std::ve
         }
         if (!reset && p.life <= 0.0f) reset = true;
 
-        if (reset) ResetBridgeParticle(&p);
+        if (reset) ResetBridgeParticle(&p, rng);
     }
 
     *capturedByBlackOut = capturedByBlack;
@@ -648,17 +714,17 @@ void DrawBridgeParticles(const std::vector<BridgeParticle>& particles, const Ren
         if (quality.pointMode && (i % 3 != 0)) {
             DrawPoint3D(p.position, c);
         } else {
-            DrawSphere(p.position, p.size * (0.85f + 0.7f * v), c);
+            astro_render::DrawSphereLod(p.position, p.size * (0.85f + 0.7f * v), c);
         }
     }
 }
 
-float UpdateWhiteJets(std::vector<JetParticle>* particles, const Hole& whiteHole, float dt, float simSpeed) {
+float UpdateWhiteJets(std::vector<JetParticle>* particles, const Hole& whiteHole, float dt, float simSpeed, Rng* rng) {
     float speedSum = 0.0f;
     for (JetParticle& p : *particles) {
         p.prevY = p.y;
         p.y += p.speed * dt * simSpeed;
-        if (p.y > 24.5f) ResetJetParticle(&p);
+        if (p.y > 24.5f) ResetJetParticle(&p, rng);
         speedSum += p.speed * simSpeed;
     }
     return particles->empty() ? 0.0f : speedSum / static_cast<float>(particles->size());
@@ -688,7 +754,7 @@ void DrawWhiteJets(const std::vector<JetParticle>& particles, const Hole& whiteH
         if (quality.pointMode && (i % 2 != 0)) {
             DrawPoint3D(pos, c);
         } else {
-            DrawSphere(pos, Mix(0.018f, 0.055f, p.heat) * (0.65f + 0.55f * fade), c);
+            astro_render::DrawSphereLod(pos, Mix(0.018f, 0.055f, p.heat) * (0.65f + 0.55f * fade), c);
         }
     }
 }
@@ -733,9 +799,170 @@ void DrawMinimalHud(
     DrawText(lineB, 34, 84, 18, Color{170, 188, 222, 255});
 }
 
+// DrawCircle3D as streak segments: the same 36-segment circle in the xy plane, rotated by
+// `angle` degrees about `axis`.
+void TraceCircle(astro_render::TraceScene* scene, Vector3 center, float radius, Vector3 axis, float angle, Color color) {
+    const Matrix rotation = MatrixRotate(axis, angle * DEG2RAD);
+    for (int i = 0; i < 360; i += 10) {
+        const Vector3 a = Vector3Transform({std::sin(DEG2RAD * i) * radius, std::cos(DEG2RAD * i) * radius, 0.0f}, rotation);
+        const Vector3 b = Vector3Transform({std::sin(DEG2RAD * (i + 10)) * radius, std::cos(DEG2RAD * (i + 10)) * radius, 0.0f}, rotation);
+        scene->AddStreak(Vector3Add(center, a), Vector3Add(center, b), 0.03f, color);
+    }
+}
+
+// The frame main() draws at HIGH quality, as path-tracer primitives. The two horizons are
+// the opaque bodies -- the white hole's glows with its core colour -- and everything else
+// is a glow or a streak; the wormhole shell becomes glow patches. Wireframe overlays
+// (DrawSphereWires, the shell's wire lines) and the HUD are left out.
+void BuildTraceScene(const std::vector<Hole>& holes, const Wormhole& worm, const std::vector<Star>& stars,
+                     const std::vector<DiskParticle>& disk, const std::vector<BridgeParticle>& bridge,
+                     const std::vector<JetParticle>& whiteJets, const std::vector<WormParticle>& wormParticles, float sceneTime,
+                     astro_render::TraceScene* scene) {
+    scene->background = astro_render::LinearRgb(Color{4, 7, 14, 255});
+
+    const float starTime = sceneTime * 0.55f;
+    for (const Star& s : stars) {
+        const float glow = 0.55f + 0.45f * std::sin(starTime * s.twinkle + s.phase);
+        scene->AddGlow(s.position, s.radius * glow, WithAlpha(s.color, static_cast<unsigned char>(80 + 170 * glow)), 4.0f);
+    }
+
+    for (const DiskParticle& p : disk) {
+        const Hole& hole = holes[p.holeIndex];
+        const float inner = hole.horizon * kDiskInnerScale;
+        const float outer = hole.horizon * kDiskOuterScale;
+        const float hot = 1.0f - Clamp01((p.radius - inner) / std::max(0.01f, (outer - inner)));
+        const float boost = Clamp01(Vector3Length(p.velocity) / 8.0f);
+        Color c;
+        if (hole.white) {
+            c = LerpColor(LerpColor(Color{142, 197, 255, 255}, Color{255, 248, 210, 255}, hot), Color{255, 255, 255, 255}, boost * 0.45f);
+        } else {
+            c = LerpColor(LerpColor(Color{255, 190, 120, 255}, Color{255, 86, 38, 255}, hot), Color{255, 236, 190, 255}, boost * 0.35f);
+        }
+        c = WithAlpha(c, static_cast<unsigned char>(170 + 80 * hot));
+        const float size = p.size * (0.8f + 0.6f * hot);
+        scene->AddStreak(Vector3Subtract(p.position, Vector3Scale(p.velocity, 0.018f)), p.position, 0.5f * size, WithAlpha(c, 130));
+        scene->AddGlow(p.position, size, c, 2.0f);
+    }
+
+    for (const BridgeParticle& p : bridge) {
+        const float v = Clamp01(Vector3Length(p.velocity) / 8.5f);
+        const Color c = WithAlpha(LerpColor(Color{118, 176, 255, 255}, Color{255, 219, 150, 255}, v), static_cast<unsigned char>(85 + 150 * v));
+        const float size = p.size * (0.85f + 0.7f * v);
+        scene->AddStreak(p.prev, p.position, 0.5f * size, WithAlpha(c, 96));
+        scene->AddGlow(p.position, size, c, 2.0f);
+    }
+
+    const Hole& whiteHole = holes[1];
+    for (const JetParticle& p : whiteJets) {
+        const float spin0 = p.swirl * p.prevY + p.phase + sceneTime * 0.5f;
+        const float spin1 = p.swirl * p.y + p.phase + sceneTime * 0.5f;
+        const Vector3 prevPos = {whiteHole.center.x + p.radius * std::cos(spin0), whiteHole.center.y + p.lane * p.prevY,
+                                 whiteHole.center.z + p.radius * std::sin(spin0)};
+        const Vector3 pos = {whiteHole.center.x + p.radius * std::cos(spin1), whiteHole.center.y + p.lane * p.y,
+                             whiteHole.center.z + p.radius * std::sin(spin1)};
+        const float fade = 1.0f - Clamp01(p.y / 24.5f);
+        const Color c = WithAlpha(LerpColor(Color{145, 195, 255, 255}, Color{255, 255, 240, 255}, p.heat),
+                                  static_cast<unsigned char>(60 + 170 * fade));
+        const float size = Mix(0.018f, 0.055f, p.heat) * (0.65f + 0.55f * fade);
+        scene->AddStreak(prevPos, pos, 0.5f * size, WithAlpha(c, static_cast<unsigned char>(90 * fade + 30)));
+        scene->AddGlow(pos, size, c, 2.0f);
+    }
+
+    const RenderQuality quality;
+    for (int i = 0; i < quality.wormRings - 1; ++i) {
+        const float u0 = Mix(-1.0f, 1.0f, static_cast<float>(i) / static_cast<float>(quality.wormRings - 1));
+        const float u1 = Mix(-1.0f, 1.0f, static_cast<float>(i + 1) / static_cast<float>(quality.wormRings - 1));
+        const float glow = 1.0f - std::fabs(u0);
+        const float pulse = 0.45f + 0.55f * (0.5f + 0.5f * std::sin(sceneTime * 2.0f + u0 * 5.0f));
+        const Color shell = LerpColor(worm.colorA, worm.colorB, 0.45f + 0.5f * glow);
+        const Color c = WithAlpha(shell, static_cast<unsigned char>(35 + 80 * glow * pulse));
+        for (int j = 0; j < quality.wormSegs; ++j) {
+            const float t0 = 2.0f * PI * static_cast<float>(j) / static_cast<float>(quality.wormSegs);
+            const float t1 = 2.0f * PI * static_cast<float>(j + 1) / static_cast<float>(quality.wormSegs);
+            const Vector3 p00 = WormPoint(worm, u0, t0);
+            const Vector3 p01 = WormPoint(worm, u0, t1);
+            const Vector3 p11 = WormPoint(worm, u1, t1);
+            scene->AddPatch(Vector3Scale(Vector3Add(p00, p11), 0.5f), Vector3Distance(p00, p01) * Vector3Distance(p01, p11), c);
+        }
+    }
+    for (int k = 0; k < 8; ++k) {
+        const float u = Mix(-1.0f, 1.0f, static_cast<float>(k) / 7.0f);
+        const Vector3 center = {worm.center.x, worm.center.y, worm.center.z + u * worm.halfLength};
+        const Color ring = WithAlpha(LerpColor(worm.colorA, worm.colorB, 0.5f + 0.5f * u),
+                                     static_cast<unsigned char>(70 + 70 * (1.0f - std::fabs(u))));
+        TraceCircle(scene, center, WormRadiusAt(worm, u), {0.0f, 0.0f, 1.0f}, 0.0f, ring);
+    }
+
+    for (const WormParticle& p : wormParticles) {
+        const float centerBoost = 1.0f - Clamp01(std::fabs(p.u));
+        const Color c = WithAlpha(LerpColor(Color{130, 180, 255, 255}, Color{180, 255, 255, 255}, p.heat),
+                                  static_cast<unsigned char>(70 + 160 * centerBoost));
+        const float size = p.size * (0.65f + 0.8f * centerBoost);
+        scene->AddStreak(p.prev, p.position, 0.5f * size, WithAlpha(c, 110));
+        scene->AddGlow(p.position, size, c, 2.0f);
+    }
+
+    for (const Hole& hole : holes) {
+        const float pulse = 0.5f + 0.5f * std::sin(sceneTime * 2.4f + (hole.white ? 1.3f : 0.0f));
+        scene->AddBody(hole.center, hole.horizon * 0.92f, hole.core,
+                       hole.white ? astro_render::LinearRgb(hole.core) : Vector3{0.0f, 0.0f, 0.0f});
+        scene->AddGlow(hole.center, hole.horizon * 1.22f, WithAlpha(hole.halo, static_cast<unsigned char>(40 + 35 * pulse)));
+
+        const float ringPulse = 0.65f + 0.35f * std::sin(sceneTime * 2.2f + (hole.white ? 1.5f : 0.0f));
+        const float base = hole.horizon * 2.9f;
+        const Color ringColor = WithAlpha(hole.accent, static_cast<unsigned char>(120 + 90 * ringPulse));
+        TraceCircle(scene, hole.center, base, {1.0f, 0.0f, 0.0f}, 90.0f, ringColor);
+        TraceCircle(scene, hole.center, base * 1.08f, {1.0f, 0.0f, 0.0f}, 90.0f, WithAlpha(ringColor, 95));
+        TraceCircle(scene, hole.center, base * 0.92f, {0.95f, 0.15f, 0.20f}, 90.0f, WithAlpha(ringColor, 80));
+    }
+    scene->Build();
+}
+
+// The camera follows the auto-orbit the window would have made by --time; --preset is
+// not used, this demo has no camera presets.
+int RenderStillFrame(const astro_render::StillOptions& options) {
+    SceneRngs rngs;
+    const std::vector<Hole> holes = BuildHoles();
+    const Wormhole wormhole = BuildWormhole();
+    const std::vector<Star> stars = BuildStars(&rngs.stars);
+    std::vector<DiskParticle> disk = BuildDiskParticles(holes, &rngs.disk);
+    std::vector<BridgeParticle> bridge = BuildBridgeParticles(&rngs.bridge);
+    std::vector<JetParticle> whiteJets = BuildWhiteJetParticles(&rngs.jets);
+    std::vector<WormParticle> wormParticles = BuildWormParticles(wormhole, &rngs.worm);
+
+    float sceneTime = 0.0f;
+    float blackMeanSpeed = 0.0f, whiteMeanSpeed = 0.0f;
+    int captures = 0, transfers = 0;
+    for (; sceneTime < options.time; sceneTime += kRenderStep) {
+        UpdateDiskParticles(&disk, holes, kRenderStep, 1.0f, &blackMeanSpeed, &whiteMeanSpeed, &rngs.disk);
+        UpdateBridgeParticles(&bridge, holes, wormhole, kRenderStep, 1.0f, &captures, &transfers, &rngs.bridge);
+        UpdateWhiteJets(&whiteJets, holes[1], kRenderStep, 1.0f, &rngs.jets);
+        UpdateWormParticles(&wormParticles, wormhole, kRenderStep, 1.0f, &rngs.worm);
+    }
+
+    CameraRig rig;
+    rig.target = {4.0f, 0.6f, 0.0f};
+    rig.yaw += 0.12f * sceneTime;
+    const float cp = std::cos(rig.pitch);
+    Camera3D camera{};
+    camera.target = rig.target;
+    camera.position = Vector3Add(rig.target, {rig.distance * cp * std::cos(rig.yaw), rig.distance * std::sin(rig.pitch),
+                                              rig.distance * cp * std::sin(rig.yaw)});
+    camera.up = {0.0f, 1.0f, 0.0f};
+    camera.fovy = 46.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+
+    astro_render::TraceScene scene;
+    BuildTraceScene(holes, wormhole, stars, disk, bridge, whiteJets, wormParticles, sceneTime, &scene);
+    return astro_render::RenderStill("dual_black_white_hole_viz", scene, camera, options);
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_render::StillOptions still = astro_render::ParseStillArgs(argc, argv, "dual_black_white_hole");
+    if (still.enabled) return RenderStillFrame(still);
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(kScreenWidth, kScreenHeight, "Dual Black Hole + White Hole 3D - C++");
     SetWindowMinSize(kWindowMinWidth, kWindowMinHeight);
@@ -748,25 +975,26 @@ int main() {
     camera.fovy = 46.0f;
     camera.projection = CAMERA_PERSPECTIVE;
 
-    std::vector<Hole> holes = {
-        {"Black Hole", {-6.2f, 0.0f, 0.0f}, 145.0f, 1.4f, false, BLACK, Color{80, 100, 140, 255}, Color{255, 145, 95, 255}},
-        {"White Hole", { 6.2f, 0.0f, 0.0f}, 116.0f, 1.3f, true,  Color{245, 248, 255, 255}, Color{180, 210, 255, 255}, Color{170, 215, 255, 255}},
-    };
-    for (Hole& hole : holes) UpdateHoleScale(&hole);
-    Wormhole wormhole{{15.2f, 0.0f, 0.0f}, 1.22f, 0.62f, 4.8f, Color{105, 165, 255, 255}, Color{170, 245, 255, 255}};
+    std::vector<Hole> holes = BuildHoles();
+    Wormhole wormhole = BuildWormhole();
 
     CameraRig rig;
     rig.target = {4.0f, 0.6f, 0.0f};
-    const std::vector<Star> stars = BuildStars();
-    std::vector<DiskParticle> disk = BuildDiskParticles(holes);
-    std::vector<BridgeParticle> bridge = BuildBridgeParticles();
-    std::vector<JetParticle> whiteJets = BuildWhiteJetParticles();
-    std::vector<WormParticle> wormParticles = BuildWormParticles(wormhole);
+    SceneRngs rngs;
+    const std::vector<Star> stars = BuildStars(&rngs.stars);
+    std::vector<DiskParticle> disk = BuildDiskParticles(holes, &rngs.disk);
+    std::vector<BridgeParticle> bridge = BuildBridgeParticles(&rngs.bridge);
+    std::vector<JetParticle> whiteJets = BuildWhiteJetParticles(&rngs.jets);
+    std::vector<WormParticle> wormParticles = BuildWormParticles(wormhole, &rngs.worm);
 
     bool paused = false;
     bool autoOrbit = true;
     bool hudVisible = true;
     bool forceEcoRender = false;
+    bool instancedDisk = true;
+    DiskInstancing diskInstancing;
+    diskInstancing.spheres.Init(astro_render::InstanceShape::kSphere);
+    diskInstancing.points.Init(astro_render::InstanceShape::kScreenPoint);
     float simSpeed = 1.0f;
     float sceneTime = 0.0f;
     float blackMeanSpeed = 0.0f;
@@ -779,12 +1007,33 @@ int main() {
     int fpsNow = 60;
     RenderQuality renderQuality = BuildRenderQuality(fpsSmoothed);
 
+    // The four particle systems only read the holes and the wormhole, so they update as
+    // parallel tasks; stepDt is zero while paused.
+    float stepDt = 0.0f;
+    astro_parallel::TaskGraph updates;
+    updates.Add("disk", [&]() {
+        if (stepDt > 0.0f) UpdateDiskParticles(&disk, holes, stepDt, simSpeed, &blackMeanSpeed, &whiteMeanSpeed, &rngs.disk);
+    });
+    updates.Add("bridge", [&]() {
+        if (stepDt > 0.0f) {
+            UpdateBridgeParticles(&bridge, holes, wormhole, stepDt, simSpeed, &capturesFrame, &wormTransfersFrame, &rngs.bridge);
+        }
+    });
+    updates.Add("jets", [&]() {
+        if (stepDt > 0.0f) whiteJetSpeed = UpdateWhiteJets(&whiteJets, holes[1], stepDt, simSpeed, &rngs.jets);
+    });
+    updates.Add("worm", [&]() {
+        if (stepDt > 0.0f) wormFlowSpeed = UpdateWormParticles(&wormParticles, wormhole, stepDt, simSpeed, &rngs.worm);
+    });
+    char timings[192] = "";
+
     while (!WindowShouldClose()) {
         const float dt = GetFrameTime();
         if (IsKeyPressed(KEY_SPACE)) paused = !paused;
         if (IsKeyPressed(KEY_A)) autoOrbit = !autoOrbit;
         if (IsKeyPressed(KEY_H)) hudVisible = !hudVisible;
         if (IsKeyPressed(KEY_L)) forceEcoRender = !forceEcoRender;
+        if (IsKeyPressed(KEY_I)) instancedDisk = !instancedDisk;
 
         if (IsKeyDown(KEY_Q)) simSpeed = std::max(0.25f, simSpeed - dt * 0.8f);
         if (IsKeyDown(KEY_E)) simSpeed = std::min(4.0f, simSpeed + dt * 0.8f);
@@ -814,21 +1063,20 @@ int main() {
 
         if (!paused) {
             sceneTime += dt * simSpeed;
-            UpdateDiskParticles(&disk, holes, dt, simSpeed, &blackMeanSpeed, &whiteMeanSpeed);
-            UpdateBridgeParticles(&bridge, holes, wormhole, dt, simSpeed, &capturesFrame, &wormTransfersFrame);
-            whiteJetSpeed = UpdateWhiteJets(&whiteJets, holes[1], dt, simSpeed);
-            wormFlowSpeed = UpdateWormParticles(&wormParticles, wormhole, dt, simSpeed);
         } else {
             capturesFrame = 0;
             wormTransfersFrame = 0;
         }
+        stepDt = paused ? 0.0f : dt;
+        updates.Run();
+        updates.FormatTimings(timings, sizeof(timings));
 
         BeginDrawing();
         ClearBackground(Color{4, 7, 14, 255});
         BeginMode3D(camera);
 
         DrawStars(stars, sceneTime * 0.55f, renderQuality);
-        DrawDiskParticles(disk, holes, renderQuality);
+        DrawDiskParticles(disk, holes, renderQuality, instancedDisk ? &diskInstancing : nullptr);
         DrawBridgeParticles(bridge, renderQuality);
         DrawWhiteJets(whiteJets, holes[1], sceneTime, renderQuality);
         DrawWormholeSurface(wormhole, sceneTime, renderQuality);
@@ -840,13 +1088,19 @@ int main() {
 
         if (hudVisible) {
             DrawMinimalHud(holes, wormhole, blackMeanSpeed, whiteMeanSpeed, whiteJetSpeed, wormFlowSpeed, simSpeed, static_cast<int>(bridge.size()), capturesFrame, wormTransfersFrame, paused, fpsNow, renderQuality);
-            DrawRectangleRounded(Rectangle{18.0f, static_cast<float>(GetScreenHeight() - 38), 940.0f, 26.0f}, 0.20f, 6, Color{8, 13, 22, 160});
-            DrawText("Mouse drag orbit | wheel zoom | Z/X black mass | C/V white mass | B/N wormhole throat | Q/E sim speed | A auto | L eco render | H hide HUD", 28, GetScreenHeight() - 30, 15, Color{188, 202, 231, 255});
+            DrawRectangleRounded(Rectangle{18.0f, static_cast<float>(GetScreenHeight() - 38), 1060.0f, 26.0f}, 0.20f, 6, Color{8, 13, 22, 160});
+            DrawText("Mouse drag orbit | wheel zoom | Z/X black mass | C/V white mass | B/N wormhole throat | Q/E sim speed | A auto | L eco render | I instanced disk | H hide HUD", 28, GetScreenHeight() - 30, 15, Color{188, 202, 231, 255});
+            DrawText(timings, 28, GetScreenHeight() - 58, 15, Color{150, 170, 204, 255});
         }
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    diskInstancing.spheres.Unload();
+    diskInstancing.points.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,5 +1,8 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/deflection_table.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
 
 #include <algorithm>
 #include <cmath>
@@ -10,6 +13,9 @@ namespace {
 constexpr int kScreenW = 1280;
 constexpr int kScreenH = 820;
 constexpr float kPi = 3.14159265358979323846f;
+// Observer-lens distance in Schwarzschild radii, with the source twice as far. Close
+// enough that the minor image visibly crowds the photon sphere instead of the centre.
+constexpr float kLensDistanceRs = 80.0f;
 
 struct Vec2f {
     float y;
@@ -54,14 +60,60 @@ Vec2f Add(Vec2f a, Vec2f b) {
     return {a.y + b.y, a.z + b.z};
 }
 
+// Einstein angle in radians for D_ls / D_s = 1/2: sqrt(2 rs D_ls / (D_l D_s)).
+float PhysicalEinsteinAngle() {
+    return 1.0f / std::sqrt(kLensDistanceRs);
+}
+
+// Signed physical image angle theta on the source's axis solving the exact lens equation
+// beta = theta - (D_ls / D_s) alpha(b), with b = theta D_l from the geodesic table. The
+// right side is monotonic above the capture angle, so a bisection finds the one root;
+// theta < capture is the shadow, where it reads -inf.
+float SolveImageAngle(float betaSigned) {
+    const astro_lensing::DeflectionTable& deflection = astro_lensing::SharedDeflectionTable();
+    const float side = betaSigned >= 0.0f ? 1.0f : -1.0f;
+    const float target = std::fabs(betaSigned);
+    // Major image: theta - alpha/2 = |beta|. Minor image: the same curve at -|beta|.
+    float lo = static_cast<float>(astro_lensing::kCaptureImpact) / kLensDistanceRs;
+    float hi = target + 2.0f * PhysicalEinsteinAngle();
+    for (int it = 0; it < 32; ++it) {
+        const float mid = 0.5f * (lo + hi);
+        const float rhs = mid - 0.5f * deflection.Deflection(mid * kLensDistanceRs);
+        (rhs < side * target ? lo : hi) = mid;
+    }
+    return 0.5f * (lo + hi);
+}
+
+// Display angles are scaled so that thetaE (the mass control) is the weak-field Einstein
+// radius; the exact map then only departs from the point-lens formula near the hole.
 Vec2f ImagePosition(Vec2f beta, float thetaE, bool majorImage) {
+    const float toPhysical = PhysicalEinsteinAngle() / thetaE;
     float b = Length(beta);
-    if (b < 0.001f) return {majorImage ? thetaE : -thetaE, 0.0f};
+    if (b < 0.001f) {
+        float ring = SolveImageAngle(0.0f) / toPhysical;
+        return {majorImage ? ring : -ring, 0.0f};
+    }
 
     Vec2f dir = Scale(beta, 1.0f / b);
-    float root = std::sqrt(b * b + 4.0f * thetaE * thetaE);
-    float radius = 0.5f * (b + (majorImage ? root : -root));
-    return Scale(dir, radius);
+    float theta = SolveImageAngle((majorImage ? b : -b) * toPhysical) / toPhysical;
+    return Scale(dir, majorImage ? theta : -theta);
+}
+
+float EinsteinRingRadius(float thetaE) {
+    return ImagePosition({0.0f, 0.0f}, thetaE, true).y;
+}
+
+// Arrival-time difference minor - major in rs / c: the geometric excess
+// D_l D_s / (2 D_ls) (theta - beta)^2 plus the table's Shapiro delay at each impact.
+float ImageTimeLag(Vec2f sourceSky, float thetaE) {
+    const astro_lensing::DeflectionTable& deflection = astro_lensing::SharedDeflectionTable();
+    const float toPhysical = PhysicalEinsteinAngle() / thetaE;
+    const float beta = Length(sourceSky) * toPhysical;
+    auto arrival = [&](float theta) {
+        const float offset = std::fabs(theta) - (theta >= 0.0f ? beta : -beta);
+        return kLensDistanceRs * offset * offset + deflection.Delay(std::fabs(theta) * kLensDistanceRs);
+    };
+    return arrival(-SolveImageAngle(-beta)) - arrival(SolveImageAngle(beta));
 }
 
 void UpdateOrbitCamera(Camera3D* camera, float* yaw, float* pitch, float* distance) {
@@ -251,7 +303,7 @@ void DrawBlackHole(const SceneFrame& frame, float thetaE, float skyScale, float
     DrawSphereWires(ToWorld(frame, {0.0f, 0.0f, 0.0f}), 0.50f, 30, 18, Fade(Color{25, 31, 45, 255}, 0.92f));
     DrawCircleYZ(frame, 0.0f, 0.61f, Fade(Color{255, 166, 78, 255}, 0.88f), 128);
     DrawCircleYZ(frame, 0.0f, 0.74f, Fade(Color{255, 222, 142, 255}, 0.28f), 128);
-    DrawCircleYZ(frame, 0.0f, thetaE * skyScale, Fade(Color{255, 231, 152, 255}, 0.44f), 160);
+    DrawCircleYZ(frame, 0.0f, EinsteinRingRadius(thetaE) * skyScale, Fade(Color{255, 231, 152, 255}, 0.44f), 160);
 }
 
 void DrawImageTrails(const SceneFrame& frame, const std::deque<Vec2f>& trail, float thetaE, float skyScale) {
@@ -364,9 +416,10 @@ void DrawLensingScene(Camera3D camera, Vec2f sourceSky, float thetaE, float phas
         DrawCurvedRay(frame, surfacePoint, impact, observer, Fade(Color{255, 222, 126, 255}, 0.20f), Fade(Color{255, 222, 126, 255}, 0.28f));
     }
 
+    const float ringRadius = EinsteinRingRadius(thetaE) * skyScale;
     for (int i = 0; i < 26; ++i) {
         float a = 2.0f * kPi * static_cast<float>(i) / 26.0f;
-        Vector3 ringImpact{0.0f, thetaE * skyScale * std::cos(a), thetaE * skyScale * std::sin(a)};
+        Vector3 ringImpact{0.0f, ringRadius * std::cos(a), ringRadius * std::sin(a)};
         DrawLine3D(ToWorld(frame, ringImpact), ToWorld(frame, observer), Fade(Color{255, 220, 130, 255}, 0.12f));
     }
 
@@ -473,17 +526,21 @@ int main() {
         DrawText("` camera-follow sim | mouse orbit | wheel zoom | arrows move star | [ ] mass | Space drift | L labels",
                  40, 96, 18, Color{176, 195, 222, 255});
 
-        DrawRectangle(kScreenW - 300, 18, 272, 138, Fade(Color{5, 8, 16, 255}, 0.56f));
+        DrawRectangle(kScreenW - 300, 18, 272, 162, Fade(Color{5, 8, 16, 255}, 0.56f));
         char status[220];
-        std::snprintf(status, sizeof(status), "mass lens %.2f\nstar y %.2f  z %.2f\n%s  %s\nview %s",
-                      thetaE, sourceSky.y, sourceSky.z, autoDrift ? "auto drift" : "manual",
-                      paused ? "paused" : "running", followCamera ? "follow" : "free");
+        std::snprintf(status, sizeof(status), "mass lens %.2f\nstar y %.2f  z %.2f\nimage lag %.1f rs/c\n%s  %s\nview %s",
+                      thetaE, sourceSky.y, sourceSky.z, ImageTimeLag(sourceSky, thetaE),
+                      autoDrift ? "auto drift" : "manual", paused ? "paused" : "running",
+                      followCamera ? "follow" : "free");
         DrawText(status, kScreenW - 280, 38, 20, Color{126, 224, 255, 255});
         DrawFPS(38, kScreenH - 34);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
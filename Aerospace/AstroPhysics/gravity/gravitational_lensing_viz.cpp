@@ -1,5 +1,8 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/deflection_table.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
 
 #include <algorithm>
 #include <cmath>
@@ -17,11 +20,16 @@ constexpr float kSourceZ = -6.5f;
 constexpr float kLensZ = 0.0f;
 constexpr float kObserverZ = 6.5f;
 
+// World units per Schwarzschild radius per unit of lens strength: the default 0.85 puts
+// the capture radius at the 0.44 black sphere.
+constexpr float kRsPerStrength = 0.2f;
+
 struct RayPath {
     Vector3 source;
     Vector3 impact;
     Vector3 end;
     bool toObserver;
+    bool captured;
 };
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
@@ -48,6 +56,9 @@ std::vector<RayPath> BuildRays(Vector3 sourcePos, float lensStrength, int nRays)
     std::vector<RayPath> rays;
     rays.reserve(nRays);
 
+    const astro_lensing::DeflectionTable& deflection = astro_lensing::SharedDeflectionTable();
+    const float rs = kRsPerStrength * lensStrength;
+
     const Vector3 observer = {0.0f, 0.0f, kObserverZ};
 
     for (int i = 0; i < nRays; ++i) {
@@ -61,23 +72,34 @@ std::vector<RayPath> BuildRays(Vector3 sourcePos, float lensStrength, int nRays)
         };
 
         Vector3 bVec = {impact.x, impact.y, 0.0f};
-        float b = std::sqrt(impact.x * impact.x + impact.y * impact.y) + 0.06f;
-
-        float alpha = lensStrength / (b * b + 0.08f);
-        Vector3 towardLens = Vector3Normalize(Vector3Negate(bVec));
+        float b = std::sqrt(impact.x * impact.x + impact.y * impact.y);
+
+        // Exact light bending from the shared geodesic table; inside the capture radius
+        // the ray never leaves the hole.
+        float alpha = deflection.Deflection(b / rs);
+        if (std::isinf(alpha)) {
+            rays.push_back({sourcePos, impact, impact, false, true});
+            continue;
+        }
 
+        // Rotate the outgoing direction by alpha toward the lens axis, in the plane the
+        // two span, so strong-field rays can swing past 90 degrees.
         Vector3 dir = Vector3Normalize(Vector3Subtract(observer, impact));
-        dir = Vector3Normalize(Vector3Add(dir, Vector3Scale(towardLens, alpha)));
-
-        float t = (kObserverZ - impact.z) / std::max(0.001f, dir.z);
-        Vector3 end = Vector3Add(impact, Vector3Scale(dir, t));
-
-        bool hitsObserver = (std::fabs(end.x) < 0.45f && std::fabs(end.y) < 0.45f);
-        if (!hitsObserver) {
-            end = Vector3Add(impact, Vector3Scale(dir, 7.5f));
+        Vector3 towardLens = Vector3Normalize(Vector3Negate(bVec));
+        Vector3 perp = Vector3Subtract(towardLens, Vector3Scale(dir, Vector3DotProduct(towardLens, dir)));
+        perp = Vector3Normalize(perp);
+        dir = Vector3Add(Vector3Scale(dir, std::cos(alpha)), Vector3Scale(perp, std::sin(alpha)));
+
+        bool hitsObserver = false;
+        Vector3 end = Vector3Add(impact, Vector3Scale(dir, 7.5f));
+        if (dir.z > 0.001f) {
+            float t = (kObserverZ - impact.z) / dir.z;
+            Vector3 atObserver = Vector3Add(impact, Vector3Scale(dir, t));
+            hitsObserver = (std::fabs(atObserver.x) < 0.45f && std::fabs(atObserver.y) < 0.45f);
+            if (hitsObserver) end = atObserver;
         }
 
-        rays.push_back({sourcePos, impact, end, hitsObserver});
+        rays.push_back({sourcePos, impact, end, hitsObserver, false});
     }
 
     return rays;
@@ -95,12 +117,14 @@ void DrawCircleXY(float z, float radius, Color c, int segs) {
     }
 }
 
-std::string Hud(float lensStrength, Vector3 sourcePos, int hitCount) {
+std::string Hud(float lensStrength, Vector3 sourcePos, int hitCount, int capturedCount) {
     std::ostringstream os;
     os << std::fixed << std::setprecision(2)
        << "lens=" << lensStrength
        << "  source=(" << sourcePos.x << "," << sourcePos.y << ")"
-       << "  focused rays=" << hitCount;
+       << "  rs=" << kRsPerStrength * lensStrength
+       << "  focused rays=" << hitCount
+       << "  captured=" << capturedCount;
     return os.str();
 }
 
@@ -156,8 +180,10 @@ int main() {
 
         std::vector<RayPath> rays = BuildRays(sourcePos, lensStrength, 44);
         int hitCount = 0;
+        int capturedCount = 0;
         for (const RayPath& r : rays) {
             if (r.toObserver) hitCount++;
+            if (r.captured) capturedCount++;
         }
 
         BeginDrawing();
@@ -178,21 +204,28 @@ int main() {
             Color cIn = Color{130, 170, 255, 110};
             Color cOut = r.toObserver ? Color{255, 235, 170, 190} : Color{255, 140, 110, 95};
             DrawLine3D(r.source, r.impact, cIn);
-            DrawLine3D(r.impact, r.end, cOut);
+            if (r.captured) {
+                DrawLine3D(r.impact, {0.0f, 0.0f, kLensZ}, Color{150, 70, 60, 70});
+            } else {
+                DrawLine3D(r.impact, r.end, cOut);
+            }
             DrawSphere(r.impact, 0.03f, Color{255, 180, 120, 170});
         }
 
         EndMode3D();
 
-        DrawText("Gravitational Lensing (Thin Lens Approximation)", 20, 18, 29, Color{232, 238, 248, 255});
+        DrawText("Gravitational Lensing (Exact Schwarzschild Deflection)", 20, 18, 29, Color{232, 238, 248, 255});
         DrawText("Hold left mouse: orbit | wheel: zoom | arrows: move source | [ ] lens mass | P pause | R reset", 20, 54, 19, Color{164, 183, 210, 255});
-        std::string hud = Hud(lensStrength, sourcePos, hitCount);
+        std::string hud = Hud(lensStrength, sourcePos, hitCount, capturedCount);
         DrawText(hud.c_str(), 20, 82, 21, Color{126, 224, 255, 255});
         DrawFPS(20, 114);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,15 +1,28 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/magnification_map.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdio>
 #include <deque>
+#include <memory>
+#include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kPi = 3.14159265358979323846f;
+constexpr Rectangle kMapPanel = {940.0f, 150.0f, 320.0f, 320.0f};
+constexpr float kMapDisplayMax = 40.0f;  // magnification at the top of the log colour scale
+constexpr int kCurveSamples = 360;
+constexpr int kCurveFan = 9;             // tracks in the light-curve batch, centred on the current one
+constexpr float kFanSpacing = 0.05f;     // u0 step between them
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -32,9 +45,58 @@ float Magnification(float u) {
     u = std::max(u, 0.0001f);
     return (u * u + 2.0f) / (u * std::sqrt(u * u + 4.0f));
 }
+
+// Log magnification from deep blue through orange to white; row 0 of the map is drawn
+// at the bottom so +y points up on screen.
+void PaintMagnificationMap(const astro_lensing::MagnificationMap& map, std::vector<Color>* pixels) {
+    const int n = map.resolution();
+    pixels->resize(static_cast<size_t>(n) * n);
+    const float scale = 1.0f / std::log(kMapDisplayMax);
+    for (int y = 0; y < n; ++y) {
+        const float* row = map.pixels().data() + static_cast<size_t>(y) * n;
+        Color* out = pixels->data() + static_cast<size_t>(n - 1 - y) * n;
+        for (int x = 0; x < n; ++x) {
+            const float u = std::clamp(std::log(std::max(row[x], 1.0f)) * scale, 0.0f, 1.0f);
+            const Color cold = {10, 16, 44, 255};
+            const Color warm = {232, 110, 60, 255};
+            const Color hot = {255, 244, 210, 255};
+            out[x] = u < 0.55f ? ColorLerp(cold, warm, u / 0.55f) : ColorLerp(warm, hot, (u - 0.55f) / 0.45f);
+        }
+    }
+}
+
+Vector2 MapToPanel(float x, float y, float halfWidth) {
+    return {kMapPanel.x + (x + halfWidth) / (2.0f * halfWidth) * kMapPanel.width,
+            kMapPanel.y + (halfWidth - y) / (2.0f * halfWidth) * kMapPanel.height};
+}
+
+astro_lensing::SourceTrack TrackFor(float u0, float alpha, float crossingTime) {
+    astro_lensing::SourceTrack track;
+    track.u0 = u0;
+    track.alpha = alpha;
+    track.tE = crossingTime;
+    return track;
+}
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 8, 0.0f);
+    if (bench.enabled) {
+        // One freshly shot map per step, sweeping the mass ratio so nothing is cached.
+        astro_lensing::MagnificationMap map;
+        int step = 0;
+        double checksum = 0.0;
+        return astro_bench::RunBench(
+            "gravitational_microlensing_viz", bench,
+            [&](float) {
+                map.Build({0.05f + 0.9f * static_cast<float>(step % 8) / 7.0f, 1.05f}, astro_lensing::MapOptions{},
+                          astro_parallel::SharedPool());
+                checksum += map.maximum();
+                ++step;
+            },
+            [&]() { return checksum; });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Gravitational Microlensing Event 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -57,6 +119,20 @@ int main() {
     float t = -7.0f;
     std::deque<float> magHistory(360, 1.0f);
 
+    bool binaryMode = false;
+    float massRatio = 0.12f;
+    float separation = 1.05f;
+    float trackAngle = 0.45f;
+    astro_lensing::MagnificationMapCache mapCache;
+    std::shared_ptr<const astro_lensing::MagnificationMap> map;
+    std::vector<Color> mapPixels;
+    Image mapImage = GenImageColor(astro_lensing::MapOptions{}.resolution, astro_lensing::MapOptions{}.resolution, BLANK);
+    Texture2D mapTexture = LoadTextureFromImage(mapImage);
+    UnloadImage(mapImage);
+    std::array<float, kCurveSamples> curveTimes{};
+    for (int i = 0; i < kCurveSamples; ++i) curveTimes[static_cast<size_t>(i)] = -7.0f + 14.0f * i / (kCurveSamples - 1);
+    std::vector<float> curves(static_cast<size_t>(kCurveFan) * kCurveSamples, 1.0f);
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
@@ -67,17 +143,51 @@ int main() {
             t = -7.0f;
             paused = false;
             magHistory.assign(360, 1.0f);
+            massRatio = 0.12f;
+            separation = 1.05f;
+            trackAngle = 0.45f;
+        }
+        if (IsKeyPressed(KEY_B)) {
+            binaryMode = !binaryMode;
+            if (!binaryMode) impact = std::max(0.03f, std::fabs(impact));
         }
+        if (IsKeyDown(KEY_Q)) massRatio = std::min(1.0f, massRatio * (1.0f + 1.2f * GetFrameTime()));
+        if (IsKeyDown(KEY_A)) massRatio = std::max(1.0e-3f, massRatio / (1.0f + 1.2f * GetFrameTime()));
+        if (IsKeyDown(KEY_W)) separation = std::min(3.0f, separation + 0.5f * GetFrameTime());
+        if (IsKeyDown(KEY_S)) separation = std::max(0.3f, separation - 0.5f * GetFrameTime());
+        if (IsKeyDown(KEY_PERIOD)) trackAngle += 0.8f * GetFrameTime();
+        if (IsKeyDown(KEY_COMMA)) trackAngle -= 0.8f * GetFrameTime();
         if (IsKeyDown(KEY_UP)) lensMass = std::min(5.0f, lensMass + 1.0f * GetFrameTime());
         if (IsKeyDown(KEY_DOWN)) lensMass = std::max(0.2f, lensMass - 1.0f * GetFrameTime());
         if (IsKeyDown(KEY_RIGHT_BRACKET)) impact = std::min(1.8f, impact + 0.7f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT_BRACKET)) impact = std::max(0.03f, impact - 0.7f * GetFrameTime());
+        if (IsKeyDown(KEY_LEFT_BRACKET)) impact = std::max(binaryMode ? -1.8f : 0.03f, impact - 0.7f * GetFrameTime());
         if (IsKeyDown(KEY_RIGHT)) crossingTime = std::min(15.0f, crossingTime + 2.0f * GetFrameTime());
         if (IsKeyDown(KEY_LEFT)) crossingTime = std::max(1.2f, crossingTime - 2.0f * GetFrameTime());
         if (IsKeyDown(KEY_EQUAL)) driftSpeed = std::min(4.0f, driftSpeed + 1.0f * GetFrameTime());
         if (IsKeyDown(KEY_MINUS)) driftSpeed = std::max(0.2f, driftSpeed - 1.0f * GetFrameTime());
 
-        UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
+        const Vector2 mouse = GetMousePosition();
+        const bool overMap = binaryMode && CheckCollisionPointRec(mouse, kMapPanel);
+        if (!overMap) UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
+
+        if (binaryMode) {
+            if (std::shared_ptr<const astro_lensing::MagnificationMap> fresh = mapCache.Get(massRatio, separation)) {
+                if (fresh != map) {
+                    map = std::move(fresh);
+                    PaintMagnificationMap(*map, &mapPixels);
+                    UpdateTexture(mapTexture, mapPixels.data());
+                }
+            }
+        }
+        // Clicking the map re-aims the track through that source position.
+        float hoverMag = 0.0f;
+        if (overMap && map) {
+            const float hw = map->halfWidth();
+            const float mx = -hw + 2.0f * hw * (mouse.x - kMapPanel.x) / kMapPanel.width;
+            const float my = hw - 2.0f * hw * (mouse.y - kMapPanel.y) / kMapPanel.height;
+            hoverMag = map->At(mx, my);
+            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) impact = std::clamp(-mx * std::sin(trackAngle) + my * std::cos(trackAngle), -1.8f, 1.8f);
+        }
 
         float thetaE = std::sqrt(lensMass);
         if (!paused) {
@@ -89,6 +199,21 @@ int main() {
         float zSky = thetaE * impact;
         float u = std::sqrt((ySky * ySky + zSky * zSky) / (thetaE * thetaE));
         float mag = Magnification(u);
+        if (binaryMode) {
+            // Map x runs along the scene's y axis, map y along z.
+            const float tau = t / crossingTime;
+            const float sx = tau * std::cos(trackAngle) - impact * std::sin(trackAngle);
+            const float sy = tau * std::sin(trackAngle) + impact * std::cos(trackAngle);
+            ySky = thetaE * sx;
+            zSky = thetaE * sy;
+            u = std::sqrt(sx * sx + sy * sy);
+            mag = map ? map->At(sx, sy) : Magnification(u);
+            std::array<astro_lensing::SourceTrack, kCurveFan> fan;
+            for (int k = 0; k < kCurveFan; ++k) {
+                fan[static_cast<size_t>(k)] = TrackFor(impact + kFanSpacing * (k - kCurveFan / 2), trackAngle, crossingTime);
+            }
+            if (map) map->LightCurves(fan.data(), kCurveFan, curveTimes.data(), kCurveSamples, curves.data());
+        }
         mag = std::min(mag, 30.0f);
         magHistory.push_back(mag);
         if (magHistory.size() > 360) magHistory.pop_front();
@@ -114,7 +239,14 @@ int main() {
 
         // Observer-lens-source axis.
         DrawLine3D({-9.0f, 0.0f, 0.0f}, {9.0f, 0.0f, 0.0f}, Fade(LIGHTGRAY, 0.35f));
-        DrawSphere(lens, 0.35f, Color{255, 214, 120, 255});
+        if (binaryMode) {
+            float x1, x2;
+            astro_lensing::LensPositions({massRatio, separation}, &x1, &x2);
+            DrawSphere({0.0f, thetaE * x1, 0.0f}, 0.35f / std::sqrt(1.0f + massRatio), Color{255, 214, 120, 255});
+            DrawSphere({0.0f, thetaE * x2, 0.0f}, 0.35f * std::sqrt(massRatio / (1.0f + massRatio)) + 0.05f, Color{255, 170, 110, 255});
+        } else {
+            DrawSphere(lens, 0.35f, Color{255, 214, 120, 255});
+        }
         DrawSphere(source, 0.20f + 0.06f * std::min(mag, 8.0f), Color{170, 220, 255, 255});
         DrawSphere(observer, 0.28f, Color{220, 235, 255, 255});
 
@@ -126,19 +258,40 @@ int main() {
             DrawLine3D(p0, p1, Fade(Color{240, 220, 150, 255}, 0.45f));
         }
 
-        DrawSphere(image1, 0.10f, Color{255, 235, 190, 255});
-        DrawSphere(image2, 0.08f, Color{255, 200, 150, 255});
+        if (!binaryMode) {
+            DrawSphere(image1, 0.10f, Color{255, 235, 190, 255});
+            DrawSphere(image2, 0.08f, Color{255, 200, 150, 255});
 
-        DrawLine3D(source, image1, Fade(SKYBLUE, 0.7f));
-        DrawLine3D(source, image2, Fade(SKYBLUE, 0.45f));
-        DrawLine3D(image1, observer, Fade(Color{255, 220, 130, 255}, 0.72f));
-        DrawLine3D(image2, observer, Fade(Color{255, 180, 120, 255}, 0.48f));
+            DrawLine3D(source, image1, Fade(SKYBLUE, 0.7f));
+            DrawLine3D(source, image2, Fade(SKYBLUE, 0.45f));
+            DrawLine3D(image1, observer, Fade(Color{255, 220, 130, 255}, 0.72f));
+            DrawLine3D(image2, observer, Fade(Color{255, 180, 120, 255}, 0.48f));
+        } else {
+            DrawLine3D(source, lens, Fade(SKYBLUE, 0.5f));
+            DrawLine3D(lens, observer, Fade(Color{255, 220, 130, 255}, 0.5f));
+        }
 
         EndMode3D();
 
         DrawRectangle(870, 516, 390, 238, Fade(Color{18, 26, 44, 255}, 0.92f));
         DrawText("Magnification Light Curve", 892, 536, 22, Color{220, 230, 244, 255});
-        for (int i = 1; i < static_cast<int>(magHistory.size()); ++i) {
+        if (binaryMode && map) {
+            // Whole-track curves from the batch, log scale: the current track bright, its
+            // neighbours faint, with a cursor at the current time.
+            const float logTop = std::log(kMapDisplayMax);
+            auto curveY = [&](float m) { return 732.0f - std::log(std::clamp(m, 1.0f, kMapDisplayMax)) / logTop * 168.0f; };
+            for (int k = 0; k < kCurveFan; ++k) {
+                const float* curve = curves.data() + static_cast<size_t>(k) * kCurveSamples;
+                const bool current = k == kCurveFan / 2;
+                const Color c = current ? Color{128, 240, 188, 255} : Fade(Color{128, 200, 240, 255}, 0.25f);
+                for (int i = 1; i < kCurveSamples; ++i) {
+                    DrawLineV({900.0f + i - 1, curveY(curve[i - 1])}, {900.0f + i, curveY(curve[i])}, c);
+                }
+            }
+            const float cursor = 900.0f + (t + 7.0f) / 14.0f * (kCurveSamples - 1);
+            DrawLineV({cursor, 560.0f}, {cursor, 732.0f}, Fade(WHITE, 0.35f));
+        }
+        for (int i = 1; i < static_cast<int>(magHistory.size()) && !binaryMode; ++i) {
             float m0 = std::min(8.0f, magHistory[i - 1]);
             float m1 = std::min(8.0f, magHistory[i]);
             int x0 = 900 + i - 1;
@@ -149,7 +302,7 @@ int main() {
         }
 
         DrawText("Gravitational Microlensing Event", 20, 18, 30, Color{232, 238, 248, 255});
-        DrawText("Mouse orbit | wheel zoom | Up/Down mass | [ ] impact | Left/Right crossing | +/- drift | P pause | R reset",
+        DrawText("Mouse orbit | wheel zoom | Up/Down mass | [ ] impact | Left/Right crossing | +/- drift | B binary lens | P pause | R reset",
                  20, 54, 18, Color{164, 183, 210, 255});
 
         char status[230];
@@ -157,10 +310,46 @@ int main() {
                       lensMass, impact, crossingTime, mag, paused ? " [PAUSED]" : "");
         DrawText(status, 20, 84, 20, Color{126, 224, 255, 255});
         DrawFPS(20, 112);
+        if (binaryMode) {
+            const astro_lensing::BinaryLens shown = astro_lensing::MagnificationMapCache::Quantize(massRatio, separation);
+            DrawText(TextFormat("Binary lens: q=%.3f  s=%.2f  track angle=%.0f deg  |  Q/A q | W/S s | , . angle | click map: aim",
+                                shown.q, shown.s, trackAngle * RAD2DEG),
+                     20, 140, 18, Color{255, 214, 150, 255});
+
+            DrawRectangle(static_cast<int>(kMapPanel.x) - 10, static_cast<int>(kMapPanel.y) - 34, static_cast<int>(kMapPanel.width) + 20,
+                          static_cast<int>(kMapPanel.height) + 64, Fade(Color{18, 26, 44, 255}, 0.92f));
+            DrawText("Magnification map (source plane)", static_cast<int>(kMapPanel.x), static_cast<int>(kMapPanel.y) - 26, 18,
+                     Color{220, 230, 244, 255});
+            if (map) {
+                const float hw = map->halfWidth();
+                DrawTexturePro(mapTexture, {0.0f, 0.0f, static_cast<float>(map->resolution()), static_cast<float>(map->resolution())}, kMapPanel,
+                               {0.0f, 0.0f}, 0.0f, WHITE);
+                float x1, x2;
+                astro_lensing::LensPositions(map->lens(), &x1, &x2);
+                DrawCircleLinesV(MapToPanel(x1, 0.0f, hw), 4.0f, Color{255, 214, 120, 255});
+                DrawCircleLinesV(MapToPanel(x2, 0.0f, hw), 3.0f, Color{255, 170, 110, 255});
+                const float c = std::cos(trackAngle), sn = std::sin(trackAngle);
+                const float reach = 7.0f / crossingTime;
+                BeginScissorMode(static_cast<int>(kMapPanel.x), static_cast<int>(kMapPanel.y), static_cast<int>(kMapPanel.width),
+                                 static_cast<int>(kMapPanel.height));
+                DrawLineEx(MapToPanel(-reach * c - impact * sn, -reach * sn + impact * c, hw),
+                           MapToPanel(reach * c - impact * sn, reach * sn + impact * c, hw), 1.5f, Fade(SKYBLUE, 0.8f));
+                DrawCircleV(MapToPanel(ySky / thetaE, zSky / thetaE, hw), 4.0f, Color{170, 220, 255, 255});
+                EndScissorMode();
+            }
+            const char* footer = mapCache.busy() ? "shooting rays..." : (overMap ? TextFormat("A = %.2f at cursor", hoverMag) : "");
+            DrawText(footer, static_cast<int>(kMapPanel.x), static_cast<int>(kMapPanel.y + kMapPanel.height) + 8, 16,
+                     Color{150, 170, 198, 255});
+        }
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    mapCache.Stop();
+    UnloadTexture(mapTexture);
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
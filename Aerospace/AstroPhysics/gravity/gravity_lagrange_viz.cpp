@@ -1,5 +1,9 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/cr3bp_orbits.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/spacetime_sheet.h"
 
 #include <algorithm>
 #include <array>
@@ -15,6 +19,14 @@ constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kSoftening = 0.05f;
 constexpr int kTrailMax = 1000;
+constexpr int kSheetGrid = 58;
+constexpr float kSheetExtent = 3.2f;
+constexpr float kSheetDepth = 4.4f;
+constexpr astro_sheet::LineStyle kSheetRows = {{45, 95, 160, 70}, {60, 90, 85, 100}};
+constexpr astro_sheet::LineStyle kSheetColumns = {{40, 85, 145, 56}, {55, 82, 90, 86}};
+constexpr float kPlaneHeight = 0.08f;
+constexpr float kSliderRate = 0.35f;  // family fraction per second with the arrow keys
+constexpr std::array<const char*, 4> kFamilyNames = {"L1 Lyapunov", "L1 halo", "L2 Lyapunov", "L2 halo"};
 
 struct LagrangePoints {
     Vector3 l1;
@@ -57,48 +69,16 @@ float PotentialHeight(float x, float z, float mu, float sheetScale) {
     float r1 = std::sqrt((x - x1) * (x - x1) + z * z + kSoftening * kSoftening);
     float r2 = std::sqrt((x - x2) * (x - x2) + z * z + kSoftening * kSoftening);
     float pseudo = (1.0f - mu) / r1 + mu / r2 + 0.17f * (x * x + z * z);
-    return std::max(-4.4f, -sheetScale * pseudo);
+    return std::max(-kSheetDepth, -sheetScale * pseudo);
 }
 
-void DrawPotentialSheet(float mu, float sheetScale) {
-    constexpr float kExtent = 3.2f;
-    constexpr int kGrid = 58;
-
-    for (int i = 0; i < kGrid; ++i) {
-        float z = -kExtent + 2.0f * kExtent * static_cast<float>(i) / static_cast<float>(kGrid - 1);
-        for (int j = 0; j < kGrid - 1; ++j) {
-            float x0 = -kExtent + 2.0f * kExtent * static_cast<float>(j) / static_cast<float>(kGrid - 1);
-            float x1 = -kExtent + 2.0f * kExtent * static_cast<float>(j + 1) / static_cast<float>(kGrid - 1);
-            Vector3 p0 = {x0, PotentialHeight(x0, z, mu, sheetScale), z};
-            Vector3 p1 = {x1, PotentialHeight(x1, z, mu, sheetScale), z};
-            float glow = 1.0f - std::min(1.0f, std::fabs(p0.y) / 4.4f);
-            Color c = {
-                static_cast<unsigned char>(45 + 60 * glow),
-                static_cast<unsigned char>(95 + 90 * glow),
-                static_cast<unsigned char>(160 + 85 * glow),
-                static_cast<unsigned char>(70 + 100 * glow),
-            };
-            DrawLine3D(p0, p1, c);
-        }
-    }
-
-    for (int j = 0; j < kGrid; ++j) {
-        float x = -kExtent + 2.0f * kExtent * static_cast<float>(j) / static_cast<float>(kGrid - 1);
-        for (int i = 0; i < kGrid - 1; ++i) {
-            float z0 = -kExtent + 2.0f * kExtent * static_cast<float>(i) / static_cast<float>(kGrid - 1);
-            float z1 = -kExtent + 2.0f * kExtent * static_cast<float>(i + 1) / static_cast<float>(kGrid - 1);
-            Vector3 p0 = {x, PotentialHeight(x, z0, mu, sheetScale), z0};
-            Vector3 p1 = {x, PotentialHeight(x, z1, mu, sheetScale), z1};
-            float glow = 1.0f - std::min(1.0f, std::fabs(p0.y) / 4.4f);
-            Color c = {
-                static_cast<unsigned char>(40 + 55 * glow),
-                static_cast<unsigned char>(85 + 82 * glow),
-                static_cast<unsigned char>(145 + 90 * glow),
-                static_cast<unsigned char>(56 + 86 * glow),
-            };
-            DrawLine3D(p0, p1, c);
-        }
-    }
+// Same field as PotentialHeight(), evaluated once per grid vertex.
+void UpdatePotentialSheet(astro_sheet::SpacetimeSheet* sheet, float mu, float sheetScale) {
+    sheet->Fill(0.0f);
+    sheet->AddWell(-mu, 0.0f, 1.0f - mu, kSoftening);
+    sheet->AddWell(1.0f - mu, 0.0f, mu, kSoftening);
+    sheet->Apply([](float x, float z, float h) { return h - 0.17f * (x * x + z * z); });
+    sheet->ScaleClamp(sheetScale, -kSheetDepth);
 }
 
 void RotatingFrameAcceleration(float x, float z, float vx, float vz, float mu, float* ax, float* az) {
@@ -253,6 +233,78 @@ void DrawTrail(const std::deque<Vector3>& trail, Color color) {
     }
 }
 
+// Synodic (x, y, z) with z out of the plane to the scene, whose orbital plane is x-z.
+Vector3 ScenePoint(const astro_cr3bp::PathPoint& p) { return {p.x, kPlaneHeight + p.z, p.y}; }
+
+Rectangle FamilySliderRect() {
+    const float width = std::min(520.0f, GetScreenWidth() - 40.0f);
+    return {20.0f, GetScreenHeight() - 46.0f, width, 14.0f};
+}
+
+int SelectedMember(const astro_cr3bp::OrbitFamily& family, float slider) {
+    if (family.members.empty()) return -1;
+    return static_cast<int>(std::lround(slider * (family.members.size() - 1)));
+}
+
+// Closed orbit plus a marker `phase` of a period along it (paths are uniform in time).
+void DrawPeriodicOrbit(const std::vector<astro_cr3bp::PathPoint>& path, float phase, Color color) {
+    if (path.size() < 2) return;
+    for (size_t i = 1; i < path.size(); ++i) DrawLine3D(ScenePoint(path[i - 1]), ScenePoint(path[i]), color);
+    const float at = phase * (path.size() - 1);
+    const size_t i = std::min(static_cast<size_t>(at), path.size() - 2);
+    const Vector3 marker = Vector3Lerp(ScenePoint(path[i]), ScenePoint(path[i + 1]), at - i);
+    DrawSphere(marker, 0.04f, Color{255, 240, 160, 255});
+}
+
+// Faint neighbours either side of the selection, so the family's shape reads at a glance.
+void DrawFamilyContext(const astro_cr3bp::OrbitFamily& family, int selected) {
+    const int n = static_cast<int>(family.paths.size());
+    for (int k = -3; k <= 3; ++k) {
+        const int i = selected + 2 * k;
+        if (k == 0 || i < 0 || i >= n) continue;
+        const std::vector<astro_cr3bp::PathPoint>& path = family.paths[static_cast<size_t>(i)];
+        for (size_t j = 1; j < path.size(); ++j) DrawLine3D(ScenePoint(path[j - 1]), ScenePoint(path[j]), Color{120, 170, 230, 60});
+    }
+}
+
+void DrawFamilySlider(float slider, int members, bool busy) {
+    const Rectangle r = FamilySliderRect();
+    DrawRectangleRec(r, Color{30, 44, 70, 220});
+    DrawRectangleLinesEx(r, 1.0f, Color{110, 150, 210, 200});
+    if (members > 0) {
+        const float x = r.x + slider * r.width;
+        DrawRectangleRec({x - 5.0f, r.y - 4.0f, 10.0f, r.height + 8.0f}, Color{255, 220, 140, 255});
+    }
+    const char* label = busy ? "Orbit family (computing...)" : "Orbit family   F: next family | <- -> or drag: orbit | O: probe onto a Lyapunov orbit";
+    DrawText(label, static_cast<int>(r.x), static_cast<int>(r.y) - 22, 18, Color{170, 190, 220, 255});
+}
+
+std::string FamilyHud(const astro_cr3bp::OrbitFamily* family, int familyIndex, int selected) {
+    std::ostringstream os;
+    os << kFamilyNames[static_cast<size_t>(familyIndex)];
+    if (!family || selected < 0) {
+        os << "  (no orbits)";
+        return os.str();
+    }
+    const astro_cr3bp::PeriodicOrbit& orbit = family->members[static_cast<size_t>(selected)];
+    os << "  " << (selected + 1) << "/" << family->members.size() << std::fixed << std::setprecision(3)
+       << (family->kind == astro_cr3bp::FamilyKind::kHalo ? "  Az=" : "  Ax=") << orbit.amplitude
+       << "  T=" << orbit.period
+       << "  C=" << std::setprecision(4) << orbit.jacobi
+       << "  stability=" << std::setprecision(1) << orbit.stability;
+    return os.str();
+}
+
+// Puts the (planar) probe on a Lyapunov orbit's initial state; the orbit is unstable,
+// so it peels off after a few revolutions.
+void LaunchProbeOnOrbit(const astro_cr3bp::PeriodicOrbit& orbit, Probe* probe) {
+    probe->active = true;
+    probe->pos = {static_cast<float>(orbit.state[0]), kPlaneHeight, static_cast<float>(orbit.state[1])};
+    probe->vel = {static_cast<float>(orbit.state[3]), 0.0f, static_cast<float>(orbit.state[4])};
+    probe->trail.clear();
+    probe->trail.push_back(probe->pos);
+}
+
 std::string Hud(float mu, float speed, float sheetScale, bool paused, bool activeProbe) {
     std::ostringstream os;
     os << std::fixed << std::setprecision(2)
@@ -284,6 +336,10 @@ int main() {
     float mu = 0.18f;
     float speed = 1.0f;
     float sheetScale = 1.0f;
+    astro_sheet::SpacetimeSheet sheet;
+    sheet.Configure(kSheetGrid, kSheetExtent);
+    float sheetMu = -1.0f;
+    float sheetWarp = -1.0f;
     bool paused = false;
     bool showSheet = true;
     bool showHelp = true;
@@ -292,6 +348,14 @@ int main() {
     Probe probe{};
     LagrangePoints lp = ComputeLagrangePoints(mu);
 
+    // Orbit families are rebuilt off-thread whenever the mass ratio changes; the
+    // slider only picks among the cached orbits.
+    astro_cr3bp::FamilyCache families;
+    int familyIndex = 1;
+    float familySlider = 0.3f;
+    float orbitPhase = 0.0f;
+    bool draggingSlider = false;
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) ResetProbe(&probe);
@@ -304,6 +368,26 @@ int main() {
         if (IsKeyPressed(KEY_PERIOD)) sheetScale = std::min(1.9f, sheetScale + 0.05f);
         if (IsKeyPressed(KEY_LEFT_BRACKET)) mu = std::max(0.05f, mu - 0.01f);
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) mu = std::min(0.45f, mu + 0.01f);
+        if (IsKeyPressed(KEY_F)) familyIndex = (familyIndex + 1) % static_cast<int>(kFamilyNames.size());
+        if (IsKeyDown(KEY_LEFT)) familySlider = std::max(0.0f, familySlider - kSliderRate * GetFrameTime());
+        if (IsKeyDown(KEY_RIGHT)) familySlider = std::min(1.0f, familySlider + kSliderRate * GetFrameTime());
+
+        const Rectangle sliderRect = FamilySliderRect();
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) &&
+            CheckCollisionPointRec(GetMousePosition(), {sliderRect.x, sliderRect.y - 6.0f, sliderRect.width, sliderRect.height + 12.0f})) {
+            draggingSlider = true;
+        }
+        if (!IsMouseButtonDown(MOUSE_LEFT_BUTTON)) draggingSlider = false;
+        if (draggingSlider) familySlider = std::clamp((GetMousePosition().x - sliderRect.x) / sliderRect.width, 0.0f, 1.0f);
+
+        families.Request({mu, kSoftening});
+        families.Acquire();
+        const astro_cr3bp::FamilySet* familySet = families.families();
+        const astro_cr3bp::OrbitFamily* family =
+            familySet && familySet->system.mu == static_cast<double>(mu) ? &familySet->families[static_cast<size_t>(familyIndex)] : nullptr;
+        const int selected = family ? SelectedMember(*family, familySlider) : -1;
+        const astro_cr3bp::PeriodicOrbit* orbit = selected >= 0 ? &family->members[static_cast<size_t>(selected)] : nullptr;
+        if (IsKeyPressed(KEY_O) && orbit && family->kind == astro_cr3bp::FamilyKind::kLyapunov) LaunchProbeOnOrbit(*orbit, &probe);
 
         lp = ComputeLagrangePoints(mu);
         if (IsKeyPressed(KEY_ONE)) LaunchProbeAt(lp.l1, 0, &probe);
@@ -312,11 +396,12 @@ int main() {
         if (IsKeyPressed(KEY_FOUR)) LaunchProbeAt(lp.l4, 3, &probe);
         if (IsKeyPressed(KEY_FIVE)) LaunchProbeAt(lp.l5, 4, &probe);
 
-        UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
+        if (!draggingSlider) UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
         if (!paused) {
             float dt = GetFrameTime() * speed;
             StepProbe(&probe, dt, mu);
+            if (orbit) orbitPhase = std::fmod(orbitPhase + dt / static_cast<float>(orbit->period), 1.0f);
         }
 
         Vector3 p1 = {-mu, 0.12f, 0.0f};
@@ -331,7 +416,15 @@ int main() {
 
         BeginMode3D(camera);
 
-        if (showSheet) DrawPotentialSheet(mu, sheetScale);
+        if (showSheet) {
+            // The potential only changes with the mass ratio and the warp slider.
+            if (mu != sheetMu || sheetScale != sheetWarp) {
+                UpdatePotentialSheet(&sheet, mu, sheetScale);
+                sheetMu = mu;
+                sheetWarp = sheetScale;
+            }
+            sheet.Draw(kSheetRows, kSheetColumns, kSheetDepth);
+        }
 
         DrawLine3D({p1.x, PotentialHeight(p1.x, p1.z, mu, sheetScale), p1.z}, p1, Color{255, 196, 120, 120});
         DrawLine3D({p2.x, PotentialHeight(p2.x, p2.z, mu, sheetScale), p2.z}, p2, Color{150, 210, 255, 120});
@@ -354,6 +447,11 @@ int main() {
             DrawSphereWires(points[i], 0.075f, 8, 8, Color{220, 240, 255, 130});
         }
 
+        if (orbit) {
+            DrawFamilyContext(*family, selected);
+            DrawPeriodicOrbit(family->paths[static_cast<size_t>(selected)], orbitPhase, Color{255, 196, 120, 230});
+        }
+
         if (showTrails) DrawTrail(probe.trail, Color{140, 230, 255, 255});
         if (probe.active) DrawSphere(probe.pos, 0.045f, Color{255, 95, 130, 255});
 
@@ -376,11 +474,17 @@ int main() {
         std::string hud = Hud(mu, speed, sheetScale, paused, probe.active);
         DrawText(hud.c_str(), 20, 82, 21, Color{126, 224, 255, 255});
         DrawText("L4/L5 are generally stable, L1/L2/L3 are saddle points", 20, 110, 18, Color{192, 206, 226, 255});
-        DrawFPS(20, 138);
+        DrawText(FamilyHud(family, familyIndex, selected).c_str(), 20, 138, 18, Color{255, 214, 160, 255});
+        DrawFamilySlider(familySlider, family ? static_cast<int>(family->members.size()) : 0, families.Busy());
+        DrawFPS(20, 164);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    families.Stop();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,12 +1,26 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+
+#include "../common/frame_arena.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/instanced_particles.h"
+#include "../common/particle_pool.h"
+#include "../common/profiler.h"
+#include "../common/replay_log.h"
+#include "../common/snapshot_export.h"
+#include "../common/spatial_hash.h"
+#include "../common/thread_pool.h"
+#include "../common/trail_buffer.h"
 
 #include <algorithm>
 #include <cmath>
-#include <deque>
+#include <cstdio>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -14,14 +28,21 @@ namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kBaseGridExtent = 8.0f;
-constexpr int kLines = 7;
-constexpr int kSegments = 58;
+constexpr int kLines = 9;
+constexpr int kSegments = 140;
+constexpr int kChunkVertices = 8;
+constexpr float kWarpTolerance = 0.012f;
 constexpr float kFlowRepeats = 4.25f;
 constexpr int kTrailLimit = 520;
 constexpr float kG = 1.45f;
 constexpr float kLightSpeed = 5.4f;
 constexpr float kPulsarMinMass = 6.0f;
 constexpr float kBlackHoleMinMass = 8.0f;
+constexpr int kMaxBodies = 48;
+constexpr int kPairBlock = 64;
+constexpr int kBurstParticles = 34;
+// Every body merging into one inside a burst's lifetime.
+constexpr size_t kMaxExplosionParticles = (kMaxBodies - 1) * kBurstParticles;
 
 struct MassObject {
     Vector3 pos;
@@ -32,7 +53,7 @@ struct MassObject {
     std::string label;
     bool blackHole;
     bool pulsar;
-    std::deque<Vector3> trail;
+    astro_render::TrailBuffer<kTrailLimit> trail;
 };
 
 struct CollisionEvent {
@@ -105,8 +126,17 @@ float EffectiveRadius(const MassObject& body) {
     return body.blackHole ? std::max(body.radius, SchwarzschildRadius(body.mass)) : body.radius;
 }
 
-Vector3 WarpOffset(Vector3 p, const std::vector<MassObject>& masses, const std::vector<CollisionEvent>& collisions, float core, float pulse) {
-    Vector3 offset = {0.0f, 0.0f, 0.0f};
+// Grid displacement split by its dependence on the ripple phase, so a cached point can
+// be re-animated without re-evaluating the bodies:
+// offset(pulse) = clamp(steady + cos(pulse) * waveCos + sin(pulse) * waveSin, 2.75).
+struct WarpTerms {
+    Vector3 steady;
+    Vector3 waveCos;
+    Vector3 waveSin;
+};
+
+WarpTerms WarpOffsetTerms(Vector3 p, const std::vector<MassObject>& masses, const std::vector<CollisionEvent>& collisions, float core) {
+    WarpTerms terms = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
     for (const MassObject& body : masses) {
         Vector3 toMass = Vector3Subtract(body.pos, p);
         float r = Vector3Length(toMass);
@@ -117,8 +147,11 @@ Vector3 WarpOffset(Vector3 p, const std::vector<MassObject>& masses, const std::
         float compactness = std::clamp(rs / std::max(r, rs + 0.08f), 0.0f, body.blackHole ? 0.96f : 0.86f);
         float pull = body.mass / (r * r + core * core) * (1.0f + (body.blackHole ? 5.2f : 3.2f) * compactness);
         pull = std::min(pull, r * 0.76f);
-        float wave = 0.075f * std::sin(4.6f * r - pulse) * std::exp(-0.18f * r);
-        offset = Vector3Add(offset, Vector3Scale(dir, pull + wave));
+        // 0.075 * sin(4.6 r - pulse) * exp(-0.18 r), expanded in the phase.
+        float wave = 0.075f * std::exp(-0.18f * r);
+        terms.steady = Vector3Add(terms.steady, Vector3Scale(dir, pull));
+        terms.waveCos = Vector3Add(terms.waveCos, Vector3Scale(dir, wave * std::sin(4.6f * r)));
+        terms.waveSin = Vector3Add(terms.waveSin, Vector3Scale(dir, -wave * std::cos(4.6f * r)));
     }
 
     for (const CollisionEvent& event : collisions) {
@@ -129,18 +162,18 @@ Vector3 WarpOffset(Vector3 p, const std::vector<MassObject>& masses, const std::
         float shell = event.age * kLightSpeed * 0.85f;
         float profile = std::exp(-3.6f * std::fabs(r - shell));
         float amplitude = 0.34f * event.strength * std::exp(-0.72f * event.age) * profile;
-        offset = Vector3Add(offset, Vector3Scale(dir, amplitude));
+        terms.steady = Vector3Add(terms.steady, Vector3Scale(dir, amplitude));
     }
+    return terms;
+}
 
+Vector3 CombineWarpTerms(const WarpTerms& terms, float cosPulse, float sinPulse) {
+    Vector3 offset = Vector3Add(terms.steady, Vector3Add(Vector3Scale(terms.waveCos, cosPulse), Vector3Scale(terms.waveSin, sinPulse)));
     float len = Vector3Length(offset);
-    if (len > 2.75f) offset = Vector3Scale(Vector3Normalize(offset), 2.75f);
+    if (len > 2.75f) offset = Vector3Scale(offset, 2.75f / len);
     return offset;
 }
 
-Vector3 WarpedPoint(Vector3 p, const std::vector<MassObject>& masses, const std::vector<CollisionEvent>& collisions, float core, float pulse) {
-    return Vector3Add(p, WarpOffset(p, masses, collisions, core, pulse));
-}
-
 float LocalWarpStrength(Vector3 p, const std::vector<MassObject>& masses, float core) {
     float strength = 0.0f;
     for (const MassObject& body : masses) {
@@ -161,47 +194,6 @@ Color WarpColor(Vector3 p, const std::vector<MassObject>& masses, float core) {
     };
 }
 
-void DrawWarpedLine(Vector3 a, Vector3 b, const std::vector<MassObject>& masses, const std::vector<CollisionEvent>& collisions, float core, float pulse) {
-    Vector3 lineDir = Vector3Normalize(Vector3Subtract(b, a));
-    Vector3 prevBase = a;
-    Vector3 prev = WarpedPoint(a, masses, collisions, core, pulse);
-    for (int i = 1; i <= kSegments; ++i) {
-        float t = static_cast<float>(i) / static_cast<float>(kSegments);
-        Vector3 base = Vector3Lerp(a, b, t);
-        Vector3 current = WarpedPoint(base, masses, collisions, core, pulse);
-        DrawLine3D(prev, current, WarpColor(current, masses, core));
-
-        Vector3 midBase = Vector3Lerp(prevBase, base, 0.5f);
-        for (const MassObject& body : masses) {
-            Vector3 toBody = Vector3Subtract(body.pos, midBase);
-            float distance = Vector3Length(toBody);
-            float influenceRadius = std::clamp(1.20f + std::sqrt(body.mass) * 0.78f + (body.blackHole ? 1.15f : 0.0f), 2.15f, 5.4f);
-            if (distance < 0.001f || distance > influenceRadius) continue;
-
-            float alignment = std::fabs(Vector3DotProduct(lineDir, Vector3Scale(toBody, 1.0f / distance)));
-            if (alignment < 0.36f) continue;
-
-            float normalizedDistance = distance / influenceRadius;
-            float localStrength = (1.0f - normalizedDistance) * alignment;
-            float direction = Vector3DotProduct(lineDir, toBody) >= 0.0f ? 1.0f : -1.0f;
-            float localCoordinate = Vector3DotProduct(midBase, lineDir) * direction;
-            float speed = 0.22f + 0.045f * body.mass;
-            float phase = std::fmod(localCoordinate * kFlowRepeats - pulse * speed, 1.0f);
-            if (phase < 0.0f) phase += 1.0f;
-
-            if (phase < 0.10f) {
-                float head = 1.0f - phase / 0.10f;
-                unsigned char alpha = static_cast<unsigned char>(std::clamp(150.0f * localStrength * head, 0.0f, 145.0f));
-                Color flowColor = body.blackHole ? Color{255, 205, 90, alpha} : Color{145, 230, 255, alpha};
-                DrawLine3D(prev, current, flowColor);
-            }
-        }
-
-        prevBase = base;
-        prev = current;
-    }
-}
-
 float TargetGridExtent(const std::vector<MassObject>& masses) {
     float required = kBaseGridExtent;
     for (const MassObject& body : masses) {
@@ -212,28 +204,220 @@ float TargetGridExtent(const std::vector<MassObject>& masses) {
     return std::max(required, kBaseGridExtent);
 }
 
-void DrawWarpedCubeGrid(const std::vector<MassObject>& masses, const std::vector<CollisionEvent>& collisions, float core, float pulse, float extent) {
+// The warp grid is kept as a persistent cache of per-vertex WarpTerms split into small
+// chunks of consecutive vertices. Every frame each chunk accumulates an upper bound on
+// how far its warped points may have drifted since they were last evaluated (from body
+// motion, mass changes, the softening core and the grid extent); only chunks past
+// kWarpTolerance, or crossed by a collision shell, are re-evaluated, in parallel. The
+// ripple phase is applied to every cached vertex each frame, which is cheap.
+struct WarpChunk {
+    int first = 0;
+    int count = 0;
+    Vector3 unitCenter{};  // bounds of the unwarped points at extent 1
+    float unitRadius = 0.0f;
+    float error = 0.0f;
+};
+
+struct WarpBodyState {
+    Vector3 pos;
+    float mass;
+    bool blackHole;
+};
+
+struct WarpGridCache {
+    std::vector<Vector3> unitBase;
+    std::vector<Vector3> lineDir;
+    std::vector<WarpTerms> terms;
+    std::vector<Vector3> warped;
+    std::vector<Color> colors;
+    std::vector<WarpChunk> chunks;
+    std::vector<int> dirty;
+    std::vector<WarpBodyState> bodies;
+    float core = 0.0f;
+    float extent = 0.0f;
+    bool valid = false;
+    int updatedChunks = 0;
+};
+
+constexpr int kLineVertices = kSegments + 1;
+
+void BuildWarpGridCache(WarpGridCache* cache) {
+    cache->unitBase.clear();
+    cache->lineDir.clear();
+    auto addLine = [&](Vector3 a, Vector3 b) {
+        cache->lineDir.push_back(Vector3Normalize(Vector3Subtract(b, a)));
+        for (int i = 0; i <= kSegments; ++i) {
+            cache->unitBase.push_back(Vector3Lerp(a, b, static_cast<float>(i) / static_cast<float>(kSegments)));
+        }
+    };
     for (int iy = 0; iy < kLines; ++iy) {
-        float y = Coordinate(iy, extent);
-        for (int iz = 0; iz < kLines; ++iz) {
-            float z = Coordinate(iz, extent);
-            DrawWarpedLine({-extent, y, z}, {extent, y, z}, masses, collisions, core, pulse);
+        for (int iz = 0; iz < kLines; ++iz) addLine({-1.0f, Coordinate(iy, 1.0f), Coordinate(iz, 1.0f)}, {1.0f, Coordinate(iy, 1.0f), Coordinate(iz, 1.0f)});
+    }
+    for (int ix = 0; ix < kLines; ++ix) {
+        for (int iz = 0; iz < kLines; ++iz) addLine({Coordinate(ix, 1.0f), -1.0f, Coordinate(iz, 1.0f)}, {Coordinate(ix, 1.0f), 1.0f, Coordinate(iz, 1.0f)});
+    }
+    for (int ix = 0; ix < kLines; ++ix) {
+        for (int iy = 0; iy < kLines; ++iy) addLine({Coordinate(ix, 1.0f), Coordinate(iy, 1.0f), -1.0f}, {Coordinate(ix, 1.0f), Coordinate(iy, 1.0f), 1.0f});
+    }
+
+    cache->chunks.clear();
+    const int lineCount = static_cast<int>(cache->lineDir.size());
+    for (int line = 0; line < lineCount; ++line) {
+        for (int i = 0; i < kLineVertices; i += kChunkVertices) {
+            WarpChunk chunk;
+            chunk.first = line * kLineVertices + i;
+            chunk.count = std::min(kChunkVertices, kLineVertices - i);
+            const Vector3 a = cache->unitBase[chunk.first];
+            const Vector3 b = cache->unitBase[chunk.first + chunk.count - 1];
+            chunk.unitCenter = Vector3Lerp(a, b, 0.5f);
+            chunk.unitRadius = 0.5f * Vector3Distance(a, b);
+            cache->chunks.push_back(chunk);
         }
     }
+    cache->terms.assign(cache->unitBase.size(), WarpTerms{});
+    cache->warped.assign(cache->unitBase.size(), Vector3Zero());
+    cache->colors.assign(cache->unitBase.size(), BLANK);
+    cache->valid = false;
+}
 
-    for (int ix = 0; ix < kLines; ++ix) {
-        float x = Coordinate(ix, extent);
-        for (int iz = 0; iz < kLines; ++iz) {
-            float z = Coordinate(iz, extent);
-            DrawWarpedLine({x, -extent, z}, {x, extent, z}, masses, collisions, core, pulse);
+// Conservative drift bound for one chunk since the previous frame.
+float WarpChunkDrift(const WarpChunk& chunk, const WarpGridCache& cache, const std::vector<MassObject>& masses,
+                     float core, float extent) {
+    const Vector3 center = Vector3Scale(chunk.unitCenter, extent);
+    const float radius = chunk.unitRadius * extent;
+    const float dCore = std::fabs(core - cache.core);
+    const float dExtent = std::fabs(extent - cache.extent);
+
+    float drift = 0.0f;
+    float gradient = 0.0f;
+    for (size_t k = 0; k < masses.size(); ++k) {
+        const MassObject& body = masses[k];
+        const WarpBodyState& before = cache.bodies[k];
+        const float d = std::max(0.0f, std::min(Vector3Distance(body.pos, center), Vector3Distance(before.pos, center)) - radius);
+        const float heavier = std::max(body.mass, before.mass);
+        const float rs = SchwarzschildRadius(heavier);
+        const float compactness = std::clamp(rs / std::max(d, rs + 0.08f), 0.0f, body.blackHole ? 0.96f : 0.86f);
+        const float boost = 1.0f + (body.blackHole ? 5.2f : 3.2f) * compactness;
+        const float mass = heavier * boost;
+        const float den = d * d + core * core;
+        const float wave = 0.075f * std::exp(-0.18f * d);
+        // |d offset / d position| for the pull (direction turn, radial falloff, compactness)
+        // and for the ripple envelope.
+        const float posGradient = std::min(0.76f, mass / (den * std::max(d, 0.05f))) + 2.0f * mass * d / (den * den) +
+                                  heavier * (boost - 1.0f) / (den * std::max(d, rs + 0.08f)) + 4.8f * wave;
+        gradient += posGradient;
+        drift += Vector3Distance(body.pos, before.pos) * posGradient;
+        drift += std::fabs(body.mass - before.mass) * boost / den;
+        drift += dCore * 2.0f * core * mass / (den * den);
+    }
+    drift += dExtent * 1.7321f * (1.0f + gradient);
+    return drift;
+}
+
+bool CollisionShellCrossesChunk(const WarpChunk& chunk, const std::vector<CollisionEvent>& collisions, float extent) {
+    const Vector3 center = Vector3Scale(chunk.unitCenter, extent);
+    const float radius = chunk.unitRadius * extent;
+    for (const CollisionEvent& event : collisions) {
+        const float shell = event.age * kLightSpeed * 0.85f;
+        const float dist = Vector3Distance(center, event.pos);
+        if (dist + radius > shell - 2.5f && dist - radius < shell + 2.5f) return true;
+    }
+    return false;
+}
+
+void UpdateWarpGridCache(WarpGridCache* cache, const std::vector<MassObject>& masses, const std::vector<CollisionEvent>& collisions,
+                         float core, float pulse, float extent) {
+    bool structural = !cache->valid || cache->bodies.size() != masses.size();
+    for (size_t k = 0; !structural && k < masses.size(); ++k) structural = masses[k].blackHole != cache->bodies[k].blackHole;
+
+    cache->dirty.clear();
+    for (int c = 0; c < static_cast<int>(cache->chunks.size()); ++c) {
+        WarpChunk& chunk = cache->chunks[c];
+        if (!structural) {
+            chunk.error += WarpChunkDrift(chunk, *cache, masses, core, extent);
+        }
+        if (structural || chunk.error > kWarpTolerance || CollisionShellCrossesChunk(chunk, collisions, extent)) {
+            cache->dirty.push_back(c);
         }
     }
 
-    for (int ix = 0; ix < kLines; ++ix) {
-        float x = Coordinate(ix, extent);
-        for (int iy = 0; iy < kLines; ++iy) {
-            float y = Coordinate(iy, extent);
-            DrawWarpedLine({x, y, -extent}, {x, y, extent}, masses, collisions, core, pulse);
+    const float cosPulse = std::cos(pulse);
+    const float sinPulse = std::sin(pulse);
+    astro_parallel::SharedPool().ParallelFor(static_cast<int>(cache->dirty.size()), 16, [&](int begin, int end) {
+        for (int d = begin; d < end; ++d) {
+            WarpChunk& chunk = cache->chunks[cache->dirty[d]];
+            for (int v = chunk.first; v < chunk.first + chunk.count; ++v) {
+                const Vector3 base = Vector3Scale(cache->unitBase[v], extent);
+                cache->terms[v] = WarpOffsetTerms(base, masses, collisions, core);
+                cache->colors[v] = WarpColor(Vector3Add(base, CombineWarpTerms(cache->terms[v], cosPulse, sinPulse)), masses, core);
+            }
+            chunk.error = 0.0f;
+        }
+    });
+
+    for (size_t v = 0; v < cache->terms.size(); ++v) {
+        cache->warped[v] = Vector3Add(Vector3Scale(cache->unitBase[v], extent), CombineWarpTerms(cache->terms[v], cosPulse, sinPulse));
+    }
+
+    cache->bodies.resize(masses.size());
+    for (size_t k = 0; k < masses.size(); ++k) cache->bodies[k] = {masses[k].pos, masses[k].mass, masses[k].blackHole};
+    cache->core = core;
+    cache->extent = extent;
+    cache->valid = true;
+    cache->updatedChunks = static_cast<int>(cache->dirty.size());
+}
+
+// Streams the cached grid into a single RL_LINES batch, then overlays the travelling
+// flow highlights on the segments that are close to a body.
+void DrawWarpGridCache(const WarpGridCache& cache, const std::vector<MassObject>& masses, float pulse) {
+    const int lineCount = static_cast<int>(cache.lineDir.size());
+    rlBegin(RL_LINES);
+    for (int line = 0; line < lineCount; ++line) {
+        const int first = line * kLineVertices;
+        for (int i = 1; i <= kSegments; ++i) {
+            const Vector3 a = cache.warped[first + i - 1];
+            const Vector3 b = cache.warped[first + i];
+            const Color c = cache.colors[first + i];
+            rlColor4ub(c.r, c.g, c.b, c.a);
+            rlVertex3f(a.x, a.y, a.z);
+            rlVertex3f(b.x, b.y, b.z);
+        }
+    }
+    rlEnd();
+
+    for (const WarpChunk& chunk : cache.chunks) {
+        const Vector3 chunkCenter = Vector3Scale(chunk.unitCenter, cache.extent);
+        const float chunkRadius = chunk.unitRadius * cache.extent;
+        const int line = chunk.first / kLineVertices;
+        const Vector3 lineDir = cache.lineDir[line];
+        for (const MassObject& body : masses) {
+            float influenceRadius = std::clamp(1.20f + std::sqrt(body.mass) * 0.78f + (body.blackHole ? 1.15f : 0.0f), 2.15f, 5.4f);
+            if (Vector3Distance(body.pos, chunkCenter) - chunkRadius > influenceRadius) continue;
+
+            for (int v = std::max(chunk.first, line * kLineVertices + 1); v < chunk.first + chunk.count; ++v) {
+                Vector3 midBase = Vector3Scale(Vector3Lerp(cache.unitBase[v - 1], cache.unitBase[v], 0.5f), cache.extent);
+                Vector3 toBody = Vector3Subtract(body.pos, midBase);
+                float distance = Vector3Length(toBody);
+                if (distance < 0.001f || distance > influenceRadius) continue;
+
+                float alignment = std::fabs(Vector3DotProduct(lineDir, Vector3Scale(toBody, 1.0f / distance)));
+                if (alignment < 0.36f) continue;
+
+                float normalizedDistance = distance / influenceRadius;
+                float localStrength = (1.0f - normalizedDistance) * alignment;
+                float direction = Vector3DotProduct(lineDir, toBody) >= 0.0f ? 1.0f : -1.0f;
+                float localCoordinate = Vector3DotProduct(midBase, lineDir) * direction;
+                float speed = 0.22f + 0.045f * body.mass;
+                float phase = std::fmod(localCoordinate * kFlowRepeats - pulse * speed, 1.0f);
+                if (phase < 0.0f) phase += 1.0f;
+
+                if (phase < 0.10f) {
+                    float head = 1.0f - phase / 0.10f;
+                    unsigned char alpha = static_cast<unsigned char>(std::clamp(150.0f * localStrength * head, 0.0f, 145.0f));
+                    Color flowColor = body.blackHole ? Color{255, 205, 90, alpha} : Color{145, 230, 255, alpha};
+                    DrawLine3D(cache.warped[v - 1], cache.warped[v], flowColor);
+                }
+            }
         }
     }
 }
@@ -308,64 +492,101 @@ void DrawPulsar(const MassObject& body, bool selected, float time) {
     }
 }
 
-void SpawnExplosionParticles(std::vector<ExplosionParticle>* particles, Vector3 pos, float strength, Color baseColor) {
-    const int count = 34;
-    for (int i = 0; i < count; ++i) {
+void SpawnExplosionParticles(astro_fx::ParticlePool<ExplosionParticle>* particles, Vector3 pos, float strength, Color baseColor) {
+    particles->SpawnBatch(kBurstParticles, [&](ExplosionParticle& particle, int i) {
         float fi = static_cast<float>(i);
         float azimuth = fi * 2.399963f;
-        float z = -1.0f + 2.0f * (fi + 0.5f) / static_cast<float>(count);
+        float z = -1.0f + 2.0f * (fi + 0.5f) / static_cast<float>(kBurstParticles);
         float ring = std::sqrt(std::max(0.0f, 1.0f - z * z));
         Vector3 dir = {ring * std::cos(azimuth), z, ring * std::sin(azimuth)};
         float speed = (1.6f + 0.09f * static_cast<float>(i % 7)) * std::clamp(strength, 0.55f, 2.2f);
         Color c = i % 3 == 0 ? Color{255, 235, 155, 255} : baseColor;
-        particles->push_back({pos, Vector3Scale(dir, speed), 0.0f, 0.78f + 0.025f * static_cast<float>(i % 9), c});
-    }
+        particle = {pos, Vector3Scale(dir, speed), 0.0f, 0.78f + 0.025f * static_cast<float>(i % 9), c};
+    });
 }
 
-void UpdateExplosionParticles(std::vector<ExplosionParticle>* particles, float dt) {
-    for (ExplosionParticle& particle : *particles) {
+void UpdateExplosionParticles(astro_fx::ParticlePool<ExplosionParticle>* particles, float dt) {
+    particles->Update([dt](ExplosionParticle& particle) {
         particle.age += dt;
         particle.vel = Vector3Scale(particle.vel, std::max(0.0f, 1.0f - 1.25f * dt));
         particle.pos = Vector3Add(particle.pos, Vector3Scale(particle.vel, dt));
-    }
-    particles->erase(std::remove_if(particles->begin(), particles->end(), [](const ExplosionParticle& particle) {
-        return particle.age >= particle.life;
-    }), particles->end());
+        return particle.age < particle.life;
+    });
 }
 
-void DrawExplosionParticles(const std::vector<ExplosionParticle>& particles) {
+void DrawExplosionParticles(const astro_fx::ParticlePool<ExplosionParticle>& particles, astro_render::InstancedParticleRenderer* instanced) {
+    if (instanced != nullptr) instanced->Clear();
     for (const ExplosionParticle& particle : particles) {
         float fade = std::clamp(1.0f - particle.age / particle.life, 0.0f, 1.0f);
         Color c = WithAlpha(particle.color, static_cast<unsigned char>(210.0f * fade));
-        DrawSphere(particle.pos, 0.035f + 0.08f * fade, c);
+        if (instanced != nullptr) {
+            instanced->Add(particle.pos, 0.035f + 0.08f * fade, c);
+        } else {
+            DrawSphere(particle.pos, 0.035f + 0.08f * fade, c);
+        }
+    }
+    if (instanced != nullptr) instanced->Draw();
+}
+
+// Acceleration of a due to b. The weak-field correction depends only on |r x v_rel|,
+// which is symmetric in a and b, so one evaluation serves both sides of the pair.
+float PairCorrection(const MassObject& a, const MassObject& b, Vector3 toB, float r2, bool relativisticMode) {
+    float correction = 1.0f;
+    if (relativisticMode) {
+        Vector3 relativeVelocity = Vector3Subtract(a.vel, b.vel);
+        float h = Vector3Length(Vector3CrossProduct(toB, relativeVelocity));
+        correction += 3.0f * h * h / (r2 * kLightSpeed * kLightSpeed);
+        correction = std::min(correction, 1.75f);
     }
+    return correction;
 }
 
-Vector3 BodyAcceleration(int index, const std::vector<MassObject>& masses, bool relativisticMode) {
+// Each i<j pair is evaluated once. Pairs are grouped into fixed blocks of kPairBlock,
+// every block accumulates into its own slice, and the slices are summed in block order,
+// so the result does not depend on the thread count or on scheduling. The result and
+// the scratch come from the frame arena; callers hold an ArenaScope around the step.
+std::pmr::vector<Vector3> BodyAccelerations(const std::vector<MassObject>& masses, bool relativisticMode) {
     constexpr float kSoftening = 0.76f;
-    Vector3 accel = {0.0f, 0.0f, 0.0f};
-    for (int i = 0; i < static_cast<int>(masses.size()); ++i) {
-        if (i == index) continue;
-        const MassObject& body = masses[i];
-        Vector3 toMass = Vector3Subtract(body.pos, masses[index].pos);
-        float r2 = Vector3LengthSqr(toMass) + kSoftening * kSoftening;
-        float invR = 1.0f / std::sqrt(r2);
-        float correction = 1.0f;
-        if (relativisticMode) {
-            Vector3 relativeVelocity = Vector3Subtract(masses[index].vel, body.vel);
-            float h = Vector3Length(Vector3CrossProduct(toMass, relativeVelocity));
-            correction += 3.0f * h * h / (r2 * kLightSpeed * kLightSpeed);
-            correction = std::min(correction, 1.75f);
+    astro_frame::FrameArena& arena = astro_frame::SharedArena();
+    const int n = static_cast<int>(masses.size());
+    std::pmr::vector<Vector3> accel(masses.size(), Vector3Zero(), &arena);
+    if (n < 2) return accel;
+
+    std::pmr::vector<std::pair<int, int>> pairs(&arena);
+    pairs.reserve(static_cast<size_t>(n * (n - 1) / 2));
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) pairs.push_back({i, j});
+    }
+    const int pairCount = static_cast<int>(pairs.size());
+    const int blockCount = (pairCount + kPairBlock - 1) / kPairBlock;
+    std::pmr::vector<Vector3> partial(static_cast<size_t>(blockCount * n), Vector3Zero(), &arena);
+
+    auto evaluateBlock = [&](int block) {
+        Vector3* slice = partial.data() + static_cast<size_t>(block * n);
+        const int end = std::min(pairCount, (block + 1) * kPairBlock);
+        for (int k = block * kPairBlock; k < end; ++k) {
+            const int i = pairs[static_cast<size_t>(k)].first;
+            const int j = pairs[static_cast<size_t>(k)].second;
+            const MassObject& a = masses[i];
+            const MassObject& b = masses[j];
+            Vector3 toB = Vector3Subtract(b.pos, a.pos);
+            float r2 = Vector3LengthSqr(toB) + kSoftening * kSoftening;
+            float invR = 1.0f / std::sqrt(r2);
+            float scale = kG * PairCorrection(a, b, toB, r2, relativisticMode) * invR * invR * invR;
+            slice[i] = Vector3Add(slice[i], Vector3Scale(toB, b.mass * scale));
+            slice[j] = Vector3Subtract(slice[j], Vector3Scale(toB, a.mass * scale));
         }
-        accel = Vector3Add(accel, Vector3Scale(toMass, kG * body.mass * correction * invR * invR * invR));
+    };
+
+    if (blockCount == 1) {
+        evaluateBlock(0);
+    } else {
+        astro_parallel::SharedPool().Run(blockCount, evaluateBlock);
     }
-    return accel;
-}
 
-std::vector<Vector3> BodyAccelerations(const std::vector<MassObject>& masses, bool relativisticMode) {
-    std::vector<Vector3> accel(masses.size());
-    for (int i = 0; i < static_cast<int>(masses.size()); ++i) {
-        accel[i] = BodyAcceleration(i, masses, relativisticMode);
+    for (int block = 0; block < blockCount; ++block) {
+        const Vector3* slice = partial.data() + static_cast<size_t>(block * n);
+        for (int i = 0; i < n; ++i) accel[i] = Vector3Add(accel[i], slice[i]);
     }
     return accel;
 }
@@ -390,15 +611,13 @@ Vector3 CenterOfMassVelocity(const std::vector<MassObject>& masses) {
     return totalMass > 0.0f ? Vector3Scale(weighted, 1.0f / totalMass) : Vector3Zero();
 }
 
-void RecenterSystem(std::vector<MassObject>* masses, std::vector<CollisionEvent>* collisions = nullptr, std::vector<ExplosionParticle>* particles = nullptr) {
+void RecenterSystem(std::vector<MassObject>* masses, std::vector<CollisionEvent>* collisions = nullptr, astro_fx::ParticlePool<ExplosionParticle>* particles = nullptr) {
     Vector3 com = CenterOfMass(*masses);
     Vector3 comVel = CenterOfMassVelocity(*masses);
     for (MassObject& body : *masses) {
         body.pos = Vector3Subtract(body.pos, com);
         body.vel = Vector3Subtract(body.vel, comVel);
-        for (Vector3& point : body.trail) {
-            point = Vector3Subtract(point, com);
-        }
+        body.trail.Translate(Vector3Negate(com));
     }
     if (collisions != nullptr) {
         for (CollisionEvent& event : *collisions) {
@@ -412,32 +631,50 @@ void RecenterSystem(std::vector<MassObject>* masses, std::vector<CollisionEvent>
     }
 }
 
-void HandleCollisions(std::vector<MassObject>* masses, std::vector<CollisionEvent>* collisions, std::vector<ExplosionParticle>* particles, int* selected) {
-    for (int i = 0; i < static_cast<int>(masses->size()); ++i) {
-        for (int j = i + 1; j < static_cast<int>(masses->size()); ++j) {
-            MassObject& a = (*masses)[i];
-            MassObject& b = (*masses)[j];
-            float mergeDistance = (EffectiveRadius(a) + EffectiveRadius(b)) * (a.blackHole || b.blackHole ? 1.05f : 1.18f);
-            if (Vector3Distance(a.pos, b.pos) > mergeDistance) continue;
-
-            float totalMass = a.mass + b.mass;
-            Vector3 pos = Vector3Scale(Vector3Add(Vector3Scale(a.pos, a.mass), Vector3Scale(b.pos, b.mass)), 1.0f / totalMass);
-            Vector3 vel = Vector3Scale(Vector3Add(Vector3Scale(a.vel, a.mass), Vector3Scale(b.vel, b.mass)), 1.0f / totalMass);
-            float impact = Vector3Length(Vector3Subtract(a.vel, b.vel));
-            bool blackHole = a.blackHole || b.blackHole || SchwarzschildRadius(totalMass) > 0.42f;
-            bool pulsar = !blackHole && (a.pulsar || b.pulsar);
-            float radius = blackHole ? std::max(0.36f, SchwarzschildRadius(totalMass) * 0.72f)
-                                     : std::min(0.55f, std::cbrt(a.radius * a.radius * a.radius + b.radius * b.radius * b.radius) * 1.18f);
-            Color mergedColor = blackHole ? Color{20, 20, 24, 255} : (pulsar ? Color{170, 220, 255, 255} : Color{255, 245, 190, 255});
-            a = {pos, vel, totalMass, radius, mergedColor, a.label + "+" + b.label, blackHole, pulsar, {}};
-            masses->erase(masses->begin() + j);
-            float burst = std::clamp(impact * 0.55f + totalMass * 0.08f, 0.5f, 1.8f);
-            collisions->push_back({pos, 0.0f, burst});
-            SpawnExplosionParticles(particles, pos, burst, mergedColor);
-            *selected = std::min(i, static_cast<int>(masses->size()) - 1);
-            return;
-        }
-    }
+// Merges the first touching pair (lowest i, then lowest j), at most one per call.
+void HandleCollisions(std::vector<MassObject>* masses, std::vector<CollisionEvent>* collisions, astro_fx::ParticlePool<ExplosionParticle>* particles, int* selected) {
+    if (masses->size() < 2) return;
+    // Cells as wide as the largest possible merge distance, so touching pairs are
+    // always in adjacent cells. Kept across calls to reuse its storage.
+    static astro_spatial::SpatialHash broadphase;
+    float maxRadius = 0.0f;
+    for (const MassObject& body : *masses) maxRadius = std::max(maxRadius, EffectiveRadius(body));
+    broadphase.Build(masses->size(), 2.0f * maxRadius * 1.18f, [&](size_t i) { return (*masses)[i].pos; });
+
+    int mergeI = -1;
+    int mergeJ = -1;
+    broadphase.ForEachCandidatePair([&](uint32_t ci, uint32_t cj) {
+        const int i = static_cast<int>(ci);
+        const int j = static_cast<int>(cj);
+        if (mergeI >= 0 && (i > mergeI || (i == mergeI && j > mergeJ))) return;
+        const MassObject& a = (*masses)[i];
+        const MassObject& b = (*masses)[j];
+        float mergeDistance = (EffectiveRadius(a) + EffectiveRadius(b)) * (a.blackHole || b.blackHole ? 1.05f : 1.18f);
+        if (Vector3Distance(a.pos, b.pos) > mergeDistance) return;
+        mergeI = i;
+        mergeJ = j;
+    });
+
+    if (mergeI < 0) return;
+    const int i = mergeI;
+    const int j = mergeJ;
+    MassObject& a = (*masses)[i];
+    MassObject& b = (*masses)[j];
+    float totalMass = a.mass + b.mass;
+    Vector3 pos = Vector3Scale(Vector3Add(Vector3Scale(a.pos, a.mass), Vector3Scale(b.pos, b.mass)), 1.0f / totalMass);
+    Vector3 vel = Vector3Scale(Vector3Add(Vector3Scale(a.vel, a.mass), Vector3Scale(b.vel, b.mass)), 1.0f / totalMass);
+    float impact = Vector3Length(Vector3Subtract(a.vel, b.vel));
+    bool blackHole = a.blackHole || b.blackHole || SchwarzschildRadius(totalMass) > 0.42f;
+    bool pulsar = !blackHole && (a.pulsar || b.pulsar);
+    float radius = blackHole ? std::max(0.36f, SchwarzschildRadius(totalMass) * 0.72f)
+                             : std::min(0.55f, std::cbrt(a.radius * a.radius * a.radius + b.radius * b.radius * b.radius) * 1.18f);
+    Color mergedColor = blackHole ? Color{20, 20, 24, 255} : (pulsar ? Color{170, 220, 255, 255} : Color{255, 245, 190, 255});
+    a = {pos, vel, totalMass, radius, mergedColor, a.label + "+" + b.label, blackHole, pulsar, {}};
+    masses->erase(masses->begin() + j);
+    float burst = std::clamp(impact * 0.55f + totalMass * 0.08f, 0.5f, 1.8f);
+    collisions->push_back({pos, 0.0f, burst});
+    SpawnExplosionParticles(particles, pos, burst, mergedColor);
+    *selected = std::min(i, static_cast<int>(masses->size()) - 1);
 }
 
 void UpdateCollisionEvents(std::vector<CollisionEvent>* collisions, float dt) {
@@ -447,24 +684,24 @@ void UpdateCollisionEvents(std::vector<CollisionEvent>* collisions, float dt) {
     }), collisions->end());
 }
 
-void UpdateMassObjects(std::vector<MassObject>* masses, std::vector<CollisionEvent>* collisions, std::vector<ExplosionParticle>* particles, int* selected, float dt, bool relativisticMode, bool radiationDecay) {
+void UpdateMassObjects(std::vector<MassObject>* masses, std::vector<CollisionEvent>* collisions, astro_fx::ParticlePool<ExplosionParticle>* particles, int* selected, float dt, bool relativisticMode, bool radiationDecay) {
     if (masses->size() < 2) {
         if (!masses->empty()) {
             MassObject& body = (*masses)[0];
-            body.trail.push_back(body.pos);
-            if (body.trail.size() > kTrailLimit) body.trail.pop_front();
+            body.trail.Push(body.pos);
         }
         return;
     }
 
-    std::vector<Vector3> accel = BodyAccelerations(*masses, relativisticMode);
+    const astro_frame::ArenaScope scratch;
+    const std::pmr::vector<Vector3> accel = BodyAccelerations(*masses, relativisticMode);
     for (int i = 0; i < static_cast<int>(masses->size()); ++i) {
         MassObject& body = (*masses)[i];
         body.vel = Vector3Add(body.vel, Vector3Scale(accel[i], 0.5f * dt));
         body.pos = Vector3Add(body.pos, Vector3Scale(body.vel, dt));
     }
 
-    std::vector<Vector3> nextAccel = BodyAccelerations(*masses, relativisticMode);
+    const std::pmr::vector<Vector3> nextAccel = BodyAccelerations(*masses, relativisticMode);
     for (int i = 0; i < static_cast<int>(masses->size()); ++i) {
         MassObject& body = (*masses)[i];
         body.vel = Vector3Add(body.vel, Vector3Scale(nextAccel[i], 0.5f * dt));
@@ -472,13 +709,31 @@ void UpdateMassObjects(std::vector<MassObject>* masses, std::vector<CollisionEve
             body.vel = Vector3Scale(body.vel, 1.0f - 0.0065f * dt);
         }
 
-        body.trail.push_back(body.pos);
-        if (body.trail.size() > kTrailLimit) body.trail.pop_front();
+        body.trail.Push(body.pos);
     }
     RecenterSystem(masses, collisions, particles);
     HandleCollisions(masses, collisions, particles, selected);
 }
 
+// Sub-steps one rendered frame of body motion; bodies run 5x faster than display time.
+// Returns the simulated time advanced.
+float AdvanceBodies(std::vector<MassObject>* masses, std::vector<CollisionEvent>* collisions, astro_fx::ParticlePool<ExplosionParticle>* particles, int* selected, float dt, float simSpeed, bool relativisticMode, bool radiationDecay) {
+    float totalSimDt = std::min(0.014f, dt) * 5.0f * simSpeed;
+    int steps = std::clamp(static_cast<int>(std::ceil(totalSimDt / 0.014f)), 1, 96);
+    float simDt = totalSimDt / static_cast<float>(steps);
+    for (int i = 0; i < steps; ++i) UpdateMassObjects(masses, collisions, particles, selected, simDt, relativisticMode, radiationDecay);
+    return totalSimDt;
+}
+
+// Bodies in their current order. The id is the index, so a merger renumbers the
+// bodies after the pair.
+void ExportWellSnapshot(astro_snapshot::SnapshotWriter* snapshots, uint64_t step, double time, const std::vector<MassObject>& masses) {
+    if (snapshots == nullptr || !snapshots->Due(step)) return;
+    snapshots->Capture(step, time, masses.size(), [&](astro_snapshot::SnapshotFrame& frame) {
+        for (size_t i = 0; i < masses.size(); ++i) frame.Set(i, static_cast<uint32_t>(i), masses[i].mass, masses[i].pos, masses[i].vel);
+    });
+}
+
 std::vector<MassObject> MakeDefaultMasses() {
     return {
         {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 3.25f, 0.30f, WHITE, "body 1", false, false, {}},
@@ -534,7 +789,7 @@ std::vector<MassObject> MakeClusterMasses() {
 }
 
 void AddOrbitingMass(std::vector<MassObject>* masses, int selected) {
-    if (masses->size() >= 6) return;
+    if (static_cast<int>(masses->size()) >= kMaxBodies) return;
 
     const std::vector<Color> colors = BodyPalette();
     int n = static_cast<int>(masses->size());
@@ -588,9 +843,229 @@ std::string Hud(const std::vector<MassObject>& masses, int selected, bool relati
     return os.str();
 }
 
+// Everything the interactive loop changes. UpdateWellScene() is the whole per-frame
+// update, so a replay log can drive it without a window.
+struct WellScene {
+    std::vector<MassObject> masses = MakeDefaultMasses();
+    std::vector<CollisionEvent> collisions;
+    astro_fx::ParticlePool<ExplosionParticle> explosionParticles{kMaxExplosionParticles};
+    WarpGridCache warpGrid;
+    int selected = 0;
+    float core = 1.05f;
+    float time = 0.0f;
+    float gridExtent = kBaseGridExtent;
+    float simSpeed = 1.0f;
+    bool paused = false;
+    bool animateGrid = true;
+    bool bodyMotionOn = true;
+    bool relativisticMode = true;
+    bool radiationDecay = false;
+    bool instancedParticles = true;
+    uint64_t bodySteps = 0;  // frames of body motion since launch, the snapshot cadence
+    double bodyTime = 0.0;
+
+    WellScene() { BuildWarpGridCache(&warpGrid); }
+};
+
+void UpdateWellScene(WellScene* scene, const astro_replay::InputFrame& input, astro_snapshot::SnapshotWriter* snapshots = nullptr) {
+    ASTRO_PROFILE_SCOPE("physics");
+    if (input.Pressed(KEY_P)) scene->paused = !scene->paused;
+    if (input.Pressed(KEY_G)) scene->relativisticMode = !scene->relativisticMode;
+    if (input.Pressed(KEY_C)) scene->radiationDecay = !scene->radiationDecay;
+    if (input.Pressed(KEY_B)) {
+        MassObject& body = scene->masses[scene->selected];
+        body.blackHole = !body.blackHole;
+        if (body.blackHole) {
+            body.pulsar = false;
+            std::size_t pulsarSuffix = body.label.find(" PSR");
+            if (pulsarSuffix != std::string::npos) body.label.erase(pulsarSuffix);
+            body.mass = std::max(body.mass, kBlackHoleMinMass);
+            body.radius = std::max(0.36f, SchwarzschildRadius(body.mass) * 0.72f);
+            body.color = Color{20, 20, 24, 255};
+            if (body.label.find(" BH") == std::string::npos) body.label += " BH";
+        } else {
+            body.radius = 0.30f;
+            body.color = BodyPalette()[scene->selected % static_cast<int>(BodyPalette().size())];
+            std::size_t suffix = body.label.find(" BH");
+            if (suffix != std::string::npos) body.label.erase(suffix);
+        }
+    }
+    if (input.Pressed(KEY_L)) {
+        MassObject& body = scene->masses[scene->selected];
+        if (!body.blackHole) {
+            body.pulsar = !body.pulsar;
+            if (body.pulsar) {
+                body.mass = std::max(body.mass, kPulsarMinMass);
+                body.radius = 0.22f;
+                body.color = Color{170, 220, 255, 255};
+                if (body.label.find(" PSR") == std::string::npos) body.label += " PSR";
+            } else {
+                body.radius = 0.30f;
+                body.color = BodyPalette()[scene->selected % static_cast<int>(BodyPalette().size())];
+                std::size_t suffix = body.label.find(" PSR");
+                if (suffix != std::string::npos) body.label.erase(suffix);
+            }
+        }
+    }
+    if (input.Pressed(KEY_SPACE)) scene->animateGrid = !scene->animateGrid;
+    if (input.Pressed(KEY_I)) scene->instancedParticles = !scene->instancedParticles;
+    if (input.Pressed(KEY_M)) scene->bodyMotionOn = !scene->bodyMotionOn;
+    if (input.Pressed(KEY_MINUS) || input.Pressed(KEY_KP_SUBTRACT)) scene->simSpeed = std::max(0.05f, scene->simSpeed * 0.8f);
+    if (input.Pressed(KEY_EQUAL) || input.Pressed(KEY_KP_ADD)) scene->simSpeed = std::min(12.0f, scene->simSpeed * 1.25f);
+    if (input.Pressed(KEY_ZERO) || input.Pressed(KEY_KP_0)) scene->simSpeed = 1.0f;
+    if (input.Pressed(KEY_ONE)) { scene->masses = MakeDefaultMasses(); scene->collisions.clear(); scene->explosionParticles.Clear(); scene->selected = 0; }
+    if (input.Pressed(KEY_TWO)) { scene->masses = MakeBinaryMasses(); scene->collisions.clear(); scene->explosionParticles.Clear(); scene->selected = 1; }
+    if (input.Pressed(KEY_THREE)) { scene->masses = MakeTriangularTripleMasses(); scene->collisions.clear(); scene->explosionParticles.Clear(); scene->selected = 2; }
+    if (input.Pressed(KEY_FOUR)) { scene->masses = MakeClusterMasses(); scene->collisions.clear(); scene->explosionParticles.Clear(); scene->selected = 0; }
+    if (input.Pressed(KEY_N)) {
+        AddOrbitingMass(&scene->masses, scene->selected);
+        scene->selected = static_cast<int>(scene->masses.size()) - 1;
+    }
+    if ((input.Pressed(KEY_BACKSPACE) || input.Pressed(KEY_DELETE)) && scene->masses.size() > 1) {
+        scene->masses.erase(scene->masses.begin() + scene->selected);
+        scene->selected = std::min(scene->selected, static_cast<int>(scene->masses.size()) - 1);
+    }
+    if (input.Pressed(KEY_TAB)) scene->selected = (scene->selected + 1) % static_cast<int>(scene->masses.size());
+    if (input.Pressed(KEY_R)) {
+        scene->masses = MakeDefaultMasses();
+        scene->collisions.clear();
+        scene->explosionParticles.Clear();
+        scene->selected = 0;
+        scene->core = 1.05f;
+        scene->time = 0.0f;
+        scene->gridExtent = kBaseGridExtent;
+        scene->simSpeed = 1.0f;
+        scene->paused = false;
+        scene->animateGrid = true;
+        scene->bodyMotionOn = true;
+        scene->relativisticMode = true;
+        scene->radiationDecay = false;
+    }
+
+    const float dt = input.dt;
+    MassObject& active = scene->masses[scene->selected];
+    if (input.Down(KEY_UP)) active.mass += 1.4f * dt;
+    if (input.Down(KEY_DOWN)) active.mass = std::max(0.35f, active.mass - 1.4f * dt);
+    if (active.blackHole) active.radius = std::max(0.36f, SchwarzschildRadius(active.mass) * 0.72f);
+    if (input.Down(KEY_RIGHT)) scene->core = std::min(2.4f, scene->core + 0.75f * dt);
+    if (input.Down(KEY_LEFT)) scene->core = std::max(0.45f, scene->core - 0.75f * dt);
+    bool movedActive = false;
+    if (input.Down(KEY_W)) { active.pos.y = std::min(3.8f, active.pos.y + 1.8f * dt); movedActive = true; }
+    if (input.Down(KEY_S)) { active.pos.y = std::max(-3.8f, active.pos.y - 1.8f * dt); movedActive = true; }
+    if (input.Down(KEY_A)) { active.pos.x = std::max(-3.8f, active.pos.x - 1.8f * dt); movedActive = true; }
+    if (input.Down(KEY_D)) { active.pos.x = std::min(3.8f, active.pos.x + 1.8f * dt); movedActive = true; }
+    if (input.Down(KEY_Q)) { active.pos.z = std::max(-3.8f, active.pos.z - 1.8f * dt); movedActive = true; }
+    if (input.Down(KEY_E)) { active.pos.z = std::min(3.8f, active.pos.z + 1.8f * dt); movedActive = true; }
+    if (movedActive) {
+        active.vel = {0.0f, 0.0f, 0.0f};
+        active.trail.Clear();
+    }
+
+    if (!scene->paused) {
+        float scaledDt = dt * scene->simSpeed;
+        if (scene->animateGrid) scene->time += scaledDt * 4.2f;
+        UpdateCollisionEvents(&scene->collisions, scaledDt);
+        UpdateExplosionParticles(&scene->explosionParticles, scaledDt);
+        if (scene->bodyMotionOn) {
+            ExportWellSnapshot(snapshots, scene->bodySteps, scene->bodyTime, scene->masses);
+            scene->bodyTime += AdvanceBodies(&scene->masses, &scene->collisions, &scene->explosionParticles, &scene->selected, dt, scene->simSpeed, scene->relativisticMode, scene->radiationDecay);
+            ++scene->bodySteps;
+        }
+    }
+
+    float targetExtent = TargetGridExtent(scene->masses);
+    if (targetExtent > scene->gridExtent) {
+        scene->gridExtent = targetExtent;
+    } else {
+        scene->gridExtent += (targetExtent - scene->gridExtent) * std::clamp(dt * 0.85f, 0.0f, 1.0f);
+    }
+    UpdateWarpGridCache(&scene->warpGrid, scene->masses, scene->collisions, scene->core, scene->time, scene->gridExtent);
+}
+
+// Keyframe for the replay log: controls plus every body's dynamical state.
+void SnapshotWellScene(const WellScene& scene, std::vector<uint8_t>* out) {
+    astro_replay::ByteWriter writer(out);
+    writer.Put(scene.selected);
+    writer.Put(scene.core);
+    writer.Put(scene.time);
+    writer.Put(scene.gridExtent);
+    writer.Put(scene.simSpeed);
+    writer.Put(static_cast<uint32_t>(scene.collisions.size()));
+    writer.Put(static_cast<uint32_t>(scene.explosionParticles.size()));
+    writer.Put(static_cast<uint32_t>(scene.masses.size()));
+    for (const MassObject& body : scene.masses) {
+        writer.Put(body.pos);
+        writer.Put(body.vel);
+        writer.Put(body.mass);
+        writer.Put(body.radius);
+        writer.Put(body.blackHole);
+        writer.Put(body.pulsar);
+    }
+    uint8_t flags = 0;
+    for (bool flag : {scene.paused, scene.animateGrid, scene.bodyMotionOn, scene.relativisticMode, scene.radiationDecay}) {
+        flags = static_cast<uint8_t>((flags << 1) | (flag ? 1 : 0));
+    }
+    writer.Put(flags);
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    // --snapshot=path writes the bodies every --snapshot-every frames of motion, in every mode.
+    astro_snapshot::SnapshotWriter snapshots;
+    std::string snapshotError;
+    if (!snapshots.Open(astro_snapshot::SnapshotOptions::FromArgs(argc, argv), "gravity_well_grid_viz", &snapshotError)) {
+        std::fprintf(stderr, "gravity_well_grid_viz: %s\n", snapshotError.c_str());
+        return 1;
+    }
+
+    const astro_replay::ReplayOptions replay = astro_replay::ParseReplayArgs(argc, argv);
+    if (!replay.replayPath.empty()) {
+        WellScene scene;
+        const int status = astro_replay::RunReplay(
+            "gravity_well_grid_viz", replay,
+            [&](const astro_replay::InputFrame& input, const auto&) { UpdateWellScene(&scene, input, &snapshots); },
+            [&](std::vector<uint8_t>* out) { SnapshotWellScene(scene, out); });
+        astro_snapshot::CloseSnapshots(&snapshots, "gravity_well_grid_viz");
+        return status;
+    }
+
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // Default scene topped up with orbiting bodies; --no-grid drops the CPU side of the warp grid.
+        const int bodyCount = std::clamp(astro_bench::IntArg(argc, argv, "--bodies", 6), 1, kMaxBodies);
+        const bool updateGrid = !astro_bench::HasFlag(argc, argv, "--no-grid");
+        std::vector<MassObject> masses = MakeDefaultMasses();
+        while (static_cast<int>(masses.size()) < bodyCount) AddOrbitingMass(&masses, 0);
+        std::vector<CollisionEvent> collisions;
+        astro_fx::ParticlePool<ExplosionParticle> explosionParticles(kMaxExplosionParticles);
+        WarpGridCache warpGrid;
+        BuildWarpGridCache(&warpGrid);
+        int selected = 0;
+        float time = 0.0f;
+        float gridExtent = kBaseGridExtent;
+        uint64_t bodySteps = 0;
+        double bodyTime = 0.0;
+        const int status = astro_bench::RunBench(
+            "gravity_well_grid_viz", bench,
+            [&](float dt) {
+                time += dt * 4.2f;
+                UpdateCollisionEvents(&collisions, dt);
+                UpdateExplosionParticles(&explosionParticles, dt);
+                ExportWellSnapshot(&snapshots, bodySteps++, bodyTime, masses);
+                bodyTime += AdvanceBodies(&masses, &collisions, &explosionParticles, &selected, dt, 1.0f, true, false);
+                gridExtent = std::max(gridExtent, TargetGridExtent(masses));
+                if (updateGrid) UpdateWarpGridCache(&warpGrid, masses, collisions, 1.05f, time, gridExtent);
+            },
+            [&]() {
+                float sum = static_cast<float>(masses.size());
+                for (const MassObject& body : masses) sum += body.pos.x + body.pos.y + body.pos.z;
+                return sum;
+            });
+        astro_snapshot::CloseSnapshots(&snapshots, "gravity_well_grid_viz");
+        return status;
+    }
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(kScreenWidth, kScreenHeight, "3D Multi-Mass Gravity Grid - C++ (raylib)");
     SetTargetFPS(60);
@@ -604,23 +1079,21 @@ int main() {
     float camPitch = 0.28f;
     float camDistance = 18.0f;
 
-    std::vector<MassObject> masses = MakeDefaultMasses();
-    std::vector<CollisionEvent> collisions;
-    std::vector<ExplosionParticle> explosionParticles;
-
-    int selected = 0;
-    float core = 1.05f;
-    float time = 0.0f;
-    float gridExtent = kBaseGridExtent;
-    float simSpeed = 1.0f;
-    bool paused = false;
-    bool animateGrid = true;
-    bool bodyMotionOn = true;
-    bool relativisticMode = true;
-    bool radiationDecay = false;
+    WellScene scene;
+    astro_render::InstancedParticleRenderer explosionRenderer;
+    explosionRenderer.Init(astro_render::InstanceShape::kSphere);
+    astro_render::TrailRenderer trailRenderer;
+    trailRenderer.Init();
     int windowedWidth = kScreenWidth;
     int windowedHeight = kScreenHeight;
 
+    astro_replay::Recorder recorder;
+    if (!replay.recordPath.empty() && !recorder.Open(replay.recordPath, "gravity_well_grid_viz", 0)) {
+        std::fprintf(stderr, "gravity_well_grid_viz: cannot write %s\n", replay.recordPath.c_str());
+    }
+    std::vector<uint8_t> keyframe;
+    uint32_t frame = 0;
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_F)) {
             if (!IsWindowFullscreen()) {
@@ -634,133 +1107,35 @@ int main() {
                 SetWindowSize(windowedWidth, windowedHeight);
             }
         }
-        if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_G)) relativisticMode = !relativisticMode;
-        if (IsKeyPressed(KEY_C)) radiationDecay = !radiationDecay;
-        if (IsKeyPressed(KEY_B)) {
-            MassObject& body = masses[selected];
-            body.blackHole = !body.blackHole;
-            if (body.blackHole) {
-                body.pulsar = false;
-                std::size_t pulsarSuffix = body.label.find(" PSR");
-                if (pulsarSuffix != std::string::npos) body.label.erase(pulsarSuffix);
-                body.mass = std::max(body.mass, kBlackHoleMinMass);
-                body.radius = std::max(0.36f, SchwarzschildRadius(body.mass) * 0.72f);
-                body.color = Color{20, 20, 24, 255};
-                if (body.label.find(" BH") == std::string::npos) body.label += " BH";
-            } else {
-                body.radius = 0.30f;
-                body.color = BodyPalette()[selected % static_cast<int>(BodyPalette().size())];
-                std::size_t suffix = body.label.find(" BH");
-                if (suffix != std::string::npos) body.label.erase(suffix);
-            }
-        }
-        if (IsKeyPressed(KEY_L)) {
-            MassObject& body = masses[selected];
-            if (!body.blackHole) {
-                body.pulsar = !body.pulsar;
-                if (body.pulsar) {
-                    body.mass = std::max(body.mass, kPulsarMinMass);
-                    body.radius = 0.22f;
-                    body.color = Color{170, 220, 255, 255};
-                    if (body.label.find(" PSR") == std::string::npos) body.label += " PSR";
-                } else {
-                    body.radius = 0.30f;
-                    body.color = BodyPalette()[selected % static_cast<int>(BodyPalette().size())];
-                    std::size_t suffix = body.label.find(" PSR");
-                    if (suffix != std::string::npos) body.label.erase(suffix);
-                }
-            }
-        }
-        if (IsKeyPressed(KEY_SPACE)) animateGrid = !animateGrid;
-        if (IsKeyPressed(KEY_M)) bodyMotionOn = !bodyMotionOn;
-        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) simSpeed = std::max(0.05f, simSpeed * 0.8f);
-        if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) simSpeed = std::min(12.0f, simSpeed * 1.25f);
-        if (IsKeyPressed(KEY_ZERO) || IsKeyPressed(KEY_KP_0)) simSpeed = 1.0f;
-        if (IsKeyPressed(KEY_ONE)) { masses = MakeDefaultMasses(); collisions.clear(); explosionParticles.clear(); selected = 0; }
-        if (IsKeyPressed(KEY_TWO)) { masses = MakeBinaryMasses(); collisions.clear(); explosionParticles.clear(); selected = 1; }
-        if (IsKeyPressed(KEY_THREE)) { masses = MakeTriangularTripleMasses(); collisions.clear(); explosionParticles.clear(); selected = 2; }
-        if (IsKeyPressed(KEY_FOUR)) { masses = MakeClusterMasses(); collisions.clear(); explosionParticles.clear(); selected = 0; }
-        if (IsKeyPressed(KEY_N)) {
-            AddOrbitingMass(&masses, selected);
-            selected = static_cast<int>(masses.size()) - 1;
-        }
-        if ((IsKeyPressed(KEY_BACKSPACE) || IsKeyPressed(KEY_DELETE)) && masses.size() > 1) {
-            masses.erase(masses.begin() + selected);
-            selected = std::min(selected, static_cast<int>(masses.size()) - 1);
-        }
-        if (IsKeyPressed(KEY_TAB)) selected = (selected + 1) % static_cast<int>(masses.size());
-        if (IsKeyPressed(KEY_R)) {
-            masses = MakeDefaultMasses();
-            collisions.clear();
-            explosionParticles.clear();
-            selected = 0;
-            core = 1.05f;
-            time = 0.0f;
-            gridExtent = kBaseGridExtent;
-            simSpeed = 1.0f;
-            paused = false;
-            animateGrid = true;
-            bodyMotionOn = true;
-            relativisticMode = true;
-            radiationDecay = false;
-        }
-
-        float dt = GetFrameTime();
-        MassObject& active = masses[selected];
-        if (IsKeyDown(KEY_UP)) active.mass += 1.4f * dt;
-        if (IsKeyDown(KEY_DOWN)) active.mass = std::max(0.35f, active.mass - 1.4f * dt);
-        if (active.blackHole) active.radius = std::max(0.36f, SchwarzschildRadius(active.mass) * 0.72f);
-        if (IsKeyDown(KEY_RIGHT)) core = std::min(2.4f, core + 0.75f * dt);
-        if (IsKeyDown(KEY_LEFT)) core = std::max(0.45f, core - 0.75f * dt);
-        bool movedActive = false;
-        if (IsKeyDown(KEY_W)) { active.pos.y = std::min(3.8f, active.pos.y + 1.8f * dt); movedActive = true; }
-        if (IsKeyDown(KEY_S)) { active.pos.y = std::max(-3.8f, active.pos.y - 1.8f * dt); movedActive = true; }
-        if (IsKeyDown(KEY_A)) { active.pos.x = std::max(-3.8f, active.pos.x - 1.8f * dt); movedActive = true; }
-        if (IsKeyDown(KEY_D)) { active.pos.x = std::min(3.8f, active.pos.x + 1.8f * dt); movedActive = true; }
-        if (IsKeyDown(KEY_Q)) { active.pos.z = std::max(-3.8f, active.pos.z - 1.8f * dt); movedActive = true; }
-        if (IsKeyDown(KEY_E)) { active.pos.z = std::min(3.8f, active.pos.z + 1.8f * dt); movedActive = true; }
-        if (movedActive) {
-            active.vel = {0.0f, 0.0f, 0.0f};
-            active.trail.clear();
-        }
-
-        if (!paused) {
-            float scaledDt = dt * simSpeed;
-            if (animateGrid) time += scaledDt * 4.2f;
-            UpdateCollisionEvents(&collisions, scaledDt);
-            UpdateExplosionParticles(&explosionParticles, scaledDt);
-            if (bodyMotionOn) {
-                float totalSimDt = std::min(0.014f, dt) * 5.0f * simSpeed;
-                int steps = std::clamp(static_cast<int>(std::ceil(totalSimDt / 0.014f)), 1, 96);
-                float simDt = totalSimDt / static_cast<float>(steps);
-                for (int i = 0; i < steps; ++i) UpdateMassObjects(&masses, &collisions, &explosionParticles, &selected, simDt, relativisticMode, radiationDecay);
+        const astro_replay::InputFrame input = astro_replay::CaptureInput();
+        UpdateWellScene(&scene, input, &snapshots);
+        if (recorder.recording()) {
+            recorder.Frame(frame, input);
+            if (astro_replay::Recorder::KeyframeDue(frame)) {
+                SnapshotWellScene(scene, &keyframe);
+                recorder.Keyframe(frame, keyframe);
             }
         }
-
-        float targetExtent = TargetGridExtent(masses);
-        if (targetExtent > gridExtent) {
-            gridExtent = targetExtent;
-        } else {
-            gridExtent += (targetExtent - gridExtent) * std::clamp(dt * 0.85f, 0.0f, 1.0f);
-        }
-
+        ++frame;
         UpdateOrbitCamera(&camera, &camYaw, &camPitch, &camDistance);
 
         BeginDrawing();
         ClearBackground(BLACK);
 
+        const std::vector<MassObject>& masses = scene.masses;
+        const int selected = scene.selected;
+        const float time = scene.time;
         BeginMode3D(camera);
-        DrawWarpedCubeGrid(masses, collisions, core, time, gridExtent);
-        DrawGravitationalWaveRipples(masses, collisions, time, radiationDecay);
-        DrawExplosionParticles(explosionParticles);
+        DrawWarpGridCache(scene.warpGrid, masses, time);
+        DrawGravitationalWaveRipples(masses, scene.collisions, time, scene.radiationDecay);
+        DrawExplosionParticles(scene.explosionParticles, scene.instancedParticles ? &explosionRenderer : nullptr);
+
+        trailRenderer.Clear();
+        for (const MassObject& body : masses) trailRenderer.Add(body.trail, WithAlpha(body.color, 175), 30);
+        trailRenderer.Draw();
 
         for (int i = 0; i < static_cast<int>(masses.size()); ++i) {
             const MassObject& body = masses[i];
-            for (std::size_t j = 1; j < body.trail.size(); ++j) {
-                float a = static_cast<float>(j) / static_cast<float>(body.trail.size());
-                DrawLine3D(body.trail[j - 1], body.trail[j], WithAlpha(body.color, static_cast<unsigned char>(30 + 145 * a)));
-            }
             float rs = SchwarzschildRadius(body.mass);
             if (body.blackHole) {
                 DrawBlackHole(body, i == selected, time);
@@ -777,14 +1152,23 @@ int main() {
         EndMode3D();
 
         DrawText("Weak-Field Relativistic Gravity Grid", 20, 18, 28, Color{238, 242, 252, 255});
-        DrawText("1-4 presets | N add | B black hole | L pulsar | -/+ speed | 0 reset speed | SPACE flow | R reset", 20, 52, 18, Color{166, 184, 214, 255});
-        std::string hud = Hud(masses, selected, relativisticMode, radiationDecay, paused, simSpeed);
+        DrawText("1-4 presets | N add | B black hole | L pulsar | -/+ speed | 0 reset speed | SPACE flow | I instanced debris | R reset", 20, 52, 18, Color{166, 184, 214, 255});
+        std::string hud = Hud(masses, selected, scene.relativisticMode, scene.radiationDecay, scene.paused, scene.simSpeed);
         DrawText(hud.c_str(), 20, 82, 19, Color{255, 220, 120, 255});
         DrawFPS(20, 112);
+        DrawText(TextFormat("grid chunks recomputed: %d / %d", scene.warpGrid.updatedChunks, static_cast<int>(scene.warpGrid.chunks.size())), 20, 138, 16,
+                 Color{150, 170, 200, 255});
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    recorder.Close();
+    astro_snapshot::CloseSnapshots(&snapshots, "gravity_well_grid_viz");
+    explosionRenderer.Unload();
+    trailRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
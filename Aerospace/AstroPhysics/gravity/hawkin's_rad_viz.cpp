@@ -1,7 +1,12 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/hawking_emission.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -11,6 +16,28 @@
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+constexpr float kPlanckMassPerUnit = 100.0f;  // display mass -> Planck masses
+constexpr float kReferenceMass = 4.0f;  // electrons sit at twice this hole's temperature
+constexpr int kBars = 40;
+constexpr float kBarMaxOverT = 12.0f;
+constexpr int kOrbiters = 22;
+const std::array<Color, 5> kSpeciesColors = {{
+    Color{150, 255, 170, 230},  // neutrinos
+    Color{255, 214, 120, 230},  // photons
+    Color{196, 140, 255, 230},  // gravitons
+    Color{110, 190, 255, 230},  // electrons
+    Color{255, 110, 110, 230},  // muons
+}};
+
+// SpectrumDensity with the greybody factor pinned at its geometric-optics value: the
+// spectrum an ideal black body of the capture cross-section would radiate.
+double UndressedDensity(const astro_hawking::Species& s, double holeMass, double x) {
+    const double mu = holeMass * s.mass;
+    if (x <= mu) return 0.0;
+    const double p2 = x * x - mu * mu;
+    const double occupation = 1.0 / (std::exp(8.0 * astro_hawking::kPi * x) + (s.twiceSpin % 2 == 1 ? 1.0 : -1.0));
+    return 27.0 * s.dof / (2.0 * astro_hawking::kPi) * p2 * occupation;
+}
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -38,6 +65,10 @@ int main() {
     camera.projection = CAMERA_PERSPECTIVE;
     float camYaw=0.84f, camPitch=0.34f, camDistance=13.8f;
 
+    astro_hawking::EmissionTables tables;
+    tables.Build(astro_hawking::StandardSpecies(kReferenceMass * kPlanckMassPerUnit), 0.8 * kPlanckMassPerUnit, 8.0 * kPlanckMassPerUnit, 48);
+    const std::vector<astro_hawking::Species>& species = tables.species();
+
     float massBH = 4.0f;
     bool paused = false;
     float t = 0.0f;
@@ -51,29 +82,56 @@ int main() {
         UpdateOrbitCameraDragOnly(&camera,&camYaw,&camPitch,&camDistance);
         if (!paused) t += GetFrameTime();
 
+        const double holeMass = massBH * kPlanckMassPerUnit;
+        const int bin = tables.BinOf(holeMass);
         float T = 1.0f / std::max(0.1f, massBH);
 
+        // Bars in E / T: the greybody spectrum stacked by species under the undressed
+        // black-body outline, both on the outline's peak.
+        std::array<std::array<double, 5>, kBars> dressed{};
+        std::array<double, kBars> undressed{};
+        double peak = 1e-300;
+        for (int i=0;i<kBars;++i) {
+            const double x = (i + 0.5) * kBarMaxOverT / kBars / (8.0 * astro_hawking::kPi);
+            for (size_t s=0;s<species.size() && s<5;++s) {
+                dressed[i][s] = astro_hawking::SpectrumDensity(species[s], holeMass, x);
+                undressed[i] += UndressedDensity(species[s], holeMass, x);
+            }
+            peak = std::max(peak, undressed[i]);
+        }
+
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
         DrawSphere({-2.8f,0.7f,0}, 0.22f*massBH, BLACK);
         DrawSphere({-2.8f,0.7f,0}, 0.22f*massBH + 0.1f, Color{120,170,230,35});
 
-        for (int i=0;i<40;++i) {
-            float E = 0.2f + 0.22f * i;
-            float I = 1.0f / (std::exp(E / T) - 1.0f);
-            I = std::clamp(I * 0.06f, 0.0f, 1.0f);
+        Vector3 prevTop{};
+        for (int i=0;i<kBars;++i) {
             float x = -0.8f + 0.23f*i;
-            float h = 0.1f + 3.0f*I;
-            Color c = Color{static_cast<unsigned char>(90 + 160*I), static_cast<unsigned char>(130 + 110*I), static_cast<unsigned char>(180 + 70*I), 230};
-            DrawCube({x, 0.05f + h*0.5f, -1.1f}, 0.16f, h, 0.5f, c);
+            float y = 0.05f;
+            for (size_t s=0;s<species.size() && s<5;++s) {
+                const float h = 3.0f * static_cast<float>(dressed[i][s] / peak);
+                if (h <= 1e-4f) continue;
+                DrawCube({x, y + h*0.5f, -1.1f}, 0.16f, h, 0.5f, kSpeciesColors[s]);
+                y += h;
+            }
+            const Vector3 top = {x, 0.05f + 3.0f * static_cast<float>(undressed[i] / peak), -1.1f};
+            if (i > 0) DrawLine3D(prevTop, top, RAYWHITE);
+            prevTop = top;
         }
 
-        for (int i=0;i<22;++i) {
-            float a = 2.0f*PI*i/22.0f + t*(0.4f+0.6f*T);
+        // Orbiters take their species and energy from evenly spaced table draws, so the
+        // mix follows the emission rates at this mass.
+        for (int i=0;i<kOrbiters;++i) {
+            int s = 0;
+            float energyX = 0.0f;
+            tables.Sample(bin, (i + 0.5f) / kOrbiters, 0.5f, &s, &energyX);
+            const float overT = 8.0f * PI * energyX;
+            float a = 2.0f*PI*i/kOrbiters + t*(0.4f+0.6f*T)*(0.5f+0.15f*overT);
             float r = 1.3f + 0.3f*std::sin(t + i*0.4f);
             Vector3 p = {-2.8f + r*std::cos(a), 0.7f + 0.2f*std::sin(2*a), r*std::sin(a)};
-            DrawSphere(p, 0.03f + 0.02f*T, Color{255, 200, 130, 220});
+            DrawSphere(p, 0.03f + 0.02f*T, kSpeciesColors[static_cast<size_t>(s) % kSpeciesColors.size()]);
         }
 
         EndMode3D();
@@ -82,14 +140,23 @@ int main() {
         DrawText("Hold left mouse: orbit | wheel: zoom | [ ] black hole mass | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
 
         std::ostringstream os;
-        os << std::fixed << std::setprecision(3) << "M=" << massBH << "  T_H~1/M=" << T << "  (bars: thermal spectrum)";
+        os << std::fixed << std::setprecision(3) << "M=" << massBH << "  T_H~1/M=" << T << "  (bars: greybody spectrum by species, line: undressed)";
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{126,224,255,255});
-        DrawFPS(20,110);
+        for (size_t s=0;s<species.size() && s<5;++s) {
+            std::ostringstream share;
+            share << std::fixed << std::setprecision(1) << species[s].name << "  " << 100.0 * tables.power(bin, s) / tables.totalPower(bin) << "% power";
+            DrawRectangle(20, 113 + 22 * static_cast<int>(s), 12, 12, kSpeciesColors[s]);
+            DrawText(share.str().c_str(), 38, 110 + 22 * static_cast<int>(s), 18, Color{200,210,226,255});
+        }
+        DrawFPS(20,226);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,14 +1,70 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/hawking_emission.h"
+#include "../common/instanced_particles.h"
+#include "../common/profiler.h"
+#include "../common/thread_pool.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
-struct Particle { Vector3 p; Vector3 v; float life; };
+constexpr double kInitialMass = 560.0;  // Planck masses; radiates about 10^6 quanta
+constexpr int kMassBins = 64;
+constexpr size_t kMaxLive = size_t{1} << 20;
+constexpr size_t kMaxDrawn = size_t{1} << 18;  // live quanta beyond this are drawn with a stride
+constexpr float kHorizonRadius = 0.8f;  // display radius at the initial mass
+constexpr float kEscapeRadius = 9.0f;
+constexpr float kLightSpeed = 2.6f;  // display units per wall second
+constexpr std::array<float, 5> kQuantaRates = {{2000.0f, 10000.0f, 50000.0f, 200000.0f, 1000000.0f}};  // per wall second
+constexpr Vector3 kCenter = {0.0f, 0.5f, 0.0f};
+const std::array<Color, 5> kSpeciesColors = {{
+    Color{150, 255, 170, 255},  // neutrinos
+    Color{255, 214, 120, 255},  // photons
+    Color{196, 140, 255, 255},  // gravitons
+    Color{110, 190, 255, 255},  // electrons
+    Color{255, 110, 110, 255},  // muons
+}};
+
+// Escaping quanta as columns: each moves radially outward along its direction at its
+// own speed, so a step is one add per quantum.
+struct QuantaCloud {
+    std::vector<float> dirX, dirY, dirZ, radius, speed, size;
+    std::vector<uint8_t> species;
+    size_t count = 0;
+
+    QuantaCloud() {
+        for (std::vector<float>* c : {&dirX, &dirY, &dirZ, &radius, &speed, &size}) c->resize(kMaxLive);
+        species.resize(kMaxLive);
+    }
+
+    void Step(float dt) {
+        astro_parallel::SharedPool().ParallelFor(static_cast<int>(count), 16384, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) radius[static_cast<size_t>(i)] += speed[static_cast<size_t>(i)] * dt;
+        });
+        for (size_t i = 0; i < count;) {
+            if (radius[i] < kEscapeRadius) {
+                ++i;
+                continue;
+            }
+            --count;
+            dirX[i] = dirX[count];
+            dirY[i] = dirY[count];
+            dirZ[i] = dirZ[count];
+            radius[i] = radius[count];
+            speed[i] = speed[count];
+            size[i] = size[count];
+            species[i] = species[count];
+        }
+    }
+};
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -22,6 +78,77 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
     float cp = std::cos(*pitch);
     c->position = Vector3Add(c->target, {*distance * cp * std::cos(*yaw), *distance * std::sin(*pitch), *distance * cp * std::sin(*yaw)});
 }
+
+// Emits up to `want` quanta from the horizon into the cloud's free slots.
+int EmitQuanta(astro_hawking::Evaporator* hole, const std::vector<astro_hawking::Species>& species, int want, QuantaCloud* cloud) {
+    const int room = static_cast<int>(kMaxLive - cloud->count);
+    const float horizon = std::max(0.02f, kHorizonRadius * static_cast<float>(hole->mass() / hole->initialMass()));
+    const float temperature = static_cast<float>(hole->temperature());
+    const size_t base = cloud->count;
+    const int emitted = hole->Emit(std::min(want, room), [&](const astro_hawking::Quantum& q) {
+        const size_t i = base + static_cast<size_t>(q.slot);
+        const float z = 2.0f * q.spread[0] - 1.0f;
+        const float ring = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        const float phi = 2.0f * PI * q.spread[1];
+        const float m = static_cast<float>(species[static_cast<size_t>(q.species)].mass);
+        const float beta = m > 0.0f ? std::sqrt(std::max(0.0f, 1.0f - (m / q.energy) * (m / q.energy))) : 1.0f;
+        cloud->dirX[i] = ring * std::cos(phi);
+        cloud->dirY[i] = z;
+        cloud->dirZ[i] = ring * std::sin(phi);
+        cloud->radius[i] = horizon;
+        cloud->speed[i] = kLightSpeed * std::max(0.08f, beta);
+        cloud->size[i] = std::clamp(1.2f + 0.35f * q.energy / temperature, 1.2f, 4.0f);
+        cloud->species[i] = static_cast<uint8_t>(q.species);
+    });
+    cloud->count += static_cast<size_t>(emitted);
+    return emitted;
+}
+
+// Recent quanta per E / T bin, stacked by species, against the greybody spectrum of the
+// current mass scaled to the same total.
+void DrawSpectrumPanel(const astro_hawking::Evaporator& hole, const std::vector<astro_hawking::Species>& species, Rectangle r) {
+    constexpr int kBins = astro_hawking::Evaporator::kSpectrumBins;
+    DrawRectangleRec(r, Color{8, 12, 22, 215});
+    DrawRectangleLinesEx(r, 1.0f, Color{70, 90, 130, 255});
+    std::array<double, kBins> stacked{};
+    std::array<double, kBins> expected{};
+    double observedTotal = 0.0, expectedTotal = 0.0;
+    const double binWidth = astro_hawking::Evaporator::kSpectrumMax / kBins;
+    for (int b = 0; b < kBins; ++b) {
+        const double x = (b + 0.5) * binWidth / (8.0 * astro_hawking::kPi);
+        for (size_t s = 0; s < species.size(); ++s) {
+            stacked[static_cast<size_t>(b)] += hole.spectrum(s, b);
+            expected[static_cast<size_t>(b)] += astro_hawking::SpectrumDensity(species[s], hole.mass(), x);
+        }
+        observedTotal += stacked[static_cast<size_t>(b)];
+        expectedTotal += expected[static_cast<size_t>(b)];
+    }
+    const double expectedScale = expectedTotal > 0.0 ? observedTotal / expectedTotal : 0.0;
+    double peak = 1e-9;
+    for (int b = 0; b < kBins; ++b) peak = std::max({peak, stacked[static_cast<size_t>(b)], expected[static_cast<size_t>(b)] * expectedScale});
+
+    const float plotX = r.x + 12.0f, plotY = r.y + 30.0f;
+    const float plotW = r.width - 24.0f, plotH = r.height - 54.0f;
+    const float barW = plotW / kBins;
+    for (int b = 0; b < kBins; ++b) {
+        float y = plotY + plotH;
+        for (size_t s = 0; s < species.size(); ++s) {
+            const float h = static_cast<float>(hole.spectrum(s, b) / peak) * plotH;
+            if (h <= 0.0f) continue;
+            DrawRectangleRec({plotX + b * barW, y - h, barW - 1.0f, h}, Fade(kSpeciesColors[s % kSpeciesColors.size()], 0.82f));
+            y -= h;
+        }
+    }
+    Vector2 prev{};
+    for (int b = 0; b < kBins; ++b) {
+        const Vector2 p = {plotX + (b + 0.5f) * barW, plotY + plotH - static_cast<float>(expected[static_cast<size_t>(b)] * expectedScale / peak) * plotH};
+        if (b > 0) DrawLineEx(prev, p, 2.0f, RAYWHITE);
+        prev = p;
+    }
+    DrawText("Recent quanta vs greybody spectrum", static_cast<int>(r.x) + 12, static_cast<int>(r.y) + 8, 16, Color{220, 228, 240, 255});
+    DrawText("0", static_cast<int>(plotX), static_cast<int>(plotY + plotH) + 4, 14, Color{164, 183, 210, 255});
+    DrawText("E / T_H = 20", static_cast<int>(plotX + plotW) - 84, static_cast<int>(plotY + plotH) + 4, 14, Color{164, 183, 210, 255});
+}
 }
 
 int main() {
@@ -30,77 +157,98 @@ int main() {
 
     Camera3D camera{};
     camera.position = {8.0f, 5.0f, 9.0f};
-    camera.target = {0,0.5f,0};
+    camera.target = kCenter;
     camera.up = {0,1,0};
     camera.fovy = 45.0f;
     camera.projection = CAMERA_PERSPECTIVE;
     float camYaw=0.84f, camPitch=0.34f, camDistance=13.5f;
 
-    std::vector<Particle> pairs;
-    float rate = 14.0f;
+    // Species and energies come from per-mass-bin greybody tables; the hole loses
+    // exactly the energy it radiates, so it heats up and burns faster as it shrinks.
+    astro_hawking::EmissionTables tables;
+    tables.Build(astro_hawking::StandardSpecies(kInitialMass), 1.0, kInitialMass, kMassBins);
+    const std::vector<astro_hawking::Species>& species = tables.species();
+    astro_hawking::Evaporator hole(&tables, kInitialMass);
+    QuantaCloud cloud;
+    astro_render::InstancedParticleRenderer renderer;
+    renderer.Init(astro_render::InstanceShape::kScreenPoint, static_cast<int>(kMaxDrawn));
+
+    int rateIndex = 2;
     bool paused=false;
-    float timer=0.0f;
+    float owed=0.0f;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused=!paused;
-        if (IsKeyPressed(KEY_R)) { pairs.clear(); rate=14.0f; paused=false; timer=0.0f; }
-        if (IsKeyPressed(KEY_LEFT_BRACKET)) rate = std::max(2.0f, rate-1.0f);
-        if (IsKeyPressed(KEY_RIGHT_BRACKET)) rate = std::min(60.0f, rate+1.0f);
+        if (IsKeyPressed(KEY_R)) { hole.Reset(kInitialMass); cloud.count = 0; paused=false; owed=0.0f; }
+        if (IsKeyPressed(KEY_LEFT_BRACKET)) rateIndex = std::max(0, rateIndex-1);
+        if (IsKeyPressed(KEY_RIGHT_BRACKET)) rateIndex = std::min(static_cast<int>(kQuantaRates.size())-1, rateIndex+1);
 
         UpdateOrbitCameraDragOnly(&camera,&camYaw,&camPitch,&camDistance);
 
         if (!paused) {
             float dt = GetFrameTime();
-            timer += dt;
-            float period = 1.0f / rate;
-            while (timer > period) {
-                timer -= period;
-                float a = 2.0f*PI*std::fmod((float)pairs.size()*0.618f,1.0f);
-                Vector3 n = {std::cos(a), 0.2f*std::sin(2*a), std::sin(a)};
-                n = Vector3Normalize(n);
-                pairs.push_back({Vector3Scale(n,1.05f), Vector3Scale(n,2.5f), 2.4f}); // escaping
-                pairs.push_back({Vector3Scale(n,1.05f), Vector3Scale(n,-1.2f), 1.2f}); // infalling partner
-            }
-
-            for (auto& p : pairs) {
-                p.p = Vector3Add(p.p, Vector3Scale(p.v, dt));
-                p.life -= dt;
-                float r = Vector3Length(p.p);
-                if (Vector3DotProduct(p.p,p.v) < 0.0f) {
-                    p.v = Vector3Scale(p.v, 1.0f + 0.7f*dt);
-                } else {
-                    p.v = Vector3Scale(p.v, 1.0f - 0.08f*dt);
-                }
-                if (r < 0.8f) p.life = 0.0f;
-            }
-            pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [](const Particle& p){ return p.life <= 0.0f; }), pairs.end());
+            owed += kQuantaRates[static_cast<size_t>(rateIndex)] * dt;
+            const int want = static_cast<int>(owed);
+            owed -= static_cast<float>(want);
+            hole.Decay(std::pow(0.5, dt / 0.6));  // spectrum half-life 0.6 s
+            EmitQuanta(&hole, species, want, &cloud);
+            cloud.Step(dt);
         }
 
+        const float horizon = std::max(0.02f, kHorizonRadius * static_cast<float>(hole.mass() / hole.initialMass()));
+
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
-        DrawSphere({0,0.5f,0}, 0.8f, BLACK);
-        DrawSphere({0,0.5f,0}, 1.02f, Color{120,170,230,25});
-
-        for (size_t i=0;i<pairs.size();++i) {
-            bool escape = (i % 2 == 0);
-            Color c = escape ? Color{255,200,120,230} : Color{120,160,255,200};
-            DrawSphere(Vector3Add(pairs[i].p,{0,0.5f,0}), 0.05f, c);
+        DrawSphere(kCenter, horizon, BLACK);
+        DrawSphere(kCenter, horizon * 1.28f, Color{120,170,230,25});
+
+        const size_t stride = std::max<size_t>(1, (cloud.count + kMaxDrawn - 1) / kMaxDrawn);
+        renderer.Clear();
+        renderer.Reserve(cloud.count / stride + 1);
+        for (size_t i = 0; i < cloud.count; i += stride) {
+            const float r = cloud.radius[i];
+            const Vector3 p = {kCenter.x + cloud.dirX[i] * r, kCenter.y + cloud.dirY[i] * r, kCenter.z + cloud.dirZ[i] * r};
+            const float fade = 1.0f - r / kEscapeRadius;
+            Color c = kSpeciesColors[cloud.species[i] % kSpeciesColors.size()];
+            c.a = static_cast<unsigned char>(60 + 190 * fade);
+            renderer.Add(p, cloud.size[i], c);
         }
+        renderer.Draw();
 
         EndMode3D();
 
-        DrawText("Hawking Pair Production: Escape vs Infall", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] pair rate | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Hawking Emission: Greybody Quanta and Evaporation", 20, 18, 29, Color{232,238,248,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] emission rate | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
 
-        char buf[160];
-        snprintf(buf,sizeof(buf),"pair rate=%.1f  active particles=%zu%s", rate, pairs.size(), paused ? "  [PAUSED]" : "");
+        char buf[200];
+        snprintf(buf,sizeof(buf),"M=%.2f m_P  T_H=%.2e  t=%.3e t_P  left~%.2e t_P%s", hole.mass(), hole.temperature(), hole.time(), hole.lifetime(),
+                 hole.evaporated() ? "  [EVAPORATED - R resets]" : paused ? "  [PAUSED]" : "");
         DrawText(buf, 20, 82, 20, Color{126,224,255,255});
-        DrawFPS(20,110);
+        snprintf(buf,sizeof(buf),"%.0f quanta/s  emitted=%llu  in flight=%zu", kQuantaRates[static_cast<size_t>(rateIndex)],
+                 static_cast<unsigned long long>(hole.emitted()), cloud.count);
+        DrawText(buf, 20, 108, 20, Color{126,224,255,255});
+
+        double energyTotal = 0.0;
+        for (size_t s = 0; s < species.size(); ++s) energyTotal += hole.emittedEnergy(s);
+        for (size_t s = 0; s < species.size(); ++s) {
+            const int y = 142 + 24 * static_cast<int>(s);
+            DrawRectangle(20, y + 3, 14, 14, kSpeciesColors[s % kSpeciesColors.size()]);
+            snprintf(buf,sizeof(buf),"%-10s %9llu quanta  %5.1f%% energy", species[s].name,
+                     static_cast<unsigned long long>(hole.emittedCount(s)), energyTotal > 0.0 ? 100.0 * hole.emittedEnergy(s) / energyTotal : 0.0);
+            DrawText(buf, 42, y, 18, Color{200,210,226,255});
+        }
+        DrawFPS(20, 142 + 24 * static_cast<int>(species.size()) + 6);
+
+        DrawSpectrumPanel(hole, species, {static_cast<float>(GetScreenWidth()) - 480.0f, static_cast<float>(GetScreenHeight()) - 250.0f, 460.0f, 230.0f});
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    renderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,26 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/chirp_search.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+constexpr float kDefaultDataSpeed = 4.0f;  // data seconds per wall second in search mode
+constexpr float kMaxDataSpeed = 64.0f;
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -47,9 +57,133 @@ std::string Hud(float strainAmp, float gwFreq, float lX, float lZ, bool paused)
     return os.str();
 }
 
+// Detector stream plus the matched-filter bank, advanced in data time.
+struct SearchPipeline {
+    astro_gw::SearchOptions options;
+    astro_gw::StrainSource source;
+    astro_gw::ChirpSearch search;
+    std::vector<float> strain;
+    std::vector<float> signal;
+    double searchSeconds = 0.0;  // wall time spent filtering
+
+    void Configure(int templates) {
+        options.templates = templates;
+        source.Configure(options);
+        search.Configure(options);
+    }
+
+    void Reset() {
+        source.Reset();
+        search.Reset();
+        searchSeconds = 0.0;
+    }
+
+    void Advance(int samples) {
+        strain.resize(static_cast<size_t>(samples));
+        signal.resize(static_cast<size_t>(samples));
+        source.Generate(samples, strain.data(), signal.data());
+        const auto start = std::chrono::steady_clock::now();
+        search.Push(strain.data(), samples);
+        searchSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double dataSeconds() const { return static_cast<double>(source.sample()) / options.sampleRate; }
+    double realTimeFactor() const { return searchSeconds > 0.0 ? dataSeconds() / searchSeconds : 0.0; }
+};
+
+// Bank-maximum SNR against coalescence time, with the threshold and closed triggers.
+void DrawSnrPanel(const SearchPipeline& p, int x0, int y0, int w, int h) {
+    DrawRectangle(x0, y0, w, h, Fade(Color{20, 28, 44, 255}, 0.9f));
+    DrawText("Matched-filter SNR vs coalescence time", x0 + 14, y0 + 10, 18, Color{220, 230, 244, 255});
+    const astro_gw::ChirpSearch& s = p.search;
+    const float left = static_cast<float>(x0 + 14), right = static_cast<float>(x0 + w - 14);
+    const float top = static_cast<float>(y0 + 36), bottom = static_cast<float>(y0 + h - 24);
+    const float snrTop = 30.0f;
+    const int shown = s.snrCount();
+    const float span = static_cast<float>(s.options().history);
+    auto px = [&](float k) { return right - (right - left) * k / span; };
+    auto py = [&](float snr) { return bottom - (bottom - top) * std::min(snr, snrTop) / snrTop; };
+    DrawLine(static_cast<int>(left), static_cast<int>(py(s.options().threshold)), static_cast<int>(right),
+             static_cast<int>(py(s.options().threshold)), Fade(Color{255, 120, 100, 255}, 0.6f));
+    for (int k = 1; k < shown; ++k) {
+        DrawLineV({px(static_cast<float>(k)), py(s.Snr(k))}, {px(static_cast<float>(k - 1)), py(s.Snr(k - 1))}, Color{120, 240, 180, 255});
+    }
+    const int64_t end = s.snrEndSample();
+    const float perBin = static_cast<float>(s.options().snrDecimation);
+    for (const astro_gw::Trigger& t : s.triggers()) {
+        const float k = static_cast<float>(end - t.sample) / perBin;
+        if (k < 0.0f || k > span) continue;
+        DrawCircleV({px(k), py(t.snr)}, 4.0f, Color{255, 210, 120, 255});
+    }
+    char label[96];
+    std::snprintf(label, sizeof(label), "last %.0f s of data  |  threshold %.0f", span * perBin / s.options().sampleRate,
+                  s.options().threshold);
+    DrawText(label, x0 + 14, y0 + h - 20, 15, Color{150, 170, 198, 255});
+}
+
+// The latest trigger's template drawn over the injection it recovered.
+void DrawBestMatchPanel(const SearchPipeline& p, const std::vector<float>& templateWave, int x0, int y0, int w, int h) {
+    DrawRectangle(x0, y0, w, h, Fade(Color{20, 28, 44, 255}, 0.9f));
+    DrawText("Best-match template", x0 + 14, y0 + 10, 18, Color{220, 230, 244, 255});
+    const std::vector<astro_gw::Trigger>& triggers = p.search.triggers();
+    if (triggers.empty() || templateWave.empty()) {
+        DrawText("waiting for a trigger...", x0 + 14, y0 + 40, 16, Color{150, 170, 198, 255});
+        return;
+    }
+    const astro_gw::Trigger& t = triggers.back();
+    const astro_gw::StrainSource::Injection* inj = p.source.InjectionNear(t.sample, p.options.sampleRate / 20);
+    const float mid = static_cast<float>(y0 + h / 2 + 8);
+    const float amp = 0.38f * static_cast<float>(h);
+    const float left = static_cast<float>(x0 + 14), width = static_cast<float>(w - 28);
+    auto drawWave = [&](const std::vector<float>& wave, Color c) {
+        if (wave.empty()) return;
+        float peak = 1.0e-12f;
+        for (float v : wave) peak = std::max(peak, std::fabs(v));
+        const int n = static_cast<int>(templateWave.size());
+        const int step = std::max(1, n / static_cast<int>(width));
+        Vector2 prev{};
+        bool havePrev = false;
+        for (int i = 0; i < n; i += step) {
+            const int64_t src = static_cast<int64_t>(wave.size()) - n + i;
+            if (src < 0 || src >= static_cast<int64_t>(wave.size())) continue;
+            const Vector2 cur = {left + width * i / n, mid - amp * wave[static_cast<size_t>(src)] / peak};
+            if (havePrev) DrawLineV(prev, cur, c);
+            prev = cur;
+            havePrev = true;
+        }
+    };
+    if (inj) drawWave(inj->signal, Fade(Color{255, 170, 110, 255}, 0.8f));
+    drawWave(templateWave, Color{120, 220, 255, 255});
+    char label[160];
+    if (inj) {
+        std::snprintf(label, sizeof(label), "template Mc %.2f  SNR %.1f  |  injected Mc %.2f  SNR %.1f  dt %+.1f ms", t.chirpMass, t.snr,
+                      inj->chirpMass, inj->snr, 1000.0 * static_cast<double>(t.sample - inj->coalescence) / p.options.sampleRate);
+    } else {
+        std::snprintf(label, sizeof(label), "template Mc %.2f  SNR %.1f  |  no injection nearby", t.chirpMass, t.snr);
+    }
+    DrawText(label, x0 + 14, y0 + h - 22, 15, Color{126, 224, 255, 255});
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f);
+    SearchPipeline pipeline;
+    pipeline.Configure(std::clamp(astro_bench::IntArg(argc, argv, "--templates", 256), 1, 4096));
+
+    if (bench.enabled) {
+        const int samplesPerStep = std::max(1, static_cast<int>(bench.dt * pipeline.options.sampleRate));
+        return astro_bench::RunBench(
+            "interferometer_gw_viz", bench, [&](float) { pipeline.Advance(samplesPerStep); },
+            [&]() {
+                double sum = 0.0;
+                for (const astro_gw::Trigger& t : pipeline.search.triggers()) sum += t.snr;
+                std::fprintf(stderr, "%d templates, %.0f s of data, %.0fx real time, %zu triggers\n", pipeline.search.templateCount(),
+                             pipeline.dataSeconds(), pipeline.realTimeFactor(), pipeline.search.triggers().size());
+                return sum;
+            });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Interferometer GW Visualization 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -73,6 +207,14 @@ int main() {
     bool paused = false;
     float t = 0.0f;
 
+    bool searchMode = true;
+    float dataSpeed = kDefaultDataSpeed;
+    double pendingSamples = 0.0;
+    float signalPeak = 1.0f;
+    int64_t peakFor = -1;
+    size_t shownTriggers = 0;
+    std::vector<float> templateWave;
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
@@ -80,14 +222,32 @@ int main() {
             gwFreq = 0.75f;
             timeScale = 1.0f;
             t = 0.0f;
+            dataSpeed = kDefaultDataSpeed;
+            pipeline.Reset();
+            peakFor = -1;
+            shownTriggers = 0;
+            templateWave.clear();
         }
+        if (IsKeyPressed(KEY_M)) searchMode = !searchMode;
 
         if (IsKeyPressed(KEY_LEFT_BRACKET)) strainAmp = std::max(0.0e-3f, strainAmp - 0.5e-3f);
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) strainAmp = std::min(20.0e-3f, strainAmp + 0.5e-3f);
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) gwFreq = std::max(0.1f, gwFreq - 0.05f);
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) gwFreq = std::min(3.0f, gwFreq + 0.05f);
-        if (IsKeyPressed(KEY_COMMA)) timeScale = std::max(0.2f, timeScale - 0.2f);
-        if (IsKeyPressed(KEY_PERIOD)) timeScale = std::min(6.0f, timeScale + 0.2f);
+        if (IsKeyPressed(KEY_COMMA)) {
+            if (searchMode) {
+                dataSpeed = std::max(1.0f, dataSpeed * 0.5f);
+            } else {
+                timeScale = std::max(0.2f, timeScale - 0.2f);
+            }
+        }
+        if (IsKeyPressed(KEY_PERIOD)) {
+            if (searchMode) {
+                dataSpeed = std::min(kMaxDataSpeed, dataSpeed * 2.0f);
+            } else {
+                timeScale = std::min(6.0f, timeScale + 0.2f);
+            }
+        }
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
@@ -96,6 +256,28 @@ int main() {
         }
 
         float h = strainAmp * std::sin(2.0f * PI * gwFreq * t);
+        if (searchMode) {
+            // The arms follow the injected signal alone (noise would blur the fringes),
+            // normalized to the loudest sample of the current injection.
+            if (!paused) {
+                pendingSamples += static_cast<double>(dataSpeed) * std::min(GetFrameTime(), 0.1f) * pipeline.options.sampleRate;
+                const int samples = static_cast<int>(pendingSamples);
+                pendingSamples -= samples;
+                if (samples > 0) pipeline.Advance(samples);
+            }
+            const std::vector<astro_gw::StrainSource::Injection>& injections = pipeline.source.injections();
+            if (!injections.empty() && injections.back().start != peakFor) {
+                peakFor = injections.back().start;
+                signalPeak = 1.0e-12f;
+                for (float v : injections.back().signal) signalPeak = std::max(signalPeak, std::fabs(v));
+            }
+            h = pipeline.signal.empty() ? 0.0f : strainAmp * pipeline.signal.back() / signalPeak;
+            const std::vector<astro_gw::Trigger>& triggers = pipeline.search.triggers();
+            if (!triggers.empty() && triggers.size() != shownTriggers) {
+                shownTriggers = triggers.size();
+                astro_gw::InspiralWaveform(triggers.back().chirpMass, pipeline.options.fLow, pipeline.options.sampleRate, 0.0, &templateWave);
+            }
+        }
         float Lx = L0 * (1.0f + h);
         float Lz = L0 * (1.0f - h);
 
@@ -148,9 +330,17 @@ int main() {
         EndMode3D();
 
         DrawText("Gravitational-Wave Interferometer (L-shaped)", 20, 18, 29, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] strain | +/- GW freq | , . time scale | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] strain | +/- GW freq | , . time scale | M search mode | P pause | R reset", 20, 54,
+                 18, Color{164, 183, 210, 255});
 
         std::string hud = Hud(strainAmp, gwFreq, Lx, Lz, paused);
+        if (searchMode) {
+            char line[200];
+            std::snprintf(line, sizeof(line), "search: %d templates  data t=%.1f s  speed %.0fx  filter %.0fx real time  %zu triggers%s",
+                          pipeline.search.templateCount(), pipeline.dataSeconds(), dataSpeed, pipeline.realTimeFactor(),
+                          pipeline.search.triggers().size(), paused ? "  [PAUSED]" : "");
+            hud = line;
+        }
         DrawText(hud.c_str(), 20, 82, 20, Color{126, 224, 255, 255});
 
         DrawText("Detector intensity", 20, 114, 18, Color{210, 220, 230, 255});
@@ -159,9 +349,17 @@ int main() {
 
         DrawFPS(20, 172);
 
+        if (searchMode) {
+            DrawBestMatchPanel(pipeline, templateWave, 800, 110, 460, 220);
+            DrawSnrPanel(pipeline, 20, 620, 1240, 180);
+        }
+
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
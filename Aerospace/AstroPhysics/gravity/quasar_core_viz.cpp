@@ -1,6 +1,12 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/colormap.h"
+#include "../common/frame_capture.h"
+#include "../common/offline_tracer.h"
+#include "../common/particle_pool.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -13,6 +19,13 @@ constexpr int kScreenWidth = 1440;
 constexpr int kScreenHeight = 900;
 constexpr float kPi = 3.14159265358979323846f;
 
+// --render: fixed step used to advance the scene to --time, and the seed that makes two
+// renders of the same time identical.
+constexpr float kRenderStep = 1.0f / 60.0f;
+constexpr unsigned int kRenderSeed = 5280;
+// Both jets at full power and flare spawn ~210 packets/s living up to 3.6 s.
+constexpr size_t kMaxJetPackets = 1024;
+
 struct DiskParticle {
     float radiusBase;
     float radialNoise;
@@ -75,15 +88,17 @@ Color LerpColor(Color a, Color b, float t) {
     };
 }
 
-Color DiskHeatColor(float heat) {
-    if (heat > 0.82f) {
-        return LerpColor(Color{160, 214, 255, 255}, Color{255, 249, 228, 255}, (heat - 0.82f) / 0.18f);
-    }
-    if (heat > 0.52f) {
-        return LerpColor(Color{255, 188, 92, 255}, Color{255, 244, 212, 255}, (heat - 0.52f) / 0.30f);
-    }
-    return LerpColor(Color{214, 72, 30, 255}, Color{255, 190, 92, 255}, heat / 0.52f);
-}
+// Dusty red to amber, amber to near-white, then a hard step into the blue-white inner disk.
+const astro_color::Colormap kDiskHeatMap = astro_color::Colormap::FromStops({
+    {0.00f, Color{214, 72, 30, 255}},
+    {0.52f, Color{255, 190, 92, 255}},
+    {0.52f, Color{255, 188, 92, 255}},
+    {0.82f, Color{255, 244, 212, 255}},
+    {0.82f, Color{160, 214, 255, 255}},
+    {1.00f, Color{255, 249, 228, 255}},
+});
+
+Color DiskHeatColor(float heat) { return kDiskHeatMap(heat); }
 
 Vector3 RotateX(Vector3 p, float angle) {
     const float c = std::cos(angle);
@@ -209,8 +224,8 @@ void InitializeStars(std::vector<Star>* stars) {
     }
 }
 
-void SpawnJetPacket(std::vector<JetPacket>* packets, int direction, float jetPower, float flareStrength) {
-    packets->push_back(JetPacket{
+void SpawnJetPacket(astro_fx::ParticlePool<JetPacket>* packets, int direction, float jetPower, float flareStrength) {
+    packets->Spawn(JetPacket{
         RandomFloat(1.35f, 1.85f),
         RandomFloat(0.04f, 0.26f + 0.12f * jetPower),
         RandomFloat(0.0f, 2.0f * kPi),
@@ -260,50 +275,214 @@ void DrawTorus(float majorRadius, float minorRadius, float opacity, float time)
     }
 }
 
-}  // namespace
+// Everything the frame loop advances; shared by the window and the --render still.
+struct QuasarState {
+    float blackHoleMass = 280.0f;
+    float jetPower = 1.25f;
+    float diskThickness = 0.72f;
+    float torusOpacity = 0.65f;
+    float beamingScale = 1.45f;
+    float time = 0.0f;
+    float flareTimer = 0.0f;
+    float flareStrength = 0.0f;
+    float jetSpawnAccumulator = 0.0f;
+    std::vector<DiskParticle> diskParticles;
+    std::vector<CoronaParticle> coronaParticles;
+    astro_fx::ParticlePool<JetPacket> jetPackets{kMaxJetPackets};
+    std::vector<Star> stars;
+};
 
-int main() {
-    InitWindow(kScreenWidth, kScreenHeight, "Quasar Core 3D - C++ (raylib)");
-    SetTargetFPS(60);
+void ResetQuasar(QuasarState* state) {
+    *state = QuasarState{};
+    InitializeDisk(&state->diskParticles);
+    InitializeCorona(&state->coronaParticles);
+    InitializeStars(&state->stars);
+}
+
+void StepQuasar(QuasarState* state, float dt) {
+    state->time += dt;
+    state->flareTimer = std::max(0.0f, state->flareTimer - dt);
+    state->flareStrength = std::sin((state->flareTimer / 1.65f) * kPi);
+    state->flareStrength = std::max(state->flareStrength, 0.0f);
+
+    const float massSpinScale = 0.72f + state->blackHoleMass / 260.0f;
+    for (DiskParticle& particle : state->diskParticles) {
+        float innerBoost = 1.0f + (1.0f - particle.radiusBase / 8.2f) * (0.35f + state->flareStrength * 0.65f);
+        particle.theta += particle.omega * massSpinScale * innerBoost * dt;
+    }
+    for (CoronaParticle& particle : state->coronaParticles) {
+        particle.theta += particle.omega * (1.0f + state->flareStrength * 0.5f) * dt;
+    }
+
+    state->jetSpawnAccumulator += dt * (18.0f + state->jetPower * 22.0f + state->flareStrength * 18.0f);
+    while (state->jetSpawnAccumulator >= 1.0f) {
+        state->jetSpawnAccumulator -= 1.0f;
+        SpawnJetPacket(&state->jetPackets, 1, state->jetPower, state->flareStrength);
+        SpawnJetPacket(&state->jetPackets, -1, state->jetPower, state->flareStrength);
+    }
+
+    const float jetPower = state->jetPower;
+    state->jetPackets.Update([dt, jetPower](JetPacket& packet) {
+        packet.age += dt;
+        packet.axial += packet.speed * dt * (1.0f + 0.25f * jetPower);
+        packet.theta += dt * (1.0f + 0.8f * jetPower);
+        packet.radial *= 0.992f;
+        return packet.age <= packet.ttl && packet.axial <= 24.0f;
+    });
+}
+
+void TraceRing(astro_render::TraceScene* scene, float radius, float y, int segments, Color color, float wobble, float time) {
+    for (int i = 0; i < segments; ++i) {
+        float a0 = (2.0f * kPi * i) / static_cast<float>(segments);
+        float a1 = (2.0f * kPi * (i + 1)) / static_cast<float>(segments);
+        float r0 = radius + wobble * std::sin(time * 2.8f + a0 * 5.0f);
+        float r1 = radius + wobble * std::sin(time * 2.8f + a1 * 5.0f);
+        scene->AddStreak({r0 * std::cos(a0), y, r0 * std::sin(a0)}, {r1 * std::cos(a1), y, r1 * std::sin(a1)}, 0.035f, color);
+    }
+}
+
+// The frame main() draws, as path-tracer primitives: the horizon is the one opaque body,
+// the disk, corona, torus, jets and rings are glows. The grid and HUD are left out.
+void BuildTraceScene(const QuasarState& quasar, const Camera3D& camera, astro_render::TraceScene* scene) {
+    const float horizonRadius = 1.0f + (quasar.blackHoleMass - 120.0f) / 500.0f;
+    const float photonRingRadius = horizonRadius * 1.85f;
+    const float flare = quasar.flareStrength;
+    const Vector3 observerDirection = Vector3Normalize(Vector3Subtract(camera.position, camera.target));
+
+    scene->background = astro_render::LinearRgb(Color{4, 6, 12, 255});
+    scene->AddBody({0.0f, 0.0f, 0.0f}, horizonRadius, Color{6, 6, 8, 255});
+
+    for (const Star& star : quasar.stars) scene->AddGlow(star.position, star.size, Fade(star.color, 0.90f), 4.0f);
+
+    for (int i = 0; i < 8; ++i) {
+        TraceRing(scene, 10.0f + i * 0.95f, -0.04f * i, 84, Fade(Color{90, 130, 185, 255}, 0.07f - i * 0.006f), 0.04f,
+                  quasar.time * 0.2f + i);
+    }
+
+    // Dusty torus as a shell of soft glows over the DrawTorus wire grid.
+    const float minorRadius = 1.45f + quasar.diskThickness * 0.25f;
+    for (int i = 0; i < 72; ++i) {
+        for (int j = 0; j < 24; ++j) {
+            const float u = (2.0f * kPi * i) / 72.0f;
+            const float v = (2.0f * kPi * j) / 24.0f;
+            const float rim = 0.5f + 0.5f * std::sin(v + quasar.time * 0.8f);
+            const Color c{static_cast<unsigned char>(80 + 120 * rim), static_cast<unsigned char>(42 + 65 * rim),
+                          static_cast<unsigned char>(20 + 25 * rim),
+                          static_cast<unsigned char>(20 + quasar.torusOpacity * (45 + 55 * rim))};
+            scene->AddGlow(TorusPoint(u, v, 7.9f, minorRadius), 0.32f, c, 0.6f);
+        }
+    }
+
+    for (const DiskParticle& particle : quasar.diskParticles) {
+        float bandFactor = 1.0f - particle.band / 5.0f;
+        float radius = particle.radiusBase +
+                       std::sin(quasar.time * (1.2f + 0.20f * particle.band) + particle.phase) * particle.radialNoise * 0.12f;
+        float y = particle.yBase * 0.22f * quasar.diskThickness +
+                  std::sin(quasar.time * 2.8f + particle.phase * 1.7f) * 0.05f * quasar.diskThickness * (0.2f + bandFactor);
+        Vector3 position{radius * std::cos(particle.theta), y, radius * std::sin(particle.theta)};
+        Vector3 tangent = Vector3Normalize({-std::sin(particle.theta), 0.12f * y, std::cos(particle.theta)});
+        float viewBoost = std::clamp((Vector3DotProduct(tangent, observerDirection) + 1.0f) * 0.5f, 0.0f, 1.0f);
+        float beaming = 0.65f + std::pow(viewBoost, 1.0f + quasar.beamingScale) * (0.8f + quasar.jetPower * 0.25f);
+        Color baseColor = DiskHeatColor(std::clamp(particle.heat + flare * bandFactor * 0.20f, 0.0f, 1.0f));
+        Color drawColor = Fade(baseColor, std::clamp(particle.alpha * beaming, 0.0f, 1.0f));
+        float streakLength = particle.streak * (1.0f + bandFactor * 0.7f + flare * bandFactor);
+        float size = particle.size * (0.9f + 0.8f * bandFactor + flare * 0.4f);
+        scene->AddStreak(Vector3Subtract(position, Vector3Scale(tangent, streakLength)), position, 0.5f * size, Fade(drawColor, 0.55f));
+        scene->AddGlow(position, size, drawColor, 2.0f);
+    }
+
+    for (const CoronaParticle& particle : quasar.coronaParticles) {
+        float lift = particle.height + std::sin(quasar.time * 1.8f + particle.pulse) * 0.25f;
+        Vector3 position{particle.radius * std::cos(particle.theta), lift, particle.radius * std::sin(particle.theta)};
+        float pulse = 0.55f + 0.45f * std::sin(quasar.time * 4.0f + particle.pulse);
+        scene->AddGlow(position, particle.size * (1.0f + flare * 0.8f),
+                       Fade(Color{185, 226, 255, 255}, 0.10f + pulse * 0.24f + flare * 0.12f), 2.0f);
+    }
+
+    for (int side = -1; side <= 1; side += 2) {
+        float spineLength = 18.0f + quasar.jetPower * 4.0f;
+        Color spineColor = (side > 0) ? Color{120, 220, 255, 120} : Color{92, 178, 250, 96};
+        Color plumeColor = (side > 0) ? Color{80, 186, 255, 40} : Color{70, 160, 230, 32};
+        scene->AddTaperedStreak({0.0f, horizonRadius * side, 0.0f}, {0.0f, spineLength * side, 0.0f}, 0.24f + flare * 0.08f, 0.08f,
+                                spineColor);
+        scene->AddTaperedStreak({0.0f, horizonRadius * side, 0.0f}, {0.0f, (10.0f + quasar.jetPower * 4.0f) * side, 0.0f},
+                                0.95f + quasar.jetPower * 0.25f, 0.22f, plumeColor);
+    }
+
+    for (const JetPacket& packet : quasar.jetPackets) {
+        Vector3 position{packet.radial * std::cos(packet.theta), packet.direction * packet.axial, packet.radial * std::sin(packet.theta)};
+        float ageT = std::clamp(packet.age / packet.ttl, 0.0f, 1.0f);
+        float beaming = (packet.direction > 0)
+                            ? (0.7f + 0.6f * std::pow(std::max(0.0f, Vector3DotProduct(observerDirection, {0.0f, 1.0f, 0.0f})), 2.0f))
+                            : 0.85f;
+        Color packetColor = LerpColor(Color{110, 200, 255, 255}, Color{255, 255, 255, 255}, packet.brightness);
+        packetColor = Fade(packetColor, (1.0f - ageT) * (0.25f + packet.brightness * 0.65f) * beaming);
+        Vector3 tail = {position.x * 0.80f, position.y - packet.direction * 0.55f, position.z * 0.80f};
+        float size = packet.width * (1.0f + 0.5f * packet.brightness);
+        scene->AddStreak(tail, position, 0.5f * size, Fade(packetColor, 0.55f));
+        scene->AddGlow(position, size, packetColor, 2.0f);
+    }
+
+    TraceRing(scene, photonRingRadius, 0.0f, 120, Fade(Color{255, 230, 176, 255}, 0.55f + flare * 0.25f), 0.04f, quasar.time);
+    TraceRing(scene, photonRingRadius * 1.12f, 0.03f, 96, Fade(Color{255, 144, 76, 255}, 0.35f), 0.07f, quasar.time * 1.2f);
+    TraceRing(scene, photonRingRadius * 0.92f, -0.02f, 96, Fade(Color{196, 220, 255, 255}, 0.22f + flare * 0.15f), 0.03f,
+              quasar.time * 1.5f);
+
+    // The screen-space core glow, as two broad volumes around the nucleus.
+    scene->AddGlow({0.0f, 0.0f, 0.0f}, 3.8f + flare, Fade(Color{255, 180, 74, 255}, 0.12f + flare * 0.08f));
+    scene->AddGlow({0.0f, 0.0f, 0.0f}, 2.2f + flare * 0.6f, Fade(Color{255, 248, 220, 255}, 0.08f + flare * 0.08f));
+    scene->Build();
+}
+
+int RenderStillFrame(const astro_render::StillOptions& options, const CameraPreset& preset) {
+    SetRandomSeed(kRenderSeed);
+    QuasarState quasar;
+    ResetQuasar(&quasar);
+    for (float t = 0.0f; t < options.time; t += kRenderStep) StepQuasar(&quasar, kRenderStep);
 
     Camera3D camera{};
-    camera.position = {15.0f, 7.2f, 15.0f};
-    camera.target = {0.0f, 0.0f, 0.0f};
     camera.up = {0.0f, 1.0f, 0.0f};
     camera.fovy = 42.0f;
     camera.projection = CAMERA_PERSPECTIVE;
+    float yaw = 0.0f, pitch = 0.0f, distance = 0.0f;
+    ApplyPreset(preset, &camera, &yaw, &pitch, &distance);
+
+    astro_render::TraceScene scene;
+    BuildTraceScene(quasar, camera, &scene);
+    return astro_render::RenderStill("quasar_core_viz", scene, camera, options);
+}
 
-    std::array<CameraPreset, 4> presets = {{
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::array<CameraPreset, 4> presets = {{
         {0.82f, 0.33f, 20.0f, {0.0f, 0.0f, 0.0f}},
         {1.58f, 0.04f, 17.5f, {0.0f, 0.1f, 0.0f}},
         {0.24f, 0.64f, 24.0f, {0.0f, 0.5f, 0.0f}},
         {1.55f, 1.02f, 23.0f, {0.0f, 6.0f, 0.0f}},
     }};
 
+    const astro_render::StillOptions still = astro_render::ParseStillArgs(argc, argv, "quasar_core");
+    if (still.enabled) return RenderStillFrame(still, presets[std::clamp(still.preset, 0, 3)]);
+
+    InitWindow(kScreenWidth, kScreenHeight, "Quasar Core 3D - C++ (raylib)");
+    SetTargetFPS(60);
+
+    Camera3D camera{};
+    camera.position = {15.0f, 7.2f, 15.0f};
+    camera.target = {0.0f, 0.0f, 0.0f};
+    camera.up = {0.0f, 1.0f, 0.0f};
+    camera.fovy = 42.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+
     float camYaw = presets[0].yaw;
     float camPitch = presets[0].pitch;
     float camDistance = presets[0].distance;
 
-    float blackHoleMass = 280.0f;
-    float jetPower = 1.25f;
-    float diskThickness = 0.72f;
-    float torusOpacity = 0.65f;
-    float beamingScale = 1.45f;
     bool paused = false;
 
-    float time = 0.0f;
-    float flareTimer = 0.0f;
-    float flareStrength = 0.0f;
-    float jetSpawnAccumulator = 0.0f;
-
-    std::vector<DiskParticle> diskParticles;
-    std::vector<CoronaParticle> coronaParticles;
-    std::vector<JetPacket> jetPackets;
-    std::vector<Star> stars;
-    InitializeDisk(&diskParticles);
-    InitializeCorona(&coronaParticles);
-    InitializeStars(&stars);
-    jetPackets.reserve(540);
+    QuasarState quasar;
+    ResetQuasar(&quasar);
 
     ApplyPreset(presets[0], &camera, &camYaw, &camPitch, &camDistance);
 
@@ -314,76 +493,30 @@ int main() {
         if (IsKeyPressed(KEY_FOUR)) ApplyPreset(presets[3], &camera, &camYaw, &camPitch, &camDistance);
 
         if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_B)) beamingScale = (beamingScale > 1.46f) ? 1.0f : 2.25f;
-        if (IsKeyPressed(KEY_F)) flareTimer = 1.65f;
+        if (IsKeyPressed(KEY_B)) quasar.beamingScale = (quasar.beamingScale > 1.46f) ? 1.0f : 2.25f;
+        if (IsKeyPressed(KEY_F)) quasar.flareTimer = 1.65f;
         if (IsKeyPressed(KEY_R)) {
-            blackHoleMass = 280.0f;
-            jetPower = 1.25f;
-            diskThickness = 0.72f;
-            torusOpacity = 0.65f;
-            beamingScale = 1.45f;
             paused = false;
-            time = 0.0f;
-            flareTimer = 0.0f;
-            flareStrength = 0.0f;
-            jetSpawnAccumulator = 0.0f;
-            InitializeDisk(&diskParticles);
-            InitializeCorona(&coronaParticles);
-            InitializeStars(&stars);
-            jetPackets.clear();
+            ResetQuasar(&quasar);
             ApplyPreset(presets[0], &camera, &camYaw, &camPitch, &camDistance);
         }
 
-        if (IsKeyDown(KEY_UP)) blackHoleMass = std::min(520.0f, blackHoleMass + 110.0f * GetFrameTime());
-        if (IsKeyDown(KEY_DOWN)) blackHoleMass = std::max(120.0f, blackHoleMass - 110.0f * GetFrameTime());
-        if (IsKeyDown(KEY_RIGHT)) jetPower = std::min(3.2f, jetPower + 1.0f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT)) jetPower = std::max(0.2f, jetPower - 1.0f * GetFrameTime());
-        if (IsKeyDown(KEY_RIGHT_BRACKET)) diskThickness = std::min(1.45f, diskThickness + 0.55f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT_BRACKET)) diskThickness = std::max(0.18f, diskThickness - 0.55f * GetFrameTime());
-        if (IsKeyDown(KEY_EQUAL)) torusOpacity = std::min(1.0f, torusOpacity + 0.7f * GetFrameTime());
-        if (IsKeyDown(KEY_MINUS)) torusOpacity = std::max(0.05f, torusOpacity - 0.7f * GetFrameTime());
+        if (IsKeyDown(KEY_UP)) quasar.blackHoleMass = std::min(520.0f, quasar.blackHoleMass + 110.0f * GetFrameTime());
+        if (IsKeyDown(KEY_DOWN)) quasar.blackHoleMass = std::max(120.0f, quasar.blackHoleMass - 110.0f * GetFrameTime());
+        if (IsKeyDown(KEY_RIGHT)) quasar.jetPower = std::min(3.2f, quasar.jetPower + 1.0f * GetFrameTime());
+        if (IsKeyDown(KEY_LEFT)) quasar.jetPower = std::max(0.2f, quasar.jetPower - 1.0f * GetFrameTime());
+        if (IsKeyDown(KEY_RIGHT_BRACKET)) quasar.diskThickness = std::min(1.45f, quasar.diskThickness + 0.55f * GetFrameTime());
+        if (IsKeyDown(KEY_LEFT_BRACKET)) quasar.diskThickness = std::max(0.18f, quasar.diskThickness - 0.55f * GetFrameTime());
+        if (IsKeyDown(KEY_EQUAL)) quasar.torusOpacity = std::min(1.0f, quasar.torusOpacity + 0.7f * GetFrameTime());
+        if (IsKeyDown(KEY_MINUS)) quasar.torusOpacity = std::max(0.05f, quasar.torusOpacity - 0.7f * GetFrameTime());
 
         UpdateOrbitCamera(&camera, &camYaw, &camPitch, &camDistance);
 
-        const float dt = GetFrameTime();
-        if (!paused) {
-            time += dt;
-            flareTimer = std::max(0.0f, flareTimer - dt);
-            flareStrength = std::sin((flareTimer / 1.65f) * kPi);
-            flareStrength = std::max(flareStrength, 0.0f);
-
-            const float massSpinScale = 0.72f + blackHoleMass / 260.0f;
-            for (DiskParticle& particle : diskParticles) {
-                float innerBoost = 1.0f + (1.0f - particle.radiusBase / 8.2f) * (0.35f + flareStrength * 0.65f);
-                particle.theta += particle.omega * massSpinScale * innerBoost * dt;
-            }
-            for (CoronaParticle& particle : coronaParticles) {
-                particle.theta += particle.omega * (1.0f + flareStrength * 0.5f) * dt;
-            }
-
-            jetSpawnAccumulator += dt * (18.0f + jetPower * 22.0f + flareStrength * 18.0f);
-            while (jetSpawnAccumulator >= 1.0f) {
-                jetSpawnAccumulator -= 1.0f;
-                SpawnJetPacket(&jetPackets, 1, jetPower, flareStrength);
-                SpawnJetPacket(&jetPackets, -1, jetPower, flareStrength);
-            }
-
-            for (JetPacket& packet : jetPackets) {
-                packet.age += dt;
-                packet.axial += packet.speed * dt * (1.0f + 0.25f * jetPower);
-                packet.theta += dt * (1.0f + 0.8f * jetPower);
-                packet.radial *= 0.992f;
-            }
-            jetPackets.erase(
-                std::remove_if(jetPackets.begin(), jetPackets.end(), [](const JetPacket& packet) {
-                    return packet.age > packet.ttl || packet.axial > 24.0f;
-                }),
-                jetPackets.end());
-        }
+        if (!paused) StepQuasar(&quasar, GetFrameTime());
 
-        const float horizonRadius = 1.0f + (blackHoleMass - 120.0f) / 500.0f;
+        const float horizonRadius = 1.0f + (quasar.blackHoleMass - 120.0f) / 500.0f;
         const float photonRingRadius = horizonRadius * 1.85f;
-        const float diskGlowRadius = 7.8f + flareStrength * 0.8f;
+        const float diskGlowRadius = 7.8f + quasar.flareStrength * 0.8f;
         const Vector3 observerDirection = Vector3Normalize(Vector3Subtract(camera.position, camera.target));
 
         BeginDrawing();
@@ -392,63 +525,63 @@ int main() {
         BeginMode3D(camera);
         DrawGrid(24, 1.4f);
 
-        for (const Star& star : stars) {
+        for (const Star& star : quasar.stars) {
             DrawSphere(star.position, star.size, Fade(star.color, 0.90f));
         }
 
         for (int i = 0; i < 8; ++i) {
             float radius = 10.0f + i * 0.95f;
             float alpha = 0.07f - i * 0.006f;
-            DrawRing(radius, -0.04f * i, 84, Fade(Color{90, 130, 185, 255}, alpha), 0.04f, time * 0.2f + i);
+            DrawRing(radius, -0.04f * i, 84, Fade(Color{90, 130, 185, 255}, alpha), 0.04f, quasar.time * 0.2f + i);
         }
 
-        DrawTorus(7.9f, 1.45f + diskThickness * 0.25f, torusOpacity, time);
+        DrawTorus(7.9f, 1.45f + quasar.diskThickness * 0.25f, quasar.torusOpacity, quasar.time);
 
-        for (const DiskParticle& particle : diskParticles) {
+        for (const DiskParticle& particle : quasar.diskParticles) {
             float bandFactor = 1.0f - particle.band / 5.0f;
             float radius = particle.radiusBase +
-                           std::sin(time * (1.2f + 0.20f * particle.band) + particle.phase) * particle.radialNoise * 0.12f;
-            float y = particle.yBase * 0.22f * diskThickness +
-                      std::sin(time * 2.8f + particle.phase * 1.7f) * 0.05f * diskThickness * (0.2f + bandFactor);
+                           std::sin(quasar.time * (1.2f + 0.20f * particle.band) + particle.phase) * particle.radialNoise * 0.12f;
+            float y = particle.yBase * 0.22f * quasar.diskThickness +
+                      std::sin(quasar.time * 2.8f + particle.phase * 1.7f) * 0.05f * quasar.diskThickness * (0.2f + bandFactor);
             Vector3 position{radius * std::cos(particle.theta), y, radius * std::sin(particle.theta)};
 
             Vector3 tangent{-std::sin(particle.theta), 0.12f * y, std::cos(particle.theta)};
             tangent = Vector3Normalize(tangent);
             float viewBoost = std::clamp((Vector3DotProduct(tangent, observerDirection) + 1.0f) * 0.5f, 0.0f, 1.0f);
-            float beaming = 0.65f + std::pow(viewBoost, 1.0f + beamingScale) * (0.8f + jetPower * 0.25f);
+            float beaming = 0.65f + std::pow(viewBoost, 1.0f + quasar.beamingScale) * (0.8f + quasar.jetPower * 0.25f);
 
-            Color baseColor = DiskHeatColor(std::clamp(particle.heat + flareStrength * bandFactor * 0.20f, 0.0f, 1.0f));
+            Color baseColor = DiskHeatColor(std::clamp(particle.heat + quasar.flareStrength * bandFactor * 0.20f, 0.0f, 1.0f));
             Color drawColor = Fade(baseColor, std::clamp(particle.alpha * beaming, 0.0f, 1.0f));
 
-            float streakLength = particle.streak * (1.0f + bandFactor * 0.7f + flareStrength * bandFactor);
+            float streakLength = particle.streak * (1.0f + bandFactor * 0.7f + quasar.flareStrength * bandFactor);
             Vector3 tail = Vector3Subtract(position, Vector3Scale(tangent, streakLength));
             DrawLine3D(tail, position, Fade(drawColor, 0.55f));
-            DrawSphere(position, particle.size * (0.9f + 0.8f * bandFactor + flareStrength * 0.4f), drawColor);
+            DrawSphere(position, particle.size * (0.9f + 0.8f * bandFactor + quasar.flareStrength * 0.4f), drawColor);
         }
 
-        for (const CoronaParticle& particle : coronaParticles) {
-            float lift = particle.height + std::sin(time * 1.8f + particle.pulse) * 0.25f;
+        for (const CoronaParticle& particle : quasar.coronaParticles) {
+            float lift = particle.height + std::sin(quasar.time * 1.8f + particle.pulse) * 0.25f;
             Vector3 position{
                 particle.radius * std::cos(particle.theta),
                 lift,
                 particle.radius * std::sin(particle.theta),
             };
-            float pulse = 0.55f + 0.45f * std::sin(time * 4.0f + particle.pulse);
-            Color coronaColor = Fade(Color{185, 226, 255, 255}, 0.10f + pulse * 0.24f + flareStrength * 0.12f);
-            DrawSphere(position, particle.size * (1.0f + flareStrength * 0.8f), coronaColor);
+            float pulse = 0.55f + 0.45f * std::sin(quasar.time * 4.0f + particle.pulse);
+            Color coronaColor = Fade(Color{185, 226, 255, 255}, 0.10f + pulse * 0.24f + quasar.flareStrength * 0.12f);
+            DrawSphere(position, particle.size * (1.0f + quasar.flareStrength * 0.8f), coronaColor);
         }
 
         for (int side = -1; side <= 1; side += 2) {
-            float spineLength = 18.0f + jetPower * 4.0f;
+            float spineLength = 18.0f + quasar.jetPower * 4.0f;
             Color spineColor = (side > 0) ? Color{120, 220, 255, 120} : Color{92, 178, 250, 96};
             Color plumeColor = (side > 0) ? Color{80, 186, 255, 40} : Color{70, 160, 230, 32};
             DrawCylinderEx({0.0f, horizonRadius * side, 0.0f}, {0.0f, spineLength * side, 0.0f},
-                           0.24f + flareStrength * 0.08f, 0.08f, 16, spineColor);
-            DrawCylinderEx({0.0f, horizonRadius * side, 0.0f}, {0.0f, (10.0f + jetPower * 4.0f) * side, 0.0f},
-                           0.95f + jetPower * 0.25f, 0.22f, 20, plumeColor);
+                           0.24f + quasar.flareStrength * 0.08f, 0.08f, 16, spineColor);
+            DrawCylinderEx({0.0f, horizonRadius * side, 0.0f}, {0.0f, (10.0f + quasar.jetPower * 4.0f) * side, 0.0f},
+                           0.95f + quasar.jetPower * 0.25f, 0.22f, 20, plumeColor);
         }
 
-        for (const JetPacket& packet : jetPackets) {
+        for (const JetPacket& packet : quasar.jetPackets) {
             float travel = packet.axial;
             Vector3 position{
                 packet.radial * std::cos(packet.theta),
@@ -468,9 +601,9 @@ int main() {
 
         DrawSphere({0.0f, 0.0f, 0.0f}, horizonRadius, Color{6, 6, 8, 255});
         DrawSphereWires({0.0f, 0.0f, 0.0f}, horizonRadius * 1.08f, 18, 18, Fade(Color{90, 116, 180, 255}, 0.16f));
-        DrawRing(photonRingRadius, 0.0f, 120, Fade(Color{255, 230, 176, 255}, 0.55f + flareStrength * 0.25f), 0.04f, time);
-        DrawRing(photonRingRadius * 1.12f, 0.03f, 96, Fade(Color{255, 144, 76, 255}, 0.35f), 0.07f, time * 1.2f);
-        DrawRing(photonRingRadius * 0.92f, -0.02f, 96, Fade(Color{196, 220, 255, 255}, 0.22f + flareStrength * 0.15f), 0.03f, time * 1.5f);
+        DrawRing(photonRingRadius, 0.0f, 120, Fade(Color{255, 230, 176, 255}, 0.55f + quasar.flareStrength * 0.25f), 0.04f, quasar.time);
+        DrawRing(photonRingRadius * 1.12f, 0.03f, 96, Fade(Color{255, 144, 76, 255}, 0.35f), 0.07f, quasar.time * 1.2f);
+        DrawRing(photonRingRadius * 0.92f, -0.02f, 96, Fade(Color{196, 220, 255, 255}, 0.22f + quasar.flareStrength * 0.15f), 0.03f, quasar.time * 1.5f);
 
         EndMode3D();
 
@@ -478,12 +611,12 @@ int main() {
         if (coreScreen.x > -200.0f && coreScreen.x < static_cast<float>(GetScreenWidth()) + 200.0f &&
             coreScreen.y > -200.0f && coreScreen.y < static_cast<float>(GetScreenHeight()) + 200.0f) {
             DrawCircleGradient(static_cast<int>(coreScreen.x), static_cast<int>(coreScreen.y),
-                               220.0f + flareStrength * 65.0f,
-                               Fade(Color{255, 180, 74, 255}, 0.12f + flareStrength * 0.08f),
+                               220.0f + quasar.flareStrength * 65.0f,
+                               Fade(Color{255, 180, 74, 255}, 0.12f + quasar.flareStrength * 0.08f),
                                Fade(Color{0, 0, 0, 0}, 0.0f));
             DrawCircleGradient(static_cast<int>(coreScreen.x), static_cast<int>(coreScreen.y),
-                               130.0f + flareStrength * 38.0f,
-                               Fade(Color{255, 248, 220, 255}, 0.08f + flareStrength * 0.08f),
+                               130.0f + quasar.flareStrength * 38.0f,
+                               Fade(Color{255, 248, 220, 255}, 0.08f + quasar.flareStrength * 0.08f),
                                Fade(Color{0, 0, 0, 0}, 0.0f));
         }
 
@@ -500,7 +633,7 @@ int main() {
         char status[320];
         std::snprintf(status, sizeof(status),
                       "BH mass: %.0f\nJet power: %.2f\nDisk thickness: %.2f\nTorus opacity: %.2f\nBeaming scale: %.2f\nFlare: %.2f%s",
-                      blackHoleMass, jetPower, diskThickness, torusOpacity, beamingScale, flareStrength,
+                      quasar.blackHoleMass, quasar.jetPower, quasar.diskThickness, quasar.torusOpacity, quasar.beamingScale, quasar.flareStrength,
                       paused ? "\n[PAUSED]" : "");
         DrawText(status, GetScreenWidth() - 312, 66, 20, Color{124, 228, 255, 255});
 
@@ -517,12 +650,15 @@ int main() {
         DrawRectangle(0, GetScreenHeight() - 110, GetScreenWidth(), 110, Fade(Color{4, 4, 8, 255}, 0.16f));
         DrawCircleGradient(GetScreenWidth() / 2, GetScreenHeight() / 2,
                            diskGlowRadius * 18.0f,
-                           Fade(Color{255, 168, 92, 255}, 0.03f + flareStrength * 0.03f),
+                           Fade(Color{255, 168, 92, 255}, 0.03f + quasar.flareStrength * 0.03f),
                            Fade(Color{0, 0, 0, 0}, 0.0f));
         DrawFPS(30, GetScreenHeight() - 42);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,18 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/chebyshev_ephemeris.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/spacetime_sheet.h"
+#include "../vision/live_controls.h"
 
 #include <algorithm>
-#include <cctype>
+#include <array>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <deque>
-#include <filesystem>
-#include <fstream>
 #include <iomanip>
-#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -23,6 +25,9 @@ constexpr int kScreenHeight = 820;
 constexpr float kPi = 3.14159265358979323846f;
 constexpr float kExtent = 24.0f;
 constexpr int kGrid = 60;
+constexpr float kSheetDepth = 7.2f;
+constexpr astro_sheet::LineStyle kSheetRows = {{46, 110, 178, 70}, {54, 85, 68, 85}};
+constexpr astro_sheet::LineStyle kSheetColumns = {{40, 96, 165, 56}, {48, 80, 75, 76}};
 constexpr int kTrailMax = 280;
 constexpr std::int64_t kControlStaleMs = 1200;
 constexpr std::int64_t kPinchSequenceWindowMs = 850;
@@ -32,36 +37,16 @@ constexpr float kWarpStep = 0.05f;
 
 struct Planet {
     const char* name;
+    astro_ephem::Body body;
     float orbitRadius;
-    float orbitOmega;
     float radius;
     float warpStrength;
     float warpCore;
-    float phase0;
     Color color;
     Vector3 pos;
     std::deque<Vector3> trail;
 };
 
-struct LiveControls {
-    float zoom = 1.0f;
-    float rotationDeg = 0.0f;
-    float pitchDeg = 0.0f;
-    int nIncCount = 0;
-    int nDecCount = 0;
-    bool zoomLineActive = false;
-    std::string label = "Unknown";
-    std::string gesture = "none";
-    std::int64_t timestampMs = 0;
-};
-
-std::string Trim(std::string s) {
-    auto notSpace = [](unsigned char ch) { return !std::isspace(ch); };
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
-    s.erase(std::find_if(s.rbegin(), s.rend(), notSpace).base(), s.end());
-    return s;
-}
-
 std::int64_t UnixMsNow() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
@@ -77,66 +62,6 @@ float AngleDeltaDeg(float current, float previous) {
     return NormalizeDeg(current - previous);
 }
 
-std::optional<LiveControls> ParseLiveControlsFile(const std::filesystem::path& path) {
-    std::ifstream in(path);
-    if (!in.is_open()) return std::nullopt;
-
-    LiveControls lc;
-    std::string line;
-    while (std::getline(in, line)) {
-        const std::size_t eq = line.find('=');
-        if (eq == std::string::npos) continue;
-        const std::string key = Trim(line.substr(0, eq));
-        const std::string val = Trim(line.substr(eq + 1));
-
-        try {
-            if (key == "zoom") lc.zoom = std::stof(val);
-            else if (key == "rotation_deg") lc.rotationDeg = std::stof(val);
-            else if (key == "pitch_deg") lc.pitchDeg = std::stof(val);
-            else if (key == "n_inc_count") lc.nIncCount = std::stoi(val);
-            else if (key == "n_dec_count") lc.nDecCount = std::stoi(val);
-            else if (key == "zoom_line_active") lc.zoomLineActive = (val == "1" || val == "true" || val == "True");
-            else if (key == "label") lc.label = val;
-            else if (key == "gesture") lc.gesture = val;
-            else if (key == "timestamp_ms") lc.timestampMs = std::stoll(val);
-        } catch (...) {
-            // Ignore malformed values and keep defaults.
-        }
-    }
-
-    if (lc.timestampMs <= 0) return std::nullopt;
-    return lc;
-}
-
-std::optional<LiveControls> LoadLiveControls() {
-    static std::optional<std::filesystem::path> cachedPath;
-
-    auto tryPath = [](const std::filesystem::path& p) -> std::optional<LiveControls> {
-        if (!std::filesystem::exists(p)) return std::nullopt;
-        return ParseLiveControlsFile(p);
-    };
-
-    if (cachedPath) {
-        if (auto parsed = tryPath(*cachedPath)) return parsed;
-    }
-
-    const std::vector<std::filesystem::path> candidates = {
-        "vision/live_controls.txt",
-        "../vision/live_controls.txt",
-        "../../vision/live_controls.txt",
-        "AstroPhysics/vision/live_controls.txt",
-        std::filesystem::path(__FILE__).parent_path().parent_path() / "vision" / "live_controls.txt",
-    };
-
-    for (const auto& p : candidates) {
-        if (auto parsed = tryPath(p)) {
-            cachedPath = p;
-            return parsed;
-        }
-    }
-    return std::nullopt;
-}
-
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 delta = GetMouseDelta();
@@ -177,45 +102,16 @@ float SpacetimeHeight(float x, float z, const Vector3& sunPos, const std::vector
     for (const Planet& p : planets) {
         h += WarpContribution(x - p.pos.x, z - p.pos.z, p.warpStrength, p.warpCore);
     }
-    return std::max(-7.2f, h * scale);
+    return std::max(-kSheetDepth, h * scale);
 }
 
-void DrawSpacetimeSheet(const Vector3& sunPos, const std::vector<Planet>& planets, float scale) {
-    for (int i = 0; i < kGrid; ++i) {
-        float z = -kExtent + 2.0f * kExtent * static_cast<float>(i) / static_cast<float>(kGrid - 1);
-        for (int j = 0; j < kGrid - 1; ++j) {
-            float x0 = -kExtent + 2.0f * kExtent * static_cast<float>(j) / static_cast<float>(kGrid - 1);
-            float x1 = -kExtent + 2.0f * kExtent * static_cast<float>(j + 1) / static_cast<float>(kGrid - 1);
-            Vector3 p0 = {x0, SpacetimeHeight(x0, z, sunPos, planets, scale), z};
-            Vector3 p1 = {x1, SpacetimeHeight(x1, z, sunPos, planets, scale), z};
-            float glow = 1.0f - std::min(1.0f, std::fabs(p0.y) / 7.2f);
-            Color c = {
-                static_cast<unsigned char>(46 + 54 * glow),
-                static_cast<unsigned char>(110 + 85 * glow),
-                static_cast<unsigned char>(178 + 68 * glow),
-                static_cast<unsigned char>(70 + 85 * glow),
-            };
-            DrawLine3D(p0, p1, c);
-        }
-    }
-
-    for (int j = 0; j < kGrid; ++j) {
-        float x = -kExtent + 2.0f * kExtent * static_cast<float>(j) / static_cast<float>(kGrid - 1);
-        for (int i = 0; i < kGrid - 1; ++i) {
-            float z0 = -kExtent + 2.0f * kExtent * static_cast<float>(i) / static_cast<float>(kGrid - 1);
-            float z1 = -kExtent + 2.0f * kExtent * static_cast<float>(i + 1) / static_cast<float>(kGrid - 1);
-            Vector3 p0 = {x, SpacetimeHeight(x, z0, sunPos, planets, scale), z0};
-            Vector3 p1 = {x, SpacetimeHeight(x, z1, sunPos, planets, scale), z1};
-            float glow = 1.0f - std::min(1.0f, std::fabs(p0.y) / 7.2f);
-            Color c = {
-                static_cast<unsigned char>(40 + 48 * glow),
-                static_cast<unsigned char>(96 + 80 * glow),
-                static_cast<unsigned char>(165 + 75 * glow),
-                static_cast<unsigned char>(56 + 76 * glow),
-            };
-            DrawLine3D(p0, p1, c);
-        }
-    }
+// Same field as SpacetimeHeight(), evaluated once per grid vertex.
+void UpdateSpacetimeSheet(astro_sheet::SpacetimeSheet* sheet, const Vector3& sunPos, const std::vector<Planet>& planets,
+                          float scale) {
+    sheet->Fill(0.0f);
+    sheet->AddWell(sunPos.x, sunPos.z, 5.2f, 0.95f);
+    for (const Planet& p : planets) sheet->AddWell(p.pos.x, p.pos.z, p.warpStrength, p.warpCore);
+    sheet->ScaleClamp(scale, -kSheetDepth);
 }
 
 void DrawOrbitRing(float radius, Color c) {
@@ -253,7 +149,10 @@ std::string Hud(float simTimeYears, float speed, float warpScale, bool paused) {
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    astro_ephem::ChebyshevEphemeris ephemeris;
+    astro_ephem::OpenPlanetEphemeris(argc, argv, &ephemeris);
+
     InitWindow(kScreenWidth, kScreenHeight, "Solar System Spacetime Curvature 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -271,17 +170,21 @@ int main() {
     Vector3 sunPos = {0.0f, 0.95f, 0.0f};
 
     std::vector<Planet> planets = {
-        {"Mercury", 2.2f, 8.2f, 0.12f, 0.10f, 0.15f, 0.2f, Color{205, 190, 165, 255}},
-        {"Venus",   3.4f, 5.3f, 0.18f, 0.13f, 0.18f, 1.2f, Color{220, 180, 110, 255}},
-        {"Earth",   4.6f, 4.1f, 0.19f, 0.14f, 0.18f, 2.1f, Color{105, 165, 255, 255}},
-        {"Mars",    6.0f, 3.0f, 0.15f, 0.11f, 0.16f, 2.8f, Color{220, 110, 85, 255}},
-        {"Jupiter", 8.7f, 1.7f, 0.45f, 0.34f, 0.30f, 0.6f, Color{220, 175, 120, 255}},
-        {"Saturn",  11.8f, 1.2f, 0.40f, 0.30f, 0.28f, 1.8f, Color{220, 200, 130, 255}},
-        {"Uranus",  15.3f, 0.82f, 0.30f, 0.22f, 0.24f, 2.7f, Color{145, 220, 225, 255}},
-        {"Neptune", 18.7f, 0.64f, 0.29f, 0.22f, 0.24f, 0.9f, Color{100, 150, 255, 255}},
+        {"Mercury", astro_ephem::kBodyMercury, 2.2f, 0.12f, 0.10f, 0.15f, Color{205, 190, 165, 255}},
+        {"Venus",   astro_ephem::kBodyVenus,   3.4f, 0.18f, 0.13f, 0.18f, Color{220, 180, 110, 255}},
+        {"Earth",   astro_ephem::kBodyEarth,   4.6f, 0.19f, 0.14f, 0.18f, Color{105, 165, 255, 255}},
+        {"Mars",    astro_ephem::kBodyMars,    6.0f, 0.15f, 0.11f, 0.16f, Color{220, 110, 85, 255}},
+        {"Jupiter", astro_ephem::kBodyJupiter, 8.7f, 0.45f, 0.34f, 0.30f, Color{220, 175, 120, 255}},
+        {"Saturn",  astro_ephem::kBodySaturn,  11.8f, 0.40f, 0.30f, 0.28f, Color{220, 200, 130, 255}},
+        {"Uranus",  astro_ephem::kBodyUranus,  15.3f, 0.30f, 0.22f, 0.24f, Color{145, 220, 225, 255}},
+        {"Neptune", astro_ephem::kBodyNeptune, 18.7f, 0.29f, 0.22f, 0.24f, Color{100, 150, 255, 255}},
     };
 
+    astro_sheet::SpacetimeSheet sheet;
+    sheet.Configure(kGrid, kExtent);
+
     float simTimeYears = 0.0f;
+    std::array<astro_ephem::Vec3d, astro_ephem::kBodyCount> planetAu{};
     float speed = 1.0f;
     float warpScale = 1.0f;
     bool paused = false;
@@ -299,6 +202,9 @@ int main() {
     std::int64_t rightPendingDeadlineMs = 0;
     std::int64_t leftPendingDeadlineMs = 0;
     std::int64_t zoomPinchSuppressUntilMs = 0;
+    astro_hand::LiveControlsWatcher liveControls;
+    liveControls.Start();
+    liveControls.ListenUdp();
     std::string bridgeStatus = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
 
     while (!WindowShouldClose()) {
@@ -321,7 +227,8 @@ int main() {
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
         const std::int64_t nowMs = UnixMsNow();
-        if (auto live = LoadLiveControls()) {
+        liveControls.Poll(GetTime());
+        if (const auto& live = liveControls.Latest()) {
             const std::int64_t ageMs = nowMs - live->timestampMs;
             if (ageMs <= kControlStaleMs) {
                 if (!hasPrevLive) {
@@ -412,9 +319,12 @@ int main() {
         float dtYears = GetFrameTime() * speed * 0.38f;
         if (!paused) simTimeYears += dtYears;
 
+        // True heliocentric longitudes (years from J2000) at the scene's ring radii.
+        ephemeris.Positions(astro_ephem::kJ2000 + simTimeYears * 365.25, &planetAu);
         for (Planet& p : planets) {
-            float ang = p.phase0 + simTimeYears * p.orbitOmega;
-            p.pos = {p.orbitRadius * std::cos(ang), 0.26f, p.orbitRadius * std::sin(ang)};
+            const astro_ephem::Vec3d& au = planetAu[p.body];
+            const float scale = p.orbitRadius / static_cast<float>(std::hypot(au.x, au.y));
+            p.pos = {static_cast<float>(au.x) * scale, 0.26f, static_cast<float>(au.y) * scale};
             p.trail.push_back(p.pos);
             if (static_cast<int>(p.trail.size()) > kTrailMax) p.trail.pop_front();
         }
@@ -424,7 +334,8 @@ int main() {
 
         BeginMode3D(camera);
 
-        DrawSpacetimeSheet(sunPos, planets, warpScale);
+        UpdateSpacetimeSheet(&sheet, sunPos, planets, warpScale);
+        sheet.Draw(kSheetRows, kSheetColumns, kSheetDepth);
 
         for (const Planet& p : planets) {
             DrawOrbitRing(p.orbitRadius, Color{120, 145, 190, 40});
@@ -466,9 +377,12 @@ int main() {
         DrawText(bridgeStatus.c_str(), 20, 108, 19, Color{152, 234, 198, 255});
         DrawFPS(20, 136);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,16 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/spacetime_sheet.h"
+#include "../vision/live_controls.h"
 
 #include <algorithm>
-#include <cctype>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <deque>
-#include <filesystem>
-#include <fstream>
 #include <iomanip>
-#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -26,6 +26,11 @@ constexpr std::int64_t kPinchSequenceWindowMs = 850;
 constexpr std::int64_t kZoomPinchSuppressMs = 260;
 constexpr float kSpeedStep = 0.25f;
 constexpr float kWarpStep = 0.05f;
+constexpr int kSheetGrid = 54;
+constexpr float kSheetExtent = 11.0f;
+constexpr float kSheetDepth = 4.6f;
+constexpr astro_sheet::LineStyle kSheetRows = {{50, 110, 185, 120}, {60, 80, 50, 80}};
+constexpr astro_sheet::LineStyle kSheetColumns = {{45, 100, 170, 95}, {55, 85, 65, 65}};
 
 struct SimState {
     float angle;
@@ -35,25 +40,6 @@ struct SimState {
     float sheetScale;
 };
 
-struct LiveControls {
-    float zoom = 1.0f;
-    float rotationDeg = 0.0f;
-    float pitchDeg = 0.0f;
-    int nIncCount = 0;
-    int nDecCount = 0;
-    bool zoomLineActive = false;
-    std::string label = "Unknown";
-    std::string gesture = "none";
-    std::int64_t timestampMs = 0;
-};
-
-std::string Trim(std::string s) {
-    auto notSpace = [](unsigned char ch) { return !std::isspace(ch); };
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
-    s.erase(std::find_if(s.rbegin(), s.rend(), notSpace).base(), s.end());
-    return s;
-}
-
 std::int64_t UnixMsNow() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
@@ -69,66 +55,6 @@ float AngleDeltaDeg(float current, float previous) {
     return NormalizeDeg(current - previous);
 }
 
-std::optional<LiveControls> ParseLiveControlsFile(const std::filesystem::path& path) {
-    std::ifstream in(path);
-    if (!in.is_open()) return std::nullopt;
-
-    LiveControls lc;
-    std::string line;
-    while (std::getline(in, line)) {
-        const std::size_t eq = line.find('=');
-        if (eq == std::string::npos) continue;
-        const std::string key = Trim(line.substr(0, eq));
-        const std::string val = Trim(line.substr(eq + 1));
-
-        try {
-            if (key == "zoom") lc.zoom = std::stof(val);
-            else if (key == "rotation_deg") lc.rotationDeg = std::stof(val);
-            else if (key == "pitch_deg") lc.pitchDeg = std::stof(val);
-            else if (key == "n_inc_count") lc.nIncCount = std::stoi(val);
-            else if (key == "n_dec_count") lc.nDecCount = std::stoi(val);
-            else if (key == "zoom_line_active") lc.zoomLineActive = (val == "1" || val == "true" || val == "True");
-            else if (key == "label") lc.label = val;
-            else if (key == "gesture") lc.gesture = val;
-            else if (key == "timestamp_ms") lc.timestampMs = std::stoll(val);
-        } catch (...) {
-            // Ignore malformed values and keep defaults.
-        }
-    }
-
-    if (lc.timestampMs <= 0) return std::nullopt;
-    return lc;
-}
-
-std::optional<LiveControls> LoadLiveControls() {
-    static std::optional<std::filesystem::path> cachedPath;
-
-    auto tryPath = [](const std::filesystem::path& p) -> std::optional<LiveControls> {
-        if (!std::filesystem::exists(p)) return std::nullopt;
-        return ParseLiveControlsFile(p);
-    };
-
-    if (cachedPath) {
-        if (auto parsed = tryPath(*cachedPath)) return parsed;
-    }
-
-    const std::vector<std::filesystem::path> candidates = {
-        "vision/live_controls.txt",
-        "../vision/live_controls.txt",
-        "../../vision/live_controls.txt",
-        "AstroPhysics/vision/live_controls.txt",
-        std::filesystem::path(__FILE__).parent_path().parent_path() / "vision" / "live_controls.txt",
-    };
-
-    for (const auto& p : candidates) {
-        if (auto parsed = tryPath(p)) {
-            cachedPath = p;
-            return parsed;
-        }
-    }
-    return std::nullopt;
-}
-
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 delta = GetMouseDelta();
@@ -168,48 +94,15 @@ float SpacetimeHeight(float x, float z, Vector3 sunPos, Vector3 planetPos, float
     float sunWell = WarpContribution(x - sunPos.x, z - sunPos.z, 2.3f, 0.55f);
     float planetWell = WarpContribution(x - planetPos.x, z - planetPos.z, 0.8f, 0.28f);
     float h = (sunWell + planetWell) * sheetScale;
-    return std::max(-4.6f, h);
+    return std::max(-kSheetDepth, h);
 }
 
-void DrawSpacetimeSheet(Vector3 sunPos, Vector3 planetPos, float sheetScale) {
-    constexpr int kGrid = 54;
-    constexpr float kExtent = 11.0f;
-
-    for (int i = 0; i < kGrid; ++i) {
-        float z = -kExtent + 2.0f * kExtent * static_cast<float>(i) / static_cast<float>(kGrid - 1);
-        for (int j = 0; j < kGrid - 1; ++j) {
-            float x0 = -kExtent + 2.0f * kExtent * static_cast<float>(j) / static_cast<float>(kGrid - 1);
-            float x1 = -kExtent + 2.0f * kExtent * static_cast<float>(j + 1) / static_cast<float>(kGrid - 1);
-            Vector3 p0 = {x0, SpacetimeHeight(x0, z, sunPos, planetPos, sheetScale), z};
-            Vector3 p1 = {x1, SpacetimeHeight(x1, z, sunPos, planetPos, sheetScale), z};
-            float glow = 1.0f - std::min(1.0f, std::fabs(p0.y) / 4.6f);
-            Color c = {
-                static_cast<unsigned char>(50 + 60 * glow),
-                static_cast<unsigned char>(110 + 80 * glow),
-                static_cast<unsigned char>(185 + 50 * glow),
-                static_cast<unsigned char>(120 + 80 * glow),
-            };
-            DrawLine3D(p0, p1, c);
-        }
-    }
-
-    for (int j = 0; j < kGrid; ++j) {
-        float x = -kExtent + 2.0f * kExtent * static_cast<float>(j) / static_cast<float>(kGrid - 1);
-        for (int i = 0; i < kGrid - 1; ++i) {
-            float z0 = -kExtent + 2.0f * kExtent * static_cast<float>(i) / static_cast<float>(kGrid - 1);
-            float z1 = -kExtent + 2.0f * kExtent * static_cast<float>(i + 1) / static_cast<float>(kGrid - 1);
-            Vector3 p0 = {x, SpacetimeHeight(x, z0, sunPos, planetPos, sheetScale), z0};
-            Vector3 p1 = {x, SpacetimeHeight(x, z1, sunPos, planetPos, sheetScale), z1};
-            float glow = 1.0f - std::min(1.0f, std::fabs(p0.y) / 4.6f);
-            Color c = {
-                static_cast<unsigned char>(45 + 55 * glow),
-                static_cast<unsigned char>(100 + 85 * glow),
-                static_cast<unsigned char>(170 + 65 * glow),
-                static_cast<unsigned char>(95 + 65 * glow),
-            };
-            DrawLine3D(p0, p1, c);
-        }
-    }
+// Same field as SpacetimeHeight(), evaluated once per grid vertex.
+void UpdateSpacetimeSheet(astro_sheet::SpacetimeSheet* sheet, Vector3 sunPos, Vector3 planetPos, float sheetScale) {
+    sheet->Fill(0.0f);
+    sheet->AddWell(sunPos.x, sunPos.z, 2.3f, 0.55f);
+    sheet->AddWell(planetPos.x, planetPos.z, 0.8f, 0.28f);
+    sheet->ScaleClamp(sheetScale, -kSheetDepth);
 }
 
 void DrawOrbitTrail(const std::deque<Vector3>& trail) {
@@ -262,6 +155,8 @@ int main() {
     constexpr int kTrailMax = 900;
 
     std::deque<Vector3> trail;
+    astro_sheet::SpacetimeSheet sheet;
+    sheet.Configure(kSheetGrid, kSheetExtent);
     bool hasPrevLive = false;
     float prevLiveZoom = 1.0f;
     float prevLiveRotDeg = 0.0f;
@@ -273,6 +168,9 @@ int main() {
     std::int64_t rightPendingDeadlineMs = 0;
     std::int64_t leftPendingDeadlineMs = 0;
     std::int64_t zoomPinchSuppressUntilMs = 0;
+    astro_hand::LiveControlsWatcher liveControls;
+    liveControls.Start();
+    liveControls.ListenUdp();
     std::string bridgeStatus = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
 
     while (!WindowShouldClose()) {
@@ -292,7 +190,8 @@ int main() {
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
         const std::int64_t nowMs = UnixMsNow();
-        if (auto live = LoadLiveControls()) {
+        liveControls.Poll(GetTime());
+        if (const auto& live = liveControls.Latest()) {
             const std::int64_t ageMs = nowMs - live->timestampMs;
             if (ageMs <= kControlStaleMs) {
                 if (!hasPrevLive) {
@@ -403,7 +302,8 @@ int main() {
 
         BeginMode3D(camera);
 
-        DrawSpacetimeSheet(sunPos, planetPos, sim.sheetScale);
+        UpdateSpacetimeSheet(&sheet, sunPos, planetPos, sim.sheetScale);
+        sheet.Draw(kSheetRows, kSheetColumns, kSheetDepth);
         DrawOrbitTrail(trail);
 
         DrawLine3D({sunPos.x, sunSheetY, sunPos.z}, sunPos, Color{255, 195, 115, 120});
@@ -436,9 +336,12 @@ int main() {
         DrawText(bridgeStatus.c_str(), 20, 134, 19, Color{152, 234, 198, 255});
         DrawFPS(20, 160);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,13 +1,28 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/integrators.h"
+#include "../common/lod.h"
+#include "../common/particle_soa.h"
+#include "../common/profiler.h"
+#include "../common/sim_thread.h"
+#include "../common/starfield.h"
+#include "../common/thread_pool.h"
+#include "../common/trail_buffer.h"
+
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
-#include <deque>
+#include <mutex>
 #include <random>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -19,8 +34,22 @@ constexpr float kG = 14.0f;
 constexpr float kSoftening = 0.18f;
 constexpr int kTrailMax = 1800;
 constexpr float kFixedStep = 1.0f / 240.0f;
+constexpr float kSimRate = 240.0f;         // simulation thread steps per simulated second
+constexpr float kSimTrailStride = 4.0f;    // steps between trail points at kSimRate
 constexpr float kPi = 3.14159265358979323846f;
 
+// Finite-time Lyapunov map over perturbed copies of the active preset.
+constexpr int kFtleSide = 64;
+constexpr int kFtleTile = 32;           // lanes integrated together by one pool task
+constexpr int kFtleRenormSteps = 60;    // kFixedStep steps between renormalisations
+constexpr float kFtleHorizon = 40.0f;
+constexpr double kFtleSeparation = 1e-9;
+constexpr float kFtleOffsetSpan = 0.6f;  // last body's x offset across the map
+constexpr float kFtleSpeedSpan = 0.10f;  // last body's speed scale up the map
+constexpr float kFtlePanelSize = 300.0f;
+
+using Trail = astro_render::TrailBuffer<kTrailMax>;
+
 struct Body {
     const char* name;
     float mass;
@@ -37,14 +66,13 @@ struct Preset {
     const char* description;
 };
 
-struct Derivative {
-    std::array<Vector3, 3> dPos{};
-    std::array<Vector3, 3> dVel{};
-};
+// Positions then velocities, three floats per body, for the Runge-Kutta integrators.
+using FlatState = std::array<float, 18>;
 
-struct State {
-    std::array<Vector3, 3> pos{};
-    std::array<Vector3, 3> vel{};
+struct Integration {
+    astro_integrate::Method method = astro_integrate::Method::DormandPrince45;
+    astro_integrate::AdaptiveStepper adaptive;
+    int lastSteps = 0;
 };
 
 Vector3 ComputeAcceleration(
@@ -66,51 +94,59 @@ Vector3 ComputeAcceleration(
     return acc;
 }
 
-Derivative EvaluateDerivative(const State& state, const std::array<float, 3>& masses) {
-    Derivative deriv{};
+FlatState PackState(const std::array<Body, 3>& bodies) {
+    FlatState y{};
     for (int i = 0; i < 3; ++i) {
-        deriv.dPos[i] = state.vel[i];
-        deriv.dVel[i] = ComputeAcceleration(state.pos, masses, i);
+        y[3 * i + 0] = bodies[i].pos.x;
+        y[3 * i + 1] = bodies[i].pos.y;
+        y[3 * i + 2] = bodies[i].pos.z;
+        y[9 + 3 * i + 0] = bodies[i].vel.x;
+        y[9 + 3 * i + 1] = bodies[i].vel.y;
+        y[9 + 3 * i + 2] = bodies[i].vel.z;
     }
-    return deriv;
+    return y;
 }
 
-State AdvanceState(const State& state, const Derivative& deriv, float dt) {
-    State next = state;
+void UnpackState(const FlatState& y, std::array<Body, 3>* bodies) {
     for (int i = 0; i < 3; ++i) {
-        next.pos[i] = Vector3Add(state.pos[i], Vector3Scale(deriv.dPos[i], dt));
-        next.vel[i] = Vector3Add(state.vel[i], Vector3Scale(deriv.dVel[i], dt));
+        (*bodies)[i].pos = {y[3 * i + 0], y[3 * i + 1], y[3 * i + 2]};
+        (*bodies)[i].vel = {y[9 + 3 * i + 0], y[9 + 3 * i + 1], y[9 + 3 * i + 2]};
     }
-    return next;
 }
 
-void StepRK4(std::array<Body, 3>* bodies, float dt) {
-    State start{};
-    std::array<float, 3> masses{};
+void EvaluateDerivative(const FlatState& y, const std::array<float, 3>& masses, FlatState& dydt) {
+    const std::array<Vector3, 3> positions = {
+        Vector3{y[0], y[1], y[2]},
+        Vector3{y[3], y[4], y[5]},
+        Vector3{y[6], y[7], y[8]},
+    };
     for (int i = 0; i < 3; ++i) {
-        start.pos[i] = (*bodies)[i].pos;
-        start.vel[i] = (*bodies)[i].vel;
-        masses[i] = (*bodies)[i].mass;
+        const Vector3 acc = ComputeAcceleration(positions, masses, i);
+        dydt[3 * i + 0] = y[9 + 3 * i + 0];
+        dydt[3 * i + 1] = y[9 + 3 * i + 1];
+        dydt[3 * i + 2] = y[9 + 3 * i + 2];
+        dydt[9 + 3 * i + 0] = acc.x;
+        dydt[9 + 3 * i + 1] = acc.y;
+        dydt[9 + 3 * i + 2] = acc.z;
     }
+}
 
-    const Derivative k1 = EvaluateDerivative(start, masses);
-    const Derivative k2 = EvaluateDerivative(AdvanceState(start, k1, dt * 0.5f), masses);
-    const Derivative k3 = EvaluateDerivative(AdvanceState(start, k2, dt * 0.5f), masses);
-    const Derivative k4 = EvaluateDerivative(AdvanceState(start, k3, dt), masses);
-
-    for (int i = 0; i < 3; ++i) {
-        Vector3 posDelta = Vector3Add(k1.dPos[i], Vector3Scale(k2.dPos[i], 2.0f));
-        posDelta = Vector3Add(posDelta, Vector3Scale(k3.dPos[i], 2.0f));
-        posDelta = Vector3Add(posDelta, k4.dPos[i]);
+// Drift/kick view of the bodies for the symplectic integrators.
+struct BodySystem {
+    std::array<Body, 3>* bodies;
+    std::array<float, 3> masses;
 
-        Vector3 velDelta = Vector3Add(k1.dVel[i], Vector3Scale(k2.dVel[i], 2.0f));
-        velDelta = Vector3Add(velDelta, Vector3Scale(k3.dVel[i], 2.0f));
-        velDelta = Vector3Add(velDelta, k4.dVel[i]);
+    void Drift(float h) {
+        for (Body& body : *bodies) body.pos = Vector3Add(body.pos, Vector3Scale(body.vel, h));
+    }
 
-        (*bodies)[i].pos = Vector3Add((*bodies)[i].pos, Vector3Scale(posDelta, dt / 6.0f));
-        (*bodies)[i].vel = Vector3Add((*bodies)[i].vel, Vector3Scale(velDelta, dt / 6.0f));
+    void Kick(float h) {
+        const std::array<Vector3, 3> positions = {(*bodies)[0].pos, (*bodies)[1].pos, (*bodies)[2].pos};
+        for (int i = 0; i < 3; ++i) {
+            (*bodies)[i].vel = Vector3Add((*bodies)[i].vel, Vector3Scale(ComputeAcceleration(positions, masses, i), h));
+        }
     }
-}
+};
 
 float TotalMass(const std::array<Body, 3>& bodies) {
     return bodies[0].mass + bodies[1].mass + bodies[2].mass;
@@ -225,48 +261,479 @@ std::array<Preset, 3> BuildPresets() {
 
 void AppendTrails(
     const std::array<Body, 3>& bodies,
-    std::array<std::deque<Vector3>, 3>* trails
+    std::array<Trail, 3>* trails
 ) {
     for (int i = 0; i < 3; ++i) {
-        (*trails)[i].push_back(bodies[i].pos);
-        if (static_cast<int>((*trails)[i].size()) > kTrailMax) {
-            (*trails)[i].pop_front();
-        }
+        (*trails)[i].Push(bodies[i].pos);
     }
 }
 
 void ResetSimulation(
     const Preset& preset,
+    Integration* integration,
     std::array<Body, 3>* bodies,
-    std::array<std::deque<Vector3>, 3>* trails,
+    std::array<Trail, 3>* trails,
     float* simTime
 ) {
     *bodies = preset.bodies;
-    for (std::deque<Vector3>& trail : *trails) {
-        trail.clear();
+    integration->adaptive.step = 0.0f;
+    for (Trail& trail : *trails) {
+        trail.Clear();
     }
     AppendTrails(*bodies, trails);
     *simTime = 0.0f;
 }
 
-void DrawTrail(const std::deque<Vector3>& trail, Color color) {
-    if (trail.size() < 2) {
-        return;
+// Integrates `advance` seconds: fixed kFixedStep substeps for RK4 and the symplectic
+// methods, error-controlled steps for Dormand-Prince.
+void Advance(float advance, Integration* integration, std::array<Body, 3>* bodies, float* simTime) {
+    const std::array<float, 3> masses = {(*bodies)[0].mass, (*bodies)[1].mass, (*bodies)[2].mass};
+    const auto derivative = [&masses](const FlatState& y, FlatState& dydt) { EvaluateDerivative(y, masses, dydt); };
+
+    if (integration->method == astro_integrate::Method::DormandPrince45) {
+        FlatState y = PackState(*bodies);
+        *simTime += astro_integrate::DormandPrince45Advance(y, advance, derivative, integration->adaptive);
+        UnpackState(y, bodies);
+        integration->lastSteps = integration->adaptive.lastAccepted;
+    } else {
+        int steps = std::max(1, static_cast<int>(std::ceil(advance / kFixedStep)));
+        float dt = advance / static_cast<float>(steps);
+        if (integration->method == astro_integrate::Method::Rk4) {
+            FlatState y = PackState(*bodies);
+            for (int i = 0; i < steps; ++i) astro_integrate::Rk4Step(y, dt, derivative);
+            UnpackState(y, bodies);
+        } else {
+            BodySystem system{bodies, masses};
+            for (int i = 0; i < steps; ++i) astro_integrate::SymplecticStep(integration->method, system, dt);
+        }
+        *simTime += dt * static_cast<float>(steps);
+        integration->lastSteps = steps;
+    }
+}
+
+// One rendered frame worth of time plus its trail point, as the headless bench runs it.
+void AdvanceFrame(
+    float frameAdvance,
+    Integration* integration,
+    std::array<Body, 3>* bodies,
+    std::array<Trail, 3>* trails,
+    float* simTime
+) {
+    Advance(frameAdvance, integration, bodies, simTime);
+    AppendTrails(*bodies, trails);
+}
+
+// ---- Simulation thread --------------------------------------------------------------
+// The window steps the bodies on an astro_sim::SimThread at --sim-hz (kSimRate by
+// default) and draws between the two newest snapshots, so the orbit is as smooth at
+// 144 Hz as at 60 and the integration step does not follow the frame time. Trails take
+// a point every kSimTrailStride steps at the default rate, so their length is measured
+// in simulated time rather than in frames.
+
+struct SimState {
+    Integration integration;
+    std::array<Body, 3> bodies{};
+    std::array<Trail, 3> trails;
+    float simTime = 0.0f;
+    float sinceTrail = 0.0f;
+};
+
+struct SimSnapshot {
+    std::array<Body, 3> bodies{};
+    std::array<Trail, 3> trails;
+    float simTime = 0.0f;
+    astro_integrate::Method method = astro_integrate::Method::DormandPrince45;
+    int lastSteps = 0;
+};
+
+void StepSimState(SimState& state, float dt) {
+    Advance(dt, &state.integration, &state.bodies, &state.simTime);
+    state.sinceTrail += dt;
+    if (state.sinceTrail + 0.5f * dt >= kSimTrailStride / kSimRate) {
+        state.sinceTrail = 0.0f;
+        AppendTrails(state.bodies, &state.trails);
+    }
+}
+
+void PublishSimState(const SimState& state, SimSnapshot& out) {
+    out.bodies = state.bodies;
+    out.trails = state.trails;
+    out.simTime = state.simTime;
+    out.method = state.integration.method;
+    out.lastSteps = state.integration.lastSteps;
+}
+
+void ResetSimState(const Preset& preset, SimState& state) {
+    ResetSimulation(preset, &state.integration, &state.bodies, &state.trails, &state.simTime);
+    state.sinceTrail = 0.0f;
+}
+
+std::array<Body, 3> BlendBodies(const SimSnapshot& from, const SimSnapshot& to, float alpha) {
+    std::array<Body, 3> bodies = to.bodies;
+    for (int i = 0; i < 3; ++i) {
+        bodies[i].pos = Vector3Lerp(from.bodies[i].pos, to.bodies[i].pos, alpha);
+        bodies[i].vel = Vector3Lerp(from.bodies[i].vel, to.bodies[i].vel, alpha);
+    }
+    return bodies;
+}
+
+// ---- Finite-time Lyapunov map -----------------------------------------------------
+// Each cell of a kFtleSide^2 grid perturbs the preset's last body (x offset across,
+// speed scale up the grid) and integrates it together with a shadow copy separated
+// by kFtleSeparation in phase space. Every kFtleRenormSteps steps the separation is
+// measured, its log growth accumulated and the shadow pulled back (Benettin et al.),
+// so the map holds log-growth / t, the finite-time largest Lyapunov exponent.
+//
+// Copies are stored as 18 structure-of-arrays lanes (the FlatState layout) in double:
+// the 1e-9 separation would be lost in float rounding of positions around 5.
+
+constexpr int kFtleSize = 18;
+using FtleLanes = std::array<std::vector<double>, kFtleSize>;
+
+struct FtleGrid {
+    int side = 0;
+    int steps = 0;
+    std::array<double, 3> masses{};
+    FtleLanes reference;
+    FtleLanes shadow;
+    std::vector<double> logGrowth;
+
+    float time() const { return static_cast<float>(steps) * kFixedStep; }
+    bool done() const { return time() >= kFtleHorizon - 0.5f * kFixedStep; }
+    int cells() const { return side * side; }
+};
+
+void ResetFtleGrid(const Preset& preset, int side, FtleGrid* grid) {
+    grid->side = side;
+    grid->steps = 0;
+    const size_t cells = static_cast<size_t>(side) * side;
+    for (int c = 0; c < kFtleSize; ++c) {
+        grid->reference[c].assign(cells, 0.0);
+        grid->shadow[c].assign(cells, 0.0);
+    }
+    grid->logGrowth.assign(cells, 0.0);
+    for (int i = 0; i < 3; ++i) grid->masses[i] = preset.bodies[i].mass;
+
+    // Fixed unit direction for the initial separation.
+    const double offset = kFtleSeparation / std::sqrt(static_cast<double>(kFtleSize));
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            std::array<Body, 3> bodies = preset.bodies;
+            bodies[2].pos.x += kFtleOffsetSpan * (2.0f * (x + 0.5f) / side - 1.0f);
+            bodies[2].vel = Vector3Scale(bodies[2].vel, 1.0f + kFtleSpeedSpan * (1.0f - 2.0f * (y + 0.5f) / side));
+            const FlatState state = PackState(bodies);
+            const size_t cell = static_cast<size_t>(y) * side + x;
+            for (int c = 0; c < kFtleSize; ++c) {
+                grid->reference[c][cell] = state[c];
+                grid->shadow[c][cell] = state[c] + offset;
+            }
+        }
+    }
+}
+
+// EvaluateDerivative over `count` lanes of a tile; component c of lane l is y[c][l].
+void FtleDerivativeTile(const double (&y)[kFtleSize][kFtleTile], const std::array<double, 3>& masses, int count,
+                        double (&dydt)[kFtleSize][kFtleTile]) {
+    constexpr double kEps2 = static_cast<double>(kSoftening) * kSoftening;
+    for (int c = 0; c < 9; ++c) {
+        for (int l = 0; l < count; ++l) {
+            dydt[c][l] = y[9 + c][l];
+            dydt[9 + c][l] = 0.0;
+        }
+    }
+    constexpr int kPairs[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+    for (const auto& pair : kPairs) {
+        const int i = pair[0];
+        const int j = pair[1];
+        const double gi = kG * masses[i];
+        const double gj = kG * masses[j];
+        double* ax = dydt[9 + 3 * i + 0];
+        double* ay = dydt[9 + 3 * i + 1];
+        double* az = dydt[9 + 3 * i + 2];
+        double* bx = dydt[9 + 3 * j + 0];
+        double* by = dydt[9 + 3 * j + 1];
+        double* bz = dydt[9 + 3 * j + 2];
+        int l = 0;
+
+        // The libm sqrt keeps this loop scalar (errno), hence the explicit paths.
+#if defined(ASTRO_SOA_AVX2)
+        const __m256d eps2 = _mm256_set1_pd(kEps2);
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d vgi = _mm256_set1_pd(gi);
+        const __m256d vgj = _mm256_set1_pd(gj);
+        for (; l + 4 <= count; l += 4) {
+            const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(y[3 * j + 0] + l), _mm256_loadu_pd(y[3 * i + 0] + l));
+            const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y[3 * j + 1] + l), _mm256_loadu_pd(y[3 * i + 1] + l));
+            const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(y[3 * j + 2] + l), _mm256_loadu_pd(y[3 * i + 2] + l));
+            const __m256d r2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)),
+                                             _mm256_add_pd(_mm256_mul_pd(dz, dz), eps2));
+            const __m256d inv3 = _mm256_div_pd(one, _mm256_mul_pd(r2, _mm256_sqrt_pd(r2)));
+            const __m256d si = _mm256_mul_pd(vgj, inv3);
+            const __m256d sj = _mm256_mul_pd(vgi, inv3);
+            _mm256_storeu_pd(ax + l, _mm256_add_pd(_mm256_loadu_pd(ax + l), _mm256_mul_pd(si, dx)));
+            _mm256_storeu_pd(ay + l, _mm256_add_pd(_mm256_loadu_pd(ay + l), _mm256_mul_pd(si, dy)));
+            _mm256_storeu_pd(az + l, _mm256_add_pd(_mm256_loadu_pd(az + l), _mm256_mul_pd(si, dz)));
+            _mm256_storeu_pd(bx + l, _mm256_sub_pd(_mm256_loadu_pd(bx + l), _mm256_mul_pd(sj, dx)));
+            _mm256_storeu_pd(by + l, _mm256_sub_pd(_mm256_loadu_pd(by + l), _mm256_mul_pd(sj, dy)));
+            _mm256_storeu_pd(bz + l, _mm256_sub_pd(_mm256_loadu_pd(bz + l), _mm256_mul_pd(sj, dz)));
+        }
+#elif defined(ASTRO_SOA_NEON)
+        const float64x2_t eps2 = vdupq_n_f64(kEps2);
+        const float64x2_t one = vdupq_n_f64(1.0);
+        const float64x2_t vgi = vdupq_n_f64(gi);
+        const float64x2_t vgj = vdupq_n_f64(gj);
+        for (; l + 2 <= count; l += 2) {
+            const float64x2_t dx = vsubq_f64(vld1q_f64(y[3 * j + 0] + l), vld1q_f64(y[3 * i + 0] + l));
+            const float64x2_t dy = vsubq_f64(vld1q_f64(y[3 * j + 1] + l), vld1q_f64(y[3 * i + 1] + l));
+            const float64x2_t dz = vsubq_f64(vld1q_f64(y[3 * j + 2] + l), vld1q_f64(y[3 * i + 2] + l));
+            const float64x2_t r2 = vfmaq_f64(vfmaq_f64(vfmaq_f64(eps2, dx, dx), dy, dy), dz, dz);
+            const float64x2_t inv3 = vdivq_f64(one, vmulq_f64(r2, vsqrtq_f64(r2)));
+            const float64x2_t si = vmulq_f64(vgj, inv3);
+            const float64x2_t sj = vmulq_f64(vgi, inv3);
+            vst1q_f64(ax + l, vfmaq_f64(vld1q_f64(ax + l), si, dx));
+            vst1q_f64(ay + l, vfmaq_f64(vld1q_f64(ay + l), si, dy));
+            vst1q_f64(az + l, vfmaq_f64(vld1q_f64(az + l), si, dz));
+            vst1q_f64(bx + l, vfmsq_f64(vld1q_f64(bx + l), sj, dx));
+            vst1q_f64(by + l, vfmsq_f64(vld1q_f64(by + l), sj, dy));
+            vst1q_f64(bz + l, vfmsq_f64(vld1q_f64(bz + l), sj, dz));
+        }
+#endif
+
+        for (; l < count; ++l) {
+            const double dx = y[3 * j + 0][l] - y[3 * i + 0][l];
+            const double dy = y[3 * j + 1][l] - y[3 * i + 1][l];
+            const double dz = y[3 * j + 2][l] - y[3 * i + 2][l];
+            const double r2 = dx * dx + dy * dy + dz * dz + kEps2;
+            const double inv3 = 1.0 / (r2 * std::sqrt(r2));
+            ax[l] += gj * inv3 * dx;
+            ay[l] += gj * inv3 * dy;
+            az[l] += gj * inv3 * dz;
+            bx[l] -= gi * inv3 * dx;
+            by[l] -= gi * inv3 * dy;
+            bz[l] -= gi * inv3 * dz;
+        }
+    }
+}
+
+// astro_integrate::Rk4Step applied lane-wise to cells [begin, begin + count).
+void FtleRk4Tile(FtleLanes* lanes, const std::array<double, 3>& masses, size_t begin, int count, double h) {
+    double y0[kFtleSize][kFtleTile];
+    double tmp[kFtleSize][kFtleTile];
+    double k[kFtleSize][kFtleTile];
+    double sum[kFtleSize][kFtleTile];
+    for (int c = 0; c < kFtleSize; ++c) {
+        const double* src = (*lanes)[c].data() + begin;
+        for (int l = 0; l < count; ++l) y0[c][l] = src[l];
+    }
+
+    FtleDerivativeTile(y0, masses, count, k);
+    for (int c = 0; c < kFtleSize; ++c) {
+        for (int l = 0; l < count; ++l) {
+            sum[c][l] = k[c][l];
+            tmp[c][l] = y0[c][l] + 0.5 * h * k[c][l];
+        }
+    }
+    FtleDerivativeTile(tmp, masses, count, k);
+    for (int c = 0; c < kFtleSize; ++c) {
+        for (int l = 0; l < count; ++l) {
+            sum[c][l] += 2.0 * k[c][l];
+            tmp[c][l] = y0[c][l] + 0.5 * h * k[c][l];
+        }
+    }
+    FtleDerivativeTile(tmp, masses, count, k);
+    for (int c = 0; c < kFtleSize; ++c) {
+        for (int l = 0; l < count; ++l) {
+            sum[c][l] += 2.0 * k[c][l];
+            tmp[c][l] = y0[c][l] + h * k[c][l];
+        }
+    }
+    FtleDerivativeTile(tmp, masses, count, k);
+    for (int c = 0; c < kFtleSize; ++c) {
+        double* dst = (*lanes)[c].data() + begin;
+        for (int l = 0; l < count; ++l) dst[l] = y0[c][l] + h / 6.0 * (sum[c][l] + k[c][l]);
+    }
+}
+
+// Advances every cell by one renormalisation interval on `pool`. Tiles are independent,
+// so a tile runs all of its steps before the next one is picked up.
+void AdvanceFtleInterval(FtleGrid* grid, astro_parallel::ThreadPool& pool) {
+    if (grid->done()) return;
+    const int steps = std::min(kFtleRenormSteps, static_cast<int>(std::lround((kFtleHorizon - grid->time()) / kFixedStep)));
+    const int tiles = (grid->cells() + kFtleTile - 1) / kFtleTile;
+    pool.Run(tiles, [grid, steps](int tile) {
+        const size_t begin = static_cast<size_t>(tile) * kFtleTile;
+        const int count = std::min(kFtleTile, grid->cells() - static_cast<int>(begin));
+        for (int s = 0; s < steps; ++s) {
+            FtleRk4Tile(&grid->reference, grid->masses, begin, count, kFixedStep);
+            FtleRk4Tile(&grid->shadow, grid->masses, begin, count, kFixedStep);
+        }
+        for (int l = 0; l < count; ++l) {
+            const size_t cell = begin + l;
+            double d2 = 0.0;
+            for (int c = 0; c < kFtleSize; ++c) {
+                const double d = grid->shadow[c][cell] - grid->reference[c][cell];
+                d2 += d * d;
+            }
+            const double d = std::max(std::sqrt(d2), 1e-300);
+            grid->logGrowth[cell] += std::log(d / kFtleSeparation);
+            const double pull = kFtleSeparation / d;
+            for (int c = 0; c < kFtleSize; ++c) {
+                grid->shadow[c][cell] = grid->reference[c][cell] + (grid->shadow[c][cell] - grid->reference[c][cell]) * pull;
+            }
+        }
+    });
+    grid->steps += steps;
+}
+
+void WriteFtleMap(const FtleGrid& grid, std::vector<float>* out) {
+    out->resize(static_cast<size_t>(grid.cells()));
+    const double t = std::max(1e-6, static_cast<double>(grid.time()));
+    for (size_t i = 0; i < out->size(); ++i) (*out)[i] = static_cast<float>(grid.logGrowth[i] / t);
+}
+
+struct FtleSnapshot {
+    int preset = -1;
+    int side = 0;
+    float time = 0.0f;
+    std::vector<float> exponent;  // row 0 = fastest speed scale
+};
+
+// Runs the map for one preset on its own thread, with a private pool that leaves a
+// core to the render thread. Request() restarts it for a preset; Acquire() copies the
+// newest published interval. Both belong to the render thread.
+class FtleWorker {
+  public:
+    FtleWorker() = default;
+    ~FtleWorker() { Stop(); }
+
+    FtleWorker(const FtleWorker&) = delete;
+    FtleWorker& operator=(const FtleWorker&) = delete;
+
+    void Request(const Preset& preset, int presetIndex) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pendingPreset_ = preset;
+            pendingIndex_ = presetIndex;
+            pending_ = true;
+            cancel_.store(true);
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Acquire(FtleSnapshot* out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!fresh_) return false;
+        out->preset = published_.preset;
+        out->side = published_.side;
+        out->time = published_.time;
+        out->exponent = published_.exponent;
+        fresh_ = false;
+        return true;
+    }
+
+    int threads() const { return threads_; }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            cancel_.store(true);
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    void WorkerLoop() {
+        astro_parallel::ThreadPool pool(threads_);
+        FtleGrid grid;
+        std::vector<float> map;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || pending_; });
+            if (stop_) return;
+            const Preset preset = pendingPreset_;
+            const int index = pendingIndex_;
+            pending_ = false;
+            cancel_.store(false);
+            lock.unlock();
+
+            ResetFtleGrid(preset, kFtleSide, &grid);
+            while (!grid.done() && !cancel_.load()) {
+                AdvanceFtleInterval(&grid, pool);
+                WriteFtleMap(grid, &map);
+                std::lock_guard<std::mutex> publish(mutex_);
+                if (pending_ || stop_) break;
+                published_.preset = index;
+                published_.side = grid.side;
+                published_.time = grid.time();
+                published_.exponent.swap(map);
+                fresh_ = true;
+            }
+
+            lock.lock();
+        }
     }
 
-    for (size_t i = 1; i < trail.size(); ++i) {
-        float alpha = static_cast<float>(i) / static_cast<float>(trail.size());
-        Color segColor = color;
-        segColor.a = static_cast<unsigned char>(18 + 170 * alpha);
-        DrawLine3D(trail[i - 1], trail[i], segColor);
+    const int threads_ = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> cancel_{false};
+    Preset pendingPreset_{};
+    int pendingIndex_ = 0;
+    bool pending_ = false;
+    bool stop_ = false;
+    FtleSnapshot published_;
+    bool fresh_ = false;
+};
+
+// Blue (regular) to orange (chaotic) on a log scale between the map's extremes: regular
+// cells all sit near ln(t)/t (linear separation growth), chaotic ones decades apart.
+void PaintFtleMap(const FtleSnapshot& map, std::vector<Color>* pixels, float* minExponent, float* maxExponent) {
+    float low = 1e9f;
+    float high = 0.0f;
+    for (float v : map.exponent) {
+        low = std::min(low, v);
+        high = std::max(high, v);
+    }
+    low = std::max(low, 1e-4f);
+    high = std::max(high, 1.01f * low);
+    *minExponent = low;
+    *maxExponent = high;
+    const float scale = 1.0f / std::log(high / low);
+    pixels->resize(map.exponent.size());
+    for (size_t i = 0; i < map.exponent.size(); ++i) {
+        const float u = std::clamp(std::log(std::max(map.exponent[i], low) / low) * scale, 0.0f, 1.0f);
+        const Color cold = {18, 40, 92, 255};
+        const Color warm = {236, 96, 58, 255};
+        const Color hot = {255, 236, 170, 255};
+        (*pixels)[i] = u < 0.6f ? ColorLerp(cold, warm, u / 0.6f) : ColorLerp(warm, hot, (u - 0.6f) / 0.4f);
     }
 }
 
-void DrawStarfield(const std::vector<Vector3>& stars) {
-    for (size_t i = 0; i < stars.size(); ++i) {
-        unsigned char alpha = static_cast<unsigned char>(120 + (i % 120));
-        DrawPoint3D(stars[i], Color{220, 232, 255, alpha});
+void DrawFtlePanel(const FtleSnapshot& map, Texture2D texture, float minExponent, float maxExponent, const Preset& preset,
+                   int threads) {
+    const Rectangle panel = {kScreenWidth - kFtlePanelSize - 24.0f, kScreenHeight - kFtlePanelSize - 96.0f, kFtlePanelSize, kFtlePanelSize};
+    DrawRectangleRounded({panel.x - 10.0f, panel.y - 34.0f, panel.width + 20.0f, panel.height + 120.0f}, 0.05f, 8, Color{6, 10, 20, 200});
+    DrawText(TextFormat("Lyapunov map: %s", preset.name), static_cast<int>(panel.x), static_cast<int>(panel.y - 26.0f), 18,
+             Color{236, 241, 248, 255});
+    if (map.side > 0) {
+        DrawTexturePro(texture, {0.0f, 0.0f, static_cast<float>(map.side), static_cast<float>(map.side)}, panel, {0.0f, 0.0f}, 0.0f, WHITE);
     }
+    DrawRectangleLinesEx(panel, 1.5f, Color{120, 150, 190, 255});
+    // The unperturbed preset sits at the centre.
+    DrawCircleLines(static_cast<int>(panel.x + 0.5f * panel.width), static_cast<int>(panel.y + 0.5f * panel.height), 5.0f, RAYWHITE);
+
+    const int x = static_cast<int>(panel.x);
+    const int y = static_cast<int>(panel.y + panel.height + 8.0f);
+    DrawText(TextFormat("x: %s offset +/-%.1f   y: speed x%.2f..%.2f", preset.bodies[2].name, kFtleOffsetSpan,
+                        1.0f - kFtleSpeedSpan, 1.0f + kFtleSpeedSpan),
+             x, y, 16, Color{166, 186, 212, 255});
+    DrawText(TextFormat("FTLE t=%.1f/%.0f   %.3f .. %.3f", map.time, kFtleHorizon, minExponent, maxExponent), x, y + 22, 18,
+             Color{255, 214, 150, 255});
+    DrawText(TextFormat("%d cells x2 copies, %d worker threads", kFtleSide * kFtleSide, threads), x, y + 46, 16, Color{166, 186, 212, 255});
 }
 
 void UpdateOrbitCamera(Camera3D* camera, float* yaw, float* pitch, float* distance, Vector3 target) {
@@ -290,8 +757,8 @@ void UpdateOrbitCamera(Camera3D* camera, float* yaw, float* pitch, float* distan
     camera->position = Vector3Add(camera->target, offset);
 }
 
-std::vector<Vector3> BuildStarfield() {
-    std::vector<Vector3> stars;
+std::vector<astro_render::StarfieldStar> BuildStarfield() {
+    std::vector<astro_render::StarfieldStar> stars;
     stars.reserve(360);
 
     std::mt19937 rng(7);
@@ -304,10 +771,15 @@ std::vector<Vector3> BuildStarfield() {
         float y = heightDist(rng);
         float ring = std::sqrt(std::max(0.0f, 1.0f - y * y));
         float radius = radiusDist(rng);
+        const unsigned char alpha = static_cast<unsigned char>(120 + (i % 120));
         stars.push_back({
-            radius * ring * std::cos(azimuth),
-            radius * y,
-            radius * ring * std::sin(azimuth),
+            {radius * ring * std::cos(azimuth), radius * y, radius * ring * std::sin(azimuth)},
+            0.75f,
+            Color{220, 232, 255, alpha},
+            0.0f,
+            0.0f,
+            0.0f,
+            0.0f,
         });
     }
 
@@ -329,20 +801,61 @@ void DrawBodyWithGlow(const Body& body) {
     Color core = Brighten(body.color, 0.38f);
     Color rim = Brighten(body.color, 0.60f);
 
-    DrawSphere(body.pos, body.radius * 1.10f, shell);
-    DrawSphere(body.pos, body.radius * 0.92f, core);
+    astro_render::DrawSphereLod(body.pos, body.radius * 1.10f, shell);
+    astro_render::DrawSphereLod(body.pos, body.radius * 0.92f, core);
     DrawSphereWires(body.pos, body.radius * 1.12f, 14, 14, rim);
 }
 
 void DrawVelocityVector(const Body& body) {
     Vector3 tip = Vector3Add(body.pos, Vector3Scale(body.vel, 0.65f));
     DrawLine3D(body.pos, tip, Fade(body.color, 0.85f));
-    DrawSphere(tip, body.radius * 0.18f, Fade(body.color, 0.92f));
+    astro_render::DrawSphereLod(tip, body.radius * 0.18f, Fade(body.color, 0.92f));
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    // --headless --ftle benchmarks one Lyapunov renormalisation interval over the grid per step.
+    const bool ftleBench = astro_bench::HasFlag(argc, argv, "--ftle");
+    const int ftleIntervals = static_cast<int>(std::ceil(kFtleHorizon / (kFtleRenormSteps * kFixedStep)));
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, ftleBench ? ftleIntervals : 20000, 1.0f / 60.0f);
+    if (bench.enabled) {
+        const std::array<Preset, 3> presets = BuildPresets();
+        const int preset = std::clamp(astro_bench::IntArg(argc, argv, "--preset", 1), 0, 2);
+        if (ftleBench) {
+            FtleGrid grid;
+            ResetFtleGrid(presets[preset], kFtleSide, &grid);
+            std::vector<float> map;
+            return astro_bench::RunBench(
+                "three_body_problem_viz_ftle", bench,
+                [&](float) {
+                    if (grid.done()) ResetFtleGrid(presets[preset], kFtleSide, &grid);
+                    AdvanceFtleInterval(&grid, astro_parallel::SharedPool());
+                },
+                [&]() {
+                    WriteFtleMap(grid, &map);
+                    double sum = 0.0;
+                    for (float v : map) sum += v;
+                    return sum / static_cast<double>(map.size());
+                });
+        }
+        Integration integration;
+        if (const char* name = astro_bench::FindArg(argc, argv, "--integrator")) {
+            if (!astro_integrate::ParseMethod(name, &integration.method)) {
+                std::fprintf(stderr, "unknown --integrator=%s (rk4, leapfrog, yoshida4, dopri5)\n", name);
+                return 1;
+            }
+        }
+        std::array<Body, 3> bodies{};
+        std::array<Trail, 3> trails;
+        float simTime = 0.0f;
+        ResetSimulation(presets[preset], &integration, &bodies, &trails, &simTime);
+        return astro_bench::RunBench(
+            "three_body_problem_viz", bench,
+            [&](float dt) { AdvanceFrame(dt, &integration, &bodies, &trails, &simTime); },
+            [&]() { return TotalEnergy(bodies); });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Three Body Problem 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -359,10 +872,22 @@ int main() {
 
     const std::array<Preset, 3> presets = BuildPresets();
     int presetIndex = 0;
-    std::array<Body, 3> bodies{};
-    std::array<std::deque<Vector3>, 3> trails;
-    float simTime = 0.0f;
-    ResetSimulation(presets[presetIndex], &bodies, &trails, &simTime);
+    const float simRate = static_cast<float>(std::clamp(astro_bench::IntArg(argc, argv, "--sim-hz", static_cast<int>(kSimRate)), 30, 4000));
+    SimState initial;
+    ResetSimState(presets[presetIndex], initial);
+    astro_sim::SimThread<SimState, SimSnapshot> sim;
+    sim.Start(std::move(initial), simRate, StepSimState, PublishSimState);
+
+    FtleWorker ftleWorker;
+    ftleWorker.Request(presets[presetIndex], presetIndex);
+    FtleSnapshot ftleMap;
+    std::vector<Color> ftlePixels;
+    float ftleMin = 0.0f;
+    float ftleMax = 0.0f;
+    Image ftleImage = GenImageColor(kFtleSide, kFtleSide, BLANK);
+    Texture2D ftleTexture = LoadTextureFromImage(ftleImage);
+    UnloadImage(ftleImage);
+    bool showFtle = true;
 
     float speed = 1.0f;
     bool paused = false;
@@ -370,7 +895,10 @@ int main() {
     bool showVectors = false;
     bool showBarycenter = true;
 
-    const std::vector<Vector3> stars = BuildStarfield();
+    astro_render::StarfieldLayer starfield;
+    starfield.Init(astro_render::StarfieldSpace::kWorldPoint, BuildStarfield());
+    astro_render::TrailRenderer trailRenderer;
+    trailRenderer.Init();
 
     while (!WindowShouldClose()) {
         int requestedPreset = presetIndex;
@@ -381,34 +909,40 @@ int main() {
         if (requestedPreset != presetIndex) {
             presetIndex = requestedPreset;
             camDistance = presets[presetIndex].suggestedDistance;
-            ResetSimulation(presets[presetIndex], &bodies, &trails, &simTime);
+            sim.Reset([preset = presets[presetIndex]](SimState& state) { ResetSimState(preset, state); });
+            ftleWorker.Request(presets[presetIndex], presetIndex);
+            ftleMap = FtleSnapshot{};
         }
 
         if (IsKeyPressed(KEY_R)) {
-            ResetSimulation(presets[presetIndex], &bodies, &trails, &simTime);
+            sim.Reset([preset = presets[presetIndex]](SimState& state) { ResetSimState(preset, state); });
         }
         if (IsKeyPressed(KEY_P)) paused = !paused;
+        if (IsKeyPressed(KEY_I)) {
+            sim.Post([](SimState& state) { state.integration.method = astro_integrate::NextMethod(state.integration.method); });
+        }
         if (IsKeyPressed(KEY_T)) showTrails = !showTrails;
         if (IsKeyPressed(KEY_V)) showVectors = !showVectors;
         if (IsKeyPressed(KEY_B)) showBarycenter = !showBarycenter;
+        if (IsKeyPressed(KEY_L)) showFtle = !showFtle;
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) speed = std::min(6.0f, speed + 0.25f);
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) speed = std::max(0.25f, speed - 0.25f);
 
-        Vector3 barycenter = ComputeBarycenter(bodies);
-        UpdateOrbitCamera(&camera, &camYaw, &camPitch, &camDistance, barycenter);
-
-        if (!paused) {
-            float frameAdvance = GetFrameTime() * speed;
-            int steps = std::max(1, static_cast<int>(std::ceil(frameAdvance / kFixedStep)));
-            float dt = frameAdvance / static_cast<float>(steps);
-            for (int i = 0; i < steps; ++i) {
-                StepRK4(&bodies, dt);
-                simTime += dt;
-            }
-            AppendTrails(bodies, &trails);
-            barycenter = ComputeBarycenter(bodies);
+        FtleSnapshot latest;
+        if (ftleWorker.Acquire(&latest) && latest.preset == presetIndex && latest.side == kFtleSide) {
+            ftleMap = std::move(latest);
+            PaintFtleMap(ftleMap, &ftlePixels, &ftleMin, &ftleMax);
+            UpdateTexture(ftleTexture, ftlePixels.data());
         }
 
+        sim.SetTimeScale(paused ? 0.0f : speed);
+        const auto frame = sim.Sample();
+        const SimSnapshot& snapshot = *frame.current;
+        const std::array<Body, 3> bodies = BlendBodies(*frame.previous, snapshot, frame.alpha);
+        const std::array<Trail, 3>& trails = snapshot.trails;
+
+        UpdateOrbitCamera(&camera, &camYaw, &camPitch, &camDistance, ComputeBarycenter(bodies));
+
         BeginDrawing();
         ClearBackground(Color{4, 6, 14, 255});
 
@@ -416,16 +950,20 @@ int main() {
 
         BeginMode3D(camera);
 
-        DrawStarfield(stars);
+        starfield.Draw(0.0f);
 
         if (showTrails) {
+            trailRenderer.Clear();
             for (int i = 0; i < 3; ++i) {
-                DrawTrail(trails[i], bodies[i].color);
+                Color newest = bodies[i].color;
+                newest.a = 188;
+                trailRenderer.Add(trails[i], newest, 18);
             }
+            trailRenderer.Draw();
         }
 
         if (showBarycenter) {
-            DrawSphere(ComputeBarycenter(bodies), 0.14f, Color{245, 245, 255, 235});
+            astro_render::DrawSphereLod(ComputeBarycenter(bodies), 0.14f, Color{245, 245, 255, 235});
         }
 
         for (const Body& body : bodies) {
@@ -439,7 +977,7 @@ int main() {
 
         DrawText("Three Body Problem", 20, 18, 34, Color{236, 241, 248, 255});
         DrawText(presets[presetIndex].description, 20, 58, 18, Color{145, 189, 231, 255});
-        DrawText("Mouse orbit | wheel zoom | 1/2/3 presets | P pause | R reset | +/- speed | T trails | V vectors | B barycenter",
+        DrawText("Mouse orbit | wheel zoom | 1/2/3 presets | P pause | R reset | +/- speed | I integrator | T trails | V vectors | B barycenter | L Lyapunov map",
                  20, 84, 18, Color{166, 186, 212, 255});
 
         char status[256];
@@ -448,7 +986,7 @@ int main() {
             sizeof(status),
             "Preset: %s   t=%.2f   speed=%.2fx   energy=%.3f   |L|=%.3f%s",
             presets[presetIndex].name,
-            simTime,
+            snapshot.simTime,
             speed,
             TotalEnergy(bodies),
             TotalAngularMomentum(bodies),
@@ -469,7 +1007,12 @@ int main() {
         );
         DrawText(metrics, 20, 138, 18, Color{199, 216, 238, 255});
 
-        int legendY = 176;
+        char integratorLine[128];
+        std::snprintf(integratorLine, sizeof(integratorLine), "Integrator: %s   steps/tick=%d   sim %.0f Hz, load %.0f%%",
+                      astro_integrate::MethodName(snapshot.method), snapshot.lastSteps, simRate, 100.0f * sim.load());
+        DrawText(integratorLine, 20, 162, 18, Color{199, 216, 238, 255});
+
+        int legendY = 200;
         for (const Body& body : bodies) {
             DrawCircle(28, legendY + 10, 7.0f, body.color);
             char bodyLine[180];
@@ -488,10 +1031,19 @@ int main() {
         }
 
         DrawFPS(20, legendY + 6);
+        if (showFtle) DrawFtlePanel(ftleMap, ftleTexture, ftleMin, ftleMax, presets[presetIndex], ftleWorker.threads());
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    sim.Stop();
+    ftleWorker.Stop();
+    UnloadTexture(ftleTexture);
+    trailRenderer.Unload();
+    starfield.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,6 +1,11 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/offline_tracer.h"
+#include "../common/particle_pool.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -14,6 +19,13 @@ constexpr int kScreenHeight = 900;
 constexpr float kPi = 3.14159265358979323846f;
 constexpr float kHalfLength = 8.0f;
 
+// --render: fixed step used to advance the scene to --time, and the seed that makes two
+// renders of the same time identical.
+constexpr float kRenderStep = 1.0f / 60.0f;
+constexpr unsigned int kRenderSeed = 8128;
+// Full swirl during a transit spawns ~45 streaks/s living up to 2.2 s.
+constexpr size_t kMaxEnergyStreaks = 256;
+
 struct FlowParticle {
     float u;
     float theta;
@@ -82,6 +94,35 @@ struct TransitState {
     float z = -kHalfLength - 6.0f;
 };
 
+const EnvironmentPalette kNearPalette{
+    "Cygnus Drift",
+    Color{110, 224, 255, 255},
+    Color{72, 132, 255, 255},
+    Color{44, 98, 170, 255},
+    Color{180, 220, 255, 255},
+    Color{66, 120, 214, 255},
+    Color{150, 244, 255, 255},
+};
+const std::array<EnvironmentPalette, 3> kFarPalettes = {{
+    {"Amber Reach", Color{255, 180, 118, 255}, Color{255, 110, 78, 255}, Color{184, 74, 54, 255},
+     Color{255, 224, 196, 255}, Color{214, 86, 72, 255}, Color{255, 212, 140, 255}},
+    {"Crimson Veil", Color{255, 110, 138, 255}, Color{255, 74, 120, 255}, Color{144, 34, 86, 255},
+     Color{255, 192, 220, 255}, Color{180, 28, 96, 255}, Color{255, 154, 188, 255}},
+    {"Solar Ash", Color{255, 208, 110, 255}, Color{255, 152, 84, 255}, Color{160, 100, 52, 255},
+     Color{255, 238, 204, 255}, Color{190, 126, 62, 255}, Color{255, 230, 150, 255}},
+}};
+
+const std::array<CameraPreset, 3> kLeftPresets = {{
+    {0.82f, 0.26f, 14.0f, {0.0f, 0.0f, -kHalfLength}},
+    {1.58f, 0.02f, 12.0f, {0.0f, 0.0f, -2.0f}},
+    {0.06f, 0.42f, 27.0f, {0.0f, 0.0f, 0.0f}},
+}};
+const std::array<CameraPreset, 3> kRightPresets = {{
+    {-2.36f, 0.26f, 14.0f, {0.0f, 0.0f, kHalfLength}},
+    {-1.58f, 0.02f, 12.0f, {0.0f, 0.0f, 2.0f}},
+    {3.08f, 0.42f, 27.0f, {0.0f, 0.0f, 0.0f}},
+}};
+
 float RandomFloat(float minValue, float maxValue) {
     return minValue + (maxValue - minValue) * (static_cast<float>(GetRandomValue(0, 10000)) / 10000.0f);
 }
@@ -235,8 +276,8 @@ void InitializeNebula(std::vector<NebulaBlob>* blobs) {
     }
 }
 
-void SpawnEnergyStreak(std::vector<EnergyStreak>* streaks, int direction, float speedBoost) {
-    streaks->push_back(EnergyStreak{
+void SpawnEnergyStreak(astro_fx::ParticlePool<EnergyStreak>* streaks, int direction, float speedBoost) {
+    streaks->Spawn(EnergyStreak{
         direction > 0 ? -kHalfLength - 0.6f : kHalfLength + 0.6f,
         RandomFloat(0.0f, 2.0f * kPi),
         RandomFloat(0.02f, 0.20f),
@@ -260,30 +301,214 @@ void DrawWarpedRing(float z, float baseRadius, Color color, float wobble, float
     }
 }
 
+// Everything the frame loop advances apart from the camera; shared by the window and
+// the --render still.
+struct GatewayState {
+    float throatRadius = 1.12f;
+    float flare = 1.15f;
+    float swirlIntensity = 1.35f;
+    float transitSpeed = 1.0f;
+    float distortion = 0.85f;
+    float time = 0.0f;
+    float entrancePulse = 0.0f;
+    float exitPulse = 0.0f;
+    float delayedPulseTimer = -1.0f;
+    float streakAccumulator = 0.0f;
+    TransitState transit;
+    std::vector<FlowParticle> flowParticles;
+    std::vector<RimMote> rimMotes;
+    astro_fx::ParticlePool<EnergyStreak> energyStreaks{kMaxEnergyStreaks};
+    std::vector<DistantStar> stars;
+    std::vector<NebulaBlob> nebulaBlobs;
+};
+
+void ResetGateway(GatewayState* state) {
+    *state = GatewayState{};
+    InitializeFlowParticles(&state->flowParticles);
+    InitializeRimMotes(&state->rimMotes);
+    InitializeStars(&state->stars);
+    InitializeNebula(&state->nebulaBlobs);
+}
+
+float PulseValue(const GatewayState& state) {
+    float throatPulse = 0.5f + 0.5f * std::sin(state.time * 1.35f);
+    return throatPulse * 0.75f + std::max(state.entrancePulse, state.exitPulse) * 0.25f;
+}
+
+// Flow, rim motes, pulses and energy streaks; the transit camera is moved by main().
+void StepGateway(GatewayState* state, float dt) {
+    state->time += dt;
+    state->entrancePulse = std::max(0.0f, state->entrancePulse - dt);
+    state->exitPulse = std::max(0.0f, state->exitPulse - dt);
+    if (state->delayedPulseTimer > 0.0f) {
+        state->delayedPulseTimer -= dt;
+        if (state->delayedPulseTimer <= 0.0f) state->exitPulse = 1.1f;
+    }
+
+    float pulseWave = 0.5f + 0.5f * std::sin(state->time * 1.4f);
+    for (FlowParticle& particle : state->flowParticles) {
+        particle.u += particle.speed * dt * (0.6f + state->transitSpeed * 0.5f) * (0.7f + 0.7f * pulseWave);
+        if (particle.u > 1.0f) particle.u -= 1.0f;
+        particle.theta += dt * state->swirlIntensity * (0.9f + particle.radialFraction * 0.8f);
+    }
+    for (RimMote& mote : state->rimMotes) {
+        mote.theta += mote.speed * dt * (0.9f + 0.3f * pulseWave);
+    }
+
+    const float boost = state->transitSpeed + state->swirlIntensity * 0.3f;
+    state->streakAccumulator += dt * (5.0f + 4.0f * state->swirlIntensity + (state->transit.active ? 10.0f : 0.0f));
+    while (state->streakAccumulator >= 1.0f) {
+        state->streakAccumulator -= 1.0f;
+        SpawnEnergyStreak(&state->energyStreaks, 1, boost);
+        if (GetRandomValue(0, 100) > 40) SpawnEnergyStreak(&state->energyStreaks, -1, boost);
+    }
+
+    const float swirl = state->swirlIntensity;
+    state->energyStreaks.Update([dt, swirl](EnergyStreak& streak) {
+        streak.age += dt;
+        streak.z += streak.direction * streak.speed * dt;
+        streak.theta += dt * swirl * 1.4f;
+        return streak.age <= streak.ttl && std::abs(streak.z) <= kHalfLength + 10.0f;
+    });
+}
+
+void TraceWarpedRing(astro_render::TraceScene* scene, float z, float baseRadius, Color color, float wobble, float time, float phase) {
+    const int segments = 120;
+    for (int i = 0; i < segments; ++i) {
+        float a0 = (2.0f * kPi * i) / static_cast<float>(segments);
+        float a1 = (2.0f * kPi * (i + 1)) / static_cast<float>(segments);
+        float r0 = baseRadius + wobble * std::sin(a0 * 6.0f + time * 2.2f + phase);
+        float r1 = baseRadius + wobble * std::sin(a1 * 6.0f + time * 2.2f + phase);
+        scene->AddStreak({r0 * std::cos(a0), r0 * std::sin(a0), z}, {r1 * std::cos(a1), r1 * std::sin(a1), z}, 0.04f, color);
+    }
+}
+
+// The frame main() draws, as path-tracer primitives. Nothing here is opaque: the tube is
+// a sheet of glow patches, one per wall quad. The screen-space mouth halos become world
+// glows at the mouths; the HUD and the full-screen fog vignette are left out.
+void BuildTraceScene(const GatewayState& gateway, const EnvironmentPalette& farPalette, astro_render::TraceScene* scene) {
+    const float pulseValue = PulseValue(gateway);
+    const float time = gateway.time;
+    const float entranceMouthZ = -kHalfLength;
+    const float exitMouthZ = kHalfLength;
+
+    scene->background = astro_render::LinearRgb(Color{3, 5, 11, 255});
+
+    for (const NebulaBlob& blob : gateway.nebulaBlobs) {
+        const EnvironmentPalette& palette = blob.side < 0 ? kNearPalette : farPalette;
+        scene->AddGlow(blob.position, blob.radius, Fade(LerpColor(palette.nebula, palette.fog, blob.tint), blob.alpha));
+    }
+
+    for (const DistantStar& star : gateway.stars) {
+        const EnvironmentPalette& palette = star.side < 0 ? kNearPalette : farPalette;
+        float mouthZ = star.side < 0 ? entranceMouthZ : exitMouthZ;
+        Vector3 warped = DistortAroundMouth(star.position, mouthZ, gateway.distortion);
+        scene->AddGlow(warped, star.size, Fade(LerpColor(palette.star, Color{255, 255, 255, 255}, star.tint), 0.92f), 4.0f);
+    }
+
+    const int rings = 74;
+    const int segments = 56;
+    for (int i = 0; i < rings - 1; ++i) {
+        float z0 = -kHalfLength + (2.0f * kHalfLength * i) / static_cast<float>(rings - 1);
+        float z1 = -kHalfLength + (2.0f * kHalfLength * (i + 1)) / static_cast<float>(rings - 1);
+        float pulse0 = pulseValue * std::sin(time * 1.1f + z0 * 0.35f);
+        float pulse1 = pulseValue * std::sin(time * 1.1f + z1 * 0.35f);
+        float centerGlow = 1.0f - std::abs(z0) / kHalfLength;
+        Color c = TubeColor(z0, kNearPalette, farPalette, pulseValue);
+        c.a = static_cast<unsigned char>(28 + 58 * centerGlow + 25 * pulseValue);
+        for (int j = 0; j < segments; ++j) {
+            float a0 = (2.0f * kPi * j) / static_cast<float>(segments);
+            float a1 = (2.0f * kPi * (j + 1)) / static_cast<float>(segments);
+            Vector3 p00 = TubePoint(z0, a0, gateway.throatRadius, gateway.flare, pulse0);
+            Vector3 p01 = TubePoint(z0, a1, gateway.throatRadius, gateway.flare, pulse0);
+            Vector3 p11 = TubePoint(z1, a1, gateway.throatRadius, gateway.flare, pulse1);
+            scene->AddPatch(Vector3Scale(Vector3Add(p00, p11), 0.5f), Vector3Distance(p00, p01) * Vector3Distance(p01, p11), c);
+        }
+    }
+
+    for (int i = 0; i < 28; ++i) {
+        float z = -kHalfLength + std::fmod(time * (3.0f + gateway.transitSpeed * 2.0f) + i * 0.68f, 2.0f * kHalfLength);
+        float pulse = std::sin(time * 1.2f + z * 0.32f);
+        float radius = WormholeRadius(z, gateway.throatRadius, gateway.flare, pulseValue * pulse);
+        Color contour = Fade(TubeColor(z, kNearPalette, farPalette, pulseValue), 0.10f + 0.08f * pulseValue);
+        TraceWarpedRing(scene, z, radius, contour, 0.08f + gateway.swirlIntensity * 0.04f, time * gateway.swirlIntensity, i * 0.5f);
+    }
+
+    const float entranceRadius = WormholeRadius(entranceMouthZ, gateway.throatRadius, gateway.flare, pulseValue);
+    const float exitRadius = WormholeRadius(exitMouthZ, gateway.throatRadius, gateway.flare, pulseValue);
+    TraceWarpedRing(scene, entranceMouthZ, entranceRadius + 0.25f, Fade(kNearPalette.mouth, 0.62f + gateway.entrancePulse * 0.15f),
+                    0.20f + gateway.entrancePulse * 0.35f, time, 0.0f);
+    TraceWarpedRing(scene, entranceMouthZ, entranceRadius + 0.65f, Fade(kNearPalette.accent, 0.32f),
+                    0.26f + gateway.entrancePulse * 0.28f, time, 1.2f);
+    TraceWarpedRing(scene, exitMouthZ, exitRadius + 0.25f, Fade(farPalette.mouth, 0.62f + gateway.exitPulse * 0.15f),
+                    0.20f + gateway.exitPulse * 0.35f, time, 0.8f);
+    TraceWarpedRing(scene, exitMouthZ, exitRadius + 0.65f, Fade(farPalette.accent, 0.32f), 0.26f + gateway.exitPulse * 0.28f, time,
+                    2.1f);
+
+    for (const RimMote& mote : gateway.rimMotes) {
+        float mouthZ = mote.mouthSign < 0 ? entranceMouthZ : exitMouthZ;
+        const EnvironmentPalette& palette = mote.mouthSign < 0 ? kNearPalette : farPalette;
+        float ringRadius = (mote.mouthSign < 0 ? entranceRadius : exitRadius) + 0.2f + mote.ringFraction * 1.6f;
+        Vector3 position{ringRadius * std::cos(mote.theta), ringRadius * std::sin(mote.theta),
+                         mouthZ + mote.lift + 0.18f * std::sin(time * 2.0f + mote.phase)};
+        scene->AddGlow(position, mote.size, Fade(palette.accent, 0.12f + 0.20f * mote.ringFraction), 2.0f);
+    }
+
+    for (const FlowParticle& particle : gateway.flowParticles) {
+        float z = -kHalfLength + particle.u * (2.0f * kHalfLength);
+        float centerFactor = 1.0f - std::abs(z) / kHalfLength;
+        float radius = WormholeRadius(z, gateway.throatRadius, gateway.flare, pulseValue);
+        float lane = radius * (0.22f + particle.radialFraction * 0.58f + 0.06f * std::sin(time * 2.6f + particle.phase));
+        float theta = particle.theta + gateway.swirlIntensity * z * 0.18f;
+        Color c = TubeColor(z, kNearPalette, farPalette, pulseValue);
+        c = LerpColor(c, Color{255, 255, 255, 255}, particle.glow * 0.25f + centerFactor * 0.22f);
+        scene->AddGlow({lane * std::cos(theta), lane * std::sin(theta), z}, 0.03f + 0.045f * particle.glow + 0.02f * centerFactor,
+                       Fade(c, 0.16f + 0.18f * particle.glow), 2.0f);
+    }
+
+    for (const EnergyStreak& streak : gateway.energyStreaks) {
+        Color c = LerpColor(TubeColor(streak.z, kNearPalette, farPalette, pulseValue), Color{255, 255, 255, 255}, 0.45f);
+        float fade = 1.0f - std::clamp(streak.age / streak.ttl, 0.0f, 1.0f);
+        Vector3 position{streak.radius * std::cos(streak.theta), streak.radius * std::sin(streak.theta), streak.z};
+        Vector3 tail{position.x * 0.85f, position.y * 0.85f, position.z - streak.direction * 0.85f};
+        scene->AddStreak(tail, position, 0.5f * streak.width, Fade(c, 0.35f * fade));
+        scene->AddGlow(position, streak.width, Fade(c, 0.32f * fade), 2.0f);
+    }
+
+    scene->AddGlow({0.0f, 0.0f, entranceMouthZ}, 2.4f + gateway.entrancePulse, Fade(kNearPalette.mouth, 0.10f + gateway.entrancePulse * 0.05f));
+    scene->AddGlow({0.0f, 0.0f, exitMouthZ}, 2.4f + gateway.exitPulse, Fade(farPalette.mouth, 0.10f + gateway.exitPulse * 0.05f));
+    scene->Build();
+}
+
+// --preset picks one of the near-side orbit presets; the transit is not rendered.
+int RenderStillFrame(const astro_render::StillOptions& options) {
+    SetRandomSeed(kRenderSeed);
+    GatewayState gateway;
+    ResetGateway(&gateway);
+    for (float t = 0.0f; t < options.time; t += kRenderStep) StepGateway(&gateway, kRenderStep);
+
+    Camera3D camera{};
+    camera.up = {0.0f, 1.0f, 0.0f};
+    camera.fovy = 42.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+    float yaw = 0.0f, pitch = 0.0f, distance = 0.0f;
+    ApplyPreset(kLeftPresets[static_cast<size_t>(std::clamp(options.preset, 0, 2))], &camera, &yaw, &pitch, &distance);
+
+    astro_render::TraceScene scene;
+    BuildTraceScene(gateway, kFarPalettes[0], &scene);
+    return astro_render::RenderStill("wormhole_gateway_viz", scene, camera, options);
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_render::StillOptions still = astro_render::ParseStillArgs(argc, argv, "wormhole_gateway");
+    if (still.enabled) return RenderStillFrame(still);
+
+
     InitWindow(kScreenWidth, kScreenHeight, "Wormhole Gateway 3D - C++ (raylib)");
     SetTargetFPS(60);
 
-    const EnvironmentPalette nearPalette{
-        "Cygnus Drift",
-        Color{110, 224, 255, 255},
-        Color{72, 132, 255, 255},
-        Color{44, 98, 170, 255},
-        Color{180, 220, 255, 255},
-        Color{66, 120, 214, 255},
-        Color{150, 244, 255, 255},
-    };
-    const std::array<EnvironmentPalette, 3> farPalettes = {{
-        {"Amber Reach", Color{255, 180, 118, 255}, Color{255, 110, 78, 255}, Color{184, 74, 54, 255},
-         Color{255, 224, 196, 255}, Color{214, 86, 72, 255}, Color{255, 212, 140, 255}},
-        {"Crimson Veil", Color{255, 110, 138, 255}, Color{255, 74, 120, 255}, Color{144, 34, 86, 255},
-         Color{255, 192, 220, 255}, Color{180, 28, 96, 255}, Color{255, 154, 188, 255}},
-        {"Solar Ash", Color{255, 208, 110, 255}, Color{255, 152, 84, 255}, Color{160, 100, 52, 255},
-         Color{255, 238, 204, 255}, Color{190, 126, 62, 255}, Color{255, 230, 150, 255}},
-    }};
-
     Camera3D camera{};
     camera.position = {11.5f, 5.0f, 15.0f};
     camera.target = {0.0f, 0.0f, -kHalfLength};
@@ -291,149 +516,87 @@ int main() {
     camera.fovy = 42.0f;
     camera.projection = CAMERA_PERSPECTIVE;
 
-    const std::array<CameraPreset, 3> leftPresets = {{
-        {0.82f, 0.26f, 14.0f, {0.0f, 0.0f, -kHalfLength}},
-        {1.58f, 0.02f, 12.0f, {0.0f, 0.0f, -2.0f}},
-        {0.06f, 0.42f, 27.0f, {0.0f, 0.0f, 0.0f}},
-    }};
-    const std::array<CameraPreset, 3> rightPresets = {{
-        {-2.36f, 0.26f, 14.0f, {0.0f, 0.0f, kHalfLength}},
-        {-1.58f, 0.02f, 12.0f, {0.0f, 0.0f, 2.0f}},
-        {3.08f, 0.42f, 27.0f, {0.0f, 0.0f, 0.0f}},
-    }};
-
-    float camYaw = leftPresets[0].yaw;
-    float camPitch = leftPresets[0].pitch;
-    float camDistance = leftPresets[0].distance;
+    float camYaw = kLeftPresets[0].yaw;
+    float camPitch = kLeftPresets[0].pitch;
+    float camDistance = kLeftPresets[0].distance;
 
-    float throatRadius = 1.12f;
-    float flare = 1.15f;
-    float swirlIntensity = 1.35f;
-    float transitSpeed = 1.0f;
-    float distortion = 0.85f;
     bool paused = false;
     int farPaletteIndex = 0;
     int currentSide = -1;
-    float time = 0.0f;
-    float entrancePulse = 0.0f;
-    float exitPulse = 0.0f;
-    float delayedPulseTimer = -1.0f;
-    float streakAccumulator = 0.0f;
-
-    TransitState transit;
-    std::vector<FlowParticle> flowParticles;
-    std::vector<RimMote> rimMotes;
-    std::vector<EnergyStreak> energyStreaks;
-    std::vector<DistantStar> stars;
-    std::vector<NebulaBlob> nebulaBlobs;
-    InitializeFlowParticles(&flowParticles);
-    InitializeRimMotes(&rimMotes);
-    InitializeStars(&stars);
-    InitializeNebula(&nebulaBlobs);
-    energyStreaks.reserve(200);
+    GatewayState gateway;
+    ResetGateway(&gateway);
 
-    ApplyPreset(leftPresets[0], &camera, &camYaw, &camPitch, &camDistance);
+    ApplyPreset(kLeftPresets[0], &camera, &camYaw, &camPitch, &camDistance);
 
     while (!WindowShouldClose()) {
-        const EnvironmentPalette& farPalette = farPalettes[farPaletteIndex];
+        const EnvironmentPalette& farPalette = kFarPalettes[farPaletteIndex];
 
         auto applyContextPreset = [&](int index) {
             if (index < 0 || index > 2) return;
-            if (currentSide < 0) ApplyPreset(leftPresets[index], &camera, &camYaw, &camPitch, &camDistance);
-            else ApplyPreset(rightPresets[index], &camera, &camYaw, &camPitch, &camDistance);
+            if (currentSide < 0) ApplyPreset(kLeftPresets[index], &camera, &camYaw, &camPitch, &camDistance);
+            else ApplyPreset(kRightPresets[index], &camera, &camYaw, &camPitch, &camDistance);
         };
 
         auto beginTransit = [&]() {
-            transit.active = true;
-            transit.direction = currentSide < 0 ? 1 : -1;
-            transit.z = currentSide < 0 ? -kHalfLength - 6.2f : kHalfLength + 6.2f;
-            entrancePulse = 1.20f;
-            exitPulse = 0.0f;
-            delayedPulseTimer = 0.55f;
+            gateway.transit.active = true;
+            gateway.transit.direction = currentSide < 0 ? 1 : -1;
+            gateway.transit.z = currentSide < 0 ? -kHalfLength - 6.2f : kHalfLength + 6.2f;
+            gateway.entrancePulse = 1.20f;
+            gateway.exitPulse = 0.0f;
+            gateway.delayedPulseTimer = 0.55f;
         };
 
-        if (IsKeyPressed(KEY_ONE) && !transit.active) applyContextPreset(0);
-        if (IsKeyPressed(KEY_TWO) && !transit.active) applyContextPreset(1);
-        if (IsKeyPressed(KEY_THREE) && !transit.active) applyContextPreset(2);
-        if (IsKeyPressed(KEY_FOUR) && !transit.active) beginTransit();
+        if (IsKeyPressed(KEY_ONE) && !gateway.transit.active) applyContextPreset(0);
+        if (IsKeyPressed(KEY_TWO) && !gateway.transit.active) applyContextPreset(1);
+        if (IsKeyPressed(KEY_THREE) && !gateway.transit.active) applyContextPreset(2);
+        if (IsKeyPressed(KEY_FOUR) && !gateway.transit.active) beginTransit();
 
-        if (IsKeyPressed(KEY_T) && !transit.active) beginTransit();
-        if (IsKeyPressed(KEY_M)) farPaletteIndex = (farPaletteIndex + 1) % static_cast<int>(farPalettes.size());
+        if (IsKeyPressed(KEY_T) && !gateway.transit.active) beginTransit();
+        if (IsKeyPressed(KEY_M)) farPaletteIndex = (farPaletteIndex + 1) % static_cast<int>(kFarPalettes.size());
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
-            throatRadius = 1.12f;
-            flare = 1.15f;
-            swirlIntensity = 1.35f;
-            transitSpeed = 1.0f;
-            distortion = 0.85f;
             paused = false;
             farPaletteIndex = 0;
             currentSide = -1;
-            time = 0.0f;
-            entrancePulse = 0.0f;
-            exitPulse = 0.0f;
-            delayedPulseTimer = -1.0f;
-            streakAccumulator = 0.0f;
-            transit = TransitState{};
-            InitializeFlowParticles(&flowParticles);
-            InitializeRimMotes(&rimMotes);
-            InitializeStars(&stars);
-            InitializeNebula(&nebulaBlobs);
-            energyStreaks.clear();
-            ApplyPreset(leftPresets[0], &camera, &camYaw, &camPitch, &camDistance);
+            ResetGateway(&gateway);
+            ApplyPreset(kLeftPresets[0], &camera, &camYaw, &camPitch, &camDistance);
         }
 
-        if (IsKeyDown(KEY_UP)) throatRadius = std::min(2.2f, throatRadius + 0.55f * GetFrameTime());
-        if (IsKeyDown(KEY_DOWN)) throatRadius = std::max(0.55f, throatRadius - 0.55f * GetFrameTime());
-        if (IsKeyDown(KEY_RIGHT_BRACKET)) flare = std::min(2.2f, flare + 0.65f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT_BRACKET)) flare = std::max(0.20f, flare - 0.65f * GetFrameTime());
-        if (IsKeyDown(KEY_RIGHT)) swirlIntensity = std::min(3.2f, swirlIntensity + 1.0f * GetFrameTime());
-        if (IsKeyDown(KEY_LEFT)) swirlIntensity = std::max(0.10f, swirlIntensity - 1.0f * GetFrameTime());
-        if (IsKeyDown(KEY_EQUAL)) transitSpeed = std::min(2.6f, transitSpeed + 1.1f * GetFrameTime());
-        if (IsKeyDown(KEY_MINUS)) transitSpeed = std::max(0.25f, transitSpeed - 1.1f * GetFrameTime());
-        if (IsKeyDown(KEY_D)) distortion = std::min(2.3f, distortion + 1.1f * GetFrameTime());
-        if (IsKeyDown(KEY_S)) distortion = std::max(0.1f, distortion - 1.1f * GetFrameTime());
+        if (IsKeyDown(KEY_UP)) gateway.throatRadius = std::min(2.2f, gateway.throatRadius + 0.55f * GetFrameTime());
+        if (IsKeyDown(KEY_DOWN)) gateway.throatRadius = std::max(0.55f, gateway.throatRadius - 0.55f * GetFrameTime());
+        if (IsKeyDown(KEY_RIGHT_BRACKET)) gateway.flare = std::min(2.2f, gateway.flare + 0.65f * GetFrameTime());
+        if (IsKeyDown(KEY_LEFT_BRACKET)) gateway.flare = std::max(0.20f, gateway.flare - 0.65f * GetFrameTime());
+        if (IsKeyDown(KEY_RIGHT)) gateway.swirlIntensity = std::min(3.2f, gateway.swirlIntensity + 1.0f * GetFrameTime());
+        if (IsKeyDown(KEY_LEFT)) gateway.swirlIntensity = std::max(0.10f, gateway.swirlIntensity - 1.0f * GetFrameTime());
+        if (IsKeyDown(KEY_EQUAL)) gateway.transitSpeed = std::min(2.6f, gateway.transitSpeed + 1.1f * GetFrameTime());
+        if (IsKeyDown(KEY_MINUS)) gateway.transitSpeed = std::max(0.25f, gateway.transitSpeed - 1.1f * GetFrameTime());
+        if (IsKeyDown(KEY_D)) gateway.distortion = std::min(2.3f, gateway.distortion + 1.1f * GetFrameTime());
+        if (IsKeyDown(KEY_S)) gateway.distortion = std::max(0.1f, gateway.distortion - 1.1f * GetFrameTime());
 
-        if (!transit.active) UpdateOrbitCamera(&camera, &camYaw, &camPitch, &camDistance);
+        if (!gateway.transit.active) UpdateOrbitCamera(&camera, &camYaw, &camPitch, &camDistance);
 
         float dt = GetFrameTime();
         if (!paused) {
-            time += dt;
-            entrancePulse = std::max(0.0f, entrancePulse - dt);
-            exitPulse = std::max(0.0f, exitPulse - dt);
-            if (delayedPulseTimer > 0.0f) {
-                delayedPulseTimer -= dt;
-                if (delayedPulseTimer <= 0.0f) exitPulse = 1.1f;
-            }
-
-            float pulseWave = 0.5f + 0.5f * std::sin(time * 1.4f);
-            for (FlowParticle& particle : flowParticles) {
-                particle.u += particle.speed * dt * (0.6f + transitSpeed * 0.5f) * (0.7f + 0.7f * pulseWave);
-                if (particle.u > 1.0f) particle.u -= 1.0f;
-                particle.theta += dt * swirlIntensity * (0.9f + particle.radialFraction * 0.8f);
-            }
-            for (RimMote& mote : rimMotes) {
-                mote.theta += mote.speed * dt * (0.9f + 0.3f * pulseWave);
-            }
+            StepGateway(&gateway, dt);
 
-            if (transit.active) {
-                transit.z += transit.direction * dt * transitSpeed * 9.5f;
-                float sway = 0.22f + 0.08f * distortion;
+            if (gateway.transit.active) {
+                gateway.transit.z += gateway.transit.direction * dt * gateway.transitSpeed * 9.5f;
+                float sway = 0.22f + 0.08f * gateway.distortion;
                 camera.position = {
-                    sway * std::sin(time * 1.9f),
-                    sway * std::cos(time * 1.6f),
-                    transit.z,
+                    sway * std::sin(gateway.time * 1.9f),
+                    sway * std::cos(gateway.time * 1.6f),
+                    gateway.transit.z,
                 };
                 camera.target = {
-                    0.18f * std::sin(time * 2.2f),
-                    0.14f * std::cos(time * 2.0f),
-                    transit.z + transit.direction * 3.6f,
+                    0.18f * std::sin(gateway.time * 2.2f),
+                    0.14f * std::cos(gateway.time * 2.0f),
+                    gateway.transit.z + gateway.transit.direction * 3.6f,
                 };
-                camera.fovy = 42.0f + 6.0f * std::sin(std::clamp((std::abs(transit.z) / (kHalfLength + 6.2f)), 0.0f, 1.0f) * kPi);
+                camera.fovy = 42.0f + 6.0f * std::sin(std::clamp((std::abs(gateway.transit.z) / (kHalfLength + 6.2f)), 0.0f, 1.0f) * kPi);
 
-                if ((transit.direction > 0 && transit.z > kHalfLength + 6.4f) ||
-                    (transit.direction < 0 && transit.z < -kHalfLength - 6.4f)) {
-                    transit.active = false;
+                if ((gateway.transit.direction > 0 && gateway.transit.z > kHalfLength + 6.4f) ||
+                    (gateway.transit.direction < 0 && gateway.transit.z < -kHalfLength - 6.4f)) {
+                    gateway.transit.active = false;
                     currentSide *= -1;
                     camera.fovy = 42.0f;
                     applyContextPreset(0);
@@ -441,28 +604,9 @@ int main() {
             } else {
                 camera.fovy = 42.0f;
             }
-
-            streakAccumulator += dt * (5.0f + 4.0f * swirlIntensity + (transit.active ? 10.0f : 0.0f));
-            while (streakAccumulator >= 1.0f) {
-                streakAccumulator -= 1.0f;
-                SpawnEnergyStreak(&energyStreaks, 1, transitSpeed + swirlIntensity * 0.3f);
-                if (GetRandomValue(0, 100) > 40) SpawnEnergyStreak(&energyStreaks, -1, transitSpeed + swirlIntensity * 0.3f);
-            }
-
-            for (EnergyStreak& streak : energyStreaks) {
-                streak.age += dt;
-                streak.z += streak.direction * streak.speed * dt;
-                streak.theta += dt * swirlIntensity * 1.4f;
-            }
-            energyStreaks.erase(
-                std::remove_if(energyStreaks.begin(), energyStreaks.end(), [](const EnergyStreak& streak) {
-                    return streak.age > streak.ttl || std::abs(streak.z) > kHalfLength + 10.0f;
-                }),
-                energyStreaks.end());
         }
 
-        float throatPulse = 0.5f + 0.5f * std::sin(time * 1.35f);
-        float pulseValue = throatPulse * 0.75f + std::max(entrancePulse, exitPulse) * 0.25f;
+        float pulseValue = PulseValue(gateway);
         float entranceMouthZ = -kHalfLength;
         float exitMouthZ = kHalfLength;
 
@@ -471,16 +615,16 @@ int main() {
 
         BeginMode3D(camera);
 
-        for (const NebulaBlob& blob : nebulaBlobs) {
-            const EnvironmentPalette& palette = blob.side < 0 ? nearPalette : farPalette;
+        for (const NebulaBlob& blob : gateway.nebulaBlobs) {
+            const EnvironmentPalette& palette = blob.side < 0 ? kNearPalette : farPalette;
             Color c = LerpColor(palette.nebula, palette.fog, blob.tint);
             DrawSphere(blob.position, blob.radius, Fade(c, blob.alpha));
         }
 
-        for (const DistantStar& star : stars) {
-            const EnvironmentPalette& palette = star.side < 0 ? nearPalette : farPalette;
+        for (const DistantStar& star : gateway.stars) {
+            const EnvironmentPalette& palette = star.side < 0 ? kNearPalette : farPalette;
             float mouthZ = star.side < 0 ? entranceMouthZ : exitMouthZ;
-            Vector3 warped = DistortAroundMouth(star.position, mouthZ, distortion);
+            Vector3 warped = DistortAroundMouth(star.position, mouthZ, gateway.distortion);
             Color c = LerpColor(palette.star, Color{255, 255, 255, 255}, star.tint);
             DrawSphere(warped, star.size, Fade(c, 0.92f));
         }
@@ -490,18 +634,18 @@ int main() {
         for (int i = 0; i < rings - 1; ++i) {
             float z0 = -kHalfLength + (2.0f * kHalfLength * i) / static_cast<float>(rings - 1);
             float z1 = -kHalfLength + (2.0f * kHalfLength * (i + 1)) / static_cast<float>(rings - 1);
-            float pulse0 = pulseValue * std::sin(time * 1.1f + z0 * 0.35f);
-            float pulse1 = pulseValue * std::sin(time * 1.1f + z1 * 0.35f);
+            float pulse0 = pulseValue * std::sin(gateway.time * 1.1f + z0 * 0.35f);
+            float pulse1 = pulseValue * std::sin(gateway.time * 1.1f + z1 * 0.35f);
             for (int j = 0; j < segments; ++j) {
                 float a0 = (2.0f * kPi * j) / static_cast<float>(segments);
                 float a1 = (2.0f * kPi * (j + 1)) / static_cast<float>(segments);
-                Vector3 p00 = TubePoint(z0, a0, throatRadius, flare, pulse0);
-                Vector3 p01 = TubePoint(z0, a1, throatRadius, flare, pulse0);
-                Vector3 p10 = TubePoint(z1, a0, throatRadius, flare, pulse1);
-                Vector3 p11 = TubePoint(z1, a1, throatRadius, flare, pulse1);
+                Vector3 p00 = TubePoint(z0, a0, gateway.throatRadius, gateway.flare, pulse0);
+                Vector3 p01 = TubePoint(z0, a1, gateway.throatRadius, gateway.flare, pulse0);
+                Vector3 p10 = TubePoint(z1, a0, gateway.throatRadius, gateway.flare, pulse1);
+                Vector3 p11 = TubePoint(z1, a1, gateway.throatRadius, gateway.flare, pulse1);
 
                 float centerGlow = 1.0f - std::abs(z0) / kHalfLength;
-                Color c = TubeColor(z0, nearPalette, farPalette, pulseValue);
+                Color c = TubeColor(z0, kNearPalette, farPalette, pulseValue);
                 c.a = static_cast<unsigned char>(28 + 58 * centerGlow + 25 * pulseValue);
                 DrawTriangle3D(p00, p10, p01, c);
                 DrawTriangle3D(p01, p10, p11, c);
@@ -509,50 +653,50 @@ int main() {
         }
 
         for (int i = 0; i < 28; ++i) {
-            float z = -kHalfLength + std::fmod(time * (3.0f + transitSpeed * 2.0f) + i * 0.68f, 2.0f * kHalfLength);
-            float pulse = std::sin(time * 1.2f + z * 0.32f);
-            float radius = WormholeRadius(z, throatRadius, flare, pulseValue * pulse);
-            Color contour = Fade(TubeColor(z, nearPalette, farPalette, pulseValue), 0.10f + 0.08f * pulseValue);
-            DrawWarpedRing(z, radius, contour, 0.08f + swirlIntensity * 0.04f, time * swirlIntensity, i * 0.5f);
+            float z = -kHalfLength + std::fmod(gateway.time * (3.0f + gateway.transitSpeed * 2.0f) + i * 0.68f, 2.0f * kHalfLength);
+            float pulse = std::sin(gateway.time * 1.2f + z * 0.32f);
+            float radius = WormholeRadius(z, gateway.throatRadius, gateway.flare, pulseValue * pulse);
+            Color contour = Fade(TubeColor(z, kNearPalette, farPalette, pulseValue), 0.10f + 0.08f * pulseValue);
+            DrawWarpedRing(z, radius, contour, 0.08f + gateway.swirlIntensity * 0.04f, gateway.time * gateway.swirlIntensity, i * 0.5f);
         }
 
-        DrawWarpedRing(entranceMouthZ, WormholeRadius(entranceMouthZ, throatRadius, flare, pulseValue) + 0.25f,
-                       Fade(nearPalette.mouth, 0.62f + entrancePulse * 0.15f), 0.20f + entrancePulse * 0.35f, time, 0.0f);
-        DrawWarpedRing(entranceMouthZ, WormholeRadius(entranceMouthZ, throatRadius, flare, pulseValue) + 0.65f,
-                       Fade(nearPalette.accent, 0.32f), 0.26f + entrancePulse * 0.28f, time, 1.2f);
-        DrawWarpedRing(exitMouthZ, WormholeRadius(exitMouthZ, throatRadius, flare, pulseValue) + 0.25f,
-                       Fade(farPalette.mouth, 0.62f + exitPulse * 0.15f), 0.20f + exitPulse * 0.35f, time, 0.8f);
-        DrawWarpedRing(exitMouthZ, WormholeRadius(exitMouthZ, throatRadius, flare, pulseValue) + 0.65f,
-                       Fade(farPalette.accent, 0.32f), 0.26f + exitPulse * 0.28f, time, 2.1f);
+        DrawWarpedRing(entranceMouthZ, WormholeRadius(entranceMouthZ, gateway.throatRadius, gateway.flare, pulseValue) + 0.25f,
+                       Fade(kNearPalette.mouth, 0.62f + gateway.entrancePulse * 0.15f), 0.20f + gateway.entrancePulse * 0.35f, gateway.time, 0.0f);
+        DrawWarpedRing(entranceMouthZ, WormholeRadius(entranceMouthZ, gateway.throatRadius, gateway.flare, pulseValue) + 0.65f,
+                       Fade(kNearPalette.accent, 0.32f), 0.26f + gateway.entrancePulse * 0.28f, gateway.time, 1.2f);
+        DrawWarpedRing(exitMouthZ, WormholeRadius(exitMouthZ, gateway.throatRadius, gateway.flare, pulseValue) + 0.25f,
+                       Fade(farPalette.mouth, 0.62f + gateway.exitPulse * 0.15f), 0.20f + gateway.exitPulse * 0.35f, gateway.time, 0.8f);
+        DrawWarpedRing(exitMouthZ, WormholeRadius(exitMouthZ, gateway.throatRadius, gateway.flare, pulseValue) + 0.65f,
+                       Fade(farPalette.accent, 0.32f), 0.26f + gateway.exitPulse * 0.28f, gateway.time, 2.1f);
 
-        for (const RimMote& mote : rimMotes) {
+        for (const RimMote& mote : gateway.rimMotes) {
             float mouthZ = mote.mouthSign < 0 ? entranceMouthZ : exitMouthZ;
-            const EnvironmentPalette& palette = mote.mouthSign < 0 ? nearPalette : farPalette;
-            float mouthRadius = WormholeRadius(mouthZ, throatRadius, flare, pulseValue);
+            const EnvironmentPalette& palette = mote.mouthSign < 0 ? kNearPalette : farPalette;
+            float mouthRadius = WormholeRadius(mouthZ, gateway.throatRadius, gateway.flare, pulseValue);
             float ringRadius = mouthRadius + 0.2f + mote.ringFraction * 1.6f;
             Vector3 position{
                 ringRadius * std::cos(mote.theta),
                 ringRadius * std::sin(mote.theta),
-                mouthZ + mote.lift + 0.18f * std::sin(time * 2.0f + mote.phase),
+                mouthZ + mote.lift + 0.18f * std::sin(gateway.time * 2.0f + mote.phase),
             };
             DrawSphere(position, mote.size, Fade(palette.accent, 0.12f + 0.20f * mote.ringFraction));
         }
 
-        for (const FlowParticle& particle : flowParticles) {
+        for (const FlowParticle& particle : gateway.flowParticles) {
             float z = -kHalfLength + particle.u * (2.0f * kHalfLength);
             float centerFactor = 1.0f - std::abs(z) / kHalfLength;
-            float radius = WormholeRadius(z, throatRadius, flare, pulseValue);
+            float radius = WormholeRadius(z, gateway.throatRadius, gateway.flare, pulseValue);
             float lane = radius * (0.22f + particle.radialFraction * 0.58f +
-                                   0.06f * std::sin(time * 2.6f + particle.phase));
-            float theta = particle.theta + swirlIntensity * z * 0.18f;
+                                   0.06f * std::sin(gateway.time * 2.6f + particle.phase));
+            float theta = particle.theta + gateway.swirlIntensity * z * 0.18f;
             Vector3 position{lane * std::cos(theta), lane * std::sin(theta), z};
-            Color c = TubeColor(z, nearPalette, farPalette, pulseValue);
+            Color c = TubeColor(z, kNearPalette, farPalette, pulseValue);
             c = LerpColor(c, Color{255, 255, 255, 255}, particle.glow * 0.25f + centerFactor * 0.22f);
             DrawSphere(position, 0.03f + 0.045f * particle.glow + 0.02f * centerFactor, Fade(c, 0.16f + 0.18f * particle.glow));
         }
 
-        for (const EnergyStreak& streak : energyStreaks) {
-            Color c = TubeColor(streak.z, nearPalette, farPalette, pulseValue);
+        for (const EnergyStreak& streak : gateway.energyStreaks) {
+            Color c = TubeColor(streak.z, kNearPalette, farPalette, pulseValue);
             c = LerpColor(c, Color{255, 255, 255, 255}, 0.45f);
             float fade = 1.0f - std::clamp(streak.age / streak.ttl, 0.0f, 1.0f);
             Vector3 position{
@@ -574,12 +718,12 @@ int main() {
         Vector2 leftMouthScreen = GetWorldToScreen({0.0f, 0.0f, entranceMouthZ}, camera);
         Vector2 rightMouthScreen = GetWorldToScreen({0.0f, 0.0f, exitMouthZ}, camera);
         DrawCircleGradient(static_cast<int>(leftMouthScreen.x), static_cast<int>(leftMouthScreen.y),
-                           140.0f + entrancePulse * 55.0f,
-                           Fade(nearPalette.mouth, 0.10f + entrancePulse * 0.05f),
+                           140.0f + gateway.entrancePulse * 55.0f,
+                           Fade(kNearPalette.mouth, 0.10f + gateway.entrancePulse * 0.05f),
                            Fade(Color{0, 0, 0, 0}, 0.0f));
         DrawCircleGradient(static_cast<int>(rightMouthScreen.x), static_cast<int>(rightMouthScreen.y),
-                           140.0f + exitPulse * 55.0f,
-                           Fade(farPalette.mouth, 0.10f + exitPulse * 0.05f),
+                           140.0f + gateway.exitPulse * 55.0f,
+                           Fade(farPalette.mouth, 0.10f + gateway.exitPulse * 0.05f),
                            Fade(Color{0, 0, 0, 0}, 0.0f));
 
         DrawRectangle(16, 16, 760, 118, Fade(Color{8, 14, 28, 255}, 0.78f));
@@ -594,8 +738,8 @@ int main() {
         char status[420];
         std::snprintf(status, sizeof(status),
                       "Near field: %s\nFar field: %s\nThroat radius: %.2f\nFlare: %.2f\nSwirl: %.2f\nTransit speed: %.2f\nDistortion: %.2f\nMode: %s\nObserver side: %s%s",
-                      nearPalette.name, farPalette.name, throatRadius, flare, swirlIntensity, transitSpeed, distortion,
-                      transit.active ? "Transit" : "Orbit",
+                      kNearPalette.name, farPalette.name, gateway.throatRadius, gateway.flare, gateway.swirlIntensity, gateway.transitSpeed, gateway.distortion,
+                      gateway.transit.active ? "Transit" : "Orbit",
                       currentSide < 0 ? "Near field" : "Far field",
                       paused ? "\n[PAUSED]" : "");
         DrawText(status, GetScreenWidth() - 328, 68, 20, Color{124, 228, 255, 255});
@@ -603,18 +747,21 @@ int main() {
         DrawRectangle(GetScreenWidth() - 350, 226, 318, 96, Fade(Color{8, 14, 28, 255}, 0.74f));
         DrawText("Pulse Echo", GetScreenWidth() - 328, 236, 22, Color{236, 240, 248, 255});
         DrawRectangle(GetScreenWidth() - 324, 272, 280, 10, Fade(Color{40, 56, 84, 255}, 0.95f));
-        DrawRectangle(GetScreenWidth() - 324, 272, static_cast<int>(280.0f * std::clamp(entrancePulse / 1.2f, 0.0f, 1.0f)), 10, nearPalette.accent);
-        DrawRectangle(GetScreenWidth() - 324, 290, static_cast<int>(280.0f * std::clamp(exitPulse / 1.1f, 0.0f, 1.0f)), 10, farPalette.accent);
+        DrawRectangle(GetScreenWidth() - 324, 272, static_cast<int>(280.0f * std::clamp(gateway.entrancePulse / 1.2f, 0.0f, 1.0f)), 10, kNearPalette.accent);
+        DrawRectangle(GetScreenWidth() - 324, 290, static_cast<int>(280.0f * std::clamp(gateway.exitPulse / 1.1f, 0.0f, 1.0f)), 10, farPalette.accent);
         DrawText("entrance pulse", GetScreenWidth() - 324, 256, 16, Color{188, 204, 224, 255});
         DrawText("exit echo", GetScreenWidth() - 324, 304, 16, Color{188, 204, 224, 255});
 
         DrawCircleGradient(GetScreenWidth() / 2, GetScreenHeight() / 2, 300.0f,
-                           Fade(LerpColor(nearPalette.fog, farPalette.fog, 0.5f), 0.035f),
+                           Fade(LerpColor(kNearPalette.fog, farPalette.fog, 0.5f), 0.035f),
                            Fade(Color{0, 0, 0, 0}, 0.0f));
         DrawFPS(30, GetScreenHeight() - 42);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,3 +1,6 @@
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../vision/hand_gestures.h"
 #include "../vision/hand_tracking_scene_shared.h"
 
 #include <algorithm>
@@ -13,6 +16,8 @@ namespace {
 constexpr int kScreenWidth = 1480;
 constexpr int kScreenHeight = 920;
 constexpr float kPi = 3.14159265358979323846f;
+// Sweeping gestures steer the throat: favour low lag and predict a little further.
+constexpr HandFilterConfig kHandFilter = {{1.0f, 10.0f, 1.0f}, 8.0f, 0.5f, 0.02f, kMaxTrackingExtrapolation};
 
 float Hash01(unsigned int n) {
     n ^= 2747636419u;
@@ -590,16 +595,6 @@ void UpdateAndDrawTransitParticles(std::vector<TransitParticle>& particles, cons
     }
 }
 
-bool IsFistGesture(const HandGeometry& g) {
-    const float palmScale = HandPalmScale(g);
-    const float thumb = Vector3Distance(g.landmarks[4], g.palmCenter) / palmScale;
-    const float index = Vector3Distance(g.landmarks[8], g.palmCenter) / palmScale;
-    const float middle = Vector3Distance(g.landmarks[12], g.palmCenter) / palmScale;
-    const float ring = Vector3Distance(g.landmarks[16], g.palmCenter) / palmScale;
-    const float pinky = Vector3Distance(g.landmarks[20], g.palmCenter) / palmScale;
-    return thumb < 1.44f && index < 1.18f && middle < 1.14f && ring < 1.10f && pinky < 1.08f;
-}
-
 bool IsPinchGesture(const HandGeometry& g) {
     const float palmScale = HandPalmScale(g);
     const float pinch = Vector3Distance(g.landmarks[4], g.landmarks[8]) / palmScale;
@@ -723,8 +718,12 @@ int main() {
     float camPitch = 0.18f;
     float camDistance = 15.8f;
 
+    // Fists are recognised per packet on the network thread, ahead of the frame.
+    GestureEngine<FistGesture<>> gestures;
     HandSceneBridge bridge;
+    bridge.SetPacketListener([&gestures](const TrackingSample& sample) { gestures.Process(sample); });
     bridge.Start();
+    bridge.SetFilter(kHandFilter);
 
     MouthState left{{-3.6f, 1.8f, 0.0f}, 1.42f, -3.6f, 1.42f};
     MouthState right{{3.6f, 1.8f, 0.0f}, 1.42f, 3.6f, 1.42f};
@@ -752,8 +751,11 @@ int main() {
 
         const HandControlState& leftHand = bridge.Control(false);
         const HandControlState& rightHand = bridge.Control(true);
-        const bool leftFistRaw = bridge.LeftTracked() && IsFistGesture(bridge.Geometry(false));
-        const bool rightFistRaw = bridge.RightTracked() && IsFistGesture(bridge.Geometry(true));
+        // Only the held flags matter here; drop the edge events.
+        for (GestureEvent event; gestures.Poll(&event);) {
+        }
+        const bool leftFistRaw = bridge.LeftTracked() && gestures.Held(false, kHoldFist);
+        const bool rightFistRaw = bridge.RightTracked() && gestures.Held(true, kHoldFist);
         const bool leftPinch = bridge.LeftTracked() && IsPinchGesture(bridge.Geometry(false)) && !leftFistRaw;
         const bool rightPinch = bridge.RightTracked() && IsPinchGesture(bridge.Geometry(true)) && !rightFistRaw;
         const bool leftFist = leftFistRaw;
@@ -867,9 +869,12 @@ int main() {
         DrawText("Pinch near a mouth to reshape it. Hold a fist on that side to stream matter into the wormhole.", 20, 56, 20, Color{182, 198, 226, 255});
         DrawBridgeStatus(bridge, 20, 84);
         bridge.DrawPreviewPanel({static_cast<float>(GetScreenWidth() - 392), 20.0f, 360.0f, 220.0f}, "Python Webcam Feed");
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
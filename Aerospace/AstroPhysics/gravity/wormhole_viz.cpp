@@ -1,14 +1,15 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/scene_host.h"
+#include "../vision/hand_tracking_scene_shared.h"
+#include "../vision/live_controls.h"
 
 #include <algorithm>
-#include <cctype>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
-#include <filesystem>
-#include <fstream>
 #include <iomanip>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -33,6 +34,8 @@ constexpr std::int64_t kZoomPinchSuppressMs = 260;
 constexpr float kWarpStep = 0.02f;
 constexpr float kThroatStep = 0.05f;
 constexpr float kBridgePitchGain = 2.20f;
+constexpr int kBackdropStars = 180;
+constexpr unsigned int kBackdropSeed = 41;
 
 struct FlowParticle {
     float u;
@@ -42,25 +45,6 @@ struct FlowParticle {
     Color color;
 };
 
-struct LiveControls {
-    float zoom = 1.0f;
-    float rotationDeg = 0.0f;
-    float pitchDeg = 0.0f;
-    int nIncCount = 0;
-    int nDecCount = 0;
-    bool zoomLineActive = false;
-    std::string label = "Unknown";
-    std::string gesture = "none";
-    std::int64_t timestampMs = 0;
-};
-
-std::string Trim(std::string s) {
-    auto notSpace = [](unsigned char ch) { return !std::isspace(ch); };
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
-    s.erase(std::find_if(s.rbegin(), s.rend(), notSpace).base(), s.end());
-    return s;
-}
-
 std::int64_t UnixMsNow() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
@@ -76,65 +60,6 @@ float AngleDeltaDeg(float current, float previous) {
     return NormalizeDeg(current - previous);
 }
 
-std::optional<LiveControls> ParseLiveControlsFile(const std::filesystem::path& path) {
-    std::ifstream in(path);
-    if (!in.is_open()) return std::nullopt;
-
-    LiveControls lc;
-    std::string line;
-    while (std::getline(in, line)) {
-        const std::size_t eq = line.find('=');
-        if (eq == std::string::npos) continue;
-        const std::string key = Trim(line.substr(0, eq));
-        const std::string val = Trim(line.substr(eq + 1));
-        try {
-            if (key == "zoom") lc.zoom = std::stof(val);
-            else if (key == "rotation_deg") lc.rotationDeg = std::stof(val);
-            else if (key == "pitch_deg") lc.pitchDeg = std::stof(val);
-            else if (key == "n_inc_count") lc.nIncCount = std::stoi(val);
-            else if (key == "n_dec_count") lc.nDecCount = std::stoi(val);
-            else if (key == "zoom_line_active") lc.zoomLineActive = (val == "1" || val == "true" || val == "True");
-            else if (key == "label") lc.label = val;
-            else if (key == "gesture") lc.gesture = val;
-            else if (key == "timestamp_ms") lc.timestampMs = std::stoll(val);
-        } catch (...) {
-            // Ignore malformed values and keep defaults.
-        }
-    }
-
-    if (lc.timestampMs <= 0) return std::nullopt;
-    return lc;
-}
-
-std::optional<LiveControls> LoadLiveControls() {
-    static std::optional<std::filesystem::path> cachedPath;
-
-    auto tryPath = [](const std::filesystem::path& p) -> std::optional<LiveControls> {
-        if (!std::filesystem::exists(p)) return std::nullopt;
-        return ParseLiveControlsFile(p);
-    };
-
-    if (cachedPath) {
-        if (auto parsed = tryPath(*cachedPath)) return parsed;
-    }
-
-    const std::vector<std::filesystem::path> candidates = {
-        "vision/live_controls.txt",
-        "../vision/live_controls.txt",
-        "../../vision/live_controls.txt",
-        "AstroPhysics/vision/live_controls.txt",
-        std::filesystem::path(__FILE__).parent_path().parent_path() / "vision" / "live_controls.txt",
-    };
-
-    for (const auto& p : candidates) {
-        if (auto parsed = tryPath(p)) {
-            cachedPath = p;
-            return parsed;
-        }
-    }
-    return std::nullopt;
-}
-
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 delta = GetMouseDelta();
@@ -226,142 +151,62 @@ std::string Hud(float throatRadius, float flare, int particles, bool paused) {
     return os.str();
 }
 
-}  // namespace
+class WormholeScene : public astro_scene::Scene {
+  public:
+    void Prepare() override {
+        flow_.clear();
+        flow_.reserve(320);
+        for (int i = 0; i < 320; ++i) {
+            float u = -4.7f + 9.4f * (static_cast<float>(i) / 319.0f);
+            float theta = 2.0f * PI * std::fmod(i * 0.6180339f, 1.0f);
+            float speed = 0.4f + 0.9f * std::fmod(i * 0.371f, 1.0f);
+            float swirl = 0.8f + 1.4f * std::fmod(i * 0.529f, 1.0f);
+            Color c = Color{
+                static_cast<unsigned char>(90 + (i * 17) % 120),
+                static_cast<unsigned char>(160 + (i * 11) % 90),
+                static_cast<unsigned char>(220 + (i * 7) % 35),
+                230
+            };
+            flow_.push_back({u, theta, speed, swirl, c});
+        }
+    }
 
-int main() {
-    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
-    InitWindow(kScreenWidth, kScreenHeight, "Wormhole 3D Visualization - C++ (raylib)");
-    SetWindowMinSize(kWindowMinWidth, kWindowMinHeight);
-    SetTargetFPS(60);
-
-    Camera3D camera{};
-    camera.position = {8.5f, 4.8f, 8.0f};
-    camera.target = {0.0f, 0.0f, 0.0f};
-    camera.up = {0.0f, 1.0f, 0.0f};
-    camera.fovy = 45.0f;
-    camera.projection = CAMERA_PERSPECTIVE;
-
-    float camYaw = 0.82f;
-    float camPitch = 0.34f;
-    float camDistance = 13.5f;
-
-    float throatRadius = 0.85f;
-    float flare = 0.22f;
-    bool paused = false;
-    bool hasPrevLive = false;
-    float prevLiveRotDeg = 0.0f;
-    float prevLivePitchDeg = 0.0f;
-    int prevLiveNIncCount = 0;
-    int prevLiveNDecCount = 0;
-    int pendingRightPinches = 0;
-    int pendingLeftPinches = 0;
-    std::int64_t rightPendingDeadlineMs = 0;
-    std::int64_t leftPendingDeadlineMs = 0;
-    std::int64_t zoomPinchSuppressUntilMs = 0;
-    std::string bridgeStatus = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
-
-    std::vector<FlowParticle> flow;
-    flow.reserve(320);
-    for (int i = 0; i < 320; ++i) {
-        float u = -4.7f + 9.4f * (static_cast<float>(i) / 319.0f);
-        float theta = 2.0f * PI * std::fmod(i * 0.6180339f, 1.0f);
-        float speed = 0.4f + 0.9f * std::fmod(i * 0.371f, 1.0f);
-        float swirl = 0.8f + 1.4f * std::fmod(i * 0.529f, 1.0f);
-        Color c = Color{
-            static_cast<unsigned char>(90 + (i * 17) % 120),
-            static_cast<unsigned char>(160 + (i * 11) % 90),
-            static_cast<unsigned char>(220 + (i * 7) % 35),
-            230
-        };
-        flow.push_back({u, theta, speed, swirl, c});
+    bool Init(astro_scene::SceneContext& /*ctx*/) override {
+        camera_.position = {8.5f, 4.8f, 8.0f};
+        camera_.target = {0.0f, 0.0f, 0.0f};
+        camera_.up = {0.0f, 1.0f, 0.0f};
+        camera_.fovy = 45.0f;
+        camera_.projection = CAMERA_PERSPECTIVE;
+        return true;
     }
 
-    while (!WindowShouldClose()) {
-        if (IsKeyPressed(KEY_P)) paused = !paused;
+    void Enter(astro_scene::SceneContext& /*ctx*/) override {
+        hasPrevLive_ = false;
+        pendingRightPinches_ = pendingLeftPinches_ = 0;
+        rightPendingDeadlineMs_ = leftPendingDeadlineMs_ = 0;
+    }
+
+    void Update(astro_scene::SceneContext& ctx, float dt) override {
+        if (IsKeyPressed(KEY_P)) paused_ = !paused_;
         if (IsKeyPressed(KEY_R)) {
-            throatRadius = 0.85f;
-            flare = 0.22f;
+            throatRadius_ = 0.85f;
+            flare_ = 0.22f;
         }
-        if (IsKeyPressed(KEY_LEFT_BRACKET)) throatRadius = std::max(0.45f, throatRadius - 0.05f);
-        if (IsKeyPressed(KEY_RIGHT_BRACKET)) throatRadius = std::min(1.8f, throatRadius + 0.05f);
-        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) flare = std::max(0.08f, flare - 0.02f);
-        if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) flare = std::min(0.55f, flare + 0.02f);
+        if (IsKeyPressed(KEY_LEFT_BRACKET)) throatRadius_ = std::max(0.45f, throatRadius_ - 0.05f);
+        if (IsKeyPressed(KEY_RIGHT_BRACKET)) throatRadius_ = std::min(1.8f, throatRadius_ + 0.05f);
+        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) flare_ = std::max(0.08f, flare_ - 0.02f);
+        if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) flare_ = std::min(0.55f, flare_ + 0.02f);
 
-        UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
+        UpdateOrbitCameraDragOnly(&camera_, &camYaw_, &camPitch_, &camDistance_);
 
         const std::int64_t nowMs = UnixMsNow();
-        if (auto live = LoadLiveControls()) {
-            const std::int64_t ageMs = nowMs - live->timestampMs;
-            if (ageMs <= kControlStaleMs) {
-                if (!hasPrevLive) {
-                    hasPrevLive = true;
-                    prevLiveRotDeg = live->rotationDeg;
-                    prevLivePitchDeg = live->pitchDeg;
-                    prevLiveNIncCount = live->nIncCount;
-                    prevLiveNDecCount = live->nDecCount;
-                } else {
-                    const float rotDeltaDeg = AngleDeltaDeg(live->rotationDeg, prevLiveRotDeg);
-                    prevLiveRotDeg = live->rotationDeg;
-                    camYaw += rotDeltaDeg * DEG2RAD;
-
-                    const float pitchDeltaDeg = live->pitchDeg - prevLivePitchDeg;
-                    prevLivePitchDeg = live->pitchDeg;
-                    camPitch += pitchDeltaDeg * kBridgePitchGain * DEG2RAD;
-                    camPitch = std::clamp(camPitch, kCameraPitchMin, kCameraPitchMax);
-
-                    if (live->zoomLineActive) {
-                        zoomPinchSuppressUntilMs = nowMs + kZoomPinchSuppressMs;
-                        pendingRightPinches = 0;
-                        pendingLeftPinches = 0;
-                        rightPendingDeadlineMs = 0;
-                        leftPendingDeadlineMs = 0;
-                    }
-
-                    const bool allowPinchActions = (nowMs >= zoomPinchSuppressUntilMs) && !live->zoomLineActive;
-                    if (allowPinchActions) {
-                        if (live->nIncCount >= prevLiveNIncCount) {
-                            const int incDelta = live->nIncCount - prevLiveNIncCount;
-                            if (incDelta > 0) {
-                                pendingRightPinches += incDelta;
-                                rightPendingDeadlineMs = nowMs + kPinchSequenceWindowMs;
-                            }
-                        }
-                        if (live->nDecCount >= prevLiveNDecCount) {
-                            const int decDelta = live->nDecCount - prevLiveNDecCount;
-                            if (decDelta > 0) {
-                                pendingLeftPinches += decDelta;
-                                leftPendingDeadlineMs = nowMs + kPinchSequenceWindowMs;
-                            }
-                        }
-                    }
-                    prevLiveNIncCount = live->nIncCount;
-                    prevLiveNDecCount = live->nDecCount;
-                }
-
-                // Absolute bridge: full live zoom span always maps to full camera distance span.
-                const float currentLiveZoom = std::clamp(live->zoom, kBridgeLiveZoomMin, kBridgeLiveZoomMax);
-                const float liveZoomNorm = (currentLiveZoom - kBridgeLiveZoomMin) / (kBridgeLiveZoomMax - kBridgeLiveZoomMin);
-                camDistance = kCameraDistanceMax + (kCameraDistanceMin - kCameraDistanceMax) * liveZoomNorm;
-                UpdateCameraFromOrbit(&camera, camYaw, camPitch, camDistance);
-                std::ostringstream cs;
-                cs << "bridge: live  hand=" << live->label
-                   << "  gesture=" << live->gesture
-                   << "  age=" << ageMs << "ms  single=flare  double=throat";
-                bridgeStatus = cs.str();
-            } else {
-                hasPrevLive = false;
-                bridgeStatus = "bridge: stale";
-            }
-        } else {
-            hasPrevLive = false;
-            bridgeStatus = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
-        }
+        UpdateLiveControls(ctx.liveControls, nowMs);
 
         auto applyPinchBuffer = [&](int* pending, std::int64_t* deadline, float flareDir, float throatDir) {
             if (*pending >= 2) {
                 const int doubleCount = *pending / 2;
-                throatRadius = std::clamp(
-                    throatRadius + throatDir * kThroatStep * static_cast<float>(doubleCount),
+                throatRadius_ = std::clamp(
+                    throatRadius_ + throatDir * kThroatStep * static_cast<float>(doubleCount),
                     0.45f,
                     1.8f
                 );
@@ -370,37 +215,39 @@ int main() {
             }
 
             if (*pending == 1 && *deadline > 0 && nowMs >= *deadline) {
-                flare = std::clamp(flare + flareDir * kWarpStep, 0.08f, 0.55f);
+                flare_ = std::clamp(flare_ + flareDir * kWarpStep, 0.08f, 0.55f);
                 *pending = 0;
                 *deadline = 0;
             }
         };
 
-        applyPinchBuffer(&pendingRightPinches, &rightPendingDeadlineMs, +1.0f, +1.0f);
-        applyPinchBuffer(&pendingLeftPinches, &leftPendingDeadlineMs, -1.0f, -1.0f);
+        applyPinchBuffer(&pendingRightPinches_, &rightPendingDeadlineMs_, +1.0f, +1.0f);
+        applyPinchBuffer(&pendingLeftPinches_, &leftPendingDeadlineMs_, -1.0f, -1.0f);
 
-        float dt = GetFrameTime();
-        if (!paused) {
-            for (FlowParticle& p : flow) {
+        if (!paused_) {
+            for (FlowParticle& p : flow_) {
                 p.u += dt * (0.35f + p.speed);
                 p.theta += dt * p.swirl;
                 if (p.u > 4.8f) p.u = -4.8f;
             }
+            backdropDrift_ += dt;
         }
+    }
 
-        BeginDrawing();
+    void Draw(astro_scene::SceneContext& /*ctx*/) override {
         ClearBackground(Color{5, 8, 18, 255});
+        // Shared with every other scene that asks for the same backdrop.
+        astro_hand::DrawStarfieldBackdrop(kBackdropStars, kBackdropSeed, backdropDrift_, Color{150, 180, 230, 255});
 
-        BeginMode3D(camera);
-
+        BeginMode3D(camera_);
 
-        DrawWormholeSurface(throatRadius, flare);
+        DrawWormholeSurface(throatRadius_, flare_);
 
-        DrawSphere({0.0f, 0.0f, -4.8f}, RadiusProfile(-4.8f, throatRadius, flare), Color{80, 120, 190, 35});
-        DrawSphere({0.0f, 0.0f, 4.8f}, RadiusProfile(4.8f, throatRadius, flare), Color{80, 120, 190, 35});
+        DrawSphere({0.0f, 0.0f, -4.8f}, RadiusProfile(-4.8f, throatRadius_, flare_), Color{80, 120, 190, 35});
+        DrawSphere({0.0f, 0.0f, 4.8f}, RadiusProfile(4.8f, throatRadius_, flare_), Color{80, 120, 190, 35});
 
-        for (const FlowParticle& p : flow) {
-            Vector3 pos = WormholePoint(p.u, p.theta, throatRadius, flare);
+        for (const FlowParticle& p : flow_) {
+            Vector3 pos = WormholePoint(p.u, p.theta, throatRadius_, flare_);
             DrawSphere(pos, 0.03f, p.color);
         }
 
@@ -408,14 +255,133 @@ int main() {
 
         DrawText("Wormhole Tunnel (Morris-Thorne Style Visual)", 20, 18, 29, Color{232, 238, 248, 255});
         DrawText("Hold left mouse: orbit | wheel: zoom | drag edge: resize | [ ] throat | +/- flare | P pause | R reset", 20, 54, 19, Color{164, 183, 210, 255});
-        std::string hud = Hud(throatRadius, flare, static_cast<int>(flow.size()), paused);
+        std::string hud = Hud(throatRadius_, flare_, static_cast<int>(flow_.size()), paused_);
         DrawText(hud.c_str(), 20, 82, 21, Color{126, 224, 255, 255});
-        DrawText(bridgeStatus.c_str(), 20, 108, 19, Color{152, 234, 198, 255});
+        DrawText(bridgeStatus_.c_str(), 20, 108, 19, Color{152, 234, 198, 255});
         DrawFPS(20, 136);
+    }
+
+    // A pinch waiting out its double-pinch window still has to land.
+    bool Animating() const override {
+        return !paused_ || pendingRightPinches_ > 0 || pendingLeftPinches_ > 0;
+    }
+
+  private:
+    void UpdateLiveControls(const astro_hand::LiveControlsWatcher* liveControls, std::int64_t nowMs) {
+        const std::optional<astro_hand::LiveControls> none;
+        const auto& live = liveControls != nullptr ? liveControls->Latest() : none;
+        if (!live) {
+            hasPrevLive_ = false;
+            bridgeStatus_ = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
+            return;
+        }
+        const std::int64_t ageMs = nowMs - live->timestampMs;
+        if (ageMs > kControlStaleMs) {
+            hasPrevLive_ = false;
+            bridgeStatus_ = "bridge: stale";
+            return;
+        }
+        if (!hasPrevLive_) {
+            hasPrevLive_ = true;
+            prevLiveRotDeg_ = live->rotationDeg;
+            prevLivePitchDeg_ = live->pitchDeg;
+            prevLiveNIncCount_ = live->nIncCount;
+            prevLiveNDecCount_ = live->nDecCount;
+        } else {
+            const float rotDeltaDeg = AngleDeltaDeg(live->rotationDeg, prevLiveRotDeg_);
+            prevLiveRotDeg_ = live->rotationDeg;
+            camYaw_ += rotDeltaDeg * DEG2RAD;
+
+            const float pitchDeltaDeg = live->pitchDeg - prevLivePitchDeg_;
+            prevLivePitchDeg_ = live->pitchDeg;
+            camPitch_ += pitchDeltaDeg * kBridgePitchGain * DEG2RAD;
+            camPitch_ = std::clamp(camPitch_, kCameraPitchMin, kCameraPitchMax);
+
+            if (live->zoomLineActive) {
+                zoomPinchSuppressUntilMs_ = nowMs + kZoomPinchSuppressMs;
+                pendingRightPinches_ = 0;
+                pendingLeftPinches_ = 0;
+                rightPendingDeadlineMs_ = 0;
+                leftPendingDeadlineMs_ = 0;
+            }
+
+            const bool allowPinchActions = (nowMs >= zoomPinchSuppressUntilMs_) && !live->zoomLineActive;
+            if (allowPinchActions) {
+                if (live->nIncCount >= prevLiveNIncCount_) {
+                    const int incDelta = live->nIncCount - prevLiveNIncCount_;
+                    if (incDelta > 0) {
+                        pendingRightPinches_ += incDelta;
+                        rightPendingDeadlineMs_ = nowMs + kPinchSequenceWindowMs;
+                    }
+                }
+                if (live->nDecCount >= prevLiveNDecCount_) {
+                    const int decDelta = live->nDecCount - prevLiveNDecCount_;
+                    if (decDelta > 0) {
+                        pendingLeftPinches_ += decDelta;
+                        leftPendingDeadlineMs_ = nowMs + kPinchSequenceWindowMs;
+                    }
+                }
+            }
+            prevLiveNIncCount_ = live->nIncCount;
+            prevLiveNDecCount_ = live->nDecCount;
+        }
 
-        EndDrawing();
+        // Absolute bridge: full live zoom span always maps to full camera distance span.
+        const float currentLiveZoom = std::clamp(live->zoom, kBridgeLiveZoomMin, kBridgeLiveZoomMax);
+        const float liveZoomNorm = (currentLiveZoom - kBridgeLiveZoomMin) / (kBridgeLiveZoomMax - kBridgeLiveZoomMin);
+        camDistance_ = kCameraDistanceMax + (kCameraDistanceMin - kCameraDistanceMax) * liveZoomNorm;
+        UpdateCameraFromOrbit(&camera_, camYaw_, camPitch_, camDistance_);
+        std::ostringstream cs;
+        cs << "bridge: live  hand=" << live->label
+           << "  gesture=" << live->gesture
+           << "  age=" << ageMs << "ms  single=flare  double=throat";
+        bridgeStatus_ = cs.str();
     }
 
-    CloseWindow();
-    return 0;
+    Camera3D camera_{};
+    float camYaw_ = 0.82f;
+    float camPitch_ = 0.34f;
+    float camDistance_ = 13.5f;
+
+    float throatRadius_ = 0.85f;
+    float flare_ = 0.22f;
+    bool paused_ = false;
+    bool hasPrevLive_ = false;
+    float prevLiveRotDeg_ = 0.0f;
+    float prevLivePitchDeg_ = 0.0f;
+    int prevLiveNIncCount_ = 0;
+    int prevLiveNDecCount_ = 0;
+    int pendingRightPinches_ = 0;
+    int pendingLeftPinches_ = 0;
+    std::int64_t rightPendingDeadlineMs_ = 0;
+    std::int64_t leftPendingDeadlineMs_ = 0;
+    std::int64_t zoomPinchSuppressUntilMs_ = 0;
+    std::string bridgeStatus_ = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
+    float backdropDrift_ = 0.0f;
+
+    std::vector<FlowParticle> flow_;
+};
+
+}  // namespace
+
+namespace astro_scene {
+
+std::unique_ptr<Scene> MakeWormholeScene() {
+    return std::make_unique<WormholeScene>();
+}
+
+}  // namespace astro_scene
+
+#if !defined(ASTRO_SCENE_HOST)
+int main(int argc, char** argv) {
+    astro_scene::WindowOptions window;
+    window.idle = astro_power::IdleOptions::FromArgs(argc, argv);
+    window.title = "Wormhole 3D Visualization - C++ (raylib)";
+    window.width = kScreenWidth;
+    window.height = kScreenHeight;
+    window.flags = FLAG_WINDOW_RESIZABLE;
+    window.minWidth = kWindowMinWidth;
+    window.minHeight = kWindowMinHeight;
+    return astro_scene::RunStandalone(astro_scene::MakeWormholeScene, window);
 }
+#endif
@@ -0,0 +1,41 @@
+#include "raylib.h"
+#include "../common/cli_args.h"
+#include "../common/scene_host.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Demos compiled with ASTRO_SCENE_HOST, hosted in one window. Tab / Shift+Tab step
+// through them, F1.. picks one directly, --scene=<name> picks the first.
+
+namespace astro_scene {
+
+std::unique_ptr<Scene> MakeBlackholeScene();
+std::unique_ptr<Scene> MakeWormholeScene();
+
+}  // namespace astro_scene
+
+int main(int argc, char** argv) {
+    const std::vector<astro_scene::SceneEntry> scenes = {
+        {"blackhole_viz", astro_scene::MakeBlackholeScene},
+        {"wormhole_viz", astro_scene::MakeWormholeScene},
+    };
+
+    int first = 0;
+    if (const char* name = astro_bench::FindArg(argc, argv, "--scene")) {
+        for (size_t i = 0; i < scenes.size(); ++i) {
+            if (std::strcmp(scenes[i].name, name) == 0) first = static_cast<int>(i);
+        }
+    }
+
+    astro_scene::WindowOptions window;
+    window.title = "AstroPhysics scenes (raylib)";
+    window.flags = FLAG_WINDOW_RESIZABLE;
+    window.minWidth = 840;
+    window.minHeight = 560;
+    window.audio = true;
+    window.idle = astro_power::IdleOptions::FromArgs(argc, argv);
+    astro_scene::SceneHost host(scenes);
+    return host.Run(window, first);
+}
@@ -1,6 +1,13 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/colormap.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/lattice_boltzmann.h"
+#include "../common/profiler.h"
+#include "../common/stable_fluids.h"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -16,14 +23,48 @@ constexpr int kScreenHeight = 940;
 constexpr float kPi = 3.14159265358979323846f;
 constexpr float kHalfLength = 2.95f;
 
+// Tunnel flow grid: free-slip floor, roof and side walls matching the drawn frames, uniform
+// inflow at the upstream face and a zero-pressure exit. The flow runs on the same slowed
+// clock the particles use, so kFlowTimeScale seconds of flow pass per displayed second.
+constexpr float kFlowCell = 0.28f;
+constexpr int kFlowNx = 96;
+constexpr int kFlowNy = 14;
+constexpr int kFlowNz = 30;
+constexpr Vector3 kFlowOrigin = {-13.0f, 0.0f, -0.5f * kFlowNz * kFlowCell};
+constexpr float kFlowTimeScale = 0.22f;
+constexpr float kMaxFlowStep = 1.0f / 120.0f;
+constexpr float kReshapeTolerance = 0.02f;  // body changes below this keep the rasterised mask
+
+// Lattice-Boltzmann mode on the same cells. The inflow is kLatticeMaxSpeed (low Mach) at
+// the fastest wind, so a fixed number of lattice steps covers each displayed second.
+constexpr float kMaxWind = 42.0f;
+constexpr float kLatticeMaxSpeed = 0.1f;
+constexpr float kLatticeTau = 0.51f;
+constexpr float kLatticeStepsPerSecond = kFlowTimeScale * kMaxWind / (kFlowCell * kLatticeMaxSpeed);
+constexpr int kMaxLatticeStepsPerFrame = 10;
+constexpr float kLoadSmoothing = 0.04f;     // per-step blend of the fluctuating loads
+constexpr Vector3 kReferenceProbe = {-10.0f, 2.0f, 0.0f};  // free-stream pressure tap
+
 struct TunnelState {
     Vector3 bodyCenter = {0.0f, 0.60f, 0.0f};
     float windSpeed = 19.0f;
-    float wakeStrength = 0.72f;
     float bodyScale = 1.0f;
     float roofBias = 0.0f;
 };
 
+struct TunnelFlow {
+    bool lattice = false;  // D3Q19 lattice Boltzmann instead of the MAC-grid solver
+    astro_fluid::MacFluidSolver solver;
+    astro_lbm::D3Q19Solver lbm;
+    float bodyScale = -1.0f;  // shape the current solid mask was rasterised for
+    float roofBias = 0.0f;
+    float latticeDebt = 0.0f;  // fractional lattice steps carried to the next frame
+    float frontalArea = 1.0f;  // body cross-sections on the grid, world units
+    float planformArea = 1.0f;
+    float drag = 0.0f;  // smoothed coefficients
+    float lift = 0.0f;
+};
+
 struct FlowParticle {
     Vector3 pos{};
     std::deque<Vector3> trail;
@@ -32,13 +73,6 @@ struct FlowParticle {
     float lane = 0.0f;
 };
 
-struct WakeBlob {
-    Vector3 pos{};
-    float radius = 0.18f;
-    float strength = 0.0f;
-    float age = 0.0f;
-};
-
 float Saturate(float value) { return std::clamp(value, 0.0f, 1.0f); }
 
 float Lerp(float a, float b, float t) { return a + (b - a) * t; }
@@ -150,102 +184,147 @@ Vector3 SurfaceNormalLocal(Vector3 local, const TunnelState& state) {
 
 bool InsideBody(Vector3 world, const TunnelState& state) { return BodySignedDistanceLocal(ToLocal(world, state), state) <= 0.0f; }
 
-float AeroSurfaceScore(Vector3 world, const TunnelState& state, const std::vector<WakeBlob>& wake);
-
-Color AeroSurfaceColor(float score) {
-    Color clean{88, 217, 255, 255};
-    Color neutral{214, 227, 236, 255};
-    Color dirty{255, 142, 82, 255};
-    if (score < 0.5f) return LerpColor(dirty, neutral, score / 0.5f);
-    return LerpColor(neutral, clean, (score - 0.5f) / 0.5f);
-}
-
-Color StreamColor(float speedRatio) {
-    Color slow{255, 160, 90, 255};
-    Color mid{208, 230, 236, 255};
-    Color fast{105, 220, 255, 255};
-    float t = Saturate((speedRatio - 0.55f) / 0.80f);
-    if (t < 0.5f) return LerpColor(slow, mid, t / 0.5f);
-    return LerpColor(mid, fast, (t - 0.5f) / 0.5f);
+// Flow-quality score: dirty orange through neutral grey to clean cyan.
+const astro_color::Colormap kSurfaceMap = astro_color::Colormap::FromStops({
+    {0.0f, Color{255, 142, 82, 255}},
+    {0.5f, Color{214, 227, 236, 255}},
+    {1.0f, Color{88, 217, 255, 255}},
+});
+
+// Local speed over the freestream, 0.55 (slow, warm) to 1.35 (fast, cyan).
+const astro_color::Colormap kStreamMap = astro_color::Colormap::FromStops({
+    {0.0f, Color{255, 160, 90, 255}},
+    {0.5f, Color{208, 230, 236, 255}},
+    {1.0f, Color{105, 220, 255, 255}},
+}, 0.55f, 1.35f);
+
+Color AeroSurfaceColor(float score) { return kSurfaceMap(score); }
+
+Color StreamColor(float speedRatio) { return kStreamMap(speedRatio); }
+
+float LatticeInflow(const TunnelState& state) { return kLatticeMaxSpeed * state.windSpeed / kMaxWind; }
+
+void ConfigureFlow(TunnelFlow* flow, const TunnelState& state) {
+    if (flow->lattice) {
+        astro_lbm::LatticeConfig config;
+        config.nx = kFlowNx;
+        config.ny = kFlowNy;
+        config.nz = kFlowNz;
+        config.cell = kFlowCell;
+        config.origin = kFlowOrigin;
+        config.tau = kLatticeTau;
+        config.inflow = LatticeInflow(state);
+        flow->lbm.Configure(config);
+    } else {
+        astro_fluid::FluidConfig config;
+        config.nx = kFlowNx;
+        config.ny = kFlowNy;
+        config.nz = kFlowNz;
+        config.cell = kFlowCell;
+        config.origin = kFlowOrigin;
+        config.openX = true;
+        config.inflow = state.windSpeed;
+        flow->solver.Configure(config);
+    }
+    flow->bodyScale = -1.0f;
+    flow->latticeDebt = 0.0f;
+    flow->drag = 0.0f;
+    flow->lift = 0.0f;
 }
 
-Vector3 ComputeWakeVelocity(Vector3 world, const TunnelState& state, const std::vector<WakeBlob>& wake) {
-    Vector3 local = ToLocal(world, state);
-    Vector3 velocity{0.0f, 0.0f, 0.0f};
-
-    if (local.x > 2.30f * state.bodyScale) {
-        float wakeX = local.x - 2.30f * state.bodyScale;
-        float spreadZ = state.bodyScale * (0.90f + 0.22f * std::sqrt(std::max(0.0f, wakeX)));
-        float spreadY = state.bodyScale * (0.55f + 0.18f * wakeX);
-        float profile = std::exp(-(local.z * local.z) / (spreadZ * spreadZ) -
-                                 ((local.y - 0.25f * state.bodyScale) * (local.y - 0.25f * state.bodyScale)) / (spreadY * spreadY));
-        float deficit = state.wakeStrength * std::exp(-0.16f * wakeX) * profile;
-        float recirculation = 0.55f * std::exp(-0.85f * wakeX) * profile;
-        velocity.x -= state.windSpeed * deficit;
-        velocity.x -= state.windSpeed * recirculation * (wakeX < 1.2f * state.bodyScale ? 1.0f : 0.0f);
-        velocity.y += -local.y * state.windSpeed * 0.06f * profile;
+// Re-rasterises the body into the active solver's solid mask once its shape has drifted,
+// and measures the frontal (y-z) and planform (x-z) areas the coefficients divide by.
+void SyncBody(TunnelFlow* flow, const TunnelState& state) {
+    if (std::fabs(flow->bodyScale - state.bodyScale) < kReshapeTolerance &&
+        std::fabs(flow->roofBias - state.roofBias) < kReshapeTolerance) {
+        return;
     }
-
-    for (const WakeBlob& blob : wake) {
-        Vector3 fromBlob = Vector3Subtract(world, blob.pos);
-        float rho = std::sqrt(fromBlob.y * fromBlob.y + fromBlob.z * fromBlob.z);
-        float falloff = std::exp(-(rho * rho) / (2.0f * blob.radius * blob.radius)) * std::exp(-0.65f * std::fabs(fromBlob.x));
-        if (rho > 0.0001f) {
-            Vector3 tangent = {0.0f, -fromBlob.z / rho, fromBlob.y / rho};
-            velocity = Vector3Add(velocity, Vector3Scale(tangent, blob.strength * falloff));
+    const auto sdf = [&](Vector3 world) { return BodySignedDistanceLocal(ToLocal(world, state), state); };
+    if (flow->lattice) {
+        flow->lbm.SetObstacle(sdf);
+    } else {
+        flow->solver.SetObstacle(sdf);
+    }
+    std::vector<uint8_t> frontal(static_cast<size_t>(kFlowNy) * kFlowNz, 0);
+    std::vector<uint8_t> planform(static_cast<size_t>(kFlowNx) * kFlowNz, 0);
+    for (int k = 0; k < kFlowNz; ++k) {
+        for (int j = 0; j < kFlowNy; ++j) {
+            for (int i = 0; i < kFlowNx; ++i) {
+                Vector3 center = Vector3Add(kFlowOrigin, {(i + 0.5f) * kFlowCell, (j + 0.5f) * kFlowCell, (k + 0.5f) * kFlowCell});
+                if (sdf(center) >= 0.0f) continue;
+                frontal[static_cast<size_t>(k) * kFlowNy + j] = 1;
+                planform[static_cast<size_t>(k) * kFlowNx + i] = 1;
+            }
         }
     }
+    const float cellArea = kFlowCell * kFlowCell;
+    flow->frontalArea = std::max(cellArea, cellArea * static_cast<float>(std::count(frontal.begin(), frontal.end(), 1)));
+    flow->planformArea = std::max(cellArea, cellArea * static_cast<float>(std::count(planform.begin(), planform.end(), 1)));
+    flow->bodyScale = state.bodyScale;
+    flow->roofBias = state.roofBias;
+}
 
-    return velocity;
+void BlendLoads(TunnelFlow* flow, Vector3 force, float dynamicPressure, float blend) {
+    flow->drag = Lerp(flow->drag, force.x / (dynamicPressure * flow->frontalArea), blend);
+    flow->lift = Lerp(flow->lift, force.y / (dynamicPressure * flow->planformArea), blend);
 }
 
-Vector3 ComputeFlowVelocity(Vector3 world, const TunnelState& state, const std::vector<WakeBlob>& wake) {
-    Vector3 local = ToLocal(world, state);
-    float distance = BodySignedDistanceLocal(local, state);
-    if (distance <= 0.0f) return {0.0f, 0.0f, 0.0f};
-
-    Vector3 velocity{state.windSpeed, 0.0f, 0.0f};
-
-    float shell = 0.85f * state.bodyScale;
-    if (distance < shell && local.x > -3.4f * state.bodyScale && local.x < 3.2f * state.bodyScale) {
-        Vector3 normal = SurfaceNormalLocal(local, state);
-        Vector3 tangent = Vector3Subtract(velocity, Vector3Scale(normal, Vector3DotProduct(velocity, normal)));
-        if (Vector3Length(tangent) < 0.001f) tangent = {state.windSpeed, 0.0f, 0.0f};
-        tangent = Vector3Normalize(tangent);
-
-        float proximity = 1.0f - distance / shell;
-        float sideSpeedup = 1.0f + 0.35f * proximity + 0.10f * std::fabs(normal.z);
-        Vector3 guided = Vector3Scale(tangent, state.windSpeed * sideSpeedup);
-        velocity = Vector3Lerp(velocity, guided, 0.88f * proximity);
-        velocity = Vector3Add(velocity, Vector3Scale(normal, state.windSpeed * 0.08f * proximity * std::max(0.0f, -normal.x)));
+void StepFlow(TunnelFlow* flow, const TunnelState& state, float dt) {
+    SyncBody(flow, state);
+    if (flow->lattice) {
+        const float inflow = LatticeInflow(state);
+        flow->lbm.SetInflow(inflow);
+        flow->latticeDebt = std::min(flow->latticeDebt + dt * kLatticeStepsPerSecond, static_cast<float>(kMaxLatticeStepsPerFrame));
+        const int steps = static_cast<int>(flow->latticeDebt);
+        flow->latticeDebt -= static_cast<float>(steps);
+        // Momentum exchange gives the force in lattice units; times the cell area it
+        // divides by the world-unit body areas like any other force.
+        const float cellArea = kFlowCell * kFlowCell;
+        for (int s = 0; s < steps; ++s) {
+            flow->lbm.Step(1);
+            BlendLoads(flow, Vector3Scale(flow->lbm.BodyForce(), cellArea), 0.5f * inflow * inflow, kLoadSmoothing);
+        }
+        return;
     }
+    flow->solver.SetInflow(state.windSpeed);
+    float remaining = dt * kFlowTimeScale;
+    while (remaining > 0.0f) {
+        const float h = std::min(remaining, kMaxFlowStep);
+        flow->solver.Step(h);
+        remaining -= h;
+    }
+    BlendLoads(flow, flow->solver.ObstacleForce(), 0.5f * state.windSpeed * state.windSpeed, 4.0f * kLoadSmoothing);
+}
 
-    float frontEnv = std::exp(-0.95f * (local.x + 2.65f * state.bodyScale) * (local.x + 2.65f * state.bodyScale) -
-                              0.55f * local.y * local.y - 0.45f * local.z * local.z);
-    velocity.x -= state.windSpeed * 0.58f * frontEnv;
-    velocity.y += local.y * state.windSpeed * 0.10f * frontEnv;
-    velocity.z += local.z * state.windSpeed * 0.10f * frontEnv;
-
-    float roofEnv = std::exp(-0.18f * (local.x + 0.15f) * (local.x + 0.15f) -
-                             1.25f * (local.y - 1.10f * state.bodyScale) * (local.y - 1.10f * state.bodyScale) -
-                             0.45f * local.z * local.z);
-    velocity.x += state.windSpeed * 0.18f * roofEnv;
-
-    float floorEnv = std::exp(-0.12f * local.x * local.x -
-                              2.30f * (local.y - 0.08f * state.bodyScale) * (local.y - 0.08f * state.bodyScale) -
-                              0.60f * local.z * local.z);
-    velocity.x += state.windSpeed * 0.10f * floorEnv;
+Vector3 ComputeFlowVelocity(Vector3 world, const TunnelState& state, const TunnelFlow& flow) {
+    if (InsideBody(world, state)) return {0.0f, 0.0f, 0.0f};
+    if (flow.lattice) {
+        if (!flow.lbm.Contains(world)) return {state.windSpeed, 0.0f, 0.0f};
+        return Vector3Scale(flow.lbm.Velocity(world), state.windSpeed / std::max(1.0e-6f, flow.lbm.inflow()));
+    }
+    if (!flow.solver.Contains(world)) return {state.windSpeed, 0.0f, 0.0f};
+    return flow.solver.Velocity(world);
+}
 
-    velocity = Vector3Add(velocity, ComputeWakeVelocity(world, state, wake));
-    return velocity;
+// (p - p_inf) / (rho U^2 / 2) against the upstream pressure tap.
+float PressureCoefficient(Vector3 world, const TunnelState& state, const TunnelFlow& flow) {
+    if (flow.lattice) {
+        const float u = std::max(1.0e-6f, flow.lbm.inflow());
+        return (flow.lbm.MeanDensity(world) - flow.lbm.MeanDensity(kReferenceProbe)) / 3.0f / (0.5f * u * u);
+    }
+    const float u = std::max(1.0e-3f, state.windSpeed);
+    return (flow.solver.Pressure(world) - flow.solver.Pressure(kReferenceProbe)) / (0.5f * u * u);
 }
 
-float AeroSurfaceScore(Vector3 world, const TunnelState& state, const std::vector<WakeBlob>& wake) {
+// Surface shading from the simulated pressure: the Bernoulli speed ratio sqrt(1 - Cp)
+// keeps the stagnation regions dirty and the suction regions clean.
+float AeroSurfaceScore(Vector3 world, const TunnelState& state, const TunnelFlow& flow) {
     Vector3 local = ToLocal(world, state);
     Vector3 normal = SurfaceNormalLocal(local, state);
-    Vector3 samplePoint = Vector3Add(world, Vector3Scale(normal, 0.18f * state.bodyScale));
-    float speed = Vector3Length(ComputeFlowVelocity(samplePoint, state, wake));
-    float speedRatio = speed / std::max(0.001f, state.windSpeed);
+    // Step far enough off the wall to leave the body's rasterised cells.
+    float offset = std::max(0.18f * state.bodyScale, 1.2f * kFlowCell);
+    Vector3 samplePoint = Vector3Add(world, Vector3Scale(normal, offset));
+    float speedRatio = std::sqrt(std::max(0.0f, 1.0f - PressureCoefficient(samplePoint, state, flow)));
     return Saturate((speedRatio - 0.45f) / 0.85f);
 }
 
@@ -262,10 +341,10 @@ void ResetParticles(std::vector<FlowParticle>* particles) {
     for (FlowParticle& particle : *particles) ResetParticle(&particle);
 }
 
-void UpdateParticles(std::vector<FlowParticle>* particles, const TunnelState& state, const std::vector<WakeBlob>& wake, float dt) {
+void UpdateParticles(std::vector<FlowParticle>* particles, const TunnelState& state, const TunnelFlow& flow, float dt) {
     for (FlowParticle& particle : *particles) {
         particle.age += dt;
-        Vector3 velocity = ComputeFlowVelocity(particle.pos, state, wake);
+        Vector3 velocity = ComputeFlowVelocity(particle.pos, state, flow);
         particle.pos = Vector3Add(particle.pos, Vector3Scale(velocity, dt * 0.22f));
 
         bool outOfBounds = particle.pos.x > 14.0f || particle.pos.x < -14.5f || particle.pos.y < -0.5f || particle.pos.y > 5.2f ||
@@ -280,33 +359,6 @@ void UpdateParticles(std::vector<FlowParticle>* particles, const TunnelState& st
     }
 }
 
-void SpawnWakeBlobs(std::vector<WakeBlob>* wake, const TunnelState& state) {
-    for (int i = 0; i < 3; ++i) {
-        WakeBlob blob;
-        blob.pos = {state.bodyCenter.x + 2.55f * state.bodyScale + RandomFloat(0.05f, 0.35f),
-                    state.bodyCenter.y + RandomFloat(0.30f, 1.05f) * state.bodyScale,
-                    RandomFloat(-0.95f, 0.95f) * state.bodyScale};
-        blob.radius = RandomFloat(0.16f, 0.38f) * state.bodyScale;
-        blob.strength = RandomFloat(-1.0f, 1.0f) * state.windSpeed * 0.18f;
-        wake->push_back(blob);
-    }
-}
-
-void UpdateWake(std::vector<WakeBlob>* wake, const TunnelState& state, float dt) {
-    for (WakeBlob& blob : *wake) {
-        blob.age += dt;
-        blob.pos.x += state.windSpeed * 0.16f * dt;
-        blob.pos.y += 0.08f * std::sin(blob.age * 1.7f + blob.pos.z) * dt;
-        blob.pos.z += 0.12f * std::cos(blob.age * 1.2f + blob.pos.y) * dt;
-        blob.radius = std::min(blob.radius + 0.07f * dt, 0.95f * state.bodyScale);
-        blob.strength *= (1.0f - 0.18f * dt);
-    }
-
-    wake->erase(std::remove_if(wake->begin(), wake->end(),
-                               [](const WakeBlob& blob) { return blob.age > 7.0f || blob.pos.x > 13.5f; }),
-                wake->end());
-}
-
 void DrawTunnel(float time) {
     DrawCube({0.4f, -0.10f, 0.0f}, 30.0f, 0.18f, 12.5f, Color{22, 28, 40, 255});
     DrawCubeWires({0.4f, -0.10f, 0.0f}, 30.0f, 0.18f, 12.5f, Fade(Color{93, 108, 132, 255}, 0.35f));
@@ -355,7 +407,7 @@ Vector3 BodySurfacePoint(float x, float angle, const TunnelState& state) {
     return ToWorld(local, state);
 }
 
-void DrawBody(const TunnelState& state, const std::vector<WakeBlob>& wake) {
+void DrawBody(const TunnelState& state, const TunnelFlow& flow) {
     const int xSegments = 44;
     const int ringSegments = 28;
 
@@ -371,8 +423,8 @@ void DrawBody(const TunnelState& state, const std::vector<WakeBlob>& wake) {
             Vector3 p01 = BodySurfacePoint(x0, a1, state);
             Vector3 p11 = BodySurfacePoint(x1, a1, state);
 
-            float scoreA = 0.25f * (AeroSurfaceScore(p00, state, wake) + AeroSurfaceScore(p10, state, wake) +
-                                    AeroSurfaceScore(p01, state, wake) + AeroSurfaceScore(p11, state, wake));
+            float scoreA = 0.25f * (AeroSurfaceScore(p00, state, flow) + AeroSurfaceScore(p10, state, flow) +
+                                    AeroSurfaceScore(p01, state, flow) + AeroSurfaceScore(p11, state, flow));
             Color color = AeroSurfaceColor(scoreA);
             DrawTriangle3D(p00, p10, p11, color);
             DrawTriangle3D(p00, p11, p01, color);
@@ -389,9 +441,9 @@ void DrawBody(const TunnelState& state, const std::vector<WakeBlob>& wake) {
     }
 }
 
-void DrawParticles(const std::vector<FlowParticle>& particles, const TunnelState& state, const std::vector<WakeBlob>& wake) {
+void DrawParticles(const std::vector<FlowParticle>& particles, const TunnelState& state, const TunnelFlow& flow) {
     for (const FlowParticle& particle : particles) {
-        float speedRatio = Vector3Length(ComputeFlowVelocity(particle.pos, state, wake)) / std::max(0.001f, state.windSpeed);
+        float speedRatio = Vector3Length(ComputeFlowVelocity(particle.pos, state, flow)) / std::max(0.001f, state.windSpeed);
         Color base = StreamColor(speedRatio);
         for (size_t i = 1; i < particle.trail.size(); ++i) {
             float alpha = static_cast<float>(i) / static_cast<float>(particle.trail.size());
@@ -401,35 +453,46 @@ void DrawParticles(const std::vector<FlowParticle>& particles, const TunnelState
     }
 }
 
-void DrawWakeRibbons(const std::vector<WakeBlob>& wake, float time) {
-    for (const WakeBlob& blob : wake) {
-        Color tint = blob.strength >= 0.0f ? Color{103, 216, 255, 255} : Color{255, 154, 92, 255};
-        Vector3 previous{};
-        bool hasPrevious = false;
-        for (int i = 0; i < 16; ++i) {
-            float x = blob.pos.x - static_cast<float>(i) * 0.18f;
-            float radius = blob.radius + 0.02f * i;
-            float angle = time * 2.5f + static_cast<float>(i) * 0.45f * (blob.strength >= 0.0f ? 1.0f : -1.0f);
-            Vector3 point{x, blob.pos.y + std::cos(angle) * radius, blob.pos.z + std::sin(angle) * radius};
-            if (hasPrevious) DrawLine3D(previous, point, Fade(tint, 0.04f + 0.36f * (1.0f - static_cast<float>(i) / 16.0f)));
-            previous = point;
-            hasPrevious = true;
-        }
-    }
-}
-
-void DrawMinimalOverlay() {
-    DrawRectangleRounded({18.0f, 16.0f, 360.0f, 54.0f}, 0.16f, 10, Fade(Color{8, 12, 20, 255}, 0.76f));
+void DrawMinimalOverlay(const TunnelFlow& flow, const TunnelState& state) {
+    DrawRectangleRounded({18.0f, 16.0f, 440.0f, 84.0f}, 0.16f, 10, Fade(Color{8, 12, 20, 255}, 0.76f));
     DrawText("Wind Tunnel Aero View", 34, 28, 26, Color{234, 239, 245, 255});
+    char loads[128];
+    if (flow.lattice) {
+        // Lattice Reynolds number on the body length.
+        const float reynolds = flow.lbm.inflow() * 2.0f * kHalfLength * state.bodyScale / kFlowCell / flow.lbm.Viscosity();
+        std::snprintf(loads, sizeof(loads), "D3Q19 lattice Boltzmann   Re %.0f   Cd %.2f   Cl %.2f", reynolds, flow.drag, flow.lift);
+    } else {
+        std::snprintf(loads, sizeof(loads), "MAC-grid Navier-Stokes   Cd %.2f   Cl %.2f", flow.drag, flow.lift);
+    }
+    DrawText(loads, 34, 64, 18, Color{126, 224, 255, 255});
 
     DrawRectangleRounded({18.0f, static_cast<float>(kScreenHeight - 54), 560.0f, 34.0f}, 0.16f, 10, Fade(Color{8, 12, 20, 255}, 0.72f));
-    DrawText("Mouse drag: orbit   Wheel: zoom   Left/Right: wind   Up/Down: body scale   [ ]: roofline   P: pause   R: reset", 30,
+    DrawText("Mouse drag: orbit   Wheel: zoom   Left/Right: wind   Up/Down: body scale   [ ]: roofline   L: LBM/NS   P: pause   R: reset", 30,
              kScreenHeight - 45, 18, Color{189, 203, 221, 255});
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 300, 1.0f / 60.0f);
+    if (bench.enabled) {
+        TunnelState state;
+        TunnelFlow flow;
+        flow.lattice = astro_bench::HasFlag(argc, argv, "--lbm");
+        ConfigureFlow(&flow, state);
+        std::vector<FlowParticle> particles(480);
+        ResetParticles(&particles);
+        // Checksum: streamwise speed one body length behind the tail.
+        const Vector3 probe = Vector3Add(state.bodyCenter, {2.0f * kHalfLength, 0.4f, 0.0f});
+        return astro_bench::RunBench(
+            "aerodynamics_viz", bench,
+            [&](float dt) {
+                StepFlow(&flow, state, dt);
+                UpdateParticles(&particles, state, flow, dt);
+            },
+            [&]() { return ComputeFlowVelocity(probe, state, flow).x; });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Aerodynamics Wind Tunnel View");
     SetTargetFPS(60);
 
@@ -448,8 +511,8 @@ int main() {
     std::vector<FlowParticle> particles(480);
     ResetParticles(&particles);
 
-    std::vector<WakeBlob> wake;
-    float wakeTimer = 0.0f;
+    TunnelFlow flow;
+    ConfigureFlow(&flow, state);
     bool paused = false;
 
     while (!WindowShouldClose()) {
@@ -462,29 +525,26 @@ int main() {
             state.windSpeed = 19.0f;
             state.bodyScale = 1.0f;
             state.roofBias = 0.0f;
-            wake.clear();
+            ConfigureFlow(&flow, state);
             ResetParticles(&particles);
-            wakeTimer = 0.0f;
+        }
+        if (IsKeyPressed(KEY_L)) {
+            flow.lattice = !flow.lattice;
+            ConfigureFlow(&flow, state);
         }
 
         if (IsKeyDown(KEY_LEFT)) state.windSpeed = std::max(6.0f, state.windSpeed - 14.0f * dt);
-        if (IsKeyDown(KEY_RIGHT)) state.windSpeed = std::min(42.0f, state.windSpeed + 14.0f * dt);
+        if (IsKeyDown(KEY_RIGHT)) state.windSpeed = std::min(kMaxWind, state.windSpeed + 14.0f * dt);
         if (IsKeyDown(KEY_DOWN)) state.bodyScale = std::max(0.72f, state.bodyScale - 0.45f * dt);
         if (IsKeyDown(KEY_UP)) state.bodyScale = std::min(1.35f, state.bodyScale + 0.45f * dt);
         if (IsKeyDown(KEY_LEFT_BRACKET)) state.roofBias = std::max(-1.0f, state.roofBias - 0.90f * dt);
         if (IsKeyDown(KEY_RIGHT_BRACKET)) state.roofBias = std::min(1.0f, state.roofBias + 0.90f * dt);
 
-        state.wakeStrength = 0.62f + 0.16f * state.bodyScale + 0.12f * std::fabs(state.roofBias);
         UpdateOrbitCamera(&camera, &camYaw, &camPitch, &camDistance);
 
         if (!paused) {
-            wakeTimer += dt;
-            if (wakeTimer >= 0.07f) {
-                SpawnWakeBlobs(&wake, state);
-                wakeTimer = 0.0f;
-            }
-            UpdateWake(&wake, state, dt);
-            UpdateParticles(&particles, state, wake, dt);
+            StepFlow(&flow, state, std::min(dt, 1.0f / 20.0f));
+            UpdateParticles(&particles, state, flow, dt);
         }
 
         BeginDrawing();
@@ -494,17 +554,19 @@ int main() {
         DrawTunnel(time);
         DrawGrid(28, 1.0f);
         DrawWindField(time);
-        DrawWakeRibbons(wake, time);
-        DrawBody(state, wake);
-        DrawParticles(particles, state, wake);
+        DrawBody(state, flow);
+        DrawParticles(particles, state, flow);
 
         EndMode3D();
 
-        DrawMinimalOverlay();
+        DrawMinimalOverlay(flow, state);
         DrawFPS(kScreenWidth - 96, 18);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,17 +1,43 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/rigid_body.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
+#include <random>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kMass = 1.0f;
+constexpr double kRigidStep = 1.0 / 240.0;
+constexpr int kMaxRigidSubsteps = 8;
+constexpr std::array<int, 4> kBodyCounts = {16, 256, 1024, 4096};
+// Rigid bodies are simulated at unit size and only drawn smaller in the larger grids.
+constexpr Vector3 kRacketSize = {1.0f, 0.6f, 0.2f};
+constexpr float kTopDiskRadius = 0.35f;
+constexpr float kTopDiskHeight = 0.08f;
+constexpr float kTopStem = 0.55f;
+
+enum class Scene { kRadius, kTennisRacket, kHeavyTops };
+
+struct RigidScene {
+    astro_rigid::RigidBodyBatch bodies;
+    std::vector<Vector3> anchors;
+    float drawScale = 1.0f;
+    double accumulator = 0.0;
+    double stepMs = 0.0;
+};
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -22,7 +48,7 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     }
 
     *distance -= GetMouseWheelMove() * 0.6f;
-    *distance = std::clamp(*distance, 3.5f, 28.0f);
+    *distance = std::clamp(*distance, 3.5f, 60.0f);
 
     const float cp = std::cos(*pitch);
     const Vector3 offset = {
@@ -45,6 +71,120 @@ std::string Hud(float r, float omega, float I, float L, bool paused, bool autoMo
     return os.str();
 }
 
+// Anchors on a square grid centred under the camera target, `spacing` apart at unit
+// size; grids wider than four bodies shrink so the whole batch stays in view.
+void LayoutGrid(RigidScene* scene, int count, float spacing) {
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+    scene->drawScale = std::min(1.0f, 4.0f / static_cast<float>(side));
+    const float pitch = spacing * scene->drawScale;
+    scene->anchors.clear();
+    for (int i = 0; i < count; ++i) {
+        const float gx = static_cast<float>(i % side) - 0.5f * static_cast<float>(side - 1);
+        const float gz = static_cast<float>(i / side) - 0.5f * static_cast<float>(side - 1);
+        scene->anchors.push_back({gx * pitch, 0.0f, gz * pitch});
+    }
+}
+
+// Boxes spun about their intermediate axis (model y) with a small, different wobble
+// each, so the Dzhanibekov flips fall out of step across the grid.
+void BuildRacketScene(RigidScene* scene, int count) {
+    LayoutGrid(scene, count, 1.6f);
+    for (Vector3& anchor : scene->anchors) anchor.y = 0.6f;
+    std::mt19937 rng(91u);
+    std::normal_distribution<float> wobble(0.0f, 0.04f);
+    std::uniform_real_distribution<float> yaw(0.0f, 2.0f * PI);
+    scene->bodies.Clear();
+    scene->bodies.Reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        astro_rigid::BodyDesc desc;
+        desc.inertia = astro_rigid::BoxInertia(1.0, kRacketSize);
+        desc.orientation = QuaternionFromAxisAngle({0.0f, 1.0f, 0.0f}, yaw(rng));
+        desc.angularVelocity = Vector3RotateByQuaternion({wobble(rng), 5.0f, wobble(rng)}, desc.orientation);
+        scene->bodies.Add(desc);
+    }
+    scene->accumulator = 0.0;
+}
+
+// Symmetric tops on a floor pivot: tilted, spun fast about their axis, and left to
+// precess and nutate under gravity.
+void BuildTopScene(RigidScene* scene, int count) {
+    LayoutGrid(scene, count, 1.4f);
+    std::mt19937 rng(4091u);
+    std::uniform_real_distribution<float> tilt(0.15f, 0.65f);
+    std::uniform_real_distribution<float> heading(0.0f, 2.0f * PI);
+    std::uniform_real_distribution<float> spin(28.0f, 60.0f);
+    const Vector3 com = {0.0f, kTopStem, 0.0f};
+    const astro_rigid::InertiaTensor inertia =
+        astro_rigid::ShiftInertia(astro_rigid::CylinderInertia(1.0, kTopDiskRadius, kTopDiskHeight), 1.0, com);
+    scene->bodies.Clear();
+    scene->bodies.Reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        const float h = heading(rng);
+        astro_rigid::BodyDesc desc;
+        desc.inertia = inertia;
+        desc.centerOfMass = com;
+        desc.orientation = QuaternionFromAxisAngle({std::cos(h), 0.0f, std::sin(h)}, tilt(rng));
+        desc.angularVelocity = Vector3RotateByQuaternion({0.0f, spin(rng), 0.0f}, desc.orientation);
+        scene->bodies.Add(desc);
+    }
+    scene->accumulator = 0.0;
+}
+
+void StepRigidScene(RigidScene* scene, float frameDt) {
+    scene->accumulator = std::min(scene->accumulator + frameDt, kMaxRigidSubsteps * kRigidStep);
+    const double start = GetTime();
+    while (scene->accumulator >= kRigidStep) {
+        scene->bodies.Step(kRigidStep);
+        scene->accumulator -= kRigidStep;
+    }
+    scene->stepMs = 1000.0 * (GetTime() - start);
+}
+
+void DrawRigidScene(const RigidScene& scene, Scene kind) {
+    const bool wires = scene.anchors.size() <= 256;
+    for (size_t i = 0; i < scene.anchors.size(); ++i) {
+        const Vector3 anchor = scene.anchors[i];
+        rlPushMatrix();
+        rlTranslatef(anchor.x, anchor.y, anchor.z);
+        rlScalef(scene.drawScale, scene.drawScale, scene.drawScale);
+        rlMultMatrixf(MatrixToFloat(QuaternionToMatrix(scene.bodies.orientation(i))));
+        if (kind == Scene::kTennisRacket) {
+            const float tone = static_cast<float>(i % 7) / 6.0f;
+            const Color body = {static_cast<unsigned char>(120 + 110 * tone), 170, static_cast<unsigned char>(255 - 90 * tone), 255};
+            DrawCubeV({0.0f, 0.0f, 0.0f}, kRacketSize, body);
+            // The intermediate axis, which is what flips.
+            DrawLine3D({0.0f, -0.55f, 0.0f}, {0.0f, 0.55f, 0.0f}, Color{255, 220, 130, 255});
+            if (wires) DrawCubeWiresV({0.0f, 0.0f, 0.0f}, kRacketSize, Fade(BLACK, 0.5f));
+        } else {
+            DrawCylinder({0.0f, 0.0f, 0.0f}, 0.06f, 0.015f, kTopStem + 0.1f, 6, Color{190, 196, 210, 255});
+            DrawCylinder({0.0f, kTopStem - 0.5f * kTopDiskHeight, 0.0f}, kTopDiskRadius, kTopDiskRadius, kTopDiskHeight, 16,
+                         Color{255, 170, 110, 255});
+            if (wires) {
+                DrawCylinderWires({0.0f, kTopStem - 0.5f * kTopDiskHeight, 0.0f}, kTopDiskRadius, kTopDiskRadius, kTopDiskHeight, 8,
+                                  Fade(BLACK, 0.45f));
+            }
+        }
+        rlPopMatrix();
+    }
+}
+
+std::string RigidHud(const RigidScene& scene, Scene kind, bool paused) {
+    const astro_rigid::Drift drift = scene.bodies.MaxDrift();
+    std::ostringstream os;
+    os << "bodies=" << scene.bodies.size() << std::fixed << std::setprecision(2) << "  step=" << scene.stepMs << " ms"
+       << std::scientific << std::setprecision(1) << "  max |dL|/L=" << drift.momentum << "  max |dE|/E=" << drift.energy;
+    if (kind == Scene::kTennisRacket) {
+        size_t flipped = 0;
+        for (size_t i = 0; i < scene.bodies.size(); ++i) {
+            if (Vector3RotateByQuaternion({0.0f, 1.0f, 0.0f}, scene.bodies.orientation(i)).y < 0.0f) ++flipped;
+        }
+        os << std::fixed << std::setprecision(0) << "  flipped=" << 100.0 * static_cast<double>(flipped) / std::max<size_t>(1, scene.bodies.size())
+           << "%";
+    }
+    if (paused) os << "  [PAUSED]";
+    return os.str();
+}
+
 void DrawArrow(const Vector3& from, const Vector3& to, Color color) {
     DrawLine3D(from, to, color);
     Vector3 dir = Vector3Normalize(Vector3Subtract(to, from));
@@ -82,9 +222,26 @@ int main() {
     bool autoMode = true;
     float t = 0.0f;
 
+    Scene scene = Scene::kRadius;
+    size_t countIndex = 1;
+    RigidScene rigid;
+    const auto rebuildRigid = [&]() {
+        const int count = kBodyCounts[countIndex];
+        if (scene == Scene::kTennisRacket) BuildRacketScene(&rigid, count);
+        if (scene == Scene::kHeavyTops) BuildTopScene(&rigid, count);
+    };
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_A)) autoMode = !autoMode;
+        if (IsKeyPressed(KEY_M)) {
+            scene = scene == Scene::kRadius ? Scene::kTennisRacket : scene == Scene::kTennisRacket ? Scene::kHeavyTops : Scene::kRadius;
+            rebuildRigid();
+        }
+        if (IsKeyPressed(KEY_N) && scene != Scene::kRadius) {
+            countIndex = (countIndex + 1) % kBodyCounts.size();
+            rebuildRigid();
+        }
         if (IsKeyPressed(KEY_R)) {
             r = 2.2f;
             angle = 0.0f;
@@ -92,6 +249,7 @@ int main() {
             autoMode = true;
             paused = false;
             t = 0.0f;
+            rebuildRigid();
         }
 
         if (!autoMode) {
@@ -103,6 +261,29 @@ int main() {
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
+        if (scene != Scene::kRadius) {
+            if (!paused) StepRigidScene(&rigid, GetFrameTime());
+            BeginDrawing();
+            ClearBackground(Color{6, 9, 17, 255});
+            BeginMode3D(camera);
+            DrawGrid(24, 1.0f);
+            DrawRigidScene(rigid, scene);
+            EndMode3D();
+            DrawText(scene == Scene::kTennisRacket ? "Tennis-Racket Instability (spin about the intermediate axis)" : "Heavy Tops (gravity torque drives precession)",
+                     20, 18, 29, Color{232, 238, 248, 255});
+            DrawText("Hold left mouse: orbit | wheel: zoom | M scene | N body count | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
+            const std::string hud = RigidHud(rigid, scene, paused);
+            DrawText(hud.c_str(), 20, 82, 20, Color{126, 224, 255, 255});
+            DrawText(scene == Scene::kTennisRacket ? "Yellow line: intermediate axis. L stays fixed while the axis flips end over end."
+                                                   : "Only the vertical part of L is conserved; its horizontal part turns with the precession.",
+                     20, 110, 18, Color{185, 198, 215, 255});
+            DrawFPS(20, 138);
+            astro_capture::CaptureFrame();
+            ASTRO_PROFILE_FRAME();
+            EndDrawing();
+            continue;
+        }
+
         if (!paused) {
             t += GetFrameTime();
 
@@ -139,7 +320,7 @@ int main() {
         EndMode3D();
 
         DrawText("Angular Momentum Conservation (L = I * omega)", 20, 18, 29, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | A auto/manual radius | [ ] radius (manual) | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | A auto/manual radius | [ ] radius (manual) | M scene | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
 
         std::string hud = Hud(r, omega, I, L, paused, autoMode);
         DrawText(hud.c_str(), 20, 82, 20, Color{126, 224, 255, 255});
@@ -147,9 +328,12 @@ int main() {
 
         DrawFPS(20, 138);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,6 +1,9 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <deque>
@@ -113,9 +116,12 @@ int main() {
         DrawText(os.str().c_str(), 20, 82, 20, Color{126,224,255,255});
         DrawFPS(20, 110);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,12 +1,22 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/particle_soa.h"
+#include "../common/profiler.h"
+#include "../common/thread_pool.h"
+#include "../common/trail_buffer.h"
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <deque>
+#include <cstdio>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -20,6 +30,29 @@ constexpr float kM1 = 1.0f;
 constexpr float kM2 = 1.0f;
 constexpr int kTrailMax = 1800;
 
+constexpr float kPi = 3.14159265f;
+constexpr float kHalfPi = 1.57079633f;
+
+// Initial-condition ensemble: a side x side grid of pendulums released from rest over
+// theta1, theta2 in [-pi, pi], each coloured by the time its first arm flips over.
+constexpr int kEnsembleDefaultSide = 512;
+constexpr int kEnsembleMinSide = 32;
+constexpr int kEnsembleMaxSide = 1024;
+constexpr float kEnsembleDt = 0.01f;
+constexpr float kEnsembleHorizon = 40.0f;
+constexpr float kEnsembleFirstFlip = 0.5f;  // left end of the log colour ramp
+constexpr int kEnsembleBlock = 64;          // lanes skipped together once all have flipped
+constexpr int kEnsembleBatchRows = 16;      // rows per pool task, one energy-drift entry each
+constexpr int kEnsembleMaxStepsPerPass = 256;
+constexpr double kEnsembleFrameBudgetMs = 7.0;
+constexpr float kEnsemblePanelSize = 360.0f;
+// Scale for relative energy drift; the rest energy itself passes through zero.
+constexpr float kEnergyScale = (kM1 + kM2) * kG * kL1 + kM2 * kG * kL2;
+// Below this energy neither arm can reach theta = pi, so the cell never flips.
+constexpr float kFlipEnergy = -(kM1 + kM2) * kG * kL1 + kM2 * kG * kL2;
+
+using Trail = astro_render::TrailBuffer<kTrailMax>;
+
 struct State {
     float t1;
     float w1;
@@ -34,33 +67,66 @@ struct Deriv {
     float dw2;
 };
 
-Deriv Eval(const State& s) {
-    const float d = s.t1 - s.t2;
-    const float den = 2.0f * kM1 + kM2 - kM2 * std::cos(2.0f * s.t1 - 2.0f * s.t2);
+// Equations of motion given sin/cos of both angles; cos(2d) and sin(t1 - 2 t2) are
+// expanded so the ensemble kernel needs only two sincos evaluations per stage.
+inline Deriv EvalTrig(const State& s, float s1, float c1, float s2, float c2) {
+    const float sd = s1 * c2 - c1 * s2;
+    const float cd = c1 * c2 + s1 * s2;
+    const float den = 2.0f * kM1 + kM2 - kM2 * (2.0f * cd * cd - 1.0f);
+    const float sinT1Minus2T2 = sd * c2 - cd * s2;
 
     Deriv out{};
     out.dt1 = s.w1;
     out.dt2 = s.w2;
 
     out.dw1 = (
-        -kG * (2.0f * kM1 + kM2) * std::sin(s.t1)
-        -kM2 * kG * std::sin(s.t1 - 2.0f * s.t2)
-        -2.0f * std::sin(d) * kM2 * (s.w2 * s.w2 * kL2 + s.w1 * s.w1 * kL1 * std::cos(d))
+        -kG * (2.0f * kM1 + kM2) * s1
+        -kM2 * kG * sinT1Minus2T2
+        -2.0f * sd * kM2 * (s.w2 * s.w2 * kL2 + s.w1 * s.w1 * kL1 * cd)
     ) / (kL1 * den);
 
     out.dw2 = (
-        2.0f * std::sin(d) * (
+        2.0f * sd * (
             s.w1 * s.w1 * kL1 * (kM1 + kM2)
-            +kG * (kM1 + kM2) * std::cos(s.t1)
-            +s.w2 * s.w2 * kL2 * kM2 * std::cos(d)
+            +kG * (kM1 + kM2) * c1
+            +s.w2 * s.w2 * kL2 * kM2 * cd
         )
     ) / (kL2 * den);
 
     return out;
 }
 
-State StepRK4(const State& s, float dt) {
-    const Deriv k1 = Eval(s);
+Deriv Eval(const State& s) {
+    return EvalTrig(s, std::sin(s.t1), std::cos(s.t1), std::sin(s.t2), std::cos(s.t2));
+}
+
+// sin and cos of any angle, within about 3e-7, by reduction to [-pi/2, pi/2] and Taylor
+// polynomials. libm calls would keep the ensemble loop scalar; both fold branches are
+// computed and selected (no floor()) so GCC can if-convert it without -fno-trapping-math.
+inline void FastSinCos(float x, float* sinOut, float* cosOut) {
+    const float k = static_cast<float>(static_cast<int>(x * (0.5f / kPi) + std::copysign(0.5f, x)));
+    const float r = (x - k * 6.28125f) - k * 1.93530717e-3f;
+    const bool back = std::fabs(r) > kHalfPi;
+    const float mirrored = std::copysign(kPi, r) - r;
+    const float f = back ? mirrored : r;
+    const float f2 = f * f;
+    *sinOut = f * (1.0f + f2 * (-1.0f / 6.0f + f2 * (1.0f / 120.0f + f2 * (-1.0f / 5040.0f +
+                  f2 * (1.0f / 362880.0f + f2 * (-1.0f / 39916800.0f))))));
+    const float c = 1.0f + f2 * (-0.5f + f2 * (1.0f / 24.0f + f2 * (-1.0f / 720.0f +
+                    f2 * (1.0f / 40320.0f + f2 * (-1.0f / 3628800.0f + f2 * (1.0f / 479001600.0f))))));
+    *cosOut = back ? -c : c;
+}
+
+inline Deriv EvalFast(const State& s) {
+    float s1, c1, s2, c2;
+    FastSinCos(s.t1, &s1, &c1);
+    FastSinCos(s.t2, &s2, &c2);
+    return EvalTrig(s, s1, c1, s2, c2);
+}
+
+template <typename EvalFn>
+State Rk4(const State& s, float dt, EvalFn eval) {
+    const Deriv k1 = eval(s);
 
     const State s2 = {
         s.t1 + 0.5f * dt * k1.dt1,
@@ -68,7 +134,7 @@ State StepRK4(const State& s, float dt) {
         s.t2 + 0.5f * dt * k1.dt2,
         s.w2 + 0.5f * dt * k1.dw2,
     };
-    const Deriv k2 = Eval(s2);
+    const Deriv k2 = eval(s2);
 
     const State s3 = {
         s.t1 + 0.5f * dt * k2.dt1,
@@ -76,7 +142,7 @@ State StepRK4(const State& s, float dt) {
         s.t2 + 0.5f * dt * k2.dt2,
         s.w2 + 0.5f * dt * k2.dw2,
     };
-    const Deriv k3 = Eval(s3);
+    const Deriv k3 = eval(s3);
 
     const State s4 = {
         s.t1 + dt * k3.dt1,
@@ -84,7 +150,7 @@ State StepRK4(const State& s, float dt) {
         s.t2 + dt * k3.dt2,
         s.w2 + dt * k3.dw2,
     };
-    const Deriv k4 = Eval(s4);
+    const Deriv k4 = eval(s4);
 
     State out{};
     out.t1 = s.t1 + (dt / 6.0f) * (k1.dt1 + 2.0f * k2.dt1 + 2.0f * k3.dt1 + k4.dt1);
@@ -94,6 +160,10 @@ State StepRK4(const State& s, float dt) {
     return out;
 }
 
+State StepRK4(const State& s, float dt) {
+    return Rk4(s, dt, Eval);
+}
+
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 delta = GetMouseDelta();
@@ -114,6 +184,16 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     camera->position = Vector3Add(camera->target, offset);
 }
 
+// Advances one rendered frame in RK4 substeps of at most 4 ms.
+void AdvanceFrame(float frameDt, State* s, float* simTime) {
+    int steps = std::max(1, static_cast<int>(std::ceil(frameDt / 0.004f)));
+    float dt = frameDt / static_cast<float>(steps);
+    for (int i = 0; i < steps; ++i) {
+        *s = StepRK4(*s, dt);
+        *simTime += dt;
+    }
+}
+
 void Positions(const State& s, Vector3* p1, Vector3* p2) {
     const float x1 = kL1 * std::sin(s.t1);
     const float y1 = -kL1 * std::cos(s.t1);
@@ -124,27 +204,196 @@ void Positions(const State& s, Vector3* p1, Vector3* p2) {
     *p2 = {x2, y2, 0.0f};
 }
 
-void DrawTrail(const std::deque<Vector3>& trail) {
-    if (trail.size() < 2) return;
-    for (size_t i = 1; i < trail.size(); ++i) {
-        float a = static_cast<float>(i) / static_cast<float>(trail.size());
-        Color c = Color{120, 220, 255, static_cast<unsigned char>(20 + 200 * a)};
-        DrawLine3D(trail[i - 1], trail[i], c);
-    }
-}
-
-float TotalEnergy(const State& s) {
-    const float y1 = -kL1 * std::cos(s.t1);
-    const float y2 = y1 - kL2 * std::cos(s.t2);
+float EnergyTrig(const State& s, float c1, float c2, float cd) {
+    const float y1 = -kL1 * c1;
+    const float y2 = y1 - kL2 * c2;
 
     const float v1sq = kL1 * kL1 * s.w1 * s.w1;
-    const float v2sq = v1sq + kL2 * kL2 * s.w2 * s.w2 + 2.0f * kL1 * kL2 * s.w1 * s.w2 * std::cos(s.t1 - s.t2);
+    const float v2sq = v1sq + kL2 * kL2 * s.w2 * s.w2 + 2.0f * kL1 * kL2 * s.w1 * s.w2 * cd;
 
     const float T = 0.5f * kM1 * v1sq + 0.5f * kM2 * v2sq;
     const float V = kM1 * kG * y1 + kM2 * kG * y2;
     return T + V;
 }
 
+float TotalEnergy(const State& s) {
+    return EnergyTrig(s, std::cos(s.t1), std::cos(s.t2), std::cos(s.t1 - s.t2));
+}
+
+float FastEnergy(const State& s) {
+    float s1, c1, s2, c2;
+    FastSinCos(s.t1, &s1, &c1);
+    FastSinCos(s.t2, &s2, &c2);
+    return EnergyTrig(s, c1, c2, c1 * c2 + s1 * s2);
+}
+
+using astro_soa::AlignedFloats;
+
+// Lanes are separate arrays so one RK4 step over a row is a single branch-free loop.
+// flip holds the first time |theta1| or |theta2| passed pi: negative while pending,
+// +inf for cells whose energy can never reach a flip (those are never integrated).
+struct Ensemble {
+    int side = 0;
+    float time = 0.0f;
+    AlignedFloats t1, w1, t2, w2;
+    AlignedFloats e0;
+    AlignedFloats flip;
+    std::vector<Color> pixels;
+    std::vector<float> batchDrift;  // max |E - E0| / kEnergyScale over the batch's live lanes
+    std::vector<int> batchFlipped;
+    int stepsPerPass = 4;
+    bool dirty = true;
+};
+
+float EnsembleTheta1(const Ensemble& e, int x) { return -kPi + (x + 0.5f) * (2.0f * kPi / e.side); }
+float EnsembleTheta2(const Ensemble& e, int y) { return kPi - (y + 0.5f) * (2.0f * kPi / e.side); }
+
+Color FlipColor(float flipTime) {
+    const float u = std::clamp(std::log(flipTime / kEnsembleFirstFlip) / std::log(kEnsembleHorizon / kEnsembleFirstFlip), 0.0f, 1.0f);
+    const Color early = {255, 236, 170, 255};
+    const Color mid = {226, 84, 92, 255};
+    const Color late = {48, 40, 140, 255};
+    return u < 0.5f ? ColorLerp(early, mid, 2.0f * u) : ColorLerp(mid, late, 2.0f * u - 1.0f);
+}
+
+void ResetEnsemble(Ensemble* e, int side) {
+    e->side = side;
+    e->time = 0.0f;
+    const size_t n = static_cast<size_t>(side) * static_cast<size_t>(side);
+    for (AlignedFloats* a : {&e->t1, &e->w1, &e->t2, &e->w2, &e->e0, &e->flip}) a->assign(n, 0.0f);
+    e->pixels.assign(n, Color{10, 12, 18, 255});
+    const int batches = (side + kEnsembleBatchRows - 1) / kEnsembleBatchRows;
+    e->batchDrift.assign(static_cast<size_t>(batches), 0.0f);
+    e->batchFlipped.assign(static_cast<size_t>(batches), 0);
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            const size_t i = static_cast<size_t>(y) * side + x;
+            const State s{EnsembleTheta1(*e, x), 0.0f, EnsembleTheta2(*e, y), 0.0f};
+            e->t1[i] = s.t1;
+            e->t2[i] = s.t2;
+            e->e0[i] = TotalEnergy(s);
+            const bool forbidden = e->e0[i] < kFlipEnergy;
+            e->flip[i] = forbidden ? std::numeric_limits<float>::infinity() : -1.0f;
+            if (forbidden) e->pixels[i] = Color{4, 5, 9, 255};
+        }
+    }
+    e->dirty = true;
+}
+
+// Advances lanes [begin, end) by steps RK4 steps, stamping flips at the end of the
+// step that crossed. Blocks whose lanes have all flipped are skipped.
+void StepEnsembleLanes(Ensemble* e, size_t begin, size_t end, int steps, float dt) {
+    float* __restrict t1 = e->t1.data();
+    float* __restrict w1 = e->w1.data();
+    float* __restrict t2 = e->t2.data();
+    float* __restrict w2 = e->w2.data();
+    float* __restrict flip = e->flip.data();
+    for (size_t b = begin; b < end; b += kEnsembleBlock) {
+        const size_t blockEnd = std::min(end, b + kEnsembleBlock);
+        bool live = false;
+        for (size_t i = b; i < blockEnd; ++i) live |= flip[i] < 0.0f;
+        if (!live) continue;
+
+        const float time0 = e->time;
+        for (int k = 0; k < steps; ++k) {
+            const float stamp = time0 + (k + 1) * dt;
+            for (size_t i = b; i < blockEnd; ++i) {
+                const State s = Rk4(State{t1[i], w1[i], t2[i], w2[i]}, dt, EvalFast);
+                t1[i] = s.t1;
+                w1[i] = s.w1;
+                t2[i] = s.t2;
+                w2[i] = s.w2;
+                const bool over = std::max(std::fabs(s.t1), std::fabs(s.t2)) > kPi;
+                flip[i] = (flip[i] < 0.0f) & over ? stamp : flip[i];
+            }
+        }
+    }
+}
+
+// One progressive pass: every batch of rows advances stepsPerPass steps (clipped at
+// the horizon) on the shared pool, then recolours new flips and measures its drift.
+void RunEnsemblePass(Ensemble* e) {
+    if (e->time >= kEnsembleHorizon) return;
+    const int remaining = static_cast<int>(std::ceil((kEnsembleHorizon - e->time) / kEnsembleDt - 1e-3f));
+    const int steps = std::clamp(std::min(e->stepsPerPass, remaining), 1, kEnsembleMaxStepsPerPass);
+    const float passStart = e->time;
+
+    const int batches = static_cast<int>(e->batchDrift.size());
+    // Captures stay within std::function's inline buffer so a pass does not allocate.
+    astro_parallel::SharedPool().Run(batches, [e, steps, passStart](int batch) {
+        const int row0 = batch * kEnsembleBatchRows;
+        const int row1 = std::min(e->side, row0 + kEnsembleBatchRows);
+        const size_t begin = static_cast<size_t>(row0) * e->side;
+        const size_t end = static_cast<size_t>(row1) * e->side;
+        StepEnsembleLanes(e, begin, end, steps, kEnsembleDt);
+
+        float drift = 0.0f;
+        int flipped = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const float f = e->flip[i];
+            if (f > passStart && f != std::numeric_limits<float>::infinity()) e->pixels[i] = FlipColor(f);
+            if (f < 0.0f) {
+                const State s{e->t1[i], e->w1[i], e->t2[i], e->w2[i]};
+                drift = std::max(drift, std::fabs(FastEnergy(s) - e->e0[i]) / kEnergyScale);
+            } else if (f != std::numeric_limits<float>::infinity()) {
+                ++flipped;
+            }
+        }
+        e->batchDrift[static_cast<size_t>(batch)] = drift;
+        e->batchFlipped[static_cast<size_t>(batch)] = flipped;
+    });
+
+    e->time = passStart + steps * kEnsembleDt;
+    e->dirty = true;
+}
+
+// Runs one pass and doubles or halves the next pass's step count to stay near the
+// per-frame budget while the main pendulum keeps animating.
+void AdvanceEnsemble(Ensemble* e) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point t0 = Clock::now();
+    RunEnsemblePass(e);
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    if (ms < 0.5 * kEnsembleFrameBudgetMs) e->stepsPerPass = std::min(kEnsembleMaxStepsPerPass, e->stepsPerPass * 2);
+    if (ms > kEnsembleFrameBudgetMs) e->stepsPerPass = std::max(1, e->stepsPerPass / 2);
+}
+
+float WorstBatchDrift(const Ensemble& e) {
+    return e.batchDrift.empty() ? 0.0f : *std::max_element(e.batchDrift.begin(), e.batchDrift.end());
+}
+
+int FlippedCount(const Ensemble& e) {
+    int total = 0;
+    for (int n : e.batchFlipped) total += n;
+    return total;
+}
+
+Rectangle EnsemblePanel() {
+    return {kScreenWidth - kEnsemblePanelSize - 24.0f, 24.0f, kEnsemblePanelSize, kEnsemblePanelSize};
+}
+
+void DrawEnsemblePanel(const Ensemble& e, Texture2D texture, const State& start) {
+    const Rectangle panel = EnsemblePanel();
+    DrawTexturePro(texture, {0.0f, 0.0f, static_cast<float>(e.side), static_cast<float>(e.side)}, panel, {0.0f, 0.0f}, 0.0f, WHITE);
+    DrawRectangleLinesEx(panel, 2.0f, Color{150, 170, 200, 255});
+
+    // Marker at the main pendulum's release angles.
+    const float mx = panel.x + (start.t1 + kPi) / (2.0f * kPi) * panel.width;
+    const float my = panel.y + (kPi - start.t2) / (2.0f * kPi) * panel.height;
+    DrawCircleLines(static_cast<int>(mx), static_cast<int>(my), 6.0f, RAYWHITE);
+
+    const int x = static_cast<int>(panel.x);
+    const int below = static_cast<int>(panel.y + panel.height + 8.0f);
+    DrawText("theta1 -> (-pi..pi)   theta2 ^   right-click: release here", x, below, 16, Color{164, 183, 210, 255});
+    const int total = e.side * e.side;
+    DrawText(TextFormat("%d pendulums  t=%.1f/%.0f s  flipped %.1f%%", total, e.time, kEnsembleHorizon,
+                        100.0f * FlippedCount(e) / total),
+             x, below + 22, 18, Color{230, 214, 170, 255});
+    DrawText(TextFormat("worst batch |dE|/E %.2e   %s x%d threads", WorstBatchDrift(e), astro_soa::SimdPathName(),
+                        astro_parallel::SharedPool().size()),
+             x, below + 44, 18, Color{126, 224, 255, 255});
+}
+
 std::string HudText(float t, float speed, const State& s, bool paused) {
     std::ostringstream os;
     os << std::fixed << std::setprecision(3)
@@ -157,7 +406,44 @@ std::string HudText(float t, float speed, const State& s, bool paused) {
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    // --ensemble=N sets the fractal grid side; under --headless it also switches the
+    // bench to one ensemble RK4 step over the whole grid per step.
+    const int ensembleArg = astro_bench::IntArg(argc, argv, "--ensemble", 0);
+    const int ensembleSide = std::clamp(ensembleArg > 0 ? ensembleArg : kEnsembleDefaultSide, kEnsembleMinSide, kEnsembleMaxSide);
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(
+        argc, argv, ensembleArg > 0 ? 400 : 50000, ensembleArg > 0 ? kEnsembleDt : 1.0f / 60.0f);
+    if (bench.enabled && ensembleArg > 0) {
+        Ensemble ensemble;
+        ResetEnsemble(&ensemble, ensembleSide);
+        ensemble.stepsPerPass = 1;
+        const int status = astro_bench::RunBench(
+            "double_pendulum_chaos_viz_ensemble", bench,
+            [&](float) {
+                if (ensemble.time >= kEnsembleHorizon) ResetEnsemble(&ensemble, ensembleSide);
+                RunEnsemblePass(&ensemble);
+            },
+            [&]() { return static_cast<float>(FlippedCount(ensemble)); });
+        std::fprintf(stderr, "ensemble %dx%d t=%.2f worst batch |dE|/E=%.3e (%s)\n", ensembleSide, ensembleSide,
+                     ensemble.time, WorstBatchDrift(ensemble), astro_soa::SimdPathName());
+        return status;
+    }
+    if (bench.enabled) {
+        State s{2.0f, 0.0f, 1.65f, 0.0f};
+        float simTime = 0.0f;
+        Trail trail;
+        return astro_bench::RunBench(
+            "double_pendulum_chaos_viz", bench,
+            [&](float dt) {
+                AdvanceFrame(dt, &s, &simTime);
+                Vector3 p1{};
+                Vector3 p2{};
+                Positions(s, &p1, &p2);
+                trail.Push(p2);
+            },
+            [&]() { return TotalEnergy(s); });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Double Pendulum Chaos 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -168,7 +454,8 @@ int main() {
     camera.fovy = 45.0f;
     camera.projection = CAMERA_PERSPECTIVE;
 
-    State s{2.0f, 0.0f, 1.65f, 0.0f};
+    State start{2.0f, 0.0f, 1.65f, 0.0f};
+    State s = start;
     float simTime = 0.0f;
     float speed = 1.0f;
     bool paused = false;
@@ -177,20 +464,38 @@ int main() {
     float camPitch = 0.30f;
     float camDistance = 8.8f;
 
-    std::deque<Vector3> trail;
+    Trail trail;
+    astro_render::TrailRenderer trailRenderer;
+    trailRenderer.Init();
     Vector3 p1{};
     Vector3 p2{};
     Positions(s, &p1, &p2);
-    trail.push_back(p2);
+    trail.Push(p2);
+
+    Ensemble ensemble;
+    ResetEnsemble(&ensemble, ensembleSide);
+    Image ensembleImage = GenImageColor(ensembleSide, ensembleSide, BLANK);
+    Texture2D ensembleTexture = LoadTextureFromImage(ensembleImage);
+    UnloadImage(ensembleImage);
+    SetTextureFilter(ensembleTexture, TEXTURE_FILTER_BILINEAR);
+    bool showEnsemble = true;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_R)) {
-            s = {2.0f, 0.0f, 1.65f, 0.0f};
+        if (IsKeyPressed(KEY_E)) showEnsemble = !showEnsemble;
+        bool restart = IsKeyPressed(KEY_R);
+        if (showEnsemble && IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), EnsemblePanel())) {
+            const Rectangle panel = EnsemblePanel();
+            const Vector2 m = GetMousePosition();
+            start = {-kPi + (m.x - panel.x) / panel.width * 2.0f * kPi, 0.0f, kPi - (m.y - panel.y) / panel.height * 2.0f * kPi, 0.0f};
+            restart = true;
+        }
+        if (restart) {
+            s = start;
             simTime = 0.0f;
-            trail.clear();
+            trail.Clear();
             Positions(s, &p1, &p2);
-            trail.push_back(p2);
+            trail.Push(p2);
         }
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) speed = std::min(8.0f, speed + 0.25f);
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) speed = std::max(0.25f, speed - 0.25f);
@@ -198,18 +503,18 @@ int main() {
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
         if (!paused) {
-            float frameDt = GetFrameTime() * speed;
-            int steps = std::max(1, static_cast<int>(std::ceil(frameDt / 0.004f)));
-            float dt = frameDt / static_cast<float>(steps);
-            for (int i = 0; i < steps; ++i) {
-                s = StepRK4(s, dt);
-                simTime += dt;
+            AdvanceFrame(GetFrameTime() * speed, &s, &simTime);
+        }
+        if (showEnsemble) {
+            AdvanceEnsemble(&ensemble);
+            if (ensemble.dirty) {
+                UpdateTexture(ensembleTexture, ensemble.pixels.data());
+                ensemble.dirty = false;
             }
         }
 
         Positions(s, &p1, &p2);
-        trail.push_back(p2);
-        if (static_cast<int>(trail.size()) > kTrailMax) trail.pop_front();
+        trail.Push(p2);
 
         BeginDrawing();
         ClearBackground(Color{6, 9, 16, 255});
@@ -219,7 +524,9 @@ int main() {
         const Vector3 pivot = {0.0f, 0.0f, 0.0f};
         DrawSphere(pivot, 0.06f, Color{230, 230, 240, 255});
 
-        DrawTrail(trail);
+        trailRenderer.Clear();
+        trailRenderer.Add(trail, Color{120, 220, 255, 220}, 20);
+        trailRenderer.Draw();
 
         DrawLine3D(pivot, p1, Color{240, 200, 120, 255});
         DrawLine3D(p1, p2, Color{130, 205, 255, 255});
@@ -230,14 +537,20 @@ int main() {
         EndMode3D();
 
         DrawText("Double Pendulum Chaos (3D)", 20, 18, 30, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | P pause | +/- speed | R reset", 20, 56, 20, Color{164, 183, 210, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | P pause | +/- speed | R reset | E ensemble", 20, 56, 20, Color{164, 183, 210, 255});
         std::string hud = HudText(simTime, speed, s, paused);
         DrawText(hud.c_str(), 20, 86, 21, Color{126, 224, 255, 255});
         DrawFPS(20, 118);
+        if (showEnsemble) DrawEnsemblePanel(ensemble, ensembleTexture, start);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    UnloadTexture(ensembleTexture);
+    trailRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
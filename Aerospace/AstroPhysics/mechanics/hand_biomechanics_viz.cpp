@@ -1,10 +1,11 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
 #include "../vision/hand_tracking_scene_shared.h"
 
 #include <algorithm>
 #include <array>
-#include <cerrno>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -13,29 +14,22 @@
 #include <string>
 #include <vector>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "Ws2_32.lib")
-#else
-#include <arpa/inet.h>
-#include <fcntl.h>
-#include <sys/socket.h>
-#include <unistd.h>
-#endif
-
 namespace {
 
+using astro_hand::Average;
+using astro_hand::Clamp01;
+using astro_hand::DrawHandModel;
+using astro_hand::DrawStarfieldBackdrop;
+using astro_hand::HandGeometry;
+using astro_hand::HandVisualStyle;
+using astro_hand::LerpFloat;
+using astro_hand::SafeNormalize;
+using astro_hand::UpdateOrbitCameraDragOnly;
+
 constexpr int kScreenWidth = 1360;
 constexpr int kScreenHeight = 860;
-
-constexpr float kBoneSides = 10.0f;
-constexpr float kJointSphereScale = 1.18f;
-constexpr int kUdpPort = 50515;
-constexpr int kFrameUdpPort = 50516;
-constexpr float kLinkTimeout = 0.75f;
-constexpr float kTrackedDepthPalmRef = 0.155f;
-constexpr float kTrackedDepthRange = 5.4f;
+// Joint angles are read off a mostly still hand: filter harder and barely predict.
+constexpr astro_hand::HandFilterConfig kHandFilter = {{0.6f, 5.0f, 1.0f}, 6.0f, 0.0f, 0.0f, 0.03f};
 
 enum class HandPreset {
     Relaxed = 0,
@@ -66,15 +60,6 @@ struct HandControls {
     std::array<float, 5> fingerAdd = {0.0f, 0.0f, 0.0f, 0.02f, 0.05f};
 };
 
-struct HandGeometry {
-    std::array<Vector3, 21> landmarks{};
-    std::array<float, 21> radii{};
-    std::array<Vector3, 7> palmRim{};
-    Vector3 palmCenter{};
-    Vector3 wristLeft{};
-    Vector3 wristRight{};
-};
-
 struct HandKinematics {
     bool active = false;
     bool pinched = false;
@@ -92,259 +77,11 @@ struct BallState {
     int grabbedBy = -1;
 };
 
-struct TrackedHandPacket {
-    bool valid = false;
-    bool pinched = false;
-    float score = 0.0f;
-    std::array<Vector3, 21> landmarks{};
-};
-
-struct TrackingPacket {
-    double timestamp = 0.0;
-    TrackedHandPacket left{};
-    TrackedHandPacket right{};
-};
-
-class UdpHandReceiver {
-  public:
-    bool Start(uint16_t port) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return false;
-#endif
-        socket_ = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
-        if (socket_ < 0) return false;
-
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        addr.sin_port = htons(port);
-        if (bind(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
-            Close();
-            return false;
-        }
-
-#ifdef _WIN32
-        u_long mode = 1;
-        if (ioctlsocket(socket_, FIONBIO, &mode) != 0) {
-            Close();
-            return false;
-        }
-#else
-        const int flags = fcntl(socket_, F_GETFL, 0);
-        if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0) {
-            Close();
-            return false;
-        }
-#endif
-        ready_ = true;
-        return true;
-    }
-
-    void Close() {
-        if (socket_ >= 0) {
-#ifdef _WIN32
-            closesocket(socket_);
-            WSACleanup();
-#else
-            close(socket_);
-#endif
-            socket_ = -1;
-        }
-        ready_ = false;
-    }
-
-    ~UdpHandReceiver() {
-        Close();
-    }
-
-    bool Poll(TrackingPacket& outPacket, int& packetsRead) {
-        packetsRead = 0;
-        if (!ready_) return false;
-
-        bool gotAny = false;
-        std::array<char, 4096> buffer{};
-        while (true) {
-            sockaddr_in src{};
-            socklen_t srcLen = sizeof(src);
-            const int n = recvfrom(
-                socket_,
-                buffer.data(),
-                static_cast<int>(buffer.size()) - 1,
-                0,
-                reinterpret_cast<sockaddr*>(&src),
-                &srcLen);
-            if (n <= 0) {
-#ifdef _WIN32
-                if (WSAGetLastError() == WSAEWOULDBLOCK) break;
-#else
-                if (errno == EWOULDBLOCK || errno == EAGAIN) break;
-#endif
-                break;
-            }
-
-            buffer[static_cast<size_t>(n)] = '\0';
-            TrackingPacket parsed{};
-            if (ParsePacket(buffer.data(), parsed)) {
-                outPacket = parsed;
-                gotAny = true;
-                packetsRead++;
-            }
-        }
-        return gotAny;
-    }
-
-    bool ready() const { return ready_; }
-
-  private:
-    static bool ParsePacket(const char* text, TrackingPacket& outPacket) {
-        std::vector<float> values;
-        values.reserve(133);
-
-        const char* p = text;
-        char* end = nullptr;
-        while (*p != '\0') {
-            const float value = std::strtof(p, &end);
-            if (end == p) {
-                if (*p == ',' || *p == '\n' || *p == '\r' || *p == ' ' || *p == '\t') {
-                    ++p;
-                    continue;
-                }
-                return false;
-            }
-            values.push_back(value);
-            p = end;
-            while (*p == ',' || *p == '\n' || *p == '\r' || *p == ' ' || *p == '\t') ++p;
-        }
-
-        if (values.size() < 133) return false;
-
-        outPacket.timestamp = static_cast<double>(values[0]);
-        auto readHand = [&](size_t start, TrackedHandPacket& hand) {
-            hand.valid = values[start] > 0.5f;
-            hand.pinched = values[start + 1] > 0.5f;
-            hand.score = values[start + 2];
-            size_t idx = start + 3;
-            for (Vector3& point : hand.landmarks) {
-                point = {values[idx], values[idx + 1], values[idx + 2]};
-                idx += 3;
-            }
-        };
-
-        readHand(1, outPacket.left);
-        readHand(67, outPacket.right);
-        return true;
-    }
-
-    int socket_ = -1;
-    bool ready_ = false;
-};
-
-class UdpFrameReceiver {
-  public:
-    bool Start(uint16_t port) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return false;
-#endif
-        socket_ = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
-        if (socket_ < 0) return false;
-
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        addr.sin_port = htons(port);
-        if (bind(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
-            Close();
-            return false;
-        }
-
-#ifdef _WIN32
-        u_long mode = 1;
-        if (ioctlsocket(socket_, FIONBIO, &mode) != 0) {
-            Close();
-            return false;
-        }
-#else
-        const int flags = fcntl(socket_, F_GETFL, 0);
-        if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0) {
-            Close();
-            return false;
-        }
-#endif
-        ready_ = true;
-        return true;
-    }
-
-    void Close() {
-        if (socket_ >= 0) {
-#ifdef _WIN32
-            closesocket(socket_);
-            WSACleanup();
-#else
-            close(socket_);
-#endif
-            socket_ = -1;
-        }
-        ready_ = false;
-    }
-
-    ~UdpFrameReceiver() {
-        Close();
-    }
-
-    bool Poll(std::vector<unsigned char>& outFrameBytes, int& packetsRead) {
-        packetsRead = 0;
-        if (!ready_) return false;
-
-        bool gotAny = false;
-        std::array<unsigned char, 65536> buffer{};
-        while (true) {
-            sockaddr_in src{};
-            socklen_t srcLen = sizeof(src);
-            const int n = recvfrom(
-                socket_,
-                reinterpret_cast<char*>(buffer.data()),
-                static_cast<int>(buffer.size()),
-                0,
-                reinterpret_cast<sockaddr*>(&src),
-                &srcLen);
-            if (n <= 0) {
-#ifdef _WIN32
-                if (WSAGetLastError() == WSAEWOULDBLOCK) break;
-#else
-                if (errno == EWOULDBLOCK || errno == EAGAIN) break;
-#endif
-                break;
-            }
-
-            outFrameBytes.assign(buffer.begin(), buffer.begin() + n);
-            gotAny = true;
-            packetsRead++;
-        }
-        return gotAny;
-    }
-
-    bool ready() const { return ready_; }
-
-  private:
-    int socket_ = -1;
-    bool ready_ = false;
-};
-
-float Clamp01(float v) {
-    return std::clamp(v, 0.0f, 1.0f);
-}
-
 float Smooth01(float x) {
     x = Clamp01(x);
     return x * x * (3.0f - 2.0f * x);
 }
 
-float LerpFloat(float a, float b, float t) {
-    return a + (b - a) * t;
-}
-
 Vector3 RotateAroundAxis(Vector3 v, Vector3 axis, float angle) {
     axis = Vector3Normalize(axis);
     const float c = std::cos(angle);
@@ -366,12 +103,6 @@ Vector3 LocalToWorld(Vector3 origin, Vector3 wristAngles, float sideSign, Vector
     return Vector3Add(origin, RotateEulerXYZ(mirrored, wristAngles));
 }
 
-Vector3 Average(const std::initializer_list<Vector3>& pts) {
-    Vector3 sum{0.0f, 0.0f, 0.0f};
-    for (const Vector3& p : pts) sum = Vector3Add(sum, p);
-    return Vector3Scale(sum, 1.0f / static_cast<float>(pts.size()));
-}
-
 HandControls PresetControls(HandPreset preset) {
     HandControls c;
     switch (preset) {
@@ -562,208 +293,14 @@ HandGeometry BuildHandGeometry(const HandControls& controls, Vector3 origin, boo
     return g;
 }
 
-float LandmarkPalmNorm(const std::array<Vector3, 21>& pts) {
-    const auto dist2 = [&](int a, int b) {
-        const float dx = pts[static_cast<size_t>(a)].x - pts[static_cast<size_t>(b)].x;
-        const float dy = pts[static_cast<size_t>(a)].y - pts[static_cast<size_t>(b)].y;
-        return std::sqrt(dx * dx + dy * dy);
-    };
-    return std::max(1.0e-4f, (dist2(0, 5) + dist2(0, 17) + dist2(5, 17)) / 3.0f);
-}
-
-Vector3 SafeNormalize(Vector3 v, Vector3 fallback) {
-    if (Vector3Length(v) < 1.0e-4f) return fallback;
-    return Vector3Normalize(v);
-}
-
-HandGeometry BlendGeometry(const HandGeometry& a, const HandGeometry& b, float t) {
-    HandGeometry out{};
-    for (size_t i = 0; i < out.landmarks.size(); ++i) {
-        out.landmarks[i] = Vector3Lerp(a.landmarks[i], b.landmarks[i], t);
-        out.radii[i] = LerpFloat(a.radii[i], b.radii[i], t);
-    }
-    for (size_t i = 0; i < out.palmRim.size(); ++i) {
-        out.palmRim[i] = Vector3Lerp(a.palmRim[i], b.palmRim[i], t);
-    }
-    out.palmCenter = Vector3Lerp(a.palmCenter, b.palmCenter, t);
-    out.wristLeft = Vector3Lerp(a.wristLeft, b.wristLeft, t);
-    out.wristRight = Vector3Lerp(a.wristRight, b.wristRight, t);
-    return out;
-}
-
-HandGeometry OffsetGeometry(const HandGeometry& g, Vector3 offset) {
-    HandGeometry out = g;
-    for (Vector3& point : out.landmarks) point = Vector3Add(point, offset);
-    for (Vector3& point : out.palmRim) point = Vector3Add(point, offset);
-    out.palmCenter = Vector3Add(out.palmCenter, offset);
-    out.wristLeft = Vector3Add(out.wristLeft, offset);
-    out.wristRight = Vector3Add(out.wristRight, offset);
-    return out;
-}
-
-float EstimateTrackedDepthShift(const TrackedHandPacket& packet) {
-    // MediaPipe normalized landmarks do not provide stable absolute camera depth.
-    // Use palm size in image space as a smoother depth hint for whole-hand motion.
-    const float palm = LandmarkPalmNorm(packet.landmarks);
-    const float relative = std::clamp((kTrackedDepthPalmRef / palm) - 1.0f, -0.55f, 0.90f);
-    return -relative * kTrackedDepthRange;
-}
-
-bool UpdatePreviewTexture(Texture2D& texture, const std::vector<unsigned char>& jpgBytes) {
-    if (jpgBytes.empty()) return false;
-
-    Image image = LoadImageFromMemory(".jpg", jpgBytes.data(), static_cast<int>(jpgBytes.size()));
-    if (image.data == nullptr) return false;
-
-    if (texture.id > 0 && texture.width == image.width && texture.height == image.height) {
-        UpdateTexture(texture, image.data);
-    } else {
-        if (texture.id > 0) {
-            UnloadTexture(texture);
-            texture = Texture2D{};
-        }
-        texture = LoadTextureFromImage(image);
-        SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
-    }
-
-    UnloadImage(image);
-    return texture.id > 0;
-}
-
-HandGeometry BuildTrackedGeometry(const TrackedHandPacket& packet, bool rightHand) {
-    HandGeometry g{};
-    constexpr std::array<float, 21> kRadii = {
-        0.34f, 0.24f, 0.22f, 0.19f, 0.16f,
-        0.23f, 0.20f, 0.17f, 0.14f,
-        0.23f, 0.20f, 0.17f, 0.14f,
-        0.21f, 0.18f, 0.15f, 0.12f,
-        0.19f, 0.16f, 0.13f, 0.10f,
-    };
-
-    const Vector3 wristNorm = packet.landmarks[0];
-    const Vector3 indexNorm = packet.landmarks[5];
-    const Vector3 pinkyNorm = packet.landmarks[17];
-    const Vector3 middleNorm = packet.landmarks[9];
-    const Vector3 ringNorm = packet.landmarks[13];
-    const Vector3 knuckleCenterNorm = Vector3Scale(Vector3Add(Vector3Add(indexNorm, middleNorm), Vector3Add(ringNorm, pinkyNorm)), 0.25f);
-    const Vector3 sideKnuckleCenterNorm = Vector3Scale(Vector3Add(indexNorm, pinkyNorm), 0.5f);
-    const Vector3 stableAnchorNorm = Vector3Add(Vector3Scale(wristNorm, 0.62f), Vector3Scale(sideKnuckleCenterNorm, 0.38f));
-    const Vector3 rootAnchorNorm = Vector3Add(Vector3Scale(wristNorm, 0.88f), Vector3Scale(sideKnuckleCenterNorm, 0.12f));
-    const float palm = LandmarkPalmNorm(packet.landmarks);
-
-    const Vector3 origin = {
-        (rootAnchorNorm.x - 0.50f) * 24.0f + (rightHand ? 0.4f : -0.4f),
-        2.6f + (0.66f - rootAnchorNorm.y) * 8.2f,
-        rightHand ? 0.45f : -0.45f,
-    };
-
-    const float xyScale = 3.8f / palm;
-    const float zScale = 5.2f / palm;
-
-    for (size_t i = 0; i < g.landmarks.size(); ++i) {
-        const Vector3 rel = Vector3Subtract(packet.landmarks[i], rootAnchorNorm);
-        const Vector3 local = {
-            rel.x * xyScale,
-            -rel.y * xyScale,
-            -rel.z * zScale,
-        };
-        g.landmarks[i] = Vector3Add(origin, local);
-        g.radii[i] = kRadii[i];
-    }
-
-    const Vector3 across = Vector3Subtract(g.landmarks[17], g.landmarks[5]);
-    const Vector3 wristAxis = SafeNormalize(across, {1.0f, 0.0f, 0.0f});
-    const Vector3 forearmDir = SafeNormalize(Vector3Subtract(g.landmarks[0], Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]})), {0.0f, -1.0f, 0.0f});
-
-    g.wristLeft = Vector3Add(Vector3Add(g.landmarks[0], Vector3Scale(wristAxis, -0.88f)), Vector3Scale(forearmDir, 0.18f));
-    g.wristRight = Vector3Add(Vector3Add(g.landmarks[0], Vector3Scale(wristAxis, 0.88f)), Vector3Scale(forearmDir, 0.18f));
-    g.palmRim = {
-        g.wristLeft,
-        g.landmarks[1],
-        g.landmarks[5],
-        g.landmarks[9],
-        g.landmarks[13],
-        g.landmarks[17],
-        g.wristRight,
-    };
-    g.palmCenter = Average({g.landmarks[0], g.landmarks[1], g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]});
-
-    return g;
-}
-
-void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
-    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-        const Vector2 d = GetMouseDelta();
-        *yaw -= d.x * 0.0032f;
-        *pitch += d.y * 0.0030f;
-        *pitch = std::clamp(*pitch, -1.35f, 1.35f);
-    }
-
-    *distance -= GetMouseWheelMove() * 0.7f;
-    *distance = std::clamp(*distance, 6.0f, 28.0f);
-
-    const float cp = std::cos(*pitch);
-    const Vector3 offset = {
-        *distance * cp * std::cos(*yaw),
-        *distance * std::sin(*pitch),
-        *distance * cp * std::sin(*yaw),
-    };
-    camera->position = Vector3Add(camera->target, offset);
-}
-
-struct HandVisualStyle {
-    Color palm{};
-    Color bone{};
-    Color tip{};
-    Color tendon{};
-    Color accent{};
-    Color shadow{};
-};
-
-HandVisualStyle StyleForHand(bool rightHand, bool tracked) {
+// Colors for the keyboard-driven demo hands; tracked hands use astro_hand::StyleForHand.
+HandVisualStyle DemoStyleForHand(bool rightHand) {
     if (rightHand) {
-        return tracked
-            ? HandVisualStyle{Color{236, 184, 146, 255}, Color{212, 155, 118, 255}, Color{248, 212, 176, 255},
-                              Color{142, 96, 74, 255}, Color{255, 210, 126, 255}, Color{76, 44, 28, 120}}
-            : HandVisualStyle{Color{222, 182, 146, 255}, Color{205, 156, 120, 255}, Color{235, 198, 166, 255},
-                              Color{142, 104, 82, 255}, Color{255, 206, 118, 255}, Color{76, 44, 28, 120}};
+        return HandVisualStyle{Color{222, 182, 146, 255}, Color{205, 156, 120, 255}, Color{235, 198, 166, 255},
+                               Color{142, 104, 82, 255}, Color{255, 206, 118, 255}, Color{76, 44, 28, 120}};
     }
-    return tracked
-        ? HandVisualStyle{Color{150, 190, 236, 255}, Color{112, 156, 214, 255}, Color{188, 220, 255, 255},
-                          Color{74, 98, 148, 255}, Color{132, 224, 255, 255}, Color{28, 40, 76, 120}}
-        : HandVisualStyle{Color{144, 180, 228, 255}, Color{104, 146, 205, 255}, Color{176, 210, 248, 255},
-                          Color{72, 96, 138, 255}, Color{126, 214, 255, 255}, Color{28, 40, 76, 120}};
-}
-
-void UpdateHandKinematics(
-    HandKinematics& out,
-    const HandGeometry& g,
-    bool active,
-    bool pinched,
-    Vector3* prevAnchor,
-    bool* prevValid,
-    float dt) {
-    out.active = active;
-    out.pinched = pinched;
-    if (!active) {
-        out.velocity = {0.0f, 0.0f, 0.0f};
-        *prevValid = false;
-        return;
-    }
-
-    out.palm = g.palmCenter;
-    out.indexTip = g.landmarks[8];
-    out.thumbTip = g.landmarks[4];
-    out.grabPoint = Vector3Scale(Vector3Add(out.indexTip, out.thumbTip), 0.5f);
-
-    const Vector3 anchor = pinched ? out.grabPoint : out.palm;
-    if (*prevValid && dt > 1.0e-4f) {
-        out.velocity = Vector3Scale(Vector3Subtract(anchor, *prevAnchor), 1.0f / dt);
-    } else {
-        out.velocity = {0.0f, 0.0f, 0.0f};
-    }
-    *prevAnchor = anchor;
-    *prevValid = true;
+    return HandVisualStyle{Color{144, 180, 228, 255}, Color{104, 146, 205, 255}, Color{176, 210, 248, 255},
+                           Color{72, 96, 138, 255}, Color{126, 214, 255, 255}, Color{28, 40, 76, 120}};
 }
 
 void UpdateBall(
@@ -859,139 +396,6 @@ void DrawBall(const BallState& ball) {
         Color{255, 236, 160, 200});
 }
 
-void DrawBone(Vector3 a, Vector3 b, float ra, float rb, Color color) {
-    DrawCylinderEx(a, b, ra, rb, static_cast<int>(kBoneSides), color);
-    DrawCylinderWiresEx(a, b, ra, rb, static_cast<int>(kBoneSides), Fade(BLACK, 0.25f));
-}
-
-void DrawPalmSurface(const HandGeometry& g, Color palmColor, Color highlightColor) {
-    for (size_t i = 0; i + 1 < g.palmRim.size(); ++i) {
-        DrawTriangle3D(g.palmCenter, g.palmRim[i], g.palmRim[i + 1], palmColor);
-    }
-
-    const Color webColor = Fade(palmColor, 0.92f);
-    DrawTriangle3D(g.landmarks[1], g.landmarks[5], g.landmarks[6], webColor);
-    DrawTriangle3D(g.landmarks[5], g.landmarks[9], g.landmarks[6], webColor);
-    DrawTriangle3D(g.landmarks[9], g.landmarks[13], g.landmarks[10], webColor);
-    DrawTriangle3D(g.landmarks[13], g.landmarks[17], g.landmarks[14], webColor);
-    DrawTriangle3D(g.landmarks[1], g.landmarks[5], g.palmCenter, Fade(highlightColor, 0.35f));
-    DrawTriangle3D(g.landmarks[5], g.landmarks[9], g.palmCenter, Fade(highlightColor, 0.18f));
-}
-
-void DrawPalmLines(const HandGeometry& g, Color color) {
-    for (size_t i = 0; i + 1 < g.palmRim.size(); ++i) {
-        DrawLine3D(g.palmRim[i], g.palmRim[i + 1], color);
-    }
-    DrawLine3D(g.wristLeft, g.wristRight, color);
-    DrawLine3D(g.landmarks[0], g.landmarks[5], Fade(color, 0.85f));
-    DrawLine3D(g.landmarks[0], g.landmarks[9], Fade(color, 0.90f));
-    DrawLine3D(g.landmarks[0], g.landmarks[13], Fade(color, 0.85f));
-    DrawLine3D(g.landmarks[0], g.landmarks[17], Fade(color, 0.80f));
-}
-
-void DrawTendonLines(const HandGeometry& g, Color color) {
-    const std::array<int, 4> fingerStarts = {5, 9, 13, 17};
-    for (int idx : fingerStarts) {
-        DrawLine3D(g.landmarks[0], g.landmarks[idx + 1], Fade(color, 0.65f));
-        DrawLine3D(g.landmarks[idx], g.landmarks[idx + 2], Fade(color, 0.50f));
-    }
-    DrawLine3D(g.landmarks[1], g.landmarks[3], Fade(color, 0.55f));
-}
-
-void DrawForearm(const HandGeometry& g, const HandVisualStyle& style) {
-    const Vector3 wristMid = Vector3Scale(Vector3Add(g.wristLeft, g.wristRight), 0.5f);
-    const Vector3 knuckleMid = Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]});
-    const Vector3 dir = SafeNormalize(Vector3Subtract(wristMid, knuckleMid), {0.0f, -1.0f, 0.0f});
-    const Vector3 forearmEnd = Vector3Add(wristMid, Vector3Scale(dir, 1.55f));
-    DrawBone(wristMid, forearmEnd, 0.48f, 0.34f, Fade(style.bone, 0.82f));
-    DrawSphere(forearmEnd, 0.34f, Fade(style.palm, 0.78f));
-}
-
-void DrawKnuckleBridge(const HandGeometry& g, const HandVisualStyle& style) {
-    const std::array<int, 4> ridge = {5, 9, 13, 17};
-    for (size_t i = 0; i + 1 < ridge.size(); ++i) {
-        DrawLine3D(g.landmarks[ridge[i]], g.landmarks[ridge[i + 1]], Fade(style.accent, 0.55f));
-    }
-    for (int idx : ridge) {
-        DrawSphere(g.landmarks[idx], g.radii[idx] * 0.72f, Fade(style.accent, 0.55f));
-    }
-}
-
-void DrawPinchCue(const HandGeometry& g, const HandVisualStyle& style) {
-    const Vector3 thumb = g.landmarks[4];
-    const Vector3 index = g.landmarks[8];
-    const Vector3 center = Vector3Scale(Vector3Add(thumb, index), 0.5f);
-    DrawLine3D(thumb, index, style.accent);
-    DrawSphere(center, 0.16f, Fade(style.accent, 0.92f));
-    DrawSphere(thumb, 0.10f, style.accent);
-    DrawSphere(index, 0.10f, style.accent);
-}
-
-void DrawPalmNormalCue(const HandGeometry& g, const HandVisualStyle& style) {
-    const Vector3 across = Vector3Subtract(g.landmarks[17], g.landmarks[5]);
-    const Vector3 fingers = Vector3Subtract(Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]}), g.landmarks[0]);
-    Vector3 normal = SafeNormalize(Vector3CrossProduct(across, fingers), {0.0f, 0.0f, 1.0f});
-    if (normal.z < 0.0f) normal = Vector3Scale(normal, -1.0f);
-    const Vector3 tip = Vector3Add(g.palmCenter, Vector3Scale(normal, 0.72f));
-    DrawLine3D(g.palmCenter, tip, style.accent);
-    DrawSphere(tip, 0.10f, style.accent);
-}
-
-void DrawHandShadow(const HandGeometry& g, const HandVisualStyle& style) {
-    for (const Vector3& point : g.palmRim) {
-        const Vector3 shadow = {point.x, 0.021f, point.z};
-        DrawSphere(shadow, 0.18f, Fade(style.shadow, 0.25f));
-    }
-}
-
-void DrawHandModel(const HandGeometry& g, const HandVisualStyle& style, bool showLandmarks, bool pinched) {
-    DrawHandShadow(g, style);
-    DrawForearm(g, style);
-    DrawPalmSurface(g, style.palm, style.tip);
-
-    const std::array<std::pair<int, int>, 20> bones = {{
-        {0, 1}, {1, 2}, {2, 3}, {3, 4},
-        {0, 5}, {5, 6}, {6, 7}, {7, 8},
-        {0, 9}, {9, 10}, {10, 11}, {11, 12},
-        {0, 13}, {13, 14}, {14, 15}, {15, 16},
-        {0, 17}, {17, 18}, {18, 19}, {19, 20},
-    }};
-
-    for (const auto& [a, b] : bones) {
-        const bool fingertipBone = (b == 4 || b == 8 || b == 12 || b == 16 || b == 20);
-        DrawBone(g.landmarks[a], g.landmarks[b], g.radii[a] * 0.78f, g.radii[b] * 0.82f, fingertipBone ? style.tip : style.bone);
-    }
-
-    const std::array<int, 4> metacarpalTargets = {5, 9, 13, 17};
-    for (int idx : metacarpalTargets) {
-        DrawBone(g.landmarks[0], g.landmarks[idx], 0.14f, g.radii[idx] * 0.90f, Fade(style.bone, 0.75f));
-    }
-    DrawBone(g.landmarks[0], g.landmarks[1], 0.16f, g.radii[1] * 0.95f, Fade(style.bone, 0.72f));
-
-    DrawTendonLines(g, style.tendon);
-    DrawPalmLines(g, Fade(style.tendon, 0.65f));
-    DrawKnuckleBridge(g, style);
-
-    for (size_t i = 0; i < g.landmarks.size(); ++i) {
-        const bool tip = (i == 4 || i == 8 || i == 12 || i == 16 || i == 20);
-        DrawSphere(g.landmarks[i], g.radii[i] * kJointSphereScale, tip ? style.tip : style.palm);
-    }
-
-    DrawSphere(g.palmCenter, 0.33f, Fade(style.palm, 0.85f));
-    DrawSphere(g.landmarks[1], 0.18f, Fade(style.accent, 0.30f));
-    DrawPalmNormalCue(g, style);
-
-    if (pinched) {
-        DrawPinchCue(g, style);
-    }
-
-    if (showLandmarks) {
-        for (size_t i = 0; i < g.landmarks.size(); ++i) {
-            DrawSphere(g.landmarks[i], g.radii[i] * 0.42f, style.accent);
-        }
-    }
-}
-
 std::string HudLine(const HandControls& c, bool autoDemo, bool showLandmarks, bool showMirrorDemo) {
     std::ostringstream os;
     os << std::fixed << std::setprecision(2)
@@ -1014,18 +418,6 @@ void DrawLandmarkLabels(const HandGeometry& g, const Camera3D& camera) {
     }
 }
 
-void DrawStarfieldBackdrop(int count, unsigned int seed, float drift, Color baseColor) {
-    for (int i = 0; i < count; ++i) {
-        const float sx = static_cast<float>((seed * 1103515245u + static_cast<unsigned int>(i * 7919)) % 10000) / 10000.0f;
-        const float sy = static_cast<float>((seed * 214013u + static_cast<unsigned int>(i * 4051)) % 10000) / 10000.0f;
-        const float twinkle = 0.55f + 0.45f * std::sin(drift * (0.8f + 0.05f * static_cast<float>(i)) + 9.0f * sx);
-        const float radius = 0.8f + 1.9f * sx;
-        const int px = static_cast<int>(sx * static_cast<float>(GetScreenWidth()));
-        const int py = static_cast<int>(sy * static_cast<float>(GetScreenHeight()));
-        DrawCircle(px, py, radius, Fade(baseColor, 0.35f + 0.55f * twinkle));
-    }
-}
-
 void DrawSpaceBackdrop(float t) {
     ClearBackground(Color{4, 6, 14, 255});
     DrawCircleGradient(GetScreenWidth() / 2, GetScreenHeight() / 2, 360.0f,
@@ -1064,6 +456,7 @@ int main() {
 
     astro_hand::HandSceneBridge bridge;
     bridge.Start();
+    bridge.SetFilter(kHandFilter);
     std::array<HandKinematics, 2> handState{};
     BallState ball{};
 
@@ -1157,7 +550,7 @@ int main() {
             autoDemo = false;
         }
 
-        UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
+        UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance, 28.0f);
         bridge.Update(camera, now, dt);
 
         const bool leftTracked = bridge.LeftTracked();
@@ -1193,8 +586,8 @@ int main() {
         if (anyTracked) {
             bridge.DrawHands(showLandmarks);
         } else {
-            if (showMirrorDemo) DrawHandModel(demoLeft, StyleForHand(false, false), showLandmarks, demoPinch);
-            DrawHandModel(demoRight, StyleForHand(true, false), showLandmarks, demoPinch);
+            if (showMirrorDemo) DrawHandModel(demoLeft, DemoStyleForHand(false), showLandmarks, demoPinch);
+            DrawHandModel(demoRight, DemoStyleForHand(true), showLandmarks, demoPinch);
         }
         EndMode3D();
 
@@ -1240,9 +633,12 @@ int main() {
             }
         }
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,11 +1,17 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/dbm_lightning.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/ribbon_batch.h"
 #include "../vision/hand_tracking_scene_shared.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -23,6 +29,8 @@ constexpr Vector3 kCoilRightTip = {3.35f, 2.95f, 0.28f};
 constexpr std::array<Vector3, 2> kCoilTips = {kCoilLeftTip, kCoilRightTip};
 constexpr Vector3 kCameraTarget = {0.0f, 2.58f, 0.0f};
 constexpr int kMaxSecondaryContacts = 3;
+// Arcs follow the fingertips, so lag shows more than jitter.
+constexpr HandFilterConfig kHandFilter = {{1.2f, 12.0f, 1.0f}, 10.0f, 0.5f, 0.015f, kMaxTrackingExtrapolation};
 
 float gRenderQuality = 1.0f;
 
@@ -115,23 +123,80 @@ struct CoilSceneState {
     std::array<bool, 2> active = {false, false};
 };
 
+// Sine for oscillator arguments x >= -pi: wrap to [-pi, pi], fold onto [-pi/2, pi/2] and
+// evaluate a degree-9 odd Taylor polynomial (error below 4e-6). Only truncating casts,
+// fabs and selects, so a loop over a block of arguments vectorizes.
+inline float BlockSin(float x) {
+    constexpr float kTwoPi = 2.0f * PI;
+    x -= kTwoPi * static_cast<float>(static_cast<int>(x * (1.0f / kTwoPi) + 0.5f));
+    const float folded = (x < 0.0f ? -PI : PI) - x;
+    x = std::fabs(x) > 0.5f * PI ? folded : x;
+    const float x2 = x * x;
+    return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+}
+
+// Counter-hashed white noise in [-1, 1): unlike an LCG every sample is independent of
+// the previous one, so a whole block is generated in one vector pass.
+inline float BlockNoise(uint32_t counter) {
+    uint32_t h = counter * 0x9E3779B9u;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return static_cast<float>(static_cast<int32_t>(h >> 8)) / 8388607.5f - 1.0f;
+}
+
+// Synthesis runs in raylib's pull callback on the audio thread: the device asks for
+// samples whenever it needs them, so a slow render frame no longer starves the stream.
+// The render loop only publishes the scene's voice parameters through relaxed atomics;
+// the callback reads them once per block and glides toward them, ramping every gain
+// and oscillator increment linearly across the block so updates never click.
 struct CoilAudioEngine {
+    static constexpr int kSampleRate = 44100;
+    static constexpr int kBufferFrames = 128;
+    static constexpr int kBlockFrames = 128;
+    static constexpr float kParamGlide = 0.22f;  // per-block approach, ~13 ms time constant
+
+    struct Voice {
+        float voltage = 0.35f;
+        float harsh = 0.62f;
+        float reaction = 0.0f;
+        float corona = 0.0f;
+        float phaseGain = 0.10f;
+        float level = 0.45f;
+    };
+
     bool ready = false;
     AudioStream stream{};
-    std::vector<float> buffer{};
+
+    // Render thread -> audio thread. Each field is independent; a block that pairs a new
+    // voltage with the previous frame's corona is inaudible.
+    std::atomic<float> targetVoltage{0.35f};
+    std::atomic<float> targetHarsh{0.62f};
+    std::atomic<float> targetReaction{0.0f};
+    std::atomic<float> targetCorona{0.0f};
+    std::atomic<int> targetPhase{static_cast<int>(ArcPhase::Idle)};
+    std::atomic<float> targetLevel{0.45f};
+
+    // Audio-thread state.
+    Voice voice{};
     float carrierPhase = 0.0f;
     float buzzPhase = 0.0f;
     float hissPhase = 0.0f;
-    uint32_t noiseState = 0x12345u;
+    uint32_t noiseCounter = 0x12345u;
+
+    static inline std::atomic<CoilAudioEngine*> active{nullptr};
 
     void Start() {
         InitAudioDevice();
         if (!IsAudioDeviceReady()) return;
-        SetAudioStreamBufferSizeDefault(1024);
-        stream = LoadAudioStream(44100, 32, 1);
+        SetAudioStreamBufferSizeDefault(kBufferFrames);
+        stream = LoadAudioStream(kSampleRate, 32, 1);
         if (!IsAudioStreamValid(stream)) return;
-        buffer.assign(1024, 0.0f);
-        SetAudioStreamVolume(stream, 0.45f);
+        active.store(this, std::memory_order_release);
+        SetAudioStreamCallback(stream, &CoilAudioEngine::Callback);
+        SetAudioStreamVolume(stream, 1.0f);
         PlayAudioStream(stream);
         ready = true;
     }
@@ -142,64 +207,133 @@ struct CoilAudioEngine {
             UnloadAudioStream(stream);
             ready = false;
         }
+        active.store(nullptr, std::memory_order_release);
         if (IsAudioDeviceReady()) CloseAudioDevice();
     }
 
-    float NextNoise() {
-        noiseState = 1664525u * noiseState + 1013904223u;
-        return static_cast<float>((noiseState >> 8) & 0x00ffffffu) / 8388607.5f - 1.0f;
+    static float PhaseGain(ArcPhase phase) {
+        return (phase == ArcPhase::PlasmaHold) ? 1.00f :
+               (phase == ArcPhase::Contact) ? 0.82f :
+               (phase == ArcPhase::Seeking) ? 0.48f :
+               (phase == ArcPhase::Corona) ? 0.28f : 0.10f;
     }
 
+    // Called once per render frame; never touches the stream's sample buffers.
     void Update(const CoilSceneState& state) {
         if (!ready) return;
-        if (!IsAudioStreamPlaying(stream)) PlayAudioStream(stream);
         const float maxReaction = std::max(state.reaction[0], state.reaction[1]);
-        const float maxCorona = std::max(state.corona[0], state.corona[1]);
-        const ArcPhase audioPhase =
-            (state.phase[0] > state.phase[1]) ? state.phase[0] : state.phase[1];
-
-        const float sr = 44100.0f;
-        while (IsAudioStreamProcessed(stream)) {
-            for (size_t i = 0; i < buffer.size(); ++i) {
-                const float phaseGain =
-                    (audioPhase == ArcPhase::PlasmaHold) ? 1.00f :
-                    (audioPhase == ArcPhase::Contact) ? 0.82f :
-                    (audioPhase == ArcPhase::Seeking) ? 0.48f :
-                    (audioPhase == ArcPhase::Corona) ? 0.28f : 0.10f;
-                const float harsh = state.audioHarshness;
-                const float smooth = 1.0f - harsh;
-
-                const float baseFreq = 42.0f + 110.0f * state.voltage * state.voltage + 26.0f * smooth;
-                const float buzzFreq = baseFreq * (1.75f + 0.58f * harsh + 0.26f * maxCorona);
-                const float hissFreq = 760.0f + 1100.0f * smooth + 2100.0f * harsh * maxCorona + 1600.0f * maxReaction;
-
-                carrierPhase += 2.0f * PI * baseFreq / sr;
-                buzzPhase += 2.0f * PI * buzzFreq / sr;
-                hissPhase += 2.0f * PI * hissFreq / sr;
-                if (carrierPhase > 2.0f * PI) carrierPhase -= 2.0f * PI;
-                if (buzzPhase > 2.0f * PI) buzzPhase -= 2.0f * PI;
-                if (hissPhase > 2.0f * PI) hissPhase -= 2.0f * PI;
-
-                const float hum = std::sin(carrierPhase);
-                const float subHum = std::sin(carrierPhase * 0.5f + 0.6f * std::sin(hissPhase * 0.01f));
-                const float buzz = std::sin(buzzPhase) * std::sin(carrierPhase * (0.45f + 0.15f * harsh) + hissPhase * 0.03f);
-                const float hiss = NextNoise() * (0.05f + 0.30f * smooth + 0.72f * harsh * maxCorona);
-                const float crackleThreshold = 0.90f - 0.48f * harsh - 0.28f * maxReaction;
-                const float crackle = (NextNoise() > crackleThreshold) ? (0.18f + 0.82f * maxReaction * (0.40f + 0.60f * harsh)) : 0.0f;
-
-                float sample =
-                    hum * (0.020f + 0.020f * smooth + 0.024f * state.voltage) +
-                    subHum * (0.006f + 0.018f * smooth) +
-                    buzz * (0.008f + 0.018f * smooth + 0.038f * harsh * phaseGain) +
-                    hiss * (0.004f + 0.012f * phaseGain + 0.010f * harsh) +
-                    crackle * (0.010f + 0.032f * harsh);
-
-                sample *= (0.18f + 0.82f * phaseGain);
-                buffer[i] = std::clamp(sample, -0.90f, 0.90f);
-            }
-            UpdateAudioStream(stream, buffer.data(), static_cast<int>(buffer.size()));
+        const ArcPhase audioPhase = (state.phase[0] > state.phase[1]) ? state.phase[0] : state.phase[1];
+        targetVoltage.store(state.voltage, std::memory_order_relaxed);
+        targetHarsh.store(state.audioHarshness, std::memory_order_relaxed);
+        targetReaction.store(maxReaction, std::memory_order_relaxed);
+        targetCorona.store(std::max(state.corona[0], state.corona[1]), std::memory_order_relaxed);
+        targetPhase.store(static_cast<int>(audioPhase), std::memory_order_relaxed);
+        targetLevel.store(0.16f + 0.38f * std::max(state.voltage, maxReaction), std::memory_order_relaxed);
+        if (!IsAudioStreamPlaying(stream)) PlayAudioStream(stream);
+    }
+
+    static void Callback(void* bufferData, unsigned int frames) {
+        float* out = static_cast<float*>(bufferData);
+        CoilAudioEngine* engine = active.load(std::memory_order_acquire);
+        if (engine == nullptr) {
+            std::fill(out, out + frames, 0.0f);
+            return;
+        }
+        while (frames > 0) {
+            const int n = static_cast<int>(std::min<unsigned int>(frames, kBlockFrames));
+            engine->RenderBlock(out, n);
+            out += n;
+            frames -= static_cast<unsigned int>(n);
+        }
+    }
+
+    void RenderBlock(float* out, int n) {
+        Voice next = voice;
+        auto glide = [](float current, float target) { return current + (target - current) * kParamGlide; };
+        next.voltage = glide(voice.voltage, targetVoltage.load(std::memory_order_relaxed));
+        next.harsh = glide(voice.harsh, targetHarsh.load(std::memory_order_relaxed));
+        next.reaction = glide(voice.reaction, targetReaction.load(std::memory_order_relaxed));
+        next.corona = glide(voice.corona, targetCorona.load(std::memory_order_relaxed));
+        next.phaseGain = glide(voice.phaseGain, PhaseGain(static_cast<ArcPhase>(targetPhase.load(std::memory_order_relaxed))));
+        next.level = glide(voice.level, targetLevel.load(std::memory_order_relaxed));
+
+        // Everything the inner loop needs, at the start (0) and end (1) of the block.
+        struct Mix {
+            float carrierInc, buzzInc, hissInc;
+            float humGain, subGain, buzzGain, hissGain, crackleThreshold, crackleGain;
+            float buzzCarrierRatio, outGain, level;
+        };
+        auto mixFor = [](const Voice& v) {
+            const float harsh = v.harsh;
+            const float smooth = 1.0f - harsh;
+            const float baseFreq = 42.0f + 110.0f * v.voltage * v.voltage + 26.0f * smooth;
+            const float buzzFreq = baseFreq * (1.75f + 0.58f * harsh + 0.26f * v.corona);
+            const float hissFreq = 760.0f + 1100.0f * smooth + 2100.0f * harsh * v.corona + 1600.0f * v.reaction;
+            const float toInc = 2.0f * PI / static_cast<float>(kSampleRate);
+            Mix m{};
+            m.carrierInc = baseFreq * toInc;
+            m.buzzInc = buzzFreq * toInc;
+            m.hissInc = hissFreq * toInc;
+            m.humGain = 0.020f + 0.020f * smooth + 0.024f * v.voltage;
+            m.subGain = 0.006f + 0.018f * smooth;
+            m.buzzGain = 0.008f + 0.018f * smooth + 0.038f * harsh * v.phaseGain;
+            m.hissGain = (0.05f + 0.30f * smooth + 0.72f * harsh * v.corona) * (0.004f + 0.012f * v.phaseGain + 0.010f * harsh);
+            m.crackleThreshold = 0.90f - 0.48f * harsh - 0.28f * v.reaction;
+            m.crackleGain = (0.18f + 0.82f * v.reaction * (0.40f + 0.60f * harsh)) * (0.010f + 0.032f * harsh);
+            m.buzzCarrierRatio = 0.45f + 0.15f * harsh;
+            m.outGain = 0.18f + 0.82f * v.phaseGain;
+            m.level = v.level;
+            return m;
+        };
+        const Mix a = mixFor(voice);
+        const Mix b = mixFor(next);
+        voice = next;
+
+        // Phase after sample i when the increment ramps linearly from a to b:
+        // p0 + i inc_a + (inc_b - inc_a) i (i + 1) / (2n), wrapped to [0, 2 pi).
+        constexpr float kTwoPi = 2.0f * PI;
+        const float invN = 1.0f / static_cast<float>(n);
+        alignas(32) float carrier[kBlockFrames];
+        alignas(32) float buzzPh[kBlockFrames];
+        alignas(32) float hissPh[kBlockFrames];
+        alignas(32) float ramp[kBlockFrames];
+        for (int i = 0; i < n; ++i) {
+            const float k = static_cast<float>(i + 1);
+            const float tri = 0.5f * k * (k + 1.0f) * invN;
+            ramp[i] = k * invN;
+            const float c = carrierPhase + k * a.carrierInc + tri * (b.carrierInc - a.carrierInc);
+            const float z = buzzPhase + k * a.buzzInc + tri * (b.buzzInc - a.buzzInc);
+            const float h = hissPhase + k * a.hissInc + tri * (b.hissInc - a.hissInc);
+            carrier[i] = c - kTwoPi * static_cast<float>(static_cast<int>(c * (1.0f / kTwoPi)));
+            buzzPh[i] = z - kTwoPi * static_cast<float>(static_cast<int>(z * (1.0f / kTwoPi)));
+            hissPh[i] = h - kTwoPi * static_cast<float>(static_cast<int>(h * (1.0f / kTwoPi)));
+        }
+        carrierPhase = carrier[n - 1];
+        buzzPhase = buzzPh[n - 1];
+        hissPhase = hissPh[n - 1];
+
+        const uint32_t noiseBase = noiseCounter;
+        noiseCounter += 2u * static_cast<uint32_t>(n);
+        for (int i = 0; i < n; ++i) {
+            const float t = ramp[i];
+            auto lerp = [t](float from, float to) { return from + (to - from) * t; };
+            const float hum = BlockSin(carrier[i]);
+            const float subHum = BlockSin(carrier[i] * 0.5f + 0.6f * BlockSin(hissPh[i] * 0.01f));
+            const float buzz = BlockSin(buzzPh[i]) *
+                               BlockSin(carrier[i] * lerp(a.buzzCarrierRatio, b.buzzCarrierRatio) + hissPh[i] * 0.03f);
+            const uint32_t counter = noiseBase + 2u * static_cast<uint32_t>(i);
+            const float hiss = BlockNoise(counter);
+            const float crackle = BlockNoise(counter + 1u) > lerp(a.crackleThreshold, b.crackleThreshold)
+                                      ? lerp(a.crackleGain, b.crackleGain) : 0.0f;
+
+            float sample = hum * lerp(a.humGain, b.humGain) +
+                           subHum * lerp(a.subGain, b.subGain) +
+                           buzz * lerp(a.buzzGain, b.buzzGain) +
+                           hiss * lerp(a.hissGain, b.hissGain) +
+                           crackle;
+            sample *= lerp(a.outGain, b.outGain);
+            out[i] = std::clamp(sample, -0.90f, 0.90f) * lerp(a.level, b.level);
         }
-        SetAudioStreamVolume(stream, 0.16f + 0.38f * std::max(state.voltage, maxReaction));
     }
 };
 
@@ -375,113 +509,266 @@ ContactCandidate EvaluateFeature(const Vector3& source, const HandGeometry& g, c
     return (feature.kind == FeatureKind::Capsule) ? EvaluateCapsuleFeature(source, g, feature) : EvaluateTriangleFeature(source, g, feature);
 }
 
-std::array<ContactCandidate, kMaxSecondaryContacts> CollectSecondaryContacts(
-    const Vector3& source,
-    const HandGeometry& g,
-    bool rightHand,
-    const ContactCandidate& primary,
-    float voltage,
-    int* outCount) {
-    std::array<ContactCandidate, kMaxSecondaryContacts> selected{};
-    *outCount = 0;
-
-    static constexpr std::array<ContactFeature, 5> tipFeatures = {{
-        {FeatureKind::Capsule, false, 3, 4, -1, "thumb_tip", -0.20f},
-        {FeatureKind::Capsule, false, 7, 8, -1, "index_tip", -0.28f},
-        {FeatureKind::Capsule, false, 11, 12, -1, "middle_tip", -0.26f},
-        {FeatureKind::Capsule, false, 15, 16, -1, "ring_tip", -0.18f},
-        {FeatureKind::Capsule, false, 19, 20, -1, "pinky_tip", -0.14f},
-    }};
+// Every surface an arc can land on: finger and web capsules, then palm triangles. The
+// rightHand flag is filled in per query.
+constexpr std::array<ContactFeature, 30> kHandContactFeatures = {{
+    {FeatureKind::Capsule, false, 0, 1, -1, "thumb_base", 0.08f},
+    {FeatureKind::Capsule, false, 1, 2, -1, "thumb_mcp", 0.02f},
+    {FeatureKind::Capsule, false, 2, 3, -1, "thumb_ip", -0.08f},
+    {FeatureKind::Capsule, false, 3, 4, -1, "thumb_tip", -0.20f},
+    {FeatureKind::Capsule, false, 0, 5, -1, "index_base", 0.04f},
+    {FeatureKind::Capsule, false, 5, 6, -1, "index_lower", -0.02f},
+    {FeatureKind::Capsule, false, 6, 7, -1, "index_upper", -0.14f},
+    {FeatureKind::Capsule, false, 7, 8, -1, "index_tip", -0.28f},
+    {FeatureKind::Capsule, false, 0, 9, -1, "middle_base", 0.06f},
+    {FeatureKind::Capsule, false, 9, 10, -1, "middle_lower", -0.03f},
+    {FeatureKind::Capsule, false, 10, 11, -1, "middle_upper", -0.16f},
+    {FeatureKind::Capsule, false, 11, 12, -1, "middle_tip", -0.26f},
+    {FeatureKind::Capsule, false, 0, 13, -1, "ring_base", 0.08f},
+    {FeatureKind::Capsule, false, 13, 14, -1, "ring_lower", 0.00f},
+    {FeatureKind::Capsule, false, 14, 15, -1, "ring_upper", -0.08f},
+    {FeatureKind::Capsule, false, 15, 16, -1, "ring_tip", -0.18f},
+    {FeatureKind::Capsule, false, 0, 17, -1, "pinky_base", 0.10f},
+    {FeatureKind::Capsule, false, 17, 18, -1, "pinky_lower", 0.02f},
+    {FeatureKind::Capsule, false, 18, 19, -1, "pinky_upper", -0.06f},
+    {FeatureKind::Capsule, false, 19, 20, -1, "pinky_tip", -0.14f},
+    {FeatureKind::Capsule, false, 5, 9, -1, "index_middle_web", 0.12f},
+    {FeatureKind::Capsule, false, 9, 13, -1, "mid_palm_bridge", 0.16f},
+    {FeatureKind::Capsule, false, 13, 17, -1, "ring_pinky_web", 0.18f},
+    {FeatureKind::Capsule, false, 0, 17, -1, "palm_edge", 0.22f},
+    {FeatureKind::Triangle, false, 0, 1, 5, "thenar_palm", 0.18f},
+    {FeatureKind::Triangle, false, 0, 5, 9, "inner_palm", 0.24f},
+    {FeatureKind::Triangle, false, 0, 9, 13, "center_palm", 0.28f},
+    {FeatureKind::Triangle, false, 0, 13, 17, "outer_palm", 0.24f},
+    {FeatureKind::Triangle, false, 1, 5, 9, "thumb_web", 0.16f},
+    {FeatureKind::Triangle, false, 9, 13, 17, "metacarpal_pad", 0.26f},
+}};
+
+// Bounding-volume hierarchy over one hand's contact features. Each node boxes the
+// features' spines (segments and triangles) and keeps the largest surface radius and the
+// smallest score bias below it, so max(0, |source - box| - radius) + bias never exceeds
+// the score of any feature inside and whole fingers are skipped. All storage is fixed, so
+// Build and Refit run in place on every new HandGeometry without allocating; Refit keeps
+// the topology and only re-boxes, Build re-partitions when the pose has drifted.
+class HandContactBvh {
+  public:
+    static constexpr int kFeatureCount = static_cast<int>(kHandContactFeatures.size());
+    static constexpr int kLeafSize = 2;
+    static constexpr int kRefitsPerBuild = 30;  // about half a second of tracking
+
+    // Rebuilds when the topology is stale, otherwise refits. Call once per new geometry.
+    void Update(const HandGeometry& g, bool rightHand) {
+        if (nodeCount_ == 0 || rightHand_ != rightHand || refits_ >= kRefitsPerBuild) {
+            Build(g, rightHand);
+        } else {
+            Refit(g);
+        }
+    }
 
-    std::array<ContactCandidate, 5> matches{};
-    int matchCount = 0;
-    const float maxGap = primary.gap + 0.26f + 0.84f * voltage;
-    const float maxScore = primary.score + 0.18f + 0.66f * voltage;
+    void Build(const HandGeometry& g, bool rightHand) {
+        rightHand_ = rightHand;
+        refits_ = 0;
+        for (int i = 0; i < kFeatureCount; ++i) {
+            order_[static_cast<size_t>(i)] = i;
+            BoundFeature(g, i, &leafBounds_[static_cast<size_t>(i)]);
+        }
+        nodeCount_ = 1;
+        BuildRange(0, 0, kFeatureCount);
+    }
 
-    for (ContactFeature feature : tipFeatures) {
-        feature.rightHand = rightHand;
-        ContactCandidate candidate = EvaluateCapsuleFeature(source, g, feature);
-        if (!candidate.valid || SameFeature(candidate.feature, primary.feature)) continue;
-        if (candidate.gap > maxGap || candidate.score > maxScore) continue;
-        matches[matchCount++] = candidate;
+    // Re-boxes every node for the new landmark positions; children always follow their
+    // parent, so one reverse sweep is a post-order pass.
+    void Refit(const HandGeometry& g) {
+        ++refits_;
+        for (int i = 0; i < kFeatureCount; ++i) BoundFeature(g, i, &leafBounds_[static_cast<size_t>(i)]);
+        for (int n = nodeCount_ - 1; n >= 0; --n) {
+            Node& node = nodes_[static_cast<size_t>(n)];
+            if (node.count > 0) {
+                node.bounds = leafBounds_[static_cast<size_t>(order_[static_cast<size_t>(node.first)])];
+                for (int i = 1; i < node.count; ++i) {
+                    Merge(&node.bounds, leafBounds_[static_cast<size_t>(order_[static_cast<size_t>(node.first + i)])]);
+                }
+            } else {
+                node.bounds = nodes_[static_cast<size_t>(node.first)].bounds;
+                Merge(&node.bounds, nodes_[static_cast<size_t>(node.first + 1)].bounds);
+            }
+        }
     }
 
-    std::sort(matches.begin(), matches.begin() + matchCount, [](const ContactCandidate& a, const ContactCandidate& b) {
-        return a.score < b.score;
-    });
+    // Up to k candidates with the lowest score, ascending, restricted to features with
+    // gap <= maxGap and score <= maxScore that pass accept(feature). Returns the count.
+    template <typename Accept>
+    int Nearest(const Vector3& source, const HandGeometry& g, int k, float maxGap, float maxScore, Accept&& accept,
+                ContactCandidate* out) const {
+        if (nodeCount_ == 0 || k <= 0) return 0;
+        int found = 0;
+        auto cutoff = [&]() { return found < k ? maxScore : out[found - 1].score; };
+
+        struct Pending {
+            int node;
+            float gapBound;
+        };
+        std::array<Pending, 2 * kFeatureCount> stack{};
+        int top = 0;
+        stack[static_cast<size_t>(top++)] = {0, GapLowerBound(nodes_[0].bounds, source)};
+        while (top > 0) {
+            const Pending pending = stack[static_cast<size_t>(--top)];
+            const Node& node = nodes_[static_cast<size_t>(pending.node)];
+            if (pending.gapBound > maxGap || pending.gapBound + node.bounds.minBias > cutoff()) continue;
+            if (node.count == 0) {
+                // Push the farther child first so the nearer one tightens the cutoff sooner.
+                Pending left{node.first, GapLowerBound(nodes_[static_cast<size_t>(node.first)].bounds, source)};
+                Pending right{node.first + 1, GapLowerBound(nodes_[static_cast<size_t>(node.first + 1)].bounds, source)};
+                if (right.gapBound < left.gapBound) std::swap(left, right);
+                stack[static_cast<size_t>(top++)] = right;
+                stack[static_cast<size_t>(top++)] = left;
+                continue;
+            }
+            for (int i = 0; i < node.count; ++i) {
+                ContactFeature feature = kHandContactFeatures[static_cast<size_t>(order_[static_cast<size_t>(node.first + i)])];
+                feature.rightHand = rightHand_;
+                if (!accept(feature)) continue;
+                const ContactCandidate candidate = EvaluateFeature(source, g, feature);
+                if (!candidate.valid || candidate.gap > maxGap || candidate.score > cutoff()) continue;
+                int slot = std::min(found, k - 1);
+                while (slot > 0 && out[slot - 1].score > candidate.score) {
+                    out[slot] = out[slot - 1];
+                    --slot;
+                }
+                out[slot] = candidate;
+                found = std::min(found + 1, k);
+            }
+        }
+        return found;
+    }
 
-    const int count = std::min(matchCount, kMaxSecondaryContacts);
-    for (int i = 0; i < count; ++i) selected[static_cast<size_t>(i)] = matches[static_cast<size_t>(i)];
-    *outCount = count;
-    return selected;
-}
+    // The single best-scoring feature, or an invalid candidate before the first Build.
+    ContactCandidate Best(const Vector3& source, const HandGeometry& g) const {
+        ContactCandidate best{};
+        Nearest(source, g, 1, std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                [](const ContactFeature&) { return true; }, &best);
+        return best;
+    }
 
-ContactCandidate ResolveHandContact(const Vector3& source, const HandGeometry& g, bool rightHand) {
-    ContactCandidate best{};
-    static constexpr std::array<ContactFeature, 24> capsuleFeatures = {{
-        {FeatureKind::Capsule, false, 0, 1, -1, "thumb_base", 0.08f},
-        {FeatureKind::Capsule, false, 1, 2, -1, "thumb_mcp", 0.02f},
-        {FeatureKind::Capsule, false, 2, 3, -1, "thumb_ip", -0.08f},
-        {FeatureKind::Capsule, false, 3, 4, -1, "thumb_tip", -0.20f},
-        {FeatureKind::Capsule, false, 0, 5, -1, "index_base", 0.04f},
-        {FeatureKind::Capsule, false, 5, 6, -1, "index_lower", -0.02f},
-        {FeatureKind::Capsule, false, 6, 7, -1, "index_upper", -0.14f},
-        {FeatureKind::Capsule, false, 7, 8, -1, "index_tip", -0.28f},
-        {FeatureKind::Capsule, false, 0, 9, -1, "middle_base", 0.06f},
-        {FeatureKind::Capsule, false, 9, 10, -1, "middle_lower", -0.03f},
-        {FeatureKind::Capsule, false, 10, 11, -1, "middle_upper", -0.16f},
-        {FeatureKind::Capsule, false, 11, 12, -1, "middle_tip", -0.26f},
-        {FeatureKind::Capsule, false, 0, 13, -1, "ring_base", 0.08f},
-        {FeatureKind::Capsule, false, 13, 14, -1, "ring_lower", 0.00f},
-        {FeatureKind::Capsule, false, 14, 15, -1, "ring_upper", -0.08f},
-        {FeatureKind::Capsule, false, 15, 16, -1, "ring_tip", -0.18f},
-        {FeatureKind::Capsule, false, 0, 17, -1, "pinky_base", 0.10f},
-        {FeatureKind::Capsule, false, 17, 18, -1, "pinky_lower", 0.02f},
-        {FeatureKind::Capsule, false, 18, 19, -1, "pinky_upper", -0.06f},
-        {FeatureKind::Capsule, false, 19, 20, -1, "pinky_tip", -0.14f},
-        {FeatureKind::Capsule, false, 5, 9, -1, "index_middle_web", 0.12f},
-        {FeatureKind::Capsule, false, 9, 13, -1, "mid_palm_bridge", 0.16f},
-        {FeatureKind::Capsule, false, 13, 17, -1, "ring_pinky_web", 0.18f},
-        {FeatureKind::Capsule, false, 0, 17, -1, "palm_edge", 0.22f},
-    }};
-    static constexpr std::array<ContactFeature, 6> triangleFeatures = {{
-        {FeatureKind::Triangle, false, 0, 1, 5, "thenar_palm", 0.18f},
-        {FeatureKind::Triangle, false, 0, 5, 9, "inner_palm", 0.24f},
-        {FeatureKind::Triangle, false, 0, 9, 13, "center_palm", 0.28f},
-        {FeatureKind::Triangle, false, 0, 13, 17, "outer_palm", 0.24f},
-        {FeatureKind::Triangle, false, 1, 5, 9, "thumb_web", 0.16f},
-        {FeatureKind::Triangle, false, 9, 13, 17, "metacarpal_pad", 0.26f},
-    }};
+  private:
+    struct Bounds {
+        Vector3 lo{};
+        Vector3 hi{};
+        float maxRadius = 0.0f;
+        float minBias = 0.0f;
+    };
 
-    auto consider = [&](ContactCandidate candidate) {
-        if (!candidate.valid) return;
-        if (!best.valid || candidate.score < best.score) best = candidate;
+    struct Node {
+        Bounds bounds{};
+        int first = 0;  // first child when count == 0, else first slot in order_
+        int count = 0;
     };
 
-    for (ContactFeature feature : capsuleFeatures) {
-        feature.rightHand = rightHand;
-        consider(EvaluateCapsuleFeature(source, g, feature));
+    static void Merge(Bounds* into, const Bounds& other) {
+        into->lo = Vector3Min(into->lo, other.lo);
+        into->hi = Vector3Max(into->hi, other.hi);
+        into->maxRadius = std::max(into->maxRadius, other.maxRadius);
+        into->minBias = std::min(into->minBias, other.minBias);
     }
-    for (ContactFeature feature : triangleFeatures) {
-        feature.rightHand = rightHand;
-        consider(EvaluateTriangleFeature(source, g, feature));
+
+    static float GapLowerBound(const Bounds& b, const Vector3& p) {
+        const float dx = std::max({b.lo.x - p.x, 0.0f, p.x - b.hi.x});
+        const float dy = std::max({b.lo.y - p.y, 0.0f, p.y - b.hi.y});
+        const float dz = std::max({b.lo.z - p.z, 0.0f, p.z - b.hi.z});
+        return std::max(0.0f, std::sqrt(dx * dx + dy * dy + dz * dz) - b.maxRadius);
     }
-    return best;
+
+    // Matches the surface radii of EvaluateCapsuleFeature and EvaluateTriangleFeature.
+    static void BoundFeature(const HandGeometry& g, int index, Bounds* out) {
+        const ContactFeature& f = kHandContactFeatures[static_cast<size_t>(index)];
+        const Vector3 a = g.landmarks[static_cast<size_t>(f.a)];
+        const Vector3 b = g.landmarks[static_cast<size_t>(f.b)];
+        out->lo = Vector3Min(a, b);
+        out->hi = Vector3Max(a, b);
+        if (f.kind == FeatureKind::Triangle) {
+            const Vector3 c = g.landmarks[static_cast<size_t>(f.c)];
+            out->lo = Vector3Min(out->lo, c);
+            out->hi = Vector3Max(out->hi, c);
+            out->maxRadius = 0.05f;
+        } else {
+            out->maxRadius = 0.55f * (g.radii[static_cast<size_t>(f.a)] + g.radii[static_cast<size_t>(f.b)]);
+        }
+        out->minBias = f.bias;
+    }
+
+    // Median split of order_[first, first + count) on the longest axis of the box centres.
+    // Siblings are allocated as a pair after their parent, so an interior node only
+    // stores its first child and every child index exceeds its parent's.
+    void BuildRange(int index, int first, int count) {
+        Node& node = nodes_[static_cast<size_t>(index)];
+        node.bounds = leafBounds_[static_cast<size_t>(order_[static_cast<size_t>(first)])];
+        for (int i = 1; i < count; ++i) Merge(&node.bounds, leafBounds_[static_cast<size_t>(order_[static_cast<size_t>(first + i)])]);
+        if (count <= kLeafSize) {
+            node.first = first;
+            node.count = count;
+            return;
+        }
+
+        const Vector3 extent = Vector3Subtract(node.bounds.hi, node.bounds.lo);
+        const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+        auto centre = [&](int feature) {
+            const Bounds& b = leafBounds_[static_cast<size_t>(feature)];
+            const Vector3 c = Vector3Add(b.lo, b.hi);
+            return axis == 0 ? c.x : (axis == 1 ? c.y : c.z);
+        };
+        const int half = count / 2;
+        std::nth_element(order_.begin() + first, order_.begin() + first + half, order_.begin() + first + count,
+                         [&](int lhs, int rhs) { return centre(lhs) < centre(rhs); });
+
+        const int children = nodeCount_;
+        nodeCount_ += 2;
+        node.first = children;
+        node.count = 0;
+        BuildRange(children, first, half);
+        BuildRange(children + 1, first + half, count - half);
+    }
+
+    std::array<Bounds, kFeatureCount> leafBounds_{};
+    std::array<int, kFeatureCount> order_{};
+    std::array<Node, 2 * kFeatureCount> nodes_{};
+    int nodeCount_ = 0;
+    int refits_ = 0;
+    bool rightHand_ = true;
+};
+
+std::array<ContactCandidate, kMaxSecondaryContacts> CollectSecondaryContacts(
+    const Vector3& source,
+    const HandGeometry& g,
+    const HandContactBvh& bvh,
+    const ContactCandidate& primary,
+    float voltage,
+    int* outCount) {
+    std::array<ContactCandidate, kMaxSecondaryContacts> selected{};
+    const float maxGap = primary.gap + 0.26f + 0.84f * voltage;
+    const float maxScore = primary.score + 0.18f + 0.66f * voltage;
+    *outCount = bvh.Nearest(source, g, kMaxSecondaryContacts, maxGap, maxScore,
+                            [&](const ContactFeature& feature) {
+                                return IsTipFeature(feature) && !SameFeature(feature, primary.feature);
+                            },
+                            selected.data());
+    return selected;
 }
 
-ActiveHandRef PickActiveHand(const HandSceneBridge& bridge, CoilSceneState* state) {
+ActiveHandRef PickActiveHand(const HandSceneBridge& bridge, std::array<HandContactBvh, 2>* contactBvh, CoilSceneState* state) {
     ActiveHandRef best{};
 
     auto considerTrackedHand = [&](bool rightHand) {
         const HandControlState& control = bridge.Control(rightHand);
         if (!control.active) return;
         const HandGeometry& geometry = bridge.Geometry(rightHand);
+        HandContactBvh& bvh = (*contactBvh)[rightHand ? 1 : 0];
+        bvh.Update(geometry, rightHand);
         std::array<ContactCandidate, 2> candidates{};
         std::array<std::array<ContactCandidate, kMaxSecondaryContacts>, 2> secondaryCandidates{};
         std::array<int, 2> secondaryCounts = {0, 0};
         float compositeScore = 0.0f;
         for (size_t i = 0; i < kCoilTips.size(); ++i) {
-            ContactCandidate candidate = ResolveHandContact(kCoilTips[i], geometry, rightHand);
+            ContactCandidate candidate = bvh.Best(kCoilTips[i], geometry);
             if (state->lockedValid[i] && state->lockedFeature[i].rightHand == rightHand) {
                 ContactCandidate locked = EvaluateFeature(kCoilTips[i], geometry, state->lockedFeature[i]);
                 const bool keepLocked =
@@ -494,7 +781,7 @@ ActiveHandRef PickActiveHand(const HandSceneBridge& bridge, CoilSceneState* stat
             }
             candidates[i] = candidate;
             secondaryCandidates[i] = CollectSecondaryContacts(
-                kCoilTips[i], geometry, rightHand, candidate, state->voltage, &secondaryCounts[i]);
+                kCoilTips[i], geometry, bvh, candidate, state->voltage, &secondaryCounts[i]);
             compositeScore += candidate.score;
         }
         compositeScore -= 0.10f * std::min(candidates[0].score, candidates[1].score);
@@ -601,90 +888,167 @@ void DrawGroundGrid() {
     }
 }
 
-void DrawArcPath(Vector3 start, Vector3 end, float intensity, float t, int seed) {
-    const Vector3 delta = Vector3Subtract(end, start);
-    const float length = Vector3Length(delta);
-    if (length < 1.0e-4f) return;
+// Discharge trees from the DBM generator, cached per call site. A site is identified by
+// its seed plus where its endpoints are, since some seeds are shared (both coils' corona,
+// every skin crawl); each frame a request claims the unused slot with that seed whose
+// endpoints are closest. Trees live in a unit frame and are stretched onto the current
+// endpoints, so they are reused until the endpoints move past a fraction of the arc
+// length or the arc re-strikes, and then regrown on the worker while the old tree keeps
+// drawing. Every segment goes into one RibbonBatch.
+class ArcField {
+  public:
+    static constexpr int kMaxSlots = 224;
+    static constexpr int kEvictFrames = 90;
+    static constexpr int kFallbackTrees = 6;
+    static constexpr float kRegrowFraction = 0.18f;  // of the arc length, both endpoints summed
+    static constexpr float kRegrowMin = 0.05f;
+    static constexpr float kRestrikeSeconds = 2.4f;
 
-    const Vector3 dir = Vector3Normalize(delta);
-    Vector3 side = SafeNormalize(Vector3CrossProduct(dir, {0.0f, 1.0f, 0.0f}), {0.0f, 0.0f, 1.0f});
-    Vector3 up = SafeNormalize(Vector3CrossProduct(side, dir), {0.0f, 1.0f, 0.0f});
-    const ArcPalette palette = PaletteForArc(seed, intensity);
-
-    const int segments = ScaleDetail(10 + static_cast<int>(length * (2.4f + 1.8f * intensity)), 0.52f);
-    const float jag = 0.02f + 0.12f * intensity;
-    Vector3 prev = start;
-    Vector3 prevOuterA = start;
-    Vector3 prevOuterB = start;
-    Vector3 prevOuterC = start;
-    for (int i = 1; i <= segments; ++i) {
-        const float s = static_cast<float>(i) / static_cast<float>(segments);
-        Vector3 point = Vector3Lerp(start, end, s);
-        if (i < segments) {
-            const float env = std::sin(s * PI);
-            const float wobbleA = std::sin(t * (7.0f + 0.85f * seed) + 11.0f * s + 6.2831f * std::fmod(seed * 0.173f, 1.0f));
-            const float wobbleB = std::cos(t * (8.6f + 0.65f * seed) + 9.0f * s + 6.2831f * std::fmod(seed * 0.287f, 1.0f));
-            point = Vector3Add(point, Vector3Scale(side, wobbleA * jag * env));
-            point = Vector3Add(point, Vector3Scale(up, wobbleB * jag * 0.70f * env));
+    void Start() {
+        batch_.Init();
+        // A few trees grown up front so new sites can draw before their own arrives.
+        astro_lightning::detail::GrowthGrid grid;
+        fallback_.resize(kFallbackTrees);
+        for (int i = 0; i < kFallbackTrees; ++i) {
+            astro_lightning::GrowArcTree(0xA5C0u + static_cast<uint64_t>(i), GrowthFor(0.5f, false), &fallback_[static_cast<size_t>(i)], &grid);
         }
+    }
 
-        const float shellRadius = (0.010f + 0.050f * intensity) * std::sin(s * PI);
-        const float angle = t * (6.6f + 0.20f * seed) + 12.0f * s;
-        const Vector3 outerOffsetA = Vector3Add(
-            Vector3Scale(side, std::cos(angle) * shellRadius),
-            Vector3Scale(up, std::sin(angle) * shellRadius * 0.76f));
-        const Vector3 outerOffsetB = Vector3Add(
-            Vector3Scale(side, std::cos(angle + 2.2f) * shellRadius * 0.82f),
-            Vector3Scale(up, std::sin(angle + 2.2f) * shellRadius));
-        const Vector3 outerOffsetC = Vector3Add(
-            Vector3Scale(side, std::cos(angle + 4.4f) * shellRadius * 0.65f),
-            Vector3Scale(up, std::sin(angle + 4.4f) * shellRadius * 0.90f));
-        const Vector3 outerA = Vector3Add(point, outerOffsetA);
-        const Vector3 outerB = Vector3Add(point, outerOffsetB);
-        const Vector3 outerC = Vector3Add(point, outerOffsetC);
-
-        DrawLine3D(prevOuterA, outerA, palette.outer);
-        if (gRenderQuality > 0.56f || intensity > 0.64f) DrawLine3D(prevOuterB, outerB, palette.outer);
-        if (gRenderQuality > 0.82f || intensity > 0.82f) DrawLine3D(prevOuterC, outerC, palette.haze);
-        DrawLine3D(prev, point, palette.mid);
-        DrawLine3D(prev, point, palette.core);
-
-        DrawSphere(point, 0.026f + 0.045f * intensity, palette.haze);
-        if (gRenderQuality > 0.60f || intensity > 0.70f) DrawSphere(point, 0.014f + 0.025f * intensity, palette.outer);
-        DrawSphere(point, 0.006f + 0.016f * intensity, palette.core);
-        if (gRenderQuality > 0.70f && i < segments && (i % 2 == 0 || intensity > 0.72f)) {
-            const Vector3 mist = Vector3Add(point, Vector3Scale(outerOffsetA, 1.3f));
-            DrawSphere(mist, 0.010f + 0.020f * intensity, palette.haze);
+    void Shutdown() {
+        queue_.Stop();
+        batch_.Unload();
+    }
+
+    void BeginFrame(float now) {
+        now_ = now;
+        ++frame_;
+        batch_.Clear();
+        queue_.Collect(&results_);
+        for (astro_lightning::ArcGrowthQueue::Result& result : results_) {
+            Slot& slot = slots_[static_cast<size_t>(result.id)];
+            if (slot.ticket != result.ticket) continue;
+            std::swap(slot.tree, result.tree);
         }
+    }
 
-        prev = point;
-        prevOuterA = outerA;
-        prevOuterB = outerB;
-        prevOuterC = outerC;
+    void Submit(Vector3 start, Vector3 end, float intensity, float t, int seed, bool plasmaHold = false) {
+        const Vector3 delta = Vector3Subtract(end, start);
+        const float length = Vector3Length(delta);
+        if (length < 1.0e-4f) return;
+        Slot* slot = Claim(seed, start, end);
+        if (slot == nullptr) return;
+
+        const float moved = Vector3Distance(start, slot->start) + Vector3Distance(end, slot->end);
+        const float restrike = kRestrikeSeconds * (0.75f + 0.5f * std::fmod(std::abs(seed) * 0.173f, 1.0f));
+        if (slot->ticket == 0 || moved > kRegrowMin + kRegrowFraction * length || now_ - slot->grownAt > restrike) {
+            slot->start = start;
+            slot->end = end;
+            slot->grownAt = now_;
+            const uint64_t treeSeed = (static_cast<uint64_t>(static_cast<uint32_t>(seed)) << 32) ^ ++generation_;
+            slot->ticket = queue_.Submit(static_cast<int>(slot - slots_.data()), treeSeed, GrowthFor(intensity, plasmaHold));
+        }
+
+        const astro_lightning::ArcTree& tree =
+            slot->tree.empty() ? fallback_[static_cast<size_t>(std::abs(seed) % kFallbackTrees)] : slot->tree;
+        Emit(tree, start, delta, length, intensity, t, seed, plasmaHold);
     }
-}
 
-void DrawBranchFilaments(Vector3 start, Vector3 end, float intensity, float t, int seed) {
-    const Vector3 delta = Vector3Subtract(end, start);
-    const float length = Vector3Length(delta);
-    if (length < 1.0e-4f) return;
+    void Draw() { batch_.Draw(); }
+
+  private:
+    struct Slot {
+        int seed = 0;
+        int lastFrame = -1000000;
+        Vector3 start{};
+        Vector3 end{};
+        float grownAt = 0.0f;
+        uint32_t ticket = 0;
+        astro_lightning::ArcTree tree;
+    };
 
-    const Vector3 dir = Vector3Normalize(delta);
-    Vector3 side = SafeNormalize(Vector3CrossProduct(dir, {0.0f, 1.0f, 0.0f}), {0.0f, 0.0f, 1.0f});
-    Vector3 up = SafeNormalize(Vector3CrossProduct(side, dir), {0.0f, 1.0f, 0.0f});
-    const int branches = ScaleDetail(1 + static_cast<int>(intensity * 6.0f), 0.45f);
-
-    for (int i = 0; i < branches; ++i) {
-        const float s = 0.14f + 0.72f * static_cast<float>(i + 1) / static_cast<float>(branches + 1);
-        const Vector3 anchor = Vector3Lerp(start, end, s);
-        const float angle = t * (4.2f + 0.18f * seed) + 9.0f * s + static_cast<float>(i) * 1.8f;
-        Vector3 branchDir = Vector3Add(
-            Vector3Scale(side, std::sin(angle)),
-            Vector3Scale(up, std::cos(angle * 1.17f)));
-        branchDir = SafeNormalize(Vector3Add(branchDir, Vector3Scale(dir, 0.25f)), side);
-        const float reach = length * (0.05f + 0.10f * intensity) * (0.75f + 0.25f * std::sin(angle * 0.8f));
-        DrawArcPath(anchor, Vector3Add(anchor, Vector3Scale(branchDir, reach)), 0.12f + 0.36f * intensity, t, seed + 200 + i * 11);
+    static astro_lightning::GrowthOptions GrowthFor(float intensity, bool plasmaHold) {
+        astro_lightning::GrowthOptions options;
+        options.eta = 3.3f - 1.3f * Clamp01(intensity) - (plasmaHold ? 0.3f : 0.0f);  // hotter arcs branch more
+        return options;
+    }
+
+    Slot* Claim(int seed, Vector3 start, Vector3 end) {
+        Slot* best = nullptr;
+        float bestDistance = 0.0f;
+        Slot* spare = nullptr;
+        for (Slot& slot : slots_) {
+            if (slot.lastFrame == frame_) continue;
+            if (slot.seed == seed && slot.lastFrame >= frame_ - kEvictFrames) {
+                const float d = Vector3Distance(start, slot.start) + Vector3Distance(end, slot.end);
+                if (best == nullptr || d < bestDistance) {
+                    best = &slot;
+                    bestDistance = d;
+                }
+            } else if (spare == nullptr && slot.lastFrame < frame_ - kEvictFrames) {
+                spare = &slot;
+            }
+        }
+        if (best == nullptr && spare != nullptr) {
+            best = spare;
+            best->seed = seed;
+            best->ticket = 0;
+            best->tree.Clear();
+        }
+        if (best != nullptr) best->lastFrame = frame_;
+        return best;
+    }
+
+    void Emit(const astro_lightning::ArcTree& tree, Vector3 start, Vector3 delta, float length, float intensity, float t, int seed,
+              bool plasmaHold) {
+        const Vector3 dir = Vector3Scale(delta, 1.0f / length);
+        const Vector3 side = SafeNormalize(Vector3CrossProduct(dir, {0.0f, 1.0f, 0.0f}), {0.0f, 0.0f, 1.0f});
+        const Vector3 up = SafeNormalize(Vector3CrossProduct(side, dir), {0.0f, 1.0f, 0.0f});
+
+        // A slow shimmer keeps a reused tree alive; the envelope pins both endpoints.
+        const float jag = (0.004f + 0.020f * intensity) * length;
+        const float phaseA = t * (7.0f + 0.85f * seed) + 6.2831f * std::fmod(seed * 0.173f, 1.0f);
+        const float phaseB = t * (8.6f + 0.65f * seed) + 6.2831f * std::fmod(seed * 0.287f, 1.0f);
+        world_.resize(tree.nodes.size());
+        for (size_t n = 0; n < tree.nodes.size(); ++n) {
+            const astro_lightning::ArcNode& node = tree.nodes[n];
+            const float env = std::sin(Clamp01(node.z) * PI);
+            const float wobbleA = std::sin(phaseA + 11.0f * node.z) * jag * env;
+            const float wobbleB = std::cos(phaseB + 9.0f * node.z) * jag * 0.7f * env;
+            Vector3 p = Vector3Add(start, Vector3Scale(dir, node.z * length));
+            p = Vector3Add(p, Vector3Scale(side, node.x * length + wobbleA));
+            world_[n] = Vector3Add(p, Vector3Scale(up, node.y * length + wobbleB));
+        }
+
+        const float hueShift = std::fmod(std::abs(seed) * 0.173f, 1.0f);
+        const float warmth = Clamp01((plasmaHold ? 0.42f : 0.18f) + 0.32f * intensity);
+        const Color tone = ArcTone(hueShift, warmth * 0.62f);
+        const float flicker = 0.80f + 0.20f * std::sin(t * (23.0f + 0.7f * seed));
+        const float width = 0.010f + 0.034f * intensity;
+        const float minWeight = LerpFloat(0.36f, 0.0f, Clamp01(gRenderQuality));
+        for (size_t n = 1; n < tree.nodes.size(); ++n) {
+            const astro_lightning::ArcNode& node = tree.nodes[n];
+            if (node.weight < minWeight) continue;
+            Color c = tone;
+            c.a = static_cast<unsigned char>(255.0f * Clamp01((0.30f + 0.70f * intensity) * (0.20f + 0.80f * node.weight) * flicker));
+            batch_.Add(world_[static_cast<size_t>(node.parent)], world_[n], width * (0.30f + 0.70f * node.weight), c);
+        }
     }
+
+    std::array<Slot, kMaxSlots> slots_{};
+    std::vector<astro_lightning::ArcTree> fallback_;
+    std::vector<astro_lightning::ArcGrowthQueue::Result> results_;
+    std::vector<Vector3> world_;
+    astro_lightning::ArcGrowthQueue queue_;
+    astro_render::RibbonBatch batch_;
+    uint64_t generation_ = 0;
+    float now_ = 0.0f;
+    int frame_ = 0;
+};
+
+ArcField gArcField;
+
+void DrawArcPath(Vector3 start, Vector3 end, float intensity, float t, int seed) {
+    gArcField.Submit(start, end, intensity, t, seed);
 }
 
 void DrawArcCluster(Vector3 start, Vector3 end, float intensity, float t, int seed, bool plasmaHold = false) {
@@ -696,8 +1060,10 @@ void DrawArcCluster(Vector3 start, Vector3 end, float intensity, float t, int se
     Vector3 side = SafeNormalize(Vector3CrossProduct(dir, {0.0f, 1.0f, 0.0f}), {0.0f, 0.0f, 1.0f});
     Vector3 up = SafeNormalize(Vector3CrossProduct(side, dir), {0.0f, 1.0f, 0.0f});
 
-    DrawArcPath(start, end, Clamp01(0.22f + 0.95f * intensity), t, seed);
+    gArcField.Submit(start, end, Clamp01(0.22f + 0.95f * intensity), t, seed, plasmaHold);
 
+    // Side branches come from the DBM trees themselves; the shells are the extra parallel
+    // leaders of a thick discharge.
     const int shells = ScaleDetail(1 + static_cast<int>(intensity * 3.0f) + (plasmaHold ? 2 : 0), 0.50f);
     const float shellScale = plasmaHold ? 0.10f : 0.07f;
     for (int i = 0; i < shells; ++i) {
@@ -708,11 +1074,7 @@ void DrawArcCluster(Vector3 start, Vector3 end, float intensity, float t, int se
             Vector3Scale(up, std::sin(angle) * spread * (plasmaHold ? 1.20f : 0.82f)));
         const Vector3 startOffset = Vector3Add(start, Vector3Scale(offset, 0.26f));
         const Vector3 endOffset = Vector3Add(end, Vector3Scale(offset, -0.72f));
-        DrawArcPath(startOffset, endOffset, Clamp01(0.16f + 0.72f * intensity), t, seed + 31 + i * 7);
-    }
-
-    if (gRenderQuality > 0.48f || intensity > 0.58f) {
-        DrawBranchFilaments(start, end, intensity * (plasmaHold ? 1.15f : 0.85f), t, seed + 91);
+        gArcField.Submit(startOffset, endOffset, Clamp01(0.16f + 0.72f * intensity), t, seed + 31 + i * 7, plasmaHold);
     }
 }
 
@@ -1012,15 +1374,19 @@ int main() {
 
     HandSceneBridge bridge;
     bridge.Start();
+    bridge.SetFilter(kHandFilter);
 
     CoilAudioEngine audio;
     audio.Start();
+    gArcField.Start();
 
     CoilSceneState state{};
+    std::array<HandContactBvh, 2> contactBvh{};
     bool showLandmarks = false;
 
     while (!WindowShouldClose()) {
         const float now = static_cast<float>(GetTime());
+        gArcField.BeginFrame(now);
         const float dt = std::min(GetFrameTime(), 0.05f);
         const float targetQuality = std::clamp(1.24f - 14.0f * std::max(0.0f, dt - (1.0f / 70.0f)), 0.46f, 1.0f);
         state.renderQuality = LerpFloat(state.renderQuality, targetQuality, 1.0f - std::exp(-3.0f * dt));
@@ -1049,7 +1415,7 @@ int main() {
 
         bridge.Update(camera, now, dt);
 
-        const ActiveHandRef hand = PickActiveHand(bridge, &state);
+        const ActiveHandRef hand = PickActiveHand(bridge, &contactBvh, &state);
         const bool handValid = hand.valid;
         state.voltage = LerpFloat(state.voltage, state.voltageTarget, 1.0f - std::exp(-5.5f * dt));
 
@@ -1114,16 +1480,21 @@ int main() {
         DrawGroundGrid();
         bridge.DrawHands(showLandmarks);
         DrawReactionScene(hand, state, now);
+        gArcField.Draw();
         EndMode3D();
 
         bridge.DrawPreviewPanel({1002.0f, 18.0f, 406.0f, 288.0f}, "Python Bridge Preview");
         DrawVoltageMeter2D(state);
         DrawHud(hand, state);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
     audio.Shutdown();
+    gArcField.Shutdown();
     bridge.Shutdown();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,6 +1,9 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
@@ -108,9 +111,12 @@ int main() {
         DrawText("Orange: force  Blue: velocity  Green: acceleration", 20, 110, 18, Color{190, 205, 225, 255});
         DrawFPS(20, 138);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
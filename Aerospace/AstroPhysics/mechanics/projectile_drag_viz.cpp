@@ -1,18 +1,35 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
+#include "../common/projectile_batch.h"
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <deque>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 
+// Targeting mode flies the drag shell with the batch integrator's fixed step, from the
+// same start, so the solved launch lands where the solver says it does.
+constexpr Vector3 kDragStart = {0.0f, 0.15f, 0.3f};
+constexpr Vector3 kVacuumStart = {0.0f, 0.15f, -0.3f};
+constexpr float kFixedDt = 1.0f / 240.0f;
+constexpr int kEnvelopeBearings = 96;
+constexpr int kEnvelopeElevations = 64;
+constexpr float kWindStep = 0.5f;
+constexpr float kMaxWind = 8.0f;
+
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 d = GetMouseDelta();
@@ -30,9 +47,86 @@ void DrawTrail(const std::deque<Vector3>& tr, Color c) {
     for (size_t i = 1; i < tr.size(); ++i) DrawLine3D(tr[i - 1], tr[i], c);
 }
 
+astro_ballistics::Ballistics MakeBallistics(float dragK, Vector2 wind) {
+    astro_ballistics::Ballistics b;
+    b.drag = dragK;
+    b.windX = wind.x;
+    b.windZ = wind.y;
+    b.dt = kFixedDt;
+    return b;
+}
+
+// The least-speed launch onto the target and the reachable ground at the current speed,
+// recomputed only when the target, drag, wind or speed changes.
+struct TargetingSolution {
+    bool valid = false;
+    Vector3 target{};
+    astro_ballistics::AimResult aim;
+    std::vector<Vector3> arc;
+    std::vector<Vector3> envelope;
+    float solveMs = 0.0f;
+};
+
+void SolveTargeting(astro_ballistics::AimSolver* solver, const astro_ballistics::Ballistics& b, float maxSpeed, Vector3 target,
+                    TargetingSolution* out) {
+    const auto start = std::chrono::steady_clock::now();
+    const float origin[3] = {kDragStart.x, kDragStart.y, kDragStart.z};
+    astro_ballistics::AimOptions options;
+    options.maxSpeed = maxSpeed;
+    out->aim = solver->Solve(b, origin, target.x, target.z, options);
+
+    std::vector<float> xz;
+    solver->Envelope(b, origin, maxSpeed, kEnvelopeBearings, kEnvelopeElevations, &xz);
+    out->envelope.clear();
+    for (size_t i = 0; i + 1 < xz.size(); i += 2) out->envelope.push_back({xz[i], 0.01f, xz[i + 1]});
+
+    out->arc.clear();
+    astro_ballistics::TracePath(b, origin, out->aim.launch, 4, [&](float x, float y, float z) { out->arc.push_back({x, y, z}); });
+    out->target = target;
+    out->valid = true;
+    out->solveMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void DrawTargeting(const TargetingSolution& solution) {
+    if (!solution.valid) return;
+    for (size_t i = 0; i < solution.envelope.size(); ++i) {
+        DrawLine3D(solution.envelope[i], solution.envelope[(i + 1) % solution.envelope.size()], Color{120, 230, 160, 170});
+    }
+    const Color arcColor = solution.aim.hit ? Color{255, 236, 140, 255} : Color{255, 110, 110, 200};
+    for (size_t i = 1; i < solution.arc.size(); ++i) DrawLine3D(solution.arc[i - 1], solution.arc[i], arcColor);
+    DrawCylinderWires(solution.target, 0.35f, 0.35f, 0.02f, 20, Color{255, 120, 90, 255});
+    DrawSphere(solution.target, 0.07f, Color{255, 120, 90, 255});
+}
+
+// Where the mouse ray meets the ground, if it does.
+bool PickGround(const Camera3D& camera, Vector3* point) {
+    const Ray ray = GetMouseRay(GetMousePosition(), camera);
+    if (ray.direction.y > -1.0e-4f) return false;
+    const float t = -ray.position.y / ray.direction.y;
+    *point = Vector3Add(ray.position, Vector3Scale(ray.direction, t));
+    point->y = 0.0f;
+    return true;
+}
+
 } // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 100, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // One bench step is a full targeting solve in a crosswind, target moving each time.
+        astro_ballistics::AimSolver solver;
+        TargetingSolution solution;
+        int frame = 0;
+        return astro_bench::RunBench(
+            "projectile_drag_viz", bench,
+            [&](float) {
+                const Vector3 target = {6.0f + 0.05f * static_cast<float>(frame % 80), 0.0f, 2.0f};
+                SolveTargeting(&solver, MakeBallistics(0.08f, {-2.0f, 1.5f}), 20.0f, target, &solution);
+                ++frame;
+            },
+            [&]() { return solution.aim.launch.speed; });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Projectile Motion with Drag 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -45,11 +139,9 @@ int main() {
 
     float camYaw = 0.8f, camPitch = 0.33f, camDistance = 15.0f;
 
-    auto resetState = [&](Vector3* pNo, Vector3* vNo, Vector3* pDr, Vector3* vDr, std::deque<Vector3>* trNo, std::deque<Vector3>* trDr, float speed, float angleDeg) {
-        float ang = angleDeg * PI / 180.0f;
-        Vector3 v0 = {speed * std::cos(ang), speed * std::sin(ang), 0.0f};
-        *pNo = {0.0f, 0.15f, -0.3f}; *vNo = v0;
-        *pDr = {0.0f, 0.15f, 0.3f};  *vDr = v0;
+    auto resetState = [&](Vector3* pNo, Vector3* vNo, Vector3* pDr, Vector3* vDr, std::deque<Vector3>* trNo, std::deque<Vector3>* trDr, Vector3 v0) {
+        *pNo = kVacuumStart; *vNo = v0;
+        *pDr = kDragStart;   *vDr = v0;
         trNo->clear(); trDr->clear();
         trNo->push_back(*pNo); trDr->push_back(*pDr);
     };
@@ -57,23 +149,63 @@ int main() {
     float speed = 14.0f;
     float angleDeg = 44.0f;
     float dragK = 0.08f;
+    Vector2 wind = {0.0f, 0.0f};
     bool paused = false;
+    auto launchVelocity = [&]() {
+        float ang = angleDeg * PI / 180.0f;
+        return Vector3{speed * std::cos(ang), speed * std::sin(ang), 0.0f};
+    };
+
+    bool targeting = false;
+    bool targetSet = false;
+    bool solveDirty = false;
+    Vector3 target = {9.0f, 0.0f, 1.5f};
+    astro_ballistics::AimSolver solver;
+    TargetingSolution solution;
+    float fixedClock = 0.0f;
 
     Vector3 pNo{}, vNo{}, pDr{}, vDr{};
     std::deque<Vector3> trNo, trDr;
-    resetState(&pNo, &vNo, &pDr, &vDr, &trNo, &trDr, speed, angleDeg);
+    resetState(&pNo, &vNo, &pDr, &vDr, &trNo, &trDr, launchVelocity());
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_R)) { paused = false; resetState(&pNo, &vNo, &pDr, &vDr, &trNo, &trDr, speed, angleDeg); }
+        if (IsKeyPressed(KEY_R)) { paused = false; resetState(&pNo, &vNo, &pDr, &vDr, &trNo, &trDr, launchVelocity()); }
+        const float oldDrag = dragK, oldSpeed = speed;
+        const Vector2 oldWind = wind;
         if (IsKeyPressed(KEY_LEFT_BRACKET)) dragK = std::max(0.0f, dragK - 0.01f);
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) dragK = std::min(0.3f, dragK + 0.01f);
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) angleDeg = std::max(10.0f, angleDeg - 1.0f);
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) angleDeg = std::min(80.0f, angleDeg + 1.0f);
         if (IsKeyPressed(KEY_COMMA)) speed = std::max(4.0f, speed - 0.5f);
         if (IsKeyPressed(KEY_PERIOD)) speed = std::min(30.0f, speed + 0.5f);
+        if (IsKeyPressed(KEY_LEFT)) wind.x = std::max(-kMaxWind, wind.x - kWindStep);
+        if (IsKeyPressed(KEY_RIGHT)) wind.x = std::min(kMaxWind, wind.x + kWindStep);
+        if (IsKeyPressed(KEY_UP)) wind.y = std::max(-kMaxWind, wind.y - kWindStep);
+        if (IsKeyPressed(KEY_DOWN)) wind.y = std::min(kMaxWind, wind.y + kWindStep);
+        if (dragK != oldDrag || speed != oldSpeed || wind.x != oldWind.x || wind.y != oldWind.y) solveDirty = true;
+
+        if (IsKeyPressed(KEY_T)) {
+            targeting = !targeting;
+            solveDirty = targeting;
+        }
+        if (targeting && IsMouseButtonPressed(MOUSE_RIGHT_BUTTON) && PickGround(camera, &target)) {
+            targetSet = true;
+            solveDirty = true;
+        }
+        if (targeting && solveDirty) {
+            SolveTargeting(&solver, MakeBallistics(dragK, wind), speed, target, &solution);
+            solveDirty = false;
+        }
 
-        if (IsKeyPressed(KEY_SPACE)) resetState(&pNo, &vNo, &pDr, &vDr, &trNo, &trDr, speed, angleDeg);
+        if (IsKeyPressed(KEY_SPACE)) {
+            Vector3 v0 = launchVelocity();
+            if (targeting && solution.valid) {
+                astro_ballistics::LaunchVelocity(solution.aim.launch, &v0.x, &v0.y, &v0.z);
+            }
+            resetState(&pNo, &vNo, &pDr, &vDr, &trNo, &trDr, v0);
+            fixedClock = 0.0f;
+        }
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
@@ -87,12 +219,26 @@ int main() {
                 trNo.push_back(pNo);
             }
 
-            if (pDr.y > 0.0f) {
-                Vector3 drag = Vector3Scale(vDr, -dragK * Vector3Length(vDr));
-                vDr = Vector3Add(vDr, Vector3Scale(Vector3Add(g, drag), dt));
-                pDr = Vector3Add(pDr, Vector3Scale(vDr, dt));
-                trDr.push_back(pDr);
+            // Fixed steps of the solver's integrator; at rest the shell sits where it landed.
+            fixedClock += dt;
+            const astro_ballistics::Ballistics b = MakeBallistics(dragK, wind);
+            while (fixedClock >= kFixedDt && pDr.y > 0.0f) {
+                fixedClock -= kFixedDt;
+                float p[3] = {pDr.x, pDr.y, pDr.z};
+                float v[3] = {vDr.x, vDr.y, vDr.z};
+                const float prevY = pDr.y;
+                astro_ballistics::Step(b, p, v);
+                if (p[1] <= 0.0f) {
+                    const float f = prevY / std::max(prevY - p[1], 1.0e-12f);
+                    p[0] = pDr.x + f * (p[0] - pDr.x);
+                    p[2] = pDr.z + f * (p[2] - pDr.z);
+                    p[1] = 0.0f;
+                }
+                pDr = {p[0], p[1], p[2]};
+                vDr = {v[0], v[1], v[2]};
             }
+            if (fixedClock > kFixedDt) fixedClock = 0.0f;
+            if (trDr.empty() || Vector3Distance(trDr.back(), pDr) > 1.0e-4f) trDr.push_back(pDr);
 
             if (trNo.size() > 1500) trNo.pop_front();
             if (trDr.size() > 1500) trDr.pop_front();
@@ -108,24 +254,47 @@ int main() {
 
         DrawSphere(pNo, 0.11f, Color{130, 220, 255, 255});
         DrawSphere(pDr, 0.11f, Color{255, 170, 110, 255});
+        if (targeting) DrawTargeting(solution);
+        if (wind.x != 0.0f || wind.y != 0.0f) {
+            const Vector3 from = {-1.5f, 0.05f, -2.0f};
+            const Vector3 to = Vector3Add(from, {0.3f * wind.x, 0.0f, 0.3f * wind.y});
+            DrawLine3D(from, to, Color{170, 200, 255, 255});
+            DrawSphere(to, 0.05f, Color{170, 200, 255, 255});
+        }
 
         EndMode3D();
 
         DrawText("Projectile Motion: Vacuum vs Air Drag", 20, 18, 29, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] drag | +/- angle | , . speed | SPACE relaunch | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] drag | +/- angle | , . speed | arrows wind | SPACE relaunch | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
+        DrawText("T targeting: right-click the ground to aim, SPACE fires the least-speed shot; green ring is reachable at the set speed", 20, 140, 18, Color{164, 183, 210, 255});
 
         std::ostringstream os;
         os << std::fixed << std::setprecision(2)
            << "drag=" << dragK << "  angle=" << angleDeg << "deg  speed=" << speed
            << "  range(no drag)=" << std::max(0.0f, pNo.x)
-           << "  range(drag)=" << std::max(0.0f, pDr.x);
+           << "  range(drag)=" << std::max(0.0f, pDr.x)
+           << "  wind=(" << wind.x << ", " << wind.y << ")";
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{126, 224, 255, 255});
+        if (targeting && solution.valid) {
+            const astro_ballistics::AimResult& aim = solution.aim;
+            std::ostringstream ts;
+            ts << std::fixed << std::setprecision(2);
+            if (!targetSet) ts << "(default target) ";
+            ts << (aim.hit ? "aim: " : "out of reach, closest: ")
+               << "elev=" << aim.launch.elevation * RAD2DEG << "deg  az=" << aim.launch.azimuth * RAD2DEG
+               << "deg  speed=" << aim.launch.speed << "  miss=" << aim.miss << "  flight=" << aim.flightTime
+               << "s  " << aim.flights << " trajectories in " << solution.solveMs << " ms";
+            DrawText(ts.str().c_str(), 20, 166, 18, aim.hit ? Color{255, 236, 140, 255} : Color{255, 130, 120, 255});
+        }
         DrawFPS(20, 110);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
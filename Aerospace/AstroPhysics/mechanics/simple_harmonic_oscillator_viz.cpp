@@ -1,6 +1,9 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -185,9 +188,12 @@ int main() {
         DrawText("x(t)", graphX + 8, graphY + 8, 18, Color{170, 190, 220, 255});
         DrawFPS(20, 120);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,9 +1,19 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "rlgl.h"
+
+#include "../common/colormap.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+#include "../common/shallow_water.h"
+#include "../common/wind_tracers.h"
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <random>
 #include <vector>
 
 namespace {
@@ -12,7 +22,15 @@ constexpr int kScreenWidth = 1440;
 constexpr int kScreenHeight = 900;
 constexpr float kEarthRadius = 3.0f;
 constexpr int kStarCount = 240;
-constexpr int kWindParticleCount = 900;
+constexpr int kWindParticleCount = 900;     // CPU tracers when the GPU path is unavailable
+constexpr int kGpuTracerCount = 200000;
+constexpr uint32_t kTracerSeed = 2319;
+constexpr uint32_t kWeatherSeed = 7;
+constexpr float kSimRate = 0.5f;            // model time units per second; a day is 2 pi
+constexpr int kFieldTextureWidth = 256;
+constexpr int kFieldTextureHeight = 128;
+constexpr float kPressureSpan = 0.35f;      // depth anomaly shown as full-scale high/low
+constexpr float kWindRadius = kEarthRadius * 1.12f;
 
 struct OrbitCameraState {
     float yaw = 0.72f;
@@ -27,25 +45,12 @@ struct WindParticle {
     float layer = 0.0f;
 };
 
-struct Storm {
-    float lat = 0.0f;
-    float lon = 0.0f;
-    float radius = 0.0f;
-    float spin = 1.0f;
-    float drift = 0.0f;
-};
-
 struct Star {
     Vector3 pos{};
     float radius = 0.0f;
     float alpha = 0.0f;
 };
 
-float RandRange(std::mt19937& rng, float lo, float hi) {
-    std::uniform_real_distribution<float> dist(lo, hi);
-    return dist(rng);
-}
-
 Color LerpColor(Color a, Color b, float t) {
     const float u = std::clamp(t, 0.0f, 1.0f);
     return Color{
@@ -92,70 +97,60 @@ void UpdateOrbitCamera(Camera3D* camera, OrbitCameraState* orbit) {
 }
 
 std::vector<Star> MakeStars() {
-    std::mt19937 rng(9031);
+    astro_random::PhiloxStream rng(9031);
     std::vector<Star> stars;
     stars.reserve(kStarCount);
 
     for (int i = 0; i < kStarCount; ++i) {
-        const float lon = RandRange(rng, -PI, PI);
-        const float lat = RandRange(rng, -0.48f * PI, 0.48f * PI);
-        const float radius = RandRange(rng, 26.0f, 42.0f);
-        stars.push_back({GlobePoint(lat, lon, radius), RandRange(rng, 0.015f, 0.055f), RandRange(rng, 0.25f, 0.92f)});
+        const float lon = rng.Uniform(-PI, PI);
+        const float lat = rng.Uniform(-0.48f * PI, 0.48f * PI);
+        const float radius = rng.Uniform(26.0f, 42.0f);
+        stars.push_back({GlobePoint(lat, lon, radius), rng.Uniform(0.015f, 0.055f), rng.Uniform(0.25f, 0.92f)});
     }
 
     return stars;
 }
 
 std::vector<WindParticle> MakeWindParticles() {
-    std::mt19937 rng(2319);
+    astro_random::PhiloxStream rng(kTracerSeed);
     std::vector<WindParticle> particles;
     particles.reserve(kWindParticleCount);
 
     for (int i = 0; i < kWindParticleCount; ++i) {
         particles.push_back({
-            RandRange(rng, -1.22f, 1.22f),
-            RandRange(rng, -PI, PI),
-            RandRange(rng, 0.25f, 1.0f),
-            RandRange(rng, 0.0f, 1.0f),
+            rng.Uniform(-1.22f, 1.22f),
+            rng.Uniform(-PI, PI),
+            rng.Uniform(0.25f, 1.0f),
+            rng.Uniform(0.0f, 1.0f),
         });
     }
 
     return particles;
 }
 
-std::vector<Storm> MakeStorms() {
-    return {
-        {0.42f, -1.25f, 0.54f, 1.0f, 0.22f},
-        {0.20f, 1.95f, 0.45f, 1.0f, 0.18f},
-        {-0.36f, 0.45f, 0.50f, -1.0f, 0.20f},
-        {-0.62f, -2.36f, 0.38f, -1.0f, 0.15f},
-    };
-}
+float LatitudeOf(Vector3 p) { return std::asin(std::clamp(p.y, -1.0f, 1.0f)); }
+float LongitudeOf(Vector3 p) { return std::atan2(p.z, p.x); }
 
-float PressureField(float lat, float lon, float time) {
-    const float equatorialWave = 0.42f * std::sin(3.0f * lon - time * 0.55f) * std::cos(lat * 1.25f);
-    const float rossbyWave = 0.34f * std::sin(5.0f * lon + 2.6f * lat + time * 0.22f);
-    const float polar = 0.32f * std::sin(std::fabs(lat) * 3.2f - time * 0.16f);
-    return equatorialWave + rossbyWave + polar;
-}
+float PressureAnomaly(float depth) { return std::clamp((depth - 1.0f) / kPressureSpan, -1.0f, 1.0f); }
 
-float TemperatureField(float lat, float lon, float time) {
-    const float latitudeGradient = 1.0f - std::pow(std::fabs(lat) / (0.5f * PI), 1.28f);
-    const float dayWave = 0.15f * std::cos(lon - time * 0.18f) * std::cos(lat);
-    return std::clamp(latitudeGradient + dayWave, 0.0f, 1.0f);
-}
+// Both ramps are also uploaded as textures for the shell shader.
+const astro_color::Colormap kTemperatureMap = astro_color::Colormap::FromStops({
+    {0.00f, Color{34, 92, 184, 255}},
+    {0.35f, Color{92, 214, 238, 255}},
+    {0.68f, Color{236, 218, 102, 255}},
+    {1.00f, Color{238, 88, 58, 255}},
+});
 
-Color TemperatureColor(float value) {
-    if (value < 0.35f) return LerpColor(Color{34, 92, 184, 255}, Color{92, 214, 238, 255}, value / 0.35f);
-    if (value < 0.68f) return LerpColor(Color{92, 214, 238, 255}, Color{236, 218, 102, 255}, (value - 0.35f) / 0.33f);
-    return LerpColor(Color{236, 218, 102, 255}, Color{238, 88, 58, 255}, (value - 0.68f) / 0.32f);
-}
+// Pressure anomaly, -1 (low) to +1 (high).
+const astro_color::Colormap kPressureMap = astro_color::Colormap::FromStops({
+    {0.0f, Color{42, 98, 214, 255}},
+    {0.5f, Color{236, 240, 244, 255}},
+    {1.0f, Color{222, 66, 78, 255}},
+}, -1.0f, 1.0f);
 
-Color PressureColor(float value) {
-    const float t = std::clamp((value + 1.0f) * 0.5f, 0.0f, 1.0f);
-    if (t < 0.5f) return LerpColor(Color{42, 98, 214, 255}, Color{236, 240, 244, 255}, t * 2.0f);
-    return LerpColor(Color{236, 240, 244, 255}, Color{222, 66, 78, 255}, (t - 0.5f) * 2.0f);
-}
+Color TemperatureColor(float value) { return kTemperatureMap(value); }
+
+Color PressureColor(float value) { return kPressureMap(value); }
 
 void DrawGlobeGrid() {
     for (int latStep = -6; latStep <= 6; ++latStep) {
@@ -181,7 +176,129 @@ void DrawGlobeGrid() {
     }
 }
 
-void DrawWeatherCells(float time, bool showTemperature, bool showPressure) {
+// The simulated fields as one float texture, updated once per frame and read both by
+// the globe shell shader and by the GPU wind tracers.
+struct WeatherLayer {
+    Texture2D fields{};
+    Texture2D temperatureMap{};  // colormap textures, bound as texture1 / texture2
+    Texture2D pressureMap{};
+    Shader shellShader{};
+    Model shell{};
+    int locShowTemperature = -1;
+    int locShowPressure = -1;
+    int locPressureSpan = -1;
+    bool shellReady = false;
+};
+
+constexpr const char* kShellVertexShader = R"(#version 330
+in vec3 vertexPosition;
+uniform mat4 mvp;
+out vec3 objectPos;
+void main() {
+    objectPos = vertexPosition;
+    gl_Position = mvp * vec4(vertexPosition, 1.0);
+}
+)";
+
+constexpr const char* kShellFragmentShader = R"(#version 330
+in vec3 objectPos;
+uniform sampler2D texture0;
+uniform sampler2D texture1;  // kTemperatureMap
+uniform sampler2D texture2;  // kPressureMap
+uniform int showTemperature;
+uniform int showPressure;
+uniform float pressureSpan;
+out vec4 finalColor;
+const float PI = 3.14159265;
+vec3 Rgb(float r, float g, float b) { return vec3(r, g, b) / 255.0; }
+// s in 0..1 across the map, onto the centres of its 256 texels.
+vec3 Ramp(sampler2D map, float s) { return texture(map, vec2(clamp(s, 0.0, 1.0) * (255.0 / 256.0) + 0.5 / 256.0, 0.5)).rgb; }
+void main() {
+    vec3 p = normalize(objectPos);
+    float lat = asin(clamp(p.y, -1.0, 1.0));
+    float lon = atan(p.z, p.x);
+    vec4 f = texture(texture0, vec2(lon / (2.0 * PI) + 0.5, lat / PI + 0.5));
+    vec3 color = Rgb(68.0, 138.0, 196.0);
+    float alpha = 0.11;
+    if (showTemperature != 0) {
+        color = Ramp(texture1, f.z);
+        alpha = 0.30;
+    }
+    if (showPressure != 0) {
+        vec3 pressure = Ramp(texture2, 0.5 + 0.5 * (f.w - 1.0) / pressureSpan);
+        color = showTemperature != 0 ? mix(color, pressure, 0.42) : pressure;
+        alpha = showTemperature != 0 ? 0.34 : 0.28;
+    }
+    finalColor = vec4(color, alpha);
+}
+)";
+
+void InitWeatherLayer(WeatherLayer* layer, const astro_weather::EquirectBaker& baker) {
+    layer->fields.id = rlLoadTexture(baker.pixels().data(), baker.width(), baker.height(), PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, 1);
+    layer->fields.width = baker.width();
+    layer->fields.height = baker.height();
+    layer->fields.mipmaps = 1;
+    layer->fields.format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32;
+    if (layer->fields.id == 0) return;
+    rlTextureParameters(layer->fields.id, RL_TEXTURE_WRAP_S, RL_TEXTURE_WRAP_REPEAT);
+    rlTextureParameters(layer->fields.id, RL_TEXTURE_WRAP_T, RL_TEXTURE_WRAP_CLAMP);
+    rlTextureParameters(layer->fields.id, RL_TEXTURE_MIN_FILTER, RL_TEXTURE_FILTER_LINEAR);
+    rlTextureParameters(layer->fields.id, RL_TEXTURE_MAG_FILTER, RL_TEXTURE_FILTER_LINEAR);
+
+    layer->temperatureMap = astro_color::LoadColormapTexture(kTemperatureMap);
+    layer->pressureMap = astro_color::LoadColormapTexture(kPressureMap);
+    if (layer->temperatureMap.id == 0 || layer->pressureMap.id == 0) return;
+
+    layer->shellShader = LoadShaderFromMemory(kShellVertexShader, kShellFragmentShader);
+    if (layer->shellShader.id == 0 || layer->shellShader.id == rlGetShaderIdDefault()) return;
+    layer->locShowTemperature = GetShaderLocation(layer->shellShader, "showTemperature");
+    layer->locShowPressure = GetShaderLocation(layer->shellShader, "showPressure");
+    layer->locPressureSpan = GetShaderLocation(layer->shellShader, "pressureSpan");
+    const float span = kPressureSpan;
+    SetShaderValue(layer->shellShader, layer->locPressureSpan, &span, SHADER_UNIFORM_FLOAT);
+    layer->shell = LoadModelFromMesh(GenMeshSphere(kEarthRadius * 1.013f, 64, 96));
+    layer->shell.materials[0].shader = layer->shellShader;
+    layer->shell.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = layer->fields;
+    layer->shell.materials[0].maps[MATERIAL_MAP_SPECULAR].texture = layer->temperatureMap;
+    layer->shell.materials[0].maps[MATERIAL_MAP_NORMAL].texture = layer->pressureMap;
+    layer->shellReady = true;
+}
+
+void UploadWeatherLayer(const WeatherLayer& layer, const astro_weather::EquirectBaker& baker) {
+    if (layer.fields.id == 0) return;
+    rlUpdateTexture(layer.fields.id, 0, 0, baker.width(), baker.height(), PIXELFORMAT_UNCOMPRESSED_R32G32B32A32, baker.pixels().data());
+}
+
+void UnloadWeatherLayer(WeatherLayer* layer) {
+    if (layer->shellReady) {
+        // Owned below, not by the model.
+        layer->shell.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = Texture2D{};
+        layer->shell.materials[0].maps[MATERIAL_MAP_SPECULAR].texture = Texture2D{};
+        layer->shell.materials[0].maps[MATERIAL_MAP_NORMAL].texture = Texture2D{};
+        UnloadModel(layer->shell);  // also unloads the shell shader
+    } else if (layer->shellShader.id != 0 && layer->shellShader.id != rlGetShaderIdDefault()) {
+        UnloadShader(layer->shellShader);
+    }
+    if (layer->fields.id != 0) rlUnloadTexture(layer->fields.id);
+    if (layer->temperatureMap.id != 0) UnloadTexture(layer->temperatureMap);
+    if (layer->pressureMap.id != 0) UnloadTexture(layer->pressureMap);
+    *layer = WeatherLayer{};
+}
+
+void DrawWeatherCells(const WeatherLayer& layer, const astro_weather::ShallowWaterSolver& solver, bool showTemperature, bool showPressure) {
+    if (layer.shellReady) {
+        const int temperature = showTemperature ? 1 : 0;
+        const int pressure = showPressure ? 1 : 0;
+        SetShaderValue(layer.shellShader, layer.locShowTemperature, &temperature, SHADER_UNIFORM_INT);
+        SetShaderValue(layer.shellShader, layer.locShowPressure, &pressure, SHADER_UNIFORM_INT);
+        // No depth writes, so the grid and cloud lines just inside the shell still show.
+        rlDrawRenderBatchActive();
+        rlDisableDepthMask();
+        DrawModel(layer.shell, {0.0f, 0.0f, 0.0f}, 1.0f, WHITE);
+        rlEnableDepthMask();
+        return;
+    }
+
     constexpr int kLatBands = 28;
     constexpr int kLonBands = 56;
 
@@ -189,16 +306,17 @@ void DrawWeatherCells(float time, bool showTemperature, bool showPressure) {
         const float lat = -0.46f * PI + 0.92f * PI * (static_cast<float>(iy) + 0.5f) / kLatBands;
         for (int ix = 0; ix < kLonBands; ++ix) {
             const float lon = -PI + 2.0f * PI * (static_cast<float>(ix) + 0.5f) / kLonBands;
+            const astro_weather::SurfaceSample sample = solver.Sample(GlobePoint(lat, lon, 1.0f));
             Color color = Color{68, 138, 196, 255};
             float alpha = 0.11f;
 
             if (showTemperature) {
-                color = TemperatureColor(TemperatureField(lat, lon, time));
+                color = TemperatureColor(sample.temperature);
                 alpha = 0.23f;
             }
             if (showPressure) {
-                color = showTemperature ? LerpColor(color, PressureColor(PressureField(lat, lon, time)), 0.42f)
-                                        : PressureColor(PressureField(lat, lon, time));
+                const Color pressure = PressureColor(PressureAnomaly(sample.depth));
+                color = showTemperature ? LerpColor(color, pressure, 0.42f) : pressure;
                 alpha = showTemperature ? 0.26f : 0.21f;
             }
 
@@ -222,21 +340,26 @@ void DrawJetStreams(float time) {
     }
 }
 
-void UpdateWindParticles(std::vector<WindParticle>* particles, float dt, float time) {
+// CPU fallback for the GPU tracers: the same RK2 step through the simulated wind.
+void UpdateWindParticles(std::vector<WindParticle>* particles, const astro_weather::ShallowWaterSolver& solver, float dt) {
+    const auto rate = [&](float lat, float lon) {
+        const astro_weather::SurfaceSample s = solver.Sample(GlobePoint(lat, lon, 1.0f));
+        return Vector2{s.north, s.east / std::max(0.05f, std::cos(lat))};
+    };
     for (WindParticle& particle : *particles) {
-        const float jet = 0.35f + 1.15f * std::exp(-std::pow((std::fabs(particle.lat) - 0.82f) / 0.18f, 2.0f));
-        const float trade = -0.33f * std::cos(particle.lat * 3.0f);
-        const float wave = 0.12f * std::sin(4.0f * particle.lon + particle.lat * 2.0f + time);
-        particle.lon = WrapPi(particle.lon + (trade + jet + wave) * particle.speed * dt * 0.18f);
-        particle.lat += 0.025f * std::sin(2.0f * particle.lon - time * 0.55f + particle.layer * 6.0f) * dt;
-        particle.lat = std::clamp(particle.lat, -1.35f, 1.35f);
+        const Vector2 k1 = rate(particle.lat, particle.lon);
+        const Vector2 k2 = rate(particle.lat + 0.5f * dt * k1.x, particle.lon + 0.5f * dt * k1.y);
+        particle.lat = std::clamp(particle.lat + dt * k2.x, -1.35f, 1.35f);
+        particle.lon = WrapPi(particle.lon + dt * k2.y);
+        const astro_weather::SurfaceSample s = solver.Sample(GlobePoint(particle.lat, particle.lon, 1.0f));
+        particle.speed = std::clamp(std::sqrt(s.east * s.east + s.north * s.north) * 8.0f, 0.0f, 1.0f);
     }
 }
 
 void DrawWindParticles(const std::vector<WindParticle>& particles, float time) {
     for (const WindParticle& particle : particles) {
-        const Vector3 p = GlobePoint(particle.lat, particle.lon, kEarthRadius * 1.12f);
-        const Vector3 tail = GlobePoint(particle.lat, particle.lon - 0.030f - 0.018f * particle.speed, kEarthRadius * 1.115f);
+        const Vector3 p = GlobePoint(particle.lat, particle.lon, kWindRadius);
+        const Vector3 tail = GlobePoint(particle.lat, particle.lon - 0.030f - 0.018f * particle.speed, kWindRadius * 0.996f);
         const float alpha = 0.26f + 0.20f * std::sin(time * 2.0f + particle.layer * 8.0f);
         DrawLine3D(tail, p, Fade(Color{226, 246, 255, 255}, alpha));
         DrawSphere(p, 0.018f + particle.speed * 0.012f, Fade(Color{210, 244, 255, 255}, 0.62f));
@@ -259,21 +382,28 @@ void DrawCloudBands(float time) {
     }
 }
 
-void DrawStorms(const std::vector<Storm>& storms, float time) {
-    for (const Storm& storm : storms) {
-        const float centerLon = WrapPi(storm.lon + storm.drift * time * 0.07f);
-        const Vector3 eye = GlobePoint(storm.lat, centerLon, kEarthRadius * 1.15f);
-        DrawSphere(eye, 0.060f, Color{245, 250, 255, 225});
+// Spiral arms on the model's storm cells, wound by the sense in which each one turns:
+// lows spin cyclonically, highs the other way, and both flip across the equator.
+void DrawStorms(const std::vector<astro_weather::StormCell>& storms, float time) {
+    for (const astro_weather::StormCell& storm : storms) {
+        const float lat = LatitudeOf(storm.center);
+        const float centerLon = LongitudeOf(storm.center);
+        const float strength = storm.Envelope();
+        const float spin = (storm.strength < 0.0f ? 1.0f : -1.0f) * (lat >= 0.0f ? 1.0f : -1.0f);
+        const float radius = 3.6f * storm.radius;
+        const float fade = (storm.strength < 0.0f ? 1.0f : 0.45f) * strength;
+        const Vector3 eye = GlobePoint(lat, centerLon, kEarthRadius * 1.15f);
+        DrawSphere(eye, 0.060f * (0.5f + 0.5f * strength), Fade(Color{245, 250, 255, 255}, 0.88f * fade));
 
         for (int arm = 0; arm < 3; ++arm) {
             Vector3 prev = eye;
             for (int i = 1; i <= 38; ++i) {
                 const float t = static_cast<float>(i) / 38.0f;
-                const float angle = storm.spin * (t * 4.6f + arm * 2.0f * PI / 3.0f + time * 0.72f);
-                const float lat = storm.lat + storm.radius * t * 0.38f * std::sin(angle);
-                const float lon = centerLon + storm.radius * t * std::cos(angle) / std::max(0.25f, std::cos(storm.lat));
-                const Vector3 p = GlobePoint(lat, lon, kEarthRadius * (1.11f + 0.025f * t));
-                DrawLine3D(prev, p, Fade(Color{245, 250, 255, 255}, 0.38f * (1.0f - t * 0.28f)));
+                const float angle = spin * (t * 4.6f + arm * 2.0f * PI / 3.0f + time * 0.72f);
+                const float pointLat = lat + radius * t * 0.38f * std::sin(angle);
+                const float lon = centerLon + radius * t * std::cos(angle) / std::max(0.25f, std::cos(lat));
+                const Vector3 p = GlobePoint(pointLat, lon, kEarthRadius * (1.11f + 0.025f * t));
+                DrawLine3D(prev, p, Fade(Color{245, 250, 255, 255}, 0.38f * fade * (1.0f - t * 0.28f)));
                 prev = p;
             }
         }
@@ -298,9 +428,36 @@ void DrawContinents() {
     }
 }
 
+double FieldChecksum(const astro_weather::EquirectBaker& baker) {
+    double sum = 0.0;
+    const std::vector<float>& pixels = baker.pixels();
+    for (size_t i = 0; i < pixels.size(); i += 4 * 61) sum += pixels[i + 3] + pixels[i];
+    return sum;
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    astro_weather::ShallowWaterConfig config;
+    config.faceCells = std::max(8, astro_bench::IntArg(argc, argv, "--cells", config.faceCells));
+    astro_weather::ShallowWaterSolver solver;
+    solver.Configure(config, kWeatherSeed);
+    astro_weather::EquirectBaker baker;
+    baker.Configure(solver, kFieldTextureWidth, kFieldTextureHeight);
+    baker.Bake(solver);
+
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 240, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // Frames at the fastest interactive time scale (x4).
+        return astro_bench::RunBench(
+            "earth_weather_globe_viz", bench,
+            [&](float dt) {
+                solver.Step(4.0f * kSimRate * dt);
+                baker.Bake(solver);
+            },
+            [&]() { return static_cast<float>(FieldChecksum(baker)); });
+    }
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
     InitWindow(kScreenWidth, kScreenHeight, "Earth Weather Globe - Meteorology Visualization");
     SetWindowMinSize(980, 640);
@@ -316,7 +473,10 @@ int main() {
     OrbitCameraState orbit{};
     std::vector<Star> stars = MakeStars();
     std::vector<WindParticle> wind = MakeWindParticles();
-    const std::vector<Storm> storms = MakeStorms();
+    WeatherLayer layer;
+    InitWeatherLayer(&layer, baker);
+    astro_render::GpuWindTracers tracers;
+    const bool gpuTracers = layer.fields.id != 0 && tracers.Init(kGpuTracerCount, kTracerSeed);
 
     bool showTemperature = true;
     bool showPressure = true;
@@ -324,6 +484,7 @@ int main() {
     bool paused = false;
     float simTime = 0.0f;
     float timeScale = 1.0f;
+    float stepMs = 0.0f;
 
     while (!WindowShouldClose()) {
         const float dt = std::max(1.0e-4f, GetFrameTime());
@@ -335,14 +496,25 @@ int main() {
         if (IsKeyPressed(KEY_SPACE)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
             simTime = 0.0f;
+            solver.Reset(kWeatherSeed);
             wind = MakeWindParticles();
         }
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) timeScale = std::min(4.0f, timeScale + 0.25f);
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) timeScale = std::max(0.25f, timeScale - 0.25f);
 
         if (!paused) {
+            const float modelDt = kSimRate * dt * timeScale;
             simTime += dt * timeScale;
-            UpdateWindParticles(&wind, dt * timeScale, simTime);
+            const auto start = std::chrono::steady_clock::now();
+            solver.Step(modelDt);
+            baker.Bake(solver);
+            stepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            UploadWeatherLayer(layer, baker);
+            if (gpuTracers) {
+                tracers.Advect(layer.fields.id, modelDt);
+            } else {
+                UpdateWindParticles(&wind, solver, modelDt);
+            }
         }
 
         BeginDrawing();
@@ -356,18 +528,24 @@ int main() {
         DrawSphere({0.0f, 0.0f, 0.0f}, kEarthRadius * 1.035f, Fade(Color{80, 166, 255, 255}, 0.08f));
         DrawSphere({0.0f, 0.0f, 0.0f}, kEarthRadius, Color{21, 64, 120, 255});
         DrawContinents();
-        DrawWeatherCells(simTime, showTemperature, showPressure);
+        DrawWeatherCells(layer, solver, showTemperature, showPressure);
         DrawGlobeGrid();
         DrawCloudBands(simTime);
-        DrawStorms(storms, simTime);
+        DrawStorms(solver.storms(), simTime);
         DrawJetStreams(simTime);
-        if (showWind) DrawWindParticles(wind, simTime);
+        if (showWind) {
+            if (gpuTracers) {
+                tracers.Draw(layer.fields.id, kWindRadius, 0.6f, 0.0045f, 0.5f);
+            } else {
+                DrawWindParticles(wind, simTime);
+            }
+        }
 
         EndMode3D();
 
-        DrawRectangle(14, 14, 560, 146, Fade(BLACK, 0.32f));
+        DrawRectangle(14, 14, 600, 172, Fade(BLACK, 0.32f));
         DrawText("Earth Weather Globe", 28, 26, 32, Color{238, 244, 252, 255});
-        DrawText("Synthetic meteorology: pressure waves, temperature bands, jet streams, cyclones, cloud cover.", 28, 62, 18, Color{176, 198, 224, 255});
+        DrawText("Rotating shallow-water model: forced jets, storm cells, Coriolis-turned winds.", 28, 62, 18, Color{176, 198, 224, 255});
         DrawText("Mouse orbit | wheel zoom | 1 temperature | 2 pressure | 3 wind | +/- speed | Space pause | R reset", 28, 90, 18, Color{132, 226, 255, 255});
 
         DrawText(TextFormat("Temp %s   Pressure %s   Wind %s   Time x%.2f",
@@ -376,6 +554,9 @@ int main() {
                             showWind ? "on" : "off",
                             timeScale),
                  28, 120, 18, Color{230, 238, 246, 255});
+        DrawText(TextFormat("cubed sphere 6x%d^2, day %.1f, model %.2f ms, %d %s tracers", solver.faceCells(), solver.time() / (2.0f * PI),
+                            stepMs, gpuTracers ? tracers.count() : static_cast<int>(wind.size()), gpuTracers ? "GPU" : "CPU"),
+                 28, 148, 18, Color{176, 198, 224, 255});
 
         DrawRectangle(GetScreenWidth() - 280, 18, 252, 116, Fade(BLACK, 0.28f));
         DrawText("Layer Readout", GetScreenWidth() - 260, 30, 22, Color{238, 244, 252, 255});
@@ -384,9 +565,14 @@ int main() {
         DrawText("White spirals: storm systems", GetScreenWidth() - 260, 108, 17, Color{238, 244, 252, 255});
 
         DrawFPS(GetScreenWidth() - 96, GetScreenHeight() - 34);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    tracers.Unload();
+    UnloadWeatherLayer(&layer);
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
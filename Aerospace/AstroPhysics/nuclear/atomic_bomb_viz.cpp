@@ -1,8 +1,17 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/instanced_particles.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -18,6 +27,21 @@ constexpr float kDetonationButtonX = 1080.0f;
 constexpr float kDetonationButtonY = 18.0f;
 constexpr float kDetonationButtonW = 178.0f;
 constexpr float kDetonationButtonH = 42.0f;
+constexpr float kCaptureRadius = 0.11f;
+constexpr float kLatticeStepXZ = 0.24f;
+constexpr float kLatticeStepY = 0.20f;
+constexpr int kNeutronsPerFission = 2;
+constexpr int kMaxGenerations = 64;
+constexpr size_t kWindowNeutronCapacity = size_t{1} << 17;
+// Fission flashes and debris are drawn per event; past this many the chain still
+// runs but only the first events of a frame get effects.
+constexpr size_t kMaxFissionEffects = 320;
+constexpr uint64_t kEffectSeed = 1945;
+
+// NucleusInReach() checks the nearest lattice column in x/z and the two nearest planes
+// in y, which covers every site within kCaptureRadius only under these bounds.
+static_assert(kCaptureRadius < 0.5f * kLatticeStepXZ, "capture sphere must not reach the next x/z column");
+static_assert(kCaptureRadius < kLatticeStepY, "capture sphere must not reach two y planes away");
 
 struct Fuel {
     Vector3 pos;
@@ -25,12 +49,6 @@ struct Fuel {
     float cooldown;
 };
 
-struct Neutron {
-    Vector3 pos;
-    Vector3 vel;
-    float life;
-};
-
 struct Debris {
     Vector3 pos;
     Vector3 vel;
@@ -49,21 +67,291 @@ float SmoothStep(float x) {
     return x * x * (3.0f - 2.0f * x);
 }
 
-float Rand01() {
-    return static_cast<float>(GetRandomValue(0, 10000)) / 10000.0f;
+// Window-side draws (effect jitter, per-reset chain seeds); the chain has its own stream.
+astro_random::PhiloxStream& EffectRng() {
+    static astro_random::PhiloxStream rng(kEffectSeed);
+    return rng;
 }
 
-void SpawnSeedNeutron(std::vector<Neutron>* neutrons) {
-    float a = 2.0f * PI * Rand01();
-    float y = 2.0f * Rand01() - 1.0f;
-    Vector3 dir = Vector3Normalize({std::cos(a), 0.35f * y, std::sin(a)});
-    Vector3 start = Vector3Scale(dir, 1.30f + 0.22f * Rand01());
-    Vector3 inward = Vector3Normalize(Vector3Negate(start));
-    Vector3 tangent = Vector3Normalize(Vector3CrossProduct(inward, {0.0f, 1.0f, 0.0f}));
-    if (Vector3Length(tangent) < 0.001f) tangent = {1.0f, 0.0f, 0.0f};
-    Vector3 vel = Vector3Normalize(Vector3Add(Vector3Scale(inward, 0.92f), Vector3Scale(tangent, 0.28f)));
-    neutrons->push_back({start, Vector3Scale(vel, 3.1f + Rand01()), 2.0f + 1.1f * Rand01()});
-}
+float Rand01() { return EffectRng().Uniform(); }
+
+// Fuel nuclei on the face-centred lattice (i + j + k even) of the core, plus a dense
+// voxel index from lattice site to nucleus so a capture lookup is a couple of array
+// reads instead of a scan.
+struct FuelLattice {
+    int halfXZ = 0;
+    int halfY = 0;
+    std::vector<Fuel> fuel;
+    std::vector<int32_t> siteToFuel;  // -1 where the site holds no nucleus
+
+    void Build(int halfXZExtent, int halfYExtent) {
+        halfXZ = halfXZExtent;
+        halfY = halfYExtent;
+        const int nxz = 2 * halfXZ + 1;
+        const int ny = 2 * halfY + 1;
+        fuel.clear();
+        siteToFuel.assign(static_cast<size_t>(nxz) * ny * nxz, -1);
+        for (int x = -halfXZ; x <= halfXZ; ++x) {
+            for (int y = -halfY; y <= halfY; ++y) {
+                for (int z = -halfXZ; z <= halfXZ; ++z) {
+                    if ((x + y + z) % 2 != 0) continue;
+                    siteToFuel[Site(x + halfXZ, y + halfY, z + halfXZ)] = static_cast<int32_t>(fuel.size());
+                    fuel.push_back({{kLatticeStepXZ * x, kLatticeStepY * y, kLatticeStepXZ * z}, true, 0.0f});
+                }
+            }
+        }
+    }
+
+    // Index of the nucleus within kCaptureRadius of p, or -1. Of the two y planes
+    // that can be in reach only one holds a site in p's x/z column (i + j + k even),
+    // and its centre follows from the indices, so memory is read only on a hit.
+    int NucleusInReach(Vector3 p) const {
+        // Offsets keep the coordinates positive inside the lattice so truncation acts as floor.
+        const float fx = p.x * (1.0f / kLatticeStepXZ) + static_cast<float>(halfXZ) + 0.5f;
+        const float fz = p.z * (1.0f / kLatticeStepXZ) + static_cast<float>(halfXZ) + 0.5f;
+        const float fy = p.y * (1.0f / kLatticeStepY) + static_cast<float>(halfY) + 1.0f;
+        const float nxz = static_cast<float>(2 * halfXZ + 1);
+        if (!(fx >= 0.0f && fx < nxz && fz >= 0.0f && fz < nxz && fy >= 0.0f)) return -1;
+        const int x = static_cast<int>(fx) - halfXZ;
+        const int z = static_cast<int>(fz) - halfXZ;
+        int y = static_cast<int>(fy) - 1 - halfY;
+        if ((x + y + z) & 1) ++y;
+        if (y < -halfY || y > halfY) return -1;
+        const float dx = p.x - kLatticeStepXZ * static_cast<float>(x);
+        const float dy = p.y - kLatticeStepY * static_cast<float>(y);
+        const float dz = p.z - kLatticeStepXZ * static_cast<float>(z);
+        if (dx * dx + dy * dy + dz * dz >= kCaptureRadius * kCaptureRadius) return -1;
+        return siteToFuel[Site(x + halfXZ, y + halfY, z + halfXZ)];
+    }
+
+    // x, y, z counted from the lattice corner.
+    size_t Site(int x, int y, int z) const {
+        const size_t nxz = static_cast<size_t>(2 * halfXZ + 1);
+        const size_t ny = static_cast<size_t>(2 * halfY + 1);
+        return (static_cast<size_t>(x) * ny + static_cast<size_t>(y)) * nxz + static_cast<size_t>(z);
+    }
+};
+
+// Fixed-capacity neutron store in structure-of-arrays form. Retired slots go on a free
+// list and are handed out again before the high-water mark grows, so the live
+// neutrons stay packed into [0, highWater) and a step is a flat pass over that range.
+class NeutronPool {
+  public:
+    void Reset(size_t capacity) {
+        for (std::vector<float>* a : {&px_, &py_, &pz_, &vx_, &vy_, &vz_, &life_}) a->assign(capacity, 0.0f);
+        generation_.assign(capacity, 0);
+        alive_.assign(capacity, 0);
+        free_.clear();
+        free_.reserve(capacity);
+        highWater_ = 0;
+        liveCount_ = 0;
+    }
+
+    bool Spawn(Vector3 pos, Vector3 vel, float life, int generation) {
+        uint32_t slot;
+        if (!free_.empty()) {
+            slot = free_.back();
+            free_.pop_back();
+        } else if (highWater_ < px_.size()) {
+            slot = static_cast<uint32_t>(highWater_++);
+        } else {
+            return false;
+        }
+        px_[slot] = pos.x;
+        py_[slot] = pos.y;
+        pz_[slot] = pos.z;
+        vx_[slot] = vel.x;
+        vy_[slot] = vel.y;
+        vz_[slot] = vel.z;
+        life_[slot] = life;
+        generation_[slot] = static_cast<uint16_t>(std::min(generation, kMaxGenerations - 1));
+        alive_[slot] = 1;
+        ++liveCount_;
+        return true;
+    }
+
+    void Retire(uint32_t slot) {
+        alive_[slot] = 0;
+        free_.push_back(slot);
+        --liveCount_;
+    }
+
+    // Moves every slot below the high-water mark by dt and ages it. Dead slots move
+    // too; that is cheaper than branching and they are overwritten on reuse.
+    void Drift(float dt) {
+        float* px = px_.data();
+        float* py = py_.data();
+        float* pz = pz_.data();
+        float* life = life_.data();
+        const float* vx = vx_.data();
+        const float* vy = vy_.data();
+        const float* vz = vz_.data();
+        for (size_t i = 0; i < highWater_; ++i) {
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            pz[i] += vz[i] * dt;
+            life[i] -= dt;
+        }
+    }
+
+    size_t LiveCount() const { return liveCount_; }
+    size_t HighWater() const { return highWater_; }
+    size_t capacity() const { return px_.size(); }
+    bool Alive(uint32_t slot) const { return alive_[slot] != 0; }
+    Vector3 Position(uint32_t slot) const { return {px_[slot], py_[slot], pz_[slot]}; }
+    float Life(uint32_t slot) const { return life_[slot]; }
+    int Generation(uint32_t slot) const { return generation_[slot]; }
+
+  private:
+    std::vector<float> px_, py_, pz_, vx_, vy_, vz_, life_;
+    std::vector<uint16_t> generation_;
+    std::vector<uint8_t> alive_;
+    std::vector<uint32_t> free_;
+    size_t highWater_ = 0;
+    size_t liveCount_ = 0;
+};
+
+struct GenerationTally {
+    uint64_t born = 0;      // neutrons that entered the pool in this generation
+    uint64_t fissions = 0;  // fissions caused by neutrons of this generation
+};
+
+// Chain-reaction engine: fuel lattice, neutron pool and per-generation bookkeeping.
+// Each Step() drifts every neutron, resolves captures against the voxel index and
+// stages the fission neutrons, which join the pool (one generation later) only after
+// the whole batch has been processed. Seed neutrons are generation 0.
+class ChainReaction {
+  public:
+    void Reset(int halfXZ, int halfY, size_t neutronCapacity, uint32_t seed) {
+        lattice_.Build(halfXZ, halfY);
+        pool_.Reset(neutronCapacity);
+        // Each nucleus fissions at most once per step.
+        births_.clear();
+        births_.reserve(kNeutronsPerFission * lattice_.fuel.size());
+        fissionSites_.clear();
+        fissionSites_.reserve(lattice_.fuel.size());
+        tally_.fill({});
+        totalFissions_ = 0;
+        endedNeutrons_ = 0;
+        droppedNeutrons_ = 0;
+        rng_ = astro_random::PhiloxStream(seed);
+    }
+
+    // A stray neutron entering the core from just outside the tamper.
+    void SpawnSeed() {
+        const float a = 2.0f * PI * Uniform();
+        const float y = 2.0f * Uniform() - 1.0f;
+        const Vector3 dir = Vector3Normalize({std::cos(a), 0.35f * y, std::sin(a)});
+        const Vector3 start = Vector3Scale(dir, 1.30f + 0.22f * Uniform());
+        const Vector3 inward = Vector3Normalize(Vector3Negate(start));
+        Vector3 tangent = Vector3Normalize(Vector3CrossProduct(inward, {0.0f, 1.0f, 0.0f}));
+        if (Vector3Length(tangent) < 0.001f) tangent = {1.0f, 0.0f, 0.0f};
+        const Vector3 vel = Vector3Normalize(Vector3Add(Vector3Scale(inward, 0.92f), Vector3Scale(tangent, 0.28f)));
+        AddNeutron(start, Vector3Scale(vel, 3.1f + Uniform()), 2.0f + 1.1f * Uniform(), 0);
+    }
+
+    // Generation-0 neutron at a random point of the fuel volume, moving isotropically.
+    void SpawnInCore() {
+        const Vector3 extent = {kLatticeStepXZ * lattice_.halfXZ, kLatticeStepY * lattice_.halfY, kLatticeStepXZ * lattice_.halfXZ};
+        const Vector3 pos = {extent.x * (2.0f * Uniform() - 1.0f), extent.y * (2.0f * Uniform() - 1.0f),
+                             extent.z * (2.0f * Uniform() - 1.0f)};
+        AddNeutron(pos, Vector3Scale(IsotropicDirection(), 2.8f + 1.4f * Uniform()), 1.8f + 1.0f * Uniform(), 0);
+    }
+
+    void Step(float dt, bool detonated) {
+        for (Fuel& f : lattice_.fuel) {
+            if (!f.active) {
+                f.cooldown -= dt;
+                if (f.cooldown <= 0.0f) {
+                    f.cooldown = 0.0f;
+                    f.active = true;
+                }
+            }
+        }
+
+        pool_.Drift(dt);
+
+        fissionSites_.clear();
+        const uint32_t highWater = static_cast<uint32_t>(pool_.HighWater());
+        for (uint32_t slot = 0; slot < highWater; ++slot) {
+            if (!pool_.Alive(slot)) continue;
+            if (pool_.Life(slot) <= 0.0f) {
+                ++endedNeutrons_;
+                pool_.Retire(slot);
+                continue;
+            }
+            const int hit = lattice_.NucleusInReach(pool_.Position(slot));
+            if (hit < 0 || !lattice_.fuel[hit].active) continue;
+
+            Fuel& f = lattice_.fuel[hit];
+            f.active = false;
+            f.cooldown = detonated ? (0.09f + 0.32f * Uniform()) : (0.75f + 1.15f * Uniform());
+            const int generation = pool_.Generation(slot);
+            ++tally_[generation].fissions;
+            ++totalFissions_;
+            ++endedNeutrons_;
+            fissionSites_.push_back(static_cast<uint32_t>(hit));
+            for (int k = 0; k < kNeutronsPerFission; ++k) {
+                const float a = 2.0f * PI * (Uniform() + 0.37f * static_cast<float>(k));
+                const Vector3 dir = Vector3Normalize({std::cos(a), 0.30f * (2.0f * Uniform() - 1.0f), std::sin(a)});
+                births_.push_back({f.pos, Vector3Scale(dir, 2.8f + 1.4f * Uniform()), 1.8f + 1.0f * Uniform(), generation + 1});
+            }
+            pool_.Retire(slot);
+        }
+
+        for (const Birth& b : births_) AddNeutron(b.pos, b.vel, b.life, b.generation);
+        births_.clear();
+    }
+
+    const NeutronPool& pool() const { return pool_; }
+    const std::vector<Fuel>& fuel() const { return lattice_.fuel; }
+    // Nuclei that fissioned during the last Step(), in processing order.
+    const std::vector<uint32_t>& fissionSites() const { return fissionSites_; }
+    const GenerationTally& tally(int generation) const { return tally_[generation]; }
+    uint64_t totalFissions() const { return totalFissions_; }
+    uint64_t droppedNeutrons() const { return droppedNeutrons_; }
+
+    // Neutrons produced per neutron that has finished its flight (by fission or by
+    // leaking out / being absorbed); > 1 means the chain is growing.
+    double MultiplicationFactor() const {
+        return endedNeutrons_ > 0 ? static_cast<double>(kNeutronsPerFission) * totalFissions_ / endedNeutrons_ : 0.0;
+    }
+
+  private:
+    struct Birth {
+        Vector3 pos;
+        Vector3 vel;
+        float life;
+        int generation;
+    };
+
+    void AddNeutron(Vector3 pos, Vector3 vel, float life, int generation) {
+        if (!pool_.Spawn(pos, vel, life, generation)) {
+            ++droppedNeutrons_;
+            return;
+        }
+        ++tally_[std::min(generation, kMaxGenerations - 1)].born;
+    }
+
+    float Uniform() { return rng_.Uniform(); }
+
+    Vector3 IsotropicDirection() {
+        const float y = 2.0f * Uniform() - 1.0f;
+        const float a = 2.0f * PI * Uniform();
+        const float r = std::sqrt(std::max(0.0f, 1.0f - y * y));
+        return {r * std::cos(a), y, r * std::sin(a)};
+    }
+
+    FuelLattice lattice_;
+    NeutronPool pool_;
+    std::vector<Birth> births_;
+    std::vector<uint32_t> fissionSites_;
+    std::array<GenerationTally, kMaxGenerations> tally_{};
+    uint64_t totalFissions_ = 0;
+    uint64_t endedNeutrons_ = 0;
+    uint64_t droppedNeutrons_ = 0;
+    astro_random::PhiloxStream rng_{0u};
+};
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -108,20 +396,62 @@ void DrawBombExterior(unsigned char alpha) {
     DrawCylinderWires({0.0f, -3.05f, 0.0f}, 1.02f, 1.10f, 0.08f, 32, rivet);
 }
 
-std::string Hud(int activeFuel, int nNeutrons, float totalFissions, float camDistance, bool paused, bool detonated) {
+std::string Hud(int activeFuel, const ChainReaction& chain, float camDistance, bool paused, bool detonated) {
     std::ostringstream os;
     os << "core=fission running  active nuclei=" << activeFuel
-       << "  neutrons=" << nNeutrons
-       << "  total fissions=" << std::fixed << std::setprecision(0) << totalFissions
-       << "  zoom=" << std::setprecision(2) << camDistance;
+       << "  neutrons=" << chain.pool().LiveCount()
+       << "  total fissions=" << chain.totalFissions()
+       << "  k=" << std::fixed << std::setprecision(2) << chain.MultiplicationFactor()
+       << "  zoom=" << camDistance;
+    if (chain.droppedNeutrons() > 0) os << "  [POOL FULL]";
     if (detonated) os << "  [DETONATED]";
     if (paused) os << "  [PAUSED]";
     return os.str();
 }
 
+// Fissions caused by each of the first generations, e.g. "g0 812  g1 1430  g2 2210".
+std::string GenerationLine(const ChainReaction& chain, int generations) {
+    std::ostringstream os;
+    os << "fissions by generation:";
+    for (int g = 0; g < generations; ++g) {
+        if (chain.tally(g).born == 0) break;
+        os << "  g" << g << " " << chain.tally(g).fissions;
+    }
+    return os.str();
+}
+
+// Headless run: a larger lattice seeded with many neutrons at once, stepped as if
+// detonated. Prints the per-generation table to stderr after the JSON report.
+int RunHeadless(int argc, char** argv, const astro_bench::BenchOptions& bench) {
+    const int seeds = std::max(1, astro_bench::IntArg(argc, argv, "--neutrons", 100000));
+    const int halfXZ = std::clamp(astro_bench::IntArg(argc, argv, "--lattice", 24), 1, 400);
+    const int halfY = std::max(1, halfXZ * 3 / 4);
+    const size_t capacity = static_cast<size_t>(std::max(astro_bench::IntArg(argc, argv, "--capacity", 0), 4 * seeds));
+
+    ChainReaction chain;
+    chain.Reset(halfXZ, halfY, capacity, 20240611u);
+    for (int i = 0; i < seeds; ++i) chain.SpawnInCore();
+
+    const int status = astro_bench::RunBench(
+        "atomic_bomb_viz", bench, [&](float dt) { chain.Step(dt, true); },
+        [&]() { return static_cast<double>(chain.totalFissions()) + static_cast<double>(chain.pool().LiveCount()); });
+
+    std::fprintf(stderr, "lattice %zu nuclei, capacity %zu, k=%.3f, dropped %llu\n", chain.fuel().size(), capacity,
+                 chain.MultiplicationFactor(), static_cast<unsigned long long>(chain.droppedNeutrons()));
+    for (int g = 0; g < kMaxGenerations && chain.tally(g).born > 0; ++g) {
+        const GenerationTally& t = chain.tally(g);
+        std::fprintf(stderr, "gen %2d  born %10llu  fissions %10llu\n", g, static_cast<unsigned long long>(t.born),
+                     static_cast<unsigned long long>(t.fissions));
+    }
+    return status;
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 240, 1.0f / 60.0f);
+    if (bench.enabled) return RunHeadless(argc, argv, bench);
+
     InitWindow(kScreenWidth, kScreenHeight, "Atomic Bomb Core Explorer 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -133,12 +463,12 @@ int main() {
 
     float camYaw = 0.82f, camPitch = 0.24f, camDistance = 11.8f;
 
-    std::vector<Fuel> fuel;
-    std::vector<Neutron> neutrons;
+    ChainReaction chain;
     std::vector<Debris> debris;
     std::vector<FissionEvent> fissionEvents;
+    astro_render::InstancedParticleRenderer neutronRenderer;
+    neutronRenderer.Init(astro_render::InstanceShape::kSphere);
 
-    float totalFissions = 0.0f;
     float neutronSeedTimer = 0.0f;
     bool detonated = false;
     float detonationTime = 0.0f;
@@ -148,26 +478,14 @@ int main() {
         camPitch = 0.24f;
         camDistance = 11.8f;
 
-        fuel.clear();
-        neutrons.clear();
+        chain.Reset(4, 3, kWindowNeutronCapacity, EffectRng().Bits());
         debris.clear();
         fissionEvents.clear();
-        totalFissions = 0.0f;
         neutronSeedTimer = 0.0f;
         detonated = false;
         detonationTime = 0.0f;
 
-        for (int x = -4; x <= 4; ++x) {
-            for (int y = -3; y <= 3; ++y) {
-                for (int z = -4; z <= 4; ++z) {
-                    if ((x + y + z) % 2 == 0) {
-                        fuel.push_back({{0.24f * x, 0.20f * y, 0.24f * z}, true, 0.0f});
-                    }
-                }
-            }
-        }
-
-        for (int i = 0; i < 4; ++i) SpawnSeedNeutron(&neutrons);
+        for (int i = 0; i < 4; ++i) chain.SpawnSeed();
     };
 
     reset();
@@ -181,7 +499,7 @@ int main() {
             detonated = true;
             detonationTime = 0.0f;
             neutronSeedTimer = 0.0f;
-            for (int i = 0; i < 60; ++i) SpawnSeedNeutron(&neutrons);
+            for (int i = 0; i < 60; ++i) chain.SpawnSeed();
         }
 
         if (IsKeyPressed(KEY_P)) paused = !paused;
@@ -197,52 +515,23 @@ int main() {
             neutronSeedTimer += dt;
             float neutronSeedStep = detonated ? 0.045f : 0.28f;
             while (neutronSeedTimer >= neutronSeedStep) {
-                SpawnSeedNeutron(&neutrons);
+                chain.SpawnSeed();
                 neutronSeedTimer -= neutronSeedStep;
             }
 
-            for (Fuel& f : fuel) {
-                if (!f.active) {
-                    f.cooldown -= dt;
-                    if (f.cooldown <= 0.0f) {
-                        f.cooldown = 0.0f;
-                        f.active = true;
-                    }
-                }
-            }
+            chain.Step(dt, detonated);
 
-            for (Neutron& n : neutrons) {
-                n.pos = Vector3Add(n.pos, Vector3Scale(n.vel, dt));
-                n.life -= dt;
-            }
+            for (uint32_t site : chain.fissionSites()) {
+                if (fissionEvents.size() >= kMaxFissionEffects) break;
+                const Vector3 pos = chain.fuel()[site].pos;
+                float spin = 2.0f * PI * (0.073f * static_cast<float>(chain.totalFissions() % 1024) + Rand01());
+                Vector3 splitAxis = Vector3Normalize({std::cos(spin), 0.42f * std::sin(1.6f * spin), std::sin(spin)});
+                fissionEvents.push_back({pos, splitAxis, 0.56f, 0.56f});
 
-            for (Neutron& n : neutrons) {
-                if (n.life <= 0.0f) continue;
-                for (Fuel& f : fuel) {
-                    if (!f.active) continue;
-                    if (Vector3Distance(n.pos, f.pos) < 0.11f) {
-                        f.active = false;
-                        f.cooldown = detonated ? (0.09f + 0.32f * Rand01()) : (0.75f + 1.15f * Rand01());
-                        n.life = 0.0f;
-                        totalFissions += 1.0f;
-
-                        float spin = 2.0f * PI * (0.073f * totalFissions + Rand01());
-                        Vector3 splitAxis = Vector3Normalize({std::cos(spin), 0.42f * std::sin(1.6f * spin), std::sin(spin)});
-                        fissionEvents.push_back({f.pos, splitAxis, 0.56f, 0.56f});
-
-                        for (int k = 0; k < 2; ++k) {
-                            float a = 2.0f * PI * (Rand01() + 0.37f * static_cast<float>(k));
-                            Vector3 dir = Vector3Normalize({std::cos(a), 0.30f * (2.0f * Rand01() - 1.0f), std::sin(a)});
-                            neutrons.push_back({f.pos, Vector3Scale(dir, 2.8f + 1.4f * Rand01()), 1.8f + 1.0f * Rand01()});
-                        }
-
-                        for (int d = 0; d < 4; ++d) {
-                            float a = 2.0f * PI * static_cast<float>(d) / 4.0f;
-                            Vector3 dir = {std::cos(a), 0.2f * (static_cast<float>(d) - 1.5f), std::sin(a)};
-                            debris.push_back({f.pos, Vector3Scale(dir, 1.75f), 1.2f});
-                        }
-                        break;
-                    }
+                for (int d = 0; d < 4; ++d) {
+                    float a = 2.0f * PI * static_cast<float>(d) / 4.0f;
+                    Vector3 dir = {std::cos(a), 0.2f * (static_cast<float>(d) - 1.5f), std::sin(a)};
+                    debris.push_back({pos, Vector3Scale(dir, 1.75f), 1.2f});
                 }
             }
 
@@ -253,15 +542,14 @@ int main() {
             }
             for (FissionEvent& e : fissionEvents) e.life -= dt;
 
-            neutrons.erase(std::remove_if(neutrons.begin(), neutrons.end(), [](const Neutron& n) { return n.life <= 0.0f; }), neutrons.end());
             debris.erase(std::remove_if(debris.begin(), debris.end(), [](const Debris& d) { return d.life <= 0.0f; }), debris.end());
             fissionEvents.erase(std::remove_if(fissionEvents.begin(), fissionEvents.end(), [](const FissionEvent& e) { return e.life <= 0.0f; }), fissionEvents.end());
 
-            if (neutrons.size() < 2) SpawnSeedNeutron(&neutrons);
+            if (chain.pool().LiveCount() < 2) chain.SpawnSeed();
         }
 
         int activeCount = 0;
-        for (const Fuel& f : fuel) if (f.active) activeCount++;
+        for (const Fuel& f : chain.fuel()) if (f.active) activeCount++;
 
         float revealT = (kCoreRevealStartDistance - camDistance) / (kCoreRevealStartDistance - kCoreRevealEndDistance);
         float coreReveal = SmoothStep(revealT);
@@ -289,11 +577,11 @@ int main() {
         }
 
         if (drawCore) {
-            float heat = std::clamp(static_cast<float>(neutrons.size()) / 60.0f, 0.0f, 1.0f);
+            float heat = std::clamp(static_cast<float>(chain.pool().LiveCount()) / 60.0f, 0.0f, 1.0f);
             float shockR = 0.16f + 0.12f * heat + 0.04f * std::sin(4.0f * static_cast<float>(GetTime()));
             DrawSphere({0.0f, 0.0f, 0.0f}, shockR, Color{255, 150, 90, static_cast<unsigned char>(32.0f * coreReveal)});
 
-            for (const Fuel& f : fuel) {
+            for (const Fuel& f : chain.fuel()) {
                 if (f.active) {
                     DrawSphere(f.pos, 0.058f, Color{125, 220, 255, nucleusAlpha});
                 } else {
@@ -302,7 +590,13 @@ int main() {
                 }
             }
 
-            for (const Neutron& n : neutrons) DrawSphere(n.pos, 0.034f, Color{255, 240, 160, static_cast<unsigned char>(255.0f * coreReveal)});
+            const NeutronPool& pool = chain.pool();
+            const Color neutronColor = {255, 240, 160, static_cast<unsigned char>(255.0f * coreReveal)};
+            neutronRenderer.Clear();
+            for (uint32_t slot = 0; slot < pool.HighWater(); ++slot) {
+                if (pool.Alive(slot)) neutronRenderer.Add(pool.Position(slot), 0.034f, neutronColor);
+            }
+            neutronRenderer.Draw();
             for (const Debris& d : debris) {
                 DrawSphere(d.pos, 0.027f, Color{255, 120, 90, static_cast<unsigned char>(std::max(0.0f, d.life) * 145.0f * coreReveal)});
             }
@@ -332,7 +626,8 @@ int main() {
 
         DrawText("Atomic Bomb Core Explorer (Conceptual)", 20, 18, 29, Color{235, 240, 250, 255});
         DrawText("Hold left mouse: orbit | wheel: zoom | P pause | R reset", 20, 54, 19, Color{170, 184, 204, 255});
-        DrawText(Hud(activeCount, static_cast<int>(neutrons.size()), totalFissions, camDistance, paused, detonated).c_str(), 20, 82, 20, Color{255, 210, 150, 255});
+        DrawText(Hud(activeCount, chain, camDistance, paused, detonated).c_str(), 20, 82, 20, Color{255, 210, 150, 255});
+        DrawText(GenerationLine(chain, 8).c_str(), 20, 136, 18, Color{220, 190, 150, 255});
         Color buttonFill = detonated
             ? Color{118, 44, 36, 255}
             : (detonateHover ? Color{214, 86, 64, 255} : Color{176, 58, 43, 255});
@@ -345,9 +640,13 @@ int main() {
                  static_cast<int>(detonateButton.y + 10.0f), 22, Color{255, 239, 232, 255});
         DrawFPS(20, 110);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    neutronRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,17 +1,25 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/gpu_sparks.h"
+#include "../common/particle_pool.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <string>
-#include <vector>
 
 namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+constexpr int kMaxFragments = 512;
+constexpr int kSparkCapacity = 1 << 20;
+constexpr int kFissionSparks = 240000;  // per GPU burst; the CPU fragments stay as the bright core
+constexpr int kFusionSparks = 400000;
 
 struct Fragment {
     Vector3 pos;
@@ -20,12 +28,24 @@ struct Fragment {
     Color color;
 };
 
-void SpawnEnergyBurst(std::vector<Fragment>* frags, Vector3 origin, int count, float speed, float life, Color color) {
-    for (int i = 0; i < count; ++i) {
+void SpawnEnergyBurst(astro_fx::ParticlePool<Fragment>* frags, Vector3 origin, int count, float speed, float life, Color color) {
+    frags->SpawnBatch(count, [&](Fragment& f, int i) {
         float a = 2.0f * PI * static_cast<float>(i) / static_cast<float>(count);
         Vector3 dir = {std::cos(a), 0.24f * std::sin(2.4f * a), std::sin(a)};
-        frags->push_back({origin, Vector3Scale(dir, speed), life, color});
-    }
+        f = {origin, Vector3Scale(dir, speed), life, color};
+    });
+}
+
+// The same release as a dense spray of GPU sparks fanned around the fragment ring.
+void EmitSparkBurst(astro_render::GpuSparkField* sparks, Vector3 origin, int count, float speed, float life) {
+    astro_render::SparkBurst burst;
+    burst.origin = origin;
+    burst.count = count;
+    burst.speedMin = 0.35f * speed;
+    burst.speedMax = 1.15f * speed;
+    burst.lifeMin = 0.45f * life;
+    burst.lifeMax = 1.1f * life;
+    sparks->Emit(burst);
 }
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
@@ -58,7 +78,14 @@ int main() {
 
     bool fusionMode = false;
     bool paused = false;
-    std::vector<Fragment> frags;
+    astro_fx::ParticlePool<Fragment> frags(kMaxFragments);
+    astro_render::GpuSparkField sparks;
+    const bool sparksAvailable = sparks.Init(kSparkCapacity);
+    bool showSparks = sparksAvailable;
+    astro_render::SparkMotion sparkMotion;
+    sparkMotion.drag = 1.1f;
+    sparkMotion.curl = 0.55f;
+    sparkMotion.curlScale = 0.9f;
 
     float reactionTime = 0.0f;
     bool reactionActive = false;
@@ -69,7 +96,7 @@ int main() {
     float fusionSeparation = 1.8f;
 
     auto resetReaction = [&]() {
-        frags.clear();
+        frags.Clear();
         reactionTime = 0.0f;
         reactionActive = false;
         energyReleased = false;
@@ -90,6 +117,7 @@ int main() {
             resetReaction();
         }
         if (IsKeyPressed(KEY_SPACE)) trigger();
+        if (IsKeyPressed(KEY_G) && sparksAvailable) showSparks = !showSparks;
         if (IsKeyPressed(KEY_R)) {
             resetReaction();
             paused = false;
@@ -111,6 +139,7 @@ int main() {
                         splitOffset = std::min((reactionTime - impactTime) * 1.35f, 1.35f);
                         if (!energyReleased) {
                             SpawnEnergyBurst(&frags, {0.0f, 0.0f, 0.0f}, 22, 3.1f, 2.1f, Color{255, 175, 100, 255});
+                            if (showSparks) EmitSparkBurst(&sparks, {0.0f, 0.0f, 0.0f}, kFissionSparks, 3.1f, 2.1f);
                             energyReleased = true;
                         }
                     }
@@ -120,17 +149,19 @@ int main() {
                         fusionSeparation = std::max(0.0f, 1.8f - (reactionTime / mergeTime) * 1.8f);
                     } else if (!energyReleased) {
                         SpawnEnergyBurst(&frags, {0.0f, 0.0f, 0.0f}, 30, 4.0f, 2.5f, Color{255, 225, 120, 255});
+                        if (showSparks) EmitSparkBurst(&sparks, {0.0f, 0.0f, 0.0f}, kFusionSparks, 4.0f, 2.5f);
                         energyReleased = true;
                     }
                 }
             }
 
-            for (Fragment& f : frags) {
+            frags.Update([dt](Fragment& f) {
                 f.pos = Vector3Add(f.pos, Vector3Scale(f.vel, dt));
                 f.vel = Vector3Scale(f.vel, 0.985f);
                 f.life -= dt;
-            }
-            frags.erase(std::remove_if(frags.begin(), frags.end(), [](const Fragment& f) { return f.life <= 0.0f; }), frags.end());
+                return f.life > 0.0f;
+            });
+            sparks.Step(dt, sparkMotion);
         }
 
         BeginDrawing();
@@ -174,11 +205,16 @@ int main() {
             c.a = static_cast<unsigned char>(std::clamp(120.0f * f.life, 20.0f, 255.0f));
             DrawSphere(f.pos, 0.05f, c);
         }
+        if (showSparks) {
+            BeginBlendMode(BLEND_ADDITIVE);
+            sparks.Draw(0.05f, Color{255, 236, 180, 150}, Color{255, 96, 40, 90});
+            EndBlendMode();
+        }
 
         EndMode3D();
 
         DrawText("Fission vs Fusion (Reaction Mechanics)", 20, 18, 29, Color{235, 240, 250, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | M mode toggle | SPACE trigger | P pause | R reset", 20, 54, 18, Color{170, 184, 204, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | M mode toggle | SPACE trigger | G sparks | P pause | R reset", 20, 54, 18, Color{170, 184, 204, 255});
 
         std::ostringstream os;
         if (fusionMode) {
@@ -187,13 +223,24 @@ int main() {
             os << "mode=fission: neutron strikes nucleus, splits into two + energy";
         }
         os << "  particles=" << frags.size();
+        if (!sparksAvailable) {
+            os << "  sparks=n/a";
+        } else if (showSparks) {
+            os << "  gpu sparks=on (" << sparks.emitted() / 1000 << "k emitted)";
+        } else {
+            os << "  gpu sparks=off";
+        }
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{255, 210, 150, 255});
         DrawFPS(20, 110);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    sparks.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,6 +1,11 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/lagrangian_hydro.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
@@ -16,6 +21,17 @@ constexpr float kExteriorDuration = 2.9f;
 constexpr float kZoomDuration = 3.1f;
 constexpr float kPrimaryDuration = 3.0f;
 constexpr float kTransferDuration = 2.0f;
+constexpr float kBlastDuration = 5.0f;      // s of sequence for the whole hydro run
+constexpr float kBlastSceneRadius = 9.0f;   // scene units per unit of hydro radius
+constexpr int kBlastShells = 14;
+constexpr int kTracerCount = 1200;
+constexpr uint64_t kTracerSeed = 0x7ab1e5u;
+
+// A fluid parcel riding the Lagrangian mesh at a fixed mass coordinate.
+struct Tracer {
+    Vector3 dir;
+    float mass;  // enclosed-mass fraction
+};
 
 struct Plasma {
     Vector3 pos;
@@ -104,6 +120,94 @@ void DrawBombExterior(unsigned char alpha) {
     DrawCylinderWires({0.0f, -2.6f, 0.0f}, 1.26f, 1.26f, 0.18f, 44, stripe);
 }
 
+std::vector<Tracer> SeedTracers() {
+    std::vector<Tracer> tracers(kTracerCount);
+    astro_random::PhiloxStream rng(kTracerSeed);
+    for (Tracer& t : tracers) {
+        const float z = rng.Range(-1.0f, 1.0f);
+        const float a = rng.Range(0.0f, 2.0f * PI);
+        const float s = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        t.dir = {s * std::cos(a), z, s * std::sin(a)};
+        t.mass = rng.Range(0.0f, 0.7f);
+    }
+    return tracers;
+}
+
+float BlastTime(float coreT) {
+    const float t = (coreT - (kPrimaryDuration + kTransferDuration)) / kBlastDuration;
+    return std::clamp(t, 0.0f, 1.0f);
+}
+
+// Log temperature mapped to 0..1 between the ambient gas and the hottest point of the run.
+float HeatLevel(const astro_hydro::BlastTable& table, float temperature) {
+    const float lo = std::log(static_cast<float>(table.params.ambientT) * 10.0f);
+    const float hi = std::log(table.peakTemperature);
+    return std::clamp((std::log(std::max(temperature, 1.0e-12f)) - lo) / (hi - lo), 0.0f, 1.0f);
+}
+
+Color HeatColor(float level, unsigned char alpha) {
+    const Color cold = {150, 40, 20, alpha};
+    const Color warm = {255, 150, 60, alpha};
+    const Color hot = {255, 244, 210, alpha};
+    return level < 0.5f ? ColorLerp(cold, warm, level * 2.0f) : ColorLerp(warm, hot, level * 2.0f - 1.0f);
+}
+
+// Nested translucent shells, outermost first, coloured by the gas temperature at their radius.
+void DrawBlast(const astro_hydro::BlastTable& table, const astro_hydro::BlastFrame& frame, Vector3 centre) {
+    const float outer = frame.shockRadius * 1.03f;
+    for (int s = kBlastShells; s >= 1; --s) {
+        const float r = outer * static_cast<float>(s) / kBlastShells;
+        const float level = HeatLevel(table, frame.temperature[static_cast<size_t>(frame.ZoneAt(r))]);
+        DrawSphere(centre, r * kBlastSceneRadius, HeatColor(level, static_cast<unsigned char>(10.0f + 26.0f * level)));
+    }
+    DrawSphereWires(centre, frame.shockRadius * kBlastSceneRadius, 18, 24, Fade(Color{255, 214, 150, 255}, 0.32f));
+}
+
+void DrawTracers(const astro_hydro::BlastTable& table, const astro_hydro::BlastFrame& frame, const std::vector<Tracer>& tracers,
+                 Vector3 centre) {
+    for (const Tracer& t : tracers) {
+        const float r = frame.RadiusAtMass(table.cumulativeMass, t.mass);
+        if (r > frame.shockRadius * 1.02f) continue;  // still undisturbed ambient gas
+        const int zone = frame.ZoneAt(r);
+        const float level = HeatLevel(table, frame.temperature[static_cast<size_t>(zone)]);
+        const float squeeze = std::clamp(frame.density[static_cast<size_t>(zone)] / 4.0f, 0.2f, 1.0f);
+        DrawSphereEx(Vector3Add(centre, Vector3Scale(t.dir, r * kBlastSceneRadius)), 0.025f + 0.03f * squeeze, 4, 6,
+                     HeatColor(level, static_cast<unsigned char>(120 + 120 * squeeze)));
+    }
+}
+
+// Radial profiles of the current frame: density over the strong-shock limit 4, and
+// temperature and pressure over their peaks.
+void DrawProfilePlot(const astro_hydro::BlastFrame& frame, int x, int y, int w, int h) {
+    DrawRectangle(x, y, w, h, Fade(Color{16, 20, 30, 255}, 0.9f));
+    DrawRectangleLines(x, y, w, h, Fade(Color{120, 140, 180, 255}, 0.5f));
+    const int px = x + 12, py = y + 34, pw = w - 24, ph = h - 58;
+    float peakT = 1.0e-12f, peakP = 1.0e-12f;
+    for (int j = 0; j < astro_hydro::kZones; ++j) {
+        peakT = std::max(peakT, frame.temperature[static_cast<size_t>(j)]);
+        peakP = std::max(peakP, frame.pressure[static_cast<size_t>(j)]);
+    }
+    const auto curve = [&](const std::vector<float>& v, float scale, Color c) {
+        for (int j = 1; j < astro_hydro::kZones; ++j) {
+            const float r0 = 0.5f * (frame.radius[static_cast<size_t>(j - 1)] + frame.radius[static_cast<size_t>(j)]);
+            const float r1 = 0.5f * (frame.radius[static_cast<size_t>(j)] + frame.radius[static_cast<size_t>(j + 1)]);
+            const float y0 = std::min(v[static_cast<size_t>(j - 1)] * scale, 1.0f);
+            const float y1 = std::min(v[static_cast<size_t>(j)] * scale, 1.0f);
+            DrawLineV({px + r0 * pw, py + ph - y0 * ph}, {px + r1 * pw, py + ph - y1 * ph}, c);
+        }
+    };
+    curve(frame.density, 0.25f, Color{120, 190, 255, 255});
+    curve(frame.temperature, 1.0f / peakT, Color{255, 170, 90, 255});
+    curve(frame.pressure, 1.0f / peakP, Color{200, 255, 170, 255});
+    const int fx = px + static_cast<int>(frame.fireballRadius * pw);
+    DrawLine(fx, py, fx, py + ph, Fade(Color{255, 120, 80, 255}, 0.5f));
+    DrawText("Lagrangian hydro profile vs r", x + 12, y + 8, 18, Color{225, 232, 245, 255});
+    DrawText("rho/4", x + 12, y + h - 20, 16, Color{120, 190, 255, 255});
+    DrawText("T/Tmax", x + 72, y + h - 20, 16, Color{255, 170, 90, 255});
+    DrawText("p/pmax", x + 144, y + h - 20, 16, Color{200, 255, 170, 255});
+    DrawText("| fireball", x + 216, y + h - 20, 16, Color{255, 120, 80, 255});
+}
+
 const char* PhaseText(SequencePhase phase) {
     switch (phase) {
         case SequencePhase::Exterior: return "intact shell";
@@ -130,6 +234,16 @@ int main() {
 
     float camYaw = 0.82f, camPitch = 0.28f, camDistance = 4.8f;
 
+    // The blast is one textbook point explosion in dimensionless units, run once per
+    // transport setting and replayed from its table; D switches radiation diffusion.
+    astro_hydro::BlastParams blastParams;
+    const astro_hydro::BlastTable diffusiveBlast = astro_hydro::BlastTable::Build(blastParams);
+    blastParams.diffusion = 0.0;
+    const astro_hydro::BlastTable adiabaticBlast = astro_hydro::BlastTable::Build(blastParams);
+    bool diffusionOn = true;
+    astro_hydro::BlastFrame blastFrame;
+    const std::vector<Tracer> tracers = SeedTracers();
+
     std::vector<Plasma> plasma;
     bool paused = false;
     float sequenceTime = 0.0f;
@@ -149,6 +263,8 @@ int main() {
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) { reset(); paused = false; }
+        if (IsKeyPressed(KEY_D)) diffusionOn = !diffusionOn;
+        const astro_hydro::BlastTable& blast = diffusionOn ? diffusiveBlast : adiabaticBlast;
         SequencePhase phase = GetPhase(sequenceTime);
 
         if (!paused) {
@@ -176,14 +292,6 @@ int main() {
                 }
             }
 
-            if (phase == SequencePhase::SecondaryFusion) {
-                for (int i = 0; i < 12; ++i) {
-                    float a = 2.0f * PI * (0.11f * static_cast<float>(i) + coreT * 0.68f);
-                    Vector3 dir = {std::cos(a), 0.28f * std::sin(3.1f * a), std::sin(a)};
-                    plasma.push_back({secondary, Vector3Scale(dir, 4.8f), 2.4f, 0.043f, Color{255, 232, 130, 255}});
-                }
-            }
-
             for (Plasma& p : plasma) {
                 p.pos = Vector3Add(p.pos, Vector3Scale(p.vel, dt));
                 p.vel = Vector3Scale(p.vel, 0.985f);
@@ -248,15 +356,18 @@ int main() {
             DrawSphere(p.pos, p.radius + 0.008f * p.life, c);
         }
 
-        float blast = (phase == SequencePhase::SecondaryFusion) ? std::min(9.0f, (coreT - (kPrimaryDuration + kTransferDuration)) * 2.2f) : 0.0f;
-        if (blast > 0.05f) {
-            DrawSphere(secondary, blast, Color{255, 176, 105, 22});
+        const bool blasting = phase == SequencePhase::SecondaryFusion;
+        if (blasting) {
+            blast.Sample(BlastTime(coreT) * blast.endTime(), &blastFrame);
+            DrawTracers(blast, blastFrame, tracers, secondary);
+            DrawBlast(blast, blastFrame, secondary);
         }
 
         EndMode3D();
 
         DrawText("Hydrogen Bomb Two-Stage Core Sequence (Conceptual)", 20, 18, 29, Color{235, 240, 250, 255});
-        DrawText("Auto fly-in to casing/core | in core: hold left mouse orbit, wheel zoom | P pause | R reset", 20, 54, 19, Color{170, 184, 204, 255});
+        DrawText("Auto fly-in to casing/core | in core: hold left mouse orbit, wheel zoom | D radiation diffusion | P pause | R reset", 20,
+                 54, 19, Color{170, 184, 204, 255});
 
         std::ostringstream os;
         os << std::fixed << std::setprecision(2) << "t=" << sequenceTime
@@ -264,11 +375,28 @@ int main() {
            << "  plasma=" << plasma.size();
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{255, 210, 150, 255});
-        DrawFPS(20, 110);
+        os.str("");
+        os << std::setprecision(3) << "blast model: 1D Lagrangian hydro, " << astro_hydro::kZones << " zones, "
+           << (diffusionOn ? "implicit radiation diffusion" : "adiabatic (Sedov-Taylor)") << ", " << blast.steps
+           << " steps, energy drift " << std::scientific << std::setprecision(1) << blast.energyError;
+        DrawText(os.str().c_str(), 20, 108, 18, Color{170, 184, 204, 255});
+        if (blasting) {
+            const float ke = blastFrame.kinetic / std::max(1.0e-12f, blastFrame.kinetic + blastFrame.internal);
+            os.str("");
+            os << std::fixed << std::setprecision(3) << "t*=" << blastFrame.time << "  shock R=" << blastFrame.shockRadius
+               << " (Sedov " << blast.SedovRadius(blastFrame.time) << ")  fireball R=" << blastFrame.fireballRadius
+               << "  kinetic share=" << ke;
+            DrawText(os.str().c_str(), 20, 132, 18, Color{255, 196, 140, 255});
+            DrawProfilePlot(blastFrame, kScreenWidth - 440, kScreenHeight - 270, 420, 250);
+        }
+        DrawFPS(20, 158);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,8 +1,15 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
+#include "../common/reactor_kinetics.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdio>
 #include <iomanip>
 #include <random>
 #include <sstream>
@@ -17,6 +24,20 @@ constexpr int kCoolantParticleCount = 180;
 constexpr int kSteamParticleCount = 160;
 constexpr int kBackgroundParticleCount = 180;
 
+// Plant time runs at speed x wall time in whole control steps; a frame that would need
+// more than kMaxStepsPerFrame drops the backlog instead of stalling.
+constexpr double kPlantStep = astro_reactor::PlantSimulator::kControlStep;
+constexpr int kMaxStepsPerFrame = 3000;
+constexpr std::array<double, 5> kSpeeds = {1.0, 10.0, 100.0, 1000.0, 10000.0};
+constexpr int kDefaultSpeed = 1;
+constexpr double kBenchSpeed = 1000.0;
+
+// Coolant colour ramp and the strip chart.
+constexpr double kColdColorTemp = 285.0;
+constexpr double kHotColorTemp = 330.0;
+constexpr int kHistorySamples = 360;
+constexpr double kHistoryWallSeconds = 0.25;
+
 struct OrbitCameraState {
     float yaw = 0.78f;
     float pitch = 0.34f;
@@ -93,6 +114,7 @@ Vector3 Bezier(Vector3 a, Vector3 b, Vector3 c, Vector3 d, float t) {
         Vector3Add(Vector3Scale(c, 3.0f * u * t * t), Vector3Scale(d, t * t * t)));
 }
 
+// The loop in four quarters: hot leg, steam generator, cold leg, core.
 Vector3 CoolantPath(float t, float lane) {
     t = std::fmod(t, 1.0f);
     if (t < 0.0f) t += 1.0f;
@@ -180,6 +202,22 @@ void DrawCoolingTower(Vector3 base, float time, const std::vector<SteamParticle>
     }
 }
 
+// Coolant temperature at loop position t, interpolated from inlet to outlet of the node
+// the particle is in.
+double CoolantTemp(const astro_reactor::PlantState& y, float t) {
+    using namespace astro_reactor;
+    const std::array<double, 5> nodes = {y[kCoreTemp], y[kHotLegTemp], y[kSteamGenTemp], y[kColdLegTemp], y[kCoreTemp]};
+    const float u = std::clamp(t, 0.0f, 0.9999f) * 4.0f;
+    const int segment = static_cast<int>(u);
+    return nodes[static_cast<size_t>(segment)] + (nodes[static_cast<size_t>(segment) + 1] - nodes[static_cast<size_t>(segment)]) * (u - segment);
+}
+
+Color CoolantColor(double temp) {
+    const float u = static_cast<float>((temp - kColdColorTemp) / (kHotColorTemp - kColdColorTemp));
+    if (u < 0.5f) return LerpColor(Color{74, 181, 255, 235}, Color{235, 235, 210, 235}, 2.0f * u);
+    return LerpColor(Color{235, 235, 210, 235}, Color{255, 91, 50, 240}, 2.0f * u - 1.0f);
+}
+
 void DrawContainmentBuilding(float corePower, float rodDepth, bool cutaway) {
     DrawCylinder({0.0f, 1.1f, 0.0f}, 2.45f, 2.45f, 2.2f, 56, Color{178, 184, 192, 240});
     DrawSphere({0.0f, 2.23f, 0.0f}, 2.45f, Color{196, 202, 210, static_cast<unsigned char>(cutaway ? 80 : 220)});
@@ -192,8 +230,10 @@ void DrawContainmentBuilding(float corePower, float rodDepth, bool cutaway) {
     DrawCylinderWires({0.0f, 1.2f, 0.0f}, 0.74f, 0.74f, 1.92f, 36, Color{165, 191, 220, 170});
 
     const float glow = 0.58f + 0.18f * std::sin(GetTime() * 8.0f);
-    DrawSphere({0.0f, 1.28f, 0.0f}, 0.44f + 0.05f * corePower * glow, Color{255, 146, 70, 225});
-    DrawSphere({0.0f, 1.28f, 0.0f}, 0.78f + 0.16f * corePower * glow, Color{255, 205, 80, 70});
+    const float power = std::clamp(corePower, 0.0f, 1.5f);
+    DrawSphere({0.0f, 1.28f, 0.0f}, 0.12f + 0.32f * std::sqrt(power) + 0.05f * power * glow, Color{255, 146, 70, 225});
+    DrawSphere({0.0f, 1.28f, 0.0f}, 0.2f + 0.58f * std::sqrt(power) + 0.16f * power * glow,
+               Color{255, 205, 80, static_cast<unsigned char>(20 + 50 * std::min(1.0f, power))});
 
     for (int i = -3; i <= 3; ++i) {
         const float x = i * 0.18f;
@@ -203,7 +243,7 @@ void DrawContainmentBuilding(float corePower, float rodDepth, bool cutaway) {
     }
 }
 
-void DrawTurbineHall(float turbineSpin, float demand) {
+void DrawTurbineHall(float turbineSpin, float steamFlow, float time) {
     DrawCube({5.15f, 0.65f, 0.0f}, 4.8f, 1.3f, 3.2f, Color{84, 103, 126, 255});
     DrawCubeWires({5.15f, 0.65f, 0.0f}, 4.8f, 1.3f, 3.2f, Color{181, 200, 216, 100});
     DrawCube({5.15f, 1.38f, 0.0f}, 4.95f, 0.18f, 3.35f, Color{118, 136, 154, 255});
@@ -225,7 +265,7 @@ void DrawTurbineHall(float turbineSpin, float demand) {
     DrawCylinderWires({8.2f, 1.45f, 0.0f}, 0.64f, 0.64f, 0.22f, 36, Color{255, 233, 128, 180});
     for (int i = 0; i < 5; ++i) {
         const float y = 2.35f + i * 0.35f;
-        const float pulse = std::fmod(static_cast<float>(GetTime()) * (0.95f + demand * 1.8f) + i * 0.18f, 1.0f);
+        const float pulse = std::fmod(time * (0.95f + steamFlow * 1.8f) + i * 0.18f, 1.0f);
         DrawLine3D({8.35f + pulse * 3.6f, y, -0.92f}, {8.95f + pulse * 3.6f, y, -0.92f}, Color{255, 218, 84, 210});
     }
 }
@@ -237,40 +277,134 @@ void DrawPlantBase() {
     DrawCube({6.4f, 0.03f, 2.65f}, 6.4f, 0.12f, 0.18f, Color{70, 82, 92, 255});
 }
 
-void DrawStatusBars(float corePower, float waterLevel, float demand, float rodDepth) {
+void DrawStatusBars(const astro_reactor::PlantSimulator& plant) {
+    using namespace astro_reactor;
+    const PlantState& y = plant.state();
     const int x = 24;
-    const int y = 752;
+    const int y0 = 752;
     const int w = 258;
     const int h = 16;
     const Color bg = {32, 41, 54, 240};
 
-    auto bar = [&](int row, const char* label, float v, Color fill) {
-        DrawText(label, x, y + row * 32 - 2, 18, Color{205, 216, 230, 255});
-        DrawRectangle(x + 128, y + row * 32, w, h, bg);
-        DrawRectangle(x + 128, y + row * 32, static_cast<int>(w * std::clamp(v, 0.0f, 1.0f)), h, fill);
-        DrawRectangleLines(x + 128, y + row * 32, w, h, Color{125, 145, 168, 180});
+    auto bar = [&](int row, const char* label, double v, Color fill) {
+        DrawText(label, x, y0 + row * 32 - 2, 18, Color{205, 216, 230, 255});
+        DrawRectangle(x + 128, y0 + row * 32, w, h, bg);
+        DrawRectangle(x + 128, y0 + row * 32, static_cast<int>(w * std::clamp(v, 0.0, 1.0)), h, fill);
+        DrawRectangleLines(x + 128, y0 + row * 32, w, h, Color{125, 145, 168, 180});
+    };
+
+    bar(0, "thermal power", plant.model().ThermalPower(y), Color{255, 145, 74, 255});
+    bar(1, "primary flow", y[kFlow], Color{79, 178, 255, 255});
+    bar(2, "turbine valve", plant.inputs().turbineValve, Color{255, 212, 74, 255});
+    bar(3, "rod depth", plant.inputs().rodDepth, Color{127, 150, 180, 255});
+}
+
+struct HistorySample {
+    double time = 0.0;
+    float power = 0.0f;
+    float tavg = 0.0f;
+    float xenon = 0.0f;
+};
+
+struct History {
+    std::array<HistorySample, kHistorySamples> samples{};
+    int count = 0;
+    int head = 0;
+    double nextTime = 0.0;
+
+    void Clear() {
+        count = head = 0;
+        nextTime = 0.0;
+    }
+    void Record(const astro_reactor::PlantSimulator& plant, double interval) {
+        if (plant.time() < nextTime) return;
+        nextTime = plant.time() + interval;
+        HistorySample& s = samples[static_cast<size_t>(head)];
+        s.time = plant.time();
+        s.power = static_cast<float>(plant.model().ThermalPower(plant.state()));
+        s.tavg = static_cast<float>(plant.AverageCoolantTemp());
+        s.xenon = static_cast<float>(plant.state()[astro_reactor::kXenon]);
+        head = (head + 1) % kHistorySamples;
+        count = std::min(count + 1, kHistorySamples);
+    }
+    const HistorySample& At(int i) const { return samples[static_cast<size_t>((head - count + i + kHistorySamples) % kHistorySamples)]; }
+};
+
+// Thermal power (0..120%), Tavg (270..340 C) and xenon (0..2x equilibrium) over the
+// recorded window.
+void DrawHistory(const History& history, int x, int y, int w, int h) {
+    DrawRectangle(x, y, w, h, Color{14, 20, 30, 215});
+    DrawRectangleLines(x, y, w, h, Color{125, 145, 168, 160});
+    if (history.count < 2) return;
+    auto plot = [&](auto value, float lo, float hi, Color color) {
+        for (int i = 1; i < history.count; ++i) {
+            const float a = std::clamp((value(history.At(i - 1)) - lo) / (hi - lo), 0.0f, 1.0f);
+            const float b = std::clamp((value(history.At(i)) - lo) / (hi - lo), 0.0f, 1.0f);
+            DrawLine(x + (i - 1) * w / (kHistorySamples - 1), y + h - static_cast<int>(a * h), x + i * w / (kHistorySamples - 1),
+                     y + h - static_cast<int>(b * h), color);
+        }
     };
+    plot([](const HistorySample& s) { return s.power; }, 0.0f, 1.2f, Color{255, 145, 74, 255});
+    plot([](const HistorySample& s) { return s.tavg; }, 270.0f, 340.0f, Color{235, 235, 210, 255});
+    plot([](const HistorySample& s) { return s.xenon; }, 0.0f, 2.0f, Color{176, 120, 255, 255});
+    const double span = history.At(history.count - 1).time - history.At(0).time;
+    char label[96];
+    std::snprintf(label, sizeof(label), "power  Tavg  xenon   last %.0f %s", span >= 600.0 ? span / 60.0 : span, span >= 600.0 ? "min" : "s");
+    DrawText(label, x + 8, y + 6, 16, Color{205, 216, 230, 255});
+}
 
-    bar(0, "core power", corePower, Color{255, 145, 74, 255});
-    bar(1, "water level", waterLevel, Color{79, 178, 255, 255});
-    bar(2, "grid demand", demand, Color{255, 212, 74, 255});
-    bar(3, "rod depth", rodDepth, Color{127, 150, 180, 255});
+std::string FormatPlantTime(double seconds) {
+    char text[48];
+    const long total = static_cast<long>(seconds);
+    std::snprintf(text, sizeof(text), "%ld:%02ld:%02ld", total / 3600, total / 60 % 60, total % 60);
+    return text;
 }
 
-std::string Hud(float corePower, float demand, float rodDepth, float waterLevel, bool paused, bool cutaway) {
+std::string Hud(const astro_reactor::PlantSimulator& plant, double speed, bool paused, bool cutaway) {
+    using namespace astro_reactor;
+    const PlantState& y = plant.state();
     std::ostringstream os;
-    os << "thermal output=" << std::fixed << std::setprecision(0) << corePower * 100.0f << "%"
-       << "  demand=" << demand * 100.0f << "%"
-       << "  control rods inserted=" << rodDepth * 100.0f << "%"
-       << "  secondary water=" << waterLevel * 100.0f << "%";
+    os << std::fixed << std::setprecision(1) << "t=" << FormatPlantTime(plant.time()) << " (" << std::setprecision(0) << speed << "x)"
+       << "  thermal=" << std::setprecision(1) << plant.model().ThermalPower(y) * 100.0 << "%"
+       << "  fission=" << y[kPower] * 100.0 << "%"
+       << "  rho=" << std::setprecision(0) << plant.model().Reactivity(y, plant.inputs()) * 1.0e5 << " pcm"
+       << "  fuel=" << y[kFuelTemp] << "C"
+       << "  Thot/Tcold=" << std::setprecision(1) << y[kHotLegTemp] << "/" << y[kColdLegTemp] << "C"
+       << "  Tavg=" << plant.AverageCoolantTemp() << " (ref " << plant.ProgramTemp() << ")"
+       << "  flow=" << std::setprecision(0) << y[kFlow] * 100.0 << "%"
+       << "  xenon=" << plant.model().XenonReactivity(y) * 1.0e5 << " pcm";
+    os << (plant.automatic() ? "  [AUTO RODS]" : "  [MANUAL RODS]");
+    if (plant.scrammed()) os << "  [SCRAM]";
+    if (!plant.inputs().pumps) os << "  [PUMPS TRIPPED]";
     if (cutaway) os << "  [CUTAWAY]";
     if (paused) os << "  [PAUSED]";
     return os.str();
 }
 
+// --headless: a 30% load reduction under automatic rod control at kBenchSpeed, i.e.
+// each step advances dt * kBenchSpeed of plant time.
+int RunPlantBench(const astro_bench::BenchOptions& bench) {
+    astro_reactor::PlantSimulator plant;
+    plant.SetTurbineValve(0.7);
+    return astro_bench::RunBench(
+        "nuclear_power_plant_viz", bench,
+        [&](float dt) { plant.Advance(std::floor(dt * kBenchSpeed / kPlantStep) * kPlantStep); },
+        [&]() {
+            const astro_reactor::PlantState& y = plant.state();
+            std::fprintf(stderr, "%s of plant time: thermal %.1f%%, Tavg %.2f C (ref %.2f), rods %.3f, xenon %.0f pcm; %ld solver steps, %ld rejected\n",
+                         FormatPlantTime(plant.time()).c_str(), 100.0 * plant.model().ThermalPower(y), plant.AverageCoolantTemp(),
+                         plant.ProgramTemp(), plant.inputs().rodDepth, 1.0e5 * plant.model().XenonReactivity(y), plant.solverSteps(),
+                         plant.solverRejects());
+            return plant.model().ThermalPower(y) + y[astro_reactor::kXenon];
+        });
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    if (bench.enabled) return RunPlantBench(bench);
+
     InitWindow(kScreenWidth, kScreenHeight, "Nuclear Power Plant 3D Simulation - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -284,51 +418,81 @@ int main() {
     std::vector<SteamParticle> steam = MakeSteamParticles();
     std::vector<BackgroundParticle> background = MakeBackgroundParticles();
 
+    astro_reactor::PlantSimulator plant;
+    History history;
+    double accumulator = 0.0;
+    int speedIndex = kDefaultSpeed;
     float time = 0.0f;
-    float corePower = 0.72f;
-    float targetDemand = 0.68f;
-    float rodDepth = 0.32f;
-    float waterLevel = 0.82f;
     float turbineSpin = 0.0f;
     bool paused = false;
     bool cutaway = true;
 
     while (!WindowShouldClose()) {
+        const float dt = GetFrameTime();
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_C)) cutaway = !cutaway;
         if (IsKeyPressed(KEY_R)) {
-            corePower = 0.72f;
-            targetDemand = 0.68f;
-            rodDepth = 0.32f;
-            waterLevel = 0.82f;
+            plant.Reset();
+            history.Clear();
+            accumulator = 0.0;
             turbineSpin = 0.0f;
         }
-
-        if (IsKeyDown(KEY_UP)) rodDepth -= 0.45f * GetFrameTime();
-        if (IsKeyDown(KEY_DOWN)) rodDepth += 0.45f * GetFrameTime();
-        if (IsKeyDown(KEY_RIGHT)) targetDemand += 0.38f * GetFrameTime();
-        if (IsKeyDown(KEY_LEFT)) targetDemand -= 0.38f * GetFrameTime();
-        rodDepth = std::clamp(rodDepth, 0.02f, 0.94f);
-        targetDemand = std::clamp(targetDemand, 0.18f, 1.0f);
+        if (IsKeyPressed(KEY_COMMA)) speedIndex = std::max(0, speedIndex - 1);
+        if (IsKeyPressed(KEY_PERIOD)) speedIndex = std::min(static_cast<int>(kSpeeds.size()) - 1, speedIndex + 1);
+        if (IsKeyPressed(KEY_S)) {
+            if (plant.scrammed()) {
+                plant.ResetScram();
+            } else {
+                plant.Scram();
+            }
+        }
+        if (IsKeyPressed(KEY_T)) plant.SetPumps(!plant.inputs().pumps);
+        if (IsKeyPressed(KEY_A)) plant.SetAutomatic(!plant.automatic());
+
+        // Rods are driven at their rated speed while a key is held; touching them takes
+        // the bank out of automatic.
+        if (IsKeyDown(KEY_UP) || IsKeyDown(KEY_DOWN)) {
+            plant.SetAutomatic(false);
+            plant.SetRodTarget(IsKeyDown(KEY_UP) ? 0.0 : 1.0);
+        } else if (!plant.automatic()) {
+            plant.SetRodTarget(plant.inputs().rodDepth);
+        }
+        if (IsKeyDown(KEY_RIGHT)) plant.SetTurbineValve(plant.inputs().turbineValve + 0.25 * dt);
+        if (IsKeyDown(KEY_LEFT)) plant.SetTurbineValve(plant.inputs().turbineValve - 0.25 * dt);
 
         UpdateOrbitCameraDragOnly(&camera, &orbit);
 
+        const double speed = kSpeeds[static_cast<size_t>(speedIndex)];
         if (!paused) {
-            const float dt = GetFrameTime();
+            {
+                ASTRO_PROFILE_SCOPE("plant");
+                accumulator += dt * speed;
+                int steps = static_cast<int>(accumulator / kPlantStep);
+                if (steps > kMaxStepsPerFrame) {
+                    steps = kMaxStepsPerFrame;
+                    accumulator = 0.0;
+                } else {
+                    accumulator -= steps * kPlantStep;
+                }
+                if (steps > 0) plant.Advance(steps * kPlantStep);
+                history.Record(plant, kHistoryWallSeconds * speed);
+            }
+
+            // Particles move in wall time: the loop would be a blur at plant speed.
+            const astro_reactor::PlantState& y = plant.state();
+            const float flow = static_cast<float>(y[astro_reactor::kFlow]);
+            const float steamFlow = static_cast<float>(plant.model().TurbineHeat(y, plant.inputs()) / plant.model().parameters().nominalPower);
+            const float condenserHeat = steamFlow + static_cast<float>(plant.model().SteamDumpHeat(y) / plant.model().parameters().nominalPower);
             time += dt;
-            const float targetPower = std::clamp(1.08f - rodDepth * 0.95f + targetDemand * 0.22f, 0.06f, 1.0f);
-            corePower += (targetPower - corePower) * (1.0f - std::pow(0.05f, dt));
-            waterLevel += ((0.92f - targetDemand * 0.22f + rodDepth * 0.05f) - waterLevel) * (1.0f - std::pow(0.25f, dt));
-            waterLevel = std::clamp(waterLevel, 0.35f, 1.0f);
-            turbineSpin += dt * (4.0f + 22.0f * corePower * targetDemand);
+            turbineSpin += dt * 26.0f * steamFlow;
 
             for (FlowParticle& p : coolant) {
-                p.t = std::fmod(p.t + dt * p.speed * (0.55f + corePower), 1.0f);
+                p.t = std::fmod(p.t + dt * p.speed * 1.5f * flow, 1.0f);
                 p.pos = CoolantPath(p.t, p.lane);
             }
 
             for (SteamParticle& p : steam) {
-                p.age += dt * (0.7f + corePower * 0.55f);
+                p.age += dt * (0.15f + condenserHeat * 1.1f);
                 if (p.age > p.life) {
                     p.age = 0.0f;
                     p.life = 3.8f + 2.2f * static_cast<float>(GetRandomValue(0, 1000)) / 1000.0f;
@@ -337,6 +501,10 @@ int main() {
             }
         }
 
+        const astro_reactor::PlantState& y = plant.state();
+        const float thermalPower = static_cast<float>(plant.model().ThermalPower(y));
+        const float steamFlow = static_cast<float>(plant.model().TurbineHeat(y, plant.inputs()) / plant.model().parameters().nominalPower);
+
         BeginDrawing();
         ClearBackground(Color{8, 12, 18, 255});
 
@@ -347,10 +515,10 @@ int main() {
             DrawSphere(p.pos, p.size, Color{155, 190, 225, static_cast<unsigned char>(255.0f * p.alpha)});
         }
 
-        DrawContainmentBuilding(corePower, rodDepth, cutaway);
+        DrawContainmentBuilding(thermalPower, static_cast<float>(plant.inputs().rodDepth), cutaway);
         DrawCoolingTower({-6.6f, 0.0f, 2.95f}, time, steam, 0);
         DrawCoolingTower({-9.2f, 0.0f, 2.25f}, time + 1.3f, steam, 1);
-        DrawTurbineHall(turbineSpin, targetDemand);
+        DrawTurbineHall(turbineSpin, steamFlow, time);
 
         DrawPipe({-1.9f, 2.72f, 0.18f}, {-5.5f, 2.72f, 0.18f}, 0.13f, Color{206, 222, 236, 255});
         DrawPipe({-5.7f, 0.42f, -0.18f}, {-1.8f, 0.42f, -0.18f}, 0.13f, Color{115, 165, 220, 255});
@@ -361,33 +529,32 @@ int main() {
         DrawCylinderWires({-5.85f, 1.45f, 0.0f}, 0.89f, 0.89f, 2.74f, 36, Color{195, 215, 230, 145});
         DrawSphere({-5.85f, 2.9f, 0.0f}, 0.74f, Color{225, 235, 240, 90});
 
-        for (const FlowParticle& p : coolant) {
-            const bool hot = p.t < 0.48f;
-            Color c = hot ? LerpColor(Color{255, 91, 50, 240}, Color{255, 210, 88, 240}, corePower)
-                          : Color{74, 181, 255, 235};
-            DrawSphere(p.pos, p.size, c);
-        }
+        for (const FlowParticle& p : coolant) DrawSphere(p.pos, p.size, CoolantColor(CoolantTemp(y, p.t)));
 
         for (int i = 0; i < 7; ++i) {
-            const float pulse = std::fmod(time * (0.55f + targetDemand) + i * 0.16f, 1.0f);
+            const float pulse = std::fmod(time * (0.55f + steamFlow) + i * 0.16f, 1.0f);
             DrawLine3D({8.2f + pulse * 4.5f, 3.95f, 1.05f}, {8.75f + pulse * 4.5f, 3.95f, 1.05f},
-                       Color{255, 222, 92, static_cast<unsigned char>(120 + 90 * pulse)});
+                       Color{255, 222, 92, static_cast<unsigned char>((120 + 90 * pulse) * std::min(1.0f, steamFlow))});
         }
 
         EndMode3D();
 
         DrawRectangle(0, 0, kScreenWidth, 122, Color{7, 10, 16, 190});
         DrawText("Nuclear Power Plant 3D Simulation", 24, 18, 30, Color{238, 244, 250, 255});
-        DrawText("Left mouse: orbit | wheel: zoom | UP/DOWN rods | LEFT/RIGHT grid demand | C cutaway | P pause | R reset",
+        DrawText("Mouse: orbit/zoom | UP/DOWN rods | LEFT/RIGHT turbine load | A auto rods | S scram/reset | T pumps | ,/. speed | C cutaway | P pause | R reset",
                  24, 56, 18, Color{176, 190, 210, 255});
-        DrawText(Hud(corePower, targetDemand, rodDepth, waterLevel, paused, cutaway).c_str(), 24, 84, 19, Color{255, 215, 142, 255});
+        DrawText(Hud(plant, speed, paused, cutaway).c_str(), 24, 84, 17, Color{255, 215, 142, 255});
 
-        DrawStatusBars(corePower, waterLevel, targetDemand, rodDepth);
+        DrawStatusBars(plant);
+        DrawHistory(history, kScreenWidth - 444, kScreenHeight - 184, 420, 160);
         DrawFPS(kScreenWidth - 98, 18);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
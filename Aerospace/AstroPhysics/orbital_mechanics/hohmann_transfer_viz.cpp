@@ -1,11 +1,17 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../common/transfer_optimizer.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -13,6 +19,14 @@ constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kMu = 1.0f;
 constexpr float kPi = 3.14159265358979323846f;
+constexpr float kMaxPathExtent = 340.0f;  // pixels from the centre to a transfer's farthest point
+const std::array<Color, astro_transfer::kFamilyCount> kFamilyColors = {{
+    Color{245, 246, 255, 255},  // Hohmann
+    Color{196, 140, 255, 255},  // bi-elliptic
+    Color{255, 188, 84, 255},   // two-impulse
+    Color{120, 235, 150, 255},  // three-impulse
+    Color{110, 205, 255, 255},  // low-thrust
+}};
 
 Vector2 ScreenCenter() {
     return {kScreenWidth * 0.5f - 80.0f, kScreenHeight * 0.54f};
@@ -74,6 +88,118 @@ void DrawPanel(float r1, float r2, float progress, bool paused) {
     DrawText(("transfer: " + Fixed(progress * 100.0f, 0) + "%").c_str(), 70, 70, 20, RAYWHITE);
 }
 
+Color FamilyColor(astro_transfer::Family f) { return kFamilyColors[static_cast<size_t>(f)]; }
+
+Vector2 ScreenPointOf(double x, double y, float scale) {
+    Vector2 center = ScreenCenter();
+    return {center.x + static_cast<float>(x) * scale, center.y + static_cast<float>(y) * scale};
+}
+
+// Which points [ ] walks through: the combined front, or one family's own front.
+const std::vector<astro_transfer::Transfer>& PickList(const astro_transfer::Front& front, int source) {
+    if (source == 0) return front.combined;
+    return front.families[static_cast<size_t>(source)];
+}
+
+bool SameTransfer(const astro_transfer::Transfer& a, const astro_transfer::Transfer& b) {
+    return a.family == b.family && a.genes == b.genes && a.dv == b.dv;
+}
+
+float PathScale(const astro_transfer::TransferPath& path, float r2) {
+    double extent = r2;
+    for (const astro_transfer::PathPoint& p : path.points) extent = std::max(extent, std::hypot(p.x, p.y));
+    return std::min(88.0f, kMaxPathExtent / static_cast<float>(extent));
+}
+
+Vector2 CraftOnPath(const astro_transfer::TransferPath& path, double t, float scale) {
+    const std::vector<astro_transfer::PathPoint>& pts = path.points;
+    if (pts.size() < 2) return ScreenPointOf(pts.empty() ? 0.0 : pts.front().x, pts.empty() ? 0.0 : pts.front().y, scale);
+    const auto it = std::lower_bound(pts.begin(), pts.end(), t, [](const astro_transfer::PathPoint& p, double v) { return p.t < v; });
+    if (it == pts.begin()) return ScreenPointOf(pts.front().x, pts.front().y, scale);
+    if (it == pts.end()) return ScreenPointOf(pts.back().x, pts.back().y, scale);
+    const astro_transfer::PathPoint& a = *(it - 1);
+    const astro_transfer::PathPoint& b = *it;
+    const double f = b.t > a.t ? (t - a.t) / (b.t - a.t) : 0.0;
+    return ScreenPointOf(a.x + f * (b.x - a.x), a.y + f * (b.y - a.y), scale);
+}
+
+void DrawTransferPath(const astro_transfer::TransferPath& path, astro_transfer::Family family, float scale) {
+    const Color color = FamilyColor(family);
+    for (size_t i = 1; i < path.points.size(); ++i) {
+        const astro_transfer::PathPoint& a = path.points[i - 1];
+        const astro_transfer::PathPoint& b = path.points[i];
+        DrawLineV(ScreenPointOf(a.x, a.y, scale), ScreenPointOf(b.x, b.y, scale), color);
+    }
+    for (size_t i = 0; i < path.burns.size(); ++i) {
+        const astro_transfer::Burn& burn = path.burns[i];
+        const Vector2 p = ScreenPointOf(burn.x, burn.y, scale);
+        DrawCircleV(p, 6.0f, Color{255, 105, 97, 255});
+        DrawText(("dv " + Fixed(static_cast<float>(burn.dv))).c_str(), static_cast<int>(p.x + 10), static_cast<int>(p.y - 8), 15, Color{255, 190, 180, 255});
+    }
+}
+
+// Delta-v against log time of flight for every family's front, with the pick ringed.
+void DrawOptimizerPanel(const astro_transfer::Front* front, int source, const astro_transfer::Transfer& picked, bool busy, bool paused) {
+    DrawRectangle(935, 55, 320, 560, Color{15, 23, 36, 232});
+    DrawRectangleLines(935, 55, 320, 560, Color{90, 122, 150, 255});
+    DrawText("TRANSFER OPTIMIZER", 952, 72, 22, Color{235, 244, 255, 255});
+    if (front == nullptr) {
+        DrawText("searching...", 952, 110, 18, Color{170, 215, 255, 255});
+        return;
+    }
+
+    const astro_transfer::Transfer hohmann = astro_transfer::Hohmann(front->problem);
+    double tMin = hohmann.tof, tMax = hohmann.tof, dvMin = hohmann.dv, dvMax = hohmann.dv;
+    for (const std::vector<astro_transfer::Transfer>& family : front->families) {
+        for (const astro_transfer::Transfer& t : family) {
+            tMin = std::min(tMin, t.tof);
+            tMax = std::max(tMax, t.tof);
+            dvMin = std::min(dvMin, t.dv);
+            dvMax = std::max(dvMax, t.dv);
+        }
+    }
+    dvMax = std::min(dvMax, 6.0 * hohmann.dv);
+    const Rectangle plot = {975.0f, 112.0f, 262.0f, 220.0f};
+    DrawRectangleLinesEx(plot, 1.0f, Color{60, 80, 110, 255});
+    const auto toScreen = [&](const astro_transfer::Transfer& t) {
+        const float u = static_cast<float>(std::log(t.tof / tMin) / std::max(1e-9, std::log(tMax / tMin)));
+        const float v = static_cast<float>((std::min(t.dv, dvMax) - dvMin) / std::max(1e-9, dvMax - dvMin));
+        return Vector2{plot.x + u * plot.width, plot.y + (1.0f - v) * plot.height};
+    };
+    for (int f = 0; f < astro_transfer::kFamilyCount; ++f) {
+        const std::vector<astro_transfer::Transfer>& family = front->families[static_cast<size_t>(f)];
+        const Color color = kFamilyColors[static_cast<size_t>(f)];
+        const bool focus = source == 0 || source == f;
+        for (const astro_transfer::Transfer& t : family) DrawCircleV(toScreen(t), focus ? 2.5f : 1.5f, Fade(color, focus ? 0.95f : 0.35f));
+    }
+    for (size_t i = 1; i < front->combined.size(); ++i)
+        DrawLineV(toScreen(front->combined[i - 1]), toScreen(front->combined[i]), Fade(RAYWHITE, source == 0 ? 0.6f : 0.2f));
+    if (picked.feasible()) DrawCircleLinesV(toScreen(picked), 7.0f, RAYWHITE);
+    DrawText("dv", 946, 116, 16, Color{164, 183, 210, 255});
+    DrawText(("tof " + Fixed(static_cast<float>(tMin), 1)).c_str(), 975, 338, 15, Color{164, 183, 210, 255});
+    DrawText((Fixed(static_cast<float>(tMax), 0) + " (log)").c_str(), 1170, 338, 15, Color{164, 183, 210, 255});
+
+    for (int f = 0; f < astro_transfer::kFamilyCount; ++f) {
+        const int y = 366 + 20 * f;
+        DrawRectangle(952, y + 3, 10, 10, kFamilyColors[static_cast<size_t>(f)]);
+        const std::string label = std::string(astro_transfer::FamilyName(static_cast<astro_transfer::Family>(f))) + "  " +
+                                  std::to_string(front->families[static_cast<size_t>(f)].size()) + " pts";
+        DrawText(label.c_str(), 970, y, 16, source != 0 && source == f ? RAYWHITE : Color{190, 200, 214, 255});
+    }
+    const std::string from = source == 0 ? "combined front" : astro_transfer::FamilyName(static_cast<astro_transfer::Family>(source));
+    DrawText(("picking: " + from).c_str(), 952, 472, 17, Color{170, 215, 255, 255});
+    if (picked.feasible()) {
+        DrawText(astro_transfer::FamilyName(picked.family), 952, 496, 18, FamilyColor(picked.family));
+        DrawText(("dv " + Fixed(static_cast<float>(picked.dv)) + "  (" + Fixed(static_cast<float>(picked.dv / hohmann.dv), 2) + "x Hohmann)").c_str(),
+                 952, 520, 17, Color{255, 238, 180, 255});
+        DrawText(("tof " + Fixed(static_cast<float>(picked.tof), 2) + "  (" + Fixed(static_cast<float>(picked.tof / hohmann.tof), 2) + "x)").c_str(),
+                 952, 542, 17, Color{255, 238, 180, 255});
+    }
+    const std::string status = "gen " + std::to_string(front->generation) + "  evals " + std::to_string(front->evaluations) + (busy ? "" : "  done");
+    DrawText(status.c_str(), 952, 566, 16, Color{155, 166, 180, 255});
+    DrawText(paused ? "SPACE animate" : "SPACE pause", 952, 588, 16, Color{155, 166, 180, 255});
+}
+
 }  // namespace
 
 int main() {
@@ -85,6 +211,15 @@ int main() {
     float progress = 0.0f;
     bool paused = false;
 
+    // Optimizer mode: the search runs on its own thread and publishes a front after
+    // every generation; the picked transfer is laid out again whenever it changes.
+    bool optimizer = false;
+    astro_transfer::SearchThread search;
+    int source = 0;
+    float pick = 0.5f;
+    astro_transfer::Transfer shown;
+    astro_transfer::TransferPath path;
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_R)) {
             r1 = 1.85f;
@@ -93,6 +228,8 @@ int main() {
             paused = false;
         }
         if (IsKeyPressed(KEY_SPACE)) paused = !paused;
+        if (IsKeyPressed(KEY_O)) optimizer = !optimizer;
+        if (IsKeyPressed(KEY_F)) source = (source + 1) % astro_transfer::kFamilyCount;
         if (IsKeyDown(KEY_RIGHT)) r2 += 0.7f * GetFrameTime();
         if (IsKeyDown(KEY_LEFT)) r2 -= 0.7f * GetFrameTime();
         if (IsKeyDown(KEY_UP)) r1 += 0.55f * GetFrameTime();
@@ -106,6 +243,23 @@ int main() {
         if (progress > 1.0f) progress -= 1.0f;
         if (progress < 0.0f) progress += 1.0f;
 
+        astro_transfer::Transfer picked;
+        if (optimizer) {
+            search.Request({1.0, r1, r2});
+            search.Acquire();
+            if (const astro_transfer::Front* front = search.front()) {
+                const std::vector<astro_transfer::Transfer>& list = PickList(*front, source);
+                const float step = list.size() > 1 ? 1.0f / static_cast<float>(list.size() - 1) : 1.0f;
+                if (IsKeyPressed(KEY_LEFT_BRACKET)) pick = std::max(0.0f, pick - step);
+                if (IsKeyPressed(KEY_RIGHT_BRACKET)) pick = std::min(1.0f, pick + step);
+                if (!list.empty()) picked = list[static_cast<size_t>(std::lround(pick * static_cast<float>(list.size() - 1)))];
+                if (picked.feasible() && !SameTransfer(picked, shown)) {
+                    path = astro_transfer::BuildPath(front->problem, picked);
+                    shown = picked;
+                }
+            }
+        }
+
         const float scale = 88.0f;
         const float theta = progress * kPi;
         const Vector2 craft = TransferPoint(r1, r2, theta, scale);
@@ -121,26 +275,47 @@ int main() {
             DrawPixelV({x, y}, Color{80, 95, 118, static_cast<unsigned char>(70 + (i % 4) * 22)});
         }
 
-        DrawOrbit(r1, scale, Color{76, 171, 255, 180});
-        DrawOrbit(r2, scale, Color{101, 235, 132, 170});
-        DrawTransfer(r1, r2, scale);
-        DrawCircleV(ScreenCenter(), 32.0f, Color{255, 188, 80, 255});
-        DrawCircleLinesV(ScreenCenter(), 38.0f, Color{255, 232, 170, 150});
-        DrawCircleV(burn1, 7.0f, Color{255, 105, 97, 255});
-        DrawCircleV(burn2, 7.0f, Color{120, 220, 255, 255});
-        DrawCircleV(craft, 9.0f, Color{245, 246, 255, 255});
-        DrawLineV(craft, {craft.x - 24.0f * std::sin(theta), craft.y + 24.0f * std::cos(theta)}, Color{245, 246, 255, 175});
-
-        DrawText("BURN 1", static_cast<int>(burn1.x + 14), static_cast<int>(burn1.y - 10), 16, Color{255, 170, 160, 255});
-        DrawText("BURN 2", static_cast<int>(burn2.x - 76), static_cast<int>(burn2.y - 10), 16, Color{155, 230, 255, 255});
-        DrawText("parking orbit", 72, 110, 18, Color{115, 195, 255, 255});
-        DrawText("target orbit", 72, 136, 18, Color{135, 245, 155, 255});
-        DrawText("LEFT/RIGHT target  UP/DOWN parking  A/D scrub  R reset", 70, kScreenHeight - 52, 18, Color{185, 195, 210, 255});
-
-        DrawPanel(r1, r2, progress, paused);
+        if (optimizer && shown.feasible()) {
+            const float fit = PathScale(path, r2);
+            DrawOrbit(r1, fit, Color{76, 171, 255, 180});
+            DrawOrbit(r2, fit, Color{101, 235, 132, 170});
+            DrawTransferPath(path, shown.family, fit);
+            DrawCircleV(ScreenCenter(), 32.0f * fit / scale, Color{255, 188, 80, 255});
+            DrawCircleV(CraftOnPath(path, progress * path.tof, fit), 8.0f, Color{245, 246, 255, 255});
+            DrawText((std::string(astro_transfer::FamilyName(shown.family)) + (path.thrusting ? " (thrusting)" : "")).c_str(), 72, 110, 18,
+                     FamilyColor(shown.family));
+            DrawText("parking / target orbit", 72, 136, 18, Color{115, 195, 255, 255});
+        } else {
+            DrawOrbit(r1, scale, Color{76, 171, 255, 180});
+            DrawOrbit(r2, scale, Color{101, 235, 132, 170});
+            DrawTransfer(r1, r2, scale);
+            DrawCircleV(ScreenCenter(), 32.0f, Color{255, 188, 80, 255});
+            DrawCircleLinesV(ScreenCenter(), 38.0f, Color{255, 232, 170, 150});
+            DrawCircleV(burn1, 7.0f, Color{255, 105, 97, 255});
+            DrawCircleV(burn2, 7.0f, Color{120, 220, 255, 255});
+            DrawCircleV(craft, 9.0f, Color{245, 246, 255, 255});
+            DrawLineV(craft, {craft.x - 24.0f * std::sin(theta), craft.y + 24.0f * std::cos(theta)}, Color{245, 246, 255, 175});
+
+            DrawText("BURN 1", static_cast<int>(burn1.x + 14), static_cast<int>(burn1.y - 10), 16, Color{255, 170, 160, 255});
+            DrawText("BURN 2", static_cast<int>(burn2.x - 76), static_cast<int>(burn2.y - 10), 16, Color{155, 230, 255, 255});
+            DrawText("parking orbit", 72, 110, 18, Color{115, 195, 255, 255});
+            DrawText("target orbit", 72, 136, 18, Color{135, 245, 155, 255});
+        }
+        DrawText("LEFT/RIGHT target  UP/DOWN parking  A/D scrub  R reset  O optimizer  F front  [ ] pick", 70, kScreenHeight - 52, 18, Color{185, 195, 210, 255});
+
+        if (optimizer) {
+            DrawOptimizerPanel(search.front(), source, picked, search.Busy(), paused);
+            DrawText(("transfer: " + Fixed(progress * 100.0f, 0) + "%").c_str(), 70, 70, 20, RAYWHITE);
+        } else {
+            DrawPanel(r1, r2, progress, paused);
+        }
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    search.Stop();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,10 +1,23 @@
 #include "raylib.h"
 
+#include "../common/colormap.h"
+#include "../common/ephemeris.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/lambert.h"
+#include "../common/profiler.h"
+#include "../common/thread_pool.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -12,29 +25,71 @@ constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 constexpr float kPi = 3.14159265358979323846f;
 
+struct GridSize {
+    int cols;
+    int rows;
+};
+
+// G cycles the porkchop resolution; the field is only recomputed when it or the
+// synodic period changes, so the fine grid costs nothing while the inputs hold still.
+constexpr std::array<GridSize, 2> kGridSizes = {GridSize{1024, 768}, GridSize{96, 72}};
+
+// M switches between the analytic stand-in and Earth -> Mars Lambert transfers on
+// mean-element ephemerides. Both axes count days from kLambertEpochJd in that mode.
+enum class PorkchopModel {
+    Synthetic,
+    Lambert,
+};
+
+constexpr double kLambertEpochJd = 2461222.5;  // 2026-07-01 00:00 TT
+constexpr const char* kLambertEpochLabel = "2026-07-01";
+
 struct WindowResult {
     float c3;
     float tof;
     float phaseError;
 };
 
-WindowResult Evaluate(float departureDay, float arrivalDay, float synodicPeriod) {
+// Launch phase for a departure day; it depends on the column only, so the grid
+// evaluates it once per column.
+float DeparturePhase(float departureDay, float synodicPeriod) {
+    return std::sin((departureDay / synodicPeriod) * 2.0f * kPi);
+}
+
+WindowResult EvaluateWithPhase(float departureDay, float arrivalDay, float phase) {
     const float tof = std::max(1.0f, arrivalDay - departureDay);
     const float preferredTof = 255.0f;
-    const float phase = std::sin((departureDay / synodicPeriod) * 2.0f * kPi);
     const float launchEnergy = 11.0f + 0.0009f * (tof - preferredTof) * (tof - preferredTof);
     const float phasePenalty = 18.0f * std::fabs(phase - 0.34f);
     const float shortTripPenalty = tof < 145.0f ? (145.0f - tof) * 0.14f : 0.0f;
     return {launchEnergy + phasePenalty + shortTripPenalty, tof, phase - 0.34f};
 }
 
-Color Heat(float c3) {
-    const float t = std::clamp((c3 - 10.0f) / 70.0f, 0.0f, 1.0f);
+WindowResult Evaluate(float departureDay, float arrivalDay, float synodicPeriod) {
+    return EvaluateWithPhase(departureDay, arrivalDay, DeparturePhase(departureDay, synodicPeriod));
+}
+
+float ArrivalForRow(int y, int rows) {
+    return 120.0f + (static_cast<float>(y) / (rows - 1)) * 480.0f;
+}
+
+float DepartureForColumn(int x, int cols) {
+    return (static_cast<float>(x) / (cols - 1)) * 360.0f;
+}
+
+bool WindowFeasible(float departure, float arrival) {
+    return arrival > departure + 70.0f;
+}
+
+// C3 from 10 (cool blue) to 80 km^2/s^2 (red); green peaks a third of the way up.
+const astro_color::Colormap kC3Map = astro_color::Colormap::Bake([](float t) {
     const unsigned char r = static_cast<unsigned char>(50 + 205 * t);
     const unsigned char g = static_cast<unsigned char>(210 - 145 * std::fabs(t - 0.34f));
     const unsigned char b = static_cast<unsigned char>(245 - 205 * t);
-    return {r, g, b, 255};
-}
+    return Color{r, g, b, 255};
+});
+
+Color Heat(float c3) { return kC3Map((c3 - 10.0f) / 70.0f); }
 
 std::string Fixed(float value, int precision = 1) {
     std::ostringstream os;
@@ -49,9 +104,198 @@ Vector2 CellToScreen(int x, int y, Rectangle plot, int cols, int rows) {
     };
 }
 
-void DrawAxes(Rectangle plot) {
+struct LambertWindow {
+    bool ok;
+    float c3;           // departure C3, km^2/s^2
+    float vInfArrival;  // km/s
+};
+
+float SquaredKmPerS(const astro_ephem::Vec3d& v, const astro_ephem::Vec3d& frame) {
+    const double dx = v.x - frame.x;
+    const double dy = v.y - frame.y;
+    const double dz = v.z - frame.z;
+    return static_cast<float>((dx * dx + dy * dy + dz * dz) * astro_ephem::kAuPerDayToKmPerS *
+                              astro_ephem::kAuPerDayToKmPerS);
+}
+
+LambertWindow EvaluateLambert(float departureDay, float arrivalDay) {
+    const astro_ephem::StateVector earth = astro_ephem::StateAt(astro_ephem::kEarthMoonBarycenter, kLambertEpochJd + departureDay);
+    const astro_ephem::StateVector mars = astro_ephem::StateAt(astro_ephem::kMars, kLambertEpochJd + arrivalDay);
+    astro_ephem::Vec3d v1, v2;
+    if (!astro_lambert::Solve(earth.position, mars.position, arrivalDay - departureDay, astro_ephem::kMuSun, &v1, &v2)) {
+        return {false, 0.0f, 0.0f};
+    }
+    return {true, SquaredKmPerS(v1, earth.velocity), std::sqrt(SquaredKmPerS(v2, mars.velocity))};
+}
+
+struct RowBest {
+    float c3;
+    int x;
+};
+
+// C3 and time of flight over the departure/arrival grid, cached together with the
+// RGBA image drawn from them. Row 0 is the latest arrival so the pixels go straight
+// into a texture. Cells that fail WindowFeasible() or have no Lambert solution hold NaN.
+struct PorkchopField {
+    bool valid = false;
+    PorkchopModel model = PorkchopModel::Synthetic;
+    int cols = 0;
+    int rows = 0;
+    float synodicPeriod = 0.0f;
+    std::vector<float> c3;
+    std::vector<float> tof;
+    std::vector<Color> pixels;
+    float bestC3 = 1.0e9f;
+    int bestX = 0;
+    int bestY = 0;
+    std::vector<RowBest> rowBest;
+    std::vector<float> columnPhase;
+    std::vector<astro_ephem::StateVector> departureStates;  // per column (Lambert)
+    std::vector<astro_ephem::StateVector> arrivalStates;    // per row (Lambert)
+};
+
+void EvaluateSyntheticRow(const PorkchopField& field, float arrival, float* c3Row) {
+    for (int x = 0; x < field.cols; ++x) {
+        const float departure = DepartureForColumn(x, field.cols);
+        c3Row[x] = WindowFeasible(departure, arrival)
+                       ? EvaluateWithPhase(departure, arrival, field.columnPhase[static_cast<size_t>(x)]).c3
+                       : std::nanf("");
+    }
+}
+
+// Solves the row kLanes columns at a time; batches with no feasible cell are skipped.
+void EvaluateLambertRow(const PorkchopField& field, int y, float arrival, float* c3Row) {
+    const astro_ephem::StateVector& mars = field.arrivalStates[static_cast<size_t>(y)];
+    astro_lambert::Batch batch;
+    astro_lambert::BatchResult result;
+    batch.r2 = mars.position;
+    for (int x0 = 0; x0 < field.cols; x0 += astro_lambert::kLanes) {
+        bool anyFeasible = false;
+        for (int l = 0; l < astro_lambert::kLanes; ++l) {
+            const int x = std::min(x0 + l, field.cols - 1);
+            const float departure = DepartureForColumn(x, field.cols);
+            const bool feasible = x0 + l < field.cols && WindowFeasible(departure, arrival);
+            const astro_ephem::Vec3d& r1 = field.departureStates[static_cast<size_t>(x)].position;
+            batch.r1x[l] = r1.x;
+            batch.r1y[l] = r1.y;
+            batch.r1z[l] = r1.z;
+            batch.tof[l] = feasible ? static_cast<double>(arrival - departure) : 0.0;
+            anyFeasible = anyFeasible || feasible;
+        }
+        if (anyFeasible) astro_lambert::SolveBatch(batch, astro_ephem::kMuSun, &result);
+        for (int l = 0; l < astro_lambert::kLanes && x0 + l < field.cols; ++l) {
+            const int x = x0 + l;
+            if (!anyFeasible || batch.tof[l] <= 0.0 || !std::isfinite(result.v1x[l])) {
+                c3Row[x] = std::nanf("");
+                continue;
+            }
+            const astro_ephem::Vec3d v1{result.v1x[l], result.v1y[l], result.v1z[l]};
+            c3Row[x] = SquaredKmPerS(v1, field.departureStates[static_cast<size_t>(x)].velocity);
+        }
+    }
+}
+
+// Recomputes the field (one pool task per block of rows) when the model, the grid size
+// or, for the synthetic model, the synodic period differs from the cached one. Returns
+// true when it did.
+bool UpdatePorkchopField(PorkchopField* field, PorkchopModel model, GridSize grid, float synodicPeriod) {
+    const bool periodMatters = model == PorkchopModel::Synthetic;
+    if (field->valid && field->model == model && field->cols == grid.cols && field->rows == grid.rows &&
+        (!periodMatters || field->synodicPeriod == synodicPeriod)) {
+        return false;
+    }
+    field->valid = true;
+    field->model = model;
+    field->cols = grid.cols;
+    field->rows = grid.rows;
+    field->synodicPeriod = synodicPeriod;
+    const size_t cells = static_cast<size_t>(grid.cols) * static_cast<size_t>(grid.rows);
+    field->c3.resize(cells);
+    field->tof.resize(cells);
+    field->pixels.resize(cells);
+
+    if (model == PorkchopModel::Synthetic) {
+        field->columnPhase.resize(static_cast<size_t>(grid.cols));
+        for (int x = 0; x < grid.cols; ++x) {
+            field->columnPhase[static_cast<size_t>(x)] = DeparturePhase(DepartureForColumn(x, grid.cols), synodicPeriod);
+        }
+    } else {
+        field->departureStates.resize(static_cast<size_t>(grid.cols));
+        field->arrivalStates.resize(static_cast<size_t>(grid.rows));
+        for (int x = 0; x < grid.cols; ++x) {
+            field->departureStates[static_cast<size_t>(x)] =
+                astro_ephem::StateAt(astro_ephem::kEarthMoonBarycenter, kLambertEpochJd + DepartureForColumn(x, grid.cols));
+        }
+        for (int y = 0; y < grid.rows; ++y) {
+            field->arrivalStates[static_cast<size_t>(y)] =
+                astro_ephem::StateAt(astro_ephem::kMars, kLambertEpochJd + ArrivalForRow(grid.rows - 1 - y, grid.rows));
+        }
+    }
+
+    std::vector<RowBest>& rowBest = field->rowBest;
+    rowBest.assign(static_cast<size_t>(grid.rows), RowBest{1.0e9f, -1});
+    astro_parallel::SharedPool().ParallelFor(grid.rows, 8, [&](int begin, int end) {
+        for (int y = begin; y < end; ++y) {
+            const float arrival = ArrivalForRow(grid.rows - 1 - y, grid.rows);
+            float* c3Row = field->c3.data() + static_cast<size_t>(y) * grid.cols;
+            float* tofRow = field->tof.data() + static_cast<size_t>(y) * grid.cols;
+            Color* pixelRow = field->pixels.data() + static_cast<size_t>(y) * grid.cols;
+            if (model == PorkchopModel::Synthetic) {
+                EvaluateSyntheticRow(*field, arrival, c3Row);
+            } else {
+                EvaluateLambertRow(*field, y, arrival, c3Row);
+            }
+            RowBest best{1.0e9f, -1};
+            for (int x = 0; x < grid.cols; ++x) {
+                const float c3 = c3Row[x];
+                const bool solved = std::isfinite(c3);
+                tofRow[x] = solved ? arrival - DepartureForColumn(x, grid.cols) : std::nanf("");
+                pixelRow[x] = solved ? Heat(c3) : Color{22, 29, 41, 255};
+                if (solved && c3 < best.c3) best = {c3, x};
+            }
+            rowBest[static_cast<size_t>(y)] = best;
+        }
+    });
+
+    // Earliest arrival first, matching the serial scan this replaced.
+    field->bestC3 = 1.0e9f;
+    for (int y = grid.rows - 1; y >= 0; --y) {
+        const RowBest& best = rowBest[static_cast<size_t>(y)];
+        if (best.x >= 0 && best.c3 < field->bestC3) {
+            field->bestC3 = best.c3;
+            field->bestX = best.x;
+            field->bestY = y;
+        }
+    }
+    return true;
+}
+
+// Writes one matrix as <path>: the bytes "PKCH", then little-endian uint32 version (1),
+// cols and rows, then cols*rows float32 values row-major with row 0 at the earliest
+// arrival and column 0 at the earliest departure. NaN marks cells without a transfer.
+bool WriteMatrix(const std::string& path, const PorkchopField& field, const std::vector<float>& values) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    const uint32_t header[3] = {1u, static_cast<uint32_t>(field.cols), static_cast<uint32_t>(field.rows)};
+    bool ok = std::fwrite("PKCH", 1, 4, file) == 4 && std::fwrite(header, sizeof(header), 1, file) == 1;
+    for (int y = field.rows - 1; ok && y >= 0; --y) {
+        const float* row = values.data() + static_cast<size_t>(y) * field.cols;
+        ok = std::fwrite(row, sizeof(float), static_cast<size_t>(field.cols), file) == static_cast<size_t>(field.cols);
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+// <prefix>_c3.f32 (km^2/s^2 for Lambert) and <prefix>_tof.f32 (days).
+bool ExportPorkchop(const PorkchopField& field, const std::string& prefix) {
+    return WriteMatrix(prefix + "_c3.f32", field, field.c3) && WriteMatrix(prefix + "_tof.f32", field, field.tof);
+}
+
+void DrawAxes(Rectangle plot, PorkchopModel model) {
+    const bool lambert = model == PorkchopModel::Lambert;
     DrawRectangleLinesEx(plot, 2.0f, Color{190, 205, 220, 255});
-    DrawText("departure day", static_cast<int>(plot.x + plot.width * 0.40f), static_cast<int>(plot.y + plot.height + 38), 20, RAYWHITE);
+    DrawText(lambert ? TextFormat("departure day (from %s)", kLambertEpochLabel) : "departure day",
+             static_cast<int>(plot.x + plot.width * (lambert ? 0.30f : 0.40f)), static_cast<int>(plot.y + plot.height + 38), 20,
+             RAYWHITE);
     DrawText("arrival day", static_cast<int>(plot.x - 90), static_cast<int>(plot.y - 34), 20, RAYWHITE);
     for (int i = 0; i <= 6; ++i) {
         float x = plot.x + i * plot.width / 6.0f;
@@ -67,13 +311,44 @@ void DrawAxes(Rectangle plot) {
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 240, 1.0f / 60.0f);
+    if (bench.enabled) {
+        const GridSize grid{std::max(2, astro_bench::IntArg(argc, argv, "--cols", kGridSizes[0].cols)),
+                            std::max(2, astro_bench::IntArg(argc, argv, "--rows", kGridSizes[0].rows))};
+        const char* modelName = astro_bench::FindArg(argc, argv, "--model");
+        const PorkchopModel model =
+            modelName != nullptr && std::strcmp(modelName, "lambert") == 0 ? PorkchopModel::Lambert : PorkchopModel::Synthetic;
+        PorkchopField field;
+        float synodicPeriod = 500.0f;
+        // Synthetic: sweeps the synodic period like holding W, so every step recomputes
+        // the field. Lambert: the ephemerides never change, so each step starts over.
+        const int status = astro_bench::RunBench(
+            "launch_window_porkchop_viz", bench,
+            [&](float dt) {
+                synodicPeriod = synodicPeriod >= 980.0f ? 500.0f : synodicPeriod + 60.0f * dt;
+                if (model == PorkchopModel::Lambert) field.valid = false;
+                UpdatePorkchopField(&field, model, grid, synodicPeriod);
+            },
+            [&]() { return field.bestC3 + field.c3[field.c3.size() / 2]; });
+        if (const char* prefix = astro_bench::FindArg(argc, argv, "--export")) {
+            if (!ExportPorkchop(field, prefix)) {
+                std::fprintf(stderr, "failed to write %s_c3.f32 / %s_tof.f32\n", prefix, prefix);
+                return 1;
+            }
+        }
+        return status;
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Orbital Mechanics - Launch Window Porkchop");
     SetTargetFPS(60);
 
     Rectangle plot{88.0f, 92.0f, 760.0f, 560.0f};
-    constexpr int cols = 96;
-    constexpr int rows = 72;
+    int gridOption = 0;
+    PorkchopModel model = PorkchopModel::Lambert;
+    PorkchopField field;
+    Texture2D heatTexture{};
+    std::string exportStatus;
 
     float selectedDeparture = 132.0f;
     float selectedArrival = 410.0f;
@@ -85,6 +360,10 @@ int main() {
             selectedArrival = 410.0f;
             synodicPeriod = 780.0f;
         }
+        if (IsKeyPressed(KEY_G)) gridOption = (gridOption + 1) % static_cast<int>(kGridSizes.size());
+        if (IsKeyPressed(KEY_M)) {
+            model = model == PorkchopModel::Lambert ? PorkchopModel::Synthetic : PorkchopModel::Lambert;
+        }
         if (IsKeyDown(KEY_RIGHT)) selectedDeparture += 80.0f * GetFrameTime();
         if (IsKeyDown(KEY_LEFT)) selectedDeparture -= 80.0f * GetFrameTime();
         if (IsKeyDown(KEY_UP)) selectedArrival += 100.0f * GetFrameTime();
@@ -96,43 +375,38 @@ int main() {
         selectedArrival = std::clamp(selectedArrival, 120.0f, 600.0f);
         synodicPeriod = std::clamp(synodicPeriod, 500.0f, 980.0f);
 
-        float bestC3 = 1.0e9f;
-        Vector2 bestPoint{};
-        for (int y = 0; y < rows; ++y) {
-            const float arrival = 120.0f + (static_cast<float>(y) / (rows - 1)) * 480.0f;
-            for (int x = 0; x < cols; ++x) {
-                const float departure = (static_cast<float>(x) / (cols - 1)) * 360.0f;
-                WindowResult result = Evaluate(departure, arrival, synodicPeriod);
-                if (arrival > departure + 70.0f && result.c3 < bestC3) {
-                    bestC3 = result.c3;
-                    bestPoint = CellToScreen(x, rows - 1 - y, plot, cols, rows);
-                }
+        const GridSize grid = kGridSizes[static_cast<size_t>(gridOption)];
+        if (UpdatePorkchopField(&field, model, grid, synodicPeriod)) {
+            if (heatTexture.id == 0 || heatTexture.width != grid.cols || heatTexture.height != grid.rows) {
+                if (heatTexture.id != 0) UnloadTexture(heatTexture);
+                Image image{field.pixels.data(), grid.cols, grid.rows, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+                heatTexture = LoadTextureFromImage(image);
+            } else {
+                UpdateTexture(heatTexture, field.pixels.data());
             }
         }
+        if (IsKeyPressed(KEY_E)) {
+            const std::string prefix = model == PorkchopModel::Lambert ? "porkchop_lambert" : "porkchop_synthetic";
+            exportStatus = ExportPorkchop(field, prefix) ? "wrote " + prefix + "_c3.f32 / _tof.f32" : "export failed";
+        }
+        const float bestC3 = field.bestC3;
+        const Vector2 bestPoint = CellToScreen(field.bestX, field.bestY, plot, grid.cols, grid.rows);
 
-        WindowResult selected = Evaluate(selectedDeparture, selectedArrival, synodicPeriod);
+        const bool lambert = model == PorkchopModel::Lambert;
+        const WindowResult selected = Evaluate(selectedDeparture, selectedArrival, synodicPeriod);
+        const LambertWindow transfer = lambert && WindowFeasible(selectedDeparture, selectedArrival)
+                                           ? EvaluateLambert(selectedDeparture, selectedArrival)
+                                           : LambertWindow{false, 0.0f, 0.0f};
         const float sx = plot.x + selectedDeparture / 360.0f * plot.width;
         const float sy = plot.y + plot.height - (selectedArrival - 120.0f) / 480.0f * plot.height;
 
         BeginDrawing();
         ClearBackground(Color{7, 11, 20, 255});
 
-        for (int y = 0; y < rows; ++y) {
-            const float arrival = 120.0f + (static_cast<float>(rows - 1 - y) / (rows - 1)) * 480.0f;
-            for (int x = 0; x < cols; ++x) {
-                const float departure = (static_cast<float>(x) / (cols - 1)) * 360.0f;
-                WindowResult result = Evaluate(departure, arrival, synodicPeriod);
-                Color c = arrival <= departure + 70.0f ? Color{22, 29, 41, 255} : Heat(result.c3);
-                DrawRectangle(
-                    static_cast<int>(plot.x + x * plot.width / cols),
-                    static_cast<int>(plot.y + y * plot.height / rows),
-                    static_cast<int>(std::ceil(plot.width / cols)) + 1,
-                    static_cast<int>(std::ceil(plot.height / rows)) + 1,
-                    c);
-            }
-        }
-
-        DrawAxes(plot);
+        DrawTexturePro(heatTexture,
+                       {0.0f, 0.0f, static_cast<float>(heatTexture.width), static_cast<float>(heatTexture.height)},
+                       plot, {0.0f, 0.0f}, 0.0f, WHITE);
+        DrawAxes(plot, model);
         DrawCircleV(bestPoint, 9.0f, Color{255, 255, 255, 255});
         DrawCircleLinesV(bestPoint, 15.0f, Color{20, 25, 35, 255});
         DrawLineV({sx, plot.y}, {sx, plot.y + plot.height}, Color{255, 255, 255, 145});
@@ -141,22 +415,37 @@ int main() {
 
         DrawRectangle(900, 90, 305, 330, Color{15, 23, 36, 235});
         DrawRectangleLines(900, 90, 305, 330, Color{91, 118, 150, 255});
-        DrawText("LAUNCH WINDOW", 930, 118, 24, RAYWHITE);
+        DrawText(lambert ? "EARTH -> MARS" : "LAUNCH WINDOW", 930, 118, 24, RAYWHITE);
         DrawText(("departure: " + Fixed(selectedDeparture, 0) + " d").c_str(), 930, 168, 19, Color{210, 230, 255, 255});
         DrawText(("arrival:   " + Fixed(selectedArrival, 0) + " d").c_str(), 930, 196, 19, Color{210, 230, 255, 255});
         DrawText(("tof:       " + Fixed(selected.tof, 0) + " d").c_str(), 930, 224, 19, Color{255, 235, 175, 255});
-        DrawText(("C3 index:  " + Fixed(selected.c3, 2)).c_str(), 930, 262, 19, Color{255, 235, 175, 255});
-        DrawText(("phase err: " + Fixed(selected.phaseError, 2)).c_str(), 930, 290, 19, Color{190, 220, 255, 255});
-        DrawText(("synodic:   " + Fixed(synodicPeriod, 0) + " d").c_str(), 930, 318, 19, Color{190, 220, 255, 255});
+        if (lambert) {
+            DrawText(transfer.ok ? ("C3:        " + Fixed(transfer.c3, 2) + " km2/s2").c_str() : "C3:        no transfer", 930, 262,
+                     19, Color{255, 235, 175, 255});
+            DrawText(transfer.ok ? ("v_inf arr: " + Fixed(transfer.vInfArrival, 2) + " km/s").c_str() : "v_inf arr: -", 930, 290,
+                     19, Color{190, 220, 255, 255});
+            DrawText(TextFormat("epoch:     %s", kLambertEpochLabel), 930, 318, 19, Color{190, 220, 255, 255});
+        } else {
+            DrawText(("C3 index:  " + Fixed(selected.c3, 2)).c_str(), 930, 262, 19, Color{255, 235, 175, 255});
+            DrawText(("phase err: " + Fixed(selected.phaseError, 2)).c_str(), 930, 290, 19, Color{190, 220, 255, 255});
+            DrawText(("synodic:   " + Fixed(synodicPeriod, 0) + " d").c_str(), 930, 318, 19, Color{190, 220, 255, 255});
+        }
         DrawText(("best C3:   " + Fixed(bestC3, 2)).c_str(), 930, 356, 19, Color{220, 255, 220, 255});
-        DrawText("white dot = best window", 930, 386, 16, Color{158, 170, 185, 255});
+        DrawText(TextFormat("white dot = best window  grid %dx%d", grid.cols, grid.rows), 930, 386, 16, Color{158, 170, 185, 255});
+        if (!exportStatus.empty()) DrawText(exportStatus.c_str(), 900, 432, 16, Color{158, 170, 185, 255});
 
-        DrawText("LEFT/RIGHT departure  UP/DOWN arrival  W/S synodic period  R reset", 88, 724, 19, Color{190, 200, 214, 255});
-        DrawText("Synthetic porkchop map: lower C3 regions represent easier departure-energy windows.", 88, 754, 18, Color{142, 154, 170, 255});
+        DrawText("LEFT/RIGHT departure  UP/DOWN arrival  W/S synodic period  G grid size  M model  E export  R reset", 88, 724, 19,
+                 Color{190, 200, 214, 255});
+        DrawText(lambert ? "Lambert porkchop: departure C3 of zero-revolution Earth-Mars transfers (Standish mean elements)."
+                         : "Synthetic porkchop map: lower C3 regions represent easier departure-energy windows.",
+                 88, 754, 18, Color{142, 154, 170, 255});
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    if (heatTexture.id != 0) UnloadTexture(heatTexture);
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
-
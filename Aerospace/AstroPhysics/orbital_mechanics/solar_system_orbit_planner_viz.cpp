@@ -1,29 +1,45 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/chebyshev_ephemeris.h"
+#include "../common/frame_capture.h"
+#include "../common/integrators.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
-constexpr float kPi = 3.14159265358979323846f;
 constexpr float kSunMu = 1600.0f;
 constexpr float kDt = 0.0028f;
 constexpr int kPreviewSteps = 5200;
+constexpr int kPreviewSampleEvery = 8;
+// The coarse pass takes one step per sample instead of kPreviewSampleEvery.
+constexpr float kCoarseStep = kDt * kPreviewSampleEvery;
 constexpr int kTrailMax = 1400;
+// Planets take their longitudes from the ephemeris from J2000 on; a time unit is this
+// many days, so Earth still laps in 18 units.
+constexpr double kDaysPerTimeUnit = 365.25 / 18.0;
 
 struct Planet {
     std::string name;
     float radius;
     float visualRadius;
-    float period;
-    float phase;
+    astro_ephem::Body body;
     Color color;
 };
 
@@ -53,26 +69,62 @@ Vector2 Accel(Vector2 pos) {
     return Vector2Scale(pos, -kSunMu * invR3);
 }
 
-void StepCraft(Craft* craft, float dt) {
-    const Vector2 a0 = Accel(craft->pos);
-    craft->vel = Vector2Add(craft->vel, Vector2Scale(a0, dt * 0.5f));
-    craft->pos = Vector2Add(craft->pos, Vector2Scale(craft->vel, dt));
-    const Vector2 a1 = Accel(craft->pos);
-    craft->vel = Vector2Add(craft->vel, Vector2Scale(a1, dt * 0.5f));
+// Drift/kick view of the craft for the symplectic integrators.
+struct CraftSystem {
+    Craft* craft;
+
+    void Drift(float h) {
+        craft->pos = Vector2Add(craft->pos, Vector2Scale(craft->vel, h));
+    }
+
+    void Kick(float h) {
+        craft->vel = Vector2Add(craft->vel, Vector2Scale(Accel(craft->pos), h));
+    }
+};
+
+using CraftState = std::array<float, 4>;
+
+void CraftDerivative(const CraftState& y, CraftState& dydt) {
+    const Vector2 a = Accel({y[0], y[1]});
+    dydt = {y[2], y[3], a.x, a.y};
 }
 
-Vector2 PlanetPosition(const Planet& planet, float time) {
-    const float angle = planet.phase + time * 2.0f * kPi / planet.period;
-    return {std::cos(angle) * planet.radius, std::sin(angle) * planet.radius};
+// Advances the craft by `duration` in steps of at most maxStep, or in error-controlled
+// steps for Dormand-Prince.
+void AdvanceCraft(Craft* craft, float duration, astro_integrate::Method method, astro_integrate::AdaptiveStepper* adaptive,
+                  float maxStep = kDt) {
+    if (method == astro_integrate::Method::DormandPrince45 || method == astro_integrate::Method::Rk4) {
+        CraftState y = {craft->pos.x, craft->pos.y, craft->vel.x, craft->vel.y};
+        if (method == astro_integrate::Method::DormandPrince45) {
+            astro_integrate::DormandPrince45Advance(y, duration, CraftDerivative, *adaptive);
+        } else {
+            const int steps = std::max(1, static_cast<int>(std::ceil(duration / maxStep)));
+            const float dt = duration / static_cast<float>(steps);
+            for (int i = 0; i < steps; ++i) astro_integrate::Rk4Step(y, dt, CraftDerivative);
+        }
+        *craft = {{y[0], y[1]}, {y[2], y[3]}};
+        return;
+    }
+    const int steps = std::max(1, static_cast<int>(std::ceil(duration / maxStep)));
+    const float dt = duration / static_cast<float>(steps);
+    CraftSystem system{craft};
+    for (int i = 0; i < steps; ++i) astro_integrate::SymplecticStep(method, system, dt);
+}
+
+// The planet's heliocentric direction at its scene radius (the orbits stay circles).
+Vector2 PlanetPosition(const Planet& planet, const std::array<astro_ephem::Vec3d, astro_ephem::kBodyCount>& au) {
+    const astro_ephem::Vec3d& p = au[planet.body];
+    const double r = std::hypot(p.x, p.y);
+    return {static_cast<float>(p.x / r) * planet.radius, static_cast<float>(p.y / r) * planet.radius};
 }
 
 std::vector<Planet> MakePlanets() {
     return {
-        {"Mercury", 28.0f, 3.2f, 7.5f, 0.7f, Color{170, 160, 145, 255}},
-        {"Venus", 42.0f, 4.8f, 12.6f, 2.5f, Color{238, 195, 116, 255}},
-        {"Earth", 58.0f, 5.2f, 18.0f, 4.2f, Color{86, 172, 255, 255}},
-        {"Mars", 82.0f, 4.3f, 34.0f, 1.4f, Color{225, 96, 66, 255}},
-        {"Jupiter", 145.0f, 9.0f, 210.0f, 5.1f, Color{224, 177, 128, 255}},
+        {"Mercury", 28.0f, 3.2f, astro_ephem::kBodyMercury, Color{170, 160, 145, 255}},
+        {"Venus", 42.0f, 4.8f, astro_ephem::kBodyVenus, Color{238, 195, 116, 255}},
+        {"Earth", 58.0f, 5.2f, astro_ephem::kBodyEarth, Color{86, 172, 255, 255}},
+        {"Mars", 82.0f, 4.3f, astro_ephem::kBodyMars, Color{225, 96, 66, 255}},
+        {"Jupiter", 145.0f, 9.0f, astro_ephem::kBodyJupiter, Color{224, 177, 128, 255}},
     };
 }
 
@@ -88,19 +140,119 @@ std::string Fixed(float value, int precision = 2) {
     return os.str();
 }
 
-std::vector<Vector2> BuildPreview(Craft craft, Vector2 burn) {
-    craft.vel = Vector2Add(craft.vel, burn);
-    std::vector<Vector2> points;
-    points.reserve(650);
-    for (int i = 0; i < kPreviewSteps; ++i) {
-        StepCraft(&craft, kDt);
-        if (i % 8 == 0) points.push_back(craft.pos);
+struct PreviewRequest {
+    Craft craft;
+    Vector2 burn;
+    astro_integrate::Method method;
+};
+
+bool SameRequest(const PreviewRequest& a, const PreviewRequest& b) {
+    return a.craft.pos.x == b.craft.pos.x && a.craft.pos.y == b.craft.pos.y && a.craft.vel.x == b.craft.vel.x &&
+           a.craft.vel.y == b.craft.vel.y && a.burn.x == b.burn.x && a.burn.y == b.burn.y && a.method == b.method;
+}
+
+// Fills *points with the post-burn path, one point per kPreviewSampleEvery steps.
+// Returns false (leaving *points partial) as soon as cancelled() says a newer request
+// is waiting.
+template <typename Cancelled>
+bool BuildPreview(const PreviewRequest& request, bool coarse, std::vector<Vector2>* points, Cancelled&& cancelled) {
+    Craft craft = request.craft;
+    craft.vel = Vector2Add(craft.vel, request.burn);
+    astro_integrate::AdaptiveStepper adaptive;
+    if (coarse) {
+        adaptive.relTol = 1.0e-3f;
+        adaptive.absTol = 1.0e-3f;
+    }
+    points->clear();
+    for (int i = 0; i < kPreviewSteps / kPreviewSampleEvery; ++i) {
+        if (cancelled()) return false;
+        AdvanceCraft(&craft, kCoarseStep, request.method, &adaptive, coarse ? kCoarseStep : kDt);
+        points->push_back(craft.pos);
         if (Vector2Length(craft.pos) > 250.0f) break;
         if (Vector2Length(craft.pos) < 5.5f) break;
     }
-    return points;
+    return true;
 }
 
+// Integrates burn previews on a worker thread so dragging the burn handle never waits
+// on the integrator. Each request is answered twice, first by a coarse pass and then
+// by the full-resolution one; a newer Submit() abandons whichever pass is running.
+// Three path buffers rotate between the worker and the caller, so steady-state
+// previews do not allocate.
+class PreviewWorker {
+  public:
+    PreviewWorker() : thread_([this]() { Loop(); }) {}
+
+    ~PreviewWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    PreviewWorker(const PreviewWorker&) = delete;
+    PreviewWorker& operator=(const PreviewWorker&) = delete;
+
+    void Submit(const PreviewRequest& request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = request;
+            requested_.fetch_add(1);
+        }
+        wake_.notify_one();
+    }
+
+    // Swaps the newest finished path into *points and hands the old buffer back to the
+    // worker. Returns false when nothing new has been published since the last call.
+    bool TakeLatest(std::vector<Vector2>* points, bool* refined) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!readyFresh_) return false;
+        std::swap(*points, ready_);
+        *refined = readyRefined_;
+        readyFresh_ = false;
+        return true;
+    }
+
+  private:
+    void Loop() {
+        std::vector<Vector2> scratch;
+        scratch.reserve(kPreviewSteps / kPreviewSampleEvery);
+        uint64_t served = 0;
+        for (;;) {
+            PreviewRequest request{};
+            uint64_t generation = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&]() { return stop_ || requested_.load() != served; });
+                if (stop_) return;
+                request = pending_;
+                generation = requested_.load();
+            }
+            served = generation;
+            const auto cancelled = [&]() { return requested_.load(std::memory_order_relaxed) != generation; };
+            for (const bool coarse : {true, false}) {
+                if (!BuildPreview(request, coarse, &scratch, cancelled)) break;
+                std::lock_guard<std::mutex> lock(mutex_);
+                std::swap(scratch, ready_);
+                readyRefined_ = !coarse;
+                readyFresh_ = true;
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    PreviewRequest pending_{};
+    std::atomic<uint64_t> requested_{0};
+    std::vector<Vector2> ready_;
+    bool readyRefined_ = false;
+    bool readyFresh_ = false;
+    std::thread thread_;  // last, so it starts after the state above exists
+};
+
 void DrawPolylineWorld(const std::vector<Vector2>& points, Vector2 camera, float scale, Color color) {
     if (points.size() < 2) return;
     for (size_t i = 1; i < points.size(); ++i) {
@@ -143,27 +295,34 @@ void DrawGrid(Vector2 camera, float scale) {
     }
 }
 
-void DrawHud(float simTime, float timeScale, Vector2 burn, bool paused, bool followCraft, float zoom) {
-    DrawRectangle(920, 48, 314, 306, Color{13, 21, 34, 236});
-    DrawRectangleLines(920, 48, 314, 306, Color{82, 110, 146, 255});
+void DrawHud(float simTime, float timeScale, Vector2 burn, bool paused, bool followCraft, float zoom, astro_integrate::Method method,
+             bool previewRefined) {
+    DrawRectangle(920, 48, 314, 332, Color{13, 21, 34, 236});
+    DrawRectangleLines(920, 48, 314, 332, Color{82, 110, 146, 255});
     DrawText("SOLAR SYSTEM PLANNER", 944, 76, 22, RAYWHITE);
     DrawText(("time: " + Fixed(simTime, 1) + " y").c_str(), 944, 118, 18, Color{205, 224, 245, 255});
     DrawText(("warp: " + Fixed(timeScale, 1) + "x").c_str(), 944, 146, 18, Color{205, 224, 245, 255});
     DrawText(("burn dv: " + Fixed(Vector2Length(burn), 2)).c_str(), 944, 184, 18, Color{255, 232, 150, 255});
-    DrawText("prograde/radial preview", 944, 212, 18, Color{135, 245, 170, 255});
+    DrawText(previewRefined ? "prograde/radial preview" : "prograde/radial preview (coarse)", 944, 212, 18,
+             Color{135, 245, 170, 255});
     DrawText(paused ? "SPACE resume" : "SPACE pause", 944, 250, 17, Color{170, 184, 204, 255});
     DrawText(followCraft ? "F follow: craft" : "F follow: sun", 944, 276, 17, Color{170, 184, 204, 255});
     DrawText(("zoom: " + Fixed(zoom, 1)).c_str(), 944, 302, 17, Color{170, 184, 204, 255});
     DrawText("ENTER applies burn", 944, 328, 17, Color{255, 232, 150, 255});
+    DrawText((std::string("I integrator: ") + astro_integrate::MethodName(method)).c_str(), 944, 354, 17, Color{170, 184, 204, 255});
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    astro_ephem::ChebyshevEphemeris ephemeris;
+    astro_ephem::OpenPlanetEphemeris(argc, argv, &ephemeris);
+
     InitWindow(kScreenWidth, kScreenHeight, "Orbital Mechanics - Solar System Orbit Planner");
     SetTargetFPS(60);
 
     std::vector<Planet> planets = MakePlanets();
+    std::array<astro_ephem::Vec3d, astro_ephem::kBodyCount> planetAu{};
     Craft craft = MakeEarthOrbitCraft();
     std::vector<Vector2> trail;
     trail.reserve(kTrailMax);
@@ -176,6 +335,15 @@ int main() {
     bool draggingBurn = false;
     Vector2 burn{};
     Vector2 camera{};
+    astro_integrate::Method method = astro_integrate::Method::Yoshida4;
+    astro_integrate::AdaptiveStepper adaptive;
+
+    PreviewWorker previewWorker;
+    PreviewRequest lastRequest{};
+    bool requestedOnce = false;
+    std::vector<Vector2> preview;
+    preview.reserve(kPreviewSteps / kPreviewSampleEvery);
+    bool previewRefined = false;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_R)) {
@@ -185,9 +353,11 @@ int main() {
             timeScale = 1.0f;
             burn = {};
             paused = true;
+            adaptive.step = 0.0f;
         }
         if (IsKeyPressed(KEY_SPACE)) paused = !paused;
         if (IsKeyPressed(KEY_F)) followCraft = !followCraft;
+        if (IsKeyPressed(KEY_I)) method = astro_integrate::NextMethod(method);
         if (IsKeyPressed(KEY_ENTER)) {
             craft.vel = Vector2Add(craft.vel, burn);
             burn = {};
@@ -214,17 +384,20 @@ int main() {
         if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) draggingBurn = false;
 
         if (!paused) {
-            const int steps = std::max(1, static_cast<int>(std::ceil(timeScale * GetFrameTime() / kDt)));
-            const float dt = timeScale * GetFrameTime() / static_cast<float>(steps);
-            for (int i = 0; i < steps; ++i) {
-                StepCraft(&craft, dt);
-                simTime += dt;
-            }
+            const float frameAdvance = timeScale * GetFrameTime();
+            AdvanceCraft(&craft, frameAdvance, method, &adaptive);
+            simTime += frameAdvance;
             trail.push_back(craft.pos);
             if (static_cast<int>(trail.size()) > kTrailMax) trail.erase(trail.begin());
         }
 
-        std::vector<Vector2> preview = BuildPreview(craft, burn);
+        const PreviewRequest request{craft, burn, method};
+        if (!requestedOnce || !SameRequest(request, lastRequest)) {
+            previewWorker.Submit(request);
+            lastRequest = request;
+            requestedOnce = true;
+        }
+        previewWorker.TakeLatest(&preview, &previewRefined);
 
         BeginDrawing();
         ClearBackground(Color{5, 9, 18, 255});
@@ -241,8 +414,9 @@ int main() {
         DrawCircleV(sun, 18.0f, Color{255, 190, 70, 255});
         DrawCircleLinesV(sun, 26.0f, Color{255, 225, 135, 135});
 
+        ephemeris.Positions(astro_ephem::kJ2000 + simTime * kDaysPerTimeUnit, &planetAu);
         for (const Planet& planet : planets) {
-            const Vector2 p = PlanetPosition(planet, simTime);
+            const Vector2 p = PlanetPosition(planet, planetAu);
             const Vector2 s = WorldToScreen(p, camera, scale);
             DrawCircleV(s, planet.visualRadius, planet.color);
             DrawCircleLinesV(s, planet.visualRadius + 9.0f, Color{planet.color.r, planet.color.g, planet.color.b, 70});
@@ -264,11 +438,14 @@ int main() {
         }
 
         DrawText("Drag from spacecraft to draw a maneuver. Green path previews the trajectory.", 54, 52, 20, RAYWHITE);
-        DrawText("Mouse wheel zoom  +/- time warp  SPACE pause  ENTER apply burn  F follow  R reset", 54, kScreenHeight - 48, 18, Color{182, 195, 212, 255});
-        DrawHud(simTime, timeScale, burn, paused, followCraft, zoom);
+        DrawText("Mouse wheel zoom  +/- time warp  SPACE pause  ENTER apply burn  F follow  I integrator  R reset", 54, kScreenHeight - 48, 18, Color{182, 195, 212, 255});
+        DrawHud(simTime, timeScale, burn, paused, followCraft, zoom, method, previewRefined);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,10 +1,21 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/lod.h"
+#include "../common/profiler.h"
+#include "../common/vegas.h"
+
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -27,6 +38,14 @@ enum class RateModel {
     kWeakSuppressed
 };
 
+// Which differential cross section VEGAS integrates for a process.
+enum class CrossSection {
+    kGammaZToMuons,
+    kCompton,
+    kChargedCurrent,
+    kGluonFusionHiggs
+};
+
 enum class Stage {
     kIncoming,
     kMediator,
@@ -63,6 +82,7 @@ struct FeynmanProcess {
     float resonanceWidth;
     float baseCoupling;
     RateModel rateModel;
+    CrossSection crossSection;
     std::vector<Vector2> nodes;
     std::vector<DiagramEdge> edges;
     std::vector<int> vertexNodeIndices;
@@ -145,7 +165,7 @@ Vector3 ArrowBaseDirection(const Vector3& start, const Vector3& end, bool forwar
 }
 
 void DrawTubeSegment(const Vector3& a, const Vector3& b, float radius, Color color) {
-    DrawCylinderEx(a, b, radius, radius, 8, color);
+    astro_render::DrawCylinderLod(a, b, radius, radius, 8, color);
 }
 
 void DrawArrowHead3D(const Vector3& start, const Vector3& end, bool forwardArrow, float radius, Color color) {
@@ -153,7 +173,7 @@ void DrawArrowHead3D(const Vector3& start, const Vector3& end, bool forwardArrow
     const Vector3 tip = WorldLerp(start, end, t);
     const Vector3 dir = Vector3Normalize(ArrowBaseDirection(start, end, forwardArrow));
     const Vector3 base = Vector3Add(tip, Vector3Scale(dir, -0.34f));
-    DrawCylinderEx(base, tip, radius * 1.85f, 0.0f, 10, color);
+    astro_render::DrawCylinderLod(base, tip, radius * 1.85f, 0.0f, 10, color);
 }
 
 std::vector<Vector3> BuildStyledPath(const DiagramEdge& edge, const std::vector<Vector2>& nodes) {
@@ -209,8 +229,7 @@ std::vector<Vector3> BuildStyledPath(const DiagramEdge& edge, const std::vector<
     return points;
 }
 
-void DrawStyledEdge3D(const DiagramEdge& edge, const std::vector<Vector2>& nodes, bool active) {
-    const std::vector<Vector3> points = BuildStyledPath(edge, nodes);
+void DrawStyledEdge3D(const DiagramEdge& edge, const std::vector<Vector3>& points, const std::vector<Vector2>& nodes, bool active) {
     const float radius = active ? 0.045f : 0.028f;
     Color color = active ? edge.color : WithAlpha(edge.color, 125);
 
@@ -271,15 +290,15 @@ void DrawPacket3D(const DiagramEdge& edge, const std::vector<Vector2>& nodes, fl
     if (edge.style == ParticleStyle::kScalar) radius = 0.1f;
     if (edge.style == ParticleStyle::kGluon) radius = 0.14f;
 
-    DrawSphere(pos, radius * 1.8f, WithAlpha(edge.color, 40));
-    DrawSphere(pos, radius, edge.color);
+    astro_render::DrawSphereLod(pos, radius * 1.8f, WithAlpha(edge.color, 40));
+    astro_render::DrawSphereLod(pos, radius, edge.color);
     DrawSphereWires(pos, radius * 1.35f, 8, 8, WithAlpha(edge.color, 110));
 }
 
 void DrawVertexGlow3D(const Vector3& center, float pulse) {
     const float r = 0.12f + 0.18f * pulse;
-    DrawSphere(center, r * 1.85f, WithAlpha(Color{255, 231, 155, 255}, static_cast<unsigned char>(80.0f * pulse)));
-    DrawSphere(center, r, Color{255, 241, 184, 255});
+    astro_render::DrawSphereLod(center, r * 1.85f, WithAlpha(Color{255, 231, 155, 255}, static_cast<unsigned char>(80.0f * pulse)));
+    astro_render::DrawSphereLod(center, r, Color{255, 241, 184, 255});
     DrawSphereWires(center, r * 1.6f, 10, 10, WithAlpha(Color{255, 214, 130, 255}, static_cast<unsigned char>(180.0f * pulse)));
 }
 
@@ -328,6 +347,330 @@ float RelativeRate(const FeynmanProcess& process, float energyGeV, float couplin
     return std::clamp(process.baseCoupling * couplingScale * response, 0.0f, 1.0f);
 }
 
+// Physical cross sections for the process list, integrated by VEGAS over each final
+// state's phase space. Every integrand also folds in a Gaussian spread of the collision
+// energy (kEnergySpread, sampled over +-4 sigma) so the narrow Higgs line has a finite
+// height, and the e+e- channel includes initial-state radiation. Integrands see SoA
+// batches and evaluate them in plain loops. Results are in pb.
+constexpr double kGeV2ToPb = 3.8937937e8;
+constexpr double kAlpha = 1.0 / 137.035999;
+constexpr double kAlphaZ = 1.0 / 128.9;  // alpha(M_Z) for the electroweak Born terms
+constexpr double kElectronMass = 0.000510999;
+constexpr double kZMass = 91.1876;
+constexpr double kZWidth = 2.4952;
+constexpr double kSin2Weinberg = 0.2312;
+constexpr double kFermi = 1.1663788e-5;
+constexpr double kWMass = 80.377;
+constexpr double kWWidth = 2.085;
+constexpr double kVud2 = 0.9484;
+constexpr double kHiggsMass = 125.1;
+constexpr double kHiggsWidth = 0.0041;
+constexpr double kHiggsToGluons = 0.0818;
+constexpr double kHiggsToPhotons = 0.00227;
+constexpr double kEnergySpread = 0.002;  // relative, 1 sigma
+constexpr double kMinRadiativeFraction = 0.01;  // ISR keeps s' / s above this
+constexpr double kPiD = 3.14159265358979323846;
+
+// Maps u in (0, 1) to a collision energy around `energy`; returns its Gaussian weight.
+inline double SpreadEnergy(double u, double energy, double* spreadEnergy) {
+    const double z = 8.0 * u - 4.0;
+    *spreadEnergy = energy * (1.0 + kEnergySpread * z);
+    return 8.0 * std::exp(-0.5 * z * z) / (std::sqrt(2.0 * kPiD) * 0.99993666);
+}
+
+int CrossSectionDims(CrossSection model) { return model == CrossSection::kGammaZToMuons ? 3 : 2; }
+
+// e+e- -> gamma*/Z -> mu+mu- (massless Born with gamma-Z interference) convolved with
+// the leading-log electron structure function beta (1 - x)^(beta - 1) (1 + 3 beta / 4).
+// x = (u0: 1 - x = u^(1/beta), which absorbs the soft-photon pole), cos(theta) = u1,
+// energy spread = u2.
+void GammaZBatch(const astro_mc::VegasBatch& batch, double energy) {
+    const double ve = -0.5 + 2.0 * kSin2Weinberg, ae = -0.5;
+    const double kappa = 1.0 / (4.0 * kSin2Weinberg * (1.0 - kSin2Weinberg));
+    const double m2 = kZMass * kZMass, mg2 = m2 * kZWidth * kZWidth;
+    const double vv = (ve * ve + ae * ae) * (ve * ve + ae * ae);
+    for (int i = 0; i < batch.count; ++i) {
+        double e;
+        const double spread = SpreadEnergy(batch.x[2][i], energy, &e);
+        const double s = e * e;
+        const double beta = 2.0 * kAlpha / kPiD * (std::log(s / (kElectronMass * kElectronMass)) - 1.0);
+        const double x = 1.0 - std::pow(batch.x[0][i], 1.0 / beta);
+        const double sh = x * s;
+        const double c = 2.0 * batch.x[1][i] - 1.0;
+        const double d = (sh - m2) * (sh - m2) + mg2;
+        const double reChi = kappa * sh * (sh - m2) / d;
+        const double chi2 = kappa * kappa * sh * sh / d;
+        const double dOmega = kAlphaZ * kAlphaZ / (4.0 * sh) *
+                              ((1.0 + c * c) * (1.0 + 2.0 * ve * ve * reChi + vv * chi2) +
+                               2.0 * c * (2.0 * ae * ae * reChi + 4.0 * ve * ae * ve * ae * chi2));
+        const double isr = 1.0 + 0.75 * beta;
+        batch.f[i] = x > kMinRadiativeFraction ? 2.0 * 2.0 * kPiD * dOmega * isr * spread * kGeV2ToPb : 0.0;
+    }
+}
+
+// e- gamma -> e- gamma with the electron mass (Klein-Nishina in invariants). The
+// backward u-channel pole is mapped logarithmically in w = m^2 - u; u0 = log w, u1 = spread.
+void ComptonBatch(const astro_mc::VegasBatch& batch, double energy) {
+    const double m2 = kElectronMass * kElectronMass;
+    const double e4 = 16.0 * kPiD * kPiD * kAlpha * kAlpha;
+    for (int i = 0; i < batch.count; ++i) {
+        double e;
+        const double spread = SpreadEnergy(batch.x[1][i], energy, &e);
+        const double s = e * e;
+        const double sm = s - m2;
+        const double wMin = sm * m2 / s, wMax = sm;
+        const double span = std::log(wMax / wMin);
+        const double w = wMin * std::exp(span * batch.x[0][i]);
+        const double pk = 0.5 * sm, pkPrime = 0.5 * w;
+        const double inv = 1.0 / pk - 1.0 / pkPrime;
+        const double amplitude2 = 2.0 * e4 * (pkPrime / pk + pk / pkPrime + 2.0 * m2 * inv + m2 * m2 * inv * inv);
+        batch.f[i] = amplitude2 / (16.0 * kPiD * sm * sm) * w * span * spread * kGeV2ToPb;
+    }
+}
+
+// d u-bar -> W- -> e- nu-bar at parton level: (G_F M_W^2)^2 s (1 + cos)^2 / (48 pi |D|^2),
+// colour averaged. u0 = cos(theta), u1 = spread.
+void ChargedCurrentBatch(const astro_mc::VegasBatch& batch, double energy) {
+    const double m2 = kWMass * kWMass, mg2 = m2 * kWWidth * kWWidth;
+    const double coupling = kFermi * kFermi * m2 * m2 * kVud2 / (48.0 * kPiD);
+    for (int i = 0; i < batch.count; ++i) {
+        double e;
+        const double spread = SpreadEnergy(batch.x[1][i], energy, &e);
+        const double s = e * e;
+        const double c = 2.0 * batch.x[0][i] - 1.0;
+        const double d = (s - m2) * (s - m2) + mg2;
+        batch.f[i] = 2.0 * coupling * s * (1.0 + c) * (1.0 + c) / d * spread * kGeV2ToPb;
+    }
+}
+
+// g g -> H -> gamma gamma through a relativistic Breit-Wigner with the gluon spin and
+// colour averages: pi M^2 Gamma_gg Gamma_yy / (2 s |D|^2), isotropic. u0 = cos, u1 = spread.
+void HiggsBatch(const astro_mc::VegasBatch& batch, double energy) {
+    const double m2 = kHiggsMass * kHiggsMass, mg2 = m2 * kHiggsWidth * kHiggsWidth;
+    const double partial = kHiggsWidth * kHiggsWidth * kHiggsToGluons * kHiggsToPhotons;
+    for (int i = 0; i < batch.count; ++i) {
+        double e;
+        const double spread = SpreadEnergy(batch.x[1][i], energy, &e);
+        const double s = e * e;
+        const double d = (s - m2) * (s - m2) + mg2;
+        batch.f[i] = kPiD * m2 * partial / (2.0 * s * d) * spread * kGeV2ToPb;
+    }
+}
+
+void EvaluateCrossSection(CrossSection model, const astro_mc::VegasBatch& batch, double energy) {
+    switch (model) {
+        case CrossSection::kGammaZToMuons: GammaZBatch(batch, energy); break;
+        case CrossSection::kCompton: ComptonBatch(batch, energy); break;
+        case CrossSection::kChargedCurrent: ChargedCurrentBatch(batch, energy); break;
+        case CrossSection::kGluonFusionHiggs: HiggsBatch(batch, energy); break;
+    }
+}
+
+struct SigmaPoint {
+    float energy = 0.0f;
+    double sigma = 0.0;  // pb
+    double error = 0.0;
+};
+
+struct SigmaCurve {
+    std::vector<SigmaPoint> points;  // ascending energy
+    int planned = 0;
+    bool complete() const { return planned > 0 && static_cast<int>(points.size()) == planned; }
+};
+
+// Energies for one process: a uniform sweep plus a cluster around its resonance.
+std::vector<float> SweepEnergies(const FeynmanProcess& process) {
+    constexpr int kUniform = 96;
+    constexpr int kResonance = 32;
+    std::vector<float> energies;
+    for (int i = 0; i < kUniform; ++i) energies.push_back(process.energyMin + (process.energyMax - process.energyMin) * i / (kUniform - 1));
+    double mass = 0.0, width = 0.0;
+    if (process.crossSection == CrossSection::kGammaZToMuons) mass = kZMass, width = kZWidth;
+    if (process.crossSection == CrossSection::kChargedCurrent) mass = kWMass, width = kWWidth;
+    if (process.crossSection == CrossSection::kGluonFusionHiggs) mass = kHiggsMass, width = kHiggsWidth;
+    if (mass > 0.0) {
+        const double step = 0.35 * std::max(width, kEnergySpread * mass);
+        for (int k = 0; k < kResonance; ++k) {
+            const float e = static_cast<float>(mass + step * (k - kResonance / 2 + 0.5));
+            if (e > process.energyMin && e < process.energyMax) energies.push_back(e);
+        }
+    }
+    std::sort(energies.begin(), energies.end());
+    return energies;
+}
+
+// One sigma(sqrt s) point: grid warm-up iterations that are thrown away, then
+// accumulated ones until the running error drops below the target.
+astro_mc::VegasEstimate IntegratePoint(CrossSection model, double energy, astro_mc::VegasIntegrator* vegas,
+                                       astro_parallel::ThreadPool& pool) {
+    constexpr int kWarmupIterations = 3;
+    constexpr int kMaxIterations = 12;
+    constexpr double kTargetRelativeError = 0.003;
+    const auto integrand = [model, energy](const astro_mc::VegasBatch& batch) { EvaluateCrossSection(model, batch, energy); };
+    for (int i = 0; i < kWarmupIterations; ++i) vegas->Iterate(integrand, pool, false);
+    vegas->ResetEstimate();
+    for (int i = 0; i < kMaxIterations; ++i) {
+        vegas->Iterate(integrand, pool);
+        if (i >= 2 && vegas->estimate().relativeError() < kTargetRelativeError) break;
+    }
+    return vegas->estimate();
+}
+
+// Fills sigma(sqrt s) curves on a worker thread with a private pool. The requested
+// process goes first and preempts a sweep in progress; the others are filled afterwards
+// so switching tabs finds them cached. Each energy warm-starts from the previous
+// energy's VEGAS grid. Snapshot()
+// copies a curve when it has changed; all public calls belong to the render thread.
+class CrossSectionSweep {
+  public:
+    explicit CrossSectionSweep(const std::vector<FeynmanProcess>& processes) : processes_(processes), curves_(processes.size()) {
+        for (size_t i = 0; i < processes_.size(); ++i) curves_[i].planned = static_cast<int>(SweepEnergies(processes_[i]).size());
+        versions_.assign(processes.size(), 0);
+    }
+    ~CrossSectionSweep() { Stop(); }
+
+    CrossSectionSweep(const CrossSectionSweep&) = delete;
+    CrossSectionSweep& operator=(const CrossSectionSweep&) = delete;
+
+    void Request(int process) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            priority_ = process;
+        }
+        if (!worker_.joinable()) worker_ = std::thread([this]() { WorkerLoop(); });
+        wake_.notify_one();
+    }
+
+    bool Snapshot(int process, uint64_t* version, SigmaCurve* out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (versions_[static_cast<size_t>(process)] == *version) return false;
+        *version = versions_[static_cast<size_t>(process)];
+        *out = curves_[static_cast<size_t>(process)];
+        return true;
+    }
+
+    int threads() const { return threads_; }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+  private:
+    void WorkerLoop() {
+        astro_parallel::ThreadPool pool(threads_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            int next = -1;
+            wake_.wait(lock, [&]() {
+                next = NextProcess();
+                return stop_ || next >= 0;
+            });
+            if (stop_) return;
+            const int current = next;
+            const size_t resume = curves_[static_cast<size_t>(current)].points.size();
+            lock.unlock();
+
+            const FeynmanProcess& process = processes_[static_cast<size_t>(current)];
+            const std::vector<float> energies = SweepEnergies(process);
+            astro_mc::VegasIntegrator vegas(CrossSectionDims(process.crossSection));
+            for (size_t i = resume; i < energies.size(); ++i) {
+                const astro_mc::VegasEstimate estimate = IntegratePoint(process.crossSection, energies[i], &vegas, pool);
+                std::lock_guard<std::mutex> publish(mutex_);
+                curves_[static_cast<size_t>(current)].points.push_back(SigmaPoint{energies[i], estimate.value, estimate.error});
+                ++versions_[static_cast<size_t>(current)];
+                // A newly selected process preempts this one; it resumes here later.
+                if (stop_ || NextProcess() != current) break;
+            }
+            lock.lock();
+        }
+    }
+
+    // Requested process first, then any other unfinished one; -1 when all are done.
+    int NextProcess() const {
+        if (priority_ >= 0 && !curves_[static_cast<size_t>(priority_)].complete()) return priority_;
+        for (size_t i = 0; i < curves_.size(); ++i) {
+            if (!curves_[i].complete()) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    const std::vector<FeynmanProcess>& processes_;
+    const int threads_ = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<SigmaCurve> curves_;
+    std::vector<uint64_t> versions_;
+    int priority_ = -1;
+    bool stop_ = false;
+};
+
+// Log-linear interpolation of the cached curve; false until the energy is bracketed.
+bool InterpolateSigma(const SigmaCurve& curve, float energy, double* sigma, double* error) {
+    const std::vector<SigmaPoint>& p = curve.points;
+    for (size_t i = 1; i < p.size(); ++i) {
+        if (p[i].energy < energy) continue;
+        if (p[i - 1].energy > energy) return false;
+        const double t = (energy - p[i - 1].energy) / std::max(1e-6f, p[i].energy - p[i - 1].energy);
+        const double a = std::max(p[i - 1].sigma, 1e-30), b = std::max(p[i].sigma, 1e-30);
+        *sigma = a * std::pow(b / a, t);
+        *error = *sigma * ((1.0 - t) * p[i - 1].error / a + t * p[i].error / b);
+        return true;
+    }
+    return false;
+}
+
+std::string FormatCrossSection(double pb) {
+    char text[48];
+    if (pb >= 1.0e3) {
+        std::snprintf(text, sizeof(text), "%.3g nb", pb * 1.0e-3);
+    } else if (pb >= 1.0) {
+        std::snprintf(text, sizeof(text), "%.3g pb", pb);
+    } else {
+        std::snprintf(text, sizeof(text), "%.3g fb", pb * 1.0e3);
+    }
+    return text;
+}
+
+void DrawSigmaPanel(const SigmaCurve& curve, float energyGeV, const FeynmanProcess& process, Rectangle panel) {
+    DrawRectangleRounded(panel, 0.06f, 18, Color{11, 19, 31, 214});
+    DrawRectangleRoundedLinesEx(panel, 0.06f, 18, 2.0f, Color{49, 79, 113, 255});
+    DrawText("sigma(sqrt s)  VEGAS", static_cast<int>(panel.x + 18), static_cast<int>(panel.y + 12), 16, Color{174, 190, 214, 255});
+    const Rectangle plot = {panel.x + 18.0f, panel.y + 38.0f, panel.width - 36.0f, panel.height - 70.0f};
+    DrawRectangleLinesEx(plot, 1.0f, Color{40, 64, 92, 255});
+    if (curve.points.size() >= 2) {
+        double lo = 1e300, hi = 0.0;
+        for (const SigmaPoint& p : curve.points) {
+            if (p.sigma <= 0.0) continue;
+            lo = std::min(lo, p.sigma);
+            hi = std::max(hi, p.sigma);
+        }
+        if (hi > 0.0) {
+            const double logLo = std::log10(lo) - 0.1, logHi = std::log10(hi) + 0.1;
+            auto px = [&](float e) { return plot.x + plot.width * (e - process.energyMin) / (process.energyMax - process.energyMin); };
+            auto py = [&](double sigma) {
+                return plot.y + plot.height * static_cast<float>(1.0 - (std::log10(std::max(sigma, lo)) - logLo) / (logHi - logLo));
+            };
+            for (size_t i = 1; i < curve.points.size(); ++i) {
+                DrawLineEx({px(curve.points[i - 1].energy), py(curve.points[i - 1].sigma)}, {px(curve.points[i].energy), py(curve.points[i].sigma)},
+                           2.0f, Color{126, 230, 188, 255});
+            }
+            DrawText(FormatCrossSection(hi).c_str(), static_cast<int>(plot.x + 4), static_cast<int>(plot.y + 3), 12, Color{150, 170, 198, 255});
+            DrawText(FormatCrossSection(lo).c_str(), static_cast<int>(plot.x + 4), static_cast<int>(plot.y + plot.height - 15), 12,
+                     Color{150, 170, 198, 255});
+        }
+        const float cursor = plot.x + plot.width * (energyGeV - process.energyMin) / (process.energyMax - process.energyMin);
+        DrawLineEx({cursor, plot.y}, {cursor, plot.y + plot.height}, 1.0f, Color{255, 226, 146, 200});
+    }
+    const char* status = curve.complete() ? "cached" : TextFormat("integrating %d / %d", static_cast<int>(curve.points.size()), curve.planned);
+    DrawText(status, static_cast<int>(panel.x + 18), static_cast<int>(panel.y + panel.height - 24), 14, Color{150, 170, 198, 255});
+}
+
 std::vector<FeynmanProcess> BuildProcesses() {
     std::vector<FeynmanProcess> processes;
 
@@ -343,6 +686,7 @@ std::vector<FeynmanProcess> BuildProcesses() {
         10.0f,
         0.88f,
         RateModel::kResonantSChannel,
+        CrossSection::kGammaZToMuons,
         {
             {180.0f, 290.0f}, {180.0f, 570.0f}, {520.0f, 430.0f},
             {860.0f, 430.0f}, {1200.0f, 290.0f}, {1200.0f, 570.0f},
@@ -370,6 +714,7 @@ std::vector<FeynmanProcess> BuildProcesses() {
         1.0f,
         0.82f,
         RateModel::kQEDScattering,
+        CrossSection::kCompton,
         {
             {180.0f, 540.0f}, {180.0f, 260.0f}, {520.0f, 430.0f},
             {860.0f, 430.0f}, {1200.0f, 260.0f}, {1200.0f, 540.0f},
@@ -397,6 +742,7 @@ std::vector<FeynmanProcess> BuildProcesses() {
         12.0f,
         0.54f,
         RateModel::kWeakSuppressed,
+        CrossSection::kChargedCurrent,
         {
             {180.0f, 430.0f}, {520.0f, 430.0f}, {820.0f, 560.0f},
             {1180.0f, 250.0f}, {1180.0f, 470.0f}, {1180.0f, 650.0f},
@@ -424,6 +770,7 @@ std::vector<FeynmanProcess> BuildProcesses() {
         7.0f,
         0.76f,
         RateModel::kResonantSChannel,
+        CrossSection::kGluonFusionHiggs,
         {
             {180.0f, 290.0f}, {180.0f, 570.0f}, {520.0f, 430.0f},
             {860.0f, 430.0f}, {1200.0f, 290.0f}, {1200.0f, 570.0f},
@@ -442,6 +789,21 @@ std::vector<FeynmanProcess> BuildProcesses() {
     return processes;
 }
 
+// Edge geometry depends only on the static diagram, so each process's styled paths are
+// built once, indexed like its edges.
+using EdgePaths = std::vector<std::vector<Vector3>>;
+
+std::vector<EdgePaths> BuildEdgePaths(const std::vector<FeynmanProcess>& processes) {
+    std::vector<EdgePaths> paths;
+    paths.reserve(processes.size());
+    for (const FeynmanProcess& process : processes) {
+        EdgePaths& edges = paths.emplace_back();
+        edges.reserve(process.edges.size());
+        for (const DiagramEdge& edge : process.edges) edges.push_back(BuildStyledPath(edge, process.nodes));
+    }
+    return paths;
+}
+
 void DrawBackdrop3D() {
     DrawPlane({0.0f, -4.2f, 0.0f}, {28.0f, 18.0f}, Color{8, 12, 20, 255});
 
@@ -465,7 +827,33 @@ void DrawBackdrop3D() {
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 8, 0.0f);
+    if (bench.enabled) {
+        // One cross section per process at its default energy, each from a cold grid.
+        const std::vector<FeynmanProcess> processes = BuildProcesses();
+        double checksum = 0.0;
+        return astro_bench::RunBench(
+            "feynman_diagram_simulator", bench,
+            [&](float) {
+                for (const FeynmanProcess& process : processes) {
+                    astro_mc::VegasIntegrator vegas(CrossSectionDims(process.crossSection));
+                    const astro_mc::VegasEstimate estimate =
+                        IntegratePoint(process.crossSection, process.defaultEnergy, &vegas, astro_parallel::SharedPool());
+                    checksum += estimate.value;
+                }
+            },
+            [&]() {
+                for (const FeynmanProcess& process : processes) {
+                    astro_mc::VegasIntegrator vegas(CrossSectionDims(process.crossSection));
+                    const astro_mc::VegasEstimate e = IntegratePoint(process.crossSection, process.defaultEnergy, &vegas, astro_parallel::SharedPool());
+                    std::fprintf(stderr, "%-24s %7.1f GeV  sigma = %.5g +- %.2g pb  chi2/dof %.2f  %d it\n", process.name, process.defaultEnergy,
+                                 e.value, e.error, e.chi2PerDof, e.iterations);
+                }
+                return checksum;
+            });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Feynman Diagram Simulator 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -481,6 +869,7 @@ int main() {
     float camDistance = 16.0f;
 
     std::vector<FeynmanProcess> processes = BuildProcesses();
+    const std::vector<EdgePaths> edgePaths = BuildEdgePaths(processes);
     int selectedProcess = 0;
     float energyGeV = processes[selectedProcess].defaultEnergy;
     float couplingScale = 1.0f;
@@ -489,10 +878,18 @@ int main() {
     bool autoReplay = true;
     bool showHelp = false;
 
+    CrossSectionSweep sweep(processes);
+    sweep.Request(selectedProcess);
+    SigmaCurve sigmaCurve;
+    uint64_t sigmaVersion = 0;
+
     auto selectProcess = [&](int index) {
         selectedProcess = (index + static_cast<int>(processes.size())) % static_cast<int>(processes.size());
         energyGeV = processes[selectedProcess].defaultEnergy;
         simTime = 0.0f;
+        sweep.Request(selectedProcess);
+        sigmaCurve = SigmaCurve{};
+        sigmaVersion = 0;
     };
 
     while (!WindowShouldClose()) {
@@ -545,6 +942,9 @@ int main() {
         }
 
         const float eventRate = RelativeRate(process, energyGeV, couplingScale);
+        sweep.Snapshot(selectedProcess, &sigmaVersion, &sigmaCurve);
+        double sigma = 0.0, sigmaError = 0.0;
+        const bool haveSigma = InterpolateSigma(sigmaCurve, energyGeV, &sigma, &sigmaError);
         const Stage stage = CurrentStage(simTime);
 
         BeginDrawing();
@@ -556,9 +956,11 @@ int main() {
         BeginMode3D(camera);
         DrawBackdrop3D();
 
-        for (const DiagramEdge& edge : process.edges) {
+        const EdgePaths& paths = edgePaths[static_cast<size_t>(selectedProcess)];
+        for (std::size_t e = 0; e < process.edges.size(); ++e) {
+            const DiagramEdge& edge = process.edges[e];
             const bool active = PhaseActive(edge.phase, simTime);
-            DrawStyledEdge3D(edge, process.nodes, active);
+            DrawStyledEdge3D(edge, paths[e], process.nodes, active);
             if (active) DrawPacket3D(edge, process.nodes, PhaseProgress(edge.phase, simTime));
         }
 
@@ -585,7 +987,7 @@ int main() {
         DrawText(process.reaction, 24, 94, 18, Color{125, 219, 255, 255});
         DrawText(process.description, 24, kScreenHeight - 62, 16, Color{166, 184, 208, 255});
 
-        Rectangle stats{1088.0f, 78.0f, 266.0f, 130.0f};
+        Rectangle stats{1088.0f, 78.0f, 266.0f, 156.0f};
         DrawRectangleRounded(stats, 0.08f, 18, Color{11, 19, 31, 214});
         DrawRectangleRoundedLinesEx(stats, 0.08f, 18, 2.0f, Color{49, 79, 113, 255});
         DrawText("stage", 1106, 96, 16, Color{174, 190, 214, 255});
@@ -596,16 +998,22 @@ int main() {
         DrawText((FormatFloat(energyGeV, 1) + " GeV").c_str(), 1188, 148, 16, Color{125, 219, 255, 255});
         DrawText("coupling", 1106, 174, 16, Color{174, 190, 214, 255});
         DrawText(FormatFloat(couplingScale).c_str(), 1188, 174, 16, Color{255, 191, 114, 255});
+        DrawText("sigma", 1106, 200, 16, Color{174, 190, 214, 255});
+        DrawText(haveSigma ? (FormatCrossSection(sigma) + " +- " + FormatFloat(static_cast<float>(100.0 * sigmaError / std::max(sigma, 1e-30)), 1) + "%").c_str()
+                           : "integrating...",
+                 1188, 200, 16, Color{126, 230, 188, 255});
 
-        Rectangle checks{1088.0f, 220.0f, 266.0f, 104.0f};
+        Rectangle checks{1088.0f, 246.0f, 266.0f, 104.0f};
         DrawRectangleRounded(checks, 0.08f, 18, Color{11, 19, 31, 198});
         DrawRectangleRoundedLinesEx(checks, 0.08f, 18, 2.0f, Color{49, 79, 113, 255});
         for (std::size_t i = 0; i < process.checks.size(); ++i) {
-            const int y = 238 + static_cast<int>(i) * 24;
+            const int y = 264 + static_cast<int>(i) * 24;
             DrawCircle(1104, y + 7, 5, process.checks[i].valid ? Color{90, 206, 132, 255} : Color{224, 92, 92, 255});
             DrawText(process.checks[i].label, 1118, y, 15, Color{206, 216, 232, 255});
         }
 
+        DrawSigmaPanel(sigmaCurve, energyGeV, process, {1088.0f, 362.0f, 266.0f, 190.0f});
+
         for (const DiagramEdge& edge : process.edges) {
             const Vector3 a = DiagramToWorld(process.nodes[edge.from]);
             const Vector3 b = DiagramToWorld(process.nodes[edge.to]);
@@ -630,9 +1038,13 @@ int main() {
         }
 
         DrawFPS(kScreenWidth - 92, 16);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    sweep.Stop();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,7 +1,15 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "rlgl.h"
+
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
+#include "../common/scalar_field_lattice.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -13,6 +21,24 @@ namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 
+constexpr float kSpan = 5.4f;          // the lattice covers [-kSpan, kSpan]^2 in world units
+constexpr float kBoxLength = 48.0f;    // the same square in field units, ~35 kink widths
+constexpr float kWorldPerField = 2.0f * kSpan / kBoxLength;
+constexpr float kFieldRate = 3.0f;     // field time per second
+constexpr int kMaxStepsPerFrame = 16;  // past this the field slows down instead of the frame rate
+constexpr int kProfileSamples = 160;
+constexpr uint64_t kNoiseSeed = 0x48164Full;
+constexpr std::array<int, 3> kLatticeSizes = {256, 512, 1024};
+constexpr float kStatsInterval = 0.5f;
+
+// Field parameters for either phase; the scene flips mu2 to quench.
+astro_field::Phi4Params FieldParams(bool broken, float damping) {
+    astro_field::Phi4Params params;
+    params.mu2 = broken ? 1.0f : -1.0f;
+    params.damping = damping;
+    return params;
+}
+
 struct Traveler {
     float x;
     float z;
@@ -42,31 +68,138 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     camera->position = Vector3Add(camera->target, offset);
 }
 
-float HiggsFieldValue(float x, float z, float t, float vev, bool pulseActive, float pulseTime) {
-    float background = 0.06f * std::sin(0.8f * x + 1.1f * z - 1.9f * t);
-    float pulse = 0.0f;
-    if (pulseActive) {
-        float r = std::sqrt(x * x + z * z);
-        float envelope = 0.65f * std::exp(-0.9f * pulseTime) * std::exp(-0.45f * r);
-        pulse = envelope * std::sin(8.5f * r - 6.0f * pulseTime);
+// The lattice on the CPU, optionally mirrored on the GPU. While the GPU copy is live it
+// owns the state and the CPU lattice is refreshed from it only for edits and stats.
+struct HiggsField {
+    astro_field::Phi4Lattice lattice;
+    astro_field::Phi4GpuLattice gpu;
+    bool useGpu = false;
+    bool broken = true;
+    float damping = 0.3f;
+    uint64_t edits = 0;
+    std::array<std::vector<float>, 2> rows;  // phi along the two tracks, GPU mode only
+};
+
+int TrackRow(const astro_field::Phi4Lattice& lattice, float z) {
+    return std::clamp(static_cast<int>((z / kWorldPerField + 0.5f * kBoxLength) / lattice.dx()), 0, lattice.size() - 1);
+}
+
+// Runs an edit on the CPU lattice, bringing the state over from the GPU and back.
+template <typename Edit>
+void EditField(HiggsField* field, Edit&& edit) {
+    if (field->useGpu) field->gpu.Download(&field->lattice);
+    edit(field->lattice);
+    field->lattice.SetParams(FieldParams(field->broken, field->damping));
+    if (field->useGpu) field->gpu.Upload(field->lattice);
+    ++field->edits;
+}
+
+void ConfigureField(HiggsField* field, int n) {
+    field->lattice.Configure(n, kBoxLength, FieldParams(field->broken, field->damping));
+    field->lattice.Thermalize(field->broken ? 1.0f : 0.0f, 0.02f, kNoiseSeed);
+    if (field->gpu.ready() && field->gpu.size() != n && !field->gpu.Init(n)) field->useGpu = false;
+    if (field->useGpu) field->gpu.Upload(field->lattice);
+}
+
+// Symmetric -> broken is the quench; the way back reheats the field to give the next
+// quench fluctuations to grow from.
+void TogglePhase(HiggsField* field) {
+    field->broken = !field->broken;
+    const bool reheat = !field->broken;
+    EditField(field, [&](astro_field::Phi4Lattice& lattice) {
+        if (reheat) lattice.Thermalize(0.0f, 0.25f, kNoiseSeed + field->edits);
+    });
+}
+
+void StepField(HiggsField* field, float frameDt) {
+    const float want = std::min(frameDt, 0.05f) * kFieldRate;
+    const float maxDt = field->lattice.maxDt();
+    const int steps = std::clamp(static_cast<int>(std::ceil(want / maxDt)), 1, kMaxStepsPerFrame);
+    const float dt = std::min(maxDt, want / static_cast<float>(steps));
+    const astro_field::Phi4Params params = FieldParams(field->broken, field->damping);
+    if (field->useGpu) {
+        field->gpu.Step(params, field->lattice.dx(), dt, steps);
+    } else {
+        field->lattice.SetParams(params);
+        for (int s = 0; s < steps; ++s) field->lattice.Step(dt);
     }
-    return std::max(0.1f, vev + background + pulse);
 }
 
-std::string HudLine(float strongCoupling, float masslessSpeed, float massiveSpeed, bool paused, bool pulseActive) {
+// phi at world (x, z); on the GPU only the two track rows are read back.
+float FieldAt(const HiggsField& field, float x, float z, int track) {
+    if (!field.useGpu) return field.lattice.Sample(x / kWorldPerField, z / kWorldPerField);
+    const std::vector<float>& row = field.rows[static_cast<size_t>(track)];
+    const float g = std::clamp((x / kWorldPerField + 0.5f * kBoxLength) / field.lattice.dx() - 0.5f, 0.0f, static_cast<float>(row.size() - 1));
+    const size_t i = std::min(static_cast<size_t>(g), row.size() - 2);
+    return row[i] + (g - static_cast<float>(i)) * (row[i + 1] - row[i]);
+}
+
+void UpdateFieldTexture(const HiggsField& field, std::vector<Color>* pixels, Texture2D texture) {
+    const astro_field::Phi4Lattice& lattice = field.lattice;
+    const float vev = lattice.params().vev();
+    pixels->resize(lattice.phi().size());
+    astro_parallel::SharedPool().ParallelFor(lattice.size(), 16, [&](int begin, int end) {
+        for (size_t c = static_cast<size_t>(begin) * lattice.size(); c < static_cast<size_t>(end) * lattice.size(); ++c) {
+            (*pixels)[c] = astro_field::FieldColor(lattice.phi()[c], vev);
+        }
+    });
+    UpdateTexture(texture, pixels->data());
+}
+
+// Texel (u, v) is lattice (i, j), i along world x and j along world z.
+void DrawFieldPlane(Texture2D texture) {
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex3f(-kSpan, 0.0f, -kSpan);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex3f(-kSpan, 0.0f, kSpan);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex3f(kSpan, 0.0f, kSpan);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex3f(kSpan, 0.0f, -kSpan);
+    rlEnd();
+    rlSetTexture(0);
+}
+
+float ProfileHeight(float phi) { return 0.45f + 0.30f * phi; }
+
+std::string HudLine(float strongCoupling, float masslessSpeed, float massiveSpeed, bool paused, bool broken) {
     std::ostringstream os;
     os << std::fixed << std::setprecision(2)
        << "strong coupling=" << strongCoupling
        << "  speed(gamma-like)=" << masslessSpeed
        << "  speed(W-like)=" << massiveSpeed;
-    if (pulseActive) os << "  [field excitation active]";
+    if (!broken) os << "  [symmetric phase]";
     if (paused) os << "  [PAUSED]";
     return os.str();
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    int latticeSize = kLatticeSizes[1];
+    if (const int n = astro_bench::IntArg(argc, argv, "--lattice", 0); n > 0) latticeSize = std::clamp(n, 16, 4096);
+
+    // Headless runs time the CPU lattice through a quench: reheated symmetric noise, then
+    // the broken phase with walls forming and coarsening.
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 200, 1.0f / 60.0f);
+    if (bench.enabled) {
+        HiggsField field;
+        ConfigureField(&field, latticeSize);
+        TogglePhase(&field);
+        TogglePhase(&field);
+        return astro_bench::RunBench(
+            "higgs_field_viz", bench, [&](float dt) { StepField(&field, dt); },
+            [&]() {
+                const astro_field::LatticeStats stats = field.lattice.Measure();
+                std::fprintf(stderr, "%d^2 lattice, t=%.2f, E=%.3f, wall length %.1f, <|phi|>=%.3f\n", field.lattice.size(),
+                             field.lattice.time(), stats.energy, stats.wallLength, stats.meanAbsPhi);
+                return static_cast<float>(stats.energy);
+            });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Higgs Field Visualization 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -82,12 +215,7 @@ int main() {
     float camDistance = 14.0f;
 
     bool paused = false;
-    bool pulseActive = false;
-    float t = 0.0f;
-    float pulseTime = 0.0f;
-
     float strongCoupling = 1.05f;
-    const float vev = 1.0f;
     const float trackMinX = -5.3f;
     const float trackMaxX = 5.3f;
 
@@ -96,40 +224,87 @@ int main() {
         {trackMinX, 1.2f, strongCoupling, 2.9f, Color{255, 175, 105, 255}, "W-like (strong Higgs coupling)"},
     };
 
+    // The field is the GPU's when float render targets work, the CPU's otherwise.
+    HiggsField field;
+    field.useGpu = field.gpu.Init(latticeSize);
+    ConfigureField(&field, latticeSize);
+
+    Texture2D fieldTexture{};
+    std::vector<Color> fieldPixels;
+    const auto reloadTexture = [&]() {
+        if (fieldTexture.id != 0) UnloadTexture(fieldTexture);
+        Image image = GenImageColor(field.lattice.size(), field.lattice.size(), BLANK);
+        fieldTexture = LoadTextureFromImage(image);
+        UnloadImage(image);
+        SetTextureFilter(fieldTexture, TEXTURE_FILTER_BILINEAR);
+    };
+    reloadTexture();
+
+    astro_field::LatticeStats stats = field.lattice.Measure();
+    float statsAge = 0.0f;
+    uint64_t statsEdits = field.edits;
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_SPACE)) {
-            pulseActive = true;
-            pulseTime = 0.0f;
+            EditField(&field, [](astro_field::Phi4Lattice& lattice) { lattice.AddPulse(0.0f, 0.0f, 3.0f, 1.5f); });
+        }
+        if (IsKeyPressed(KEY_Q)) TogglePhase(&field);
+        if (IsKeyPressed(KEY_K)) {
+            field.broken = true;
+            EditField(&field, [](astro_field::Phi4Lattice& lattice) {
+                lattice.SetParams(FieldParams(true, lattice.params().damping));
+                lattice.SetKinkPair(0.5f * kBoxLength, 0.45f);
+            });
+        }
+        if (IsKeyPressed(KEY_G) && field.gpu.ready()) {
+            if (field.useGpu) field.gpu.Download(&field.lattice);
+            else field.gpu.Upload(field.lattice);
+            field.useGpu = !field.useGpu;
+        }
+        if (IsKeyPressed(KEY_N)) {
+            const auto current = std::find(kLatticeSizes.begin(), kLatticeSizes.end(), field.lattice.size());
+            const size_t next = current == kLatticeSizes.end() ? 0 : (current - kLatticeSizes.begin() + 1) % kLatticeSizes.size();
+            ConfigureField(&field, kLatticeSizes[next]);
+            reloadTexture();
+            ++field.edits;
         }
         if (IsKeyPressed(KEY_R)) {
             paused = false;
-            pulseActive = false;
-            pulseTime = 0.0f;
-            t = 0.0f;
             strongCoupling = 1.05f;
+            field.broken = true;
+            field.damping = 0.3f;
+            ConfigureField(&field, field.lattice.size());
+            ++field.edits;
             travelers[0].x = trackMinX;
             travelers[1].x = trackMinX;
         }
         if (IsKeyPressed(KEY_UP)) strongCoupling = std::min(2.2f, strongCoupling + 0.1f);
         if (IsKeyPressed(KEY_DOWN)) strongCoupling = std::max(0.2f, strongCoupling - 0.1f);
+        if (IsKeyDown(KEY_RIGHT_BRACKET)) field.damping = std::min(1.0f, field.damping + 0.4f * GetFrameTime());
+        if (IsKeyDown(KEY_LEFT_BRACKET)) field.damping = std::max(0.0f, field.damping - 0.4f * GetFrameTime());
         travelers[1].coupling = strongCoupling;
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
         float gammaSpeed = travelers[0].baseSpeed;
         float massiveSpeed = travelers[1].baseSpeed;
+        if (!paused) StepField(&field, GetFrameTime());
+        if (field.useGpu) {
+            for (size_t k = 0; k < travelers.size(); ++k) field.gpu.ReadRow(TrackRow(field.lattice, travelers[k].z), &field.rows[k]);
+            field.gpu.Colorize(field.lattice.params().vev());
+        } else {
+            UpdateFieldTexture(field, &fieldPixels, fieldTexture);
+        }
+
+        // Travelers pick up an effective mass proportional to |phi| where they are: full in
+        // either vacuum, none on a domain wall or in the symmetric phase.
         if (!paused) {
             float dt = GetFrameTime();
-            t += dt;
-            if (pulseActive) {
-                pulseTime += dt;
-                if (pulseTime > 4.2f) pulseActive = false;
-            }
-
-            for (Traveler& traveler : travelers) {
-                float field = HiggsFieldValue(traveler.x, traveler.z, t, vev, pulseActive, pulseTime);
-                float effectiveMass = traveler.coupling * field;
+            for (size_t k = 0; k < travelers.size(); ++k) {
+                Traveler& traveler = travelers[k];
+                float phi = FieldAt(field, traveler.x, traveler.z, static_cast<int>(k));
+                float effectiveMass = traveler.coupling * std::fabs(phi);
                 float speed = traveler.baseSpeed / (1.0f + 2.2f * effectiveMass);
                 traveler.x += speed * dt;
                 if (traveler.x > trackMaxX) traveler.x = trackMinX;
@@ -138,39 +313,37 @@ int main() {
             }
         }
 
+        statsAge += GetFrameTime();
+        if (statsAge > kStatsInterval || statsEdits != field.edits) {
+            if (field.useGpu) field.gpu.Download(&field.lattice);
+            stats = field.lattice.Measure();
+            statsAge = 0.0f;
+            statsEdits = field.edits;
+        }
+
         BeginDrawing();
         ClearBackground(Color{8, 10, 18, 255});
 
         BeginMode3D(camera);
 
-        DrawPlane({0.0f, 0.0f, 0.0f}, {13.0f, 13.0f}, Color{20, 28, 38, 255});
-
-        const int fieldN = 24;
-        const float span = 5.4f;
-        for (int iz = 0; iz <= fieldN; ++iz) {
-            for (int ix = 0; ix <= fieldN; ++ix) {
-                float x = -span + 2.0f * span * static_cast<float>(ix) / static_cast<float>(fieldN);
-                float z = -span + 2.0f * span * static_cast<float>(iz) / static_cast<float>(fieldN);
-                float phi = HiggsFieldValue(x, z, t, vev, pulseActive, pulseTime);
-                float norm = std::clamp((phi - 0.45f) / 1.35f, 0.0f, 1.0f);
-                float y = 0.12f + 0.30f * phi;
-                float r = 0.04f + 0.03f * norm;
-                Color c = {
-                    static_cast<unsigned char>(70 + 95 * norm),
-                    static_cast<unsigned char>(120 + 80 * norm),
-                    static_cast<unsigned char>(210 + 35 * (1.0f - norm)),
-                    185
-                };
-                DrawSphere({x, y, z}, r, c);
+        DrawFieldPlane(field.useGpu ? field.gpu.display() : fieldTexture);
+
+        for (size_t k = 0; k < travelers.size(); ++k) {
+            const Traveler& traveler = travelers[k];
+            const Color track = k == 0 ? Color{110, 180, 230, 150} : Color{230, 160, 110, 150};
+            DrawLine3D({trackMinX, 0.02f, traveler.z}, {trackMaxX, 0.02f, traveler.z}, track);
+            Vector3 last{};
+            for (int s = 0; s < kProfileSamples; ++s) {
+                const float x = -kSpan + 2.0f * kSpan * static_cast<float>(s) / static_cast<float>(kProfileSamples - 1);
+                const Vector3 p = {x, ProfileHeight(FieldAt(field, x, traveler.z, static_cast<int>(k))), traveler.z};
+                if (s > 0) DrawLine3D(last, p, Fade(track, 0.9f));
+                last = p;
             }
         }
 
-        DrawLine3D({trackMinX, 0.10f, -1.2f}, {trackMaxX, 0.10f, -1.2f}, Color{110, 180, 230, 150});
-        DrawLine3D({trackMinX, 0.10f, 1.2f}, {trackMaxX, 0.10f, 1.2f}, Color{230, 160, 110, 150});
-
-        for (const Traveler& traveler : travelers) {
-            float phi = HiggsFieldValue(traveler.x, traveler.z, t, vev, pulseActive, pulseTime);
-            float y = 0.18f + 0.30f * phi;
+        for (size_t k = 0; k < travelers.size(); ++k) {
+            const Traveler& traveler = travelers[k];
+            float y = ProfileHeight(FieldAt(field, traveler.x, traveler.z, static_cast<int>(k))) + 0.06f;
             DrawSphere({traveler.x, y, traveler.z}, 0.16f, traveler.color);
             DrawSphere({traveler.x, y, traveler.z}, 0.23f, Color{traveler.color.r, traveler.color.g, traveler.color.b, 40});
         }
@@ -178,20 +351,33 @@ int main() {
         DrawCubeWires({0.0f, 0.8f, 0.0f}, 11.0f, 1.8f, 11.0f, Color{120, 160, 210, 80});
         EndMode3D();
 
-        DrawText("Higgs Field (Conceptual)", 20, 18, 30, Color{235, 240, 252, 255});
+        DrawText("Higgs Field (phi^4 lattice)", 20, 18, 30, Color{235, 240, 252, 255});
         DrawText("Non-zero field fills space. Particles that couple to it move as if they have inertia (mass).", 20, 54, 19, Color{168, 186, 214, 255});
-        DrawText("Mouse drag: orbit | wheel: zoom | UP/DOWN: coupling | SPACE: excite field | P: pause | R: reset", 20, 80, 18, Color{168, 186, 214, 255});
+        DrawText("Mouse drag: orbit | wheel: zoom | UP/DOWN: coupling | SPACE: excite | Q: quench | K: kink pair | [ ]: damping | N: lattice | G: GPU | P | R",
+                 20, 80, 18, Color{168, 186, 214, 255});
 
         DrawText("blue: no coupling (stays fast)", 20, 110, 19, Color{125, 215, 255, 255});
-        DrawText("orange: strong coupling (slower = larger effective mass)", 20, 134, 19, Color{255, 175, 105, 255});
+        DrawText("orange: strong coupling (slower = larger effective mass; full speed on a domain wall)", 20, 134, 19, Color{255, 175, 105, 255});
 
-        std::string hud = HudLine(strongCoupling, gammaSpeed, massiveSpeed, paused, pulseActive);
+        std::string hud = HudLine(strongCoupling, gammaSpeed, massiveSpeed, paused, field.broken);
         DrawText(hud.c_str(), 20, 164, 20, Color{255, 220, 130, 255});
         DrawFPS(20, 194);
 
+        std::ostringstream fieldHud;
+        fieldHud << std::fixed << std::setprecision(2) << field.lattice.size() << "^2 lattice on " << (field.useGpu ? "GPU" : "CPU")
+                 << "  t=" << (field.useGpu ? field.gpu.time() : field.lattice.time()) << "  damping=" << field.damping
+                 << "  <|phi|>=" << stats.meanAbsPhi << "  <phi>=" << stats.meanPhi << "  wall length=" << std::setprecision(1)
+                 << stats.wallLength << "  E=" << stats.energy;
+        DrawText(fieldHud.str().c_str(), 20, 222, 18, Color{170, 200, 170, 255});
+
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    UnloadTexture(fieldTexture);
+    field.gpu.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,8 +1,19 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/boris_pusher.h"
+#include "../common/colormap.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/instanced_particles.h"
+#include "../common/parametric_mesh.h"
+#include "../common/profiler.h"
+#include "../common/thread_pool.h"
+
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <iomanip>
 #include <random>
 #include <sstream>
@@ -15,11 +26,57 @@ constexpr int kScreenWidth = 1600;
 constexpr int kScreenHeight = 960;
 constexpr float kMajorRadius = 5.65f;
 constexpr float kMinorRadius = 1.42f;
-constexpr int kPlasmaParticleCount = 1800;
 constexpr int kSparkCount = 260;
 constexpr int kFieldLineCount = 26;
 constexpr int kTorusSegments = 132;
 constexpr int kPoloidalSegments = 44;
+constexpr int kToroidalCoilCount = 18;
+constexpr int kVesselBands = 9;           // toroidal lines on the vessel
+constexpr int kVesselRings = 24;          // poloidal rings on the vessel
+constexpr float kVesselMinorRadius = kMinorRadius + 0.36f;
+constexpr float kVesselStretch = 1.08f;
+constexpr int kPlasmaShells = 5;
+constexpr int kShellBands = 8;
+constexpr int kFieldLineSamples = 300;
+
+// Particle engine. Lengths are scene units, the toroidal field is normalised to 1 on the
+// axis at the reference coil current, and the electron/ion mass ratio is reduced to 5 so
+// all species can share a frame.
+constexpr int kParticleCounts[] = {20000, 100000, 1000000};
+constexpr int kParticleCountPresets = static_cast<int>(sizeof(kParticleCounts) / sizeof(kParticleCounts[0]));
+constexpr int kDefaultCountIndex = 1;
+constexpr int kMaxDrawnParticles = 160000;
+constexpr unsigned char kParticleAlpha = 158;  // 0.62, additive
+constexpr float kTimeScale = 4.0f;       // simulated seconds per displayed second
+constexpr float kMaxGyroAngle = 0.6f;    // bound on Omega * dt for one Boris sub-step
+constexpr float kReferenceField = 5.5f;  // tesla shown on the HUD for b0 = 1
+constexpr float kLoadRadius = 0.8f * kMinorRadius;
+constexpr float kWallRadius = kMinorRadius + 0.2f;
+constexpr float kSafetyAxis = 1.1f;
+constexpr float kSafetyEdge = 3.7f;
+constexpr float kRippleEdge = 0.015f;  // toroidal-field ripple at the outboard wall
+constexpr float kLossSmoothing = 0.04f;
+constexpr float kConfinementScale = 120.0f;  // tau_p that fills half the confinement bar
+constexpr int kPicNodes = 64;
+constexpr int kPicSweeps = 40;
+constexpr float kPlasmaFrequency = 8.0f;  // electron omega_pe the PIC permittivity is tuned for
+
+struct SpeciesSpec {
+    const char* name;
+    float chargeOverMass;
+    float thermalSpeed;  // per-component speed spread at the reference temperature
+    float share;         // fraction of the macro-particles
+    float heat;          // colour on the PlasmaColor ramp
+    float pointSize;
+    bool deposits;       // contributes charge to the PIC field; alphas are test particles
+};
+
+constexpr SpeciesSpec kSpecies[] = {
+    {"D+", 25.0f, 1.5f, 0.45f, 0.42f, 2.0f, true},
+    {"e-", -125.0f, 3.35f, 0.45f, 0.08f, 1.6f, true},
+    {"alpha", 25.0f, 6.0f, 0.10f, 0.96f, 3.2f, false},
+};
+constexpr int kSpeciesCount = static_cast<int>(sizeof(kSpecies) / sizeof(kSpecies[0]));
 
 struct OrbitCameraState {
     float yaw = 0.82f;
@@ -27,17 +84,6 @@ struct OrbitCameraState {
     float distance = 19.5f;
 };
 
-struct PlasmaParticle {
-    float theta = 0.0f;
-    float phi = 0.0f;
-    float thetaSpeed = 0.0f;
-    float phiSpeed = 0.0f;
-    float radius = 0.0f;
-    float heat = 0.0f;
-    float size = 0.0f;
-    float phase = 0.0f;
-};
-
 struct Spark {
     float theta = 0.0f;
     float phi = 0.0f;
@@ -72,12 +118,18 @@ Color LerpColor(Color a, Color b, float t) {
     };
 }
 
-Color PlasmaColor(float heat, float alpha = 1.0f) {
-    Color c = LerpColor(Color{80, 178, 255, 255}, Color{255, 74, 180, 255}, heat);
-    c = LerpColor(c, Color{255, 224, 98, 255}, std::max(0.0f, heat - 0.72f) / 0.28f);
-    c.a = static_cast<unsigned char>(255.0f * std::clamp(alpha, 0.0f, 1.0f));
-    return c;
-}
+struct VesselColors {
+    Color grid;   // toroidal bands
+    Color steel;  // poloidal rings
+};
+
+// Blue through magenta, turning gold above heat 0.72.
+const astro_color::Colormap kPlasmaMap = astro_color::Colormap::Bake([](float heat) {
+    const Color c = LerpColor(Color{80, 178, 255, 255}, Color{255, 74, 180, 255}, heat);
+    return LerpColor(c, Color{255, 224, 98, 255}, std::max(0.0f, heat - 0.72f) / 0.28f);
+});
+
+Color PlasmaColor(float heat, float alpha = 1.0f) { return kPlasmaMap(heat, alpha); }
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, OrbitCameraState* orbit) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -110,27 +162,189 @@ Vector3 RingPoint(float theta, float radius, float y = 0.0f) {
     return {radius * std::cos(theta), y, radius * std::sin(theta)};
 }
 
-std::vector<PlasmaParticle> MakePlasmaParticles() {
-    std::mt19937 rng(8172);
-    std::vector<PlasmaParticle> particles;
-    particles.reserve(kPlasmaParticleCount);
+uint32_t HashU32(uint32_t v) {
+    v ^= v >> 16;
+    v *= 0x7feb352du;
+    v ^= v >> 15;
+    v *= 0x846ca68bu;
+    v ^= v >> 16;
+    return v;
+}
+
+float Hash01(uint32_t* state) {
+    *state = HashU32(*state + 0x9e3779b9u);
+    return static_cast<float>(*state >> 8) * (1.0f / 16777216.0f);
+}
+
+float HashNormal(uint32_t* state) {
+    const float u = std::max(Hash01(state), 1e-7f);
+    return std::sqrt(-2.0f * std::log(u)) * std::cos(2.0f * PI * Hash01(state));
+}
+
+// Coil model seen by the particles: 1/R toroidal field with the ripple of the discrete TF
+// coils, a poloidal field from the plasma current with safety factor q(r) rising from the
+// axis to the edge, and the PIC electric field when it is enabled.
+struct CoilField {
+    float b0 = 1.0f;
+    bool plasmaCurrent = true;
+    const astro_plasma::AxisymmetricPoisson* pic = nullptr;
+
+    void operator()(float x, float y, float z, float* e, float* b) const {
+        const float r2 = x * x + z * z;
+        const float invR = 1.0f / std::sqrt(r2);
+        const float major = r2 * invR;
+        const float c = x * invR;
+        const float s = z * invR;
+
+        // cos(18 theta) and (R / R_wall)^18 by repeated squaring.
+        const float re2 = c * c - s * s, im2 = 2.0f * c * s;
+        const float edge = major / (kMajorRadius + kWallRadius);
+        const float edge2 = edge * edge;
+        float re = re2, im = im2, edgePow = edge2;
+        for (int k = 0; k < 3; ++k) {
+            const float t = re * re - im * im;
+            im = 2.0f * re * im;
+            re = t;
+            edgePow *= edgePow;
+        }
+        const float cos18 = re * re2 - im * im2;
+        const float bt = b0 * kMajorRadius * invR * (1.0f + kRippleEdge * edgePow * edge2 * cos18);
+
+        b[0] = -bt * s;
+        b[1] = 0.0f;
+        b[2] = bt * c;
+        if (plasmaCurrent) {
+            const float dR = major - kMajorRadius;
+            const float rho2 = (dR * dR + y * y) / (kMinorRadius * kMinorRadius);
+            const float q = kSafetyAxis + (kSafetyEdge - kSafetyAxis) * std::min(rho2, 1.6f);
+            const float bp = bt / (q * kMajorRadius);
+            b[0] -= bp * y * c;
+            b[1] = bp * dR;
+            b[2] -= bp * y * s;
+        }
 
-    for (int i = 0; i < kPlasmaParticleCount; ++i) {
-        const float heat = RandRange(rng, 0.0f, 1.0f);
-        const float radius = kMinorRadius * RandRange(rng, 0.12f, 0.92f);
-        particles.push_back({
-            RandRange(rng, 0.0f, 2.0f * PI),
-            RandRange(rng, 0.0f, 2.0f * PI),
-            RandRange(rng, 0.55f, 1.45f),
-            RandRange(rng, 2.5f, 7.8f) * (0.72f + heat * 0.72f),
-            radius,
-            heat,
-            RandRange(rng, 0.018f, 0.066f),
-            RandRange(rng, 0.0f, 2.0f * PI),
-        });
+        e[0] = e[1] = e[2] = 0.0f;
+        if (pic != nullptr) {
+            float er, ez;
+            pic->FieldAt(major, y, &er, &ez);
+            e[0] = er * c;
+            e[1] = ez;
+            e[2] = er * s;
+        }
     }
+};
+struct SpeciesState {
+    astro_plasma::ParticleBatch batch;
+    long long lost = 0;
+    float lossRate = 0.0f;  // smoothed wall losses per simulated second
+};
+
+struct PlasmaSim {
+    SpeciesState species[kSpeciesCount];
+    astro_plasma::AxisymmetricPoisson poisson;
+    CoilField field;
+    uint32_t generation = 1;
+    int countIndex = kDefaultCountIndex;
+    bool pic = false;
+};
 
-    return particles;
+float TemperatureScale(float power) { return (80.0f + 90.0f * power) / 150.0f; }
+
+float AxisField(float fieldCurrent) { return (3.2f + 3.1f * fieldCurrent) / kReferenceField; }
+
+// Places particle i on the parabolic-profile core with a Maxwellian velocity; the seed
+// mixes species, index and generation so reloads are reproducible.
+void LoadParticle(astro_plasma::ParticleBatch* batch, size_t i, int species, float speedScale, uint32_t generation) {
+    uint32_t state = HashU32(static_cast<uint32_t>(i) * 0x9e3779b9u ^ HashU32(generation * 3u + static_cast<uint32_t>(species)));
+    const float r = kLoadRadius * std::sqrt(1.0f - std::sqrt(1.0f - Hash01(&state)));
+    const float poloidal = 2.0f * PI * Hash01(&state);
+    const float toroidal = 2.0f * PI * Hash01(&state);
+    const Vector3 p = TokamakPoint(toroidal, poloidal, r);
+    const float spread = kSpecies[species].thermalSpeed * speedScale;
+    batch->x[i] = p.x;
+    batch->y[i] = p.y;
+    batch->z[i] = p.z;
+    batch->vx[i] = spread * HashNormal(&state);
+    batch->vy[i] = spread * HashNormal(&state);
+    batch->vz[i] = spread * HashNormal(&state);
+}
+
+void ConfigurePlasma(PlasmaSim* sim, float power) {
+    const int total = kParticleCounts[sim->countIndex];
+    const float speedScale = std::sqrt(TemperatureScale(power));
+    for (int k = 0; k < kSpeciesCount; ++k) {
+        SpeciesState& species = sim->species[k];
+        const size_t n = static_cast<size_t>(total * kSpecies[k].share);
+        species.batch.resize(n);
+        species.batch.chargeOverMass = kSpecies[k].chargeOverMass;
+        species.batch.weight = kSpecies[k].deposits ? (kSpecies[k].chargeOverMass > 0.0f ? 1.0f : -1.0f) / n : 0.0f;
+        species.lost = 0;
+        species.lossRate = 0.0f;
+        for (size_t i = 0; i < n; ++i) LoadParticle(&species.batch, i, k, speedScale, 0);
+    }
+    const float margin = kMinorRadius + 0.4f;
+    sim->poisson.Configure(kMajorRadius - margin, kMajorRadius + margin, -margin, margin, kPicNodes, kPicNodes);
+    sim->generation = 1;
+}
+
+// Particles past the wall are counted as lost and reloaded in the core at the current
+// temperature, which keeps the population fixed.
+int ReloadLostParticles(PlasmaSim* sim, int species, float speedScale) {
+    astro_plasma::ParticleBatch* batch = &sim->species[species].batch;
+    std::atomic<int> lost{0};
+    const uint32_t generation = sim->generation;
+    astro_parallel::SharedPool().ParallelFor(static_cast<int>(batch->size()), astro_plasma::kPushChunk, [&](int begin, int end) {
+        int local = 0;
+        for (int i = begin; i < end; ++i) {
+            const float major = std::sqrt(batch->x[i] * batch->x[i] + batch->z[i] * batch->z[i]);
+            const float dR = major - kMajorRadius;
+            if (dR * dR + batch->y[i] * batch->y[i] < kWallRadius * kWallRadius) continue;
+            LoadParticle(batch, static_cast<size_t>(i), species, speedScale, generation);
+            ++local;
+        }
+        lost += local;
+    });
+    return lost.load();
+}
+
+void StepPlasma(PlasmaSim* sim, float frameDt, float power, float fieldCurrent) {
+    const float dt = frameDt * kTimeScale;
+    if (dt <= 0.0f) return;
+    const float speedScale = std::sqrt(TemperatureScale(power));
+    sim->field.b0 = AxisField(fieldCurrent);
+    sim->field.pic = sim->pic ? &sim->poisson : nullptr;
+    const float maxField = sim->field.b0 * kMajorRadius / (kMajorRadius - kWallRadius) * (1.0f + kRippleEdge);
+
+    for (int k = 0; k < kSpeciesCount; ++k) {
+        SpeciesState& species = sim->species[k];
+        const float omega = std::fabs(kSpecies[k].chargeOverMass) * maxField;
+        const int steps = std::max(1, static_cast<int>(std::ceil(omega * dt / kMaxGyroAngle)));
+        astro_plasma::BorisPush(&species.batch, dt / steps, steps, sim->field);
+        const int lost = ReloadLostParticles(sim, k, speedScale);
+        species.lost += lost;
+        species.lossRate += kLossSmoothing * (lost / dt - species.lossRate);
+    }
+
+    if (sim->pic) {
+        // omega_pe^2 = |q/m|_e n_e / epsilon with the mean electron density of the load.
+        const float volume = 2.0f * PI * kMajorRadius * PI * kLoadRadius * kLoadRadius;
+        const float epsilon = std::fabs(kSpecies[1].chargeOverMass) / (volume * kPlasmaFrequency * kPlasmaFrequency);
+        sim->poisson.ClearCharge();
+        for (const SpeciesState& species : sim->species) sim->poisson.Deposit(species.batch);
+        sim->poisson.Solve(epsilon, kPicSweeps);
+    }
+    ++sim->generation;
+}
+
+// Particle confinement time N / (dN/dt) over the deposited species, in simulated seconds.
+float ConfinementTime(const PlasmaSim& sim) {
+    float count = 0.0f, rate = 0.0f;
+    for (int k = 0; k < kSpeciesCount; ++k) {
+        if (!kSpecies[k].deposits) continue;
+        count += static_cast<float>(sim.species[k].batch.size());
+        rate += sim.species[k].lossRate;
+    }
+    return rate > 1e-3f ? count / rate : 1e6f;
 }
 
 std::vector<Spark> MakeSparks() {
@@ -207,55 +421,48 @@ void DrawPoloidalCoils(float time, float current) {
     }
 }
 
-void DrawVacuumVessel(float time, bool cutaway) {
-    const Color steel = cutaway ? Color{102, 118, 136, 72} : Color{102, 118, 136, 138};
-    const Color grid = Color{178, 198, 220, static_cast<unsigned char>(cutaway ? 90 : 132)};
+VesselColors VesselLineColors(bool cutaway) {
+    return {Color{178, 198, 220, static_cast<unsigned char>(cutaway ? 90 : 132)},
+            cutaway ? Color{102, 118, 136, 72} : Color{102, 118, 136, 138}};
+}
+
+// Cutaway hides vessel rings 2..8, the ones facing the default camera.
+bool VesselRingHidden(int ring, bool cutaway) { return cutaway && ring > 1 && ring < 9; }
 
-    for (int band = 0; band < 9; ++band) {
-        const float phi = 2.0f * PI * band / 9.0f;
+Color PlasmaShellColor(int shell, float power) {
+    return PlasmaColor(0.38f + 0.13f * shell, (0.18f - shell * 0.025f) * power);
+}
+
+void DrawVesselLinesImmediate(bool cutaway) {
+    const VesselColors colors = VesselLineColors(cutaway);
+    for (int band = 0; band < kVesselBands; ++band) {
+        const float phi = 2.0f * PI * band / kVesselBands;
         for (int i = 0; i < kTorusSegments; ++i) {
             const float a0 = 2.0f * PI * i / kTorusSegments;
             const float a1 = 2.0f * PI * (i + 1) / kTorusSegments;
-            DrawLine3D(TokamakPoint(a0, phi, kMinorRadius + 0.36f, 1.08f), TokamakPoint(a1, phi, kMinorRadius + 0.36f, 1.08f), grid);
+            DrawLine3D(TokamakPoint(a0, phi, kVesselMinorRadius, kVesselStretch), TokamakPoint(a1, phi, kVesselMinorRadius, kVesselStretch), colors.grid);
         }
     }
 
-    for (int ring = 0; ring < 24; ++ring) {
-        if (cutaway && ring > 1 && ring < 9) continue;
-        const float theta = 2.0f * PI * ring / 24.0f;
+    for (int ring = 0; ring < kVesselRings; ++ring) {
+        if (VesselRingHidden(ring, cutaway)) continue;
+        const float theta = 2.0f * PI * ring / kVesselRings;
         std::vector<Vector3> loop;
         loop.reserve(kPoloidalSegments);
         for (int p = 0; p < kPoloidalSegments; ++p) {
             const float phi = 2.0f * PI * p / kPoloidalSegments;
-            loop.push_back(TokamakPoint(theta, phi, kMinorRadius + 0.36f, 1.08f));
+            loop.push_back(TokamakPoint(theta, phi, kVesselMinorRadius, kVesselStretch));
         }
-        DrawPolylineLoop(loop, steel);
-    }
-
-    for (int port = 0; port < 12; ++port) {
-        const float a = 2.0f * PI * port / 12.0f;
-        const float r0 = kMajorRadius + kMinorRadius + 0.42f;
-        const float r1 = r0 + 1.55f;
-        DrawCylinderEx(RingPoint(a, r0, 0.0f), RingPoint(a, r1, 0.0f), 0.18f, 0.18f, 14, Color{78, 92, 110, 245});
-        DrawCylinderEx(RingPoint(a, r1, 0.0f), RingPoint(a, r1 + 0.28f, 0.0f), 0.27f, 0.27f, 18, Color{132, 150, 172, 220});
-    }
-
-    for (int i = 0; i < 36; ++i) {
-        const float a = 2.0f * PI * i / 36.0f;
-        const float flicker = 0.5f + 0.5f * std::sin(time * 3.0f + i * 1.7f);
-        DrawSphere(RingPoint(a, kMajorRadius + 2.25f, -2.0f), 0.035f + 0.022f * flicker, Color{90, 190, 255, 110});
+        DrawPolylineLoop(loop, colors.steel);
     }
 }
 
-void DrawPlasmaSurfaces(float time, float power, bool magneticLines) {
-    BeginBlendMode(BLEND_ADDITIVE);
-
-    for (int shell = 0; shell < 5; ++shell) {
+void DrawPlasmaLinesImmediate(float time, float power, bool magneticLines) {
+    for (int shell = 0; shell < kPlasmaShells; ++shell) {
         const float r = kMinorRadius * (0.22f + shell * 0.135f);
-        const float alpha = (0.18f - shell * 0.025f) * power;
-        const Color shellColor = PlasmaColor(0.38f + 0.13f * shell, alpha);
-        for (int band = 0; band < 8; ++band) {
-            const float phi = 2.0f * PI * band / 8.0f + time * (0.07f + shell * 0.012f);
+        const Color shellColor = PlasmaShellColor(shell, power);
+        for (int band = 0; band < kShellBands; ++band) {
+            const float phi = 2.0f * PI * band / kShellBands + time * (0.07f + shell * 0.012f);
             for (int i = 0; i < kTorusSegments; ++i) {
                 const float a0 = 2.0f * PI * i / kTorusSegments;
                 const float a1 = 2.0f * PI * (i + 1) / kTorusSegments;
@@ -270,8 +477,8 @@ void DrawPlasmaSurfaces(float time, float power, bool magneticLines) {
             Vector3 prev{};
             bool hasPrev = false;
             const float q = 3.7f + 0.25f * std::sin(time * 0.4f + line);
-            for (int i = 0; i <= 300; ++i) {
-                const float u = static_cast<float>(i) / 300.0f;
+            for (int i = 0; i <= kFieldLineSamples; ++i) {
+                const float u = static_cast<float>(i) / static_cast<float>(kFieldLineSamples);
                 const float theta = 2.0f * PI * (1.75f * u) + time * 0.18f;
                 const float phi = base + theta * q + 0.16f * std::sin(time + theta * 2.0f);
                 const Vector3 p = TokamakPoint(theta, phi, kMinorRadius * 0.76f);
@@ -282,21 +489,204 @@ void DrawPlasmaSurfaces(float time, float power, bool magneticLines) {
         }
     }
 
+}
+
+// Vessel grid, plasma shells and field lines as one static line list. Each vertex is
+// (theta or u, phi or line, shell or base phi, family) and the shader runs TokamakPoint,
+// the shells' poloidal drift and the field lines' breathing safety factor from `time`, so
+// a frame is at most five draw calls instead of ~15k DrawLine3D. Same lines as the immediate path.
+class TokamakLineMesh {
+  public:
+    bool Init() {
+        std::vector<Vector4> v;
+        const auto segment = [&v](Vector4 a, Vector4 b) {
+            v.push_back(a);
+            v.push_back(b);
+        };
+        const float torusStep = 2.0f * PI / kTorusSegments;
+        for (int band = 0; band < kVesselBands; ++band) {
+            const float phi = 2.0f * PI * band / kVesselBands;
+            for (int i = 0; i < kTorusSegments; ++i) segment({torusStep * i, phi, 0.0f, 0.0f}, {torusStep * (i + 1), phi, 0.0f, 0.0f});
+        }
+        ringsFirst_ = static_cast<int>(v.size());
+        const float poloidalStep = 2.0f * PI / kPoloidalSegments;
+        for (int ring = 0; ring < kVesselRings; ++ring) {
+            const float theta = 2.0f * PI * ring / kVesselRings;
+            for (int p = 0; p < kPoloidalSegments; ++p) {
+                segment({theta, poloidalStep * p, 0.0f, 0.0f}, {theta, poloidalStep * ((p + 1) % kPoloidalSegments), 0.0f, 0.0f});
+            }
+        }
+        shellsFirst_ = static_cast<int>(v.size());
+        for (int shell = 0; shell < kPlasmaShells; ++shell) {
+            for (int band = 0; band < kShellBands; ++band) {
+                const float phi = 2.0f * PI * band / kShellBands;
+                for (int i = 0; i < kTorusSegments; ++i) {
+                    segment({torusStep * i, phi, static_cast<float>(shell), 1.0f}, {torusStep * (i + 1), phi, static_cast<float>(shell), 1.0f});
+                }
+            }
+        }
+        fieldFirst_ = static_cast<int>(v.size());
+        for (int line = 0; line < kFieldLineCount; ++line) {
+            const float base = 2.0f * PI * line / kFieldLineCount;
+            for (int i = 0; i < kFieldLineSamples; ++i) {
+                const float u0 = static_cast<float>(i) / static_cast<float>(kFieldLineSamples);
+                const float u1 = static_cast<float>(i + 1) / static_cast<float>(kFieldLineSamples);
+                segment({u0, static_cast<float>(line), base, 2.0f}, {u1, static_cast<float>(line), base, 2.0f});
+            }
+        }
+        if (!mesh_.Init(kVertexShader, kFragmentShader, astro_render::ParametricPrimitive::kLines, v)) return false;
+        locShape_ = mesh_.Uniform("shape");
+        locTime_ = mesh_.Uniform("time");
+        locLineColor_ = mesh_.Uniform("lineColor");
+        locShellColors_ = mesh_.Uniform("shellColors");
+        return true;
+    }
+
+    void Unload() { mesh_.Unload(); }
+    bool ready() const { return mesh_.ready(); }
+
+    void DrawVessel(bool cutaway) const {
+        const VesselColors colors = VesselLineColors(cutaway);
+        constexpr int kRingVertices = 2 * kPoloidalSegments;
+        Begin(0.0f);
+        mesh_.SetVec4(locLineColor_, ToVector(colors.grid));
+        mesh_.Draw(0, ringsFirst_);
+        mesh_.SetVec4(locLineColor_, ToVector(colors.steel));
+        int ring = 0;
+        while (ring < kVesselRings) {
+            if (VesselRingHidden(ring, cutaway)) {
+                ++ring;
+                continue;
+            }
+            const int first = ring;
+            while (ring < kVesselRings && !VesselRingHidden(ring, cutaway)) ++ring;
+            mesh_.Draw(ringsFirst_ + first * kRingVertices, (ring - first) * kRingVertices);
+        }
+        mesh_.End();
+    }
+
+    // Between BeginBlendMode(BLEND_ADDITIVE) and EndBlendMode, like the immediate path.
+    void DrawPlasma(float time, float power, bool magneticLines) const {
+        Vector4 shellColors[kPlasmaShells];
+        for (int shell = 0; shell < kPlasmaShells; ++shell) shellColors[shell] = ToVector(PlasmaShellColor(shell, power));
+        Begin(time);
+        mesh_.SetVec4s(locShellColors_, shellColors, kPlasmaShells);
+        mesh_.Draw(shellsFirst_, fieldFirst_ - shellsFirst_);
+        if (magneticLines) {
+            mesh_.SetVec4(locLineColor_, ToVector(Color{96, 226, 255, 82}));
+            mesh_.Draw(fieldFirst_);
+        }
+        mesh_.End();
+    }
+
+  private:
+    static Vector4 ToVector(Color c) { return ColorNormalize(c); }
+
+    void Begin(float time) const {
+        mesh_.Begin();
+        mesh_.SetVec4(locShape_, {kMajorRadius, kMinorRadius, kVesselMinorRadius, kVesselStretch});
+        mesh_.SetFloat(locTime_, time);
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec4 vertexParams;
+uniform mat4 mvp;
+uniform vec4 shape;  // major radius, minor radius, vessel minor radius, vessel stretch
+uniform float time;
+uniform vec4 lineColor;
+uniform vec4 shellColors[5];
+out vec4 fragColor;
+vec3 TokamakPoint(float theta, float phi, float minorRadius, float stretch) {
+    float tube = shape.x + minorRadius * cos(phi);
+    return vec3(tube * cos(theta), minorRadius * stretch * sin(phi), tube * sin(theta));
+}
+void main() {
+    vec3 p;
+    if (vertexParams.w < 0.5) {
+        p = TokamakPoint(vertexParams.x, vertexParams.y, shape.z, shape.w);
+        fragColor = lineColor;
+    } else if (vertexParams.w < 1.5) {
+        float shell = vertexParams.z;
+        float phi = vertexParams.y + time * (0.07 + shell * 0.012);
+        p = TokamakPoint(vertexParams.x, phi, shape.y * (0.22 + shell * 0.135), 1.0);
+        fragColor = shellColors[int(shell + 0.5)];
+    } else {
+        float theta = 6.28318530718 * (1.75 * vertexParams.x) + time * 0.18;
+        float q = 3.7 + 0.25 * sin(time * 0.4 + vertexParams.y);
+        float phi = vertexParams.z + theta * q + 0.16 * sin(time + theta * 2.0);
+        p = TokamakPoint(theta, phi, shape.y * 0.76, 1.0);
+        fragColor = lineColor;
+    }
+    gl_Position = mvp * vec4(p, 1.0);
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main() { finalColor = fragColor; }
+)";
+
+    astro_render::ParametricMesh mesh_;
+    int ringsFirst_ = 0;
+    int shellsFirst_ = 0;
+    int fieldFirst_ = 0;
+    int locShape_ = -1;
+    int locTime_ = -1;
+    int locLineColor_ = -1;
+    int locShellColors_ = -1;
+};
+
+void DrawVacuumVessel(const TokamakLineMesh& lines, float time, bool cutaway) {
+    if (lines.ready()) {
+        lines.DrawVessel(cutaway);
+    } else {
+        DrawVesselLinesImmediate(cutaway);
+    }
+
+    for (int port = 0; port < 12; ++port) {
+        const float a = 2.0f * PI * port / 12.0f;
+        const float r0 = kMajorRadius + kMinorRadius + 0.42f;
+        const float r1 = r0 + 1.55f;
+        DrawCylinderEx(RingPoint(a, r0, 0.0f), RingPoint(a, r1, 0.0f), 0.18f, 0.18f, 14, Color{78, 92, 110, 245});
+        DrawCylinderEx(RingPoint(a, r1, 0.0f), RingPoint(a, r1 + 0.28f, 0.0f), 0.27f, 0.27f, 18, Color{132, 150, 172, 220});
+    }
+
+    for (int i = 0; i < 36; ++i) {
+        const float a = 2.0f * PI * i / 36.0f;
+        const float flicker = 0.5f + 0.5f * std::sin(time * 3.0f + i * 1.7f);
+        DrawSphere(RingPoint(a, kMajorRadius + 2.25f, -2.0f), 0.035f + 0.022f * flicker, Color{90, 190, 255, 110});
+    }
+}
+
+void DrawPlasmaSurfaces(const TokamakLineMesh& lines, float time, float power, bool magneticLines) {
+    BeginBlendMode(BLEND_ADDITIVE);
+
+    if (lines.ready()) {
+        lines.DrawPlasma(time, power, magneticLines);
+    } else {
+        DrawPlasmaLinesImmediate(time, power, magneticLines);
+    }
+
     EndBlendMode();
 }
 
-void DrawParticles(const std::vector<PlasmaParticle>& particles, const std::vector<Spark>& sparks, float time, float power) {
+void DrawParticles(const PlasmaSim& sim, astro_render::InstancedParticleRenderer* instanced, const std::vector<Spark>& sparks,
+                   float time, float power) {
     BeginBlendMode(BLEND_ADDITIVE);
 
-    for (const PlasmaParticle& particle : particles) {
-        const float theta = particle.theta + time * particle.thetaSpeed;
-        const float phi = particle.phi + time * particle.phiSpeed + 0.2f * std::sin(time * 1.3f + particle.phase);
-        const float breathing = 1.0f + 0.08f * std::sin(time * 5.0f + particle.phase);
-        const Vector3 p = TokamakPoint(theta, phi, particle.radius * breathing);
-        const Color c = PlasmaColor(std::clamp(particle.heat * 0.82f + power * 0.28f, 0.0f, 1.0f), 0.72f);
-        DrawSphere(p, particle.size * (0.8f + power), c);
-        if (particle.heat > 0.72f) DrawSphere(p, particle.size * 3.8f, PlasmaColor(1.0f, 0.09f));
+    size_t total = 0;
+    for (const SpeciesState& species : sim.species) total += species.batch.size();
+    const size_t stride = std::max<size_t>(1, (total + kMaxDrawnParticles - 1) / kMaxDrawnParticles);
+    instanced->Clear();
+    instanced->Reserve(total / stride + kSpeciesCount);
+    for (int k = 0; k < kSpeciesCount; ++k) {
+        const astro_plasma::ParticleBatch& batch = sim.species[k].batch;
+        const float heat = kSpecies[k].heat * 0.82f + power * 0.28f;
+        const float size = kSpecies[k].pointSize * (0.8f + 0.4f * power);
+        for (size_t i = 0; i < batch.size(); i += stride) instanced->AddMapped({batch.x[i], batch.y[i], batch.z[i]}, size, heat, kParticleAlpha);
     }
+    instanced->Draw();
 
     for (const Spark& spark : sparks) {
         const float life = 0.5f + 0.5f * std::sin(time * spark.speed + spark.phase);
@@ -389,10 +779,12 @@ void DrawDiagnostics(float time) {
     }
 }
 
-void DrawHud(float power, float q, float current, float density, bool paused, bool cutaway, bool magneticLines) {
-    DrawRectangle(0, 0, GetScreenWidth(), 136, Color{5, 8, 14, 215});
+void DrawHud(const PlasmaSim& sim, float power, float q, float current, float density, bool paused, bool cutaway,
+             bool magneticLines) {
+    DrawRectangle(0, 0, GetScreenWidth(), 150, Color{5, 8, 14, 215});
     DrawText("Graphically Advanced Tokamak Fusion Reactor", 24, 18, 32, Color{240, 246, 255, 255});
-    DrawText("Mouse orbit | wheel zoom | [ ] plasma power | , . field current | C cutaway | M field lines | P pause | R reset",
+    DrawText("Mouse orbit | wheel zoom | [ ] plasma power | , . field current | I plasma current | E PIC field | N particles | "
+             "C cutaway | M field lines | P pause | R reset",
              24, 58, 18, Color{178, 195, 222, 255});
 
     std::ostringstream os;
@@ -405,6 +797,19 @@ void DrawHud(float power, float q, float current, float density, bool paused, bo
     if (paused) os << "   [PAUSED]";
     DrawText(os.str().c_str(), 24, 90, 20, Color{255, 218, 142, 255});
 
+    const float tau = ConfinementTime(sim);
+    std::ostringstream engine;
+    engine << "Boris engine  " << kParticleCounts[sim.countIndex] << " particles   losses/s";
+    for (int k = 0; k < kSpeciesCount; ++k) {
+        engine << "  " << kSpecies[k].name << "=" << std::fixed << std::setprecision(0) << sim.species[k].lossRate;
+    }
+    engine << "   tau_p=";
+    if (tau < 1e5f) engine << std::setprecision(0) << tau << " s";
+    else engine << "inf";
+    if (!sim.field.plasmaCurrent) engine << "   [NO PLASMA CURRENT]";
+    if (sim.pic) engine << "   [PIC FIELD]";
+    DrawText(engine.str().c_str(), 24, 120, 18, Color{150, 226, 255, 255});
+
     const int x = GetScreenWidth() - 378;
     const int y = 24;
     const int w = 240;
@@ -416,12 +821,35 @@ void DrawHud(float power, float q, float current, float density, bool paused, bo
     };
     bar(0, "plasma power", power, Color{255, 94, 170, 255});
     bar(1, "field current", current, Color{112, 224, 255, 255});
-    bar(2, "confinement", q / 12.0f, Color{255, 210, 94, 255});
+    bar(2, "confinement", tau / (tau + kConfinementScale), Color{255, 210, 94, 255});
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 240, 1.0f / 60.0f);
+    if (bench.enabled) {
+        // --particles=N picks the nearest preset at or above N; --pic adds the charge deposit and
+        // field solve, --no-current drops the poloidal field so the vertical drift shows as loss.
+        const int requested = astro_bench::IntArg(argc, argv, "--particles", kParticleCounts[kDefaultCountIndex]);
+        PlasmaSim sim;
+        sim.countIndex = 0;
+        while (sim.countIndex + 1 < kParticleCountPresets && kParticleCounts[sim.countIndex] < requested) ++sim.countIndex;
+        sim.pic = astro_bench::HasFlag(argc, argv, "--pic");
+        sim.field.plasmaCurrent = !astro_bench::HasFlag(argc, argv, "--no-current");
+        ConfigurePlasma(&sim, 0.78f);
+        return astro_bench::RunBench(
+            "tokamak_confinement_viz", bench, [&](float dt) { StepPlasma(&sim, dt, 0.78f, 0.74f); },
+            [&]() {
+                float sum = 0.0f;
+                for (const SpeciesState& species : sim.species) {
+                    sum += static_cast<float>(species.lost);
+                    for (size_t i = 0; i < species.batch.size(); ++i) sum += species.batch.y[i];
+                }
+                return sum;
+            });
+    }
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
     InitWindow(kScreenWidth, kScreenHeight, "Tokamak Fusion Reactor 3D - C++ (raylib)");
     SetWindowMinSize(1100, 720);
@@ -433,7 +861,14 @@ int main() {
     camera.projection = CAMERA_PERSPECTIVE;
 
     OrbitCameraState orbit{};
-    std::vector<PlasmaParticle> particles = MakePlasmaParticles();
+    PlasmaSim sim;
+    ConfigurePlasma(&sim, 0.78f);
+    astro_render::InstancedParticleRenderer particleRenderer;
+    particleRenderer.Init(astro_render::InstanceShape::kScreenPoint, kMaxDrawnParticles);
+    const Texture2D plasmaTexture = astro_color::LoadColormapTexture(kPlasmaMap);
+    particleRenderer.SetColormap(&kPlasmaMap, plasmaTexture);
+    TokamakLineMesh lineMesh;
+    lineMesh.Init();
     std::vector<Spark> sparks = MakeSparks();
     std::vector<Star> stars = MakeBackdrop();
 
@@ -452,6 +887,16 @@ int main() {
             power = 0.78f;
             fieldCurrent = 0.74f;
             time = 0.0f;
+            ConfigurePlasma(&sim, power);
+        }
+        if (IsKeyPressed(KEY_N)) {
+            sim.countIndex = (sim.countIndex + 1) % kParticleCountPresets;
+            ConfigurePlasma(&sim, power);
+        }
+        if (IsKeyPressed(KEY_I)) sim.field.plasmaCurrent = !sim.field.plasmaCurrent;
+        if (IsKeyPressed(KEY_E)) {
+            sim.pic = !sim.pic;
+            sim.poisson.Reset();
         }
         if (IsKeyPressed(KEY_LEFT_BRACKET)) power = std::max(0.18f, power - 0.08f);
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) power = std::min(1.0f, power + 0.08f);
@@ -459,7 +904,11 @@ int main() {
         if (IsKeyPressed(KEY_PERIOD)) fieldCurrent = std::min(1.0f, fieldCurrent + 0.06f);
 
         UpdateOrbitCameraDragOnly(&camera, &orbit);
-        if (!paused) time += std::min(GetFrameTime(), 1.0f / 45.0f);
+        if (!paused) {
+            const float dt = std::min(GetFrameTime(), 1.0f / 45.0f);
+            time += dt;
+            StepPlasma(&sim, dt, power, fieldCurrent);
+        }
 
         const float q = 4.2f + 6.4f * fieldCurrent + 1.2f * power;
         const float density = 0.7f + 1.4f * power;
@@ -470,18 +919,18 @@ int main() {
 
         BeginMode3D(camera);
         DrawCryostatAndFloor(time, stars);
-        DrawVacuumVessel(time, cutaway);
+        DrawVacuumVessel(lineMesh, time, cutaway);
 
-        for (int i = 0; i < 18; ++i) {
-            DrawDShapedToroidalCoil(2.0f * PI * i / 18.0f, time, fieldCurrent);
+        for (int i = 0; i < kToroidalCoilCount; ++i) {
+            DrawDShapedToroidalCoil(2.0f * PI * i / kToroidalCoilCount, time, fieldCurrent);
         }
 
         DrawPoloidalCoils(time, fieldCurrent);
         DrawDivertorAndHeatTiles(time, exhaust);
         DrawHeatingSystems(time, power);
         DrawDiagnostics(time);
-        DrawPlasmaSurfaces(time, power, magneticLines);
-        DrawParticles(particles, sparks, time, power);
+        DrawPlasmaSurfaces(lineMesh, time, power, magneticLines);
+        DrawParticles(sim, &particleRenderer, sparks, time, power);
 
         BeginBlendMode(BLEND_ADDITIVE);
         DrawSphere({0.0f, 0.0f, 0.0f}, 2.2f + 0.2f * std::sin(time * 2.0f), Color{90, 180, 255, static_cast<unsigned char>(20 + 25 * power)});
@@ -490,12 +939,18 @@ int main() {
 
         EndMode3D();
 
-        DrawHud(power, q, fieldCurrent, density, paused, cutaway, magneticLines);
+        DrawHud(sim, power, q, fieldCurrent, density, paused, cutaway, magneticLines);
         DrawFPS(GetScreenWidth() - 100, 18);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    lineMesh.Unload();
+    particleRenderer.Unload();
+    if (plasmaTexture.id != 0) UnloadTexture(plasmaTexture);
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
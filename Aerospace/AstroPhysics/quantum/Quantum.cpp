@@ -1,15 +1,43 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/bound_states.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+constexpr float kWellMin = -4.5f;  // hard walls at both ends of the drawn potential
+constexpr float kWellMax = 4.5f;
+constexpr int kGridPoints = 1200;
+constexpr int kStates = 8;
+constexpr float kSliderRate = 0.5f;  // per second while a key is held
+constexpr float kKeyStep = 0.01f;    // parameters are quantised to this for the memo
+
+float WellPotential(float x, float a, float w, float V0) {
+    return V0*((x*x)/(a*a) + w*std::sin(2*x));
+}
+
+float GridX(int i) {
+    const float h = (kWellMax - kWellMin) / (kGridPoints + 1);
+    return kWellMin + h * (i + 1);
+}
+
+std::vector<double> SampleWell(float a, float w, float V0) {
+    std::vector<double> v(kGridPoints);
+    for (int i=0;i<kGridPoints;++i) v[i] = WellPotential(GridX(i), a, w, V0);
+    return v;
+}
+
+float Quantise(float v) { return std::round(v / kKeyStep) * kKeyStep; }
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -29,8 +57,8 @@ void DrawPotentialWell(float a, float w, float V0) {
     for (int i=1;i<n;++i) {
         float x0 = -4.5f + 9.0f*(i-1)/(n-1.0f);
         float x1 = -4.5f + 9.0f*i/(n-1.0f);
-        float v0 = V0*((x0*x0)/(a*a) + w*std::sin(2*x0));
-        float v1 = V0*((x1*x1)/(a*a) + w*std::sin(2*x1));
+        float v0 = WellPotential(x0, a, w, V0);
+        float v1 = WellPotential(x1, a, w, V0);
         DrawLine3D({x0,0.2f+0.2f*v0,-1.4f}, {x1,0.2f+0.2f*v1,-1.4f}, Color{255,170,120,220});
     }
 }
@@ -55,48 +83,81 @@ int main() {
     bool paused=false;
     float t=0.0f;
 
+    // Eigenstates of the drawn potential, re-solved on a worker while V0 / w move.
+    const double h = (kWellMax - kWellMin) / (kGridPoints + 1);
+    astro_quantum::BoundStateCache solver;
+    solver.SolveNow({a, Quantise(w), Quantise(V0), 0.0f}, SampleWell(a, Quantise(w), Quantise(V0)), h, kStates);
+
     while (!WindowShouldClose()) {
+        const float dt = GetFrameTime();
         if (IsKeyPressed(KEY_P)) paused=!paused;
         if (IsKeyPressed(KEY_R)) { a=2.0f; w=0.35f; V0=0.8f; nState=2; paused=false; t=0.0f; }
         if (IsKeyPressed(KEY_LEFT_BRACKET)) nState = std::max(1, nState-1);
-        if (IsKeyPressed(KEY_RIGHT_BRACKET)) nState = std::min(8, nState+1);
-        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) V0 = std::max(0.2f, V0-0.05f);
-        if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) V0 = std::min(2.0f, V0+0.05f);
+        if (IsKeyPressed(KEY_RIGHT_BRACKET)) nState = std::min(kStates, nState+1);
+        if (IsKeyDown(KEY_MINUS) || IsKeyDown(KEY_KP_SUBTRACT)) V0 = std::max(0.2f, V0-kSliderRate*dt);
+        if (IsKeyDown(KEY_EQUAL) || IsKeyDown(KEY_KP_ADD)) V0 = std::min(2.0f, V0+kSliderRate*dt);
+        if (IsKeyDown(KEY_COMMA)) w = std::max(-1.0f, w-kSliderRate*dt);
+        if (IsKeyDown(KEY_PERIOD)) w = std::min(1.0f, w+kSliderRate*dt);
+
+        const float wq = Quantise(w), V0q = Quantise(V0);
+        const astro_quantum::BoundStateCache::Key key{a, wq, V0q, 0.0f};
+        if (key != solver.key()) solver.Request(key, SampleWell(a, wq, V0q), h, kStates);
+        solver.Acquire();
+        const astro_quantum::BoundStates& states = *solver.states();
+        const float* psi = states.State(nState-1);
+        const float energy = static_cast<float>(states.energy[nState-1]);
+        float peak = 1e-6f;
+        for (int i=0;i<kGridPoints;++i) peak = std::max(peak, std::fabs(psi[i]));
 
         UpdateOrbitCameraDragOnly(&camera,&camYaw,&camPitch,&camDistance);
-        if (!paused) t += GetFrameTime();
+        if (!paused) t += dt;
 
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
-        DrawPotentialWell(a,w,V0);
+        const astro_quantum::BoundStateCache::Key& shown = solver.key();
+        DrawPotentialWell(shown[0],shown[1],shown[2]);
+        DrawLine3D({kWellMin,0.2f+0.2f*energy,-1.4f}, {kWellMax,0.2f+0.2f*energy,-1.4f}, Color{130,220,255,150});
 
+        // psi(x, t) = psi_n(x) cos(E_n t), scaled to unit peak for display.
         const int n=200;
-        for (int i=1;i<n;++i) {
-            float x0 = -4.0f + 8.0f*(i-1)/(n-1.0f);
-            float x1 = -4.0f + 8.0f*i/(n-1.0f);
-            float psi0 = std::sin(nState*PI*(x0+4.0f)/8.0f);
-            float psi1 = std::sin(nState*PI*(x1+4.0f)/8.0f);
-            float y0 = 0.8f + 0.6f*psi0*std::cos(2.0f*t);
-            float y1 = 0.8f + 0.6f*psi1*std::cos(2.0f*t);
-            DrawLine3D({x0,y0,0.0f}, {x1,y1,0.0f}, Color{130,220,255,255});
-            DrawLine3D({x0,0.35f+0.45f*psi0*psi0,1.3f}, {x1,0.35f+0.45f*psi1*psi1,1.3f}, Color{255,210,130,220});
+        const float phase = std::cos(energy*t);
+        int prevIndex = -1;
+        for (int i=0;i<n;++i) {
+            const int index = std::min(kGridPoints-1, i*kGridPoints/(n-1));
+            if (prevIndex >= 0) {
+                float x0 = GridX(prevIndex), x1 = GridX(index);
+                float psi0 = psi[prevIndex]/peak, psi1 = psi[index]/peak;
+                float y0 = 0.8f + 0.6f*psi0*phase;
+                float y1 = 0.8f + 0.6f*psi1*phase;
+                DrawLine3D({x0,y0,0.0f}, {x1,y1,0.0f}, Color{130,220,255,255});
+                DrawLine3D({x0,0.35f+0.45f*psi0*psi0,1.3f}, {x1,0.35f+0.45f*psi1*psi1,1.3f}, Color{255,210,130,220});
+            }
+            prevIndex = index;
         }
 
         EndMode3D();
 
-        DrawText("Quantum States in a Potential (Conceptual)", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] quantum state n | +/- potential depth | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Quantum Bound States in a Potential Well", 20, 18, 29, Color{232,238,248,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] quantum state n | hold +/- potential depth | hold , . wobble w | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
 
         std::ostringstream os;
-        os << std::fixed << std::setprecision(2) << "n=" << nState << "  V0=" << V0 << "  (cyan: wavefunction, yellow: probability)";
+        os << std::fixed << std::setprecision(2) << "n=" << nState << "  V0=" << V0q << "  w=" << wq
+           << "  E_n=" << std::setprecision(3) << energy << "  (cyan: wavefunction, yellow: probability)";
+        if (solver.Busy()) os << "  [solving]";
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{126,224,255,255});
-        DrawFPS(20,110);
+        std::ostringstream info;
+        info << kGridPoints << "-point tridiagonal Hamiltonian  |  solves " << solver.solves() << "  memo hits " << solver.memoHits();
+        DrawText(info.str().c_str(), 20, 108, 18, Color{164,183,210,255});
+        DrawFPS(20,134);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,9 +1,18 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/hydrogen_orbitals.h"
+#include "../common/lod.h"
+#include "../common/point_cloud.h"
+#include "../common/profiler.h"
+
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <random>
+#include <string>
 #include <vector>
 
 namespace {
@@ -14,6 +23,11 @@ constexpr int kNucleons = 40;
 constexpr int kElectrons = 12;
 constexpr float kNucleusRadius = 0.25f;
 constexpr std::array<float, 3> kShellRadii = {1.1f, 1.65f, 2.2f};
+constexpr size_t kCloudCapacity = size_t{1} << 21;  // 32 MB of points on the GPU
+constexpr size_t kCloudBatch = size_t{1} << 16;     // full cloud in 32 frames
+constexpr float kCloudExtent = 2.4f;                 // display radius of the 99% sphere
+constexpr float kCloudPointPixels = 1.6f;
+constexpr unsigned char kCloudAlpha = 34;
 
 struct Nucleon {
     Vector3 pos;
@@ -126,6 +140,40 @@ void DrawShellGuides() {
     }
 }
 
+// Probability-cloud mode: samples of |psi_nlm|^2 appended to a persistent GPU buffer a
+// batch per frame until it is full, so the cloud sharpens over the first half second.
+struct OrbitalCloud {
+    astro_quantum::HydrogenOrbitalSampler sampler;
+    astro_render::PointCloudBuffer buffer;
+    uint64_t next = 0;
+    float scale = 1.0f;
+    std::vector<float> xyz;
+    std::vector<int8_t> sign;
+    std::vector<astro_render::CloudPoint> points;
+};
+
+void SelectOrbital(OrbitalCloud* cloud, int n, int l, int m) {
+    if (!cloud->sampler.Configure(n, l, m)) return;
+    cloud->scale = kCloudExtent / cloud->sampler.Radius99();
+    cloud->buffer.Clear();
+    cloud->next = 0;
+}
+
+void RefineCloud(OrbitalCloud* cloud) {
+    if (cloud->buffer.full()) return;
+    const size_t n = std::min(kCloudBatch, cloud->buffer.capacity() - cloud->buffer.size());
+    cloud->xyz.resize(3 * n);
+    cloud->sign.resize(n);
+    cloud->points.resize(n);
+    cloud->sampler.Sample(cloud->next, n, cloud->scale, cloud->xyz.data(), cloud->sign.data());
+    for (size_t i = 0; i < n; ++i) {
+        const Color c = cloud->sign[i] > 0 ? Color{90, 190, 255, kCloudAlpha} : Color{255, 140, 80, kCloudAlpha};
+        cloud->points[i] = {{cloud->xyz[3 * i], cloud->xyz[3 * i + 1], cloud->xyz[3 * i + 2]}, c};
+    }
+    cloud->buffer.Append(cloud->points.data(), n);
+    cloud->next += n;
+}
+
 void DrawElectronTrail(const Electron& e, float tNow, float duration, int samples, Color color) {
     Vector3 prev = ElectronPosition(e, tNow - duration);
     for (int i = 1; i <= samples; ++i) {
@@ -154,7 +202,28 @@ int main() {
     const std::vector<Nucleon> nucleus = MakeNucleus(rng);
     const std::vector<Electron> electrons = MakeElectrons(rng);
 
+    OrbitalCloud cloud;
+    cloud.buffer.Init(kCloudCapacity);
+    int qn = 4, ql = 3, qm = 1;
+    SelectOrbital(&cloud, qn, ql, qm);
+    bool cloudMode = false;
+
     while (!WindowShouldClose()) {
+        if (IsKeyPressed(KEY_C)) cloudMode = !cloudMode;
+        if (cloudMode) {
+            const int n0 = qn, l0 = ql, m0 = qm;
+            if (IsKeyPressed(KEY_UP)) qn = std::min(qn + 1, astro_quantum::HydrogenOrbitalSampler::kMaxN);
+            if (IsKeyPressed(KEY_DOWN)) qn = std::max(qn - 1, 1);
+            if (IsKeyPressed(KEY_RIGHT)) ++ql;
+            if (IsKeyPressed(KEY_LEFT)) --ql;
+            if (IsKeyPressed(KEY_RIGHT_BRACKET)) ++qm;
+            if (IsKeyPressed(KEY_LEFT_BRACKET)) --qm;
+            ql = std::clamp(ql, 0, qn - 1);
+            qm = std::clamp(qm, -ql, ql);
+            if (qn != n0 || ql != l0 || qm != m0) SelectOrbital(&cloud, qn, ql, qm);
+            RefineCloud(&cloud);
+        }
+
         UpdateCamera(&camera, CAMERA_ORBITAL);
         const float t = static_cast<float>(GetTime());
 
@@ -163,28 +232,47 @@ int main() {
 
         BeginMode3D(camera);
 
-        DrawShellGuides();
-        DrawSphere({0.0f, 0.0f, 0.0f}, kNucleusRadius * 1.35f, Color{255, 190, 100, 40});
-
-        for (const Nucleon& n : nucleus) {
-            DrawSphere(n.pos, 0.06f, n.color);
-        }
-
-        for (const Electron& e : electrons) {
-            DrawElectronTrail(e, t, 1.3f, 32, Color{130, 210, 255, 45});
-            const Vector3 p = ElectronPosition(e, t);
-            DrawSphere(p, 0.065f, Color{100, 230, 255, 255});
+        if (cloudMode) {
+            astro_render::DrawSphereLod({0.0f, 0.0f, 0.0f}, 0.05f, Color{255, 190, 100, 255});
+            BeginBlendMode(BLEND_ADDITIVE);
+            cloud.buffer.Draw(kCloudPointPixels);
+            EndBlendMode();
+        } else {
+            DrawShellGuides();
+            astro_render::DrawSphereLod({0.0f, 0.0f, 0.0f}, kNucleusRadius * 1.35f, Color{255, 190, 100, 40});
+
+            for (const Nucleon& n : nucleus) {
+                astro_render::DrawSphereLod(n.pos, 0.06f, n.color);
+            }
+
+            for (const Electron& e : electrons) {
+                DrawElectronTrail(e, t, 1.3f, 32, Color{130, 210, 255, 45});
+                const Vector3 p = ElectronPosition(e, t);
+                astro_render::DrawSphereLod(p, 0.065f, Color{100, 230, 255, 255});
+            }
         }
 
         EndMode3D();
 
-        DrawText("3D Atom Visualization (intuitive model)", 20, 20, 24, Color{230, 236, 245, 255});
-        DrawText("Mouse drag: orbit camera | Mouse wheel: zoom | ESC: exit", 20, 54, 18, Color{170, 184, 204, 255});
+        DrawText(cloudMode ? "3D Atom Visualization (hydrogen probability cloud)" : "3D Atom Visualization (intuitive model)", 20, 20, 24,
+                 Color{230, 236, 245, 255});
+        DrawText("Mouse drag: orbit camera | Mouse wheel: zoom | C: Bohr model / probability cloud | ESC: exit", 20, 54, 18,
+                 Color{170, 184, 204, 255});
         DrawFPS(20, 80);
+        if (cloudMode) {
+            const std::string info = "n=" + std::to_string(qn) + " l=" + std::to_string(ql) + " m=" + std::to_string(qm) + "  (UP/DOWN n, LEFT/RIGHT l, [ ] m)  " +
+                                     std::to_string(cloud.buffer.size() / 1000) + "k samples" + (cloud.buffer.full() ? "" : " [refining]") +
+                                     "  |  blue/orange = sign of psi";
+            DrawText(info.c_str(), 20, 106, 18, Color{126, 224, 255, 255});
+        }
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    cloud.buffer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,39 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "rlgl.h"
+
+#include "../common/alias_table.h"
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 
+// Detector screen: hits land on a kHitColumns x kHitRows texture spanning
+// [-kPatternHalf, kPatternHalf] across the fringes and [-kScreenHalfDepth, kScreenHalfDepth]
+// along the slits. One alias-table outcome per texel column.
+constexpr int kHitColumns = 768;
+constexpr int kHitRows = 192;
+constexpr float kPatternHalf = 2.4f;
+constexpr float kScreenHalfDepth = 1.2f;
+constexpr int kMaxHitsPerFrame = 250000;
+constexpr std::array<float, 6> kPhotonRates = {30.0f, 300.0f, 3000.0f, 30000.0f, 300000.0f, 3000000.0f};
+constexpr uint64_t kPhotonSeed = 0x5117D0u;
+constexpr int kPanelBins = 192;
+
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 d = GetMouseDelta();
@@ -31,9 +54,142 @@ float Intensity(float y, float sep, float lambda, float D) {
     float env = std::exp(-0.08f * y * y);
     return env * 0.5f * (1.0f + std::cos(phase));
 }
+
+// Photon-by-photon build-up: detections are drawn from Intensity() through an alias table
+// and tallied per texel, and the counts become a texture once per frame.
+struct DetectorScreen {
+    astro_random::AliasTable pattern;
+    std::vector<uint32_t> hits;         // kHitRows x kHitColumns, row-major
+    std::vector<uint32_t> columnHits;   // hits summed along the slits
+    std::vector<float> uniforms;
+    std::vector<Color> pixels;
+    uint64_t total = 0;
+    uint32_t peak = 0;
+    uint32_t batch = 0;
+    float carry = 0.0f;
+    float sep = -1.0f;
+    float lambda = -1.0f;
+    float D = -1.0f;
+};
+
+float ColumnY(int column) { return -kPatternHalf + 2.0f * kPatternHalf * (static_cast<float>(column) + 0.5f) / kHitColumns; }
+
+void ClearHits(DetectorScreen* screen) {
+    screen->hits.assign(static_cast<size_t>(kHitColumns) * kHitRows, 0);
+    screen->columnHits.assign(kHitColumns, 0);
+    screen->total = 0;
+    screen->peak = 0;
+    screen->carry = 0.0f;
+}
+
+// Rebuilds the table and starts a fresh exposure only when the geometry changed.
+void UpdatePattern(DetectorScreen* screen, float sep, float lambda, float D) {
+    if (sep == screen->sep && lambda == screen->lambda && D == screen->D) return;
+    std::vector<double> weights(kHitColumns);
+    for (int c = 0; c < kHitColumns; ++c) weights[static_cast<size_t>(c)] = Intensity(ColumnY(c), sep, lambda, D);
+    screen->pattern.Build(weights);
+    screen->sep = sep;
+    screen->lambda = lambda;
+    screen->D = D;
+    ClearHits(screen);
+}
+
+// Two uniforms per photon from one Philox batch: the column from the alias table and a
+// uniform row along the slits.
+void DetectPhotons(DetectorScreen* screen, int count) {
+    if (count <= 0) return;
+    screen->uniforms.resize(static_cast<size_t>(2 * count));
+    astro_random::FillUniform(astro_random::SeedKey(kPhotonSeed), screen->batch++, 0, 0, screen->uniforms.data(), screen->uniforms.size());
+    const float* u = screen->uniforms.data();
+    for (int n = 0; n < count; ++n) {
+        const uint32_t column = screen->pattern.Sample(u[2 * n]);
+        const uint32_t row = std::min(static_cast<uint32_t>(u[2 * n + 1] * kHitRows), static_cast<uint32_t>(kHitRows - 1));
+        const uint32_t hits = ++screen->hits[static_cast<size_t>(row) * kHitColumns + column];
+        ++screen->columnHits[column];
+        screen->peak = std::max(screen->peak, hits);
+    }
+    screen->total += static_cast<uint64_t>(count);
+}
+
+// While hits are sparse each one shows as a full-brightness dot; as they pile up the
+// scale follows the busiest texel.
+void UpdateHitTexture(DetectorScreen* screen, Texture2D texture) {
+    screen->pixels.resize(screen->hits.size());
+    const float scale = 1.0f / std::max(1.0f, 0.6f * static_cast<float>(screen->peak));
+    for (size_t i = 0; i < screen->hits.size(); ++i) {
+        const float b = std::sqrt(std::min(1.0f, static_cast<float>(screen->hits[i]) * scale));
+        screen->pixels[i] = {static_cast<unsigned char>(18 + 172 * b), static_cast<unsigned char>(24 + 211 * b),
+                             static_cast<unsigned char>(40 + 215 * b), 255};
+    }
+    UpdateTexture(texture, screen->pixels.data());
 }
 
-int main() {
+// Texel u runs along y (across the fringes), v along z; drawn on the face towards the
+// default camera, which sits beyond the screen.
+void DrawHitScreen(Texture2D texture, float x) {
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlNormal3f(1.0f, 0.0f, 0.0f);
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex3f(x, -kPatternHalf, -kScreenHalfDepth);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex3f(x, kPatternHalf, -kScreenHalfDepth);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex3f(x, kPatternHalf, kScreenHalfDepth);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex3f(x, -kPatternHalf, kScreenHalfDepth);
+    rlEnd();
+    rlSetTexture(0);
+}
+
+// Counted hits per bin against the intensity they were drawn from, both normalised to
+// their own peak.
+void DrawBuildUpPanel(const DetectorScreen& screen, int x, int y, int w, int h) {
+    DrawRectangle(x, y, w, h, Fade(Color{18, 26, 42, 255}, 0.92f));
+    DrawText("Detections vs intensity", x + 14, y + 10, 18, Color{220, 230, 244, 255});
+    std::array<float, kPanelBins> counts{};
+    std::array<float, kPanelBins> expected{};
+    const int per = kHitColumns / kPanelBins;
+    float countPeak = 1.0f, expectedPeak = 1.0e-6f;
+    for (int b = 0; b < kPanelBins; ++b) {
+        for (int c = b * per; c < (b + 1) * per; ++c) {
+            counts[static_cast<size_t>(b)] += static_cast<float>(screen.columnHits[static_cast<size_t>(c)]);
+            expected[static_cast<size_t>(b)] += Intensity(ColumnY(c), screen.sep, screen.lambda, screen.D);
+        }
+        countPeak = std::max(countPeak, counts[static_cast<size_t>(b)]);
+        expectedPeak = std::max(expectedPeak, expected[static_cast<size_t>(b)]);
+    }
+    const int base = y + h - 12;
+    const float barW = static_cast<float>(w - 28) / kPanelBins;
+    for (int b = 0; b < kPanelBins; ++b) {
+        const int bh = static_cast<int>((h - 48) * counts[static_cast<size_t>(b)] / countPeak);
+        DrawRectangle(x + 14 + static_cast<int>(b * barW), base - bh, std::max(1, static_cast<int>(barW)), bh, Color{110, 180, 255, 200});
+    }
+    for (int b = 1; b < kPanelBins; ++b) {
+        const int y0 = base - static_cast<int>((h - 48) * expected[static_cast<size_t>(b - 1)] / expectedPeak);
+        const int y1 = base - static_cast<int>((h - 48) * expected[static_cast<size_t>(b)] / expectedPeak);
+        DrawLine(x + 14 + static_cast<int>((b - 0.5f) * barW), y0, x + 14 + static_cast<int>((b + 0.5f) * barW), y1, Color{255, 210, 130, 255});
+    }
+}
+}
+
+int main(int argc, char** argv) {
+    // Headless runs time the detector at the top photon rate.
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 300, 1.0f / 60.0f);
+    if (bench.enabled) {
+        DetectorScreen screen;
+        UpdatePattern(&screen, 1.2f, 0.8f, 6.5f);
+        return astro_bench::RunBench(
+            "double_slit_viz", bench,
+            [&](float dt) { DetectPhotons(&screen, std::min(kMaxHitsPerFrame, static_cast<int>(kPhotonRates.back() * dt))); },
+            [&]() {
+                double mean = 0.0;
+                for (int c = 0; c < kHitColumns; ++c) mean += ColumnY(c) * static_cast<double>(screen.columnHits[static_cast<size_t>(c)]);
+                return static_cast<float>(mean / std::max<uint64_t>(screen.total, 1)) + static_cast<float>(screen.peak);
+            });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Double Slit Interference 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -47,22 +203,44 @@ int main() {
 
     float sep = 1.2f;
     float lambda = 0.8f;
+    float screenX = 6.5f;
+    int rateIndex = 2;
+    bool showCurve = false;
     bool paused = false;
     float t = 0.0f;
 
+    DetectorScreen detector;
+    Image hitImage = GenImageColor(kHitColumns, kHitRows, BLANK);
+    Texture2D hitTexture = LoadTextureFromImage(hitImage);
+    UnloadImage(hitImage);
+    SetTextureFilter(hitTexture, TEXTURE_FILTER_BILINEAR);
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_R)) { sep=1.2f; lambda=0.8f; paused=false; t=0.0f; }
+        if (IsKeyPressed(KEY_R)) { sep=1.2f; lambda=0.8f; screenX=6.5f; rateIndex=2; paused=false; t=0.0f; ClearHits(&detector); }
         if (IsKeyPressed(KEY_LEFT_BRACKET)) sep = std::max(0.4f, sep-0.05f);
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) sep = std::min(2.4f, sep+0.05f);
         if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) lambda = std::max(0.2f, lambda-0.03f);
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) lambda = std::min(1.6f, lambda+0.03f);
+        if (IsKeyPressed(KEY_LEFT)) screenX = std::max(3.0f, screenX-0.25f);
+        if (IsKeyPressed(KEY_RIGHT)) screenX = std::min(9.0f, screenX+0.25f);
+        if (IsKeyPressed(KEY_UP)) rateIndex = std::min(static_cast<int>(kPhotonRates.size()) - 1, rateIndex+1);
+        if (IsKeyPressed(KEY_DOWN)) rateIndex = std::max(0, rateIndex-1);
+        if (IsKeyPressed(KEY_C)) showCurve = !showCurve;
+        if (IsKeyPressed(KEY_SPACE)) ClearHits(&detector);
 
         UpdateOrbitCameraDragOnly(&camera,&camYaw,&camPitch,&camDistance);
         if (!paused) t += GetFrameTime();
 
         const float barrierX = 0.0f;
-        const float screenX = 6.5f;
+        UpdatePattern(&detector, sep, lambda, screenX-barrierX);
+        if (!paused) {
+            detector.carry += kPhotonRates[static_cast<size_t>(rateIndex)] * GetFrameTime();
+            const int photons = std::min(kMaxHitsPerFrame, static_cast<int>(detector.carry));
+            detector.carry = std::min(detector.carry - static_cast<float>(photons), 1.0f);
+            DetectPhotons(&detector, photons);
+        }
+        UpdateHitTexture(&detector, hitTexture);
 
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
@@ -77,11 +255,12 @@ int main() {
         DrawSphere(s1,0.08f,Color{130,220,255,255});
         DrawSphere(s2,0.08f,Color{130,220,255,255});
 
-        for (int i=0;i<140;++i) {
+        DrawHitScreen(hitTexture, screenX+0.065f);
+        for (int i=0;showCurve && i<140;++i) {
             float y = -2.4f + 4.8f * i / 139.0f;
             float I = Intensity(y, sep, lambda, screenX-barrierX);
             Color c = Color{static_cast<unsigned char>(90 + 160*I), static_cast<unsigned char>(120 + 110*I), static_cast<unsigned char>(170 + 80*I), 255};
-            DrawSphere({screenX+0.12f, y, 0.0f}, 0.02f + 0.04f*I, c);
+            DrawSphere({screenX+0.16f, y, 0.0f}, 0.02f + 0.04f*I, c);
         }
 
         for (int i=0;i<12;++i) {
@@ -98,16 +277,24 @@ int main() {
         EndMode3D();
 
         DrawText("Double Slit: Interference Pattern on Screen", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] slit separation | +/- wavelength | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] slit separation | +/- wavelength | Left/Right screen distance | Up/Down photon rate | Space clear | C curve | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
         std::ostringstream os;
-        os << std::fixed << std::setprecision(2) << "sep=" << sep << "  lambda=" << lambda;
+        os << std::fixed << std::setprecision(2) << "sep=" << sep << "  lambda=" << lambda << "  D=" << screenX-barrierX;
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{126,224,255,255});
         DrawFPS(20,110);
+        std::ostringstream hitsHud;
+        hitsHud << "photons: " << detector.total << "  rate=" << static_cast<long>(kPhotonRates[static_cast<size_t>(rateIndex)]) << "/s";
+        DrawText(hitsHud.str().c_str(), 20, 138, 20, Color{150,200,255,255});
+        DrawBuildUpPanel(detector, 870, 560, 390, 220);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    UnloadTexture(hitTexture);
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
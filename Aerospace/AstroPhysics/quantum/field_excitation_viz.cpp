@@ -1,10 +1,19 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+
+#include "../common/dynamic_resolution.h"
+#include "../common/frame_capture.h"
+#include "../common/hud_text.h"
+#include "../common/headless_bench.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+#include "../common/thread_pool.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <random>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -12,12 +21,18 @@ namespace {
 
 constexpr int kScreenWidth = 1440;
 constexpr int kScreenHeight = 900;
-constexpr int kGridX = 92;
-constexpr int kGridZ = 92;
+// Field samples per side; N cycles through kGridSizes in the window.
+constexpr int kDefaultGrid = 92;
+constexpr std::array<int, 3> kGridSizes = {92, 256, 512};
+constexpr int kMaxGrid = 512;
 constexpr float kXMin = -9.0f;
 constexpr float kXMax = 9.0f;
 constexpr float kZMin = -9.0f;
 constexpr float kZMax = 9.0f;
+// Field sources are dropped where they would move a sample by less than this, and are
+// binned into square tiles of kFieldTile samples per side.
+constexpr float kFieldCutoff = 1.0e-3f;
+constexpr int kFieldTile = 8;
 
 enum class DemoMode {
     kVacuum = 0,
@@ -160,15 +175,18 @@ float PacketDecayDuration(int level) {
     return 1.45f + 0.24f * static_cast<float>(level);
 }
 
-int FieldIndex(int ix, int iz) {
-    return iz * kGridX + ix;
+int FieldIndex(int ix, int iz, int grid) {
+    return iz * grid + ix;
 }
 
-float RandRange(std::mt19937& rng, float lo, float hi) {
-    std::uniform_real_distribution<float> dist(lo, hi);
-    return dist(rng);
+float FieldCoordinate(float lo, float hi, int i, int grid) {
+    return lo + (hi - lo) * static_cast<float>(i) / static_cast<float>(grid - 1);
 }
 
+using Rng = astro_random::PhiloxStream;
+
+float RandRange(Rng& rng, float lo, float hi) { return rng.Uniform(lo, hi); }
+
 float Saturate(float x) {
     return std::clamp(x, 0.0f, 1.0f);
 }
@@ -277,7 +295,7 @@ float VacuumSecondary(float x, float z, float time) {
 }
 
 std::vector<VacuumFluctuation> MakeVacuumFluctuations() {
-    std::mt19937 rng(4242);
+    Rng rng(4242);
     std::vector<VacuumFluctuation> fluctuations;
     fluctuations.reserve(18);
 
@@ -295,26 +313,38 @@ std::vector<VacuumFluctuation> MakeVacuumFluctuations() {
     return fluctuations;
 }
 
-float VacuumLocalizedContribution(const VacuumFluctuation& fluctuation, float x, float z, float time, bool coupled) {
+// Fluctuations wobble around their anchor; the centre is the same for every sample.
+Vector2 FluctuationCenter(const VacuumFluctuation& fluctuation, float time) {
     const float wobbleX = 0.38f * std::sin(time * fluctuation.drift + fluctuation.phase);
     const float wobbleZ = 0.38f * std::cos(time * (0.82f * fluctuation.drift) - fluctuation.phase * 0.6f);
-    const Vector2 center = {
+    return {
         fluctuation.center.x + wobbleX,
         fluctuation.center.y + wobbleZ,
     };
+}
 
+// Primary and coupled-field values of one source at one sample. The two share the
+// envelope and differ only in phase, so they are evaluated together.
+struct FieldPair {
+    float primary = 0.0f;
+    float coupled = 0.0f;
+};
+
+FieldPair VacuumLocalizedContribution(const VacuumFluctuation& fluctuation, Vector2 center, float x, float z, float time) {
     const Vector2 delta = {x - center.x, z - center.y};
-    const float envelope = Gaussian2D(delta, fluctuation.sigma);
+    const float envelope = fluctuation.amplitude * Gaussian2D(delta, fluctuation.sigma);
     const float radial = std::sqrt(delta.x * delta.x + delta.y * delta.y);
-    const float phase = fluctuation.omega * time + fluctuation.phase + (coupled ? 0.8f : 0.0f);
-    const float ripple = std::sin(4.8f * radial - phase) + 0.55f * std::cos(2.8f * radial + 1.2f * phase);
-    return fluctuation.amplitude * envelope * ripple;
+    const float phase = fluctuation.omega * time + fluctuation.phase;
+    const float coupledPhase = phase + 0.8f;
+    return {
+        envelope * (std::sin(4.8f * radial - phase) + 0.55f * std::cos(2.8f * radial + 1.2f * phase)),
+        envelope * (std::sin(4.8f * radial - coupledPhase) + 0.55f * std::cos(2.8f * radial + 1.2f * coupledPhase)),
+    };
 }
 
-float TravelingContribution(const TravelingExcitation& excitation, float x, float z, float time, bool coupled) {
+FieldPair TravelingContribution(const TravelingExcitation& excitation, float x, float z, float time) {
     const Vector2 sample = {x, z};
     const Vector2 delta = Vector2Subtract(sample, excitation.pos);
-    const float envelope = Gaussian2D(delta, excitation.sigma);
     Vector2 dir = excitation.vel;
     if (Vector2Length(dir) < 1.0e-5f) dir = {1.0f, 0.0f};
     dir = Vector2Normalize(dir);
@@ -323,10 +353,10 @@ float TravelingContribution(const TravelingExcitation& excitation, float x, floa
     const float cross = delta.x * (-dir.y) + delta.y * dir.x;
     const float k = 2.0f * PI / excitation.wavelength;
     const float ageFade = Saturate(1.0f - excitation.age / excitation.life);
-    const float phaseShift = coupled ? 0.7f : 0.0f;
-    const float coupledSkew = coupled ? 0.22f * std::sin(cross * 1.8f + 0.9f * time) : 0.0f;
-    return excitation.amplitude * ageFade * envelope *
-           std::cos(k * proj - excitation.omega * time + excitation.phase + phaseShift + coupledSkew);
+    const float envelope = excitation.amplitude * ageFade * Gaussian2D(delta, excitation.sigma);
+    const float phase = k * proj - excitation.omega * time + excitation.phase;
+    const float coupledSkew = 0.22f * std::sin(cross * 1.8f + 0.9f * time);
+    return {envelope * std::cos(phase), envelope * std::cos(phase + 0.7f + coupledSkew)};
 }
 
 float StableContribution(const StablePacket& packet, float x, float z, float time, bool coupled) {
@@ -356,6 +386,17 @@ float StableContribution(const StablePacket& packet, float x, float z, float tim
             0.46f * formationShell);
 }
 
+// Angular filaments of the coupled field around a packet.
+float StableFilamentContribution(const StablePacket& packet, float x, float z, float time) {
+    const Vector2 delta = {x - packet.pos.x, z - packet.pos.y};
+    const float radial = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+    const float angular = std::atan2(delta.y, delta.x);
+    const float stageWeight = PacketStageWeight(packet);
+    const float filament = std::exp(-radial * (1.4f - 0.12f * packet.level)) *
+                           std::sin((3.0f + packet.level) * angular - 1.3f * time + packet.phase);
+    return (0.18f + 0.10f * packet.level + 0.18f * packet.transitionGlow) * stageWeight * filament;
+}
+
 float RingContribution(const ShockRing& ring, float x, float z, bool coupled) {
     const Vector2 sample = {x, z};
     const Vector2 delta = Vector2Subtract(sample, ring.center);
@@ -367,7 +408,7 @@ float RingContribution(const ShockRing& ring, float x, float z, bool coupled) {
     return ring.amplitude * fade * shell * std::sin(4.2f * radial - 2.0f * ring.age + phase);
 }
 
-TravelingExcitation MakeTravelingExcitationSafe(Vector2 pos, Vector2 vel, Color color, float phase, float amplitudeScale, std::mt19937* rng) {
+TravelingExcitation MakeTravelingExcitationSafe(Vector2 pos, Vector2 vel, Color color, float phase, float amplitudeScale, Rng* rng) {
     TravelingExcitation excitation{};
     excitation.pos = pos;
     excitation.vel = vel;
@@ -383,7 +424,7 @@ TravelingExcitation MakeTravelingExcitationSafe(Vector2 pos, Vector2 vel, Color
     return excitation;
 }
 
-StablePacket MakeQuantizedPacket(Vector2 center, int level, Color seedColor, std::mt19937* rng) {
+StablePacket MakeQuantizedPacket(Vector2 center, int level, Color seedColor, Rng* rng) {
     const QuantizedPacketPreset& preset = kPacketPresets[std::clamp(level, 0, 2)];
     StablePacket packet{};
     packet.pos = center;
@@ -403,7 +444,7 @@ StablePacket MakeQuantizedPacket(Vector2 center, int level, Color seedColor, std
     return packet;
 }
 
-void AddShockBurst(std::vector<ShockRing>* rings, std::vector<Spark>* sparks, Vector2 center, int level, std::mt19937* rng);
+void AddShockBurst(std::vector<ShockRing>* rings, std::vector<Spark>* sparks, Vector2 center, int level, Rng* rng);
 
 void PromotePacket(StablePacket* packet, Color inputColor) {
     if (packet->level < 2) ++packet->level;
@@ -419,7 +460,7 @@ void PromotePacket(StablePacket* packet, Color inputColor) {
     packet->color = LerpColor(packet->color, LerpColor(inputColor, preset.color, 0.7f), 0.65f);
 }
 
-bool DemotePacket(StablePacket* packet, std::vector<TravelingExcitation>* traveling, std::vector<ShockRing>* rings, std::vector<Spark>* sparks, std::mt19937* rng) {
+bool DemotePacket(StablePacket* packet, std::vector<TravelingExcitation>* traveling, std::vector<ShockRing>* rings, std::vector<Spark>* sparks, Rng* rng) {
     if (packet->level > 0) {
         --packet->level;
         const QuantizedPacketPreset& preset = kPacketPresets[packet->level];
@@ -445,17 +486,17 @@ bool DemotePacket(StablePacket* packet, std::vector<TravelingExcitation>* travel
     return true;
 }
 
-void SpawnCollisionPair(std::vector<TravelingExcitation>* traveling, std::mt19937* rng, float offset) {
+void SpawnCollisionPair(std::vector<TravelingExcitation>* traveling, Rng* rng, float offset) {
     traveling->push_back(MakeTravelingExcitationSafe({kXMin + 1.0f, offset}, {3.0f, 0.0f}, Color{64, 232, 255, 255}, 0.0f, 1.0f, rng));
     traveling->push_back(MakeTravelingExcitationSafe({kXMax - 1.0f, -offset}, {-3.0f, 0.0f}, Color{255, 86, 214, 255}, PI, 1.0f, rng));
 }
 
-void SpawnDiagonalPair(std::vector<TravelingExcitation>* traveling, std::mt19937* rng) {
+void SpawnDiagonalPair(std::vector<TravelingExcitation>* traveling, Rng* rng) {
     traveling->push_back(MakeTravelingExcitationSafe({-7.0f, -6.2f}, {2.5f, 2.0f}, Color{112, 255, 178, 255}, 0.5f, 0.95f, rng));
     traveling->push_back(MakeTravelingExcitationSafe({6.8f, 6.0f}, {-2.3f, -2.1f}, Color{255, 180, 96, 255}, 2.8f, 0.95f, rng));
 }
 
-void SpawnTravelingTrain(std::vector<TravelingExcitation>* traveling, std::mt19937* rng) {
+void SpawnTravelingTrain(std::vector<TravelingExcitation>* traveling, Rng* rng) {
     const float z = RandRange(*rng, -4.6f, 4.6f);
     const float direction = RandRange(*rng, 0.0f, 1.0f) > 0.5f ? 1.0f : -1.0f;
     const float x = direction > 0.0f ? kXMin + 0.8f : kXMax - 0.8f;
@@ -463,7 +504,7 @@ void SpawnTravelingTrain(std::vector<TravelingExcitation>* traveling, std::mt199
     traveling->push_back(MakeTravelingExcitationSafe({x, z}, velocity, Color{90, 226, 255, 255}, RandRange(*rng, 0.0f, 2.0f * PI), 0.9f, rng));
 }
 
-void AddShockBurst(std::vector<ShockRing>* rings, std::vector<Spark>* sparks, Vector2 center, int level, std::mt19937* rng) {
+void AddShockBurst(std::vector<ShockRing>* rings, std::vector<Spark>* sparks, Vector2 center, int level, Rng* rng) {
     const float levelScale = 1.0f + 0.25f * static_cast<float>(level);
     rings->push_back({center, 0.0f, 4.8f * levelScale, 0.28f, 0.75f * levelScale, 2.6f, 0.0f, Color{92, 230, 255, 255}});
     rings->push_back({center, 0.0f, 6.2f * levelScale, 0.42f, 0.62f * levelScale, 3.0f, 0.0f, Color{255, 110, 214, 255}});
@@ -489,7 +530,7 @@ void ResetSceneForMode(DemoMode mode,
                        std::vector<StablePacket>* stable,
                        std::vector<ShockRing>* rings,
                        std::vector<Spark>* sparks,
-                       std::mt19937* rng,
+                       Rng* rng,
                        int* mergeCount,
                        float* cycleTimer,
                        float* simTime) {
@@ -535,83 +576,477 @@ void ApplyStablePacketInteractions(std::vector<StablePacket>* stable, float dt)
     }
 }
 
+// Energy sums of one grid row, added up in row order so the metrics do not depend
+// on how the rows were split across threads.
+struct FieldRowSums {
+    float primaryEnergy = 0.0f;
+    float secondaryEnergy = 0.0f;
+    float transfer = 0.0f;
+};
+
+// Where one source can still move the field by more than kFieldCutoff: the annulus
+// inner <= |p - center| <= outer (inner is 0 for everything but shock rings).
+struct SourceSupport {
+    Vector2 center{};
+    float inner = 0.0f;
+    float outer = 0.0f;
+};
+
+// Radius beyond which amplitude * exp(-r^2 / (2 sigma^2)) stays below kFieldCutoff.
+float GaussianSupport(float amplitude, float sigma) {
+    const float a = std::fabs(amplitude);
+    if (a <= kFieldCutoff) return 0.0f;
+    return sigma * std::sqrt(2.0f * std::log(a / kFieldCutoff));
+}
+
+// Bounds below take the larger of the primary and coupled weights of each term.
+SourceSupport FluctuationSupport(const VacuumFluctuation& fluctuation, Vector2 center, float scale) {
+    return {center, 0.0f, GaussianSupport(1.55f * scale * fluctuation.amplitude, fluctuation.sigma)};
+}
+
+SourceSupport TravelingSupport(const TravelingExcitation& excitation) {
+    const float ageFade = Saturate(1.0f - excitation.age / excitation.life);
+    return {excitation.pos, 0.0f, GaussianSupport(excitation.amplitude * ageFade, excitation.sigma)};
+}
+
+SourceSupport StableSupport(const StablePacket& packet) {
+    const float coupledAmplitude = 1.18f * packet.amplitude * (0.90f + 0.24f * packet.level + 0.30f * packet.transitionGlow) *
+                                   (1.0f + 0.35f * packet.transitionGlow);
+    float outer = GaussianSupport(coupledAmplitude, packet.sigma);
+    if (packet.stage == PacketStage::kForming) {
+        outer = std::max(outer, 1.4f + GaussianSupport(0.46f * coupledAmplitude, 0.14f));
+    } else if (packet.stage == PacketStage::kDecaying) {
+        outer = std::max(outer, 1.5f + GaussianSupport(0.46f * coupledAmplitude, 0.18f));
+    }
+    const float filament = (0.18f + 0.10f * packet.level + 0.18f * packet.transitionGlow) * PacketStageWeight(packet);
+    if (filament > kFieldCutoff) outer = std::max(outer, std::log(filament / kFieldCutoff) / (1.4f - 0.12f * packet.level));
+    return {packet.pos, 0.0f, outer};
+}
+
+SourceSupport RingSupport(const ShockRing& ring) {
+    const float fade = Saturate(1.0f - ring.age / ring.life);
+    const float halfWidth = GaussianSupport(ring.amplitude * fade, 1.22f * ring.width);
+    if (halfWidth <= 0.0f) return {ring.center, 0.0f, 0.0f};
+    return {ring.center, std::max(0.0f, ring.radius - halfWidth), ring.radius + halfWidth};
+}
+
+// Sources binned into square tiles of kFieldTile x kFieldTile samples by their
+// support. Each tile lists the sources that reach it (kind in the top two bits, index
+// below) in a compressed table that is rebuilt every frame without reallocating once
+// it has grown.
+class FieldSourceBins {
+  public:
+    enum Kind : uint32_t { kFluctuation = 0, kTraveling = 1, kStable = 2, kRing = 3 };
+    static constexpr uint32_t kIndexMask = (1u << 30) - 1u;
+
+    void Begin(int grid) {
+        grid_ = grid;
+        tiles_ = (grid + kFieldTile - 1) / kFieldTile;
+        supports_.clear();
+        refs_.clear();
+    }
+
+    void Add(Kind kind, uint32_t index, const SourceSupport& support) {
+        if (support.outer <= 0.0f) return;
+        supports_.push_back(support);
+        refs_.push_back((static_cast<uint32_t>(kind) << 30) | index);
+    }
+
+    // Counting sort of (source, tile) overlaps into the per-tile lists.
+    void Finish() {
+        tileStart_.assign(static_cast<size_t>(tiles_) * tiles_ + 1, 0);
+        ForEachOverlap([&](int tile, size_t) { ++tileStart_[tile + 1]; });
+        for (size_t t = 1; t < tileStart_.size(); ++t) tileStart_[t] += tileStart_[t - 1];
+        entries_.resize(tileStart_.back());
+        fill_.assign(tileStart_.begin(), tileStart_.end() - 1);
+        ForEachOverlap([&](int tile, size_t source) { entries_[fill_[tile]++] = refs_[source]; });
+    }
+
+    int tiles() const { return tiles_; }
+    size_t sources() const { return refs_.size(); }
+    size_t overlaps() const { return entries_.size(); }
+    const uint32_t* begin(int tx, int tz) const { return entries_.data() + tileStart_[static_cast<size_t>(tz) * tiles_ + tx]; }
+    const uint32_t* end(int tx, int tz) const { return entries_.data() + tileStart_[static_cast<size_t>(tz) * tiles_ + tx + 1]; }
+
+  private:
+    float TileEdge(float lo, float hi, int sample) const {
+        return FieldCoordinate(lo, hi, std::min(sample, grid_ - 1), grid_);
+    }
+
+    template <typename F>
+    void ForEachOverlap(F&& f) const {
+        const float spacingX = (kXMax - kXMin) / static_cast<float>(grid_ - 1);
+        const float spacingZ = (kZMax - kZMin) / static_cast<float>(grid_ - 1);
+        const float tileX = spacingX * kFieldTile;
+        const float tileZ = spacingZ * kFieldTile;
+        for (size_t i = 0; i < supports_.size(); ++i) {
+            const SourceSupport& support = supports_[i];
+            const int tx0 = std::clamp(static_cast<int>((support.center.x - support.outer - kXMin) / tileX), 0, tiles_ - 1);
+            const int tx1 = std::clamp(static_cast<int>((support.center.x + support.outer - kXMin) / tileX), 0, tiles_ - 1);
+            const int tz0 = std::clamp(static_cast<int>((support.center.y - support.outer - kZMin) / tileZ), 0, tiles_ - 1);
+            const int tz1 = std::clamp(static_cast<int>((support.center.y + support.outer - kZMin) / tileZ), 0, tiles_ - 1);
+            if (support.center.x + support.outer < kXMin || support.center.x - support.outer > kXMax ||
+                support.center.y + support.outer < kZMin || support.center.y - support.outer > kZMax) {
+                continue;
+            }
+            for (int tz = tz0; tz <= tz1; ++tz) {
+                const float z0 = TileEdge(kZMin, kZMax, tz * kFieldTile);
+                const float z1 = TileEdge(kZMin, kZMax, tz * kFieldTile + kFieldTile - 1);
+                const float nearZ = std::clamp(support.center.y, z0, z1) - support.center.y;
+                const float farZ = std::max(std::fabs(z0 - support.center.y), std::fabs(z1 - support.center.y));
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    const float x0 = TileEdge(kXMin, kXMax, tx * kFieldTile);
+                    const float x1 = TileEdge(kXMin, kXMax, tx * kFieldTile + kFieldTile - 1);
+                    const float nearX = std::clamp(support.center.x, x0, x1) - support.center.x;
+                    const float farX = std::max(std::fabs(x0 - support.center.x), std::fabs(x1 - support.center.x));
+                    if (nearX * nearX + nearZ * nearZ > support.outer * support.outer) continue;
+                    if (farX * farX + farZ * farZ < support.inner * support.inner) continue;
+                    f(tz * tiles_ + tx, i);
+                }
+            }
+        }
+    }
+
+    int grid_ = 0;
+    int tiles_ = 0;
+    std::vector<SourceSupport> supports_;
+    std::vector<uint32_t> refs_;
+    std::vector<uint32_t> tileStart_;
+    std::vector<uint32_t> fill_;
+    std::vector<uint32_t> entries_;
+};
+
+// Evaluates both fields at grid x grid samples. The vacuum background is dense; every
+// other source is binned by its support and only evaluated on the tiles it reaches, so
+// a frame costs O(grid^2 + sum of footprints) instead of O(grid^2 x sources). Tile
+// rows are independent and are spread over the shared thread pool.
 void BuildFieldCaches(const std::vector<TravelingExcitation>& traveling,
                       const std::vector<StablePacket>& stable,
                       const std::vector<ShockRing>& rings,
                       const std::vector<VacuumFluctuation>& fluctuations,
                       DemoMode mode,
                       float time,
+                      int grid,
                       std::vector<float>* primary,
                       std::vector<float>* secondary,
+                      std::vector<FieldRowSums>* rowSums,
+                      std::vector<Vector2>* fluctuationCenters,
+                      FieldSourceBins* bins,
                       Metrics* metrics) {
-    primary->assign(kGridX * kGridZ, 0.0f);
-    secondary->assign(kGridX * kGridZ, 0.0f);
+    primary->resize(static_cast<size_t>(grid) * grid);
+    secondary->resize(static_cast<size_t>(grid) * grid);
+    rowSums->assign(grid, FieldRowSums{});
+
+    const float fluctuationScale = mode == DemoMode::kVacuum ? 1.0f : 0.22f;
+    fluctuationCenters->resize(fluctuations.size());
+    bins->Begin(grid);
+    for (size_t i = 0; i < fluctuations.size(); ++i) {
+        (*fluctuationCenters)[i] = FluctuationCenter(fluctuations[i], time);
+        bins->Add(FieldSourceBins::kFluctuation, static_cast<uint32_t>(i),
+                  FluctuationSupport(fluctuations[i], (*fluctuationCenters)[i], fluctuationScale));
+    }
+    for (size_t i = 0; i < traveling.size(); ++i) bins->Add(FieldSourceBins::kTraveling, static_cast<uint32_t>(i), TravelingSupport(traveling[i]));
+    for (size_t i = 0; i < stable.size(); ++i) bins->Add(FieldSourceBins::kStable, static_cast<uint32_t>(i), StableSupport(stable[i]));
+    for (size_t i = 0; i < rings.size(); ++i) bins->Add(FieldSourceBins::kRing, static_cast<uint32_t>(i), RingSupport(rings[i]));
+    bins->Finish();
+
+    const std::vector<Vector2>& centers = *fluctuationCenters;
+    const auto buildTileRows = [&](int tileRowBegin, int tileRowEnd) {
+        for (int tz = tileRowBegin; tz < tileRowEnd; ++tz) {
+            const int izEnd = std::min(grid, (tz + 1) * kFieldTile);
+            for (int tx = 0; tx < bins->tiles(); ++tx) {
+                const int ixEnd = std::min(grid, (tx + 1) * kFieldTile);
+                const uint32_t* sourcesBegin = bins->begin(tx, tz);
+                const uint32_t* sourcesEnd = bins->end(tx, tz);
+                for (int iz = tz * kFieldTile; iz < izEnd; ++iz) {
+                    const float z = FieldCoordinate(kZMin, kZMax, iz, grid);
+                    FieldRowSums& sums = (*rowSums)[iz];
+                    for (int ix = tx * kFieldTile; ix < ixEnd; ++ix) {
+                        const float x = FieldCoordinate(kXMin, kXMax, ix, grid);
+
+                        float p = VacuumPrimary(x, z, time);
+                        float s = VacuumSecondary(x, z, time);
+                        for (const uint32_t* ref = sourcesBegin; ref != sourcesEnd; ++ref) {
+                            const uint32_t index = *ref & FieldSourceBins::kIndexMask;
+                            switch (*ref >> 30) {
+                                case FieldSourceBins::kFluctuation: {
+                                    const VacuumFluctuation& fluctuation = fluctuations[index];
+                                    const FieldPair f = VacuumLocalizedContribution(fluctuation, centers[index], x, z, time);
+                                    p += fluctuationScale * f.primary;
+                                    s += fluctuationScale * 0.82f * f.coupled;
+                                    break;
+                                }
+                                case FieldSourceBins::kTraveling: {
+                                    const FieldPair f = TravelingContribution(traveling[index], x, z, time);
+                                    p += f.primary;
+                                    s += 0.46f * f.coupled;
+                                    break;
+                                }
+                                case FieldSourceBins::kStable:
+                                    p += StableContribution(stable[index], x, z, time, false);
+                                    s += 1.18f * StableContribution(stable[index], x, z, time, true);
+                                    s += StableFilamentContribution(stable[index], x, z, time);
+                                    break;
+                                case FieldSourceBins::kRing:
+                                    p += RingContribution(rings[index], x, z, false);
+                                    s += 0.70f * RingContribution(rings[index], x, z, true);
+                                    break;
+                            }
+                        }
 
-    float primaryEnergy = 0.0f;
-    float secondaryEnergy = 0.0f;
-    float transfer = 0.0f;
+                        (*primary)[FieldIndex(ix, iz, grid)] = 0.68f * p;
+                        (*secondary)[FieldIndex(ix, iz, grid)] = 0.52f * s;
+                        sums.primaryEnergy += p * p;
+                        sums.secondaryEnergy += s * s;
+                        sums.transfer += std::fabs(p - s);
+                    }
+                }
+            }
+        }
+    };
+    astro_parallel::SharedPool().ParallelFor(bins->tiles(), 1, buildTileRows);
+
+    FieldRowSums total{};
+    for (const FieldRowSums& row : *rowSums) {
+        total.primaryEnergy += row.primaryEnergy;
+        total.secondaryEnergy += row.secondaryEnergy;
+        total.transfer += row.transfer;
+    }
     float localizedEnergy = 0.0f;
+    for (const StablePacket& packet : stable) localizedEnergy += packet.amplitude * packet.amplitude * PacketStageWeight(packet);
+
+    const float denom = static_cast<float>(grid) * static_cast<float>(grid);
+    metrics->primaryEnergy = total.primaryEnergy / denom;
+    metrics->secondaryEnergy = total.secondaryEnergy / denom;
+    metrics->transfer = total.transfer / denom;
+    metrics->localizedEnergy = localizedEnergy / std::max(1.0f, static_cast<float>(stable.size()));
+}
+
+// Field simulation state; the render loop only reads it.
+struct FieldScene {
+    std::vector<TravelingExcitation> traveling;
+    std::vector<StablePacket> stable;
+    std::vector<ShockRing> rings;
+    std::vector<Spark> sparks;
+    std::vector<VacuumFluctuation> fluctuations = MakeVacuumFluctuations();
+    int grid = kDefaultGrid;
+    std::vector<float> primary = std::vector<float>(kDefaultGrid * kDefaultGrid, 0.0f);
+    std::vector<float> secondary = std::vector<float>(kDefaultGrid * kDefaultGrid, 0.0f);
+    std::vector<FieldRowSums> rowSums;
+    std::vector<Vector2> fluctuationCenters;
+    FieldSourceBins sourceBins;
+    Rng rng{9001};
+    int mergeCount = 0;
+    float simTime = 0.0f;
+    float cycleTimer = 0.0f;
+    Metrics metrics{};
+};
+
+void ResetScene(FieldScene* scene, DemoMode mode) {
+    ResetSceneForMode(mode, &scene->traveling, &scene->stable, &scene->rings, &scene->sparks, &scene->rng,
+                      &scene->mergeCount, &scene->cycleTimer, &scene->simTime);
+}
+
+// Advances every excitation, packet, ring and spark by dt, resolves merges and
+// rebuilds the primary/coupled field grids.
+void StepFieldScene(FieldScene* scene, DemoMode mode, bool autoDrive, float dt) {
+    std::vector<TravelingExcitation>& traveling = scene->traveling;
+    std::vector<StablePacket>& stable = scene->stable;
+    std::vector<ShockRing>& rings = scene->rings;
+    std::vector<Spark>& sparks = scene->sparks;
+    const std::vector<VacuumFluctuation>& fluctuations = scene->fluctuations;
+    Rng& rng = scene->rng;
+    int& mergeCount = scene->mergeCount;
+    float& simTime = scene->simTime;
+    float& cycleTimer = scene->cycleTimer;
+
+    simTime += dt;
+    cycleTimer += dt;
+
+    if (autoDrive && mode == DemoMode::kVacuum && cycleTimer > 2.5f) {
+        cycleTimer = 0.0f;
+        const Vector2 center = {RandRange(rng, -4.2f, 4.2f), RandRange(rng, -4.2f, 4.2f)};
+        rings.push_back({center, 0.0f, RandRange(rng, 1.4f, 2.6f), 0.24f, 0.10f, 1.8f, 0.0f, Color{110, 220, 255, 255}});
+    } else if (autoDrive && mode == DemoMode::kTraveling && cycleTimer > 2.2f) {
+        cycleTimer = 0.0f;
+        SpawnTravelingTrain(&traveling, &rng);
+        if (RandRange(rng, 0.0f, 1.0f) > 0.62f) SpawnDiagonalPair(&traveling, &rng);
+    } else if (autoDrive && mode == DemoMode::kCollision && cycleTimer > 3.7f) {
+        cycleTimer = 0.0f;
+        if (RandRange(rng, 0.0f, 1.0f) > 0.4f) {
+            SpawnCollisionPair(&traveling, &rng, 1.8f * std::sin(simTime * 0.7f));
+        } else {
+            SpawnDiagonalPair(&traveling, &rng);
+        }
+    }
 
-    for (int ix = 0; ix < kGridX; ++ix) {
-        for (int iz = 0; iz < kGridZ; ++iz) {
-            const float x = kXMin + (kXMax - kXMin) * static_cast<float>(ix) / static_cast<float>(kGridX - 1);
-            const float z = kZMin + (kZMax - kZMin) * static_cast<float>(iz) / static_cast<float>(kGridZ - 1);
-
-            float p = VacuumPrimary(x, z, time);
-            float s = VacuumSecondary(x, z, time);
-            const float fluctuationScale = mode == DemoMode::kVacuum ? 1.0f : 0.22f;
-            for (const VacuumFluctuation& fluctuation : fluctuations) {
-                p += fluctuationScale * VacuumLocalizedContribution(fluctuation, x, z, time, false);
-                s += fluctuationScale * 0.82f * VacuumLocalizedContribution(fluctuation, x, z, time, true);
+    for (TravelingExcitation& excitation : traveling) {
+        excitation.pos = Vector2Add(excitation.pos, Vector2Scale(excitation.vel, dt));
+        excitation.age += dt;
+    }
+
+    for (StablePacket& packet : stable) {
+        packet.pos = Vector2Add(packet.pos, Vector2Scale(packet.drift, dt));
+        packet.stageAge += dt;
+        packet.transitionGlow = std::max(0.0f, packet.transitionGlow - dt * 0.8f);
+        if (packet.stage == PacketStage::kForming) {
+            if (packet.stageAge >= PacketFormationDuration(packet.level)) {
+                packet.stage = PacketStage::kStable;
+                packet.stageAge = 0.0f;
+                packet.age = 0.0f;
             }
-            for (const TravelingExcitation& excitation : traveling) {
-                p += TravelingContribution(excitation, x, z, time, false);
-                s += 0.46f * TravelingContribution(excitation, x, z, time, true);
+        } else if (packet.stage == PacketStage::kStable) {
+            packet.age += dt;
+            if (packet.age >= packet.life) {
+                packet.stage = PacketStage::kDecaying;
+                packet.stageAge = 0.0f;
+                packet.decayDuration = PacketDecayDuration(packet.level);
+                AddShockBurst(&rings, &sparks, packet.pos, packet.level, &rng);
             }
-            for (const StablePacket& packet : stable) {
-                p += StableContribution(packet, x, z, time, false);
-                s += 1.18f * StableContribution(packet, x, z, time, true);
-                const Vector2 delta = {x - packet.pos.x, z - packet.pos.y};
-                const float radial = std::sqrt(delta.x * delta.x + delta.y * delta.y);
-                const float angular = std::atan2(delta.y, delta.x);
-                const float stageWeight = PacketStageWeight(packet);
-                const float filament = std::exp(-radial * (1.4f - 0.12f * packet.level)) *
-                                       std::sin((3.0f + packet.level) * angular - 1.3f * time + packet.phase);
-                s += (0.18f + 0.10f * packet.level + 0.18f * packet.transitionGlow) * stageWeight * filament;
-                localizedEnergy += packet.amplitude * packet.amplitude * stageWeight;
+        }
+    }
+
+    ApplyStablePacketInteractions(&stable, dt);
+
+    for (ShockRing& ring : rings) {
+        ring.radius += ring.speed * dt;
+        ring.age += dt;
+    }
+
+    for (Spark& spark : sparks) {
+        spark.pos = Vector3Add(spark.pos, Vector3Scale(spark.vel, dt));
+        spark.vel.y -= 1.8f * dt;
+        spark.age += dt;
+    }
+
+    if (mode == DemoMode::kCollision) {
+        std::vector<int> consumedByPackets;
+        for (size_t i = 0; i < traveling.size(); ++i) {
+            if (std::find(consumedByPackets.begin(), consumedByPackets.end(), static_cast<int>(i)) != consumedByPackets.end()) continue;
+            for (StablePacket& packet : stable) {
+                if (packet.stage != PacketStage::kStable) continue;
+                const float captureRadius = 0.65f + 0.22f * packet.level;
+                if (Vector2Distance(traveling[i].pos, packet.pos) < captureRadius) {
+                    const float absorption = PacketAbsorptionScore(packet, traveling[i]);
+                    if (absorption > 0.62f) {
+                        PromotePacket(&packet, traveling[i].color);
+                        AddShockBurst(&rings, &sparks, packet.pos, packet.level, &rng);
+                        consumedByPackets.push_back(static_cast<int>(i));
+                        ++mergeCount;
+                        break;
+                    }
+
+                    if (absorption < 0.32f) {
+                        traveling[i].vel = Vector2Scale(traveling[i].vel, -0.85f);
+                        traveling[i].phase += PI * 0.4f;
+                        rings.push_back({packet.pos, 0.0f, 2.6f, 0.16f, 0.12f, 0.8f, 0.0f, Color{255, 170, 110, 255}});
+                    }
+                }
             }
-            for (const ShockRing& ring : rings) {
-                p += RingContribution(ring, x, z, false);
-                s += 0.70f * RingContribution(ring, x, z, true);
+        }
+
+        std::vector<int> consumed;
+        for (size_t i = 0; i < traveling.size(); ++i) {
+            if (std::find(consumedByPackets.begin(), consumedByPackets.end(), static_cast<int>(i)) != consumedByPackets.end()) continue;
+            if (std::find(consumed.begin(), consumed.end(), static_cast<int>(i)) != consumed.end()) continue;
+            for (size_t j = i + 1; j < traveling.size(); ++j) {
+                if (std::find(consumedByPackets.begin(), consumedByPackets.end(), static_cast<int>(j)) != consumedByPackets.end()) continue;
+                if (std::find(consumed.begin(), consumed.end(), static_cast<int>(j)) != consumed.end()) continue;
+
+                const float dist = Vector2Distance(traveling[i].pos, traveling[j].pos);
+                if (dist < 1.28f) {
+                    const Vector2 center = Vector2Scale(Vector2Add(traveling[i].pos, traveling[j].pos), 0.5f);
+                    const float energyProxy = std::fabs(traveling[i].amplitude) + std::fabs(traveling[j].amplitude);
+                    const float resonance = CollisionResonanceScore(traveling[i], traveling[j]);
+                    if (resonance > 0.58f) {
+                        const int level = resonance > 0.86f && energyProxy > 2.2f ? 2 : (resonance > 0.70f ? 1 : 0);
+                        const Color mergedColor = LerpColor(traveling[i].color, traveling[j].color, 0.5f);
+                        stable.push_back(MakeQuantizedPacket(center, level, mergedColor, &rng));
+                        AddShockBurst(&rings, &sparks, center, level, &rng);
+                        consumed.push_back(static_cast<int>(i));
+                        consumed.push_back(static_cast<int>(j));
+                        ++mergeCount;
+                    } else {
+                        traveling[i].vel = Vector2Rotate(traveling[i].vel, 0.45f);
+                        traveling[j].vel = Vector2Rotate(traveling[j].vel, -0.45f);
+                        traveling[i].phase += 0.7f;
+                        traveling[j].phase -= 0.7f;
+                        rings.push_back({center, 0.0f, 2.4f, 0.14f, 0.10f, 0.7f, 0.0f, Color{120, 210, 255, 255}});
+                    }
+                    break;
+                }
             }
+        }
 
-            primary->at(FieldIndex(ix, iz)) = 0.68f * p;
-            secondary->at(FieldIndex(ix, iz)) = 0.52f * s;
-            primaryEnergy += p * p;
-            secondaryEnergy += s * s;
-            transfer += std::fabs(p - s);
+        consumed.insert(consumed.end(), consumedByPackets.begin(), consumedByPackets.end());
+        std::sort(consumed.begin(), consumed.end());
+        consumed.erase(std::unique(consumed.begin(), consumed.end()), consumed.end());
+
+        std::vector<TravelingExcitation> survivors;
+        survivors.reserve(traveling.size());
+        for (size_t i = 0; i < traveling.size(); ++i) {
+            const TravelingExcitation& excitation = traveling[i];
+            const bool removeForMerge = std::binary_search(consumed.begin(), consumed.end(), static_cast<int>(i));
+            const bool expired = excitation.age >= excitation.life ||
+                                 std::fabs(excitation.pos.x) > 11.0f ||
+                                 std::fabs(excitation.pos.y) > 11.0f;
+            if (!removeForMerge && !expired) survivors.push_back(excitation);
         }
+        traveling = std::move(survivors);
+    } else {
+        traveling.erase(
+            std::remove_if(traveling.begin(), traveling.end(), [](const TravelingExcitation& excitation) {
+                return excitation.age >= excitation.life ||
+                       std::fabs(excitation.pos.x) > 11.0f ||
+                       std::fabs(excitation.pos.y) > 11.0f;
+            }),
+            traveling.end()
+        );
     }
 
-    const float denom = static_cast<float>(kGridX * kGridZ);
-    metrics->primaryEnergy = primaryEnergy / denom;
-    metrics->secondaryEnergy = secondaryEnergy / denom;
-    metrics->transfer = transfer / denom;
-    metrics->localizedEnergy = localizedEnergy / std::max(1.0f, static_cast<float>(stable.size()));
-}
+    std::vector<StablePacket> nextStable;
+    nextStable.reserve(stable.size());
+    for (StablePacket& packet : stable) {
+        if (packet.stage == PacketStage::kDecaying && packet.stageAge >= packet.decayDuration) {
+            const bool vanished = DemotePacket(&packet, &traveling, &rings, &sparks, &rng);
+            if (vanished) {
+                AddShockBurst(&rings, &sparks, packet.pos, 0, &rng);
+                continue;
+            }
+            AddShockBurst(&rings, &sparks, packet.pos, packet.level, &rng);
+        }
 
-void DrawPrimaryFieldSurface(const std::vector<float>& primary) {
-    for (int ix = 0; ix < kGridX - 1; ++ix) {
-        for (int iz = 0; iz < kGridZ - 1; ++iz) {
-            const float x0 = kXMin + (kXMax - kXMin) * static_cast<float>(ix) / static_cast<float>(kGridX - 1);
-            const float x1 = kXMin + (kXMax - kXMin) * static_cast<float>(ix + 1) / static_cast<float>(kGridX - 1);
-            const float z0 = kZMin + (kZMax - kZMin) * static_cast<float>(iz) / static_cast<float>(kGridZ - 1);
-            const float z1 = kZMin + (kZMax - kZMin) * static_cast<float>(iz + 1) / static_cast<float>(kGridZ - 1);
+        if (std::fabs(packet.pos.x) > 11.0f || std::fabs(packet.pos.y) > 11.0f) continue;
+        nextStable.push_back(packet);
+    }
+    stable = std::move(nextStable);
+    rings.erase(
+        std::remove_if(rings.begin(), rings.end(), [](const ShockRing& ring) { return ring.age >= ring.life; }),
+        rings.end()
+    );
+    sparks.erase(
+        std::remove_if(sparks.begin(), sparks.end(), [](const Spark& spark) { return spark.age >= spark.life; }),
+        sparks.end()
+    );
+
+    BuildFieldCaches(traveling, stable, rings, fluctuations, mode, simTime, scene->grid, &scene->primary, &scene->secondary,
+                     &scene->rowSums, &scene->fluctuationCenters, &scene->sourceBins, &scene->metrics);
+}
 
-            const float f00 = primary[FieldIndex(ix, iz)];
-            const float f10 = primary[FieldIndex(ix + 1, iz)];
-            const float f01 = primary[FieldIndex(ix, iz + 1)];
-            const float f11 = primary[FieldIndex(ix + 1, iz + 1)];
+// Immediate-mode surface: two triangles and a lattice of lines per cell. Used when
+// the surface mesh cannot be built, or with M.
+void DrawPrimaryFieldSurface(const std::vector<float>& primary, int grid) {
+    for (int ix = 0; ix < grid - 1; ++ix) {
+        for (int iz = 0; iz < grid - 1; ++iz) {
+            const float x0 = FieldCoordinate(kXMin, kXMax, ix, grid);
+            const float x1 = FieldCoordinate(kXMin, kXMax, ix + 1, grid);
+            const float z0 = FieldCoordinate(kZMin, kZMax, iz, grid);
+            const float z1 = FieldCoordinate(kZMin, kZMax, iz + 1, grid);
+
+            const float f00 = primary[FieldIndex(ix, iz, grid)];
+            const float f10 = primary[FieldIndex(ix + 1, iz, grid)];
+            const float f01 = primary[FieldIndex(ix, iz + 1, grid)];
+            const float f11 = primary[FieldIndex(ix + 1, iz + 1, grid)];
 
             const Vector3 p00 = {x0, f00, z0};
             const Vector3 p10 = {x1, f10, z0};
@@ -633,18 +1068,21 @@ void DrawPrimaryFieldSurface(const std::vector<float>& primary) {
     }
 }
 
-void DrawCoupledFieldOverlay(const std::vector<float>& secondary) {
-    for (int ix = 0; ix < kGridX - 1; ix += 2) {
-        for (int iz = 0; iz < kGridZ - 1; iz += 2) {
-            const float x0 = kXMin + (kXMax - kXMin) * static_cast<float>(ix) / static_cast<float>(kGridX - 1);
-            const float x1 = kXMin + (kXMax - kXMin) * static_cast<float>(ix + 1) / static_cast<float>(kGridX - 1);
-            const float z0 = kZMin + (kZMax - kZMin) * static_cast<float>(iz) / static_cast<float>(kGridZ - 1);
-            const float z1 = kZMin + (kZMax - kZMin) * static_cast<float>(iz + 1) / static_cast<float>(kGridZ - 1);
-
-            const float f00 = secondary[FieldIndex(ix, iz)] + 0.12f;
-            const float f10 = secondary[FieldIndex(ix + 1, iz)] + 0.12f;
-            const float f01 = secondary[FieldIndex(ix, iz + 1)] + 0.12f;
-            const float f11 = secondary[FieldIndex(ix + 1, iz + 1)] + 0.12f;
+// Outlines every other cell of the default grid; finer grids keep the same world-space
+// spacing so the overlay does not turn into a solid mesh.
+void DrawCoupledFieldOverlay(const std::vector<float>& secondary, int grid) {
+    const int step = std::max(1, grid / kDefaultGrid);
+    for (int ix = 0; ix + step < grid; ix += 2 * step) {
+        for (int iz = 0; iz + step < grid; iz += 2 * step) {
+            const float x0 = FieldCoordinate(kXMin, kXMax, ix, grid);
+            const float x1 = FieldCoordinate(kXMin, kXMax, ix + step, grid);
+            const float z0 = FieldCoordinate(kZMin, kZMax, iz, grid);
+            const float z1 = FieldCoordinate(kZMin, kZMax, iz + step, grid);
+
+            const float f00 = secondary[FieldIndex(ix, iz, grid)] + 0.12f;
+            const float f10 = secondary[FieldIndex(ix + step, iz, grid)] + 0.12f;
+            const float f01 = secondary[FieldIndex(ix, iz + step, grid)] + 0.12f;
+            const float f11 = secondary[FieldIndex(ix + step, iz + step, grid)] + 0.12f;
 
             const Vector3 p00 = {x0, f00, z0};
             const Vector3 p10 = {x1, f10, z0};
@@ -663,6 +1101,170 @@ void DrawCoupledFieldOverlay(const std::vector<float>& secondary) {
     }
 }
 
+// GPU path for the primary surface. The xz lattice and the triangle indices are
+// uploaded once per grid size; a frame uploads only the height buffer, and the shaders
+// derive the colour ramp and the lattice lines from the height as
+// DrawPrimaryFieldSurface does per cell. rlgl indices are 16-bit, so the grid is drawn
+// as bands of at most 65536 vertices that share one index buffer and read the xz and
+// height buffers at a row offset.
+class FieldSurfaceMesh {
+  public:
+    bool Init() {
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locXZ_ = rlGetLocationAttrib(shader_, "vertexXZ");
+        locHeight_ = rlGetLocationAttrib(shader_, "vertexHeight");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locLineSpacing_ = rlGetLocationUniform(shader_, "lineSpacing");
+        return true;
+    }
+
+    bool ready() const { return shader_ != 0; }
+
+    // Rebuilds the static buffers when the grid size changes.
+    void Resize(int grid) {
+        if (!ready() || grid == grid_) return;
+        UnloadBuffers();
+        grid_ = grid;
+
+        std::vector<float> xz(static_cast<size_t>(grid) * grid * 2);
+        for (int iz = 0; iz < grid; ++iz) {
+            for (int ix = 0; ix < grid; ++ix) {
+                const size_t i = static_cast<size_t>(FieldIndex(ix, iz, grid)) * 2;
+                xz[i] = FieldCoordinate(kXMin, kXMax, ix, grid);
+                xz[i + 1] = FieldCoordinate(kZMin, kZMax, iz, grid);
+            }
+        }
+
+        const int bandRows = std::min(grid, 65536 / grid);
+        std::vector<unsigned short> indices;
+        indices.reserve(static_cast<size_t>(bandRows - 1) * (grid - 1) * 6);
+        for (int r = 0; r < bandRows - 1; ++r) {
+            for (int c = 0; c < grid - 1; ++c) {
+                const unsigned short i00 = static_cast<unsigned short>(r * grid + c);
+                const unsigned short i10 = static_cast<unsigned short>(i00 + 1);
+                const unsigned short i01 = static_cast<unsigned short>(i00 + grid);
+                const unsigned short i11 = static_cast<unsigned short>(i01 + 1);
+                indices.insert(indices.end(), {i00, i10, i01, i10, i11, i01});
+            }
+        }
+
+        xzVbo_ = rlLoadVertexBuffer(xz.data(), static_cast<int>(xz.size() * sizeof(float)), false);
+        heightVbo_ = rlLoadVertexBuffer(nullptr, grid * grid * static_cast<int>(sizeof(float)), true);
+        ebo_ = rlLoadVertexBufferElement(indices.data(), static_cast<int>(indices.size() * sizeof(unsigned short)), false);
+
+        // Consecutive bands share their boundary row.
+        for (int firstRow = 0; firstRow < grid - 1; firstRow += bandRows - 1) {
+            Band band{};
+            band.rows = std::min(bandRows, grid - firstRow);
+            band.vao = rlLoadVertexArray();
+            rlEnableVertexArray(band.vao);
+            rlEnableVertexBuffer(xzVbo_);
+            rlSetVertexAttribute(static_cast<unsigned int>(locXZ_), 2, RL_FLOAT, false, 0,
+                                 firstRow * grid * 2 * static_cast<int>(sizeof(float)));
+            rlEnableVertexAttribute(static_cast<unsigned int>(locXZ_));
+            rlEnableVertexBuffer(heightVbo_);
+            rlSetVertexAttribute(static_cast<unsigned int>(locHeight_), 1, RL_FLOAT, false, 0,
+                                 firstRow * grid * static_cast<int>(sizeof(float)));
+            rlEnableVertexAttribute(static_cast<unsigned int>(locHeight_));
+            rlEnableVertexBufferElement(ebo_);
+            rlDisableVertexArray();
+            bands_.push_back(band);
+        }
+    }
+
+    // Call between BeginMode3D/EndMode3D; queued immediate geometry is flushed first.
+    void Draw(const std::vector<float>& primary) {
+        if (!ready() || bands_.empty()) return;
+        rlDrawRenderBatchActive();
+        rlUpdateVertexBuffer(heightVbo_, primary.data(), grid_ * grid_ * static_cast<int>(sizeof(float)), 0);
+
+        const Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+        const float lineSpacing = 2.0f * (kXMax - kXMin) / static_cast<float>(kDefaultGrid - 1);
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, mvp);
+        rlSetUniform(locLineSpacing_, &lineSpacing, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlDisableBackfaceCulling();
+        for (const Band& band : bands_) {
+            rlEnableVertexArray(band.vao);
+            rlDrawVertexArrayElements(0, (band.rows - 1) * (grid_ - 1) * 6, nullptr);
+        }
+        rlDisableVertexArray();
+        rlEnableBackfaceCulling();
+        rlDisableShader();
+    }
+
+    // Must run before CloseWindow().
+    void Unload() {
+        UnloadBuffers();
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        shader_ = 0;
+    }
+
+  private:
+    struct Band {
+        unsigned int vao = 0;
+        int rows = 0;
+    };
+
+    void UnloadBuffers() {
+        for (const Band& band : bands_) rlUnloadVertexArray(band.vao);
+        bands_.clear();
+        if (xzVbo_ != 0) rlUnloadVertexBuffer(xzVbo_);
+        if (heightVbo_ != 0) rlUnloadVertexBuffer(heightVbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        xzVbo_ = heightVbo_ = ebo_ = 0;
+        grid_ = 0;
+    }
+
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec2 vertexXZ;
+in float vertexHeight;
+uniform mat4 mvp;
+uniform float lineSpacing;
+out vec4 fragColor;
+out vec2 fragCell;
+out float fragIntensity;
+void main() {
+    float intensity = clamp(0.12 + 1.68 * abs(vertexHeight), 0.0, 1.0);
+    vec3 cool = mix(vec3(0.071, 0.094, 0.235), vec3(0.337, 0.933, 1.0), intensity);
+    vec3 hot = mix(cool, vec3(1.0, 0.345, 0.839), clamp(intensity * 0.8, 0.0, 1.0));
+    fragColor = vec4(mix(cool, hot, 0.5), 0.15 + 0.21 * intensity);
+    fragCell = vertexXZ / lineSpacing;
+    fragIntensity = intensity;
+    gl_Position = mvp * vec4(vertexXZ.x, vertexHeight, vertexXZ.y, 1.0);
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+in vec2 fragCell;
+in float fragIntensity;
+out vec4 finalColor;
+void main() {
+    vec2 d = abs(fract(fragCell + 0.5) - 0.5) / max(fwidth(fragCell), vec2(1e-5));
+    float alongX = 1.0 - clamp(d.y, 0.0, 1.0);
+    float alongZ = (1.0 - clamp(d.x, 0.0, 1.0)) * (1.0 - alongX);
+    vec4 color = mix(fragColor, vec4(0.361, 0.839, 1.0, 0.14 + 0.22 * fragIntensity), alongX);
+    finalColor = mix(color, vec4(1.0, 0.416, 0.847, 0.10 + 0.16 * fragIntensity), alongZ);
+}
+)";
+
+    unsigned int shader_ = 0;
+    int locXZ_ = -1;
+    int locHeight_ = -1;
+    int locMvp_ = -1;
+    int locLineSpacing_ = -1;
+    unsigned int xzVbo_ = 0;
+    unsigned int heightVbo_ = 0;
+    unsigned int ebo_ = 0;
+    int grid_ = 0;
+    std::vector<Band> bands_;
+};
+
 void DrawShockRings(const std::vector<ShockRing>& rings) {
     for (const ShockRing& ring : rings) {
         const float fade = Saturate(1.0f - ring.age / ring.life);
@@ -870,7 +1472,7 @@ const char* PacketStageName(PacketStage stage) {
     return "";
 }
 
-void DrawLabelTag(const char* text, Vector3 world, const Camera3D& camera, Color color) {
+void DrawLabelTag(astro_render::HudTextLayer* hud, const char* text, Vector3 world, const Camera3D& camera, Color color) {
     const Vector2 screen = GetWorldToScreen(world, camera);
     if (screen.x < 30.0f || screen.x > static_cast<float>(GetScreenWidth() - 30) ||
         screen.y < 30.0f || screen.y > static_cast<float>(GetScreenHeight() - 30)) {
@@ -878,42 +1480,61 @@ void DrawLabelTag(const char* text, Vector3 world, const Camera3D& camera, Color
     }
 
     const int fontSize = 16;
-    const int width = MeasureText(text, fontSize) + 18;
+    const int width = hud->Measure(text, fontSize) + 18;
     const int x = static_cast<int>(screen.x) - width / 2;
     const int y = static_cast<int>(screen.y) - 28;
     DrawRectangleRounded({static_cast<float>(x), static_cast<float>(y), static_cast<float>(width), 24.0f}, 0.28f, 8, Fade(BLACK, 0.52f));
-    DrawText(text, x + 9, y + 4, fontSize, color);
+    hud->Text(text, x + 9, y + 4, fontSize, color);
 }
 
-void DrawSceneLabels(const Camera3D& camera,
+void DrawSceneLabels(astro_render::HudTextLayer* hud,
+                     const Camera3D& camera,
                      DemoMode mode,
                      const std::vector<TravelingExcitation>& traveling,
                      const std::vector<StablePacket>& stable,
                      const std::vector<ShockRing>& rings) {
-    DrawLabelTag("field surface", {5.4f, -0.55f, 5.6f}, camera, Color{112, 232, 255, 255});
-    DrawLabelTag("coupled field", {-5.0f, 0.32f, -5.6f}, camera, Color{255, 184, 118, 255});
+    DrawLabelTag(hud, "field surface", {5.4f, -0.55f, 5.6f}, camera, Color{112, 232, 255, 255});
+    DrawLabelTag(hud, "coupled field", {-5.0f, 0.32f, -5.6f}, camera, Color{255, 184, 118, 255});
 
     if (!traveling.empty() && mode != DemoMode::kVacuum) {
         const TravelingExcitation& excitation = traveling.front();
-        DrawLabelTag("traveling excitation", {excitation.pos.x, 0.88f, excitation.pos.y}, camera, excitation.color);
+        DrawLabelTag(hud, "traveling excitation", {excitation.pos.x, 0.88f, excitation.pos.y}, camera, excitation.color);
     }
     if (!stable.empty()) {
         const StablePacket& packet = stable.front();
-        DrawLabelTag("localized particle-like state", {packet.pos.x, 1.45f, packet.pos.y}, camera, packet.color);
+        DrawLabelTag(hud, "localized particle-like state", {packet.pos.x, 1.45f, packet.pos.y}, camera, packet.color);
     }
     if (!rings.empty()) {
         const ShockRing& ring = rings.front();
-        DrawLabelTag("energy injection", {ring.center.x + ring.radius, 0.35f, ring.center.y}, camera, ring.color);
+        DrawLabelTag(hud, "energy injection", {ring.center.x + ring.radius, 0.35f, ring.center.y}, camera, ring.color);
     }
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 240, 1.0f / 120.0f);
+    if (bench.enabled) {
+        const DemoMode mode = static_cast<DemoMode>(std::clamp(astro_bench::IntArg(argc, argv, "--mode", 2), 0, 2));
+        FieldScene scene;
+        scene.grid = std::clamp(astro_bench::IntArg(argc, argv, "--grid", kDefaultGrid), 2, kMaxGrid);
+        ResetScene(&scene, mode);
+        // Extra wave trains to load the sparse field evaluation.
+        for (int i = astro_bench::IntArg(argc, argv, "--packets", 0); i > 0; --i) SpawnTravelingTrain(&scene.traveling, &scene.rng);
+        return astro_bench::RunBench(
+            "field_excitation_viz", bench,
+            [&](float dt) { StepFieldScene(&scene, mode, true, dt); },
+            [&]() { return scene.metrics.primaryEnergy + scene.metrics.secondaryEnergy + scene.mergeCount; });
+    }
+
     SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
     InitWindow(kScreenWidth, kScreenHeight, "Field Excitations 3D - C++ (raylib)");
     SetWindowMinSize(1100, 700);
     SetTargetFPS(120);
+    astro_render::DynamicResolution dynres;
+    dynres.Init(GetScreenWidth(), GetScreenHeight(), astro_render::DynamicResolutionOptions::FromArgs(argc, argv));
+    astro_render::HudTextLayer hud;
+    hud.Init();
 
     Camera3D camera{};
     camera.position = {13.0f, 8.0f, 14.0f};
@@ -923,43 +1544,44 @@ int main() {
     camera.projection = CAMERA_PERSPECTIVE;
 
     OrbitCameraState orbit{};
-    std::vector<TravelingExcitation> traveling;
-    std::vector<StablePacket> stable;
-    std::vector<ShockRing> rings;
-    std::vector<Spark> sparks;
-    const std::vector<VacuumFluctuation> fluctuations = MakeVacuumFluctuations();
-    std::vector<float> primary(kGridX * kGridZ, 0.0f);
-    std::vector<float> secondary(kGridX * kGridZ, 0.0f);
+    FieldScene scene;
+    std::vector<TravelingExcitation>& traveling = scene.traveling;
+    std::vector<StablePacket>& stable = scene.stable;
+    std::vector<ShockRing>& rings = scene.rings;
+    std::vector<Spark>& sparks = scene.sparks;
+    Rng& rng = scene.rng;
+    const std::vector<float>& primary = scene.primary;
+    const std::vector<float>& secondary = scene.secondary;
+    const Metrics& metrics = scene.metrics;
+    int& mergeCount = scene.mergeCount;
+    const float& simTime = scene.simTime;
 
     DemoMode mode = DemoMode::kCollision;
-    std::mt19937 rng(9001);
-    int mergeCount = 0;
-    float simTime = 0.0f;
     float simSpeed = 1.0f;
-    float cycleTimer = 0.0f;
     bool paused = false;
     bool slowMotion = false;
     bool autoDrive = true;
     bool inspectOverlay = false;
-    Metrics metrics{};
+    FieldSurfaceMesh surfaceMesh;
+    bool meshSurface = surfaceMesh.Init();
 
-    ResetSceneForMode(mode, &traveling, &stable, &rings, &sparks, &rng, &mergeCount, &cycleTimer, &simTime);
+    ResetScene(&scene, mode);
     SnapCameraToPreset(&orbit, mode);
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_ONE)) {
             mode = DemoMode::kVacuum;
-            ResetSceneForMode(mode, &traveling, &stable, &rings, &sparks, &rng, &mergeCount, &cycleTimer, &simTime);
+            ResetScene(&scene, mode);
             SnapCameraToPreset(&orbit, mode);
         }
         if (IsKeyPressed(KEY_TWO)) {
             mode = DemoMode::kTraveling;
-            ResetSceneForMode(mode, &traveling, &stable, &rings, &sparks, &rng, &mergeCount, &cycleTimer, &simTime);
+            ResetScene(&scene, mode);
             SnapCameraToPreset(&orbit, mode);
         }
         if (IsKeyPressed(KEY_THREE)) {
             mode = DemoMode::kCollision;
-            ResetSceneForMode(mode, &traveling, &stable, &rings, &sparks, &rng, &mergeCount, &cycleTimer, &simTime);
+            ResetScene(&scene, mode);
             SnapCameraToPreset(&orbit, mode);
         }
 
@@ -968,10 +1590,16 @@ int main() {
         if (IsKeyPressed(KEY_A)) autoDrive = !autoDrive;
         if (IsKeyPressed(KEY_I)) inspectOverlay = !inspectOverlay;
         if (IsKeyPressed(KEY_G)) SnapCameraToPreset(&orbit, mode);
+        if (IsKeyPressed(KEY_M)) meshSurface = surfaceMesh.ready() && !meshSurface;
+        if (IsKeyPressed(KEY_N)) {
+            const auto current = std::find(kGridSizes.begin(), kGridSizes.end(), scene.grid);
+            const size_t next = current == kGridSizes.end() ? 0 : (current - kGridSizes.begin() + 1) % kGridSizes.size();
+            scene.grid = kGridSizes[next];
+        }
         if (IsKeyPressed(KEY_R)) {
             paused = false;
             simSpeed = 1.0f;
-            ResetSceneForMode(mode, &traveling, &stable, &rings, &sparks, &rng, &mergeCount, &cycleTimer, &simTime);
+            ResetScene(&scene, mode);
             SnapCameraToPreset(&orbit, mode);
         }
         if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) simSpeed = std::min(4.0f, simSpeed + 0.2f);
@@ -988,233 +1616,74 @@ int main() {
 
         const float timeScale = slowMotion ? 0.24f : 1.0f;
         const float dt = paused ? 0.0f : GetFrameTime() * simSpeed * timeScale;
-        simTime += dt;
-        cycleTimer += dt;
         UpdateOrbitCameraDragOnly(&camera, &orbit);
-
-        if (autoDrive && mode == DemoMode::kVacuum && cycleTimer > 2.5f) {
-            cycleTimer = 0.0f;
-            const Vector2 center = {RandRange(rng, -4.2f, 4.2f), RandRange(rng, -4.2f, 4.2f)};
-            rings.push_back({center, 0.0f, RandRange(rng, 1.4f, 2.6f), 0.24f, 0.10f, 1.8f, 0.0f, Color{110, 220, 255, 255}});
-        } else if (autoDrive && mode == DemoMode::kTraveling && cycleTimer > 2.2f) {
-            cycleTimer = 0.0f;
-            SpawnTravelingTrain(&traveling, &rng);
-            if (RandRange(rng, 0.0f, 1.0f) > 0.62f) SpawnDiagonalPair(&traveling, &rng);
-        } else if (autoDrive && mode == DemoMode::kCollision && cycleTimer > 3.7f) {
-            cycleTimer = 0.0f;
-            if (RandRange(rng, 0.0f, 1.0f) > 0.4f) {
-                SpawnCollisionPair(&traveling, &rng, 1.8f * std::sin(simTime * 0.7f));
-            } else {
-                SpawnDiagonalPair(&traveling, &rng);
-            }
-        }
-
-        for (TravelingExcitation& excitation : traveling) {
-            excitation.pos = Vector2Add(excitation.pos, Vector2Scale(excitation.vel, dt));
-            excitation.age += dt;
-        }
-
-        for (StablePacket& packet : stable) {
-            packet.pos = Vector2Add(packet.pos, Vector2Scale(packet.drift, dt));
-            packet.stageAge += dt;
-            packet.transitionGlow = std::max(0.0f, packet.transitionGlow - dt * 0.8f);
-            if (packet.stage == PacketStage::kForming) {
-                if (packet.stageAge >= PacketFormationDuration(packet.level)) {
-                    packet.stage = PacketStage::kStable;
-                    packet.stageAge = 0.0f;
-                    packet.age = 0.0f;
-                }
-            } else if (packet.stage == PacketStage::kStable) {
-                packet.age += dt;
-                if (packet.age >= packet.life) {
-                    packet.stage = PacketStage::kDecaying;
-                    packet.stageAge = 0.0f;
-                    packet.decayDuration = PacketDecayDuration(packet.level);
-                    AddShockBurst(&rings, &sparks, packet.pos, packet.level, &rng);
-                }
-            }
-        }
-
-        ApplyStablePacketInteractions(&stable, dt);
-
-        for (ShockRing& ring : rings) {
-            ring.radius += ring.speed * dt;
-            ring.age += dt;
-        }
-
-        for (Spark& spark : sparks) {
-            spark.pos = Vector3Add(spark.pos, Vector3Scale(spark.vel, dt));
-            spark.vel.y -= 1.8f * dt;
-            spark.age += dt;
-        }
-
-        if (mode == DemoMode::kCollision) {
-            std::vector<int> consumedByPackets;
-            for (size_t i = 0; i < traveling.size(); ++i) {
-                if (std::find(consumedByPackets.begin(), consumedByPackets.end(), static_cast<int>(i)) != consumedByPackets.end()) continue;
-                for (StablePacket& packet : stable) {
-                    if (packet.stage != PacketStage::kStable) continue;
-                    const float captureRadius = 0.65f + 0.22f * packet.level;
-                    if (Vector2Distance(traveling[i].pos, packet.pos) < captureRadius) {
-                        const float absorption = PacketAbsorptionScore(packet, traveling[i]);
-                        if (absorption > 0.62f) {
-                            PromotePacket(&packet, traveling[i].color);
-                            AddShockBurst(&rings, &sparks, packet.pos, packet.level, &rng);
-                            consumedByPackets.push_back(static_cast<int>(i));
-                            ++mergeCount;
-                            break;
-                        }
-
-                        if (absorption < 0.32f) {
-                            traveling[i].vel = Vector2Scale(traveling[i].vel, -0.85f);
-                            traveling[i].phase += PI * 0.4f;
-                            rings.push_back({packet.pos, 0.0f, 2.6f, 0.16f, 0.12f, 0.8f, 0.0f, Color{255, 170, 110, 255}});
-                        }
-                    }
-                }
-            }
-
-            std::vector<int> consumed;
-            for (size_t i = 0; i < traveling.size(); ++i) {
-                if (std::find(consumedByPackets.begin(), consumedByPackets.end(), static_cast<int>(i)) != consumedByPackets.end()) continue;
-                if (std::find(consumed.begin(), consumed.end(), static_cast<int>(i)) != consumed.end()) continue;
-                for (size_t j = i + 1; j < traveling.size(); ++j) {
-                    if (std::find(consumedByPackets.begin(), consumedByPackets.end(), static_cast<int>(j)) != consumedByPackets.end()) continue;
-                    if (std::find(consumed.begin(), consumed.end(), static_cast<int>(j)) != consumed.end()) continue;
-
-                    const float dist = Vector2Distance(traveling[i].pos, traveling[j].pos);
-                    if (dist < 1.28f) {
-                        const Vector2 center = Vector2Scale(Vector2Add(traveling[i].pos, traveling[j].pos), 0.5f);
-                        const float energyProxy = std::fabs(traveling[i].amplitude) + std::fabs(traveling[j].amplitude);
-                        const float resonance = CollisionResonanceScore(traveling[i], traveling[j]);
-                        if (resonance > 0.58f) {
-                            const int level = resonance > 0.86f && energyProxy > 2.2f ? 2 : (resonance > 0.70f ? 1 : 0);
-                            const Color mergedColor = LerpColor(traveling[i].color, traveling[j].color, 0.5f);
-                            stable.push_back(MakeQuantizedPacket(center, level, mergedColor, &rng));
-                            AddShockBurst(&rings, &sparks, center, level, &rng);
-                            consumed.push_back(static_cast<int>(i));
-                            consumed.push_back(static_cast<int>(j));
-                            ++mergeCount;
-                        } else {
-                            traveling[i].vel = Vector2Rotate(traveling[i].vel, 0.45f);
-                            traveling[j].vel = Vector2Rotate(traveling[j].vel, -0.45f);
-                            traveling[i].phase += 0.7f;
-                            traveling[j].phase -= 0.7f;
-                            rings.push_back({center, 0.0f, 2.4f, 0.14f, 0.10f, 0.7f, 0.0f, Color{120, 210, 255, 255}});
-                        }
-                        break;
-                    }
-                }
-            }
-
-            consumed.insert(consumed.end(), consumedByPackets.begin(), consumedByPackets.end());
-            std::sort(consumed.begin(), consumed.end());
-            consumed.erase(std::unique(consumed.begin(), consumed.end()), consumed.end());
-
-            std::vector<TravelingExcitation> survivors;
-            survivors.reserve(traveling.size());
-            for (size_t i = 0; i < traveling.size(); ++i) {
-                const TravelingExcitation& excitation = traveling[i];
-                const bool removeForMerge = std::binary_search(consumed.begin(), consumed.end(), static_cast<int>(i));
-                const bool expired = excitation.age >= excitation.life ||
-                                     std::fabs(excitation.pos.x) > 11.0f ||
-                                     std::fabs(excitation.pos.y) > 11.0f;
-                if (!removeForMerge && !expired) survivors.push_back(excitation);
-            }
-            traveling = std::move(survivors);
-        } else {
-            traveling.erase(
-                std::remove_if(traveling.begin(), traveling.end(), [](const TravelingExcitation& excitation) {
-                    return excitation.age >= excitation.life ||
-                           std::fabs(excitation.pos.x) > 11.0f ||
-                           std::fabs(excitation.pos.y) > 11.0f;
-                }),
-                traveling.end()
-            );
-        }
-
-        std::vector<StablePacket> nextStable;
-        nextStable.reserve(stable.size());
-        for (StablePacket& packet : stable) {
-            if (packet.stage == PacketStage::kDecaying && packet.stageAge >= packet.decayDuration) {
-                const bool vanished = DemotePacket(&packet, &traveling, &rings, &sparks, &rng);
-                if (vanished) {
-                    AddShockBurst(&rings, &sparks, packet.pos, 0, &rng);
-                    continue;
-                }
-                AddShockBurst(&rings, &sparks, packet.pos, packet.level, &rng);
-            }
-
-            if (std::fabs(packet.pos.x) > 11.0f || std::fabs(packet.pos.y) > 11.0f) continue;
-            nextStable.push_back(packet);
-        }
-        stable = std::move(nextStable);
-        rings.erase(
-            std::remove_if(rings.begin(), rings.end(), [](const ShockRing& ring) { return ring.age >= ring.life; }),
-            rings.end()
-        );
-        sparks.erase(
-            std::remove_if(sparks.begin(), sparks.end(), [](const Spark& spark) { return spark.age >= spark.life; }),
-            sparks.end()
-        );
-
-        BuildFieldCaches(traveling, stable, rings, fluctuations, mode, simTime, &primary, &secondary, &metrics);
+        StepFieldScene(&scene, mode, autoDrive, dt);
 
         BeginDrawing();
+        dynres.BeginScene();
         ClearBackground(Color{4, 6, 16, 255});
         DrawRectangleGradientV(0, 0, GetScreenWidth(), GetScreenHeight() / 2, Color{8, 12, 28, 255}, Color{4, 6, 16, 255});
         DrawRectangleGradientV(0, GetScreenHeight() / 2, GetScreenWidth(), GetScreenHeight() / 2, Color{4, 6, 16, 255}, Color{3, 4, 10, 255});
 
         BeginMode3D(camera);
-        DrawPrimaryFieldSurface(primary);
-        DrawCoupledFieldOverlay(secondary);
+        if (meshSurface) {
+            surfaceMesh.Resize(scene.grid);
+            surfaceMesh.Draw(primary);
+        } else {
+            DrawPrimaryFieldSurface(primary, scene.grid);
+        }
+        DrawCoupledFieldOverlay(secondary, scene.grid);
         DrawShockRings(rings);
         DrawTravelingExcitations(traveling, simTime);
         DrawStablePackets(stable, simTime);
         DrawSparks(sparks);
         EndMode3D();
+        dynres.EndScene();
 
-        DrawSceneLabels(camera, mode, traveling, stable, rings);
+        hud.Begin();
+        DrawSceneLabels(&hud, camera, mode, traveling, stable, rings);
 
         DrawRectangleRounded({14.0f, 14.0f, 640.0f, 102.0f}, 0.08f, 12, Fade(BLACK, 0.34f));
-        DrawText("Field Excitations", 26, 22, 32, Color{236, 242, 252, 255});
-        DrawText(TextFormat("%s | %s", DemoModeName(mode), DemoModeSummary(mode)), 26, 58, 18, Color{176, 196, 224, 255});
-        DrawText(TextFormat("1 vacuum  2 traveling  3 collision  |  C inject pair  V inject wave  Space quantized burst  |  A auto%s  T slow%s",
-                            autoDrive ? " [ON]" : "",
-                            slowMotion ? " [ON]" : ""),
-                 26, 82, 16, Color{124, 226, 255, 255});
+        hud.Text("Field Excitations", 26, 22, 32, Color{236, 242, 252, 255});
+        hud.Print(26, 58, 18, Color{176, 196, 224, 255}, "%s | %s", DemoModeName(mode), DemoModeSummary(mode));
+        hud.Print(26, 82, 16, Color{124, 226, 255, 255},
+                  "1 vacuum  2 traveling  3 collision  |  C inject pair  V inject wave  Space quantized burst  |  A auto%s  T slow%s",
+                  autoDrive ? " [ON]" : "", slowMotion ? " [ON]" : "");
 
         DrawRectangleRounded({GetScreenWidth() - 280.0f, 14.0f, 266.0f, 122.0f}, 0.08f, 12, Fade(BLACK, 0.36f));
-        DrawText("Energy", GetScreenWidth() - 258, 24, 24, Color{236, 242, 252, 255});
-        DrawText(TextFormat("primary  %.3f", metrics.primaryEnergy), GetScreenWidth() - 258, 54, 18, Color{102, 232, 255, 255});
-        DrawText(TextFormat("coupled  %.3f", metrics.secondaryEnergy), GetScreenWidth() - 258, 76, 18, Color{255, 190, 120, 255});
-        DrawText(TextFormat("transfer %.3f  local %.3f", metrics.transfer, metrics.localizedEnergy), GetScreenWidth() - 258, 98, 18, Color{255, 132, 214, 255});
-        DrawText(TextFormat("traveling %d   localized %d   events %d%s",
-                            static_cast<int>(traveling.size()),
-                            static_cast<int>(stable.size()),
-                            mergeCount,
-                            paused ? "   [PAUSED]" : ""),
-                 GetScreenWidth() - 258,
-                 120,
-                 16,
-                 Color{222, 228, 240, 255});
+        hud.Text("Energy", GetScreenWidth() - 258, 24, 24, Color{236, 242, 252, 255});
+        hud.Print(GetScreenWidth() - 258, 54, 18, Color{102, 232, 255, 255}, "primary  %.3f", metrics.primaryEnergy);
+        hud.Print(GetScreenWidth() - 258, 76, 18, Color{255, 190, 120, 255}, "coupled  %.3f", metrics.secondaryEnergy);
+        hud.Print(GetScreenWidth() - 258, 98, 18, Color{255, 132, 214, 255}, "transfer %.3f  local %.3f", metrics.transfer, metrics.localizedEnergy);
+        hud.Print(GetScreenWidth() - 258, 120, 16, Color{222, 228, 240, 255}, "traveling %d   localized %d   events %d%s",
+                  static_cast<int>(traveling.size()), static_cast<int>(stable.size()), mergeCount, paused ? "   [PAUSED]" : "");
 
         if (inspectOverlay && paused) {
             const InspectInfo inspect = BuildInspectInfo(stable);
             if (inspect.hasPacket) {
                 DrawRectangleRounded({14.0f, static_cast<float>(GetScreenHeight() - 118), 300.0f, 92.0f}, 0.08f, 12, Fade(BLACK, 0.36f));
-                DrawText("Inspect", 26, GetScreenHeight() - 108, 22, Color{236, 242, 252, 255});
-                DrawText(TextFormat("level %s  stage %s", kPacketPresets[inspect.level].label, PacketStageName(inspect.stage)),
-                         26, GetScreenHeight() - 80, 17, Color{126, 228, 255, 255});
-                DrawText(TextFormat("amp %.2f  sigma %.2f  coherence %.2f", inspect.amplitude, inspect.sigma, inspect.stageWeight),
-                         26, GetScreenHeight() - 58, 16, Color{220, 228, 240, 255});
+                hud.Text("Inspect", 26, GetScreenHeight() - 108, 22, Color{236, 242, 252, 255});
+                hud.Print(26, GetScreenHeight() - 80, 17, Color{126, 228, 255, 255}, "level %s  stage %s", kPacketPresets[inspect.level].label,
+                          PacketStageName(inspect.stage));
+                hud.Print(26, GetScreenHeight() - 58, 16, Color{220, 228, 240, 255}, "amp %.2f  sigma %.2f  coherence %.2f", inspect.amplitude,
+                          inspect.sigma, inspect.stageWeight);
             }
         }
 
+        hud.Print(GetScreenWidth() - 720, GetScreenHeight() - 30, 16, Color{176, 196, 224, 255},
+                  "grid %dx%d  %s surface  |  N grid  M mesh  |  render %.0f%% (scene %.1f / %.1f ms)", scene.grid, scene.grid,
+                  meshSurface ? "mesh" : "immediate", 100.0f * dynres.scale(), dynres.gpuMs(), dynres.targetMs());
+        hud.Draw();
         DrawFPS(GetScreenWidth() - 96, GetScreenHeight() - 34);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    surfaceMesh.Unload();
+    hud.Unload();
+    dynres.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
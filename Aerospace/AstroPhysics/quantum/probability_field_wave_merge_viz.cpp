@@ -1,5 +1,10 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+
+#include "../common/cli_args.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
 
 #include <algorithm>
 #include <cmath>
@@ -13,8 +18,14 @@ namespace {
 constexpr int kScreenWidth = 1320;
 constexpr int kScreenHeight = 860;
 
-constexpr int kGridX = 70;
-constexpr int kGridZ = 70;
+// Surface lattice points per side. --grid=N or G picks the resolution; the CPU
+// fallback stops at kCpuGridMax because it draws every cell with immediate triangles.
+constexpr int kDefaultGrid = 70;
+constexpr int kMaxGrid = 1024;
+constexpr int kCpuGridMax = 256;
+constexpr int kGridChoices[] = {70, 256, 512, 1024};
+constexpr int kGridChoiceCount = static_cast<int>(sizeof(kGridChoices) / sizeof(kGridChoices[0]));
+constexpr int kMaxGpuPackets = 48;  // 3 vec4 uniforms each, well inside GL 3.3's vertex limit
 constexpr float kXMin = -8.0f;
 constexpr float kXMax = 8.0f;
 constexpr float kZMin = -8.0f;
@@ -127,11 +138,195 @@ float SampleField(const std::vector<HelicalPacket>& packets, float x, float z, f
     return value;
 }
 
-Vector3 GridPoint(int ix, int iz, float value) {
-    const float x = kXMin + (kXMax - kXMin) * static_cast<float>(ix) / static_cast<float>(kGridX - 1);
-    const float z = kZMin + (kZMax - kZMin) * static_cast<float>(iz) / static_cast<float>(kGridZ - 1);
-    return {x, kFieldHeightScale * value, z};
+float GridCoordinate(float lo, float hi, int i, int grid) {
+    return lo + (hi - lo) * static_cast<float>(i) / static_cast<float>(grid - 1);
+}
+
+Vector3 GridPoint(int ix, int iz, int grid, float value) {
+    return {GridCoordinate(kXMin, kXMax, ix, grid), kFieldHeightScale * value, GridCoordinate(kZMin, kZMax, iz, grid)};
+}
+
+// GPU path for the field surface. The xz lattice and the triangle indices are uploaded
+// once per grid size, and the packets arrive each frame as a uniform array, so the
+// vertex shader evaluates SampleField, the density and the colour blend exactly as the
+// CPU loop does, with no per-frame upload beyond the uniforms. The lattice lines of the
+// immediate path, at its default spacing, come from the fragment shader. rlgl indices
+// are 16-bit, so the grid is drawn as bands of at most 65536 vertices that share one
+// index buffer and read the xz buffer at a row offset.
+class PacketSurfaceMesh {
+  public:
+    bool Init() {
+        const int version = rlGetVersion();
+        if (version != RL_OPENGL_33 && version != RL_OPENGL_43) return false;
+        shader_ = rlLoadShaderCode(kVertexShader, kFragmentShader);
+        if (shader_ == 0 || shader_ == rlGetShaderIdDefault()) {
+            shader_ = 0;
+            return false;
+        }
+        locXZ_ = rlGetLocationAttrib(shader_, "vertexXZ");
+        locMvp_ = rlGetLocationUniform(shader_, "mvp");
+        locSurface_ = rlGetLocationUniform(shader_, "surface");
+        locPackets_ = rlGetLocationUniform(shader_, "packets");
+        return true;
+    }
+
+    bool ready() const { return shader_ != 0; }
+
+    // Rebuilds the static buffers when the grid size changes.
+    void Resize(int grid) {
+        if (!ready() || grid == grid_) return;
+        UnloadBuffers();
+        grid_ = grid;
+
+        std::vector<float> xz(static_cast<size_t>(grid) * grid * 2);
+        for (int iz = 0; iz < grid; ++iz) {
+            for (int ix = 0; ix < grid; ++ix) {
+                const size_t i = (static_cast<size_t>(iz) * grid + ix) * 2;
+                xz[i] = GridCoordinate(kXMin, kXMax, ix, grid);
+                xz[i + 1] = GridCoordinate(kZMin, kZMax, iz, grid);
+            }
+        }
+
+        const int bandRows = std::min(grid, 65536 / grid);
+        std::vector<unsigned short> indices;
+        indices.reserve(static_cast<size_t>(bandRows - 1) * (grid - 1) * 6);
+        for (int r = 0; r < bandRows - 1; ++r) {
+            for (int c = 0; c < grid - 1; ++c) {
+                const unsigned short i00 = static_cast<unsigned short>(r * grid + c);
+                const unsigned short i10 = static_cast<unsigned short>(i00 + 1);
+                const unsigned short i01 = static_cast<unsigned short>(i00 + grid);
+                const unsigned short i11 = static_cast<unsigned short>(i01 + 1);
+                indices.insert(indices.end(), {i00, i10, i01, i10, i11, i01});
+            }
+        }
+
+        xzVbo_ = rlLoadVertexBuffer(xz.data(), static_cast<int>(xz.size() * sizeof(float)), false);
+        ebo_ = rlLoadVertexBufferElement(indices.data(), static_cast<int>(indices.size() * sizeof(unsigned short)), false);
+
+        // Consecutive bands share their boundary row.
+        for (int firstRow = 0; firstRow < grid - 1; firstRow += bandRows - 1) {
+            Band band{};
+            band.rows = std::min(bandRows, grid - firstRow);
+            band.vao = rlLoadVertexArray();
+            rlEnableVertexArray(band.vao);
+            rlEnableVertexBuffer(xzVbo_);
+            rlSetVertexAttribute(static_cast<unsigned int>(locXZ_), 2, RL_FLOAT, false, 0,
+                                 firstRow * grid * 2 * static_cast<int>(sizeof(float)));
+            rlEnableVertexAttribute(static_cast<unsigned int>(locXZ_));
+            rlEnableVertexBufferElement(ebo_);
+            rlDisableVertexArray();
+            bands_.push_back(band);
+        }
+    }
+
+    // Call between BeginMode3D/EndMode3D; queued immediate geometry is flushed first.
+    // False, drawing nothing, when there are more packets than the uniform array holds.
+    bool Draw(const std::vector<HelicalPacket>& packets, float time, float fieldGain) {
+        if (!ready() || bands_.empty() || packets.size() > static_cast<size_t>(kMaxGpuPackets)) return false;
+        packed_.clear();
+        for (const HelicalPacket& packet : packets) {
+            const Vector2 dir = PropagationDir2(packet);
+            const float handed = packet.rightHanded ? 1.0f : -1.0f;
+            const float phase = std::fmod(packet.phase - handed * packet.omega * time, 2.0f * PI);
+            packed_.push_back({packet.pos.x, packet.pos.y, dir.x, dir.y});
+            packed_.push_back({packet.amplitude, 1.0f / (2.0f * packet.sigma * packet.sigma), 2.0f * PI * packet.turnsPerUnit, phase});
+            packed_.push_back({packet.color.r / 255.0f, packet.color.g / 255.0f, packet.color.b / 255.0f, 1.0f});
+        }
+        const float lineSpacing = (kXMax - kXMin) / static_cast<float>(kDefaultGrid - 1);
+        const Vector4 surface = {kFieldHeightScale * fieldGain, static_cast<float>(packets.size()), lineSpacing, kXMin};
+
+        rlDrawRenderBatchActive();
+        rlEnableShader(shader_);
+        rlSetUniformMatrix(locMvp_, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+        rlSetUniform(locSurface_, &surface, RL_SHADER_UNIFORM_VEC4, 1);
+        if (!packed_.empty()) rlSetUniform(locPackets_, packed_.data(), RL_SHADER_UNIFORM_VEC4, static_cast<int>(packed_.size()));
+        rlDisableBackfaceCulling();
+        for (const Band& band : bands_) {
+            rlEnableVertexArray(band.vao);
+            rlDrawVertexArrayElements(0, (band.rows - 1) * (grid_ - 1) * 6, nullptr);
+        }
+        rlDisableVertexArray();
+        rlEnableBackfaceCulling();
+        rlDisableShader();
+        return true;
+    }
+
+    // Must run before CloseWindow().
+    void Unload() {
+        UnloadBuffers();
+        if (shader_ != 0) rlUnloadShaderProgram(shader_);
+        shader_ = 0;
+    }
+
+  private:
+    struct Band {
+        unsigned int vao = 0;
+        int rows = 0;
+    };
+
+    void UnloadBuffers() {
+        for (const Band& band : bands_) rlUnloadVertexArray(band.vao);
+        bands_.clear();
+        if (xzVbo_ != 0) rlUnloadVertexBuffer(xzVbo_);
+        if (ebo_ != 0) rlUnloadVertexBuffer(ebo_);
+        xzVbo_ = ebo_ = 0;
+        grid_ = 0;
+    }
+
+    // packets[3i]: position, propagation direction; [3i + 1]: amplitude, 1 / (2 sigma^2),
+    // 2 pi turns per unit, phase at this time; [3i + 2]: colour.
+    static constexpr const char* kVertexShader = R"(#version 330
+in vec2 vertexXZ;
+uniform mat4 mvp;
+uniform vec4 surface;  // height scale times gain, packet count, line spacing, lattice origin
+uniform vec4 packets[144];  // 3 * kMaxGpuPackets
+out vec4 fragColor;
+out vec2 fragCell;
+void main() {
+    float f = 0.0;
+    float d = 0.0;
+    vec3 tint = vec3(100.0, 155.0, 230.0) / 255.0;
+    float blendWeight = 0.0;
+    int count = int(surface.y);
+    for (int i = 0; i < count; ++i) {
+        vec4 kinematics = packets[3 * i];
+        vec4 wave = packets[3 * i + 1];
+        vec2 rel = vertexXZ - kinematics.xy;
+        float env = exp(-dot(rel, rel) * wave.y);
+        f += wave.x * env * cos(wave.z * dot(rel, kinematics.zw) + wave.w);
+        d += abs(wave.x) * env;
+        float w = env * 0.8;
+        tint = mix(tint, packets[3 * i + 2].rgb, clamp(w / max(0.001, blendWeight + w), 0.0, 1.0));
+        blendWeight += w;
+    }
+    fragColor = vec4(tint, (60.0 + 120.0 * clamp(0.22 + d, 0.0, 1.0)) / 255.0);
+    fragCell = (vertexXZ - surface.w) / surface.z;
+    gl_Position = mvp * vec4(vertexXZ.x, surface.x * f, vertexXZ.y, 1.0);
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+in vec2 fragCell;
+out vec4 finalColor;
+void main() {
+    vec2 d = abs(fract(fragCell + 0.5) - 0.5) / max(fwidth(fragCell), vec2(1e-5));
+    float line = 1.0 - clamp(min(d.x, d.y), 0.0, 1.0);
+    finalColor = mix(fragColor, vec4(fragColor.rgb, 40.0 / 255.0), line);
 }
+)";
+
+    unsigned int shader_ = 0;
+    int locXZ_ = -1;
+    int locMvp_ = -1;
+    int locSurface_ = -1;
+    int locPackets_ = -1;
+    unsigned int xzVbo_ = 0;
+    unsigned int ebo_ = 0;
+    int grid_ = 0;
+    std::vector<Band> bands_;
+    std::vector<Vector4> packed_;
+};
 
 HelicalPacket MakePacket(Vector2 pos,
                          Vector2 vel,
@@ -189,7 +384,9 @@ std::string HudText(int waveCount,
                     bool paused,
                     bool autoSpawn,
                     float fieldGain,
-                    bool rightHanded) {
+                    bool rightHanded,
+                    int grid,
+                    bool gpuSurface) {
     std::ostringstream os;
     os.setf(std::ios::fixed);
     os.precision(2);
@@ -197,14 +394,15 @@ std::string HudText(int waveCount,
        << "  merges=" << mergeCount
        << "  gain=" << fieldGain
        << "  hand=" << (rightHanded ? "right" : "left")
-       << "  auto=" << (autoSpawn ? "on" : "off");
+       << "  auto=" << (autoSpawn ? "on" : "off")
+       << "  grid=" << grid << "^2 " << (gpuSurface ? "GPU" : "CPU");
     if (paused) os << "  [PAUSED]";
     return os.str();
 }
 
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
     InitWindow(kScreenWidth, kScreenHeight, "Helical Probability Wave Field 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -265,9 +463,12 @@ int main() {
     packets.push_back(MakePacket({-4.5f, -1.3f}, {1.28f, 0.22f}, 1.0f, 1.0f, 0.34f, 1.08f, 5.8f, 0.3f, true, Color{90, 210, 255, 255}));
     packets.push_back(MakePacket({4.6f, 1.4f}, {-1.33f, -0.18f}, 0.92f, 1.1f, 0.30f, 0.96f, 5.4f, 1.5f, false, Color{255, 150, 118, 255}));
 
-    std::vector<float> field(kGridX * kGridZ, 0.0f);
-    std::vector<float> density(kGridX * kGridZ, 0.0f);
-    std::vector<Color> tint(kGridX * kGridZ, Color{100, 155, 230, 180});
+    int grid = std::clamp(astro_bench::IntArg(argc, argv, "--grid", kDefaultGrid), 2, kMaxGrid);
+    PacketSurfaceMesh surfaceMesh;
+    surfaceMesh.Init();
+    std::vector<float> field;
+    std::vector<float> density;
+    std::vector<Color> tint;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
@@ -293,6 +494,11 @@ int main() {
         if (IsKeyPressed(KEY_FOUR)) spawnEdgePacket(3);
         if (IsKeyPressed(KEY_SPACE)) spawnCollisionPair();
 
+        if (IsKeyPressed(KEY_G)) {
+            const int* next = std::upper_bound(kGridChoices, kGridChoices + kGridChoiceCount, grid);
+            grid = next == kGridChoices + kGridChoiceCount ? kGridChoices[0] : *next;
+        }
+
         if (IsKeyPressed(KEY_LEFT_BRACKET)) fieldGain = std::max(0.45f, fieldGain - 0.08f);
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) fieldGain = std::min(1.8f, fieldGain + 0.08f);
 
@@ -366,28 +572,39 @@ int main() {
             packets = std::move(next);
         }
 
-        for (int ix = 0; ix < kGridX; ++ix) {
-            for (int iz = 0; iz < kGridZ; ++iz) {
-                const float x = kXMin + (kXMax - kXMin) * static_cast<float>(ix) / static_cast<float>(kGridX - 1);
-                const float z = kZMin + (kZMax - kZMin) * static_cast<float>(iz) / static_cast<float>(kGridZ - 1);
-                float f = 0.0f;
-                float d = 0.0f;
-                Color mix = Color{100, 155, 230, 180};
-                float blendWeight = 0.0f;
-
-                for (const HelicalPacket& packet : packets) {
-                    const float env = PacketEnvelope(packet, x, z);
-                    f += PacketContribution(packet, x, z, time);
-                    d += std::fabs(packet.amplitude) * env;
-                    const float w = env * 0.8f;
-                    mix = MixColor(mix, packet.color, Saturate(w / std::max(0.001f, blendWeight + w)));
-                    blendWeight += w;
+        // The CPU field is only sampled when the shader path is missing or this frame has
+        // more packets than its uniform array holds.
+        surfaceMesh.Resize(grid);
+        const bool gpuSurface = surfaceMesh.ready() && packets.size() <= static_cast<size_t>(kMaxGpuPackets);
+        const int cpuGrid = std::min(grid, kCpuGridMax);
+        if (!gpuSurface) {
+            const size_t cells = static_cast<size_t>(cpuGrid) * cpuGrid;
+            field.resize(cells);
+            density.resize(cells);
+            tint.resize(cells);
+            for (int ix = 0; ix < cpuGrid; ++ix) {
+                for (int iz = 0; iz < cpuGrid; ++iz) {
+                    const float x = GridCoordinate(kXMin, kXMax, ix, cpuGrid);
+                    const float z = GridCoordinate(kZMin, kZMax, iz, cpuGrid);
+                    float f = 0.0f;
+                    float d = 0.0f;
+                    Color mix = Color{100, 155, 230, 180};
+                    float blendWeight = 0.0f;
+
+                    for (const HelicalPacket& packet : packets) {
+                        const float env = PacketEnvelope(packet, x, z);
+                        f += PacketContribution(packet, x, z, time);
+                        d += std::fabs(packet.amplitude) * env;
+                        const float w = env * 0.8f;
+                        mix = MixColor(mix, packet.color, Saturate(w / std::max(0.001f, blendWeight + w)));
+                        blendWeight += w;
+                    }
+
+                    const int idx = ix * cpuGrid + iz;
+                    field[idx] = fieldGain * f;
+                    density[idx] = d;
+                    tint[idx] = WithAlpha(mix, static_cast<unsigned char>(60.0f + 120.0f * Saturate(0.22f + d)));
                 }
-
-                const int idx = ix * kGridZ + iz;
-                field[idx] = fieldGain * f;
-                density[idx] = d;
-                tint[idx] = WithAlpha(mix, static_cast<unsigned char>(60.0f + 120.0f * Saturate(0.22f + d)));
             }
         }
 
@@ -407,22 +624,26 @@ int main() {
             DrawLine3D({kXMin, 0.0f, static_cast<float>(i)}, {kXMax, 0.0f, static_cast<float>(i)}, gridColor);
         }
 
-        for (int ix = 0; ix < kGridX - 1; ++ix) {
-            for (int iz = 0; iz < kGridZ - 1; ++iz) {
-                const int i00 = ix * kGridZ + iz;
-                const int i10 = (ix + 1) * kGridZ + iz;
-                const int i01 = ix * kGridZ + (iz + 1);
-                const int i11 = (ix + 1) * kGridZ + (iz + 1);
-
-                const Vector3 p00 = GridPoint(ix, iz, field[i00]);
-                const Vector3 p10 = GridPoint(ix + 1, iz, field[i10]);
-                const Vector3 p01 = GridPoint(ix, iz + 1, field[i01]);
-                const Vector3 p11 = GridPoint(ix + 1, iz + 1, field[i11]);
-
-                DrawTriangle3D(p00, p10, p01, tint[i00]);
-                DrawTriangle3D(p10, p11, p01, tint[i11]);
-                DrawLine3D(p00, p10, WithAlpha(tint[i00], 40));
-                DrawLine3D(p00, p01, WithAlpha(tint[i00], 40));
+        if (gpuSurface) {
+            surfaceMesh.Draw(packets, time, fieldGain);
+        } else {
+            for (int ix = 0; ix < cpuGrid - 1; ++ix) {
+                for (int iz = 0; iz < cpuGrid - 1; ++iz) {
+                    const int i00 = ix * cpuGrid + iz;
+                    const int i10 = (ix + 1) * cpuGrid + iz;
+                    const int i01 = ix * cpuGrid + (iz + 1);
+                    const int i11 = (ix + 1) * cpuGrid + (iz + 1);
+
+                    const Vector3 p00 = GridPoint(ix, iz, cpuGrid, field[i00]);
+                    const Vector3 p10 = GridPoint(ix + 1, iz, cpuGrid, field[i10]);
+                    const Vector3 p01 = GridPoint(ix, iz + 1, cpuGrid, field[i01]);
+                    const Vector3 p11 = GridPoint(ix + 1, iz + 1, cpuGrid, field[i11]);
+
+                    DrawTriangle3D(p00, p10, p01, tint[i00]);
+                    DrawTriangle3D(p10, p11, p01, tint[i11]);
+                    DrawLine3D(p00, p10, WithAlpha(tint[i00], 40));
+                    DrawLine3D(p00, p01, WithAlpha(tint[i00], 40));
+                }
             }
         }
 
@@ -440,9 +661,10 @@ int main() {
         DrawText("Helical Probability Wave Field", 20, 18, 30, Color{234, 240, 250, 255});
         DrawText("Each excitation is rendered as an actual traveling helix riding over the field surface. When two packet cores overlap, they fuse into one helix.", 20, 54, 18, Color{168, 184, 208, 255});
         DrawText("1/2/3/4 spawn from edges | SPACE collision pair | H toggle next handedness", 20, 80, 17, Color{168, 184, 208, 255});
-        DrawText("Mouse drag orbit | wheel zoom | A auto | [ ] field gain | P pause | R reset", 20, 104, 17, Color{168, 184, 208, 255});
+        DrawText("Mouse drag orbit | wheel zoom | A auto | [ ] field gain | G grid | P pause | R reset", 20, 104, 17, Color{168, 184, 208, 255});
 
-        const std::string hud = HudText(static_cast<int>(packets.size()), mergeCount, paused, autoSpawn, fieldGain, nextRightHanded);
+        const std::string hud = HudText(static_cast<int>(packets.size()), mergeCount, paused, autoSpawn, fieldGain, nextRightHanded,
+                                        gpuSurface ? grid : cpuGrid, gpuSurface);
         DrawText(hud.c_str(), 20, 134, 20, Color{126, 226, 255, 255});
 
         DrawRectangleRounded({986.0f, 20.0f, 310.0f, 114.0f}, 0.08f, 14, Color{10, 18, 31, 205});
@@ -453,9 +675,13 @@ int main() {
         DrawText("actual helical wave packets", 1006, 106, 16, Color{172, 190, 214, 255});
 
         DrawFPS(20, 164);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    surfaceMesh.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,15 +1,14 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
+#include "../vision/live_controls.h"
 
 #include <algorithm>
-#include <cctype>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
-#include <filesystem>
-#include <fstream>
 #include <iomanip>
-#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -28,32 +27,6 @@ struct SamplePoint {
     Color color;
 };
 
-struct LiveControls {
-    float zoom = 1.0f;
-    float rotationDeg = 0.0f;
-    float pitchDeg = 0.0f;
-    float waveAmp = 1.0f;
-    bool paused = false;
-    bool zoomLineActive = false;
-    float zoomLineAx = 0.5f;
-    float zoomLineAy = 0.5f;
-    float zoomLineBx = 0.5f;
-    float zoomLineBy = 0.5f;
-    std::string label = "Unknown";
-    std::string gesture = "none";
-    float pinchRatio = 0.0f;
-    int nIncCount = 0;
-    int nDecCount = 0;
-    std::int64_t timestampMs = 0;
-};
-
-std::string Trim(std::string s) {
-    auto notSpace = [](unsigned char ch) { return !std::isspace(ch); };
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
-    s.erase(std::find_if(s.rbegin(), s.rend(), notSpace).base(), s.end());
-    return s;
-}
-
 std::int64_t UnixMsNow() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
@@ -92,73 +65,6 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     UpdateCameraFromOrbit(camera, *yaw, *pitch, *distance);
 }
 
-std::optional<LiveControls> ParseLiveControlsFile(const std::filesystem::path& path) {
-    std::ifstream in(path);
-    if (!in.is_open()) return std::nullopt;
-
-    LiveControls lc;
-    std::string line;
-    while (std::getline(in, line)) {
-        std::size_t eq = line.find('=');
-        if (eq == std::string::npos) continue;
-        std::string key = Trim(line.substr(0, eq));
-        std::string val = Trim(line.substr(eq + 1));
-
-        try {
-            if (key == "zoom") lc.zoom = std::stof(val);
-            else if (key == "rotation_deg") lc.rotationDeg = std::stof(val);
-            else if (key == "pitch_deg") lc.pitchDeg = std::stof(val);
-            else if (key == "wave_amp") lc.waveAmp = std::stof(val);
-            else if (key == "paused") lc.paused = (val == "1" || val == "true" || val == "True");
-            else if (key == "zoom_line_active") lc.zoomLineActive = (val == "1" || val == "true" || val == "True");
-            else if (key == "zoom_line_ax") lc.zoomLineAx = std::stof(val);
-            else if (key == "zoom_line_ay") lc.zoomLineAy = std::stof(val);
-            else if (key == "zoom_line_bx") lc.zoomLineBx = std::stof(val);
-            else if (key == "zoom_line_by") lc.zoomLineBy = std::stof(val);
-            else if (key == "label") lc.label = val;
-            else if (key == "gesture") lc.gesture = val;
-            else if (key == "pinch_ratio") lc.pinchRatio = std::stof(val);
-            else if (key == "n_inc_count") lc.nIncCount = std::stoi(val);
-            else if (key == "n_dec_count") lc.nDecCount = std::stoi(val);
-            else if (key == "timestamp_ms") lc.timestampMs = std::stoll(val);
-        } catch (...) {
-            // Ignore malformed values; keep defaults.
-        }
-    }
-
-    if (lc.timestampMs <= 0) return std::nullopt;
-    return lc;
-}
-
-std::optional<LiveControls> LoadLiveControls() {
-    static std::optional<std::filesystem::path> cachedPath;
-
-    auto tryPath = [](const std::filesystem::path& p) -> std::optional<LiveControls> {
-        if (!std::filesystem::exists(p)) return std::nullopt;
-        return ParseLiveControlsFile(p);
-    };
-
-    if (cachedPath) {
-        if (auto parsed = tryPath(*cachedPath)) return parsed;
-    }
-
-    const std::vector<std::filesystem::path> candidates = {
-        "vision/live_controls.txt",
-        "../vision/live_controls.txt",
-        "../../vision/live_controls.txt",
-        "AstroPhysics/vision/live_controls.txt",
-        std::filesystem::path(__FILE__).parent_path().parent_path() / "vision" / "live_controls.txt",
-    };
-
-    for (const auto& p : candidates) {
-        if (auto parsed = tryPath(p)) {
-            cachedPath = p;
-            return parsed;
-        }
-    }
-    return std::nullopt;
-}
-
 float PsiN(float x, float L, int n) {
     if (x < 0.0f || x > L) return 0.0f;
     return std::sqrt(2.0f / L) * std::sin(static_cast<float>(n) * PI * x / L);
@@ -241,6 +147,9 @@ int main() {
     float prevLivePitchDeg = 0.0f;
     int prevLiveNIncCount = 0;
     int prevLiveNDecCount = 0;
+    astro_hand::LiveControlsWatcher liveControls;
+    liveControls.Start();
+    liveControls.ListenUdp();
     std::string controlStatus = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
 
     while (!WindowShouldClose()) {
@@ -265,7 +174,8 @@ int main() {
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
         controlStatus = "bridge: waiting for AstroPhysics/vision/live_controls.txt";
 
-        if (auto live = LoadLiveControls()) {
+        liveControls.Poll(GetTime());
+        if (const auto& live = liveControls.Latest()) {
             std::int64_t ageMs = UnixMsNow() - live->timestampMs;
             if (ageMs <= kControlStaleMs) {
                 if (!hasPrevLive) {
@@ -397,9 +307,12 @@ int main() {
         DrawText(controlStatus.c_str(), 20, 110, 18, Color{255, 205, 140, 255});
         DrawFPS(20, 138);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
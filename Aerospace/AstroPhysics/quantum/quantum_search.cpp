@@ -1,8 +1,14 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
+#include "../common/state_vector.h"
+
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -11,6 +17,58 @@
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+constexpr int kDefaultQubits = 4;
+constexpr int kMinQubits = 2;
+constexpr int kMaxWindowQubits = 20;   // 8 MB of amplitudes; headless runs go to 30
+constexpr uint64_t kMaxShownCells = 256;  // basis states drawn around the cursor
+constexpr uint64_t kDefaultTarget = 11;
+
+// Live Grover search on a state vector: the oracle marks any set of basis states and
+// every iteration is the fused gate circuit applied to the amplitudes.
+struct GroverScene {
+    int qubits = kDefaultQubits;
+    std::vector<uint64_t> marked{kDefaultTarget};
+    astro_quantum::StateVector state;
+    astro_quantum::Circuit iteration;
+    int iter = 0;
+};
+
+void ResetSearch(GroverScene* s, bool fused = true) {
+    s->state.Reset(s->qubits);
+    astro_quantum::Circuit init;
+    init.AddLayer(s->qubits, astro_quantum::Hadamard());
+    init.Fused().Run(&s->state);
+    const astro_quantum::Circuit step = astro_quantum::GroverIteration(s->qubits, s->marked);
+    s->iteration = fused ? step.Fused() : step;
+    s->iter = 0;
+}
+
+void StepSearch(GroverScene* s) {
+    s->iteration.Run(&s->state);
+    ++s->iter;
+}
+
+float MarkedProbability(const GroverScene& s) {
+    float p = 0.0f;
+    for (uint64_t m : s.marked) p += s.state.Probability(m);
+    return p;
+}
+
+// Closed form sin^2((2k + 1) theta), sin^2 theta = M / N, for comparison with the state.
+float FormulaProbability(const GroverScene& s) {
+    if (s.marked.empty()) return 0.0f;
+    const double theta = std::asin(std::sqrt(static_cast<double>(s.marked.size()) / static_cast<double>(s.state.size())));
+    return static_cast<float>(std::pow(std::sin((2 * s.iter + 1) * theta), 2.0));
+}
+
+int OptimalIterations(const GroverScene& s) {
+    if (s.marked.empty()) return 0;
+    return static_cast<int>(0.25 * PI * std::sqrt(static_cast<double>(s.state.size()) / static_cast<double>(s.marked.size())));
+}
+
+bool IsMarked(const GroverScene& s, uint64_t basis) {
+    return std::find(s.marked.begin(), s.marked.end(), basis) != s.marked.end();
+}
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -26,7 +84,19 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
 }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 20, 0.0f);
+    if (bench.enabled) {
+        GroverScene scene;
+        scene.qubits = std::clamp(astro_bench::IntArg(argc, argv, "--qubits", 20), kMinQubits, astro_quantum::StateVector::kMaxQubits);
+        scene.marked.clear();
+        const int marks = std::max(1, astro_bench::IntArg(argc, argv, "--marks", 1));
+        for (int m = 0; m < marks; ++m) scene.marked.push_back((kDefaultTarget + 7919u * static_cast<uint64_t>(m)) % (uint64_t{1} << scene.qubits));
+        ResetSearch(&scene, !astro_bench::HasFlag(argc, argv, "--unfused"));
+        return astro_bench::RunBench(
+            "quantum_search", bench, [&](float) { StepSearch(&scene); }, [&]() { return MarkedProbability(scene); });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Quantum Search (Grover Intuition) 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -38,58 +108,111 @@ int main() {
     camera.projection = CAMERA_PERSPECTIVE;
     float camYaw=0.84f, camPitch=0.34f, camDistance=13.0f;
 
-    int N = 16;
-    int target = 11;
-    int iter = 0;
+    GroverScene scene;
+    ResetSearch(&scene);
+    uint64_t cursor = kDefaultTarget;
+    bool autoRun = false;
     bool paused = false;
     float t=0.0f;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused=!paused;
-        if (IsKeyPressed(KEY_R)) { iter=0; target=11; paused=false; t=0.0f; }
-        if (IsKeyPressed(KEY_SPACE)) iter++;
-        if (IsKeyPressed(KEY_LEFT_BRACKET)) target = std::max(0, target-1);
-        if (IsKeyPressed(KEY_RIGHT_BRACKET)) target = std::min(N-1, target+1);
+        if (IsKeyPressed(KEY_R)) {
+            scene.qubits = kDefaultQubits;
+            scene.marked = {kDefaultTarget};
+            cursor = kDefaultTarget;
+            autoRun = false;
+            paused = false;
+            t = 0.0f;
+            ResetSearch(&scene);
+        }
+        if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_DOWN)) {
+            scene.qubits = std::clamp(scene.qubits + (IsKeyPressed(KEY_UP) ? 1 : -1), kMinQubits, kMaxWindowQubits);
+            const uint64_t size = uint64_t{1} << scene.qubits;
+            scene.marked.erase(std::remove_if(scene.marked.begin(), scene.marked.end(), [&](uint64_t m) { return m >= size; }), scene.marked.end());
+            cursor = std::min(cursor, size - 1);
+            ResetSearch(&scene);
+        }
+        if (IsKeyPressed(KEY_M)) {
+            // Editing the oracle restarts the search from the uniform superposition.
+            if (IsMarked(scene, cursor)) {
+                scene.marked.erase(std::find(scene.marked.begin(), scene.marked.end(), cursor));
+            } else {
+                scene.marked.push_back(cursor);
+            }
+            ResetSearch(&scene);
+        }
+        if (IsKeyPressed(KEY_LEFT_BRACKET) && cursor > 0) --cursor;
+        if (IsKeyPressed(KEY_RIGHT_BRACKET) && cursor + 1 < scene.state.size()) ++cursor;
+        if (IsKeyPressed(KEY_ENTER)) autoRun = !autoRun;
+        if (IsKeyPressed(KEY_SPACE)) StepSearch(&scene);
+        if (autoRun && !paused) {
+            if (scene.iter < OptimalIterations(scene)) {
+                StepSearch(&scene);
+            } else {
+                autoRun = false;
+            }
+        }
 
         UpdateOrbitCameraDragOnly(&camera,&camYaw,&camPitch,&camDistance);
         if (!paused) t += GetFrameTime();
 
-        float theta = std::asin(1.0f / std::sqrt(static_cast<float>(N)));
-        float pTarget = std::pow(std::sin((2*iter+1)*theta), 2.0f);
-        pTarget = std::clamp(pTarget, 0.0f, 1.0f);
-        float pOther = (1.0f - pTarget) / (N - 1);
+        const uint64_t N = scene.state.size();
+        // Up to 256 basis states around the cursor, read straight from the amplitudes.
+        const uint64_t cells = std::min<uint64_t>(N, kMaxShownCells);
+        const uint64_t base = cursor & ~(cells - 1);
+        int cellBits = 0;
+        while ((uint64_t{1} << cellBits) < cells) ++cellBits;
+        const int cols = 1 << ((cellBits + 1) / 2);
+        const float spacing = 6.4f / static_cast<float>(cols);
+        const float origin = -0.5f * spacing * static_cast<float>(cols - 1);
 
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
 
-        for (int i=0;i<N;++i) {
-            int row = i / 4;
-            int col = i % 4;
-            float x = -2.4f + col * 1.6f;
-            float z = -2.4f + row * 1.6f;
-            float p = (i==target) ? pTarget : pOther;
-            float h = 0.2f + 2.0f * p;
-            Color c = (i==target) ? Color{255, 180, 120, 255} : Color{120, 200, 255, 230};
-            DrawCube({x, 0.1f + h*0.5f, z}, 0.7f, h, 0.7f, c);
+        for (uint64_t k = 0; k < cells; ++k) {
+            const uint64_t i = base + k;
+            const int row = static_cast<int>(k) / cols;
+            const int col = static_cast<int>(k) % cols;
+            const float x = origin + col * spacing;
+            const float z = origin + row * spacing;
+            const astro_quantum::Amplitude a = scene.state.amplitude(i);
+            const float h = 0.2f + 2.0f * std::abs(a);
+            const float w = 0.44f * spacing;
+            Color c = a.real() >= 0.0f ? Color{120, 200, 255, 230} : Color{176, 132, 255, 230};
+            if (IsMarked(scene, i)) c = Color{255, 180, 120, 255};
+            DrawCube({x, 0.1f + h*0.5f, z}, w, h, w, c);
+            if (i == cursor) {
+                const float pulse = 0.5f + 0.5f * std::sin(4.0f * t);
+                DrawCubeWires({x, 0.1f + h*0.5f, z}, w * 1.25f, h + 0.1f, w * 1.25f, Fade(WHITE, 0.45f + 0.5f * pulse));
+            }
         }
 
         EndMode3D();
 
         DrawText("Quantum Search (Grover) Probability Amplification", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | SPACE iterate | [ ] target index | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | SPACE iterate | ENTER run to optimum | [ ] cursor | M mark/unmark | UP/DOWN qubits | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
 
         std::ostringstream os;
         os << std::fixed << std::setprecision(4)
-           << "N=" << N << "  target=" << target << "  iteration=" << iter
-           << "  P(target)~" << pTarget;
+           << "qubits=" << scene.qubits << "  N=" << N << "  marked=" << scene.marked.size() << "  cursor=" << cursor
+           << "  iteration=" << scene.iter << "/" << OptimalIterations(scene)
+           << "  P(marked)=" << MarkedProbability(scene) << "  formula=" << FormulaProbability(scene);
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{126,224,255,255});
-        DrawFPS(20, 110);
-
+        std::ostringstream info;
+        info << "state vector " << (N * 8) / 1024 << " KiB  |  " << scene.iteration.Passes()
+             << " fused passes per iteration  |  bar height = |amplitude|, violet = negative";
+        DrawText(info.str().c_str(), 20, 108, 18, Color{164,183,210,255});
+        DrawFPS(20, 134);
+
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,17 +1,45 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+
+#include "../common/frame_capture.h"
+#include "../common/gpu_wave_solver.h"
+#include "../common/profiler.h"
 
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
 
+constexpr float kSourceX = -5.0f;
+constexpr float kBarrierX = 0.0f;
+constexpr float kScreenX = 7.0f;
+
+// Wave-equation domain in the z = 0 plane, square cells, sponge layer along every edge.
+constexpr float kDomainX0 = -6.5f;
+constexpr float kDomainY0 = -4.8f;
+constexpr float kDomainWidth = 15.0f;
+constexpr float kDomainHeight = 9.6f;
+constexpr float kSpongeWidth = 1.2f;
+constexpr float kSpongeStrength = 30.0f;
+constexpr float kIntensityTau = 1.5f;  // time average of u^2 behind the screen plot
+constexpr float kSlitWidth = 0.3f;
+constexpr float kWallThickness = 0.08f;  // thin, so the slits do not act as cut-off waveguides
+constexpr float kSourceRadius = 0.15f;
+constexpr float kDriveScale = 400.0f;  // source amplitude per c^2: order-one waves before the barrier
+constexpr int kMaxStepsPerFrame = 32;
+constexpr int kGridSizes[] = {512, 1024, 2048};
+constexpr int kGridSizeCount = static_cast<int>(sizeof(kGridSizes) / sizeof(kGridSizes[0]));
+constexpr float kPlotHalf = 3.6f;  // screen plot stops where the sponge begins
+constexpr int kPlotBins = 180;
+
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
         Vector2 d = GetMouseDelta();
@@ -44,6 +72,94 @@ float IntensityAtScreen(float y, float slitSep, float wavelength, float screenX)
     return envelope * 0.5f * (1.0f + std::cos(phase));
 }
 
+astro_wave::WaveDomain MakeDomain(int nx) {
+    astro_wave::WaveDomain domain;
+    domain.x0 = kDomainX0;
+    domain.y0 = kDomainY0;
+    domain.width = kDomainWidth;
+    domain.nx = nx;
+    domain.ny = static_cast<int>(std::lround(nx * kDomainHeight / kDomainWidth));
+    return domain;
+}
+
+// The barrier runs the full height of the domain so no wave gets round its ends.
+bool IsBarrier(float x, float y, float slitSep) {
+    if (std::fabs(x - kBarrierX) > 0.5f * kWallThickness) return false;
+    return std::fabs(std::fabs(y) - 0.5f * slitSep) > 0.5f * kSlitWidth;
+}
+
+bool InitSolver(astro_wave::GpuWaveSolver* solver, int nx, float slitSep) {
+    if (!solver->Init(MakeDomain(nx))) return false;
+    solver->SetMedium([slitSep](float x, float y) { return IsBarrier(x, y, slitSep); }, kSpongeWidth);
+    return true;
+}
+
+// Drawn from both sides so the field stays visible when orbiting behind it.
+void DrawWavePlane(const Texture2D& texture, const astro_wave::WaveDomain& domain) {
+    const float x0 = domain.x0, x1 = domain.x0 + domain.width;
+    const float y0 = domain.y0, y1 = domain.y0 + domain.height();
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex3f(x0, y0, 0.0f);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex3f(x1, y0, 0.0f);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex3f(x1, y1, 0.0f);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex3f(x0, y1, 0.0f);
+
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex3f(x0, y0, 0.0f);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex3f(x0, y1, 0.0f);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex3f(x1, y1, 0.0f);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex3f(x1, y0, 0.0f);
+    rlEnd();
+    rlSetTexture(0);
+}
+
+// Three blocks between the slits, matching the solver's wall mask.
+void DrawBarrier(float slitSep, float top) {
+    const float inner = 0.5f * slitSep - 0.5f * kSlitWidth;
+    const float outer = 0.5f * slitSep + 0.5f * kSlitWidth;
+    const Color color = {100, 110, 130, 120};
+    DrawCube({kBarrierX, 0.0f, 0.0f}, 0.12f, 2.0f * inner, 2.5f, color);
+    DrawCube({kBarrierX, 0.5f * (outer + top), 0.0f}, 0.12f, top - outer, 2.5f, color);
+    DrawCube({kBarrierX, -0.5f * (outer + top), 0.0f}, 0.12f, top - outer, 2.5f, color);
+}
+
+// Screen intensity at height y from the solver's column readback, one value per row.
+float ColumnIntensity(const std::vector<float>& column, const astro_wave::WaveDomain& domain, float y) {
+    if (column.empty()) return 0.0f;
+    const int last = static_cast<int>(column.size()) - 1;  // may still be the previous grid's
+    const int j = std::clamp(static_cast<int>((y - domain.y0) / domain.dx()), 0, last);
+    return column[static_cast<size_t>(j)];
+}
+
+// intensity(y) already normalised to [0, 1].
+template <typename Intensity>
+void DrawScreenPlot(Intensity&& intensity) {
+    DrawCube({kScreenX, 0.0f, 0.0f}, 0.12f, 2.0f * kPlotHalf + 0.4f, 2.8f, Color{110, 130, 170, 170});
+    for (int i = 0; i < kPlotBins; ++i) {
+        const float y0 = -kPlotHalf + 2.0f * kPlotHalf * static_cast<float>(i) / static_cast<float>(kPlotBins);
+        const float y1 = -kPlotHalf + 2.0f * kPlotHalf * static_cast<float>(i + 1) / static_cast<float>(kPlotBins);
+        const float I0 = std::clamp(intensity(y0), 0.0f, 1.0f);
+
+        Color c = Color{
+            static_cast<unsigned char>(80 + 170 * I0),
+            static_cast<unsigned char>(90 + 130 * I0),
+            static_cast<unsigned char>(160 + 90 * I0),
+            255
+        };
+        DrawLine3D({kScreenX + 0.08f, y0, 0.0f}, {kScreenX + 0.08f, y1, 0.0f}, c);
+        DrawSphere({kScreenX + 0.15f + 0.4f * I0, y0, 0.0f}, 0.012f + 0.02f * I0, Color{255, 220, 130, 180});
+    }
+}
+
 std::string Hud(float slitSep, float wavelength, float freq, bool paused) {
     std::ostringstream os;
     os << std::fixed << std::setprecision(2)
@@ -54,6 +170,17 @@ std::string Hud(float slitSep, float wavelength, float freq, bool paused) {
     return os.str();
 }
 
+std::string SolverHud(const astro_wave::GpuWaveSolver& solver, int steps, float frameMs) {
+    std::ostringstream os;
+    if (!solver.ready()) {
+        os << "analytic rings (GPU wave solver needs GL 3.3 float targets)";
+        return os.str();
+    }
+    os << std::fixed << std::setprecision(2) << "GPU wave grid " << solver.domain().nx << "x" << solver.domain().ny
+       << "  steps/frame=" << steps << "  solver " << frameMs << " ms";
+    return os.str();
+}
+
 }  // namespace
 
 int main() {
@@ -71,18 +198,23 @@ int main() {
     float camPitch = 0.31f;
     float camDistance = 13.0f;
 
-    const float sourceX = -5.0f;
-    const float barrierX = 0.0f;
-    const float screenX = 7.0f;
-
     float slitSep = 1.45f;
-    float slitGap = 0.24f;
     float wavelength = 1.05f;
-    float waveFreq = 2.6f;
+    float waveFreq = 2.6f;  // ring speed, and the wave speed c on the GPU grid
     float timeScale = 1.0f;
     bool paused = false;
     float t = 0.0f;
 
+    int gridIndex = kGridSizeCount - 1;
+    astro_wave::GpuWaveSolver solver;
+    InitSolver(&solver, kGridSizes[gridIndex], slitSep);
+    float mediumSep = slitSep;
+    std::vector<float> column;
+    float columnMax = 0.0f;
+    float gain = 1.0f;
+    int stepsPerFrame = 0;
+    float solverMs = 0.0f;
+
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
@@ -92,6 +224,12 @@ int main() {
             timeScale = 1.0f;
             t = 0.0f;
             paused = false;
+            solver.Clear();
+        }
+        if (IsKeyPressed(KEY_N)) {
+            gridIndex = (gridIndex + 1) % kGridSizeCount;
+            InitSolver(&solver, kGridSizes[gridIndex], slitSep);
+            mediumSep = slitSep;
         }
 
         if (IsKeyPressed(KEY_LEFT_BRACKET)) slitSep = std::max(0.6f, slitSep - 0.05f);
@@ -105,84 +243,104 @@ int main() {
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
+        if (solver.ready() && mediumSep != slitSep) {
+            solver.SetMedium([slitSep](float x, float y) { return IsBarrier(x, y, slitSep); }, kSpongeWidth);
+            mediumSep = slitSep;
+        }
+
         if (!paused) {
             t += GetFrameTime() * timeScale;
         }
 
+        // Whole CFL-limited steps covering the frame, capped so a slow GPU runs slow-motion
+        // instead of falling further behind every frame.
+        stepsPerFrame = 0;
+        if (solver.ready() && !paused) {
+            const double start = GetTime();
+            const float simDt = std::min(GetFrameTime(), 1.0f / 30.0f) * timeScale;
+            stepsPerFrame = std::clamp(static_cast<int>(std::ceil(simDt / solver.MaxDt(waveFreq))), 1, kMaxStepsPerFrame);
+            const float dt = std::min(simDt / static_cast<float>(stepsPerFrame), solver.MaxDt(waveFreq));
+
+            astro_wave::WaveSource source;
+            source.x = kSourceX;
+            source.y = 0.0f;
+            source.radius = kSourceRadius;
+            source.amplitude = kDriveScale * waveFreq * waveFreq;
+            source.omega = 2.0f * PI * waveFreq / wavelength;
+            solver.Step(source, waveFreq, kSpongeStrength, kIntensityTau, dt, stepsPerFrame);
+
+            solver.ReadColumn(kScreenX, &column);
+            columnMax = 0.0f;
+            for (int j = 0; j < solver.domain().ny; ++j) {
+                if (std::fabs(solver.domain().Y(j)) <= kPlotHalf) columnMax = std::max(columnMax, column[static_cast<size_t>(j)]);
+            }
+            // Screen rms amplitude maps to mid brightness; eased so start-up noise is not blown up.
+            const float target = std::min(30.0f, 1.0f / std::sqrt(std::max(columnMax, 1.0e-6f)));
+            gain += (target - gain) * 0.05f;
+            solver.Colorize(gain);
+            solverMs = static_cast<float>(1000.0 * (GetTime() - start));
+        }
+
         BeginDrawing();
         ClearBackground(Color{6, 9, 17, 255});
 
         BeginMode3D(camera);
 
-        DrawSphere({sourceX, 0.0f, 0.0f}, 0.18f, Color{255, 210, 120, 255});
-
-        DrawCube({barrierX, 0.0f, 0.0f}, 0.2f, 4.0f, 2.5f, Color{100, 110, 130, 120});
-
-        DrawCube({barrierX,  0.5f * slitSep + slitGap, 0.0f}, 0.24f, 1.6f, 2.6f, Color{6, 9, 17, 255});
-        DrawCube({barrierX, -0.5f * slitSep - slitGap, 0.0f}, 0.24f, 1.6f, 2.6f, Color{6, 9, 17, 255});
-
-        DrawCube({screenX, 0.0f, 0.0f}, 0.12f, 5.0f, 2.8f, Color{110, 130, 170, 170});
-
-        Vector3 slit1 = {barrierX,  0.5f * slitSep, 0.0f};
-        Vector3 slit2 = {barrierX, -0.5f * slitSep, 0.0f};
-
-        DrawLine3D({sourceX, 0.0f, 0.0f}, slit1, Color{255, 120, 100, 170});
-        DrawLine3D({sourceX, 0.0f, 0.0f}, slit2, Color{255, 120, 100, 170});
-
-        for (int i = 0; i < 18; ++i) {
-            float r = std::fmod(t * waveFreq + 0.5f * i, 12.0f);
-            float alpha = static_cast<float>(1.0 - i / 18.0);
-
-            int segs = 80;
-            for (int s = 0; s < segs; ++s) {
-                float a0 = 2.0f * PI * static_cast<float>(s) / static_cast<float>(segs);
-                float a1 = 2.0f * PI * static_cast<float>(s + 1) / static_cast<float>(segs);
-                Vector3 p0a = {slit1.x + r * std::cos(a0), slit1.y + r * std::sin(a0), 0.0f};
-                Vector3 p1a = {slit1.x + r * std::cos(a1), slit1.y + r * std::sin(a1), 0.0f};
-                Vector3 p0b = {slit2.x + r * std::cos(a0), slit2.y + r * std::sin(a0), 0.0f};
-                Vector3 p1b = {slit2.x + r * std::cos(a1), slit2.y + r * std::sin(a1), 0.0f};
-
-                Color c1 = Color{110, 190, 255, static_cast<unsigned char>(30 + 90 * alpha)};
-                DrawLine3D(p0a, p1a, c1);
-                DrawLine3D(p0b, p1b, c1);
+        DrawSphere({kSourceX, 0.0f, 0.0f}, 0.18f, Color{255, 210, 120, 255});
+
+        Vector3 slit1 = {kBarrierX,  0.5f * slitSep, 0.0f};
+        Vector3 slit2 = {kBarrierX, -0.5f * slitSep, 0.0f};
+
+        if (solver.ready()) {
+            DrawWavePlane(solver.display(), solver.domain());
+            DrawBarrier(slitSep, kDomainY0 + kDomainHeight);
+            const float norm = 1.0f / std::max(columnMax, 1.0e-12f);
+            DrawScreenPlot([&](float y) { return ColumnIntensity(column, solver.domain(), y) * norm; });
+        } else {
+            DrawBarrier(slitSep, 2.0f);
+
+            DrawLine3D({kSourceX, 0.0f, 0.0f}, slit1, Color{255, 120, 100, 170});
+            DrawLine3D({kSourceX, 0.0f, 0.0f}, slit2, Color{255, 120, 100, 170});
+
+            for (int i = 0; i < 18; ++i) {
+                float r = std::fmod(t * waveFreq + 0.5f * i, 12.0f);
+                float alpha = static_cast<float>(1.0 - i / 18.0);
+
+                int segs = 80;
+                for (int s = 0; s < segs; ++s) {
+                    float a0 = 2.0f * PI * static_cast<float>(s) / static_cast<float>(segs);
+                    float a1 = 2.0f * PI * static_cast<float>(s + 1) / static_cast<float>(segs);
+                    Vector3 p0a = {slit1.x + r * std::cos(a0), slit1.y + r * std::sin(a0), 0.0f};
+                    Vector3 p1a = {slit1.x + r * std::cos(a1), slit1.y + r * std::sin(a1), 0.0f};
+                    Vector3 p0b = {slit2.x + r * std::cos(a0), slit2.y + r * std::sin(a0), 0.0f};
+                    Vector3 p1b = {slit2.x + r * std::cos(a1), slit2.y + r * std::sin(a1), 0.0f};
+
+                    Color c1 = Color{110, 190, 255, static_cast<unsigned char>(30 + 90 * alpha)};
+                    DrawLine3D(p0a, p1a, c1);
+                    DrawLine3D(p0b, p1b, c1);
+                }
             }
-        }
-
-        const int bins = 180;
-        for (int i = 0; i < bins; ++i) {
-            float y0 = -2.3f + 4.6f * static_cast<float>(i) / static_cast<float>(bins - 1);
-            float y1 = -2.3f + 4.6f * static_cast<float>(i + 1) / static_cast<float>(bins - 1);
-
-            float I0 = IntensityAtScreen(y0, slitSep, wavelength, screenX - barrierX);
-            float I1 = IntensityAtScreen(y1, slitSep, wavelength, screenX - barrierX);
-
-            Color c = Color{
-                static_cast<unsigned char>(80 + 170 * I0),
-                static_cast<unsigned char>(90 + 130 * I0),
-                static_cast<unsigned char>(160 + 90 * I0),
-                255
-            };
-
-            Vector3 p0 = {screenX + 0.08f, y0, 0.0f};
-            Vector3 p1 = {screenX + 0.08f, y1, 0.0f};
-            DrawLine3D(p0, p1, c);
-
-            DrawSphere({screenX + 0.15f + 0.4f * I0, y0, 0.0f}, 0.012f + 0.02f * I0, Color{255, 220, 130, 180});
 
-            (void)I1;
+            DrawScreenPlot([&](float y) { return IntensityAtScreen(y, slitSep, wavelength, kScreenX - kBarrierX); });
         }
 
         EndMode3D();
 
         DrawText("Double-Slit Interference (Wave Picture)", 20, 18, 29, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] slit sep | +/- wavelength | , . freq | ; ' time | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
-        std::string hud = Hud(slitSep, wavelength, waveFreq, paused);
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] slit sep | +/- wavelength | , . speed | ; ' time | N grid | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
+        std::string hud = Hud(slitSep, wavelength, solver.ready() ? waveFreq / wavelength : waveFreq, paused);
         DrawText(hud.c_str(), 20, 82, 20, Color{126, 224, 255, 255});
-        DrawFPS(20, 112);
+        std::string solverHud = SolverHud(solver, stepsPerFrame, solverMs);
+        DrawText(solverHud.c_str(), 20, 108, 18, Color{170, 200, 230, 255});
+        DrawFPS(20, 136);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    solver.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,16 +1,49 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "rlgl.h"
+
+#include "../common/frame_capture.h"
+#include "../common/headless_bench.h"
+#include "../common/profiler.h"
+#include "../common/split_step_schrodinger.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
+// The solver box spans [-kBoxLength/2, kBoxLength/2) per axis; the scene shows the
+// |x| <= kViewHalfX part (and |y| <= kViewHalfZ along world z in 2D). Everything that
+// leaves the view is damped in the absorbing layer long before it reaches the edge.
+constexpr float kBoxLength = 40.0f;
+constexpr float kViewHalfX = 8.0f;
+constexpr float kViewHalfZ = 4.0f;
+constexpr float kAbsorberWidth = 4.0f;
+constexpr float kAbsorberStrength = 6.0f;
+constexpr float kSolverDt = 1.0f / 120.0f;
+constexpr int kMaxStepsPerFrame = 12;
+constexpr int kGrid1D = 4096;
+constexpr std::array<int, 3> kGrid2DSizes = {256, 512, 1024};
+constexpr float kPacketStart = -5.8f;
+constexpr float kPacketSigmaX = 1.5f;  // standard deviation of |psi|^2
+constexpr float kPacketSigmaY = 1.6f;
+// Transmission and reflection count the probability beyond probe lines kProbeOffset
+// outside each barrier face plus what the absorber has removed on that side. A run
+// restarts once they account for kScatteredFraction of the packet and most of it has
+// left the view, or after kRunTimeLimit.
+constexpr float kProbeOffset = 0.5f;
+constexpr float kScatteredFraction = 0.98f;
+constexpr float kRestartInView = 0.2f;
+constexpr float kRunTimeLimit = 30.0f;
+constexpr int kDensityTextureWidth = 256;
+constexpr int kDensityTextureHeight = 128;
 
 void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -31,24 +64,212 @@ void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float
     camera->position = Vector3Add(camera->target, offset);
 }
 
-float Gaussian(float x, float center, float sigma) {
-    float u = (x - center) / sigma;
-    return std::exp(-0.5f * u * u);
+// Wave packet scattering off a square barrier, integrated with the split-step solver
+// (hbar = 1, 2m = 1, so a packet of energy E has k = sqrt(E) and the barrier decay
+// constant is sqrt(V - E), as in the WKB estimate shown next to the measurement).
+struct TunnelingScene {
+    astro_quantum::SplitStepSolver solver;
+    int dims = 1;
+    int grid2D = kGrid2DSizes[0];
+    float barrierCenter = 0.0f;
+    float barrierWidth = 1.0f;
+    float barrierHeight = 1.15f;
+    float packetEnergy = 0.80f;
+    float accumulator = 0.0f;
+    float peakAmplitude = 1.0f;  // max |psi| at launch; scales the plots
+    float transmission = 0.0f;   // past the far probe, including what was absorbed
+    float reflection = 0.0f;     // before the near probe, including what was absorbed
+    float lastTransmission = -1.0f;
+    int runs = 0;
+};
+
+float BarrierLeft(const TunnelingScene& scene) { return scene.barrierCenter - 0.5f * scene.barrierWidth; }
+float BarrierRight(const TunnelingScene& scene) { return scene.barrierCenter + 0.5f * scene.barrierWidth; }
+
+float WkbTransmission(const TunnelingScene& scene) {
+    const float decay = std::sqrt(std::max(0.0f, scene.barrierHeight - scene.packetEnergy)) * scene.barrierWidth;
+    return std::exp(-2.0f * decay);
+}
+
+void ApplyBarrier(TunnelingScene* scene) {
+    const float left = BarrierLeft(*scene);
+    const float right = BarrierRight(*scene);
+    const float height = scene->barrierHeight;
+    scene->solver.SetPotential([&](float x, float) { return x >= left && x < right ? height : 0.0f; });
+}
+
+// The solver splits its absorbed tally at x = 0, which lies inside the barrier.
+void MeasureScattering(TunnelingScene* scene) {
+    const astro_quantum::SplitStepSolver& solver = scene->solver;
+    const float halfBox = 0.5f * kBoxLength;
+    scene->transmission = solver.ProbabilityBetween(BarrierRight(*scene) + kProbeOffset, halfBox) + solver.AbsorbedRight();
+    scene->reflection = solver.ProbabilityBetween(-halfBox, BarrierLeft(*scene) - kProbeOffset) + solver.AbsorbedLeft();
+}
+
+void LaunchPacket(TunnelingScene* scene) {
+    astro_quantum::SplitStepSolver& solver = scene->solver;
+    solver.SetGaussianPacket(kPacketStart, 0.0f, kPacketSigmaX, kPacketSigmaY, std::sqrt(scene->packetEnergy), 0.0f);
+    float peak = 0.0f;
+    for (int j = 0; j < solver.ny(); ++j) {
+        for (int i = 0; i < solver.nx(); ++i) peak = std::max(peak, std::abs(solver.Psi(i, j)));
+    }
+    scene->peakAmplitude = std::max(peak, 1.0e-6f);
+    scene->accumulator = 0.0f;
+    MeasureScattering(scene);
+}
+
+void ConfigureScene(TunnelingScene* scene) {
+    if (scene->dims == 1) {
+        scene->solver.Configure(kGrid1D, 1, kBoxLength, 1.0f, kSolverDt);
+    } else {
+        scene->solver.Configure(scene->grid2D, scene->grid2D, kBoxLength, kBoxLength, kSolverDt);
+    }
+    scene->solver.SetAbsorber(kAbsorberWidth, kAbsorberStrength);
+    ApplyBarrier(scene);
+    LaunchPacket(scene);
+}
+
+// Runs the solver at its fixed step for dt of scene time and accumulates the
+// transmitted and reflected probability; starts a new run once the packet has scattered.
+void StepScene(TunnelingScene* scene, float dt) {
+    astro_quantum::SplitStepSolver& solver = scene->solver;
+    scene->accumulator += dt;
+    int steps = static_cast<int>(scene->accumulator / kSolverDt);
+    if (steps > kMaxStepsPerFrame) {
+        steps = kMaxStepsPerFrame;
+        scene->accumulator = 0.0f;
+    } else {
+        scene->accumulator -= static_cast<float>(steps) * kSolverDt;
+    }
+    if (steps == 0) return;
+    solver.Advance(steps);
+    MeasureScattering(scene);
+
+    const float scattered = scene->transmission + scene->reflection;
+    const float inView = solver.ProbabilityBetween(-kViewHalfX, kViewHalfX);
+    if (solver.time() > kRunTimeLimit || (scattered > kScatteredFraction && inView < kRestartInView)) {
+        scene->lastTransmission = scene->transmission;
+        ++scene->runs;
+        LaunchPacket(scene);
+    }
+}
+
+int ColumnOf(const astro_quantum::SplitStepSolver& solver, float x) {
+    return std::clamp(static_cast<int>((x + 0.5f * kBoxLength) / solver.Dx() + 0.5f), 0, solver.nx() - 1);
+}
+
+int RowOf(const astro_quantum::SplitStepSolver& solver, float y) {
+    return std::clamp(static_cast<int>((y + 0.5f * kBoxLength) / solver.Dy() + 0.5f), 0, solver.ny() - 1);
+}
+
+// |psi| as bead height and Re(psi) as the sideways wobble, plus a continuous envelope.
+void DrawWave1D(const TunnelingScene& scene) {
+    const astro_quantum::SplitStepSolver& solver = scene.solver;
+    const float invPeak = 1.0f / scene.peakAmplitude;
+    const float right = BarrierRight(scene);
+
+    rlBegin(RL_LINES);
+    rlColor4ub(150, 200, 255, 150);
+    constexpr int kSegments = 480;
+    float previous = 0.05f + 1.8f * std::abs(solver.Psi(ColumnOf(solver, -kViewHalfX), 0)) * invPeak;
+    for (int i = 1; i <= kSegments; ++i) {
+        const float x0 = -kViewHalfX + 2.0f * kViewHalfX * static_cast<float>(i - 1) / kSegments;
+        const float x1 = -kViewHalfX + 2.0f * kViewHalfX * static_cast<float>(i) / kSegments;
+        const float y1 = 0.05f + 1.8f * std::abs(solver.Psi(ColumnOf(solver, x1), 0)) * invPeak;
+        rlVertex3f(x0, previous, 0.0f);
+        rlVertex3f(x1, y1, 0.0f);
+        previous = y1;
+    }
+    rlEnd();
+
+    for (int i = 0; i < 96; ++i) {
+        const float x = -kViewHalfX + 2.0f * kViewHalfX * static_cast<float>(i) / 95.0f;
+        const astro_fft::Complex psi = solver.Psi(ColumnOf(solver, x), 0);
+        const float envelope = std::abs(psi) * invPeak;
+        const float y = 0.05f + 1.8f * envelope;
+        const float z = 0.45f * psi.real() * invPeak;
+        const Color c = x > right ? Color{110, 230, 255, 220} : Color{160, 170, 255, 220};
+        DrawSphere({x, y, z}, 0.045f + 0.05f * envelope, c);
+    }
+}
+
+// Probability density over the visible window, brightness |psi|^2 relative to launch.
+void UpdateDensityTexture(const TunnelingScene& scene, std::vector<Color>* pixels, Texture2D texture) {
+    const astro_quantum::SplitStepSolver& solver = scene.solver;
+    const float invPeak2 = 1.0f / (scene.peakAmplitude * scene.peakAmplitude);
+    pixels->resize(static_cast<size_t>(kDensityTextureWidth) * kDensityTextureHeight);
+    for (int v = 0; v < kDensityTextureHeight; ++v) {
+        const float y = -kViewHalfZ + 2.0f * kViewHalfZ * (static_cast<float>(v) + 0.5f) / kDensityTextureHeight;
+        const int row = RowOf(solver, y);
+        for (int u = 0; u < kDensityTextureWidth; ++u) {
+            const float x = -kViewHalfX + 2.0f * kViewHalfX * (static_cast<float>(u) + 0.5f) / kDensityTextureWidth;
+            const float d = std::min(1.0f, std::sqrt(std::norm(solver.Psi(ColumnOf(solver, x), row)) * invPeak2));
+            const float hot = std::max(0.0f, 2.0f * d - 1.0f);
+            (*pixels)[static_cast<size_t>(v) * kDensityTextureWidth + u] = Color{
+                static_cast<unsigned char>(40 + 200 * hot),
+                static_cast<unsigned char>(60 + 180 * d),
+                static_cast<unsigned char>(120 + 135 * d),
+                static_cast<unsigned char>(30 + 225 * d),
+            };
+        }
+    }
+    UpdateTexture(texture, pixels->data());
 }
 
-std::string Hud(float barrierH, float packetE, float transP, bool paused) {
+void DrawDensityPlane(Texture2D texture) {
+    rlSetTexture(texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlTexCoord2f(0.0f, 0.0f);
+    rlVertex3f(-kViewHalfX, 0.03f, -kViewHalfZ);
+    rlTexCoord2f(0.0f, 1.0f);
+    rlVertex3f(-kViewHalfX, 0.03f, kViewHalfZ);
+    rlTexCoord2f(1.0f, 1.0f);
+    rlVertex3f(kViewHalfX, 0.03f, kViewHalfZ);
+    rlTexCoord2f(1.0f, 0.0f);
+    rlVertex3f(kViewHalfX, 0.03f, -kViewHalfZ);
+    rlEnd();
+    rlSetTexture(0);
+}
+
+std::string Hud(float barrierH, float packetE, float transP, float reflectP, float wkb, bool paused) {
     std::ostringstream os;
     os << std::fixed << std::setprecision(2)
        << "Barrier=" << barrierH
        << "  PacketE=" << packetE
-       << "  TransProb~" << transP;
+       << "  T=" << transP
+       << "  R=" << reflectP
+       << "  (WKB~" << wkb << ")";
     if (paused) os << "  [PAUSED]";
     return os.str();
 }
 
+std::string SolverHud(const TunnelingScene& scene) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2)
+       << (scene.dims == 1 ? "1D " : "2D ") << scene.solver.nx();
+    if (scene.dims == 2) os << "x" << scene.solver.ny();
+    os << " split-step  t=" << scene.solver.time() << "  runs=" << scene.runs;
+    if (scene.lastTransmission >= 0.0f) os << "  last T=" << scene.lastTransmission;
+    return os.str();
+}
+
 }  // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 600, 1.0f / 60.0f);
+    if (bench.enabled) {
+        TunnelingScene scene;
+        scene.dims = std::clamp(astro_bench::IntArg(argc, argv, "--dim", 1), 1, 2);
+        scene.grid2D = astro_bench::IntArg(argc, argv, "--grid", kGrid2DSizes[0]);
+        if (!astro_fft::IsPowerOfTwo(scene.grid2D)) scene.grid2D = kGrid2DSizes[0];
+        ConfigureScene(&scene);
+        return astro_bench::RunBench(
+            "quantum_tunneling_viz", bench,
+            [&](float dt) { StepScene(&scene, dt); },
+            [&]() { return scene.transmission + 0.5f * scene.reflection + static_cast<float>(scene.runs); });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Quantum Tunneling 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -63,14 +284,14 @@ int main() {
     float camPitch = 0.35f;
     float camDistance = 14.0f;
 
-    float barrierCenter = 0.0f;
-    float barrierWidth = 1.0f;
-    float barrierHeight = 1.15f;
+    TunnelingScene scene;
+    ConfigureScene(&scene);
 
-    float packetEnergy = 0.80f;
-    float packetCenter = -5.8f;
-    float packetSpeed = 1.25f;
-    float sigma = 0.95f;
+    Image densityImage = GenImageColor(kDensityTextureWidth, kDensityTextureHeight, BLANK);
+    Texture2D densityTexture = LoadTextureFromImage(densityImage);
+    UnloadImage(densityImage);
+    SetTextureFilter(densityTexture, TEXTURE_FILTER_BILINEAR);
+    std::vector<Color> densityPixels;
 
     float timeScale = 1.0f;
     bool paused = false;
@@ -78,90 +299,93 @@ int main() {
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
         if (IsKeyPressed(KEY_R)) {
-            barrierHeight = 1.15f;
-            packetEnergy = 0.80f;
-            packetCenter = -5.8f;
-            packetSpeed = 1.25f;
+            scene.barrierHeight = 1.15f;
+            scene.packetEnergy = 0.80f;
+            scene.runs = 0;
+            scene.lastTransmission = -1.0f;
             timeScale = 1.0f;
             paused = false;
+            ApplyBarrier(&scene);
+            LaunchPacket(&scene);
         }
 
-        if (IsKeyPressed(KEY_LEFT_BRACKET)) barrierHeight = std::max(0.35f, barrierHeight - 0.05f);
-        if (IsKeyPressed(KEY_RIGHT_BRACKET)) barrierHeight = std::min(2.5f, barrierHeight + 0.05f);
-        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT)) packetEnergy = std::max(0.25f, packetEnergy - 0.05f);
-        if (IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) packetEnergy = std::min(2.4f, packetEnergy + 0.05f);
+        if (IsKeyPressed(KEY_LEFT_BRACKET) || IsKeyPressed(KEY_RIGHT_BRACKET)) {
+            scene.barrierHeight = IsKeyPressed(KEY_LEFT_BRACKET) ? std::max(0.35f, scene.barrierHeight - 0.05f)
+                                                                 : std::min(2.5f, scene.barrierHeight + 0.05f);
+            ApplyBarrier(&scene);
+        }
+        if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT) || IsKeyPressed(KEY_EQUAL) || IsKeyPressed(KEY_KP_ADD)) {
+            const bool lower = IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT);
+            scene.packetEnergy = lower ? std::max(0.25f, scene.packetEnergy - 0.05f) : std::min(2.4f, scene.packetEnergy + 0.05f);
+            LaunchPacket(&scene);
+        }
         if (IsKeyPressed(KEY_COMMA)) timeScale = std::max(0.2f, timeScale - 0.2f);
         if (IsKeyPressed(KEY_PERIOD)) timeScale = std::min(5.0f, timeScale + 0.2f);
+        if (IsKeyPressed(KEY_D)) {
+            scene.dims = scene.dims == 1 ? 2 : 1;
+            ConfigureScene(&scene);
+        }
+        if (IsKeyPressed(KEY_N) && scene.dims == 2) {
+            const auto current = std::find(kGrid2DSizes.begin(), kGrid2DSizes.end(), scene.grid2D);
+            const size_t next = current == kGrid2DSizes.end() ? 0 : (current - kGrid2DSizes.begin() + 1) % kGrid2DSizes.size();
+            scene.grid2D = kGrid2DSizes[next];
+            ConfigureScene(&scene);
+        }
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
-        if (!paused) {
-            packetCenter += packetSpeed * GetFrameTime() * timeScale;
-            if (packetCenter > 8.0f) {
-                packetCenter = -5.8f;
-            }
-        }
+        if (!paused) StepScene(&scene, GetFrameTime() * timeScale);
+        if (scene.dims == 2) UpdateDensityTexture(scene, &densityPixels, densityTexture);
 
-        float decay = std::sqrt(std::max(0.0f, barrierHeight - packetEnergy)) * barrierWidth;
-        float transProb = std::exp(-2.0f * decay);
+        const float barrierCenter = scene.barrierCenter;
+        const float barrierWidth = scene.barrierWidth;
+        const float barrierHeight = scene.barrierHeight;
+        const float barrierDepth = scene.dims == 1 ? 3.6f : 2.0f * kViewHalfZ;
 
         BeginDrawing();
         ClearBackground(Color{6, 9, 17, 255});
 
         BeginMode3D(camera);
 
-        DrawCube({barrierCenter, barrierHeight * 0.5f, 0.0f}, barrierWidth, barrierHeight, 3.6f, Color{200, 120, 130, 120});
-        DrawCubeWires({barrierCenter, barrierHeight * 0.5f, 0.0f}, barrierWidth, barrierHeight, 3.6f, Color{255, 170, 180, 200});
-
-        for (int i = 0; i < 96; ++i) {
-            float x = -8.0f + 16.0f * static_cast<float>(i) / 95.0f;
-
-            float incident = Gaussian(x, packetCenter, sigma);
-            float reflected = (1.0f - transProb) * Gaussian(x, -packetCenter - 0.8f, sigma * 1.08f);
-            float transmitted = transProb * Gaussian(x, packetCenter - 1.0f, sigma * 1.15f);
-
-            float envelope = 0.0f;
-            if (x < barrierCenter - barrierWidth * 0.5f) {
-                envelope = incident + reflected;
-            } else if (x > barrierCenter + barrierWidth * 0.5f) {
-                envelope = transmitted;
-            } else {
-                envelope = incident * std::exp(-1.9f * std::fabs(x - barrierCenter));
-            }
-
-            float y = 0.05f + 1.8f * envelope;
-            float phase = 8.0f * x - 4.0f * packetCenter;
-            float z = 0.45f * std::sin(phase) * envelope;
-
-            Color c = (x > barrierCenter + barrierWidth * 0.5f)
-                ? Color{110, 230, 255, 220}
-                : Color{160, 170, 255, 220};
-
-            DrawSphere({x, y, z}, 0.045f + 0.05f * envelope, c);
+        if (scene.dims == 1) {
+            DrawWave1D(scene);
+        } else {
+            DrawDensityPlane(densityTexture);
         }
 
+        DrawCube({barrierCenter, barrierHeight * 0.5f, 0.0f}, barrierWidth, barrierHeight, barrierDepth, Color{200, 120, 130, 120});
+        DrawCubeWires({barrierCenter, barrierHeight * 0.5f, 0.0f}, barrierWidth, barrierHeight, barrierDepth, Color{255, 170, 180, 200});
+
+        const float meterZ = -0.5f * barrierDepth;
         for (int i = 0; i < 100; ++i) {
             float x0 = -8.0f + 16.0f * static_cast<float>(i) / 100.0f;
             float x1 = -8.0f + 16.0f * static_cast<float>(i + 1) / 100.0f;
 
-            float y0 = 0.02f + 0.25f * ((x0 < barrierCenter) ? 0.0f : transProb);
-            float y1 = 0.02f + 0.25f * ((x1 < barrierCenter) ? 0.0f : transProb);
-            DrawLine3D({x0, y0, -1.8f}, {x1, y1, -1.8f}, Color{255, 210, 120, 140});
+            float y0 = 0.02f + 0.25f * ((x0 < barrierCenter) ? scene.reflection : scene.transmission);
+            float y1 = 0.02f + 0.25f * ((x1 < barrierCenter) ? scene.reflection : scene.transmission);
+            DrawLine3D({x0, y0, meterZ}, {x1, y1, meterZ}, Color{255, 210, 120, 140});
         }
 
         EndMode3D();
 
         DrawText("Quantum Tunneling (Wave Packet vs Barrier)", 20, 18, 29, Color{232, 238, 248, 255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] barrier | +/- packet energy | , . time | P pause | R reset", 20, 54, 18, Color{164, 183, 210, 255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | [ ] barrier | +/- packet energy | , . time | D 1D/2D | N grid | P pause | R reset",
+                 20, 54, 18, Color{164, 183, 210, 255});
 
-        std::string hud = Hud(barrierHeight, packetEnergy, transProb, paused);
+        std::string hud = Hud(barrierHeight, scene.packetEnergy, scene.transmission, scene.reflection, WkbTransmission(scene), paused);
         DrawText(hud.c_str(), 20, 82, 20, Color{126, 224, 255, 255});
+        std::string solverHud = SolverHud(scene);
+        DrawText(solverHud.c_str(), 20, 108, 18, Color{149, 201, 255, 255});
 
-        DrawFPS(20, 112);
+        DrawFPS(20, 136);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    UnloadTexture(densityTexture);
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,9 +1,16 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/indexed_lines.h"
+#include "../common/penrose_geodesics.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
+#include <iomanip>
 #include <random>
 #include <sstream>
 #include <string>
@@ -18,6 +25,16 @@ constexpr int kWindowMinHeight = 620;
 constexpr float kSceneScale = 2.2f;
 constexpr float kHalfDepth = 1.25f;
 constexpr float kStarFieldRadius = 95.0f;
+// Diagram corners: future timelike infinity of region I sits at (kCornerX, kCornerY) and
+// spatial infinity at (2 kCornerX, 0), matching astro_penrose's (1, 1) and (2, 0).
+constexpr float kCornerX = 3.2f;
+constexpr float kCornerY = 3.05f;
+constexpr float kBundleDepth = kHalfDepth * 0.8f;
+constexpr float kSliderRate = 0.35f;  // charge or spin per second while a key is held
+constexpr float kParameterStep = 0.01f;  // bundles are cached per step
+constexpr float kMinParameter = 0.05f;
+constexpr float kMaxParameter = 0.95f;
+constexpr std::array<const char*, 3> kMetricNames = {{"Schwarzschild", "Reissner-Nordstrom", "Kerr (spin axis)"}};
 
 struct Region {
     const char* name;
@@ -76,12 +93,21 @@ Vector3 ToWorld(Vector2 p, float z = 0.0f) {
     return {p.x * kSceneScale, p.y * kSceneScale, z};
 }
 
-std::vector<Region> BuildRegions() {
+// Without an inner horizon the black and white holes end on the r = 0 singularity, a
+// flat edge between the corners; with one they run on to the Cauchy horizons.
+std::vector<Region> BuildRegions(bool cauchyHorizon) {
+    const float top = cauchyHorizon ? 2.0f * kCornerY : kCornerY;
+    std::vector<Vector2> blackHole = {{0.0f, 0.0f}, {kCornerX, kCornerY}, {0.0f, top}, {-kCornerX, kCornerY}};
+    std::vector<Vector2> whiteHole = {{-kCornerX, -kCornerY}, {0.0f, -top}, {kCornerX, -kCornerY}, {0.0f, 0.0f}};
+    if (!cauchyHorizon) {
+        blackHole = {{0.0f, 0.0f}, {kCornerX, kCornerY}, {-kCornerX, kCornerY}};
+        whiteHole = {{0.0f, 0.0f}, {-kCornerX, -kCornerY}, {kCornerX, -kCornerY}};
+    }
     return {
         {
             "Universe",
             "Region I",
-            {{0.0f, 0.0f}, {3.2f, 3.05f}, {6.2f, 0.0f}, {3.2f, -3.05f}},
+            {{0.0f, 0.0f}, {kCornerX, kCornerY}, {2.0f * kCornerX, 0.0f}, {kCornerX, -kCornerY}},
             {3.45f, 0.0f},
             Color{82, 189, 255, 255},
             0.0f
@@ -89,23 +115,23 @@ std::vector<Region> BuildRegions() {
         {
             "Black Hole",
             "Region II",
-            {{0.0f, 0.0f}, {3.2f, 3.05f}, {0.0f, 6.15f}, {-3.2f, 3.05f}},
-            {0.0f, 3.55f},
+            blackHole,
+            {0.0f, cauchyHorizon ? 3.55f : 2.0f},
             Color{255, 112, 92, 255},
             1.1f
         },
         {
             "White Hole",
             "Region IV",
-            {{-3.2f, -3.05f}, {0.0f, -6.15f}, {3.2f, -3.05f}, {0.0f, 0.0f}},
-            {0.0f, -3.65f},
+            whiteHole,
+            {0.0f, cauchyHorizon ? -3.65f : -2.0f},
             Color{255, 233, 143, 255},
             2.2f
         },
         {
             "Parallel Universe",
             "Region III",
-            {{-6.2f, 0.0f}, {-3.2f, 3.05f}, {0.0f, 0.0f}, {-3.2f, -3.05f}},
+            {{-2.0f * kCornerX, 0.0f}, {-kCornerX, kCornerY}, {0.0f, 0.0f}, {-kCornerX, -kCornerY}},
             {-3.75f, 0.0f},
             Color{154, 124, 255, 255},
             3.0f
@@ -203,8 +229,10 @@ void DrawRegionLattice(const Region& region, float sceneTime) {
         const float pulse = 0.3f + 0.7f * (0.5f + 0.5f * std::sin(sceneTime * 1.8f + region.pulsePhase + t * 3.0f));
         for (int layer = 0; layer < layers; ++layer) {
             const float z = Mix(-kHalfDepth * 0.85f, kHalfDepth * 0.85f, static_cast<float>(layer) / static_cast<float>(layers - 1));
-            const Vector2 p0 = Vector2Lerp(region.polygon[0], region.polygon[2], t);
-            const Vector2 p1 = Vector2Lerp(region.polygon[1], region.polygon[3], t);
+            // Triangles start at the bifurcation point, so their stripes run parallel to the singularity.
+            const bool triangle = region.polygon.size() == 3;
+            const Vector2 p0 = Vector2Lerp(region.polygon[0], region.polygon[triangle ? 1 : 2], t);
+            const Vector2 p1 = triangle ? Vector2Lerp(region.polygon[0], region.polygon[2], t) : Vector2Lerp(region.polygon[1], region.polygon[3], t);
             DrawLine3D(ToWorld(p0, z), ToWorld(p1, z), WithAlpha(region.color, static_cast<unsigned char>(65 + 90 * pulse)));
         }
     }
@@ -217,7 +245,7 @@ void DrawStars(const std::vector<Star>& stars, float sceneTime) {
     }
 }
 
-Vector3 SampleWorldlinePoint(int regionIndex, float s, int lane, float sceneTime) {
+Vector3 SampleWorldlinePoint(int regionIndex, float s, int lane, float sceneTime, float interiorTop) {
     const float laneShift = (static_cast<float>(lane) - 1.5f) * 0.42f;
     const float z = laneShift * 0.95f;
     const float wobble = 0.18f * std::sin(sceneTime * 1.25f + s * 9.0f + lane * 0.9f);
@@ -232,13 +260,13 @@ Vector3 SampleWorldlinePoint(int regionIndex, float s, int lane, float sceneTime
             const float bend = SmoothStep(0.0f, 1.0f, s);
             const float startX = laneShift * 3.1f;
             const float x = Mix(startX, 0.0f, std::pow(bend, 0.82f)) + wobble * (1.0f - s);
-            const float y = Mix(0.35f, 4.85f, s);
+            const float y = Mix(0.35f, interiorTop, s);
             return ToWorld({x, y}, z);
         }
         case 2: {
             const float endX = laneShift * 3.0f;
             const float x = Mix(0.0f, endX, s) + wobble * s;
-            const float y = Mix(-4.85f, -0.35f, s);
+            const float y = Mix(-interiorTop, -0.35f, s);
             return ToWorld({x, y}, z);
         }
         case 3: {
@@ -251,7 +279,7 @@ Vector3 SampleWorldlinePoint(int regionIndex, float s, int lane, float sceneTime
     }
 }
 
-void DrawWorldline(int regionIndex, int lane, float sceneTime, Color color) {
+void DrawWorldline(int regionIndex, int lane, float sceneTime, float interiorTop, Color color) {
     constexpr int kSegments = 34;
     std::array<Vector3, kSegments> points{};
     const float head = std::fmod(sceneTime * (0.13f + lane * 0.015f) + lane * 0.17f, 1.0f);
@@ -259,7 +287,7 @@ void DrawWorldline(int regionIndex, int lane, float sceneTime, Color color) {
     for (int i = 0; i < kSegments; ++i) {
         const float u = static_cast<float>(i) / static_cast<float>(kSegments - 1);
         const float sample = std::fmod(head + u, 1.0f);
-        points[i] = SampleWorldlinePoint(regionIndex, sample, lane, sceneTime);
+        points[i] = SampleWorldlinePoint(regionIndex, sample, lane, sceneTime, interiorTop);
     }
 
     for (int i = 0; i < kSegments - 1; ++i) {
@@ -271,12 +299,15 @@ void DrawWorldline(int regionIndex, int lane, float sceneTime, Color color) {
     DrawSphereWires(points[0], 0.22f, 10, 10, WithAlpha(color, 110));
 }
 
-void DrawSingularityBand(float y, Color color) {
+// The band widens away from the diagram centre, like the region it caps.
+void DrawSingularityBand(float y, float halfWidth, Color color) {
+    const float lower = y > 0.0f ? halfWidth : halfWidth + 0.4f;
+    const float upper = y > 0.0f ? halfWidth + 0.4f : halfWidth;
     const std::vector<Vector2> band = {
-        {-2.05f, y - 0.22f},
-        {2.05f, y - 0.22f},
-        {2.45f, y + 0.22f},
-        {-2.45f, y + 0.22f},
+        {-lower, y - 0.22f},
+        {lower, y - 0.22f},
+        {upper, y + 0.22f},
+        {-upper, y + 0.22f},
     };
     DrawExtrudedPolygon(band, kHalfDepth * 0.78f, WithAlpha(color, 115), WithAlpha(color, 220));
 }
@@ -288,6 +319,70 @@ void DrawFocusMarker(Vector2 center, float sceneTime, Color color) {
     DrawSphereWires(p, 1.1f * pulse, 14, 14, WithAlpha(color, 90));
 }
 
+// The cached bundle in world space (diagram units times the scene scale, lanes spread
+// through the slab), uploaded once per charge or spin step.
+struct BundleView {
+    astro_render::IndexedLineBuffer lines;
+    std::vector<Vector4> world;
+    astro_penrose::Spacetime spacetime;
+    double outer = 2.0;
+    double inner = 0.0;
+    int curves = 0;
+};
+
+const Color kBundleLow = Color{255, 126, 104, 190};  // r = 0 or the inner horizon
+const Color kBundleHigh = Color{124, 204, 255, 110};  // r = 3 r+ and beyond
+constexpr float kBundleHighRadius = 3.0f;
+
+void UploadBundle(const astro_penrose::GeodesicBundle& bundle, BundleView* view) {
+    view->world.resize(bundle.vertices.size());
+    for (std::size_t i = 0; i < bundle.vertices.size(); ++i) {
+        const Vector4& v = bundle.vertices[i];
+        view->world[i] = {v.x * kCornerX * kSceneScale, v.y * kCornerY * kSceneScale, v.z * kBundleDepth, v.w};
+    }
+    view->spacetime = bundle.spacetime;
+    view->outer = bundle.outer;
+    view->inner = bundle.inner;
+    view->curves = bundle.nullCurves + bundle.timelikeCurves;
+    if (view->lines.Init(static_cast<int>(view->world.size()), bundle.indices)) {
+        view->lines.SetGradient(kBundleLow, kBundleHigh, 0.0f, kBundleHighRadius);
+        view->lines.Update(view->world.data(), static_cast<int>(view->world.size()));
+    }
+}
+
+void DrawBundleFallback(const std::vector<Vector4>& world, const std::vector<uint32_t>& indices) {
+    for (std::size_t i = 0; i + 1 < indices.size(); i += 2) {
+        const Vector4& a = world[indices[i]];
+        const Vector4& b = world[indices[i + 1]];
+        const Color color = LerpColor(kBundleLow, kBundleHigh, 0.5f * (a.w + b.w) / kBundleHighRadius);
+        DrawLine3D({a.x, a.y, a.z}, {b.x, b.y, b.z}, color);
+    }
+}
+
+float Quantise(float v) {
+    return std::round(v / kParameterStep) * kParameterStep;
+}
+
+astro_penrose::Spacetime SpacetimeFor(astro_penrose::Metric metric, float charge, float spin) {
+    astro_penrose::Spacetime s;
+    s.metric = metric;
+    if (metric == astro_penrose::Metric::kReissnerNordstrom) s.charge = Quantise(charge);
+    if (metric == astro_penrose::Metric::kKerrAxis) s.spin = Quantise(spin);
+    return s;
+}
+
+std::string BuildBundleText(const BundleView& view, bool rebuilding) {
+    std::ostringstream out;
+    out << kMetricNames[static_cast<std::size_t>(view.spacetime.metric)] << std::fixed << std::setprecision(2);
+    if (view.spacetime.metric == astro_penrose::Metric::kReissnerNordstrom) out << "  Q = " << view.spacetime.charge;
+    if (view.spacetime.metric == astro_penrose::Metric::kKerrAxis) out << "  a = " << view.spacetime.spin;
+    out << "  r+ " << view.outer;
+    if (view.inner > 0.0) out << "  r- " << view.inner;
+    out << "  |  " << view.curves << " radial geodesics";
+    if (rebuilding) out << "  (rebuilding)";
+    return out.str();
+}
+
 std::string BuildFocusText(const Region& region) {
     std::ostringstream out;
     out << region.name << "  |  " << region.detail;
@@ -310,9 +405,20 @@ int main() {
     camera.projection = CAMERA_PERSPECTIVE;
 
     CameraRig rig;
-    const std::vector<Region> regions = BuildRegions();
     const std::vector<Star> stars = BuildStars();
 
+    // Geodesic bundles are rebuilt off-thread when the charge or spin moves a step; the
+    // diagram keeps drawing the previous one until the new one lands.
+    astro_penrose::Metric metric = astro_penrose::Metric::kSchwarzschild;
+    float charge = 0.6f;
+    float spin = 0.7f;
+    astro_penrose::BundleCache geodesics;
+    geodesics.BuildNow(SpacetimeFor(metric, charge, spin));
+    BundleView bundleView;
+    UploadBundle(*geodesics.bundle(), &bundleView);
+    std::vector<Region> regions = BuildRegions(bundleView.inner > 0.0);
+    bool showBundle = true;
+
     bool paused = false;
     bool autoOrbit = true;
     bool showHud = true;
@@ -329,6 +435,21 @@ int main() {
         if (IsKeyPressed(KEY_TWO)) focusRegion = 1;
         if (IsKeyPressed(KEY_THREE)) focusRegion = 2;
         if (IsKeyPressed(KEY_FOUR)) focusRegion = 3;
+        if (IsKeyPressed(KEY_G)) showBundle = !showBundle;
+        if (IsKeyPressed(KEY_M)) metric = static_cast<astro_penrose::Metric>((static_cast<int>(metric) + 1) % static_cast<int>(kMetricNames.size()));
+        float* parameter = metric == astro_penrose::Metric::kReissnerNordstrom ? &charge
+                         : metric == astro_penrose::Metric::kKerrAxis ? &spin
+                         : nullptr;
+        if (parameter && IsKeyDown(KEY_LEFT_BRACKET)) *parameter = std::max(kMinParameter, *parameter - kSliderRate * dt);
+        if (parameter && IsKeyDown(KEY_RIGHT_BRACKET)) *parameter = std::min(kMaxParameter, *parameter + kSliderRate * dt);
+
+        geodesics.Request(SpacetimeFor(metric, charge, spin));
+        if (geodesics.Acquire()) {
+            UploadBundle(*geodesics.bundle(), &bundleView);
+            regions = BuildRegions(bundleView.inner > 0.0);
+        }
+        const bool cauchyHorizon = bundleView.inner > 0.0;
+        const float interiorTop = cauchyHorizon ? 4.85f : 2.75f;
 
         if (!paused) sceneTime += dt;
 
@@ -344,6 +465,15 @@ int main() {
         BeginMode3D(camera);
         DrawStars(stars, sceneTime);
 
+        // Before the translucent regions, which then tint the lines inside the slab.
+        if (showBundle) {
+            if (bundleView.lines.ready()) {
+                bundleView.lines.Draw();
+            } else {
+                DrawBundleFallback(bundleView.world, geodesics.bundle()->indices);
+            }
+        }
+
         const Color horizonColor = Color{228, 241, 255, 255};
         const Color infinityColor = Color{111, 128, 180, 255};
         const float axisDepth = kHalfDepth * 1.22f;
@@ -359,28 +489,30 @@ int main() {
             DrawRegionLattice(region, sceneTime);
         }
 
-        DrawRibbonSegment({0.0f, 0.0f}, {3.2f, 3.05f}, axisDepth, 0.075f, horizonColor);
-        DrawRibbonSegment({0.0f, 0.0f}, {-3.2f, 3.05f}, axisDepth, 0.075f, horizonColor);
-        DrawRibbonSegment({0.0f, 0.0f}, {3.2f, -3.05f}, axisDepth, 0.075f, horizonColor);
-        DrawRibbonSegment({0.0f, 0.0f}, {-3.2f, -3.05f}, axisDepth, 0.075f, horizonColor);
+        const std::array<Vector2, 4> horizonEnds = {{{kCornerX, kCornerY}, {-kCornerX, kCornerY}, {kCornerX, -kCornerY}, {-kCornerX, -kCornerY}}};
+        for (const Vector2& end : horizonEnds) DrawRibbonSegment({0.0f, 0.0f}, end, axisDepth, 0.075f, horizonColor);
 
-        DrawRibbonSegment({3.2f, 3.05f}, {6.2f, 0.0f}, kHalfDepth, 0.04f, infinityColor);
-        DrawRibbonSegment({6.2f, 0.0f}, {3.2f, -3.05f}, kHalfDepth, 0.04f, infinityColor);
-        DrawRibbonSegment({-3.2f, 3.05f}, {-6.2f, 0.0f}, kHalfDepth, 0.04f, infinityColor);
-        DrawRibbonSegment({-6.2f, 0.0f}, {-3.2f, -3.05f}, kHalfDepth, 0.04f, infinityColor);
+        DrawRibbonSegment({kCornerX, kCornerY}, {2.0f * kCornerX, 0.0f}, kHalfDepth, 0.04f, infinityColor);
+        DrawRibbonSegment({2.0f * kCornerX, 0.0f}, {kCornerX, -kCornerY}, kHalfDepth, 0.04f, infinityColor);
+        DrawRibbonSegment({-kCornerX, kCornerY}, {-2.0f * kCornerX, 0.0f}, kHalfDepth, 0.04f, infinityColor);
+        DrawRibbonSegment({-2.0f * kCornerX, 0.0f}, {-kCornerX, -kCornerY}, kHalfDepth, 0.04f, infinityColor);
 
-        DrawSingularityBand(4.7f, Color{255, 86, 120, 255});
-        DrawSingularityBand(-4.7f, Color{255, 210, 110, 255});
+        if (cauchyHorizon) {
+            const Color cauchyColor = Color{255, 176, 120, 255};
+            for (const Vector2& end : horizonEnds) DrawRibbonSegment(end, {0.0f, end.y > 0.0f ? 2.0f * kCornerY : -2.0f * kCornerY}, axisDepth, 0.06f, cauchyColor);
+        } else {
+            DrawSingularityBand(kCornerY, kCornerX - 0.4f, Color{255, 86, 120, 255});
+            DrawSingularityBand(-kCornerY, kCornerX - 0.4f, Color{255, 210, 110, 255});
+        }
 
         for (int lane = 0; lane < 4; ++lane) {
-            DrawWorldline(0, lane, sceneTime, Color{110, 210, 255, 255});
-            DrawWorldline(1, lane, sceneTime, Color{255, 130, 110, 255});
-            DrawWorldline(2, lane, sceneTime, Color{255, 225, 135, 255});
-            DrawWorldline(3, lane, sceneTime, Color{174, 144, 255, 255});
+            DrawWorldline(0, lane, sceneTime, interiorTop, Color{110, 210, 255, 255});
+            DrawWorldline(1, lane, sceneTime, interiorTop, Color{255, 130, 110, 255});
+            DrawWorldline(2, lane, sceneTime, interiorTop, Color{255, 225, 135, 255});
+            DrawWorldline(3, lane, sceneTime, interiorTop, Color{174, 144, 255, 255});
         }
 
         const float photonPhase = std::fmod(sceneTime * 0.38f, 1.0f);
-        const std::array<Vector2, 4> horizonEnds = {{{3.2f, 3.05f}, {-3.2f, 3.05f}, {3.2f, -3.05f}, {-3.2f, -3.05f}}};
         for (std::size_t i = 0; i < horizonEnds.size(); ++i) {
             const float local = std::fmod(photonPhase + static_cast<float>(i) * 0.23f, 1.0f);
             const Vector2 p = Vector2Lerp({0.0f, 0.0f}, horizonEnds[i], local);
@@ -396,7 +528,8 @@ int main() {
 
         DrawRectangleGradientV(0, 0, GetScreenWidth(), 130, Color{4, 6, 12, 220}, Color{4, 6, 12, 0});
         DrawText("Penrose Diagram in 3D", 26, 20, 30, RAYWHITE);
-        DrawText("Animated interpretation of the eternal Schwarzschild extension", 28, 56, 20, Color{187, 201, 230, 255});
+        const std::string subtitle = std::string("Animated interpretation of the eternal ") + kMetricNames[static_cast<std::size_t>(bundleView.spacetime.metric)] + " extension";
+        DrawText(subtitle.c_str(), 28, 56, 20, Color{187, 201, 230, 255});
 
         int legendY = 102;
         for (std::size_t i = 0; i < regions.size(); ++i) {
@@ -405,6 +538,10 @@ int main() {
             DrawText(regions[i].detail, 54 + static_cast<int>(i) * 245, legendY + 18, 16, Color{180, 188, 210, 255});
         }
 
+        if (showBundle) {
+            DrawText(BuildBundleText(bundleView, geodesics.Busy()).c_str(), 28, GetScreenHeight() - 104, 18, Color{194, 204, 228, 255});
+        }
+
         if (focusRegion >= 0) {
             DrawRectangleRounded(Rectangle{24.0f, static_cast<float>(GetScreenHeight() - 78), 430.0f, 42.0f}, 0.25f, 8, Color{10, 14, 26, 210});
             DrawText(BuildFocusText(regions[focusRegion]).c_str(), 40, GetScreenHeight() - 66, 24, regions[focusRegion].color);
@@ -414,17 +551,24 @@ int main() {
         }
 
         if (showHud) {
-            DrawRectangleRounded(Rectangle{static_cast<float>(GetScreenWidth() - 370), 20.0f, 346.0f, 150.0f}, 0.2f, 8, Color{8, 12, 22, 210});
+            DrawRectangleRounded(Rectangle{static_cast<float>(GetScreenWidth() - 370), 20.0f, 346.0f, 198.0f}, 0.2f, 8, Color{8, 12, 22, 210});
             DrawText("Controls", GetScreenWidth() - 340, 34, 24, RAYWHITE);
             DrawText("Mouse drag: orbit camera", GetScreenWidth() - 340, 66, 20, Color{194, 204, 228, 255});
             DrawText("Wheel: zoom", GetScreenWidth() - 340, 90, 20, Color{194, 204, 228, 255});
             DrawText("1-4: focus regions   0: reset", GetScreenWidth() - 340, 114, 20, Color{194, 204, 228, 255});
             DrawText("A: auto orbit   Space: pause   H: hide", GetScreenWidth() - 340, 138, 20, Color{194, 204, 228, 255});
+            DrawText("M: metric   [ ]: charge / spin", GetScreenWidth() - 340, 162, 20, Color{194, 204, 228, 255});
+            DrawText("G: geodesic bundle", GetScreenWidth() - 340, 186, 20, Color{194, 204, 228, 255});
         }
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
+    geodesics.Stop();
+    bundleView.lines.Unload();
     CloseWindow();
     return 0;
 }
@@ -0,0 +1,162 @@
+"""Reader for the particle snapshots written by common/snapshot_export.h.
+
+    snaps = SnapshotFile("merger.asnp")
+    for k in range(len(snaps)):
+        chunk = snaps[k]          # dict of id, mass, pos (n, 3), vel (n, 3)
+        print(snaps.steps[k], chunk["pos"].mean(axis=0))
+
+The file is mapped with numpy.memmap, so float32 chunks are views into the file and
+nothing is read until it is touched. Quantized chunks are dequantized on access;
+raw(k) returns the stored u16 arrays with their origin and scale instead.
+"""
+
+from __future__ import annotations
+
+import numpy as np
+
+MAGIC = b"ASNP"
+CHUNK_MAGIC = b"ASNC"
+INDEX_MAGIC = b"ASNI"
+FORMAT_VERSION = 1
+ENCODING_FLOAT32 = 0
+ENCODING_QUANTIZED16 = 1
+HEADER_BYTES = 64
+CHUNK_ALIGN = 64
+
+CHUNK_HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "S4"),
+        ("count", "<u4"),
+        ("step", "<u8"),
+        ("time", "<f8"),
+        ("pos_origin", "<f4", 3),
+        ("pos_scale", "<f4", 3),
+        ("vel_origin", "<f4", 3),
+        ("vel_scale", "<f4", 3),
+        ("mass_offset", "<u4"),
+        ("pos_offset", "<u4"),
+        ("vel_offset", "<u4"),
+        ("bytes", "<u4"),
+        ("reserved", "<u4", 2),
+    ]
+)
+
+INDEX_DTYPE = np.dtype(
+    [("offset", "<u8"), ("step", "<u8"), ("time", "<f8"), ("count", "<u4"), ("reserved", "<u4")]
+)
+
+FOOTER_DTYPE = np.dtype([("index_offset", "<u8"), ("chunks", "<u4"), ("magic", "S4")])
+
+assert CHUNK_HEADER_DTYPE.itemsize == 96 and INDEX_DTYPE.itemsize == 32 and FOOTER_DTYPE.itemsize == 16
+
+
+class SnapshotFile:
+    """A snapshot file opened read-only; index k is the k-th chunk in file order."""
+
+    def __init__(self, path):
+        self._map = np.memmap(path, dtype=np.uint8, mode="r")
+        if self._map.size < HEADER_BYTES or bytes(self._map[:4]) != MAGIC:
+            raise ValueError(f"{path}: not a snapshot file")
+        version, encoding, name_length = self._map[4:16].view("<u4")
+        if version != FORMAT_VERSION:
+            raise ValueError(f"{path}: unsupported snapshot version {version}")
+        if encoding not in (ENCODING_FLOAT32, ENCODING_QUANTIZED16):
+            raise ValueError(f"{path}: unknown encoding {encoding}")
+        self.encoding = int(encoding)
+        self.name = bytes(self._map[16 : 16 + int(name_length)]).decode("utf-8", "replace")
+        self.index = self._read_index()
+        if self.index is None:
+            self.index = self._scan_chunks()
+
+    @property
+    def quantized(self) -> bool:
+        return self.encoding == ENCODING_QUANTIZED16
+
+    @property
+    def steps(self) -> np.ndarray:
+        return self.index["step"]
+
+    @property
+    def times(self) -> np.ndarray:
+        return self.index["time"]
+
+    @property
+    def counts(self) -> np.ndarray:
+        return self.index["count"]
+
+    def __len__(self) -> int:
+        return len(self.index)
+
+    def __getitem__(self, k: int) -> dict:
+        raw = self.raw(k)
+        if not self.quantized:
+            return {key: raw[key] for key in ("id", "mass", "pos", "vel")}
+        return {
+            "id": raw["id"],
+            "mass": raw["mass"],
+            "pos": raw["pos_origin"] + raw["pos"].astype(np.float32) * raw["pos_scale"],
+            "vel": raw["vel_origin"] + raw["vel"].astype(np.float32) * raw["vel_scale"],
+        }
+
+    def raw(self, k: int) -> dict:
+        """The chunk's arrays as stored, plus its header fields."""
+        offset = int(self.index["offset"][k])
+        header = self._chunk_header(offset)
+        n = int(header["count"])
+        vector = np.dtype("<u2" if self.quantized else "<f4")
+        vector_bytes = 3 * n * vector.itemsize
+        base = CHUNK_HEADER_DTYPE.itemsize
+        mass_at = offset + int(header["mass_offset"])
+        pos_at = offset + int(header["pos_offset"])
+        vel_at = offset + int(header["vel_offset"])
+        return {
+            "step": int(header["step"]),
+            "time": float(header["time"]),
+            "id": self._map[offset + base : offset + base + 4 * n].view("<u4"),
+            "mass": self._map[mass_at : mass_at + 4 * n].view("<f4"),
+            "pos": self._map[pos_at : pos_at + vector_bytes].view(vector).reshape(n, 3),
+            "vel": self._map[vel_at : vel_at + vector_bytes].view(vector).reshape(n, 3),
+            "pos_origin": header["pos_origin"].copy(),
+            "pos_scale": header["pos_scale"].copy(),
+            "vel_origin": header["vel_origin"].copy(),
+            "vel_scale": header["vel_scale"].copy(),
+        }
+
+    def by_id(self, k: int) -> dict:
+        """Chunk k with every array sorted by particle id."""
+        chunk = self[k]
+        order = np.argsort(chunk["id"], kind="stable")
+        return {key: np.asarray(value)[order] for key, value in chunk.items()}
+
+    def _chunk_header(self, offset: int):
+        end = offset + CHUNK_HEADER_DTYPE.itemsize
+        if end > self._map.size:
+            raise ValueError(f"chunk header at {offset} runs past the end of the file")
+        header = self._map[offset:end].view(CHUNK_HEADER_DTYPE)[0]
+        if header["magic"] != CHUNK_MAGIC:
+            raise ValueError(f"no chunk at offset {offset}")
+        return header
+
+    def _read_index(self):
+        if self._map.size < HEADER_BYTES + FOOTER_DTYPE.itemsize:
+            return None
+        footer = self._map[-FOOTER_DTYPE.itemsize :].view(FOOTER_DTYPE)[0]
+        if footer["magic"] != INDEX_MAGIC:
+            return None
+        start = int(footer["index_offset"])
+        end = start + int(footer["chunks"]) * INDEX_DTYPE.itemsize
+        if end > self._map.size - FOOTER_DTYPE.itemsize:
+            return None
+        return self._map[start:end].view(INDEX_DTYPE)
+
+    def _scan_chunks(self) -> np.ndarray:
+        """Index rebuilt from the chunk headers, for a file whose writer never closed."""
+        entries = []
+        offset = HEADER_BYTES
+        while offset + CHUNK_HEADER_DTYPE.itemsize <= self._map.size:
+            header = self._map[offset : offset + CHUNK_HEADER_DTYPE.itemsize].view(CHUNK_HEADER_DTYPE)[0]
+            if header["magic"] != CHUNK_MAGIC or offset + int(header["bytes"]) > self._map.size:
+                break
+            entries.append((offset, header["step"], header["time"], header["count"], 0))
+            offset += -(-int(header["bytes"]) // CHUNK_ALIGN) * CHUNK_ALIGN
+        return np.array(entries, dtype=INDEX_DTYPE)
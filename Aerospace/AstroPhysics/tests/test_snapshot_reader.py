@@ -0,0 +1,136 @@
+import numpy as np
+import pytest
+
+from snapshot_reader import (
+    CHUNK_ALIGN,
+    CHUNK_HEADER_DTYPE,
+    ENCODING_FLOAT32,
+    ENCODING_QUANTIZED16,
+    FOOTER_DTYPE,
+    INDEX_DTYPE,
+    SnapshotFile,
+)
+
+
+def _align(value, alignment):
+    return -(-value // alignment) * alignment
+
+
+def _write_snapshots(path, chunks, encoding, close=True):
+    """Lays chunks out the way common/snapshot_export.h does."""
+    out = bytearray(b"ASNP" + np.array([1, encoding, 4], "<u4").tobytes() + b"test")
+    out.extend(bytes(64 - len(out)))
+    index = []
+    for step, time, ids, mass, pos, vel in chunks:
+        n = len(ids)
+        header = np.zeros(1, CHUNK_HEADER_DTYPE)
+        header["magic"] = b"ASNC"
+        header["count"] = n
+        header["step"] = step
+        header["time"] = time
+        vectors = []
+        for name, values in (("pos", pos), ("vel", vel)):
+            if encoding == ENCODING_QUANTIZED16:
+                lo, hi = values.min(axis=0), values.max(axis=0)
+                scale = (hi - lo) / np.float32(65535.0)
+                q = np.where(scale > 0, np.rint((values - lo) / np.where(scale > 0, scale, 1)), 0)
+                header[f"{name}_origin"] = lo
+                header[f"{name}_scale"] = scale
+                vectors.append(np.clip(q, 0, 65535).astype("<u2").tobytes())
+            else:
+                header[f"{name}_scale"] = 1.0
+                vectors.append(values.astype("<f4").tobytes())
+        mass_at = _align(96 + 4 * n, 16)
+        pos_at = _align(mass_at + 4 * n, 16)
+        vel_at = _align(pos_at + len(vectors[0]), 16)
+        header["mass_offset"], header["pos_offset"], header["vel_offset"] = mass_at, pos_at, vel_at
+        header["bytes"] = vel_at + len(vectors[1])
+        chunk = bytearray(int(header["bytes"][0]))
+        chunk[:96] = header.tobytes()
+        chunk[96 : 96 + 4 * n] = np.asarray(ids, "<u4").tobytes()
+        chunk[mass_at : mass_at + 4 * n] = np.asarray(mass, "<f4").tobytes()
+        chunk[pos_at : pos_at + len(vectors[0])] = vectors[0]
+        chunk[vel_at : vel_at + len(vectors[1])] = vectors[1]
+        out.extend(bytes(_align(len(out), CHUNK_ALIGN) - len(out)))
+        index.append((len(out), step, time, n, 0))
+        out.extend(chunk)
+    if close:
+        out.extend(bytes(_align(len(out), CHUNK_ALIGN) - len(out)))
+        index_offset = len(out)
+        out.extend(np.array(index, INDEX_DTYPE).tobytes())
+        out.extend(np.array([(index_offset, len(index), b"ASNI")], FOOTER_DTYPE).tobytes())
+    path.write_bytes(bytes(out))
+
+
+def _random_chunks(count, n, seed=7):
+    rng = np.random.default_rng(seed)
+    chunks = []
+    for k in range(count):
+        ids = rng.permutation(n).astype(np.uint32)
+        mass = rng.uniform(0.5, 2.0, n).astype(np.float32)
+        pos = rng.normal(0.0, 10.0, (n, 3)).astype(np.float32)
+        vel = rng.normal(0.0, 1.0, (n, 3)).astype(np.float32)
+        chunks.append((10 * k, 0.5 * k, ids, mass, pos, vel))
+    return chunks
+
+
+def test_float_chunks_round_trip_as_views(tmp_path):
+    chunks = _random_chunks(3, 257)
+    path = tmp_path / "run.asnp"
+    _write_snapshots(path, chunks, ENCODING_FLOAT32)
+
+    snaps = SnapshotFile(path)
+    assert snaps.name == "test"
+    assert len(snaps) == 3
+    assert list(snaps.steps) == [0, 10, 20]
+    for k, (_, _, ids, mass, pos, vel) in enumerate(chunks):
+        chunk = snaps[k]
+        assert np.shares_memory(chunk["pos"], snaps.raw(k)["pos"])
+        np.testing.assert_array_equal(chunk["id"], ids)
+        np.testing.assert_array_equal(chunk["mass"], mass)
+        np.testing.assert_array_equal(chunk["pos"], pos)
+        np.testing.assert_array_equal(chunk["vel"], vel)
+
+
+def test_quantized_error_stays_under_half_a_step(tmp_path):
+    chunks = _random_chunks(2, 1000)
+    path = tmp_path / "run.asnp"
+    _write_snapshots(path, chunks, ENCODING_QUANTIZED16)
+
+    snaps = SnapshotFile(path)
+    assert snaps.quantized
+    for k, (_, _, _, _, pos, vel) in enumerate(chunks):
+        raw = snaps.raw(k)
+        assert raw["pos"].dtype == np.uint16
+        chunk = snaps[k]
+        assert np.all(np.abs(chunk["pos"] - pos) <= 0.5 * raw["pos_scale"] + 1e-5)
+        assert np.all(np.abs(chunk["vel"] - vel) <= 0.5 * raw["vel_scale"] + 1e-5)
+
+
+def test_unclosed_file_is_indexed_from_chunk_headers(tmp_path):
+    chunks = _random_chunks(4, 33)
+    path = tmp_path / "run.asnp"
+    _write_snapshots(path, chunks, ENCODING_FLOAT32, close=False)
+
+    snaps = SnapshotFile(path)
+    assert len(snaps) == 4
+    assert list(snaps.counts) == [33] * 4
+    np.testing.assert_array_equal(snaps[3]["vel"], chunks[3][5])
+
+
+def test_by_id_orders_particles(tmp_path):
+    chunks = _random_chunks(1, 64)
+    path = tmp_path / "run.asnp"
+    _write_snapshots(path, chunks, ENCODING_FLOAT32)
+
+    chunk = SnapshotFile(path).by_id(0)
+    np.testing.assert_array_equal(chunk["id"], np.arange(64))
+    ids, pos = chunks[0][2], chunks[0][4]
+    np.testing.assert_array_equal(chunk["pos"], pos[np.argsort(ids)])
+
+
+def test_rejects_other_files(tmp_path):
+    path = tmp_path / "other.bin"
+    path.write_bytes(b"ARPL" + bytes(80))
+    with pytest.raises(ValueError):
+        SnapshotFile(path)
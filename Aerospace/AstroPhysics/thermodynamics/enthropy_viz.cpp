@@ -1,10 +1,18 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/hard_sphere_md.h"
+#include "../common/headless_bench.h"
+#include "../common/instanced_particles.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <iomanip>
-#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -12,7 +20,81 @@
 namespace {
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
-struct Dot { Vector3 p; Vector3 v; };
+constexpr float kDotRadius = 0.045f;
+constexpr double kPackingFraction = 0.12;  // volume fraction used once kDotRadius no longer fits
+constexpr double kPartitionHalfWidth = 0.025;
+constexpr astro_md::Vec3d kBoxLo = {-2.3, -0.4, -1.7};
+constexpr astro_md::Vec3d kBoxHi = {2.3, 1.6, 1.7};
+constexpr std::array<int, 4> kDotCounts = {220, 2000, 20000, 100000};
+constexpr double kFrameBudgetMs = 8.0;  // event processing per frame before slowing the clock
+constexpr uint64_t kGasSeed = 123;
+
+double DotRadius(int count) {
+    const double volume = (kBoxHi[0] - kBoxLo[0]) * (kBoxHi[1] - kBoxLo[1]) * (kBoxHi[2] - kBoxLo[2]);
+    return std::min<double>(kDotRadius, std::cbrt(kPackingFraction * volume / (count * 4.0 / 3.0 * PI)));
+}
+
+// Two species at unit temperature, one on each side of the partition.
+void ResetGas(astro_md::HardSphereGas* gas, int count) {
+    astro_md::HardSphereConfig config;
+    config.lo = kBoxLo;
+    config.hi = kBoxHi;
+    config.radius = DotRadius(count);
+    config.partition = true;
+    config.partitionHalfWidth = kPartitionHalfWidth;
+
+    astro_random::PhiloxStream rng(kGasSeed);
+    const double r = config.radius;
+    const double gap = kPartitionHalfWidth + r;
+    const std::vector<astro_md::Vec3d> left = astro_md::LatticeStart({kBoxLo[0] + r, kBoxLo[1] + r, kBoxLo[2] + r}, {-gap, kBoxHi[1] - r, kBoxHi[2] - r},
+                                                                      static_cast<size_t>(count / 2), r, rng);
+    const std::vector<astro_md::Vec3d> right = astro_md::LatticeStart({gap, kBoxLo[1] + r, kBoxLo[2] + r}, {kBoxHi[0] - r, kBoxHi[1] - r, kBoxHi[2] - r},
+                                                                       static_cast<size_t>(count - count / 2), r, rng);
+    std::vector<astro_md::HardSphere> spheres;
+    spheres.reserve(left.size() + right.size());
+    for (const astro_md::Vec3d& p : left) spheres.push_back({p, {rng.Normal(), rng.Normal(), rng.Normal()}, 0});
+    for (const astro_md::Vec3d& p : right) spheres.push_back({p, {rng.Normal(), rng.Normal(), rng.Normal()}, 1});
+    gas->Reset(config, spheres);
+}
+
+// Species-0 spheres in the left half, from the coarse occupancy grid.
+int LeftCount(const astro_md::HardSphereGas& gas) {
+    const std::array<int, 3>& cells = gas.EntropyCells();
+    int left = 0;
+    for (int z = 0; z < cells[2]; ++z) {
+        for (int y = 0; y < cells[1]; ++y) {
+            for (int x = 0; x < cells[0] / 2; ++x) left += gas.Occupancy(0, x, y, z);
+        }
+    }
+    return left;
+}
+
+// Speed histogram against the Maxwell-Boltzmann density at the gas temperature.
+void DrawSpeedHistogram(const astro_md::HardSphereGas& gas, int x, int y, int w, int h) {
+    const std::vector<uint32_t>& bins = gas.SpeedHistogram();
+    const double width = gas.HistogramBinWidth();
+    const double kT = std::max(1e-6, gas.Temperature());
+    const double n = static_cast<double>(gas.size());
+    const auto maxwell = [&](double v) { return n * width * 4.0 * PI * v * v * std::pow(2.0 * PI * kT, -1.5) * std::exp(-v * v / (2.0 * kT)); };
+    double peak = maxwell(std::sqrt(2.0 * kT));
+    for (uint32_t b : bins) peak = std::max(peak, static_cast<double>(b));
+
+    DrawRectangle(x, y, w, h, Color{12, 18, 30, 210});
+    DrawRectangleLines(x, y, w, h, Color{90, 120, 170, 200});
+    const float barW = static_cast<float>(w) / static_cast<float>(bins.size());
+    for (size_t i = 0; i < bins.size(); ++i) {
+        const float bh = static_cast<float>((h - 24) * bins[i] / peak);
+        DrawRectangleRec({x + barW * i + 1.0f, y + h - bh, barW - 2.0f, bh}, Color{120, 200, 255, 200});
+    }
+    Vector2 prev = {static_cast<float>(x), static_cast<float>(y + h)};
+    for (size_t i = 0; i < bins.size(); ++i) {
+        const double v = (i + 0.5) * width;
+        const Vector2 cur = {x + barW * (i + 0.5f), static_cast<float>(y + h - (h - 24) * maxwell(v) / peak)};
+        DrawLineEx(prev, cur, 2.0f, Color{255, 190, 120, 230});
+        prev = cur;
+    }
+    DrawText("speed histogram vs Maxwell-Boltzmann", x + 8, y + 6, 16, Color{200, 214, 236, 255});
+}
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -28,7 +110,16 @@ void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* dis
 }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    const astro_bench::BenchOptions bench = astro_bench::ParseBenchArgs(argc, argv, 60, 1.0f / 60.0f);
+    if (bench.enabled) {
+        astro_md::HardSphereGas gas;
+        ResetGas(&gas, std::max(2, astro_bench::IntArg(argc, argv, "--particles", 100000)));
+        gas.SetPartition(false);
+        return astro_bench::RunBench(
+            "enthropy_viz", bench, [&](float dt) { gas.Advance(dt); }, [&]() { return static_cast<float>(gas.Entropy()); });
+    }
+
     InitWindow(kScreenWidth, kScreenHeight, "Entropy Mixing 3D - C++ (raylib)");
     SetTargetFPS(60);
 
@@ -40,72 +131,79 @@ int main() {
     camera.projection = CAMERA_PERSPECTIVE;
     float camYaw=0.84f, camPitch=0.34f, camDistance=13.0f;
 
-    std::mt19937 rng(123);
-    std::uniform_real_distribution<float> u(-1.0f,1.0f);
-
-    std::vector<Dot> dots;
-    auto reset = [&]() {
-        dots.clear();
-        for (int i=0;i<220;++i) {
-            float side = (i < 110) ? -1.0f : 1.0f;
-            Vector3 p = {side*1.2f + 0.6f*u(rng), 0.6f + 0.9f*u(rng), 1.2f*u(rng)};
-            Vector3 v = {1.2f*u(rng), 1.2f*u(rng), 1.2f*u(rng)};
-            dots.push_back({p,v});
-        }
-    };
+    astro_render::InstancedParticleRenderer dotRenderer;
+    dotRenderer.Init(astro_render::InstanceShape::kSphere);
 
-    bool wall = true;
+    size_t countIndex = 0;
+    astro_md::HardSphereGas gas;
+    ResetGas(&gas, kDotCounts[countIndex]);
     bool paused = false;
-    reset();
+    double timeScale = 1.0;  // simulated time per real second, lowered when events exceed the budget
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused=!paused;
-        if (IsKeyPressed(KEY_W)) wall = !wall;
-        if (IsKeyPressed(KEY_R)) { reset(); wall=true; paused=false; }
+        if (IsKeyPressed(KEY_W)) gas.SetPartition(!gas.config().partition);
+        if (IsKeyPressed(KEY_N)) {
+            countIndex = (countIndex + 1) % kDotCounts.size();
+            ResetGas(&gas, kDotCounts[countIndex]);
+            timeScale = 1.0;
+        }
+        if (IsKeyPressed(KEY_R)) { ResetGas(&gas, kDotCounts[countIndex]); paused=false; timeScale = 1.0; }
 
         UpdateOrbitCameraDragOnly(&camera,&camYaw,&camPitch,&camDistance);
 
         if (!paused) {
-            float dt = GetFrameTime();
-            for (auto& d : dots) {
-                d.p = Vector3Add(d.p, Vector3Scale(d.v, dt));
-                if (d.p.x < -2.2f || d.p.x > 2.2f) d.v.x *= -1.0f;
-                if (d.p.y < -0.3f || d.p.y > 1.5f) d.v.y *= -1.0f;
-                if (d.p.z < -1.6f || d.p.z > 1.6f) d.v.z *= -1.0f;
-                if (wall && std::fabs(d.p.x) < 0.03f) d.v.x *= -1.0f;
-            }
+            const auto t0 = std::chrono::steady_clock::now();
+            gas.Advance(GetFrameTime() * timeScale);
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            if (ms > kFrameBudgetMs) timeScale = std::max(0.01, timeScale * 0.8);
+            if (ms < 0.5 * kFrameBudgetMs) timeScale = std::min(1.0, timeScale * 1.05);
         }
 
-        int leftCount=0;
-        for (auto& d : dots) if (d.p.x < 0.0f) leftCount++;
-        float mix = 1.0f - std::fabs(leftCount - 110.0f)/110.0f;
+        const int half = static_cast<int>(gas.size() / 2);
+        const int leftCount = LeftCount(gas);
+        const float mix = 1.0f - std::fabs(leftCount - 0.5f * half) / (0.5f * std::max(1, half));
 
         BeginDrawing();
         ClearBackground(Color{6,9,16,255});
         BeginMode3D(camera);
         DrawCubeWires({0,0.6f,0}, 4.6f, 2.0f, 3.4f, Color{130,180,255,180});
-        if (wall) DrawCube({0,0.6f,0}, 0.05f, 1.9f, 3.2f, Color{170,170,190,130});
-
-        for (int i=0;i<(int)dots.size();++i) {
-            Color c = (i<110) ? Color{255,140,120,230} : Color{120,200,255,230};
-            DrawSphere(dots[i].p, 0.045f, c);
+        if (gas.config().partition) DrawCube({0,0.6f,0}, 0.05f, 1.9f, 3.2f, Color{170,170,190,130});
+
+        const float radius = static_cast<float>(gas.config().radius);
+        dotRenderer.Clear();
+        dotRenderer.Reserve(gas.size());
+        for (size_t i = 0; i < gas.size(); ++i) {
+            const Color c = gas.species(i) == 0 ? Color{255,140,120,230} : Color{120,200,255,230};
+            dotRenderer.Add(gas.Position(i), radius, c);
         }
+        dotRenderer.Draw();
 
         EndMode3D();
 
-        DrawText("Entropy and Mixing (Box Gas Model)", 20, 18, 29, Color{232,238,248,255});
-        DrawText("Hold left mouse: orbit | wheel: zoom | W toggle partition | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
+        DrawText("Entropy and Mixing (Hard-Sphere Gas)", 20, 18, 29, Color{232,238,248,255});
+        DrawText("Hold left mouse: orbit | wheel: zoom | W toggle partition | N molecule count | P pause | R reset", 20, 54, 18, Color{164,183,210,255});
 
         std::ostringstream os;
-        os << std::fixed << std::setprecision(2) << "left count=" << leftCount << "  mixing index=" << mix;
-        if (wall) os << "  [partition ON]";
+        os << std::fixed << std::setprecision(2) << "N=" << gas.size() << "  left count=" << leftCount << "/" << half << "  mixing index=" << mix
+           << "  S=" << gas.Entropy() << " / " << gas.MaxEntropy() << "  T=" << gas.Temperature();
+        if (gas.config().partition) os << "  [partition ON]";
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{126,224,255,255});
-        DrawFPS(20,110);
-
+        std::ostringstream info;
+        info << std::fixed << std::setprecision(2) << "t=" << gas.time() << "  collisions=" << gas.collisions() << "  events=" << gas.events();
+        if (timeScale < 1.0) info << "  [slow motion x" << timeScale << "]";
+        DrawText(info.str().c_str(), 20, 108, 18, Color{164,183,210,255});
+        DrawFPS(20,134);
+        DrawSpeedHistogram(gas, kScreenWidth - 380, kScreenHeight - 220, 360, 200);
+
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    dotRenderer.Unload();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -1,10 +1,14 @@
 #include "raylib.h"
 #include "raymath.h"
 
+#include "../common/frame_capture.h"
+#include "../common/hard_sphere_md.h"
+#include "../common/philox.h"
+#include "../common/profiler.h"
+
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
-#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -13,11 +17,28 @@ namespace {
 
 constexpr int kScreenWidth = 1280;
 constexpr int kScreenHeight = 820;
-
-struct GasParticle {
-    Vector3 pos;
-    Vector3 vel;
-};
+constexpr int kMolecules = 240;
+constexpr float kMoleculeRadius = 0.05f;
+constexpr double kPressureWindow = 1.0;  // simulated seconds of wall impulse per pressure reading
+
+// Hard-sphere gas at temperature kT (unit mass, k_B = 1) filling the box around y = 0.8.
+void ResetGas(astro_md::HardSphereGas* gas, float halfX, float halfY, float halfZ, float temperature) {
+    astro_md::HardSphereConfig config;
+    config.lo = {-halfX, 0.8 - halfY, -halfZ};
+    config.hi = {halfX, 0.8 + halfY, halfZ};
+    config.radius = kMoleculeRadius;
+    config.entropyCells = {1, 1, 1};
+
+    astro_random::PhiloxStream rng(42);
+    const double r = config.radius;
+    const std::vector<astro_md::Vec3d> sites = astro_md::LatticeStart({config.lo[0] + r, config.lo[1] + r, config.lo[2] + r},
+                                                                       {config.hi[0] - r, config.hi[1] - r, config.hi[2] - r}, kMolecules, r, rng);
+    const float sigma = std::sqrt(temperature);
+    std::vector<astro_md::HardSphere> spheres;
+    spheres.reserve(sites.size());
+    for (const astro_md::Vec3d& p : sites) spheres.push_back({p, {sigma * rng.Normal(), sigma * rng.Normal(), sigma * rng.Normal()}, 0});
+    gas->Reset(config, spheres);
+}
 
 void UpdateOrbitCameraDragOnly(Camera3D* c, float* yaw, float* pitch, float* distance) {
     if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -47,63 +68,56 @@ int main() {
 
     float camYaw = 0.85f, camPitch = 0.34f, camDistance = 13.0f;
 
-    std::mt19937 rng(42);
-    std::uniform_real_distribution<float> ur(-1.0f, 1.0f);
-
     float halfX = 2.4f;
     float halfY = 1.6f;
     float halfZ = 1.8f;
     float temperature = 1.0f;
 
-    std::vector<GasParticle> gas;
-    gas.reserve(240);
-
-    auto reset = [&]() {
-        gas.clear();
-        for (int i = 0; i < 240; ++i) {
-            Vector3 p = {ur(rng) * halfX * 0.95f, ur(rng) * halfY * 0.95f + 0.8f, ur(rng) * halfZ * 0.95f};
-            Vector3 v = {ur(rng), ur(rng), ur(rng)};
-            v = Vector3Scale(Vector3Normalize(v), 1.2f * std::sqrt(temperature));
-            gas.push_back({p, v});
-        }
-    };
-
-    reset();
+    // Molecules collide with each other as hard spheres (common/hard_sphere_md.h), so the
+    // speeds relax to a Maxwell distribution and the pressure is measured from wall impulses.
+    astro_md::HardSphereGas gas;
+    ResetGas(&gas, halfX, halfY, halfZ, temperature);
+    double windowStart = 0.0, windowImpulse = 0.0;
+    float pMeasured = 0.0f;
     bool paused = false;
 
     while (!WindowShouldClose()) {
         if (IsKeyPressed(KEY_P)) paused = !paused;
-        if (IsKeyPressed(KEY_R)) { temperature = 1.0f; reset(); paused = false; }
+        if (IsKeyPressed(KEY_R)) {
+            temperature = 1.0f;
+            ResetGas(&gas, halfX, halfY, halfZ, temperature);
+            windowStart = windowImpulse = 0.0;
+            pMeasured = 0.0f;
+            paused = false;
+        }
+        const float previousTemperature = temperature;
         if (IsKeyPressed(KEY_LEFT_BRACKET)) temperature = std::max(0.2f, temperature - 0.1f);
         if (IsKeyPressed(KEY_RIGHT_BRACKET)) temperature = std::min(4.0f, temperature + 0.1f);
-
-        for (GasParticle& g : gas) {
-            float current = Vector3Length(g.vel);
-            if (current > 1e-4f) {
-                g.vel = Vector3Scale(g.vel, (1.2f * std::sqrt(temperature)) / current);
-            }
+        if (temperature != previousTemperature) {
+            // Heating or cooling rescales every velocity; the pressure window restarts.
+            gas.ScaleSpeeds(std::sqrt(temperature / std::max(1e-6, gas.Temperature())));
+            windowStart = gas.time();
+            windowImpulse = gas.WallImpulse();
         }
 
         UpdateOrbitCameraDragOnly(&camera, &camYaw, &camPitch, &camDistance);
 
-        float momentumWall = 0.0f;
         if (!paused) {
-            float dt = GetFrameTime();
-            for (GasParticle& gp : gas) {
-                gp.pos = Vector3Add(gp.pos, Vector3Scale(gp.vel, dt));
-
-                if (gp.pos.x < -halfX) { gp.pos.x = -halfX; momentumWall += 2.0f * std::fabs(gp.vel.x); gp.vel.x *= -1.0f; }
-                if (gp.pos.x > halfX)  { gp.pos.x = halfX;  momentumWall += 2.0f * std::fabs(gp.vel.x); gp.vel.x *= -1.0f; }
-                if (gp.pos.y < 0.8f - halfY) { gp.pos.y = 0.8f - halfY; momentumWall += 2.0f * std::fabs(gp.vel.y); gp.vel.y *= -1.0f; }
-                if (gp.pos.y > 0.8f + halfY) { gp.pos.y = 0.8f + halfY; momentumWall += 2.0f * std::fabs(gp.vel.y); gp.vel.y *= -1.0f; }
-                if (gp.pos.z < -halfZ) { gp.pos.z = -halfZ; momentumWall += 2.0f * std::fabs(gp.vel.z); gp.vel.z *= -1.0f; }
-                if (gp.pos.z > halfZ)  { gp.pos.z = halfZ;  momentumWall += 2.0f * std::fabs(gp.vel.z); gp.vel.z *= -1.0f; }
+            gas.Advance(GetFrameTime());
+            if (gas.time() - windowStart >= kPressureWindow) {
+                pMeasured = static_cast<float>((gas.WallImpulse() - windowImpulse) / (gas.WallArea() * (gas.time() - windowStart)));
+                windowStart = gas.time();
+                windowImpulse = gas.WallImpulse();
             }
         }
 
-        float volume = (2.0f * halfX) * (2.0f * halfY) * (2.0f * halfZ);
+        float volume = static_cast<float>(gas.Volume());
         float n = static_cast<float>(gas.size());
-        float pIdeal = n * temperature / std::max(0.1f, volume);
+        float kT = static_cast<float>(gas.Temperature());
+        float pIdeal = n * kT / std::max(0.1f, volume);
+        // Carnahan-Starling compressibility of the hard-sphere fluid at this packing fraction.
+        const double eta = n * 4.0 / 3.0 * PI * std::pow(kMoleculeRadius, 3.0) / volume;
+        const double zHardSphere = (1.0 + eta + eta * eta - eta * eta * eta) / std::pow(1.0 - eta, 3.0);
 
         BeginDrawing();
         ClearBackground(Color{7, 10, 16, 255});
@@ -112,11 +126,12 @@ int main() {
 
         DrawCubeWires({0.0f, 0.8f, 0.0f}, 2.0f * halfX, 2.0f * halfY, 2.0f * halfZ, Color{130, 180, 255, 180});
 
-        for (const GasParticle& gp : gas) {
-            float sp = Vector3Length(gp.vel);
+        for (size_t i = 0; i < gas.size(); ++i) {
+            const astro_md::Vec3d& v = gas.velocity(i);
+            float sp = static_cast<float>(std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]));
             float heat = std::clamp(sp / 3.0f, 0.0f, 1.0f);
             Color c = Color{static_cast<unsigned char>(100 + 155 * heat), static_cast<unsigned char>(120 + 80 * (1.0f - heat)), 255, 230};
-            DrawSphere(gp.pos, 0.05f, c);
+            DrawSphere(gas.Position(i), kMoleculeRadius, c);
         }
 
         EndMode3D();
@@ -127,17 +142,21 @@ int main() {
         std::ostringstream os;
         os << std::fixed << std::setprecision(3)
            << "N=" << gas.size()
-           << "  T=" << temperature
+           << "  T=" << kT
            << "  V=" << volume
-           << "  P~" << pIdeal
-           << "  PV/(NT)~" << (pIdeal * volume / std::max(0.001f, n * temperature));
+           << "  P=" << pMeasured << " (ideal " << pIdeal << ")"
+           << "  PV/(NT)=" << (pMeasured * volume / std::max(0.001f, n * kT))
+           << " (hard spheres " << zHardSphere << ")";
         if (paused) os << "  [PAUSED]";
         DrawText(os.str().c_str(), 20, 82, 20, Color{200, 220, 255, 255});
         DrawFPS(20, 110);
 
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -3,18 +3,25 @@
 Two-hand webcam bridge for the C++ hand biomechanics visualizer.
 
 Transport:
-- UDP localhost:50515
+- UDP port 50515 on the loopback multicast group 239.255.50.15, so several C++
+  scenes can share one bridge; ASTRO_HAND_UNICAST=1 sends to localhost instead
 - CSV packet
 - timestamp,left_valid,left_pinched,left_score,(x,y,z)*21,right_valid,right_pinched,right_score,(x,y,z)*21
+- or, with ASTRO_HAND_BINARY=1, the versioned binary packet decoded by
+  hand_tracking_scene_shared.h (header 'AHTP', sequence number, CRC-32 payload)
+- webcam preview JPEGs on UDP port 50516, same destination (see udp_preview.py); set
+  ASTRO_PREVIEW_SIZE=1280x720 for a full-resolution preview
 """
 
 from __future__ import annotations
 
 import os
 import socket
+import struct
 import sys
 import tempfile
 import time
+import zlib
 from dataclasses import dataclass
 from pathlib import Path
 from typing import Dict, List, Sequence, Tuple
@@ -28,10 +35,17 @@ import cv2
 import mediapipe as mp
 import numpy as np
 
+from udp_preview import HAND_MULTICAST_GROUP, PreviewSender, enable_loopback_multicast, preview_size
 
-UDP_HOST = "127.0.0.1"
+
+MULTICAST = os.environ.get("ASTRO_HAND_UNICAST", "0") != "1"
+UDP_HOST = HAND_MULTICAST_GROUP if MULTICAST else "127.0.0.1"
 UDP_PORT = 50515
 FRAME_UDP_PORT = 50516
+BINARY_PACKETS = os.environ.get("ASTRO_HAND_BINARY", "0") == "1"
+BINARY_MAGIC = 0x50544841  # "AHTP"
+BINARY_VERSION = 1
+BINARY_HAND = struct.Struct("<64f")
 WINDOW_NAME = "Hand Biomechanics Bridge"
 MODULE_DIR = Path(__file__).resolve().parent
 MODEL_CANDIDATES: Tuple[Path, ...] = (
@@ -49,8 +63,7 @@ PINCH_CLOSE_RATIO = 0.40
 PINCH_RELEASE_RATIO = 0.52
 HAND_STALE_S = 0.45
 PREVIEW_SEND_HZ = 30.0
-PREVIEW_W = 320
-PREVIEW_H = 180
+PREVIEW_W, PREVIEW_H = preview_size(320, 180)
 PREVIEW_JPEG_QUALITY = 55
 
 WRIST = 0
@@ -346,31 +359,38 @@ def _append_hand_packet(parts: List[str], hand: TrackedHand | None) -> None:
         parts.extend((f"{x:.6f}", f"{y:.6f}", f"{z:.6f}"))
 
 
+_packet_sequence = 0
+
+
+def _binary_hand(hand: TrackedHand | None) -> bytes:
+    if hand is None:
+        return BINARY_HAND.pack(*([0.0] * 64))
+    return BINARY_HAND.pack(float(hand.score), *np.asarray(hand.pose, dtype=np.float32).reshape(-1).tolist())
+
+
+def _encode_binary_packet(left: TrackedHand | None, right: TrackedHand | None, now: float) -> bytes:
+    global _packet_sequence
+    flags = 0
+    if left is not None:
+        flags |= 0x1 | (0x2 if left.pinched else 0)
+    if right is not None:
+        flags |= 0x4 | (0x8 if right.pinched else 0)
+    payload = struct.pack("<d", now) + _binary_hand(left) + _binary_hand(right)
+    header = struct.pack("<IHHII", BINARY_MAGIC, BINARY_VERSION, flags, _packet_sequence, zlib.crc32(payload))
+    _packet_sequence = (_packet_sequence + 1) & 0xFFFFFFFF
+    return header + payload
+
+
 def _send_packet(sock: socket.socket, left: TrackedHand | None, right: TrackedHand | None, now: float) -> None:
+    if BINARY_PACKETS:
+        sock.sendto(_encode_binary_packet(left, right, now), (UDP_HOST, UDP_PORT))
+        return
     parts = [f"{now:.3f}"]
     _append_hand_packet(parts, left)
     _append_hand_packet(parts, right)
     sock.sendto((",".join(parts) + "\n").encode("ascii"), (UDP_HOST, UDP_PORT))
 
 
-def _send_preview_frame(sock: socket.socket, frame: np.ndarray) -> None:
-    preview = cv2.resize(frame, (PREVIEW_W, PREVIEW_H), interpolation=cv2.INTER_AREA)
-    ok, encoded = cv2.imencode(
-        ".jpg",
-        preview,
-        [int(cv2.IMWRITE_JPEG_QUALITY), PREVIEW_JPEG_QUALITY],
-    )
-    if not ok:
-        return
-    data = encoded.tobytes()
-    if len(data) >= 65000:
-        return
-    try:
-        sock.sendto(data, (UDP_HOST, FRAME_UDP_PORT))
-    except OSError:
-        return
-
-
 def _draw_hud(
     frame: np.ndarray,
     fps: float,
@@ -472,6 +492,8 @@ def main() -> int:
 
     sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
     sock.setblocking(False)
+    if MULTICAST:
+        enable_loopback_multicast(sock)
 
     mirror = True
     tracked: Dict[str, TrackedHand] = {}
@@ -481,6 +503,7 @@ def main() -> int:
     last_t = time.perf_counter()
     fps = 60.0
     last_preview_send_ts = 0.0
+    preview_sender = PreviewSender(UDP_HOST, FRAME_UDP_PORT, (PREVIEW_W, PREVIEW_H), PREVIEW_JPEG_QUALITY)
 
     cv2.namedWindow(WINDOW_NAME, cv2.WINDOW_NORMAL)
     cv2.resizeWindow(WINDOW_NAME, 1120, 680)
@@ -554,7 +577,7 @@ def main() -> int:
             _send_packet(sock, left_hand, right_hand, now)
             _draw_hud(frame, fps, mirror, left_hand, right_hand, len(extracted))
             if (now - last_preview_send_ts) >= (1.0 / PREVIEW_SEND_HZ):
-                _send_preview_frame(sock, frame)
+                preview_sender.send(sock, frame)
                 last_preview_send_ts = now
             cv2.imshow(WINDOW_NAME, frame)
 
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "hand_tracking_scene_shared.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <tuple>
+
+// Gesture recognition on the bridge's network thread.
+//
+//   astro_hand::GestureEngine<astro_hand::PinchGesture<>, astro_hand::FistGesture<>> gestures;
+//   bridge.SetPacketListener([&](const astro_hand::TrackingSample& s) { gestures.Process(s); });
+//   bridge.Start();
+//   ...
+//   astro_hand::GestureEvent event;
+//   while (gestures.Poll(&event)) { ... }
+//
+// Process() runs for every packet the moment it is decoded. It builds each tracked
+// hand's geometry once and passes it through the recognizers the scene listed, a fold
+// over the template pack, so an unused recognizer costs nothing and nothing allocates.
+// What they detect goes into a lock-free queue, stamped with the packet's local arrival
+// time; the scene drains it wherever it likes (frame loop, simulation thread), and
+// because each event carries when it really happened, tap windows and hold times do not
+// depend on the frame rate. Gestures that last (a pinch, a fist) are also readable as
+// held flags at any time.
+//
+// A recognizer is a type with a `State` per hand and
+//   static void Update(const GestureInput& in, State& state, GestureSink& sink);
+// thresholds come from a Config type parameter, so a scene tunes them at compile time.
+
+namespace astro_hand {
+
+enum class GestureType : uint8_t {
+    kPinchDown,
+    kPinchUp,
+    kPinchTaps,  // a run of quick pinches has ended; `count` says how many
+    kFistDown,
+    kFistUp,
+};
+
+enum GestureHold : uint32_t {
+    kHoldPinch = 1u << 0,
+    kHoldFist = 1u << 1,
+};
+
+struct GestureEvent {
+    GestureType type = GestureType::kPinchDown;
+    bool rightHand = false;
+    int count = 0;
+    double time = 0.0;        // local steady-clock seconds (SteadySeconds()) the packet arrived
+    double senderTime = 0.0;  // the packet's own timestamp
+};
+
+struct GestureInput {
+    const TrackedHandPacket& packet;
+    const HandGeometry& geometry;  // BuildTrackedGeometry(packet); meaningful only when tracked
+    bool tracked;
+    bool rightHand;
+    double time;  // sender seconds, for intervals between packets
+};
+
+class GestureSink {
+  public:
+    GestureSink(SpscRing<GestureEvent, 64>& queue, std::atomic<uint32_t>& held, std::atomic<uint32_t>& dropped,
+                const GestureEvent& stamp)
+        : queue_(queue), held_(held), dropped_(dropped), stamp_(stamp) {}
+
+    void Emit(GestureType type, int count = 0) {
+        GestureEvent event = stamp_;
+        event.type = type;
+        event.count = count;
+        if (!queue_.Push(event)) dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Hold(uint32_t bit, bool on) {
+        if (on) {
+            held_.fetch_or(bit, std::memory_order_relaxed);
+        } else {
+            held_.fetch_and(~bit, std::memory_order_relaxed);
+        }
+    }
+
+  private:
+    SpscRing<GestureEvent, 64>& queue_;
+    std::atomic<uint32_t>& held_;
+    std::atomic<uint32_t>& dropped_;
+    const GestureEvent& stamp_;
+};
+
+// Same windows as the live_controls pinch counters in circuit_em_energy_flow_viz and
+// blackhole_viz: a pinch released within kTapSeconds is a tap, and taps closer together
+// than kSequenceSeconds are reported as one kPinchTaps event once the window closes.
+struct PinchConfig {
+    static constexpr double kTapSeconds = 0.30;
+    static constexpr double kSequenceSeconds = 0.45;
+};
+
+// Edges of the tracker's own pinch decision (TrackedHandPacket::pinched, with the
+// bridge's hysteresis), so events agree with HandControlState::pinched.
+template <typename Config = PinchConfig>
+struct PinchGesture {
+    struct State {
+        bool down = false;
+        double downAt = 0.0;
+        int taps = 0;
+        double deadline = 0.0;
+    };
+
+    static void Update(const GestureInput& in, State& state, GestureSink& sink) {
+        const bool down = in.tracked && in.packet.pinched;
+        if (down != state.down) {
+            state.down = down;
+            sink.Hold(kHoldPinch, down);
+            sink.Emit(down ? GestureType::kPinchDown : GestureType::kPinchUp);
+            if (down) {
+                state.downAt = in.time;
+            } else if (in.time - state.downAt <= Config::kTapSeconds) {
+                ++state.taps;
+                state.deadline = in.time + Config::kSequenceSeconds;
+            }
+        }
+        // The bridges send every camera frame, hands or not, so the window closes on time.
+        if (state.taps > 0 && !state.down && in.time >= state.deadline) {
+            sink.Emit(GestureType::kPinchTaps, state.taps);
+            state.taps = 0;
+        }
+    }
+};
+
+// Every fingertip within this many palm lengths (wrist to middle knuckle) of the palm
+// centre.
+struct FistConfig {
+    static constexpr float kThumb = 1.44f;
+    static constexpr float kIndex = 1.18f;
+    static constexpr float kMiddle = 1.14f;
+    static constexpr float kRing = 1.10f;
+    static constexpr float kPinky = 1.08f;
+};
+
+template <typename Config = FistConfig>
+struct FistGesture {
+    struct State {
+        bool closed = false;
+    };
+
+    static bool Closed(const HandGeometry& g) {
+        const float palm = std::max(0.18f, Vector3Distance(g.landmarks[0], g.landmarks[9]));
+        const auto reach = [&](int tip) { return Vector3Distance(g.landmarks[static_cast<size_t>(tip)], g.palmCenter) / palm; };
+        return reach(4) < Config::kThumb && reach(8) < Config::kIndex && reach(12) < Config::kMiddle &&
+               reach(16) < Config::kRing && reach(20) < Config::kPinky;
+    }
+
+    static void Update(const GestureInput& in, State& state, GestureSink& sink) {
+        const bool closed = in.tracked && Closed(in.geometry);
+        if (closed == state.closed) return;
+        state.closed = closed;
+        sink.Hold(kHoldFist, closed);
+        sink.Emit(closed ? GestureType::kFistDown : GestureType::kFistUp);
+    }
+};
+
+template <typename... Recognizers>
+class GestureEngine {
+  public:
+    // Network thread: one call per packet, in arrival order.
+    void Process(const TrackingSample& sample) {
+        const TrackingPacket& packet = sample.packet;
+        const double time = packet.timestamp > 0.0 ? packet.timestamp : sample.receivedAt;
+        Run(packet.left, false, time, sample.receivedAt, packet.timestamp);
+        Run(packet.right, true, time, sample.receivedAt, packet.timestamp);
+    }
+
+    // Consumer side (one thread): the next event, oldest first.
+    bool Poll(GestureEvent* out) { return queue_.Pop(out); }
+
+    bool Held(bool rightHand, GestureHold hold) const {
+        return (held_[rightHand ? 1 : 0].load(std::memory_order_relaxed) & hold) != 0;
+    }
+
+    // Events lost because the consumer fell 64 behind.
+    uint32_t droppedEvents() const { return dropped_.load(std::memory_order_relaxed); }
+
+  private:
+    void Run(const TrackedHandPacket& hand, bool rightHand, double time, double arrival, double senderTime) {
+        const size_t side = rightHand ? 1 : 0;
+        HandGeometry& geometry = geometry_[side];
+        if (hand.valid) geometry = BuildTrackedGeometry(hand, rightHand);
+        GestureEvent stamp;
+        stamp.rightHand = rightHand;
+        stamp.time = arrival;
+        stamp.senderTime = senderTime;
+        GestureSink sink(queue_, held_[side], dropped_, stamp);
+        const GestureInput input{hand, geometry, hand.valid, rightHand, time};
+        std::apply([&](auto&... state) { (Recognizers::Update(input, state, sink), ...); }, states_[side]);
+    }
+
+    std::array<std::tuple<typename Recognizers::State...>, 2> states_{};
+    std::array<HandGeometry, 2> geometry_{};
+    SpscRing<GestureEvent, 64> queue_;
+    std::array<std::atomic<uint32_t>, 2> held_{};
+    std::atomic<uint32_t> dropped_{0};
+};
+
+}  // namespace astro_hand
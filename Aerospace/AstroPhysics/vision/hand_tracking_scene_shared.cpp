@@ -0,0 +1,1438 @@
+#include "hand_tracking_scene_shared.h"
+#include "udp_socket.h"
+#include "../common/lod.h"
+#include "../common/parametric_mesh.h"
+#include "../common/starfield.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace astro_hand {
+
+uint32_t Crc32(const unsigned char* data, size_t size) {
+    struct Table {
+        std::array<uint32_t, 256> entries{};
+        Table() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[i] = c;
+            }
+        }
+    };
+    static const Table table;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) crc = table.entries[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool DecodeBinaryTrackingPacket(const unsigned char* data, size_t size, TrackingPacket& outPacket) {
+    if (size != kTrackingPacketBytes) return false;
+    if (LoadLE32(data) != kTrackingMagic || LoadLE16(data + 4) != kTrackingVersion) return false;
+    const unsigned char* payload = data + kTrackingHeaderBytes;
+    if (Crc32(payload, kTrackingPayloadBytes) != LoadLE32(data + 12)) return false;
+
+    const uint16_t flags = LoadLE16(data + 6);
+    outPacket.sequence = LoadLE32(data + 8);
+    outPacket.timestamp = LoadLEDouble(payload);
+    auto readHand = [&](const unsigned char* p, bool valid, bool pinched, TrackedHandPacket& hand) {
+        hand.valid = valid;
+        hand.pinched = pinched;
+        hand.score = LoadLEFloat(p);
+        p += 4;
+        for (Vector3& point : hand.landmarks) {
+            point = {LoadLEFloat(p), LoadLEFloat(p + 4), LoadLEFloat(p + 8)};
+            p += 12;
+        }
+    };
+    readHand(payload + 8, (flags & 1u) != 0, (flags & 2u) != 0, outPacket.left);
+    readHand(payload + 8 + kTrackingHandBytes, (flags & 4u) != 0, (flags & 8u) != 0, outPacket.right);
+    return true;
+}
+
+bool ParseTextTrackingPacket(const char* text, TrackingPacket& outPacket) {
+    std::array<float, 133> values;
+    size_t count = 0;
+
+    const char* p = text;
+    char* end = nullptr;
+    while (*p != '\0' && count < values.size()) {
+        const float value = std::strtof(p, &end);
+        if (end == p) {
+            if (*p == ',' || *p == '\n' || *p == '\r' || *p == ' ' || *p == '\t') {
+                ++p;
+                continue;
+            }
+            return false;
+        }
+        values[count++] = value;
+        p = end;
+        while (*p == ',' || *p == '\n' || *p == '\r' || *p == ' ' || *p == '\t') ++p;
+    }
+
+    if (count < values.size()) return false;
+
+    outPacket.timestamp = std::strtod(text, nullptr);  // full precision for wall-clock stamps
+    outPacket.sequence = 0;
+    auto readHand = [&](size_t start, TrackedHandPacket& hand) {
+        hand.valid = values[start] > 0.5f;
+        hand.pinched = values[start + 1] > 0.5f;
+        hand.score = values[start + 2];
+        size_t idx = start + 3;
+        for (Vector3& point : hand.landmarks) {
+            point = {values[idx], values[idx + 1], values[idx + 2]};
+            idx += 3;
+        }
+    };
+
+    readHand(1, outPacket.left);
+    readHand(67, outPacket.right);
+    return true;
+}
+
+bool UdpHandReceiver::Start(uint16_t port, const char* multicastGroup) {
+    socket_ = multicastGroup != nullptr ? OpenMulticastUdpSocket(port, multicastGroup) : -1;
+    multicast_ = socket_ >= 0;
+    if (!multicast_) socket_ = OpenUdpSocket(port);
+    ready_ = socket_ >= 0;
+    return ready_;
+}
+
+void UdpHandReceiver::Close() {
+    CloseUdpSocket(socket_);
+    ready_ = false;
+    multicast_ = false;
+}
+
+bool UdpHandReceiver::Poll(TrackingPacket& outPacket, int& packetsRead) {
+    packetsRead = 0;
+    if (!ready_) return false;
+
+    bool gotAny = false;
+#if defined(__linux__)
+    // Drain the socket kBatch datagrams per syscall.
+    while (true) {
+        std::array<mmsghdr, kBatch> messages{};
+        std::array<iovec, kBatch> vectors{};
+        for (size_t i = 0; i < kBatch; ++i) {
+            vectors[i] = {buffers_[i].data(), buffers_[i].size() - 1};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int got = recvmmsg(socket_, messages.data(), static_cast<unsigned int>(kBatch), MSG_DONTWAIT, nullptr);
+        if (got <= 0) break;
+        for (int i = 0; i < got; ++i) {
+            if (DecodePacket(buffers_[static_cast<size_t>(i)].data(), messages[static_cast<size_t>(i)].msg_len, outPacket)) {
+                gotAny = true;
+                packetsRead++;
+            }
+        }
+        if (got < static_cast<int>(kBatch)) break;
+    }
+#else
+    while (true) {
+        const int n = ReceiveDatagram(socket_, buffers_[0].data(), buffers_[0].size() - 1);
+        if (n <= 0) break;
+        if (DecodePacket(buffers_[0].data(), static_cast<size_t>(n), outPacket)) {
+            gotAny = true;
+            packetsRead++;
+        }
+    }
+#endif
+    return gotAny;
+}
+
+bool UdpHandReceiver::DecodePacket(char* buffer, size_t n, TrackingPacket& outPacket) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(buffer);
+    if (n >= 4 && LoadLE32(bytes) == kTrackingMagic) {
+        TrackingPacket decoded;
+        if (!DecodeBinaryTrackingPacket(bytes, n, decoded)) {
+            ++rejected_;
+            return false;
+        }
+        // Reordered datagrams are dropped; a large backwards jump means the bridge restarted.
+        const int32_t delta = static_cast<int32_t>(decoded.sequence - lastSequence_);
+        if (haveSequence_ && delta <= 0 && delta > -1024) {
+            ++rejected_;
+            return false;
+        }
+        haveSequence_ = true;
+        lastSequence_ = decoded.sequence;
+        outPacket = decoded;
+        return true;
+    }
+
+    buffer[n] = '\0';
+    TrackingPacket parsed;
+    if (!ParseTextTrackingPacket(buffer, parsed)) {
+        ++rejected_;
+        return false;
+    }
+    outPacket = parsed;
+    return true;
+}
+
+bool UdpFrameReceiver::Start(uint16_t port, const char* multicastGroup) {
+    socket_ = multicastGroup != nullptr ? OpenMulticastUdpSocket(port, multicastGroup) : -1;
+    multicast_ = socket_ >= 0;
+    if (!multicast_) socket_ = OpenUdpSocket(port);
+    if (socket_ < 0) return false;
+    // Room for a few chunked 720p frames between polls; the OS may cap this lower.
+    const int receiveBuffer = 1 << 20;
+    setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&receiveBuffer), sizeof(receiveBuffer));
+    ready_ = true;
+    return true;
+}
+
+void UdpFrameReceiver::Close() {
+    CloseUdpSocket(socket_);
+    ready_ = false;
+    multicast_ = false;
+}
+
+bool UdpFrameReceiver::Poll(std::vector<unsigned char>& outFrameBytes, int& packetsRead) {
+    packetsRead = 0;
+    if (!ready_) return false;
+
+    bool gotAny = false;
+    while (true) {
+        const int n = ReceiveDatagram(socket_, buffer_.data(), buffer_.size());
+        if (n <= 0) break;
+        packetsRead++;
+        if (AcceptDatagram(buffer_.data(), static_cast<size_t>(n), outFrameBytes)) gotAny = true;
+    }
+    return gotAny;
+}
+
+bool UdpFrameReceiver::AcceptDatagram(const unsigned char* data, size_t n, std::vector<unsigned char>& outFrameBytes) {
+    if (n < kFrameChunkHeaderBytes || LoadLE32(data) != kFrameChunkMagic) {
+        outFrameBytes.assign(data, data + n);
+        return true;
+    }
+
+    const uint16_t index = LoadLE16(data + 6);
+    const uint16_t count = LoadLE16(data + 8);
+    const uint32_t frameId = LoadLE32(data + 12);
+    const uint32_t frameBytes = LoadLE32(data + 16);
+    const uint32_t offset = LoadLE32(data + 20);
+    const size_t sliceBytes = n - kFrameChunkHeaderBytes;
+    if (LoadLE16(data + 4) != kFrameChunkVersion || count == 0 || index >= count || frameBytes == 0 ||
+        frameBytes > kMaxPreviewFrameBytes || offset > frameBytes || sliceBytes > frameBytes - offset) {
+        ++droppedChunks_;
+        return false;
+    }
+
+    if (!assembling_ || frameId != frameId_) {
+        // Stragglers from an older frame are dropped; a large backwards jump means the bridge restarted.
+        const int32_t delta = static_cast<int32_t>(frameId - frameId_);
+        if (haveFrameId_ && delta <= 0 && delta > -1024) {
+            ++droppedChunks_;
+            return false;
+        }
+        if (assembling_) ++droppedFrames_;
+        haveFrameId_ = true;
+        assembling_ = true;
+        frameId_ = frameId;
+        assembly_.resize(frameBytes);
+        chunkSeen_.assign(count, 0);
+        chunksLeft_ = count;
+    } else if (count != chunkSeen_.size() || frameBytes != assembly_.size()) {
+        ++droppedChunks_;
+        return false;
+    }
+
+    if (chunkSeen_[index] != 0) {
+        ++droppedChunks_;
+        return false;
+    }
+    chunkSeen_[index] = 1;
+    if (sliceBytes > 0) std::memcpy(assembly_.data() + offset, data + kFrameChunkHeaderBytes, sliceBytes);
+    if (--chunksLeft_ > 0) return false;
+
+    assembling_ = false;
+    outFrameBytes.swap(assembly_);
+    return true;
+}
+
+bool ParseBridgeInput(const char* text, BridgeInput& outInput) {
+    BridgeInput parsed{};
+    int lv = 0;
+    int rv = 0;
+    int rp = 0;
+    int lp = 0;
+    const int got = std::sscanf(text, "%lf,%d,%f,%f,%d,%d,%f,%f,%d", &parsed.timestamp, &lv, &parsed.leftX, &parsed.leftY, &rv, &rp,
+                                &parsed.rightX, &parsed.rightY, &lp);
+    if (got < 6) return false;
+
+    parsed.leftValid = (lv != 0);
+    parsed.rightValid = (rv != 0);
+    parsed.rightPinch = (rp != 0);
+    if (got < 8) {
+        parsed.rightX = 0.5f;
+        parsed.rightY = 0.5f;
+    }
+    if (got >= 9) parsed.leftPinch = (lp != 0);
+
+    parsed.leftX = Clamp01(parsed.leftX);
+    parsed.leftY = Clamp01(parsed.leftY);
+    parsed.rightX = Clamp01(parsed.rightX);
+    parsed.rightY = Clamp01(parsed.rightY);
+    outInput = parsed;
+    return true;
+}
+
+bool UdpBridgeReceiver::Start(uint16_t port) {
+    socket_ = OpenUdpSocket(port);
+    ready_ = socket_ >= 0;
+    return ready_;
+}
+
+void UdpBridgeReceiver::Close() {
+    CloseUdpSocket(socket_);
+    ready_ = false;
+}
+
+bool UdpBridgeReceiver::Poll(BridgeInput& outInput, int& packetsRead) {
+    packetsRead = 0;
+    if (!ready_) return false;
+
+    bool gotAny = false;
+    while (true) {
+        const int n = ReceiveDatagram(socket_, buffer_.data(), buffer_.size() - 1);
+        if (n <= 0) break;
+        buffer_[static_cast<size_t>(n)] = '\0';
+        if (ParseBridgeInput(buffer_.data(), outInput)) {
+            gotAny = true;
+            packetsRead++;
+        }
+    }
+    return gotAny;
+}
+
+double SteadySeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void WaitForSockets(int a, int b, int timeoutMs) {
+#ifdef _WIN32
+    WSAPOLLFD fds[2]{};
+    ULONG count = 0;
+    for (int s : {a, b}) {
+        if (s < 0) continue;
+        fds[count].fd = static_cast<SOCKET>(s);
+        fds[count].events = POLLRDNORM;
+        ++count;
+    }
+    if (count > 0) {
+        WSAPoll(fds, count, timeoutMs);
+        return;
+    }
+#else
+    pollfd fds[2]{};
+    nfds_t count = 0;
+    for (int s : {a, b}) {
+        if (s < 0) continue;
+        fds[count].fd = s;
+        fds[count].events = POLLIN;
+        ++count;
+    }
+    if (count > 0) {
+        poll(fds, count, timeoutMs);
+        return;
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+}
+
+namespace {
+
+// Exponential smoothing factor for a first-order low-pass at `cutoff` Hz.
+float SmoothingAlpha(float cutoff, float dt) {
+    const float tau = 1.0f / (2.0f * PI * cutoff);
+    return 1.0f / (1.0f + tau / dt);
+}
+
+}  // namespace
+
+void LandmarkFilter::Update(const std::array<Vector3, kLandmarkCount>& raw, float dt, const HandFilterConfig& config) {
+    if (primed_ == 0) {
+        position_ = raw;
+        derivative_ = {};
+        velocity_ = {};
+        acceleration_ = {};
+        primed_ = 1;
+        return;
+    }
+    dt = std::max(dt, 1.0e-3f);
+    const OneEuroParams& p = config.landmarks;
+    const float derivativeAlpha = SmoothingAlpha(p.derivativeCutoff, dt);
+    const float motionAlpha = SmoothingAlpha(config.velocityCutoff, dt);
+    for (size_t i = 0; i < raw.size(); ++i) {
+        const Vector3 speed = Vector3Scale(Vector3Subtract(raw[i], position_[i]), 1.0f / dt);
+        derivative_[i] = Vector3Lerp(derivative_[i], speed, derivativeAlpha);
+        const float cutoff = p.minCutoff + p.beta * Vector3Length(derivative_[i]);
+        const Vector3 filtered = Vector3Lerp(position_[i], raw[i], SmoothingAlpha(cutoff, dt));
+
+        const Vector3 velocity = Vector3Scale(Vector3Subtract(filtered, position_[i]), 1.0f / dt);
+        if (primed_ == 1) {
+            velocity_[i] = velocity;
+        } else {
+            const Vector3 smoothed = Vector3Lerp(velocity_[i], velocity, motionAlpha);
+            const Vector3 accel = Vector3Scale(Vector3Subtract(smoothed, velocity_[i]), 1.0f / dt);
+            acceleration_[i] = primed_ == 2 ? accel : Vector3Lerp(acceleration_[i], accel, motionAlpha);
+            velocity_[i] = smoothed;
+        }
+        position_[i] = filtered;
+    }
+    primed_ = std::min(primed_ + 1, 3);
+}
+
+void LandmarkFilter::Predict(float ahead, float accelerationWeight, std::array<Vector3, kLandmarkCount>* out) const {
+    const float v = primed_ >= 2 ? ahead : 0.0f;
+    const float a = primed_ >= 3 ? 0.5f * accelerationWeight * ahead * ahead : 0.0f;
+    for (size_t i = 0; i < out->size(); ++i) {
+        (*out)[i] = Vector3Add(position_[i], Vector3Add(Vector3Scale(velocity_[i], v), Vector3Scale(acceleration_[i], a)));
+    }
+}
+
+BridgeInput ExtrapolateBridgeInput(const BridgeInput& previous, const BridgeInput& current, float ahead) {
+    BridgeInput out = current;
+    const double span = current.timestamp - previous.timestamp;
+    if (ahead <= 0.0f || span <= 1.0e-4 || span > 0.25) return out;
+    const float scale = ahead / static_cast<float>(span);
+    if (previous.leftValid && current.leftValid) {
+        out.leftX = Clamp01(current.leftX + (current.leftX - previous.leftX) * scale);
+        out.leftY = Clamp01(current.leftY + (current.leftY - previous.leftY) * scale);
+    }
+    if (previous.rightValid && current.rightValid) {
+        out.rightX = Clamp01(current.rightX + (current.rightX - previous.rightX) * scale);
+        out.rightY = Clamp01(current.rightY + (current.rightY - previous.rightY) * scale);
+    }
+    return out;
+}
+
+float LandmarkPalmNorm(const std::array<Vector3, 21>& pts) {
+    const auto dist2 = [&](int a, int b) {
+        const float dx = pts[static_cast<size_t>(a)].x - pts[static_cast<size_t>(b)].x;
+        const float dy = pts[static_cast<size_t>(a)].y - pts[static_cast<size_t>(b)].y;
+        return std::sqrt(dx * dx + dy * dy);
+    };
+    return std::max(1.0e-4f, (dist2(0, 5) + dist2(0, 17) + dist2(5, 17)) / 3.0f);
+}
+
+bool UpdatePreviewTexture(Texture2D& texture, const std::vector<unsigned char>& jpgBytes) {
+    if (jpgBytes.empty()) return false;
+    Image image = LoadImageFromMemory(".jpg", jpgBytes.data(), static_cast<int>(jpgBytes.size()));
+    if (image.data == nullptr) return false;
+
+    if (texture.id > 0 && texture.width == image.width && texture.height == image.height) {
+        UpdateTexture(texture, image.data);
+    } else {
+        if (texture.id > 0) {
+            UnloadTexture(texture);
+            texture = Texture2D{};
+        }
+        texture = LoadTextureFromImage(image);
+        SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+    }
+    UnloadImage(image);
+    return texture.id > 0;
+}
+
+void PreviewDecoder::Start() {
+    if (worker_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+        pending_ = false;
+    }
+    worker_ = std::thread([this]() { WorkerLoop(); });
+}
+
+void PreviewDecoder::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    if (worker_.joinable()) worker_.join();
+}
+
+void PreviewDecoder::Submit(std::vector<unsigned char>& jpegBytes) {
+    jpegSlot_.WriteBuffer().swap(jpegBytes);
+    jpegSlot_.Publish();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = true;
+    }
+    wake_.notify_one();
+}
+
+bool PreviewDecoder::Upload(Texture2D& texture, float now, float interval) {
+    if (texture.id > 0 && (now - lastUpload_) < interval) return false;
+    if (!decodedSlot_.Acquire()) return false;
+    DecodedPreview& frame = decodedSlot_.ReadBuffer();
+
+    if (texture.id > 0 && texture.width == frame.width && texture.height == frame.height &&
+        texture.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        UpdateTexture(texture, frame.rgba.data());
+    } else {
+        if (texture.id > 0) {
+            UnloadTexture(texture);
+            texture = Texture2D{};
+        }
+        Image image{};
+        image.data = frame.rgba.data();
+        image.width = frame.width;
+        image.height = frame.height;
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        texture = LoadTextureFromImage(image);
+        SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+    }
+    lastUpload_ = now;
+    return texture.id > 0;
+}
+
+void PreviewDecoder::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this]() { return stop_ || pending_; });
+        if (stop_) return;
+        pending_ = false;
+        lock.unlock();
+
+        if (jpegSlot_.Acquire() && Decode(jpegSlot_.ReadBuffer(), decodedSlot_.WriteBuffer())) decodedSlot_.Publish();
+
+        lock.lock();
+    }
+}
+
+bool PreviewDecoder::Decode(const std::vector<unsigned char>& jpegBytes, DecodedPreview& out) {
+    if (jpegBytes.empty()) return false;
+    Image image = LoadImageFromMemory(".jpg", jpegBytes.data(), static_cast<int>(jpegBytes.size()));
+    if (image.data == nullptr) return false;
+    if (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8 && image.format != PIXELFORMAT_UNCOMPRESSED_GRAYSCALE) {
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+
+    const size_t pixels = static_cast<size_t>(image.width) * static_cast<size_t>(image.height);
+    out.width = image.width;
+    out.height = image.height;
+    out.rgba.resize(pixels * 4);
+    const unsigned char* src = static_cast<const unsigned char*>(image.data);
+    unsigned char* dst = out.rgba.data();
+    if (image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8) {
+        for (size_t i = 0; i < pixels; ++i, src += 3, dst += 4) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = 255;
+        }
+    } else if (image.format == PIXELFORMAT_UNCOMPRESSED_GRAYSCALE) {
+        for (size_t i = 0; i < pixels; ++i, ++src, dst += 4) {
+            dst[0] = dst[1] = dst[2] = *src;
+            dst[3] = 255;
+        }
+    } else {
+        std::memcpy(dst, src, pixels * 4);
+    }
+    UnloadImage(image);
+    return true;
+}
+
+HandGeometry BlendGeometry(const HandGeometry& a, const HandGeometry& b, float t) {
+    HandGeometry out{};
+    for (size_t i = 0; i < out.landmarks.size(); ++i) {
+        out.landmarks[i] = Vector3Lerp(a.landmarks[i], b.landmarks[i], t);
+        out.radii[i] = LerpFloat(a.radii[i], b.radii[i], t);
+    }
+    for (size_t i = 0; i < out.palmRim.size(); ++i) out.palmRim[i] = Vector3Lerp(a.palmRim[i], b.palmRim[i], t);
+    out.palmCenter = Vector3Lerp(a.palmCenter, b.palmCenter, t);
+    out.wristLeft = Vector3Lerp(a.wristLeft, b.wristLeft, t);
+    out.wristRight = Vector3Lerp(a.wristRight, b.wristRight, t);
+    return out;
+}
+
+HandGeometry OffsetGeometry(const HandGeometry& g, Vector3 offset) {
+    HandGeometry out = g;
+    for (Vector3& point : out.landmarks) point = Vector3Add(point, offset);
+    for (Vector3& point : out.palmRim) point = Vector3Add(point, offset);
+    out.palmCenter = Vector3Add(out.palmCenter, offset);
+    out.wristLeft = Vector3Add(out.wristLeft, offset);
+    out.wristRight = Vector3Add(out.wristRight, offset);
+    return out;
+}
+
+float EstimateTrackedDepthShift(const TrackedHandPacket& packet) {
+    const float palm = LandmarkPalmNorm(packet.landmarks);
+    const float relative = std::clamp((kTrackedDepthPalmRef / palm) - 1.0f, -0.55f, 0.90f);
+    return -relative * kTrackedDepthRange;
+}
+
+HandGeometry BuildTrackedGeometry(const TrackedHandPacket& packet, bool rightHand) {
+    HandGeometry g{};
+    constexpr std::array<float, 21> kRadii = {
+        0.34f, 0.24f, 0.22f, 0.19f, 0.16f,
+        0.23f, 0.20f, 0.17f, 0.14f,
+        0.23f, 0.20f, 0.17f, 0.14f,
+        0.21f, 0.18f, 0.15f, 0.12f,
+        0.19f, 0.16f, 0.13f, 0.10f,
+    };
+
+    const Vector3 wristNorm = packet.landmarks[0];
+    const Vector3 indexNorm = packet.landmarks[5];
+    const Vector3 pinkyNorm = packet.landmarks[17];
+    const Vector3 sideKnuckleCenterNorm = Vector3Scale(Vector3Add(indexNorm, pinkyNorm), 0.5f);
+    const Vector3 rootAnchorNorm = Vector3Add(Vector3Scale(wristNorm, 0.88f), Vector3Scale(sideKnuckleCenterNorm, 0.12f));
+    const float palm = LandmarkPalmNorm(packet.landmarks);
+
+    const Vector3 origin = {
+        (rootAnchorNorm.x - 0.50f) * 24.0f + (rightHand ? 0.4f : -0.4f),
+        2.6f + (0.66f - rootAnchorNorm.y) * 8.2f,
+        rightHand ? 0.45f : -0.45f,
+    };
+
+    const float xyScale = (3.8f / palm) * kTrackedHandModelScale;
+    const float zScale = (5.2f / palm) * kTrackedHandModelScale;
+
+    for (size_t i = 0; i < g.landmarks.size(); ++i) {
+        const Vector3 rel = Vector3Subtract(packet.landmarks[i], rootAnchorNorm);
+        const Vector3 local = {
+            rel.x * xyScale,
+            -rel.y * xyScale,
+            -rel.z * zScale,
+        };
+        g.landmarks[i] = Vector3Add(origin, local);
+        g.radii[i] = kRadii[i] * kTrackedHandModelScale;
+    }
+
+    const Vector3 across = Vector3Subtract(g.landmarks[17], g.landmarks[5]);
+    const Vector3 wristAxis = SafeNormalize(across, {1.0f, 0.0f, 0.0f});
+    const Vector3 forearmDir = SafeNormalize(Vector3Subtract(g.landmarks[0], Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]})), {0.0f, -1.0f, 0.0f});
+
+    g.wristLeft = Vector3Add(Vector3Add(g.landmarks[0], Vector3Scale(wristAxis, -0.88f * kTrackedHandModelScale)), Vector3Scale(forearmDir, 0.18f * kTrackedHandModelScale));
+    g.wristRight = Vector3Add(Vector3Add(g.landmarks[0], Vector3Scale(wristAxis, 0.88f * kTrackedHandModelScale)), Vector3Scale(forearmDir, 0.18f * kTrackedHandModelScale));
+    g.palmRim = {
+        g.wristLeft,
+        g.landmarks[1],
+        g.landmarks[5],
+        g.landmarks[9],
+        g.landmarks[13],
+        g.landmarks[17],
+        g.wristRight,
+    };
+    g.palmCenter = Average({g.landmarks[0], g.landmarks[1], g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]});
+    return g;
+}
+
+void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance, float maxDistance) {
+    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+        const Vector2 d = GetMouseDelta();
+        *yaw -= d.x * 0.0032f;
+        *pitch += d.y * 0.0030f;
+        *pitch = std::clamp(*pitch, -1.35f, 1.35f);
+    }
+
+    *distance -= GetMouseWheelMove() * 0.7f;
+    *distance = std::clamp(*distance, 6.0f, maxDistance);
+
+    const float cp = std::cos(*pitch);
+    const Vector3 offset = {
+        *distance * cp * std::cos(*yaw),
+        *distance * std::sin(*pitch),
+        *distance * cp * std::sin(*yaw),
+    };
+    camera->position = Vector3Add(camera->target, offset);
+}
+
+HandVisualStyle StyleForHand(bool rightHand) {
+    if (rightHand) {
+        return HandVisualStyle{Color{236, 184, 146, 255}, Color{212, 155, 118, 255}, Color{248, 212, 176, 255},
+                               Color{142, 96, 74, 255}, Color{255, 210, 126, 255}, Color{76, 44, 28, 120}};
+    }
+    return HandVisualStyle{Color{150, 190, 236, 255}, Color{112, 156, 214, 255}, Color{188, 220, 255, 255},
+                           Color{74, 98, 148, 255}, Color{132, 224, 255, 255}, Color{28, 40, 76, 120}};
+}
+
+void DrawBone(Vector3 a, Vector3 b, float ra, float rb, Color color) {
+    const int sides = astro_render::CylinderSidesLod(a, b, ra, rb, static_cast<int>(kBoneSides));
+    astro_render::DrawCylinderLod(a, b, ra, rb, static_cast<int>(kBoneSides), color);
+    if (sides > 0) DrawCylinderWiresEx(a, b, ra, rb, sides, Fade(BLACK, 0.25f));
+}
+
+void DrawPalmSurface(const HandGeometry& g, Color palmColor, Color highlightColor) {
+    for (size_t i = 0; i + 1 < g.palmRim.size(); ++i) DrawTriangle3D(g.palmCenter, g.palmRim[i], g.palmRim[i + 1], palmColor);
+    const Color webColor = Fade(palmColor, 0.92f);
+    DrawTriangle3D(g.landmarks[1], g.landmarks[5], g.landmarks[6], webColor);
+    DrawTriangle3D(g.landmarks[5], g.landmarks[9], g.landmarks[6], webColor);
+    DrawTriangle3D(g.landmarks[9], g.landmarks[13], g.landmarks[10], webColor);
+    DrawTriangle3D(g.landmarks[13], g.landmarks[17], g.landmarks[14], webColor);
+    DrawTriangle3D(g.landmarks[1], g.landmarks[5], g.palmCenter, Fade(highlightColor, 0.35f));
+    DrawTriangle3D(g.landmarks[5], g.landmarks[9], g.palmCenter, Fade(highlightColor, 0.18f));
+}
+
+void DrawPalmLines(const HandGeometry& g, Color color) {
+    for (size_t i = 0; i + 1 < g.palmRim.size(); ++i) DrawLine3D(g.palmRim[i], g.palmRim[i + 1], color);
+    DrawLine3D(g.wristLeft, g.wristRight, color);
+    DrawLine3D(g.landmarks[0], g.landmarks[5], Fade(color, 0.85f));
+    DrawLine3D(g.landmarks[0], g.landmarks[9], Fade(color, 0.90f));
+    DrawLine3D(g.landmarks[0], g.landmarks[13], Fade(color, 0.85f));
+    DrawLine3D(g.landmarks[0], g.landmarks[17], Fade(color, 0.80f));
+}
+
+void DrawTendonLines(const HandGeometry& g, Color color) {
+    const std::array<int, 4> fingerStarts = {5, 9, 13, 17};
+    for (int idx : fingerStarts) {
+        DrawLine3D(g.landmarks[0], g.landmarks[idx + 1], Fade(color, 0.65f));
+        DrawLine3D(g.landmarks[idx], g.landmarks[idx + 2], Fade(color, 0.50f));
+    }
+    DrawLine3D(g.landmarks[1], g.landmarks[3], Fade(color, 0.55f));
+}
+
+void DrawForearm(const HandGeometry& g, const HandVisualStyle& style) {
+    const float s = HandVisualScale(g);
+    const Vector3 wristMid = Vector3Scale(Vector3Add(g.wristLeft, g.wristRight), 0.5f);
+    const Vector3 knuckleMid = Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]});
+    const Vector3 dir = SafeNormalize(Vector3Subtract(wristMid, knuckleMid), {0.0f, -1.0f, 0.0f});
+    const Vector3 forearmEnd = Vector3Add(wristMid, Vector3Scale(dir, 1.55f * s));
+    DrawBone(wristMid, forearmEnd, 0.48f * s, 0.34f * s, Fade(style.bone, 0.82f));
+    astro_render::DrawSphereLod(forearmEnd, 0.34f * s, Fade(style.palm, 0.78f));
+}
+
+void DrawKnuckleBridge(const HandGeometry& g, const HandVisualStyle& style) {
+    const std::array<int, 4> ridge = {5, 9, 13, 17};
+    for (size_t i = 0; i + 1 < ridge.size(); ++i) DrawLine3D(g.landmarks[ridge[i]], g.landmarks[ridge[i + 1]], Fade(style.accent, 0.55f));
+    for (int idx : ridge) astro_render::DrawSphereLod(g.landmarks[idx], g.radii[idx] * 0.72f, Fade(style.accent, 0.55f));
+}
+
+void DrawPinchCue(const HandGeometry& g, const HandVisualStyle& style) {
+    const float s = HandVisualScale(g);
+    const Vector3 thumb = g.landmarks[4];
+    const Vector3 index = g.landmarks[8];
+    const Vector3 center = Vector3Scale(Vector3Add(thumb, index), 0.5f);
+    DrawLine3D(thumb, index, style.accent);
+    astro_render::DrawSphereLod(center, 0.16f * s, Fade(style.accent, 0.92f));
+    astro_render::DrawSphereLod(thumb, 0.10f * s, style.accent);
+    astro_render::DrawSphereLod(index, 0.10f * s, style.accent);
+}
+
+void DrawPalmNormalCue(const HandGeometry& g, const HandVisualStyle& style) {
+    const float s = HandVisualScale(g);
+    const Vector3 across = Vector3Subtract(g.landmarks[17], g.landmarks[5]);
+    const Vector3 fingers = Vector3Subtract(Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]}), g.landmarks[0]);
+    Vector3 normal = SafeNormalize(Vector3CrossProduct(across, fingers), {0.0f, 0.0f, 1.0f});
+    if (normal.z < 0.0f) normal = Vector3Scale(normal, -1.0f);
+    const Vector3 tip = Vector3Add(g.palmCenter, Vector3Scale(normal, 0.72f * s));
+    DrawLine3D(g.palmCenter, tip, style.accent);
+    astro_render::DrawSphereLod(tip, 0.10f * s, style.accent);
+}
+
+void DrawHandShadow(const HandGeometry& g, const HandVisualStyle& style) {
+    const float s = HandVisualScale(g);
+    for (const Vector3& point : g.palmRim) {
+        const Vector3 shadow = {point.x, 0.021f, point.z};
+        astro_render::DrawSphereLod(shadow, 0.18f * s, Fade(style.shadow, 0.25f));
+    }
+}
+
+namespace {
+
+// Everything DrawHandModel draws, reduced to tapered tubes, spheres, and triangles and
+// lines between a fixed set of points, so the GPU and immediate paths share one list.
+constexpr int kMaxHandTubes = 32;
+constexpr int kMaxHandBalls = 64;
+// Landmarks 0-20, palm rim 21-27, palm centre, wrist left and right, palm normal tip.
+constexpr int kHandPointCount = 32;
+constexpr int kHandRimPoint = 21;
+constexpr int kHandCenterPoint = 28;
+constexpr int kHandWristLeftPoint = 29;
+constexpr int kHandWristRightPoint = 30;
+constexpr int kHandNormalPoint = 31;
+constexpr int kHandPaletteSize = 16;
+constexpr int kHandBallRings = 8;
+constexpr int kHandBallSlices = 12;
+
+struct HandTube {
+    Vector3 a;
+    Vector3 b;
+    float ra;
+    float rb;
+    Color color;
+};
+
+struct HandBall {
+    Vector3 center;
+    float radius;
+    Color color;
+};
+
+// Palette slots the fixed triangles and lines are coloured with.
+enum HandSlot : int {
+    kSlotPalm,
+    kSlotWeb,
+    kSlotHighlight,
+    kSlotHighlightFaint,
+    kSlotPalmLine,
+    kSlotPalmSpoke,
+    kSlotPalmSpokeMiddle,
+    kSlotPalmSpokePinky,
+    kSlotTendon,
+    kSlotTendonCross,
+    kSlotTendonThumb,
+    kSlotKnuckle,
+    kSlotAccent,
+    kSlotPinch,
+};
+
+struct HandShapes {
+    std::array<HandTube, kMaxHandTubes> tubes{};
+    int tubeCount = 0;
+    std::array<HandBall, kMaxHandBalls> balls{};
+    int ballCount = 0;
+    std::array<Vector3, kHandPointCount> points{};
+    std::array<Color, kHandPaletteSize> palette{};
+
+    void Tube(Vector3 a, Vector3 b, float ra, float rb, Color color) { tubes[static_cast<size_t>(tubeCount++)] = {a, b, ra, rb, color}; }
+    void Ball(Vector3 center, float radius, Color color) { balls[static_cast<size_t>(ballCount++)] = {center, radius, color}; }
+};
+
+struct HandTriangle {
+    int a, b, c, slot;
+};
+
+struct HandLine {
+    int a, b, slot;
+};
+
+constexpr std::array<HandTriangle, 12> kHandTriangles = {{
+    {kHandCenterPoint, kHandRimPoint + 0, kHandRimPoint + 1, kSlotPalm},
+    {kHandCenterPoint, kHandRimPoint + 1, kHandRimPoint + 2, kSlotPalm},
+    {kHandCenterPoint, kHandRimPoint + 2, kHandRimPoint + 3, kSlotPalm},
+    {kHandCenterPoint, kHandRimPoint + 3, kHandRimPoint + 4, kSlotPalm},
+    {kHandCenterPoint, kHandRimPoint + 4, kHandRimPoint + 5, kSlotPalm},
+    {kHandCenterPoint, kHandRimPoint + 5, kHandRimPoint + 6, kSlotPalm},
+    {1, 5, 6, kSlotWeb},
+    {5, 9, 6, kSlotWeb},
+    {9, 13, 10, kSlotWeb},
+    {13, 17, 14, kSlotWeb},
+    {1, 5, kHandCenterPoint, kSlotHighlight},
+    {5, 9, kHandCenterPoint, kSlotHighlightFaint},
+}};
+
+constexpr std::array<HandLine, 25> kHandLines = {{
+    {0, 6, kSlotTendon}, {5, 7, kSlotTendonCross},
+    {0, 10, kSlotTendon}, {9, 11, kSlotTendonCross},
+    {0, 14, kSlotTendon}, {13, 15, kSlotTendonCross},
+    {0, 18, kSlotTendon}, {17, 19, kSlotTendonCross},
+    {1, 3, kSlotTendonThumb},
+    {kHandRimPoint + 0, kHandRimPoint + 1, kSlotPalmLine},
+    {kHandRimPoint + 1, kHandRimPoint + 2, kSlotPalmLine},
+    {kHandRimPoint + 2, kHandRimPoint + 3, kSlotPalmLine},
+    {kHandRimPoint + 3, kHandRimPoint + 4, kSlotPalmLine},
+    {kHandRimPoint + 4, kHandRimPoint + 5, kSlotPalmLine},
+    {kHandRimPoint + 5, kHandRimPoint + 6, kSlotPalmLine},
+    {kHandWristLeftPoint, kHandWristRightPoint, kSlotPalmLine},
+    {0, 5, kSlotPalmSpoke},
+    {0, 9, kSlotPalmSpokeMiddle},
+    {0, 13, kSlotPalmSpoke},
+    {0, 17, kSlotPalmSpokePinky},
+    {5, 9, kSlotKnuckle},
+    {9, 13, kSlotKnuckle},
+    {13, 17, kSlotKnuckle},
+    {kHandCenterPoint, kHandNormalPoint, kSlotAccent},
+    {4, 8, kSlotPinch},
+}};
+
+// The same parts, colours and radii DrawForearm, DrawPalmSurface, DrawTendonLines,
+// DrawPalmLines, DrawKnuckleBridge, DrawPalmNormalCue, DrawPinchCue and DrawHandShadow draw.
+void BuildHandShapes(const HandGeometry& g, const HandVisualStyle& style, bool showLandmarks, bool pinched, HandShapes* out) {
+    HandShapes& h = *out;
+    const float s = HandVisualScale(g);
+    for (size_t i = 0; i < g.landmarks.size(); ++i) h.points[i] = g.landmarks[i];
+    for (size_t i = 0; i < g.palmRim.size(); ++i) h.points[kHandRimPoint + i] = g.palmRim[i];
+    h.points[kHandCenterPoint] = g.palmCenter;
+    h.points[kHandWristLeftPoint] = g.wristLeft;
+    h.points[kHandWristRightPoint] = g.wristRight;
+
+    const Vector3 across = Vector3Subtract(g.landmarks[17], g.landmarks[5]);
+    const Vector3 knuckleMid = Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]});
+    Vector3 normal = SafeNormalize(Vector3CrossProduct(across, Vector3Subtract(knuckleMid, g.landmarks[0])), {0.0f, 0.0f, 1.0f});
+    if (normal.z < 0.0f) normal = Vector3Scale(normal, -1.0f);
+    h.points[kHandNormalPoint] = Vector3Add(g.palmCenter, Vector3Scale(normal, 0.72f * s));
+
+    const Color palmLine = Fade(style.tendon, 0.65f);
+    h.palette = {};
+    h.palette[kSlotPalm] = style.palm;
+    h.palette[kSlotWeb] = Fade(style.palm, 0.92f);
+    h.palette[kSlotHighlight] = Fade(style.tip, 0.35f);
+    h.palette[kSlotHighlightFaint] = Fade(style.tip, 0.18f);
+    h.palette[kSlotPalmLine] = palmLine;
+    h.palette[kSlotPalmSpoke] = Fade(palmLine, 0.85f);
+    h.palette[kSlotPalmSpokeMiddle] = Fade(palmLine, 0.90f);
+    h.palette[kSlotPalmSpokePinky] = Fade(palmLine, 0.80f);
+    h.palette[kSlotTendon] = Fade(style.tendon, 0.65f);
+    h.palette[kSlotTendonCross] = Fade(style.tendon, 0.50f);
+    h.palette[kSlotTendonThumb] = Fade(style.tendon, 0.55f);
+    h.palette[kSlotKnuckle] = Fade(style.accent, 0.55f);
+    h.palette[kSlotAccent] = style.accent;
+    h.palette[kSlotPinch] = pinched ? style.accent : BLANK;
+
+    h.tubeCount = 0;
+    const Vector3 wristMid = Vector3Scale(Vector3Add(g.wristLeft, g.wristRight), 0.5f);
+    const Vector3 forearmDir = SafeNormalize(Vector3Subtract(wristMid, knuckleMid), {0.0f, -1.0f, 0.0f});
+    const Vector3 forearmEnd = Vector3Add(wristMid, Vector3Scale(forearmDir, 1.55f * s));
+    h.Tube(wristMid, forearmEnd, 0.48f * s, 0.34f * s, Fade(style.bone, 0.82f));
+    for (int finger = 0; finger < 5; ++finger) {
+        for (int joint = 0; joint < 4; ++joint) {
+            const int first = joint == 0 ? 0 : 4 * finger + joint;
+            const int second = 4 * finger + joint + 1;
+            h.Tube(g.landmarks[first], g.landmarks[second], g.radii[first] * 0.78f, g.radii[second] * 0.82f,
+                   joint == 3 ? style.tip : style.bone);
+        }
+    }
+    for (int idx : {5, 9, 13, 17}) h.Tube(g.landmarks[0], g.landmarks[idx], 0.14f * s, g.radii[idx] * 0.90f, Fade(style.bone, 0.75f));
+    h.Tube(g.landmarks[0], g.landmarks[1], 0.16f * s, g.radii[1] * 0.95f, Fade(style.bone, 0.72f));
+
+    h.ballCount = 0;
+    for (const Vector3& point : g.palmRim) h.Ball({point.x, 0.021f, point.z}, 0.18f * s, Fade(style.shadow, 0.25f));
+    h.Ball(forearmEnd, 0.34f * s, Fade(style.palm, 0.78f));
+    for (int idx : {5, 9, 13, 17}) h.Ball(g.landmarks[idx], g.radii[idx] * 0.72f, Fade(style.accent, 0.55f));
+    for (size_t i = 0; i < g.landmarks.size(); ++i) {
+        const bool tip = (i == 4 || i == 8 || i == 12 || i == 16 || i == 20);
+        h.Ball(g.landmarks[i], g.radii[i] * kJointSphereScale, tip ? style.tip : style.palm);
+    }
+    h.Ball(g.palmCenter, 0.33f * s, Fade(style.palm, 0.85f));
+    h.Ball(g.landmarks[1], 0.18f * s, Fade(style.accent, 0.30f));
+    h.Ball(h.points[kHandNormalPoint], 0.10f * s, style.accent);
+    if (pinched) {
+        h.Ball(Vector3Scale(Vector3Add(g.landmarks[4], g.landmarks[8]), 0.5f), 0.16f * s, Fade(style.accent, 0.92f));
+        h.Ball(g.landmarks[4], 0.10f * s, style.accent);
+        h.Ball(g.landmarks[8], 0.10f * s, style.accent);
+    }
+    if (showLandmarks) {
+        for (size_t i = 0; i < g.landmarks.size(); ++i) h.Ball(g.landmarks[i], g.radii[i] * 0.42f, style.accent);
+    }
+}
+
+void DrawHandShapesImmediate(const HandShapes& h) {
+    for (int i = 0; i < h.tubeCount; ++i) {
+        const HandTube& t = h.tubes[static_cast<size_t>(i)];
+        DrawBone(t.a, t.b, t.ra, t.rb, t.color);
+    }
+    for (const HandTriangle& t : kHandTriangles) {
+        DrawTriangle3D(h.points[static_cast<size_t>(t.a)], h.points[static_cast<size_t>(t.b)], h.points[static_cast<size_t>(t.c)],
+                       h.palette[static_cast<size_t>(t.slot)]);
+    }
+    for (const HandLine& l : kHandLines) {
+        const Color color = h.palette[static_cast<size_t>(l.slot)];
+        if (color.a > 0) DrawLine3D(h.points[static_cast<size_t>(l.a)], h.points[static_cast<size_t>(l.b)], color);
+    }
+    for (int i = 0; i < h.ballCount; ++i) {
+        const HandBall& b = h.balls[static_cast<size_t>(i)];
+        astro_render::DrawSphereLod(b.center, b.radius, b.color);
+    }
+}
+
+Vector4 ColorToVec4(Color c) {
+    return {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f};
+}
+
+// The hand as five static GPU buffers skinned by uniforms: every tube and sphere slot
+// is a unit shape tagged with its slot index, and the vertex shader places it from a
+// (centre, radius) pair per end, so a frame uploads about 250 vec4s per hand and
+// issues five draws instead of generating every cylinder and sphere on the CPU. Palm
+// triangles and lines index a uniform point table the same way.
+class HandMesh {
+  public:
+    bool Init() {
+        const float step = 2.0f * PI / kBoneSides;
+        const int sides = static_cast<int>(kBoneSides);
+        std::vector<Vector4> tubes;
+        tubes.reserve(static_cast<size_t>(kMaxHandTubes * kTubeVertices));
+        std::vector<Vector4> wires;
+        wires.reserve(static_cast<size_t>(kMaxHandTubes * kWireVertices));
+        for (int t = 0; t < kMaxHandTubes; ++t) {
+            const float slot = static_cast<float>(t);
+            for (int j = 0; j < sides; ++j) {
+                const float a0 = step * static_cast<float>(j);
+                const float a1 = step * static_cast<float>(j + 1);
+                // Counter-clockwise from outside: raylib culls back faces.
+                tubes.insert(tubes.end(), {{slot, 0.0f, a0, 1.0f}, {slot, 0.0f, a1, 1.0f}, {slot, 1.0f, a0, 1.0f},
+                                           {slot, 0.0f, a1, 1.0f}, {slot, 1.0f, a1, 1.0f}, {slot, 1.0f, a0, 1.0f},
+                                           {slot, 0.0f, a0, 0.0f}, {slot, 0.0f, a1, 1.0f}, {slot, 0.0f, a0, 1.0f},
+                                           {slot, 1.0f, a0, 0.0f}, {slot, 1.0f, a0, 1.0f}, {slot, 1.0f, a1, 1.0f}});
+                wires.insert(wires.end(), {{slot, 0.0f, a0, 1.0f}, {slot, 0.0f, a1, 1.0f}, {slot, 1.0f, a0, 1.0f},
+                                           {slot, 1.0f, a1, 1.0f}, {slot, 0.0f, a0, 1.0f}, {slot, 1.0f, a0, 1.0f}});
+            }
+        }
+
+        std::vector<Vector4> balls;
+        balls.reserve(static_cast<size_t>(kMaxHandBalls * kBallVertices));
+        for (int b = 0; b < kMaxHandBalls; ++b) {
+            const float slot = static_cast<float>(b);
+            for (int i = 0; i < kHandBallRings; ++i) {
+                const float lat0 = PI * static_cast<float>(i) / kHandBallRings;
+                const float lat1 = PI * static_cast<float>(i + 1) / kHandBallRings;
+                for (int j = 0; j < kHandBallSlices; ++j) {
+                    const float lon0 = 2.0f * PI * static_cast<float>(j) / kHandBallSlices;
+                    const float lon1 = 2.0f * PI * static_cast<float>(j + 1) / kHandBallSlices;
+                    balls.insert(balls.end(), {{slot, lat0, lon0, 0.0f}, {slot, lat1, lon1, 0.0f}, {slot, lat1, lon0, 0.0f},
+                                               {slot, lat0, lon0, 0.0f}, {slot, lat0, lon1, 0.0f}, {slot, lat1, lon1, 0.0f}});
+                }
+            }
+        }
+
+        std::vector<Vector4> palm;
+        for (const HandTriangle& t : kHandTriangles) {
+            const float slot = static_cast<float>(t.slot);
+            palm.insert(palm.end(), {{static_cast<float>(t.a), slot, 0.0f, 0.0f}, {static_cast<float>(t.b), slot, 0.0f, 0.0f},
+                                     {static_cast<float>(t.c), slot, 0.0f, 0.0f}});
+        }
+        std::vector<Vector4> lines;
+        for (const HandLine& l : kHandLines) {
+            const float slot = static_cast<float>(l.slot);
+            lines.insert(lines.end(), {{static_cast<float>(l.a), slot, 0.0f, 0.0f}, {static_cast<float>(l.b), slot, 0.0f, 0.0f}});
+        }
+
+        using astro_render::ParametricPrimitive;
+        if (!tubes_.Init(kTubeShader, kFragmentShader, ParametricPrimitive::kTriangles, tubes) ||
+            !wires_.Init(kTubeShader, kFragmentShader, ParametricPrimitive::kLines, wires) ||
+            !balls_.Init(kBallShader, kFragmentShader, ParametricPrimitive::kTriangles, balls) ||
+            !palm_.Init(kPointShader, kFragmentShader, ParametricPrimitive::kTriangles, palm) ||
+            !lines_.Init(kPointShader, kFragmentShader, ParametricPrimitive::kLines, lines)) {
+            Unload();
+            return false;
+        }
+        tubeLocs_ = TubeLocations::Of(tubes_);
+        wireLocs_ = TubeLocations::Of(wires_);
+        palmLocs_ = PointLocations::Of(palm_);
+        lineLocs_ = PointLocations::Of(lines_);
+        ballLoc_ = balls_.Uniform("balls");
+        ballColorLoc_ = balls_.Uniform("colors");
+        return true;
+    }
+
+    void Unload() {
+        tubes_.Unload();
+        wires_.Unload();
+        balls_.Unload();
+        palm_.Unload();
+        lines_.Unload();
+    }
+
+    bool ready() const { return tubes_.ready() && wires_.ready() && balls_.ready() && palm_.ready() && lines_.ready(); }
+
+    // Same order as DrawHandShapesImmediate.
+    void Draw(const HandShapes& h) {
+        for (int i = 0; i < h.tubeCount; ++i) {
+            const HandTube& t = h.tubes[static_cast<size_t>(i)];
+            starts_[static_cast<size_t>(i)] = {t.a.x, t.a.y, t.a.z, t.ra};
+            ends_[static_cast<size_t>(i)] = {t.b.x, t.b.y, t.b.z, t.rb};
+            tubeColors_[static_cast<size_t>(i)] = ColorToVec4(t.color);
+        }
+        for (int i = 0; i < h.ballCount; ++i) {
+            const HandBall& b = h.balls[static_cast<size_t>(i)];
+            ballParams_[static_cast<size_t>(i)] = {b.center.x, b.center.y, b.center.z, b.radius};
+            ballColors_[static_cast<size_t>(i)] = ColorToVec4(b.color);
+        }
+        for (size_t i = 0; i < h.points.size(); ++i) points_[i] = {h.points[i].x, h.points[i].y, h.points[i].z, 1.0f};
+        for (size_t i = 0; i < h.palette.size(); ++i) palette_[i] = ColorToVec4(h.palette[i]);
+
+        DrawTubes(tubes_, tubeLocs_, h.tubeCount, kTubeVertices, {0.0f, 0.0f, 0.0f, -1.0f});
+        DrawTubes(wires_, wireLocs_, h.tubeCount, kWireVertices, ColorToVec4(Fade(BLACK, 0.25f)));
+        DrawPoints(palm_, palmLocs_);
+        DrawPoints(lines_, lineLocs_);
+        balls_.Begin();
+        balls_.SetVec4s(ballLoc_, ballParams_.data(), h.ballCount);
+        balls_.SetVec4s(ballColorLoc_, ballColors_.data(), h.ballCount);
+        balls_.Draw(0, h.ballCount * kBallVertices);
+        balls_.End();
+    }
+
+  private:
+    static constexpr int kTubeVertices = static_cast<int>(kBoneSides) * 12;
+    static constexpr int kWireVertices = static_cast<int>(kBoneSides) * 6;
+    static constexpr int kBallVertices = kHandBallRings * kHandBallSlices * 6;
+
+    struct TubeLocations {
+        int starts = -1;
+        int ends = -1;
+        int colors = -1;
+        int wireColor = -1;
+
+        static TubeLocations Of(const astro_render::ParametricMesh& mesh) {
+            return {mesh.Uniform("starts"), mesh.Uniform("ends"), mesh.Uniform("colors"), mesh.Uniform("wireColor")};
+        }
+    };
+
+    struct PointLocations {
+        int points = -1;
+        int palette = -1;
+
+        static PointLocations Of(const astro_render::ParametricMesh& mesh) {
+            return {mesh.Uniform("points"), mesh.Uniform("palette")};
+        }
+    };
+
+    void DrawTubes(const astro_render::ParametricMesh& mesh, const TubeLocations& locs, int count, int vertices,
+                   Vector4 wireColor) const {
+        mesh.Begin();
+        mesh.SetVec4s(locs.starts, starts_.data(), count);
+        mesh.SetVec4s(locs.ends, ends_.data(), count);
+        mesh.SetVec4s(locs.colors, tubeColors_.data(), count);
+        mesh.SetVec4(locs.wireColor, wireColor);
+        mesh.Draw(0, count * vertices);
+        mesh.End();
+    }
+
+    void DrawPoints(const astro_render::ParametricMesh& mesh, const PointLocations& locs) const {
+        mesh.Begin();
+        mesh.SetVec4s(locs.points, points_.data(), kHandPointCount);
+        mesh.SetVec4s(locs.palette, palette_.data(), kHandPaletteSize);
+        mesh.Draw();
+        mesh.End();
+    }
+
+    // vertexParams: tube slot, end (0 start, 1 end), angle around the axis, radial scale
+    // (0 on the axis for the caps).
+    static constexpr const char* kTubeShader = R"(#version 330
+in vec4 vertexParams;
+uniform mat4 mvp;
+uniform vec4 starts[32];  // centre, radius
+uniform vec4 ends[32];
+uniform vec4 colors[32];
+uniform vec4 wireColor;   // alpha < 0 for the surface
+out vec4 fragColor;
+void main() {
+    int i = int(vertexParams.x);
+    vec3 axis = ends[i].xyz - starts[i].xyz;
+    float len = length(axis);
+    vec3 dir = len > 1e-6 ? axis / len : vec3(0.0, 1.0, 0.0);
+    vec3 side = normalize(cross(dir, abs(dir.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 up = cross(dir, side);
+    float r = mix(starts[i].w, ends[i].w, vertexParams.y) * vertexParams.w;
+    vec3 p = mix(starts[i].xyz, ends[i].xyz, vertexParams.y) + r * (cos(vertexParams.z) * side + sin(vertexParams.z) * up);
+    gl_Position = mvp * vec4(p, 1.0);
+    fragColor = wireColor.a >= 0.0 ? wireColor : colors[i];
+}
+)";
+
+    // vertexParams: sphere slot, latitude, longitude.
+    static constexpr const char* kBallShader = R"(#version 330
+in vec4 vertexParams;
+uniform mat4 mvp;
+uniform vec4 balls[64];  // centre, radius
+uniform vec4 colors[64];
+out vec4 fragColor;
+void main() {
+    int i = int(vertexParams.x);
+    float s = sin(vertexParams.y);
+    vec3 n = vec3(s * cos(vertexParams.z), cos(vertexParams.y), s * sin(vertexParams.z));
+    gl_Position = mvp * vec4(balls[i].xyz + balls[i].w * n, 1.0);
+    fragColor = colors[i];
+}
+)";
+
+    // vertexParams: point index, palette slot.
+    static constexpr const char* kPointShader = R"(#version 330
+in vec4 vertexParams;
+uniform mat4 mvp;
+uniform vec4 points[32];
+uniform vec4 palette[16];
+out vec4 fragColor;
+void main() {
+    gl_Position = mvp * vec4(points[int(vertexParams.x)].xyz, 1.0);
+    fragColor = palette[int(vertexParams.y)];
+}
+)";
+
+    static constexpr const char* kFragmentShader = R"(#version 330
+in vec4 fragColor;
+out vec4 finalColor;
+void main() {
+    if (fragColor.a <= 0.0) discard;
+    finalColor = fragColor;
+}
+)";
+
+    astro_render::ParametricMesh tubes_;
+    astro_render::ParametricMesh wires_;
+    astro_render::ParametricMesh balls_;
+    astro_render::ParametricMesh palm_;
+    astro_render::ParametricMesh lines_;
+    std::array<Vector4, kMaxHandTubes> starts_{};
+    std::array<Vector4, kMaxHandTubes> ends_{};
+    std::array<Vector4, kMaxHandTubes> tubeColors_{};
+    std::array<Vector4, kMaxHandBalls> ballParams_{};
+    std::array<Vector4, kMaxHandBalls> ballColors_{};
+    std::array<Vector4, kHandPointCount> points_{};
+    std::array<Vector4, kHandPaletteSize> palette_{};
+    TubeLocations tubeLocs_;
+    TubeLocations wireLocs_;
+    PointLocations palmLocs_;
+    PointLocations lineLocs_;
+    int ballLoc_ = -1;
+    int ballColorLoc_ = -1;
+};
+
+}  // namespace
+
+// The mesh is built the first time a hand is drawn and stays resident for the life of
+// the GL context, like the starfield backdrops; without GL 3.3 the same shapes are
+// drawn in immediate mode.
+void DrawHandModel(const HandGeometry& g, const HandVisualStyle& style, bool showLandmarks, bool pinched) {
+    static HandMesh mesh;
+    static bool meshTried = false;
+    if (!meshTried) {
+        meshTried = true;
+        mesh.Init();
+    }
+    HandShapes shapes;
+    BuildHandShapes(g, style, showLandmarks, pinched, &shapes);
+    if (mesh.ready()) {
+        mesh.Draw(shapes);
+    } else {
+        DrawHandShapesImmediate(shapes);
+    }
+}
+
+void DrawHandModel(const HandGeometry& g, bool rightHand, bool showLandmarks, bool pinched) {
+    DrawHandModel(g, StyleForHand(rightHand), showLandmarks, pinched);
+}
+
+bool HandSceneBridge::Start() {
+    receiverOk_ = receiver_.Start(static_cast<uint16_t>(kUdpPort));
+    frameReceiverOk_ = frameReceiver_.Start(static_cast<uint16_t>(kFrameUdpPort));
+    if (receiverOk_ || frameReceiverOk_) {
+        stopNetwork_.store(false);
+        if (frameReceiverOk_) previewDecoder_.Start();
+        networkThread_ = std::thread([this]() { NetworkLoop(); });
+    }
+    return receiverOk_ || frameReceiverOk_;
+}
+
+void HandSceneBridge::Shutdown() {
+    stopNetwork_.store(true);
+    if (networkThread_.joinable()) networkThread_.join();
+    previewDecoder_.Stop();
+    receiver_.Close();
+    frameReceiver_.Close();
+    if (webcamTexture_.id > 0) {
+        UnloadTexture(webcamTexture_);
+        webcamTexture_ = Texture2D{};
+    }
+}
+
+void HandSceneBridge::Update(const Camera3D& camera, float now, float dt) {
+    const double steadyNow = SteadySeconds();
+    // EndDrawing() of the previous frame has returned, so whatever it drew is on screen.
+    if (lastUpdateSteady_ > 0.0) {
+        const float interval = std::clamp(static_cast<float>(steadyNow - lastUpdateSteady_), 1.0e-3f, 0.25f);
+        frameInterval_ = LerpFloat(frameInterval_, interval, 0.1f);
+    }
+    lastUpdateSteady_ = steadyNow;
+    if (shownReceivedAt_ > 0.0) {
+        const float latency = static_cast<float>(steadyNow - shownReceivedAt_);
+        displayLatency_ = displayLatency_ > 0.0f ? LerpFloat(displayLatency_, latency, 0.1f) : latency;
+        shownReceivedAt_ = 0.0;
+    }
+
+    if (trackingSlot_.Acquire()) {
+        const TrackingSample& sample = trackingSlot_.ReadBuffer();
+        // Filter in sender time: the capture spacing, not the jittery arrival spacing,
+        // unless the stamps are missing or jump.
+        const double span = sample.packet.timestamp - latestSample_.packet.timestamp;
+        const double arrivalSpan = sample.receivedAt - latestSample_.receivedAt;
+        const float packetDt = static_cast<float>(span > 1.0e-4 && span < 0.25 ? span : std::clamp(arrivalSpan, 1.0e-3, 0.25));
+        const auto filterHand = [&](const TrackedHandPacket& hand, size_t side) {
+            if (!hand.valid || !filterValid_[side]) landmarkFilter_[side].Reset();
+            if (hand.valid) landmarkFilter_[side].Update(hand.landmarks, packetDt, filterConfig_);
+            filterValid_[side] = hand.valid;
+        };
+        filterHand(sample.packet.left, 0);
+        filterHand(sample.packet.right, 1);
+        latestSample_ = sample;
+        lastPacketWallClock_ = now - static_cast<float>(steadyNow - sample.receivedAt);
+        shownReceivedAt_ = sample.receivedAt;
+    }
+    if (latestSample_.count > 0) {
+        // Predict to when this frame is expected on screen: about one frame from now.
+        const float ahead = static_cast<float>(steadyNow - latestSample_.receivedAt) + frameInterval_ + filterConfig_.extraLead;
+        predictionAhead_ = std::clamp(ahead, 0.0f, filterConfig_.maxPrediction);
+        tracking_ = latestSample_.packet;
+        if (filterValid_[0]) landmarkFilter_[0].Predict(predictionAhead_, filterConfig_.accelerationWeight, &tracking_.left.landmarks);
+        if (filterValid_[1]) landmarkFilter_[1].Predict(predictionAhead_, filterConfig_.accelerationWeight, &tracking_.right.landmarks);
+    }
+
+    if (previewDecoder_.Upload(webcamTexture_, now, kPreviewUpdateInterval)) lastFramePacketWallClock_ = now;
+
+    linkLive_ = receiver_.ready() && ((now - lastPacketWallClock_) < kLinkTimeout);
+    previewLive_ = frameReceiver_.ready() && webcamTexture_.id > 0 && ((now - lastFramePacketWallClock_) < kLinkTimeout);
+    leftTracked_ = linkLive_ && tracking_.left.valid;
+    rightTracked_ = linkLive_ && tracking_.right.valid;
+
+    Vector3 depthAxis = Vector3Subtract(camera.position, camera.target);
+    depthAxis.y *= 0.16f;
+    depthAxis = SafeNormalize(depthAxis, {0.72f, 0.08f, 0.69f});
+
+    if (leftTracked_) {
+        const HandGeometry target = BuildTrackedGeometry(tracking_.left, false);
+        liveGeometry_[0] = OffsetGeometry(target, Vector3Scale(depthAxis, EstimateTrackedDepthShift(tracking_.left)));
+    }
+    if (rightTracked_) {
+        const HandGeometry target = BuildTrackedGeometry(tracking_.right, true);
+        liveGeometry_[1] = OffsetGeometry(target, Vector3Scale(depthAxis, EstimateTrackedDepthShift(tracking_.right)));
+    }
+
+    UpdateControl(control_[0], liveGeometry_[0], leftTracked_, false, tracking_.left.score, tracking_.left.pinched, &prevAnchor_[0], &prevValid_[0], dt);
+    UpdateControl(control_[1], liveGeometry_[1], rightTracked_, true, tracking_.right.score, tracking_.right.pinched, &prevAnchor_[1], &prevValid_[1], dt);
+}
+
+void HandSceneBridge::DrawPreviewPanel(Rectangle panel, const char* title) const {
+    DrawRectangleRounded(panel, 0.06f, 10, Fade(BLACK, 0.38f));
+    DrawRectangleLinesEx(panel, 1.5f, Color{92, 110, 138, 255});
+    DrawText(title, static_cast<int>(panel.x) + 14, static_cast<int>(panel.y) + 12, 20, Color{222, 230, 244, 255});
+    if (previewLive_) {
+        const Rectangle src = {0.0f, 0.0f, static_cast<float>(webcamTexture_.width), static_cast<float>(webcamTexture_.height)};
+        const Rectangle dst = {panel.x + 12.0f, panel.y + 42.0f, panel.width - 24.0f, panel.height - 54.0f};
+        DrawTexturePro(webcamTexture_, src, dst, {0.0f, 0.0f}, 0.0f, WHITE);
+    } else {
+        DrawRectangle(static_cast<int>(panel.x) + 12, static_cast<int>(panel.y) + 42, static_cast<int>(panel.width) - 24, static_cast<int>(panel.height) - 54, Color{20, 24, 32, 255});
+        const char* previewStatus = !frameReceiverOk_ ? "preview receiver failed" : "waiting for webcam preview";
+        DrawText(previewStatus, static_cast<int>(panel.x) + 24, static_cast<int>(panel.y) + 122, 18, Color{180, 194, 214, 255});
+    }
+}
+
+void HandSceneBridge::NetworkLoop() {
+    TrackingPacket packet{};
+    std::vector<unsigned char> frame;
+    uint64_t count = 0;
+    while (!stopNetwork_.load(std::memory_order_relaxed)) {
+        WaitForSockets(receiver_.socketHandle(), frameReceiver_.socketHandle(), 20);
+
+        int packetsRead = 0;
+        if (receiver_.Poll(packet, packetsRead)) {
+            TrackingSample& sample = trackingSlot_.WriteBuffer();
+            sample.packet = packet;
+            sample.receivedAt = SteadySeconds();
+            sample.count = ++count;
+            if (packetListener_) packetListener_(sample);
+            trackingSlot_.Publish();
+        }
+
+        int framePacketsRead = 0;
+        if (frameReceiver_.Poll(frame, framePacketsRead)) previewDecoder_.Submit(frame);
+    }
+}
+
+void HandSceneBridge::UpdateControl(
+    HandControlState& out,
+    const HandGeometry& g,
+    bool active,
+    bool rightHand,
+    float score,
+    bool pinched,
+    Vector3* prevAnchor,
+    bool* prevValid,
+    float dt) {
+    out.active = active;
+    out.pinched = pinched;
+    out.rightHand = rightHand;
+    out.score = score;
+    if (!active) {
+        out.velocity = {0.0f, 0.0f, 0.0f};
+        out.palmSize = 0.0f;
+        *prevValid = false;
+        return;
+    }
+
+    out.wrist = g.landmarks[0];
+    out.palm = g.palmCenter;
+    out.thumbTip = g.landmarks[4];
+    out.indexTip = g.landmarks[8];
+    out.pinchPoint = Vector3Scale(Vector3Add(out.indexTip, out.thumbTip), 0.5f);
+    out.palmSize = Vector3Distance(g.landmarks[0], g.landmarks[9]);
+
+    const Vector3 anchor = pinched ? out.pinchPoint : out.palm;
+    if (*prevValid && dt > 1.0e-4f) {
+        out.velocity = Vector3Scale(Vector3Subtract(anchor, *prevAnchor), 1.0f / dt);
+    } else {
+        out.velocity = {0.0f, 0.0f, 0.0f};
+    }
+    *prevAnchor = anchor;
+    *prevValid = true;
+}
+
+void DrawBridgeStatus(const HandSceneBridge& bridge, int x, int y) {
+    const char* bridgeStatus =
+        !bridge.ReceiverOk() ? "bridge: UDP receiver failed to start"
+        : bridge.AnyTracked() ? TextFormat("bridge: tracking live on udp:%d%s  packet to screen %.0f ms, predicted %.0f ms",
+                                           kUdpPort, bridge.ReceiverShared() ? " (shared)" : "",
+                                           1000.0f * bridge.DisplayLatency(), 1000.0f * bridge.PredictionAhead())
+        : TextFormat("bridge: idle on udp:%d%s  run AstroPhysics/vision/hand_biomechanics_bridge.py", kUdpPort,
+                     bridge.ReceiverShared() ? " (shared)" : "");
+    DrawText(bridgeStatus, x, y, 18, bridge.AnyTracked() ? Color{142, 255, 190, 255} : Color{188, 198, 220, 255});
+}
+
+// Each (count, seed, colour) set is baked into a starfield layer the first time it is
+// drawn; the few sets a scene uses stay resident for the life of the GL context.
+void DrawStarfieldBackdrop(int count, unsigned int seed, float drift, Color baseColor) {
+    struct Backdrop {
+        int count;
+        unsigned int seed;
+        Color color;
+        astro_render::StarfieldLayer layer;
+    };
+    static std::vector<std::unique_ptr<Backdrop>> backdrops;
+    constexpr size_t kMaxBackdrops = 8;
+
+    Backdrop* backdrop = nullptr;
+    for (const std::unique_ptr<Backdrop>& entry : backdrops) {
+        if (entry->count == count && entry->seed == seed && entry->color.r == baseColor.r && entry->color.g == baseColor.g &&
+            entry->color.b == baseColor.b && entry->color.a == baseColor.a) {
+            backdrop = entry.get();
+            break;
+        }
+    }
+    if (backdrop == nullptr) {
+        if (backdrops.size() == kMaxBackdrops) {
+            backdrops.front()->layer.Unload();
+            backdrops.erase(backdrops.begin());
+        }
+        // Alpha was 0.35 + 0.55 * (0.55 + 0.45 * sin(...)): mean 0.6525, swing 0.2475.
+        std::vector<astro_render::StarfieldStar> stars;
+        stars.reserve(static_cast<size_t>(std::max(0, count)));
+        for (int i = 0; i < count; ++i) {
+            const float sx = static_cast<float>((seed * 1103515245u + static_cast<unsigned int>(i * 7919)) % 10000) / 10000.0f;
+            const float sy = static_cast<float>((seed * 214013u + static_cast<unsigned int>(i * 4051)) % 10000) / 10000.0f;
+            Color color = baseColor;
+            color.a = static_cast<unsigned char>(255.0f * 0.6525f);
+            stars.push_back({{sx, sy, 0.0f}, 0.8f + 1.9f * sx, color, 0.8f + 0.05f * static_cast<float>(i), 9.0f * sx,
+                             0.2475f / 0.6525f, 0.0f});
+        }
+        backdrops.push_back(std::unique_ptr<Backdrop>(new Backdrop{count, seed, baseColor, {}}));
+        backdrop = backdrops.back().get();
+        backdrop->layer.Init(astro_render::StarfieldSpace::kScreen, stars);
+    }
+    backdrop->layer.Draw(drift);
+}
+
+}  // namespace astro_hand
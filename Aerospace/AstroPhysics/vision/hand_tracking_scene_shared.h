@@ -5,28 +5,30 @@
 
 #include <algorithm>
 #include <array>
-#include <cerrno>
-#include <cmath>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
-#include <cstdlib>
-#include <string>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <thread>
+#include <utility>
 #include <vector>
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "Ws2_32.lib")
-#else
-#include <arpa/inet.h>
-#include <fcntl.h>
-#include <sys/socket.h>
-#include <unistd.h>
-#endif
+// Webcam hand-tracking support shared by the hand-driven demos: UDP receivers for
+// the Python bridges, the preview decoder, and hand geometry / rendering. Built once
+// as the `astro_hand` static library (hand_tracking_scene_shared.cpp); link it
+// instead of compiling this code into every demo.
 
 namespace astro_hand {
 
 constexpr int kUdpPort = 50515;
 constexpr int kFrameUdpPort = 50516;
+constexpr int kBridgeUdpPort = 50505;
+// Loopback multicast group hand_biomechanics_bridge.py sends landmarks and preview
+// frames to, so one tracker process can feed several scenes at once.
+constexpr const char* kHandMulticastGroup = "239.255.50.15";
 constexpr float kLinkTimeout = 0.75f;
 constexpr float kTrackedDepthPalmRef = 0.155f;
 constexpr float kTrackedDepthRange = 5.4f;
@@ -34,6 +36,9 @@ constexpr float kTrackedHandModelScale = 0.18f;
 constexpr float kBoneSides = 8.0f;
 constexpr float kJointSphereScale = 1.18f;
 constexpr float kPreviewUpdateInterval = 1.0f / 24.0f;
+// Tracked landmarks are predicted ahead to display time by at most this much (seconds).
+constexpr float kMaxTrackingExtrapolation = 0.05f;
+constexpr int kLandmarkCount = 21;
 
 struct TrackedHandPacket {
     bool valid = false;
@@ -44,235 +49,294 @@ struct TrackedHandPacket {
 
 struct TrackingPacket {
     double timestamp = 0.0;
+    uint32_t sequence = 0;
     TrackedHandPacket left{};
     TrackedHandPacket right{};
 };
 
+// Binary tracking datagram, all fields little-endian:
+//   u32 magic 'AHTP' | u16 version | u16 flags | u32 sequence | u32 crc32(payload)
+//   payload: f64 timestamp, then per hand (left, right) f32 score + 21 x f32 xyz.
+// flags: bit0 left valid, bit1 left pinched, bit2 right valid, bit3 right pinched.
+// The CSV text format stays accepted for bridges that have not switched yet.
+constexpr uint32_t kTrackingMagic = 0x50544841u;  // "AHTP"
+constexpr uint16_t kTrackingVersion = 1;
+constexpr size_t kTrackingHeaderBytes = 16;
+constexpr size_t kTrackingHandBytes = 4 * (1 + 21 * 3);
+constexpr size_t kTrackingPayloadBytes = 8 + 2 * kTrackingHandBytes;
+constexpr size_t kTrackingPacketBytes = kTrackingHeaderBytes + kTrackingPayloadBytes;
+
+inline uint32_t LoadLE32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint16_t LoadLE16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline float LoadLEFloat(const unsigned char* p) {
+    const uint32_t bits = LoadLE32(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline double LoadLEDouble(const unsigned char* p) {
+    const uint64_t bits = static_cast<uint64_t>(LoadLE32(p)) | (static_cast<uint64_t>(LoadLE32(p + 4)) << 32);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Standard CRC-32 (IEEE 802.3, reflected), the same as Python's zlib.crc32.
+uint32_t Crc32(const unsigned char* data, size_t size);
+bool DecodeBinaryTrackingPacket(const unsigned char* data, size_t size, TrackingPacket& outPacket);
+// Heap-free parse of the legacy CSV datagram (133 values); `text` must be NUL-terminated.
+bool ParseTextTrackingPacket(const char* text, TrackingPacket& outPacket);
+
 class UdpHandReceiver {
   public:
-    bool Start(uint16_t port) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return false;
-#endif
-        socket_ = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
-        if (socket_ < 0) return false;
-
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        addr.sin_port = htons(port);
-        if (bind(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
-            Close();
-            return false;
-        }
-
-#ifdef _WIN32
-        u_long mode = 1;
-        if (ioctlsocket(socket_, FIONBIO, &mode) != 0) {
-            Close();
-            return false;
-        }
-#else
-        const int flags = fcntl(socket_, F_GETFL, 0);
-        if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0) {
-            Close();
-            return false;
-        }
-#endif
-        ready_ = true;
-        return true;
-    }
-
-    void Close() {
-        if (socket_ >= 0) {
-#ifdef _WIN32
-            closesocket(socket_);
-            WSACleanup();
-#else
-            close(socket_);
-#endif
-            socket_ = -1;
-        }
-        ready_ = false;
-    }
+    // Subscribes to `multicastGroup` on a shared port, or binds the port alone when
+    // the group is null or cannot be joined.
+    bool Start(uint16_t port, const char* multicastGroup = kHandMulticastGroup);
+    void Close();
 
     ~UdpHandReceiver() {
         Close();
     }
 
-    bool Poll(TrackingPacket& outPacket, int& packetsRead) {
-        packetsRead = 0;
-        if (!ready_) return false;
-
-        bool gotAny = false;
-        std::array<char, 4096> buffer{};
-        while (true) {
-            sockaddr_in src{};
-            socklen_t srcLen = sizeof(src);
-            const int n = recvfrom(
-                socket_,
-                buffer.data(),
-                static_cast<int>(buffer.size()) - 1,
-                0,
-                reinterpret_cast<sockaddr*>(&src),
-                &srcLen);
-            if (n <= 0) {
-#ifdef _WIN32
-                if (WSAGetLastError() == WSAEWOULDBLOCK) break;
+    bool Poll(TrackingPacket& outPacket, int& packetsRead);
+
+    bool ready() const { return ready_; }
+    bool multicast() const { return multicast_; }
+    int socketHandle() const { return socket_; }
+    // Datagrams rejected as malformed, corrupt, or older than the last binary sequence.
+    uint32_t rejectedPackets() const { return rejected_; }
+
+  private:
+#if defined(__linux__)
+    static constexpr size_t kBatch = 16;
 #else
-                if (errno == EWOULDBLOCK || errno == EAGAIN) break;
+    static constexpr size_t kBatch = 1;
 #endif
-                break;
-            }
-
-            buffer[static_cast<size_t>(n)] = '\0';
-            TrackingPacket parsed{};
-            if (ParsePacket(buffer.data(), parsed)) {
-                outPacket = parsed;
-                gotAny = true;
-                packetsRead++;
-            }
-        }
-        return gotAny;
+
+    bool DecodePacket(char* buffer, size_t n, TrackingPacket& outPacket);
+
+    int socket_ = -1;
+    bool ready_ = false;
+    bool multicast_ = false;
+    bool haveSequence_ = false;
+    uint32_t lastSequence_ = 0;
+    uint32_t rejected_ = 0;
+    std::array<std::array<char, 4096>, kBatch> buffers_;
+};
+
+// Preview frames too large for one datagram arrive as chunks, little-endian:
+//   u32 magic 'AHFC' | u16 version | u16 chunkIndex | u16 chunkCount | u16 reserved
+//   u32 frameId | u32 frameBytes | u32 offset, then this chunk's slice of the JPEG.
+// A datagram without the magic is taken as a whole JPEG (single-datagram senders).
+constexpr uint32_t kFrameChunkMagic = 0x43464841u;  // "AHFC"
+constexpr uint16_t kFrameChunkVersion = 1;
+constexpr size_t kFrameChunkHeaderBytes = 24;
+constexpr uint32_t kMaxPreviewFrameBytes = 8u << 20;
+
+class UdpFrameReceiver {
+  public:
+    // As UdpHandReceiver::Start().
+    bool Start(uint16_t port, const char* multicastGroup = kHandMulticastGroup);
+    void Close();
+
+    ~UdpFrameReceiver() {
+        Close();
     }
 
+    bool Poll(std::vector<unsigned char>& outFrameBytes, int& packetsRead);
+
     bool ready() const { return ready_; }
+    bool multicast() const { return multicast_; }
+    int socketHandle() const { return socket_; }
+    // Partly received frames abandoned because a newer frame started first.
+    uint32_t droppedFrames() const { return droppedFrames_; }
+    // Chunks discarded as malformed, duplicated, or belonging to an older frame.
+    uint32_t droppedChunks() const { return droppedChunks_; }
 
   private:
-    static bool ParsePacket(const char* text, TrackingPacket& outPacket) {
-        std::vector<float> values;
-        values.reserve(133);
-
-        const char* p = text;
-        char* end = nullptr;
-        while (*p != '\0') {
-            const float value = std::strtof(p, &end);
-            if (end == p) {
-                if (*p == ',' || *p == '\n' || *p == '\r' || *p == ' ' || *p == '\t') {
-                    ++p;
-                    continue;
-                }
-                return false;
-            }
-            values.push_back(value);
-            p = end;
-            while (*p == ',' || *p == '\n' || *p == '\r' || *p == ' ' || *p == '\t') ++p;
-        }
-
-        if (values.size() < 133) return false;
-
-        outPacket.timestamp = static_cast<double>(values[0]);
-        auto readHand = [&](size_t start, TrackedHandPacket& hand) {
-            hand.valid = values[start] > 0.5f;
-            hand.pinched = values[start + 1] > 0.5f;
-            hand.score = values[start + 2];
-            size_t idx = start + 3;
-            for (Vector3& point : hand.landmarks) {
-                point = {values[idx], values[idx + 1], values[idx + 2]};
-                idx += 3;
-            }
-        };
-
-        readHand(1, outPacket.left);
-        readHand(67, outPacket.right);
-        return true;
+    // Returns true when `data` completes a frame; the frame is swapped into `outFrameBytes`,
+    // whose old storage becomes the next assembly buffer.
+    bool AcceptDatagram(const unsigned char* data, size_t n, std::vector<unsigned char>& outFrameBytes);
+
+    int socket_ = -1;
+    bool ready_ = false;
+    bool multicast_ = false;
+    bool assembling_ = false;
+    bool haveFrameId_ = false;
+    uint32_t frameId_ = 0;
+    size_t chunksLeft_ = 0;
+    uint32_t droppedFrames_ = 0;
+    uint32_t droppedChunks_ = 0;
+    std::vector<unsigned char> assembly_;
+    std::vector<uint8_t> chunkSeen_;
+    std::array<unsigned char, 65536> buffer_;
+};
+
+// Normalized 2D hand positions from the lightweight CSV bridges
+// (vision/two_hand_bridge.py, DefensiveSys/hand_turret_sim.py):
+//   timestamp,left_valid,left_x,left_y,right_valid,right_pinch[,right_x,right_y,left_pinch]
+struct BridgeInput {
+    bool leftValid = false;
+    float leftX = 0.5f;
+    float leftY = 0.5f;
+    bool rightValid = false;
+    bool rightPinch = false;
+    float rightX = 0.5f;
+    float rightY = 0.5f;
+    bool leftPinch = false;
+    double timestamp = 0.0;
+};
+
+bool ParseBridgeInput(const char* text, BridgeInput& outInput);
+
+// Linear extrapolation of the normalized hand positions `ahead` seconds past `current`,
+// with velocity from the sender timestamps.
+BridgeInput ExtrapolateBridgeInput(const BridgeInput& previous, const BridgeInput& current, float ahead);
+
+class UdpBridgeReceiver {
+  public:
+    bool Start(uint16_t port);
+    void Close();
+
+    ~UdpBridgeReceiver() {
+        Close();
     }
 
+    bool Poll(BridgeInput& outInput, int& packetsRead);
+
+    bool ready() const { return ready_; }
+    int socketHandle() const { return socket_; }
+
+  private:
     int socket_ = -1;
     bool ready_ = false;
+    std::array<char, 256> buffer_;
 };
 
-class UdpFrameReceiver {
+// Single-producer / single-consumer latest-value slot. The writer fills
+// WriteBuffer() and calls Publish(); the reader calls Acquire() and, when it returns
+// true, owns ReadBuffer() until the next Acquire(). Neither side ever blocks.
+template <typename T>
+class TripleBuffer {
   public:
-    bool Start(uint16_t port) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return false;
-#endif
-        socket_ = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
-        if (socket_ < 0) return false;
-
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        addr.sin_port = htons(port);
-        if (bind(socket_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
-            Close();
-            return false;
-        }
-
-#ifdef _WIN32
-        u_long mode = 1;
-        if (ioctlsocket(socket_, FIONBIO, &mode) != 0) {
-            Close();
-            return false;
-        }
-#else
-        const int flags = fcntl(socket_, F_GETFL, 0);
-        if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0) {
-            Close();
-            return false;
-        }
-#endif
-        ready_ = true;
-        return true;
+    T& WriteBuffer() { return buffers_[back_]; }
+
+    void Publish() {
+        back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
     }
 
-    void Close() {
-        if (socket_ >= 0) {
-#ifdef _WIN32
-            closesocket(socket_);
-            WSACleanup();
-#else
-            close(socket_);
-#endif
-            socket_ = -1;
-        }
-        ready_ = false;
+    bool Acquire() {
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
     }
 
-    ~UdpFrameReceiver() {
-        Close();
+    T& ReadBuffer() { return buffers_[front_]; }
+
+  private:
+    static constexpr unsigned kIndexMask = 3u;
+    static constexpr unsigned kFresh = 4u;
+
+    std::array<T, 3> buffers_{};
+    std::atomic<unsigned> middle_{1u};
+    unsigned back_ = 0u;   // writer side
+    unsigned front_ = 2u;  // reader side
+};
+
+// Single-producer / single-consumer FIFO of N (a power of two) values. Push() fails
+// when the ring is full and Pop() when it is empty; neither side ever blocks.
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+  public:
+    bool Push(const T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == N) return false;
+        slots_[head & (N - 1)] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
     }
 
-    bool Poll(std::vector<unsigned char>& outFrameBytes, int& packetsRead) {
-        packetsRead = 0;
-        if (!ready_) return false;
-
-        bool gotAny = false;
-        std::array<unsigned char, 65536> buffer{};
-        while (true) {
-            sockaddr_in src{};
-            socklen_t srcLen = sizeof(src);
-            const int n = recvfrom(
-                socket_,
-                reinterpret_cast<char*>(buffer.data()),
-                static_cast<int>(buffer.size()),
-                0,
-                reinterpret_cast<sockaddr*>(&src),
-                &srcLen);
-            if (n <= 0) {
-#ifdef _WIN32
-                if (WSAGetLastError() == WSAEWOULDBLOCK) break;
-#else
-                if (errno == EWOULDBLOCK || errno == EAGAIN) break;
-#endif
-                break;
-            }
-
-            outFrameBytes.assign(buffer.begin(), buffer.begin() + n);
-            gotAny = true;
-            packetsRead++;
-        }
-        return gotAny;
+    bool Pop(T* out) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        *out = slots_[tail & (N - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
     }
 
-    bool ready() const { return ready_; }
+  private:
+    std::array<T, N> slots_{};
+    alignas(64) std::atomic<size_t> head_{0};  // writer side
+    alignas(64) std::atomic<size_t> tail_{0};  // reader side
+};
+
+double SteadySeconds();
+
+// Newest decoded packet and the local steady-clock time it arrived.
+struct TrackingSample {
+    TrackingPacket packet{};
+    double receivedAt = 0.0;
+    uint64_t count = 0;
+};
+
+// Newest bridge input and the local steady-clock time it arrived.
+struct BridgeSample {
+    BridgeInput input{};
+    double receivedAt = 0.0;
+    uint64_t count = 0;
+};
+
+// Blocks until one of the sockets is readable or timeoutMs passes.
+void WaitForSockets(int a, int b, int timeoutMs);
+
+// One Euro filter (Casiez, Roussel and Vogel, CHI 2012): a low-pass whose cutoff rises
+// with speed, so a resting hand holds still and a fast pinch is not dragged behind.
+// Cutoffs are in Hz; beta is Hz per (normalized image unit / s) of speed.
+struct OneEuroParams {
+    float minCutoff = 1.0f;
+    float beta = 8.0f;
+    float derivativeCutoff = 1.0f;
+};
+
+// How a scene trades jitter against lag (HandSceneBridge::SetFilter). Filtered landmarks
+// are predicted to the time the frame being built reaches the screen, plus `extraLead`
+// for the camera exposure and bridge processing that happen before a packet is sent.
+struct HandFilterConfig {
+    OneEuroParams landmarks{};
+    float velocityCutoff = 8.0f;      // Hz, low-pass on the prediction's velocity and acceleration
+    float accelerationWeight = 0.5f;  // 0 constant velocity, 1 constant acceleration
+    float extraLead = 0.0f;
+    float maxPrediction = kMaxTrackingExtrapolation;
+};
+
+// One Euro filter over the 21 landmarks of one hand, stepped once per packet with the
+// sender's timestamps, plus the velocity and acceleration of the filtered points.
+class LandmarkFilter {
+  public:
+    void Reset() { primed_ = 0; }
+
+    // Filters a packet `dt` seconds after the previous one.
+    void Update(const std::array<Vector3, kLandmarkCount>& raw, float dt, const HandFilterConfig& config);
+
+    // The filtered landmarks `ahead` seconds past the last packet.
+    void Predict(float ahead, float accelerationWeight, std::array<Vector3, kLandmarkCount>* out) const;
 
   private:
-    int socket_ = -1;
-    bool ready_ = false;
+    std::array<Vector3, kLandmarkCount> position_{};
+    std::array<Vector3, kLandmarkCount> derivative_{};  // One Euro speed estimate
+    std::array<Vector3, kLandmarkCount> velocity_{};
+    std::array<Vector3, kLandmarkCount> acceleration_{};
+    int primed_ = 0;  // packets seen: velocity needs two, acceleration three
 };
 
 inline float Clamp01(float v) {
@@ -294,33 +358,50 @@ inline Vector3 Average(const std::initializer_list<Vector3>& pts) {
     return Vector3Scale(sum, 1.0f / static_cast<float>(pts.size()));
 }
 
-inline float LandmarkPalmNorm(const std::array<Vector3, 21>& pts) {
-    const auto dist2 = [&](int a, int b) {
-        const float dx = pts[static_cast<size_t>(a)].x - pts[static_cast<size_t>(b)].x;
-        const float dy = pts[static_cast<size_t>(a)].y - pts[static_cast<size_t>(b)].y;
-        return std::sqrt(dx * dx + dy * dy);
-    };
-    return std::max(1.0e-4f, (dist2(0, 5) + dist2(0, 17) + dist2(5, 17)) / 3.0f);
-}
+float LandmarkPalmNorm(const std::array<Vector3, 21>& pts);
+
+// Decodes on the calling thread; prefer PreviewDecoder on the render path.
+bool UpdatePreviewTexture(Texture2D& texture, const std::vector<unsigned char>& jpgBytes);
+
+struct DecodedPreview {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> rgba;
+};
+
+// Decodes preview JPEGs on a worker thread into reused RGBA buffers, so the render
+// thread only uploads pixels. Submit() may be called from one producer thread;
+// Upload() belongs to the render thread. Frames submitted faster than they decode,
+// or decoded faster than they are shown, are skipped in favour of the newest one.
+class PreviewDecoder {
+  public:
+    void Start();
+    void Stop();
 
-inline bool UpdatePreviewTexture(Texture2D& texture, const std::vector<unsigned char>& jpgBytes) {
-    if (jpgBytes.empty()) return false;
-    Image image = LoadImageFromMemory(".jpg", jpgBytes.data(), static_cast<int>(jpgBytes.size()));
-    if (image.data == nullptr) return false;
-
-    if (texture.id > 0 && texture.width == image.width && texture.height == image.height) {
-        UpdateTexture(texture, image.data);
-    } else {
-        if (texture.id > 0) {
-            UnloadTexture(texture);
-            texture = Texture2D{};
-        }
-        texture = LoadTextureFromImage(image);
-        SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+    ~PreviewDecoder() {
+        Stop();
     }
-    UnloadImage(image);
-    return texture.id > 0;
-}
+
+    // Hands over a complete JPEG; `jpegBytes` gets back a spare buffer to fill next.
+    void Submit(std::vector<unsigned char>& jpegBytes);
+
+    // Uploads the newest decoded frame, at most once per `interval` seconds once a
+    // texture exists. Returns true when the texture changed.
+    bool Upload(Texture2D& texture, float now, float interval);
+
+  private:
+    void WorkerLoop();
+    static bool Decode(const std::vector<unsigned char>& jpegBytes, DecodedPreview& out);
+
+    TripleBuffer<std::vector<unsigned char>> jpegSlot_{};
+    TripleBuffer<DecodedPreview> decodedSlot_{};
+    std::thread worker_{};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    bool pending_ = false;
+    float lastUpload_ = -100.0f;
+};
 
 struct HandGeometry {
     std::array<Vector3, 21> landmarks{};
@@ -331,116 +412,17 @@ struct HandGeometry {
     Vector3 wristRight{};
 };
 
-inline HandGeometry BlendGeometry(const HandGeometry& a, const HandGeometry& b, float t) {
-    HandGeometry out{};
-    for (size_t i = 0; i < out.landmarks.size(); ++i) {
-        out.landmarks[i] = Vector3Lerp(a.landmarks[i], b.landmarks[i], t);
-        out.radii[i] = LerpFloat(a.radii[i], b.radii[i], t);
-    }
-    for (size_t i = 0; i < out.palmRim.size(); ++i) out.palmRim[i] = Vector3Lerp(a.palmRim[i], b.palmRim[i], t);
-    out.palmCenter = Vector3Lerp(a.palmCenter, b.palmCenter, t);
-    out.wristLeft = Vector3Lerp(a.wristLeft, b.wristLeft, t);
-    out.wristRight = Vector3Lerp(a.wristRight, b.wristRight, t);
-    return out;
-}
-
-inline HandGeometry OffsetGeometry(const HandGeometry& g, Vector3 offset) {
-    HandGeometry out = g;
-    for (Vector3& point : out.landmarks) point = Vector3Add(point, offset);
-    for (Vector3& point : out.palmRim) point = Vector3Add(point, offset);
-    out.palmCenter = Vector3Add(out.palmCenter, offset);
-    out.wristLeft = Vector3Add(out.wristLeft, offset);
-    out.wristRight = Vector3Add(out.wristRight, offset);
-    return out;
-}
-
-inline float EstimateTrackedDepthShift(const TrackedHandPacket& packet) {
-    const float palm = LandmarkPalmNorm(packet.landmarks);
-    const float relative = std::clamp((kTrackedDepthPalmRef / palm) - 1.0f, -0.55f, 0.90f);
-    return -relative * kTrackedDepthRange;
-}
+HandGeometry BlendGeometry(const HandGeometry& a, const HandGeometry& b, float t);
+HandGeometry OffsetGeometry(const HandGeometry& g, Vector3 offset);
+float EstimateTrackedDepthShift(const TrackedHandPacket& packet);
 
 inline float HandVisualScale(const HandGeometry& g) {
     return std::max(0.14f, g.radii[0] / 0.34f);
 }
 
-inline HandGeometry BuildTrackedGeometry(const TrackedHandPacket& packet, bool rightHand) {
-    HandGeometry g{};
-    constexpr std::array<float, 21> kRadii = {
-        0.34f, 0.24f, 0.22f, 0.19f, 0.16f,
-        0.23f, 0.20f, 0.17f, 0.14f,
-        0.23f, 0.20f, 0.17f, 0.14f,
-        0.21f, 0.18f, 0.15f, 0.12f,
-        0.19f, 0.16f, 0.13f, 0.10f,
-    };
-
-    const Vector3 wristNorm = packet.landmarks[0];
-    const Vector3 indexNorm = packet.landmarks[5];
-    const Vector3 pinkyNorm = packet.landmarks[17];
-    const Vector3 middleNorm = packet.landmarks[9];
-    const Vector3 ringNorm = packet.landmarks[13];
-    const Vector3 sideKnuckleCenterNorm = Vector3Scale(Vector3Add(indexNorm, pinkyNorm), 0.5f);
-    const Vector3 rootAnchorNorm = Vector3Add(Vector3Scale(wristNorm, 0.88f), Vector3Scale(sideKnuckleCenterNorm, 0.12f));
-    const float palm = LandmarkPalmNorm(packet.landmarks);
-
-    const Vector3 origin = {
-        (rootAnchorNorm.x - 0.50f) * 24.0f + (rightHand ? 0.4f : -0.4f),
-        2.6f + (0.66f - rootAnchorNorm.y) * 8.2f,
-        rightHand ? 0.45f : -0.45f,
-    };
-
-    const float xyScale = (3.8f / palm) * kTrackedHandModelScale;
-    const float zScale = (5.2f / palm) * kTrackedHandModelScale;
-
-    for (size_t i = 0; i < g.landmarks.size(); ++i) {
-        const Vector3 rel = Vector3Subtract(packet.landmarks[i], rootAnchorNorm);
-        const Vector3 local = {
-            rel.x * xyScale,
-            -rel.y * xyScale,
-            -rel.z * zScale,
-        };
-        g.landmarks[i] = Vector3Add(origin, local);
-        g.radii[i] = kRadii[i] * kTrackedHandModelScale;
-    }
-
-    const Vector3 across = Vector3Subtract(g.landmarks[17], g.landmarks[5]);
-    const Vector3 wristAxis = SafeNormalize(across, {1.0f, 0.0f, 0.0f});
-    const Vector3 forearmDir = SafeNormalize(Vector3Subtract(g.landmarks[0], Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]})), {0.0f, -1.0f, 0.0f});
-
-    g.wristLeft = Vector3Add(Vector3Add(g.landmarks[0], Vector3Scale(wristAxis, -0.88f * kTrackedHandModelScale)), Vector3Scale(forearmDir, 0.18f * kTrackedHandModelScale));
-    g.wristRight = Vector3Add(Vector3Add(g.landmarks[0], Vector3Scale(wristAxis, 0.88f * kTrackedHandModelScale)), Vector3Scale(forearmDir, 0.18f * kTrackedHandModelScale));
-    g.palmRim = {
-        g.wristLeft,
-        g.landmarks[1],
-        g.landmarks[5],
-        g.landmarks[9],
-        g.landmarks[13],
-        g.landmarks[17],
-        g.wristRight,
-    };
-    g.palmCenter = Average({g.landmarks[0], g.landmarks[1], g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]});
-    return g;
-}
-
-inline void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance) {
-    if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-        const Vector2 d = GetMouseDelta();
-        *yaw -= d.x * 0.0032f;
-        *pitch += d.y * 0.0030f;
-        *pitch = std::clamp(*pitch, -1.35f, 1.35f);
-    }
+HandGeometry BuildTrackedGeometry(const TrackedHandPacket& packet, bool rightHand);
 
-    *distance -= GetMouseWheelMove() * 0.7f;
-    *distance = std::clamp(*distance, 6.0f, 34.0f);
-
-    const float cp = std::cos(*pitch);
-    const Vector3 offset = {
-        *distance * cp * std::cos(*yaw),
-        *distance * std::sin(*pitch),
-        *distance * cp * std::sin(*yaw),
-    };
-    camera->position = Vector3Add(camera->target, offset);
-}
+void UpdateOrbitCameraDragOnly(Camera3D* camera, float* yaw, float* pitch, float* distance, float maxDistance = 34.0f);
 
 struct HandVisualStyle {
     Color palm{};
@@ -451,137 +433,19 @@ struct HandVisualStyle {
     Color shadow{};
 };
 
-inline HandVisualStyle StyleForHand(bool rightHand) {
-    if (rightHand) {
-        return HandVisualStyle{Color{236, 184, 146, 255}, Color{212, 155, 118, 255}, Color{248, 212, 176, 255},
-                               Color{142, 96, 74, 255}, Color{255, 210, 126, 255}, Color{76, 44, 28, 120}};
-    }
-    return HandVisualStyle{Color{150, 190, 236, 255}, Color{112, 156, 214, 255}, Color{188, 220, 255, 255},
-                           Color{74, 98, 148, 255}, Color{132, 224, 255, 255}, Color{28, 40, 76, 120}};
-}
-
-inline void DrawBone(Vector3 a, Vector3 b, float ra, float rb, Color color) {
-    DrawCylinderEx(a, b, ra, rb, static_cast<int>(kBoneSides), color);
-    DrawCylinderWiresEx(a, b, ra, rb, static_cast<int>(kBoneSides), Fade(BLACK, 0.25f));
-}
-
-inline void DrawPalmSurface(const HandGeometry& g, Color palmColor, Color highlightColor) {
-    for (size_t i = 0; i + 1 < g.palmRim.size(); ++i) DrawTriangle3D(g.palmCenter, g.palmRim[i], g.palmRim[i + 1], palmColor);
-    const Color webColor = Fade(palmColor, 0.92f);
-    DrawTriangle3D(g.landmarks[1], g.landmarks[5], g.landmarks[6], webColor);
-    DrawTriangle3D(g.landmarks[5], g.landmarks[9], g.landmarks[6], webColor);
-    DrawTriangle3D(g.landmarks[9], g.landmarks[13], g.landmarks[10], webColor);
-    DrawTriangle3D(g.landmarks[13], g.landmarks[17], g.landmarks[14], webColor);
-    DrawTriangle3D(g.landmarks[1], g.landmarks[5], g.palmCenter, Fade(highlightColor, 0.35f));
-    DrawTriangle3D(g.landmarks[5], g.landmarks[9], g.palmCenter, Fade(highlightColor, 0.18f));
-}
-
-inline void DrawPalmLines(const HandGeometry& g, Color color) {
-    for (size_t i = 0; i + 1 < g.palmRim.size(); ++i) DrawLine3D(g.palmRim[i], g.palmRim[i + 1], color);
-    DrawLine3D(g.wristLeft, g.wristRight, color);
-    DrawLine3D(g.landmarks[0], g.landmarks[5], Fade(color, 0.85f));
-    DrawLine3D(g.landmarks[0], g.landmarks[9], Fade(color, 0.90f));
-    DrawLine3D(g.landmarks[0], g.landmarks[13], Fade(color, 0.85f));
-    DrawLine3D(g.landmarks[0], g.landmarks[17], Fade(color, 0.80f));
-}
-
-inline void DrawTendonLines(const HandGeometry& g, Color color) {
-    const std::array<int, 4> fingerStarts = {5, 9, 13, 17};
-    for (int idx : fingerStarts) {
-        DrawLine3D(g.landmarks[0], g.landmarks[idx + 1], Fade(color, 0.65f));
-        DrawLine3D(g.landmarks[idx], g.landmarks[idx + 2], Fade(color, 0.50f));
-    }
-    DrawLine3D(g.landmarks[1], g.landmarks[3], Fade(color, 0.55f));
-}
-
-inline void DrawForearm(const HandGeometry& g, const HandVisualStyle& style) {
-    const float s = HandVisualScale(g);
-    const Vector3 wristMid = Vector3Scale(Vector3Add(g.wristLeft, g.wristRight), 0.5f);
-    const Vector3 knuckleMid = Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]});
-    const Vector3 dir = SafeNormalize(Vector3Subtract(wristMid, knuckleMid), {0.0f, -1.0f, 0.0f});
-    const Vector3 forearmEnd = Vector3Add(wristMid, Vector3Scale(dir, 1.55f * s));
-    DrawBone(wristMid, forearmEnd, 0.48f * s, 0.34f * s, Fade(style.bone, 0.82f));
-    DrawSphere(forearmEnd, 0.34f * s, Fade(style.palm, 0.78f));
-}
-
-inline void DrawKnuckleBridge(const HandGeometry& g, const HandVisualStyle& style) {
-    const std::array<int, 4> ridge = {5, 9, 13, 17};
-    for (size_t i = 0; i + 1 < ridge.size(); ++i) DrawLine3D(g.landmarks[ridge[i]], g.landmarks[ridge[i + 1]], Fade(style.accent, 0.55f));
-    for (int idx : ridge) DrawSphere(g.landmarks[idx], g.radii[idx] * 0.72f, Fade(style.accent, 0.55f));
-}
-
-inline void DrawPinchCue(const HandGeometry& g, const HandVisualStyle& style) {
-    const float s = HandVisualScale(g);
-    const Vector3 thumb = g.landmarks[4];
-    const Vector3 index = g.landmarks[8];
-    const Vector3 center = Vector3Scale(Vector3Add(thumb, index), 0.5f);
-    DrawLine3D(thumb, index, style.accent);
-    DrawSphere(center, 0.16f * s, Fade(style.accent, 0.92f));
-    DrawSphere(thumb, 0.10f * s, style.accent);
-    DrawSphere(index, 0.10f * s, style.accent);
-}
-
-inline void DrawPalmNormalCue(const HandGeometry& g, const HandVisualStyle& style) {
-    const float s = HandVisualScale(g);
-    const Vector3 across = Vector3Subtract(g.landmarks[17], g.landmarks[5]);
-    const Vector3 fingers = Vector3Subtract(Average({g.landmarks[5], g.landmarks[9], g.landmarks[13], g.landmarks[17]}), g.landmarks[0]);
-    Vector3 normal = SafeNormalize(Vector3CrossProduct(across, fingers), {0.0f, 0.0f, 1.0f});
-    if (normal.z < 0.0f) normal = Vector3Scale(normal, -1.0f);
-    const Vector3 tip = Vector3Add(g.palmCenter, Vector3Scale(normal, 0.72f * s));
-    DrawLine3D(g.palmCenter, tip, style.accent);
-    DrawSphere(tip, 0.10f * s, style.accent);
-}
-
-inline void DrawHandShadow(const HandGeometry& g, const HandVisualStyle& style) {
-    const float s = HandVisualScale(g);
-    for (const Vector3& point : g.palmRim) {
-        const Vector3 shadow = {point.x, 0.021f, point.z};
-        DrawSphere(shadow, 0.18f * s, Fade(style.shadow, 0.25f));
-    }
-}
-
-inline void DrawHandModel(const HandGeometry& g, bool rightHand, bool showLandmarks, bool pinched) {
-    const HandVisualStyle style = StyleForHand(rightHand);
-    const float s = HandVisualScale(g);
-    DrawHandShadow(g, style);
-    DrawForearm(g, style);
-    DrawPalmSurface(g, style.palm, style.tip);
-
-    const std::array<std::pair<int, int>, 20> bones = {{
-        {0, 1}, {1, 2}, {2, 3}, {3, 4},
-        {0, 5}, {5, 6}, {6, 7}, {7, 8},
-        {0, 9}, {9, 10}, {10, 11}, {11, 12},
-        {0, 13}, {13, 14}, {14, 15}, {15, 16},
-        {0, 17}, {17, 18}, {18, 19}, {19, 20},
-    }};
-
-    for (const auto& bone : bones) {
-        const bool fingertipBone = (bone.second == 4 || bone.second == 8 || bone.second == 12 || bone.second == 16 || bone.second == 20);
-        DrawBone(g.landmarks[bone.first], g.landmarks[bone.second], g.radii[bone.first] * 0.78f, g.radii[bone.second] * 0.82f, fingertipBone ? style.tip : style.bone);
-    }
+HandVisualStyle StyleForHand(bool rightHand);
 
-    const std::array<int, 4> metacarpalTargets = {5, 9, 13, 17};
-    for (int idx : metacarpalTargets) DrawBone(g.landmarks[0], g.landmarks[idx], 0.14f * s, g.radii[idx] * 0.90f, Fade(style.bone, 0.75f));
-    DrawBone(g.landmarks[0], g.landmarks[1], 0.16f * s, g.radii[1] * 0.95f, Fade(style.bone, 0.72f));
-
-    DrawTendonLines(g, style.tendon);
-    DrawPalmLines(g, Fade(style.tendon, 0.65f));
-    DrawKnuckleBridge(g, style);
-
-    for (size_t i = 0; i < g.landmarks.size(); ++i) {
-        const bool tip = (i == 4 || i == 8 || i == 12 || i == 16 || i == 20);
-        DrawSphere(g.landmarks[i], g.radii[i] * kJointSphereScale, tip ? style.tip : style.palm);
-    }
-
-    DrawSphere(g.palmCenter, 0.33f * s, Fade(style.palm, 0.85f));
-    DrawSphere(g.landmarks[1], 0.18f * s, Fade(style.accent, 0.30f));
-    DrawPalmNormalCue(g, style);
-    if (pinched) DrawPinchCue(g, style);
-
-    if (showLandmarks) {
-        for (size_t i = 0; i < g.landmarks.size(); ++i) DrawSphere(g.landmarks[i], g.radii[i] * 0.42f, style.accent);
-    }
-}
+void DrawBone(Vector3 a, Vector3 b, float ra, float rb, Color color);
+void DrawPalmSurface(const HandGeometry& g, Color palmColor, Color highlightColor);
+void DrawPalmLines(const HandGeometry& g, Color color);
+void DrawTendonLines(const HandGeometry& g, Color color);
+void DrawForearm(const HandGeometry& g, const HandVisualStyle& style);
+void DrawKnuckleBridge(const HandGeometry& g, const HandVisualStyle& style);
+void DrawPinchCue(const HandGeometry& g, const HandVisualStyle& style);
+void DrawPalmNormalCue(const HandGeometry& g, const HandVisualStyle& style);
+void DrawHandShadow(const HandGeometry& g, const HandVisualStyle& style);
+void DrawHandModel(const HandGeometry& g, const HandVisualStyle& style, bool showLandmarks, bool pinched);
+void DrawHandModel(const HandGeometry& g, bool rightHand, bool showLandmarks, bool pinched);
 
 struct HandControlState {
     bool active = false;
@@ -599,73 +463,26 @@ struct HandControlState {
 
 class HandSceneBridge {
   public:
-    bool Start() {
-        receiverOk_ = receiver_.Start(static_cast<uint16_t>(kUdpPort));
-        frameReceiverOk_ = frameReceiver_.Start(static_cast<uint16_t>(kFrameUdpPort));
-        return receiverOk_ || frameReceiverOk_;
-    }
-
-    void Shutdown() {
-        receiver_.Close();
-        frameReceiver_.Close();
-        if (webcamTexture_.id > 0) {
-            UnloadTexture(webcamTexture_);
-            webcamTexture_ = Texture2D{};
-        }
-    }
+    bool Start();
+    void Shutdown();
 
     ~HandSceneBridge() {
         Shutdown();
     }
 
-    void Update(const Camera3D& camera, float now, float dt) {
-        int packetsRead = 0;
-        if (receiver_.Poll(tracking_, packetsRead)) lastPacketWallClock_ = now;
-
-        int framePacketsRead = 0;
-        if (frameReceiver_.Poll(previewFrameBytes_, framePacketsRead)) {
-            lastFramePacketWallClock_ = now;
-            previewDirty_ = true;
-        }
-        if (previewDirty_ && !previewFrameBytes_.empty() &&
-            (webcamTexture_.id == 0 || (now - lastPreviewTextureUpdateWallClock_) >= kPreviewUpdateInterval)) {
-            if (UpdatePreviewTexture(webcamTexture_, previewFrameBytes_)) {
-                lastPreviewTextureUpdateWallClock_ = now;
-                previewDirty_ = false;
-            }
-        }
-
-        linkLive_ = receiver_.ready() && ((now - lastPacketWallClock_) < kLinkTimeout);
-        previewLive_ = frameReceiver_.ready() && webcamTexture_.id > 0 && ((now - lastFramePacketWallClock_) < kLinkTimeout);
-        leftTracked_ = linkLive_ && tracking_.left.valid;
-        rightTracked_ = linkLive_ && tracking_.right.valid;
-
-        Vector3 depthAxis = Vector3Subtract(camera.position, camera.target);
-        depthAxis.y *= 0.16f;
-        depthAxis = SafeNormalize(depthAxis, {0.72f, 0.08f, 0.69f});
-        const float liveBlend = 1.0f - std::exp(-12.0f * dt);
-
-        if (leftTracked_) {
-            HandGeometry target = BuildTrackedGeometry(tracking_.left, false);
-            target = OffsetGeometry(target, Vector3Scale(depthAxis, EstimateTrackedDepthShift(tracking_.left)));
-            liveGeometry_[0] = liveGeometryInit_[0] ? BlendGeometry(liveGeometry_[0], target, liveBlend) : target;
-            liveGeometryInit_[0] = true;
-        } else {
-            liveGeometryInit_[0] = false;
-        }
-
-        if (rightTracked_) {
-            HandGeometry target = BuildTrackedGeometry(tracking_.right, true);
-            target = OffsetGeometry(target, Vector3Scale(depthAxis, EstimateTrackedDepthShift(tracking_.right)));
-            liveGeometry_[1] = liveGeometryInit_[1] ? BlendGeometry(liveGeometry_[1], target, liveBlend) : target;
-            liveGeometryInit_[1] = true;
-        } else {
-            liveGeometryInit_[1] = false;
-        }
-
-        UpdateControl(control_[0], liveGeometry_[0], leftTracked_, false, tracking_.left.score, tracking_.left.pinched, &prevAnchor_[0], &prevValid_[0], dt);
-        UpdateControl(control_[1], liveGeometry_[1], rightTracked_, true, tracking_.right.score, tracking_.right.pinched, &prevAnchor_[1], &prevValid_[1], dt);
-    }
+    void Update(const Camera3D& camera, float now, float dt);
+
+    // Runs on the network thread for every decoded tracking packet, as soon as it is
+    // published (GestureEngine::Process is the intended listener). Set before Start().
+    using PacketListener = std::function<void(const TrackingSample&)>;
+    void SetPacketListener(PacketListener listener) { packetListener_ = std::move(listener); }
+
+    void SetFilter(const HandFilterConfig& config) { filterConfig_ = config; }
+    const HandFilterConfig& filter() const { return filterConfig_; }
+    // Packet arrival to the end of the frame that first drew it, smoothed (seconds), and
+    // how far the current landmarks are predicted past their packet.
+    float DisplayLatency() const { return displayLatency_; }
+    float PredictionAhead() const { return predictionAhead_; }
 
     bool AnyTracked() const { return leftTracked_ || rightTracked_; }
     bool LeftTracked() const { return leftTracked_; }
@@ -673,6 +490,8 @@ class HandSceneBridge {
     bool PreviewLive() const { return previewLive_; }
     bool ReceiverOk() const { return receiverOk_; }
     bool FrameReceiverOk() const { return frameReceiverOk_; }
+    // True when the landmark stream comes through kHandMulticastGroup.
+    bool ReceiverShared() const { return receiver_.multicast(); }
     const Texture2D& WebcamTexture() const { return webcamTexture_; }
     const HandGeometry& Geometry(bool rightHand) const { return liveGeometry_[rightHand ? 1 : 0]; }
     const HandControlState& Control(bool rightHand) const { return control_[rightHand ? 1 : 0]; }
@@ -682,22 +501,13 @@ class HandSceneBridge {
         if (rightTracked_) DrawHandModel(liveGeometry_[1], true, showLandmarks, tracking_.right.pinched);
     }
 
-    void DrawPreviewPanel(Rectangle panel, const char* title) const {
-        DrawRectangleRounded(panel, 0.06f, 10, Fade(BLACK, 0.38f));
-        DrawRectangleLinesEx(panel, 1.5f, Color{92, 110, 138, 255});
-        DrawText(title, static_cast<int>(panel.x) + 14, static_cast<int>(panel.y) + 12, 20, Color{222, 230, 244, 255});
-        if (previewLive_) {
-            const Rectangle src = {0.0f, 0.0f, static_cast<float>(webcamTexture_.width), static_cast<float>(webcamTexture_.height)};
-            const Rectangle dst = {panel.x + 12.0f, panel.y + 42.0f, panel.width - 24.0f, panel.height - 54.0f};
-            DrawTexturePro(webcamTexture_, src, dst, {0.0f, 0.0f}, 0.0f, WHITE);
-        } else {
-            DrawRectangle(static_cast<int>(panel.x) + 12, static_cast<int>(panel.y) + 42, static_cast<int>(panel.width) - 24, static_cast<int>(panel.height) - 54, Color{20, 24, 32, 255});
-            const char* previewStatus = !frameReceiverOk_ ? "preview receiver failed" : "waiting for webcam preview";
-            DrawText(previewStatus, static_cast<int>(panel.x) + 24, static_cast<int>(panel.y) + 122, 18, Color{180, 194, 214, 255});
-        }
-    }
+    void DrawPreviewPanel(Rectangle panel, const char* title) const;
 
   private:
+    // Receiver thread: sleeps in poll() until a datagram arrives, drains both sockets,
+    // publishes the newest tracking packet and hands complete frames to the decoder.
+    void NetworkLoop();
+
     static void UpdateControl(
         HandControlState& out,
         const HandGeometry& g,
@@ -707,37 +517,24 @@ class HandSceneBridge {
         bool pinched,
         Vector3* prevAnchor,
         bool* prevValid,
-        float dt) {
-        out.active = active;
-        out.pinched = pinched;
-        out.rightHand = rightHand;
-        out.score = score;
-        if (!active) {
-            out.velocity = {0.0f, 0.0f, 0.0f};
-            out.palmSize = 0.0f;
-            *prevValid = false;
-            return;
-        }
-
-        out.wrist = g.landmarks[0];
-        out.palm = g.palmCenter;
-        out.thumbTip = g.landmarks[4];
-        out.indexTip = g.landmarks[8];
-        out.pinchPoint = Vector3Scale(Vector3Add(out.indexTip, out.thumbTip), 0.5f);
-        out.palmSize = Vector3Distance(g.landmarks[0], g.landmarks[9]);
-
-        const Vector3 anchor = pinched ? out.pinchPoint : out.palm;
-        if (*prevValid && dt > 1.0e-4f) {
-            out.velocity = Vector3Scale(Vector3Subtract(anchor, *prevAnchor), 1.0f / dt);
-        } else {
-            out.velocity = {0.0f, 0.0f, 0.0f};
-        }
-        *prevAnchor = anchor;
-        *prevValid = true;
-    }
+        float dt);
 
     UdpHandReceiver receiver_{};
     UdpFrameReceiver frameReceiver_{};
+    std::thread networkThread_{};
+    PacketListener packetListener_{};
+    std::atomic<bool> stopNetwork_{false};
+    TripleBuffer<TrackingSample> trackingSlot_{};
+    PreviewDecoder previewDecoder_{};
+    TrackingSample latestSample_{};
+    HandFilterConfig filterConfig_{};
+    std::array<LandmarkFilter, 2> landmarkFilter_{};
+    std::array<bool, 2> filterValid_ = {false, false};
+    double lastUpdateSteady_ = 0.0;
+    double shownReceivedAt_ = 0.0;  // arrival of the packet first drawn last frame; 0 if none
+    float frameInterval_ = 1.0f / 60.0f;
+    float displayLatency_ = 0.0f;
+    float predictionAhead_ = 0.0f;
     bool receiverOk_ = false;
     bool frameReceiverOk_ = false;
     bool linkLive_ = false;
@@ -746,36 +543,15 @@ class HandSceneBridge {
     bool rightTracked_ = false;
     float lastPacketWallClock_ = -100.0f;
     float lastFramePacketWallClock_ = -100.0f;
-    float lastPreviewTextureUpdateWallClock_ = -100.0f;
     TrackingPacket tracking_{};
     std::array<HandGeometry, 2> liveGeometry_{};
-    std::array<bool, 2> liveGeometryInit_ = {false, false};
     std::array<HandControlState, 2> control_{};
     std::array<Vector3, 2> prevAnchor_ = {Vector3{0.0f, 0.0f, 0.0f}, Vector3{0.0f, 0.0f, 0.0f}};
     std::array<bool, 2> prevValid_ = {false, false};
-    bool previewDirty_ = false;
-    std::vector<unsigned char> previewFrameBytes_{};
     Texture2D webcamTexture_{};
 };
 
-inline void DrawBridgeStatus(const HandSceneBridge& bridge, int x, int y) {
-    const char* bridgeStatus =
-        !bridge.ReceiverOk() ? "bridge: UDP receiver failed to start"
-        : bridge.AnyTracked() ? "bridge: tracking live on udp:50515"
-        : "bridge: idle on udp:50515  run AstroPhysics/vision/hand_biomechanics_bridge.py";
-    DrawText(bridgeStatus, x, y, 18, bridge.AnyTracked() ? Color{142, 255, 190, 255} : Color{188, 198, 220, 255});
-}
-
-inline void DrawStarfieldBackdrop(int count, unsigned int seed, float drift, Color baseColor) {
-    for (int i = 0; i < count; ++i) {
-        const float sx = static_cast<float>((seed * 1103515245u + static_cast<unsigned int>(i * 7919)) % 10000) / 10000.0f;
-        const float sy = static_cast<float>((seed * 214013u + static_cast<unsigned int>(i * 4051)) % 10000) / 10000.0f;
-        const float twinkle = 0.55f + 0.45f * std::sin(drift * (0.8f + 0.05f * static_cast<float>(i)) + 9.0f * sx);
-        const float radius = 0.8f + 1.9f * sx;
-        const int px = static_cast<int>(sx * static_cast<float>(GetScreenWidth()));
-        const int py = static_cast<int>(sy * static_cast<float>(GetScreenHeight()));
-        DrawCircle(px, py, radius, Fade(baseColor, 0.35f + 0.55f * twinkle));
-    }
-}
+void DrawBridgeStatus(const HandSceneBridge& bridge, int x, int y);
+void DrawStarfieldBackdrop(int count, unsigned int seed, float drift, Color baseColor);
 
 }  // namespace astro_hand
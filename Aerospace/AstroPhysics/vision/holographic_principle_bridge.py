@@ -37,9 +37,12 @@ except ImportError as exc:
     )
     sys.exit(1)
 
+from live_controls_publisher import LiveControlsPublisher
+
 
 WINDOW_NAME = "Holographic Principle Bridge"
 CONTROL_OUTPUT_PATH = Path(__file__).resolve().parent / "live_controls.txt"
+CONTROL_PUBLISHER = LiveControlsPublisher(CONTROL_OUTPUT_PATH)
 MODEL_PATH = Path(__file__).resolve().parent / "models" / "hand_landmarker.task"
 
 WRIST = 0
@@ -187,12 +190,7 @@ def _export_live_controls(state: BridgeState, now: float) -> None:
         f"n_inc_count=0\n"
         f"n_dec_count=0\n"
     )
-    tmp_path = CONTROL_OUTPUT_PATH.with_suffix(".tmp")
-    try:
-        tmp_path.write_text(payload, encoding="utf-8")
-        os.replace(tmp_path, CONTROL_OUTPUT_PATH)
-    except OSError:
-        pass
+    CONTROL_PUBLISHER.publish(payload)
 
 
 def _tracker_setup():
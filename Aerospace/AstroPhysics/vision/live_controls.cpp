@@ -0,0 +1,366 @@
+#include "live_controls.h"
+#include "udp_socket.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define ASTRO_LIVE_CONTROLS_INOTIFY 1
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#include <fcntl.h>
+#include <sys/event.h>
+#include <unistd.h>
+#define ASTRO_LIVE_CONTROLS_KQUEUE 1
+#endif
+
+namespace astro_hand {
+
+namespace {
+
+constexpr const char* kFileName = "live_controls.txt";
+// Without a notification API the file's mtime is checked this often (seconds).
+constexpr double kStatInterval = 0.25;
+constexpr double kResolveInterval = 1.0;
+
+std::string_view Trim(std::string_view s) {
+    const auto space = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    while (!s.empty() && space(s.front())) s.remove_prefix(1);
+    while (!s.empty() && space(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+bool ParseFlag(std::string_view v) {
+    return v == "1" || v == "true" || v == "True";
+}
+
+// Leaves `out` unchanged unless the whole value is a number.
+template <typename T>
+void ParseNumber(std::string_view v, T& out) {
+    char text[64];
+    if (v.empty() || v.size() >= sizeof(text)) return;
+    std::memcpy(text, v.data(), v.size());
+    text[v.size()] = '\0';
+    char* end = nullptr;
+    const double value = std::strtod(text, &end);
+    if (end != text + v.size()) return;
+    out = static_cast<T>(value);
+}
+
+void ParseInt64(std::string_view v, std::int64_t& out) {
+    char text[32];
+    if (v.empty() || v.size() >= sizeof(text)) return;
+    std::memcpy(text, v.data(), v.size());
+    text[v.size()] = '\0';
+    char* end = nullptr;
+    const long long value = std::strtoll(text, &end, 10);
+    if (end != text + v.size()) return;
+    out = static_cast<std::int64_t>(value);
+}
+
+}  // namespace
+
+bool ParseLiveControls(const char* text, std::size_t size, LiveControls& out) {
+    LiveControls lc;
+    std::string_view rest(text, size);
+    while (!rest.empty()) {
+        const std::size_t newline = rest.find('\n');
+        const std::string_view line = rest.substr(0, newline);
+        rest.remove_prefix(newline == std::string_view::npos ? rest.size() : newline + 1);
+
+        const std::size_t eq = line.find('=');
+        if (eq == std::string_view::npos) continue;
+        const std::string_view key = Trim(line.substr(0, eq));
+        const std::string_view val = Trim(line.substr(eq + 1));
+        if (key == "zoom") ParseNumber(val, lc.zoom);
+        else if (key == "rotation_deg") ParseNumber(val, lc.rotationDeg);
+        else if (key == "pitch_deg") ParseNumber(val, lc.pitchDeg);
+        else if (key == "wave_amp") ParseNumber(val, lc.waveAmp);
+        else if (key == "paused") lc.paused = ParseFlag(val);
+        else if (key == "zoom_line_active") lc.zoomLineActive = ParseFlag(val);
+        else if (key == "zoom_line_ax") ParseNumber(val, lc.zoomLineAx);
+        else if (key == "zoom_line_ay") ParseNumber(val, lc.zoomLineAy);
+        else if (key == "zoom_line_bx") ParseNumber(val, lc.zoomLineBx);
+        else if (key == "zoom_line_by") ParseNumber(val, lc.zoomLineBy);
+        else if (key == "label") lc.label = std::string(val);
+        else if (key == "gesture") lc.gesture = std::string(val);
+        else if (key == "pinch_ratio") ParseNumber(val, lc.pinchRatio);
+        else if (key == "n_inc_count") ParseNumber(val, lc.nIncCount);
+        else if (key == "n_dec_count") ParseNumber(val, lc.nDecCount);
+        else if (key == "timestamp_ms") ParseInt64(val, lc.timestampMs);
+    }
+
+    if (lc.timestampMs <= 0) return false;
+    out = std::move(lc);
+    return true;
+}
+
+bool LiveControlsWatcher::Start() {
+    Close();
+    nextResolveAt_ = 0.0;
+    if (!ResolveDirectory()) return false;
+    watching_ = true;
+    dirty_ = true;
+    OpenNotifier();
+    return true;
+}
+
+bool LiveControlsWatcher::ListenUdp(uint16_t port) {
+    CloseUdpSocket(udpSocket_);
+    udpSocket_ = OpenUdpSocket(port);
+    return udpSocket_ >= 0;
+}
+
+void LiveControlsWatcher::Close() {
+    CloseNotifier();
+    CloseUdpSocket(udpSocket_);
+    watching_ = false;
+}
+
+bool LiveControlsWatcher::ResolveDirectory() {
+    const std::filesystem::path candidates[] = {
+        "vision",
+        "../vision",
+        "../../vision",
+        "AstroPhysics/vision",
+        std::filesystem::path(__FILE__).parent_path(),
+    };
+
+    // Prefer a directory that already has the file; otherwise wait in the first
+    // vision/ directory found for a bridge to create it.
+    std::error_code ec;
+    const std::filesystem::path* firstDir = nullptr;
+    for (const std::filesystem::path& dir : candidates) {
+        if (std::filesystem::exists(dir / kFileName, ec)) {
+            path_ = dir / kFileName;
+            return true;
+        }
+        if (firstDir == nullptr && std::filesystem::is_directory(dir, ec)) firstDir = &dir;
+    }
+    if (firstDir == nullptr) return false;
+    path_ = *firstDir / kFileName;
+    return true;
+}
+
+#if defined(ASTRO_LIVE_CONTROLS_INOTIFY)
+
+bool LiveControlsWatcher::OpenNotifier() {
+    notifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd_ < 0) return false;
+    // The bridges write a temp file and rename it over live_controls.txt, so the
+    // directory is watched rather than the file's inode.
+    const std::string dir = path_.parent_path().empty() ? std::string(".") : path_.parent_path().string();
+    watchFd_ = inotify_add_watch(notifyFd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF);
+    if (watchFd_ < 0) {
+        CloseNotifier();
+        return false;
+    }
+    return true;
+}
+
+void LiveControlsWatcher::CloseNotifier() {
+    if (notifyFd_ >= 0) close(notifyFd_);
+    notifyFd_ = -1;
+    watchFd_ = -1;
+}
+
+bool LiveControlsWatcher::DrainNotifier() {
+    if (notifyFd_ < 0) return false;
+    bool changed = false;
+    alignas(inotify_event) char events[4096];
+    while (true) {
+        const ssize_t n = read(notifyFd_, events, sizeof(events));
+        if (n <= 0) break;
+        for (ssize_t offset = 0; offset < n;) {
+            const inotify_event* ev = reinterpret_cast<const inotify_event*>(events + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+            if (ev->mask & (IN_Q_OVERFLOW | IN_DELETE_SELF | IN_IGNORED)) {
+                changed = true;
+                if (!(ev->mask & IN_Q_OVERFLOW)) watching_ = false;
+            } else if (ev->len > 0 && std::strcmp(ev->name, kFileName) == 0) {
+                changed = true;
+            }
+        }
+    }
+    if (!watching_) CloseNotifier();
+    return changed;
+}
+
+#elif defined(ASTRO_LIVE_CONTROLS_KQUEUE)
+
+bool LiveControlsWatcher::OpenNotifier() {
+    const std::string dir = path_.parent_path().empty() ? std::string(".") : path_.parent_path().string();
+#ifdef O_EVTONLY
+    watchFd_ = open(dir.c_str(), O_EVTONLY);
+#else
+    watchFd_ = open(dir.c_str(), O_RDONLY);
+#endif
+    if (watchFd_ < 0) return false;
+    notifyFd_ = kqueue();
+    if (notifyFd_ < 0) {
+        CloseNotifier();
+        return false;
+    }
+    // Renaming a file into the directory is a write to the directory vnode.
+    struct kevent change;
+    EV_SET(&change, watchFd_, EVFILT_VNODE, EV_ADD | EV_CLEAR, NOTE_WRITE | NOTE_DELETE | NOTE_RENAME, 0, nullptr);
+    if (kevent(notifyFd_, &change, 1, nullptr, 0, nullptr) < 0) {
+        CloseNotifier();
+        return false;
+    }
+    return true;
+}
+
+void LiveControlsWatcher::CloseNotifier() {
+    if (notifyFd_ >= 0) close(notifyFd_);
+    if (watchFd_ >= 0) close(watchFd_);
+    notifyFd_ = -1;
+    watchFd_ = -1;
+}
+
+bool LiveControlsWatcher::DrainNotifier() {
+    if (notifyFd_ < 0) return false;
+    bool changed = false;
+    const timespec zero{0, 0};
+    struct kevent events[8];
+    while (true) {
+        const int n = kevent(notifyFd_, nullptr, 0, events, 8, &zero);
+        if (n <= 0) break;
+        for (int i = 0; i < n; ++i) {
+            changed = true;
+            if (events[i].fflags & (NOTE_DELETE | NOTE_RENAME)) watching_ = false;
+        }
+    }
+    if (!watching_) CloseNotifier();
+    return changed;
+}
+
+#elif defined(_WIN32)
+
+bool LiveControlsWatcher::OpenNotifier() {
+    const std::filesystem::path dir = path_.parent_path().empty() ? std::filesystem::path(".") : path_.parent_path();
+    // A change-notification handle can be polled with a zero timeout, which suits a
+    // once-per-frame Poll() better than an overlapped ReadDirectoryChangesW.
+    HANDLE handle = FindFirstChangeNotificationW(dir.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    notifyHandle_ = handle;
+    return true;
+}
+
+void LiveControlsWatcher::CloseNotifier() {
+    if (notifyHandle_ != nullptr) FindCloseChangeNotification(static_cast<HANDLE>(notifyHandle_));
+    notifyHandle_ = nullptr;
+}
+
+bool LiveControlsWatcher::DrainNotifier() {
+    if (notifyHandle_ == nullptr) return false;
+    bool changed = false;
+    while (WaitForSingleObject(static_cast<HANDLE>(notifyHandle_), 0) == WAIT_OBJECT_0) {
+        changed = true;
+        if (!FindNextChangeNotification(static_cast<HANDLE>(notifyHandle_))) {
+            CloseNotifier();
+            watching_ = false;
+            break;
+        }
+    }
+    return changed;
+}
+
+#else
+
+bool LiveControlsWatcher::OpenNotifier() {
+    return false;
+}
+
+void LiveControlsWatcher::CloseNotifier() {}
+
+bool LiveControlsWatcher::DrainNotifier() {
+    return false;
+}
+
+#endif
+
+bool LiveControlsWatcher::NotifierOpen() const {
+#ifdef _WIN32
+    return notifyHandle_ != nullptr;
+#else
+    return notifyFd_ >= 0;
+#endif
+}
+
+void LiveControlsWatcher::ReloadFile() {
+    fromFile_.reset();
+    std::FILE* file = std::fopen(path_.string().c_str(), "rb");
+    if (file == nullptr) return;
+    const size_t n = std::fread(buffer_.data(), 1, buffer_.size(), file);
+    std::fclose(file);
+    LiveControls lc;
+    if (ParseLiveControls(buffer_.data(), n, lc)) fromFile_ = std::move(lc);
+}
+
+bool LiveControlsWatcher::Poll(double nowSeconds) {
+    const std::int64_t previousFile = fromFile_ ? fromFile_->timestampMs : 0;
+    const std::int64_t previousUdp = fromUdp_ ? fromUdp_->timestampMs : 0;
+
+    if (!watching_ && nowSeconds >= nextResolveAt_) {
+        nextResolveAt_ = nowSeconds + kResolveInterval;
+        if (ResolveDirectory()) {
+            watching_ = true;
+            dirty_ = true;
+            OpenNotifier();
+        } else {
+            fromFile_.reset();
+        }
+    }
+
+    if (watching_) {
+        if (NotifierOpen()) {
+            if (DrainNotifier()) dirty_ = true;
+        } else if (nowSeconds >= nextStatAt_) {
+            nextStatAt_ = nowSeconds + kStatInterval;
+            std::error_code ec;
+            const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path_, ec);
+            const std::filesystem::file_time_type stamp = ec ? std::filesystem::file_time_type{} : writeTime;
+            if (stamp != lastWriteTime_) {
+                lastWriteTime_ = stamp;
+                dirty_ = true;
+            }
+        }
+        // The notifier may have reported its directory gone; reload once either way
+        // so a removed file clears the controls.
+        if (dirty_) {
+            dirty_ = false;
+            ReloadFile();
+        }
+    }
+
+    if (udpSocket_ >= 0) {
+        while (true) {
+            const int n = ReceiveDatagram(udpSocket_, buffer_.data(), buffer_.size());
+            if (n <= 0) break;
+            LiveControls lc;
+            if (ParseLiveControls(buffer_.data(), static_cast<size_t>(n), lc)) fromUdp_ = std::move(lc);
+        }
+    }
+
+    const std::int64_t fileStamp = fromFile_ ? fromFile_->timestampMs : 0;
+    const std::int64_t udpStamp = fromUdp_ ? fromUdp_->timestampMs : 0;
+    if (fileStamp == previousFile && udpStamp == previousUdp) return false;
+
+    if (fromFile_ && (!fromUdp_ || fromFile_->timestampMs >= fromUdp_->timestampMs)) {
+        latest_ = fromFile_;
+    } else {
+        latest_ = fromUdp_;
+    }
+    return true;
+}
+
+}  // namespace astro_hand
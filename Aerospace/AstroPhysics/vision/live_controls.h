@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+// Camera controls published by the webcam bridges (webcam_finger_tracker.py,
+// holographic_principle_bridge.py) as "key=value" lines. The bridges replace
+// vision/live_controls.txt atomically, or with ASTRO_LIVE_CONTROLS_UDP=1 send the
+// same text to udp:kLiveControlsUdpPort instead. Part of the astro_hand library.
+
+namespace astro_hand {
+
+constexpr int kLiveControlsUdpPort = 50517;
+
+struct LiveControls {
+    float zoom = 1.0f;
+    float rotationDeg = 0.0f;
+    float pitchDeg = 0.0f;
+    float waveAmp = 1.0f;
+    bool paused = false;
+    bool zoomLineActive = false;
+    float zoomLineAx = 0.5f;
+    float zoomLineAy = 0.5f;
+    float zoomLineBx = 0.5f;
+    float zoomLineBy = 0.5f;
+    std::string label = "Unknown";
+    std::string gesture = "none";
+    float pinchRatio = 0.0f;
+    int nIncCount = 0;
+    int nDecCount = 0;
+    std::int64_t timestampMs = 0;
+};
+
+// Parses a live_controls payload; malformed values keep their defaults. Fails when
+// the payload carries no timestamp_ms.
+bool ParseLiveControls(const char* text, std::size_t size, LiveControls& out);
+
+// Watches the live_controls.txt directory with inotify (Linux), kqueue (macOS/BSD)
+// or a change notification handle (Windows), and re-reads the file only when the
+// bridge has replaced it. Elsewhere it falls back to checking the file's mtime a
+// few times a second. Poll() once per frame; it never blocks.
+class LiveControlsWatcher {
+  public:
+    LiveControlsWatcher() = default;
+    LiveControlsWatcher(const LiveControlsWatcher&) = delete;
+    LiveControlsWatcher& operator=(const LiveControlsWatcher&) = delete;
+
+    ~LiveControlsWatcher() {
+        Close();
+    }
+
+    // Starts watching the first of the usual vision/ directories that exists.
+    // Returns false when none does; Poll() keeps looking once a second.
+    bool Start();
+    // Also accept controls as UDP datagrams. The newest timestamp from either
+    // source wins.
+    bool ListenUdp(uint16_t port = kLiveControlsUdpPort);
+    void Close();
+
+    // Returns true when Latest() changed.
+    bool Poll(double nowSeconds);
+
+    // Most recent controls, or empty while no bridge has published any (or the
+    // file was removed).
+    const std::optional<LiveControls>& Latest() const { return latest_; }
+    const std::filesystem::path& path() const { return path_; }
+
+  private:
+    bool ResolveDirectory();
+    bool OpenNotifier();
+    void CloseNotifier();
+    bool NotifierOpen() const;
+    // Drains pending notifications; true when live_controls.txt may have changed.
+    bool DrainNotifier();
+    void ReloadFile();
+
+    std::filesystem::path path_;
+    bool watching_ = false;
+    bool dirty_ = false;
+    double nextResolveAt_ = 0.0;
+    double nextStatAt_ = 0.0;
+    std::filesystem::file_time_type lastWriteTime_{};
+#ifdef _WIN32
+    void* notifyHandle_ = nullptr;
+#else
+    int notifyFd_ = -1;
+    int watchFd_ = -1;
+#endif
+    int udpSocket_ = -1;
+    std::optional<LiveControls> fromFile_;
+    std::optional<LiveControls> fromUdp_;
+    std::optional<LiveControls> latest_;
+    std::array<char, 2048> buffer_;
+};
+
+}  // namespace astro_hand
@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+"""
+live_controls publisher shared by the camera-control bridges.
+
+The C++ LiveControlsWatcher (live_controls.h) reads "key=value" lines from
+live_controls.txt, which is replaced atomically so a reader never sees a partial
+write. Set ASTRO_LIVE_CONTROLS_UDP=1 to send the same text to
+udp:localhost:50517 instead and skip the filesystem entirely.
+"""
+
+from __future__ import annotations
+
+import os
+import socket
+from pathlib import Path
+
+
+LIVE_CONTROLS_UDP_PORT = 50517
+
+
+class LiveControlsPublisher:
+    def __init__(self, path: Path, host: str = "127.0.0.1", port: int = LIVE_CONTROLS_UDP_PORT) -> None:
+        self.path = path
+        self.address = (host, port)
+        self.sock = None
+        if os.environ.get("ASTRO_LIVE_CONTROLS_UDP", "0") == "1":
+            self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+    def publish(self, payload: str) -> None:
+        if self.sock is not None:
+            try:
+                self.sock.sendto(payload.encode("utf-8"), self.address)
+            except OSError:
+                pass
+            return
+
+        tmp_path = self.path.with_suffix(".tmp")
+        try:
+            tmp_path.write_text(payload, encoding="utf-8")
+            os.replace(tmp_path, self.path)
+        except OSError:
+            # Keep the bridge running even if a write fails intermittently.
+            pass
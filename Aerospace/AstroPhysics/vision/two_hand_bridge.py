@@ -9,6 +9,8 @@ Bridge transport:
   timestamp,left_valid,left_x,left_y,right_valid,right_pinch
 - Extended fields:
   right_x,right_y,left_pinch
+- Webcam preview JPEGs on UDP localhost:50516, 1280x720 by default and
+  chunked when larger than one datagram (see udp_preview.py)
 """
 
 from __future__ import annotations
@@ -24,9 +26,12 @@ import cv2
 import mediapipe as mp
 import numpy as np
 
+from udp_preview import PreviewSender, preview_size
+
 
 UDP_HOST = "127.0.0.1"
 UDP_PORT = 50505
+FRAME_UDP_PORT = 50516
 WINDOW_NAME = "Vision Two-Hand Bridge"
 MODULE_DIR = Path(__file__).resolve().parent
 MODEL_PATH = MODULE_DIR / "models" / "hand_landmarker.task"
@@ -35,6 +40,9 @@ SMOOTH_ALPHA = 0.34
 PINCH_CLOSE_RATIO = 0.40
 PINCH_RELEASE_RATIO = 0.54
 SWAP_LABELS_ON_MIRROR = True
+PREVIEW_SEND_HZ = 30.0
+PREVIEW_W, PREVIEW_H = preview_size(1280, 720)
+PREVIEW_JPEG_QUALITY = 60
 
 WRIST = 0
 THUMB_TIP = 4
@@ -213,8 +221,8 @@ def main() -> int:
         print("Error: could not open webcam (camera index 0).")
         return 1
 
-    cap.set(cv2.CAP_PROP_FRAME_WIDTH, 960)
-    cap.set(cv2.CAP_PROP_FRAME_HEIGHT, 540)
+    cap.set(cv2.CAP_PROP_FRAME_WIDTH, 1280)
+    cap.set(cv2.CAP_PROP_FRAME_HEIGHT, 720)
 
     use_tasks = False
     hands = None
@@ -261,6 +269,8 @@ def main() -> int:
 
     sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
     sock.setblocking(False)
+    preview_sender = PreviewSender(UDP_HOST, FRAME_UDP_PORT, (PREVIEW_W, PREVIEW_H), PREVIEW_JPEG_QUALITY)
+    last_preview_send_ts = 0.0
 
     mirror = True
     left = HandState()
@@ -314,6 +324,9 @@ def main() -> int:
 
             _send_bridge_packet(sock, left, right, now)
             _draw_hud(frame, fps, mirror, left, right, len(extracted))
+            if (now - last_preview_send_ts) >= (1.0 / PREVIEW_SEND_HZ):
+                preview_sender.send(sock, frame)
+                last_preview_send_ts = now
             cv2.imshow(WINDOW_NAME, frame)
 
             key = cv2.waitKey(1) & 0xFF
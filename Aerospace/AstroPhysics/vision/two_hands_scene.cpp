@@ -1,170 +1,31 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "hand_tracking_scene_shared.h"
+
+#include "../common/frame_capture.h"
+#include "../common/profiler.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdio>
-
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "Ws2_32.lib")
-#else
-#include <arpa/inet.h>
-#include <errno.h>
-#include <fcntl.h>
-#include <sys/socket.h>
-#include <unistd.h>
-#endif
+#include <vector>
 
 namespace {
 
 constexpr int kWindowW = 1320;
 constexpr int kWindowH = 820;
-constexpr int kUdpPort = 50505;
+constexpr int kUdpPort = astro_hand::kBridgeUdpPort;
 constexpr float kHandSmooth = 12.0f;
 constexpr float kCursorSmooth = 8.0f;
 constexpr float kLinkTimeout = 0.75f;
 
-struct TrackingInput {
-    bool leftValid = false;
-    float leftX = 0.5f;
-    float leftY = 0.5f;
-    bool rightValid = false;
-    bool rightPinch = false;
-    float rightX = 0.5f;
-    float rightY = 0.5f;
-    bool leftPinch = false;
-    double timestamp = 0.0;
-};
-
 struct HandPose {
     Vector3 pos = {0.0f, 1.7f, 0.0f};
     bool valid = false;
     bool pinched = false;
 };
 
-class UdpBridgeReceiver {
-  public:
-    bool Start(uint16_t port) {
-#ifdef _WIN32
-        WSADATA wsaData;
-        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return false;
-#endif
-        socket_ = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
-        if (socket_ < 0) return false;
-
-        sockaddr_in addr{};
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        addr.sin_port = htons(port);
-        if (bind(socket_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
-            Close();
-            return false;
-        }
-
-#ifdef _WIN32
-        u_long mode = 1;
-        if (ioctlsocket(socket_, FIONBIO, &mode) != 0) {
-            Close();
-            return false;
-        }
-#else
-        const int flags = fcntl(socket_, F_GETFL, 0);
-        if (flags < 0 || fcntl(socket_, F_SETFL, flags | O_NONBLOCK) < 0) {
-            Close();
-            return false;
-        }
-#endif
-        ready_ = true;
-        return true;
-    }
-
-    void Close() {
-        if (socket_ >= 0) {
-#ifdef _WIN32
-            closesocket(socket_);
-            WSACleanup();
-#else
-            close(socket_);
-#endif
-            socket_ = -1;
-        }
-        ready_ = false;
-    }
-
-    bool Poll(TrackingInput &outInput, int &packetsRead) {
-        packetsRead = 0;
-        if (!ready_) return false;
-
-        bool gotAny = false;
-        std::array<char, 256> buffer{};
-        while (true) {
-            sockaddr_in src{};
-            socklen_t srcLen = sizeof(src);
-            const int n = recvfrom(socket_, buffer.data(), static_cast<int>(buffer.size()) - 1, 0,
-                                   reinterpret_cast<sockaddr *>(&src), &srcLen);
-            if (n <= 0) {
-#ifdef _WIN32
-                if (WSAGetLastError() == WSAEWOULDBLOCK) break;
-#else
-                if (errno == EWOULDBLOCK || errno == EAGAIN) break;
-#endif
-                break;
-            }
-
-            buffer[static_cast<size_t>(n)] = '\0';
-
-            TrackingInput parsed{};
-            int lv = 0;
-            int rv = 0;
-            int rp = 0;
-            int lp = 0;
-
-            const int got = std::sscanf(
-                buffer.data(),
-                "%lf,%d,%f,%f,%d,%d,%f,%f,%d",
-                &parsed.timestamp,
-                &lv,
-                &parsed.leftX,
-                &parsed.leftY,
-                &rv,
-                &rp,
-                &parsed.rightX,
-                &parsed.rightY,
-                &lp
-            );
-            if (got >= 6) {
-                parsed.leftValid = (lv != 0);
-                parsed.rightValid = (rv != 0);
-                parsed.rightPinch = (rp != 0);
-                if (got < 8) {
-                    parsed.rightX = 0.5f;
-                    parsed.rightY = 0.5f;
-                }
-                if (got >= 9) parsed.leftPinch = (lp != 0);
-
-                parsed.leftX = std::clamp(parsed.leftX, 0.0f, 1.0f);
-                parsed.leftY = std::clamp(parsed.leftY, 0.0f, 1.0f);
-                parsed.rightX = std::clamp(parsed.rightX, 0.0f, 1.0f);
-                parsed.rightY = std::clamp(parsed.rightY, 0.0f, 1.0f);
-
-                outInput = parsed;
-                gotAny = true;
-                packetsRead++;
-            }
-        }
-        return gotAny;
-    }
-
-    bool ready() const { return ready_; }
-
-  private:
-    int socket_ = -1;
-    bool ready_ = false;
-};
-
 Vector3 HandSpaceToWorld(float x, float y, bool rightSide) {
     const float worldX = Lerp(-10.0f, 10.0f, x) + (rightSide ? 0.55f : -0.55f);
     const float worldY = Lerp(1.5f, 8.8f, 1.0f - y);
@@ -226,10 +87,19 @@ int main() {
     cam.fovy = 48.0f;
     cam.projection = CAMERA_PERSPECTIVE;
 
-    UdpBridgeReceiver receiver;
+    astro_hand::UdpBridgeReceiver receiver;
     const bool receiverOk = receiver.Start(static_cast<uint16_t>(kUdpPort));
 
-    TrackingInput tracking{};
+    // Webcam preview: chunked JPEGs are reassembled here and decoded off the render thread.
+    astro_hand::UdpFrameReceiver frameReceiver;
+    const bool frameReceiverOk = frameReceiver.Start(static_cast<uint16_t>(astro_hand::kFrameUdpPort));
+    astro_hand::PreviewDecoder previewDecoder;
+    if (frameReceiverOk) previewDecoder.Start();
+    std::vector<unsigned char> frameBytes;
+    Texture2D previewTexture{};
+    float lastFrameWallClock = -100.0f;
+
+    astro_hand::BridgeInput tracking{};
     float lastPacketWallClock = -100.0f;
     HandPose leftHand{};
     HandPose rightHand{};
@@ -245,6 +115,11 @@ int main() {
         }
         const bool linkLive = receiver.ready() && ((now - lastPacketWallClock) < kLinkTimeout);
 
+        int framePacketsRead = 0;
+        if (frameReceiver.Poll(frameBytes, framePacketsRead)) previewDecoder.Submit(frameBytes);
+        if (previewDecoder.Upload(previewTexture, now, astro_hand::kPreviewUpdateInterval)) lastFrameWallClock = now;
+        const bool previewLive = previewTexture.id > 0 && ((now - lastFrameWallClock) < kLinkTimeout);
+
         const bool leftLive = linkLive && tracking.leftValid;
         const bool rightLive = linkLive && tracking.rightValid;
 
@@ -340,11 +215,35 @@ int main() {
             Color{208, 226, 248, 255}
         );
 
+        const Rectangle panel = {static_cast<float>(GetScreenWidth()) - 344.0f, 96.0f, 328.0f, 226.0f};
+        DrawRectangleRounded(panel, 0.06f, 10, Fade(BLACK, 0.38f));
+        DrawRectangleLinesEx(panel, 1.5f, Color{92, 110, 138, 255});
+        DrawText("Webcam preview", static_cast<int>(panel.x) + 14, static_cast<int>(panel.y) + 10, 18, Color{222, 230, 244, 255});
+        const Rectangle view = {panel.x + 12.0f, panel.y + 36.0f, panel.width - 24.0f, panel.height - 48.0f};
+        if (previewLive) {
+            const float aspect = static_cast<float>(previewTexture.width) / static_cast<float>(previewTexture.height);
+            const float w = std::min(view.width, view.height * aspect);
+            const float h = w / aspect;
+            const Rectangle src = {0.0f, 0.0f, static_cast<float>(previewTexture.width), static_cast<float>(previewTexture.height)};
+            const Rectangle dst = {view.x + 0.5f * (view.width - w), view.y + 0.5f * (view.height - h), w, h};
+            DrawTexturePro(previewTexture, src, dst, {0.0f, 0.0f}, 0.0f, WHITE);
+        } else {
+            DrawRectangleRec(view, Color{20, 24, 32, 255});
+            DrawText(frameReceiverOk ? "waiting for frames on udp:50516" : "preview receiver failed",
+                     static_cast<int>(view.x) + 12, static_cast<int>(view.y + 0.5f * view.height) - 9, 16, Color{180, 194, 214, 255});
+        }
+
         DrawFPS(GetScreenWidth() - 100, 14);
+        astro_capture::CaptureFrame();
+        ASTRO_PROFILE_FRAME();
         EndDrawing();
     }
 
+    previewDecoder.Stop();
+    if (previewTexture.id > 0) UnloadTexture(previewTexture);
+    frameReceiver.Close();
     receiver.Close();
+    astro_capture::StopCapture();
     CloseWindow();
     return 0;
 }
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+Webcam preview sender shared by the hand bridges.
+
+Frames go to the C++ UdpFrameReceiver in hand_tracking_scene_shared.h. A JPEG that
+fits in one datagram is sent as-is; larger ones (720p previews) are split into
+chunks, each prefixed with a little-endian header:
+
+  u32 magic 'AHFC' | u16 version | u16 chunk_index | u16 chunk_count | u16 reserved
+  u32 frame_id | u32 frame_bytes | u32 offset
+
+The bridges can send to HAND_MULTICAST_GROUP instead of 127.0.0.1; every C++ receiver
+subscribes to it, so one tracker process feeds all the scenes that are running.
+"""
+
+from __future__ import annotations
+
+import os
+import socket
+import struct
+from typing import List, Tuple
+
+import cv2
+import numpy as np
+
+
+CHUNK_MAGIC = 0x43464841  # "AHFC"
+CHUNK_VERSION = 1
+CHUNK_HEADER = struct.Struct("<IHHHHIII")
+CHUNK_PAYLOAD = 60000
+SINGLE_DATAGRAM_LIMIT = 65000
+HAND_MULTICAST_GROUP = "239.255.50.15"  # kHandMulticastGroup in hand_tracking_scene_shared.h
+
+
+def preview_size(default_w: int, default_h: int) -> Tuple[int, int]:
+    """Preview resolution, overridable with ASTRO_PREVIEW_SIZE=WxH (e.g. 1280x720)."""
+    value = os.environ.get("ASTRO_PREVIEW_SIZE", "")
+    try:
+        w, h = (int(v) for v in value.lower().split("x"))
+    except ValueError:
+        return default_w, default_h
+    if w <= 0 or h <= 0:
+        return default_w, default_h
+    return w, h
+
+
+def enable_loopback_multicast(sock: socket.socket) -> None:
+    """Sends multicast out of loopback with TTL 0, so it reaches local subscribers only."""
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF, socket.inet_aton("127.0.0.1"))
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 0)
+
+
+def encode_frame_chunks(data: bytes, frame_id: int) -> List[bytes]:
+    if len(data) < SINGLE_DATAGRAM_LIMIT:
+        return [data]
+    count = (len(data) + CHUNK_PAYLOAD - 1) // CHUNK_PAYLOAD
+    chunks = []
+    for index in range(count):
+        offset = index * CHUNK_PAYLOAD
+        header = CHUNK_HEADER.pack(CHUNK_MAGIC, CHUNK_VERSION, index, count, 0, frame_id, len(data), offset)
+        chunks.append(header + data[offset:offset + CHUNK_PAYLOAD])
+    return chunks
+
+
+class PreviewSender:
+    def __init__(self, host: str, port: int, size: Tuple[int, int], quality: int) -> None:
+        self.address = (host, port)
+        self.size = size
+        self.quality = quality
+        self.frame_id = 0
+
+    def send(self, sock: socket.socket, frame: np.ndarray) -> None:
+        preview = frame
+        if (frame.shape[1], frame.shape[0]) != self.size:
+            preview = cv2.resize(frame, self.size, interpolation=cv2.INTER_AREA)
+        ok, encoded = cv2.imencode(".jpg", preview, [int(cv2.IMWRITE_JPEG_QUALITY), self.quality])
+        if not ok:
+            return
+        chunks = encode_frame_chunks(encoded.tobytes(), self.frame_id)
+        self.frame_id = (self.frame_id + 1) & 0xFFFFFFFF
+        try:
+            for chunk in chunks:
+                sock.sendto(chunk, self.address)
+        except OSError:
+            return
@@ -0,0 +1,98 @@
+#include "udp_socket.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace astro_hand {
+
+namespace {
+
+int OpenSocket(uint16_t port, const char* group) {
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return -1;
+#endif
+    int s = static_cast<int>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if (s < 0) {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return -1;
+    }
+
+    bool ok = true;
+    if (group != nullptr) {
+        const int on = 1;
+        ok = setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&on), sizeof(on)) == 0;
+#ifdef SO_REUSEPORT
+        ok = ok && setsockopt(s, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char*>(&on), sizeof(on)) == 0;
+#endif
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    ok = ok && bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+
+    if (ok && group != nullptr) {
+        // Joined on loopback: the bridges send with TTL 0, so the stream never leaves the host.
+        ip_mreq membership{};
+        ok = inet_pton(AF_INET, group, &membership.imr_multiaddr) == 1;
+        membership.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+        ok = ok && setsockopt(s, IPPROTO_IP, IP_ADD_MEMBERSHIP, reinterpret_cast<const char*>(&membership),
+                              sizeof(membership)) == 0;
+    }
+
+#ifdef _WIN32
+    u_long mode = 1;
+    ok = ok && ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+    const int flags = ok ? fcntl(s, F_GETFL, 0) : -1;
+    ok = ok && flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    if (!ok) {
+#ifdef _WIN32
+        closesocket(s);
+        WSACleanup();
+#else
+        close(s);
+#endif
+        return -1;
+    }
+    return s;
+}
+
+}  // namespace
+
+int OpenUdpSocket(uint16_t port) { return OpenSocket(port, nullptr); }
+
+int OpenMulticastUdpSocket(uint16_t port, const char* group) { return OpenSocket(port, group); }
+
+void CloseUdpSocket(int& s) {
+    if (s < 0) return;
+#ifdef _WIN32
+    closesocket(s);
+    WSACleanup();
+#else
+    close(s);
+#endif
+    s = -1;
+}
+
+int ReceiveDatagram(int s, void* buffer, size_t capacity) {
+    sockaddr_in src{};
+    socklen_t srcLen = sizeof(src);
+    return static_cast<int>(recvfrom(s, static_cast<char*>(buffer), static_cast<int>(capacity), 0, reinterpret_cast<sockaddr*>(&src), &srcLen));
+}
+
+}  // namespace astro_hand
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Plain non-blocking UDP sockets for the astro_hand receivers. Kept apart from
+// hand_tracking_scene_shared.h so code that needs the platform headers does not
+// also pull in raylib.
+
+namespace astro_hand {
+
+// Non-blocking UDP socket bound to INADDR_ANY:port, or -1.
+int OpenUdpSocket(uint16_t port);
+// As OpenUdpSocket, but the port can be shared with other processes (SO_REUSEADDR, and
+// SO_REUSEPORT where it exists) and the socket joins the multicast `group` (dotted
+// quad) on the loopback interface, so every subscriber gets its own copy of what is
+// sent to the group. Unicast to the port still arrives, at one of the sharing sockets.
+// -1 when the group cannot be joined.
+int OpenMulticastUdpSocket(uint16_t port, const char* group);
+void CloseUdpSocket(int& s);
+// Non-blocking receive of one datagram; returns its length, or <= 0 when drained.
+int ReceiveDatagram(int s, void* buffer, size_t capacity);
+
+}  // namespace astro_hand
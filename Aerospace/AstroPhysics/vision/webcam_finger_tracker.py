@@ -51,6 +51,8 @@ except ImportError as exc:
     )
     sys.exit(1)
 
+from live_controls_publisher import LiveControlsPublisher
+
 # Landmark indices (MediaPipe 21-hand-landmark format)
 WRIST = 0
 THUMB_TIP = 4
@@ -141,6 +143,7 @@ MODEL_URL = (
 )
 MODEL_PATH = Path(__file__).resolve().parent / "models" / "hand_landmarker.task"
 CONTROL_OUTPUT_PATH = Path(__file__).resolve().parent / "live_controls.txt"
+CONTROL_PUBLISHER = LiveControlsPublisher(CONTROL_OUTPUT_PATH)
 UDP_HOST = "127.0.0.1"
 FRAME_UDP_PORT = 50516
 PREVIEW_SEND_HZ = 30.0
@@ -971,13 +974,7 @@ def _export_live_controls(control: CameraControlState, now: float) -> None:
         f"n_dec_count={control.n_dec_count}\n"
     )
 
-    tmp_path = CONTROL_OUTPUT_PATH.with_suffix(".tmp")
-    try:
-        tmp_path.write_text(payload, encoding="utf-8")
-        os.replace(tmp_path, CONTROL_OUTPUT_PATH)
-    except OSError:
-        # Keep tracker running even if file write fails intermittently.
-        pass
+    CONTROL_PUBLISHER.publish(payload)
 
 
 def _send_preview_frame(sock: socket.socket, frame: np.ndarray, state: CameraControlState, now: float) -> None: